@@ -2,7 +2,7 @@
 # PYTHON_PYARROW_INCLUDE_DIR
 # PYTHON_PYARROW_FOUND
 # PYTHON_PYARROW_LIBRARY_DIR
-# PYTHON_PYARROW_LIBRARIES
+# PYTHON_PYARROW_LIBRARIES (arrow, arrow_python and parquet)
 # will be set by this script
 
 cmake_minimum_required(VERSION 2.6)
@@ -52,17 +52,20 @@ if(${CMAKE_SYSTEM_NAME} MATCHES "Windows")
   # windows its just "arrow.dll"
   set(PYTHON_PYARROW_PYTHON_SHARED_LIBRARY "arrow_python")
   set(PYTHON_PYARROW_ARROW_SHARED_LIBRARY "arrow")
-  set(PYTHON_PYARROW_LIBRARIES ${PYTHON_PYARROW_PYTHON_SHARED_LIBRARY} ${PYTHON_PYARROW_ARROW_SHARED_LIBRARY})
+  set(PYTHON_PYARROW_PARQUET_SHARED_LIBRARY "parquet")
+  set(PYTHON_PYARROW_LIBRARIES ${PYTHON_PYARROW_PYTHON_SHARED_LIBRARY} ${PYTHON_PYARROW_ARROW_SHARED_LIBRARY} ${PYTHON_PYARROW_PARQUET_SHARED_LIBRARY})
 elseif (CMAKE_SYSTEM_NAME MATCHES "Darwin")
   # Link against pre-built libarrow on MacOS
   set(PYTHON_PYARROW_PYTHON_SHARED_LIBRARY ${PYTHON_PYARROW_LIBRARY_DIR}/${CMAKE_SHARED_LIBRARY_PREFIX}arrow_python.15.dylib)
   set(PYTHON_PYARROW_ARROW_SHARED_LIBRARY ${PYTHON_PYARROW_LIBRARY_DIR}/${CMAKE_SHARED_LIBRARY_PREFIX}arrow.15.dylib)
-  set(PYTHON_PYARROW_LIBRARIES ${PYTHON_PYARROW_PYTHON_SHARED_LIBRARY} ${PYTHON_PYARROW_ARROW_SHARED_LIBRARY})
+  set(PYTHON_PYARROW_PARQUET_SHARED_LIBRARY ${PYTHON_PYARROW_LIBRARY_DIR}/${CMAKE_SHARED_LIBRARY_PREFIX}parquet.15.dylib)
+  set(PYTHON_PYARROW_LIBRARIES ${PYTHON_PYARROW_PYTHON_SHARED_LIBRARY} ${PYTHON_PYARROW_ARROW_SHARED_LIBRARY} ${PYTHON_PYARROW_PARQUET_SHARED_LIBRARY})
 else()
   # linux
   set(PYTHON_PYARROW_PYTHON_SHARED_LIBRARY ${CMAKE_SHARED_LIBRARY_PREFIX}arrow_python${CMAKE_SHARED_LIBRARY_SUFFIX}.15)
   set(PYTHON_PYARROW_ARROW_SHARED_LIBRARY ${CMAKE_SHARED_LIBRARY_PREFIX}arrow${CMAKE_SHARED_LIBRARY_SUFFIX}.15)
-  set(PYTHON_PYARROW_LIBRARIES ${PYTHON_PYARROW_PYTHON_SHARED_LIBRARY} ${PYTHON_PYARROW_ARROW_SHARED_LIBRARY})
+  set(PYTHON_PYARROW_PARQUET_SHARED_LIBRARY ${CMAKE_SHARED_LIBRARY_PREFIX}parquet${CMAKE_SHARED_LIBRARY_SUFFIX}.15)
+  set(PYTHON_PYARROW_LIBRARIES ${PYTHON_PYARROW_PYTHON_SHARED_LIBRARY} ${PYTHON_PYARROW_ARROW_SHARED_LIBRARY} ${PYTHON_PYARROW_PARQUET_SHARED_LIBRARY})
 endif()
 
 if(PYTHON_PYARROW_INCLUDE_DIR AND PYTHON_PYARROW_LIBRARIES)
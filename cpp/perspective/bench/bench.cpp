@@ -0,0 +1,376 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+/**
+ * Benchmarks for the core engine, run without any binding overhead.
+ *
+ * Build with `-DPSP_CPP_BUILD=1 -DPSP_WASM_BUILD=0 -DPSP_CPP_BUILD_BENCH=1`,
+ * then run `psp_bench [--rows N] [--iterations N]`. Each benchmark writes one
+ * JSON object per line to stdout:
+ *
+ *     {"name": "update_indexed", "rows": 100000, "iterations": 10,
+ *      "mean_ms": 12.3, "min_ms": 11.9, "max_ms": 13.1}
+ *
+ * Each benchmark also checks the rows it leaves behind, exiting with an error
+ * if they are wrong, so that a short run (`ctest`) tests the engine paths
+ * the benchmarks time.
+ */
+
+#include <perspective/first.h>
+#include <perspective/base.h>
+#include <perspective/context_one.h>
+#include <perspective/context_two.h>
+#include <perspective/context_zero.h>
+#include <perspective/data_generator.h>
+#include <perspective/data_table.h>
+#include <perspective/pool.h>
+#include <perspective/table.h>
+#include <perspective/view.h>
+#include <perspective/view_config.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace perspective;
+
+namespace {
+
+t_uindex NUM_ROWS = 100000;
+t_uindex NUM_ITERATIONS = 10;
+
+const char* GROUPS[] = {"a", "b", "c", "d", "e", "f", "g", "h", "i", "j", "k", "l", "m", "n",
+    "o", "p"};
+const t_uindex NUM_GROUPS = sizeof(GROUPS) / sizeof(GROUPS[0]);
+
+const std::vector<std::string> COLUMN_NAMES{"id", "x", "g", "h"};
+const std::vector<t_dtype> DATA_TYPES{DTYPE_INT64, DTYPE_FLOAT64, DTYPE_STR, DTYPE_STR};
+
+/**
+ * @brief Write `nrows` generated rows, starting at row `offset`, into a new
+ * `t_data_table` along with the `psp_pkey` and `psp_okey` columns, as the
+ * bindings do before calling `Table::init`.
+ */
+std::shared_ptr<t_data_table>
+make_data(t_uindex nrows, t_uindex offset, bool indexed) {
+    auto data = std::make_shared<t_data_table>(t_schema(COLUMN_NAMES, DATA_TYPES));
+    data->init();
+    data->extend(nrows);
+
+    t_column* id = data->get_column("id").get();
+    t_column* x = data->get_column("x").get();
+    t_column* g = data->get_column("g").get();
+    t_column* h = data->get_column("h").get();
+
+    for (t_uindex ridx = 0; ridx < nrows; ++ridx) {
+        t_uindex row = ridx + offset;
+        id->set_nth<std::int64_t>(ridx, row);
+        x->set_nth<double>(ridx, static_cast<double>((row * 7919) % 10007) / 10007.0);
+        g->set_nth<const char*>(ridx, GROUPS[row % NUM_GROUPS]);
+        h->set_nth<const char*>(ridx, GROUPS[(row / NUM_GROUPS) % 8]);
+    }
+
+    if (indexed) {
+        data->clone_column("id", "psp_pkey");
+        data->clone_column("id", "psp_okey");
+    } else {
+        auto pkey = data->add_column("psp_pkey", DTYPE_INT32, true);
+        auto okey = data->add_column("psp_okey", DTYPE_INT32, true);
+        for (t_uindex ridx = 0; ridx < nrows; ++ridx) {
+            pkey->set_nth<std::int32_t>(ridx, ridx + offset);
+            okey->set_nth<std::int32_t>(ridx, ridx + offset);
+        }
+    }
+
+    return data;
+}
+
+std::shared_ptr<Table>
+make_table(bool indexed) {
+    auto pool = std::make_shared<t_pool>();
+    auto table = std::make_shared<Table>(pool, COLUMN_NAMES, DATA_TYPES,
+        std::numeric_limits<std::uint32_t>::max(), indexed ? "id" : "");
+    return table;
+}
+
+/**
+ * @brief Send `nrows` rows starting at row `offset` to `table`, and process
+ * them through the gnode and every registered context.
+ */
+void
+update(std::shared_ptr<Table> table, t_uindex nrows, t_uindex offset) {
+    auto data = make_data(nrows, offset, table->get_index() != "");
+    table->init(data, nrows, OP_INSERT, 0);
+    table->get_pool()->_process();
+}
+
+std::shared_ptr<t_view_config>
+make_view_config(std::shared_ptr<t_schema> schema, const std::vector<std::string>& row_pivots,
+    const std::vector<std::string>& column_pivots,
+    const std::vector<std::tuple<std::string, std::string, std::vector<t_tscalar>>>& filter,
+    const std::vector<std::vector<std::string>>& sort) {
+    tsl::ordered_map<std::string, std::vector<std::string>> aggregates;
+    auto config = std::make_shared<t_view_config>(row_pivots, column_pivots, aggregates,
+        std::vector<std::string>{"id", "x", "g", "h"}, filter, sort,
+        std::vector<t_computed_column_definition>{}, "and", false);
+    config->init(schema);
+    return config;
+}
+
+// Mirrors `make_context` in the bindings.
+std::shared_ptr<View<t_ctx0>>
+make_view_zero(std::shared_ptr<Table> table, const std::string& name,
+    std::shared_ptr<t_view_config> config) {
+    auto schema = std::make_shared<t_schema>(table->get_schema());
+    auto ctx = std::make_shared<t_ctx0>(*schema,
+        t_config(config->get_columns(), config->get_fterm(), config->get_filter_op(),
+            config->get_computed_columns()));
+    ctx->init();
+    ctx->sort_by(config->get_sortspec());
+    table->get_pool()->register_context(table->get_gnode()->get_id(), name,
+        ZERO_SIDED_CONTEXT, reinterpret_cast<std::uintptr_t>(ctx.get()));
+    return std::make_shared<View<t_ctx0>>(table, ctx, name, "|", config);
+}
+
+std::shared_ptr<View<t_ctx1>>
+make_view_one(std::shared_ptr<Table> table, const std::string& name,
+    std::shared_ptr<t_view_config> config) {
+    auto schema = std::make_shared<t_schema>(table->get_schema());
+    auto ctx = std::make_shared<t_ctx1>(*schema,
+        t_config(config->get_row_pivots(), config->get_aggspecs(), config->get_fterm(),
+            config->get_filter_op(), config->get_computed_columns()));
+    ctx->init();
+    ctx->sort_by(config->get_sortspec());
+    table->get_pool()->register_context(table->get_gnode()->get_id(), name,
+        ONE_SIDED_CONTEXT, reinterpret_cast<std::uintptr_t>(ctx.get()));
+    ctx->set_depth(config->get_row_pivots().size());
+    return std::make_shared<View<t_ctx1>>(table, ctx, name, "|", config);
+}
+
+std::shared_ptr<View<t_ctx2>>
+make_view_two(std::shared_ptr<Table> table, const std::string& name,
+    std::shared_ptr<t_view_config> config) {
+    auto schema = std::make_shared<t_schema>(table->get_schema());
+    auto ctx = std::make_shared<t_ctx2>(*schema,
+        t_config(config->get_row_pivots(), config->get_column_pivots(),
+            config->get_aggspecs(), TOTALS_HIDDEN, config->get_fterm(),
+            config->get_filter_op(), config->get_computed_columns(), false));
+    ctx->init();
+    table->get_pool()->register_context(table->get_gnode()->get_id(), name,
+        TWO_SIDED_CONTEXT, reinterpret_cast<std::uintptr_t>(ctx.get()));
+    ctx->set_depth(t_header::HEADER_ROW, config->get_row_pivots().size());
+    ctx->set_depth(t_header::HEADER_COLUMN, config->get_column_pivots().size());
+    return std::make_shared<View<t_ctx2>>(table, ctx, name, "|", config);
+}
+
+/**
+ * @brief Exit with an error naming `name` unless `actual` rows are
+ * `expected`.
+ */
+void
+check_rows(const std::string& name, t_uindex actual, t_uindex expected) {
+    if (actual != expected) {
+        std::cerr << name << ": expected " << expected << " rows, got " << actual << std::endl;
+        std::exit(1);
+    }
+}
+
+/**
+ * @brief Time `NUM_ITERATIONS` calls of `run`, each preceded by an untimed
+ * call of `setup`, and print the result as one line of JSON.
+ */
+void
+bench(const std::string& name, std::function<void()> setup, std::function<void()> run) {
+    std::vector<double> times;
+    for (t_uindex idx = 0; idx < NUM_ITERATIONS; ++idx) {
+        setup();
+        auto start = std::chrono::steady_clock::now();
+        run();
+        auto end = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+
+    double total = 0;
+    for (double t : times) {
+        total += t;
+    }
+
+    std::cout << "{\"name\": \"" << name << "\", \"rows\": " << NUM_ROWS
+              << ", \"iterations\": " << NUM_ITERATIONS
+              << ", \"mean_ms\": " << total / times.size()
+              << ", \"min_ms\": " << *std::min_element(times.begin(), times.end())
+              << ", \"max_ms\": " << *std::max_element(times.begin(), times.end()) << "}"
+              << std::endl;
+}
+
+/**
+ * @brief Time updating half of the rows of a table with `NUM_ROWS` rows and
+ * the views made by `make_views`, which are notified on every update.
+ */
+void
+bench_notify(const std::string& name, bool indexed,
+    std::function<void(std::shared_ptr<Table>)> make_views) {
+    std::shared_ptr<Table> table;
+    bench(name,
+        [&]() {
+            table = make_table(indexed);
+            update(table, NUM_ROWS, 0);
+            make_views(table);
+        },
+        [&]() { update(table, NUM_ROWS / 2, NUM_ROWS / 4); });
+
+    // The updated rows replace rows of the same keys.
+    check_rows(name, table->size(), NUM_ROWS);
+}
+
+} // namespace
+
+int
+main(int argc, char** argv) {
+    for (int idx = 1; idx + 1 < argc; idx += 2) {
+        if (std::strcmp(argv[idx], "--rows") == 0) {
+            NUM_ROWS = std::strtoull(argv[idx + 1], nullptr, 10);
+        } else if (std::strcmp(argv[idx], "--iterations") == 0) {
+            NUM_ITERATIONS = std::strtoull(argv[idx + 1], nullptr, 10);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--rows N] [--iterations N]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::shared_ptr<Table> table;
+    std::shared_ptr<t_schema> schema
+        = std::make_shared<t_schema>(t_schema(COLUMN_NAMES, DATA_TYPES));
+
+    // Table creation
+    bench("table", [&]() { table = make_table(false); },
+        [&]() { update(table, NUM_ROWS, 0); });
+    check_rows("table", table->size(), NUM_ROWS);
+
+    bench("table_indexed", [&]() { table = make_table(true); },
+        [&]() { update(table, NUM_ROWS, 0); });
+    check_rows("table_indexed", table->size(), NUM_ROWS);
+
+    // Updates, with no contexts
+    bench_notify("update", false, [](std::shared_ptr<Table>) {});
+    bench_notify("update_indexed", true, [](std::shared_ptr<Table>) {});
+
+    // Updates, notifying one context of each type
+    std::shared_ptr<View<t_ctx0>> view0;
+    std::shared_ptr<View<t_ctx1>> view1;
+    std::shared_ptr<View<t_ctx2>> view2;
+
+    // A total row, and a row per group.
+    t_uindex num_group_rows = std::min(NUM_ROWS, NUM_GROUPS) + 1;
+
+    bench_notify("update_ctx0", true, [&](std::shared_ptr<Table> table) {
+        view0 = make_view_zero(table, "ctx0", make_view_config(schema, {}, {}, {}, {}));
+    });
+    check_rows("update_ctx0", view0->num_rows(), NUM_ROWS);
+    view0.reset();
+
+    bench_notify("update_ctx1", true, [&](std::shared_ptr<Table> table) {
+        view1 = make_view_one(table, "ctx1", make_view_config(schema, {"g"}, {}, {}, {}));
+    });
+    check_rows("update_ctx1", view1->num_rows(), num_group_rows);
+    view1.reset();
+
+    bench_notify("update_ctx2", true, [&](std::shared_ptr<Table> table) {
+        view2
+            = make_view_two(table, "ctx2", make_view_config(schema, {"g"}, {"h"}, {}, {}));
+    });
+    check_rows("update_ctx2", view2->num_rows(), num_group_rows);
+    view2.reset();
+
+    // Sorting and filtering, measured as the cost of creating the view
+    auto make_loaded_table = [&]() {
+        view0.reset();
+        view1.reset();
+        table = make_table(true);
+        update(table, NUM_ROWS, 0);
+    };
+
+    bench("sort_ctx0", make_loaded_table, [&]() {
+        view0 = make_view_zero(
+            table, "sort", make_view_config(schema, {}, {}, {}, {{"x", "asc"}}));
+    });
+    check_rows("sort_ctx0", view0->num_rows(), NUM_ROWS);
+
+    bench("sort_ctx1", make_loaded_table, [&]() {
+        view1 = make_view_one(
+            table, "sort", make_view_config(schema, {"g", "h"}, {}, {}, {{"x", "desc"}}));
+    });
+
+    bench("filter_ctx0", make_loaded_table, [&]() {
+        view0 = make_view_zero(table, "filter",
+            make_view_config(schema, {}, {}, {std::make_tuple(std::string("x"),
+                std::string(">"), std::vector<t_tscalar>{mktscalar(0.5)})}, {}));
+    });
+
+    bench("filter_str_ctx0", make_loaded_table, [&]() {
+        view0 = make_view_zero(table, "filter",
+            make_view_config(schema, {}, {}, {std::make_tuple(std::string("g"),
+                std::string("=="), std::vector<t_tscalar>{mktscalar("a")})}, {}));
+    });
+
+    // Group `a` is every `NUM_GROUPS`th row.
+    check_rows("filter_str_ctx0", view0->num_rows(), (NUM_ROWS + NUM_GROUPS - 1) / NUM_GROUPS);
+
+    // Serialization
+    bench("to_arrow_ctx0",
+        [&]() {
+            make_loaded_table();
+            view0 = make_view_zero(table, "arrow", make_view_config(schema, {}, {}, {}, {}));
+        },
+        [&]() { view0->to_arrow(0, view0->num_rows(), 0, view0->num_columns()); });
+
+    bench("to_arrow_ctx1",
+        [&]() {
+            make_loaded_table();
+            view1 = make_view_one(table, "arrow", make_view_config(schema, {"g"}, {}, {}, {}));
+        },
+        [&]() { view1->to_arrow(0, view1->num_rows(), 0, view1->num_columns()); });
+
+    view0.reset();
+    view1.reset();
+
+    // Generating rows directly, with a low-cardinality `g` and `h`, and
+    // inserting, updating and removing them.
+    t_generator_spec spec;
+    spec.m_columns["g"].m_cardinality = NUM_GROUPS;
+    spec.m_columns["h"].m_cardinality = 8;
+    spec.m_columns["h"].m_null_ratio = 0.1;
+    std::shared_ptr<t_data_generator> generator;
+
+    bench("generate", [&]() { generator = std::make_shared<t_data_generator>(spec); },
+        [&]() { generator->make_batch(*schema, "id", NUM_ROWS, 0); });
+
+    bench("generate_mixed_ctx1",
+        [&]() {
+            generator = std::make_shared<t_data_generator>(spec);
+            table = make_table(true);
+            update(table, 0, 0);
+            generator->generate(table, NUM_ROWS, 0, 0, 0);
+            table->get_pool()->_process();
+            view1 = make_view_one(table, "ctx1", make_view_config(schema, {"g"}, {}, {}, {}));
+        },
+        [&]() {
+            generator->generate(table, NUM_ROWS / 10, NUM_ROWS / 2, NUM_ROWS / 10, 0);
+            table->get_pool()->_process();
+        });
+
+    view1.reset();
+    return 0;
+}
@@ -0,0 +1,261 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+/**
+ * Benchmarks for the memory footprint of the engine's structures, as bytes
+ * per entry: per row of a master table column by dtype, null ratio and
+ * string cardinality, per primary key of a `t_gstate`'s mapping, per row of
+ * a `t_ftrav`, and per node of a `t_stree` and its aggregates by number of
+ * aggregates.
+ *
+ * Build with `-DPSP_CPP_BUILD=1 -DPSP_WASM_BUILD=0 -DPSP_CPP_BUILD_BENCH=1`,
+ * then run `psp_memory_bench [--rows N]`. Each benchmark writes one JSON
+ * object per line to stdout:
+ *
+ *     {"name": "column/float64", "entries": 100000, "bytes": 1703936,
+ *      "bytes_per_entry": 17.04}
+ *
+ * where bytes are those allocated, as `get_memory_usage` reports them, so
+ * include the spare capacity of each store. The output of two versions can
+ * be diffed by name to see where the footprint changed. A benchmark exits
+ * with an error if its structure does not hold the entries it expects.
+ */
+
+#include <perspective/first.h>
+#include <perspective/base.h>
+#include <perspective/context_one.h>
+#include <perspective/context_zero.h>
+#include <perspective/data_generator.h>
+#include <perspective/data_table.h>
+#include <perspective/gnode.h>
+#include <perspective/pool.h>
+#include <perspective/sparse_tree.h>
+#include <perspective/table.h>
+#include <perspective/view.h>
+#include <perspective/view_config.h>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace perspective;
+
+namespace {
+
+t_uindex NUM_ROWS = 100000;
+
+/**
+ * @brief Print `bytes` for `entries` entries as one line of JSON.
+ */
+void
+report(const std::string& name, t_uindex entries, t_uindex bytes) {
+    std::cout << "{\"name\": \"" << name << "\", \"entries\": " << entries
+              << ", \"bytes\": " << bytes << ", \"bytes_per_entry\": "
+              << (entries == 0 ? 0.0 : static_cast<double>(bytes) / entries) << "}"
+              << std::endl;
+}
+
+/**
+ * @brief Exit with an error unless `ok`, the expectation `what` of the
+ * benchmark `name`.
+ */
+void
+check(const std::string& name, bool ok, const std::string& what) {
+    if (!ok) {
+        std::cerr << name << ": expected " << what << std::endl;
+        std::exit(1);
+    }
+}
+
+/**
+ * @brief Returns a table of `schema`, indexed by `index` unless it is `""`,
+ * with `NUM_ROWS` rows generated by `spec` and processed.
+ */
+std::shared_ptr<Table>
+make_table(const t_schema& schema, const std::string& index, const t_generator_spec& spec) {
+    auto pool = std::make_shared<t_pool>();
+    auto table = std::make_shared<Table>(pool, schema.m_columns, schema.m_types,
+        std::numeric_limits<std::uint32_t>::max(), index);
+
+    // Add the primary key columns as the bindings do.
+    t_data_generator generator(spec);
+    auto data = generator.make_batch(schema, index, NUM_ROWS, 0);
+    if (index == "") {
+        auto pkey = data->add_column("psp_pkey", DTYPE_INT32, true);
+        auto okey = data->add_column("psp_okey", DTYPE_INT32, true);
+        for (t_uindex ridx = 0; ridx < data->size(); ++ridx) {
+            pkey->set_nth<std::int32_t>(ridx, ridx);
+            okey->set_nth<std::int32_t>(ridx, ridx);
+        }
+    } else {
+        data->clone_column(index, "psp_pkey");
+        data->clone_column(index, "psp_okey");
+    }
+
+    table->init(data, NUM_ROWS, OP_INSERT, 0);
+    pool->_process();
+    return table;
+}
+
+std::shared_ptr<t_view_config>
+make_view_config(const t_schema& schema, const std::vector<std::string>& row_pivots,
+    const std::vector<std::string>& columns, const std::vector<std::vector<std::string>>& sort) {
+    tsl::ordered_map<std::string, std::vector<std::string>> aggregates;
+    std::vector<std::tuple<std::string, std::string, std::vector<t_tscalar>>> filter;
+    auto config = std::make_shared<t_view_config>(row_pivots, std::vector<std::string>{},
+        aggregates, columns, filter, sort, std::vector<t_computed_column_definition>{}, "and",
+        false);
+    config->init(std::make_shared<t_schema>(schema));
+    return config;
+}
+
+// Mirrors `make_context` in the bindings.
+std::shared_ptr<View<t_ctx0>>
+make_view_zero(std::shared_ptr<Table> table, std::shared_ptr<t_view_config> config) {
+    auto ctx = std::make_shared<t_ctx0>(table->get_schema(),
+        t_config(config->get_columns(), config->get_fterm(), config->get_filter_op(),
+            config->get_computed_columns()));
+    ctx->init();
+    ctx->sort_by(config->get_sortspec());
+    table->get_pool()->register_context(table->get_gnode()->get_id(), "ctx0",
+        ZERO_SIDED_CONTEXT, reinterpret_cast<std::uintptr_t>(ctx.get()));
+    return std::make_shared<View<t_ctx0>>(table, ctx, "ctx0", "|", config);
+}
+
+std::shared_ptr<View<t_ctx1>>
+make_view_one(std::shared_ptr<Table> table, std::shared_ptr<t_view_config> config) {
+    auto ctx = std::make_shared<t_ctx1>(table->get_schema(),
+        t_config(config->get_row_pivots(), config->get_aggspecs(), config->get_fterm(),
+            config->get_filter_op(), config->get_computed_columns()));
+    ctx->init();
+    ctx->sort_by(config->get_sortspec());
+    table->get_pool()->register_context(table->get_gnode()->get_id(), "ctx1",
+        ONE_SIDED_CONTEXT, reinterpret_cast<std::uintptr_t>(ctx.get()));
+    ctx->set_depth(config->get_row_pivots().size());
+    return std::make_shared<View<t_ctx1>>(table, ctx, "ctx1", "|", config);
+}
+
+/**
+ * @brief Report the bytes per row of a master table column of `dtype`,
+ * `null_ratio` of whose rows are null, counting its vocabulary.
+ */
+void
+bench_column(const std::string& name, t_dtype dtype, double null_ratio,
+    t_uindex cardinality = 0, t_uindex string_length = 8) {
+    t_schema schema({"x"}, {dtype});
+    t_generator_spec spec;
+    spec.m_rows = NUM_ROWS;
+    spec.m_columns["x"].m_null_ratio = null_ratio;
+    spec.m_columns["x"].m_cardinality = cardinality;
+    spec.m_columns["x"].m_string_length = string_length;
+
+    auto table = make_table(schema, "", spec);
+    const t_column* column = table->get_gnode()->get_table()->get_const_column("x").get();
+    t_uindex bytes = column->nbytes();
+    if (column->is_vlen()) {
+        bytes += column->_get_vocab()->nbytes();
+    }
+    check(name, column->size() == NUM_ROWS, "a row per generated row");
+    check(name, bytes >= NUM_ROWS * get_dtype_size(dtype), "the bytes of each row's value");
+    report(name, NUM_ROWS, bytes);
+}
+
+/**
+ * @brief Report the bytes per primary key of the mapping of a table keyed
+ * by a column of `dtype`, or by row number if `indexed` is false.
+ */
+void
+bench_mapping(const std::string& name, t_dtype dtype, bool indexed) {
+    t_schema schema({"k", "x"}, {dtype, DTYPE_FLOAT64});
+    t_generator_spec spec;
+    spec.m_rows = NUM_ROWS;
+    auto table = make_table(schema, indexed ? "k" : "", spec);
+    auto gnode = table->get_gnode();
+    check(name, gnode->mapping_size() == NUM_ROWS, "a primary key per generated row");
+    report(name, gnode->mapping_size(), gnode->get_memory_usage()["primary_keys"]);
+}
+
+} // namespace
+
+int
+main(int argc, char** argv) {
+    for (int idx = 1; idx + 1 < argc; idx += 2) {
+        if (std::strcmp(argv[idx], "--rows") == 0) {
+            NUM_ROWS = std::strtoull(argv[idx + 1], nullptr, 10);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--rows N]" << std::endl;
+            return 1;
+        }
+    }
+
+    // Master table columns, by dtype and validity
+    const std::vector<std::pair<std::string, t_dtype>> dtypes{{"int64", DTYPE_INT64},
+        {"int32", DTYPE_INT32}, {"int16", DTYPE_INT16}, {"int8", DTYPE_INT8},
+        {"float64", DTYPE_FLOAT64}, {"float32", DTYPE_FLOAT32}, {"bool", DTYPE_BOOL},
+        {"date", DTYPE_DATE}, {"datetime", DTYPE_TIME}};
+    for (const auto& dtype : dtypes) {
+        bench_column("column/" + dtype.first, dtype.second, 0);
+        bench_column("column/" + dtype.first + "/nulls", dtype.second, 0.5);
+    }
+
+    // Strings, by cardinality and length, where 0 is a value per row
+    for (t_uindex cardinality : {t_uindex(16), t_uindex(1024), t_uindex(0)}) {
+        std::string label = cardinality == 0 ? "unique" : std::to_string(cardinality);
+        bench_column("column/str/cardinality_" + label, DTYPE_STR, 0, cardinality);
+        bench_column(
+            "column/str/cardinality_" + label + "/length_32", DTYPE_STR, 0, cardinality, 32);
+    }
+
+    // Primary key mappings
+    bench_mapping("gstate/mapping/implicit", DTYPE_INT64, false);
+    bench_mapping("gstate/mapping/int64", DTYPE_INT64, true);
+    bench_mapping("gstate/mapping/str", DTYPE_STR, true);
+
+    // Flat traversals, unsorted and sorted, per row
+    t_schema schema({"k", "p", "a", "b", "c", "d"},
+        {DTYPE_INT64, DTYPE_INT64, DTYPE_FLOAT64, DTYPE_FLOAT64, DTYPE_FLOAT64, DTYPE_FLOAT64});
+    t_generator_spec spec;
+    spec.m_rows = NUM_ROWS;
+    spec.m_columns["p"].m_cardinality = NUM_ROWS / 4;
+    auto table = make_table(schema, "k", spec);
+
+    {
+        auto view = make_view_zero(table, make_view_config(schema, {}, {"a"}, {}));
+        check("ftrav/unsorted", static_cast<t_uindex>(view->num_rows()) == NUM_ROWS,
+            "a row per table row");
+        report("ftrav/unsorted", view->num_rows(), view->get_memory_usage()["traversal"]);
+    }
+
+    {
+        auto view = make_view_zero(table, make_view_config(schema, {}, {"a"}, {{"a", "asc"}}));
+        check("ftrav/sorted", static_cast<t_uindex>(view->num_rows()) == NUM_ROWS,
+            "a row per table row");
+        report("ftrav/sorted", view->num_rows(), view->get_memory_usage()["traversal"]);
+    }
+
+    // Trees of a pivot with a node per 4 rows, per node, by number of
+    // aggregates
+    const std::vector<std::string> aggregated{"a", "b", "c", "d"};
+    for (t_uindex naggs = 1; naggs <= aggregated.size(); naggs *= 2) {
+        std::vector<std::string> columns(aggregated.begin(), aggregated.begin() + naggs);
+        auto view = make_view_one(table, make_view_config(schema, {"p"}, columns, {}));
+        t_uindex nodes = view->get_context()->get_tree()->size();
+        auto usage = view->get_memory_usage();
+        std::string label = "stree/aggregates_" + std::to_string(naggs);
+        check(label, nodes > 1 && nodes <= NUM_ROWS / 4 + 1, "a node per value of the pivot");
+        check(label, usage["aggregates"] > 0, "aggregates for each node");
+        report(label + "/nodes", nodes, usage["tree"]);
+        report(label + "/aggregates", nodes, usage["aggregates"]);
+    }
+
+    return 0;
+}
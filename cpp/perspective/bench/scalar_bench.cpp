@@ -0,0 +1,224 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+/**
+ * Microbenchmarks for `t_tscalar`'s `operator==`, `operator<`, hash and `add`,
+ * which dispatch on dtype at runtime, against the `t_tscalar_ops` variants
+ * for a dtype known at compile time.
+ *
+ * Build with `-DPSP_CPP_BUILD=1 -DPSP_WASM_BUILD=0 -DPSP_CPP_BUILD_BENCH=1`,
+ * then run `psp_scalar_bench [--size N] [--iterations N]`. Each benchmark
+ * writes one JSON object per line to stdout:
+ *
+ *     {"name": "eq/int64/generic", "size": 65536, "iterations": 20,
+ *      "mean_ns": 2.1, "min_ns": 2.0, "max_ns": 2.4}
+ *
+ * where the times are per operation. Before timing an operation, it exits
+ * with an error if the generic and typed forms disagree on any pair.
+ * Strings are benchmarked both short enough to be stored inplace, and
+ * interned, i.e. a pointer to characters owned elsewhere, as the scalars
+ * read from a column's vocabulary are.
+ */
+
+#include <perspective/first.h>
+#include <perspective/base.h>
+#include <perspective/scalar.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace perspective;
+
+namespace {
+
+t_uindex NUM_SCALARS = 1 << 16;
+t_uindex NUM_ITERATIONS = 20;
+
+// Read by every benchmark, so that its operations are not optimized away.
+volatile std::size_t SINK = 0;
+
+// The characters of interned strings, which are too long to store inplace.
+std::vector<std::string> INTERNED;
+
+/**
+ * @brief Returns the `idx`th value of a column of `dtype`, from a domain
+ * small enough that some pairs of values are equal.
+ */
+t_tscalar
+make_scalar(t_dtype dtype, bool inplace, t_uindex idx) {
+    t_uindex v = (idx * 2654435761u) % 1024;
+    switch (dtype) {
+        case DTYPE_INT64: return mktscalar<std::int64_t>(v);
+        case DTYPE_INT32: return mktscalar<std::int32_t>(v);
+        case DTYPE_FLOAT64: return mktscalar<double>(v * 0.5);
+        case DTYPE_FLOAT32: return mktscalar<float>(v * 0.5f);
+        case DTYPE_BOOL: return mktscalar<bool>(v % 2 == 0);
+        case DTYPE_DATE: return mktscalar(t_date(2000 + v % 20, v % 12, 1 + v % 28));
+        case DTYPE_TIME: return mktscalar(t_time(1500000000000 + v * 1000));
+        case DTYPE_STR: {
+            const std::string& s = INTERNED[v];
+            return mktscalar(inplace ? s.c_str() + s.size() - 8 : s.c_str());
+        }
+        default: { PSP_COMPLAIN_AND_ABORT("Unexpected dtype"); }
+    }
+    return mktscalar();
+}
+
+/**
+ * @brief Time `NUM_ITERATIONS` passes of `op` over each pair of `lhs` and
+ * `rhs`, and print the time per operation as one line of JSON.
+ */
+template <typename OP_T>
+void
+bench(const std::string& name, const std::vector<t_tscalar>& lhs,
+    const std::vector<t_tscalar>& rhs, OP_T op) {
+    std::vector<double> times;
+    std::size_t acc = 0;
+    for (t_uindex iter = 0; iter < NUM_ITERATIONS; ++iter) {
+        auto start = std::chrono::steady_clock::now();
+        for (t_uindex idx = 0; idx < lhs.size(); ++idx) {
+            acc += op(lhs[idx], rhs[idx]);
+        }
+        auto end = std::chrono::steady_clock::now();
+        times.push_back(
+            std::chrono::duration<double, std::nano>(end - start).count() / lhs.size());
+    }
+    SINK = SINK + acc;
+
+    double total = 0;
+    for (double t : times) {
+        total += t;
+    }
+
+    std::cout << "{\"name\": \"" << name << "\", \"size\": " << lhs.size()
+              << ", \"iterations\": " << NUM_ITERATIONS
+              << ", \"mean_ns\": " << total / times.size()
+              << ", \"min_ns\": " << *std::min_element(times.begin(), times.end())
+              << ", \"max_ns\": " << *std::max_element(times.begin(), times.end()) << "}"
+              << std::endl;
+}
+
+/**
+ * @brief Exit with an error unless the generic and typed forms of an
+ * operation agree on every pair of `lhs` and `rhs`, since the engine mixes
+ * the two.
+ */
+template <typename GENERIC_T, typename TYPED_T>
+void
+check_agree(const std::string& name, const std::vector<t_tscalar>& lhs,
+    const std::vector<t_tscalar>& rhs, GENERIC_T generic, TYPED_T typed) {
+    for (t_uindex idx = 0; idx < lhs.size(); ++idx) {
+        if (generic(lhs[idx], rhs[idx]) != typed(lhs[idx], rhs[idx])) {
+            std::cerr << name << ": generic and typed disagree on " << lhs[idx] << ", "
+                      << rhs[idx] << std::endl;
+            std::exit(1);
+        }
+    }
+}
+
+/**
+ * @brief Benchmark `operator==`, `operator<` and the hash of scalars of
+ * `DTYPE_T`, generic and typed, and `add` where `ADD` is set.
+ */
+template <t_dtype DTYPE_T, bool ADD>
+struct t_bench_dtype {
+    static void
+    run(const std::string& label, bool inplace = false) {
+        std::vector<t_tscalar> lhs(NUM_SCALARS);
+        std::vector<t_tscalar> rhs(NUM_SCALARS);
+        for (t_uindex idx = 0; idx < NUM_SCALARS; ++idx) {
+            lhs[idx] = make_scalar(DTYPE_T, inplace, idx);
+            rhs[idx] = make_scalar(DTYPE_T, inplace, idx * 7 + 3);
+        }
+
+        typedef t_tscalar_ops<DTYPE_T> t_ops;
+        std::hash<t_tscalar> hasher;
+
+        check_agree("eq/" + label, lhs, rhs,
+            [](const t_tscalar& a, const t_tscalar& b) { return a == b; },
+            [](const t_tscalar& a, const t_tscalar& b) { return t_ops::eq(a, b); });
+        check_agree("lt/" + label, lhs, rhs,
+            [](const t_tscalar& a, const t_tscalar& b) { return a < b; },
+            [](const t_tscalar& a, const t_tscalar& b) { return t_ops::lt(a, b); });
+        check_agree("hash/" + label, lhs, rhs,
+            [&hasher](const t_tscalar& a, const t_tscalar&) { return hasher(a); },
+            [](const t_tscalar& a, const t_tscalar&) { return t_ops::hash(a); });
+
+        bench("eq/" + label + "/generic", lhs, rhs,
+            [](const t_tscalar& a, const t_tscalar& b) { return a == b; });
+        bench("eq/" + label + "/typed", lhs, rhs,
+            [](const t_tscalar& a, const t_tscalar& b) { return t_ops::eq(a, b); });
+        bench("lt/" + label + "/generic", lhs, rhs,
+            [](const t_tscalar& a, const t_tscalar& b) { return a < b; });
+        bench("lt/" + label + "/typed", lhs, rhs,
+            [](const t_tscalar& a, const t_tscalar& b) { return t_ops::lt(a, b); });
+        bench("hash/" + label + "/generic", lhs, rhs,
+            [&hasher](const t_tscalar& a, const t_tscalar&) { return hasher(a); });
+        bench("hash/" + label + "/typed", lhs, rhs,
+            [](const t_tscalar& a, const t_tscalar&) { return t_ops::hash(a); });
+        run_add(label, lhs, rhs, std::integral_constant<bool, ADD>());
+    }
+
+    static void
+    run_add(const std::string&, const std::vector<t_tscalar>&,
+        const std::vector<t_tscalar>&, std::false_type) {}
+
+    static void
+    run_add(const std::string& label, const std::vector<t_tscalar>& lhs,
+        const std::vector<t_tscalar>& rhs, std::true_type) {
+        typedef t_tscalar_ops<DTYPE_T> t_ops;
+        check_agree("add/" + label, lhs, rhs,
+            [](const t_tscalar& a, const t_tscalar& b) { return a.add(b); },
+            [](const t_tscalar& a, const t_tscalar& b) { return t_ops::add(a, b); });
+        bench("add/" + label + "/generic", lhs, rhs, [](const t_tscalar& a, const t_tscalar& b) {
+            return a.add(b).m_data.m_uint64;
+        });
+        bench("add/" + label + "/typed", lhs, rhs, [](const t_tscalar& a, const t_tscalar& b) {
+            return t_ops::add(a, b).m_data.m_uint64;
+        });
+    }
+};
+
+} // namespace
+
+int
+main(int argc, char** argv) {
+    for (int idx = 1; idx + 1 < argc; idx += 2) {
+        if (std::strcmp(argv[idx], "--size") == 0) {
+            NUM_SCALARS = std::strtoull(argv[idx + 1], nullptr, 10);
+        } else if (std::strcmp(argv[idx], "--iterations") == 0) {
+            NUM_ITERATIONS = std::strtoull(argv[idx + 1], nullptr, 10);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--size N] [--iterations N]" << std::endl;
+            return 1;
+        }
+    }
+
+    // Strings share a long prefix, so comparing them reads past it; their
+    // last 8 characters are distinct, and short enough to store inplace.
+    for (t_uindex idx = 0; idx < 1024; ++idx) {
+        std::string digits = std::to_string(10000000 + idx);
+        INTERNED.push_back("perspective-interned-" + digits);
+    }
+
+    t_bench_dtype<DTYPE_INT64, true>::run("int64");
+    t_bench_dtype<DTYPE_INT32, true>::run("int32");
+    t_bench_dtype<DTYPE_FLOAT64, true>::run("float64");
+    t_bench_dtype<DTYPE_FLOAT32, true>::run("float32");
+    t_bench_dtype<DTYPE_BOOL, false>::run("bool");
+    t_bench_dtype<DTYPE_DATE, false>::run("date");
+    t_bench_dtype<DTYPE_TIME, false>::run("datetime");
+    t_bench_dtype<DTYPE_STR, false>::run("str_inplace", true);
+    t_bench_dtype<DTYPE_STR, false>::run("str_interned", false);
+    return 0;
+}
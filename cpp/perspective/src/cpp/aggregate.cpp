@@ -114,7 +114,7 @@ t_aggregate::init() {
             switch (m_icolumns[0]->get_dtype()) {
                 case DTYPE_STR: {
                     build_aggregate<
-                        t_aggimpl_count<std::uint64_t, std::uint64_t, std::uint64_t>>();
+                        t_aggimpl_count<t_stridx, std::uint64_t, std::uint64_t>>();
                 } break;
                 case DTYPE_TIME:
                 case DTYPE_INT64: {
@@ -65,6 +65,22 @@ t_aggspec::t_aggspec(const std::string& aggname, const std::string& disp_aggname
     , m_agg_one_weight(agg_one_weight)
     , m_agg_two_weight(agg_two_weight) {}
 
+t_aggspec::t_aggspec(const std::string& aggname, t_aggtype agg,
+    const std::vector<t_dep>& dependencies, double param)
+    : m_name(aggname)
+    , m_disp_name(aggname)
+    , m_agg(agg)
+    , m_dependencies(dependencies)
+    , m_param(param) {}
+
+t_aggspec::t_aggspec(const std::string& aggname, t_aggtype agg,
+    const std::vector<t_dep>& dependencies, const std::string& kernel)
+    : m_name(aggname)
+    , m_disp_name(aggname)
+    , m_agg(agg)
+    , m_dependencies(dependencies)
+    , m_kernel(kernel) {}
+
 t_aggspec::~t_aggspec() {}
 
 std::string
@@ -122,6 +138,12 @@ t_aggspec::agg_str() const {
         case AGGTYPE_MEDIAN: {
             return "median";
         } break;
+        case AGGTYPE_MIN: {
+            return "min";
+        } break;
+        case AGGTYPE_MAX: {
+            return "max";
+        } break;
         case AGGTYPE_JOIN: {
             return "join";
         } break;
@@ -167,9 +189,8 @@ t_aggspec::agg_str() const {
             return ss.str();
         }
         case AGGTYPE_UDF_REDUCER: {
-
             std::stringstream ss;
-            ss << "udf_reducer_" << disp_name();
+            ss << "udf_reducer_" << (m_kernel.empty() ? disp_name() : m_kernel);
             return ss.str();
         }
         case AGGTYPE_SUM_NOT_NULL: {
@@ -184,6 +205,24 @@ t_aggspec::agg_str() const {
         case AGGTYPE_DISTINCT_COUNT: {
             return "distinct_count";
         }
+        case AGGTYPE_APPROX_DISTINCT_COUNT: {
+            return "approx_distinct_count";
+        }
+        case AGGTYPE_APPROX_PERCENTILE: {
+            return "approx_percentile";
+        }
+        case AGGTYPE_ROLLING_SUM: {
+            return "rolling_sum";
+        }
+        case AGGTYPE_ROLLING_COUNT: {
+            return "rolling_count";
+        }
+        case AGGTYPE_ROLLING_MEAN: {
+            return "rolling_mean";
+        }
+        case AGGTYPE_ROLLING_WEIGHTED_MEAN: {
+            return "rolling_weighted_mean";
+        }
         case AGGTYPE_DISTINCT_LEAF: {
             return "distinct_leaf";
         }
@@ -256,6 +295,21 @@ t_aggspec::get_agg_two_weight() const {
     return m_agg_two_weight;
 }
 
+double
+t_aggspec::get_quantile() const {
+    return m_param;
+}
+
+double
+t_aggspec::get_window() const {
+    return m_param;
+}
+
+const std::string&
+t_aggspec::get_kernel() const {
+    return m_kernel;
+}
+
 t_invmode
 t_aggspec::get_inv_mode() const {
     return m_invmode;
@@ -296,6 +350,8 @@ t_aggspec::get_output_specs(const t_schema& schema) const {
         case AGGTYPE_UNIQUE:
         case AGGTYPE_DOMINANT:
         case AGGTYPE_MEDIAN:
+        case AGGTYPE_MIN:
+        case AGGTYPE_MAX:
         case AGGTYPE_FIRST:
         case AGGTYPE_LAST:
         case AGGTYPE_OR:
@@ -329,8 +385,10 @@ t_aggspec::get_output_specs(const t_schema& schema) const {
         case AGGTYPE_SCALED_MUL: {
             return mk_col_name_type_vec(name(), DTYPE_FLOAT64);
         }
-        case AGGTYPE_UDF_COMBINER:
         case AGGTYPE_UDF_REDUCER: {
+            return mk_col_name_type_vec(name(), DTYPE_FLOAT64);
+        }
+        case AGGTYPE_UDF_COMBINER: {
             std::vector<t_col_name_type> rval;
             for (const auto& d : m_odependencies) {
                 t_col_name_type tp(d.name(), d.dtype());
@@ -341,7 +399,17 @@ t_aggspec::get_output_specs(const t_schema& schema) const {
         case AGGTYPE_AND: {
             return mk_col_name_type_vec(name(), DTYPE_BOOL);
         }
-        case AGGTYPE_DISTINCT_COUNT: {
+        case AGGTYPE_APPROX_PERCENTILE:
+        case AGGTYPE_ROLLING_SUM:
+        case AGGTYPE_ROLLING_MEAN:
+        case AGGTYPE_ROLLING_WEIGHTED_MEAN: {
+            return mk_col_name_type_vec(name(), DTYPE_FLOAT64);
+        }
+        case AGGTYPE_ROLLING_COUNT: {
+            return mk_col_name_type_vec(name(), DTYPE_INT64);
+        }
+        case AGGTYPE_DISTINCT_COUNT:
+        case AGGTYPE_APPROX_DISTINCT_COUNT: {
             return mk_col_name_type_vec(name(), DTYPE_UINT32);
         }
         default: { PSP_COMPLAIN_AND_ABORT("Unknown agg type"); }
@@ -382,6 +450,109 @@ t_aggspec::is_non_delta() const {
     return false;
 }
 
+bool
+t_aggspec::is_running_agg() const {
+    switch (m_agg) {
+        case AGGTYPE_MEAN:
+        case AGGTYPE_WEIGHTED_MEAN: {
+            return true;
+        }
+        default:
+            return false;
+    }
+    return false;
+}
+
+std::string
+t_aggspec::get_running_nr_name() const {
+    return "psp_running_nr|" + m_name;
+}
+
+std::string
+t_aggspec::get_running_dr_name() const {
+    return "psp_running_dr|" + m_name;
+}
+
+bool
+t_aggspec::is_multiset_agg() const {
+    switch (m_agg) {
+        case AGGTYPE_MEDIAN:
+        case AGGTYPE_MIN:
+        case AGGTYPE_MAX:
+        case AGGTYPE_UNIQUE:
+        case AGGTYPE_DISTINCT_COUNT:
+        case AGGTYPE_DOMINANT: {
+            return true;
+        }
+        default:
+            return false;
+    }
+    return false;
+}
+
+bool
+t_aggspec::is_sketch_agg() const {
+    return m_agg == AGGTYPE_APPROX_DISTINCT_COUNT || m_agg == AGGTYPE_APPROX_PERCENTILE;
+}
+
+bool
+t_aggspec::is_rolling_agg() const {
+    switch (m_agg) {
+        case AGGTYPE_ROLLING_SUM:
+        case AGGTYPE_ROLLING_COUNT:
+        case AGGTYPE_ROLLING_MEAN:
+        case AGGTYPE_ROLLING_WEIGHTED_MEAN: {
+            return true;
+        }
+        default:
+            return false;
+    }
+    return false;
+}
+
+std::string
+t_aggspec::get_rolling_name(const std::string& field) const {
+    return "psp_rolling_" + field + "|" + m_name;
+}
+
+bool
+t_aggspec::is_leaf_scan_agg() const {
+    switch (m_agg) {
+        case AGGTYPE_OR:
+        case AGGTYPE_ANY:
+        case AGGTYPE_AND:
+        case AGGTYPE_JOIN:
+        case AGGTYPE_FIRST:
+        case AGGTYPE_LAST:
+        case AGGTYPE_SUM_NOT_NULL:
+        case AGGTYPE_SUM_ABS:
+        case AGGTYPE_ABS_SUM:
+        case AGGTYPE_MUL:
+        case AGGTYPE_DISTINCT_LEAF:
+        case AGGTYPE_UDF_REDUCER: {
+            return true;
+        }
+        default:
+            return false;
+    }
+    return false;
+}
+
+std::string
+t_aggspec::get_multiset_add_name() const {
+    return "psp_multiset_add|" + m_name;
+}
+
+std::string
+t_aggspec::get_multiset_sub_name() const {
+    return "psp_multiset_sub|" + m_name;
+}
+
+std::string
+t_aggspec::get_multiset_op_name() const {
+    return "psp_multiset_op|" + m_name;
+}
+
 std::string
 t_aggspec::get_first_depname() const {
     if (m_dependencies.empty())
@@ -0,0 +1,113 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2017, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#include <perspective/first.h>
+#include <perspective/base.h>
+#include <perspective/alloc_stats.h>
+#include <perspective/env_vars.h>
+
+namespace perspective {
+
+namespace {
+    const char* ALLOC_OWNER_NAMES[ALLOC_OWNER_NUM_OWNERS] = {"other", "master_table",
+        "input_port", "transitional", "aggregate", "vocab"};
+
+    const char* ALLOC_OP_NAMES[ALLOC_OP_NUM_OPS]
+        = {"init", "reserve", "extend", "shrink", "clone", "free"};
+
+    struct t_owner_counters {
+        std::atomic<std::int64_t> m_ops[ALLOC_OP_NUM_OPS];
+        std::atomic<std::int64_t> m_allocated_bytes;
+        std::atomic<std::int64_t> m_freed_bytes;
+        std::atomic<std::int64_t> m_live_bytes;
+        std::atomic<std::int64_t> m_high_water_bytes;
+    };
+
+    t_owner_counters*
+    get_counters() {
+        // Zero-initialized, as it has static storage duration.
+        static t_owner_counters counters[ALLOC_OWNER_NUM_OWNERS];
+        return counters;
+    }
+
+    void
+    add_live(t_owner_counters& counters, std::int64_t delta) {
+        std::int64_t live
+            = counters.m_live_bytes.fetch_add(delta, std::memory_order_relaxed) + delta;
+        std::int64_t high_water = counters.m_high_water_bytes.load(std::memory_order_relaxed);
+        while (live > high_water
+            && !counters.m_high_water_bytes.compare_exchange_weak(
+                high_water, live, std::memory_order_relaxed)) {
+        }
+    }
+} // namespace
+
+std::atomic<bool> t_alloc_stats::ENABLED(t_env::alloc_stats());
+
+void
+t_alloc_stats::set_enabled(bool enabled) {
+    ENABLED.store(enabled, std::memory_order_relaxed);
+}
+
+void
+t_alloc_stats::record(t_alloc_owner owner, t_alloc_op op, std::int64_t delta) {
+    t_owner_counters& counters = get_counters()[owner];
+    counters.m_ops[op].fetch_add(1, std::memory_order_relaxed);
+    if (delta > 0) {
+        counters.m_allocated_bytes.fetch_add(delta, std::memory_order_relaxed);
+    } else if (delta < 0) {
+        counters.m_freed_bytes.fetch_add(-delta, std::memory_order_relaxed);
+    }
+    add_live(counters, delta);
+}
+
+void
+t_alloc_stats::transfer(t_alloc_owner from, t_alloc_owner to, std::int64_t bytes) {
+    if (from == to || bytes == 0) {
+        return;
+    }
+
+    add_live(get_counters()[from], -bytes);
+    add_live(get_counters()[to], bytes);
+}
+
+std::map<std::string, double>
+t_alloc_stats::get_stats() {
+    std::map<std::string, double> rv;
+    t_owner_counters* counters = get_counters();
+    for (t_uindex owner = 0; owner < ALLOC_OWNER_NUM_OWNERS; ++owner) {
+        const t_owner_counters& c = counters[owner];
+        std::string prefix = std::string(ALLOC_OWNER_NAMES[owner]) + ".";
+        for (t_uindex op = 0; op < ALLOC_OP_NUM_OPS; ++op) {
+            rv[prefix + ALLOC_OP_NAMES[op]] = c.m_ops[op].load(std::memory_order_relaxed);
+        }
+        rv[prefix + "allocated_bytes"] = c.m_allocated_bytes.load(std::memory_order_relaxed);
+        rv[prefix + "freed_bytes"] = c.m_freed_bytes.load(std::memory_order_relaxed);
+        rv[prefix + "live_bytes"] = c.m_live_bytes.load(std::memory_order_relaxed);
+        rv[prefix + "high_water_bytes"] = c.m_high_water_bytes.load(std::memory_order_relaxed);
+    }
+    return rv;
+}
+
+void
+t_alloc_stats::reset() {
+    t_owner_counters* counters = get_counters();
+    for (t_uindex owner = 0; owner < ALLOC_OWNER_NUM_OWNERS; ++owner) {
+        t_owner_counters& c = counters[owner];
+        for (t_uindex op = 0; op < ALLOC_OP_NUM_OPS; ++op) {
+            c.m_ops[op].store(0, std::memory_order_relaxed);
+        }
+        c.m_allocated_bytes.store(0, std::memory_order_relaxed);
+        c.m_freed_bytes.store(0, std::memory_order_relaxed);
+        c.m_live_bytes.store(0, std::memory_order_relaxed);
+        c.m_high_water_bytes.store(0, std::memory_order_relaxed);
+    }
+}
+
+} // end namespace perspective
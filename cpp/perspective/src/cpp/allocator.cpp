@@ -0,0 +1,365 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#include <perspective/first.h>
+#include <perspective/allocator.h>
+#include <perspective/env_vars.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace perspective {
+
+namespace {
+    std::mutex DEFAULT_MTX;
+    std::shared_ptr<t_allocator> DEFAULT;
+    bool DEFAULT_USER_SET = false;
+    thread_local std::shared_ptr<t_allocator> CURRENT;
+
+    bool
+    is_power_of_two(t_uindex n) {
+        return n != 0 && !(n & (n - 1));
+    }
+} // namespace
+
+t_allocator::~t_allocator() {}
+
+void*
+t_allocator::reallocate(void* ptr, t_uindex nbytes, t_uindex new_nbytes, t_uindex alignment) {
+    void* rval = allocate(new_nbytes, alignment, false);
+    if (!rval) {
+        return nullptr;
+    }
+
+    std::memcpy(rval, ptr, size_t(std::min(nbytes, new_nbytes)));
+    deallocate(ptr, nbytes, alignment);
+    return rval;
+}
+
+t_uindex
+t_allocator::good_size(t_uindex nbytes) const {
+    return nbytes;
+}
+
+t_uindex
+t_allocator::reserved_nbytes() const {
+    return 0;
+}
+
+std::shared_ptr<t_allocator>
+t_allocator::make(const std::string& name) {
+    if (name == "system") {
+        return std::make_shared<t_system_allocator>();
+    }
+
+    if (name == "arena") {
+        return std::make_shared<t_arena_allocator>();
+    }
+
+    PSP_COMPLAIN_AND_ABORT("Unknown allocator `" + name + "`");
+    return nullptr;
+}
+
+std::shared_ptr<t_allocator>
+t_allocator::get_default() {
+    std::lock_guard<std::mutex> lk(DEFAULT_MTX);
+    if (!DEFAULT) {
+        DEFAULT = std::make_shared<t_system_allocator>();
+    }
+    return DEFAULT;
+}
+
+void
+t_allocator::set_default(std::shared_ptr<t_allocator> allocator) {
+    PSP_VERBOSE_ASSERT(allocator, "Setting a null allocator");
+    std::lock_guard<std::mutex> lk(DEFAULT_MTX);
+    DEFAULT = allocator;
+    DEFAULT_USER_SET = true;
+}
+
+std::shared_ptr<t_allocator>
+t_allocator::for_gnode() {
+    {
+        std::lock_guard<std::mutex> lk(DEFAULT_MTX);
+        if (!DEFAULT_USER_SET && t_env::allocator() == "arena") {
+            return std::make_shared<t_arena_allocator>();
+        }
+    }
+
+    return get_default();
+}
+
+std::shared_ptr<t_allocator>
+t_allocator::current() {
+    if (CURRENT) {
+        return CURRENT;
+    }
+    return get_default();
+}
+
+void*
+t_system_allocator::allocate(t_uindex nbytes, t_uindex alignment, bool zero) {
+    void* base = nullptr;
+
+    if (alignment < 2) {
+        base = zero ? calloc(size_t(nbytes), 1) : malloc(size_t(nbytes));
+    } else {
+#ifdef _MSC_VER
+        base = _aligned_malloc(size_t(nbytes), size_t(alignment));
+#else
+        int result = posix_memalign(
+            &base, std::max(sizeof(void*), size_t(alignment)), size_t(nbytes));
+        if (result != 0)
+            base = nullptr;
+#endif
+        if (base && zero)
+            std::memset(base, 0, size_t(nbytes));
+    }
+
+    return base;
+}
+
+void
+t_system_allocator::deallocate(void* ptr, t_uindex nbytes, t_uindex alignment) {
+#ifdef _MSC_VER
+    if (alignment >= 2) {
+        _aligned_free(ptr);
+        return;
+    }
+#endif // _MSC_VER
+
+    free(ptr);
+}
+
+void*
+t_system_allocator::reallocate(
+    void* ptr, t_uindex nbytes, t_uindex new_nbytes, t_uindex alignment) {
+    if (alignment < 2) {
+        return realloc(ptr, size_t(new_nbytes));
+    }
+
+#ifdef _MSC_VER
+    return _aligned_realloc(ptr, size_t(new_nbytes), size_t(alignment));
+#else
+    // realloc() does not promise to keep the alignment, but keeps it when it
+    // grows the block in place, as it does for large blocks, which it
+    // remaps; only a block it moved off alignment is copied again.
+    void* rval = realloc(ptr, size_t(new_nbytes));
+    if (!rval || (reinterpret_cast<std::uintptr_t>(rval) & (alignment - 1)) == 0) {
+        return rval;
+    }
+
+    void* aligned = allocate(new_nbytes, alignment, false);
+    if (aligned) {
+        std::memcpy(aligned, rval, size_t(std::min(nbytes, new_nbytes)));
+    }
+    free(rval);
+    return aligned;
+#endif
+}
+
+std::string
+t_system_allocator::name() const {
+    return "system";
+}
+
+const t_uindex t_arena_allocator::MIN_BLOCK_NBYTES = 64;
+
+t_arena_allocator::t_arena_allocator()
+    : t_arena_allocator(t_env::arena_chunk_size()) {}
+
+t_arena_allocator::t_arena_allocator(t_uindex chunk_nbytes)
+    : m_chunk_nbytes(chunk_nbytes)
+    , m_large_nbytes(0) {
+    PSP_VERBOSE_ASSERT(is_power_of_two(m_chunk_nbytes) && m_chunk_nbytes >= 2 * MIN_BLOCK_NBYTES,
+        "Arena chunks must be a power of two of at least two blocks");
+
+    t_uindex nclasses = 0;
+    for (t_uindex block = MIN_BLOCK_NBYTES; block <= m_chunk_nbytes / 2; block <<= 1) {
+        ++nclasses;
+    }
+    m_partial.resize(nclasses);
+}
+
+t_arena_allocator::~t_arena_allocator() {
+    for (auto& kv : m_chunks) {
+        m_system.deallocate(kv.second.m_base, m_chunk_nbytes, m_chunk_nbytes);
+    }
+}
+
+t_uindex
+t_arena_allocator::size_class(t_uindex nbytes) const {
+    t_uindex block = MIN_BLOCK_NBYTES;
+    while (block < nbytes) {
+        block <<= 1;
+    }
+    return block;
+}
+
+bool
+t_arena_allocator::is_small(t_uindex nbytes, t_uindex alignment) const {
+    t_uindex block = size_class(nbytes);
+    return block <= m_chunk_nbytes / 2 && alignment <= block;
+}
+
+t_arena_allocator::t_chunk*
+t_arena_allocator::find_chunk(void* ptr) {
+    // Chunks are aligned to their size, and no large allocation can lie
+    // within one.
+    auto key = reinterpret_cast<std::uintptr_t>(ptr) & ~std::uintptr_t(m_chunk_nbytes - 1);
+    auto iter = m_chunks.find(key);
+    return iter == m_chunks.end() ? nullptr : &iter->second;
+}
+
+void*
+t_arena_allocator::allocate(t_uindex nbytes, t_uindex alignment, bool zero) {
+    std::lock_guard<std::mutex> lk(m_mtx);
+    if (!is_small(nbytes, alignment)) {
+        void* base = m_system.allocate(nbytes, alignment, zero);
+        if (base) {
+            m_large_nbytes += nbytes;
+        }
+        return base;
+    }
+
+    t_uindex block = size_class(nbytes);
+    t_uindex cls = 0;
+    for (t_uindex b = MIN_BLOCK_NBYTES; b < block; b <<= 1) {
+        ++cls;
+    }
+
+    std::vector<std::uintptr_t>& partial = m_partial[cls];
+    if (partial.empty()) {
+        void* base = m_system.allocate(m_chunk_nbytes, m_chunk_nbytes, false);
+        if (!base) {
+            return nullptr;
+        }
+
+        t_chunk chunk;
+        chunk.m_base = static_cast<unsigned char*>(base);
+        chunk.m_block_nbytes = block;
+        chunk.m_nblocks = m_chunk_nbytes / block;
+        chunk.m_carved = 0;
+        chunk.m_live = 0;
+        chunk.m_free = nullptr;
+        auto key = reinterpret_cast<std::uintptr_t>(base);
+        m_chunks[key] = chunk;
+        partial.push_back(key);
+    }
+
+    t_chunk& chunk = m_chunks[partial.back()];
+    void* rval;
+    if (chunk.m_free) {
+        rval = chunk.m_free;
+        chunk.m_free = *static_cast<void**>(rval);
+    } else {
+        rval = chunk.m_base + chunk.m_carved * chunk.m_block_nbytes;
+        ++chunk.m_carved;
+    }
+
+    ++chunk.m_live;
+    if (chunk.m_live == chunk.m_nblocks) {
+        partial.pop_back();
+    }
+
+    if (zero) {
+        std::memset(rval, 0, size_t(nbytes));
+    }
+
+    return rval;
+}
+
+void
+t_arena_allocator::deallocate(void* ptr, t_uindex nbytes, t_uindex alignment) {
+    if (!ptr) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lk(m_mtx);
+    t_chunk* chunk = find_chunk(ptr);
+    if (!chunk) {
+        m_system.deallocate(ptr, nbytes, alignment);
+        m_large_nbytes -= nbytes;
+        return;
+    }
+
+    t_uindex cls = 0;
+    for (t_uindex b = MIN_BLOCK_NBYTES; b < chunk->m_block_nbytes; b <<= 1) {
+        ++cls;
+    }
+
+    std::vector<std::uintptr_t>& partial = m_partial[cls];
+    auto key = reinterpret_cast<std::uintptr_t>(chunk->m_base);
+    bool was_full = chunk->m_live == chunk->m_nblocks;
+    --chunk->m_live;
+
+    if (chunk->m_live == 0) {
+        if (!was_full) {
+            partial.erase(std::find(partial.begin(), partial.end(), key));
+        }
+        m_system.deallocate(chunk->m_base, m_chunk_nbytes, m_chunk_nbytes);
+        m_chunks.erase(key);
+        return;
+    }
+
+    *static_cast<void**>(ptr) = chunk->m_free;
+    chunk->m_free = ptr;
+    if (was_full) {
+        partial.push_back(key);
+    }
+}
+
+void*
+t_arena_allocator::reallocate(
+    void* ptr, t_uindex nbytes, t_uindex new_nbytes, t_uindex alignment) {
+    bool small = is_small(nbytes, alignment);
+    bool new_small = is_small(new_nbytes, alignment);
+    if (small && new_small && size_class(nbytes) == size_class(new_nbytes)) {
+        return ptr;
+    }
+
+    if (!small && !new_small) {
+        std::lock_guard<std::mutex> lk(m_mtx);
+        void* rval = m_system.reallocate(ptr, nbytes, new_nbytes, alignment);
+        if (rval) {
+            m_large_nbytes += new_nbytes;
+            m_large_nbytes -= nbytes;
+        }
+        return rval;
+    }
+
+    return t_allocator::reallocate(ptr, nbytes, new_nbytes, alignment);
+}
+
+t_uindex
+t_arena_allocator::good_size(t_uindex nbytes) const {
+    t_uindex block = size_class(nbytes);
+    return block <= m_chunk_nbytes / 2 ? block : nbytes;
+}
+
+t_uindex
+t_arena_allocator::reserved_nbytes() const {
+    std::lock_guard<std::mutex> lk(m_mtx);
+    return m_chunks.size() * m_chunk_nbytes + m_large_nbytes;
+}
+
+std::string
+t_arena_allocator::name() const {
+    return "arena";
+}
+
+t_allocator_scope::t_allocator_scope(std::shared_ptr<t_allocator> allocator)
+    : m_prev(CURRENT) {
+    CURRENT = allocator;
+}
+
+t_allocator_scope::~t_allocator_scope() { CURRENT = m_prev; }
+
+} // end namespace perspective
@@ -12,6 +12,7 @@
 #include <perspective/arg_sort.h>
 #include <perspective/multi_sort.h>
 #include <perspective/scalar.h>
+#include <perspective/sort_key.h>
 #ifdef PSP_PARALLEL_FOR
 #include <tbb/parallel_sort.h>
 #endif
@@ -24,6 +25,21 @@ argsort(std::vector<t_index>& output, const t_multisorter& sorter) {
     // Output should be the same size is v
     for (t_index i = 0, loop_end = output.size(); i != loop_end; ++i)
         output[i] = i;
+
+    // Encode each element once so that comparisons are a `memcmp` of the
+    // keys rather than a walk over the sort values.
+    if (sorter.m_elems && is_sort_key_encodable(sorter.m_sort_order)) {
+        const std::vector<t_mselem>& elems = *sorter.m_elems;
+        std::vector<std::string> keys(output.size());
+        for (t_index i = 0, loop_end = output.size(); i != loop_end; ++i) {
+            encode_sort_key(sorter.m_sort_order, elems[i], keys[i]);
+        }
+
+        std::sort(output.begin(), output.end(),
+            [&keys](t_index a, t_index b) { return keys[a] < keys[b]; });
+        return;
+    }
+
     std::sort(output.begin(), output.end(), sorter);
 }
 
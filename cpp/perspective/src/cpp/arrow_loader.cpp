@@ -8,6 +8,8 @@
  */
 
 #include <perspective/arrow_loader.h>
+#include <perspective/arrow_writer.h>
+#include <perspective/scheduler.h>
 
 
 using namespace perspective;
@@ -56,10 +58,62 @@ namespace arrow {
         return DTYPE_STR;
     }
 
+    namespace {
+        /**
+         * @brief A `Buffer` over memory allocated with `malloc`, which it
+         * frees once the last array read from it, and so the last column
+         * borrowing one, is gone.
+         */
+        class t_malloc_buffer : public Buffer {
+        public:
+            t_malloc_buffer(std::uint8_t* data, std::int64_t size)
+                : Buffer(data, size)
+                , m_owned(data) {}
+
+            ~t_malloc_buffer() { std::free(m_owned); }
+
+        private:
+            std::uint8_t* m_owned;
+        };
+
+        std::shared_ptr<Buffer>
+        wrap_buffer(const uintptr_t ptr, const uint32_t length, bool owned) {
+            std::uint8_t* data = reinterpret_cast<std::uint8_t*>(ptr);
+            if (owned) {
+                return std::make_shared<t_malloc_buffer>(data, length);
+            }
+            return std::make_shared<Buffer>(data, length);
+        }
+    } // namespace
+
+    bool
+    is_parquet(const uintptr_t ptr, const uint32_t length) {
+        return length >= 4 && std::memcmp("PAR1", (const void*)ptr, 4) == 0;
+    }
+
     void
-    ArrowLoader::initialize(const uintptr_t ptr, const uint32_t length) {
-        io::BufferReader buffer_reader(reinterpret_cast<const std::uint8_t*>(ptr), length);
-        if (std::memcmp("ARROW1", (const void *)ptr, 6) == 0) {
+    ArrowLoader::initialize(const uintptr_t ptr, const uint32_t length, bool owned) {
+        if (is_parquet(ptr, length)) {
+#ifdef PSP_ENABLE_PARQUET
+            initialize_parquet(ptr, length, {}, owned);
+            return;
+#else
+            if (owned) {
+                std::free(reinterpret_cast<void*>(ptr));
+            }
+            PSP_COMPLAIN_AND_ABORT("Parquet is not supported in this build of Perspective.");
+#endif
+        }
+
+        // Columns borrow the arrays read from `buffer`, which the arrays keep
+        // alive, so `ptr` is only freed with the last of them.
+        std::shared_ptr<Buffer> buffer = wrap_buffer(ptr, length, owned);
+        if (is_compressed_arrow(buffer->data(), length)) {
+            buffer = decompress_arrow(buffer->data(), length);
+        }
+
+        io::BufferReader buffer_reader(buffer);
+        if (std::memcmp("ARROW1", (const void *)buffer->data(), 6) == 0) {
             std::shared_ptr<ipc::RecordBatchFileReader> batch_reader;
             ::arrow::Status status = ipc::RecordBatchFileReader::Open(&buffer_reader, &batch_reader);        
             if (!status.ok()) {
@@ -103,12 +157,78 @@ namespace arrow {
             }
         }
 
+        init_schema();
+    }
+
+#ifdef PSP_ENABLE_PARQUET
+    namespace {
+        std::unique_ptr<::parquet::arrow::FileReader>
+        open_parquet(std::shared_ptr<Buffer> buffer) {
+            std::unique_ptr<::parquet::arrow::FileReader> reader;
+            auto source = std::make_shared<io::BufferReader>(buffer);
+            PSP_CHECK_ARROW_STATUS(
+                ::parquet::arrow::OpenFile(source, default_memory_pool(), &reader));
+            return reader;
+        }
+    } // namespace
+
+    void
+    ArrowLoader::initialize_parquet(const uintptr_t ptr, const uint32_t length,
+        const std::vector<std::string>& columns, bool owned) {
+        // Wrap rather than copy the file, so that every reader shares it
+        std::shared_ptr<Buffer> buffer = wrap_buffer(ptr, length, owned);
+        std::unique_ptr<::parquet::arrow::FileReader> reader = open_parquet(buffer);
+
+        std::shared_ptr<Schema> file_schema;
+        PSP_CHECK_ARROW_STATUS(reader->GetSchema(&file_schema));
+
+        std::vector<int> column_indices;
+        if (columns.empty()) {
+            for (int idx = 0; idx < file_schema->num_fields(); ++idx) {
+                column_indices.push_back(idx);
+            }
+        } else {
+            for (const std::string& name : columns) {
+                int idx = file_schema->GetFieldIndex(name);
+                if (idx != -1) {
+                    column_indices.push_back(idx);
+                }
+            }
+        }
+
+        int num_row_groups = reader->num_row_groups();
+        if (num_row_groups <= 1) {
+            PSP_CHECK_ARROW_STATUS(reader->ReadTable(column_indices, &m_table));
+        } else {
+            std::vector<std::shared_ptr<::arrow::Table>> row_groups(num_row_groups);
+
+            t_scheduler::current().parallel_for(num_row_groups,
+                [&buffer, &column_indices, &row_groups](t_uindex i) {
+                    std::unique_ptr<::parquet::arrow::FileReader> row_group_reader
+                        = open_parquet(buffer);
+                    PSP_CHECK_ARROW_STATUS(
+                        row_group_reader->ReadRowGroup(i, column_indices, &row_groups[i]));
+                });
+
+            PSP_CHECK_ARROW_STATUS(ConcatenateTables(row_groups, &m_table));
+        }
+
+        init_schema();
+    }
+#endif
+
+    void
+    ArrowLoader::init_schema() {
         std::shared_ptr<Schema> schema = m_table->schema();
         std::vector<std::shared_ptr<Field>> fields = schema->fields();
 
         for (auto field : fields) {
             m_names.push_back(field->name());
             m_types.push_back(convert_type(field->type()->name()));
+            if (field->type()->id() == ::arrow::Type::DECIMAL) {
+                m_scales[field->name()]
+                    = std::static_pointer_cast<::arrow::DecimalType>(field->type())->scale();
+            }
         }
     }
 
@@ -167,6 +287,23 @@ namespace arrow {
         }
     }
 
+    template <typename T>
+    void
+    remap_dictionary_indices(std::shared_ptr<t_column> dest, std::shared_ptr<::arrow::Array> src,
+        const std::vector<t_stridx>& ids, const int64_t offset, const int64_t len) {
+        std::shared_ptr<T> scol = std::static_pointer_cast<T>(src);
+        const typename T::value_type* vals = scol->raw_values();
+        t_stridx* out = dest->get_nth<t_stridx>(offset);
+        const int64_t nids = ids.size();
+
+        for (int64_t i = 0; i < len; i++) {
+            int64_t didx = static_cast<int64_t>(vals[i]);
+            // Null entries may hold any index, and are cleared by the
+            // validity map.
+            out[i] = didx >= 0 && didx < nids ? ids[didx] : 0;
+        }
+    }
+
     void
     copy_array(std::shared_ptr<t_column> dest, std::shared_ptr<::arrow::Array> src,
         const int64_t offset, const int64_t len) {
@@ -180,27 +317,32 @@ namespace arrow {
                 const std::uint64_t dsize = dict->length();
 
                 t_vocab* vocab = dest->_get_vocab();
+                vocab->reserve_additional(offsets[dsize] - offsets[0] + dsize, dsize);
                 std::string elem;
 
+                // Intern each dictionary entry once; the vocabulary may
+                // already hold other strings, so indices are remapped to the
+                // ids they were interned at.
+                std::vector<t_stridx> ids(dsize);
                 for (std::uint64_t i = 0; i < dsize; ++i) {
                     std::int32_t bidx = offsets[i];
                     std::size_t es = offsets[i + 1] - bidx;
                     elem.assign(reinterpret_cast<const char*>(values) + bidx, es);
-                    vocab->get_interned(elem);
+                    ids[i] = vocab->get_interned(elem);
                 }
                 auto indices = scol->indices();
                 switch (indices->type()->id()) {
                     case ::arrow::Int8Type::type_id: {
-                        iter_col_copy<::arrow::Int8Array, t_uindex>(dest, indices, offset, len);
+                        remap_dictionary_indices<::arrow::Int8Array>(dest, indices, ids, offset, len);
                     } break;
                     case ::arrow::Int16Type::type_id: {
-                        iter_col_copy<::arrow::Int16Array, t_uindex>(dest, indices, offset, len);
+                        remap_dictionary_indices<::arrow::Int16Array>(dest, indices, ids, offset, len);
                     } break;
                     case ::arrow::Int32Type::type_id: {
-                        iter_col_copy<::arrow::Int32Array, t_uindex>(dest, indices, offset, len);
+                        remap_dictionary_indices<::arrow::Int32Array>(dest, indices, ids, offset, len);
                     } break;
                     case ::arrow::Int64Type::type_id: {
-                         iter_col_copy<::arrow::Int64Array, t_uindex>(dest, indices, offset, len);
+                        remap_dictionary_indices<::arrow::Int64Array>(dest, indices, ids, offset, len);
                     } break;
                     default:
                         std::stringstream ss;
@@ -332,14 +474,9 @@ namespace arrow {
             } break;
             case ::arrow::Decimal128Type::type_id:
             case ::arrow::DecimalType::type_id: {
-                std::shared_ptr<::arrow::Decimal128Array> scol = std::static_pointer_cast<::arrow::DecimalArray>(src);
-                auto vals = (::arrow::Decimal128 *)scol->raw_values();
-                for (uint32_t i = 0; i < len; ++i) {
-                    ::arrow::Status status = vals[i].ToInteger(dest->get_nth<int64_t>(offset + i));
-                    if (!status.ok()) {
-                        PSP_COMPLAIN_AND_ABORT("Could not write Decimal to column: " + status.message());
-                    };
-                }
+                std::int32_t scale
+                    = std::static_pointer_cast<::arrow::DecimalType>(src->type())->scale();
+                copy_decimal_array(dest, src, offset, len, scale, scale);
             } break;
             case ::arrow::BooleanType::type_id: {
                 auto scol = std::static_pointer_cast<::arrow::BooleanArray>(src);
@@ -359,6 +496,111 @@ namespace arrow {
         }
     }
 
+    template <typename T>
+    const void*
+    borrowable_values(std::shared_ptr<::arrow::Array> src, t_dtype expected, t_dtype dtype) {
+        if (dtype != expected) {
+            return nullptr;
+        }
+        return std::static_pointer_cast<T>(src)->raw_values();
+    }
+
+    /**
+     * @brief If `src` is a fixed-width array whose values are laid out
+     * exactly as `dest` would store them, point `dest` at the Arrow buffer
+     * instead of copying it, keeping `src` alive until `dest` is written to
+     * or destroyed. Returns false if `src` must be copied.
+     */
+    bool
+    borrow_array(std::shared_ptr<t_column> dest, std::shared_ptr<::arrow::Array> src,
+        const int64_t len) {
+        if (dest->size() != static_cast<t_uindex>(len)) {
+            return false;
+        }
+
+        t_dtype dtype = dest->get_dtype();
+        const void* values = nullptr;
+
+        switch (src->type()->id()) {
+            case ::arrow::Int8Type::type_id: {
+                values = borrowable_values<::arrow::Int8Array>(src, DTYPE_INT8, dtype);
+            } break;
+            case ::arrow::UInt8Type::type_id: {
+                values = borrowable_values<::arrow::UInt8Array>(src, DTYPE_UINT8, dtype);
+            } break;
+            case ::arrow::Int16Type::type_id: {
+                values = borrowable_values<::arrow::Int16Array>(src, DTYPE_INT16, dtype);
+            } break;
+            case ::arrow::UInt16Type::type_id: {
+                values = borrowable_values<::arrow::UInt16Array>(src, DTYPE_UINT16, dtype);
+            } break;
+            case ::arrow::Int32Type::type_id: {
+                values = borrowable_values<::arrow::Int32Array>(src, DTYPE_INT32, dtype);
+            } break;
+            case ::arrow::UInt32Type::type_id: {
+                values = borrowable_values<::arrow::UInt32Array>(src, DTYPE_UINT32, dtype);
+            } break;
+            case ::arrow::Int64Type::type_id: {
+                values = borrowable_values<::arrow::Int64Array>(src, DTYPE_INT64, dtype);
+            } break;
+            case ::arrow::UInt64Type::type_id: {
+                values = borrowable_values<::arrow::UInt64Array>(src, DTYPE_UINT64, dtype);
+            } break;
+            case ::arrow::FloatType::type_id: {
+                values = borrowable_values<::arrow::FloatArray>(src, DTYPE_FLOAT32, dtype);
+            } break;
+            case ::arrow::DoubleType::type_id: {
+                values = borrowable_values<::arrow::DoubleArray>(src, DTYPE_FLOAT64, dtype);
+            } break;
+            case ::arrow::TimestampType::type_id: {
+                // Only millisecond timestamps match `t_time`'s representation.
+                std::shared_ptr<::arrow::TimestampType> tunit
+                    = std::static_pointer_cast<::arrow::TimestampType>(src->type());
+                if (tunit->unit() == ::arrow::TimeUnit::MILLI) {
+                    values = borrowable_values<::arrow::TimestampArray>(src, DTYPE_TIME, dtype);
+                }
+            } break;
+            default:
+                break;
+        }
+
+        if (values == nullptr) {
+            return false;
+        }
+
+        dest->borrow_data(values, len, src);
+        return true;
+    }
+
+    void
+    copy_decimal_array(std::shared_ptr<t_column> dest, std::shared_ptr<::arrow::Array> src,
+        const int64_t offset, const int64_t len, std::int32_t scale, std::int32_t target_scale) {
+        std::shared_ptr<::arrow::Decimal128Array> scol
+            = std::static_pointer_cast<::arrow::DecimalArray>(src);
+        auto vals = (::arrow::Decimal128*)scol->raw_values();
+        std::int64_t* out = dest->get_nth<std::int64_t>(offset);
+        for (int64_t i = 0; i < len; ++i) {
+            // Null entries may hold anything, and are cleared by the
+            // validity map.
+            if (scol->IsNull(i)) {
+                out[i] = 0;
+                continue;
+            }
+
+            ::arrow::Decimal128 value = vals[i];
+            if (scale != target_scale) {
+                ::arrow::Status status = vals[i].Rescale(scale, target_scale, &value);
+                if (!status.ok()) {
+                    PSP_COMPLAIN_AND_ABORT("Could not rescale Decimal: " + status.message());
+                }
+            }
+            ::arrow::Status status = value.ToInteger(out + i);
+            if (!status.ok()) {
+                PSP_COMPLAIN_AND_ABORT("Could not write Decimal to column: " + status.message());
+            }
+        }
+    }
+
     void
     ArrowLoader::fill_column(t_data_table& tbl, std::shared_ptr<t_column> col,
         const std::string& name, std::int32_t cidx, t_dtype type, std::string& raw_type,
@@ -369,22 +611,28 @@ namespace arrow {
         for(auto i = 0; i < carray->num_chunks(); ++i) {
             std::shared_ptr<::arrow::Array> array = carray->chunk(i);
             int64_t len = array->length();
-        
-            copy_array(col, array, offset, len);
+
+            // Decimals are rescaled to the scale of the table they update. A
+            // single chunk covers the whole column, so its buffer can be
+            // borrowed rather than copied.
+            auto target_scale = m_target_scales.find(name);
+            if (target_scale != m_target_scales.end()
+                && array->type_id() == ::arrow::Type::DECIMAL) {
+                copy_decimal_array(col, array, offset, len,
+                    std::static_pointer_cast<::arrow::DecimalType>(array->type())->scale(),
+                    target_scale->second);
+            } else if (carray->num_chunks() != 1 || !borrow_array(col, array, len)) {
+                copy_array(col, array, offset, len);
+            }
 
             // Fill validity bitmap
             std::int64_t null_count = array->null_count();
             if (null_count == 0) {
                 col->valid_raw_fill();
             } else {
+                // The bitmap of a sliced array starts at the array's offset
                 const uint8_t* null_bitmap = array->null_bitmap_data();
-
-                // arrow packs bools into a bitmap
-                for (uint32_t i = 0; i < len; ++i) {
-                    std::uint8_t elem = null_bitmap[i / 8];
-                    bool v = elem & (1 << (i % 8));
-                    col->set_valid(offset + i, v);
-                }
+                col->set_valid_bitmap(null_bitmap, array->offset(), offset, len);
             }
             offset += len;
         }
@@ -407,5 +655,15 @@ namespace arrow {
         return m_types;
     }
 
+    const std::map<std::string, std::int32_t>&
+    ArrowLoader::scales() const {
+        return m_scales;
+    }
+
+    void
+    ArrowLoader::set_scales(const std::map<std::string, std::int32_t>& scales) {
+        m_target_scales = scales;
+    }
+
 } // namespace arrow
 } // namespace perspective
\ No newline at end of file
@@ -16,6 +16,131 @@ using namespace ::arrow;
 namespace perspective {
 namespace arrow {
 
+    namespace {
+        std::unique_ptr<util::Codec>
+        make_codec(t_arrow_compression compression) {
+            Compression::type type = Compression::UNCOMPRESSED;
+            switch (compression) {
+                case ARROW_COMPRESSION_LZ4: type = Compression::LZ4; break;
+                case ARROW_COMPRESSION_ZSTD: type = Compression::ZSTD; break;
+                default: {
+                    PSP_COMPLAIN_AND_ABORT("Unknown Arrow compression");
+                }
+            }
+
+            std::unique_ptr<util::Codec> codec;
+            PSP_CHECK_ARROW_STATUS(util::Codec::Create(type, &codec));
+            return codec;
+        }
+    } // namespace
+
+    t_arrow_compression
+    str_to_arrow_compression(const std::string& name) {
+        if (name == "") {
+            return ARROW_COMPRESSION_NONE;
+        } else if (name == "lz4") {
+            return ARROW_COMPRESSION_LZ4;
+        } else if (name == "zstd") {
+            return ARROW_COMPRESSION_ZSTD;
+        }
+
+        std::stringstream ss;
+        ss << "Unknown Arrow compression `" << name << "`" << std::endl;
+        PSP_COMPLAIN_AND_ABORT(ss.str());
+        return ARROW_COMPRESSION_NONE;
+    }
+
+    bool
+    is_arrow_compression_available(t_arrow_compression compression) {
+        if (compression == ARROW_COMPRESSION_NONE) {
+            return true;
+        }
+
+        Compression::type type
+            = compression == ARROW_COMPRESSION_LZ4 ? Compression::LZ4 : Compression::ZSTD;
+        std::unique_ptr<util::Codec> codec;
+        return util::Codec::Create(type, &codec).ok();
+    }
+
+    std::shared_ptr<std::string>
+    compress_arrow(const std::string& arrow, t_arrow_compression compression) {
+        if (compression == ARROW_COMPRESSION_NONE) {
+            return std::make_shared<std::string>(arrow);
+        }
+
+        std::unique_ptr<util::Codec> codec = make_codec(compression);
+        auto input = reinterpret_cast<const std::uint8_t*>(arrow.data());
+        std::int64_t input_len = arrow.size();
+        std::int64_t max_len = codec->MaxCompressedLen(input_len, input);
+
+        auto rval = std::make_shared<std::string>(
+            PSP_ARROW_COMPRESSED_HEADER_SIZE + max_len, '\0');
+        char* header = &(*rval)[0];
+        std::memcpy(header, PSP_ARROW_COMPRESSED_MAGIC, 4);
+        header[4] = static_cast<char>(compression);
+        std::memcpy(header + 5, &input_len, sizeof(std::int64_t));
+
+        std::int64_t compressed_len;
+        PSP_CHECK_ARROW_STATUS(codec->Compress(input_len, input, max_len,
+            reinterpret_cast<std::uint8_t*>(header + PSP_ARROW_COMPRESSED_HEADER_SIZE),
+            &compressed_len));
+        rval->resize(PSP_ARROW_COMPRESSED_HEADER_SIZE + compressed_len);
+        return rval;
+    }
+
+    bool
+    is_compressed_arrow(const std::uint8_t* ptr, std::uint64_t length) {
+        return length >= PSP_ARROW_COMPRESSED_HEADER_SIZE
+            && std::memcmp(ptr, PSP_ARROW_COMPRESSED_MAGIC, 4) == 0;
+    }
+
+    std::shared_ptr<Buffer>
+    decompress_arrow(const std::uint8_t* ptr, std::uint64_t length) {
+        PSP_VERBOSE_ASSERT(
+            is_compressed_arrow(ptr, length), "Buffer is not a compressed Arrow buffer");
+        auto compression = static_cast<t_arrow_compression>(ptr[4]);
+        std::int64_t output_len;
+        std::memcpy(&output_len, ptr + 5, sizeof(std::int64_t));
+
+        std::unique_ptr<util::Codec> codec = make_codec(compression);
+        std::shared_ptr<Buffer> rval;
+        PSP_CHECK_ARROW_STATUS(AllocateBuffer(output_len, &rval));
+        std::int64_t actual_len;
+        PSP_CHECK_ARROW_STATUS(codec->Decompress(length - PSP_ARROW_COMPRESSED_HEADER_SIZE,
+            ptr + PSP_ARROW_COMPRESSED_HEADER_SIZE, output_len, rval->mutable_data(),
+            &actual_len));
+        PSP_VERBOSE_ASSERT(actual_len == output_len, "Compressed Arrow buffer is truncated");
+        return rval;
+    }
+
+    std::shared_ptr<::arrow::DataType>
+    dtype_to_arrow_type(t_dtype dtype) {
+        switch (dtype) {
+            case DTYPE_INT8: return ::arrow::int8();
+            case DTYPE_UINT8: return ::arrow::uint8();
+            case DTYPE_INT16: return ::arrow::int16();
+            case DTYPE_UINT16: return ::arrow::uint16();
+            case DTYPE_INT32: return ::arrow::int32();
+            case DTYPE_UINT32: return ::arrow::uint32();
+            case DTYPE_INT64: return ::arrow::int64();
+            case DTYPE_UINT64: return ::arrow::uint64();
+            case DTYPE_FLOAT32: return ::arrow::float32();
+            case DTYPE_FLOAT64: return ::arrow::float64();
+            case DTYPE_DATE: return ::arrow::date32();
+            case DTYPE_TIME: return ::arrow::timestamp(::arrow::TimeUnit::MILLI);
+            case DTYPE_BOOL: return ::arrow::boolean();
+            case DTYPE_STR: return ::arrow::dictionary(::arrow::int32(), ::arrow::utf8());
+            case DTYPE_OBJECT: return ::arrow::uint64();
+            default: {
+                std::stringstream ss;
+                ss << "Cannot serialize a column of type `" << get_dtype_descr(dtype)
+                   << "` to Arrow format." << std::endl;
+                PSP_COMPLAIN_AND_ABORT(ss.str());
+            }
+        }
+        return nullptr;
+    }
+
     // TODO: unsure about efficacy of these functions when get<T> exists
     template <>
     double
@@ -272,5 +397,197 @@ namespace arrow {
         return dictionary_array;
     }
 
+    std::shared_ptr<::arrow::Array>
+    vocab_to_dictionary_array(
+        const std::vector<std::int32_t>& ids,
+        const t_vocab& vocab) {
+        std::int64_t nrows = ids.size();
+        t_uindex vocab_size = vocab.get_vlenidx();
+
+        // Dictionary entries as vocabulary ids in string order, and the
+        // index of each entry of `used` in that order, when pruned
+        std::vector<std::int32_t> used;
+        std::vector<std::int32_t> entries;
+        std::vector<std::int32_t> positions;
+        bool prune = static_cast<t_uindex>(nrows) < vocab_size;
+        if (prune) {
+            used = ids;
+            std::sort(used.begin(), used.end());
+            used.erase(std::unique(used.begin(), used.end()), used.end());
+            used.erase(used.begin(), std::lower_bound(used.begin(), used.end(), 0));
+
+            // Fewer strings than the vocabulary's are sorted here rather
+            // than ranking all of the vocabulary's.
+            entries = used;
+            std::sort(entries.begin(), entries.end(), [&vocab](std::int32_t a, std::int32_t b) {
+                return std::strcmp(vocab.unintern_c(a), vocab.unintern_c(b)) < 0;
+            });
+            positions.resize(used.size());
+            for (t_uindex pos = 0, loop_end = entries.size(); pos < loop_end; ++pos) {
+                auto iter = std::lower_bound(used.begin(), used.end(), entries[pos]);
+                positions[iter - used.begin()] = static_cast<std::int32_t>(pos);
+            }
+        }
+
+        const std::vector<std::uint32_t>* ranks = prune ? nullptr : &vocab.get_ranks();
+        std::vector<std::int32_t> indices(nrows);
+        std::vector<std::uint8_t> valid(nrows);
+        for (std::int64_t ridx = 0; ridx < nrows; ++ridx) {
+            std::int32_t id = ids[ridx];
+            valid[ridx] = id >= 0;
+            if (id < 0) {
+                indices[ridx] = 0;
+            } else if (prune) {
+                indices[ridx]
+                    = positions[std::lower_bound(used.begin(), used.end(), id) - used.begin()];
+            } else {
+                indices[ridx] = static_cast<std::int32_t>((*ranks)[id]);
+            }
+        }
+
+        ::arrow::Int32Builder indices_builder;
+        PSP_CHECK_ARROW_STATUS(
+            indices_builder.AppendValues(indices.data(), nrows, valid.data()));
+        std::shared_ptr<::arrow::Array> indices_array;
+        PSP_CHECK_ARROW_STATUS(indices_builder.Finish(&indices_array));
+
+        t_uindex dictionary_size = prune ? entries.size() : vocab_size;
+        const std::vector<std::uint32_t>* sorted_ids
+            = prune ? nullptr : &vocab.get_sorted_ids();
+        ::arrow::StringBuilder values_builder;
+        PSP_CHECK_ARROW_STATUS(values_builder.Reserve(dictionary_size));
+        for (t_uindex i = 0; i < dictionary_size; ++i) {
+            const char* str = vocab.unintern_c(prune ? entries[i] : (*sorted_ids)[i]);
+            PSP_CHECK_ARROW_STATUS(values_builder.Append(str, strlen(str)));
+        }
+
+        std::shared_ptr<::arrow::Array> values_array;
+        PSP_CHECK_ARROW_STATUS(values_builder.Finish(&values_array));
+
+        std::shared_ptr<::arrow::Array> dictionary_array;
+        PSP_CHECK_ARROW_STATUS(::arrow::DictionaryArray::FromArrays(
+            ::arrow::dictionary(::arrow::int32(), ::arrow::utf8()), indices_array,
+            values_array, &dictionary_array));
+
+        return dictionary_array;
+    }
+
+    namespace {
+        std::shared_ptr<::arrow::Buffer>
+        copy_to_buffer(const void* data, std::int64_t nbytes) {
+            std::shared_ptr<::arrow::Buffer> rval;
+            PSP_CHECK_ARROW_STATUS(::arrow::AllocateBuffer(nbytes, &rval));
+            if (nbytes > 0) {
+                std::memcpy(rval->mutable_data(), data, size_t(nbytes));
+            }
+            return rval;
+        }
+
+        /**
+         * @brief An array of `col`'s length from its fixed width `values`,
+         * with the validity bitmap of `col` as the array's null bitmap
+         * rather than appending a validity byte per row.
+         */
+        template <typename T>
+        std::shared_ptr<::arrow::Array>
+        values_to_array(const t_slice_column& col, const T* values,
+            std::shared_ptr<::arrow::DataType> type) {
+            std::int64_t nrows = col.size();
+            std::int64_t null_count = col.get_null_count();
+            std::shared_ptr<::arrow::Buffer> null_bitmap = null_count == 0
+                ? nullptr
+                : copy_to_buffer(col.get_valid_bitmap(), (nrows + 7) / 8);
+            return ::arrow::MakeArray(::arrow::ArrayData::Make(type, nrows,
+                {null_bitmap, copy_to_buffer(values, nrows * sizeof(T))}, null_count));
+        }
+
+        template <typename T>
+        std::shared_ptr<::arrow::Array>
+        values_to_array(const t_slice_column& col, std::shared_ptr<::arrow::DataType> type) {
+            return values_to_array<T>(col, col.get_values<T>(), type);
+        }
+    } // namespace
+
+    std::shared_ptr<::arrow::Array>
+    slice_column_to_array(const t_slice_column& col) {
+        t_uindex nrows = col.size();
+        switch (col.get_dtype()) {
+            case DTYPE_INT8: {
+                return values_to_array<std::int8_t>(col, ::arrow::int8());
+            }
+            case DTYPE_UINT8: {
+                return values_to_array<std::uint8_t>(col, ::arrow::uint8());
+            }
+            case DTYPE_INT16: {
+                return values_to_array<std::int16_t>(col, ::arrow::int16());
+            }
+            case DTYPE_UINT16: {
+                return values_to_array<std::uint16_t>(col, ::arrow::uint16());
+            }
+            case DTYPE_INT32: {
+                return values_to_array<std::int32_t>(col, ::arrow::int32());
+            }
+            case DTYPE_UINT32: {
+                return values_to_array<std::uint32_t>(col, ::arrow::uint32());
+            }
+            case DTYPE_INT64: {
+                return values_to_array<std::int64_t>(col, ::arrow::int64());
+            }
+            case DTYPE_UINT64: {
+                return values_to_array<std::uint64_t>(col, ::arrow::uint64());
+            }
+            case DTYPE_FLOAT32: {
+                return values_to_array<float>(col, ::arrow::float32());
+            }
+            case DTYPE_FLOAT64: {
+                return values_to_array<double>(col, ::arrow::float64());
+            }
+            case DTYPE_TIME: {
+                return values_to_array<std::int64_t>(
+                    col, ::arrow::timestamp(::arrow::TimeUnit::MILLI));
+            }
+            case DTYPE_BOOL: {
+                ::arrow::BooleanBuilder array_builder;
+                PSP_CHECK_ARROW_STATUS(array_builder.AppendValues(
+                    col.get_values<std::uint8_t>(), nrows, col.get_valid()));
+                std::shared_ptr<::arrow::Array> array;
+                PSP_CHECK_ARROW_STATUS(array_builder.Finish(&array));
+                return array;
+            }
+            case DTYPE_DATE: {
+                // A `t_date` packs its year, month and day, so each is
+                // converted to days since the epoch.
+                const t_date::t_rawtype* values = col.get_values<t_date::t_rawtype>();
+                std::vector<std::int32_t> days(nrows);
+                for (t_uindex ridx = 0; ridx < nrows; ++ridx) {
+                    if (!col.is_valid(ridx)) {
+                        continue;
+                    }
+                    t_date val(values[ridx]);
+                    date::year year {val.year()};
+                    date::month month {static_cast<std::uint32_t>(val.month() + 1)};
+                    date::day day {static_cast<std::uint32_t>(val.day())};
+                    date::sys_days days_since_epoch = date::year_month_day(year, month, day);
+                    days[ridx] = static_cast<std::int32_t>(days_since_epoch.time_since_epoch().count());
+                }
+
+                return values_to_array<std::int32_t>(col, days.data(), ::arrow::date32());
+            }
+            case DTYPE_STR: {
+                const std::int32_t* ids = col.get_values<std::int32_t>();
+                return vocab_to_dictionary_array(
+                    std::vector<std::int32_t>(ids, ids + nrows), col.get_vocab());
+            }
+            default: {
+                std::stringstream ss;
+                ss << "Cannot serialize a column of type `" << get_dtype_descr(col.get_dtype())
+                   << "` to Arrow format." << std::endl;
+                PSP_COMPLAIN_AND_ABORT(ss.str());
+            }
+        }
+
+        return nullptr;
+    }
+
 } // namespace arrow
 } // namespace perspective
\ No newline at end of file
@@ -136,7 +136,7 @@ get_dtype_size(t_dtype dtype) {
             return sizeof(float);
         }
         case DTYPE_STR: {
-            return sizeof(t_uindex);
+            return sizeof(t_stridx);
         }
         case DTYPE_TIME: {
             return sizeof(std::int64_t);
@@ -545,11 +545,38 @@ str_to_sorttype(const std::string& str) {
     }
 }
 
+std::string
+sorttype_to_str(t_sorttype type) {
+    switch (type) {
+        case SORTTYPE_ASCENDING: return "asc";
+        case SORTTYPE_DESCENDING: return "desc";
+        case SORTTYPE_NONE: return "none";
+        case SORTTYPE_ASCENDING_ABS: return "asc abs";
+        case SORTTYPE_DESCENDING_ABS: return "desc abs";
+        default: {
+            PSP_COMPLAIN_AND_ABORT("Encountered unknown sort type");
+            return "";
+        }
+    }
+}
+
 t_aggtype
 str_to_aggtype(const std::string& str) {
     if (str == "distinct count" || str == "distinctcount" || str == "distinct"
         || str == "distinct_count") {
         return t_aggtype::AGGTYPE_DISTINCT_COUNT;
+    } else if (str == "approx distinct count" || str == "approx_distinct_count") {
+        return t_aggtype::AGGTYPE_APPROX_DISTINCT_COUNT;
+    } else if (str == "approx percentile" || str == "approx_percentile") {
+        return t_aggtype::AGGTYPE_APPROX_PERCENTILE;
+    } else if (str == "rolling sum" || str == "rolling_sum") {
+        return t_aggtype::AGGTYPE_ROLLING_SUM;
+    } else if (str == "rolling count" || str == "rolling_count") {
+        return t_aggtype::AGGTYPE_ROLLING_COUNT;
+    } else if (str == "rolling mean" || str == "rolling_mean") {
+        return t_aggtype::AGGTYPE_ROLLING_MEAN;
+    } else if (str == "rolling weighted mean" || str == "rolling_weighted_mean") {
+        return t_aggtype::AGGTYPE_ROLLING_WEIGHTED_MEAN;
     } else if (str == "sum") {
         return t_aggtype::AGGTYPE_SUM;
     } else if (str == "mul") {
@@ -566,6 +593,10 @@ str_to_aggtype(const std::string& str) {
         return t_aggtype::AGGTYPE_ANY;
     } else if (str == "median") {
         return t_aggtype::AGGTYPE_MEDIAN;
+    } else if (str == "min") {
+        return t_aggtype::AGGTYPE_MIN;
+    } else if (str == "max") {
+        return t_aggtype::AGGTYPE_MAX;
     } else if (str == "join") {
         return t_aggtype::AGGTYPE_JOIN;
     } else if (str == "div") {
@@ -608,7 +639,7 @@ str_to_aggtype(const std::string& str) {
         return t_aggtype::AGGTYPE_PCT_SUM_GRAND_TOTAL;
     } else if (str.find("udf_combiner_") != std::string::npos) {
         return t_aggtype::AGGTYPE_UDF_COMBINER;
-    } else if (str.find("udf_reducer_") != std::string::npos) {
+    } else if (str == "reducer" || str.find("udf_reducer_") != std::string::npos) {
         return t_aggtype::AGGTYPE_UDF_REDUCER;
     } else {
         PSP_COMPLAIN_AND_ABORT("Encountered unknown aggregate operation.");
@@ -810,6 +841,29 @@ type_to_dtype<void *>() {
     return DTYPE_OBJECT;
 }
 
+void
+write_json_string(std::ostream& os, const char* str, std::size_t len) {
+    os << '"';
+    for (std::size_t idx = 0; idx < len; ++idx) {
+        char c = str[idx];
+        switch (c) {
+            case '"': os << "\\\""; break;
+            case '\\': os << "\\\\"; break;
+            case '\n': os << "\\n"; break;
+            case '\t': os << "\\t"; break;
+            default: {
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    os << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                       << static_cast<int>(c) << std::dec << std::setfill(' ');
+                } else {
+                    os << c;
+                }
+            }
+        }
+    }
+    os << '"';
+}
+
 } // end namespace perspective
 
 namespace std {
@@ -0,0 +1,93 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#include <perspective/first.h>
+#include <perspective/bloom_filter.h>
+
+// Bits of the filter per key it is sized for.
+#define PSP_BLOOM_FILTER_BITS_PER_KEY 10
+
+#define PSP_BLOOM_FILTER_BLOCK_WORDS 8
+
+namespace perspective {
+
+namespace {
+// The finalizer of splitmix64, so that sequential integer keys spread
+// across blocks.
+inline std::uint64_t
+mix(std::uint64_t h) {
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    return h;
+}
+} // namespace
+
+t_bloom_filter::t_bloom_filter()
+    : m_block_mask(0) {}
+
+void
+t_bloom_filter::reset(t_uindex nkeys) {
+    t_uindex bits = std::max<t_uindex>(nkeys, 1) * PSP_BLOOM_FILTER_BITS_PER_KEY;
+    t_uindex nblocks = 1;
+    while (nblocks * PSP_BLOOM_FILTER_BLOCK_WORDS * 64 < bits) {
+        nblocks *= 2;
+    }
+
+    m_words.assign(nblocks * PSP_BLOOM_FILTER_BLOCK_WORDS, 0);
+    m_block_mask = nblocks - 1;
+}
+
+void
+t_bloom_filter::clear() {
+    std::vector<std::uint64_t>().swap(m_words);
+    m_block_mask = 0;
+}
+
+bool
+t_bloom_filter::empty() const {
+    return m_words.empty();
+}
+
+void
+t_bloom_filter::insert(std::uint64_t hash) {
+    std::uint64_t h = mix(hash);
+    std::uint64_t* block = &m_words[(h & m_block_mask) * PSP_BLOOM_FILTER_BLOCK_WORDS];
+
+    // The bit of each word is read from a second hash, independent of the
+    // bits that chose the block.
+    std::uint64_t bits = mix(h ^ 0x9e3779b97f4a7c15ULL);
+    for (t_uindex idx = 0; idx < PSP_BLOOM_FILTER_BLOCK_WORDS; ++idx) {
+        block[idx] |= std::uint64_t(1) << ((bits >> (6 * idx)) & 63);
+    }
+}
+
+bool
+t_bloom_filter::may_contain(std::uint64_t hash) const {
+    std::uint64_t h = mix(hash);
+    const std::uint64_t* block
+        = &m_words[(h & m_block_mask) * PSP_BLOOM_FILTER_BLOCK_WORDS];
+
+    std::uint64_t bits = mix(h ^ 0x9e3779b97f4a7c15ULL);
+    for (t_uindex idx = 0; idx < PSP_BLOOM_FILTER_BLOCK_WORDS; ++idx) {
+        if (!(block[idx] & (std::uint64_t(1) << ((bits >> (6 * idx)) & 63)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+t_uindex
+t_bloom_filter::nbytes() const {
+    return m_words.capacity() * sizeof(std::uint64_t);
+}
+
+} // end namespace perspective
@@ -11,6 +11,7 @@
 #include <perspective/portable.h>
 SUPPRESS_WARNINGS_VC(4505)
 #include <perspective/column.h>
+#include <perspective/packed_column.h>
 #include <perspective/defaults.h>
 #include <perspective/base.h>
 #include <perspective/sym_table.h>
@@ -33,6 +34,7 @@ t_column::t_column()
     , m_size(0)
     , m_status_enabled(false)
     , m_from_recipe(false)
+    , m_is_packed(false)
 
 {
     LOG_CONSTRUCTOR("t_column");
@@ -44,6 +46,7 @@ t_column::t_column(const t_column_recipe& recipe)
     , m_size(recipe.m_size)
     , m_status_enabled(recipe.m_status_enabled)
     , m_from_recipe(true)
+    , m_is_packed(false)
 
 {
     LOG_CONSTRUCTOR("t_column");
@@ -65,6 +68,10 @@ t_column::t_column(const t_column_recipe& recipe)
 
 void
 t_column::column_copy_helper(const t_column& other) {
+    // The copy is of the full-width recipe.
+    other.unpack_if_packed();
+    m_packed.reset();
+    m_is_packed = false;
     m_dtype = other.m_dtype;
     m_init = false;
     m_isvlen = other.m_isvlen;
@@ -101,7 +108,8 @@ t_column::t_column(
     , m_init(false)
     , m_size(0)
     , m_status_enabled(missing_enabled)
-    , m_from_recipe(false) {
+    , m_from_recipe(false)
+    , m_is_packed(false) {
 
     m_data.reset(new t_lstore(a));
     // TODO make sure that capacity from a
@@ -171,6 +179,7 @@ t_column::get_dtype() const {
 // extend based on dtype size
 void
 t_column::extend_dtype(t_uindex idx) {
+    unpack_if_packed();
     t_uindex new_extents = idx * get_dtype_size(m_dtype);
     m_data->reserve(new_extents);
     m_data->set_size(new_extents);
@@ -199,11 +208,11 @@ void
 t_column::push_back<const char*>(const char* elem) {
     COLUMN_CHECK_STRCOL();
     if (!elem) {
-        m_data->push_back(static_cast<t_uindex>(0));
+        m_data->push_back(static_cast<t_stridx>(0));
         return;
     }
 
-    t_uindex idx = m_vocab->get_interned(elem);
+    t_stridx idx = m_vocab->get_interned(elem);
     m_data->push_back(idx);
     ++m_size;
 }
@@ -212,7 +221,7 @@ template <>
 void
 t_column::push_back<char*>(char* elem) {
     COLUMN_CHECK_STRCOL();
-    t_uindex idx = m_vocab->get_interned(elem);
+    t_stridx idx = m_vocab->get_interned(elem);
     m_data->push_back(idx);
     ++m_size;
 }
@@ -313,6 +322,7 @@ t_column::push_back<t_tscalar>(t_tscalar elem) {
 
 const t_lstore&
 t_column::data_lstore() const {
+    unpack_if_packed();
     return *m_data;
 }
 
@@ -327,6 +337,7 @@ t_column::set_size(t_uindex size) {
     PSP_VERBOSE_ASSERT(size * get_dtype_size(m_dtype) <= m_data->capacity(),
         "Not enough space reserved for column");
 #endif
+    unpack_if_packed();
     m_size = size;
     m_data->set_size(m_elemsize * size);
 
@@ -336,11 +347,18 @@ t_column::set_size(t_uindex size) {
 
 void
 t_column::reserve(t_uindex size) {
+    unpack_if_packed();
     m_data->reserve(get_dtype_size(m_dtype) * size);
     if (is_status_enabled())
         m_status->reserve(get_dtype_size(DTYPE_UINT8) * size);
 }
 
+void
+t_column::set_alloc_owner(t_alloc_owner owner) {
+    m_data->set_alloc_owner(owner);
+    m_status->set_alloc_owner(owner);
+}
+
 //object storage, specialize only for std::uint64_t
 template <>
 void t_column::object_copied<std::uint64_t>(std::uint64_t ptr) const {}
@@ -360,6 +378,7 @@ void t_column::notify_object_cleared(std::uint64_t idx) const {
 
 t_lstore*
 t_column::_get_data_lstore() {
+    unpack_if_packed();
     return m_data.get();
 }
 
@@ -368,6 +387,30 @@ t_column::_get_vocab() {
     return m_vocab.get();
 }
 
+const t_vocab*
+t_column::_get_vocab() const {
+    return m_vocab.get();
+}
+
+t_uindex
+t_column::nbytes() const {
+    std::shared_ptr<const t_packed_column> packed = std::atomic_load(&m_packed);
+    if (packed) {
+        t_uindex rv = packed->nbytes() + m_data->capacity();
+        if (is_status_enabled()) {
+            rv += m_status->capacity();
+        }
+        return rv;
+    }
+
+    // Spilled stores are read from the page cache, not counted.
+    t_uindex rv = m_data->is_spilled() ? 0 : m_data->capacity();
+    if (is_status_enabled() && !m_status->is_spilled()) {
+        rv += m_status->capacity();
+    }
+    return rv;
+}
+
 t_uindex
 t_column::get_vlenidx() const {
     return m_vocab->get_vlenidx();
@@ -376,6 +419,14 @@ t_column::get_vlenidx() const {
 t_tscalar
 t_column::get_scalar(t_uindex idx) const {
     COLUMN_CHECK_ACCESS(idx);
+    if (m_is_packed.load(std::memory_order_acquire)) {
+        std::shared_ptr<const t_packed_column> packed = std::atomic_load(&m_packed);
+        if (packed) {
+            return packed->get_scalar(idx);
+        }
+    }
+
+    const t_lstore& data = *m_data;
     t_tscalar rv;
     rv.clear();
 
@@ -383,61 +434,61 @@ t_column::get_scalar(t_uindex idx) const {
         case DTYPE_NONE: {
         } break;
         case DTYPE_INT64: {
-            rv.set(*(m_data->get_nth<std::int64_t>(idx)));
+            rv.set(*(data.get_nth<std::int64_t>(idx)));
         } break;
         case DTYPE_INT32: {
-            rv.set(*(m_data->get_nth<std::int32_t>(idx)));
+            rv.set(*(data.get_nth<std::int32_t>(idx)));
         } break;
         case DTYPE_INT16: {
-            rv.set(*(m_data->get_nth<std::int16_t>(idx)));
+            rv.set(*(data.get_nth<std::int16_t>(idx)));
         } break;
         case DTYPE_INT8: {
-            rv.set(*(m_data->get_nth<std::int8_t>(idx)));
+            rv.set(*(data.get_nth<std::int8_t>(idx)));
         } break;
 
         case DTYPE_UINT64: {
-            rv.set(*(m_data->get_nth<std::uint64_t>(idx)));
+            rv.set(*(data.get_nth<std::uint64_t>(idx)));
         } break;
         case DTYPE_UINT32: {
-            rv.set(*(m_data->get_nth<std::uint32_t>(idx)));
+            rv.set(*(data.get_nth<std::uint32_t>(idx)));
         } break;
         case DTYPE_UINT16: {
-            rv.set(*(m_data->get_nth<std::uint16_t>(idx)));
+            rv.set(*(data.get_nth<std::uint16_t>(idx)));
         } break;
         case DTYPE_UINT8: {
-            rv.set(*(m_data->get_nth<std::uint8_t>(idx)));
+            rv.set(*(data.get_nth<std::uint8_t>(idx)));
         } break;
 
         case DTYPE_FLOAT64: {
-            rv.set(*(m_data->get_nth<double>(idx)));
+            rv.set(*(data.get_nth<double>(idx)));
         } break;
         case DTYPE_FLOAT32: {
-            rv.set(*(m_data->get_nth<float>(idx)));
+            rv.set(*(data.get_nth<float>(idx)));
         } break;
         case DTYPE_BOOL: {
-            rv.set(*(m_data->get_nth<bool>(idx)));
+            rv.set(*(data.get_nth<bool>(idx)));
         } break;
         case DTYPE_TIME: {
-            const t_time::t_rawtype* v = m_data->get_nth<t_time::t_rawtype>(idx);
+            const t_time::t_rawtype* v = data.get_nth<t_time::t_rawtype>(idx);
             rv.set(t_time(*v));
         } break;
         case DTYPE_DATE: {
-            const t_date::t_rawtype* v = m_data->get_nth<t_date::t_rawtype>(idx);
+            const t_date::t_rawtype* v = data.get_nth<t_date::t_rawtype>(idx);
             rv.set(t_date(*v));
         } break;
         case DTYPE_STR: {
             COLUMN_CHECK_STRCOL();
-            const t_uindex* sidx = m_data->get_nth<t_uindex>(idx);
+            const t_stridx* sidx = data.get_nth<t_stridx>(idx);
             rv.set(m_vocab->unintern_c(*sidx));
         } break;
         case DTYPE_F64PAIR: {
             const std::pair<double, double>* pair
-                = m_data->get_nth<std::pair<double, double>>(idx);
+                = data.get_nth<std::pair<double, double>>(idx);
             rv.set(pair->first / pair->second);
         } break;
         case DTYPE_OBJECT: {
             // set as uint64_t
-            rv.set(*(m_data->get_nth<std::uint64_t>(idx)));
+            rv.set(*(data.get_nth<std::uint64_t>(idx)));
 
             // Maintain DTYPE info
             rv.m_type = DTYPE_OBJECT;
@@ -464,8 +515,8 @@ void
 t_column::clear(t_uindex idx, t_status status) {
     switch (m_dtype) {
         case DTYPE_STR: {
-            t_uindex v = 0;
-            set_nth<t_uindex>(idx, v, status);
+            t_stridx v = 0;
+            set_nth<t_stridx>(idx, v, status);
         } break;
         case DTYPE_TIME:
         case DTYPE_FLOAT64:
@@ -514,7 +565,7 @@ const char*
 t_column::get_nth<const char>(t_uindex idx) const {
     COLUMN_CHECK_ACCESS(idx);
     COLUMN_CHECK_STRCOL();
-    const t_uindex* sidx = get_nth<t_uindex>(idx);
+    const t_stridx* sidx = get_nth<t_stridx>(idx);
     return m_vocab->unintern_c(*sidx);
 }
 
@@ -523,6 +574,7 @@ const t_status*
 t_column::get_nth_status(t_uindex idx) const {
     PSP_VERBOSE_ASSERT(is_status_enabled(), "Status not available for column");
     COLUMN_CHECK_ACCESS(idx);
+    unpack_if_packed();
     t_status* status = m_status->get_nth<t_status>(idx);
     return status;
 }
@@ -531,6 +583,13 @@ bool
 t_column::is_valid(t_uindex idx) const {
     PSP_VERBOSE_ASSERT(is_status_enabled(), "Status not available for column");
     COLUMN_CHECK_ACCESS(idx);
+    if (m_is_packed.load(std::memory_order_acquire)) {
+        std::shared_ptr<const t_packed_column> packed = std::atomic_load(&m_packed);
+        if (packed) {
+            return packed->get_status(idx) == STATUS_VALID;
+        }
+    }
+
     t_status status = *m_status->get_nth<t_status>(idx);
     return status == STATUS_VALID;
 }
@@ -539,6 +598,13 @@ bool
 t_column::is_cleared(t_uindex idx) const {
     PSP_VERBOSE_ASSERT(is_status_enabled(), "Status not available for column");
     COLUMN_CHECK_ACCESS(idx);
+    if (m_is_packed.load(std::memory_order_acquire)) {
+        std::shared_ptr<const t_packed_column> packed = std::atomic_load(&m_packed);
+        if (packed) {
+            return packed->get_status(idx) == STATUS_CLEAR;
+        }
+    }
+
     t_status status = *m_status->get_nth<t_status>(idx);
     return status == STATUS_CLEAR;
 }
@@ -578,6 +644,7 @@ t_column::set_valid(t_uindex idx, bool valid) {
 
 void
 t_column::set_status(t_uindex idx, t_status status) {
+    unpack_if_packed();
     m_status->set_nth<t_status>(idx, status);
 }
 
@@ -670,8 +737,14 @@ t_column::is_vlen() const {
 void
 t_column::append(const t_column& other) {
     PSP_VERBOSE_ASSERT(m_dtype == other.m_dtype, "Mismatched dtypes detected");
+    unpack_if_packed();
+    other.unpack_if_packed();
     if (is_vlen()) {
-        if (size() == 0) {
+        // A column attached to another shared vocabulary interns `other`'s
+        // strings one at a time.
+        bool keep_vocab = m_vocab->is_shared() && !shares_vocabulary(other);
+
+        if (size() == 0 && !keep_vocab) {
 
             m_data->fill(*other.m_data);
 
@@ -679,12 +752,21 @@ t_column::append(const t_column& other) {
                 m_status->fill(*other.m_status);
             }
 
-            m_vocab->fill(*(other.m_vocab->get_vlendata()), *(other.m_vocab->get_extents()),
-                other.m_vocab->get_vlenidx());
+            if (other.m_vocab->is_shared()) {
+                m_vocab = other.m_vocab;
+            } else {
+                m_vocab->fill(*(other.m_vocab->get_vlendata()), *(other.m_vocab->get_extents()),
+                    other.m_vocab->get_vlenidx());
+                m_vocab->rebuild_map();
+            }
 
             set_size(other.size());
-            m_vocab->rebuild_map();
         } else {
+            // At most every string of `other` is new.
+            m_data->reserve(m_elemsize * (size() + other.size() + 1));
+            reserve_vocabulary(
+                other.m_vocab->get_vlendata()->size(), other.m_vocab->get_vlenidx());
+
             for (t_uindex idx = 0, loop_end = other.size(); idx < loop_end; ++idx) {
                 const char* s = other.get_nth<const char>(idx);
                 push_back(s);
@@ -706,6 +788,13 @@ t_column::append(const t_column& other) {
 
 void
 t_column::clear() {
+    // A packed copy has nothing worth restoring.
+    if (is_packed()) {
+        std::lock_guard<std::mutex> lock(m_packed_mtx);
+        std::atomic_store(&m_packed, std::shared_ptr<const t_packed_column>());
+        m_is_packed = false;
+    }
+
     // clear out the data store
     m_data->set_size(0);
     if (m_dtype == DTYPE_STR)
@@ -733,6 +822,7 @@ t_column::pprint() const {
 
 t_column_recipe
 t_column::get_recipe() const {
+    unpack_if_packed();
     t_column_recipe rval;
     rval.m_dtype = m_dtype;
     rval.m_data = m_data->get_recipe();
@@ -753,16 +843,167 @@ t_column::get_recipe() const {
     return rval;
 }
 
+void
+t_column::reserve_vocabulary(t_uindex string_size, t_uindex string_count) {
+    COLUMN_CHECK_STRCOL();
+    m_vocab->reserve_additional(string_size, string_count);
+}
+
 void
 t_column::copy_vocabulary(const t_column* other) {
 #ifdef PSP_COLUMN_VERIFY
     other->verify();
 #endif
     COLUMN_CHECK_STRCOL();
+
+    // The rows of both columns hold ids into `other`'s vocabulary, so a
+    // shared one is borrowed rather than copied.
+    if (other->m_vocab->is_shared()) {
+        m_vocab = other->m_vocab;
+        return;
+    }
+
+    _unshare_vocabulary();
     m_vocab->copy_vocabulary(*(other->m_vocab.get()));
     COLUMN_CHECK_VALUES();
 }
 
+void
+t_column::clear_vocabulary() {
+    if (!is_vlen_dtype(m_dtype) || m_vocab.use_count() != 1 || m_vocab->is_shared())
+        return;
+    m_vocab->clear();
+}
+
+void
+t_column::compact_rows(const std::vector<t_uindex>& rows) {
+    unpack_if_packed();
+    t_uindex nrows = rows.size();
+    if (nrows > 0) {
+        // Each row moves down, so the rows it passes over have already been
+        // moved.
+        auto data = static_cast<unsigned char*>(m_data->get_ptr(0));
+        for (t_uindex idx = 0; idx < nrows; ++idx) {
+            if (rows[idx] != idx) {
+                memcpy(data + idx * m_elemsize, data + rows[idx] * m_elemsize, m_elemsize);
+            }
+        }
+
+        if (is_status_enabled()) {
+            auto status = static_cast<t_status*>(m_status->get_ptr(0));
+            for (t_uindex idx = 0; idx < nrows; ++idx) {
+                status[idx] = status[rows[idx]];
+            }
+        }
+    }
+
+    set_size(nrows);
+    m_data->shrink(m_elemsize * nrows);
+    if (is_status_enabled()) {
+        m_status->shrink(get_dtype_size(DTYPE_UINT8) * nrows);
+    }
+}
+
+void
+t_column::permute_rows(const std::vector<t_uindex>& rows) {
+    unpack_if_packed();
+    t_uindex nrows = rows.size();
+    PSP_VERBOSE_ASSERT(nrows == size(), "Permutation does not cover the column");
+    if (nrows == 0) {
+        return;
+    }
+
+    auto data = static_cast<unsigned char*>(m_data->get_ptr(0));
+    std::vector<unsigned char> src(data, data + nrows * m_elemsize);
+    for (t_uindex idx = 0; idx < nrows; ++idx) {
+        memcpy(data + idx * m_elemsize, src.data() + rows[idx] * m_elemsize, m_elemsize);
+    }
+
+    if (is_status_enabled()) {
+        auto status = static_cast<t_status*>(m_status->get_ptr(0));
+        std::vector<t_status> src_status(status, status + nrows);
+        for (t_uindex idx = 0; idx < nrows; ++idx) {
+            status[idx] = src_status[rows[idx]];
+        }
+    }
+}
+
+t_uindex
+t_column::compact_vocabulary(double min_dead_ratio) {
+    if (!is_vlen_dtype(m_dtype) || m_vocab.use_count() != 1 || m_vocab->is_shared())
+        return 0;
+
+    t_uindex vlenidx = m_vocab->get_vlenidx();
+    if (vlenidx == 0)
+        return 0;
+
+    std::vector<bool> live(vlenidx, false);
+    live[0] = true;
+    t_uindex nlive = 1;
+
+    t_stridx* sidx = m_data->get_nth<t_stridx>(0);
+    for (t_uindex idx = 0; idx < m_size; ++idx) {
+        if (is_status_enabled() && *get_nth_status(idx) != STATUS_VALID)
+            continue;
+        if (!live[sidx[idx]]) {
+            live[sidx[idx]] = true;
+            ++nlive;
+        }
+    }
+
+    t_uindex ndead = vlenidx - nlive;
+    if (ndead == 0 || static_cast<double>(ndead) < min_dead_ratio * double(vlenidx))
+        return 0;
+
+    std::vector<t_uindex> remap;
+    m_vocab->compact(live, remap);
+
+    // Rows that are not valid may hold any id
+    for (t_uindex idx = 0; idx < m_size; ++idx) {
+        sidx[idx] = sidx[idx] < vlenidx ? remap[sidx[idx]] : 0;
+    }
+
+    COLUMN_CHECK_VALUES();
+    return ndead;
+}
+
+void
+t_column::share_vocabulary(std::shared_ptr<t_vocab> vocab) {
+    COLUMN_CHECK_STRCOL();
+    vocab->set_shared(true);
+
+    if (m_vocab == vocab)
+        return;
+
+    t_uindex vlenidx = m_vocab->get_vlenidx();
+    t_stridx* sidx = m_data->get_nth<t_stridx>(0);
+    for (t_uindex idx = 0; idx < m_size; ++idx) {
+        bool valid = !is_status_enabled() || *get_nth_status(idx) == STATUS_VALID;
+        sidx[idx] = valid && sidx[idx] < vlenidx
+            ? vocab->get_interned(m_vocab->unintern_c(sidx[idx]))
+            : 0;
+    }
+
+    m_vocab = vocab;
+}
+
+std::shared_ptr<t_vocab>
+t_column::get_shared_vocabulary() {
+    COLUMN_CHECK_STRCOL();
+    m_vocab->set_shared(true);
+    return m_vocab;
+}
+
+bool
+t_column::is_vocabulary_shared() const {
+    return is_vlen_dtype(m_dtype) && m_vocab->is_shared();
+}
+
+bool
+t_column::shares_vocabulary(const t_column& other) const {
+    return is_vlen_dtype(m_dtype) && m_vocab == other.m_vocab;
+}
+
 void
 t_column::pprint_vocabulary() const {
     if (!is_vlen_dtype(m_dtype))
@@ -781,7 +1022,9 @@ t_column::clone() const {
         rval->m_status->fill(*m_status);
     }
 
-    if (is_vlen_dtype(get_dtype())) {
+    if (is_vocabulary_shared()) {
+        rval->m_vocab = m_vocab;
+    } else if (is_vlen_dtype(get_dtype())) {
         rval->m_vocab->clone(*m_vocab);
     }
 
@@ -791,6 +1034,23 @@ t_column::clone() const {
     return rval;
 }
 
+std::shared_ptr<t_column>
+t_column::snapshot() {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    unpack_if_packed();
+    auto rval = std::make_shared<t_column>();
+    rval->m_dtype = m_dtype;
+    rval->m_isvlen = m_isvlen;
+    rval->m_status_enabled = m_status_enabled;
+    rval->m_elemsize = m_elemsize;
+    rval->m_size = m_size;
+    rval->m_data = m_data->snapshot();
+    rval->m_status = is_status_enabled() ? m_status->snapshot() : std::make_shared<t_lstore>();
+    rval->m_vocab = m_isvlen ? m_vocab->snapshot() : std::make_shared<t_vocab>();
+    rval->m_init = true;
+    return rval;
+}
+
 std::shared_ptr<t_column>
 t_column::clone(const t_mask& mask) const {
     if (mask.count() == size()) {
@@ -807,7 +1067,9 @@ t_column::clone(const t_mask& mask) const {
         rval->m_status->fill(*m_status, mask, sizeof(t_status));
     }
 
-    if (is_vlen_dtype(get_dtype())) {
+    if (is_vocabulary_shared()) {
+        rval->m_vocab = m_vocab;
+    } else if (is_vlen_dtype(get_dtype())) {
         rval->m_vocab->clone(*m_vocab);
     }
 #ifdef PSP_COLUMN_VERIFY
@@ -818,9 +1080,95 @@ t_column::clone(const t_mask& mask) const {
 
 void
 t_column::valid_raw_fill() {
+    unpack_if_packed();
     m_status->raw_fill(STATUS_VALID);
 }
 
+namespace {
+
+// The statuses of the eight rows described by each bitmap byte.
+struct t_valid_bitmap_table {
+    t_valid_bitmap_table() {
+        for (t_uindex byte = 0; byte < 256; ++byte) {
+            for (t_uindex bit = 0; bit < 8; ++bit) {
+                m_statuses[byte][bit] = (byte >> bit) & 1 ? STATUS_VALID : STATUS_INVALID;
+            }
+        }
+    }
+
+    t_status m_statuses[256][8];
+};
+
+const t_valid_bitmap_table&
+get_valid_bitmap_table() {
+    static const t_valid_bitmap_table table;
+    return table;
+}
+
+} // end anonymous namespace
+
+void
+t_column::set_valid_bitmap(
+    const std::uint8_t* bitmap, t_uindex bit_offset, t_uindex offset, t_uindex len) {
+    PSP_VERBOSE_ASSERT(is_status_enabled(), "Status not available for column");
+    COLUMN_CHECK_ACCESS(offset + len);
+    unpack_if_packed();
+
+    t_status* status = m_status->get_nth<t_status>(offset);
+    t_uindex idx = 0;
+
+    // Leading bits up to a byte boundary of the bitmap
+    for (; idx < len && (bit_offset + idx) % 8 != 0; ++idx) {
+        t_uindex bit = bit_offset + idx;
+        status[idx] = (bitmap[bit / 8] >> (bit % 8)) & 1 ? STATUS_VALID : STATUS_INVALID;
+    }
+
+    const t_valid_bitmap_table& table = get_valid_bitmap_table();
+    for (; idx + 8 <= len; idx += 8) {
+        std::uint8_t byte = bitmap[(bit_offset + idx) / 8];
+        std::memcpy(status + idx, table.m_statuses[byte], 8 * sizeof(t_status));
+    }
+
+    for (; idx < len; ++idx) {
+        t_uindex bit = bit_offset + idx;
+        status[idx] = (bitmap[bit / 8] >> (bit % 8)) & 1 ? STATUS_VALID : STATUS_INVALID;
+    }
+}
+
+t_uindex
+t_column::get_valid_bitmap(t_uindex bidx, t_uindex eidx, std::uint8_t* out) const {
+    PSP_VERBOSE_ASSERT(bidx <= eidx, "Invalid bitmap range");
+    COLUMN_CHECK_ACCESS(eidx);
+
+    t_uindex len = eidx - bidx;
+    t_uindex nbytes = (len + 7) / 8;
+
+    if (!is_status_enabled()) {
+        std::memset(out, 0xFF, size_t(nbytes));
+        return 0;
+    }
+
+    unpack_if_packed();
+    const t_status* status = m_status->get_nth<t_status>(bidx);
+    t_uindex valid_count = 0;
+
+    for (t_uindex byte_idx = 0; byte_idx < nbytes; ++byte_idx) {
+        t_uindex begin = byte_idx * 8;
+        t_uindex end = std::min(begin + 8, len);
+        std::uint8_t byte = 0;
+
+        for (t_uindex idx = begin; idx < end; ++idx) {
+            std::uint8_t valid = status[idx] == STATUS_VALID;
+            byte |= valid << (idx - begin);
+            valid_count += valid;
+        }
+
+        out[byte_idx] = byte;
+    }
+
+    return len - valid_count;
+}
+
 void
 t_column::copy(const t_column* other, const std::vector<t_uindex>& indices, t_uindex offset) {
     PSP_VERBOSE_ASSERT(m_dtype == other->get_dtype(), "Cannot copy from diff dtype");
@@ -917,7 +1265,7 @@ t_column::verify() const {
 
 void
 t_column::verify_size(t_uindex idx) const {
-    if (m_dtype == DTYPE_USER_FIXED)
+    if (m_dtype == DTYPE_USER_FIXED || is_packed())
         return;
 
     PSP_VERBOSE_ASSERT(idx * get_dtype_size(m_dtype) <= m_data->capacity(),
@@ -956,4 +1304,156 @@ t_column::borrow_vocabulary(const t_column& o) {
     m_vocab = const_cast<t_column&>(o).m_vocab;
 }
 
+void
+t_column::_unshare_vocabulary() {
+    if (!is_vlen_dtype(m_dtype) || !m_vocab->is_shared())
+        return;
+    m_vocab.reset(new t_vocab(
+        m_vocab->get_vlendata()->get_recipe(), m_vocab->get_extents()->get_recipe()));
+    m_vocab->init(false);
+}
+
+void
+t_column::save(const std::string& prefix) const {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    PSP_VERBOSE_ASSERT(m_dtype != DTYPE_OBJECT, "Cannot save a column of objects");
+    unpack_if_packed();
+    m_data->save(prefix + ".data");
+
+    if (is_status_enabled()) {
+        m_status->save(prefix + ".status");
+    }
+
+    if (is_vlen_dtype(m_dtype)) {
+        m_vocab->get_vlendata()->save(prefix + ".vlendata");
+        m_vocab->get_extents()->save(prefix + ".extents");
+    }
+}
+
+void
+t_column::load(const std::string& prefix, const t_column_recipe& recipe) {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    PSP_VERBOSE_ASSERT(recipe.m_dtype == m_dtype, "Loading column of mismatched dtype");
+    PSP_VERBOSE_ASSERT(
+        recipe.m_status_enabled == m_status_enabled, "Loading column of mismatched status");
+    unpack_if_packed();
+
+    // The saved files hold each store's capacity, so map only the sizes
+    // from the recipe.
+    m_data->map(prefix + ".data", recipe.m_data.m_size);
+
+    if (is_status_enabled()) {
+        m_status->map(prefix + ".status", recipe.m_status.m_size);
+    }
+
+    if (is_vlen_dtype(m_dtype)) {
+        // The saved strings replace the vocabulary, which must not be one
+        // other columns refer to.
+        _unshare_vocabulary();
+        m_vocab->get_vlendata()->map(prefix + ".vlendata", recipe.m_vlendata.m_size);
+        m_vocab->get_extents()->map(prefix + ".extents", recipe.m_extents.m_size);
+        m_vocab->set_vlenidx(recipe.m_vlenidx);
+        m_vocab->rebuild_map();
+    }
+
+    m_size = recipe.m_size;
+}
+
+void
+t_column::borrow_data(const void* base, t_uindex size, std::shared_ptr<const void> owner) {
+    PSP_VERBOSE_ASSERT(!m_isvlen, "Cannot borrow data for a vlen column");
+    unpack_if_packed();
+    m_data->borrow(base, size * m_elemsize, owner);
+    m_size = size;
+}
+
+bool
+t_column::spill(const std::string& dirname) {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    // A packed column holds little to spill.
+    if (is_packed()) {
+        return false;
+    }
+
+    bool spilled = m_data->spill(dirname);
+    if (is_status_enabled()) {
+        spilled = m_status->spill(dirname) || spilled;
+    }
+    return spilled;
+}
+
+void
+t_column::reload() {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    m_data->reload();
+    if (is_status_enabled()) {
+        m_status->reload();
+    }
+}
+
+bool
+t_column::is_spilled() const {
+    return m_data->is_spilled() || (is_status_enabled() && m_status->is_spilled());
+}
+
+bool
+t_column::pack() {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    if (is_packed() || m_size == 0 || !t_packed_column::is_packable(m_dtype) || is_spilled()) {
+        return false;
+    }
+
+    auto packed = std::make_shared<const t_packed_column>(*this);
+    if (packed->nbytes() >= nbytes()) {
+        return false;
+    }
+
+    std::atomic_store(&m_packed, packed);
+    m_is_packed.store(true, std::memory_order_release);
+
+    m_data->set_size(0);
+    m_data->shrink(0);
+
+    if (is_status_enabled()) {
+        m_status->set_size(0);
+        m_status->shrink(0);
+    }
+
+    return true;
+}
+
+void
+t_column::unpack() {
+    unpack_if_packed();
+}
+
+bool
+t_column::is_packed() const {
+    return m_is_packed.load(std::memory_order_acquire);
+}
+
+bool
+t_column::_gather_packed(const t_uindex* bidx, const t_uindex* eidx, std::int64_t* out) const {
+    std::shared_ptr<const t_packed_column> packed = std::atomic_load(&m_packed);
+    if (!packed) {
+        return false;
+    }
+
+    packed->gather(bidx, eidx, out);
+    return true;
+}
+
+void
+t_column::_unpack() const {
+    std::lock_guard<std::mutex> lock(m_packed_mtx);
+    if (!m_is_packed.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    // Readers of the packed copy keep it alive until they are done.
+    m_packed->unpack(*m_data, is_status_enabled() ? m_status.get() : nullptr);
+    m_is_packed.store(false, std::memory_order_release);
+    std::atomic_store(&m_packed, std::shared_ptr<const t_packed_column>());
+}
+
 } // end namespace perspective
@@ -0,0 +1,507 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2017, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#include <perspective/first.h>
+#include <perspective/column_filter.h>
+#include <perspective/kernels.h>
+#include <perspective/vocab.h>
+#include <tsl/hopscotch_set.h>
+#include <algorithm>
+#include <cstring>
+
+// Bags of `in` terms larger than this are looked up in a hash set rather
+// than scanned.
+#define PSP_FILTER_BAG_HASH_SIZE 8
+
+namespace perspective {
+
+/**
+ * @brief The values of an `in` term, as raw values of the column's storage
+ * type or as vocabulary ids, built once per evaluation of the term.
+ */
+template <typename DATA_T>
+class t_filter_bag {
+public:
+    void
+    insert(DATA_T value) {
+        m_values.push_back(value);
+        if (m_values.size() == PSP_FILTER_BAG_HASH_SIZE + 1) {
+            m_set.insert(m_values.begin(), m_values.end());
+        } else if (m_values.size() > PSP_FILTER_BAG_HASH_SIZE) {
+            m_set.insert(value);
+        }
+    }
+
+    inline bool
+    contains(DATA_T value) const {
+        if (!m_set.empty()) {
+            return m_set.find(value) != m_set.end();
+        }
+
+        for (const auto& v : m_values) {
+            if (v == value) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    std::vector<DATA_T> m_values;
+    tsl::hopscotch_set<DATA_T> m_set;
+};
+
+template <typename DATA_T>
+inline DATA_T
+filter_threshold(const t_tscalar& threshold) {
+    DATA_T rval;
+    std::memcpy(&rval, &threshold.m_data, sizeof(DATA_T));
+    return rval;
+}
+
+/**
+ * @brief Evaluate a comparison term with a threshold of the column's own
+ * dtype over the raw column buffer. Returns false if the term cannot be
+ * evaluated this way.
+ */
+template <typename DATA_T>
+bool
+filter_column_typed(const t_column& column, const t_fterm& fterm, t_uindex nrows,
+    std::uint8_t* out) {
+    const DATA_T* data = column.get_nth<DATA_T>(0);
+    t_dtype dtype = column.get_dtype();
+
+    switch (fterm.m_op) {
+        case FILTER_OP_LT:
+        case FILTER_OP_LTEQ:
+        case FILTER_OP_GT:
+        case FILTER_OP_GTEQ:
+        case FILTER_OP_EQ:
+        case FILTER_OP_NE: {
+            if (fterm.m_threshold.get_dtype() != dtype || !fterm.m_threshold.is_valid()) {
+                return false;
+            }
+        } break;
+        case FILTER_OP_IN:
+        case FILTER_OP_NOT_IN:
+        case FILTER_OP_IS_NULL:
+        case FILTER_OP_IS_NOT_NULL:
+            break;
+        default:
+            return false;
+    }
+
+    DATA_T threshold = filter_threshold<DATA_T>(fterm.m_threshold);
+
+    switch (fterm.m_op) {
+        case FILTER_OP_LT:
+        case FILTER_OP_LTEQ:
+        case FILTER_OP_GT:
+        case FILTER_OP_GTEQ:
+        case FILTER_OP_EQ:
+        case FILTER_OP_NE: {
+            kernel_compare(data, threshold, fterm.m_op, nrows, out);
+        } break;
+        case FILTER_OP_IN:
+        case FILTER_OP_NOT_IN: {
+            // Bag values of another dtype, or null, never equal a valid cell.
+            t_filter_bag<typename t_filter_bits<DATA_T>::type> bag;
+            for (const auto& v : fterm.m_bag) {
+                if (v.get_dtype() == dtype && v.is_valid()) {
+                    bag.insert(filter_bits(filter_threshold<DATA_T>(v)));
+                }
+            }
+
+            std::uint8_t found = fterm.m_op == FILTER_OP_IN ? 1 : 0;
+            for (t_uindex idx = 0; idx < nrows; ++idx) {
+                out[idx] = bag.contains(filter_bits(data[idx])) ? found : 1 - found;
+            }
+        } break;
+        case FILTER_OP_IS_NULL: {
+            std::memset(out, 0, nrows);
+        } break;
+        case FILTER_OP_IS_NOT_NULL: {
+            std::memset(out, 1, nrows);
+        } break;
+        default:
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Evaluate an equality or `in` term over a string column by
+ * vocabulary id, looking the term's strings up in the column's vocabulary
+ * once: a string the vocabulary does not hold matches no row. `interned`
+ * terms already hold the id of their threshold. Returns false for other
+ * terms. Like `filter_column_typed`, this does not apply `m_negated`.
+ */
+bool
+filter_column_ids(const t_column& column, const t_fterm& fterm, bool interned,
+    t_uindex nrows, std::uint8_t* out) {
+    const t_stridx* data = column.get_nth<t_stridx>(0);
+    const t_vocab* vocab = column._get_vocab();
+    t_filter_bag<t_stridx> ids;
+    t_uindex id;
+
+    switch (fterm.m_op) {
+        case FILTER_OP_EQ:
+        case FILTER_OP_NE: {
+            if (interned) {
+                ids.insert(static_cast<t_stridx>(fterm.m_threshold.to_uint64()));
+            } else if (fterm.m_threshold.get_dtype() != DTYPE_STR
+                || !fterm.m_threshold.is_valid()) {
+                return false;
+            } else if (vocab->string_exists(fterm.m_threshold.get_char_ptr(), id)) {
+                ids.insert(static_cast<t_stridx>(id));
+            }
+        } break;
+        case FILTER_OP_IN:
+        case FILTER_OP_NOT_IN: {
+            for (const auto& v : fterm.m_bag) {
+                if (v.get_dtype() == DTYPE_STR && v.is_valid()
+                    && vocab->string_exists(v.get_char_ptr(), id)) {
+                    ids.insert(static_cast<t_stridx>(id));
+                }
+            }
+        } break;
+        default:
+            return false;
+    }
+
+    std::uint8_t found = fterm.m_op == FILTER_OP_EQ || fterm.m_op == FILTER_OP_IN ? 1 : 0;
+    for (t_uindex idx = 0; idx < nrows; ++idx) {
+        out[idx] = ids.contains(data[idx]) ? found : 1 - found;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Evaluate `fterm` once per vocabulary entry referenced by a string
+ * column, then look each row's result up by its vocabulary index. Returns
+ * false if the column's vocabulary is too large relative to `nrows` for
+ * this to pay off.
+ */
+bool
+filter_column_vocab(const t_column& column, const t_fterm& fterm, bool interned,
+    t_uindex nrows, std::uint8_t* out) {
+    const t_stridx* data = column.get_nth<t_stridx>(0);
+
+    t_uindex vocab_size = 0;
+    for (t_uindex idx = 0; idx < nrows; ++idx) {
+        vocab_size = std::max(vocab_size, static_cast<t_uindex>(data[idx]) + 1);
+    }
+
+    if (vocab_size > 2 * nrows + 64) {
+        return false;
+    }
+
+    std::vector<std::uint8_t> results(vocab_size);
+    t_tscalar value;
+    for (t_uindex vidx = 0; vidx < vocab_size; ++vidx) {
+        if (interned) {
+            value.set(vidx);
+        } else {
+            value.set(column.unintern_c(vidx));
+        }
+        results[vidx] = fterm(value);
+    }
+
+    for (t_uindex idx = 0; idx < nrows; ++idx) {
+        out[idx] = results[data[idx]];
+    }
+
+    return true;
+}
+
+void
+filter_column(const t_column& column, const t_fterm& fterm, bool fail_invalid, t_uindex nrows,
+    std::uint8_t* out) {
+    if (nrows == 0) {
+        return;
+    }
+
+    // `filter_cpp` compares interned string terms by vocabulary index, and
+    // does not check the validity of such cells, only under FILTER_OP_AND.
+    bool interned = fterm.m_use_interned && fail_invalid;
+    bool done = false;
+
+    switch (column.get_dtype()) {
+        case DTYPE_INT64: {
+            done = filter_column_typed<std::int64_t>(column, fterm, nrows, out);
+        } break;
+        case DTYPE_INT32: {
+            done = filter_column_typed<std::int32_t>(column, fterm, nrows, out);
+        } break;
+        case DTYPE_INT16: {
+            done = filter_column_typed<std::int16_t>(column, fterm, nrows, out);
+        } break;
+        case DTYPE_INT8: {
+            done = filter_column_typed<std::int8_t>(column, fterm, nrows, out);
+        } break;
+        case DTYPE_UINT64: {
+            done = filter_column_typed<std::uint64_t>(column, fterm, nrows, out);
+        } break;
+        case DTYPE_UINT32: {
+            done = filter_column_typed<std::uint32_t>(column, fterm, nrows, out);
+        } break;
+        case DTYPE_UINT16: {
+            done = filter_column_typed<std::uint16_t>(column, fterm, nrows, out);
+        } break;
+        case DTYPE_UINT8: {
+            done = filter_column_typed<std::uint8_t>(column, fterm, nrows, out);
+        } break;
+        case DTYPE_FLOAT64: {
+            done = filter_column_typed<double>(column, fterm, nrows, out);
+        } break;
+        case DTYPE_FLOAT32: {
+            done = filter_column_typed<float>(column, fterm, nrows, out);
+        } break;
+        case DTYPE_BOOL: {
+            done = filter_column_typed<bool>(column, fterm, nrows, out);
+        } break;
+        case DTYPE_DATE: {
+            done = filter_column_typed<std::uint32_t>(column, fterm, nrows, out);
+        } break;
+        case DTYPE_TIME: {
+            done = filter_column_typed<std::int64_t>(column, fterm, nrows, out);
+        } break;
+        case DTYPE_STR: {
+            // Interned terms already compare by vocabulary index.
+            if (fterm.m_use_interned && !interned) {
+                break;
+            }
+
+            done = filter_column_ids(column, fterm, interned, nrows, out);
+
+            // Interned terms do not check the validity of cells.
+            if (done && interned) {
+                if (fterm.m_negated) {
+                    for (t_uindex idx = 0; idx < nrows; ++idx) {
+                        out[idx] ^= 1;
+                    }
+                }
+                return;
+            } else if (done) {
+                break;
+            }
+
+            done = filter_column_vocab(column, fterm, interned, nrows, out);
+
+            if (done) {
+                // `fterm` was applied through `operator()`, which already
+                // handles negation.
+                if (column.is_status_enabled() && !interned) {
+                    for (t_uindex idx = 0; idx < nrows; ++idx) {
+                        if (*column.get_nth_status(idx) != STATUS_VALID) {
+                            t_tscalar cell = column.get_scalar(idx);
+                            out[idx] = !(fail_invalid && fterm.m_op != FILTER_OP_IS_NULL)
+                                && fterm(cell);
+                        }
+                    }
+                }
+                return;
+            }
+        } break;
+        default:
+            break;
+    }
+
+    if (done) {
+        if (fterm.m_negated) {
+            for (t_uindex idx = 0; idx < nrows; ++idx) {
+                out[idx] ^= 1;
+            }
+        }
+
+        // Invalid cells compare by status rather than value, so evaluate
+        // them individually.
+        if (column.is_status_enabled()) {
+            for (t_uindex idx = 0; idx < nrows; ++idx) {
+                if (*column.get_nth_status(idx) != STATUS_VALID) {
+                    t_tscalar cell = column.get_scalar(idx);
+                    out[idx]
+                        = !(fail_invalid && fterm.m_op != FILTER_OP_IS_NULL) && fterm(cell);
+                }
+            }
+        }
+        return;
+    }
+
+    t_tscalar cell;
+    for (t_uindex idx = 0; idx < nrows; ++idx) {
+        if (interned) {
+            cell.set(static_cast<t_uindex>(*(column.get_nth<t_stridx>(idx))));
+            out[idx] = fterm(cell);
+        } else {
+            cell = column.get_scalar(idx);
+            out[idx] = !(fail_invalid && fterm.m_op != FILTER_OP_IS_NULL && !cell.is_valid())
+                && fterm(cell);
+        }
+    }
+}
+
+/**
+ * @brief Compare two columns of the same dtype row by row over their raw
+ * buffers, ignoring validity. Returns false for ops other than comparisons.
+ */
+template <typename DATA_T>
+bool
+filter_column_pair_typed(const t_column& lhs, t_filter_op op, const t_column& rhs,
+    t_uindex nrows, std::uint8_t* out) {
+    const DATA_T* a = lhs.get_nth<DATA_T>(0);
+    const DATA_T* b = rhs.get_nth<DATA_T>(0);
+
+    switch (op) {
+        case FILTER_OP_LT: {
+            for (t_uindex idx = 0; idx < nrows; ++idx) {
+                out[idx] = a[idx] < b[idx];
+            }
+        } break;
+        case FILTER_OP_LTEQ: {
+            for (t_uindex idx = 0; idx < nrows; ++idx) {
+                out[idx] = a[idx] < b[idx] || filter_bits_eq(a[idx], b[idx]);
+            }
+        } break;
+        case FILTER_OP_GT: {
+            for (t_uindex idx = 0; idx < nrows; ++idx) {
+                out[idx] = a[idx] > b[idx];
+            }
+        } break;
+        case FILTER_OP_GTEQ: {
+            for (t_uindex idx = 0; idx < nrows; ++idx) {
+                out[idx] = a[idx] > b[idx] || filter_bits_eq(a[idx], b[idx]);
+            }
+        } break;
+        case FILTER_OP_EQ: {
+            for (t_uindex idx = 0; idx < nrows; ++idx) {
+                out[idx] = filter_bits_eq(a[idx], b[idx]);
+            }
+        } break;
+        case FILTER_OP_NE: {
+            for (t_uindex idx = 0; idx < nrows; ++idx) {
+                out[idx] = !filter_bits_eq(a[idx], b[idx]);
+            }
+        } break;
+        default:
+            return false;
+    }
+
+    return true;
+}
+
+void
+filter_column_pair(const t_column& lhs, t_filter_op op, const t_column& rhs, t_uindex nrows,
+    std::uint8_t* out) {
+    if (nrows == 0) {
+        return;
+    }
+
+    bool done = false;
+    if (lhs.get_dtype() == rhs.get_dtype()) {
+        switch (lhs.get_dtype()) {
+            case DTYPE_INT64:
+            case DTYPE_TIME: {
+                done = filter_column_pair_typed<std::int64_t>(lhs, op, rhs, nrows, out);
+            } break;
+            case DTYPE_INT32: {
+                done = filter_column_pair_typed<std::int32_t>(lhs, op, rhs, nrows, out);
+            } break;
+            case DTYPE_INT16: {
+                done = filter_column_pair_typed<std::int16_t>(lhs, op, rhs, nrows, out);
+            } break;
+            case DTYPE_INT8: {
+                done = filter_column_pair_typed<std::int8_t>(lhs, op, rhs, nrows, out);
+            } break;
+            case DTYPE_UINT64: {
+                done = filter_column_pair_typed<std::uint64_t>(lhs, op, rhs, nrows, out);
+            } break;
+            case DTYPE_UINT32:
+            case DTYPE_DATE: {
+                done = filter_column_pair_typed<std::uint32_t>(lhs, op, rhs, nrows, out);
+            } break;
+            case DTYPE_UINT16: {
+                done = filter_column_pair_typed<std::uint16_t>(lhs, op, rhs, nrows, out);
+            } break;
+            case DTYPE_UINT8: {
+                done = filter_column_pair_typed<std::uint8_t>(lhs, op, rhs, nrows, out);
+            } break;
+            case DTYPE_FLOAT64: {
+                done = filter_column_pair_typed<double>(lhs, op, rhs, nrows, out);
+            } break;
+            case DTYPE_FLOAT32: {
+                done = filter_column_pair_typed<float>(lhs, op, rhs, nrows, out);
+            } break;
+            case DTYPE_BOOL: {
+                done = filter_column_pair_typed<bool>(lhs, op, rhs, nrows, out);
+            } break;
+            default:
+                break;
+        }
+    }
+
+    if (done) {
+        if (lhs.is_status_enabled() || rhs.is_status_enabled()) {
+            for (t_uindex idx = 0; idx < nrows; ++idx) {
+                if ((lhs.is_status_enabled() && *lhs.get_nth_status(idx) != STATUS_VALID)
+                    || (rhs.is_status_enabled() && *rhs.get_nth_status(idx) != STATUS_VALID)) {
+                    out[idx] = 0;
+                }
+            }
+        }
+        return;
+    }
+
+    for (t_uindex idx = 0; idx < nrows; ++idx) {
+        t_tscalar a = lhs.get_scalar(idx);
+        t_tscalar b = rhs.get_scalar(idx);
+        if (!a.is_valid() || !b.is_valid()) {
+            out[idx] = 0;
+        } else if (a.get_dtype() != b.get_dtype() && a.is_numeric() && b.is_numeric()) {
+            out[idx] = mktscalar(a.to_double()).cmp(op, mktscalar(b.to_double()));
+        } else {
+            out[idx] = a.cmp(op, b);
+        }
+    }
+}
+
+t_mask
+filter_columns(const std::vector<const t_column*>& columns, const std::vector<t_fterm>& fterms,
+    t_filter_op combiner, t_uindex nrows) {
+    bool is_and = false;
+
+    switch (combiner) {
+        case FILTER_OP_AND: {
+            is_and = true;
+        } break;
+        case FILTER_OP_OR: {
+            is_and = false;
+        } break;
+        default: { PSP_COMPLAIN_AND_ABORT("Unknown filter op"); } break;
+    }
+
+    std::vector<std::uint8_t> rval(nrows, is_and ? 1 : 0);
+    std::vector<std::uint8_t> term(nrows);
+
+    for (t_uindex cidx = 0, loop_end = fterms.size(); cidx < loop_end; ++cidx) {
+        filter_column(*columns[cidx], fterms[cidx], is_and, nrows, term.data());
+
+        if (is_and) {
+            kernel_and(rval.data(), term.data(), nrows);
+        } else {
+            kernel_or(rval.data(), term.data(), nrows);
+        }
+    }
+
+    return t_mask(rval.data(), nrows);
+}
+
+} // end namespace perspective
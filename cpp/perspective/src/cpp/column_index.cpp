@@ -0,0 +1,76 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#include <perspective/first.h>
+#include <perspective/column_index.h>
+
+namespace perspective {
+
+t_column_index::t_column_index()
+    : m_size(0) {}
+
+void
+t_column_index::build(const t_column& column, t_uindex nrows) {
+    PSP_VERBOSE_ASSERT(column.get_dtype() == DTYPE_STR, "Only string columns can be indexed");
+    m_rows.clear();
+    m_size = 0;
+    for (t_uindex ridx = 0; ridx < nrows; ++ridx) {
+        if (column.is_valid(ridx)) {
+            add(ridx, *(column.get_nth<t_stridx>(ridx)));
+        }
+    }
+}
+
+void
+t_column_index::add(t_uindex ridx, t_stridx id) {
+    if (id >= m_rows.size()) {
+        m_rows.resize(id + 1);
+    }
+
+    std::vector<t_uindex>& rows = m_rows[id];
+    // A row written the same value twice in a row is only recorded once.
+    if (rows.empty() || rows.back() != ridx) {
+        rows.push_back(ridx);
+        ++m_size;
+    }
+}
+
+void
+t_column_index::get_rows(
+    const t_column& column, const std::vector<t_stridx>& ids, t_mask& mask) const {
+    t_uindex nrows = column.size();
+    for (t_stridx id : ids) {
+        if (id >= m_rows.size()) {
+            continue;
+        }
+
+        for (t_uindex ridx : m_rows[id]) {
+            if (ridx < nrows && column.is_valid(ridx)
+                && *(column.get_nth<t_stridx>(ridx)) == id) {
+                mask.set(ridx, true);
+            }
+        }
+    }
+}
+
+bool
+t_column_index::needs_rebuild(t_uindex nrows) const {
+    return m_size > 2 * nrows;
+}
+
+t_uindex
+t_column_index::nbytes() const {
+    t_uindex rval = m_rows.capacity() * sizeof(std::vector<t_uindex>);
+    for (const auto& rows : m_rows) {
+        rval += rows.capacity() * sizeof(t_uindex);
+    }
+    return rval;
+}
+
+} // end namespace perspective
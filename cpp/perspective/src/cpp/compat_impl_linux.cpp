@@ -14,6 +14,7 @@
 #include <perspective/raii.h>
 #include <perspective/raw_types.h>
 #include <perspective/utils.h>
+#include <dirent.h>
 #include <fcntl.h>
 #include <sys/mman.h>
 #include <sys/mman.h>
@@ -23,6 +24,7 @@
 #include <sys/types.h>
 #include <unistd.h>
 #include <stdio.h>
+#include <algorithm>
 
 namespace perspective {
 static void map_file_internal_(const std::string& fname, t_fflag fflag, t_fflag fmode,
@@ -154,11 +156,167 @@ set_thread_name(const std::string& name) {
     PSP_COMPLAIN_AND_ABORT("Not implemented");
 }
 
+std::vector<t_uindex>
+get_thread_affinity() {
+    std::vector<t_uindex> cpus;
+#ifdef PSP_PARALLEL_FOR
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset) == 0) {
+        for (t_uindex cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &cpuset)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+#endif
+    return cpus;
+}
+
+void
+set_thread_affinity(const std::vector<t_uindex>& cpus) {
+#ifdef PSP_PARALLEL_FOR
+    if (cpus.empty()) {
+        return;
+    }
+
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    for (auto cpu : cpus) {
+        if (cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &cpuset);
+        }
+    }
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+#endif
+}
+
+// The memory policies of `set_mempolicy`, as in <numaif.h>, which is only
+// installed with libnuma.
+#define PSP_MPOL_DEFAULT 0
+#define PSP_MPOL_PREFERRED 1
+#define PSP_NUMA_MAX_NODES 1024
+#define PSP_NUMA_MASK_BITS (sizeof(unsigned long) * 8)
+
+t_uindex
+get_num_numa_nodes() {
+    t_uindex nnodes = 0;
+    while (true) {
+        std::string dirname = "/sys/devices/system/node/node" + std::to_string(nnodes);
+        DIR* dir = opendir(dirname.c_str());
+        if (dir == nullptr) {
+            break;
+        }
+        closedir(dir);
+        ++nnodes;
+    }
+    return std::max(nnodes, t_uindex(1));
+}
+
+std::vector<t_uindex>
+get_numa_node_cpus(t_uindex node) {
+    std::vector<t_uindex> cpus;
+    std::string fname = "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+    std::FILE* f = fopen(fname.c_str(), "r");
+    if (f == nullptr) {
+        return cpus;
+    }
+
+    // A list of ranges, e.g. `0-3,8-11`.
+    unsigned long first, last;
+    while (fscanf(f, "%lu", &first) == 1) {
+        last = first;
+        int sep = fgetc(f);
+        if (sep == '-') {
+            if (fscanf(f, "%lu", &last) != 1) {
+                break;
+            }
+            sep = fgetc(f);
+        }
+
+        for (unsigned long cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+
+        if (sep != ',') {
+            break;
+        }
+    }
+    fclose(f);
+    return cpus;
+}
+
+t_index
+get_thread_numa_node() {
+#ifdef PSP_PARALLEL_FOR
+    int mode = PSP_MPOL_DEFAULT;
+    unsigned long mask[PSP_NUMA_MAX_NODES / PSP_NUMA_MASK_BITS] = {0};
+    if (syscall(SYS_get_mempolicy, &mode, mask, PSP_NUMA_MAX_NODES + 1, nullptr, 0) == 0
+        && mode == PSP_MPOL_PREFERRED) {
+        for (t_uindex node = 0; node < PSP_NUMA_MAX_NODES; ++node) {
+            if (mask[node / PSP_NUMA_MASK_BITS] & (1UL << (node % PSP_NUMA_MASK_BITS))) {
+                return static_cast<t_index>(node);
+            }
+        }
+    }
+#endif
+    return -1;
+}
+
+void
+set_thread_numa_node(t_index node) {
+#ifdef PSP_PARALLEL_FOR
+    if (node < 0 || node >= PSP_NUMA_MAX_NODES) {
+        syscall(SYS_set_mempolicy, PSP_MPOL_DEFAULT, nullptr, 0);
+        return;
+    }
+
+    unsigned long mask[PSP_NUMA_MAX_NODES / PSP_NUMA_MASK_BITS] = {0};
+    mask[node / PSP_NUMA_MASK_BITS] = 1UL << (node % PSP_NUMA_MASK_BITS);
+    syscall(SYS_set_mempolicy, PSP_MPOL_PREFERRED, mask, PSP_NUMA_MAX_NODES + 1);
+#endif
+}
+
 void
 rmfile(const std::string& fname) {
     unlink(fname.c_str());
 }
 
+void
+sync_file(std::FILE* file) {
+    t_index rcode = fflush(file);
+    PSP_VERBOSE_ASSERT(rcode == 0, "Error in fflush");
+    rcode = fdatasync(fileno(file));
+    PSP_VERBOSE_ASSERT(rcode == 0, "Error in fdatasync");
+}
+
+void
+sync_dir(const std::string& dirname) {
+    DIR* dir = opendir(dirname.c_str());
+    PSP_VERBOSE_ASSERT(dir != nullptr, "Error in opendir");
+    while (struct dirent* entry = readdir(dir)) {
+        std::string fname = dirname + "/" + entry->d_name;
+        struct stat st;
+        if (stat(fname.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+            continue;
+        }
+
+        t_handle fd = open(fname.c_str(), O_RDONLY);
+        PSP_VERBOSE_ASSERT(fd != -1, "Error opening file");
+        t_index rcode = fsync(fd);
+        close(fd);
+        PSP_VERBOSE_ASSERT(rcode == 0, "Error in fsync");
+    }
+    closedir(dir);
+
+    // Sync the directory too, so that files added to or removed from it are.
+    t_handle fd = open(dirname.c_str(), O_RDONLY);
+    PSP_VERBOSE_ASSERT(fd != -1, "Error opening directory");
+    t_index rcode = fsync(fd);
+    close(fd);
+    PSP_VERBOSE_ASSERT(rcode == 0, "Error in fsync");
+}
+
 void
 launch_proc(const std::string& cmdline) {
     PSP_COMPLAIN_AND_ABORT("Not implemented");
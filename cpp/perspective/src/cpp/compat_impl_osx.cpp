@@ -14,6 +14,7 @@
 #include <perspective/raii.h>
 #include <perspective/raw_types.h>
 #include <perspective/utils.h>
+#include <dirent.h>
 #include <fcntl.h>
 #include <sys/mman.h>
 #include <sys/mman.h>
@@ -153,11 +154,73 @@ set_thread_name(const std::string& name) {
     PSP_COMPLAIN_AND_ABORT("Not implemented");
 }
 
+std::vector<t_uindex>
+get_thread_affinity() {
+    // macOS has no API to pin threads to CPUs.
+    return std::vector<t_uindex>();
+}
+
+void
+set_thread_affinity(const std::vector<t_uindex>& cpus) {}
+
+t_uindex
+get_num_numa_nodes() {
+    return 1;
+}
+
+std::vector<t_uindex>
+get_numa_node_cpus(t_uindex node) {
+    return std::vector<t_uindex>();
+}
+
+t_index
+get_thread_numa_node() {
+    return -1;
+}
+
+void
+set_thread_numa_node(t_index node) {}
+
 void
 rmfile(const std::string& fname) {
     unlink(fname.c_str());
 }
 
+void
+sync_file(std::FILE* file) {
+    t_index rcode = fflush(file);
+    PSP_VERBOSE_ASSERT(rcode == 0, "Error in fflush");
+    rcode = fsync(fileno(file));
+    PSP_VERBOSE_ASSERT(rcode == 0, "Error in fsync");
+}
+
+void
+sync_dir(const std::string& dirname) {
+    DIR* dir = opendir(dirname.c_str());
+    PSP_VERBOSE_ASSERT(dir != nullptr, "Error in opendir");
+    while (struct dirent* entry = readdir(dir)) {
+        std::string fname = dirname + "/" + entry->d_name;
+        struct stat st;
+        if (stat(fname.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+            continue;
+        }
+
+        t_handle fd = open(fname.c_str(), O_RDONLY);
+        PSP_VERBOSE_ASSERT(fd != -1, "Error opening file");
+        t_index rcode = fsync(fd);
+        close(fd);
+        PSP_VERBOSE_ASSERT(rcode == 0, "Error in fsync");
+    }
+    closedir(dir);
+
+    // Sync the directory too, so that files added to or removed from it are.
+    t_handle fd = open(dirname.c_str(), O_RDONLY);
+    PSP_VERBOSE_ASSERT(fd != -1, "Error opening directory");
+    t_index rcode = fsync(fd);
+    close(fd);
+    PSP_VERBOSE_ASSERT(rcode == 0, "Error in fsync");
+}
+
 void
 launch_proc(const std::string& cmdline) {
     PSP_COMPLAIN_AND_ABORT("Not implemented");
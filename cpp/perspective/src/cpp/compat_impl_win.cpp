@@ -16,6 +16,7 @@
 #include <perspective/utils.h>
 #include <cstdio>
 #include <psapi.h>
+#include <io.h>
 #include <cstdint>
 
 namespace perspective {
@@ -168,11 +169,115 @@ set_thread_name(const std::string& name) {
     set_thread_name_win(GetCurrentThreadId(), name);
 }
 
+std::vector<t_uindex>
+get_thread_affinity() {
+    std::vector<t_uindex> cpus;
+    HANDLE thread = GetCurrentThread();
+    DWORD_PTR process_mask, system_mask;
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask)) {
+        return cpus;
+    }
+
+    // `SetThreadAffinityMask` returns the previous mask, so read the mask by
+    // setting it and restoring it.
+    DWORD_PTR mask = SetThreadAffinityMask(thread, process_mask);
+    if (mask == 0) {
+        return cpus;
+    }
+    SetThreadAffinityMask(thread, mask);
+
+    for (t_uindex cpu = 0; cpu < sizeof(DWORD_PTR) * CHAR_BIT; ++cpu) {
+        if (mask & (DWORD_PTR(1) << cpu)) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+void
+set_thread_affinity(const std::vector<t_uindex>& cpus) {
+    DWORD_PTR mask = 0;
+    for (auto cpu : cpus) {
+        if (cpu < sizeof(DWORD_PTR) * CHAR_BIT) {
+            mask |= DWORD_PTR(1) << cpu;
+        }
+    }
+
+    if (mask != 0) {
+        SetThreadAffinityMask(GetCurrentThread(), mask);
+    }
+}
+
+t_uindex
+get_num_numa_nodes() {
+    ULONG highest = 0;
+    if (!GetNumaHighestNodeNumber(&highest)) {
+        return 1;
+    }
+    return static_cast<t_uindex>(highest) + 1;
+}
+
+std::vector<t_uindex>
+get_numa_node_cpus(t_uindex node) {
+    std::vector<t_uindex> cpus;
+    ULONGLONG mask = 0;
+    if (!GetNumaNodeProcessorMask(static_cast<UCHAR>(node), &mask)) {
+        return cpus;
+    }
+
+    for (t_uindex cpu = 0; cpu < sizeof(ULONGLONG) * CHAR_BIT; ++cpu) {
+        if (mask & (ULONGLONG(1) << cpu)) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+// Windows places memory on the node of the thread that touches it first, and
+// has no per-thread preference short of `VirtualAllocExNuma`.
+t_index
+get_thread_numa_node() {
+    return -1;
+}
+
+void
+set_thread_numa_node(t_index node) {}
+
 void
 rmfile(const std::string& fname) {
     DeleteFile(fname.c_str());
 }
 
+void
+sync_file(std::FILE* file) {
+    t_index rcode = fflush(file);
+    PSP_VERBOSE_ASSERT(rcode == 0, "Error in fflush");
+    rcode = _commit(_fileno(file));
+    PSP_VERBOSE_ASSERT(rcode == 0, "Error in _commit");
+}
+
+void
+sync_dir(const std::string& dirname) {
+    // Windows cannot flush a directory, only the files in it.
+    WIN32_FIND_DATA entry;
+    HANDLE find = FindFirstFile((dirname + "\\*").c_str(), &entry);
+    PSP_VERBOSE_ASSERT(find != INVALID_HANDLE_VALUE, "Error listing directory");
+    do {
+        if (entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+            continue;
+        }
+
+        std::string fname = dirname + "\\" + entry.cFileName;
+        HANDLE file = CreateFile(fname.c_str(), GENERIC_WRITE,
+            FILE_SHARE_READ | FILE_SHARE_WRITE, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+        PSP_VERBOSE_ASSERT(file != INVALID_HANDLE_VALUE, "Error opening file");
+        BOOL rb = FlushFileBuffers(file);
+        CloseHandle(file);
+        PSP_VERBOSE_ASSERT(rb != 0, "Error flushing file");
+    } while (FindNextFile(find, &entry));
+    FindClose(find);
+}
+
 void
 launch_proc(const std::string& cmdline) {
     STARTUPINFO si;
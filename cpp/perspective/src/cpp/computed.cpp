@@ -9,8 +9,716 @@
 
 #include <perspective/computed.h>
 
+// The widest range of days, i.e. ~180 years, for which the datetime kernels
+// build a table of per-day results rather than converting each row.
+#define PSP_COMPUTED_DAY_TABLE_MAX 65536
+
 namespace perspective {
 
+namespace {
+
+const std::int64_t MS_PER_HOUR = 3600000;
+const std::int64_t MS_PER_DAY = 86400000;
+
+/**
+ * @brief Returns a mask of the first `end` rows, set where every one of
+ * `inputs` is valid.
+ */
+std::vector<std::uint8_t>
+get_valid_rows(const std::vector<std::shared_ptr<t_column>>& inputs, t_uindex end) {
+    std::vector<std::uint8_t> valid(end, 1);
+    for (const auto& input : inputs) {
+        if (!input->is_status_enabled()) {
+            continue;
+        }
+
+        const t_status* status = input->get_nth_status(0);
+        for (t_uindex idx = 0; idx < end; ++idx) {
+            valid[idx] &= status[idx] == STATUS_VALID;
+        }
+    }
+
+    return valid;
+}
+
+/**
+ * @brief Write the statuses of the first `end` rows of `output_column`,
+ * clearing the rows which are not `valid`.
+ */
+void
+write_statuses(const std::vector<std::uint8_t>& valid, t_column& output_column, t_uindex end) {
+    bool status_enabled = output_column.is_status_enabled();
+    for (t_uindex idx = 0; idx < end; ++idx) {
+        if (!valid[idx]) {
+            output_column.clear(idx);
+        } else if (status_enabled) {
+            output_column.set_status(idx, STATUS_VALID);
+        }
+    }
+}
+
+/**
+ * @brief Apply `op` over the first `end` values of two buffers of the same
+ * type `T`, writing `OUT_T` values into `output_column`.
+ *
+ * This is the batch counterpart to the scalar loop in `apply_computation`:
+ * `valid` marks the rows where both inputs are valid, a first pass runs
+ * `op` over the raw values of those rows, and a second pass writes the
+ * output statuses. `op` returns false where the result is undefined (i.e.
+ * division by zero), and the row is cleared.
+ */
+template <typename T, typename OUT_T, typename OP_T>
+void
+apply_kernel_2(const T* lhs_data, const T* rhs_data, std::vector<std::uint8_t>& valid,
+    t_column& output_column, t_uindex end, OP_T op) {
+    OUT_T* output_data = output_column.get_nth<OUT_T>(0);
+
+    for (t_uindex idx = 0; idx < end; ++idx) {
+        if (valid[idx]) {
+            valid[idx] = op(lhs_data[idx], rhs_data[idx], output_data[idx]);
+        }
+    }
+
+    write_statuses(valid, output_column, end);
+}
+
+/**
+ * @brief Dispatch `computation` to a typed kernel with inputs of type `T`,
+ * returning false if the function has no kernel. Each kernel computes
+ * exactly what its counterpart in `computed_function` does.
+ */
+template <typename T>
+bool
+apply_typed_computation_2(const T* lhs, const T* rhs, std::vector<std::uint8_t>& valid,
+    t_column& output_column, t_uindex end, t_computed_function_name name) {
+    switch (name) {
+        case ADD: {
+            apply_kernel_2<T, double>(lhs, rhs, valid, output_column, end,
+                [](T x, T y, double& out) {
+                    out = static_cast<double>(x + y);
+                    return true;
+                });
+        } break;
+        case SUBTRACT: {
+            apply_kernel_2<T, double>(lhs, rhs, valid, output_column, end,
+                [](T x, T y, double& out) {
+                    out = static_cast<double>(x - y);
+                    return true;
+                });
+        } break;
+        case MULTIPLY: {
+            apply_kernel_2<T, double>(lhs, rhs, valid, output_column, end,
+                [](T x, T y, double& out) {
+                    out = static_cast<double>(x * y);
+                    return true;
+                });
+        } break;
+        case DIVIDE: {
+            apply_kernel_2<T, double>(lhs, rhs, valid, output_column, end,
+                [](T x, T y, double& out) {
+                    double divisor = static_cast<double>(y);
+                    out = static_cast<double>(x) / divisor;
+                    return divisor != 0;
+                });
+        } break;
+        case PERCENT_OF: {
+            apply_kernel_2<T, double>(lhs, rhs, valid, output_column, end,
+                [](T x, T y, double& out) {
+                    double divisor = static_cast<double>(y);
+                    out = (static_cast<double>(x) / divisor) * 100;
+                    return divisor != 0;
+                });
+        } break;
+        case POW: {
+            apply_kernel_2<T, double>(lhs, rhs, valid, output_column, end,
+                [](T x, T y, double& out) {
+                    double divisor = static_cast<double>(y);
+                    if (divisor == 0) return false;
+                    out = std::pow(static_cast<double>(x), divisor);
+                    return true;
+                });
+        } break;
+        case EQUALS: {
+            apply_kernel_2<T, bool>(lhs, rhs, valid, output_column, end,
+                [](T x, T y, bool& out) {
+                    out = x == y;
+                    return true;
+                });
+        } break;
+        case NOT_EQUALS: {
+            apply_kernel_2<T, bool>(lhs, rhs, valid, output_column, end,
+                [](T x, T y, bool& out) {
+                    out = x != y;
+                    return true;
+                });
+        } break;
+        case GREATER_THAN: {
+            apply_kernel_2<T, bool>(lhs, rhs, valid, output_column, end,
+                [](T x, T y, bool& out) {
+                    out = x > y;
+                    return true;
+                });
+        } break;
+        case LESS_THAN: {
+            apply_kernel_2<T, bool>(lhs, rhs, valid, output_column, end,
+                [](T x, T y, bool& out) {
+                    out = x < y;
+                    return true;
+                });
+        } break;
+        default: return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Returns the UTC calendar date of a number of days since epoch,
+ * using integer arithmetic only - the same result as
+ * `date::year_month_day(date::sys_days)`.
+ */
+t_date
+date_from_day_number(std::int64_t days) {
+    days += 719468;
+    std::int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    std::int64_t day_of_era = days - era * 146097;
+    std::int64_t year_of_era = (day_of_era - day_of_era / 1460
+        + day_of_era / 36524 - day_of_era / 146096) / 365;
+    std::int64_t day_of_year = day_of_era
+        - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+
+    // Months are counted from March, so that leap days fall at the end
+    std::int64_t shifted_month = (5 * day_of_year + 2) / 153;
+    std::int64_t day = day_of_year - (153 * shifted_month + 2) / 5 + 1;
+    std::int64_t month = shifted_month < 10 ? shifted_month + 3 : shifted_month - 9;
+    std::int64_t year = year_of_era + era * 400 + (month <= 2);
+
+    // `t_date` months are [0-11]
+    return t_date(static_cast<std::int16_t>(year),
+        static_cast<std::int8_t>(month - 1), static_cast<std::int8_t>(day));
+}
+
+/**
+ * @brief Returns the day of the week of a number of days since epoch,
+ * from 0 (Sunday) to 6 (Saturday).
+ */
+std::int64_t
+weekday_from_day_number(std::int64_t days) {
+    // 1970-01-01 was a Thursday
+    std::int64_t weekday = (days + 4) % 7;
+    return weekday < 0 ? weekday + 7 : weekday;
+}
+
+/**
+ * @brief Apply `op` to the day number of the first `end` valid values of a
+ * buffer of `DTYPE_TIME` values, writing `OUT_T` values into
+ * `output_column`.
+ *
+ * Datetime functions only depend on the day of a timestamp, and a column
+ * usually spans far fewer days than it has rows, so `op` is evaluated once
+ * per day in the range of the column and every row is then a table
+ * lookup. Columns spanning more than `PSP_COMPUTED_DAY_TABLE_MAX` days call
+ * `op` on each row instead.
+ */
+template <typename OUT_T, typename OP_T>
+void
+apply_day_kernel(const t_time::t_rawtype* input_data, const std::vector<std::uint8_t>& valid,
+    t_column& output_column, t_uindex end, OP_T op) {
+    OUT_T* output_data = output_column.get_nth<OUT_T>(0);
+
+    std::vector<std::int64_t> day_numbers(end);
+    std::int64_t first_day = std::numeric_limits<std::int64_t>::max();
+    std::int64_t last_day = std::numeric_limits<std::int64_t>::min();
+
+    for (t_uindex idx = 0; idx < end; ++idx) {
+        std::int64_t ms = input_data[idx];
+        std::int64_t days = ms / MS_PER_DAY;
+        if (ms % MS_PER_DAY < 0) {
+            --days;
+        }
+
+        day_numbers[idx] = days;
+        if (valid[idx]) {
+            first_day = std::min(first_day, days);
+            last_day = std::max(last_day, days);
+        }
+    }
+
+    if (first_day <= last_day && last_day - first_day < PSP_COMPUTED_DAY_TABLE_MAX) {
+        std::vector<OUT_T> table(last_day - first_day + 1);
+        for (std::int64_t days = first_day; days <= last_day; ++days) {
+            table[days - first_day] = op(days);
+        }
+
+        for (t_uindex idx = 0; idx < end; ++idx) {
+            if (valid[idx]) {
+                output_data[idx] = table[day_numbers[idx] - first_day];
+            }
+        }
+    } else {
+        for (t_uindex idx = 0; idx < end; ++idx) {
+            if (valid[idx]) {
+                output_data[idx] = op(day_numbers[idx]);
+            }
+        }
+    }
+
+    write_statuses(valid, output_column, end);
+}
+
+/**
+ * @brief Returns whether `apply_typed_computation_2` has a kernel for
+ * `name`.
+ */
+bool
+has_numeric_kernel_2(t_computed_function_name name) {
+    switch (name) {
+        case ADD:
+        case SUBTRACT:
+        case MULTIPLY:
+        case DIVIDE:
+        case PERCENT_OF:
+        case POW:
+        case EQUALS:
+        case NOT_EQUALS:
+        case GREATER_THAN:
+        case LESS_THAN: return true;
+        default: return false;
+    }
+}
+
+/**
+ * @brief Returns whether `apply_time_computation_1` has a kernel for `name`.
+ */
+bool
+has_time_kernel(t_computed_function_name name) {
+    switch (name) {
+        case HOUR_BUCKET:
+        case DAY_BUCKET:
+        case WEEK_BUCKET:
+        case MONTH_BUCKET:
+        case YEAR_BUCKET:
+        case DAY_OF_WEEK:
+        case MONTH_OF_YEAR: return true;
+        default: return false;
+    }
+}
+
+/**
+ * @brief Dispatch `computation` over a buffer of `DTYPE_TIME` values to a
+ * batch kernel, returning false if the function has no kernel. Each kernel
+ * computes exactly what its counterpart in `computed_function` does, in
+ * UTC.
+ */
+bool
+apply_time_computation_1(const t_time::t_rawtype* input_data,
+    const std::vector<std::uint8_t>& valid, t_column& output_column, t_uindex end,
+    t_computed_function_name name) {
+    switch (name) {
+        case HOUR_BUCKET: {
+            // Matches the truncation of `std::chrono::duration_cast`
+            t_time::t_rawtype* output_data = output_column.get_nth<t_time::t_rawtype>(0);
+            for (t_uindex idx = 0; idx < end; ++idx) {
+                if (valid[idx]) {
+                    output_data[idx] = (input_data[idx] / MS_PER_HOUR) * MS_PER_HOUR;
+                }
+            }
+
+            write_statuses(valid, output_column, end);
+        } break;
+        case DAY_BUCKET: {
+            apply_day_kernel<t_date::t_rawtype>(input_data, valid, output_column, end,
+                [](std::int64_t days) {
+                    return date_from_day_number(days).raw_value();
+                });
+        } break;
+        case WEEK_BUCKET: {
+            // Weeks begin on Monday
+            apply_day_kernel<t_date::t_rawtype>(input_data, valid, output_column, end,
+                [](std::int64_t days) {
+                    std::int64_t since_monday = (weekday_from_day_number(days) + 6) % 7;
+                    return date_from_day_number(days - since_monday).raw_value();
+                });
+        } break;
+        case MONTH_BUCKET: {
+            apply_day_kernel<t_date::t_rawtype>(input_data, valid, output_column, end,
+                [](std::int64_t days) {
+                    t_date date = date_from_day_number(days);
+                    return t_date(date.year(), date.month(), 1).raw_value();
+                });
+        } break;
+        case YEAR_BUCKET: {
+            apply_day_kernel<t_date::t_rawtype>(input_data, valid, output_column, end,
+                [](std::int64_t days) {
+                    return t_date(date_from_day_number(days).year(), 0, 1).raw_value();
+                });
+        } break;
+        case DAY_OF_WEEK: {
+            // Names are interned as they are first seen, so the vocabulary
+            // holds the same strings as the scalar path would add.
+            std::vector<t_stridx> interned(7);
+            std::vector<bool> is_interned(7, false);
+            apply_day_kernel<t_stridx>(input_data, valid, output_column, end,
+                [&](std::int64_t days) {
+                    std::int64_t weekday = weekday_from_day_number(days);
+                    if (!is_interned[weekday]) {
+                        interned[weekday] = output_column.get_interned(
+                            computed_function::days_of_week[weekday]);
+                        is_interned[weekday] = true;
+                    }
+                    return interned[weekday];
+                });
+        } break;
+        case MONTH_OF_YEAR: {
+            std::vector<t_stridx> interned(12);
+            std::vector<bool> is_interned(12, false);
+            apply_day_kernel<t_stridx>(input_data, valid, output_column, end,
+                [&](std::int64_t days) {
+                    std::int32_t month = date_from_day_number(days).month();
+                    if (!is_interned[month]) {
+                        interned[month] = output_column.get_interned(
+                            computed_function::months_of_year[month]);
+                        is_interned[month] = true;
+                    }
+                    return interned[month];
+                });
+        } break;
+        default: return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Returns the result of the string function `name` over `x`, and
+ * `y` for functions of two strings - the same string that its counterpart
+ * in `computed_function` would intern.
+ */
+std::string
+transform_string(t_computed_function_name name, const char* x, const char* y) {
+    std::string rval(x);
+
+    switch (name) {
+        case UPPERCASE: {
+            boost::to_upper(rval);
+        } break;
+        case LOWERCASE: {
+            boost::to_lower(rval);
+        } break;
+        case CONCAT_SPACE: {
+            rval += " ";
+            rval += y;
+        } break;
+        case CONCAT_COMMA: {
+            rval += ", ";
+            rval += y;
+        } break;
+        default: {
+            PSP_COMPLAIN_AND_ABORT("Not a memoized string function.");
+        }
+    }
+
+    return rval;
+}
+
+/**
+ * @brief Apply the string function `name` over the vocabulary ids of its
+ * inputs, returning false if it has no kernel.
+ *
+ * A string column usually holds far fewer distinct strings than rows, so
+ * the function is evaluated and interned once per distinct id (or pair of
+ * ids), and every other row copies the resulting id into `output_column`.
+ */
+bool
+apply_string_computation(
+    const std::vector<std::shared_ptr<t_column>>& table_columns,
+    t_column& output_column,
+    t_uindex end,
+    t_computed_function_name name) {
+    t_uindex arity = table_columns.size();
+
+    switch (name) {
+        case UPPERCASE:
+        case LOWERCASE: {
+            if (arity != 1) return false;
+        } break;
+        case CONCAT_SPACE:
+        case CONCAT_COMMA: {
+            if (arity != 2) return false;
+        } break;
+        default: return false;
+    }
+
+    std::vector<const t_stridx*> input_data;
+    for (const auto& input : table_columns) {
+        if (input->get_dtype() != DTYPE_STR || input->size() < end) {
+            return false;
+        }
+
+        input_data.push_back(input->get_nth<t_stridx>(0));
+    }
+
+    std::vector<std::uint8_t> valid = get_valid_rows(table_columns, end);
+
+    t_stridx* output_data = output_column.get_nth<t_stridx>(0);
+    const t_column& x = *table_columns[0];
+
+    if (arity == 1) {
+        // Ids are dense, so the memo is indexed by id directly
+        t_uindex vocab_size = x._get_vocab()->get_vlenidx();
+        std::vector<t_stridx> memo(vocab_size);
+        std::vector<bool> is_memoized(vocab_size, false);
+
+        for (t_uindex idx = 0; idx < end; ++idx) {
+            if (!valid[idx]) {
+                continue;
+            }
+
+            t_stridx id = input_data[0][idx];
+            if (!is_memoized[id]) {
+                memo[id] = output_column.get_interned(
+                    transform_string(name, x.unintern_c(id), nullptr));
+                is_memoized[id] = true;
+            }
+
+            output_data[idx] = memo[id];
+        }
+    } else {
+        const t_column& y = *table_columns[1];
+        std::unordered_map<std::pair<t_stridx, t_stridx>, t_stridx,
+            boost::hash<std::pair<t_stridx, t_stridx>>>
+            memo;
+
+        for (t_uindex idx = 0; idx < end; ++idx) {
+            if (!valid[idx]) {
+                continue;
+            }
+
+            std::pair<t_stridx, t_stridx> key(input_data[0][idx], input_data[1][idx]);
+            auto iter = memo.find(key);
+            if (iter == memo.end()) {
+                t_stridx interned = output_column.get_interned(transform_string(
+                    name, x.unintern_c(key.first), y.unintern_c(key.second)));
+                iter = memo.emplace(key, interned).first;
+            }
+
+            output_data[idx] = iter->second;
+        }
+    }
+
+    write_statuses(valid, output_column, end);
+    return true;
+}
+
+/**
+ * @brief Apply `computation` through a typed kernel if both inputs share
+ * a numeric type, if its single input is a datetime, or if it is a string
+ * function, returning false if the scalar path should be used instead.
+ */
+bool
+apply_typed_computation(
+    const std::vector<std::shared_ptr<t_column>>& table_columns,
+    t_column& output_column,
+    const t_computation& computation,
+    t_uindex end) {
+    if (end == 0 || output_column.get_dtype() != computation.m_return_type
+        || output_column.size() < end) {
+        return false;
+    }
+
+    if (computation.m_return_type == DTYPE_STR
+        && apply_string_computation(table_columns, output_column, end, computation.m_name)) {
+        return true;
+    }
+
+    if (table_columns.size() == 1) {
+        const t_column& input = *table_columns[0];
+        if (input.get_dtype() != DTYPE_TIME || input.size() < end
+            || !has_time_kernel(computation.m_name)) {
+            return false;
+        }
+
+        std::vector<std::uint8_t> valid = get_valid_rows(table_columns, end);
+        return apply_time_computation_1(input.get_nth<t_time::t_rawtype>(0), valid,
+            output_column, end, computation.m_name);
+    }
+
+    if (table_columns.size() != 2) {
+        return false;
+    }
+
+    const t_column& lhs = *table_columns[0];
+    const t_column& rhs = *table_columns[1];
+    t_dtype dtype = lhs.get_dtype();
+
+    if (rhs.get_dtype() != dtype || rhs.size() < end || !has_numeric_kernel_2(computation.m_name)) {
+        return false;
+    }
+
+    std::vector<std::uint8_t> valid = get_valid_rows(table_columns, end);
+
+#define APPLY_TYPED_COMPUTATION_2(T)                                           \
+    apply_typed_computation_2<T>(lhs.get_nth<T>(0), rhs.get_nth<T>(0), valid,  \
+        output_column, end, computation.m_name)
+
+    switch (dtype) {
+        case DTYPE_UINT8: return APPLY_TYPED_COMPUTATION_2(std::uint8_t);
+        case DTYPE_UINT16: return APPLY_TYPED_COMPUTATION_2(std::uint16_t);
+        case DTYPE_UINT32: return APPLY_TYPED_COMPUTATION_2(std::uint32_t);
+        case DTYPE_UINT64: return APPLY_TYPED_COMPUTATION_2(std::uint64_t);
+        case DTYPE_INT8: return APPLY_TYPED_COMPUTATION_2(std::int8_t);
+        case DTYPE_INT16: return APPLY_TYPED_COMPUTATION_2(std::int16_t);
+        case DTYPE_INT32: return APPLY_TYPED_COMPUTATION_2(std::int32_t);
+        case DTYPE_INT64: return APPLY_TYPED_COMPUTATION_2(std::int64_t);
+        case DTYPE_FLOAT32: return APPLY_TYPED_COMPUTATION_2(float);
+        case DTYPE_FLOAT64: return APPLY_TYPED_COMPUTATION_2(double);
+        default: return false;
+    }
+
+#undef APPLY_TYPED_COMPUTATION_2
+}
+
+/**
+ * @brief Gather the value of one input for each of the first `end` rows of
+ * `flattened_column` into `values`, reading the master `table_column` where
+ * `flattened_column` does not set the value of a row which already exists,
+ * by the rules of `t_computed_column::reapply_computation`.
+ *
+ * Rows whose input is invalid are marked off in `valid`, and rows which
+ * should not be computed at all, because the update clears the input or a
+ * new row does not set it, are also marked in `unset`.
+ */
+template <typename T>
+void
+gather_changed_rows(const t_column& table_column, const t_column& flattened_column,
+    const std::vector<t_rlookup>& changed_rows, t_uindex end, std::vector<T>& values,
+    std::vector<std::uint8_t>& valid, std::vector<std::uint8_t>& unset) {
+    values.resize(end);
+    const T* flattened_data = flattened_column.get_nth<T>(0);
+    const T* table_data = table_column.get_nth<T>(0);
+    const t_status* flattened_status
+        = flattened_column.is_status_enabled() ? flattened_column.get_nth_status(0) : nullptr;
+    bool table_status_enabled = table_column.is_status_enabled();
+
+    for (t_uindex idx = 0; idx < end; ++idx) {
+        if (!flattened_status || flattened_status[idx] == STATUS_VALID) {
+            values[idx] = flattened_data[idx];
+            continue;
+        }
+
+        bool row_already_exists = !changed_rows.empty() && changed_rows[idx].m_exists;
+        if (!row_already_exists || flattened_status[idx] == STATUS_CLEAR) {
+            valid[idx] = 0;
+            unset[idx] = 1;
+            continue;
+        }
+
+        t_uindex ridx = changed_rows[idx].m_idx;
+        values[idx] = table_data[ridx];
+        if (table_status_enabled && *table_column.get_nth_status(ridx) != STATUS_VALID) {
+            valid[idx] = 0;
+        }
+    }
+}
+
+template <typename T>
+bool
+reapply_typed_computation_2(const std::vector<std::shared_ptr<t_column>>& table_columns,
+    const std::vector<std::shared_ptr<t_column>>& flattened_columns,
+    const std::vector<t_rlookup>& changed_rows, t_column& output_column, t_uindex end,
+    t_computed_function_name name, std::vector<std::uint8_t>& valid,
+    std::vector<std::uint8_t>& unset) {
+    std::vector<T> lhs;
+    std::vector<T> rhs;
+    gather_changed_rows<T>(
+        *table_columns[0], *flattened_columns[0], changed_rows, end, lhs, valid, unset);
+    gather_changed_rows<T>(
+        *table_columns[1], *flattened_columns[1], changed_rows, end, rhs, valid, unset);
+    return apply_typed_computation_2<T>(lhs.data(), rhs.data(), valid, output_column, end, name);
+}
+
+/**
+ * @brief Reapply `computation` over the rows of `flattened_columns` through
+ * the typed kernels of `apply_typed_computation`, returning false if the
+ * scalar path should be used instead.
+ *
+ * The inputs of the changed rows are first gathered into contiguous
+ * buffers, so that an update, which reads some inputs from the master table,
+ * is computed in batch like the first computation of the column. String
+ * functions memoize by the vocabulary ids of a single column, which the
+ * gathered inputs of `flattened` and the master table do not share, so they
+ * use the scalar path.
+ */
+bool
+reapply_typed_computation(
+    const std::vector<std::shared_ptr<t_column>>& table_columns,
+    const std::vector<std::shared_ptr<t_column>>& flattened_columns,
+    const std::vector<t_rlookup>& changed_rows,
+    t_column& output_column,
+    const t_computation& computation,
+    t_uindex end) {
+    if (end == 0 || output_column.get_dtype() != computation.m_return_type
+        || output_column.size() < end) {
+        return false;
+    }
+
+    t_computed_function_name name = computation.m_name;
+    std::vector<std::uint8_t> valid(end, 1);
+    std::vector<std::uint8_t> unset(end, 0);
+
+    if (flattened_columns.size() == 1) {
+        const t_column& input = *flattened_columns[0];
+        if (input.get_dtype() != DTYPE_TIME || input.size() < end || !has_time_kernel(name)) {
+            return false;
+        }
+
+        std::vector<t_time::t_rawtype> values;
+        gather_changed_rows<t_time::t_rawtype>(
+            *table_columns[0], input, changed_rows, end, values, valid, unset);
+        apply_time_computation_1(values.data(), valid, output_column, end, name);
+    } else if (flattened_columns.size() == 2) {
+        t_dtype dtype = flattened_columns[0]->get_dtype();
+        if (flattened_columns[1]->get_dtype() != dtype || flattened_columns[0]->size() < end
+            || flattened_columns[1]->size() < end || !has_numeric_kernel_2(name)) {
+            return false;
+        }
+
+#define REAPPLY_TYPED_COMPUTATION_2(T)                                         \
+    reapply_typed_computation_2<T>(table_columns, flattened_columns,           \
+        changed_rows, output_column, end, name, valid, unset)
+
+        switch (dtype) {
+            case DTYPE_UINT8: REAPPLY_TYPED_COMPUTATION_2(std::uint8_t); break;
+            case DTYPE_UINT16: REAPPLY_TYPED_COMPUTATION_2(std::uint16_t); break;
+            case DTYPE_UINT32: REAPPLY_TYPED_COMPUTATION_2(std::uint32_t); break;
+            case DTYPE_UINT64: REAPPLY_TYPED_COMPUTATION_2(std::uint64_t); break;
+            case DTYPE_INT8: REAPPLY_TYPED_COMPUTATION_2(std::int8_t); break;
+            case DTYPE_INT16: REAPPLY_TYPED_COMPUTATION_2(std::int16_t); break;
+            case DTYPE_INT32: REAPPLY_TYPED_COMPUTATION_2(std::int32_t); break;
+            case DTYPE_INT64: REAPPLY_TYPED_COMPUTATION_2(std::int64_t); break;
+            case DTYPE_FLOAT32: REAPPLY_TYPED_COMPUTATION_2(float); break;
+            case DTYPE_FLOAT64: REAPPLY_TYPED_COMPUTATION_2(double); break;
+            default: return false;
+        }
+
+#undef REAPPLY_TYPED_COMPUTATION_2
+    } else {
+        return false;
+    }
+
+    // Use `unset` instead of `clear`, as `t_gstate::update_master_table`
+    // will reconcile `STATUS_CLEAR` into `STATUS_INVALID`.
+    for (t_uindex idx = 0; idx < end; ++idx) {
+        if (unset[idx]) {
+            output_column.unset(idx);
+        }
+    }
+
+    return true;
+}
+
+} // end anonymous namespace
+
 t_computation::t_computation()
     : m_name(INVALID_COMPUTED_FUNCTION) {};
 
@@ -25,7 +733,7 @@ t_computation::t_computation(
 t_computation
 t_computed_column::get_computation(
     t_computed_function_name name, const std::vector<t_dtype>& input_types) {
-    for (const t_computation& computation : t_computed_column::computations) {
+    for (const t_computation& computation : get_computations()) {
         if (computation.m_name == name && computation.m_input_types == input_types) {
             return computation;
         }
@@ -287,6 +995,13 @@ t_computed_column::apply_computation(
     std::uint32_t end = table_columns[0]->size();
     auto arity = table_columns.size();
 
+    // Numeric and comparison functions over inputs of the same type,
+    // datetime functions and string functions are computed in batch;
+    // everything else falls through to the scalar loop.
+    if (apply_typed_computation(table_columns, *output_column, computation, end)) {
+        return;
+    }
+
     std::function<t_tscalar(t_tscalar)> function_1;
     std::function<t_tscalar(t_tscalar, t_tscalar)> function_2;
     std::function<void(t_tscalar, std::int32_t idx, std::shared_ptr<t_column>)> string_function_1;
@@ -387,6 +1102,14 @@ t_computed_column::reapply_computation(
     }
     auto arity = table_columns.size();
 
+    // Numeric and comparison functions over inputs of the same type and
+    // datetime functions gather their inputs and are computed in batch;
+    // everything else falls through to the scalar loop.
+    if (reapply_typed_computation(
+            table_columns, flattened_columns, changed_rows, *output_column, computation, end)) {
+        return;
+    }
+
     std::function<t_tscalar(t_tscalar)> function_1;
     std::function<t_tscalar(t_tscalar, t_tscalar)> function_2;
     std::function<void(t_tscalar, std::int32_t idx, std::shared_ptr<t_column>)> string_function_1;
@@ -508,9 +1231,21 @@ t_computed_column::reapply_computation(
     }
 }
 
-std::vector<t_computation> t_computed_column::computations = {};
+void
+t_computed_column::make_computations() {
+    get_computations();
+}
+
+const std::vector<t_computation>&
+t_computed_column::get_computations() {
+    static const std::vector<t_computation> computations = generate_computations();
+    return computations;
+}
+
+std::vector<t_computation>
+t_computed_column::generate_computations() {
+    std::vector<t_computation> computations;
 
-void t_computed_column::make_computations() {
     // Generate numeric functions
     std::vector<t_dtype> dtypes = {DTYPE_FLOAT64, DTYPE_FLOAT32, DTYPE_INT64, DTYPE_INT32, DTYPE_INT16, DTYPE_INT8, DTYPE_UINT64, DTYPE_UINT32, DTYPE_UINT16, DTYPE_UINT8};
     std::vector<t_computed_function_name> numeric_function_1 = {INVERT, POW2, SQRT, ABS, LOG, EXP, BUCKET_10, BUCKET_100, BUCKET_1000, BUCKET_0_1, BUCKET_0_0_1, BUCKET_0_0_0_1};
@@ -519,7 +1254,7 @@ void t_computed_column::make_computations() {
     
     for (const auto f : numeric_function_1) {
         for (auto i = 0; i < dtypes.size(); ++i) {
-            t_computed_column::computations.push_back(
+            computations.push_back(
                 t_computation{
                     f, 
                     std::vector<t_dtype>{dtypes[i]},
@@ -532,7 +1267,7 @@ void t_computed_column::make_computations() {
     for (const auto f : numeric_function_2) {
         for (auto i = 0; i < dtypes.size(); ++i) {
             for (auto j = 0; j < dtypes.size(); ++j) {
-                t_computed_column::computations.push_back(
+                computations.push_back(
                     t_computation{
                         f, 
                         std::vector<t_dtype>{dtypes[i], dtypes[j]},
@@ -546,7 +1281,7 @@ void t_computed_column::make_computations() {
     for (const auto f : numeric_comparison_2) {
         for (auto i = 0; i < dtypes.size(); ++i) {
             for (auto j = 0; j < dtypes.size(); ++j) {
-                t_computed_column::computations.push_back(
+                computations.push_back(
                     t_computation{
                         f, 
                         std::vector<t_dtype>{dtypes[i], dtypes[j]},
@@ -562,7 +1297,7 @@ void t_computed_column::make_computations() {
     std::vector<t_computed_function_name> string_function_2 = {CONCAT_SPACE, CONCAT_COMMA};
 
     for (const auto f : string_function_1) {
-        t_computed_column::computations.push_back(
+        computations.push_back(
             t_computation{
                 f, 
                 std::vector<t_dtype>{DTYPE_STR},
@@ -572,7 +1307,7 @@ void t_computed_column::make_computations() {
     }
     
     for (const auto f : string_function_2) {
-        t_computed_column::computations.push_back(
+        computations.push_back(
             t_computation{
                 f, 
                 std::vector<t_dtype>{DTYPE_STR, DTYPE_STR},
@@ -582,12 +1317,12 @@ void t_computed_column::make_computations() {
     }
 
     // Length takes a string and returns an int
-    t_computed_column::computations.push_back(
+    computations.push_back(
         t_computation{LENGTH, std::vector<t_dtype>{DTYPE_STR}, DTYPE_INT64}
     );
 
     // IS takes 2 strings and returns a bool
-    t_computed_column::computations.push_back(
+    computations.push_back(
         t_computation{IS, std::vector<t_dtype>{DTYPE_STR, DTYPE_STR}, DTYPE_BOOL}
     );
 
@@ -617,7 +1352,7 @@ void t_computed_column::make_computations() {
 
     for (auto i = 0; i < date_dtypes.size(); ++i) {
         for (auto j = 0; j < date_to_date_functions.size(); ++j) {
-            t_computed_column::computations.push_back(
+            computations.push_back(
                 t_computation {
                     date_to_date_functions[j],
                     std::vector<t_dtype>{date_dtypes[i]},
@@ -633,7 +1368,7 @@ void t_computed_column::make_computations() {
                 // so just return the column as is.
                 return_type = DTYPE_DATE;
             }
-            t_computed_column::computations.push_back(
+            computations.push_back(
                 t_computation {
                     date_to_datetime_functions[j],
                     std::vector<t_dtype>{date_dtypes[i]},
@@ -643,7 +1378,7 @@ void t_computed_column::make_computations() {
         };
 
         for (auto j = 0; j < date_to_string_functions.size(); ++j) {
-            t_computed_column::computations.push_back(
+            computations.push_back(
                 t_computation {
                     date_to_string_functions[j],
                     std::vector<t_dtype>{date_dtypes[i]},
@@ -654,515 +1389,520 @@ void t_computed_column::make_computations() {
     };
 
     // Hour of Day returns an int64
-    t_computed_column::computations.push_back(
+    computations.push_back(
         t_computation{HOUR_OF_DAY, std::vector<t_dtype>{DTYPE_DATE}, DTYPE_INT64}
     );
 
-    t_computed_column::computations.push_back(
+    computations.push_back(
         t_computation{HOUR_OF_DAY, std::vector<t_dtype>{DTYPE_TIME}, DTYPE_INT64}
-    );    
+    );
+
+    return computations;
 }
 
-std::map<std::string, std::map<std::string, std::string>>
-t_computed_column::computed_functions = {
-    // Operators
-    {"add", {
-        {"name", "add"},
-        {"label", "+"},
-        {"pattern", "\\+"},
-        {"computed_function_name", "+"},
-        {"input_type", "float"},
-        {"return_type", "float"},
-        {"category", "OperatorTokenType"},
-        {"num_params", "2"}, // integer needs to be parsed in front-end
-        {"format_function", "(x, y) => `(${x} + ${y})`"}, // JS style function
-        {"help", "Add together two numeric columns."},
-        {"signature", "(x: Number) + (y: Number): Number"}
-    }},
-    {"subtract", {
-        {"name", "subtract"},
-        {"label", "-"},
-        {"pattern", "\\-"},
-        {"computed_function_name", "-"},
-        {"input_type", "float"},
-        {"return_type", "float"},
-        {"category", "OperatorTokenType"},
-        {"num_params", "2"},
-        {"format_function", "(x, y) => `(${x} - ${y})`"},
-        {"help", "Subtract two numeric columns."},
-        {"signature", "(x: Number) - (y: Number): Number"}
-    }},
-    {"multiply", {
-        {"name", "multiply"},
-        {"label", "*"},
-        {"pattern", "\\*"},
-        {"computed_function_name", "*"},
-        {"input_type", "float"},
-        {"return_type", "float"},
-        {"category", "OperatorTokenType"},
-        {"num_params", "2"},
-        {"format_function", "(x, y) => `(${x} * ${y})`"},
-        {"help", "Multiplies two numeric columns."},
-        {"signature", "(x: Number) * (y: Number): Number"}
-    }},
-    {"divide", {
-        {"name", "divide"},
-        {"label", "/"},
-        {"pattern", "\\/"},
-        {"computed_function_name", "/"},
-        {"input_type", "float"},
-        {"return_type", "float"},
-        {"category", "OperatorTokenType"},
-        {"num_params", "2"},
-        {"format_function", "(x, y) => `(${x} / ${y})`"},
-        {"help", "Divides two numeric columns."},
-        {"signature", "(x: Number) / (y: Number): Number"}
-    }},
-    {"pow", {
-        {"name", "pow"},
-        {"label", "x ^ y"},
-        {"pattern", "\\^"},
-        {"computed_function_name", "pow"},
-        {"input_type", "float"},
-        {"return_type", "float"},
-        {"category", "OperatorTokenType"},
-        {"num_params", "2"},
-        {"format_function", "x => `(${x} ^ ${y})`"},
-        {"help", "Raises the first column to the power of the second column."},
-        {"signature", "(x: Number) ^ (y: Number): Number"}
-    }},
-    {"percent_of", {
-        {"name", "percent_of"},
-        {"label", "x % y"},
-        {"pattern", "\\%"},
-        {"computed_function_name", "%"},
-        {"input_type", "float"},
-        {"return_type", "float"},
-        {"category", "OperatorTokenType"},
-        {"num_params", "2"},
-        {"format_function", "x => `(x, y) => `(${x} % ${y})`"},
-        {"help", "Returns the first column as a percent of the second column."},
-        {"signature", "(x: Number) % (y: Number): Number"}
-    }},
-    {"equals", {
-        {"name", "equals"},
-        {"label", "x == y"},
-        {"pattern", "\\=="},
-        {"computed_function_name", "equals"},
-        {"input_type", "float"},
-        {"return_type", "boolean"},
-        {"category", "OperatorTokenType"},
-        {"num_params", "2"},
-        {"format_function", "x => `(x, y) => `(${x} == ${y})`"},
-        {"help", "Checks the equality of two numeric columns."},
-        {"signature", "(x: Number) == (y: Number): Boolean"}
-    }},
-    {"not_equals", {
-        {"name", "not_equals"},
-        {"label", "x != y"},
-        {"pattern", "\\!="},
-        {"computed_function_name", "not_equals"},
-        {"input_type", "float"},
-        {"return_type", "boolean"},
-        {"category", "OperatorTokenType"},
-        {"num_params", "2"},
-        {"format_function", "x => `(x, y) => `(${x} != ${y})`"},
-        {"help", "Whether two numeric columns are not equal."},
-        {"signature", "(x: Number) != (y: Number): Boolean"}
-    }},
-    {"greater_than", {
-        {"name", "greater_than"},
-        {"label", "x > y"},
-        {"pattern", "\\>"},
-        {"computed_function_name", "greater_than"},
-        {"input_type", "float"},
-        {"return_type", "boolean"},
-        {"category", "OperatorTokenType"},
-        {"num_params", "2"},
-        {"format_function", "x => `(x, y) => `(${x} > ${y})`"},
-        {"help", "Whether the first numeric column is greater than the second numeric column."},
-        {"signature", "(x: Number) > (y: Number): Boolean"}
-    }},
-    {"less_than", {
-        {"name", "less_than"},
-        {"label", "x < y"},
-        {"pattern", "\\<"},
-        {"computed_function_name", "less_than"},
-        {"input_type", "float"},
-        {"return_type", "boolean"},
-        {"category", "OperatorTokenType"},
-        {"num_params", "2"},
-        {"format_function", "x => `(x, y) => `(${x} < ${y})`"},
-        {"help", "Whether the first numeric column is less than the second numeric column."},
-        {"signature", "(x: Number) < (y: Number): Boolean"}
-    }},
-    {"is", {
-        {"name", "is"},
-        {"label", "x is y"},
-        {"pattern", "is"},
-        {"computed_function_name", "is"},
-        {"input_type", "string"},
-        {"return_type", "boolean"},
-        {"category", "OperatorTokenType"},
-        {"num_params", "2"},
-        {"format_function", "x => `(x, y) => `(${x} < ${y})`"},
-        {"help", "Checks equality of two string columns."},
-        {"signature", "(x: String) is (y: String): Boolean"}
-    }},
-    // Numeric Functions
-    {"invert", {
-        {"name", "invert"},
-        {"label", "1 / x"},
-        {"pattern", "invert"},
-        {"computed_function_name", "1/x"},
-        {"input_type", "float"},
-        {"return_type", "float"},
-        {"category", "FunctionTokenType"},
-        {"num_params", "1"},
-        {"format_function", "x => `(1 / ${x})`"},
-        {"help", "Returns 1 / the numeric column."},
-        {"signature", "invert(x: Number): Number"}
-    }},
-    {"pow2", {
-        {"name", "pow2"},
-        {"label", "x ^ 2"},
-        {"pattern", "pow2"},
-        {"computed_function_name", "x^2"},
-        {"input_type", "float"},
-        {"return_type", "float"},
-        {"category", "FunctionTokenType"},
-        {"num_params", "1"},
-        {"format_function", "x => `(${x} ^ 2)`"},
-        {"help", "Returns the numeric column to the power of 2."},
-        {"signature", "pow2(x: Number): Number"}
-    }},
-    {"log", {
-        {"name", "log"},
-        {"label", "log(x)"},
-        {"pattern", "log"},
-        {"computed_function_name", "log"},
-        {"input_type", "float"},
-        {"return_type", "float"},
-        {"category", "FunctionTokenType"},
-        {"num_params", "1"},
-        {"format_function", "x => `log(${x})`"},
-        {"help", "Returns the natural log of the numeric column."},
-        {"signature", "log(x: Number): Number"}
-    }},
-    {"exp", {
-        {"name", "exp"},
-        {"label", "exp(x)"},
-        {"pattern", "exp"},
-        {"computed_function_name", "exp"},
-        {"input_type", "float"},
-        {"return_type", "float"},
-        {"category", "FunctionTokenType"},
-        {"num_params", "1"},
-        {"format_function", "x => `exp(${x})`"},
-        {"help", "Returns the base-e exponent of the numeric column."},
-        {"signature", "exp(x: Number): Number"}
-    }},
-    {"sqrt", {
-        {"name", "sqrt"},
-        {"label", "sqrt(x)"},
-        {"pattern", "sqrt"},
-        {"computed_function_name", "sqrt"},
-        {"input_type", "float"},
-        {"return_type", "float"},
-        {"category", "FunctionTokenType"},
-        {"num_params", "1"},
-        {"format_function", "x => `sqrt(${x})`"},
-        {"help", "Returns the square root of the numeric column."},
-        {"signature", "sqrt(x: Number): Number"}
-    }},
-    {"abs", {
-        {"name", "abs"},
-        {"label", "abs(x)"},
-        {"pattern", "abs"},
-        {"computed_function_name", "abs"},
-        {"input_type", "float"},
-        {"return_type", "float"},
-        {"category", "FunctionTokenType"},
-        {"num_params", "1"},
-        {"format_function", "x => `abs(${x})`"},
-        {"help", "Returns the absolute value of the numeric column."},
-        {"signature", "abs(x: Number): Number"}
-    }},
-    {"bin10", {
-        {"name", "bin10"},
-        {"label", "Bucket x by 10"},
-        {"pattern", "bin10"},
-        {"computed_function_name", "Bucket (10)"},
-        {"input_type", "float"},
-        {"return_type", "float"},
-        {"category", "FunctionTokenType"},
-        {"num_params", "1"},
-        {"format_function", "x => `bin10(${x})`"},
-        {"help", "Buckets the numeric column to the nearest 10."},
-        {"signature", "bin10(x: Number): Number"}
-    }},
-    {"bin100", {
-        {"name", "bin100"},
-        {"label", "Bucket x by 100"},
-        {"pattern", "bin100"},
-        {"computed_function_name", "Bucket (100)"},
-        {"input_type", "float"},
-        {"return_type", "float"},
-        {"category", "FunctionTokenType"},
-        {"num_params", "1"},
-        {"format_function", "x => `bin100(${x})`"},
-        {"help", "Buckets the numeric column to the nearest 100."},
-        {"signature", "bin100(x: Number): Number"}
-    }},
-    {"bin1000", {
-        {"name", "bin1000"},
-        {"label", "Bucket x by 1000"},
-        {"pattern", "bin1000"},
-        {"computed_function_name", "Bucket (1000)"},
-        {"input_type", "float"},
-        {"return_type", "float"},
-        {"category", "FunctionTokenType"},
-        {"num_params", "1"},
-        {"format_function", "x => `bin1000(${x})`"},
-        {"help", "Buckets the numeric column to the nearest 1000."},
-        {"signature", "bin1000(x: Number): Number"}
-    }},
-    {"bin10th", {
-        {"name", "bin10th"},
-        {"label", "Bucket x by 1/10"},
-        {"pattern", "bin10th"},
-        {"computed_function_name", "Bucket (1/10)"},
-        {"input_type", "float"},
-        {"return_type", "float"},
-        {"category", "FunctionTokenType"},
-        {"num_params", "1"},
-        {"format_function", "x => `bin10th(${x})`"},
-        {"help", "Buckets the numeric column to the nearest 0.1."},
-        {"signature", "bin10th(x: Number): Number"}
-    }},
-    {"bin100th", {
-        {"name", "bin100th"},
-        {"label", "Bucket x by 1/100"},
-        {"pattern", "bin100th"},
-        {"computed_function_name", "Bucket (1/100)"},
-        {"input_type", "float"},
-        {"return_type", "float"},
-        {"category", "FunctionTokenType"},
-        {"num_params", "1"},
-        {"format_function", "x => `bin100th(${x})`"},
-        {"help", "Buckets the numeric column to the nearest 0.01."},
-        {"signature", "bin100th(x: Number): Number"}
-    }},
-    {"bin1000th", {
-        {"name", "bin1000th"},
-        {"label", "Bucket x by 1/1000"},
-        {"pattern", "bin1000th"},
-        {"computed_function_name", "Bucket (1/1000)"},
-        {"input_type", "float"},
-        {"return_type", "float"},
-        {"category", "FunctionTokenType"},
-        {"num_params", "1"},
-        {"format_function", "x => `bin1000th(${x})`"},
-        {"help", "Buckets the numeric column to the nearest 0.001."},
-        {"signature", "bin1000th(x: Number): Number"}
-    }},
-    // String Functions
-    {"length", {
-        {"name", "length"},
-        {"label", "length(x)"},
-        {"pattern", "length"},
-        {"computed_function_name", "length"},
-        {"input_type", "string"},
-        {"return_type", "integer"},
-        {"category", "FunctionTokenType"},
-        {"num_params", "1"},
-        {"format_function", "x => `length(${x})`"},
-        {"help", "Returns the length of the string column."},
-        {"signature", "length(x: String): Number"}
-    }},
-    {"uppercase", {
-        {"name", "uppercase"},
-        {"label", "uppercase(x)"},
-        {"pattern", "uppercase"},
-        {"computed_function_name", "Uppercase"},
-        {"input_type", "string"},
-        {"return_type", "string"},
-        {"category", "FunctionTokenType"},
-        {"num_params", "1"},
-        {"format_function", "x => `uppercase(${x})`"},
-        {"help", "Converts each string to uppercase in the column."},
-        {"signature", "uppercase(x: String): String"}
-    }},
-    {"lowercase", {
-        {"name", "lowercase"},
-        {"label", "lowercase(x)"},
-        {"pattern", "lowercase"},
-        {"computed_function_name", "Lowercase"},
-        {"input_type", "string"},
-        {"return_type", "string"},
-        {"category", "FunctionTokenType"},
-        {"num_params", "1"},
-        {"format_function", "x => `lowercase(${x})`"},
-        {"help", "Converts each string to lowercase in the column."},
-        {"signature", "lowercase(x: String): String"}
-    }},
-    {"concat_space", {
-        {"name", "concat_space"},
-        {"label", "Concat(x, y) with space"},
-        {"pattern", "concat_space"},
-        {"computed_function_name", "concat_space"},
-        {"input_type", "string"},
-        {"return_type", "string"},
-        {"category", "FunctionTokenType"},
-        {"num_params", "2"},
-        {"format_function", "x => `concat_space(${x})`"},
-        {"help", "Concatenates two columns with a space."},
-        {"signature", "concat_space(x: String, y: String): String"}
-    }},
-    {"concat_comma", {
-        {"name", "concat_comma"},
-        {"label", "Concat(x, y) with comma"},
-        {"pattern", "concat_comma"},
-        {"computed_function_name", "concat_comma"},
-        {"input_type", "string"},
-        {"return_type", "string"},
-        {"category", "FunctionTokenType"},
-        {"num_params", "2"},
-        {"format_function", "x => `concat_comma(${x})`"},
-        {"help", "Concatenates two columns with a comma."},
-        {"signature", "concat_comma(x: String, y: String): String"}
-    }},
-    // Date Functions
-    {"hour_of_day", {
-        {"name", "hour_of_day"},
-        {"label", "Hour of day"},
-        {"pattern", "hour_of_day"},
-        {"computed_function_name", "Hour of Day"},
-        {"input_type", "datetime"},
-        {"return_type", "integer"},
-        {"category", "FunctionTokenType"},
-        {"num_params", "1"},
-        {"format_function", "x => `hour_of_day(${x})`"},
-        {"help", "Returns the hour of day (0-23) in UTC for the datetime column."},
-        {"signature", "hour_of_day(x: Datetime): Number"}
-    }},
-    {"day_of_week", {
-        {"name", "day_of_week"},
-        {"label", "Day of week"},
-        {"pattern", "day_of_week"},
-        {"computed_function_name", "Day of Week"},
-        {"input_type", "datetime"},
-        {"return_type", "string"},
-        {"category", "FunctionTokenType"},
-        {"num_params", "1"},
-        {"format_function", "x => `day_of_week(${x})`"},
-        {"help", "Returns the day of week in UTC for the datetime column."},
-        {"signature", "day_of_week(x: Datetime): String"}
-    }},
-    {"month_of_year", {
-        {"name", "month_of_year"},
-        {"label", "Month of year"},
-        {"pattern", "month_of_year"},
-        {"computed_function_name", "Month of Year"},
-        {"input_type", "datetime"},
-        {"return_type", "string"},
-        {"category", "FunctionTokenType"},
-        {"num_params", "1"},
-        {"format_function", "x => `month_of_year(${x})`"},
-        {"help", "Returns the month of year in UTC for the datetime column."},
-        {"signature", "month_of_year(x: Datetime): String"}
-    }},
-    {"second_bucket", {
-        {"name", "second_bucket"},
-        {"label", "Bucket(x) by seconds"},
-        {"pattern", "second_bucket"},
-        {"computed_function_name", "Bucket (s)"},
-        {"input_type", "datetime"},
-        {"return_type", "datetime"},
-        {"category", "FunctionTokenType"},
-        {"num_params", "1"},
-        {"format_function", "x => `second_bucket(${x})`"},
-        {"help", "Buckets the datetime column to the nearest second."},
-        {"signature", "second_bucket(x: Datetime): Datetime"}
-    }},
-    {"minute_bucket", {
-        {"name", "minute_bucket"},
-        {"label", "Bucket(x) by minutes"},
-        {"pattern", "minute_bucket"},
-        {"computed_function_name", "Bucket (m)"},
-        {"input_type", "datetime"},
-        {"return_type", "datetime"},
-        {"category", "FunctionTokenType"},
-        {"num_params", "1"},
-        {"format_function", "x => `minute_bucket(${x})`"},
-        {"help", "Buckets the datetime column to the nearest minute."},
-        {"signature", "minute_bucket(x: Datetime): Datetime"}
-    }},
-    {"hour_bucket", {
-        {"name", "hour_bucket"},
-        {"label", "Bucket(x) by hours"},
-        {"pattern", "hour_bucket"},
-        {"computed_function_name", "Bucket (h)"},
-        {"input_type", "datetime"},
-        {"return_type", "datetime"},
-        {"category", "FunctionTokenType"},
-        {"num_params", "1"},
-        {"format_function", "x => `hour_bucket(${x})`"},
-        {"help", "Buckets the datetime column to the nearest hour."},
-        {"signature", "hour_bucket(x: Datetime): Datetime"}
-    }},
-    {"day_bucket", {
-        {"name", "day_bucket"},
-        {"label", "Bucket(x) by days"},
-        {"pattern", "day_bucket"},
-        {"computed_function_name", "Bucket (D)"},
-        {"input_type", "datetime"},
-        {"return_type", "date"},
-        {"category", "FunctionTokenType"},
-        {"num_params", "1"},
-        {"format_function", "x => `day_bucket(${x})`"},
-        {"help", "Buckets the datetime column to the nearest day."},
-        {"signature", "day_bucket(x: Datetime): Datetime"}
-    }},
-    {"week_bucket", {
-        {"name", "week_bucket"},
-        {"label", "Bucket(x) by weeks"},
-        {"pattern", "week_bucket"},
-        {"computed_function_name", "Bucket (W)"},
-        {"input_type", "datetime"},
-        {"return_type", "date"},
-        {"category", "FunctionTokenType"},
-        {"num_params", "1"},
-        {"format_function", "x => `week_bucket(${x})`"},
-        {"help", "Buckets the datetime column to the nearest week."},
-        {"signature", "week_bucket(x: Datetime): Datetime"}
-    }},
-    {"month_bucket", {
-        {"name", "month_bucket"},
-        {"label", "Bucket(x) by months"},
-        {"pattern", "month_bucket"},
-        {"computed_function_name", "Bucket (M)"},
-        {"input_type", "datetime"},
-        {"return_type", "date"},
-        {"category", "FunctionTokenType"},
-        {"num_params", "1"},
-        {"format_function", "x => `month_bucket(${x})`"},
-        {"help", "Buckets the datetime column to the nearest month."},
-        {"signature", "month_bucket(x: Datetime): Datetime"}
-    }},
-    {"year_bucket", {
-        {"name", "year_bucket"},
-        {"label", "Bucket(x) by years"},
-        {"pattern", "year_bucket"},
-        {"computed_function_name", "Bucket (Y)"},
-        {"input_type", "datetime"},
-        {"return_type", "date"},
-        {"category", "FunctionTokenType"},
-        {"num_params", "1"},
-        {"format_function", "x => `year_bucket(${x})`"},
-        {"help", "Buckets the datetime column to the nearest year."},
-        {"signature", "year_bucket(x: Datetime): Datetime"}
-    }}
-};
+const std::map<std::string, std::map<std::string, std::string>>&
+t_computed_column::get_computed_functions() {
+    static const std::map<std::string, std::map<std::string, std::string>> computed_functions = {
+        // Operators
+        {"add", {
+            {"name", "add"},
+            {"label", "+"},
+            {"pattern", "\\+"},
+            {"computed_function_name", "+"},
+            {"input_type", "float"},
+            {"return_type", "float"},
+            {"category", "OperatorTokenType"},
+            {"num_params", "2"}, // integer needs to be parsed in front-end
+            {"format_function", "(x, y) => `(${x} + ${y})`"}, // JS style function
+            {"help", "Add together two numeric columns."},
+            {"signature", "(x: Number) + (y: Number): Number"}
+        }},
+        {"subtract", {
+            {"name", "subtract"},
+            {"label", "-"},
+            {"pattern", "\\-"},
+            {"computed_function_name", "-"},
+            {"input_type", "float"},
+            {"return_type", "float"},
+            {"category", "OperatorTokenType"},
+            {"num_params", "2"},
+            {"format_function", "(x, y) => `(${x} - ${y})`"},
+            {"help", "Subtract two numeric columns."},
+            {"signature", "(x: Number) - (y: Number): Number"}
+        }},
+        {"multiply", {
+            {"name", "multiply"},
+            {"label", "*"},
+            {"pattern", "\\*"},
+            {"computed_function_name", "*"},
+            {"input_type", "float"},
+            {"return_type", "float"},
+            {"category", "OperatorTokenType"},
+            {"num_params", "2"},
+            {"format_function", "(x, y) => `(${x} * ${y})`"},
+            {"help", "Multiplies two numeric columns."},
+            {"signature", "(x: Number) * (y: Number): Number"}
+        }},
+        {"divide", {
+            {"name", "divide"},
+            {"label", "/"},
+            {"pattern", "\\/"},
+            {"computed_function_name", "/"},
+            {"input_type", "float"},
+            {"return_type", "float"},
+            {"category", "OperatorTokenType"},
+            {"num_params", "2"},
+            {"format_function", "(x, y) => `(${x} / ${y})`"},
+            {"help", "Divides two numeric columns."},
+            {"signature", "(x: Number) / (y: Number): Number"}
+        }},
+        {"pow", {
+            {"name", "pow"},
+            {"label", "x ^ y"},
+            {"pattern", "\\^"},
+            {"computed_function_name", "pow"},
+            {"input_type", "float"},
+            {"return_type", "float"},
+            {"category", "OperatorTokenType"},
+            {"num_params", "2"},
+            {"format_function", "x => `(${x} ^ ${y})`"},
+            {"help", "Raises the first column to the power of the second column."},
+            {"signature", "(x: Number) ^ (y: Number): Number"}
+        }},
+        {"percent_of", {
+            {"name", "percent_of"},
+            {"label", "x % y"},
+            {"pattern", "\\%"},
+            {"computed_function_name", "%"},
+            {"input_type", "float"},
+            {"return_type", "float"},
+            {"category", "OperatorTokenType"},
+            {"num_params", "2"},
+            {"format_function", "x => `(x, y) => `(${x} % ${y})`"},
+            {"help", "Returns the first column as a percent of the second column."},
+            {"signature", "(x: Number) % (y: Number): Number"}
+        }},
+        {"equals", {
+            {"name", "equals"},
+            {"label", "x == y"},
+            {"pattern", "\\=="},
+            {"computed_function_name", "equals"},
+            {"input_type", "float"},
+            {"return_type", "boolean"},
+            {"category", "OperatorTokenType"},
+            {"num_params", "2"},
+            {"format_function", "x => `(x, y) => `(${x} == ${y})`"},
+            {"help", "Checks the equality of two numeric columns."},
+            {"signature", "(x: Number) == (y: Number): Boolean"}
+        }},
+        {"not_equals", {
+            {"name", "not_equals"},
+            {"label", "x != y"},
+            {"pattern", "\\!="},
+            {"computed_function_name", "not_equals"},
+            {"input_type", "float"},
+            {"return_type", "boolean"},
+            {"category", "OperatorTokenType"},
+            {"num_params", "2"},
+            {"format_function", "x => `(x, y) => `(${x} != ${y})`"},
+            {"help", "Whether two numeric columns are not equal."},
+            {"signature", "(x: Number) != (y: Number): Boolean"}
+        }},
+        {"greater_than", {
+            {"name", "greater_than"},
+            {"label", "x > y"},
+            {"pattern", "\\>"},
+            {"computed_function_name", "greater_than"},
+            {"input_type", "float"},
+            {"return_type", "boolean"},
+            {"category", "OperatorTokenType"},
+            {"num_params", "2"},
+            {"format_function", "x => `(x, y) => `(${x} > ${y})`"},
+            {"help", "Whether the first numeric column is greater than the second numeric column."},
+            {"signature", "(x: Number) > (y: Number): Boolean"}
+        }},
+        {"less_than", {
+            {"name", "less_than"},
+            {"label", "x < y"},
+            {"pattern", "\\<"},
+            {"computed_function_name", "less_than"},
+            {"input_type", "float"},
+            {"return_type", "boolean"},
+            {"category", "OperatorTokenType"},
+            {"num_params", "2"},
+            {"format_function", "x => `(x, y) => `(${x} < ${y})`"},
+            {"help", "Whether the first numeric column is less than the second numeric column."},
+            {"signature", "(x: Number) < (y: Number): Boolean"}
+        }},
+        {"is", {
+            {"name", "is"},
+            {"label", "x is y"},
+            {"pattern", "is"},
+            {"computed_function_name", "is"},
+            {"input_type", "string"},
+            {"return_type", "boolean"},
+            {"category", "OperatorTokenType"},
+            {"num_params", "2"},
+            {"format_function", "x => `(x, y) => `(${x} < ${y})`"},
+            {"help", "Checks equality of two string columns."},
+            {"signature", "(x: String) is (y: String): Boolean"}
+        }},
+        // Numeric Functions
+        {"invert", {
+            {"name", "invert"},
+            {"label", "1 / x"},
+            {"pattern", "invert"},
+            {"computed_function_name", "1/x"},
+            {"input_type", "float"},
+            {"return_type", "float"},
+            {"category", "FunctionTokenType"},
+            {"num_params", "1"},
+            {"format_function", "x => `(1 / ${x})`"},
+            {"help", "Returns 1 / the numeric column."},
+            {"signature", "invert(x: Number): Number"}
+        }},
+        {"pow2", {
+            {"name", "pow2"},
+            {"label", "x ^ 2"},
+            {"pattern", "pow2"},
+            {"computed_function_name", "x^2"},
+            {"input_type", "float"},
+            {"return_type", "float"},
+            {"category", "FunctionTokenType"},
+            {"num_params", "1"},
+            {"format_function", "x => `(${x} ^ 2)`"},
+            {"help", "Returns the numeric column to the power of 2."},
+            {"signature", "pow2(x: Number): Number"}
+        }},
+        {"log", {
+            {"name", "log"},
+            {"label", "log(x)"},
+            {"pattern", "log"},
+            {"computed_function_name", "log"},
+            {"input_type", "float"},
+            {"return_type", "float"},
+            {"category", "FunctionTokenType"},
+            {"num_params", "1"},
+            {"format_function", "x => `log(${x})`"},
+            {"help", "Returns the natural log of the numeric column."},
+            {"signature", "log(x: Number): Number"}
+        }},
+        {"exp", {
+            {"name", "exp"},
+            {"label", "exp(x)"},
+            {"pattern", "exp"},
+            {"computed_function_name", "exp"},
+            {"input_type", "float"},
+            {"return_type", "float"},
+            {"category", "FunctionTokenType"},
+            {"num_params", "1"},
+            {"format_function", "x => `exp(${x})`"},
+            {"help", "Returns the base-e exponent of the numeric column."},
+            {"signature", "exp(x: Number): Number"}
+        }},
+        {"sqrt", {
+            {"name", "sqrt"},
+            {"label", "sqrt(x)"},
+            {"pattern", "sqrt"},
+            {"computed_function_name", "sqrt"},
+            {"input_type", "float"},
+            {"return_type", "float"},
+            {"category", "FunctionTokenType"},
+            {"num_params", "1"},
+            {"format_function", "x => `sqrt(${x})`"},
+            {"help", "Returns the square root of the numeric column."},
+            {"signature", "sqrt(x: Number): Number"}
+        }},
+        {"abs", {
+            {"name", "abs"},
+            {"label", "abs(x)"},
+            {"pattern", "abs"},
+            {"computed_function_name", "abs"},
+            {"input_type", "float"},
+            {"return_type", "float"},
+            {"category", "FunctionTokenType"},
+            {"num_params", "1"},
+            {"format_function", "x => `abs(${x})`"},
+            {"help", "Returns the absolute value of the numeric column."},
+            {"signature", "abs(x: Number): Number"}
+        }},
+        {"bin10", {
+            {"name", "bin10"},
+            {"label", "Bucket x by 10"},
+            {"pattern", "bin10"},
+            {"computed_function_name", "Bucket (10)"},
+            {"input_type", "float"},
+            {"return_type", "float"},
+            {"category", "FunctionTokenType"},
+            {"num_params", "1"},
+            {"format_function", "x => `bin10(${x})`"},
+            {"help", "Buckets the numeric column to the nearest 10."},
+            {"signature", "bin10(x: Number): Number"}
+        }},
+        {"bin100", {
+            {"name", "bin100"},
+            {"label", "Bucket x by 100"},
+            {"pattern", "bin100"},
+            {"computed_function_name", "Bucket (100)"},
+            {"input_type", "float"},
+            {"return_type", "float"},
+            {"category", "FunctionTokenType"},
+            {"num_params", "1"},
+            {"format_function", "x => `bin100(${x})`"},
+            {"help", "Buckets the numeric column to the nearest 100."},
+            {"signature", "bin100(x: Number): Number"}
+        }},
+        {"bin1000", {
+            {"name", "bin1000"},
+            {"label", "Bucket x by 1000"},
+            {"pattern", "bin1000"},
+            {"computed_function_name", "Bucket (1000)"},
+            {"input_type", "float"},
+            {"return_type", "float"},
+            {"category", "FunctionTokenType"},
+            {"num_params", "1"},
+            {"format_function", "x => `bin1000(${x})`"},
+            {"help", "Buckets the numeric column to the nearest 1000."},
+            {"signature", "bin1000(x: Number): Number"}
+        }},
+        {"bin10th", {
+            {"name", "bin10th"},
+            {"label", "Bucket x by 1/10"},
+            {"pattern", "bin10th"},
+            {"computed_function_name", "Bucket (1/10)"},
+            {"input_type", "float"},
+            {"return_type", "float"},
+            {"category", "FunctionTokenType"},
+            {"num_params", "1"},
+            {"format_function", "x => `bin10th(${x})`"},
+            {"help", "Buckets the numeric column to the nearest 0.1."},
+            {"signature", "bin10th(x: Number): Number"}
+        }},
+        {"bin100th", {
+            {"name", "bin100th"},
+            {"label", "Bucket x by 1/100"},
+            {"pattern", "bin100th"},
+            {"computed_function_name", "Bucket (1/100)"},
+            {"input_type", "float"},
+            {"return_type", "float"},
+            {"category", "FunctionTokenType"},
+            {"num_params", "1"},
+            {"format_function", "x => `bin100th(${x})`"},
+            {"help", "Buckets the numeric column to the nearest 0.01."},
+            {"signature", "bin100th(x: Number): Number"}
+        }},
+        {"bin1000th", {
+            {"name", "bin1000th"},
+            {"label", "Bucket x by 1/1000"},
+            {"pattern", "bin1000th"},
+            {"computed_function_name", "Bucket (1/1000)"},
+            {"input_type", "float"},
+            {"return_type", "float"},
+            {"category", "FunctionTokenType"},
+            {"num_params", "1"},
+            {"format_function", "x => `bin1000th(${x})`"},
+            {"help", "Buckets the numeric column to the nearest 0.001."},
+            {"signature", "bin1000th(x: Number): Number"}
+        }},
+        // String Functions
+        {"length", {
+            {"name", "length"},
+            {"label", "length(x)"},
+            {"pattern", "length"},
+            {"computed_function_name", "length"},
+            {"input_type", "string"},
+            {"return_type", "integer"},
+            {"category", "FunctionTokenType"},
+            {"num_params", "1"},
+            {"format_function", "x => `length(${x})`"},
+            {"help", "Returns the length of the string column."},
+            {"signature", "length(x: String): Number"}
+        }},
+        {"uppercase", {
+            {"name", "uppercase"},
+            {"label", "uppercase(x)"},
+            {"pattern", "uppercase"},
+            {"computed_function_name", "Uppercase"},
+            {"input_type", "string"},
+            {"return_type", "string"},
+            {"category", "FunctionTokenType"},
+            {"num_params", "1"},
+            {"format_function", "x => `uppercase(${x})`"},
+            {"help", "Converts each string to uppercase in the column."},
+            {"signature", "uppercase(x: String): String"}
+        }},
+        {"lowercase", {
+            {"name", "lowercase"},
+            {"label", "lowercase(x)"},
+            {"pattern", "lowercase"},
+            {"computed_function_name", "Lowercase"},
+            {"input_type", "string"},
+            {"return_type", "string"},
+            {"category", "FunctionTokenType"},
+            {"num_params", "1"},
+            {"format_function", "x => `lowercase(${x})`"},
+            {"help", "Converts each string to lowercase in the column."},
+            {"signature", "lowercase(x: String): String"}
+        }},
+        {"concat_space", {
+            {"name", "concat_space"},
+            {"label", "Concat(x, y) with space"},
+            {"pattern", "concat_space"},
+            {"computed_function_name", "concat_space"},
+            {"input_type", "string"},
+            {"return_type", "string"},
+            {"category", "FunctionTokenType"},
+            {"num_params", "2"},
+            {"format_function", "x => `concat_space(${x})`"},
+            {"help", "Concatenates two columns with a space."},
+            {"signature", "concat_space(x: String, y: String): String"}
+        }},
+        {"concat_comma", {
+            {"name", "concat_comma"},
+            {"label", "Concat(x, y) with comma"},
+            {"pattern", "concat_comma"},
+            {"computed_function_name", "concat_comma"},
+            {"input_type", "string"},
+            {"return_type", "string"},
+            {"category", "FunctionTokenType"},
+            {"num_params", "2"},
+            {"format_function", "x => `concat_comma(${x})`"},
+            {"help", "Concatenates two columns with a comma."},
+            {"signature", "concat_comma(x: String, y: String): String"}
+        }},
+        // Date Functions
+        {"hour_of_day", {
+            {"name", "hour_of_day"},
+            {"label", "Hour of day"},
+            {"pattern", "hour_of_day"},
+            {"computed_function_name", "Hour of Day"},
+            {"input_type", "datetime"},
+            {"return_type", "integer"},
+            {"category", "FunctionTokenType"},
+            {"num_params", "1"},
+            {"format_function", "x => `hour_of_day(${x})`"},
+            {"help", "Returns the hour of day (0-23) in UTC for the datetime column."},
+            {"signature", "hour_of_day(x: Datetime): Number"}
+        }},
+        {"day_of_week", {
+            {"name", "day_of_week"},
+            {"label", "Day of week"},
+            {"pattern", "day_of_week"},
+            {"computed_function_name", "Day of Week"},
+            {"input_type", "datetime"},
+            {"return_type", "string"},
+            {"category", "FunctionTokenType"},
+            {"num_params", "1"},
+            {"format_function", "x => `day_of_week(${x})`"},
+            {"help", "Returns the day of week in UTC for the datetime column."},
+            {"signature", "day_of_week(x: Datetime): String"}
+        }},
+        {"month_of_year", {
+            {"name", "month_of_year"},
+            {"label", "Month of year"},
+            {"pattern", "month_of_year"},
+            {"computed_function_name", "Month of Year"},
+            {"input_type", "datetime"},
+            {"return_type", "string"},
+            {"category", "FunctionTokenType"},
+            {"num_params", "1"},
+            {"format_function", "x => `month_of_year(${x})`"},
+            {"help", "Returns the month of year in UTC for the datetime column."},
+            {"signature", "month_of_year(x: Datetime): String"}
+        }},
+        {"second_bucket", {
+            {"name", "second_bucket"},
+            {"label", "Bucket(x) by seconds"},
+            {"pattern", "second_bucket"},
+            {"computed_function_name", "Bucket (s)"},
+            {"input_type", "datetime"},
+            {"return_type", "datetime"},
+            {"category", "FunctionTokenType"},
+            {"num_params", "1"},
+            {"format_function", "x => `second_bucket(${x})`"},
+            {"help", "Buckets the datetime column to the nearest second."},
+            {"signature", "second_bucket(x: Datetime): Datetime"}
+        }},
+        {"minute_bucket", {
+            {"name", "minute_bucket"},
+            {"label", "Bucket(x) by minutes"},
+            {"pattern", "minute_bucket"},
+            {"computed_function_name", "Bucket (m)"},
+            {"input_type", "datetime"},
+            {"return_type", "datetime"},
+            {"category", "FunctionTokenType"},
+            {"num_params", "1"},
+            {"format_function", "x => `minute_bucket(${x})`"},
+            {"help", "Buckets the datetime column to the nearest minute."},
+            {"signature", "minute_bucket(x: Datetime): Datetime"}
+        }},
+        {"hour_bucket", {
+            {"name", "hour_bucket"},
+            {"label", "Bucket(x) by hours"},
+            {"pattern", "hour_bucket"},
+            {"computed_function_name", "Bucket (h)"},
+            {"input_type", "datetime"},
+            {"return_type", "datetime"},
+            {"category", "FunctionTokenType"},
+            {"num_params", "1"},
+            {"format_function", "x => `hour_bucket(${x})`"},
+            {"help", "Buckets the datetime column to the nearest hour."},
+            {"signature", "hour_bucket(x: Datetime): Datetime"}
+        }},
+        {"day_bucket", {
+            {"name", "day_bucket"},
+            {"label", "Bucket(x) by days"},
+            {"pattern", "day_bucket"},
+            {"computed_function_name", "Bucket (D)"},
+            {"input_type", "datetime"},
+            {"return_type", "date"},
+            {"category", "FunctionTokenType"},
+            {"num_params", "1"},
+            {"format_function", "x => `day_bucket(${x})`"},
+            {"help", "Buckets the datetime column to the nearest day."},
+            {"signature", "day_bucket(x: Datetime): Datetime"}
+        }},
+        {"week_bucket", {
+            {"name", "week_bucket"},
+            {"label", "Bucket(x) by weeks"},
+            {"pattern", "week_bucket"},
+            {"computed_function_name", "Bucket (W)"},
+            {"input_type", "datetime"},
+            {"return_type", "date"},
+            {"category", "FunctionTokenType"},
+            {"num_params", "1"},
+            {"format_function", "x => `week_bucket(${x})`"},
+            {"help", "Buckets the datetime column to the nearest week."},
+            {"signature", "week_bucket(x: Datetime): Datetime"}
+        }},
+        {"month_bucket", {
+            {"name", "month_bucket"},
+            {"label", "Bucket(x) by months"},
+            {"pattern", "month_bucket"},
+            {"computed_function_name", "Bucket (M)"},
+            {"input_type", "datetime"},
+            {"return_type", "date"},
+            {"category", "FunctionTokenType"},
+            {"num_params", "1"},
+            {"format_function", "x => `month_bucket(${x})`"},
+            {"help", "Buckets the datetime column to the nearest month."},
+            {"signature", "month_bucket(x: Datetime): Datetime"}
+        }},
+        {"year_bucket", {
+            {"name", "year_bucket"},
+            {"label", "Bucket(x) by years"},
+            {"pattern", "year_bucket"},
+            {"computed_function_name", "Bucket (Y)"},
+            {"input_type", "datetime"},
+            {"return_type", "date"},
+            {"category", "FunctionTokenType"},
+            {"num_params", "1"},
+            {"format_function", "x => `year_bucket(${x})`"},
+            {"help", "Buckets the datetime column to the nearest year."},
+            {"signature", "year_bucket(x: Datetime): Datetime"}
+        }}
+    };
+    return computed_functions;
+}
 
-} // end namespace perspective
\ No newline at end of file
+} // end namespace perspective
@@ -11,6 +11,20 @@
 
 namespace perspective {
 
+namespace {
+
+bool
+is_same_definition(const t_computed_column_definition& a, const t_computed_column_definition& b) {
+    const t_computation& a_computation = std::get<3>(a);
+    const t_computation& b_computation = std::get<3>(b);
+    return std::get<1>(a) == std::get<1>(b) && std::get<2>(a) == std::get<2>(b)
+        && a_computation.m_name == b_computation.m_name
+        && a_computation.m_input_types == b_computation.m_input_types
+        && a_computation.m_return_type == b_computation.m_return_type;
+}
+
+} // end anonymous namespace
+
 t_computed_column_map::t_computed_column_map() {};
 
 void
@@ -18,18 +32,218 @@ t_computed_column_map::add_computed_columns(
     const std::vector<t_computed_column_definition>& columns) {
     for (const auto& col : columns) {
         std::string name = std::get<0>(col);
+        auto iter = m_computed_columns.find(name);
+
+        if (iter == m_computed_columns.end() || !is_same_definition(iter->second, col)) {
+            m_stale_columns.insert(name);
+        }
+
         m_computed_columns[name] = col;
+        m_reference_counts[name]++;
     }
+
+    update_dependents();
 }
 
-void
+std::vector<std::string>
 t_computed_column_map::remove_computed_columns(
     const std::vector<std::string>& names) {
+    std::vector<std::string> removed;
+
     for (const auto& name : names) {
-        if (m_computed_columns.count(name)) {
-            m_computed_columns.erase(name);
+        auto iter = m_reference_counts.find(name);
+        if (iter == m_reference_counts.end()) {
+            continue;
+        }
+
+        if (--iter->second > 0) {
+            continue;
+        }
+
+        m_reference_counts.erase(iter);
+        m_computed_columns.erase(name);
+        m_stale_columns.erase(name);
+        removed.push_back(name);
+    }
+
+    update_dependents();
+    return removed;
+}
+
+void
+t_computed_column_map::update_expressions(const std::set<std::string>& referenced) {
+    std::set<std::string> materialized;
+
+    for (const auto& iter : m_computed_columns) {
+        const t_computation& computation = std::get<3>(iter.second);
+        if (computation.m_name == INVALID_COMPUTED_FUNCTION) {
+            continue;
+        }
+
+        if (referenced.count(iter.first) || computation.m_return_type == DTYPE_STR) {
+            materialized.insert(iter.first);
+        }
+    }
+
+    // Columns that are only now materialized have no values yet.
+    for (const std::string& name : materialized) {
+        if (m_expressions.count(name) == 0) {
+            m_stale_columns.insert(name);
+        }
+    }
+
+    m_expressions.clear();
+
+    for (const auto& iter : m_computed_columns) {
+        if (materialized.count(iter.first) == 0) {
+            continue;
+        }
+
+        std::set<std::string> visiting;
+        m_expressions[iter.first] = build_expression(iter.second, materialized, visiting);
+    }
+
+    m_read_columns.clear();
+    m_transitional_columns.clear();
+    std::vector<std::string> stack;
+
+    for (const auto& iter : m_expressions) {
+        if (referenced.count(iter.first)) {
+            m_read_columns.insert(iter.first);
+            m_transitional_columns.insert(iter.first);
+            stack.push_back(iter.first);
+        }
+    }
+
+    while (!stack.empty()) {
+        std::string name = stack.back();
+        stack.pop_back();
+
+        for (const t_computed_expression* leaf : m_expressions.at(name)->get_leaves()) {
+            const std::string& input_name = leaf->get_column_name();
+            if (leaf->is_computed() && m_expressions.count(input_name)
+                && m_transitional_columns.insert(input_name).second) {
+                stack.push_back(input_name);
+            }
+        }
+    }
+
+    update_levels();
+}
+
+std::shared_ptr<t_computed_expression>
+t_computed_column_map::get_expression(const std::string& name) const {
+    auto iter = m_expressions.find(name);
+    if (iter == m_expressions.end()) {
+        return nullptr;
+    }
+
+    return iter->second;
+}
+
+std::set<std::string>
+t_computed_column_map::get_affected_columns(
+    const std::set<std::string>& changed_columns) const {
+    std::set<std::string> affected;
+    std::vector<std::string> stack(changed_columns.begin(), changed_columns.end());
+
+    while (!stack.empty()) {
+        std::string name = stack.back();
+        stack.pop_back();
+
+        auto iter = m_dependents.find(name);
+        if (iter == m_dependents.end()) {
+            continue;
+        }
+
+        for (const std::string& dependent : iter->second) {
+            if (affected.insert(dependent).second) {
+                stack.push_back(dependent);
+            }
+        }
+    }
+
+    return affected;
+}
+
+void
+t_computed_column_map::update_dependents() {
+    m_dependents.clear();
+
+    for (const auto& iter : m_computed_columns) {
+        for (const std::string& input_name : std::get<2>(iter.second)) {
+            m_dependents[input_name].push_back(iter.first);
+        }
+    }
+}
+
+void
+t_computed_column_map::update_levels() {
+    std::map<std::string, t_uindex> levels;
+    m_levels.clear();
+
+    for (const auto& iter : m_expressions) {
+        std::set<std::string> visiting;
+        t_uindex level = get_level(iter.first, levels, visiting);
+
+        if (m_levels.size() <= level) {
+            m_levels.resize(level + 1);
         }
+
+        m_levels[level].push_back(iter.first);
+    }
+}
+
+t_uindex
+t_computed_column_map::get_level(const std::string& name,
+    std::map<std::string, t_uindex>& levels, std::set<std::string>& visiting) const {
+    auto memo = levels.find(name);
+    if (memo != levels.end()) {
+        return memo->second;
     }
+
+    t_uindex level = 0;
+    visiting.insert(name);
+
+    for (const t_computed_expression* leaf : m_expressions.at(name)->get_leaves()) {
+        const std::string& input_name = leaf->get_column_name();
+        if (leaf->is_computed() && m_expressions.count(input_name)
+            && visiting.count(input_name) == 0) {
+            level = std::max(level, get_level(input_name, levels, visiting) + 1);
+        }
+    }
+
+    visiting.erase(name);
+    levels[name] = level;
+    return level;
+}
+
+std::shared_ptr<t_computed_expression>
+t_computed_column_map::build_expression(const t_computed_column_definition& column,
+    const std::set<std::string>& materialized, std::set<std::string>& visiting) const {
+    visiting.insert(std::get<0>(column));
+
+    std::vector<std::shared_ptr<t_computed_expression>> inputs;
+
+    for (const std::string& input_name : std::get<2>(column)) {
+        auto iter = m_computed_columns.find(input_name);
+        bool is_computed = iter != m_computed_columns.end();
+
+        if (is_computed && materialized.count(input_name) == 0
+            && visiting.count(input_name) == 0) {
+            const t_computation& computation = std::get<3>(iter->second);
+            if (computation.m_name != INVALID_COMPUTED_FUNCTION) {
+                inputs.push_back(build_expression(iter->second, materialized, visiting));
+                continue;
+            }
+        }
+
+        inputs.push_back(std::make_shared<t_computed_expression>(input_name, is_computed));
+    }
+
+    visiting.erase(std::get<0>(column));
+
+    return std::make_shared<t_computed_expression>(std::get<3>(column), inputs);
 }
 
 } // end namespace perspective
\ No newline at end of file
@@ -0,0 +1,281 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#include <perspective/first.h>
+#include <perspective/computed_expression.h>
+
+namespace perspective {
+
+t_computed_expression::t_computed_expression(
+    const std::string& column_name, bool is_computed)
+    : m_column_name(column_name)
+    , m_is_computed(is_computed)
+    , m_leaf_idx(0) {}
+
+t_computed_expression::t_computed_expression(const t_computation& computation,
+    const std::vector<std::shared_ptr<t_computed_expression>>& inputs)
+    : m_is_computed(false)
+    , m_leaf_idx(0)
+    , m_computation(computation)
+    , m_inputs(inputs) {
+    PSP_VERBOSE_ASSERT(
+        m_inputs.size() == 1 || m_inputs.size() == 2, "Computed columns must have 1 or 2 inputs.");
+
+    bool returns_string = m_computation.m_return_type == DTYPE_STR;
+
+    switch (m_inputs.size()) {
+        case 1: {
+            if (returns_string) {
+                m_string_function_1 = t_computed_column::get_computed_function_string_1(m_computation);
+            } else {
+                m_function_1 = t_computed_column::get_computed_function_1(m_computation);
+            }
+        } break;
+        default: {
+            if (returns_string) {
+                m_string_function_2 = t_computed_column::get_computed_function_string_2(m_computation);
+            } else {
+                m_function_2 = t_computed_column::get_computed_function_2(m_computation);
+            }
+        } break;
+    }
+
+    // Inputs are now part of this tree, so only this node keeps leaves.
+    for (const auto& input : m_inputs) {
+        PSP_VERBOSE_ASSERT(input->is_leaf() || input->m_computation.m_return_type != DTYPE_STR,
+            "Only the root of a computed expression may return a string.");
+        input->m_leaves.clear();
+    }
+
+    collect_leaves(m_leaves);
+}
+
+bool
+t_computed_expression::is_leaf() const {
+    return m_inputs.empty();
+}
+
+bool
+t_computed_expression::is_fused() const {
+    for (const auto& input : m_inputs) {
+        if (!input->is_leaf()) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+const std::string&
+t_computed_expression::get_column_name() const {
+    return m_column_name;
+}
+
+bool
+t_computed_expression::is_computed() const {
+    return m_is_computed;
+}
+
+const std::vector<const t_computed_expression*>&
+t_computed_expression::get_leaves() const {
+    return m_leaves;
+}
+
+const t_computation&
+t_computed_expression::get_computation() const {
+    return m_computation;
+}
+
+void
+t_computed_expression::collect_leaves(std::vector<const t_computed_expression*>& leaves) {
+    if (is_leaf()) {
+        m_leaf_idx = leaves.size();
+        leaves.push_back(this);
+        return;
+    }
+
+    for (const auto& input : m_inputs) {
+        input->collect_leaves(leaves);
+    }
+}
+
+t_tscalar
+t_computed_expression::evaluate(const std::vector<t_tscalar>& leaf_values) const {
+    if (is_leaf()) {
+        return leaf_values[m_leaf_idx];
+    }
+
+    t_tscalar x = m_inputs[0]->evaluate(leaf_values);
+    if (!x.is_valid() || x.is_none()) {
+        return mknone();
+    }
+
+    if (m_inputs.size() == 1) {
+        return m_function_1(x);
+    }
+
+    t_tscalar y = m_inputs[1]->evaluate(leaf_values);
+    if (!y.is_valid() || y.is_none()) {
+        return mknone();
+    }
+
+    return m_function_2(x, y);
+}
+
+void
+t_computed_expression::write_row(const std::vector<t_tscalar>& leaf_values, t_uindex idx,
+    std::shared_ptr<t_column> output_column) const {
+    if (m_computation.m_return_type != DTYPE_STR) {
+        t_tscalar rval = evaluate(leaf_values);
+
+        if (!rval.is_valid() || rval.is_none()) {
+            output_column->clear(idx);
+        } else {
+            output_column->set_scalar(idx, rval);
+        }
+
+        return;
+    }
+
+    std::vector<t_tscalar> args;
+    args.reserve(m_inputs.size());
+
+    for (const auto& input : m_inputs) {
+        t_tscalar arg = input->evaluate(leaf_values);
+        if (!arg.is_valid() || arg.is_none()) {
+            output_column->clear(idx);
+            return;
+        }
+
+        args.push_back(arg);
+    }
+
+    if (args.size() == 1) {
+        m_string_function_1(args[0], idx, output_column);
+    } else {
+        m_string_function_2(args[0], args[1], idx, output_column);
+    }
+}
+
+void
+t_computed_expression::compute(
+    const t_data_table& tbl, std::shared_ptr<t_column> output_column) const {
+    PSP_VERBOSE_ASSERT(!is_leaf(), "Cannot compute a leaf of a computed expression.");
+
+    std::vector<std::shared_ptr<t_column>> leaf_columns;
+    leaf_columns.reserve(m_leaves.size());
+
+    for (const t_computed_expression* leaf : m_leaves) {
+        leaf_columns.push_back(tbl.get_column(leaf->m_column_name));
+    }
+
+    // A single computation keeps the typed kernels of `apply_computation`.
+    if (!is_fused()) {
+        t_computed_column::apply_computation(leaf_columns, output_column, m_computation);
+        return;
+    }
+
+    t_uindex end = leaf_columns[0]->size();
+    std::vector<t_tscalar> leaf_values(leaf_columns.size());
+
+    for (t_uindex idx = 0; idx < end; ++idx) {
+        bool skip_row = false;
+
+        for (t_uindex lidx = 0, loop_end = leaf_columns.size(); lidx < loop_end; ++lidx) {
+            leaf_values[lidx] = leaf_columns[lidx]->get_scalar(idx);
+            if (!leaf_values[lidx].is_valid()) {
+                output_column->clear(idx);
+                skip_row = true;
+                break;
+            }
+        }
+
+        if (skip_row) {
+            continue;
+        }
+
+        write_row(leaf_values, idx, output_column);
+    }
+}
+
+void
+t_computed_expression::recompute(const t_data_table& tbl, const t_data_table& flattened,
+    const std::vector<t_rlookup>& changed_rows, std::shared_ptr<t_column> output_column) const {
+    PSP_VERBOSE_ASSERT(!is_leaf(), "Cannot compute a leaf of a computed expression.");
+
+    std::vector<std::shared_ptr<t_column>> table_columns;
+    std::vector<std::shared_ptr<t_column>> flattened_columns;
+    table_columns.reserve(m_leaves.size());
+    flattened_columns.reserve(m_leaves.size());
+
+    bool has_computed_leaf = false;
+
+    for (const t_computed_expression* leaf : m_leaves) {
+        table_columns.push_back(tbl.get_column(leaf->m_column_name));
+        flattened_columns.push_back(flattened.get_column(leaf->m_column_name));
+        has_computed_leaf = has_computed_leaf || leaf->m_is_computed;
+    }
+
+    if (!is_fused() && !has_computed_leaf) {
+        t_computed_column::reapply_computation(
+            table_columns, flattened_columns, changed_rows, output_column, m_computation);
+        return;
+    }
+
+    t_uindex end = changed_rows.size();
+    if (end == 0) {
+        end = table_columns[0]->size();
+    }
+
+    std::vector<t_tscalar> leaf_values(m_leaves.size());
+
+    for (t_uindex idx = 0; idx < end; ++idx) {
+        bool row_already_exists = false;
+        t_uindex ridx = idx;
+
+        if (changed_rows.size() > 0) {
+            ridx = changed_rows[idx].m_idx;
+            row_already_exists = changed_rows[idx].m_exists;
+        }
+
+        bool skip_row = false;
+
+        for (t_uindex lidx = 0, loop_end = m_leaves.size(); lidx < loop_end; ++lidx) {
+            const t_column& flattened_column = *flattened_columns[lidx];
+            t_tscalar arg = flattened_column.get_scalar(idx);
+
+            if (!arg.is_valid()) {
+                bool should_unset = (row_already_exists && flattened_column.is_cleared(idx))
+                    || (!row_already_exists && !flattened_column.is_valid(idx));
+
+                if (should_unset) {
+                    output_column->unset(idx);
+                    skip_row = true;
+                    break;
+                }
+
+                // A computed input has already been recomputed on
+                // `flattened`, so an invalid value there is the new value.
+                if (!m_leaves[lidx]->m_is_computed) {
+                    arg = table_columns[lidx]->get_scalar(ridx);
+                }
+            }
+
+            leaf_values[lidx] = arg;
+        }
+
+        if (skip_row) {
+            continue;
+        }
+
+        write_row(leaf_values, idx, output_column);
+    }
+}
+
+} // end namespace perspective
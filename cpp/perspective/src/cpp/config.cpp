@@ -92,6 +92,25 @@ t_config::t_config(
     setup(m_detail_columns, std::vector<std::string>{}, std::vector<std::string>{});
 }
 
+// t_ctx_grouped_pkey
+t_config::t_config(const std::vector<std::string>& detail_columns,
+    const std::string& parent_pkey_column, const std::string& child_pkey_column,
+    const std::string& grouping_label_column, const std::vector<t_fterm>& fterms,
+    t_filter_op combiner)
+    : m_detail_columns(detail_columns)
+    , m_totals(TOTALS_BEFORE)
+    , m_fterms(fterms)
+    , m_combiner(combiner)
+    , m_parent_pkey_column(parent_pkey_column)
+    , m_child_pkey_column(child_pkey_column)
+    , m_grouping_label_column(grouping_label_column)
+    , m_fmode(FMODE_SIMPLE_CLAUSES) {
+    for (const auto& column : detail_columns) {
+        m_aggregates.push_back(t_aggspec(column, AGGTYPE_IDENTITY, column));
+    }
+    setup(m_detail_columns, std::vector<std::string>{}, std::vector<std::string>{});
+}
+
 // Constructors used for C++ tests
 t_config::t_config(const std::vector<std::string>& row_pivots,
     const std::vector<std::string>& col_pivots, const std::vector<t_aggspec>& aggregates)
@@ -188,6 +207,8 @@ t_config::setup(const std::vector<std::string>& detail_columns,
             case AGGTYPE_WEIGHTED_MEAN:
             case AGGTYPE_UNIQUE:
             case AGGTYPE_MEDIAN:
+            case AGGTYPE_MIN:
+            case AGGTYPE_MAX:
             case AGGTYPE_JOIN:
             case AGGTYPE_DOMINANT:
             case AGGTYPE_PY_AGG:
@@ -196,6 +217,8 @@ t_config::setup(const std::vector<std::string>& detail_columns,
             case AGGTYPE_ABS_SUM:
             case AGGTYPE_MUL:
             case AGGTYPE_DISTINCT_COUNT:
+            case AGGTYPE_APPROX_DISTINCT_COUNT:
+            case AGGTYPE_APPROX_PERCENTILE:
             case AGGTYPE_DISTINCT_LEAF:
                 m_has_pkey_agg = true;
                 break;
@@ -222,7 +245,7 @@ t_config::populate_sortby(const std::vector<t_pivot>& pivots) {
 
         PSP_VERBOSE_ASSERT(
             pivot.mode() == PIVOT_MODE_NORMAL, "Only normal pivots supported for now");
-        std::string pstr = pivot.colname();
+        std::string pstr = pivot.name();
         if (m_sortby.find(pstr) == m_sortby.end())
             m_sortby[pstr] = pstr;
     }
@@ -245,6 +268,69 @@ t_config::repr() const {
     return ss.str();
 }
 
+std::string
+t_config::get_tree_signature() const {
+    // Fields are separated by a unit separator, so that no two configs
+    // produce the same signature by running names together.
+    const char sep = '\x1f';
+    std::stringstream ss;
+
+    ss << "rpivots" << sep;
+    for (const auto& pivot : m_row_pivots) {
+        ss << pivot.name() << sep << pivot.mode() << sep;
+    }
+
+    ss << "cpivots" << sep;
+    for (const auto& pivot : m_col_pivots) {
+        ss << pivot.name() << sep << pivot.mode() << sep;
+    }
+
+    ss << "aggregates" << sep;
+    for (const auto& agg : m_aggregates) {
+        ss << agg.name() << sep << agg.agg() << sep << agg.get_sort_type() << sep;
+        for (const auto& dep : agg.get_input_depnames()) {
+            ss << dep << sep;
+        }
+        ss << agg.get_agg_one_idx() << sep << agg.get_agg_two_idx() << sep
+           << agg.get_agg_one_weight() << sep << agg.get_agg_two_weight() << sep
+           << agg.get_kernel() << sep;
+    }
+
+    ss << "sortby" << sep;
+    for (const auto& kv : m_sortby) {
+        ss << kv.first << sep << kv.second << sep;
+    }
+
+    ss << "filters" << sep << m_combiner << sep << m_fmode << sep;
+    for (const auto& fterm : m_fterms) {
+        ss << fterm.m_colname << sep << fterm.m_op << sep << fterm.m_negated << sep
+           << perspective::repr(fterm.m_threshold) << sep;
+        for (const auto& value : fterm.m_bag) {
+            ss << perspective::repr(value) << sep;
+        }
+    }
+
+    for (const auto& expr : m_filter_exprs) {
+        ss << expr << sep;
+    }
+
+    if (m_fmode == FMODE_JIT_EXPR) {
+        ss << m_fexpr.get_expr() << sep;
+    }
+
+    ss << "computed" << sep;
+    for (const auto& computed : m_computed_columns) {
+        ss << std::get<0>(computed) << sep << std::get<1>(computed) << sep;
+        for (const auto& input : std::get<2>(computed)) {
+            ss << input << sep;
+        }
+    }
+
+    ss << "totals" << sep << m_totals << sep << m_column_only;
+
+    return ss.str();
+}
+
 t_uindex
 t_config::get_num_aggregates() const {
     return m_aggregates.size();
@@ -367,6 +453,9 @@ t_config::has_filters() const {
         case FMODE_SIMPLE_CLAUSES: {
             return !m_fterms.empty();
         } break;
+        case FMODE_JIT_EXPR: {
+            return m_fexpr.num_terms() > 0;
+        } break;
         default: { return false; }
     }
     return false;
@@ -377,6 +466,31 @@ t_config::get_fterms() const {
     return m_fterms;
 }
 
+void
+t_config::set_filter_expr(const t_fexpr& fexpr) {
+    m_fexpr = fexpr;
+    m_fterms.clear();
+    m_fmode = FMODE_JIT_EXPR;
+}
+
+const t_fexpr&
+t_config::get_filter_expr() const {
+    return m_fexpr;
+}
+
+std::set<std::string>
+t_config::get_filter_columns() const {
+    std::set<std::string> rval;
+    for (const t_fterm& fterm : m_fterms) {
+        rval.insert(fterm.m_colname);
+    }
+
+    if (m_fmode == FMODE_JIT_EXPR) {
+        m_fexpr.get_columns(rval);
+    }
+    return rval;
+}
+
 std::vector<t_computed_column_definition>
 t_config::get_computed_columns() const {
     return m_computed_columns;
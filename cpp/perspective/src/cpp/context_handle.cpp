@@ -14,11 +14,27 @@ namespace perspective {
 
 t_ctx_handle::t_ctx_handle()
     : m_ctx_type(ZERO_SIDED_CONTEXT)
-    , m_ctx(0) {}
+    , m_ctx(0)
+    , m_priority(CTX_PRIORITY_VISIBLE)
+    , m_stale(false)
+    , m_building(false)
+    , m_build_offset(0)
+    , m_frozen(false)
+    , m_frozen_at(0)
+    , m_thaw_priority(CTX_PRIORITY_VISIBLE)
+    , m_memory_budget(0) {}
 
 t_ctx_handle::t_ctx_handle(void* ctx, t_ctx_type ctx_type)
     : m_ctx_type(ctx_type)
-    , m_ctx(ctx) {}
+    , m_ctx(ctx)
+    , m_priority(CTX_PRIORITY_VISIBLE)
+    , m_stale(false)
+    , m_building(false)
+    , m_build_offset(0)
+    , m_frozen(false)
+    , m_frozen_at(0)
+    , m_thaw_priority(CTX_PRIORITY_VISIBLE)
+    , m_memory_budget(0) {}
 
 std::string
 t_ctx_handle::get_type_descr() const {
@@ -24,15 +24,22 @@ namespace perspective {
 t_ctx1::t_ctx1(const t_schema& schema, const t_config& pivot_config)
     : t_ctxbase<t_ctx1>(schema, pivot_config)
     , m_depth(0)
-    , m_depth_set(false) {}
+    , m_depth_set(false)
+    , m_lazy_aggregates(t_env::lazy_aggregates())
+    , m_tree_leader(nullptr) {}
 
-t_ctx1::~t_ctx1() {}
+t_ctx1::~t_ctx1() {
+    leave_tree_group();
+}
 
 void
 t_ctx1::init() {
     auto pivots = m_config.get_row_pivots();
     m_tree = std::make_shared<t_stree>(pivots, m_config.get_aggregates(), m_schema, m_config);
     m_tree->init();
+    if (m_lazy_aggregates) {
+        m_tree->set_lazy_depth(1);
+    }
     m_traversal = std::shared_ptr<t_traversal>(new t_traversal(m_tree));
     m_minmax = std::vector<t_minmax>(m_config.get_num_aggregates());
     m_init = true;
@@ -66,6 +73,16 @@ t_ctx1::repr() const {
     return ss.str();
 }
 
+std::map<std::string, t_uindex>
+t_ctx1::get_memory_usage() const {
+    std::map<std::string, t_uindex> rv;
+    rv["traversal"] = m_traversal->nbytes();
+    rv["tree"] = m_tree->nbytes();
+    auto aggtable = m_tree->get_aggtable();
+    rv["aggregates"] = aggtable->nbytes() + aggtable->vocab_nbytes();
+    return rv;
+}
+
 t_index
 t_ctx1::open(t_index idx) {
     PSP_TRACE_SENTINEL();
@@ -77,6 +94,10 @@ t_ctx1::open(t_index idx) {
     if (idx >= t_index(m_traversal->size()))
         return 0;
 
+    if (m_lazy_aggregates && m_gstate) {
+        m_tree->materialize_children(m_traversal->get_tree_index(idx), *m_gstate, m_config);
+    }
+
     t_index retval = m_traversal->expand_node(m_sortby, idx);
     m_rows_changed = (retval > 0);
     return retval;
@@ -215,10 +236,15 @@ t_ctx1::notify(const t_data_table& flattened, const t_data_table& delta,
     const t_data_table& existed) {
     PSP_TRACE_SENTINEL();
     PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    // a follower's traversal is updated by its leader
+    if (m_tree_leader) {
+        return;
+    }
+
     psp_log_time(repr() + " notify.enter");
-    notify_sparse_tree(m_tree, m_traversal, true, m_config.get_aggregates(),
-        m_config.get_sortby_pairs(), m_sortby, flattened, delta, prev, current, transitions,
-        existed, m_config, *m_gstate);
+    notify_sparse_tree(m_tree, get_tree_traversals(), m_config.get_aggregates(),
+        m_config.get_sortby_pairs(), flattened, delta, prev, current, transitions, existed,
+        m_config, *m_gstate);
     psp_log_time(repr() + " notify.exit");
 }
 
@@ -226,7 +252,26 @@ void
 t_ctx1::step_begin() {
     PSP_TRACE_SENTINEL();
     PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
-    reset_step_state();
+    bool reset_deltas = begin_step_deltas();
+    if (reset_deltas) {
+        reset_step_state();
+    }
+    m_step_row_count = get_row_count();
+
+    // a follower reads the nodes its leader's step updates
+    if (!m_tree_leader) {
+        m_tree->clear_updated();
+    }
+
+    if (!m_tree_followers.empty()) {
+        // Unread coalesced deltas of the shared tree are kept for the leader.
+        if (reset_deltas) {
+            m_tree->clear_deltas();
+        }
+        for (t_ctx1* follower : m_tree_followers) {
+            follower->step_begin();
+        }
+    }
 }
 
 void
@@ -234,10 +279,25 @@ t_ctx1::step_end() {
     PSP_TRACE_SENTINEL();
     PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
     m_minmax = m_tree->get_min_max();
-    sort_by(m_sortby);
+
+    // Changes to the traversal are counted by its own version.
+    if (!m_tree->get_updated().empty()) {
+        ++m_data_version;
+    }
+
+    // Only the nodes updated this step can have moved
+    if (!m_sortby.empty()) {
+        PSP_TRACE_SPAN("ctx1.sort");
+        m_traversal->resort_nodes(m_sortby, m_tree->get_updated(), *(m_tree.get()));
+    }
+
     if (m_depth_set) {
         set_depth(m_depth);
     }
+
+    for (t_ctx1* follower : m_tree_followers) {
+        follower->step_end();
+    }
 }
 
 t_aggspec
@@ -291,9 +351,41 @@ t_ctx1::sort_by(const std::vector<t_sortspec>& sortby) {
     if (m_sortby.empty()) {
         return;
     }
+    PSP_TRACE_SPAN("ctx1.sort");
     m_traversal->sort_by(m_config, sortby, *(m_tree.get()));
 }
 
+std::vector<t_path>
+t_ctx1::get_expansion_state() const {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    return ctx_get_expansion_state(m_tree, m_traversal);
+}
+
+void
+t_ctx1::set_expansion_state(const std::vector<t_path>& paths) {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    std::vector<t_index> nodes = ctx_resolve_expansion_state(m_tree, paths);
+    if (nodes.empty()) {
+        return;
+    }
+
+    // As `open`, stop automatically expanding
+    m_depth_set = false;
+    m_depth = 0;
+
+    if (m_lazy_aggregates && m_gstate) {
+        for (t_index nidx : nodes) {
+            m_tree->materialize_children(nidx, *m_gstate, m_config);
+        }
+    }
+
+    t_index retval = m_traversal->expand_tree_nodes(
+        m_sortby, tsl::hopscotch_set<t_index>(nodes.begin(), nodes.end()));
+    m_rows_changed = (retval > 0);
+}
+
 void
 t_ctx1::set_depth(t_depth depth) {
     PSP_TRACE_SENTINEL();
@@ -301,6 +393,15 @@ t_ctx1::set_depth(t_depth depth) {
     if (m_config.get_num_rpivots() == 0)
         return;
     depth = std::min<t_depth>(m_config.get_num_rpivots() - 1, depth);
+
+    // The traversal shows the children of every node down to `depth`.
+    if (m_lazy_aggregates) {
+        if (m_gstate) {
+            m_tree->materialize(depth + 1, *m_gstate, m_config);
+        }
+        m_tree->set_lazy_depth(depth + 1);
+    }
+
     t_index retval = 0;
     retval = m_traversal->set_depth(m_sortby, depth);
     m_rows_changed = (retval > 0);
@@ -379,19 +480,31 @@ t_ctx1::set_feature_state(t_ctx_feature feature, bool state) {
 void
 t_ctx1::set_alerts_enabled(bool enabled_state) {
     m_features[CTX_FEAT_ALERT] = enabled_state;
-    m_tree->set_alerts_enabled(enabled_state);
+    if (is_tree_shared()) {
+        update_tree_features();
+    } else {
+        m_tree->set_alerts_enabled(enabled_state);
+    }
 }
 
 void
 t_ctx1::set_deltas_enabled(bool enabled_state) {
     m_features[CTX_FEAT_DELTA] = enabled_state;
-    m_tree->set_deltas_enabled(enabled_state);
+    if (is_tree_shared()) {
+        update_tree_features();
+    } else {
+        m_tree->set_deltas_enabled(enabled_state);
+    }
 }
 
 void
 t_ctx1::set_minmax_enabled(bool enabled_state) {
     m_features[CTX_FEAT_MINMAX] = enabled_state;
-    m_tree->set_minmax_enabled(enabled_state);
+    if (is_tree_shared()) {
+        update_tree_features();
+    } else {
+        m_tree->set_minmax_enabled(enabled_state);
+    }
 }
 
 std::vector<t_minmax>
@@ -416,7 +529,7 @@ t_ctx1::get_step_delta(t_index bidx, t_index eidx) {
     eidx = std::min(eidx, t_index(m_traversal->size()));
 
     t_stepdelta rval(m_rows_changed, m_columns_changed, get_cell_delta(bidx, eidx));
-    m_tree->clear_deltas();
+    clear_deltas();
     return rval;
 }
 
@@ -434,7 +547,7 @@ t_ctx1::get_row_delta() {
     std::vector<t_uindex> rows = get_rows_changed();
     std::vector<t_tscalar> data = get_data(rows);
     t_rowdelta rval(m_rows_changed, rows.size(), data);
-    m_tree->clear_deltas();
+    clear_deltas();
     return rval;
 }
 
@@ -442,18 +555,36 @@ std::vector<t_uindex>
 t_ctx1::get_rows_changed() {
     std::vector<t_uindex> rows;
     const auto& deltas = m_tree->get_deltas();
-    t_uindex eidx = t_uindex(m_traversal->size());
+    if (deltas->empty()) {
+        return rows;
+    }
 
-    for (t_uindex idx = 0; idx < eidx; ++idx) {
-        t_index ptidx = m_traversal->get_tree_index(idx);
-        // Retrieve delta from storage and check if the row has been changed
-        auto iterators = deltas->get<by_tc_nidx_aggidx>().equal_range(ptidx);
-        bool unique_ridx = std::find(rows.begin(), rows.end(), idx) == rows.end();
-        if ((iterators.first != iterators.second) && unique_ridx)
+    // The tree nodes changed in a column of the viewport since the deltas
+    // were last read, whichever steps changed them; deltas are ordered by
+    // node, so the last has the highest.
+    t_mask changed(deltas->back().m_nidx + 1);
+    for (const auto& delta : *deltas) {
+        if (m_viewport.contains_column(delta.m_aggidx + 1)) {
+            changed.set(delta.m_nidx);
+        }
+    }
+
+    if (changed.count() == 0) {
+        return rows;
+    }
+
+    // Rows are visited in traversal order, so they are read out in order
+    // and each once.
+    t_index bidx = 0;
+    t_index eidx = t_index(m_traversal->size());
+    m_viewport.clip_rows(bidx, eidx);
+    for (t_index idx = bidx; idx < eidx; ++idx) {
+        t_uindex ptidx = m_traversal->get_tree_index(idx);
+        if (ptidx < changed.size() && changed.get(ptidx)) {
             rows.push_back(idx);
+        }
     }
 
-    std::sort(rows.begin(), rows.end());
     return rows;
 }
 
@@ -462,12 +593,16 @@ t_ctx1::get_cell_delta(t_index bidx, t_index eidx) const {
     PSP_TRACE_SENTINEL();
     PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
     eidx = std::min(eidx, t_index(m_traversal->size()));
+    m_viewport.clip_rows(bidx, eidx);
     std::vector<t_cellupd> rval;
     const auto& deltas = m_tree->get_deltas();
     for (t_index idx = bidx; idx < eidx; ++idx) {
         t_index ptidx = m_traversal->get_tree_index(idx);
-        auto iterators = deltas->get<by_tc_nidx_aggidx>().equal_range(ptidx);
+        auto iterators = deltas->equal_range(ptidx);
         for (auto iter = iterators.first; iter != iterators.second; ++iter) {
+            if (!m_viewport.contains_column(iter->m_aggidx + 1)) {
+                continue;
+            }
             rval.push_back(
                 t_cellupd(idx, iter->m_aggidx + 1, iter->m_old_value, iter->m_new_value));
         }
@@ -477,11 +612,32 @@ t_ctx1::get_cell_delta(t_index bidx, t_index eidx) const {
 
 void
 t_ctx1::reset() {
+    // Keep the data version increasing across the new traversal's.
+    m_data_version += m_traversal->get_version() + 1;
+
+    // a follower reads its leader's tree, whether or not that is reset
+    if (m_tree_leader) {
+        share_tree(m_tree_leader);
+        return;
+    }
+
     auto pivots = m_config.get_row_pivots();
     m_tree = std::make_shared<t_stree>(pivots, m_config.get_aggregates(), m_schema, m_config);
     m_tree->init();
     m_tree->set_deltas_enabled(get_feature_state(CTX_FEAT_DELTA));
+    if (m_lazy_aggregates) {
+        m_tree->set_lazy_depth(1);
+    }
     m_traversal = std::shared_ptr<t_traversal>(new t_traversal(m_tree));
+
+    for (t_ctx1* follower : m_tree_followers) {
+        follower->share_tree(this);
+    }
+}
+
+t_uindex
+t_ctx1::get_data_version() const {
+    return m_data_version + m_traversal->get_version();
 }
 
 void
@@ -514,6 +670,11 @@ t_ctx1::has_deltas() const {
     return m_tree->has_deltas();
 }
 
+std::set<std::string>
+t_ctx1::get_transitional_columns() const {
+    return get_tree_transitional_columns(m_config);
+}
+
 t_minmax
 t_ctx1::get_agg_min_max(t_uindex aggidx, t_depth depth) const {
     PSP_TRACE_SENTINEL();
@@ -525,8 +686,12 @@ void
 t_ctx1::notify(const t_data_table& flattened) {
     PSP_TRACE_SENTINEL();
     PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
-    notify_sparse_tree(m_tree, m_traversal, true, m_config.get_aggregates(),
-        m_config.get_sortby_pairs(), m_sortby, flattened, m_config, *m_gstate);
+    if (m_tree_leader) {
+        return;
+    }
+
+    notify_sparse_tree(m_tree, get_tree_traversals(), m_config.get_aggregates(),
+        m_config.get_sortby_pairs(), flattened, m_config, *m_gstate);
 }
 
 void
@@ -593,6 +758,158 @@ t_ctx1::get_trav_depth(t_index idx) const {
     return m_traversal->get_depth(idx);
 }
 
+void
+t_ctx1::set_lazy_aggregates(bool enabled) {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    if (is_tree_shared()) {
+        return;
+    }
+
+    m_lazy_aggregates = enabled;
+
+    // Keep every node which is visible now up to date.
+    t_depth depth = t_stree::LAZY_DEPTH_NONE;
+    if (enabled) {
+        depth = 0;
+        for (t_uindex idx = 0, loop_end = m_traversal->size(); idx < loop_end; ++idx) {
+            depth = std::max(depth, m_traversal->get_depth(idx));
+        }
+    }
+
+    if (m_gstate) {
+        m_tree->materialize(depth, *m_gstate, m_config);
+    }
+    m_tree->set_lazy_depth(depth);
+}
+
+bool
+t_ctx1::get_lazy_aggregates() const {
+    return m_lazy_aggregates;
+}
+
+void
+t_ctx1::reclaim() {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    if (is_tree_shared() || is_tree_follower()) {
+        return;
+    }
+
+    // Every child of an expanded node is visible, so is aggregated already.
+    std::set<t_uindex> open;
+    for (t_index idx = 0, loop_end = m_traversal->size(); idx < loop_end; ++idx) {
+        if (m_traversal->get_node_expanded(idx)) {
+            open.insert(m_traversal->get_tree_index(idx));
+        }
+    }
+
+    m_lazy_aggregates = true;
+    m_tree->reclaim(m_depth_set ? m_depth + 1 : 1, open);
+}
+
+bool
+t_ctx1::can_share_tree() const {
+    return !m_lazy_aggregates && !t_env::disable_shared_trees();
+}
+
+void
+t_ctx1::share_tree(t_ctx1* leader) {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    PSP_VERBOSE_ASSERT(
+        leader != this && leader->m_tree_leader == nullptr, "Cannot share a follower's tree");
+
+    if (m_tree_leader != leader) {
+        leave_tree_group();
+        m_tree_leader = leader;
+        leader->m_tree_followers.push_back(this);
+    }
+
+    m_tree = leader->m_tree;
+    m_data_version += m_traversal->get_version() + 1;
+    m_traversal = std::shared_ptr<t_traversal>(new t_traversal(m_tree));
+    m_minmax = m_tree->get_min_max();
+    update_tree_features();
+    sort_by(m_sortby);
+    if (m_depth_set) {
+        set_depth(m_depth);
+    }
+}
+
+void
+t_ctx1::leave_tree_group() {
+    if (m_tree_leader) {
+        auto& followers = m_tree_leader->m_tree_followers;
+        followers.erase(std::remove(followers.begin(), followers.end(), this), followers.end());
+        m_tree_leader = nullptr;
+        return;
+    }
+
+    if (m_tree_followers.empty()) {
+        return;
+    }
+
+    t_ctx1* leader = m_tree_followers.front();
+    leader->m_tree_leader = nullptr;
+    leader->m_tree_followers.assign(m_tree_followers.begin() + 1, m_tree_followers.end());
+    for (t_ctx1* follower : leader->m_tree_followers) {
+        follower->m_tree_leader = leader;
+    }
+
+    m_tree_followers.clear();
+}
+
+std::shared_ptr<t_stree>
+t_ctx1::get_tree() const {
+    return m_tree;
+}
+
+t_ctx1*
+t_ctx1::get_tree_leader() const {
+    return m_tree_leader;
+}
+
+bool
+t_ctx1::is_tree_follower() const {
+    return m_tree_leader != nullptr;
+}
+
+bool
+t_ctx1::is_tree_shared() const {
+    return m_tree_leader != nullptr || !m_tree_followers.empty();
+}
+
+// A shared tree keeps each feature which any context reading it enables.
+void
+t_ctx1::update_tree_features() {
+    const t_ctx1* leader = m_tree_leader ? m_tree_leader : this;
+    bool alerts = leader->get_feature_state(CTX_FEAT_ALERT);
+    bool deltas = leader->get_feature_state(CTX_FEAT_DELTA);
+    bool minmax = leader->get_feature_state(CTX_FEAT_MINMAX);
+
+    for (const t_ctx1* follower : leader->m_tree_followers) {
+        alerts = alerts || follower->get_feature_state(CTX_FEAT_ALERT);
+        deltas = deltas || follower->get_feature_state(CTX_FEAT_DELTA);
+        minmax = minmax || follower->get_feature_state(CTX_FEAT_MINMAX);
+    }
+
+    m_tree->set_alerts_enabled(alerts);
+    m_tree->set_deltas_enabled(deltas);
+    m_tree->set_minmax_enabled(minmax);
+}
+
+std::vector<t_tree_traversal>
+t_ctx1::get_tree_traversals() {
+    std::vector<t_tree_traversal> rval;
+    rval.reserve(m_tree_followers.size() + 1);
+    rval.push_back(t_tree_traversal{m_traversal, &m_sortby});
+    for (t_ctx1* follower : m_tree_followers) {
+        rval.push_back(t_tree_traversal{follower->m_traversal, &follower->m_sortby});
+    }
+    return rval;
+}
+
 std::vector<t_tscalar>
 t_ctx1::unity_get_row_data(t_uindex idx) const {
     auto rval = get_data(idx, idx + 1, 0, get_column_count());
@@ -613,6 +930,11 @@ t_ctx1::unity_get_row_path(t_uindex idx) const {
     return get_row_path(idx);
 }
 
+t_row_paths
+t_ctx1::unity_get_row_paths(t_uindex start_row, t_uindex end_row) const {
+    return ctx_get_paths(m_tree, m_traversal, start_row, end_row);
+}
+
 std::vector<t_tscalar>
 t_ctx1::unity_get_column_path(t_uindex idx) const {
     return std::vector<t_tscalar>();
@@ -680,7 +1002,10 @@ t_ctx1::unity_get_column_expanded(t_uindex idx) const {
 
 void
 t_ctx1::clear_deltas() {
-    m_tree->clear_deltas();
+    m_deltas_pending = false;
+    if (!is_tree_shared()) {
+        m_tree->clear_deltas();
+    }
 }
 
 void
@@ -700,7 +1025,8 @@ t_ctx1::get_table() const {
 
     std::stringstream ss;
     for (const auto& c : pivots) {
-        pivcols.push_back(tbl->add_column(c.colname(), m_schema.get_dtype(c.colname()), true));
+        pivcols.push_back(
+            tbl->add_column(c.name(), c.get_dtype(m_schema.get_dtype(c.colname())), true));
     }
 
     auto idx = 0;
@@ -0,0 +1,354 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#include <perspective/first.h>
+#include <perspective/context_totals.h>
+#include <perspective/filter_utils.h>
+#include <perspective/mask.h>
+#include <cmath>
+#include <limits>
+#include <set>
+
+namespace perspective {
+
+namespace {
+    bool
+    is_integral_dtype(t_dtype dtype) {
+        switch (dtype) {
+            case DTYPE_INT64:
+            case DTYPE_INT32:
+            case DTYPE_INT16:
+            case DTYPE_INT8:
+            case DTYPE_UINT64:
+            case DTYPE_UINT32:
+            case DTYPE_UINT16:
+            case DTYPE_UINT8:
+            case DTYPE_BOOL: {
+                return true;
+            }
+            default:
+                return false;
+        }
+    }
+
+    // Aggregates in the units of their column, which are divided by its
+    // scale, as `View::get_aggregate_scale`.
+    bool
+    is_in_column_units(t_aggtype agg) {
+        switch (agg) {
+            case AGGTYPE_SUM:
+            case AGGTYPE_MEAN:
+            case AGGTYPE_WEIGHTED_MEAN:
+            case AGGTYPE_UNIQUE:
+            case AGGTYPE_MEDIAN:
+            case AGGTYPE_MIN:
+            case AGGTYPE_MAX:
+            case AGGTYPE_DOMINANT:
+            case AGGTYPE_HIGH_WATER_MARK:
+            case AGGTYPE_LOW_WATER_MARK: {
+                return true;
+            }
+            default:
+                return false;
+        }
+    }
+} // namespace
+
+t_ctx_totals::t_total::t_total()
+    : m_dtype(DTYPE_NONE)
+    , m_scale(0)
+    , m_count(0)
+    , m_isum(0)
+    , m_sum(0)
+    , m_weights(0)
+    , m_nvalues(0)
+    , m_nans(0)
+    , m_bound(mknone()) {}
+
+t_ctx_totals::t_ctx_totals(const t_schema& schema, const std::vector<t_aggspec>& aggspecs,
+    const std::vector<t_fterm>& fterms, t_filter_op combiner,
+    const std::map<std::string, std::int32_t>& scales)
+    : m_config(std::vector<std::string>(), fterms, combiner,
+        std::vector<t_computed_column_definition>()) {
+    for (const t_aggspec& aggspec : aggspecs) {
+        switch (aggspec.agg()) {
+            case AGGTYPE_SUM:
+            case AGGTYPE_COUNT:
+            case AGGTYPE_MEAN:
+            case AGGTYPE_WEIGHTED_MEAN:
+            case AGGTYPE_HIGH_WATER_MARK:
+            case AGGTYPE_LOW_WATER_MARK:
+            case AGGTYPE_MEDIAN:
+            case AGGTYPE_MIN:
+            case AGGTYPE_MAX:
+            case AGGTYPE_DISTINCT_COUNT:
+            case AGGTYPE_UNIQUE:
+            case AGGTYPE_DOMINANT: {
+            } break;
+            default: {
+                PSP_COMPLAIN_AND_ABORT("Aggregate `" + aggspec.agg_str() + "` of `"
+                    + aggspec.name() + "` is not supported by totals");
+            }
+        }
+
+        std::unique_ptr<t_total> total(new t_total());
+        total->m_spec = aggspec;
+        total->m_dtype = schema.get_dtype(aggspec.get_first_depname());
+        auto scale = scales.find(aggspec.get_first_depname());
+        if (scale != scales.end() && is_in_column_units(aggspec.agg())) {
+            total->m_scale = scale->second;
+        }
+        m_totals.push_back(std::move(total));
+    }
+}
+
+void
+t_ctx_totals::set_filter_expr(const t_fexpr& fexpr) {
+    m_config.set_filter_expr(fexpr);
+}
+
+void
+t_ctx_totals::reset() {
+    for (auto& total : m_totals) {
+        total->m_count = 0;
+        total->m_isum = 0;
+        total->m_sum = 0;
+        total->m_weights = 0;
+        total->m_nvalues = 0;
+        total->m_nans = 0;
+        total->m_bound = mknone();
+        total->m_values.clear();
+    }
+}
+
+void
+t_ctx_totals::update_from_state(const t_data_table& tbl) {
+    t_uindex nrows = tbl.size();
+    if (nrows == 0) {
+        return;
+    }
+
+    t_mask msk = m_config.has_filters() ? filter_table_for_config(tbl, m_config) : t_mask();
+    const t_column* op_col
+        = tbl.get_schema().has_column("psp_op") ? tbl.get_const_column("psp_op").get() : nullptr;
+    for (t_uindex idx = 0; idx < nrows; ++idx) {
+        if (op_col && *(op_col->get_nth<std::uint8_t>(idx)) == OP_DELETE) {
+            continue;
+        }
+
+        if (m_config.has_filters() && !msk.get(idx)) {
+            continue;
+        }
+
+        apply(tbl, nullptr, idx, 1);
+    }
+}
+
+void
+t_ctx_totals::notify(const t_data_table& flattened, const t_data_table& prev,
+    const t_data_table& current, const t_data_table& transitions,
+    const t_data_table& existed) {
+    t_uindex nrows = flattened.size();
+    const t_column* op_col = flattened.get_const_column("psp_op").get();
+    const t_column* existed_col = existed.get_const_column("psp_existed").get();
+
+    bool has_filters = m_config.has_filters();
+    t_mask msk_curr;
+    t_mask msk_prev;
+    if (has_filters) {
+        msk_curr = filter_table_for_config(current, m_config);
+        msk_prev = filter_columns_changed(transitions, m_config)
+            ? filter_table_for_config(prev, m_config)
+            : msk_curr;
+    }
+
+    for (t_uindex idx = 0; idx < nrows; ++idx) {
+        bool is_delete = *(op_col->get_nth<std::uint8_t>(idx)) == OP_DELETE;
+        bool was_counted = *(existed_col->get_nth<bool>(idx)) && (!has_filters || msk_prev.get(idx));
+        bool is_counted = !is_delete && (!has_filters || msk_curr.get(idx));
+
+        if (was_counted) {
+            apply(prev, nullptr, idx, -1);
+        }
+
+        if (is_counted) {
+            apply(current, &flattened, idx, 1);
+        }
+    }
+}
+
+void
+t_ctx_totals::apply(const t_data_table& tbl, const t_data_table* flattened, t_uindex idx,
+    std::int64_t sign) {
+    for (auto& total_ptr : m_totals) {
+        t_total& total = *total_ptr;
+        const std::vector<t_dep>& deps = total.m_spec.get_dependencies();
+        const std::string& name = deps[0].name();
+        total.m_count += sign;
+
+        const t_column* col = tbl.get_const_column(name).get();
+        bool cleared = flattened && flattened->get_const_column(name)->is_cleared(idx);
+        if (cleared || !col->is_valid(idx)) {
+            continue;
+        }
+
+        t_tscalar value = col->get_scalar(idx);
+        switch (total.m_spec.agg()) {
+            case AGGTYPE_COUNT: {
+            } break;
+            case AGGTYPE_SUM:
+            case AGGTYPE_MEAN: {
+                if (value.is_nan()) {
+                    total.m_nans += sign;
+                } else if (is_integral_dtype(total.m_dtype)) {
+                    total.m_isum += sign * value.to_int64();
+                    total.m_sum += sign * value.to_double();
+                    total.m_nvalues += sign;
+                } else {
+                    total.m_sum += sign * value.to_double();
+                    total.m_nvalues += sign;
+                }
+            } break;
+            case AGGTYPE_WEIGHTED_MEAN: {
+                const t_column* wcol = tbl.get_const_column(deps[1].name()).get();
+                bool wcleared
+                    = flattened && flattened->get_const_column(deps[1].name())->is_cleared(idx);
+                if (wcleared || !wcol->is_valid(idx) || value.is_nan()) {
+                    continue;
+                }
+
+                t_tscalar weight = wcol->get_scalar(idx);
+                if (weight.is_nan()) {
+                    continue;
+                }
+
+                total.m_sum += sign * weight.to_double() * value.to_double();
+                total.m_weights += sign * weight.to_double();
+            } break;
+            case AGGTYPE_HIGH_WATER_MARK: {
+                if (sign > 0 && (!total.m_bound.is_valid() || total.m_bound < value)) {
+                    total.m_bound = m_symtable.get_interned_tscalar(value);
+                }
+            } break;
+            case AGGTYPE_LOW_WATER_MARK: {
+                if (sign > 0 && (!total.m_bound.is_valid() || value < total.m_bound)) {
+                    total.m_bound = m_symtable.get_interned_tscalar(value);
+                }
+            } break;
+            default: {
+                // The multiset aggregates.
+                t_tscalar interned = m_symtable.get_interned_tscalar(value);
+                if (sign > 0) {
+                    total.m_values.insert(interned);
+                } else {
+                    total.m_values.erase(interned);
+                }
+            } break;
+        }
+    }
+}
+
+t_tscalar
+t_ctx_totals::get_value(const t_total& total) const {
+    t_tscalar rval = mknone();
+    switch (total.m_spec.agg()) {
+        case AGGTYPE_COUNT: {
+            rval.set(total.m_count);
+        } break;
+        case AGGTYPE_SUM: {
+            if (total.m_nans > 0) {
+                rval.set(std::numeric_limits<double>::quiet_NaN());
+            } else if (is_integral_dtype(total.m_dtype)) {
+                rval.set(total.m_isum);
+            } else {
+                rval.set(total.m_sum);
+            }
+        } break;
+        case AGGTYPE_MEAN: {
+            if (total.m_nvalues > 0) {
+                rval.set(total.m_sum / total.m_nvalues);
+            }
+        } break;
+        case AGGTYPE_WEIGHTED_MEAN: {
+            if (total.m_weights != 0) {
+                rval.set(total.m_sum / total.m_weights);
+            }
+        } break;
+        case AGGTYPE_HIGH_WATER_MARK:
+        case AGGTYPE_LOW_WATER_MARK: {
+            rval = total.m_bound;
+        } break;
+        case AGGTYPE_MEDIAN: {
+            rval = total.m_values.median();
+        } break;
+        case AGGTYPE_MIN: {
+            rval = total.m_values.min();
+        } break;
+        case AGGTYPE_MAX: {
+            rval = total.m_values.max();
+        } break;
+        case AGGTYPE_DISTINCT_COUNT: {
+            rval.set(static_cast<std::uint32_t>(total.m_values.distinct_size()));
+        } break;
+        case AGGTYPE_UNIQUE: {
+            t_tscalar value;
+            if (total.m_values.unique(value)) {
+                rval = value;
+            }
+        } break;
+        case AGGTYPE_DOMINANT: {
+            rval = total.m_values.dominant();
+        } break;
+        default: { PSP_COMPLAIN_AND_ABORT("Unexpected aggregate"); }
+    }
+
+    if (total.m_scale > 0 && rval.is_valid() && rval.is_numeric()) {
+        rval.set(rval.to_double() / std::pow(10.0, total.m_scale));
+    }
+
+    return rval;
+}
+
+std::vector<std::string>
+t_ctx_totals::get_column_names() const {
+    std::vector<std::string> rval;
+    rval.reserve(m_totals.size());
+    for (const auto& total : m_totals) {
+        rval.push_back(total->m_spec.name());
+    }
+    return rval;
+}
+
+std::vector<t_tscalar>
+t_ctx_totals::get_values() const {
+    std::vector<t_tscalar> rval;
+    rval.reserve(m_totals.size());
+    for (const auto& total : m_totals) {
+        rval.push_back(get_value(*total));
+    }
+    return rval;
+}
+
+std::vector<std::string>
+t_ctx_totals::get_referenced_columns() const {
+    std::set<std::string> referenced;
+    for (const auto& total : m_totals) {
+        for (const t_dep& dep : total->m_spec.get_dependencies()) {
+            referenced.insert(dep.name());
+        }
+    }
+
+    for (const std::string& name : m_config.get_filter_columns()) {
+        referenced.insert(name);
+    }
+
+    return std::vector<std::string>(referenced.begin(), referenced.end());
+}
+
+} // end namespace perspective
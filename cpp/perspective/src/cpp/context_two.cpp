@@ -15,6 +15,8 @@
 #include <perspective/tree_context_common.h>
 #include <perspective/logtime.h>
 #include <perspective/traversal.h>
+#include <perspective/env_vars.h>
+#include <tsl/hopscotch_map.h>
 
 namespace perspective {
 
@@ -22,14 +24,20 @@ t_ctx2::t_ctx2()
     : m_row_depth(0)
     , m_row_depth_set(false)
     , m_column_depth(0)
-    , m_column_depth_set(false) {}
+    , m_column_depth_set(false)
+    , m_lazy_aggregates(t_env::lazy_aggregates())
+    , m_column_cache_valid(false)
+    , m_column_cache_version(0) {}
 
 t_ctx2::t_ctx2(const t_schema& schema, const t_config& pivot_config)
     : t_ctxbase<t_ctx2>(schema, pivot_config)
     , m_row_depth(0)
     , m_row_depth_set(false)
     , m_column_depth(0)
-    , m_column_depth_set(false) {}
+    , m_column_depth_set(false)
+    , m_lazy_aggregates(t_env::lazy_aggregates())
+    , m_column_cache_valid(false)
+    , m_column_cache_version(0) {}
 
 t_ctx2::~t_ctx2() {}
 
@@ -45,42 +53,82 @@ t_ctx2::repr() const {
     return ss.str();
 }
 
+std::map<std::string, t_uindex>
+t_ctx2::get_memory_usage() const {
+    std::map<std::string, t_uindex> rv;
+    rv["row_traversal"] = m_rtraversal->nbytes();
+    rv["column_traversal"] = m_ctraversal->nbytes();
+    rv["tree"] = 0;
+    rv["aggregates"] = 0;
+    for (const auto& tree : m_trees) {
+        rv["tree"] += tree->nbytes();
+        auto aggtable = tree->get_aggtable();
+        rv["aggregates"] += aggtable->nbytes() + aggtable->vocab_nbytes();
+    }
+    return rv;
+}
+
+std::shared_ptr<t_stree>
+t_ctx2::make_tree(t_uindex treeidx) const {
+    std::vector<t_pivot> pivots;
+    if (treeidx > 0) {
+        pivots.insert(pivots.end(), m_config.get_row_pivots().begin(),
+            m_config.get_row_pivots().begin() + treeidx);
+    }
+
+    pivots.insert(pivots.end(), m_config.get_column_pivots().begin(),
+        m_config.get_column_pivots().end());
+
+    auto tree = std::make_shared<t_stree>(pivots, m_config.get_aggregates(), m_schema, m_config);
+    tree->init();
+    return tree;
+}
+
 void
 t_ctx2::init() {
     m_trees = std::vector<std::shared_ptr<t_stree>>(get_num_trees());
 
     for (t_uindex treeidx = 0, tree_loop_end = m_trees.size(); treeidx < tree_loop_end;
          ++treeidx) {
-        std::vector<t_pivot> pivots;
-        if (treeidx > 0) {
-            pivots.insert(pivots.end(), m_config.get_row_pivots().begin(),
-                m_config.get_row_pivots().begin() + treeidx);
-        }
-
-        pivots.insert(pivots.end(), m_config.get_column_pivots().begin(),
-            m_config.get_column_pivots().end());
-
-        m_trees[treeidx]
-            = std::make_shared<t_stree>(pivots, m_config.get_aggregates(), m_schema, m_config);
+        m_trees[treeidx] = make_tree(treeidx);
+    }
 
-        m_trees[treeidx]->init();
+    m_stale_trees = std::vector<bool>(m_trees.size(), false);
+    if (m_lazy_aggregates) {
+        set_lazy_row_depth(1);
     }
 
     m_rtraversal = std::make_shared<t_traversal>(rtree());
 
     m_ctraversal = std::make_shared<t_traversal>(ctree());
+    m_column_cache_valid = false;
     m_minmax = std::vector<t_minmax>(m_config.get_num_aggregates());
     m_init = true;
 }
 
 void
 t_ctx2::step_begin() {
-    reset_step_state();
+    if (begin_step_deltas()) {
+        reset_step_state();
+    }
+    m_step_row_count = get_row_count();
+    for (const auto& tree : m_trees) {
+        tree->clear_updated();
+    }
 }
 
 void
 t_ctx2::step_end() {
     m_minmax = m_trees.back()->get_min_max();
+
+    // Changes to the traversals are counted by their own versions.
+    for (const auto& tree : m_trees) {
+        if (!tree->get_updated().empty()) {
+            ++m_data_version;
+            break;
+        }
+    }
+
     if (m_row_depth_set) {
         set_depth(HEADER_ROW, m_row_depth);
     }
@@ -108,6 +156,9 @@ t_ctx2::open(t_header header, t_index idx) {
             return 0;
         m_row_depth_set = false;
         m_row_depth = 0;
+        if (m_lazy_aggregates) {
+            materialize_tree(m_rtraversal->get_depth(idx) + 1);
+        }
         if (m_sortby.empty()) {
             retval = m_rtraversal->expand_node(idx);
         } else {
@@ -162,34 +213,47 @@ t_ctx2::get_totals() const {
 
 std::vector<t_index>
 t_ctx2::get_ctraversal_indices() const {
+    return get_column_cache();
+}
+
+const std::vector<t_index>&
+t_ctx2::get_column_cache() const {
+    if (m_column_cache_valid && m_column_cache_version == m_ctraversal->get_version()) {
+        return m_ctraversal_indices;
+    }
+
+    m_ctraversal_indices.clear();
     switch (m_config.get_totals()) {
         case TOTALS_BEFORE: {
             t_index nelems = m_ctraversal->size();
             PSP_VERBOSE_ASSERT(nelems > 0, "nelems is <= 0");
-            std::vector<t_index> rval(nelems);
+            m_ctraversal_indices.resize(nelems);
             for (t_index cidx = 0; cidx < nelems; ++cidx) {
-                rval[cidx] = cidx;
+                m_ctraversal_indices[cidx] = cidx;
             }
-            return rval;
         } break;
         case TOTALS_AFTER: {
-            std::vector<t_index> col_order;
-            m_ctraversal->post_order(0, col_order);
-            return col_order;
+            m_ctraversal->post_order(0, m_ctraversal_indices);
         } break;
         case TOTALS_HIDDEN: {
             std::vector<t_index> leaves;
             m_ctraversal->get_leaves(leaves);
-            std::vector<t_index> rval(leaves.size() + 1);
-            rval[0] = 0;
-            for (t_uindex idx = 1, loop_end = rval.size(); idx < loop_end; ++idx) {
-                rval[idx] = leaves[idx - 1];
+            m_ctraversal_indices.resize(leaves.size() + 1);
+            m_ctraversal_indices[0] = 0;
+            for (t_uindex idx = 1, loop_end = m_ctraversal_indices.size(); idx < loop_end;
+                 ++idx) {
+                m_ctraversal_indices[idx] = leaves[idx - 1];
             }
-            return rval;
         } break;
         default: { PSP_COMPLAIN_AND_ABORT("Unknown total type"); }
     }
-    return std::vector<t_index>();
+
+    m_column_paths.clear();
+    m_column_paths.resize(m_ctraversal_indices.size());
+    m_column_path_cached.assign(m_ctraversal_indices.size(), false);
+    m_column_cache_version = m_ctraversal->get_version();
+    m_column_cache_valid = true;
+    return m_ctraversal_indices;
 }
 
 std::vector<t_tscalar>
@@ -352,6 +416,7 @@ t_ctx2::sort_by(const std::vector<t_sortspec>& sortby) {
     if (m_sortby.empty()) {
         return;
     }
+    PSP_TRACE_SPAN("ctx2.sort");
     m_rtraversal->sort_by(m_config, sortby, *(rtree().get()), this);
 }
 
@@ -376,7 +441,7 @@ t_ctx2::notify(const t_data_table& flattened, const t_data_table& delta,
             notify_sparse_tree(ctree(), m_ctraversal, true, m_config.get_aggregates(),
                 m_config.get_sortby_pairs(), m_column_sortby, flattened, delta, prev, current,
                 transitions, existed, m_config, *m_gstate);
-        } else {
+        } else if (!m_stale_trees[tree_idx]) {
             notify_sparse_tree(m_trees[tree_idx], std::shared_ptr<t_traversal>(0), false,
                 m_config.get_aggregates(), m_config.get_sortby_pairs(),
                 std::vector<t_sortspec>(), flattened, delta, prev, current, transitions,
@@ -415,18 +480,22 @@ t_ctx2::resolve_cells(const std::vector<std::pair<t_uindex, t_uindex>>& cells) c
 
     t_index n_aggs = m_config.get_num_aggregates();
     std::vector<t_index> c_tvindices = get_ctraversal_indices();
-
-    std::vector<std::vector<t_tscalar>> col_paths(m_ctraversal->size());
-
-    for (t_index cidx = 0, loop_end = c_tvindices.size(); cidx < loop_end; ++cidx) {
-        auto translated = c_tvindices[cidx];
-        const t_tvnode& c_tvnode = m_ctraversal->get_node(translated);
-        col_paths[cidx].reserve(m_config.get_num_cpivots());
-        col_paths[cidx] = get_column_path(c_tvnode);
-    }
+    std::shared_ptr<const t_stree> c_tree = ctree();
 
     t_uindex ncols = get_num_view_columns();
 
+    // The cells of a row are resolved from the node of its row path in the
+    // tree of its depth, one column tree level at a time, and each column
+    // node is resolved once per row, so a column path costs a single child
+    // lookup below its parent's, and nothing below an empty one. Column
+    // nodes map to their `INVALID_INDEX`-or-node in `resolved`, which holds
+    // the row of `cur_ridx` only.
+    t_index cur_ridx = INVALID_INDEX;
+    t_index row_ptidx = INVALID_INDEX;
+    t_index row_treenum = 0;
+    tsl::hopscotch_map<t_index, t_index> resolved;
+    std::vector<t_index> chain;
+
     for (t_index idx = 0, loop_end = cells.size(); idx < loop_end; ++idx) {
         const auto& cell = cells[idx];
 
@@ -439,7 +508,6 @@ t_ctx2::resolve_cells(const std::vector<std::pair<t_uindex, t_uindex>>& cells) c
 
         t_index r_ptidx = r_tvnode.m_tnid;
         t_depth r_depth = r_tvnode.m_depth;
-        std::vector<t_tscalar> r_path = get_row_path(r_tvnode);
         t_index agg_idx = (cell.second - 1) % n_aggs;
         t_uindex translated_cidx = calc_translated_colidx(n_aggs, cell.second);
         if (translated_cidx >= c_tvindices.size()) {
@@ -457,33 +525,65 @@ t_ctx2::resolve_cells(const std::vector<std::pair<t_uindex, t_uindex>>& cells) c
             continue;
         }
 
-        const t_tvnode& c_tvnode = m_ctraversal->get_node(c_tvidx);
-        t_index c_ptidx = c_tvnode.m_tnid;
-        const std::vector<t_tscalar>& c_path = col_paths[translated_cidx];
+        t_index c_ptidx = m_ctraversal->get_tree_index(c_tvidx);
 
         rval[idx].m_agg_index = agg_idx;
 
         if (cell.first == 0) {
             rval[idx].m_idx = c_ptidx;
             rval[idx].m_treenum = 0;
-        } else if (c_path.size() == 0) {
+            continue;
+        } else if (c_ptidx == 0) {
             rval[idx].m_idx = r_ptidx;
             rval[idx].m_treenum = m_trees.size() - 1;
-        } else {
-            t_index tree_idx = r_depth;
-            rval[idx].m_treenum = tree_idx;
+            continue;
+        }
+
+        if (t_index(cell.first) != cur_ridx) {
+            cur_ridx = cell.first;
+            row_treenum = r_depth;
+            resolved.clear();
 
             if (r_depth + 1 == static_cast<t_depth>(m_trees.size())) {
-                rval[idx].m_idx = m_trees[tree_idx]->resolve_path(r_ptidx, c_path);
+                row_ptidx = r_ptidx;
             } else {
-                t_index path_ptidx = m_trees[tree_idx]->resolve_path(0, r_path);
-                if (path_ptidx < 0) {
-                    rval[idx].m_idx = INVALID_INDEX;
-                } else {
-                    rval[idx].m_idx = m_trees[tree_idx]->resolve_path(path_ptidx, c_path);
-                }
+                std::vector<t_tscalar> r_path = get_row_path(r_tvnode);
+                row_ptidx = m_trees[row_treenum]->resolve_path(0, r_path);
             }
         }
+
+        rval[idx].m_treenum = row_treenum;
+
+        if (row_ptidx < 0) {
+            rval[idx].m_idx = INVALID_INDEX;
+            continue;
+        }
+
+        // Walk up to the nearest column node already resolved for this row,
+        // then resolve the nodes below it.
+        chain.clear();
+        t_index node = c_ptidx;
+        t_index target = row_ptidx;
+        while (node != 0) {
+            auto iter = resolved.find(node);
+            if (iter != resolved.end()) {
+                target = iter->second;
+                break;
+            }
+            chain.push_back(node);
+            node = c_tree->get_parent_idx(node);
+        }
+
+        const auto& tree = m_trees[row_treenum];
+        for (auto iter = chain.rbegin(); iter != chain.rend(); ++iter) {
+            if (target != INVALID_INDEX) {
+                target = static_cast<t_index>(
+                    tree->resolve_child(target, c_tree->get_value(*iter)));
+            }
+            resolved[*iter] = target;
+        }
+
+        rval[idx].m_idx = target;
     }
 
     return rval;
@@ -558,6 +658,13 @@ t_ctx2::get_row_path(const t_tvnode& node) const {
     return rval;
 }
 
+std::vector<t_tscalar>
+t_ctx2::get_row_pkeys(t_index idx) const {
+    if (idx < 0 || t_uindex(idx) >= m_rtraversal->size())
+        return std::vector<t_tscalar>();
+    return rtree()->get_pkeys(m_rtraversal->get_tree_index(idx));
+}
+
 std::vector<t_tscalar>
 t_ctx2::get_column_path(t_index idx) const {
     if (idx < 0)
@@ -574,35 +681,52 @@ t_ctx2::get_column_path(const t_tvnode& node) const {
 
 std::vector<t_tscalar>
 t_ctx2::get_column_path_userspace(t_index idx) const {
-    t_index translated_idx = translate_column_index(idx);
-    if (translated_idx == INVALID_INDEX) {
+    if (idx < 0) {
+        return std::vector<t_tscalar>();
+    }
+
+    const std::vector<t_index>& indices = get_column_cache();
+    t_uindex cidx = idx > 0 ? (idx - 1) / m_config.get_num_aggregates() : 0;
+    if (m_config.get_totals() == TOTALS_HIDDEN) {
+        ++cidx;
+    }
+
+    if (cidx >= indices.size()) {
         return std::vector<t_tscalar>();
     }
-    return get_column_path(translated_idx);
+
+    if (!m_column_path_cached[cidx]) {
+        m_column_paths[cidx] = get_column_path(indices[cidx]);
+        m_column_path_cached[cidx] = true;
+    }
+
+    return m_column_paths[cidx];
 }
 
 t_index
 t_ctx2::translate_column_index(t_index idx) const {
-    t_index rval = INVALID_INDEX;
+    if (idx < 0) {
+        return INVALID_INDEX;
+    }
+
+    t_uindex cidx = idx > 0 ? (idx - 1) / m_config.get_num_aggregates() : 0;
 
     switch (m_config.get_totals()) {
         case TOTALS_BEFORE: {
-            rval = (idx - 1) / m_config.get_num_aggregates();
+            return cidx;
         } break;
         case TOTALS_AFTER: {
-            std::vector<t_index> col_order;
-            m_ctraversal->post_order(0, col_order);
-            rval = col_order[(idx - 1) / m_config.get_num_aggregates()];
+            const std::vector<t_index>& indices = get_column_cache();
+            return cidx < indices.size() ? indices[cidx] : INVALID_INDEX;
         } break;
         case TOTALS_HIDDEN: {
-            std::vector<t_index> leaves;
-            m_ctraversal->get_leaves(leaves);
-            rval = leaves[(idx - 1) / m_config.get_num_aggregates()];
+            const std::vector<t_index>& indices = get_column_cache();
+            return cidx + 1 < indices.size() ? indices[cidx + 1] : INVALID_INDEX;
         } break;
         default: { PSP_COMPLAIN_AND_ABORT("Unknown totals type encountered."); }
     }
 
-    return rval;
+    return INVALID_INDEX;
 }
 
 std::vector<t_aggspec>
@@ -621,6 +745,42 @@ t_ctx2::get_aggregate_name(t_uindex idx) const {
     return s;
 }
 
+std::vector<t_path>
+t_ctx2::get_expansion_state() const {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    return ctx_get_expansion_state(rtree(), m_rtraversal);
+}
+
+void
+t_ctx2::set_expansion_state(const std::vector<t_path>& paths) {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    std::vector<t_index> nodes = ctx_resolve_expansion_state(rtree(), paths);
+    if (nodes.empty()) {
+        return;
+    }
+
+    m_row_depth_set = false;
+    m_row_depth = 0;
+
+    // Nodes are shallowest first, so each depth is materialized once.
+    if (m_lazy_aggregates) {
+        t_depth materialized = 0;
+        for (t_index nidx : nodes) {
+            t_depth depth = rtree()->get_depth(nidx) + 1;
+            if (depth > materialized) {
+                materialize_tree(depth);
+                materialized = depth;
+            }
+        }
+    }
+
+    t_index retval = m_rtraversal->expand_tree_nodes(
+        m_sortby, tsl::hopscotch_set<t_index>(nodes.begin(), nodes.end()));
+    m_rows_changed = (retval > 0);
+}
+
 void
 t_ctx2::set_depth(t_header header, t_depth depth) {
     t_depth new_depth;
@@ -630,6 +790,9 @@ t_ctx2::set_depth(t_header header, t_depth depth) {
             if (m_config.get_num_rpivots() == 0)
                 return;
             new_depth = std::min<t_depth>(m_config.get_num_rpivots() - 1, depth);
+            if (m_lazy_aggregates) {
+                set_lazy_row_depth(new_depth + 1);
+            }
             m_rtraversal->set_depth(m_sortby, new_depth);
             m_row_depth = new_depth;
             m_row_depth_set = true;
@@ -711,8 +874,14 @@ t_ctx2::get_step_delta(t_index bidx, t_index eidx) {
 
     std::vector<std::pair<t_uindex, t_uindex>> cells;
 
-    for (t_index ridx = ext.m_srow; ridx < ext.m_erow; ++ridx) {
-        for (t_uindex cidx = 1; cidx < end_col; ++cidx) {
+    t_index srow = ext.m_srow;
+    t_index erow = ext.m_erow;
+    m_viewport.clip_rows(srow, erow);
+    start_col = std::max(start_col, m_viewport.m_start_col);
+    end_col = std::min(end_col, m_viewport.m_end_col);
+
+    for (t_index ridx = srow; ridx < erow; ++ridx) {
+        for (t_uindex cidx = start_col; cidx < end_col; ++cidx) {
             cells.push_back(std::pair<t_index, t_index>(ridx, cidx));
         }
     }
@@ -725,7 +894,7 @@ t_ctx2::get_step_delta(t_index bidx, t_index eidx) {
 
         const auto& deltas = m_trees[c.m_treenum]->get_deltas();
 
-        auto iterators = deltas->get<by_tc_nidx_aggidx>().equal_range(c.m_idx);
+        auto iterators = deltas->equal_range(c.m_idx);
 
         for (auto iter = iterators.first; iter != iterators.second; ++iter) {
             updvec.push_back(
@@ -753,14 +922,17 @@ t_ctx2::get_row_delta() {
 
 std::vector<t_uindex>
 t_ctx2::get_rows_changed() {
-    t_uindex nrows = get_row_count();
-    t_uindex ncols = get_num_view_columns();
+    t_index srow = 0;
+    t_index erow = get_row_count();
+    m_viewport.clip_rows(srow, erow);
+    t_uindex scol = std::max(t_uindex(1), m_viewport.m_start_col);
+    t_uindex ecol = std::min(t_uindex(get_num_view_columns()), m_viewport.m_end_col);
     std::vector<t_uindex> rows;
     std::vector<std::pair<t_uindex, t_uindex>> cells;
 
-    // get cells and imbue with additional information
-    for (t_uindex ridx = 0; ridx < nrows; ++ridx) {
-        for (t_uindex cidx = 1; cidx < ncols; ++cidx) {
+    // get cells within the viewport and imbue with additional information
+    for (t_index ridx = srow; ridx < erow; ++ridx) {
+        for (t_uindex cidx = scol; cidx < ecol; ++cidx) {
             cells.push_back(std::pair<t_uindex, t_uindex>(ridx, cidx));
         }
     }
@@ -771,14 +943,16 @@ t_ctx2::get_rows_changed() {
         if (c.m_idx < 0)
             continue;
         const auto& deltas = m_trees[c.m_treenum]->get_deltas();
-        auto iterators = deltas->get<by_tc_nidx_aggidx>().equal_range(c.m_idx);
-        auto ridx = c.m_ridx;
-        bool unique_ridx = std::find(rows.begin(), rows.end(), ridx) == rows.end();
+        auto iterators = deltas->equal_range(c.m_idx);
+        t_uindex ridx = c.m_ridx;
+
+        // Cells are resolved row by row, in order, so a row is changed
+        // already if it is the last one found.
+        bool unique_ridx = rows.empty() || rows.back() != ridx;
         if ((iterators.first != iterators.second) && unique_ridx)
             rows.push_back(ridx);
     }
 
-    std::sort(rows.begin(), rows.end());
     return rows;
 }
 
@@ -789,25 +963,28 @@ t_ctx2::get_min_max() const {
 
 void
 t_ctx2::reset() {
+    // Keep the data version increasing across the new traversals'.
+    m_data_version += m_rtraversal->get_version() + m_ctraversal->get_version() + 1;
+
     for (t_uindex treeidx = 0, tree_loop_end = m_trees.size(); treeidx < tree_loop_end;
          ++treeidx) {
-        std::vector<t_pivot> pivots;
-        if (treeidx > 0) {
-            pivots.insert(pivots.end(), m_config.get_row_pivots().begin(),
-                m_config.get_row_pivots().begin() + treeidx);
-        }
-
-        pivots.insert(pivots.end(), m_config.get_column_pivots().begin(),
-            m_config.get_column_pivots().end());
-
-        m_trees[treeidx]
-            = std::make_shared<t_stree>(pivots, m_config.get_aggregates(), m_schema, m_config);
-        m_trees[treeidx]->init();
+        m_trees[treeidx] = make_tree(treeidx);
         m_trees[treeidx]->set_deltas_enabled(get_feature_state(CTX_FEAT_DELTA));
     }
 
+    m_stale_trees = std::vector<bool>(m_trees.size(), false);
+    if (m_lazy_aggregates) {
+        set_lazy_row_depth(1);
+    }
+
     m_rtraversal = std::make_shared<t_traversal>(rtree());
     m_ctraversal = std::make_shared<t_traversal>(ctree());
+    m_column_cache_valid = false;
+}
+
+t_uindex
+t_ctx2::get_data_version() const {
+    return m_data_version + m_rtraversal->get_version() + m_ctraversal->get_version();
 }
 
 bool
@@ -823,6 +1000,7 @@ t_ctx2::reset_step_state() {
 
 void
 t_ctx2::clear_deltas() {
+    m_deltas_pending = false;
     for (auto& tr : m_trees) {
         tr->clear_deltas();
     }
@@ -877,6 +1055,11 @@ t_ctx2::has_deltas() const {
     return has_deltas;
 }
 
+std::set<std::string>
+t_ctx2::get_transitional_columns() const {
+    return get_tree_transitional_columns(m_config);
+}
+
 void
 t_ctx2::notify(const t_data_table& flattened) {
     for (t_uindex tree_idx = 0, loop_end = m_trees.size(); tree_idx < loop_end; ++tree_idx) {
@@ -886,7 +1069,7 @@ t_ctx2::notify(const t_data_table& flattened) {
         } else if (is_ctree_idx(tree_idx)) {
             notify_sparse_tree(ctree(), m_ctraversal, true, m_config.get_aggregates(),
                 m_config.get_sortby_pairs(), m_column_sortby, flattened, m_config, *m_gstate);
-        } else {
+        } else if (!m_stale_trees[tree_idx]) {
             notify_sparse_tree(m_trees[tree_idx], std::shared_ptr<t_traversal>(0), false,
                 m_config.get_aggregates(), m_config.get_sortby_pairs(),
                 std::vector<t_sortspec>(), flattened, m_config, *m_gstate);
@@ -897,6 +1080,81 @@ t_ctx2::notify(const t_data_table& flattened) {
     }
 }
 
+void
+t_ctx2::set_lazy_aggregates(bool enabled) {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    m_lazy_aggregates = enabled;
+
+    // Keep the tree of every row depth which is visible now up to date.
+    t_depth depth = t_stree::LAZY_DEPTH_NONE;
+    if (enabled) {
+        depth = 0;
+        for (t_index idx = 0, loop_end = m_rtraversal->size(); idx < loop_end; ++idx) {
+            depth = std::max(depth, m_rtraversal->get_depth(idx));
+        }
+    }
+
+    set_lazy_row_depth(depth);
+}
+
+bool
+t_ctx2::get_lazy_aggregates() const {
+    return m_lazy_aggregates;
+}
+
+void
+t_ctx2::reclaim() {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    set_lazy_aggregates(true);
+
+    m_column_cache_valid = false;
+    std::vector<t_index>().swap(m_ctraversal_indices);
+    std::vector<std::vector<t_tscalar>>().swap(m_column_paths);
+    std::vector<bool>().swap(m_column_path_cached);
+}
+
+// Cells of rows at depth `idx` are read from `m_trees[idx]`, which are
+// rebuilt from the gnode state when a row at that depth is first shown.
+// The row and column trees back the traversals, so are never stale.
+void
+t_ctx2::set_lazy_row_depth(t_depth depth) {
+    for (t_uindex tree_idx = 1, loop_end = m_trees.size(); tree_idx + 1 < loop_end;
+         ++tree_idx) {
+        if (tree_idx <= depth) {
+            materialize_tree(tree_idx);
+        } else if (!m_stale_trees[tree_idx]) {
+            m_trees[tree_idx] = make_tree(tree_idx);
+            m_trees[tree_idx]->set_deltas_enabled(get_feature_state(CTX_FEAT_DELTA));
+            m_stale_trees[tree_idx] = true;
+        }
+    }
+}
+
+void
+t_ctx2::materialize_tree(t_uindex tree_idx) {
+    if (tree_idx >= m_trees.size() || !m_stale_trees[tree_idx]) {
+        return;
+    }
+
+    m_stale_trees[tree_idx] = false;
+
+    if (!m_gstate) {
+        return;
+    }
+
+    auto tree = m_trees[tree_idx];
+    auto flattened = m_gstate->get_pkeyed_table();
+    notify_sparse_tree(tree, std::shared_ptr<t_traversal>(0), false, m_config.get_aggregates(),
+        m_config.get_sortby_pairs(), std::vector<t_sortspec>(), *flattened, m_config,
+        *m_gstate);
+
+    // The rebuild is not an update, so don't report it as one.
+    tree->clear_deltas();
+    tree->set_has_deltas(false);
+}
+
 void
 t_ctx2::pprint() const {}
 
@@ -930,6 +1188,11 @@ t_ctx2::unity_get_row_path(t_uindex idx) const {
     return get_row_path(idx);
 }
 
+t_row_paths
+t_ctx2::unity_get_row_paths(t_uindex start_row, t_uindex end_row) const {
+    return ctx_get_paths(rtree(), m_rtraversal, start_row, end_row);
+}
+
 std::vector<t_tscalar>
 t_ctx2::unity_get_column_path(t_uindex idx) const {
     auto rv = get_column_path_userspace(idx);
@@ -980,9 +1243,7 @@ t_uindex
 t_ctx2::unity_get_column_count() const {
     if (m_config.get_totals() != TOTALS_HIDDEN)
         return get_column_count() - 1;
-    std::vector<t_index> leaves;
-    m_ctraversal->get_leaves(leaves);
-    return leaves.size() * m_config.get_num_aggregates();
+    return (get_column_cache().size() - 1) * m_config.get_num_aggregates();
 }
 
 t_uindex
@@ -15,6 +15,8 @@
 #include <perspective/sym_table.h>
 #include <perspective/logtime.h>
 #include <perspective/filter_utils.h>
+#include <perspective/env_vars.h>
+#include <perspective/scheduler.h>
 
 namespace perspective {
 
@@ -36,15 +38,27 @@ t_ctx0::repr() const {
     return ss.str();
 }
 
+std::map<std::string, t_uindex>
+t_ctx0::get_memory_usage() const {
+    std::map<std::string, t_uindex> rv;
+    rv["traversal"] = m_traversal->nbytes();
+    rv["symbols"] = m_symtable.nbytes();
+    return rv;
+}
+
 void
 t_ctx0::step_begin() {
     if (!m_init)
         return;
 
-    m_deltas = std::make_shared<t_zcdeltas>();
-    m_delta_pkeys.clear();
-    m_rows_changed = false;
-    m_columns_changed = false;
+    if (begin_step_deltas()) {
+        m_deltas->clear();
+        m_delta_pkeys.clear();
+        m_rows_changed = false;
+        m_columns_changed = false;
+    }
+
+    m_step_row_count = get_row_count();
     m_traversal->step_begin();
 }
 
@@ -54,34 +68,23 @@ t_ctx0::step_end() {
         return;
     }
 
+    ++m_data_version;
     m_traversal->step_end();
 #ifndef PSP_ENABLE_WASM
     t_uindex ncols = m_config.get_num_columns();
     std::vector<t_minmax> rval(ncols);
 
-    auto pkeys = m_traversal->get_pkeys();
+    auto pkeys = m_traversal->get_unordered_pkeys();
     auto stbl = m_gstate->get_table();
 
-#ifdef PSP_PARALLEL_FOR
-    tbb::parallel_for(0, int(ncols), 1,
-        [&rval, &stbl, pkeys, this](int colidx)
-#else
-    for (t_uindex colidx = 0; colidx < ncols; ++colidx)
-#endif
-        {
+    t_scheduler::current().parallel_for(ncols,
+        [&rval, &stbl, pkeys, this](t_uindex colidx) {
             auto colname = m_config.col_at(colidx);
 
             if (stbl->get_dtype(colname) != DTYPE_STR) {
-                auto v = m_gstate->reduce<std::function<std::pair<t_tscalar, t_tscalar>(
-                    const std::vector<t_tscalar>&)>>(pkeys, colname, get_vec_min_max);
-
-                rval[colidx].m_min = v.first;
-                rval[colidx].m_max = v.second;
+                rval[colidx] = m_gstate->get_min_max(pkeys, colname);
             }
-        }
-#ifdef PSP_PARALLEL_FOR
-    );
-#endif
+        });
 
     m_minmax = rval;
 #endif
@@ -170,6 +173,146 @@ t_ctx0::get_data(const std::vector<t_uindex>& rows) const {
     return values;
 }
 
+std::shared_ptr<const t_column>
+t_ctx0::get_string_ids(t_index cidx, t_index start_row, t_index end_row,
+    std::vector<std::int32_t>& ids) const {
+    std::vector<t_tscalar> pkeys = m_traversal->get_pkeys(start_row, end_row);
+    std::shared_ptr<const t_column> col
+        = m_gstate->get_table()->get_const_column(m_config.col_at(cidx));
+    PSP_VERBOSE_ASSERT(col->get_dtype() == DTYPE_STR, "Expected a string column");
+    bool has_status = col->is_status_enabled();
+
+    ids.resize(pkeys.size());
+    for (t_uindex idx = 0, loop_end = pkeys.size(); idx < loop_end; ++idx) {
+        t_rlookup lookup = m_gstate->lookup(pkeys[idx]);
+        if (!lookup.m_exists || (has_status && !col->is_valid(lookup.m_idx))) {
+            ids[idx] = -1;
+        } else {
+            ids[idx] = static_cast<std::int32_t>(*(col->get_nth<t_stridx>(lookup.m_idx)));
+        }
+    }
+
+    return col;
+}
+
+std::shared_ptr<t_slice_column>
+t_ctx0::get_column(t_index cidx, t_index start_row, t_index end_row) const {
+    std::shared_ptr<const t_column> col
+        = m_gstate->get_table()->get_const_column(m_config.col_at(cidx));
+    if (!t_slice_column::is_supported(col->get_dtype())) {
+        return nullptr;
+    }
+
+    std::vector<t_tscalar> pkeys = m_traversal->get_pkeys(start_row, end_row);
+    std::vector<t_index> rows(pkeys.size());
+    for (t_uindex idx = 0, loop_end = pkeys.size(); idx < loop_end; ++idx) {
+        t_rlookup lookup = m_gstate->lookup(pkeys[idx]);
+        rows[idx] = lookup.m_exists ? static_cast<t_index>(lookup.m_idx) : -1;
+    }
+
+    return std::make_shared<t_slice_column>(col, rows);
+}
+
+std::shared_ptr<t_ctx_snapshot>
+t_ctx0::get_snapshot(t_index start_row, t_index end_row, t_index start_col, t_index end_col) {
+    auto ext = sanitize_get_data_extents(
+        get_row_count(), get_column_count(), start_row, end_row, start_col, end_col);
+
+    std::vector<std::string> columns;
+    for (t_index cidx = ext.m_scol; cidx < ext.m_ecol; ++cidx) {
+        const std::string& name = m_config.col_at(cidx);
+        if (std::find(columns.begin(), columns.end(), name) == columns.end()) {
+            columns.push_back(name);
+        }
+    }
+
+    auto snapshot = std::make_shared<t_ctx_snapshot>();
+    snapshot->m_tables.push_back(m_gstate->get_table()->snapshot(columns));
+
+    std::vector<t_tscalar> pkeys = m_traversal->get_pkeys(ext.m_srow, ext.m_erow);
+    snapshot->m_rows.resize(pkeys.size());
+    for (t_uindex idx = 0, loop_end = pkeys.size(); idx < loop_end; ++idx) {
+        t_rlookup lookup = m_gstate->lookup(pkeys[idx]);
+        snapshot->m_rows[idx] = lookup.m_exists ? static_cast<t_index>(lookup.m_idx) : -1;
+    }
+
+    return snapshot;
+}
+
+std::vector<t_tscalar>
+t_ctx0::get_data(const t_ctx_snapshot& snapshot, t_index start_col, t_index end_col) const {
+    t_index nrows = snapshot.m_rows.size();
+    auto ext = sanitize_get_data_extents(
+        nrows, get_column_count(), 0, nrows, start_col, end_col);
+
+    t_index stride = ext.m_ecol - ext.m_scol;
+    std::vector<t_tscalar> values(nrows * stride);
+    const t_data_table& table = *snapshot.m_tables[0];
+    auto none = mknone();
+
+    for (t_index cidx = ext.m_scol; cidx < ext.m_ecol; ++cidx) {
+        std::shared_ptr<const t_column> col = table.get_const_column(m_config.col_at(cidx));
+
+        for (t_index ridx = 0; ridx < nrows; ++ridx) {
+            t_index row = snapshot.m_rows[ridx];
+            t_tscalar v = row < 0 ? t_tscalar() : col->get_scalar(row);
+
+            // todo: fix null handling
+            if (!v.is_valid())
+                v.set(none);
+
+            values[ridx * stride + (cidx - ext.m_scol)] = v;
+        }
+    }
+
+    return values;
+}
+
+std::shared_ptr<const t_column>
+t_ctx0::get_string_ids(
+    const t_ctx_snapshot& snapshot, t_index cidx, std::vector<std::int32_t>& ids) const {
+    std::shared_ptr<const t_column> col
+        = snapshot.m_tables[0]->get_const_column(m_config.col_at(cidx));
+    PSP_VERBOSE_ASSERT(col->get_dtype() == DTYPE_STR, "Expected a string column");
+    bool has_status = col->is_status_enabled();
+
+    ids.resize(snapshot.m_rows.size());
+    for (t_uindex idx = 0, loop_end = snapshot.m_rows.size(); idx < loop_end; ++idx) {
+        t_index row = snapshot.m_rows[idx];
+        if (row < 0 || (has_status && !col->is_valid(row))) {
+            ids[idx] = -1;
+        } else {
+            ids[idx] = static_cast<std::int32_t>(*(col->get_nth<t_stridx>(row)));
+        }
+    }
+
+    return col;
+}
+
+std::vector<t_slice_column>
+t_ctx0::get_columns(const t_ctx_snapshot& snapshot, t_index start_col, t_index end_col) const {
+    t_index nrows = snapshot.m_rows.size();
+    auto ext = sanitize_get_data_extents(
+        nrows, get_column_count(), 0, nrows, start_col, end_col);
+
+    const t_data_table& table = *snapshot.m_tables[0];
+    std::vector<std::shared_ptr<const t_column>> cols;
+    for (t_index cidx = ext.m_scol; cidx < ext.m_ecol; ++cidx) {
+        cols.push_back(table.get_const_column(m_config.col_at(cidx)));
+        if (!t_slice_column::is_supported(cols.back()->get_dtype())) {
+            return std::vector<t_slice_column>();
+        }
+    }
+
+    std::vector<t_slice_column> columns;
+    columns.reserve(cols.size());
+    for (const auto& col : cols) {
+        columns.emplace_back(col, snapshot.m_rows);
+    }
+
+    return columns;
+}
+
 void
 t_ctx0::sort_by() {
     reset_sortby();
@@ -179,6 +322,7 @@ void
 t_ctx0::sort_by(const std::vector<t_sortspec>& sortby) {
     if (sortby.empty())
         return;
+    PSP_TRACE_SPAN("ctx0.sort");
     m_traversal->sort_by(m_gstate, m_config, sortby);
 }
 
@@ -187,6 +331,16 @@ t_ctx0::reset_sortby() {
     m_traversal->sort_by(m_gstate, m_config, std::vector<t_sortspec>());
 }
 
+void
+t_ctx0::set_sort_limit(t_uindex limit) {
+    m_traversal->set_sort_limit(limit);
+}
+
+t_uindex
+t_ctx0::get_sort_limit() const {
+    return m_traversal->get_sort_limit();
+}
+
 t_tscalar
 t_ctx0::get_column_name(t_index idx) {
     std::string empty("");
@@ -200,6 +354,7 @@ t_ctx0::get_column_name(t_index idx) {
 void
 t_ctx0::init() {
     m_traversal = std::make_shared<t_ftrav>();
+    m_traversal->set_sort_limit(t_env::sort_limit());
     m_deltas = std::make_shared<t_zcdeltas>();
     m_init = true;
 }
@@ -267,6 +422,8 @@ t_ctx0::get_cell_delta(t_index bidx, t_index eidx) const {
     bidx = std::min(bidx, m_traversal->size());
     eidx = std::min(eidx, m_traversal->size());
 
+    m_viewport.clip_rows(bidx, eidx);
+
     std::vector<t_cellupd> rval;
 
     if (m_traversal->empty_sort_by()) {
@@ -274,11 +431,11 @@ t_ctx0::get_cell_delta(t_index bidx, t_index eidx) const {
         for (t_index idx = 0, loop_end = pkey_vec.size(); idx < loop_end; ++idx) {
             const t_tscalar& pkey = pkey_vec[idx];
             t_index row = bidx + idx;
-            std::pair<t_zcdeltas::index<by_zc_pkey_colidx>::type::iterator,
-                t_zcdeltas::index<by_zc_pkey_colidx>::type::iterator>
-                iters = m_deltas->get<by_zc_pkey_colidx>().equal_range(pkey);
-            for (t_zcdeltas::index<by_zc_pkey_colidx>::type::iterator iter = iters.first;
-                 iter != iters.second; ++iter) {
+            auto iters = m_deltas->equal_range(pkey);
+            for (auto iter = iters.first; iter != iters.second; ++iter) {
+                if (!m_viewport.contains_column(iter->m_colidx)) {
+                    continue;
+                }
                 t_cellupd cellupd;
                 cellupd.row = row;
                 cellupd.column = iter->m_colidx;
@@ -288,23 +445,24 @@ t_ctx0::get_cell_delta(t_index bidx, t_index eidx) const {
             }
         }
     } else {
-        for (t_zcdeltas::index<by_zc_pkey_colidx>::type::iterator iter
-             = m_deltas->get<by_zc_pkey_colidx>().begin();
-             iter != m_deltas->get<by_zc_pkey_colidx>().end(); ++iter) {
+        for (auto iter = m_deltas->begin(); iter != m_deltas->end(); ++iter) {
             if (prev_pkey != iter->m_pkey) {
                 pkeys.insert(iter->m_pkey);
                 prev_pkey = iter->m_pkey;
             }
         }
 
+        // Only the rows up to `eidx` need to be sorted to be found.
         tsl::hopscotch_map<t_tscalar, t_index> r_indices;
-        m_traversal->get_row_indices(pkeys, r_indices);
+        m_traversal->get_row_indices(bidx, eidx + 1, pkeys, r_indices);
 
-        for (t_zcdeltas::index<by_zc_pkey_colidx>::type::iterator iter
-             = m_deltas->get<by_zc_pkey_colidx>().begin();
-             iter != m_deltas->get<by_zc_pkey_colidx>().end(); ++iter) {
-            t_index row = r_indices[iter->m_pkey];
-            if (bidx <= row && row <= eidx) {
+        for (auto iter = m_deltas->begin(); iter != m_deltas->end(); ++iter) {
+            auto riter = r_indices.find(iter->m_pkey);
+            if (riter == r_indices.end()) {
+                continue;
+            }
+            t_index row = riter->second;
+            if (bidx <= row && row <= eidx && m_viewport.contains_column(iter->m_colidx)) {
                 t_cellupd cellupd;
                 cellupd.row = row;
                 cellupd.column = iter->m_colidx;
@@ -345,8 +503,11 @@ t_rowdelta
 t_ctx0::get_row_delta() {
     bool rows_changed = m_rows_changed || !m_traversal->empty_sort_by();
     tsl::hopscotch_set<t_tscalar> pkeys = get_delta_pkeys();
-    std::vector<t_uindex> rows = m_traversal->get_row_indices(pkeys);
-    std::sort(rows.begin(), rows.end());
+    // Only the rows up to the end of the viewport need to be sorted.
+    t_index bidx = 0;
+    t_index eidx = m_traversal->size();
+    m_viewport.clip_rows(bidx, eidx);
+    std::vector<t_uindex> rows = m_traversal->get_row_indices(bidx, eidx, pkeys);
     std::vector<t_tscalar> data = get_data(rows);
     t_rowdelta rval(rows_changed, rows.size(), data);
     clear_deltas();
@@ -371,9 +532,10 @@ t_ctx0::get_sort_by() const {
 void
 t_ctx0::reset() {
     m_traversal->reset();
-    m_deltas = std::make_shared<t_zcdeltas>();
+    m_deltas->clear();
     m_minmax = std::vector<t_minmax>(m_config.get_num_columns());
     m_has_delta = false;
+    ++m_data_version;
 }
 
 t_index
@@ -405,10 +567,18 @@ t_ctx0::notify(const t_data_table& flattened, const t_data_table& delta,
     std::shared_ptr<const t_column> existed_sptr = existed.get_const_column("psp_existed");
     const t_column* existed_col = existed_sptr.get();
 
+    // Rows are applied to the traversal in batches, so that it reads their
+    // sort values a column at a time.
+    std::vector<t_tscalar> added_pkeys;
+    std::vector<t_tscalar> updated_pkeys;
+    std::vector<t_tscalar> deleted_pkeys;
+
     bool delete_encountered = false;
     if (m_config.has_filters()) {
-        t_mask msk_prev = filter_table_for_config(prev, m_config);
         t_mask msk_curr = filter_table_for_config(curr, m_config);
+        t_mask msk_prev = filter_columns_changed(transitions, m_config)
+            ? filter_table_for_config(prev, m_config)
+            : msk_curr;
 
         for (t_uindex idx = 0; idx < nrecs; ++idx) {
             t_tscalar pkey = m_symtable.get_interned_tscalar(pkey_col->get_scalar(idx));
@@ -424,18 +594,18 @@ t_ctx0::notify(const t_data_table& flattened, const t_data_table& delta,
 
                     if (filter_prev) {
                         if (filter_curr) {
-                            m_traversal->update_row(m_gstate, m_config, pkey);
+                            updated_pkeys.push_back(pkey);
                         } else {
-                            m_traversal->delete_row(pkey);
+                            deleted_pkeys.push_back(pkey);
                         }
                     } else {
                         if (filter_curr) {
-                            m_traversal->add_row(m_gstate, m_config, pkey);
+                            added_pkeys.push_back(pkey);
                         }
                     }
                 } break;
                 case OP_DELETE: {
-                    m_traversal->delete_row(pkey);
+                    deleted_pkeys.push_back(pkey);
                     delete_encountered = true;
                 } break;
                 default: { PSP_COMPLAIN_AND_ABORT("Unexpected OP"); } break;
@@ -444,10 +614,17 @@ t_ctx0::notify(const t_data_table& flattened, const t_data_table& delta,
             // add the pkey for updated rows
             add_delta_pkey(pkey);
         }
+
+        m_traversal->delete_rows(deleted_pkeys);
+        m_traversal->add_rows(m_gstate, m_config, added_pkeys);
+        m_traversal->update_rows(m_gstate, m_config, updated_pkeys);
+    m_rows_changed = m_rows_changed || !added_pkeys.empty() || !deleted_pkeys.empty();
         psp_log_time(repr() + " notify.has_filter_path.updated_traversal");
 
         // calculate deltas
-        calc_step_delta(flattened, prev, curr, transitions);
+        if (get_deltas_enabled()) {
+            calc_step_delta(flattened, prev, curr, transitions);
+        }
         m_has_delta = m_deltas->size() > 0 || m_delta_pkeys.size() > 0 || delete_encountered;
 
         psp_log_time(repr() + " notify.has_filter_path.exit");
@@ -464,13 +641,13 @@ t_ctx0::notify(const t_data_table& flattened, const t_data_table& delta,
         switch (op) {
             case OP_INSERT: {
                 if (existed) {
-                    m_traversal->update_row(m_gstate, m_config, pkey);
+                    updated_pkeys.push_back(pkey);
                 } else {
-                    m_traversal->add_row(m_gstate, m_config, pkey);
+                    added_pkeys.push_back(pkey);
                 }
             } break;
             case OP_DELETE: {
-                m_traversal->delete_row(pkey);
+                deleted_pkeys.push_back(pkey);
                 delete_encountered = true;
             } break;
             default: { PSP_COMPLAIN_AND_ABORT("Unexpected OP"); } break;
@@ -480,10 +657,17 @@ t_ctx0::notify(const t_data_table& flattened, const t_data_table& delta,
         add_delta_pkey(pkey);
     }
 
+    m_traversal->delete_rows(deleted_pkeys);
+    m_traversal->add_rows(m_gstate, m_config, added_pkeys);
+    m_traversal->update_rows(m_gstate, m_config, updated_pkeys);
+    m_rows_changed = m_rows_changed || !added_pkeys.empty() || !deleted_pkeys.empty();
+
     psp_log_time(repr() + " notify.no_filter_path.updated_traversal");
 
     // calculate deltas
-    calc_step_delta(flattened, prev, curr, transitions);
+    if (get_deltas_enabled()) {
+        calc_step_delta(flattened, prev, curr, transitions);
+    }
     m_has_delta = m_deltas->size() > 0 || m_delta_pkeys.size() > 0 || delete_encountered;
 
     psp_log_time(repr() + " notify.no_filter_path.exit");
@@ -503,6 +687,7 @@ t_ctx0::notify(const t_data_table& flattened) {
     const t_column* op_col = op_sptr.get();
 
     m_has_delta = true;
+    std::vector<t_tscalar> added_pkeys;
 
     if (m_config.has_filters()) {
         t_mask msk = filter_table_for_config(flattened, m_config);
@@ -515,7 +700,7 @@ t_ctx0::notify(const t_data_table& flattened) {
             switch (op) {
                 case OP_INSERT: {
                     if (msk.get(idx)) {
-                        m_traversal->add_row(m_gstate, m_config, pkey);
+                        added_pkeys.push_back(pkey);
                     }
                 } break;
                 default: {
@@ -523,6 +708,7 @@ t_ctx0::notify(const t_data_table& flattened) {
                 } break;
             }
         }
+        m_traversal->add_rows(m_gstate, m_config, added_pkeys);
         return;
     }
 
@@ -533,10 +719,11 @@ t_ctx0::notify(const t_data_table& flattened) {
 
         switch (op) {
             case OP_INSERT: {
-                m_traversal->add_row(m_gstate, m_config, pkey);
+                added_pkeys.push_back(pkey);
             } break;
             default: { } break; }
     }
+    m_traversal->add_rows(m_gstate, m_config, added_pkeys);
 }
 
 void
@@ -553,6 +740,10 @@ t_ctx0::calc_step_delta(const t_data_table& flattened, const t_data_table& prev,
 
     for (const auto& name : column_names) {
         auto cidx = m_config.get_colidx(name);
+        // Changes to columns outside of the viewport are never reported.
+        if (!m_viewport.contains_column(cidx)) {
+            continue;
+        }
         const t_column* tcol = transitions.get_const_column(name).get();
         const t_column* pcol = prev.get_const_column(name).get();
         const t_column* ccol = curr.get_const_column(name).get();
@@ -630,6 +821,20 @@ t_ctx0::has_deltas() const {
     return m_has_delta;
 }
 
+std::set<std::string>
+t_ctx0::get_transitional_columns() const {
+    std::set<std::string> rval = m_config.get_filter_columns();
+
+    // Cell deltas are calculated from every column, when they are enabled.
+    if (get_deltas_enabled()) {
+        for (const std::string& name : m_config.get_column_names()) {
+            rval.insert(name);
+        }
+    }
+
+    return rval;
+}
+
 void
 t_ctx0::pprint() const {}
 
@@ -662,6 +867,16 @@ t_ctx0::unity_get_row_path(t_uindex idx) const {
     return std::vector<t_tscalar>(mktscalar(idx));
 }
 
+t_row_paths
+t_ctx0::unity_get_row_paths(t_uindex start_row, t_uindex end_row) const {
+    t_row_paths rval;
+    std::vector<t_tscalar> empty;
+    for (t_uindex ridx = start_row; ridx < end_row; ++ridx) {
+        rval.push_back(empty);
+    }
+    return rval;
+}
+
 std::vector<t_tscalar>
 t_ctx0::unity_get_column_path(t_uindex idx) const {
     return std::vector<t_tscalar>();
@@ -720,6 +935,7 @@ t_ctx0::unity_get_column_expanded(t_uindex idx) const {
 void
 t_ctx0::clear_deltas() {
     m_has_delta = false;
+    m_deltas_pending = false;
 }
 
 void
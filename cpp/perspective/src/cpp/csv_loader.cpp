@@ -0,0 +1,884 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#include <perspective/first.h>
+#include <perspective/csv_loader.h>
+#include <perspective/date_parser.h>
+#include <perspective/column.h>
+#include <perspective/scheduler.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <limits>
+
+// The number of rows parsed by each task
+#define PSP_CSV_CHUNK_SIZE 65536
+
+namespace perspective {
+namespace csv {
+
+    namespace {
+
+        const std::int64_t MS_PER_HOUR = 3600000;
+        const std::int64_t MS_PER_DAY = 86400000;
+
+        /**
+         * @brief Returns the number of days between 1970-01-01 and the civil
+         * date `year`-`month`-`day`, where `month` is 1-12.
+         */
+        std::int64_t
+        days_from_civil(std::int64_t year, std::int64_t month, std::int64_t day) {
+            year -= month <= 2;
+            std::int64_t era = (year >= 0 ? year : year - 399) / 400;
+            std::int64_t yoe = year - era * 400;
+            std::int64_t doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+            std::int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+            return era * 146097 + doe - 719468;
+        }
+
+        /**
+         * @brief A date, and the milliseconds into the day if it has a time.
+         */
+        struct t_csv_datetime {
+            std::int32_t m_year;
+            std::int32_t m_month;
+            std::int32_t m_day;
+            std::int64_t m_ms;
+            bool m_has_time;
+            bool m_is_utc;
+
+            /**
+             * @brief Returns milliseconds since epoch, reading datetimes
+             * without a `Z` suffix or UTC offset as local time like the
+             * Python and Javascript loaders do.
+             *
+             * Local time offsets change on the hour, so the offset of the
+             * last hour read is cached in `layout`, as the datetimes of a
+             * column are often close together.
+             */
+            std::int64_t
+            to_ms(t_csv_date_layout& layout) const {
+                std::int64_t ms = days_from_civil(m_year, m_month, m_day) * MS_PER_DAY + m_ms;
+                if (m_is_utc) {
+                    return ms;
+                }
+
+                std::int64_t hour = ms >= 0 ? ms / MS_PER_HOUR : (ms + 1) / MS_PER_HOUR - 1;
+                if (hour != layout.m_local_hour) {
+                    std::tm tm = {};
+                    tm.tm_year = m_year - 1900;
+                    tm.tm_mon = m_month - 1;
+                    tm.tm_mday = m_day;
+                    tm.tm_hour = m_ms / MS_PER_HOUR;
+                    tm.tm_isdst = -1;
+                    std::time_t local = std::mktime(&tm);
+                    layout.m_local_hour = hour;
+                    layout.m_local_offset
+                        = static_cast<std::int64_t>(local) * 1000 - hour * MS_PER_HOUR;
+                }
+
+                return ms + layout.m_local_offset;
+            }
+        };
+
+        bool
+        is_empty(const t_csv_field& field) {
+            return field.m_begin == field.m_end;
+        }
+
+        bool
+        parse_int(const char* begin, const char* end, std::int64_t& out) {
+            bool negative = false;
+            if (begin < end && (*begin == '-' || *begin == '+')) {
+                negative = *begin == '-';
+                ++begin;
+            }
+
+            // 18 digits always fit in an int64
+            if (begin == end || end - begin > 18) {
+                return false;
+            }
+
+            std::int64_t value = 0;
+            for (const char* p = begin; p < end; ++p) {
+                if (*p < '0' || *p > '9') {
+                    return false;
+                }
+                value = value * 10 + (*p - '0');
+            }
+
+            out = negative ? -value : value;
+            return true;
+        }
+
+        bool
+        parse_float(const char* begin, const char* end, double& out) {
+            // Fields are not terminated, so copy them to call `strtod`.
+            char buffer[64];
+            std::size_t length = end - begin;
+            if (length == 0 || length >= sizeof(buffer)) {
+                return false;
+            }
+
+            std::memcpy(buffer, begin, length);
+            buffer[length] = '\0';
+
+            char* parsed_end = nullptr;
+            out = std::strtod(buffer, &parsed_end);
+            return parsed_end == buffer + length;
+        }
+
+        bool
+        equals_ignore_case(const char* begin, const char* end, const char* word) {
+            std::size_t length = std::strlen(word);
+            if (std::size_t(end - begin) != length) {
+                return false;
+            }
+
+            for (std::size_t i = 0; i < length; ++i) {
+                if (std::tolower(static_cast<unsigned char>(begin[i])) != word[i]) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        bool
+        parse_bool(const char* begin, const char* end, bool& out) {
+            if (equals_ignore_case(begin, end, "true")) {
+                out = true;
+                return true;
+            } else if (equals_ignore_case(begin, end, "false")) {
+                out = false;
+                return true;
+            }
+
+            return false;
+        }
+
+        bool
+        read_digits(const char*& p, const char* end, std::int32_t ndigits, std::int32_t& out) {
+            out = 0;
+            for (std::int32_t i = 0; i < ndigits; ++i, ++p) {
+                if (p >= end || *p < '0' || *p > '9') {
+                    return false;
+                }
+                out = out * 10 + (*p - '0');
+            }
+
+            return true;
+        }
+
+        /**
+         * @brief Parse `YYYY-MM-DD`, optionally followed by `[T ]HH:MM`,
+         * seconds, fractional seconds and `Z` or a `+HH:MM` UTC offset.
+         */
+        bool
+        parse_iso(const char* begin, const char* end, t_csv_datetime& out) {
+            const char* p = begin;
+            std::int32_t hour = 0, minute = 0, second = 0;
+            std::int64_t utc_offset = 0;
+
+            if (!read_digits(p, end, 4, out.m_year) || p >= end || *p++ != '-'
+                || !read_digits(p, end, 2, out.m_month) || p >= end || *p++ != '-'
+                || !read_digits(p, end, 2, out.m_day)) {
+                return false;
+            }
+
+            out.m_ms = 0;
+            out.m_has_time = p < end;
+            out.m_is_utc = false;
+
+            if (out.m_has_time) {
+                if ((*p != 'T' && *p != ' ') || !read_digits(++p, end, 2, hour) || p >= end
+                    || *p++ != ':' || !read_digits(p, end, 2, minute)) {
+                    return false;
+                }
+
+                if (p < end && *p == ':') {
+                    if (!read_digits(++p, end, 2, second)) {
+                        return false;
+                    }
+
+                    if (p < end && *p == '.') {
+                        // Keep milliseconds, and ignore finer precision
+                        std::int32_t scale = 100;
+                        for (++p; p < end && *p >= '0' && *p <= '9'; ++p) {
+                            out.m_ms += (*p - '0') * scale;
+                            scale /= 10;
+                        }
+                    }
+                }
+
+                if (p < end && *p == 'Z') {
+                    out.m_is_utc = true;
+                    ++p;
+                } else if (p < end && (*p == '+' || *p == '-')) {
+                    bool negative = *p == '-';
+                    std::int32_t offset_hour, offset_minute;
+                    if (!read_digits(++p, end, 2, offset_hour) || p >= end || *p++ != ':'
+                        || !read_digits(p, end, 2, offset_minute)) {
+                        return false;
+                    }
+
+                    utc_offset = (offset_hour * 60 + offset_minute) * std::int64_t(60000);
+                    utc_offset = negative ? -utc_offset : utc_offset;
+                    out.m_is_utc = true;
+                }
+
+                if (p != end) {
+                    return false;
+                }
+            }
+
+            if (out.m_month < 1 || out.m_month > 12 || out.m_day < 1 || out.m_day > 31
+                || hour > 23 || minute > 59 || second > 60) {
+                return false;
+            }
+
+            out.m_ms += ((hour * 60 + minute) * 60 + second) * std::int64_t(1000) - utc_offset;
+            return true;
+        }
+
+        std::int32_t
+        digits2(const char* p) {
+            return (p[0] - '0') * 10 + (p[1] - '0');
+        }
+
+        std::int32_t
+        digits4(const char* p) {
+            return digits2(p) * 100 + digits2(p + 2);
+        }
+
+        /**
+         * @brief Detect the layout of a column from `begin`, its first
+         * datetime, if it is ISO 8601 or `MM/DD/YYYY`. Values in other
+         * formats or that are not datetimes leave the layout to be detected
+         * from the next value.
+         */
+        void
+        detect_layout(const char* begin, const char* end, t_csv_date_layout& layout) {
+            std::int32_t length = end - begin;
+            t_csv_datetime dval;
+
+            if (length == 10 && begin[2] == '/' && begin[5] == '/'
+                && std::count_if(begin, end, [](char c) { return c >= '0' && c <= '9'; }) == 8) {
+                layout.m_month = 0;
+                layout.m_day = 3;
+                layout.m_year = 6;
+            } else if (length <= 40 && parse_iso(begin, end, dval)) {
+                layout.m_year = 0;
+                layout.m_month = 5;
+                layout.m_day = 8;
+
+                if (length > 10) {
+                    layout.m_hour = 11;
+                    layout.m_minute = 14;
+                    std::int32_t pos = 16;
+
+                    if (pos < length && begin[pos] == ':') {
+                        layout.m_second = 17;
+                        pos = 19;
+
+                        if (pos < length && begin[pos] == '.') {
+                            layout.m_fraction = ++pos;
+                            while (pos < length && begin[pos] >= '0' && begin[pos] <= '9') {
+                                ++pos;
+                            }
+                            layout.m_fraction_end = pos;
+                        }
+                    }
+
+                    if (pos < length && begin[pos] == 'Z') {
+                        layout.m_is_utc = true;
+                    } else if (pos < length) {
+                        layout.m_utc_offset = pos;
+                    }
+                }
+            } else {
+                return;
+            }
+
+            layout.m_detected = true;
+            layout.m_template.assign(begin, end);
+            for (char& c : layout.m_template) {
+                if (c >= '0' && c <= '9') {
+                    c = '0';
+                }
+            }
+        }
+
+        /**
+         * @brief Parse a datetime with the fixed layout of its column,
+         * returning false if it does not match the layout.
+         */
+        bool
+        parse_layout(
+            const t_csv_date_layout& layout, const char* begin, const char* end, t_csv_datetime& out) {
+            const char* tpl = layout.m_template.data();
+            std::size_t length = layout.m_template.size();
+            if (length == 0 || std::size_t(end - begin) != length) {
+                return false;
+            }
+
+            // Check every character without branching, so that the loop
+            // can be vectorized.
+            bool mismatch = false;
+            for (std::size_t i = 0; i < length; ++i) {
+                bool is_digit = static_cast<unsigned char>(begin[i] - '0') < 10;
+                mismatch |= tpl[i] == '0' ? !is_digit : begin[i] != tpl[i];
+            }
+
+            if (mismatch) {
+                return false;
+            }
+
+            out.m_year = digits4(begin + layout.m_year);
+            out.m_month = digits2(begin + layout.m_month);
+            out.m_day = digits2(begin + layout.m_day);
+            out.m_has_time = layout.m_hour >= 0;
+            out.m_is_utc = layout.m_is_utc || layout.m_utc_offset >= 0;
+            out.m_ms = 0;
+
+            std::int32_t hour = 0, minute = 0, second = 0;
+            if (out.m_has_time) {
+                hour = digits2(begin + layout.m_hour);
+                minute = digits2(begin + layout.m_minute);
+            }
+
+            if (layout.m_second >= 0) {
+                second = digits2(begin + layout.m_second);
+            }
+
+            // Keep milliseconds, and ignore finer precision
+            std::int32_t scale = 100;
+            for (std::int32_t i = layout.m_fraction; i < layout.m_fraction_end && scale > 0;
+                 ++i, scale /= 10) {
+                out.m_ms += (begin[i] - '0') * scale;
+            }
+
+            if (out.m_month < 1 || out.m_month > 12 || out.m_day < 1 || out.m_day > 31
+                || hour > 23 || minute > 59 || second > 60) {
+                return false;
+            }
+
+            out.m_ms += ((hour * 60 + minute) * 60 + second) * std::int64_t(1000);
+            if (layout.m_utc_offset >= 0) {
+                const char* offset = begin + layout.m_utc_offset;
+                std::int64_t utc_offset
+                    = (digits2(offset + 1) * 60 + digits2(offset + 4)) * std::int64_t(60000);
+                out.m_ms -= *offset == '-' ? -utc_offset : utc_offset;
+            }
+
+            return true;
+        }
+
+        bool
+        parse_datetime(
+            const t_date_parser& parser, const char* begin, const char* end, t_csv_datetime& out) {
+            if (parse_iso(begin, end, out)) {
+                return true;
+            }
+
+            // Only values with digits can be dates, which keeps the slower
+            // formats of `t_date_parser` away from most strings.
+            std::size_t length = end - begin;
+            if (length < 6 || length > 64 || std::find_if(begin, end, [](char c) {
+                    return c >= '0' && c <= '9';
+                }) == end) {
+                return false;
+            }
+
+            std::tm tm = {};
+            if (!parser.parse(std::string(begin, end), tm, out.m_has_time)) {
+                return false;
+            }
+
+            out.m_year = tm.tm_year + 1900;
+            out.m_month = tm.tm_mon + 1;
+            out.m_day = tm.tm_mday;
+            out.m_is_utc = false;
+            out.m_ms = ((tm.tm_hour * 60 + tm.tm_min) * 60 + tm.tm_sec) * std::int64_t(1000);
+            return true;
+        }
+
+        /**
+         * @brief Parse a datetime of a column with the column's layout,
+         * detecting the layout first if it has not been, and falling back to
+         * `parse_datetime` for values that do not match it.
+         */
+        bool
+        parse_column_datetime(const t_date_parser& parser, t_csv_date_layout& layout,
+            const char* begin, const char* end, t_csv_datetime& out) {
+            if (!layout.m_detected) {
+                detect_layout(begin, end, layout);
+            }
+
+            return parse_layout(layout, begin, end, out)
+                || parse_datetime(parser, begin, end, out);
+        }
+
+    } // end anonymous namespace
+
+    t_csv_date_layout::t_csv_date_layout()
+        : m_detected(false)
+        , m_year(-1)
+        , m_month(-1)
+        , m_day(-1)
+        , m_hour(-1)
+        , m_minute(-1)
+        , m_second(-1)
+        , m_fraction(-1)
+        , m_fraction_end(-1)
+        , m_utc_offset(-1)
+        , m_is_utc(false)
+        , m_local_hour(std::numeric_limits<std::int64_t>::min())
+        , m_local_offset(0) {}
+
+    std::string
+    field_to_string(const t_csv_field& field) {
+        std::string rval(field.m_begin, field.m_end);
+        if (!field.m_quoted || rval.find('"') == std::string::npos) {
+            return rval;
+        }
+
+        // Unescape doubled quotes
+        std::string unescaped;
+        unescaped.reserve(rval.size());
+        for (std::size_t i = 0; i < rval.size(); ++i) {
+            unescaped.push_back(rval[i]);
+            if (rval[i] == '"' && i + 1 < rval.size() && rval[i + 1] == '"') {
+                ++i;
+            }
+        }
+
+        return unescaped;
+    }
+
+    t_dtype
+    infer_field(const t_date_parser& parser, const t_csv_field& field) {
+        if (is_empty(field)) {
+            return DTYPE_NONE;
+        }
+
+        std::int64_t ival;
+        double fval;
+        bool bval;
+        t_csv_datetime dval;
+
+        if (parse_int(field.m_begin, field.m_end, ival)) {
+            return DTYPE_INT64;
+        } else if (parse_float(field.m_begin, field.m_end, fval)) {
+            return DTYPE_FLOAT64;
+        } else if (parse_bool(field.m_begin, field.m_end, bval)) {
+            return DTYPE_BOOL;
+        } else if (parse_datetime(parser, field.m_begin, field.m_end, dval)) {
+            return dval.m_has_time ? DTYPE_TIME : DTYPE_DATE;
+        }
+
+        return DTYPE_STR;
+    }
+
+    t_dtype
+    merge_types(t_dtype a, t_dtype b) {
+        if (a == b || b == DTYPE_NONE) {
+            return a;
+        } else if (a == DTYPE_NONE) {
+            return b;
+        } else if ((a == DTYPE_INT64 && b == DTYPE_FLOAT64)
+            || (a == DTYPE_FLOAT64 && b == DTYPE_INT64)) {
+            return DTYPE_FLOAT64;
+        } else if ((a == DTYPE_DATE && b == DTYPE_TIME) || (a == DTYPE_TIME && b == DTYPE_DATE)) {
+            return DTYPE_TIME;
+        }
+
+        return DTYPE_STR;
+    }
+
+    void
+    fill_value(const t_date_parser& parser, const t_csv_field& field, t_column& col,
+        t_uindex ridx, bool is_update, t_csv_date_layout& layout) {
+        const char* begin = field.m_begin;
+        const char* end = field.m_end;
+        bool is_set = false;
+
+        if (!is_empty(field)) {
+            std::int64_t ival;
+            double fval;
+            bool bval;
+            t_csv_datetime dval;
+
+            switch (col.get_dtype()) {
+                case DTYPE_INT64:
+                case DTYPE_INT32:
+                case DTYPE_INT16:
+                case DTYPE_INT8:
+                case DTYPE_UINT64:
+                case DTYPE_UINT32:
+                case DTYPE_UINT16:
+                case DTYPE_UINT8: {
+                    is_set = parse_int(begin, end, ival);
+                    if (!is_set && parse_float(begin, end, fval)) {
+                        ival = static_cast<std::int64_t>(fval);
+                        is_set = true;
+                    }
+
+                    if (is_set) {
+                        switch (col.get_dtype()) {
+                            case DTYPE_INT64: col.set_nth<std::int64_t>(ridx, ival); break;
+                            case DTYPE_INT32: col.set_nth<std::int32_t>(ridx, ival); break;
+                            case DTYPE_INT16: col.set_nth<std::int16_t>(ridx, ival); break;
+                            case DTYPE_INT8: col.set_nth<std::int8_t>(ridx, ival); break;
+                            case DTYPE_UINT64: col.set_nth<std::uint64_t>(ridx, ival); break;
+                            case DTYPE_UINT32: col.set_nth<std::uint32_t>(ridx, ival); break;
+                            case DTYPE_UINT16: col.set_nth<std::uint16_t>(ridx, ival); break;
+                            default: col.set_nth<std::uint8_t>(ridx, ival); break;
+                        }
+                    }
+                } break;
+                case DTYPE_FLOAT64:
+                case DTYPE_FLOAT32: {
+                    is_set = parse_float(begin, end, fval);
+                    if (is_set) {
+                        if (col.get_dtype() == DTYPE_FLOAT64) {
+                            col.set_nth<double>(ridx, fval);
+                        } else {
+                            col.set_nth<float>(ridx, fval);
+                        }
+                    }
+                } break;
+                case DTYPE_BOOL: {
+                    is_set = parse_bool(begin, end, bval);
+                    if (is_set) {
+                        col.set_nth<bool>(ridx, bval);
+                    }
+                } break;
+                case DTYPE_DATE: {
+                    is_set = parse_column_datetime(parser, layout, begin, end, dval);
+                    if (is_set) {
+                        col.set_nth<t_date>(
+                            ridx, t_date(dval.m_year, dval.m_month - 1, dval.m_day));
+                    }
+                } break;
+                case DTYPE_TIME: {
+                    is_set = parse_column_datetime(parser, layout, begin, end, dval);
+                    if (is_set) {
+                        col.set_nth<std::int64_t>(ridx, dval.to_ms(layout));
+                    }
+                } break;
+                default: break;
+            }
+        }
+
+        if (!is_set) {
+            if (is_update) {
+                col.unset(ridx);
+            } else {
+                col.clear(ridx);
+            }
+        }
+    }
+
+    CsvLoader::CsvLoader()
+        : m_data(nullptr)
+        , m_end(nullptr)
+        , m_delimiter(',') {}
+
+    CsvLoader::~CsvLoader() {}
+
+    void
+    CsvLoader::initialize(const char* data, std::size_t length, char delimiter) {
+        m_data = data;
+        m_end = data + length;
+        m_delimiter = delimiter;
+        m_rows.clear();
+        m_names.clear();
+
+        const char* p = m_data;
+
+        // Skip a UTF-8 byte order mark
+        if (length >= 3 && std::memcmp(p, "\xEF\xBB\xBF", 3) == 0) {
+            p += 3;
+        }
+
+        std::vector<t_csv_field> fields;
+        p = split_row(p, fields);
+        for (const auto& field : fields) {
+            m_names.push_back(field_to_string(field));
+        }
+
+        // A newline ends a row unless it is quoted; doubled quotes toggle
+        // twice, so they leave the state unchanged.
+        while (p < m_end) {
+            if (*p == '\n' || (*p == '\r' && p + 1 < m_end && p[1] == '\n')) {
+                p += *p == '\n' ? 1 : 2;
+                continue;
+            }
+
+            m_rows.push_back(p);
+
+            bool quoted = false;
+            for (; p < m_end; ++p) {
+                if (*p == '"') {
+                    quoted = !quoted;
+                } else if (*p == '\n' && !quoted) {
+                    ++p;
+                    break;
+                }
+            }
+        }
+
+        m_types = infer_types();
+    }
+
+    const char*
+    CsvLoader::split_row(const char* begin, std::vector<t_csv_field>& fields) const {
+        fields.clear();
+        const char* p = begin;
+
+        while (true) {
+            t_csv_field field;
+
+            if (p < m_end && *p == '"') {
+                field.m_quoted = true;
+                field.m_begin = ++p;
+
+                while (p < m_end) {
+                    if (*p == '"') {
+                        if (p + 1 < m_end && p[1] == '"') {
+                            p += 2;
+                            continue;
+                        }
+                        break;
+                    }
+                    ++p;
+                }
+
+                field.m_end = p;
+
+                // Skip the closing quote, and anything after it
+                while (p < m_end && *p != m_delimiter && *p != '\n') {
+                    ++p;
+                }
+            } else {
+                field.m_quoted = false;
+                field.m_begin = p;
+
+                while (p < m_end && *p != m_delimiter && *p != '\n') {
+                    ++p;
+                }
+
+                field.m_end = p;
+                if (field.m_end > field.m_begin && field.m_end[-1] == '\r'
+                    && (p == m_end || *p == '\n')) {
+                    --field.m_end;
+                }
+            }
+
+            fields.push_back(field);
+
+            if (p < m_end && *p == m_delimiter) {
+                ++p;
+                continue;
+            }
+
+            break;
+        }
+
+        return p < m_end ? p + 1 : p;
+    }
+
+    t_uindex
+    CsvLoader::num_chunks() const {
+        return (m_rows.size() + PSP_CSV_CHUNK_SIZE - 1) / PSP_CSV_CHUNK_SIZE;
+    }
+
+    std::vector<t_dtype>
+    CsvLoader::infer_types() const {
+        t_uindex ncols = m_names.size();
+        t_uindex nchunks = num_chunks();
+        std::vector<std::vector<t_dtype>> chunk_types(
+            nchunks, std::vector<t_dtype>(ncols, DTYPE_NONE));
+        t_date_parser parser;
+
+        auto infer_chunk = [&](t_uindex chunk) {
+            std::vector<t_csv_field> fields;
+            std::vector<t_dtype>& types = chunk_types[chunk];
+            t_uindex end = std::min<t_uindex>(m_rows.size(), (chunk + 1) * PSP_CSV_CHUNK_SIZE);
+
+            for (t_uindex ridx = chunk * PSP_CSV_CHUNK_SIZE; ridx < end; ++ridx) {
+                split_row(m_rows[ridx], fields);
+                for (t_uindex cidx = 0, loop_end = std::min<t_uindex>(ncols, fields.size());
+                     cidx < loop_end; ++cidx) {
+                    // Strings hold every value, so stop parsing the column
+                    if (types[cidx] != DTYPE_STR) {
+                        types[cidx] = merge_types(types[cidx], infer_field(parser, fields[cidx]));
+                    }
+                }
+            }
+        };
+
+        t_scheduler::current().parallel_for(nchunks,
+            [&infer_chunk](t_uindex chunk) { infer_chunk(chunk); });
+
+        std::vector<t_dtype> rval(ncols, DTYPE_NONE);
+        for (const auto& types : chunk_types) {
+            for (t_uindex cidx = 0; cidx < ncols; ++cidx) {
+                rval[cidx] = merge_types(rval[cidx], types[cidx]);
+            }
+        }
+
+        // Columns without any value are read as strings
+        for (auto& type : rval) {
+            if (type == DTYPE_NONE) {
+                type = DTYPE_STR;
+            }
+        }
+
+        return rval;
+    }
+
+    void
+    CsvLoader::fill_table(t_data_table& tbl, const std::string& index, std::uint32_t offset,
+        std::uint32_t limit, bool is_update) {
+        bool implicit_index = false;
+        t_uindex ncols = m_names.size();
+        t_uindex nchunks = num_chunks();
+
+        // The column each field is written to, if it is in the table
+        std::vector<t_column*> columns(ncols, nullptr);
+        std::vector<t_uindex> string_columns;
+
+        for (t_uindex cidx = 0; cidx < ncols; ++cidx) {
+            const std::string& name = m_names[cidx];
+            std::shared_ptr<t_column> col;
+
+            if (name == "__INDEX__") {
+                implicit_index = true;
+                col = tbl.add_column_sptr("psp_pkey", m_types[cidx], true);
+            } else if (tbl.get_schema().has_column(name)) {
+                col = tbl.get_column(name);
+            } else {
+                continue;
+            }
+
+            columns[cidx] = col.get();
+            if (col->get_dtype() == DTYPE_STR) {
+                string_columns.push_back(cidx);
+            }
+        }
+
+        // Strings of each chunk, by string column, which are interned after
+        // every chunk has been parsed. Null strings are flagged.
+        t_uindex nstrings = string_columns.size();
+        std::vector<std::vector<std::string>> chunk_strings(nchunks * nstrings);
+        std::vector<std::vector<bool>> chunk_nulls(nchunks * nstrings);
+        t_date_parser parser;
+
+        auto fill_chunk = [&](t_uindex chunk) {
+            std::vector<t_csv_field> fields;
+            std::vector<t_csv_date_layout> layouts(ncols);
+            t_uindex begin = chunk * PSP_CSV_CHUNK_SIZE;
+            t_uindex end = std::min<t_uindex>(m_rows.size(), begin + PSP_CSV_CHUNK_SIZE);
+            t_csv_field missing = {nullptr, nullptr, false};
+
+            for (t_uindex sidx = 0; sidx < nstrings; ++sidx) {
+                chunk_strings[chunk * nstrings + sidx].reserve(end - begin);
+                chunk_nulls[chunk * nstrings + sidx].reserve(end - begin);
+            }
+
+            for (t_uindex ridx = begin; ridx < end; ++ridx) {
+                split_row(m_rows[ridx], fields);
+                t_uindex sidx = 0;
+
+                for (t_uindex cidx = 0; cidx < ncols; ++cidx) {
+                    t_column* col = columns[cidx];
+                    if (col == nullptr) {
+                        continue;
+                    }
+
+                    // Short rows are missing their last fields
+                    const t_csv_field& field = cidx < fields.size() ? fields[cidx] : missing;
+
+                    if (col->get_dtype() == DTYPE_STR) {
+                        t_uindex slot = chunk * nstrings + sidx++;
+                        bool is_null = is_empty(field);
+                        chunk_nulls[slot].push_back(is_null);
+                        chunk_strings[slot].push_back(is_null ? "" : field_to_string(field));
+                    } else {
+                        fill_value(parser, field, *col, ridx, is_update, layouts[cidx]);
+                    }
+                }
+            }
+        };
+
+        t_scheduler::current().parallel_for(nchunks,
+            [&fill_chunk](t_uindex chunk) { fill_chunk(chunk); });
+
+        auto intern_column = [&](t_uindex sidx) {
+            t_column* col = columns[string_columns[sidx]];
+            t_uindex ridx = 0;
+
+            for (t_uindex chunk = 0; chunk < nchunks; ++chunk) {
+                const auto& strings = chunk_strings[chunk * nstrings + sidx];
+                const auto& nulls = chunk_nulls[chunk * nstrings + sidx];
+
+                for (t_uindex idx = 0, loop_end = strings.size(); idx < loop_end; ++idx, ++ridx) {
+                    if (!nulls[idx]) {
+                        col->set_nth(ridx, strings[idx]);
+                    } else if (is_update) {
+                        col->unset(ridx);
+                    } else {
+                        col->clear(ridx);
+                    }
+                }
+            }
+        };
+
+        t_scheduler::current().parallel_for(nstrings,
+            [&intern_column](t_uindex sidx) { intern_column(sidx); });
+
+        if (implicit_index) {
+            tbl.clone_column("psp_pkey", "psp_okey");
+        } else if (index == "") {
+            // Use row number as index if not explicitly provided or provided with
+            // `__INDEX__`
+            auto key_col = tbl.add_column("psp_pkey", DTYPE_INT32, true);
+            auto okey_col = tbl.add_column("psp_okey", DTYPE_INT32, true);
+
+            for (std::uint32_t ridx = 0; ridx < tbl.size(); ++ridx) {
+                key_col->set_nth<std::int32_t>(ridx, (ridx + offset) % limit);
+                okey_col->set_nth<std::int32_t>(ridx, (ridx + offset) % limit);
+            }
+        } else {
+            tbl.clone_column(index, "psp_pkey");
+            tbl.clone_column(index, "psp_okey");
+        }
+    }
+
+    std::vector<std::string>
+    CsvLoader::names() const {
+        return m_names;
+    }
+
+    std::vector<t_dtype>
+    CsvLoader::types() const {
+        return m_types;
+    }
+
+    std::uint32_t
+    CsvLoader::row_count() const {
+        return m_rows.size();
+    }
+
+} // namespace csv
+} // namespace perspective
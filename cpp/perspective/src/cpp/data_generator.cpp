@@ -0,0 +1,339 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#include <perspective/first.h>
+#include <perspective/base.h>
+#include <perspective/column.h>
+#include <perspective/data_generator.h>
+#include <perspective/date.h>
+#include <perspective/scheduler.h>
+#include <algorithm>
+
+namespace perspective {
+
+namespace {
+    // The `splitmix64` finalizer, which is a bijection of 64-bit integers.
+    std::uint64_t
+    mix(std::uint64_t x) {
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    // FNV-1a, rather than `std::hash`, so that values are the same on every
+    // platform.
+    std::uint64_t
+    hash_name(const std::string& name) {
+        std::uint64_t h = 0xcbf29ce484222325ULL;
+        for (char c : name) {
+            h = (h ^ static_cast<unsigned char>(c)) * 0x100000001b3ULL;
+        }
+        return h;
+    }
+
+    // A uniform double in `[0, 1)`.
+    double
+    to_unit(std::uint64_t h) {
+        return static_cast<double>(h >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    /**
+     * @brief A bijection of `[0, n)` for `x < n`, by cycle-walking a
+     * bijection of the next power of two.
+     */
+    std::uint64_t
+    permute(std::uint64_t x, std::uint64_t n, std::uint64_t seed) {
+        if (n <= 1) {
+            return 0;
+        }
+
+        t_uindex bits = 0;
+        while (bits < 64 && (n - 1) >> bits) {
+            ++bits;
+        }
+
+        std::uint64_t mask = bits == 64 ? ~0ULL : (1ULL << bits) - 1;
+        t_uindex shift = (bits + 1) / 2;
+        do {
+            x = ((x ^ seed) * 0x9e3779b97f4a7c15ULL) & mask;
+            x ^= x >> shift;
+            x = (x * 0xbf58476d1ce4e5b9ULL) & mask;
+            x ^= x >> shift;
+        } while (x >= n);
+        return x;
+    }
+
+    // Midnight of 2020-01-01 UTC, in milliseconds.
+    const std::int64_t TIME_EPOCH = 1577836800000LL;
+
+    // 100 years, in seconds and days.
+    const std::uint64_t TIME_RANGE = 3155760000ULL;
+    const std::uint64_t DATE_RANGE = 36525;
+
+    // The civil date `days` after 1970-01-01, after Howard Hinnant's
+    // `civil_from_days`.
+    t_date
+    date_from_days(std::int64_t days) {
+        days += 719468;
+        std::int64_t era = days / 146097;
+        std::int64_t doe = days - era * 146097;
+        std::int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        std::int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        std::int64_t mp = (5 * doy + 2) / 153;
+        std::int64_t day = doy - (153 * mp + 2) / 5 + 1;
+        std::int64_t month = mp < 10 ? mp + 3 : mp - 9;
+        std::int64_t year = yoe + era * 400 + (month <= 2);
+        return t_date(year, month - 1, day);
+    }
+
+    /**
+     * @brief Write the string for `idx`, `length` lowercase letters in base
+     * 26 padded with `a`, into `buf`. Unless `truncate`, more letters are
+     * written if `idx` needs them.
+     */
+    void
+    make_string(std::uint64_t idx, t_uindex length, bool truncate, std::string& buf) {
+        buf.clear();
+        do {
+            buf.push_back('a' + idx % 26);
+            idx /= 26;
+        } while (idx > 0 && (!truncate || buf.size() < length));
+
+        if (buf.size() < length) {
+            buf.append(length - buf.size(), 'a');
+        }
+
+        std::reverse(buf.begin(), buf.end());
+    }
+
+    /**
+     * @brief Write the value for `idx` to row `ridx` of `column`, as the
+     * column's dtype.
+     */
+    void
+    set_value(t_column& column, t_uindex ridx, std::uint64_t idx, t_uindex string_length,
+        bool is_key, std::string& buf) {
+        switch (column.get_dtype()) {
+            case DTYPE_INT64: {
+                column.set_nth<std::int64_t>(ridx, static_cast<std::int64_t>(idx));
+            } break;
+            case DTYPE_INT32: {
+                column.set_nth<std::int32_t>(ridx, static_cast<std::int32_t>(idx));
+            } break;
+            case DTYPE_INT16: {
+                column.set_nth<std::int16_t>(ridx, static_cast<std::int16_t>(idx));
+            } break;
+            case DTYPE_INT8: {
+                column.set_nth<std::int8_t>(ridx, static_cast<std::int8_t>(idx));
+            } break;
+            case DTYPE_UINT64: {
+                column.set_nth<std::uint64_t>(ridx, idx);
+            } break;
+            case DTYPE_UINT32: {
+                column.set_nth<std::uint32_t>(ridx, static_cast<std::uint32_t>(idx));
+            } break;
+            case DTYPE_UINT16: {
+                column.set_nth<std::uint16_t>(ridx, static_cast<std::uint16_t>(idx));
+            } break;
+            case DTYPE_UINT8: {
+                column.set_nth<std::uint8_t>(ridx, static_cast<std::uint8_t>(idx));
+            } break;
+            case DTYPE_FLOAT64: {
+                column.set_nth<double>(ridx, static_cast<double>(idx) / 4);
+            } break;
+            case DTYPE_FLOAT32: {
+                column.set_nth<float>(ridx, static_cast<float>(idx) / 4);
+            } break;
+            case DTYPE_BOOL: {
+                column.set_nth<bool>(ridx, idx % 2 == 1);
+            } break;
+            case DTYPE_DATE: {
+                column.set_nth<t_date>(ridx, date_from_days(idx % DATE_RANGE));
+            } break;
+            case DTYPE_TIME: {
+                column.set_nth<std::int64_t>(
+                    ridx, TIME_EPOCH + static_cast<std::int64_t>(idx % TIME_RANGE) * 1000);
+            } break;
+            case DTYPE_STR: {
+                make_string(idx, string_length, !is_key, buf);
+                column.set_nth<const char*>(ridx, buf.c_str());
+            } break;
+            default: {
+                PSP_COMPLAIN_AND_ABORT(
+                    "Cannot generate values of dtype `" + get_dtype_descr(column.get_dtype()) + "`");
+            }
+        }
+    }
+} // namespace
+
+t_generator_column::t_generator_column()
+    : m_cardinality(0)
+    , m_null_ratio(0)
+    , m_string_length(8)
+    , m_sortedness(0) {}
+
+t_generator_spec::t_generator_spec()
+    : m_seed(0)
+    , m_rows(0) {}
+
+t_data_generator::t_data_generator(
+    const t_generator_spec& spec, t_uindex num_keys, t_uindex num_batches)
+    : m_spec(spec)
+    , m_num_keys(num_keys)
+    , m_num_batches(num_batches)
+    , m_num_values(std::max(spec.m_rows, num_keys)) {}
+
+const t_generator_column&
+t_data_generator::get_column_spec(const std::string& name) const {
+    auto it = m_spec.m_columns.find(name);
+    return it == m_spec.m_columns.end() ? m_spec.m_default : it->second;
+}
+
+void
+t_data_generator::fill_column(t_column& column, const std::string& name, bool is_key,
+    const std::vector<t_uindex>& keys, t_uindex batch) const {
+    const t_generator_column& spec = get_column_spec(name);
+    std::uint64_t seed = mix(m_spec.m_seed ^ hash_name(name));
+    std::uint64_t batch_seed = mix(seed ^ batch);
+    std::string buf;
+
+    for (t_uindex ridx = 0; ridx < keys.size(); ++ridx) {
+        std::uint64_t key = keys[ridx];
+        if (is_key) {
+            set_value(column, ridx, key, spec.m_string_length, true, buf);
+            continue;
+        }
+
+        std::uint64_t h = mix(batch_seed ^ key);
+        if (spec.m_null_ratio > 0 && to_unit(mix(h ^ 1)) < spec.m_null_ratio) {
+            column.clear(ridx);
+            continue;
+        }
+
+        std::uint64_t idx;
+        bool sorted = spec.m_sortedness > 0 && to_unit(mix(h ^ 2)) < spec.m_sortedness;
+        if (sorted && spec.m_cardinality == 0) {
+            idx = key;
+        } else if (sorted) {
+            double position = static_cast<double>(key) / m_num_values;
+            idx = std::min<std::uint64_t>(
+                spec.m_cardinality - 1, static_cast<std::uint64_t>(position * spec.m_cardinality));
+        } else if (spec.m_cardinality == 0) {
+            idx = permute(key, m_num_values, batch_seed);
+        } else {
+            idx = h % spec.m_cardinality;
+        }
+
+        set_value(column, ridx, idx, spec.m_string_length, false, buf);
+    }
+}
+
+std::shared_ptr<t_data_table>
+t_data_generator::make_batch(const t_schema& schema, const std::string& index,
+    t_uindex num_inserts, t_uindex num_updates) {
+    PSP_TRACE_SENTINEL();
+    t_uindex nrows = num_inserts + num_updates;
+    t_uindex batch = m_num_batches++;
+    std::uint64_t batch_seed = mix(mix(m_spec.m_seed) ^ batch);
+
+    // Updates are spread evenly through the batch, and pick a key from
+    // those inserted before it; with none, they are inserts.
+    std::vector<t_uindex> keys(nrows);
+    t_uindex num_keys = m_num_keys;
+    for (t_uindex ridx = 0; ridx < nrows; ++ridx) {
+        bool is_update = num_keys > 0 && (ridx + 1) * num_updates / nrows > ridx * num_updates / nrows;
+        keys[ridx] = is_update ? mix(batch_seed ^ ridx) % num_keys : m_num_keys++;
+    }
+
+    m_num_values = std::max(m_spec.m_rows, m_num_keys);
+
+    auto data = std::make_shared<t_data_table>(schema);
+    data->init();
+    data->extend(nrows);
+
+    const std::vector<std::string>& names = schema.columns();
+    t_scheduler::current().parallel_for(names.size(), [&](t_uindex cidx) {
+        fill_column(*data->get_column(names[cidx]), names[cidx], names[cidx] == index, keys,
+            batch);
+    });
+
+    return data;
+}
+
+std::shared_ptr<t_data_table>
+t_data_generator::make_deletes(
+    const t_schema& schema, const std::string& index, t_uindex num_deletes) {
+    PSP_VERBOSE_ASSERT(index != "", "Cannot delete from a table without an index");
+    t_uindex batch = m_num_batches++;
+    std::uint64_t batch_seed = mix(mix(m_spec.m_seed) ^ batch);
+
+    std::vector<t_uindex> keys(m_num_keys > 0 ? num_deletes : 0);
+    for (t_uindex ridx = 0; ridx < keys.size(); ++ridx) {
+        keys[ridx] = mix(batch_seed ^ ridx) % m_num_keys;
+    }
+
+    auto data = std::make_shared<t_data_table>(
+        t_schema({index}, {schema.get_dtype(index)}));
+    data->init();
+    data->extend(keys.size());
+    fill_column(*data->get_column(index), index, true, keys, batch);
+    return data;
+}
+
+void
+t_data_generator::generate(std::shared_ptr<Table> table, t_uindex num_inserts,
+    t_uindex num_updates, t_uindex num_deletes, t_uindex port_id) {
+    const std::string& index = table->get_index();
+    if (index == "" && (num_updates > 0 || num_deletes > 0)) {
+        PSP_COMPLAIN_AND_ABORT("Cannot generate updates or deletes for a table without an index");
+    }
+
+    t_schema schema = table->get_schema().drop({"psp_okey"});
+
+    // Add the primary key columns as the bindings do.
+    auto send = [&](std::shared_ptr<t_data_table> data, t_op op) {
+        if (index == "") {
+            std::uint32_t offset = table->get_offset();
+            std::uint32_t limit = table->get_limit();
+            auto pkey = data->add_column("psp_pkey", DTYPE_INT32, true);
+            auto okey = data->add_column("psp_okey", DTYPE_INT32, true);
+            for (t_uindex ridx = 0; ridx < data->size(); ++ridx) {
+                pkey->set_nth<std::int32_t>(ridx, (ridx + offset) % limit);
+                okey->set_nth<std::int32_t>(ridx, (ridx + offset) % limit);
+            }
+        } else {
+            data->clone_column(index, "psp_pkey");
+            data->clone_column(index, "psp_okey");
+        }
+
+        t_uindex size = data->size();
+        table->init(std::move(data), size, op, port_id);
+    };
+
+    if (num_inserts + num_updates > 0) {
+        send(make_batch(schema, index, num_inserts, num_updates), OP_INSERT);
+    }
+
+    if (num_deletes > 0 && m_num_keys > 0) {
+        send(make_deletes(schema, index, num_deletes), OP_DELETE);
+    }
+}
+
+t_uindex
+t_data_generator::get_num_keys() const {
+    return m_num_keys;
+}
+
+t_uindex
+t_data_generator::get_num_batches() const {
+    return m_num_batches;
+}
+
+} // end namespace perspective
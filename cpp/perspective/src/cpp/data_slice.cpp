@@ -56,8 +56,19 @@ template <typename CTX_T>
 t_tscalar
 t_data_slice<CTX_T>::get(t_uindex ridx, t_uindex cidx) const {
     ridx += m_row_offset;
-    t_uindex idx = get_slice_idx(ridx, cidx);
     t_tscalar rv;
+    if (!m_columns.empty()) {
+        t_uindex row = ridx - m_start_row;
+        t_uindex col = cidx - m_start_col;
+        if (col >= m_columns.size() || row >= m_columns[col].size()) {
+            rv.clear();
+        } else {
+            rv = m_columns[col].get_scalar(row);
+        }
+        return rv;
+    }
+
+    t_uindex idx = get_slice_idx(ridx, cidx);
     if (idx >= m_slice.size()) {
         rv.clear();
     } else {
@@ -95,6 +106,12 @@ t_data_slice<CTX_T>::get_row_path(t_uindex ridx) const {
     return m_ctx->unity_get_row_path(ridx);
 }
 
+template <typename CTX_T>
+t_row_paths
+t_data_slice<CTX_T>::get_row_paths(t_uindex start_row, t_uindex end_row) const {
+    return m_ctx->unity_get_row_paths(start_row, end_row);
+}
+
 template <typename CTX_T>
 t_uindex
 t_data_slice<CTX_T>::num_rows() const {
@@ -139,6 +156,36 @@ t_data_slice<t_ctx2>::is_column_only() const {
     return config.is_column_only();
 }
 
+template <typename CTX_T>
+void
+t_data_slice<CTX_T>::set_snapshot(std::shared_ptr<const t_ctx_snapshot> snapshot) {
+    m_snapshot = snapshot;
+}
+
+template <typename CTX_T>
+std::shared_ptr<const t_ctx_snapshot>
+t_data_slice<CTX_T>::get_snapshot() const {
+    return m_snapshot;
+}
+
+template <typename CTX_T>
+void
+t_data_slice<CTX_T>::set_columns(std::vector<t_slice_column> columns) {
+    m_columns = std::move(columns);
+}
+
+template <typename CTX_T>
+bool
+t_data_slice<CTX_T>::has_columns() const {
+    return !m_columns.empty();
+}
+
+template <typename CTX_T>
+const t_slice_column&
+t_data_slice<CTX_T>::get_column(t_uindex cidx) const {
+    return m_columns.at(cidx - m_start_col);
+}
+
 template <typename CTX_T>
 t_uindex
 t_data_slice<CTX_T>::get_stride() const {
@@ -12,11 +12,16 @@
 #include <perspective/raw_types.h>
 #include <perspective/data_table.h>
 #include <perspective/column.h>
+#include <perspective/column_filter.h>
+#include <perspective/kernels.h>
 #include <perspective/storage.h>
 #include <perspective/scalar.h>
 #include <perspective/tracing.h>
 #include <perspective/utils.h>
 #include <perspective/logtime.h>
+#include <perspective/scheduler.h>
+#include <cstring>
+#include <set>
 #include <sstream>
 namespace perspective {
 
@@ -40,7 +45,8 @@ t_data_table::t_data_table(const t_schema& s, t_uindex init_cap)
     , m_schema(s)
     , m_size(0)
     , m_backing_store(BACKING_STORE_MEMORY)
-    , m_init(false) {
+    , m_init(false)
+    , m_alloc_owner(ALLOC_OWNER_OTHER) {
     PSP_TRACE_SENTINEL();
     LOG_CONSTRUCTOR("t_data_table");
     set_capacity(init_cap);
@@ -53,7 +59,8 @@ t_data_table::t_data_table(const std::string& name, const std::string& dirname,
     , m_schema(s)
     , m_size(0)
     , m_backing_store(backing_store)
-    , m_init(false) {
+    , m_init(false)
+    , m_alloc_owner(ALLOC_OWNER_OTHER) {
     PSP_TRACE_SENTINEL();
     LOG_CONSTRUCTOR("t_data_table");
     set_capacity(init_cap);
@@ -66,7 +73,8 @@ t_data_table::t_data_table(const t_schema& s, const std::vector<std::vector<t_ts
     , m_schema(s)
     , m_size(0)
     , m_backing_store(BACKING_STORE_MEMORY)
-    , m_init(false) {
+    , m_init(false)
+    , m_alloc_owner(ALLOC_OWNER_OTHER) {
     PSP_TRACE_SENTINEL();
     LOG_CONSTRUCTOR("t_data_table");
     auto ncols = s.size();
@@ -104,21 +112,13 @@ t_data_table::init() {
     LOG_INIT("t_data_table");
     m_columns = std::vector<std::shared_ptr<t_column>>(m_schema.size());
 
-#ifdef PSP_PARALLEL_FOR
-    tbb::parallel_for(0, int(m_schema.size()), 1,
-        [this](int idx)
-#else
-    for (t_uindex idx = 0, loop_end = m_schema.size(); idx < loop_end; ++idx)
-#endif
-        {
+    t_scheduler::current().parallel_for(m_schema.size(),
+        [this](t_uindex idx) {
             const std::string& colname = m_schema.m_columns[idx];
             t_dtype dtype = m_schema.m_types[idx];
             m_columns[idx] = make_column(colname, dtype, m_schema.m_status_enabled[idx]);
             m_columns[idx]->init();
-        }
-#ifdef PSP_PARALLEL_FOR
-    );
-#endif
+        });
 
     m_init = true;
 }
@@ -127,9 +127,25 @@ std::shared_ptr<t_column>
 t_data_table::make_column(const std::string& colname, t_dtype dtype, bool status_enabled) {
     t_lstore_recipe a(m_dirname, m_name + std::string("_") + colname,
         m_capacity * get_dtype_size(dtype), m_backing_store);
+    a.m_alloc_owner = m_alloc_owner;
     return std::make_shared<t_column>(dtype, status_enabled, a, m_capacity);
 }
 
+void
+t_data_table::set_alloc_owner(t_alloc_owner owner) {
+    m_alloc_owner = owner;
+    for (auto& column : m_columns) {
+        if (column) {
+            column->set_alloc_owner(owner);
+        }
+    }
+}
+
+t_alloc_owner
+t_data_table::get_alloc_owner() const {
+    return m_alloc_owner;
+}
+
 t_uindex
 t_data_table::num_columns() const {
     PSP_TRACE_SENTINEL();
@@ -279,6 +295,15 @@ t_data_table::set_size(t_uindex size) {
     m_size = size;
 }
 
+void
+t_data_table::set_size(t_uindex size, const std::vector<std::string>& columns) {
+    PSP_TRACE_SENTINEL();
+    for (const std::string& name : columns) {
+        _get_column(name)->set_size(size);
+    }
+    m_size = size;
+}
+
 void
 t_data_table::reserve(t_uindex capacity) {
     PSP_TRACE_SENTINEL();
@@ -289,6 +314,15 @@ t_data_table::reserve(t_uindex capacity) {
     set_capacity(std::max(capacity, m_capacity));
 }
 
+void
+t_data_table::reserve(t_uindex capacity, const std::vector<std::string>& columns) {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    for (const std::string& name : columns) {
+        _get_column(name)->reserve(capacity);
+    }
+}
+
 t_column*
 t_data_table::_get_column(const std::string& colname) {
     PSP_TRACE_SENTINEL();
@@ -312,10 +346,71 @@ t_data_table::flatten() const {
     std::shared_ptr<t_data_table> flattened = std::make_shared<t_data_table>(
         "", "", m_schema, DEFAULT_EMPTY_CAPACITY, BACKING_STORE_MEMORY);
     flattened->init();
+    PSP_VERBOSE_ASSERT(is_same_shape(*flattened), "Misaligned shaped found");
     flatten_body<std::shared_ptr<t_data_table>>(flattened);
     return flattened;
 }
 
+void
+t_data_table::flatten_into(std::shared_ptr<t_data_table> flattened) const {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    PSP_VERBOSE_ASSERT(is_pkey_table(), "Not a pkeyed table");
+    PSP_VERBOSE_ASSERT(flattened->size() == 0, "Cannot flatten into a non-empty table");
+
+    const t_schema& flattened_schema = flattened->get_schema();
+    PSP_VERBOSE_ASSERT(flattened_schema.size() >= m_schema.size(), "Misaligned shaped found");
+    for (t_uindex idx = 0, loop_end = m_schema.size(); idx < loop_end; ++idx) {
+        PSP_VERBOSE_ASSERT(flattened_schema.m_columns[idx] == m_schema.m_columns[idx]
+                && flattened_schema.m_types[idx] == m_schema.m_types[idx],
+            "Misaligned shaped found");
+    }
+
+    flatten_body<std::shared_ptr<t_data_table>>(flattened);
+}
+
+bool
+t_data_table::is_flattened() const {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    PSP_VERBOSE_ASSERT(is_pkey_table(), "Not a pkeyed table");
+
+    switch (get_const_column("psp_pkey")->get_dtype()) {
+        case DTYPE_INT64:
+        case DTYPE_TIME: return is_flattened_helper<std::int64_t>();
+        case DTYPE_INT32: return is_flattened_helper<std::int32_t>();
+        case DTYPE_INT16: return is_flattened_helper<std::int16_t>();
+        case DTYPE_INT8: return is_flattened_helper<std::int8_t>();
+        case DTYPE_UINT64: return is_flattened_helper<std::uint64_t>();
+        case DTYPE_UINT32:
+        case DTYPE_DATE: return is_flattened_helper<std::uint32_t>();
+        case DTYPE_UINT16: return is_flattened_helper<std::uint16_t>();
+        case DTYPE_UINT8: return is_flattened_helper<std::uint8_t>();
+        case DTYPE_STR: return is_flattened_helper<t_stridx>();
+        case DTYPE_FLOAT64: return is_flattened_helper<double>();
+        case DTYPE_FLOAT32: return is_flattened_helper<float>();
+        default: return false;
+    }
+}
+
+template <typename PKEY_T>
+bool
+t_data_table::is_flattened_helper() const {
+    const t_column* pkey_col = get_const_column("psp_pkey").get();
+    const std::uint8_t* ops = get_const_column("psp_op")->get_nth<std::uint8_t>(0);
+    const PKEY_T* pkeys = pkey_col->get_nth<PKEY_T>(0);
+
+    // String keys compare by their vocabulary index, as `flatten` sorts them.
+    for (t_uindex idx = 0, loop_end = size(); idx < loop_end; ++idx) {
+        if (ops[idx] != OP_INSERT || !pkey_col->is_valid(idx)
+            || (idx > 0 && !(pkeys[idx - 1] < pkeys[idx]))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 bool
 t_data_table::is_pkey_table() const {
     PSP_TRACE_SENTINEL();
@@ -434,22 +529,20 @@ t_data_table::append(const t_data_table& other) {
     }
     t_uindex other_size = other.num_rows();
 
+    // Every column is grown once, rather than as it is appended to.
+    if (cursize + other_size > m_capacity) {
+        reserve(cursize + other_size);
+    }
+
     for (const auto& cname : m_schema.m_columns) {
         if (incoming.find(cname) == incoming.end()) {
             get_column(cname)->extend_dtype(cursize + other_size);
         }
     }
 
-#ifdef PSP_PARALLEL_FOR
-    tbb::parallel_for(0, int(src_cols.size()), 1,
-        [&src_cols, dst_cols](int colidx)
-#else
-    for (t_uindex colidx = 0, loop_end = src_cols.size(); colidx < loop_end; ++colidx)
-#endif
-        { dst_cols[colidx]->append(*(src_cols[colidx])); }
-#ifdef PSP_PARALLEL_FOR
-    );
-#endif
+    t_scheduler::current().parallel_for(src_cols.size(), [&src_cols, dst_cols](t_uindex colidx) {
+        dst_cols[colidx]->append(*(src_cols[colidx]));
+    });
     set_capacity(std::max(m_capacity, m_size + other.num_rows()));
     set_size(m_size + other.num_rows());
 }
@@ -464,12 +557,23 @@ t_data_table::clear() {
     m_size = 0;
 }
 
+void
+t_data_table::recycle() {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    for (t_uindex idx = 0, loop_end = m_columns.size(); idx < loop_end; ++idx) {
+        m_columns[idx]->clear();
+        m_columns[idx]->clear_vocabulary();
+    }
+    m_size = 0;
+}
+
 t_mask
 t_data_table::filter_cpp(t_filter_op combiner, const std::vector<t_fterm>& fterms_) const {
+    PSP_TRACE_SPAN("filter");
     auto self = const_cast<t_data_table*>(this);
     auto fterms = fterms_;
 
-    t_mask mask(size());
     t_uindex fterm_size = fterms.size();
     std::vector<t_uindex> indices(fterm_size);
     std::vector<const t_column*> columns(fterm_size);
@@ -486,54 +590,53 @@ t_data_table::filter_cpp(t_filter_op combiner, const std::vector<t_fterm>& fterm
         }
     }
 
-    switch (combiner) {
-        case FILTER_OP_AND: {
-            t_tscalar cell_val;
-
-            for (t_uindex ridx = 0, rloop_end = size(); ridx < rloop_end; ++ridx) {
-                bool pass = true;
-
-                for (t_uindex cidx = 0; cidx < fterm_size; ++cidx) {
-                    if (!pass)
-                        break;
-
-                    const auto& ft = fterms[cidx];
-                    bool tval;
-
-                    if (ft.m_use_interned) {
-                        cell_val.set(*(columns[cidx]->get_nth<t_uindex>(ridx)));
-                        tval = ft(cell_val);
-                    } else {
-                        cell_val = columns[cidx]->get_scalar(ridx);
-                        tval = ft(cell_val);
-                    }
+    return filter_columns(columns, fterms, combiner, size());
+}
 
-                    if ((ft.m_op != FILTER_OP_IS_NULL && !cell_val.is_valid()) || !tval) {
-                        pass = false;
-                        break;
-                    }
-                }
+// Writes whether each row of `tbl` passes `fexpr` into `out`. Under an
+// `and` group, as under `FILTER_OP_AND`, invalid values fail every term
+// other than `FILTER_OP_IS_NULL`.
+static void
+filter_expr_rows(const t_data_table& tbl, const t_fexpr& fexpr, bool fail_invalid,
+    std::uint8_t* out) {
+    t_uindex nrows = tbl.size();
+    switch (fexpr.m_type) {
+        case FEXPR_TERM: {
+            const t_column* column = tbl.get_const_column(fexpr.m_term.m_colname).get();
 
-                mask.set(ridx, pass);
-            }
+            // Strings are looked up in the column's vocabulary rather than
+            // interned, so they compare the same way in either group.
+            t_fterm fterm = fexpr.m_term;
+            fterm.m_use_interned = false;
+            fterm.coerce_numeric(column->get_dtype());
+            filter_column(*column, fterm, fail_invalid, nrows, out);
+        } break;
+        case FEXPR_COLUMNS: {
+            filter_column_pair(*tbl.get_const_column(fexpr.m_term.m_colname),
+                fexpr.m_term.m_op, *tbl.get_const_column(fexpr.m_other_colname), nrows, out);
         } break;
-        case FILTER_OP_OR: {
-            for (t_uindex ridx = 0, rloop_end = size(); ridx < rloop_end; ++ridx) {
-                bool pass = false;
-                for (t_uindex cidx = 0; cidx < fterm_size; ++cidx) {
-                    t_tscalar cell_val = columns[cidx]->get_scalar(ridx);
-                    if (fterms[cidx](cell_val)) {
-                        pass = true;
-                        break;
-                    }
+        case FEXPR_GROUP: {
+            bool is_and = fexpr.m_combiner == FILTER_OP_AND;
+            std::memset(out, is_and ? 1 : 0, nrows);
+            std::vector<std::uint8_t> child(nrows);
+            for (const t_fexpr& expr : fexpr.m_children) {
+                filter_expr_rows(tbl, expr, is_and, child.data());
+                if (is_and) {
+                    kernel_and(out, child.data(), nrows);
+                } else {
+                    kernel_or(out, child.data(), nrows);
                 }
-                mask.set(ridx, pass);
             }
         } break;
-        default: { PSP_COMPLAIN_AND_ABORT("Unknown filter op"); } break;
     }
+}
 
-    return mask;
+t_mask
+t_data_table::filter_expr(const t_fexpr& fexpr) const {
+    PSP_TRACE_SPAN("filter");
+    std::vector<std::uint8_t> rval(size());
+    filter_expr_rows(*this, fexpr, true, rval.data());
+    return t_mask(rval.data(), size());
 }
 
 t_uindex
@@ -541,6 +644,27 @@ t_data_table::get_capacity() const {
     return m_capacity;
 }
 
+t_uindex
+t_data_table::nbytes() const {
+    t_uindex rv = 0;
+    for (const auto& column : m_columns) {
+        rv += column->nbytes();
+    }
+    return rv;
+}
+
+t_uindex
+t_data_table::vocab_nbytes() const {
+    std::set<const t_vocab*> seen;
+    t_uindex rv = 0;
+    for (const auto& column : m_columns) {
+        if (column->is_vlen() && seen.insert(column->_get_vocab()).second) {
+            rv += column->_get_vocab()->nbytes();
+        }
+    }
+    return rv;
+}
+
 t_data_table*
 t_data_table::clone_(const t_mask& mask) const {
     PSP_TRACE_SENTINEL();
@@ -548,6 +672,7 @@ t_data_table::clone_(const t_mask& mask) const {
     t_schema schema = m_schema;
 
     t_data_table* rval = new t_data_table("", "", schema, 5, BACKING_STORE_MEMORY);
+    rval->set_alloc_owner(m_alloc_owner);
     rval->init();
 
     for (const auto& cname : schema.m_columns) {
@@ -572,6 +697,7 @@ t_data_table::clone() const {
     PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
     t_schema schema = m_schema;
     auto rval = std::make_shared<t_data_table>("", "", schema, 5, BACKING_STORE_MEMORY);
+    rval->set_alloc_owner(m_alloc_owner);
     rval->init();
 
     for (const auto& cname : schema.m_columns) {
@@ -603,6 +729,28 @@ t_data_table::borrow(const std::vector<std::string>& columns) const {
     return rval;
 }
 
+std::shared_ptr<t_data_table>
+t_data_table::snapshot(const std::vector<std::string>& columns) {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    std::vector<t_dtype> dtypes;
+
+    for (const auto& col : columns) {
+        dtypes.push_back(m_schema.get_dtype(col));
+    }
+
+    t_schema snapshot_schema = t_schema(columns, dtypes);
+    auto rval = std::make_shared<t_data_table>("", "", snapshot_schema, 5, BACKING_STORE_MEMORY);
+    rval->init();
+
+    for (const auto& cname : snapshot_schema.m_columns) {
+        rval->set_column(cname, get_column(cname)->snapshot());
+    }
+
+    rval->set_size(size());
+    return rval;
+}
+
 std::shared_ptr<t_column>
 t_data_table::add_column_sptr(const std::string& name, t_dtype dtype, bool status_enabled) {
     PSP_TRACE_SENTINEL();
@@ -637,6 +785,35 @@ t_data_table::drop_column(const std::string& name) {
     }
 }
 
+void
+t_data_table::reindex(const std::vector<std::string>& dropped_columns) {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+
+    std::set<std::string> dropped;
+    for (const std::string& name : dropped_columns) {
+        if (m_schema.has_column(name)) {
+            dropped.insert(name);
+        }
+    }
+
+    if (dropped.empty()) {
+        return;
+    }
+
+    std::vector<std::shared_ptr<t_column>> columns;
+    columns.reserve(m_columns.size() - dropped.size());
+
+    for (t_uindex idx = 0, loop_end = m_columns.size(); idx < loop_end; ++idx) {
+        if (dropped.count(m_schema.m_columns[idx]) == 0) {
+            columns.push_back(m_columns[idx]);
+        }
+    }
+
+    m_columns = std::move(columns);
+    m_schema = m_schema.drop(dropped);
+}
+
 void
 t_data_table::promote_column(
     const std::string& name, t_dtype new_dtype, std::int32_t iter_limit, bool fill) {
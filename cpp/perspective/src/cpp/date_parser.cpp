@@ -42,4 +42,22 @@ t_date_parser::is_valid(std::string const& datestring) {
     }
     return false;
 }
+
+bool
+t_date_parser::parse(std::string const& datestring, std::tm& out, bool& has_time) const {
+    for (const std::string& fmt : VALID_FORMATS) {
+        if (fmt != "") {
+            std::tm t = {};
+            std::stringstream ss(datestring);
+            ss.imbue(std::locale::classic());
+            ss >> std::get_time(&t, fmt.c_str());
+            if (!ss.fail()) {
+                out = t;
+                has_time = fmt.find("%H") != std::string::npos;
+                return true;
+            }
+        }
+    }
+    return false;
+}
 } // end namespace perspective
\ No newline at end of file
@@ -9,6 +9,7 @@
 
 #include <perspective/first.h>
 #include <iomanip>
+#include <set>
 #include <perspective/dense_tree_context.h>
 #include <perspective/dependency.h>
 #include <perspective/schema.h>
@@ -27,6 +28,22 @@ t_dtree_ctx::t_dtree_ctx(std::shared_ptr<const t_data_table> strands,
 
     m_aggspecs.push_back(t_aggspec("psp_strand_count_sum", AGGTYPE_SUM, depvec));
 
+    // Sum the running numerator/denominator columns of the strand deltas,
+    // which t_stree applies to its MEAN and WEIGHTED_MEAN aggregates.
+    std::set<std::string> running_colnames;
+    for (const auto& spec : aggspecs) {
+        if (!spec.is_running_agg()) {
+            continue;
+        }
+
+        for (const auto& colname : {spec.get_running_nr_name(), spec.get_running_dr_name()}) {
+            if (running_colnames.insert(colname).second) {
+                std::vector<t_dep> running_depvec = {t_dep(colname, DEPTYPE_COLUMN)};
+                m_aggspecs.push_back(t_aggspec(colname, AGGTYPE_SUM, running_depvec));
+            }
+        }
+    }
+
     t_uindex aggidx = 0;
     for (const auto& spec : m_aggspecs) {
         m_aggspecmap[spec.name()] = aggidx;
@@ -238,7 +255,7 @@ t_dtree_ctx::pprint_strands_tree() const {
 
     for (const auto& piv : m_tree.get_pivots()) {
         columns.push_back(t_colname_cptr_pair(
-            piv.colname(), m_strands->get_const_column(piv.colname()).get()));
+            piv.name(), m_strands->get_const_column(piv.name()).get()));
     }
 
     for (auto dptidx : m_tree.dfs()) {
@@ -10,6 +10,7 @@
 #include <perspective/emscripten.h>
 #include <perspective/arrow_loader.h>
 #include <perspective/arrow_writer.h>
+#include <perspective/json_loader.h>
 
 using namespace emscripten;
 using namespace perspective;
@@ -127,6 +128,17 @@ namespace binding {
         return vecFromJSArray<U>(arr);
     }
 
+    /**
+     * @brief The offset of `ptr` in the WebAssembly heap as a Javascript
+     * number. In a `PSP_WASM_MEMORY64` build a `uintptr_t` crosses into
+     * Javascript as a `BigInt`, which typed arrays do not take as an offset;
+     * a double holds any offset of a heap below 2^53 bytes exactly.
+     */
+    double
+    heap_offset(const void* ptr) {
+        return static_cast<double>(reinterpret_cast<std::uintptr_t>(ptr));
+    }
+
     /**
      * Converts a std::vector<T> to a Typed Array, slicing directly from the
      * WebAssembly heap.
@@ -134,24 +146,21 @@ namespace binding {
     template <typename T>
     t_val
     vector_to_typed_array(std::vector<T>& xs) {
-        T* st = &xs[0];
-        uintptr_t offset = reinterpret_cast<uintptr_t>(st);
+        double offset = heap_offset(&xs[0]);
         return t_val::module_property("HEAPU8").call<t_val>(
             "slice", offset, offset + (sizeof(T) * xs.size()));
     }
 
     t_val
     to_arraybuffer(std::shared_ptr<std::vector<uint8_t>> xs) {
-        uint8_t* st = &(*xs)[0];
-        uintptr_t offset = reinterpret_cast<uintptr_t>(st);
+        double offset = heap_offset(&(*xs)[0]);
         return t_val::module_property("HEAPU8").call<t_val>(
             "slice", offset, offset + (sizeof(uint8_t) * xs->size()));
     }
 
     t_val
     str_to_arraybuffer(std::shared_ptr<std::string> str) {
-        char* start = &(*str)[0];
-        uintptr_t offset = reinterpret_cast<uintptr_t>(start);
+        double offset = heap_offset(&(*str)[0]);
         return t_val::module_property("HEAPU8").call<t_val>(
             "slice", offset, offset + (sizeof(char) * str->size()));
     }
@@ -166,6 +175,33 @@ namespace binding {
         return str_to_arraybuffer(s)["buffer"];
     }
 
+    template <typename CTX_T>
+    void
+    to_arrow_chunked(
+        std::shared_ptr<View<CTX_T>> view, std::int32_t start_row,
+        std::int32_t end_row, std::int32_t start_col, std::int32_t end_col,
+        std::int32_t chunk_size, t_val callback) {
+        view->to_arrow_chunked(start_row, end_row, start_col, end_col, chunk_size,
+            [&callback](std::shared_ptr<std::string> s) {
+                callback(str_to_arraybuffer(s)["buffer"]);
+            });
+    }
+
+    /**
+     * @brief The next `page_size` rows of the cursor `cursor_id` as an Arrow
+     * `ArrayBuffer`, or `undefined` once the cursor has passed the last row.
+     */
+    template <typename CTX_T>
+    t_val
+    cursor_to_arrow(std::shared_ptr<View<CTX_T>> view, std::int32_t cursor_id,
+        std::int32_t page_size) {
+        std::shared_ptr<std::string> s = view->cursor_to_arrow(cursor_id, page_size);
+        if (s == nullptr) {
+            return t_val::undefined();
+        }
+        return str_to_arraybuffer(s)["buffer"];
+    }
+
     template <typename CTX_T>
     t_val
     get_row_delta(
@@ -174,6 +210,89 @@ namespace binding {
         auto row_delta = view->data_slice_to_arrow(slice);
         return str_to_arraybuffer(row_delta)["buffer"];
     }
+
+    /**
+     * @brief The cells of `view` changed by the last update, in its viewport
+     * if one is set, grouped by column: an object with `rows_changed`, and
+     * `columns`, which has for each changed column its index in the view,
+     * the `ranges` of rows changed as `[start, end, start, end, ...]` and the
+     * new `values` of those rows in order.
+     */
+    template <typename CTX_T>
+    t_val
+    get_cell_diff(std::shared_ptr<View<CTX_T>> view) {
+        t_stepdelta delta
+            = view->get_step_delta(0, std::numeric_limits<std::int32_t>::max());
+        std::vector<t_cellupd>& cells = delta.cells;
+        std::stable_sort(cells.begin(), cells.end(), [](const t_cellupd& a, const t_cellupd& b) {
+            return a.column < b.column || (a.column == b.column && a.row < b.row);
+        });
+
+        t_val columns = t_val::array();
+        t_uindex ncolumns = 0;
+        for (t_uindex begin = 0, end = 0; begin < cells.size(); begin = end) {
+            std::int32_t column = cells[begin].column;
+            t_val ranges = t_val::array();
+            t_val values = t_val::array();
+            t_uindex nranges = 0;
+            t_uindex nvalues = 0;
+            std::int32_t start = cells[begin].row;
+            std::int32_t prev = start;
+
+            for (end = begin; end < cells.size() && cells[end].column == column; ++end) {
+                const t_cellupd& cell = cells[end];
+
+                // A cell changed twice has its latest value.
+                if (end > begin && cell.row == prev) {
+                    values.set(nvalues - 1, scalar_to_val(cell.new_value));
+                    continue;
+                }
+
+                if (cell.row != prev + 1 && end > begin) {
+                    ranges.set(nranges++, start);
+                    ranges.set(nranges++, prev + 1);
+                    start = cell.row;
+                }
+
+                prev = cell.row;
+                values.set(nvalues++, scalar_to_val(cell.new_value));
+            }
+
+            ranges.set(nranges++, start);
+            ranges.set(nranges++, prev + 1);
+
+            t_val diff = t_val::object();
+            diff.set("column", column);
+            diff.set("ranges", ranges);
+            diff.set("values", values);
+            columns.set(ncolumns++, diff);
+        }
+
+        t_val rval = t_val::object();
+        rval.set("rows_changed", delta.rows_changed);
+        rval.set("columns", columns);
+        return rval;
+    }
+
+    template <typename CTX_T>
+    t_val
+    get_histogram(std::shared_ptr<View<CTX_T>> view, std::string column_name,
+        std::uint32_t nbuckets, bool quantile, std::int32_t ridx) {
+        t_binning binning = quantile ? BINNING_QUANTILE : BINNING_FIXED_WIDTH;
+        t_histogram histogram = view->get_histogram(column_name, nbuckets, binning, ridx);
+
+        t_val arr = t_val::array();
+        for (t_uindex idx = 0, loop_end = histogram.m_buckets.size(); idx < loop_end; ++idx) {
+            const t_hist_bucket& bucket = histogram.m_buckets[idx];
+            t_val item = t_val::object();
+            item.set("begin", scalar_to_val(bucket.m_begin));
+            item.set("end", scalar_to_val(bucket.m_end));
+            item.set("count", bucket.m_count);
+            arr.set(idx, item);
+        }
+
+        return arr;
+    }
     
     /******************************************************************************
      *
@@ -187,8 +306,7 @@ namespace binding {
             const t_val& typedArray, void* data, std::int32_t length, const char* destType) {
             t_val constructor = destType == nullptr ? typedArray["constructor"] : t_val::global(destType);
             t_val memory = t_val::module_property("HEAP8")["buffer"];
-            std::uintptr_t ptr = reinterpret_cast<std::uintptr_t>(data);
-            t_val memoryView = constructor.new_(memory, ptr, length);
+            t_val memoryView = constructor.new_(memory, heap_offset(data), length);
             t_val slice = typedArray.call<t_val>("slice", 0, length);
             memoryView.call<void>("set", slice);
         }
@@ -230,6 +348,7 @@ namespace binding {
             std::uint32_t dsize = dictvec["length"].as<std::uint32_t>();
 
             t_vocab* vocab = col->_get_vocab();
+            vocab->reserve_additional(offsets[dsize] - offsets[0] + dsize, dsize);
             std::string elem;
 
             for (std::uint32_t i = 0; i < dsize; ++i) {
@@ -476,6 +595,123 @@ namespace binding {
         }
     }
 
+    /**
+     * @brief Copy `nbytes` from `data` out of the WASM heap into a new (and
+     * so transferable) `ArrayBuffer`, viewed as a typed array of `T`.
+     */
+    template <typename T>
+    t_val
+    heap_to_typed_array(const void* data, t_uindex nbytes) {
+        double offset = heap_offset(data);
+        t_val bytes = t_val::module_property("HEAPU8").call<t_val>(
+            "slice", offset, offset + nbytes);
+        return typed_array<T>.new_(bytes["buffer"]);
+    }
+
+    /**
+     * @brief Build the typed array `col_to_js_typed_array` would from the
+     * scalars of `col`, from its buffer instead, or return undefined if
+     * `col_to_js_typed_array` represents a column of `dtype` differently.
+     */
+    t_val
+    slice_column_to_js_typed_array(const t_slice_column& col, t_dtype dtype) {
+        t_uindex data_size = col.size();
+        t_val values;
+        switch (dtype) {
+            case DTYPE_INT8: {
+                values = heap_to_typed_array<std::int8_t>(
+                    col.get_values<std::int8_t>(), data_size);
+            } break;
+            case DTYPE_INT16: {
+                values = heap_to_typed_array<std::int16_t>(
+                    col.get_values<std::int16_t>(), data_size * sizeof(std::int16_t));
+            } break;
+            case DTYPE_INT32:
+            case DTYPE_UINT32: {
+                values = heap_to_typed_array<std::uint32_t>(
+                    col.get_values<std::uint32_t>(), data_size * sizeof(std::uint32_t));
+            } break;
+            case DTYPE_FLOAT32: {
+                values = heap_to_typed_array<float>(
+                    col.get_values<float>(), data_size * sizeof(float));
+            } break;
+            case DTYPE_FLOAT64: {
+                values = heap_to_typed_array<double>(
+                    col.get_values<double>(), data_size * sizeof(double));
+            } break;
+            case DTYPE_TIME: {
+                // Each 64 bit timestamp as a pair of 32 bit words.
+                values = heap_to_typed_array<std::int32_t>(
+                    col.get_values<std::int64_t>(), data_size * sizeof(std::int64_t));
+            } break;
+            case DTYPE_DATE: {
+                const t_date::t_rawtype* raw = col.get_values<t_date::t_rawtype>();
+                std::vector<std::uint64_t> dates(raw, raw + data_size);
+                values = heap_to_typed_array<std::int32_t>(
+                    dates.data(), data_size * sizeof(std::uint64_t));
+            } break;
+            case DTYPE_INT64: {
+                const std::int64_t* raw = col.get_values<std::int64_t>();
+                std::vector<std::int32_t> ints(raw, raw + data_size);
+                values = heap_to_typed_array<std::int32_t>(
+                    ints.data(), data_size * sizeof(std::int32_t));
+            } break;
+            default: {
+                return t_val::undefined();
+            }
+        }
+
+        // Validity map must have a length that is a multiple of 64
+        int nullSize = ceil(data_size / 64.0) * 2;
+        int nullCount = 0;
+        std::vector<std::uint32_t> validityMap;
+        validityMap.resize(nullSize);
+        for (t_uindex idx = 0; idx < data_size; idx++) {
+            if (col.is_valid(idx)) {
+                validityMap[idx / 32] |= 1u << (idx % 32);
+            } else {
+                nullCount++;
+            }
+        }
+
+        t_val arr = t_val::global("Array").new_();
+        arr.call<void>("push", values);
+        arr.call<void>("push", nullCount);
+        arr.call<void>("push", vector_to_typed_array(validityMap));
+        return arr;
+    }
+
+    /**
+     * @brief Read the column at `cidx` of `view` for rows `start_row` to
+     * `end_row` as a typed array, as `col_to_js_typed_array` does, straight
+     * from the table's column when the view is not aggregated.
+     */
+    template <typename CTX_T>
+    t_val
+    view_col_to_js_typed_array(std::shared_ptr<View<CTX_T>> view, std::uint32_t start_row,
+        std::uint32_t end_row, std::uint32_t cidx) {
+        t_dtype dtype = view->get_column_dtype(cidx);
+        std::shared_ptr<t_slice_column> col = view->get_column(start_row, end_row, cidx);
+        if (col && col->get_dtype() == dtype) {
+            t_val arr = slice_column_to_js_typed_array(*col, dtype);
+            if (!arr.isUndefined()) {
+                return arr;
+            }
+        }
+
+        auto data_slice = view->get_data(start_row, end_row, cidx, cidx + 1);
+        if (!data_slice->has_columns()) {
+            return col_to_js_typed_array(data_slice->get_slice(), dtype, cidx);
+        }
+
+        const t_slice_column& column = data_slice->get_column(cidx);
+        std::vector<t_tscalar> data(column.size());
+        for (t_uindex idx = 0; idx < data.size(); ++idx) {
+            data[idx] = column.get_scalar(idx);
+        }
+        return col_to_js_typed_array(data, dtype, cidx);
+    }
+
     /******************************************************************************
      *
      * Data accessor API
@@ -930,7 +1166,20 @@ namespace binding {
 
     std::map<std::string, std::map<std::string, std::string>>
     get_computed_functions() {
-        return t_computed_column::computed_functions;
+        return t_computed_column::get_computed_functions();
+    }
+
+    /**
+     * @brief Returns whether the engine was built with pthreads, and so runs
+     * its parallel paths on a pool of Web Workers.
+     */
+    bool
+    is_threaded() {
+#ifdef PSP_PARALLEL_FOR
+        return true;
+#else
+        return false;
+#endif
     }
 
     /******************************************************************************
@@ -1040,13 +1289,18 @@ namespace binding {
         std::vector<std::string> column_names;
         std::vector<t_dtype> data_types;
         arrow::ArrowLoader loader;
+        json::JsonLoader json_loader;
         std::uintptr_t ptr;
 
+        // A binary may hold JSON text instead of Arrow, which is parsed
+        // without crossing into Javascript for each value.
+        bool is_json = false;
+
         // Determine metadata
         bool is_delete = op == OP_DELETE;
         if (is_arrow && !is_delete) {
             t_val constructor = accessor["constructor"];
-            std::int32_t length = accessor["byteLength"].as<std::int32_t>();
+            std::uint32_t length = accessor["byteLength"].as<std::uint32_t>();
 
             // Allocate memory 
             ptr = reinterpret_cast<std::uintptr_t>(malloc(length));
@@ -1057,14 +1311,30 @@ namespace binding {
 
             // Write to the C++ heap where we allocated the space
             t_val memory = t_val::module_property("HEAP8")["buffer"];
-            t_val memoryView = constructor.new_(memory, ptr, length);
+            t_val memoryView
+                = constructor.new_(memory, heap_offset(reinterpret_cast<void*>(ptr)), length);
             memoryView.call<void>("set", accessor);
 
-            // Parse the arrow and get its metadata
-            loader.initialize(ptr, length);
-            
-            // Always use the `Table` column names and data types on up
-            if (table_initialized && is_update) {
+            is_json = json::is_json(reinterpret_cast<const char*>(ptr), length);
+            if (is_json) {
+                json_loader.initialize(reinterpret_cast<const char*>(ptr), length);
+            } else {
+                // Parse the arrow and get its metadata. The loader frees
+                // `ptr` once no column borrows from it.
+                loader.initialize(ptr, length, true);
+            }
+
+            // Always use the `Table` column names and data types on update.
+            if (is_json) {
+                if (table_initialized && is_update) {
+                    auto schema = gnode->get_output_schema().drop({"psp_okey"});
+                    column_names = schema.columns();
+                    data_types = schema.types();
+                } else {
+                    column_names = json_loader.names();
+                    data_types = json_loader.types();
+                }
+            } else if (table_initialized && is_update) {
                 auto gnode_output_schema = gnode->get_output_schema();
                 auto schema = gnode_output_schema.drop({"psp_okey"});
                 column_names = schema.columns();
@@ -1144,30 +1414,86 @@ namespace binding {
         t_schema output_schema(column_names, data_types); // names + types might have been mutated at this point after implicit index removal
 
         std::uint32_t row_count = 0;
-        if (is_arrow) {
+        if (is_json) {
+            row_count = json_loader.row_count();
+        } else if (is_arrow) {
             row_count = loader.row_count();
         } else {
             row_count = accessor["row_count"].as<std::int32_t>();
         }
 
-        t_data_table data_table(output_schema);
-        data_table.init();
-        data_table.extend(row_count);
-        if (is_arrow) {
-            loader.fill_table(data_table, index, offset, limit, is_update);
-        } else {
-            _fill_data(data_table, accessor, input_schema, index, offset, limit, is_update);
-        }
-
-        if (is_arrow) {
+        auto data_table = std::make_shared<t_data_table>(output_schema);
+        data_table->init();
+        data_table->extend(row_count);
+        if (is_json) {
+            json_loader.fill_table(*data_table, index, offset, limit, is_update);
+            // JSON is copied into the table, unlike Arrow, which may be
+            // borrowed and is freed by the loader.
             free((void *)ptr);
+        } else if (is_arrow) {
+            // Decimals are loaded as fixed-point columns, and updates are
+            // rescaled to the scale of the table's columns.
+            if (table_initialized) {
+                loader.set_scales(tbl->get_column_scales());
+            } else {
+                for (const auto& scale : loader.scales()) {
+                    if (scale.first != "__INDEX__") {
+                        tbl->set_column_scale(scale.first, scale.second);
+                    }
+                }
+            }
+            loader.fill_table(*data_table, index, offset, limit, is_update);
+        } else {
+            _fill_data(*data_table, accessor, input_schema, index, offset, limit, is_update);
         }
 
         // calculate offset, limit, and set the gnode
-        tbl->init(data_table, row_count, op, port_id);
+        tbl->init(std::move(data_table), row_count, op, port_id);
         return tbl;
     }
 
+#ifndef PSP_WASM_LEAN
+    namespace {
+        void
+        read_generator_column(t_val spec, t_generator_column& column) {
+            if (has_value(spec["cardinality"])) {
+                column.m_cardinality = spec["cardinality"].as<double>();
+            }
+            if (has_value(spec["null_ratio"])) {
+                column.m_null_ratio = spec["null_ratio"].as<double>();
+            }
+            if (has_value(spec["string_length"])) {
+                column.m_string_length = spec["string_length"].as<double>();
+            }
+            if (has_value(spec["sortedness"])) {
+                column.m_sortedness = spec["sortedness"].as<double>();
+            }
+        }
+    } // namespace
+
+    template <>
+    std::shared_ptr<t_data_generator>
+    make_data_generator(t_val spec, t_uindex num_keys, t_uindex num_batches) {
+        t_generator_spec generator_spec;
+        if (has_value(spec["seed"])) {
+            generator_spec.m_seed = spec["seed"].as<double>();
+        }
+        if (has_value(spec["rows"])) {
+            generator_spec.m_rows = spec["rows"].as<double>();
+        }
+
+        t_val columns = spec["columns"];
+        if (has_value(columns)) {
+            t_val names = t_val::global("Object").call<t_val>("keys", columns);
+            for (const auto& name : vecFromArray<t_val, std::string>(names)) {
+                read_generator_column(columns[name], generator_spec.m_columns[name]);
+            }
+        }
+
+        return std::make_shared<t_data_generator>(generator_spec, num_keys, num_batches);
+    }
+#endif
+
     /******************************************************************************
      *
      * View API
@@ -1375,11 +1701,13 @@ namespace binding {
     template <typename CTX_T>
     std::shared_ptr<View<CTX_T>>
     make_view(std::shared_ptr<Table> table, const std::string& name, const std::string& separator,
-        t_val view_config, t_val date_parser) {
+        t_val view_config, t_val date_parser, bool deferred) {
         std::shared_ptr<t_schema> schema = std::make_shared<t_schema>(table->get_schema());
         std::shared_ptr<t_view_config> config = make_view_config<t_val>(schema, date_parser, view_config);
+        config->scale_filters(table->get_column_scales());
 
-        auto ctx = make_context<CTX_T>(table, schema, config, name);
+        t_allocator_scope allocator_scope(table->get_gnode()->get_allocator());
+        auto ctx = make_context<CTX_T>(table, schema, config, name, deferred);
 
         auto view_ptr = std::make_shared<View<CTX_T>>(table, ctx, name, separator, config);
 
@@ -1394,7 +1722,8 @@ namespace binding {
     template <>
     std::shared_ptr<t_ctx0>
     make_context(std::shared_ptr<Table> table, std::shared_ptr<t_schema> schema,
-        std::shared_ptr<t_view_config> view_config, const std::string& name) {
+        std::shared_ptr<t_view_config> view_config, const std::string& name,
+        bool deferred) {
         auto columns = view_config->get_columns();
         auto filter_op = view_config->get_filter_op();
         auto fterm = view_config->get_fterm();
@@ -1402,6 +1731,9 @@ namespace binding {
         auto computed_columns = view_config->get_computed_columns();
 
         auto cfg = t_config(columns, fterm, filter_op, computed_columns);
+        if (view_config->get_filter_expr().num_terms() > 0) {
+            cfg.set_filter_expr(view_config->get_filter_expr());
+        }
         auto ctx0 = std::make_shared<t_ctx0>(*(schema.get()), cfg);
         ctx0->init();
         ctx0->sort_by(sortspec);
@@ -1409,7 +1741,7 @@ namespace binding {
         auto pool = table->get_pool();
         auto gnode = table->get_gnode();
         pool->register_context(gnode->get_id(), name, ZERO_SIDED_CONTEXT,
-            reinterpret_cast<std::uintptr_t>(ctx0.get()));
+            reinterpret_cast<std::uintptr_t>(ctx0.get()), deferred);
 
         return ctx0;
     }
@@ -1417,7 +1749,8 @@ namespace binding {
     template <>
     std::shared_ptr<t_ctx1>
     make_context(std::shared_ptr<Table> table, std::shared_ptr<t_schema> schema,
-       std::shared_ptr<t_view_config> view_config, const std::string& name) {
+       std::shared_ptr<t_view_config> view_config, const std::string& name,
+        bool deferred) {
         auto row_pivots = view_config->get_row_pivots();
         auto aggspecs = view_config->get_aggspecs();
         auto filter_op = view_config->get_filter_op();
@@ -1428,6 +1761,9 @@ namespace binding {
 
         auto cfg = t_config(
             row_pivots, aggspecs, fterm, filter_op, computed_columns);
+        if (view_config->get_filter_expr().num_terms() > 0) {
+            cfg.set_filter_expr(view_config->get_filter_expr());
+        }
         auto ctx1 = std::make_shared<t_ctx1>(*(schema.get()), cfg);
 
         ctx1->init();
@@ -1436,7 +1772,7 @@ namespace binding {
         auto pool = table->get_pool();
         auto gnode = table->get_gnode();
         pool->register_context(gnode->get_id(), name, ONE_SIDED_CONTEXT,
-            reinterpret_cast<std::uintptr_t>(ctx1.get()));
+            reinterpret_cast<std::uintptr_t>(ctx1.get()), deferred);
 
         if (row_pivot_depth > -1) {
             ctx1->set_depth(row_pivot_depth - 1);
@@ -1450,7 +1786,8 @@ namespace binding {
     template <>
     std::shared_ptr<t_ctx2>
     make_context(std::shared_ptr<Table> table, std::shared_ptr<t_schema> schema,
-        std::shared_ptr<t_view_config> view_config, const std::string& name) {
+        std::shared_ptr<t_view_config> view_config, const std::string& name,
+        bool deferred) {
         bool column_only = view_config->is_column_only();
         auto row_pivots = view_config->get_row_pivots();
         auto column_pivots = view_config->get_column_pivots();
@@ -1467,6 +1804,9 @@ namespace binding {
 
         auto cfg = t_config(
             row_pivots, column_pivots, aggspecs, total, fterm, filter_op, computed_columns,column_only);
+        if (view_config->get_filter_expr().num_terms() > 0) {
+            cfg.set_filter_expr(view_config->get_filter_expr());
+        }
         auto ctx2 = std::make_shared<t_ctx2>(*(schema.get()), cfg);
 
         ctx2->init();
@@ -1474,7 +1814,7 @@ namespace binding {
         auto pool = table->get_pool();
         auto gnode = table->get_gnode();
         pool->register_context(gnode->get_id(), name, TWO_SIDED_CONTEXT,
-            reinterpret_cast<std::uintptr_t>(ctx2.get()));
+            reinterpret_cast<std::uintptr_t>(ctx2.get()), deferred);
 
         if (row_pivot_depth > -1) {
             ctx2->set_depth(t_header::HEADER_ROW, row_pivot_depth - 1);
@@ -1584,8 +1924,8 @@ using namespace perspective::binding;
  */
 int
 main(int argc, char** argv) {
-// seed the computations vector
-t_computed_column::make_computations();
+// `t_computed_column` generates its computations on first use, rather than
+// delaying the module's startup.
 
 // clang-format off
 EM_ASM({
@@ -1626,8 +1966,14 @@ EMSCRIPTEN_BINDINGS(perspective) {
             const std::string&>()
         .smart_ptr<std::shared_ptr<Table>>("shared_ptr<Table>")
         .function("size", &Table::size)
+        .function("get_memory_usage", &Table::get_memory_usage)
+        .function("get_update_stats", &Table::get_update_stats)
+        .function("get_latency_stats", &Table::get_latency_stats)
+        .function("reset_latency_stats", &Table::reset_latency_stats)
         .function("get_schema", &Table::get_schema)
         .function("get_computed_schema", &Table::get_computed_schema)
+        .function("set_column_scale", &Table::set_column_scale)
+        .function("get_column_scale", &Table::get_column_scale)
         .function("unregister_gnode", &Table::unregister_gnode)
         .function("reset_gnode", &Table::reset_gnode)
         .function("make_port", &Table::make_port)
@@ -1635,6 +1981,18 @@ EMSCRIPTEN_BINDINGS(perspective) {
         .function("get_id", &Table::get_id)
         .function("get_pool", &Table::get_pool)
         .function("get_gnode", &Table::get_gnode);
+
+#ifndef PSP_WASM_LEAN
+    /******************************************************************************
+     *
+     * t_data_generator
+     */
+    class_<t_data_generator>("t_data_generator")
+        .smart_ptr<std::shared_ptr<t_data_generator>>("shared_ptr<t_data_generator>")
+        .function("generate", &t_data_generator::generate)
+        .function("get_num_keys", &t_data_generator::get_num_keys)
+        .function("get_num_batches", &t_data_generator::get_num_batches);
+#endif
     /******************************************************************************
      *
      * View
@@ -1651,8 +2009,14 @@ EMSCRIPTEN_BINDINGS(perspective) {
         .smart_ptr<std::shared_ptr<View<t_ctx0>>>("shared_ptr<View_ctx0>")
         .function("sides", &View<t_ctx0>::sides)
         .function("num_rows", &View<t_ctx0>::num_rows)
+        .function("get_memory_usage", &View<t_ctx0>::get_memory_usage)
+        .function("explain", &View<t_ctx0>::explain)
+        .function("get_latency_stats", &View<t_ctx0>::get_latency_stats)
+        .function("reset_latency_stats", &View<t_ctx0>::reset_latency_stats)
         .function("num_columns", &View<t_ctx0>::num_columns)
         .function("get_row_expanded", &View<t_ctx0>::get_row_expanded)
+        .function("open_cursor", &View<t_ctx0>::open_cursor)
+        .function("close_cursor", &View<t_ctx0>::close_cursor)
         .function("schema", &View<t_ctx0>::schema)
         .function("computed_schema", &View<t_ctx0>::computed_schema)
         .function("column_names", &View<t_ctx0>::column_names)
@@ -1666,6 +2030,23 @@ EMSCRIPTEN_BINDINGS(perspective) {
         .function("get_filter", &View<t_ctx0>::get_filter)
         .function("get_sort", &View<t_ctx0>::get_sort)
         .function("get_step_delta", &View<t_ctx0>::get_step_delta)
+        .function("set_viewport", &View<t_ctx0>::set_viewport)
+        .function("clear_viewport", &View<t_ctx0>::clear_viewport)
+        .function("set_priority", &View<t_ctx0>::set_priority)
+        .function("get_priority", &View<t_ctx0>::get_priority)
+        .function("freeze", &View<t_ctx0>::freeze)
+        .function("thaw", &View<t_ctx0>::thaw)
+        .function("is_frozen", &View<t_ctx0>::is_frozen)
+        .function("set_memory_budget", &View<t_ctx0>::set_memory_budget)
+        .function("get_memory_budget", &View<t_ctx0>::get_memory_budget)
+        .function("reclaim_memory", &View<t_ctx0>::reclaim_memory)
+        .function("build", &View<t_ctx0>::build)
+        .function("get_build_progress", &View<t_ctx0>::get_build_progress)
+        .function("get_row_count_changed", &View<t_ctx0>::get_row_count_changed)
+        .function("set_notify_interval", &View<t_ctx0>::set_notify_interval)
+        .function("get_notify_interval", &View<t_ctx0>::get_notify_interval)
+        .function("get_notify_delay", &View<t_ctx0>::get_notify_delay)
+        .function("set_notified", &View<t_ctx0>::set_notified)
         .function("get_column_dtype", &View<t_ctx0>::get_column_dtype)
         .function("is_column_only", &View<t_ctx0>::is_column_only);
 
@@ -1679,8 +2060,14 @@ EMSCRIPTEN_BINDINGS(perspective) {
         .smart_ptr<std::shared_ptr<View<t_ctx1>>>("shared_ptr<View_ctx1>")
         .function("sides", &View<t_ctx1>::sides)
         .function("num_rows", &View<t_ctx1>::num_rows)
+        .function("get_memory_usage", &View<t_ctx1>::get_memory_usage)
+        .function("explain", &View<t_ctx1>::explain)
+        .function("get_latency_stats", &View<t_ctx1>::get_latency_stats)
+        .function("reset_latency_stats", &View<t_ctx1>::reset_latency_stats)
         .function("num_columns", &View<t_ctx1>::num_columns)
         .function("get_row_expanded", &View<t_ctx1>::get_row_expanded)
+        .function("open_cursor", &View<t_ctx1>::open_cursor)
+        .function("close_cursor", &View<t_ctx1>::close_cursor)
         .function("expand", &View<t_ctx1>::expand)
         .function("collapse", &View<t_ctx1>::collapse)
         .function("set_depth", &View<t_ctx1>::set_depth)
@@ -1697,6 +2084,23 @@ EMSCRIPTEN_BINDINGS(perspective) {
         .function("get_filter", &View<t_ctx1>::get_filter)
         .function("get_sort", &View<t_ctx1>::get_sort)
         .function("get_step_delta", &View<t_ctx1>::get_step_delta)
+        .function("set_viewport", &View<t_ctx1>::set_viewport)
+        .function("clear_viewport", &View<t_ctx1>::clear_viewport)
+        .function("set_priority", &View<t_ctx1>::set_priority)
+        .function("get_priority", &View<t_ctx1>::get_priority)
+        .function("freeze", &View<t_ctx1>::freeze)
+        .function("thaw", &View<t_ctx1>::thaw)
+        .function("is_frozen", &View<t_ctx1>::is_frozen)
+        .function("set_memory_budget", &View<t_ctx1>::set_memory_budget)
+        .function("get_memory_budget", &View<t_ctx1>::get_memory_budget)
+        .function("reclaim_memory", &View<t_ctx1>::reclaim_memory)
+        .function("build", &View<t_ctx1>::build)
+        .function("get_build_progress", &View<t_ctx1>::get_build_progress)
+        .function("get_row_count_changed", &View<t_ctx1>::get_row_count_changed)
+        .function("set_notify_interval", &View<t_ctx1>::set_notify_interval)
+        .function("get_notify_interval", &View<t_ctx1>::get_notify_interval)
+        .function("get_notify_delay", &View<t_ctx1>::get_notify_delay)
+        .function("set_notified", &View<t_ctx1>::set_notified)
         .function("get_column_dtype", &View<t_ctx1>::get_column_dtype)
         .function("is_column_only", &View<t_ctx1>::is_column_only);
 
@@ -1710,8 +2114,14 @@ EMSCRIPTEN_BINDINGS(perspective) {
         .smart_ptr<std::shared_ptr<View<t_ctx2>>>("shared_ptr<View_ctx2>")
         .function("sides", &View<t_ctx2>::sides)
         .function("num_rows", &View<t_ctx2>::num_rows)
+        .function("get_memory_usage", &View<t_ctx2>::get_memory_usage)
+        .function("explain", &View<t_ctx2>::explain)
+        .function("get_latency_stats", &View<t_ctx2>::get_latency_stats)
+        .function("reset_latency_stats", &View<t_ctx2>::reset_latency_stats)
         .function("num_columns", &View<t_ctx2>::num_columns)
         .function("get_row_expanded", &View<t_ctx2>::get_row_expanded)
+        .function("open_cursor", &View<t_ctx2>::open_cursor)
+        .function("close_cursor", &View<t_ctx2>::close_cursor)
         .function("expand", &View<t_ctx2>::expand)
         .function("collapse", &View<t_ctx2>::collapse)
         .function("set_depth", &View<t_ctx2>::set_depth)
@@ -1729,6 +2139,23 @@ EMSCRIPTEN_BINDINGS(perspective) {
         .function("get_sort", &View<t_ctx2>::get_sort)
         .function("get_row_path", &View<t_ctx2>::get_row_path)
         .function("get_step_delta", &View<t_ctx2>::get_step_delta)
+        .function("set_viewport", &View<t_ctx2>::set_viewport)
+        .function("clear_viewport", &View<t_ctx2>::clear_viewport)
+        .function("set_priority", &View<t_ctx2>::set_priority)
+        .function("get_priority", &View<t_ctx2>::get_priority)
+        .function("freeze", &View<t_ctx2>::freeze)
+        .function("thaw", &View<t_ctx2>::thaw)
+        .function("is_frozen", &View<t_ctx2>::is_frozen)
+        .function("set_memory_budget", &View<t_ctx2>::set_memory_budget)
+        .function("get_memory_budget", &View<t_ctx2>::get_memory_budget)
+        .function("reclaim_memory", &View<t_ctx2>::reclaim_memory)
+        .function("build", &View<t_ctx2>::build)
+        .function("get_build_progress", &View<t_ctx2>::get_build_progress)
+        .function("get_row_count_changed", &View<t_ctx2>::get_row_count_changed)
+        .function("set_notify_interval", &View<t_ctx2>::set_notify_interval)
+        .function("get_notify_interval", &View<t_ctx2>::get_notify_interval)
+        .function("get_notify_delay", &View<t_ctx2>::get_notify_delay)
+        .function("set_notified", &View<t_ctx2>::set_notified)
         .function("get_column_dtype", &View<t_ctx2>::get_column_dtype)
         .function("is_column_only", &View<t_ctx2>::is_column_only);
 
@@ -1828,6 +2255,17 @@ EMSCRIPTEN_BINDINGS(perspective) {
      */
     class_<t_ctx2>("t_ctx2").smart_ptr<std::shared_ptr<t_ctx2>>("shared_ptr<t_ctx2>");
 
+    /******************************************************************************
+     *
+     * t_scheduler
+     */
+    class_<t_scheduler>("t_scheduler")
+        .smart_ptr<std::shared_ptr<t_scheduler>>("shared_ptr<t_scheduler>")
+        .function("set_num_threads", &t_scheduler::set_num_threads)
+        .function("get_num_threads", &t_scheduler::get_num_threads)
+        .function("is_inline", &t_scheduler::is_inline)
+        .function("max_concurrency", &t_scheduler::max_concurrency);
+
     /******************************************************************************
      *
      * t_pool
@@ -1836,8 +2274,13 @@ EMSCRIPTEN_BINDINGS(perspective) {
         .constructor<>()
         .smart_ptr<std::shared_ptr<t_pool>>("shared_ptr<t_pool>")
         .function("unregister_gnode", &t_pool::unregister_gnode)
+        .function("get_scheduler", &t_pool::get_scheduler)
         .function("_process", &t_pool::_process)
-        .function("set_update_delegate", &t_pool::set_update_delegate);
+        .function("set_update_delegate", &t_pool::set_update_delegate)
+        .function("set_num_threads", &t_pool::set_num_threads)
+        .function("get_num_threads", &t_pool::get_num_threads)
+        .function("set_notify_threads", &t_pool::set_notify_threads)
+        .function("get_notify_threads", &t_pool::get_notify_threads);
 
     /******************************************************************************
      *
@@ -1897,6 +2340,8 @@ EMSCRIPTEN_BINDINGS(perspective) {
         "std::map<std::string, std::string>");
     register_map<std::string, std::map<std::string, std::string>>(
         "std::map<std::string, std::map<std::string, std::string>>");
+    register_map<std::string, t_uindex>("std::map<std::string, t_uindex>");
+    register_map<std::string, double>("std::map<std::string, double>");
 
     /******************************************************************************
      *
@@ -1936,6 +2381,15 @@ EMSCRIPTEN_BINDINGS(perspective) {
         .value("OP_DELETE", OP_DELETE)
         .value("OP_CLEAR", OP_CLEAR);
 
+    /******************************************************************************
+     *
+     * t_ctx_priority
+     */
+    enum_<t_ctx_priority>("t_ctx_priority")
+        .value("CTX_PRIORITY_VISIBLE", CTX_PRIORITY_VISIBLE)
+        .value("CTX_PRIORITY_BACKGROUND", CTX_PRIORITY_BACKGROUND)
+        .value("CTX_PRIORITY_PAUSED", CTX_PRIORITY_PAUSED);
+
     /******************************************************************************
      *
      * t_computed_function_name
@@ -1992,7 +2446,13 @@ EMSCRIPTEN_BINDINGS(perspective) {
      * Perspective functions
      */
     function("make_table", &make_table<t_val>);
+#ifndef PSP_WASM_LEAN
+    function("make_data_generator", &make_data_generator<t_val>);
+#endif
     function("col_to_js_typed_array", &col_to_js_typed_array);
+    function("col_to_js_typed_array_zero", &view_col_to_js_typed_array<t_ctx0>);
+    function("col_to_js_typed_array_one", &view_col_to_js_typed_array<t_ctx1>);
+    function("col_to_js_typed_array_two", &view_col_to_js_typed_array<t_ctx2>);
     function("make_view_zero", &make_view<t_ctx0>);
     function("make_view_one", &make_view<t_ctx1>);
     function("make_view_two", &make_view<t_ctx2>);
@@ -2005,11 +2465,38 @@ EMSCRIPTEN_BINDINGS(perspective) {
     function("to_arrow_zero", &to_arrow<t_ctx0>);
     function("to_arrow_one", &to_arrow<t_ctx1>);
     function("to_arrow_two", &to_arrow<t_ctx2>);
+    function("to_arrow_chunked_zero", &to_arrow_chunked<t_ctx0>);
+    function("to_arrow_chunked_one", &to_arrow_chunked<t_ctx1>);
+    function("to_arrow_chunked_two", &to_arrow_chunked<t_ctx2>);
+    function("cursor_to_arrow_zero", &cursor_to_arrow<t_ctx0>);
+    function("cursor_to_arrow_one", &cursor_to_arrow<t_ctx1>);
+    function("cursor_to_arrow_two", &cursor_to_arrow<t_ctx2>);
     function("get_row_delta_zero", &get_row_delta<t_ctx0>);
     function("get_row_delta_one", &get_row_delta<t_ctx1>);
     function("get_row_delta_two", &get_row_delta<t_ctx2>);
+    function("get_cell_diff_zero", &get_cell_diff<t_ctx0>);
+    function("get_cell_diff_one", &get_cell_diff<t_ctx1>);
+    function("get_cell_diff_two", &get_cell_diff<t_ctx2>);
+    function("get_histogram_zero", &get_histogram<t_ctx0>);
+    function("get_histogram_one", &get_histogram<t_ctx1>);
+    function("get_histogram_two", &get_histogram<t_ctx2>);
     function("scalar_to_val", &scalar_to_val);
     function("get_computed_functions", &get_computed_functions);
     function("get_table_computed_schema", &get_table_computed_schema<t_val>);
     function("get_computation_input_types", &get_computation_input_types);
+    function("is_threaded", &is_threaded);
+    function("set_tracing_enabled", &t_tracer::set_enabled);
+    function("is_tracing_enabled", &t_tracer::is_enabled);
+    function("get_trace", &t_tracer::to_chrome_json);
+    function("clear_trace", &t_tracer::clear);
+    function("set_profiling_enabled", &t_profiler::set_enabled);
+    function("is_profiling_enabled", &t_profiler::is_enabled);
+    function("get_profile", &t_profiler::get_profile);
+    function("get_profile_ticks", &t_profiler::get_ticks);
+    function("get_profile_interval_us", &t_profiler::get_interval_us);
+    function("clear_profile", &t_profiler::clear);
+    function("set_alloc_stats_enabled", &t_alloc_stats::set_enabled);
+    function("is_alloc_stats_enabled", &t_alloc_stats::is_enabled);
+    function("get_alloc_stats", &t_alloc_stats::get_stats);
+    function("reset_alloc_stats", &t_alloc_stats::reset);
 }
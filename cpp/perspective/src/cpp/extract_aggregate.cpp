@@ -54,6 +54,8 @@ extract_aggregate(
         case AGGTYPE_ANY:
         case AGGTYPE_DOMINANT:
         case AGGTYPE_MEDIAN:
+        case AGGTYPE_MIN:
+        case AGGTYPE_MAX:
         case AGGTYPE_FIRST:
         case AGGTYPE_LAST:
         case AGGTYPE_AND:
@@ -69,6 +71,12 @@ extract_aggregate(
         case AGGTYPE_JOIN:
         case AGGTYPE_IDENTITY:
         case AGGTYPE_DISTINCT_COUNT:
+        case AGGTYPE_APPROX_DISTINCT_COUNT:
+        case AGGTYPE_APPROX_PERCENTILE:
+        case AGGTYPE_ROLLING_SUM:
+        case AGGTYPE_ROLLING_COUNT:
+        case AGGTYPE_ROLLING_MEAN:
+        case AGGTYPE_ROLLING_WEIGHTED_MEAN:
         case AGGTYPE_DISTINCT_LEAF: {
             t_tscalar rval = aggcol->get_scalar(ridx);
             return rval;
@@ -81,6 +81,99 @@ t_fterm::get_expr() const {
     return ss.str();
 }
 
+t_fexpr::t_fexpr()
+    : m_type(FEXPR_GROUP)
+    , m_combiner(FILTER_OP_AND) {}
+
+t_fexpr::t_fexpr(const t_fterm& term)
+    : m_type(FEXPR_TERM)
+    , m_term(term)
+    , m_combiner(FILTER_OP_AND) {}
+
+t_fexpr::t_fexpr(const std::string& colname, t_filter_op op, const std::string& other_colname)
+    : m_type(FEXPR_COLUMNS)
+    , m_term(colname, op, mknone(), std::vector<t_tscalar>())
+    , m_other_colname(other_colname)
+    , m_combiner(FILTER_OP_AND) {
+    switch (op) {
+        case FILTER_OP_IN:
+        case FILTER_OP_NOT_IN:
+        case FILTER_OP_IS_NULL:
+        case FILTER_OP_IS_NOT_NULL: {
+            PSP_COMPLAIN_AND_ABORT("Cannot compare `" + colname + "` to `" + other_colname
+                + "` by `" + filter_op_to_str(op) + "`");
+        } break;
+        default:
+            break;
+    }
+}
+
+t_fexpr::t_fexpr(t_filter_op combiner, const std::vector<t_fexpr>& children)
+    : m_type(FEXPR_GROUP)
+    , m_combiner(combiner)
+    , m_children(children) {
+    if (combiner != FILTER_OP_AND && combiner != FILTER_OP_OR) {
+        PSP_COMPLAIN_AND_ABORT("Filter groups combine by `and` or `or`");
+    }
+}
+
+void
+t_fexpr::get_columns(std::set<std::string>& out) const {
+    switch (m_type) {
+        case FEXPR_TERM: {
+            out.insert(m_term.m_colname);
+        } break;
+        case FEXPR_COLUMNS: {
+            out.insert(m_term.m_colname);
+            out.insert(m_other_colname);
+        } break;
+        case FEXPR_GROUP: {
+            for (const t_fexpr& child : m_children) {
+                child.get_columns(out);
+            }
+        } break;
+    }
+}
+
+t_uindex
+t_fexpr::num_terms() const {
+    if (m_type != FEXPR_GROUP) {
+        return 1;
+    }
+
+    t_uindex rval = 0;
+    for (const t_fexpr& child : m_children) {
+        rval += child.num_terms();
+    }
+    return rval;
+}
+
+std::string
+t_fexpr::get_expr() const {
+    switch (m_type) {
+        case FEXPR_TERM: {
+            return m_term.get_expr();
+        } break;
+        case FEXPR_COLUMNS: {
+            return m_term.m_colname + " " + filter_op_to_str(m_term.m_op) + " "
+                + m_other_colname;
+        } break;
+        case FEXPR_GROUP:
+            break;
+    }
+
+    std::stringstream ss;
+    ss << "(";
+    for (t_uindex idx = 0, loop_end = m_children.size(); idx < loop_end; ++idx) {
+        if (idx > 0) {
+            ss << " " << filter_op_to_str(m_combiner) << " ";
+        }
+        ss << m_children[idx].get_expr();
+    }
+    ss << ")";
+    return ss.str();
+}
+
 t_filter::t_filter()
     : m_mode(SELECT_MODE_ALL) {}
 
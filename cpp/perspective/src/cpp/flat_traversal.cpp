@@ -11,23 +11,49 @@
 #include <perspective/base.h>
 #include <perspective/config.h>
 #include <perspective/flat_traversal.h>
+#include <perspective/mask.h>
 #include <perspective/scalar.h>
 #include <perspective/schema.h>
+#include <perspective/sort_key.h>
+#include <cmath>
 #ifdef PSP_PARALLEL_FOR
 #include <tbb/parallel_sort.h>
 #endif
 
+// The sort values of a batch of this many rows are read before they are
+// stored, bounding the buffer read into.
+#define PSP_FTRAV_FILL_BATCH 4096
+
 namespace perspective {
 
+namespace {
+
+    struct t_ftelem_less {
+        bool
+        operator()(const t_ftelem& a, const t_ftelem& b) const {
+            return m_arena->less(a, b);
+        }
+
+        const t_sort_arena* m_arena;
+    };
+
+} // end anonymous namespace
+
 t_ftrav::t_ftrav()
     : m_step_deletes(0)
-    , m_step_inserts(0) {
-    m_index = std::make_shared<std::vector<t_mselem>>();
+    , m_step_inserts(0)
+    , m_sort_limit(0) {
+    m_arena = std::make_shared<t_sort_arena>();
+    m_index = std::make_shared<t_sorted_index>(m_arena);
 }
 
 void
 t_ftrav::init() {
-    m_index = std::make_shared<std::vector<t_mselem>>();
+    release_rows();
+    m_index = std::make_shared<t_sorted_index>(m_arena);
+    m_pkeyidx.clear();
+    m_unsorted.clear();
+    m_unsorted_pos.clear();
 }
 
 std::vector<t_tscalar>
@@ -36,28 +62,32 @@ t_ftrav::get_all_pkeys(const std::vector<std::pair<t_uindex, t_uindex>>& cells)
     // cells
     std::vector<t_tscalar> rval;
     rval.reserve(cells.size());
-    std::vector<t_mselem>* index = m_index.get();
     for (auto iter = cells.begin(); iter != cells.end(); ++iter) {
-        rval.push_back((*index)[iter->first].m_pkey);
+        ensure_sorted(iter->first + 1);
+    }
+    for (auto iter = cells.begin(); iter != cells.end(); ++iter) {
+        rval.push_back(m_index->select(iter->first)->m_elem.m_pkey);
     }
     return rval;
 }
 
 std::vector<t_tscalar>
 t_ftrav::get_pkeys(const std::vector<std::pair<t_uindex, t_uindex>>& cells) const {
-    tsl::hopscotch_set<t_tscalar> all_pkeys;
-
     std::set<t_index> all_rows;
 
     for (t_index idx = 0, loop_end = cells.size(); idx < loop_end; ++idx) {
         all_rows.insert(cells[idx].first);
     }
 
+    if (!all_rows.empty()) {
+        ensure_sorted(*all_rows.rbegin() + 1);
+    }
+
     std::vector<t_tscalar> rval(all_rows.size());
     std::set<t_index>::iterator it;
     t_index count = 0;
     for (it = all_rows.begin(); it != all_rows.end(); ++it) {
-        rval[count] = (*m_index)[*it].m_pkey;
+        rval[count] = m_index->select(*it)->m_elem.m_pkey;
         ++count;
     }
     return rval;
@@ -67,9 +97,17 @@ std::vector<t_tscalar>
 t_ftrav::get_pkeys(t_index begin_row, t_index end_row) const {
     t_index index_size = m_index->size();
     end_row = std::min(end_row, index_size);
-    std::vector<t_tscalar> rval(end_row - begin_row);
+    std::vector<t_tscalar> rval;
+    if (begin_row >= end_row) {
+        return rval;
+    }
+
+    ensure_sorted(end_row);
+    rval.reserve(end_row - begin_row);
+    const t_sorted_index::t_node* node = m_index->select(begin_row);
     for (t_index ridx = begin_row; ridx < end_row; ++ridx) {
-        rval[ridx - begin_row] = (*m_index)[ridx].m_pkey;
+        rval.push_back(node->m_elem.m_pkey);
+        node = t_sorted_index::next(node);
     }
     return rval;
 }
@@ -78,9 +116,12 @@ std::vector<t_tscalar>
 t_ftrav::get_pkeys(const std::vector<t_uindex>& rows) const {
     std::vector<t_tscalar> rval;
     rval.reserve(rows.size());
+    if (!rows.empty()) {
+        ensure_sorted(*std::max_element(rows.begin(), rows.end()) + 1);
+    }
     for (auto it = rows.begin(); it != rows.end(); ++it) {
         t_uindex ridx = *it;
-        rval.push_back((*m_index)[ridx].m_pkey);
+        rval.push_back(m_index->select(ridx)->m_elem.m_pkey);
     }
     return rval;
 }
@@ -90,17 +131,29 @@ t_ftrav::get_pkeys() const {
     return get_pkeys(0, size());
 }
 
+std::vector<t_tscalar>
+t_ftrav::get_unordered_pkeys() const {
+    std::vector<t_tscalar> rval;
+    rval.reserve(size());
+    for (auto node = m_index->select(0); node; node = t_sorted_index::next(node)) {
+        rval.push_back(node->m_elem.m_pkey);
+    }
+    for (const auto& elem : m_unsorted) {
+        rval.push_back(elem.m_pkey);
+    }
+    return rval;
+}
+
 t_tscalar
 t_ftrav::get_pkey(t_index idx) const {
-    return (*m_index)[idx].m_pkey;
+    ensure_sorted(idx + 1);
+    return m_index->select(idx)->m_elem.m_pkey;
 }
 
-void
-t_ftrav::fill_sort_elem(std::shared_ptr<const t_gstate> gstate, const t_config& config,
-    t_tscalar pkey, t_mselem& out_elem) {
-    out_elem.m_pkey = pkey;
-    t_index sortby_size = m_sortby.size();
-    out_elem.m_row.reserve(sortby_size);
+std::vector<std::string>
+t_ftrav::get_sort_colnames(const t_config& config) const {
+    std::vector<std::string> rval;
+    rval.reserve(m_sortby.size());
     for (const t_sortspec& sort : m_sortby) {
         // maintain backwards compatibility
         std::string colname;
@@ -109,28 +162,53 @@ t_ftrav::fill_sort_elem(std::shared_ptr<const t_gstate> gstate, const t_config&
         } else {
             colname = config.col_at(sort.m_agg_index);
         }
-        const std::string& sortby_colname = config.get_sort_by(colname);
-        out_elem.m_row.push_back(
-            m_symtable.get_interned_tscalar(gstate->get(pkey, sortby_colname)));
+        rval.push_back(config.get_sort_by(colname));
     }
+    return rval;
 }
 
 void
-t_ftrav::fill_sort_elem(std::shared_ptr<const t_gstate> gstate, const t_config& config,
-    const std::vector<t_tscalar>& row, t_mselem& out_elem) const {
-    out_elem.m_pkey = mknone();
-    t_index sortby_size = m_sortby.size();
-    out_elem.m_row.reserve(sortby_size);
-    for (const t_sortspec& sort : m_sortby) {
-        std::string colname;
-        if (sort.m_colname != "") {
-            colname = config.get_sort_by(sort.m_colname);
-        } else {
-            colname = config.col_at(sort.m_agg_index);
+t_ftrav::fill_elems(std::shared_ptr<const t_gstate> gstate, const t_config& config,
+    const std::vector<t_tscalar>& pkeys, std::vector<t_ftelem>& out_elems) {
+    std::shared_ptr<const t_data_table> table = gstate->get_table();
+    std::vector<std::shared_ptr<const t_column>> columns;
+    for (const std::string& colname : get_sort_colnames(config)) {
+        columns.push_back(table->get_const_column(colname));
+    }
+
+    // Normalized keys copy the strings they encode, which only need to
+    // outlive the batch; values kept as they are point into `m_symtable`.
+    bool intern = !is_sort_key_encodable(m_sort_orders);
+
+    t_uindex ncols = columns.size();
+    t_uindex npkeys = pkeys.size();
+    t_uindex batch_size = std::min(npkeys, t_uindex(PSP_FTRAV_FILL_BATCH));
+    std::vector<t_rlookup> lookups(batch_size);
+    std::vector<t_tscalar> values(batch_size * ncols);
+    out_elems.reserve(out_elems.size() + npkeys);
+
+    for (t_uindex bidx = 0; bidx < npkeys; bidx += batch_size) {
+        t_uindex nrows = std::min(batch_size, npkeys - bidx);
+        for (t_uindex ridx = 0; ridx < nrows; ++ridx) {
+            lookups[ridx] = gstate->lookup(pkeys[bidx + ridx]);
+        }
+
+        for (t_uindex cidx = 0; cidx < ncols; ++cidx) {
+            const t_column* col = columns[cidx].get();
+            for (t_uindex ridx = 0; ridx < nrows; ++ridx) {
+                t_tscalar value = t_tscalar();
+                if (lookups[ridx].m_exists) {
+                    value = col->get_scalar(lookups[ridx].m_idx);
+                }
+                values[ridx * ncols + cidx]
+                    = intern ? m_symtable.get_interned_tscalar(value) : value;
+            }
+        }
+
+        for (t_uindex ridx = 0; ridx < nrows; ++ridx) {
+            const t_tscalar& pkey = pkeys[bidx + ridx];
+            out_elems.push_back(t_ftelem{pkey, m_arena->add(values.data() + ridx * ncols, pkey)});
         }
-        const std::string& sortby_colname = config.get_sort_by(colname);
-        out_elem.m_row.push_back(
-            get_interned_tscalar(row.at(config.get_colidx(sortby_colname))));
     }
 }
 
@@ -139,37 +217,79 @@ t_ftrav::sort_by(std::shared_ptr<const t_gstate> gstate, const t_config& config,
     const std::vector<t_sortspec>& sortby) {
     if (sortby.empty())
         return;
-    t_multisorter sorter(get_sort_orders(sortby));
-    t_index size = m_index->size();
-    auto sort_elems = std::make_shared<std::vector<t_mselem>>(static_cast<size_t>(size));
     m_sortby = sortby;
-
-    for (t_index idx = 0; idx < size; ++idx) {
-        t_mselem& elem = (*sort_elems)[idx];
-        t_tscalar pkey = (*m_index)[idx].m_pkey;
-        fill_sort_elem(gstate, config, pkey, elem);
+    m_sort_orders = get_sort_orders(sortby);
+    m_sorted_index = sortby.size() == 1
+        ? gstate->get_sorted_index(get_sort_colnames(config)[0], m_sort_orders[0])
+        : nullptr;
+    t_ftelem_less sorter{m_arena.get()};
+    std::vector<t_tscalar> pkeys = get_unordered_pkeys();
+    t_uindex size = pkeys.size();
+
+    // Every slot is reset, so the rows of the step so far are read again too.
+    std::vector<t_tscalar> new_pkeys;
+    new_pkeys.reserve(m_new_elems.size());
+    for (const auto& kv : m_new_elems) {
+        new_pkeys.push_back(kv.first);
     }
 
-    std::swap(m_index, sort_elems);
-    std::sort(m_index->begin(), m_index->end(), sorter);
+    m_index->clear();
+    m_new_elems.clear();
     m_pkeyidx.clear();
-    for (t_index idx = 0, loop_end = m_index->size(); idx < loop_end; ++idx) {
-        m_pkeyidx[(*m_index)[idx].m_pkey] = idx;
+    m_unsorted.clear();
+    m_unsorted_pos.clear();
+    m_arena->init(m_sort_orders);
+
+    std::vector<t_ftelem> sort_elems;
+    fill_elems(gstate, config, pkeys, sort_elems);
+    fill_new_elems(gstate, config, new_pkeys);
+
+    if (order_by_sorted_index(sort_elems)) {
+        // Read in order from the state's index, so there is nothing to sort.
+    } else if (m_sort_limit > 0 && size > m_sort_limit) {
+        // Partition the rows around the limit and sort only the prefix; the
+        // remaining rows are sorted in batches as they are read.
+        auto nth = sort_elems.begin() + m_sort_limit;
+        std::nth_element(sort_elems.begin(), nth, sort_elems.end(), sorter);
+        std::sort(sort_elems.begin(), nth, sorter);
+        m_unsorted.assign(std::make_move_iterator(nth),
+            std::make_move_iterator(sort_elems.end()));
+        sort_elems.erase(nth, sort_elems.end());
+        for (t_uindex idx = 0, loop_end = m_unsorted.size(); idx < loop_end; ++idx) {
+            m_unsorted_pos[m_unsorted[idx].m_pkey] = idx;
+        }
+    } else {
+        std::sort(sort_elems.begin(), sort_elems.end(), sorter);
+    }
+
+    m_index->build(sort_elems);
+    for (auto node = m_index->select(0); node; node = t_sorted_index::next(node)) {
+        m_pkeyidx[node->m_elem.m_pkey] = node;
     }
 }
 
 t_index
 t_ftrav::size() const {
-    return m_index->size();
+    return m_index->size() + m_unsorted.size();
+}
+
+t_uindex
+t_ftrav::nbytes() const {
+    t_uindex rv = m_index->size() * sizeof(t_sorted_index::t_node)
+        + m_unsorted.capacity() * sizeof(t_ftelem) + m_arena->nbytes();
+    rv += hash_map_nbytes(m_pkeyidx) + hash_map_nbytes(m_new_elems)
+        + hash_map_nbytes(m_unsorted_pos) + m_symtable.nbytes();
+    return rv;
 }
 
 void
 t_ftrav::get_row_indices(const tsl::hopscotch_set<t_tscalar>& pkeys,
     tsl::hopscotch_map<t_tscalar, t_index>& out_map) const {
-    for (t_index idx = 0, loop_end = size(); idx < loop_end; ++idx) {
-        const t_tscalar& pkey = (*m_index)[idx].m_pkey;
-        if (pkeys.find(pkey) != pkeys.end()) {
-            out_map[pkey] = idx;
+    ensure_sorted(size());
+    for (const auto& pkey : pkeys) {
+        auto pkiter = m_pkeyidx.find(pkey);
+        if (pkiter != m_pkeyidx.end()) {
+            out_map[pkey] = m_index->rank(pkiter->second);
         }
     }
 }
@@ -177,9 +297,16 @@ t_ftrav::get_row_indices(const tsl::hopscotch_set<t_tscalar>& pkeys,
 void
 t_ftrav::get_row_indices(t_index bidx, t_index eidx, const tsl::hopscotch_set<t_tscalar>& pkeys,
     tsl::hopscotch_map<t_tscalar, t_index>& out_map) const {
-    for (t_index idx = bidx; idx < eidx; ++idx) {
-        const t_tscalar& pkey = (*m_index)[idx].m_pkey;
-        if (pkeys.find(pkey) != pkeys.end()) {
+    // rows that are still unsorted sort after `eidx`
+    ensure_sorted(eidx);
+    for (const auto& pkey : pkeys) {
+        auto pkiter = m_pkeyidx.find(pkey);
+        if (pkiter == m_pkeyidx.end()) {
+            continue;
+        }
+
+        t_index idx = m_index->rank(pkiter->second);
+        if (bidx <= idx && idx < eidx) {
             out_map[pkey] = idx;
         }
     }
@@ -193,32 +320,60 @@ t_ftrav::get_row_indices(t_index bidx, t_index eidx, const tsl::hopscotch_set<t_
  */
 std::vector<t_uindex>
 t_ftrav::get_row_indices(const tsl::hopscotch_set<t_tscalar>& pkeys) const {
+    return get_row_indices(0, size(), pkeys);
+}
+
+std::vector<t_uindex>
+t_ftrav::get_row_indices(
+    t_index bidx, t_index eidx, const tsl::hopscotch_set<t_tscalar>& pkeys) const {
     std::vector<t_uindex> rows;
-    for (t_uindex idx = 0, loop_end = size(); idx < loop_end; ++idx) {
-        const t_tscalar& pkey = (*m_index)[idx].m_pkey;
-        if (pkeys.find(pkey) != pkeys.end()) {
-            rows.push_back(idx);
+    if (pkeys.empty() || bidx >= eidx) {
+        return rows;
+    }
+
+    // rows that are still unsorted sort after `eidx`
+    ensure_sorted(eidx);
+    t_mask changed(eidx);
+    for (const auto& pkey : pkeys) {
+        auto pkiter = m_pkeyidx.find(pkey);
+        if (pkiter == m_pkeyidx.end()) {
+            continue;
         }
+
+        t_index idx = m_index->rank(pkiter->second);
+        if (bidx <= idx && idx < eidx) {
+            changed.set(idx);
+        }
+    }
+
+    rows.reserve(changed.count());
+    for (t_uindex idx = changed.find_first(); idx != t_mask::m_npos;
+         idx = changed.find_next(idx)) {
+        rows.push_back(idx);
     }
     return rows;
 }
 
 void
 t_ftrav::reset() {
+    release_rows();
     if (m_index.get())
         m_index->clear();
+    m_pkeyidx.clear();
+    m_unsorted.clear();
+    m_unsorted_pos.clear();
 }
 
 void
 t_ftrav::check_size() {
     tsl::hopscotch_set<t_tscalar> pkey_set;
-    for (t_index idx = 0, loop_end = m_index->size(); idx < loop_end; ++idx) {
-        if (pkey_set.find((*m_index)[idx].m_pkey) != pkey_set.end()) {
-            std::cout << "Duplicate entry for " << (*m_index)[idx].m_pkey << std::endl;
+    for (const auto& pkey : get_unordered_pkeys()) {
+        if (pkey_set.find(pkey) != pkey_set.end()) {
+            std::cout << "Duplicate entry for " << pkey << std::endl;
             PSP_COMPLAIN_AND_ABORT("Exiting");
         }
 
-        pkey_set.insert((*m_index)[idx].m_pkey);
+        pkey_set.insert(pkey);
     }
 }
 
@@ -238,67 +393,278 @@ void
 t_ftrav::step_begin() {
     m_step_deletes = 0;
     m_step_inserts = 0;
-    m_new_elems.clear();
+    clear_new_elems();
+    m_deleted_pkeys.clear();
+    m_appended_pkeys.clear();
 }
 
+/**
+ * @brief Apply the rows added, updated and deleted during the step to the
+ * index, each in O(log n): a deleted or updated row is erased from its
+ * place, and a new or updated row is inserted at its (new) place.
+ */
 void
 t_ftrav::step_end() {
-    t_index new_size = m_index->size() + m_step_inserts - m_step_deletes;
-
-    auto new_index = std::make_shared<std::vector<t_mselem>>();
-    new_index->reserve(new_size);
-
-    t_uindex i = 0;
-    t_multisorter sorter(get_sort_orders(m_sortby));
-    std::vector<t_mselem> new_rows;
-
-    for (t_pkmselem_map::const_iterator pkelem_iter = m_new_elems.begin();
-         pkelem_iter != m_new_elems.end(); ++pkelem_iter) {
-        new_rows.push_back(pkelem_iter->second);
-    }
-    std::sort(new_rows.begin(), new_rows.end(), sorter);
-    for (auto it = new_rows.begin(); it != new_rows.end(); ++it) {
-        const t_mselem& new_elem = *it;
-        while (i < m_index->size()) {
-            const t_mselem& old_elem = (*m_index)[i];
-            if (old_elem.m_deleted) {
-                i++;
-                m_pkeyidx.erase(old_elem.m_pkey);
-            } else if (old_elem.m_updated) {
-                i++;
-            } else if (sorter(old_elem, new_elem)) {
-                m_pkeyidx[old_elem.m_pkey] = new_index->size();
-                new_index->push_back(old_elem);
-                i++;
-            } else {
-                break;
-            }
+    // Rows appended in sort order are placed after the other changes.
+    std::vector<t_ftelem> appended;
+    bool has_appends = m_unsorted.empty() && take_ordered_appends(appended);
+
+    // A step changing enough rows that k erases and inserts in O(k log n)
+    // cost more than rebuilding the index in O(n) is merged instead.
+    t_uindex nrows = m_index->size();
+    t_uindex nchanges = m_new_elems.size() + m_deleted_pkeys.size();
+    if (m_unsorted.empty() && nchanges > 0 && nchanges * std::log2(nrows + 2) > nrows) {
+        merge_rows();
+    } else {
+        for (const auto& pkey : m_deleted_pkeys) {
+            erase_row(pkey);
         }
 
-        m_pkeyidx[new_elem.m_pkey] = new_index->size();
-        new_index->push_back(new_elem);
+        for (t_pkelem_map::const_iterator pkelem_iter = m_new_elems.begin();
+             pkelem_iter != m_new_elems.end(); ++pkelem_iter) {
+            erase_row(pkelem_iter->first);
+            insert_row(pkelem_iter->second);
+        }
     }
 
-    while (i < m_index->size()) {
-        const t_mselem& old_elem = (*m_index)[i++];
-        if (old_elem.m_deleted) {
-            m_pkeyidx.erase(old_elem.m_pkey);
-        } else if (!old_elem.m_updated) {
-            m_pkeyidx[old_elem.m_pkey] = new_index->size();
-            new_index->push_back(old_elem);
-        }
+    if (has_appends) {
+        append_rows(appended);
     }
 
-    std::swap(new_index, m_index);
     m_new_elems.clear();
+    m_deleted_pkeys.clear();
+    m_appended_pkeys.clear();
+}
+
+bool
+t_ftrav::take_ordered_appends(std::vector<t_ftelem>& out_elems) {
+    if (m_appended_pkeys.empty() || m_sortby.empty()) {
+        return false;
+    }
+
+    std::vector<const t_ftelem*> elems;
+    elems.reserve(m_appended_pkeys.size());
+    for (const t_tscalar& pkey : m_appended_pkeys) {
+        // A row deleted and added again is still indexed until `step_end`.
+        if (m_pkeyidx.find(pkey) != m_pkeyidx.end()) {
+            return false;
+        }
+
+        auto iter = m_new_elems.find(pkey);
+        if (iter != m_new_elems.end()) {
+            elems.push_back(&iter->second);
+        }
+    }
+
+    if (elems.empty()) {
+        return false;
+    }
+
+    // One comparison per row, stopping at the first out of order.
+    t_ftelem_less sorter{m_arena.get()};
+    bool ascending = true;
+    bool descending = true;
+    for (t_uindex idx = 1, loop_end = elems.size(); idx < loop_end; ++idx) {
+        ascending = ascending && sorter(*elems[idx - 1], *elems[idx]);
+        descending = descending && sorter(*elems[idx], *elems[idx - 1]);
+        if (!ascending && !descending) {
+            return false;
+        }
+    }
+
+    out_elems.clear();
+    out_elems.reserve(elems.size());
+    if (ascending) {
+        for (const t_ftelem* elem : elems) {
+            out_elems.push_back(*elem);
+        }
+    } else {
+        for (auto iter = elems.rbegin(); iter != elems.rend(); ++iter) {
+            out_elems.push_back(**iter);
+        }
+    }
+
+    for (const t_ftelem& elem : out_elems) {
+        m_new_elems.erase(elem.m_pkey);
+    }
+
+    return true;
+}
+
+void
+t_ftrav::append_rows(const std::vector<t_ftelem>& elems) {
+    t_ftelem_less sorter{m_arena.get()};
+    t_uindex nrows = m_index->size();
+    if (nrows == 0 || sorter(m_index->select(nrows - 1)->m_elem, elems.front())) {
+        for (const t_ftelem& elem : elems) {
+            m_pkeyidx[elem.m_pkey] = m_index->push_back(elem);
+        }
+    } else if (sorter(elems.back(), m_index->select(0)->m_elem)) {
+        for (auto iter = elems.rbegin(); iter != elems.rend(); ++iter) {
+            m_pkeyidx[iter->m_pkey] = m_index->push_front(*iter);
+        }
+    } else {
+        for (const t_ftelem& elem : elems) {
+            insert_row(elem);
+        }
+    }
+}
+
+void
+t_ftrav::merge_rows() {
+    t_ftelem_less sorter{m_arena.get()};
+    std::vector<t_ftelem> new_elems;
+    new_elems.reserve(m_new_elems.size());
+    for (const auto& kv : m_new_elems) {
+        new_elems.push_back(kv.second);
+    }
+    if (!order_by_sorted_index(new_elems)) {
+        std::sort(new_elems.begin(), new_elems.end(), sorter);
+    }
+
+    // Updated rows are dropped from their old place, and inserted at their
+    // new place along with the added rows.
+    tsl::hopscotch_set<t_tscalar> deleted(m_deleted_pkeys.begin(), m_deleted_pkeys.end());
+    std::vector<t_ftelem> elems;
+    elems.reserve(m_index->size() + new_elems.size());
+    auto new_iter = new_elems.begin();
+    for (auto node = m_index->select(0); node; node = t_sorted_index::next(node)) {
+        const t_ftelem& elem = node->m_elem;
+        if (deleted.count(elem.m_pkey) || m_new_elems.count(elem.m_pkey)) {
+            m_arena->release(elem.m_slot);
+            continue;
+        }
+        while (new_iter != new_elems.end() && sorter(*new_iter, elem)) {
+            elems.push_back(*new_iter++);
+        }
+        elems.push_back(elem);
+    }
+    elems.insert(elems.end(), new_iter, new_elems.end());
+
+    m_index->build(elems);
+    m_pkeyidx.clear();
+    for (auto node = m_index->select(0); node; node = t_sorted_index::next(node)) {
+        m_pkeyidx[node->m_elem.m_pkey] = node;
+    }
+}
+
+bool
+t_ftrav::order_by_sorted_index(std::vector<t_ftelem>& elems) const {
+    if (!m_sorted_index || elems.size() < 2) {
+        return false;
+    }
+
+    // Reading every row of the index only pays for sorting many of them.
+    t_uindex nelems = elems.size();
+    if (nelems * std::log2(nelems) < m_sorted_index->size()) {
+        return false;
+    }
+
+    tsl::hopscotch_map<t_tscalar, t_uindex> positions;
+    positions.reserve(nelems);
+    for (t_uindex idx = 0; idx < nelems; ++idx) {
+        positions[elems[idx].m_pkey] = idx;
+    }
+
+    std::vector<t_ftelem> ordered;
+    ordered.reserve(nelems);
+    m_sorted_index->for_each_pkey([&positions, &elems, &ordered](const t_tscalar& pkey) {
+        auto iter = positions.find(pkey);
+        if (iter != positions.end()) {
+            ordered.push_back(elems[iter->second]);
+        }
+    });
+
+    if (ordered.size() != nelems) {
+        return false;
+    }
+
+    elems.swap(ordered);
+    return true;
+}
+
+bool
+t_ftrav::is_indexed(t_tscalar pkey) const {
+    return m_pkeyidx.find(pkey) != m_pkeyidx.end()
+        || m_unsorted_pos.find(pkey) != m_unsorted_pos.end();
+}
+
+void
+t_ftrav::erase_row(t_tscalar pkey) {
+    auto pkiter = m_pkeyidx.find(pkey);
+    if (pkiter != m_pkeyidx.end()) {
+        m_arena->release(pkiter->second->m_elem.m_slot);
+        m_index->erase(pkiter->second);
+        m_pkeyidx.erase(pkiter);
+        return;
+    }
+
+    auto positer = m_unsorted_pos.find(pkey);
+    if (positer != m_unsorted_pos.end()) {
+        t_uindex pos = positer->second;
+        m_arena->release(m_unsorted[pos].m_slot);
+        m_unsorted_pos.erase(positer);
+        if (pos != m_unsorted.size() - 1) {
+            m_unsorted[pos] = std::move(m_unsorted.back());
+            m_unsorted_pos[m_unsorted[pos].m_pkey] = pos;
+        }
+        m_unsorted.pop_back();
+    }
+}
+
+// A row goes into the sorted prefix unless it sorts after all of it and
+// there are unsorted rows that may sort before it.
+void
+t_ftrav::insert_row(const t_ftelem& elem) {
+    bool sorted = m_unsorted.empty();
+    if (!sorted && m_index->size() > 0) {
+        t_ftelem_less sorter{m_arena.get()};
+        sorted = sorter(elem, m_index->select(m_index->size() - 1)->m_elem);
+    }
+
+    if (sorted) {
+        m_pkeyidx[elem.m_pkey] = m_index->insert(elem);
+    } else {
+        m_unsorted_pos[elem.m_pkey] = m_unsorted.size();
+        m_unsorted.push_back(elem);
+    }
+}
+
+void
+t_ftrav::ensure_sorted(t_uindex end_row) const {
+    t_uindex nsorted = m_index->size();
+    if (end_row <= nsorted || m_unsorted.empty()) {
+        return;
+    }
+
+    // Sort at least a batch of `m_sort_limit` rows at a time, so that
+    // scrolling through the rows stays amortized O(n log n) overall.
+    t_uindex nrows = std::min(t_uindex(m_unsorted.size()),
+        std::max(end_row - nsorted, std::max(m_sort_limit, t_uindex(1))));
+
+    t_ftelem_less sorter{m_arena.get()};
+    auto nth = m_unsorted.begin() + nrows;
+    if (nth != m_unsorted.end()) {
+        std::nth_element(m_unsorted.begin(), nth, m_unsorted.end(), sorter);
+    }
+    std::sort(m_unsorted.begin(), nth, sorter);
+
+    for (auto iter = m_unsorted.begin(); iter != nth; ++iter) {
+        m_pkeyidx[iter->m_pkey] = m_index->insert(*iter);
+    }
+
+    m_unsorted.erase(m_unsorted.begin(), nth);
+    m_unsorted_pos.clear();
+    for (t_uindex idx = 0, loop_end = m_unsorted.size(); idx < loop_end; ++idx) {
+        m_unsorted_pos[m_unsorted[idx].m_pkey] = idx;
+    }
 }
 
 void
 t_ftrav::add_row(
     std::shared_ptr<const t_gstate> gstate, const t_config& config, t_tscalar pkey) {
-    t_mselem mselem;
-    fill_sort_elem(gstate, config, pkey, mselem);
-    m_new_elems[pkey] = mselem;
+    fill_new_elems(gstate, config, std::vector<t_tscalar>{pkey});
+    m_appended_pkeys.push_back(pkey);
     ++m_step_inserts;
 }
 
@@ -307,27 +673,87 @@ t_ftrav::update_row(
     std::shared_ptr<const t_gstate> gstate, const t_config& config, t_tscalar pkey) {
     if (m_sortby.empty())
         return;
-    t_pkeyidx_map::iterator pkiter = m_pkeyidx.find(pkey);
-    if (pkiter == m_pkeyidx.end()) {
+    if (!is_indexed(pkey)) {
         add_row(gstate, config, pkey);
         return;
     }
-    t_mselem mselem;
-    fill_sort_elem(gstate, config, pkey, mselem);
-    (*m_index)[pkiter->second].m_updated = true;
-    m_new_elems[pkey] = mselem;
+    fill_new_elems(gstate, config, std::vector<t_tscalar>{pkey});
 }
 
 void
 t_ftrav::delete_row(t_tscalar pkey) {
-    t_pkeyidx_map::iterator pkiter = m_pkeyidx.find(pkey);
-    if (pkiter == m_pkeyidx.end())
+    auto iter = m_new_elems.find(pkey);
+    if (iter != m_new_elems.end()) {
+        m_arena->release(iter->second.m_slot);
+        m_new_elems.erase(iter);
+    }
+    if (!is_indexed(pkey))
         return;
-    (*m_index)[pkiter->second].m_deleted = true;
-    m_new_elems.erase(pkey);
+    m_deleted_pkeys.push_back(pkey);
     ++m_step_deletes;
 }
 
+void
+t_ftrav::fill_new_elems(std::shared_ptr<const t_gstate> gstate, const t_config& config,
+    const std::vector<t_tscalar>& pkeys) {
+    std::vector<t_ftelem> elems;
+    fill_elems(gstate, config, pkeys, elems);
+    for (const t_ftelem& elem : elems) {
+        auto iter = m_new_elems.find(elem.m_pkey);
+        if (iter != m_new_elems.end()) {
+            m_arena->release(iter->second.m_slot);
+        }
+        m_new_elems[elem.m_pkey] = elem;
+    }
+}
+
+void
+t_ftrav::clear_new_elems() {
+    for (const auto& kv : m_new_elems) {
+        m_arena->release(kv.second.m_slot);
+    }
+    m_new_elems.clear();
+}
+
+void
+t_ftrav::release_rows() {
+    for (auto node = m_index->select(0); node; node = t_sorted_index::next(node)) {
+        m_arena->release(node->m_elem.m_slot);
+    }
+    for (const auto& elem : m_unsorted) {
+        m_arena->release(elem.m_slot);
+    }
+}
+
+void
+t_ftrav::add_rows(std::shared_ptr<const t_gstate> gstate, const t_config& config,
+    const std::vector<t_tscalar>& pkeys) {
+    fill_new_elems(gstate, config, pkeys);
+    m_appended_pkeys.insert(m_appended_pkeys.end(), pkeys.begin(), pkeys.end());
+    m_step_inserts += pkeys.size();
+}
+
+void
+t_ftrav::update_rows(std::shared_ptr<const t_gstate> gstate, const t_config& config,
+    const std::vector<t_tscalar>& pkeys) {
+    if (m_sortby.empty())
+        return;
+    for (const t_tscalar& pkey : pkeys) {
+        if (!is_indexed(pkey)) {
+            m_appended_pkeys.push_back(pkey);
+            ++m_step_inserts;
+        }
+    }
+    fill_new_elems(gstate, config, pkeys);
+}
+
+void
+t_ftrav::delete_rows(const std::vector<t_tscalar>& pkeys) {
+    for (const t_tscalar& pkey : pkeys) {
+        delete_row(pkey);
+    }
+}
+
 std::vector<t_sortspec>
 t_ftrav::get_sort_by() const {
     return m_sortby;
@@ -342,28 +768,72 @@ void
 t_ftrav::reset_step_state() {
     m_step_deletes = 0;
     m_step_inserts = 0;
-    m_new_elems.clear();
+    clear_new_elems();
+    m_deleted_pkeys.clear();
+    m_appended_pkeys.clear();
 }
 
 t_uindex
 t_ftrav::lower_bound_row_idx(std::shared_ptr<const t_gstate> gstate, const t_config& config,
     const std::vector<t_tscalar>& row) const {
-    t_multisorter sorter(get_sort_orders(m_sortby));
-    t_mselem target_val;
-
-    fill_sort_elem(gstate, config, row, target_val);
+    std::vector<t_tscalar> values;
+    for (const std::string& colname : get_sort_colnames(config)) {
+        values.push_back(get_interned_tscalar(row.at(config.get_colidx(colname))));
+    }
 
-    auto iter = std::lower_bound(m_index->begin(), m_index->end(), target_val, sorter);
+    // the target is stored, as if a row, only until it is found
+    t_ftelem target_val{mknone(), m_arena->add(values.data(), mknone())};
 
-    return std::distance(m_index->begin(), iter);
+    t_uindex rval = m_index->lower_bound(target_val);
+    while (rval == m_index->size() && !m_unsorted.empty()) {
+        ensure_sorted(rval + 1);
+        rval = m_index->lower_bound(target_val);
+    }
+    m_arena->release(target_val.m_slot);
+    return rval;
 }
 
 t_index
 t_ftrav::get_row_idx(t_tscalar pkey) const {
+    if (m_unsorted_pos.find(pkey) != m_unsorted_pos.end()) {
+        ensure_sorted(size());
+    }
     auto pkiter = m_pkeyidx.find(pkey);
     if (pkiter == m_pkeyidx.end())
         return -1;
-    return pkiter->second;
+    return m_index->rank(pkiter->second);
+}
+
+void
+t_ftrav::set_sort_limit(t_uindex limit) {
+    m_sort_limit = limit;
+    if (limit == 0 || m_sortby.empty() || t_uindex(m_index->size()) <= limit) {
+        return;
+    }
+
+    // The sorted rows past the limit are unsorted again, so that rows
+    // updated after the limit join them rather than have their place found.
+    std::vector<t_ftelem> prefix;
+    prefix.reserve(limit);
+    const t_sorted_index::t_node* node = m_index->select(0);
+    for (t_uindex idx = 0; idx < limit; ++idx, node = t_sorted_index::next(node)) {
+        prefix.push_back(node->m_elem);
+    }
+    for (; node; node = t_sorted_index::next(node)) {
+        m_unsorted_pos[node->m_elem.m_pkey] = m_unsorted.size();
+        m_unsorted.push_back(node->m_elem);
+    }
+
+    m_index->build(prefix);
+    m_pkeyidx.clear();
+    for (node = m_index->select(0); node; node = t_sorted_index::next(node)) {
+        m_pkeyidx[node->m_elem.m_pkey] = node;
+    }
+}
+
+t_uindex
+t_ftrav::get_sort_limit() const {
+    return m_sort_limit;
 }
 
 } // end namespace perspective
@@ -39,6 +39,27 @@ calc_negate(t_tscalar val) {
     return val.negate();
 }
 
+t_update_stats::t_update_stats()
+    : m_port_id(0)
+    , m_rows_in(0)
+    , m_rows_flattened(0)
+    , m_flatten_passthrough(false)
+    , m_append(false)
+    , m_rows_added(0)
+    , m_rows_updated(0)
+    , m_rows_removed(0)
+    , m_columns_skipped(0)
+    , m_total_ns(0)
+    , m_flatten_ns(0)
+    , m_lookup_ns(0)
+    , m_process_columns_ns(0)
+    , m_computed_columns_ns(0)
+    , m_update_master_table_ns(0)
+    , m_notify_ns(0) {}
+
+t_context_latency::t_context_latency()
+    : m_notified_at(0) {}
+
 t_gnode::t_gnode(const t_schema& input_schema, const t_schema& output_schema)
     : m_mode(NODE_PROCESSING_SIMPLE_DATAFLOW)
     , m_gnode_type(GNODE_TYPE_PKEYED)
@@ -47,9 +68,24 @@ t_gnode::t_gnode(const t_schema& input_schema, const t_schema& output_schema)
     , m_init(false)
     , m_id(0)
     , m_last_input_port_id(0)
-    , m_pool_cleanup([]() {}) {
+    , m_num_processed(0)
+    , m_spill_idle_ns(0)
+    , m_pack_enabled(false)
+    , m_pack_idle_ns(0)
+    , m_pool_cleanup([]() {})
+    , m_scheduler(t_scheduler::get_default())
+    , m_allocator(t_allocator::for_gnode())
+    , m_has_update_stats(false)
+    , m_sent_at(0)
+    , m_processed_at(0)
+    , m_awaiting_callback(false)
+    , m_num_threads(0)
+    , m_notify_threads(0)
+    , m_last_cube_id(0)
+    , m_last_listener_id(0) {
     PSP_TRACE_SENTINEL();
     LOG_CONSTRUCTOR("t_gnode");
+    m_max_pkey.clear();
 
     std::vector<t_dtype> trans_types(m_output_schema.size());
     for (t_uindex idx = 0; idx < trans_types.size(); ++idx) {
@@ -74,6 +110,7 @@ t_gnode::~t_gnode() {
 void
 t_gnode::init() {
     PSP_TRACE_SENTINEL();
+    t_allocator_scope allocator_scope(m_allocator);
 
     m_gstate = std::make_shared<t_gstate>(m_input_schema, m_output_schema);
     m_gstate->init();
@@ -83,6 +120,7 @@ t_gnode::init() {
     std::shared_ptr<t_port> input_port = 
         std::make_shared<t_port>(PORT_MODE_PKEYED, m_input_schema);
 
+    input_port->set_alloc_owner(ALLOC_OWNER_INPUT_PORT);
     input_port->init();
 
     m_input_ports[0] = input_port;
@@ -92,6 +130,7 @@ t_gnode::init() {
 
         std::shared_ptr<t_port> port = std::make_shared<t_port>(mode, m_transitional_schemas[idx]);
 
+        port->set_alloc_owner(ALLOC_OWNER_TRANSITIONAL);
         port->init();
         m_oports.push_back(port);
     }
@@ -109,6 +148,7 @@ t_gnode::make_input_port() {
     PSP_VERBOSE_ASSERT(m_init, "Cannot `make_input_port` on an uninited gnode.");
     std::shared_ptr<t_port> input_port = 
         std::make_shared<t_port>(PORT_MODE_PKEYED, m_input_schema);
+    input_port->set_alloc_owner(ALLOC_OWNER_INPUT_PORT);
     input_port->init();
 
     t_uindex port_id = m_last_input_port_id + 1;
@@ -120,6 +160,21 @@ t_gnode::make_input_port() {
     return port_id;
 }
 
+void
+t_gnode::make_input_port(t_uindex port_id) {
+    PSP_VERBOSE_ASSERT(m_init, "Cannot `make_input_port` on an uninited gnode.");
+    if (m_input_ports.count(port_id) != 0) {
+        return;
+    }
+
+    std::shared_ptr<t_port> input_port =
+        std::make_shared<t_port>(PORT_MODE_PKEYED, m_input_schema);
+    input_port->set_alloc_owner(ALLOC_OWNER_INPUT_PORT);
+    input_port->init();
+    m_input_ports[port_id] = input_port;
+    m_last_input_port_id = std::max(m_last_input_port_id, port_id);
+}
+
 void
 t_gnode::remove_input_port(t_uindex port_id) {
     PSP_VERBOSE_ASSERT(m_init, "Cannot `remove_input_port` on an uninited gnode.");
@@ -138,44 +193,6 @@ t_gnode::remove_input_port(t_uindex port_id) {
     m_input_ports.erase(port_id);
 }
 
-t_value_transition
-t_gnode::calc_transition(
-    bool prev_existed,
-    bool row_pre_existed,
-    bool exists,
-    bool prev_valid,
-    bool cur_valid,
-    bool prev_cur_eq,
-    bool prev_pkey_eq) {
-    t_value_transition trans = VALUE_TRANSITION_EQ_FF;
-
-    if (!row_pre_existed && !cur_valid && !t_env::backout_invalid_neq_ft()) {
-        trans = VALUE_TRANSITION_NEQ_FT;
-    } else if (row_pre_existed && !prev_valid && !cur_valid
-        && !t_env::backout_eq_invalid_invalid()) {
-        trans = VALUE_TRANSITION_EQ_TT;
-    } else if (!prev_existed && !exists) {
-        trans = VALUE_TRANSITION_EQ_FF;
-    } else if (row_pre_existed && exists && !prev_valid && cur_valid
-        && !t_env::backout_nveq_ft()) {
-        trans = VALUE_TRANSITION_NVEQ_FT;
-    } else if (prev_existed && exists && prev_cur_eq) {
-        trans = VALUE_TRANSITION_EQ_TT;
-    } else if (!prev_existed && exists) {
-        trans = VALUE_TRANSITION_NEQ_FT;
-    } else if (prev_existed && !exists) {
-        trans = VALUE_TRANSITION_NEQ_TF;
-    } else if (prev_existed && exists && !prev_cur_eq) {
-        trans = VALUE_TRANSITION_NEQ_TT;
-    } else if (prev_pkey_eq) {
-        // prev op must have been a delete
-        trans = VALUE_TRANSITION_NEQ_TDT;
-    } else {
-        PSP_COMPLAIN_AND_ABORT("Hit unexpected condition");
-    }
-    return trans;
-}
-
 t_mask
 t_gnode::_process_mask_existed_rows(t_process_state& process_state) {
     // Make sure `existed_data_table` has enough space to write without resizing
@@ -235,8 +252,28 @@ t_gnode::_process_mask_existed_rows(t_process_state& process_state) {
     return mask;
 }
 
+t_mask
+t_gnode::_process_mask_appended_rows(t_process_state& process_state) {
+    auto flattened_num_rows = process_state.m_flattened_data_table->num_rows();
+    process_state.m_existed_data_table->set_size(flattened_num_rows);
+    process_state.m_op_base
+        = process_state.m_flattened_data_table->get_column("psp_op")->get_nth<std::uint8_t>(0);
+
+    t_mask mask(flattened_num_rows);
+    t_column* existed_column
+        = process_state.m_existed_data_table->get_column("psp_existed").get();
+
+    for (t_uindex idx = 0; idx < flattened_num_rows; ++idx) {
+        mask.set(idx, true);
+        existed_column->set_nth(idx, false);
+    }
+
+    return mask;
+}
+
 t_process_table_result
 t_gnode::_process_table(t_uindex port_id) {
+    PSP_TRACE_SPAN("gnode.process_table");
     m_was_updated = false;
 
     t_process_table_result result;
@@ -257,27 +294,89 @@ t_gnode::_process_table(t_uindex port_id) {
     }
 
     m_was_updated = true;
-    flattened = input_port->get_table()->flatten();
+    m_has_update_stats = true;
+    m_update_stats = t_update_stats();
+    m_update_stats.m_port_id = port_id;
+    m_update_stats.m_rows_in = input_port->get_table()->size();
+
+    std::int64_t phase_begin = t_tracer::now();
+    {
+        PSP_TRACE_SPAN("gnode.flatten");
+        if (input_port->get_table()->is_flattened()) {
+            // Flattening would copy the input unchanged, so the input is
+            // used as the flattened table, and the port takes the previous
+            // flattened table in its place when nothing else holds it.
+            std::shared_ptr<t_data_table> spare = m_oports[PSP_PORT_FLATTENED]->get_table();
+            if (spare.use_count() != 2) {
+                spare = nullptr;
+            }
+
+            flattened = input_port->take_table(spare);
+            m_oports[PSP_PORT_FLATTENED]->set_table(flattened);
+            m_update_stats.m_flatten_passthrough = true;
+        } else {
+            flattened = _get_flattened_table(*input_port->get_table());
+            input_port->get_table()->flatten_into(flattened);
+        }
+    }
+    m_update_stats.m_flatten_ns = t_tracer::now() - phase_begin;
 
     PSP_GNODE_VERIFY_TABLE(flattened);
     PSP_GNODE_VERIFY_TABLE(get_table());
 
     t_uindex flattened_num_rows = flattened->num_rows();
 
+    m_update_stats.m_rows_flattened = flattened_num_rows;
+
     std::vector<t_rlookup> row_lookup(flattened_num_rows);
     t_column* pkey_col = flattened->get_column("psp_pkey").get();
-    
-    for (t_uindex idx = 0; idx < flattened_num_rows; ++idx) {
-        // See if each primary key in flattened already exist in the dataset
-        t_tscalar pkey = pkey_col->get_scalar(idx);
-        row_lookup[idx] = m_gstate->lookup(pkey);
+    const std::uint8_t* op_base = flattened->get_column("psp_op")->get_nth<std::uint8_t>(0);
+
+    // A batch of keys greater than any in the state, such as the row numbers
+    // of a table without an `index` that is only inserted into, is appended
+    // without looking up or computing the transitions of rows that cannot
+    // exist.
+    bool is_append = m_update_stats.m_flatten_passthrough && _is_append(*flattened);
+    m_update_stats.m_append = is_append;
+    _update_max_pkey(*flattened);
+
+    phase_begin = t_tracer::now();
+    if (is_append) {
+        std::fill(row_lookup.begin(), row_lookup.end(), t_rlookup(0, false));
+        m_update_stats.m_rows_added = flattened_num_rows;
+    } else {
+        PSP_TRACE_SPAN("gnode.lookup");
+        for (t_uindex idx = 0; idx < flattened_num_rows; ++idx) {
+            // See if each primary key in flattened already exist in the dataset
+            t_tscalar pkey = pkey_col->get_scalar(idx);
+            row_lookup[idx] = m_gstate->lookup(pkey);
+
+            bool exists = row_lookup[idx].m_exists;
+            if (static_cast<t_op>(op_base[idx]) == OP_DELETE) {
+                m_update_stats.m_rows_removed += exists;
+            } else if (exists) {
+                ++m_update_stats.m_rows_updated;
+            } else {
+                ++m_update_stats.m_rows_added;
+            }
+        }
     }
+    m_update_stats.m_lookup_ns = t_tracer::now() - phase_begin;
 
     // first update - master table is empty
     if (m_gstate->mapping_size() == 0) {
+        ++m_num_processed;
+
         // Update context from state first - computes columns during update
+        phase_begin = t_tracer::now();
         _update_contexts_from_state(flattened);
+        m_update_stats.m_notify_ns = t_tracer::now() - phase_begin;
+
+        phase_begin = t_tracer::now();
         m_gstate->update_master_table(flattened.get());
+        m_update_stats.m_update_master_table_ns = t_tracer::now() - phase_begin;
+        m_computed_column_map.m_stale_columns.clear();
+        _notify_update_listeners(*flattened);
         m_oports[PSP_PORT_FLATTENED]->set_table(flattened);
         release_inputs();
         release_outputs();
@@ -291,7 +390,9 @@ t_gnode::_process_table(t_uindex port_id) {
         return result;
     }
 
-    input_port->release_or_clear();
+    if (!m_update_stats.m_flatten_passthrough) {
+        input_port->release_or_clear();
+    }
 
     // Use `t_process_state` to manage intermediate structures
     t_process_state _process_state;
@@ -313,126 +414,207 @@ t_gnode::_process_table(t_uindex port_id) {
         DTYPE_UINT8);
 
     // Recompute values for flattened and m_state->get_table
-    _recompute_all_columns(
-        get_table_sptr(),
-        _process_state.m_flattened_data_table,
-        _process_state.m_lookup);
+    phase_begin = t_tracer::now();
+    {
+        PSP_TRACE_SPAN("gnode.recompute_columns");
+        _recompute_all_columns(
+            get_table_sptr(),
+            _process_state.m_flattened_data_table,
+            _process_state.m_lookup);
+    }
+    m_update_stats.m_computed_columns_ns += t_tracer::now() - phase_begin;
 
     // Clear delta, prev, current, transitions, existed on EACH call.
     _process_state.clear_transitional_data_tables();
 
+    // Computed columns that no context reads are only kept up to date in
+    // the master table, and are skipped in the transitional tables.
+    const std::set<std::string>& transitional_columns
+        = m_computed_column_map.m_transitional_columns;
+
     // compute values on transitional tables before reserve
+    phase_begin = t_tracer::now();
     _compute_all_columns(
         {
             _process_state.m_delta_data_table,
             _process_state.m_prev_data_table,
             _process_state.m_current_data_table
-        });
+        }, &transitional_columns);
+    m_update_stats.m_computed_columns_ns += t_tracer::now() - phase_begin;
+
+    // Process the `real` columns of the gnode state output schema that
+    // contexts read + the computed columns that contexts read. Columns no
+    // context reads are left empty in the transitional tables.
+    std::set<std::string> transitional_names = _get_transitional_columns();
+    std::vector<std::string> column_names;
+    for (const std::string& name : get_output_schema().m_columns) {
+        if (transitional_names.count(name)) {
+            column_names.push_back(name);
+        }
+    }
+
+    m_update_stats.m_columns_skipped = get_output_schema().size() - column_names.size();
+    const std::set<std::string>& read_columns = m_computed_column_map.m_read_columns;
+    column_names.insert(column_names.end(), read_columns.begin(), read_columns.end());
 
-    // And re-reserved for the amount of data in `flattened`
-    _process_state.reserve_transitional_data_tables(flattened_num_rows);
+    // And re-reserved for the amount of data in `flattened`, for only the
+    // columns that are processed.
+    _process_state.reserve_transitional_data_tables(flattened_num_rows, column_names);
 
-    t_mask existed_mask = _process_mask_existed_rows(_process_state);
+    t_mask existed_mask = is_append ? _process_mask_appended_rows(_process_state)
+                                    : _process_mask_existed_rows(_process_state);
     auto mask_count = existed_mask.count();
 
     // mask_count = flattened_num_rows - number of rows that were removed
-    _process_state.set_size_transitional_data_tables(mask_count);
+    _process_state.set_size_transitional_data_tables(mask_count, column_names);
 
-    // Reconcile column names - only attempt to process valid computed columns
-    std::vector<std::string> column_names = get_output_schema().m_columns;
-    std::vector<std::string> valid_computed_columns;
-    valid_computed_columns.reserve(
-        m_computed_column_map.m_computed_columns.size());
+    t_uindex ncols = column_names.size();
 
-    for (const auto& computed : m_computed_column_map.m_computed_columns) {
-        valid_computed_columns.push_back(computed.first);
-    }
-    
-    // Process the `real` columns of the gnode state output schema + the
-    // computed columns registered by each context.
-    column_names.insert(
-        column_names.end(),
-        valid_computed_columns.begin(),
-        valid_computed_columns.end());
+    auto process_column_helper = [&_process_state, &column_names, this](t_uindex colidx) {
+        const std::string& cname = column_names[colidx];
+        auto fcolumn = _process_state.m_flattened_data_table->get_column(cname).get();
+        auto scolumn = _process_state.m_state_data_table->get_column(cname).get();
+        auto dcolumn = _process_state.m_delta_data_table->get_column(cname).get();
+        auto pcolumn = _process_state.m_prev_data_table->get_column(cname).get();
+        auto ccolumn = _process_state.m_current_data_table->get_column(cname).get();
+        auto tcolumn = _process_state.m_transitions_data_table->get_column(cname).get();
 
-    t_uindex ncols = column_names.size();
+        t_dtype col_dtype = fcolumn->get_dtype();
 
-#ifdef PSP_PARALLEL_FOR
-    tbb::parallel_for(0, int(ncols), 1,
-        [&_process_state, &column_names, this](int colidx)
-#else
-    for (t_uindex colidx = 0; colidx < ncols; ++colidx)
-#endif
-        {
-            const std::string& cname = column_names[colidx];
-            auto fcolumn = _process_state.m_flattened_data_table->get_column(cname).get();
-            auto scolumn = _process_state.m_state_data_table->get_column(cname).get();
-            auto dcolumn = _process_state.m_delta_data_table->get_column(cname).get();
-            auto pcolumn = _process_state.m_prev_data_table->get_column(cname).get();
-            auto ccolumn = _process_state.m_current_data_table->get_column(cname).get();
-            auto tcolumn = _process_state.m_transitions_data_table->get_column(cname).get();
-
-            t_dtype col_dtype = fcolumn->get_dtype();
-
-            switch (col_dtype) {
-                case DTYPE_INT64: {
-                    _process_column<std::int64_t>(fcolumn, scolumn, dcolumn, pcolumn, ccolumn, tcolumn, _process_state);
-                } break;
-                case DTYPE_INT32: {
-                    _process_column<std::int32_t>(fcolumn, scolumn, dcolumn, pcolumn, ccolumn, tcolumn, _process_state);
-                } break;
-                case DTYPE_INT16: {
-                    _process_column<std::int16_t>(fcolumn, scolumn, dcolumn, pcolumn, ccolumn, tcolumn, _process_state);
-                } break;
-                case DTYPE_INT8: {
-                    _process_column<std::int8_t>(fcolumn, scolumn, dcolumn, pcolumn, ccolumn, tcolumn, _process_state);
-                } break;
-                case DTYPE_UINT64: {
-                    _process_column<std::uint64_t>(fcolumn, scolumn, dcolumn, pcolumn, ccolumn, tcolumn, _process_state);
-                } break;
-                case DTYPE_UINT32: {
-                    _process_column<std::uint32_t>(fcolumn, scolumn, dcolumn, pcolumn, ccolumn, tcolumn, _process_state);
-                } break;
-                case DTYPE_UINT16: {
-                    _process_column<std::uint16_t>(fcolumn, scolumn, dcolumn, pcolumn, ccolumn, tcolumn, _process_state);
-                } break;
-                case DTYPE_UINT8: {
-                    _process_column<std::uint8_t>(fcolumn, scolumn, dcolumn, pcolumn, ccolumn, tcolumn, _process_state);
-                } break;
-                case DTYPE_FLOAT64: {
-                    _process_column<double>(fcolumn, scolumn, dcolumn, pcolumn, ccolumn, tcolumn, _process_state);
-                } break;
-                case DTYPE_FLOAT32: {
-                    _process_column<float>(fcolumn, scolumn, dcolumn, pcolumn, ccolumn, tcolumn, _process_state);
-                } break;
-                case DTYPE_BOOL: {
-                    _process_column<std::uint8_t>(fcolumn, scolumn, dcolumn, pcolumn, ccolumn, tcolumn, _process_state);
-                } break;
-                case DTYPE_TIME: {
-                    _process_column<std::int64_t>(fcolumn, scolumn, dcolumn, pcolumn, ccolumn, tcolumn, _process_state);
-                } break;
-                case DTYPE_DATE: {
-                    _process_column<std::uint32_t>(fcolumn, scolumn, dcolumn, pcolumn, ccolumn, tcolumn, _process_state);
-                } break;
-                case DTYPE_STR: {
-                    _process_column<std::string>(fcolumn, scolumn, dcolumn, pcolumn, ccolumn, tcolumn, _process_state);
-                } break;
-                case DTYPE_OBJECT: {
-                    _process_column<std::uint64_t>(fcolumn, scolumn, dcolumn, pcolumn, ccolumn, tcolumn, _process_state);
-                } break;
-                default: { PSP_COMPLAIN_AND_ABORT("Unsupported column dtype"); }
-            }
+        switch (col_dtype) {
+            case DTYPE_INT64: {
+                _process_column<std::int64_t>(fcolumn, scolumn, dcolumn, pcolumn, ccolumn, tcolumn, _process_state);
+            } break;
+            case DTYPE_INT32: {
+                _process_column<std::int32_t>(fcolumn, scolumn, dcolumn, pcolumn, ccolumn, tcolumn, _process_state);
+            } break;
+            case DTYPE_INT16: {
+                _process_column<std::int16_t>(fcolumn, scolumn, dcolumn, pcolumn, ccolumn, tcolumn, _process_state);
+            } break;
+            case DTYPE_INT8: {
+                _process_column<std::int8_t>(fcolumn, scolumn, dcolumn, pcolumn, ccolumn, tcolumn, _process_state);
+            } break;
+            case DTYPE_UINT64: {
+                _process_column<std::uint64_t>(fcolumn, scolumn, dcolumn, pcolumn, ccolumn, tcolumn, _process_state);
+            } break;
+            case DTYPE_UINT32: {
+                _process_column<std::uint32_t>(fcolumn, scolumn, dcolumn, pcolumn, ccolumn, tcolumn, _process_state);
+            } break;
+            case DTYPE_UINT16: {
+                _process_column<std::uint16_t>(fcolumn, scolumn, dcolumn, pcolumn, ccolumn, tcolumn, _process_state);
+            } break;
+            case DTYPE_UINT8: {
+                _process_column<std::uint8_t>(fcolumn, scolumn, dcolumn, pcolumn, ccolumn, tcolumn, _process_state);
+            } break;
+            case DTYPE_FLOAT64: {
+                _process_column<double>(fcolumn, scolumn, dcolumn, pcolumn, ccolumn, tcolumn, _process_state);
+            } break;
+            case DTYPE_FLOAT32: {
+                _process_column<float>(fcolumn, scolumn, dcolumn, pcolumn, ccolumn, tcolumn, _process_state);
+            } break;
+            case DTYPE_BOOL: {
+                _process_column<std::uint8_t>(fcolumn, scolumn, dcolumn, pcolumn, ccolumn, tcolumn, _process_state);
+            } break;
+            case DTYPE_TIME: {
+                _process_column<std::int64_t>(fcolumn, scolumn, dcolumn, pcolumn, ccolumn, tcolumn, _process_state);
+            } break;
+            case DTYPE_DATE: {
+                _process_column<std::uint32_t>(fcolumn, scolumn, dcolumn, pcolumn, ccolumn, tcolumn, _process_state);
+            } break;
+            case DTYPE_STR: {
+                _process_column<std::string>(fcolumn, scolumn, dcolumn, pcolumn, ccolumn, tcolumn, _process_state);
+            } break;
+            case DTYPE_OBJECT: {
+                _process_column<std::uint64_t>(fcolumn, scolumn, dcolumn, pcolumn, ccolumn, tcolumn, _process_state);
+            } break;
+            default: { PSP_COMPLAIN_AND_ABORT("Unsupported column dtype"); }
+        }
+    };
+
+    auto process_appended_column_helper = [&_process_state, &column_names, this](
+                                              t_uindex colidx) {
+        const std::string& cname = column_names[colidx];
+        auto fcolumn = _process_state.m_flattened_data_table->get_column(cname).get();
+        auto dcolumn = _process_state.m_delta_data_table->get_column(cname).get();
+        auto pcolumn = _process_state.m_prev_data_table->get_column(cname).get();
+        auto ccolumn = _process_state.m_current_data_table->get_column(cname).get();
+        auto tcolumn = _process_state.m_transitions_data_table->get_column(cname).get();
+
+        switch (fcolumn->get_dtype()) {
+            case DTYPE_INT64: {
+                _process_appended_column<std::int64_t>(fcolumn, dcolumn, pcolumn, ccolumn, tcolumn);
+            } break;
+            case DTYPE_INT32: {
+                _process_appended_column<std::int32_t>(fcolumn, dcolumn, pcolumn, ccolumn, tcolumn);
+            } break;
+            case DTYPE_INT16: {
+                _process_appended_column<std::int16_t>(fcolumn, dcolumn, pcolumn, ccolumn, tcolumn);
+            } break;
+            case DTYPE_INT8: {
+                _process_appended_column<std::int8_t>(fcolumn, dcolumn, pcolumn, ccolumn, tcolumn);
+            } break;
+            case DTYPE_UINT64: {
+                _process_appended_column<std::uint64_t>(fcolumn, dcolumn, pcolumn, ccolumn, tcolumn);
+            } break;
+            case DTYPE_UINT32: {
+                _process_appended_column<std::uint32_t>(fcolumn, dcolumn, pcolumn, ccolumn, tcolumn);
+            } break;
+            case DTYPE_UINT16: {
+                _process_appended_column<std::uint16_t>(fcolumn, dcolumn, pcolumn, ccolumn, tcolumn);
+            } break;
+            case DTYPE_UINT8: {
+                _process_appended_column<std::uint8_t>(fcolumn, dcolumn, pcolumn, ccolumn, tcolumn);
+            } break;
+            case DTYPE_FLOAT64: {
+                _process_appended_column<double>(fcolumn, dcolumn, pcolumn, ccolumn, tcolumn);
+            } break;
+            case DTYPE_FLOAT32: {
+                _process_appended_column<float>(fcolumn, dcolumn, pcolumn, ccolumn, tcolumn);
+            } break;
+            case DTYPE_BOOL: {
+                _process_appended_column<std::uint8_t>(fcolumn, dcolumn, pcolumn, ccolumn, tcolumn);
+            } break;
+            case DTYPE_TIME: {
+                _process_appended_column<std::int64_t>(fcolumn, dcolumn, pcolumn, ccolumn, tcolumn);
+            } break;
+            case DTYPE_DATE: {
+                _process_appended_column<std::uint32_t>(fcolumn, dcolumn, pcolumn, ccolumn, tcolumn);
+            } break;
+            case DTYPE_STR: {
+                _process_appended_column<std::string>(fcolumn, dcolumn, pcolumn, ccolumn, tcolumn);
+            } break;
+            case DTYPE_OBJECT: {
+                _process_appended_column<std::uint64_t>(fcolumn, dcolumn, pcolumn, ccolumn, tcolumn);
+            } break;
+            default: { PSP_COMPLAIN_AND_ABORT("Unsupported column dtype"); }
+        }
+    };
+
+    // Each column writes only into its own delta/prev/current/transitions
+    // columns, so columns fan out across the scheduler without locking.
+    phase_begin = t_tracer::now();
+    {
+        PSP_TRACE_SPAN("gnode.process_columns");
+        if (is_append) {
+            m_scheduler->parallel_for(ncols, process_appended_column_helper, m_num_threads);
+        } else {
+            m_scheduler->parallel_for(ncols, process_column_helper, m_num_threads);
         }
-#ifdef PSP_PARALLEL_FOR
-    );
-#endif
+    }
+    m_update_stats.m_process_columns_ns = t_tracer::now() - phase_begin;
+
     // After transitional tables are written, compute their values
-    _compute_all_columns(
-        {
-            _process_state.m_delta_data_table,
-            _process_state.m_prev_data_table,
-            _process_state.m_current_data_table
-        });
+    phase_begin = t_tracer::now();
+    {
+        PSP_TRACE_SPAN("gnode.compute_columns");
+        _compute_all_columns(
+            {
+                _process_state.m_delta_data_table,
+                _process_state.m_prev_data_table,
+                _process_state.m_current_data_table
+            }, &transitional_columns);
+    }
+    m_update_stats.m_computed_columns_ns += t_tracer::now() - phase_begin;
 
     /**
      * After all columns have been processed (transitional tables written into),
@@ -462,7 +644,12 @@ t_gnode::_process_table(t_uindex port_id) {
     }
     #endif
 
-    m_gstate->update_master_table(flattened_masked.get());
+    phase_begin = t_tracer::now();
+    {
+        PSP_TRACE_SPAN("gnode.update_master_table");
+        m_gstate->update_master_table(flattened_masked.get());
+    }
+    m_update_stats.m_update_master_table_ns = t_tracer::now() - phase_begin;
 
     #ifdef PSP_GNODE_VERIFY
     {
@@ -508,7 +695,6 @@ t_gnode::_process_column<std::string>(
                 bool prev_valid = false;
 
                 auto cur_value = fcolumn->get_nth<const char>(idx);
-                std::string curs(cur_value);
 
                 bool cur_valid = fcolumn->is_valid(idx);
 
@@ -526,8 +712,8 @@ t_gnode::_process_column<std::string>(
                     cur_valid, prev_cur_eq, prev_pkey_eq);
 
                 if (prev_valid) {
-                    pcolumn->set_nth<t_uindex>(
-                        added_count, *(scolumn->get_nth<t_uindex>(rlookup.m_idx)));
+                    pcolumn->set_nth<t_stridx>(
+                        added_count, *(scolumn->get_nth<t_stridx>(rlookup.m_idx)));
                 }
 
                 pcolumn->set_valid(added_count, prev_valid);
@@ -566,124 +752,588 @@ t_gnode::_process_column<std::string>(
     }
 }
 
+template <>
 void
-t_gnode::send(t_uindex port_id, const t_data_table& fragments) {
-    PSP_TRACE_SENTINEL();
+t_gnode::_process_appended_column<std::string>(const t_column* fcolumn, t_column* dcolumn,
+    t_column* pcolumn, t_column* ccolumn, t_column* tcolumn) {
+    std::uint8_t invalid_trans
+        = t_env::backout_invalid_neq_ft() ? VALUE_TRANSITION_EQ_FF : VALUE_TRANSITION_NEQ_FT;
+
+    for (t_uindex idx = 0, loop_end = fcolumn->size(); idx < loop_end; ++idx) {
+        bool cur_valid = fcolumn->is_valid(idx);
+
+        pcolumn->set_valid(idx, false);
+
+        if (cur_valid) {
+            ccolumn->set_nth<const char*>(idx, fcolumn->get_nth<const char>(idx));
+        }
+
+        ccolumn->set_valid(idx, cur_valid);
+
+        tcolumn->set_nth<std::uint8_t>(
+            idx, cur_valid ? std::uint8_t(VALUE_TRANSITION_NEQ_FT) : invalid_trans);
+    }
+}
+
+bool
+t_gnode::_begin_send(t_uindex port_id, const t_data_table& fragments) {
     PSP_VERBOSE_ASSERT(m_init, "Cannot `send` to an uninited gnode.");
 
     if (m_input_ports.count(port_id) == 0) {
         std::cerr << "Cannot send table to port `" << port_id << "`, which does not exist." << std::endl;
-        return;
+        return false;
+    }
+
+    if (m_update_log) {
+        m_update_log->append(port_id, fragments);
+    }
+
+    return true;
+}
+
+void
+t_gnode::send(t_uindex port_id, const t_data_table& fragments) {
+    PSP_TRACE_SENTINEL();
+    t_allocator_scope allocator_scope(m_allocator);
+    if (_begin_send(port_id, fragments)) {
+        m_input_ports[port_id]->send(fragments);
     }
+}
 
-    std::shared_ptr<t_port>& input_port = m_input_ports[port_id];
-    input_port->send(fragments);
+void
+t_gnode::send(t_uindex port_id, std::shared_ptr<t_data_table>&& fragments) {
+    PSP_TRACE_SENTINEL();
+    t_allocator_scope allocator_scope(m_allocator);
+    if (_begin_send(port_id, *fragments)) {
+        m_input_ports[port_id]->send(std::move(fragments));
+    }
 }
 
 bool
-t_gnode::process(t_uindex port_id) {
+t_gnode::process(t_uindex port_id, bool defer_background) {
     PSP_TRACE_SENTINEL();
+    PSP_TRACE_SPAN("gnode.process");
     PSP_VERBOSE_ASSERT(m_init, "Cannot `process` on an uninited gnode.");
+    t_allocator_scope allocator_scope(m_allocator);
+
+    // Background contexts read the output ports of their update, so are
+    // notified before the ports are overwritten.
+    notify_background_contexts();
+
+    // Updates sent from now on are processed by the next `process`. The
+    // wait of an update is measured from its first `send`.
+    std::int64_t sent_at = -1;
+    auto input_port = m_input_ports.find(port_id);
+    if (input_port != m_input_ports.end()) {
+        sent_at = input_port->second->swap_buffers();
+    }
+
+    std::int64_t begin = t_tracer::now();
+    bool was_sent = sent_at >= 0;
+    if (was_sent) {
+        m_sent_at = sent_at;
+        m_send_wait_latency.record(begin - m_sent_at);
+        for (auto& kv : m_context_latency) {
+            kv.second->m_notified_at = 0;
+        }
+    } else {
+        m_sent_at = begin;
+    }
 
     t_process_table_result result = _process_table(port_id);
 
     if (result.m_flattened_data_table) {
-        notify_contexts(*result.m_flattened_data_table);
-    } 
-    
+        ++m_num_processed;
+        _mark_paused_contexts_stale();
+        notify_contexts(*result.m_flattened_data_table, CTX_PRIORITY_VISIBLE);
+        _notify_totals(*result.m_flattened_data_table);
+        _notify_update_listeners(*result.m_flattened_data_table);
+
+        if (defer_background) {
+            m_background_flattened = result.m_flattened_data_table;
+        } else {
+            notify_contexts(*result.m_flattened_data_table, CTX_PRIORITY_BACKGROUND);
+
+            // Contexts have read the transitional tables, which refer to the
+            // state's string ids, so vocabularies can be renumbered now.
+            _compact_state();
+        }
+
+        _enforce_memory_budgets();
+        spill_cold_columns();
+        pack_cold_columns();
+    }
+
+    std::int64_t end = t_tracer::now();
+    if (was_sent) {
+        m_process_latency.record(end - begin);
+    }
+
+    m_processed_at = end;
+    m_awaiting_callback = result.m_should_notify_userspace;
+    if (result.m_should_notify_userspace) {
+        m_update_stats.m_total_ns = end - begin;
+    }
+
     // Whether the user should be notified - False if process_table exited
     // early, True otherwise.
     return result.m_should_notify_userspace;
 }
 
-t_uindex
-t_gnode::mapping_size() const {
-    return m_gstate->mapping_size();
+bool
+t_gnode::notify_background_contexts() {
+    if (!m_background_flattened) {
+        return false;
+    }
+    t_allocator_scope allocator_scope(m_allocator);
+
+    std::shared_ptr<t_data_table> flattened = m_background_flattened;
+    m_background_flattened.reset();
+    std::int64_t begin = t_tracer::now();
+    bool notified = notify_contexts(*flattened, CTX_PRIORITY_BACKGROUND);
+    _compact_state();
+    _enforce_memory_budgets();
+    m_update_stats.m_total_ns += t_tracer::now() - begin;
+    return notified;
 }
 
-t_data_table*
-t_gnode::_get_otable(t_uindex port_id) {
-    PSP_TRACE_SENTINEL();
-    PSP_VERBOSE_ASSERT(m_init, "Cannot `_get_otable` on an uninited gnode.");
-    PSP_VERBOSE_ASSERT(port_id < m_oports.size(), "Invalid port number");
-    return m_oports[port_id]->get_table().get();
-}
+bool
+t_gnode::set_context_priority(const std::string& name, t_ctx_priority priority) {
+    // A frozen context takes the priority once thawed.
+    auto frozen = m_frozen_contexts.find(name);
+    if (frozen != m_frozen_contexts.end()) {
+        frozen->second.m_priority = priority;
+        return false;
+    }
 
-t_data_table*
-t_gnode::_get_itable(t_uindex port_id) {
-    PSP_TRACE_SENTINEL();
-    PSP_VERBOSE_ASSERT(m_init, "Cannot `_get_itable` on an uninited gnode.");
-    PSP_VERBOSE_ASSERT(m_input_ports.count(port_id) != 0, "Invalid port number");
-    return m_input_ports[port_id]->get_table().get();
-}
+    auto it = m_contexts.find(name);
+    PSP_VERBOSE_ASSERT(it != m_contexts.end(), "Context not found.");
+    if (it->second.m_frozen) {
+        it->second.m_thaw_priority = priority;
+        return false;
+    }
+    it->second.m_priority = priority;
 
-t_data_table*
-t_gnode::get_table() {
-    PSP_TRACE_SENTINEL();
-    PSP_VERBOSE_ASSERT(m_init, "Cannot `get_table` on an uninited gnode.");
-    return m_gstate->get_table().get();
-}
+    // A follower misses updates through the tree it reads.
+    void* ctx = it->second.m_ctx;
+    void* tree_owner = ctx;
+    if (it->second.get_type() == ONE_SIDED_CONTEXT && it->second.get<t_ctx1>()->is_tree_follower()) {
+        tree_owner = it->second.get<t_ctx1>()->get_tree_leader();
+    }
 
-const t_data_table*
-t_gnode::get_table() const {
-    PSP_TRACE_SENTINEL();
-    PSP_VERBOSE_ASSERT(m_init, "Cannot `get_table` on an uninited gnode.");
-    return m_gstate->get_table().get();
+    std::set<void*> refreshed = _refresh_stale_contexts();
+    return refreshed.count(ctx) > 0 || refreshed.count(tree_owner) > 0;
 }
 
-std::shared_ptr<t_data_table>
-t_gnode::get_table_sptr() {
-    PSP_TRACE_SENTINEL();
-    PSP_VERBOSE_ASSERT(m_init, "Cannot `get_table_sptr` on an uninited gnode.");
-    return m_gstate->get_table();
+t_ctx_priority
+t_gnode::get_context_priority(const std::string& name) const {
+    auto frozen = m_frozen_contexts.find(name);
+    if (frozen != m_frozen_contexts.end()) {
+        return frozen->second.m_priority;
+    }
+
+    auto it = m_contexts.find(name);
+    PSP_VERBOSE_ASSERT(it != m_contexts.end(), "Context not found.");
+    return it->second.m_frozen ? it->second.m_thaw_priority : it->second.m_priority;
 }
 
-/**
- * Convenience method for promoting a column.  This is a hack used to
- * interop with javascript more efficiently, and does not handle all
- * possible type conversions.  Non-public.
- */
 void
-t_gnode::promote_column(const std::string& name, t_dtype new_type) {
-    PSP_TRACE_SENTINEL();
-    PSP_VERBOSE_ASSERT(m_init, "Cannot `promote_column` on an uninited gnode.");
-    get_table()->promote_column(name, new_type, 0, false);
-    _get_otable(0)->promote_column(name, new_type, 0, false);
+t_gnode::freeze_context(const std::string& name) {
+    auto it = m_contexts.find(name);
+    if (it == m_contexts.end() || it->second.m_frozen) {
+        return;
+    }
 
-    for (auto& iter : m_input_ports) {
-        std::shared_ptr<t_port> input_port = iter.second;
-        std::shared_ptr<t_data_table> input_table = input_port->get_table();
-        input_table->promote_column(name, new_type, 0, false);
+    t_ctx_handle& ctxh = it->second;
+    bool shares_tree = false;
+    if (ctxh.get_type() == ONE_SIDED_CONTEXT) {
+        const t_ctx1* ctx = ctxh.get<t_ctx1>();
+        shares_tree = ctx->is_tree_follower() || ctx->is_tree_shared();
     }
 
-    m_output_schema.retype_column(name, new_type);
-    m_input_schema.retype_column(name, new_type);
-    m_transitional_schemas[0].retype_column(name, new_type);
+    if (shares_tree || ctxh.m_building) {
+        ctxh.m_thaw_priority = ctxh.m_priority;
+        ctxh.m_priority = CTX_PRIORITY_PAUSED;
+        ctxh.m_frozen = true;
+        return;
+    }
+
+    ctxh.m_frozen = true;
+    ctxh.m_frozen_at = m_num_processed;
+    m_frozen_contexts[name] = ctxh;
+    m_contexts.erase(it);
 }
 
-void
-t_gnode::pprint() const {
-    PSP_TRACE_SENTINEL();
-    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
-    m_gstate->pprint();
+bool
+t_gnode::thaw_context(const std::string& name) {
+    auto frozen = m_frozen_contexts.find(name);
+    if (frozen != m_frozen_contexts.end()) {
+        t_ctx_handle ctxh = frozen->second;
+        m_frozen_contexts.erase(frozen);
+        ctxh.m_frozen = false;
+        ctxh.m_stale = ctxh.m_stale || ctxh.m_frozen_at != m_num_processed;
+        m_contexts[name] = ctxh;
+        return _refresh_stale_contexts().count(ctxh.m_ctx) > 0;
+    }
+
+    auto it = m_contexts.find(name);
+    if (it == m_contexts.end() || !it->second.m_frozen) {
+        return false;
+    }
+
+    it->second.m_frozen = false;
+    return set_context_priority(name, it->second.m_thaw_priority);
 }
 
-template <typename CTX_T>
-void
-t_gnode::set_ctx_state(void* ptr) {
-    PSP_TRACE_SENTINEL();
-    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
-    CTX_T* ctx = static_cast<CTX_T*>(ptr);
-    ctx->set_state(m_gstate);
+bool
+t_gnode::is_context_frozen(const std::string& name) const {
+    if (m_frozen_contexts.count(name) > 0) {
+        return true;
+    }
+
+    auto it = m_contexts.find(name);
+    return it != m_contexts.end() && it->second.m_frozen;
 }
 
 void
-t_gnode::_update_contexts_from_state(std::shared_ptr<t_data_table> tbl) {
+t_gnode::set_context_memory_budget(const std::string& name, t_uindex nbytes) {
+    auto it = m_contexts.find(name);
+    if (it == m_contexts.end()) {
+        it = m_frozen_contexts.find(name);
+        if (it == m_frozen_contexts.end()) {
+            PSP_COMPLAIN_AND_ABORT("Context `" + name + "` not found");
+        }
+    }
+
+    it->second.m_memory_budget = nbytes;
+    _enforce_memory_budgets();
+}
+
+t_uindex
+t_gnode::get_context_memory_budget(const std::string& name) const {
+    auto it = m_contexts.find(name);
+    if (it != m_contexts.end()) {
+        return it->second.m_memory_budget;
+    }
+
+    auto frozen = m_frozen_contexts.find(name);
+    return frozen != m_frozen_contexts.end() ? frozen->second.m_memory_budget : 0;
+}
+
+t_uindex
+t_gnode::reclaim_context(const std::string& name) {
     PSP_TRACE_SENTINEL();
-    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    PSP_TRACE_SPAN_ARG("gnode.reclaim_context", name.c_str());
+    t_allocator_scope allocator_scope(m_allocator);
+    auto it = m_contexts.find(name);
+    if (it == m_contexts.end() || it->second.m_building) {
+        return 0;
+    }
+
+    const t_ctx_handle& ctxh = it->second;
+    t_uindex before = _get_context_nbytes(ctxh);
+    switch (ctxh.get_type()) {
+        case TWO_SIDED_CONTEXT: {
+            ctxh.get<t_ctx2>()->reclaim();
+        } break;
+        case ONE_SIDED_CONTEXT: {
+            ctxh.get<t_ctx1>()->reclaim();
+        } break;
+        default: {
+            // The traversal of a flat context is its data.
+        } break;
+    }
+
+    t_uindex after = _get_context_nbytes(ctxh);
+    return before > after ? before - after : 0;
+}
+
+t_uindex
+t_gnode::reclaim_memory(t_uindex nbytes) {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    t_uindex before = _get_contexts_nbytes();
+    _evict_cubes(0);
+    t_uindex after = _get_contexts_nbytes();
+    t_uindex released = before > after ? before - after : 0;
+
+    std::vector<std::pair<t_uindex, std::string>> contexts;
+    for (const auto& kv : m_contexts) {
+        contexts.push_back(std::make_pair(_get_context_nbytes(kv.second), kv.first));
+    }
+    std::sort(contexts.rbegin(), contexts.rend());
+
+    for (const auto& context : contexts) {
+        if (nbytes > 0 && released >= nbytes) {
+            break;
+        }
+        released += reclaim_context(context.second);
+    }
+
+    return released;
+}
+
+t_uindex
+t_gnode::_get_context_nbytes(const t_ctx_handle& ctxh) const {
+    std::map<std::string, t_uindex> usage;
+    switch (ctxh.get_type()) {
+        case TWO_SIDED_CONTEXT: {
+            usage = ctxh.get<t_ctx2>()->get_memory_usage();
+        } break;
+        case ONE_SIDED_CONTEXT: {
+            usage = ctxh.get<t_ctx1>()->get_memory_usage();
+        } break;
+        case ZERO_SIDED_CONTEXT: {
+            usage = ctxh.get<t_ctx0>()->get_memory_usage();
+        } break;
+        case GROUPED_PKEY_CONTEXT: {
+            usage = ctxh.get<t_ctx_grouped_pkey>()->get_memory_usage();
+        } break;
+        default: { PSP_COMPLAIN_AND_ABORT("Unexpected context type"); } break;
+    }
+
+    t_uindex rv = 0;
+    for (const auto& kv : usage) {
+        rv += kv.second;
+    }
+    return rv;
+}
+
+t_uindex
+t_gnode::_get_contexts_nbytes() const {
+    t_uindex rv = 0;
+    for (const auto& kv : m_contexts) {
+        rv += _get_context_nbytes(kv.second);
+    }
+    return rv;
+}
+
+void
+t_gnode::_enforce_memory_budgets() {
+    for (const auto& kv : m_contexts) {
+        const t_ctx_handle& ctxh = kv.second;
+        if (ctxh.m_memory_budget > 0 && _get_context_nbytes(ctxh) > ctxh.m_memory_budget) {
+            reclaim_context(kv.first);
+        }
+    }
+}
+
+bool
+t_gnode::build_context(const std::string& name, t_uindex max_rows) {
+    PSP_TRACE_SENTINEL();
+    PSP_TRACE_SPAN_ARG("gnode.build_context", name.c_str());
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    t_allocator_scope allocator_scope(m_allocator);
+    auto it = m_contexts.find(name);
+    if (it == m_contexts.end() || !it->second.m_building)
+        return true;
+
+    t_ctx_handle& ctxh = it->second;
+
+    // The rows read so far were changed by an update, so the context is
+    // rebuilt from the current state instead.
+    if (ctxh.m_stale) {
+        ctxh.m_building = false;
+        ctxh.m_build_offset = 0;
+        ctxh.m_build_table.reset();
+        _refresh_stale_contexts();
+        return true;
+    }
+
+    std::shared_ptr<t_data_table> flattened = ctxh.m_build_table;
+    t_uindex nrows = flattened->size();
+    t_uindex begin = ctxh.m_build_offset;
+    t_uindex end = nrows;
+
+    // A grouped context rebuilds its whole tree whenever it is notified.
+    if (max_rows > 0 && ctxh.m_ctx_type != GROUPED_PKEY_CONTEXT) {
+        end = std::min(nrows, begin + max_rows);
+    }
+
+    std::shared_ptr<t_data_table> rows = flattened;
+    if (begin > 0 || end < nrows) {
+        t_mask msk(nrows);
+        for (t_uindex idx = begin; idx < end; ++idx) {
+            msk.set(idx, true);
+        }
+        rows = flattened->clone(msk);
+    }
+
+    switch (ctxh.m_ctx_type) {
+        case TWO_SIDED_CONTEXT: {
+            update_context_from_state<t_ctx2>(ctxh.get<t_ctx2>(), rows);
+        } break;
+        case ONE_SIDED_CONTEXT: {
+            update_context_from_state<t_ctx1>(ctxh.get<t_ctx1>(), rows);
+        } break;
+        case ZERO_SIDED_CONTEXT: {
+            update_context_from_state<t_ctx0>(ctxh.get<t_ctx0>(), rows);
+        } break;
+        case GROUPED_PKEY_CONTEXT: {
+            update_context_from_state<t_ctx_grouped_pkey>(
+                ctxh.get<t_ctx_grouped_pkey>(), rows);
+        } break;
+        default: { PSP_COMPLAIN_AND_ABORT("Unexpected context type"); } break;
+    }
+
+    ctxh.m_build_offset = end;
+    if (end < nrows) {
+        return false;
+    }
+
+    ctxh.m_building = false;
+    ctxh.m_build_offset = 0;
+    ctxh.m_build_table.reset();
+    return true;
+}
+
+double
+t_gnode::get_context_build_progress(const std::string& name) const {
+    auto it = m_contexts.find(name);
+    if (it == m_contexts.end() || !it->second.m_building)
+        return 1.0;
+
+    const t_ctx_handle& ctxh = it->second;
+    t_uindex nrows = ctxh.m_build_table->size();
+    if (nrows == 0)
+        return 1.0;
+
+    return static_cast<double>(ctxh.m_build_offset) / static_cast<double>(nrows);
+}
+
+t_uindex
+t_gnode::mapping_size() const {
+    return m_gstate->mapping_size();
+}
+
+void
+t_gnode::set_num_threads(t_uindex num_threads) {
+    m_num_threads = num_threads;
+}
+
+t_uindex
+t_gnode::get_num_threads() const {
+    return m_num_threads;
+}
+
+void
+t_gnode::set_scheduler(std::shared_ptr<t_scheduler> scheduler) {
+    m_scheduler = scheduler;
+}
+
+std::shared_ptr<t_scheduler>
+t_gnode::get_scheduler() const {
+    return m_scheduler;
+}
+
+std::shared_ptr<t_allocator>
+t_gnode::get_allocator() const {
+    return m_allocator;
+}
+
+void
+t_gnode::set_notify_threads(t_uindex notify_threads) {
+    m_notify_threads = notify_threads;
+}
+
+t_uindex
+t_gnode::get_notify_threads() const {
+    return m_notify_threads;
+}
+
+t_data_table*
+t_gnode::_get_otable(t_uindex port_id) {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "Cannot `_get_otable` on an uninited gnode.");
+    PSP_VERBOSE_ASSERT(port_id < m_oports.size(), "Invalid port number");
+    return m_oports[port_id]->get_table().get();
+}
+
+t_data_table*
+t_gnode::_get_itable(t_uindex port_id) {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "Cannot `_get_itable` on an uninited gnode.");
+    PSP_VERBOSE_ASSERT(m_input_ports.count(port_id) != 0, "Invalid port number");
+    return m_input_ports[port_id]->get_table().get();
+}
+
+t_data_table*
+t_gnode::get_table() {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "Cannot `get_table` on an uninited gnode.");
+    return m_gstate->get_table().get();
+}
+
+const t_data_table*
+t_gnode::get_table() const {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "Cannot `get_table` on an uninited gnode.");
+    return m_gstate->get_table().get();
+}
+
+std::shared_ptr<t_data_table>
+t_gnode::get_table_sptr() {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "Cannot `get_table_sptr` on an uninited gnode.");
+    return m_gstate->get_table();
+}
+
+/**
+ * Convenience method for promoting a column.  This is a hack used to
+ * interop with javascript more efficiently, and does not handle all
+ * possible type conversions.  Non-public.
+ */
+void
+t_gnode::promote_column(const std::string& name, t_dtype new_type) {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "Cannot `promote_column` on an uninited gnode.");
+    get_table()->promote_column(name, new_type, 0, false);
+    _get_otable(0)->promote_column(name, new_type, 0, false);
+
+    for (auto& iter : m_input_ports) {
+        std::shared_ptr<t_port> input_port = iter.second;
+        std::shared_ptr<t_data_table> input_table = input_port->get_table();
+        input_table->promote_column(name, new_type, 0, false);
+    }
+
+    m_output_schema.retype_column(name, new_type);
+    m_input_schema.retype_column(name, new_type);
+    m_transitional_schemas[0].retype_column(name, new_type);
+}
+
+void
+t_gnode::pprint() const {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    m_gstate->pprint();
+}
+
+template <typename CTX_T>
+void
+t_gnode::set_ctx_state(void* ptr) {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    CTX_T* ctx = static_cast<CTX_T*>(ptr);
+    ctx->set_state(m_gstate);
+}
+
+void
+t_gnode::_update_contexts_from_state(std::shared_ptr<t_data_table> tbl) {
+    PSP_TRACE_SENTINEL();
+    PSP_TRACE_SPAN("gnode.update_contexts_from_state");
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+
+    // Computed columns are shared by every context, so compute them once.
+    if (tbl->size() > 0) {
+        _compute_all_columns({tbl});
+    }
 
     for (auto& kv : m_contexts) {
         auto& ctxh = kv.second;
+        ctxh.m_stale = false;
+        ctxh.m_building = false;
+        ctxh.m_build_offset = 0;
+        ctxh.m_build_table.reset();
         switch (ctxh.m_ctx_type) {
             case TWO_SIDED_CONTEXT: {
                 auto ctx = static_cast<t_ctx2*>(ctxh.m_ctx);
@@ -693,7 +1343,8 @@ t_gnode::_update_contexts_from_state(std::shared_ptr<t_data_table> tbl) {
             case ONE_SIDED_CONTEXT: {
                 auto ctx = static_cast<t_ctx1*>(ctxh.m_ctx);
                 ctx->reset();
-                update_context_from_state<t_ctx1>(ctx, tbl);
+                if (!ctx->is_tree_follower())
+                    update_context_from_state<t_ctx1>(ctx, tbl);
             } break;
             case ZERO_SIDED_CONTEXT: {
                 auto ctx = static_cast<t_ctx0*>(ctxh.m_ctx);
@@ -708,6 +1359,11 @@ t_gnode::_update_contexts_from_state(std::shared_ptr<t_data_table> tbl) {
             default: { PSP_COMPLAIN_AND_ABORT("Unexpected context type"); } break;
         }
     }
+
+    for (auto& kv : m_totals) {
+        kv.second->reset();
+        kv.second->update_from_state(*tbl);
+    }
 }
 
 std::vector<std::string>
@@ -746,20 +1402,27 @@ t_gnode::get_registered_contexts() const {
 }
 
 void
-t_gnode::_register_context(const std::string& name, t_ctx_type type, std::int64_t ptr) {
+t_gnode::_register_context(
+    const std::string& name, t_ctx_type type, std::int64_t ptr, bool deferred) {
     PSP_TRACE_SENTINEL();
     PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    t_allocator_scope allocator_scope(m_allocator);
     void* ptr_ = reinterpret_cast<void*>(ptr);
     t_ctx_handle ch(ptr_, type);
     m_contexts[name] = ch;
+    m_context_latency[name] = std::make_shared<t_context_latency>();
+
+    // Columns the context reads are reloaded before it reads its rows.
+    spill_cold_columns();
 
-    bool should_update = m_gstate->mapping_size() > 0;
+    bool has_rows = m_gstate->mapping_size() > 0;
+    bool should_update = has_rows && !deferred;
 
     // TODO: shift columns forward in cleanup, translate dead indices
     std::shared_ptr<t_data_table> flattened;
 
-    if (should_update) {
-        flattened = m_gstate->get_pkeyed_table();
+    if (has_rows) {
+        flattened = _get_context_rows(type, ptr_);
     }
 
     std::vector<t_computed_column_definition> computed_columns;
@@ -770,7 +1433,7 @@ t_gnode::_register_context(const std::string& name, t_ctx_type type, std::int64_
             t_ctx2* ctx = static_cast<t_ctx2*>(ptr_);
             ctx->reset();
             computed_columns = ctx->get_config().get_computed_columns();
-            m_computed_column_map.add_computed_columns(computed_columns);
+            _register_computed_columns(computed_columns, flattened);
             if (should_update)
                 update_context_from_state<t_ctx2>(ctx, flattened);
         } break;
@@ -779,16 +1442,22 @@ t_gnode::_register_context(const std::string& name, t_ctx_type type, std::int64_
             t_ctx1* ctx = static_cast<t_ctx1*>(ptr_);
             ctx->reset();
             computed_columns = ctx->get_config().get_computed_columns();
-            m_computed_column_map.add_computed_columns(computed_columns);
-            if (should_update)
+            _register_computed_columns(computed_columns, flattened);
+            t_ctx1* leader = _find_tree_leader(ctx);
+            if (leader) {
+                ctx->share_tree(leader);
+                _touch_cube(leader);
+                deferred = false;
+            } else if (should_update) {
                 update_context_from_state<t_ctx1>(ctx, flattened);
+            }
         } break;
         case ZERO_SIDED_CONTEXT: {
             set_ctx_state<t_ctx0>(ptr_);
             t_ctx0* ctx = static_cast<t_ctx0*>(ptr_);
             ctx->reset();
             computed_columns = ctx->get_config().get_computed_columns();
-            m_computed_column_map.add_computed_columns(computed_columns);
+            _register_computed_columns(computed_columns, flattened);
             if (should_update)
                 update_context_from_state<t_ctx0>(ctx, flattened);
         } break;
@@ -797,25 +1466,98 @@ t_gnode::_register_context(const std::string& name, t_ctx_type type, std::int64_
             auto ctx = static_cast<t_ctx_grouped_pkey*>(ptr_);
             ctx->reset();
             computed_columns = ctx->get_config().get_computed_columns();
-            m_computed_column_map.add_computed_columns(computed_columns);
+            _register_computed_columns(computed_columns, flattened);
             if (should_update)
                 update_context_from_state<t_ctx_grouped_pkey>(ctx, flattened);
         } break;
         default: { PSP_COMPLAIN_AND_ABORT("Unexpected context type"); } break;
     }
 
-    // When a context is registered, compute its columns on the master table
+    // When a context is registered, add its columns to the master table
     // so the columns will exist when updates, etc. are processed.
     std::shared_ptr<t_data_table> gstate_table = get_table_sptr();
     for (const auto& computed : computed_columns) {
         _add_computed_column(computed, gstate_table);
     }
+
+    // The rows of the state are read from `flattened`, with its computed
+    // columns, by `build_context`.
+    if (deferred && has_rows) {
+        t_ctx_handle& ctxh = m_contexts[name];
+        ctxh.m_building = true;
+        ctxh.m_build_table = flattened;
+    }
+
+    // A new context sharing the tree of a paused context reads it now.
+    _refresh_stale_contexts();
+}
+
+t_ctx1*
+t_gnode::_find_tree_leader(const t_ctx1* ctx) const {
+    if (!ctx->can_share_tree())
+        return nullptr;
+
+    std::string signature = ctx->get_config().get_tree_signature();
+
+    for (const auto& kv : m_contexts) {
+        const t_ctx_handle& ctxh = kv.second;
+        if (ctxh.get_type() != ONE_SIDED_CONTEXT || ctxh.m_ctx == ctx)
+            continue;
+
+        t_ctx1* other = ctxh.get<t_ctx1>();
+        if (!other->is_tree_follower() && other->can_share_tree()
+            && other->get_config().get_tree_signature() == signature) {
+            return other;
+        }
+    }
+
+    return nullptr;
+}
+
+std::shared_ptr<t_data_table>
+t_gnode::_get_context_rows(t_ctx_type type, void* ptr) {
+    const t_config* config = nullptr;
+    switch (type) {
+        case TWO_SIDED_CONTEXT: {
+            config = &static_cast<t_ctx2*>(ptr)->get_config();
+        } break;
+        case ONE_SIDED_CONTEXT: {
+            config = &static_cast<t_ctx1*>(ptr)->get_config();
+        } break;
+        case ZERO_SIDED_CONTEXT: {
+            config = &static_cast<t_ctx0*>(ptr)->get_config();
+        } break;
+        default: {
+            // A grouped pkey context reads the state itself.
+        } break;
+    }
+
+    // The filters are still applied to the rows the indexes match, so a
+    // context that is not built from them sees the same rows.
+    t_mask mask;
+    if (config && m_gstate->get_index_mask(*config, mask)) {
+        return std::shared_ptr<t_data_table>(
+            m_gstate->_get_pkeyed_table(m_gstate->get_input_schema(), mask));
+    }
+
+    return m_gstate->get_pkeyed_table();
 }
 
 void
 t_gnode::_unregister_context(const std::string& name) {
     PSP_TRACE_SENTINEL();
     PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+
+    // A frozen context is unregistered like a paused one, so that its tree
+    // is not retained.
+    auto frozen = m_frozen_contexts.find(name);
+    if (frozen != m_frozen_contexts.end()) {
+        t_ctx_handle ctxh = frozen->second;
+        m_frozen_contexts.erase(frozen);
+        ctxh.m_stale = true;
+        m_contexts[name] = ctxh;
+    }
+
     auto it = m_contexts.find(name);
     if (it == m_contexts.end()) return;
 
@@ -832,16 +1574,31 @@ t_gnode::_unregister_context(const std::string& name) {
             for (const auto& c : computed_columns) {
                 computed_column_names.push_back(std::get<0>(c));
             }
-            m_computed_column_map.remove_computed_columns(computed_column_names);
         } break;
         case ONE_SIDED_CONTEXT: {
             t_ctx1* ctx = static_cast<t_ctx1*>(ctxh.m_ctx);
+            // The follower that takes over a stale or partly built tree
+            // must rebuild it.
+            if (ctxh.m_stale || ctxh.m_building) {
+                for (auto& kv : m_contexts) {
+                    t_ctx_handle& other = kv.second;
+                    if (other.get_type() == ONE_SIDED_CONTEXT
+                        && other.get<t_ctx1>()->get_tree_leader() == ctx) {
+                        other.m_stale = true;
+                    }
+                }
+            }
+            if (!ctxh.m_stale && !ctxh.m_building && !ctx->is_tree_follower()
+                && !ctx->is_tree_shared() && ctx->can_share_tree() && !_is_cube(name)
+                && t_env::cube_cache_size() > 0) {
+                _retain_cube(ctx);
+            }
+            ctx->leave_tree_group();
             auto computed_columns = ctx->get_config().get_computed_columns();
             computed_column_names.reserve(computed_columns.size());
             for (const auto& c : computed_columns) {
                 computed_column_names.push_back(std::get<0>(c));
             }
-            m_computed_column_map.remove_computed_columns(computed_column_names);
         } break;
         case ZERO_SIDED_CONTEXT: {
             t_ctx0* ctx = static_cast<t_ctx0*>(ctxh.m_ctx);
@@ -850,7 +1607,6 @@ t_gnode::_unregister_context(const std::string& name) {
             for (const auto& c : computed_columns) {
                 computed_column_names.push_back(std::get<0>(c));
             }
-            m_computed_column_map.remove_computed_columns(computed_column_names);
         } break;
         case GROUPED_PKEY_CONTEXT: {
             auto ctx = static_cast<t_ctx_grouped_pkey*>(ctxh.m_ctx);
@@ -859,88 +1615,657 @@ t_gnode::_unregister_context(const std::string& name) {
             for (const auto& c : computed_columns) {
                 computed_column_names.push_back(std::get<0>(c));
             }
-            m_computed_column_map.remove_computed_columns(computed_column_names);
         } break;
         default: { PSP_COMPLAIN_AND_ABORT("Unexpected context type"); } break;
     }
 
     PSP_VERBOSE_ASSERT(it != m_contexts.end(), "Context not found.");
 
-    m_contexts.erase(name);
+    m_contexts.erase(name);
+    m_context_latency.erase(name);
+
+    // Computed columns that no other context declares are dropped.
+    std::vector<std::string> removed
+        = m_computed_column_map.remove_computed_columns(computed_column_names);
+    _drop_computed_columns(removed);
+    _update_computed_expressions();
+
+    if (!_is_cube(name)) {
+        _evict_cubes(t_env::cube_cache_size());
+    }
+}
+
+void
+t_gnode::_retain_cube(t_ctx1* ctx) {
+    std::stringstream ss;
+    ss << "__psp_cube_" << m_last_cube_id++;
+    std::string name = ss.str();
+
+    // The cube takes over the tree as its leader's only follower, and reads
+    // the computed columns it was built with for as long as it is kept.
+    auto cube = std::make_shared<t_ctx1>(ctx->get_schema(), ctx->get_config());
+    cube->init();
+    set_ctx_state<t_ctx1>(cube.get());
+    cube->share_tree(ctx);
+    m_computed_column_map.add_computed_columns(cube->get_config().get_computed_columns());
+
+    t_ctx_handle ctxh(cube.get(), ONE_SIDED_CONTEXT);
+    ctxh.m_priority = CTX_PRIORITY_BACKGROUND;
+    m_contexts[name] = ctxh;
+    m_cubes.emplace_front(name, cube);
+}
+
+void
+t_gnode::_touch_cube(const t_ctx1* cube) {
+    for (auto iter = m_cubes.begin(); iter != m_cubes.end(); ++iter) {
+        if (iter->second.get() == cube) {
+            m_cubes.splice(m_cubes.begin(), m_cubes, iter);
+            return;
+        }
+    }
+}
+
+void
+t_gnode::_evict_cubes(t_uindex size) {
+    while (m_cubes.size() > size) {
+        // Unregistered first, so its tree passes to any context sharing it.
+        _unregister_context(m_cubes.back().first);
+        m_cubes.pop_back();
+    }
+}
+
+bool
+t_gnode::_is_cube(const std::string& name) const {
+    for (const auto& kv : m_cubes) {
+        if (kv.first == name) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void
+t_gnode::_register_computed_columns(
+    const std::vector<t_computed_column_definition>& computed_columns,
+    std::shared_ptr<t_data_table> flattened) {
+    m_computed_column_map.add_computed_columns(computed_columns);
+    _update_computed_expressions();
+
+    if (!flattened || flattened->size() == 0) {
+        return;
+    }
+
+    // The master table already holds every computed column that is not
+    // stale, so only those need computing; a copy of it holds none.
+    std::shared_ptr<t_data_table> gstate_table = get_table_sptr();
+    std::set<std::string> stale = m_computed_column_map.m_stale_columns;
+    _compute_all_columns({gstate_table}, &stale);
+    m_computed_column_map.m_stale_columns.clear();
+
+    if (flattened != gstate_table) {
+        _compute_all_columns({flattened});
+    }
+}
+
+void
+t_gnode::_drop_computed_columns(const std::vector<std::string>& names) {
+    if (names.empty()) {
+        return;
+    }
+
+    get_table()->reindex(names);
+
+    for (const auto& port : m_oports) {
+        std::shared_ptr<t_data_table> table = port->get_table();
+        if (table && table.get() != get_table()) {
+            table->reindex(names);
+        }
+    }
+}
+
+std::set<std::string>
+t_gnode::_get_referenced_columns() const {
+    std::set<std::string> referenced;
+
+    // Frozen contexts read their columns again once thawed.
+    std::vector<const t_ctx_handle*> handles;
+    for (const auto& kv : m_contexts) {
+        handles.push_back(&kv.second);
+    }
+    for (const auto& kv : m_frozen_contexts) {
+        handles.push_back(&kv.second);
+    }
+
+    for (const t_ctx_handle* handle : handles) {
+        const t_ctx_handle& ctxh = *handle;
+        const t_config* config = nullptr;
+
+        switch (ctxh.get_type()) {
+            case TWO_SIDED_CONTEXT: {
+                config = &ctxh.get<t_ctx2>()->get_config();
+            } break;
+            case ONE_SIDED_CONTEXT: {
+                config = &ctxh.get<t_ctx1>()->get_config();
+            } break;
+            case ZERO_SIDED_CONTEXT: {
+                config = &ctxh.get<t_ctx0>()->get_config();
+            } break;
+            case GROUPED_PKEY_CONTEXT: {
+                config = &ctxh.get<t_ctx_grouped_pkey>()->get_config();
+                referenced.insert(config->get_parent_pkey_column());
+                referenced.insert(config->get_child_pkey_column());
+                referenced.insert(config->get_grouping_label_column());
+            } break;
+            default: { PSP_COMPLAIN_AND_ABORT("Unexpected context type"); } break;
+        }
+
+        for (const std::string& name : config->get_column_names()) {
+            referenced.insert(name);
+        }
+
+        for (const t_aggspec& aggspec : config->get_aggregates()) {
+            for (const t_dep& dep : aggspec.get_dependencies()) {
+                referenced.insert(dep.name());
+            }
+        }
+
+        for (const t_pivot& pivot : config->get_row_pivots()) {
+            referenced.insert(pivot.colname());
+        }
+
+        for (const t_pivot& pivot : config->get_column_pivots()) {
+            referenced.insert(pivot.colname());
+        }
+
+        for (const t_sortspec& sortspec : config->get_sortspecs()) {
+            referenced.insert(sortspec.m_colname);
+        }
+
+        for (const t_sortspec& sortspec : config->get_col_sortspecs()) {
+            referenced.insert(sortspec.m_colname);
+        }
+
+        for (const std::string& name : config->get_filter_columns()) {
+            referenced.insert(name);
+        }
+    }
+
+    for (const auto& kv : m_totals) {
+        for (const std::string& name : kv.second->get_referenced_columns()) {
+            referenced.insert(name);
+        }
+    }
+
+    return referenced;
+}
+
+void
+t_gnode::_update_computed_expressions() {
+    m_computed_column_map.update_expressions(_get_referenced_columns());
+}
+
+void
+t_gnode::notify_contexts(const t_data_table& flattened) {
+    notify_contexts(flattened, CTX_PRIORITY_VISIBLE);
+    notify_contexts(flattened, CTX_PRIORITY_BACKGROUND);
+}
+
+bool
+t_gnode::notify_contexts(const t_data_table& flattened, t_ctx_priority priority) {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    PSP_TRACE_SPAN_ARG("gnode.notify_contexts",
+        priority == CTX_PRIORITY_VISIBLE ? "visible" : "background");
+    psp_log_time(repr() + "notify_contexts.enter");
+    std::vector<t_ctx_handle> ctxhvec;
+    std::vector<const char*> ctxnames;
+    ctxhvec.reserve(m_contexts.size());
+    ctxnames.reserve(m_contexts.size());
+
+    for (std::map<std::string, t_ctx_handle>::const_iterator iter = m_contexts.begin(); iter != m_contexts.end();
+         ++iter) {
+        // a context sharing another's tree is notified along with it
+        const t_ctx_handle& ctxh = iter->second;
+        if (ctxh.get_type() == ONE_SIDED_CONTEXT && ctxh.get<t_ctx1>()->is_tree_follower())
+            continue;
+        if (_get_effective_priority(ctxh) != priority)
+            continue;
+        ctxhvec.push_back(ctxh);
+        ctxnames.push_back(iter->first.c_str());
+    }
+
+    t_index num_ctx = ctxhvec.size();
+
+    // Each context writes only its own slot.
+    std::vector<std::int64_t> ctx_ns(num_ctx);
+    std::vector<std::int64_t> ctx_end(num_ctx);
+    std::int64_t begin = t_tracer::now();
+
+    auto notify_context_helper = [this, &ctxhvec, &ctxnames, &ctx_ns, &ctx_end, &flattened](
+                                     t_index ctxidx) {
+        PSP_TRACE_SPAN_ARG("ctx.notify", ctxnames[ctxidx]);
+        std::int64_t ctx_begin = t_tracer::now();
+        const t_ctx_handle& ctxh = ctxhvec[ctxidx];
+        switch (ctxh.get_type()) {
+            case TWO_SIDED_CONTEXT: {
+                PSP_TRACE_SPAN("ctx2.notify");
+                notify_context<t_ctx2>(flattened, ctxh);
+            } break;
+            case ONE_SIDED_CONTEXT: {
+                PSP_TRACE_SPAN("ctx1.notify");
+                notify_context<t_ctx1>(flattened, ctxh);
+            } break;
+            case ZERO_SIDED_CONTEXT: {
+                PSP_TRACE_SPAN("ctx0.notify");
+                notify_context<t_ctx0>(flattened, ctxh);
+            } break;
+            case GROUPED_PKEY_CONTEXT: {
+                PSP_TRACE_SPAN("ctx_grouped_pkey.notify");
+                notify_context<t_ctx_grouped_pkey>(flattened, ctxh);
+            } break;
+            default: { PSP_COMPLAIN_AND_ABORT("Unexpected context type"); } break;
+        }
+        ctx_end[ctxidx] = t_tracer::now();
+        ctx_ns[ctxidx] = ctx_end[ctxidx] - ctx_begin;
+    };
+
+    m_scheduler->parallel_for(num_ctx, notify_context_helper, m_notify_threads);
+
+    m_update_stats.m_notify_ns += t_tracer::now() - begin;
+    std::map<void*, t_index> notified;
+    for (t_index ctxidx = 0; ctxidx < num_ctx; ++ctxidx) {
+        m_update_stats.m_context_notify_ns.emplace_back(ctxnames[ctxidx], ctx_ns[ctxidx]);
+        notified[ctxhvec[ctxidx].m_ctx] = ctxidx;
+    }
+
+    // Followers are notified with the tree they share, so wait for the
+    // callback from when it was.
+    for (const auto& kv : m_contexts) {
+        const t_ctx_handle& ctxh = kv.second;
+        void* owner = ctxh.m_ctx;
+        if (ctxh.get_type() == ONE_SIDED_CONTEXT && ctxh.get<t_ctx1>()->is_tree_follower()) {
+            owner = ctxh.get<t_ctx1>()->get_tree_leader();
+        }
+
+        auto iter = notified.find(owner);
+        auto latency = m_context_latency.find(kv.first);
+        if (iter == notified.end() || latency == m_context_latency.end())
+            continue;
+
+        if (owner == ctxh.m_ctx) {
+            latency->second->m_notify.record(ctx_ns[iter->second]);
+        }
+        latency->second->m_notified_at = ctx_end[iter->second];
+    }
+
+    psp_log_time(repr() + "notify_contexts.exit");
+    return num_ctx > 0;
+}
+
+t_ctx_priority
+t_gnode::_get_effective_priority(const t_ctx_handle& ctxh) const {
+    if (ctxh.m_building) {
+        return CTX_PRIORITY_PAUSED;
+    }
+
+    t_ctx_priority priority = ctxh.m_priority;
+    if (ctxh.get_type() != ONE_SIDED_CONTEXT) {
+        return priority;
+    }
+
+    const t_ctx1* ctx = ctxh.get<t_ctx1>();
+    for (const auto& kv : m_contexts) {
+        const t_ctx_handle& other = kv.second;
+        if (other.get_type() == ONE_SIDED_CONTEXT && other.get<t_ctx1>()->get_tree_leader() == ctx) {
+            priority = std::min(priority, other.m_priority);
+        }
+    }
+
+    return priority;
+}
+
+void
+t_gnode::_mark_paused_contexts_stale() {
+    for (auto& kv : m_contexts) {
+        t_ctx_handle& ctxh = kv.second;
+        if (ctxh.get_type() == ONE_SIDED_CONTEXT && ctxh.get<t_ctx1>()->is_tree_follower())
+            continue;
+        if (_get_effective_priority(ctxh) == CTX_PRIORITY_PAUSED) {
+            ctxh.m_stale = true;
+        }
+    }
+}
+
+std::set<std::string>
+t_gnode::_get_transitional_columns() const {
+    std::set<std::string> rval;
+
+    for (const auto& kv : m_contexts) {
+        const t_ctx_handle& ctxh = kv.second;
+        if (_get_effective_priority(ctxh) == CTX_PRIORITY_PAUSED)
+            continue;
+
+        std::set<std::string> columns;
+        switch (ctxh.get_type()) {
+            case TWO_SIDED_CONTEXT: {
+                columns = ctxh.get<t_ctx2>()->get_transitional_columns();
+            } break;
+            case ONE_SIDED_CONTEXT: {
+                columns = ctxh.get<t_ctx1>()->get_transitional_columns();
+            } break;
+            case ZERO_SIDED_CONTEXT: {
+                columns = ctxh.get<t_ctx0>()->get_transitional_columns();
+            } break;
+            case GROUPED_PKEY_CONTEXT: {
+                columns = ctxh.get<t_ctx_grouped_pkey>()->get_transitional_columns();
+            } break;
+            default: { PSP_COMPLAIN_AND_ABORT("Unexpected context type"); } break;
+        }
+
+        rval.insert(columns.begin(), columns.end());
+    }
+
+    // Computed columns are computed on the transitional tables from the
+    // columns they read.
+    for (const std::string& name : m_computed_column_map.m_transitional_columns) {
+        auto expression = m_computed_column_map.get_expression(name);
+        if (!expression) {
+            continue;
+        }
+
+        for (const t_computed_expression* leaf : expression->get_leaves()) {
+            if (!leaf->is_computed()) {
+                rval.insert(leaf->get_column_name());
+            }
+        }
+    }
+
+    return rval;
+}
+
+std::set<void*>
+t_gnode::_refresh_stale_contexts() {
+    std::set<void*> refreshed;
+    std::shared_ptr<t_data_table> flattened;
+
+    for (auto& kv : m_contexts) {
+        t_ctx_handle& ctxh = kv.second;
+        if (!ctxh.m_stale || _get_effective_priority(ctxh) == CTX_PRIORITY_PAUSED)
+            continue;
+
+        if (!flattened) {
+            flattened = m_gstate->get_pkeyed_table();
+            if (flattened != get_table_sptr() && flattened->size() > 0) {
+                _compute_all_columns({flattened});
+            }
+        }
+
+        switch (ctxh.m_ctx_type) {
+            case TWO_SIDED_CONTEXT: {
+                auto ctx = static_cast<t_ctx2*>(ctxh.m_ctx);
+                ctx->reset();
+                update_context_from_state<t_ctx2>(ctx, flattened);
+            } break;
+            case ONE_SIDED_CONTEXT: {
+                // A context left owning a stale tree by its leader is rebuilt
+                // once it owns it, but not while it follows another.
+                auto ctx = static_cast<t_ctx1*>(ctxh.m_ctx);
+                if (!ctx->is_tree_follower()) {
+                    ctx->reset();
+                    update_context_from_state<t_ctx1>(ctx, flattened);
+                }
+            } break;
+            case ZERO_SIDED_CONTEXT: {
+                auto ctx = static_cast<t_ctx0*>(ctxh.m_ctx);
+                ctx->reset();
+                update_context_from_state<t_ctx0>(ctx, flattened);
+            } break;
+            case GROUPED_PKEY_CONTEXT: {
+                auto ctx = static_cast<t_ctx_grouped_pkey*>(ctxh.m_ctx);
+                ctx->reset();
+                update_context_from_state<t_ctx_grouped_pkey>(ctx, flattened);
+            } break;
+            default: { PSP_COMPLAIN_AND_ABORT("Unexpected context type"); } break;
+        }
+
+        ctxh.m_stale = false;
+        refreshed.insert(ctxh.m_ctx);
+    }
+
+    return refreshed;
+}
+
+/******************************************************************************
+ *
+ * Computed Column Operations
+ */
+
+void
+t_gnode::_recompute_all_columns(
+    std::shared_ptr<t_data_table> tbl,
+    std::shared_ptr<t_data_table> flattened,
+    const std::vector<t_rlookup>& changed_rows) {
+    const auto& computed_columns = m_computed_column_map.m_computed_columns;
+    if (computed_columns.size() == 0) {
+        return;
+    }
+
+    // New rows need every computed column, whichever inputs they set.
+    bool recompute_all = changed_rows.empty();
+    for (const t_rlookup& lookup : changed_rows) {
+        if (!lookup.m_exists) {
+            recompute_all = true;
+            break;
+        }
+    }
+
+    std::set<std::string> affected;
+
+    if (!recompute_all) {
+        // The transitions table is only written after computed columns are,
+        // so read which inputs this update set from `flattened` instead.
+        std::set<std::string> changed;
+        const t_schema& schema = flattened->get_schema();
+
+        for (t_uindex idx = 0, loop_end = schema.size(); idx < loop_end; ++idx) {
+            const std::string& name = schema.m_columns[idx];
+            if (computed_columns.count(name) == 0
+                && _is_column_updated(*flattened->get_const_column(idx))) {
+                changed.insert(name);
+            }
+        }
+
+        affected = m_computed_column_map.get_affected_columns(changed);
+    }
+
+    // Adding columns is not thread-safe, so every column is added first.
+    for (const auto& computed : computed_columns) {
+        _add_computed_column(computed.second, flattened);
+    }
+
+    // Leave unaffected and unmaterialized columns unset, so that the master
+    // table keeps their values.
+    std::vector<std::shared_ptr<t_column>> unaffected;
+    for (const auto& computed : computed_columns) {
+        const std::string& name = computed.first;
+        bool is_recomputed = (recompute_all || affected.count(name))
+            && m_computed_column_map.get_expression(name);
+
+        if (!is_recomputed
+            && std::get<3>(computed.second).m_name != INVALID_COMPUTED_FUNCTION) {
+            unaffected.push_back(flattened->get_column(name));
+        }
+    }
+
+    _run_tasks(unaffected.size(), [&unaffected, &flattened](t_uindex cidx) {
+        t_column& output_column = *unaffected[cidx];
+        for (t_uindex idx = 0, loop_end = flattened->size(); idx < loop_end; ++idx) {
+            output_column.clear(idx);
+        }
+    });
+
+    for (const auto& level : m_computed_column_map.m_levels) {
+        std::vector<const t_computed_column_definition*> columns;
+        for (const std::string& name : level) {
+            if (recompute_all || affected.count(name)) {
+                columns.push_back(&computed_columns.at(name));
+            }
+        }
+
+        _run_tasks(columns.size(), [&columns, &tbl, &flattened, &changed_rows, this](t_uindex cidx) {
+            _recompute_column(*columns[cidx], tbl, flattened, changed_rows);
+        });
+    }
+}
+
+void
+t_gnode::_run_tasks(t_uindex num_tasks, const std::function<void(t_uindex)>& task) const {
+    m_scheduler->parallel_for(num_tasks, task, m_num_threads);
+}
+
+bool
+t_gnode::_is_column_updated(const t_column& column) const {
+    if (!column.is_status_enabled()) {
+        return column.size() > 0;
+    }
+
+    const t_status* status = column.get_nth_status(0);
+    for (t_uindex idx = 0, loop_end = column.size(); idx < loop_end; ++idx) {
+        if (status[idx] != STATUS_INVALID) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+std::shared_ptr<t_data_table>
+t_gnode::_get_flattened_table(const t_data_table& tbl) {
+    std::shared_ptr<t_data_table> flattened = m_oports[PSP_PORT_FLATTENED]->get_table();
+
+    // Held only by the port and by `flattened` itself
+    if (flattened && flattened.use_count() == 2
+        && _is_recyclable(*flattened, tbl.get_schema())) {
+        flattened->recycle();
+        return flattened;
+    }
+
+    flattened = std::make_shared<t_data_table>(
+        "", "", tbl.get_schema(), DEFAULT_EMPTY_CAPACITY, BACKING_STORE_MEMORY);
+    flattened->set_alloc_owner(ALLOC_OWNER_TRANSITIONAL);
+    flattened->init();
+    return flattened;
+}
+
+bool
+t_gnode::_is_append(const t_data_table& flattened) const {
+    const t_column* pkey_col = flattened.get_const_column("psp_pkey").get();
+    if (flattened.size() == 0 || m_gstate->mapping_size() == 0
+        || pkey_col->get_dtype() == DTYPE_STR || !m_max_pkey.is_valid()) {
+        return false;
+    }
+
+    return m_max_pkey < pkey_col->get_scalar(0);
 }
 
 void
-t_gnode::notify_contexts(const t_data_table& flattened) {
-    PSP_TRACE_SENTINEL();
-    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
-    psp_log_time(repr() + "notify_contexts.enter");
-    t_index num_ctx = m_contexts.size();
-    std::vector<t_ctx_handle> ctxhvec(num_ctx);
-
-    t_index ctxh_count = 0;
-    for (std::map<std::string, t_ctx_handle>::const_iterator iter = m_contexts.begin(); iter != m_contexts.end();
-         ++iter) {
-        ctxhvec[ctxh_count] = iter->second;
-        ctxh_count++;
+t_gnode::_update_max_pkey(const t_data_table& flattened) {
+    const t_column* pkey_col = flattened.get_const_column("psp_pkey").get();
+    if (pkey_col->get_dtype() == DTYPE_STR) {
+        return;
     }
 
-    auto notify_context_helper = [this, &ctxhvec, &flattened](t_index ctxidx) {
-        const t_ctx_handle& ctxh = ctxhvec[ctxidx];
-        switch (ctxh.get_type()) {
-            case TWO_SIDED_CONTEXT: {
-                notify_context<t_ctx2>(flattened, ctxh);
-            } break;
-            case ONE_SIDED_CONTEXT: {
-                notify_context<t_ctx1>(flattened, ctxh);
-            } break;
-            case ZERO_SIDED_CONTEXT: {
-                notify_context<t_ctx0>(flattened, ctxh);
-            } break;
-            case GROUPED_PKEY_CONTEXT: {
-                notify_context<t_ctx_grouped_pkey>(flattened, ctxh);
-            } break;
-            default: { PSP_COMPLAIN_AND_ABORT("Unexpected context type"); } break;
+    for (t_uindex idx = flattened.size(); idx > 0; --idx) {
+        t_tscalar pkey = pkey_col->get_scalar(idx - 1);
+        if (pkey.is_valid()) {
+            if (!m_max_pkey.is_valid() || m_max_pkey < pkey) {
+                m_max_pkey = pkey;
+            }
+            return;
         }
-    };
+    }
+}
 
-    #ifdef PSP_PARALLEL_FOR
-    tbb::parallel_for(0, int(num_ctx), 1,
-        [&notify_context_helper](int ctxidx)
-    #else
-    for (t_index ctxidx = 0; ctxidx < num_ctx; ++ctxidx)
-    #endif
-        { notify_context_helper(ctxidx); }
-    #ifdef PSP_PARALLEL_FOR
-        );
-    #endif
+void
+t_gnode::_reset_max_pkey() {
+    m_max_pkey.clear();
+    std::shared_ptr<t_data_table> table = get_table_sptr();
+    const t_column* pkey_col = table->get_const_column("psp_pkey").get();
+    if (pkey_col->get_dtype() == DTYPE_STR) {
+        return;
+    }
 
-    psp_log_time(repr() + "notify_contexts.exit");
+    for (t_uindex idx = 0, loop_end = table->size(); idx < loop_end; ++idx) {
+        t_tscalar pkey = pkey_col->get_scalar(idx);
+        if (pkey.is_valid() && (!m_max_pkey.is_valid() || m_max_pkey < pkey)) {
+            m_max_pkey = pkey;
+        }
+    }
 }
 
-/******************************************************************************
- *
- * Computed Column Operations
- */
-
-void
-t_gnode::_recompute_all_columns(
-    std::shared_ptr<t_data_table> tbl,
-    std::shared_ptr<t_data_table> flattened,
-    const std::vector<t_rlookup>& changed_rows) {
+bool
+t_gnode::_is_recyclable(const t_data_table& tbl, const t_schema& schema) const {
+    const t_schema& tbl_schema = tbl.get_schema();
     const auto& computed_columns = m_computed_column_map.m_computed_columns;
+
+    if (tbl_schema.size() != schema.size() + computed_columns.size()) {
+        return false;
+    }
+
+    for (t_uindex idx = 0, loop_end = schema.size(); idx < loop_end; ++idx) {
+        if (tbl_schema.m_columns[idx] != schema.m_columns[idx]
+            || tbl_schema.m_types[idx] != schema.m_types[idx]) {
+            return false;
+        }
+    }
+
+    // A computed column re-registered under the same name may have changed
+    // its return type.
     for (const auto& computed : computed_columns) {
-        _recompute_column(computed.second, tbl, flattened, changed_rows);
+        const std::string& name = computed.first;
+        t_dtype dtype = std::get<3>(computed.second).m_return_type;
+        if (!tbl_schema.has_column(name) || tbl_schema.get_dtype(name) != dtype) {
+            return false;
+        }
     }
+
+    return true;
 }
 
 void
 t_gnode::_compute_all_columns(
-    std::vector<std::shared_ptr<t_data_table>> tables) {
+    std::vector<std::shared_ptr<t_data_table>> tables,
+    const std::set<std::string>* only_columns) {
     const auto& computed_columns = m_computed_column_map.m_computed_columns;
+    if (computed_columns.size() == 0) {
+        return;
+    }
+
+    // Adding columns is not thread-safe, so every column is added first.
     for (std::shared_ptr<t_data_table> table : tables) {
         for (const auto& computed : computed_columns) {
-            _compute_column(computed.second, table);
+            _add_computed_column(computed.second, table);
+        }
+    }
+
+    // Each computed column of each table is computed independently of the
+    // others in its level.
+    for (const auto& all_level : m_computed_column_map.m_levels) {
+        std::vector<std::string> level;
+        for (const std::string& name : all_level) {
+            if (!only_columns || only_columns->count(name)) {
+                level.push_back(name);
+            }
         }
+
+        t_uindex num_columns = level.size();
+        t_uindex num_tasks = num_columns * tables.size();
+
+        _run_tasks(num_tasks, [&level, &tables, &computed_columns, num_columns, this](t_uindex idx) {
+            const t_computed_column_definition& computed = computed_columns.at(level[idx % num_columns]);
+            _compute_column(computed, tables[idx / num_columns]);
+        });
     }
 }
 
@@ -987,17 +2312,8 @@ void
 t_gnode::_compute_column(
     const t_computed_column_definition& computed_column,
     std::shared_ptr<t_data_table> tbl) {
-        std::vector<t_dtype> input_types;
-    std::vector<std::shared_ptr<t_column>> input_columns;
-
     std::string computed_column_name = std::get<0>(computed_column);
-    std::vector<std::string> input_column_names = std::get<2>(computed_column);
     t_computation computation = std::get<3>(computed_column);
-    
-    for (const auto& name : input_column_names) {
-        auto column = tbl->get_column(name);
-        input_columns.push_back(column);
-    }
 
     if (computation.m_name == INVALID_COMPUTED_FUNCTION) {
         std::cerr 
@@ -1013,12 +2329,15 @@ t_gnode::_compute_column(
     auto output_column = tbl->add_column_sptr(
         computed_column_name, output_column_type, true);
 
-    output_column->reserve(input_columns[0]->size());
+    // Columns that no context reads are only computed as part of the
+    // expressions that depend on them.
+    auto expression = m_computed_column_map.get_expression(computed_column_name);
+    if (!expression) {
+        return;
+    }
 
-    t_computed_column::apply_computation(
-        input_columns,
-        output_column,
-        computation);
+    output_column->reserve(tbl->size());
+    expression->compute(*tbl, output_column);
 }
 
 void
@@ -1027,12 +2346,7 @@ t_gnode::_recompute_column(
     std::shared_ptr<t_data_table> table,
     std::shared_ptr<t_data_table> flattened,
     const std::vector<t_rlookup>& changed_rows) {
-    std::vector<t_dtype> input_types;
-    std::vector<std::shared_ptr<t_column>> table_columns;
-    std::vector<std::shared_ptr<t_column>> flattened_columns;
-
     std::string computed_column_name = std::get<0>(computed_column);
-    std::vector<std::string> input_column_names = std::get<2>(computed_column);
     t_computation computation = std::get<3>(computed_column);
 
     if (computation.m_name == INVALID_COMPUTED_FUNCTION) {
@@ -1043,28 +2357,19 @@ t_gnode::_recompute_column(
         << std::endl;
         return;
     }
-    
-    for (const auto& name : input_column_names) {
-        auto table_column = table->get_column(name);
-        auto flattened_column = flattened->get_column(name);
-        table_columns.push_back(table_column);
-        flattened_columns.push_back(flattened_column);
-    }
 
     t_dtype output_column_type = computation.m_return_type;
-    
-    // FIXME: computed columns created with dependencies don't seem to work
 
     auto output_column = flattened->add_column_sptr(
         computed_column_name, output_column_type, true);
-    output_column->reserve(table_columns[0]->size());
 
-    t_computed_column::reapply_computation(
-        table_columns,
-        flattened_columns,
-        changed_rows,
-        output_column,
-        computation);
+    auto expression = m_computed_column_map.get_expression(computed_column_name);
+    if (!expression) {
+        return;
+    }
+
+    output_column->reserve(table->size());
+    expression->recompute(*table, *flattened, changed_rows, output_column);
 }
 
 std::vector<t_pivot>
@@ -1158,6 +2463,121 @@ t_gnode::num_input_ports() const {
     return m_input_ports.size();
 }
 
+std::map<std::string, t_uindex>
+t_gnode::get_memory_usage() const {
+    auto port_nbytes = [](const std::shared_ptr<t_port>& port) -> t_uindex {
+        auto table = port->get_table();
+        return table ? table->nbytes() + table->vocab_nbytes() : 0;
+    };
+
+    std::map<std::string, t_uindex> rv;
+    auto table = m_gstate->get_table();
+    rv["table"] = table->nbytes();
+    rv["vocabularies"] = table->vocab_nbytes();
+    rv["primary_keys"] = m_gstate->mapping_nbytes();
+    rv["indexes"] = m_gstate->index_nbytes();
+
+    rv["input_ports"] = 0;
+    for (const auto& kv : m_input_ports) {
+        rv["input_ports"] += port_nbytes(kv.second);
+    }
+
+    rv["output_ports"] = 0;
+    for (const auto& port : m_oports) {
+        rv["output_ports"] += port_nbytes(port);
+    }
+
+    return rv;
+}
+
+std::map<std::string, double>
+t_gnode::get_update_stats() const {
+    std::map<std::string, double> rv;
+    if (!m_has_update_stats) {
+        return rv;
+    }
+
+    const t_update_stats& stats = m_update_stats;
+    rv["port_id"] = stats.m_port_id;
+    rv["rows_in"] = stats.m_rows_in;
+    rv["rows_flattened"] = stats.m_rows_flattened;
+    rv["flatten_passthrough"] = stats.m_flatten_passthrough;
+    rv["append"] = stats.m_append;
+    rv["rows_added"] = stats.m_rows_added;
+    rv["rows_updated"] = stats.m_rows_updated;
+    rv["rows_removed"] = stats.m_rows_removed;
+    rv["columns_skipped"] = stats.m_columns_skipped;
+    rv["total_ns"] = stats.m_total_ns;
+    rv["flatten_ns"] = stats.m_flatten_ns;
+    rv["lookup_ns"] = stats.m_lookup_ns;
+    rv["process_columns_ns"] = stats.m_process_columns_ns;
+    rv["computed_columns_ns"] = stats.m_computed_columns_ns;
+    rv["update_master_table_ns"] = stats.m_update_master_table_ns;
+    rv["notify_ns"] = stats.m_notify_ns;
+    for (const auto& kv : stats.m_context_notify_ns) {
+        rv["context_notify_ns." + kv.first] = kv.second;
+    }
+    return rv;
+}
+
+void
+t_gnode::record_callback_latency() {
+    std::int64_t now = t_tracer::now();
+    if (m_awaiting_callback) {
+        m_callback_wait_latency.record(now - m_processed_at);
+        m_end_to_end_latency.record(now - m_sent_at);
+        m_awaiting_callback = false;
+    }
+
+    for (auto& kv : m_context_latency) {
+        t_context_latency& latency = *kv.second;
+        if (latency.m_notified_at == 0)
+            continue;
+
+        latency.m_callback_wait.record(now - latency.m_notified_at);
+        latency.m_end_to_end.record(now - m_sent_at);
+        latency.m_notified_at = 0;
+    }
+}
+
+std::map<std::string, double>
+t_gnode::get_latency_stats() const {
+    std::map<std::string, double> rv;
+    m_send_wait_latency.write_stats(rv, "send_wait.");
+    m_process_latency.write_stats(rv, "process.");
+    m_callback_wait_latency.write_stats(rv, "callback_wait.");
+    m_end_to_end_latency.write_stats(rv, "end_to_end.");
+    return rv;
+}
+
+void
+t_gnode::reset_latency_stats() {
+    m_send_wait_latency.reset();
+    m_process_latency.reset();
+    m_callback_wait_latency.reset();
+    m_end_to_end_latency.reset();
+}
+
+std::map<std::string, double>
+t_gnode::get_context_latency_stats(const std::string& name) const {
+    auto it = m_context_latency.find(name);
+    PSP_VERBOSE_ASSERT(it != m_context_latency.end(), "Context not found.");
+    std::map<std::string, double> rv;
+    it->second->m_notify.write_stats(rv, "notify.");
+    it->second->m_callback_wait.write_stats(rv, "callback_wait.");
+    it->second->m_end_to_end.write_stats(rv, "end_to_end.");
+    return rv;
+}
+
+void
+t_gnode::reset_context_latency_stats(const std::string& name) {
+    auto it = m_context_latency.find(name);
+    PSP_VERBOSE_ASSERT(it != m_context_latency.end(), "Context not found.");
+    it->second->m_notify.reset();
+    it->second->m_callback_wait.reset();
+    it->second->m_end_to_end.reset();
+}
+
 t_uindex
 t_gnode::num_output_ports() const {
     return m_oports.size();
@@ -1183,6 +2603,10 @@ t_gnode::get_contexts_last_updated() const {
     std::vector<std::string> rval;
 
     for (const auto& kv : m_contexts) {
+        // A retained tree has no view to notify.
+        if (_is_cube(kv.first))
+            continue;
+
         auto ctxh = kv.second;
         switch (ctxh.m_ctx_type) {
             case TWO_SIDED_CONTEXT: {
@@ -1228,12 +2652,86 @@ t_gnode::get_row_data_pkeys(const std::vector<t_tscalar>& pkeys) const {
     return m_gstate->get_row_data_pkeys(pkeys);
 }
 
+void
+t_gnode::read_column(const std::string& colname, const std::vector<t_tscalar>& pkeys,
+    std::vector<t_tscalar>& out_data) const {
+    m_gstate->read_column(colname, pkeys, out_data);
+}
+
+void
+t_gnode::copy_column(const std::string& colname, const std::vector<t_tscalar>& pkeys,
+    t_column& dest) const {
+    m_gstate->copy_column(colname, pkeys, dest);
+}
+
+t_uindex
+t_gnode::add_update_listener(t_update_listener listener) {
+    t_uindex id = ++m_last_listener_id;
+    m_update_listeners[id] = std::move(listener);
+    return id;
+}
+
+void
+t_gnode::remove_update_listener(t_uindex id) {
+    m_update_listeners.erase(id);
+}
+
+void
+t_gnode::_notify_update_listeners(const t_data_table& flattened) {
+    for (const auto& kv : m_update_listeners) {
+        kv.second(flattened);
+    }
+}
+
+void
+t_gnode::register_totals(const std::string& name, std::shared_ptr<t_ctx_totals> totals) {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    t_allocator_scope allocator_scope(m_allocator);
+    m_totals[name] = totals;
+    _update_computed_expressions();
+
+    // Columns the totals read are reloaded before they read the rows.
+    spill_cold_columns();
+    if (m_gstate->mapping_size() > 0) {
+        totals->update_from_state(*m_gstate->get_pkeyed_table());
+    }
+}
+
+void
+t_gnode::unregister_totals(const std::string& name) {
+    m_totals.erase(name);
+    _update_computed_expressions();
+}
+
+void
+t_gnode::_notify_totals(const t_data_table& flattened) {
+    if (m_totals.empty()) {
+        return;
+    }
+
+    PSP_TRACE_SPAN("gnode.notify_totals");
+    const t_data_table& prev = *m_oports[PSP_PORT_PREV]->get_table();
+    const t_data_table& current = *m_oports[PSP_PORT_CURRENT]->get_table();
+    const t_data_table& transitions = *m_oports[PSP_PORT_TRANSITIONS]->get_table();
+    const t_data_table& existed = *m_oports[PSP_PORT_EXISTED]->get_table();
+    for (const auto& kv : m_totals) {
+        kv.second->notify(flattened, prev, current, transitions, existed);
+    }
+}
+
 void
 t_gnode::reset() {
+    t_allocator_scope allocator_scope(m_allocator);
     std::vector<std::string> rval;
 
-    for (const auto& kv : m_contexts) {
-        auto ctxh = kv.second;
+    for (auto& kv : m_contexts) {
+        auto& ctxh = kv.second;
+
+        // There are no rows left to build a context from.
+        ctxh.m_building = false;
+        ctxh.m_build_offset = 0;
+        ctxh.m_build_table.reset();
+
         switch (ctxh.m_ctx_type) {
             case TWO_SIDED_CONTEXT: {
                 auto ctx = reinterpret_cast<t_ctx2*>(ctxh.m_ctx);
@@ -1255,7 +2753,233 @@ t_gnode::reset() {
         }
     }
 
+    for (auto& kv : m_totals) {
+        kv.second->reset();
+    }
+
     m_gstate->reset();
+    m_max_pkey.clear();
+
+    // Frozen contexts keep their rows until thawed.
+    ++m_num_processed;
+}
+
+void
+t_gnode::save_snapshot(const std::string& dirname) const {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    m_gstate->save(dirname);
+}
+
+void
+t_gnode::load_snapshot(const std::string& dirname) {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    t_allocator_scope allocator_scope(m_allocator);
+    _evict_cubes(0);
+    if (!m_contexts.empty() || !m_frozen_contexts.empty()) {
+        PSP_COMPLAIN_AND_ABORT("Cannot load a snapshot into a gnode with registered contexts");
+    }
+    m_gstate->load(dirname);
+    _reset_max_pkey();
+}
+
+void
+t_gnode::set_row_limit(t_uindex row_limit) {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    m_gstate->set_row_limit(row_limit);
+}
+
+void
+t_gnode::set_update_log(std::shared_ptr<t_update_log> update_log) {
+    m_update_log = update_log;
+}
+
+std::shared_ptr<t_update_log>
+t_gnode::get_update_log() const {
+    return m_update_log;
+}
+
+void
+t_gnode::share_vocabulary(const std::string& colname, std::shared_ptr<t_vocab> vocab) {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    m_gstate->share_vocabulary(colname, vocab);
+}
+
+std::vector<t_tscalar>
+t_gnode::get_pkeys_where(const std::vector<t_fterm>& fterms, t_filter_op combiner) const {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    return m_gstate->get_pkeys_where(fterms, combiner);
+}
+
+t_uindex
+t_gnode::compact_rows() {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    t_allocator_scope allocator_scope(m_allocator);
+    return m_gstate->compact_rows(0);
+}
+
+// Tables smaller than this are never compacted after an update.
+#define PSP_ROW_COMPACTION_MIN_SIZE 1024
+
+void
+t_gnode::set_column_spill(const std::string& dirname, double idle_seconds) {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    m_spill_dirname = dirname;
+    m_spill_idle_ns = static_cast<std::int64_t>(idle_seconds * 1000000000);
+
+    if (m_spill_dirname.empty()) {
+        std::shared_ptr<t_data_table> table = m_gstate->get_table();
+        for (const std::string& name : m_spilled_columns) {
+            if (table->get_schema().has_column(name)) {
+                table->get_column(name)->reload();
+            }
+        }
+        m_spilled_columns.clear();
+        m_column_used_at.clear();
+    }
+}
+
+t_uindex
+t_gnode::spill_cold_columns() {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    if (m_spill_dirname.empty()) {
+        return 0;
+    }
+
+    std::int64_t now = t_tracer::now();
+    std::set<std::string> referenced = _get_referenced_columns();
+    std::shared_ptr<t_data_table> table = m_gstate->get_table();
+    t_uindex nspilled = 0;
+    for (const std::string& name : table->get_schema().columns()) {
+        // The keys and ops are read by every update.
+        if (name == "psp_pkey" || name == "psp_okey" || name == "psp_op") {
+            continue;
+        }
+
+        std::shared_ptr<t_column> col = table->get_column(name);
+        if (referenced.count(name) > 0) {
+            col->reload();
+            m_spilled_columns.erase(name);
+            m_column_used_at[name] = now;
+            continue;
+        }
+
+        // A spilled column written to by an update was reloaded, and is
+        // kept a while in case it is written to again.
+        if (m_spilled_columns.count(name) > 0 && !col->is_spilled()) {
+            m_spilled_columns.erase(name);
+            m_column_used_at[name] = now;
+        }
+
+        std::int64_t used_at = m_column_used_at.emplace(name, now).first->second;
+        if (now - used_at >= m_spill_idle_ns && !col->is_spilled()
+            && col->spill(m_spill_dirname)) {
+            m_spilled_columns.insert(name);
+            ++nspilled;
+        }
+    }
+
+    return nspilled;
+}
+
+void
+t_gnode::set_column_packing(bool enabled, double idle_seconds) {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    m_pack_enabled = enabled;
+    m_pack_idle_ns = static_cast<std::int64_t>(idle_seconds * 1000000000);
+
+    if (!m_pack_enabled) {
+        std::shared_ptr<t_data_table> table = m_gstate->get_table();
+        for (const std::string& name : m_packed_columns) {
+            if (table->get_schema().has_column(name)) {
+                table->get_column(name)->unpack();
+            }
+        }
+        m_packed_columns.clear();
+        m_column_unpacked_at.clear();
+    }
+}
+
+t_uindex
+t_gnode::pack_cold_columns() {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    if (!m_pack_enabled) {
+        return 0;
+    }
+
+    std::int64_t now = t_tracer::now();
+    std::shared_ptr<t_data_table> table = m_gstate->get_table();
+    t_uindex npacked = 0;
+    for (const std::string& name : table->get_schema().columns()) {
+        // The keys and ops are read by every update.
+        if (name == "psp_pkey" || name == "psp_okey" || name == "psp_op") {
+            continue;
+        }
+
+        // A packed column read or written to at full width was unpacked, and
+        // is left unpacked a while in case it is again.
+        std::shared_ptr<t_column> col = table->get_column(name);
+        if (m_packed_columns.count(name) > 0 && !col->is_packed()) {
+            m_packed_columns.erase(name);
+            m_column_unpacked_at[name] = now;
+        }
+
+        std::int64_t unpacked_at = m_column_unpacked_at.emplace(name, now).first->second;
+        if (col->is_packed() || now - unpacked_at < m_pack_idle_ns) {
+            continue;
+        }
+
+        if (col->pack()) {
+            m_packed_columns.insert(name);
+            ++npacked;
+        } else {
+            // Not worth trying again until the column has been idle again.
+            m_column_unpacked_at[name] = now;
+        }
+    }
+
+    return npacked;
+}
+
+void
+t_gnode::_compact_state() {
+    // Erased rows hold no strings, so rows are compacted first to leave the
+    // vocabulary scans fewer rows.
+    double ratio = t_env::row_compaction_ratio();
+    if (ratio > 0 && m_gstate->size() >= PSP_ROW_COMPACTION_MIN_SIZE) {
+        m_gstate->compact_rows(ratio);
+    }
+
+    m_gstate->compact_vocabularies();
+}
+
+void
+t_gnode::create_index(const std::string& colname) {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    m_gstate->create_index(colname);
+}
+
+void
+t_gnode::create_sorted_index(const std::string& colname, t_sorttype order) {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    m_gstate->create_sorted_index(colname, order);
+}
+
+std::shared_ptr<t_vocab>
+t_gnode::get_shared_vocabulary(const std::string& colname) {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    return m_gstate->get_shared_vocabulary(colname);
 }
 
 void
@@ -1268,6 +2992,7 @@ t_gnode::clear_input_ports() {
 
 void
 t_gnode::clear_output_ports() {
+    notify_background_contexts();
     for (t_uindex idx = 0, loop_end = m_oports.size(); idx < loop_end; ++idx) {
         m_oports[idx]->get_table()->clear();
     }
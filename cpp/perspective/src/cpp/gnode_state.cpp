@@ -11,9 +11,12 @@
 #include <perspective/context_one.h>
 #include <perspective/context_two.h>
 #include <perspective/context_zero.h>
+#include <perspective/env_vars.h>
 #include <perspective/gnode_state.h>
 #include <perspective/mask.h>
 #include <perspective/sym_table.h>
+#include <perspective/scheduler.h>
+#include <fstream>
 #ifdef PSP_PARALLEL_FOR
 #include <tbb/tbb.h>
 #endif
@@ -23,7 +26,8 @@ namespace perspective {
 t_gstate::t_gstate(const t_schema& input_schema, const t_schema& output_schema)
     : m_input_schema(input_schema)
     , m_output_schema(output_schema)
-    , m_init(false) {
+    , m_init(false)
+    , m_row_limit(0) {
     LOG_CONSTRUCTOR("t_gstate");
 }
 
@@ -33,23 +37,18 @@ void
 t_gstate::init() {
     m_table = std::make_shared<t_data_table>(
         "", "", m_input_schema, DEFAULT_EMPTY_CAPACITY, BACKING_STORE_MEMORY);
+    m_table->set_alloc_owner(ALLOC_OWNER_MASTER_TABLE);
     m_table->init();
     m_pkcol = m_table->get_column("psp_pkey");
     m_opcol = m_table->get_column("psp_op");
+    m_mapping.init(m_pkcol->get_dtype());
     m_init = true;
 }
 
 t_rlookup
 t_gstate::lookup(t_tscalar pkey) const {
     t_rlookup rval(0, false);
-
-    t_mapping::const_iterator iter = m_mapping.find(pkey);
-
-    if (iter == m_mapping.end())
-        return rval;
-
-    rval.m_idx = iter->second;
-    rval.m_exists = true;
+    rval.m_exists = m_mapping.find(pkey, rval.m_idx);
     return rval;
 }
 
@@ -60,51 +59,55 @@ t_gstate::_mark_deleted(t_uindex idx) {
 
 void
 t_gstate::erase(const t_tscalar& pkey) {
-    t_mapping::const_iterator iter = m_mapping.find(pkey);
+    t_uindex idx;
 
-    if (iter == m_mapping.end()) {
+    if (!m_mapping.erase(pkey, idx)) {
         return;
     }
 
     auto columns = m_table->get_columns();
 
-    t_uindex idx = iter->second;
-
     for (auto c : columns) {
         c->clear(idx);
     }
 
-    m_mapping.erase(iter);
+    for (const auto& index : m_sorted_indexes) {
+        index->erase(pkey);
+    }
+
     _mark_deleted(idx);
 }
 
 t_uindex
 t_gstate::lookup_or_create(const t_tscalar& pkey) {
-    auto pkey_ = m_symtable.get_interned_tscalar(pkey);
-    t_mapping::const_iterator iter = m_mapping.find(pkey_);
+    t_uindex idx;
 
-    if (iter != m_mapping.end()) {
-        return iter->second;
+    if (m_mapping.find(pkey, idx)) {
+        return idx;
     }
 
     if (!m_free.empty()) {
         t_free_items::const_iterator iter = m_free.begin();
-        t_uindex idx = *iter;
+        idx = *iter;
         m_free.erase(iter);
-        m_mapping[pkey_] = idx;
+        m_mapping.insert(pkey, idx);
         return idx;
     }
 
     t_uindex nrows = m_table->num_rows();
     if (nrows >= m_table->get_capacity() - 1) {
-        m_table->reserve(std::max(
-            nrows + 1, static_cast<t_uindex>(m_table->get_capacity() * PSP_TABLE_GROW_RATIO)));
+        t_uindex capacity = static_cast<t_uindex>(m_table->get_capacity() * PSP_TABLE_GROW_RATIO);
+        if (m_row_limit > 0) {
+            // One row spare, as the table is grown when one row is left.
+            capacity = std::min(capacity, m_row_limit + 1);
+        }
+        m_table->reserve(std::max(nrows + 1, capacity));
     }
 
     m_table->set_size(nrows + 1);
     m_opcol->set_nth<std::uint8_t>(nrows, OP_INSERT);
     m_pkcol->set_scalar(nrows, pkey);
-    m_mapping[pkey_] = nrows;
+    m_mapping.insert(pkey, nrows);
     return nrows;
 }
 
@@ -113,6 +116,7 @@ t_gstate::fill_master_table(const t_data_table* flattened) {
     // insert into empty `m_table`
     m_free.clear();
     m_mapping.clear();
+    m_vocab_scan_sizes.clear();
 
     const t_schema& master_table_schema = m_table->get_schema();
 
@@ -122,22 +126,18 @@ t_gstate::fill_master_table(const t_data_table* flattened) {
     t_uindex ncols = m_table->num_columns();
     auto master_table = m_table.get();
 
-#ifdef PSP_PARALLEL_FOR
-    tbb::parallel_for(0, int(ncols), 1,
-        [&master_table, &master_table_schema, &flattened](int idx)
-#else
-    for (t_uindex idx = 0; idx < ncols; ++idx)
-#endif
-        {
+    t_scheduler::current().parallel_for(ncols,
+        [&master_table, &master_table_schema, &flattened](t_uindex idx) {
             // Clone each column from flattened into `m_table`
             const std::string& column_name = master_table_schema.m_columns[idx];
             // No need for safe lookup as master_table schema == flattened schema
             const t_column* flattened_column = flattened->get_const_column(column_name).get();
             master_table->set_column(idx, flattened_column->clone());
-        }
-#ifdef PSP_PARALLEL_FOR
-    );
-#endif
+        });
+    // Clones of columns with a vocabulary of their own are re-interned, one
+    // column at a time as they may share a vocabulary.
+    _attach_shared_vocabularies();
+
     m_pkcol = master_table->get_column("psp_pkey");
     m_opcol = master_table->get_column("psp_op");
 
@@ -152,7 +152,7 @@ t_gstate::fill_master_table(const t_data_table* flattened) {
         switch (op) {
             case OP_INSERT: {
                 // Write new primary keys into `m_mapping`
-                m_mapping[m_symtable.get_interned_tscalar(pkey)] = idx;
+                m_mapping.insert(pkey, idx);
                 m_opcol->set_nth<std::uint8_t>(idx, OP_INSERT);
                 m_pkcol->set_scalar(idx, pkey);
             } break;
@@ -167,7 +167,7 @@ t_gstate::fill_master_table(const t_data_table* flattened) {
     master_table->verify();
 #endif
 
-    return;
+    _build_sorted_indexes();
 }
 
 void
@@ -186,6 +186,18 @@ t_gstate::update_master_table(const t_data_table* flattened) {
     t_data_table* master_table = m_table.get();
     std::vector<t_uindex> master_table_indexes(flattened->num_rows());
 
+    // Reserve room for every row the update could create up front, rather
+    // than growing the table as they are created.
+    t_uindex nrows_hint = m_table->num_rows() + flattened->num_rows();
+    nrows_hint = nrows_hint > m_free.size() ? nrows_hint - m_free.size() : 0;
+    if (m_row_limit > 0) {
+        nrows_hint = std::min(nrows_hint, m_row_limit);
+    }
+
+    if (nrows_hint + 1 > m_table->get_capacity()) {
+        m_table->reserve(nrows_hint + 1);
+    }
+
     for (t_uindex idx = 0, loop_end = flattened->num_rows(); idx < loop_end; ++idx) {
         t_tscalar pkey = flattened_pkey_col->get_scalar(idx);
         const std::uint8_t* op_ptr = flattened_op_col->get_nth<std::uint8_t>(idx);
@@ -210,35 +222,90 @@ t_gstate::update_master_table(const t_data_table* flattened) {
 
     const t_schema& master_schema = m_table->get_schema();
     t_uindex ncols = master_table->num_columns();
-#ifdef PSP_PARALLEL_FOR
-    tbb::parallel_for(0, int(ncols), 1,
-        [flattened, flattened_op_col, &master_schema, &master_table, &master_table_indexes, this](int idx)
-#else
-    for (t_uindex idx = 0; idx < ncols; ++idx)
-#endif
-        {
-            const std::string& column_name = master_schema.m_columns[idx];
-            t_column* master_column = master_table->get_column(column_name).get();
-            auto flattened_column = flattened->get_const_column_safe(column_name);
-            if (!flattened_column) {
-            #ifdef PSP_PARALLEL_FOR
-                return;
-            #else
-                continue;
-            #endif
+
+    auto update_column = [flattened, flattened_op_col, &master_schema, &master_table,
+                              &master_table_indexes, this](t_uindex idx) {
+        const std::string& column_name = master_schema.m_columns[idx];
+        t_column* master_column = master_table->get_column(column_name).get();
+        auto flattened_column = flattened->get_const_column_safe(column_name);
+        if (!flattened_column) {
+            return;
+        }
+        update_master_column(
+            master_column,
+            flattened_column.get(),
+            flattened_op_col,
+            master_table_indexes,
+            flattened->num_rows());
+    };
+
+    // Columns attached to a shared vocabulary may intern into the same one,
+    // so they are updated one at a time after the rest.
+    t_scheduler::current().parallel_for(ncols,
+        [&update_column, &master_schema, &master_table](t_uindex idx) {
+            if (!master_table->get_column(master_schema.m_columns[idx])->is_vocabulary_shared()) {
+                update_column(idx);
             }
-            update_master_column(
-                master_column,
-                flattened_column.get(),
-                flattened_op_col,
-                master_table_indexes,
-                flattened->num_rows());
+        });
+
+    for (t_uindex idx = 0; idx < ncols; ++idx) {
+        if (master_table->get_column(master_schema.m_columns[idx])->is_vocabulary_shared()) {
+            update_column(idx);
         }
-#ifdef PSP_PARALLEL_FOR
-    );
-#endif
+    }
+
+    _update_indexes(flattened, master_table_indexes);
 }
 
+namespace {
+
+    template <typename DATA_T>
+    void
+    copy_value(
+        t_column* master_column, t_uindex master_idx, const t_column* flattened_column, t_uindex idx) {
+        master_column->set_nth<DATA_T>(master_idx, *(flattened_column->get_nth<DATA_T>(idx)));
+    }
+
+    // Strings from another vocabulary are interned into the master column's.
+    template <>
+    void
+    copy_value<const char*>(
+        t_column* master_column, t_uindex master_idx, const t_column* flattened_column, t_uindex idx) {
+        master_column->set_nth<const char*>(master_idx, flattened_column->get_nth<const char>(idx));
+    }
+
+    /**
+     * @brief Copy the inserted values of `flattened_column` into
+     * `master_column` as `DATA_T`, clearing the cells cleared in
+     * `flattened_column`, so that no cell dispatches on its type.
+     */
+    template <typename DATA_T>
+    void
+    copy_master_column(t_column* master_column, const t_column* flattened_column,
+        const t_column* op_column, const std::vector<t_uindex>& master_table_indexes,
+        t_uindex num_rows) {
+        const std::uint8_t* ops = op_column->get_nth<std::uint8_t>(0);
+
+        for (t_uindex idx = 0; idx < num_rows; ++idx) {
+            t_uindex master_table_idx = master_table_indexes[idx];
+
+            if (!flattened_column->is_valid(idx)) {
+                if (flattened_column->is_cleared(idx)) {
+                    master_column->clear(master_table_idx);
+                }
+                continue;
+            }
+
+            if (static_cast<t_op>(ops[idx]) == OP_DELETE) {
+                continue;
+            }
+
+            copy_value<DATA_T>(master_column, master_table_idx, flattened_column, idx);
+        }
+    }
+
+} // end anonymous namespace
+
 void
 t_gstate::update_master_column(
     t_column* master_column,
@@ -246,89 +313,65 @@ t_gstate::update_master_column(
     const t_column* op_column,
     const std::vector<t_uindex>& master_table_indexes,
     t_uindex num_rows) {
-    for (t_uindex idx = 0, loop_end = num_rows; idx < loop_end; ++idx) {
-        bool is_valid = flattened_column->is_valid(idx);
-        t_uindex master_table_idx = master_table_indexes[idx];
-
-        if (!is_valid) {
-            bool is_cleared = flattened_column->is_cleared(idx);
-            if (is_cleared) {
-                master_column->clear(master_table_idx);
+    switch (flattened_column->get_dtype()) {
+        case DTYPE_NONE: {
+        } break;
+        case DTYPE_INT64:
+        case DTYPE_TIME: {
+            copy_master_column<std::int64_t>(
+                master_column, flattened_column, op_column, master_table_indexes, num_rows);
+        } break;
+        case DTYPE_INT32: {
+            copy_master_column<std::int32_t>(
+                master_column, flattened_column, op_column, master_table_indexes, num_rows);
+        } break;
+        case DTYPE_INT16: {
+            copy_master_column<std::int16_t>(
+                master_column, flattened_column, op_column, master_table_indexes, num_rows);
+        } break;
+        case DTYPE_INT8: {
+            copy_master_column<std::int8_t>(
+                master_column, flattened_column, op_column, master_table_indexes, num_rows);
+        } break;
+        case DTYPE_UINT64:
+        case DTYPE_OBJECT: {
+            copy_master_column<std::uint64_t>(
+                master_column, flattened_column, op_column, master_table_indexes, num_rows);
+        } break;
+        case DTYPE_UINT32:
+        case DTYPE_DATE: {
+            copy_master_column<std::uint32_t>(
+                master_column, flattened_column, op_column, master_table_indexes, num_rows);
+        } break;
+        case DTYPE_UINT16: {
+            copy_master_column<std::uint16_t>(
+                master_column, flattened_column, op_column, master_table_indexes, num_rows);
+        } break;
+        case DTYPE_UINT8:
+        case DTYPE_BOOL: {
+            copy_master_column<std::uint8_t>(
+                master_column, flattened_column, op_column, master_table_indexes, num_rows);
+        } break;
+        case DTYPE_FLOAT64: {
+            copy_master_column<double>(
+                master_column, flattened_column, op_column, master_table_indexes, num_rows);
+        } break;
+        case DTYPE_FLOAT32: {
+            copy_master_column<float>(
+                master_column, flattened_column, op_column, master_table_indexes, num_rows);
+        } break;
+        case DTYPE_STR: {
+            // Strings interned into a vocabulary both columns share are
+            // copied as ids.
+            if (master_column->shares_vocabulary(*flattened_column)) {
+                copy_master_column<t_stridx>(
+                    master_column, flattened_column, op_column, master_table_indexes, num_rows);
+            } else {
+                copy_master_column<const char*>(
+                    master_column, flattened_column, op_column, master_table_indexes, num_rows);
             }
-            continue;
-        }
-
-        const std::uint8_t* op_ptr = op_column->get_nth<std::uint8_t>(idx);
-        t_op op = static_cast<t_op>(*op_ptr);
-
-        if (op == OP_DELETE)
-            continue;
-
-        switch (flattened_column->get_dtype()) {
-            case DTYPE_NONE: {
-            } break;
-            case DTYPE_INT64: {
-                master_column->set_nth<std::int64_t>(
-                    master_table_idx, *(flattened_column->get_nth<std::int64_t>(idx)));
-            } break;
-            case DTYPE_INT32: {
-                master_column->set_nth<std::int32_t>(
-                    master_table_idx, *(flattened_column->get_nth<std::int32_t>(idx)));
-            } break;
-            case DTYPE_INT16: {
-                master_column->set_nth<std::int16_t>(
-                    master_table_idx, *(flattened_column->get_nth<std::int16_t>(idx)));
-            } break;
-            case DTYPE_INT8: {
-                master_column->set_nth<std::int8_t>(
-                    master_table_idx, *(flattened_column->get_nth<std::int8_t>(idx)));
-            } break;
-            case DTYPE_UINT64: {
-                master_column->set_nth<std::uint64_t>(
-                    master_table_idx, *(flattened_column->get_nth<std::uint64_t>(idx)));
-            } break;
-            case DTYPE_UINT32: {
-                master_column->set_nth<std::uint32_t>(
-                    master_table_idx, *(flattened_column->get_nth<std::uint32_t>(idx)));
-            } break;
-            case DTYPE_UINT16: {
-                master_column->set_nth<std::uint16_t>(
-                    master_table_idx, *(flattened_column->get_nth<std::uint16_t>(idx)));
-            } break;
-            case DTYPE_UINT8: {
-                master_column->set_nth<std::uint8_t>(
-                    master_table_idx, *(flattened_column->get_nth<std::uint8_t>(idx)));
-            } break;
-            case DTYPE_FLOAT64: {
-                master_column->set_nth<double>(master_table_idx, *(flattened_column->get_nth<double>(idx)));
-            } break;
-            case DTYPE_FLOAT32: {
-                master_column->set_nth<float>(master_table_idx, *(flattened_column->get_nth<float>(idx)));
-            } break;
-            case DTYPE_BOOL: {
-                master_column->set_nth<std::uint8_t>(
-                    master_table_idx, *(flattened_column->get_nth<std::uint8_t>(idx)));
-            } break;
-            case DTYPE_TIME: {
-                master_column->set_nth<std::int64_t>(
-                    master_table_idx, *(flattened_column->get_nth<std::int64_t>(idx)));
-            } break;
-            case DTYPE_DATE: {
-                master_column->set_nth<std::uint32_t>(
-                    master_table_idx, *(flattened_column->get_nth<std::uint32_t>(idx)));
-            } break;
-            case DTYPE_STR: {
-                master_column->set_nth<const char*>(
-                    master_table_idx, flattened_column->get_nth<const char>(idx));
-            } break;
-            case DTYPE_OBJECT: {
-                // inform new column its being copied
-                master_column->set_nth<std::uint64_t>(
-                    master_table_idx, *(flattened_column->get_nth<std::uint64_t>(idx)));
-
-            } break;
-            default: { PSP_COMPLAIN_AND_ABORT("Unexpected type"); }
-        }
+        } break;
+        default: { PSP_COMPLAIN_AND_ABORT("Unexpected type"); }
     }
 }
 
@@ -336,10 +379,10 @@ void
 t_gstate::pprint() const {
     std::vector<t_uindex> indices(m_mapping.size());
     t_uindex idx = 0;
-    for (t_mapping::const_iterator iter = m_mapping.begin(); iter != m_mapping.end(); ++iter) {
-        indices[idx] = iter->second;
+    m_mapping.for_each([&indices, &idx](const t_tscalar& pkey, t_uindex ridx) {
+        indices[idx] = ridx;
         ++idx;
-    }
+    });
     m_table->pprint(indices);
 }
 
@@ -347,9 +390,7 @@ t_mask
 t_gstate::get_cpp_mask() const {
     t_uindex sz = m_table->size();
     t_mask msk(sz);
-    for (t_mapping::const_iterator iter = m_mapping.begin(); iter != m_mapping.end(); ++iter) {
-        msk.set(iter->second, true);
-    }
+    m_mapping.for_each([&msk](const t_tscalar& pkey, t_uindex ridx) { msk.set(ridx, true); });
     return msk;
 }
 
@@ -372,9 +413,9 @@ t_gstate::read_column(const std::string& colname, const std::vector<t_tscalar>&
     std::vector<t_tscalar> rval(num);
 
     for (t_index idx = 0; idx < num; ++idx) {
-        t_mapping::const_iterator iter = m_mapping.find(pkeys[idx]);
-        if (iter != m_mapping.end()) {
-            rval[idx].set(col_->get_scalar(iter->second));
+        t_uindex ridx;
+        if (m_mapping.find(pkeys[idx], ridx)) {
+            rval[idx].set(col_->get_scalar(ridx));
         }
     }
 
@@ -396,9 +437,9 @@ t_gstate::read_column(const std::string& colname, const std::vector<t_tscalar>&
 
     std::vector<double> rval;
     for (t_index idx = 0; idx < num; ++idx) {
-        t_mapping::const_iterator iter = m_mapping.find(pkeys[idx]);
-        if (iter != m_mapping.end()) {
-            auto tscalar = col_->get_scalar(iter->second);
+        t_uindex ridx;
+        if (m_mapping.find(pkeys[idx], ridx)) {
+            auto tscalar = col_->get_scalar(ridx);
             if (include_nones || tscalar.is_valid()) {
                 rval.push_back(tscalar.to_double());
             }
@@ -407,12 +448,44 @@ t_gstate::read_column(const std::string& colname, const std::vector<t_tscalar>&
     std::swap(rval, out_data);
 }
 
+void
+t_gstate::read_column(const std::string& colname, const std::vector<t_tscalar>& pkeys,
+    t_slice_column& out_data) const {
+    std::vector<t_index> rows(pkeys.size());
+    for (t_uindex idx = 0, loop_end = pkeys.size(); idx < loop_end; ++idx) {
+        t_uindex ridx;
+        rows[idx] = m_mapping.find(pkeys[idx], ridx) ? static_cast<t_index>(ridx) : -1;
+    }
+    out_data = t_slice_column(m_table->get_const_column(colname), rows);
+}
+
+void
+t_gstate::copy_column(const std::string& colname, const std::vector<t_tscalar>& pkeys,
+    t_column& dest) const {
+    if (t_slice_column::is_supported(dest.get_dtype())) {
+        t_slice_column values;
+        read_column(colname, pkeys, values);
+        values.write_into(dest);
+        return;
+    }
+
+    std::vector<t_tscalar> values;
+    read_column(colname, pkeys, values);
+    for (t_uindex idx = 0, loop_end = pkeys.size(); idx < loop_end; ++idx) {
+        if (values[idx].is_valid()) {
+            dest.set_scalar(idx, values[idx]);
+        } else {
+            dest.clear(idx);
+        }
+    }
+}
+
 t_tscalar
 t_gstate::get(t_tscalar pkey, const std::string& colname) const {
-    t_mapping::const_iterator iter = m_mapping.find(pkey);
-    if (iter != m_mapping.end()) {
+    t_uindex ridx;
+    if (m_mapping.find(pkey, ridx)) {
         std::shared_ptr<const t_column> col = m_table->get_const_column(colname);
-        return col->get_scalar(iter->second);
+        return col->get_scalar(ridx);
     }
 
     return t_tscalar();
@@ -423,10 +496,10 @@ t_gstate::get_row(t_tscalar pkey) const {
     auto columns = m_table->get_const_columns();
     std::vector<t_tscalar> rval(columns.size());
 
-    t_mapping::const_iterator iter = m_mapping.find(pkey);
-    PSP_VERBOSE_ASSERT(iter != m_mapping.end(), "Reached end");
+    t_uindex ridx = 0;
+    bool exists = m_mapping.find(pkey, ridx);
+    PSP_VERBOSE_ASSERT(exists, "Reached end");
 
-    t_uindex ridx = iter->second;
     t_uindex idx = 0;
 
     for (auto c : columns) {
@@ -444,9 +517,9 @@ t_gstate::is_unique(
     value = mknone();
 
     for (const auto& pkey : pkeys) {
-        t_mapping::const_iterator iter = m_mapping.find(pkey);
-        if (iter != m_mapping.end()) {
-            auto tmp = col_->get_scalar(iter->second);
+        t_uindex ridx;
+        if (m_mapping.find(pkey, ridx)) {
+            auto tmp = col_->get_scalar(ridx);
             if (!value.is_none() && value != tmp)
                 return false;
             value = tmp;
@@ -465,9 +538,9 @@ t_gstate::apply(const std::vector<t_tscalar>& pkeys, const std::string& colname,
     value = mknone();
 
     for (const auto& pkey : pkeys) {
-        t_mapping::const_iterator iter = m_mapping.find(pkey);
-        if (iter != m_mapping.end()) {
-            auto tmp = col_->get_scalar(iter->second);
+        t_uindex ridx;
+        if (m_mapping.find(pkey, ridx)) {
+            auto tmp = col_->get_scalar(ridx);
             bool done = fn(tmp, value);
             if (done) {
                 value = tmp;
@@ -488,13 +561,14 @@ t_dtype
 t_gstate::get_pkey_dtype() const {
     if (m_mapping.empty())
         return DTYPE_STR;
-    auto iter = m_mapping.begin();
-    return iter->first.get_dtype();
+    return m_mapping.get_dtype();
 }
 
 std::shared_ptr<t_data_table>
 t_gstate::get_sorted_pkeyed_table() const {
-    std::map<t_tscalar, t_uindex> ordered(m_mapping.begin(), m_mapping.end());
+    std::map<t_tscalar, t_uindex> ordered;
+    m_mapping.for_each(
+        [&ordered](const t_tscalar& pkey, t_uindex ridx) { ordered[pkey] = ridx; });
     auto sch = m_input_schema.drop({"psp_op"});
     auto rv = std::make_shared<t_data_table>(sch, 0);
     rv->init();
@@ -576,22 +650,13 @@ t_gstate::_get_pkeyed_table(const t_schema& schema, const t_mask& mask) const {
 
     const t_data_table* tbl = m_table.get();
 
-#ifdef PSP_PARALLEL_FOR
-    tbb::parallel_for(0, int(o_ncols), 1,
-        [&sch_cols, rval, tbl, &mask](int colidx)
-#else
-    for (t_uindex colidx = 0; colidx < o_ncols; ++colidx)
-#endif
-        {
+    t_scheduler::current().parallel_for(o_ncols,
+        [&sch_cols, rval, tbl, &mask](t_uindex colidx) {
             const std::string& c = sch_cols[colidx];
             if (c != "psp_op" && c != "psp_pkey") {
                 rval->set_column(c, tbl->get_const_column(c)->clone(mask));
             }
-        }
-
-#ifdef PSP_PARALLEL_FOR
-    );
-#endif
+        });
     auto pkey_col = rval->get_column("psp_pkey").get();
     auto op_col = rval->get_column("psp_op").get();
 
@@ -614,19 +679,19 @@ t_gstate::_get_pkeyed_table(const t_schema& schema, const t_mask& mask) const {
         }
 
         t_uindex oidx = 0;
-        for (const auto& kv : m_mapping) {
-            if (mask.get(kv.second)) {
-                order[oidx] = std::make_pair(kv.first, mapping[kv.second]);
+        m_mapping.for_each([&mask, &order, &mapping, &oidx](const t_tscalar& pkey, t_uindex ridx) {
+            if (mask.get(ridx)) {
+                order[oidx] = std::make_pair(pkey, mapping[ridx]);
                 ++oidx;
             }
-        }
+        });
     } else // enable_pkeyed_table_mask_fix
     {
         t_uindex oidx = 0;
-        for (const auto& kv : m_mapping) {
-            order[oidx] = kv;
+        m_mapping.for_each([&order, &oidx](const t_tscalar& pkey, t_uindex ridx) {
+            order[oidx] = std::make_pair(pkey, ridx);
             ++oidx;
-        }
+        });
     }
 
     std::sort(order.begin(), order.end(),
@@ -655,7 +720,7 @@ t_gstate::_get_pkeyed_table(const t_schema& schema, const t_mask& mask) const {
             total_string_size = 0;
 
         pkey_col->set_vocabulary(order, total_string_size);
-        auto base = pkey_col->get_nth<t_uindex>(0);
+        auto base = pkey_col->get_nth<t_stridx>(0);
 
         for (t_uindex idx = 0, loop_end = order.size(); idx < loop_end; ++idx) {
             base[idx] = idx + offset;
@@ -676,6 +741,11 @@ t_gstate::size() const {
     return m_table->size();
 }
 
+t_uindex
+t_gstate::mapping_nbytes() const {
+    return m_mapping.nbytes();
+}
+
 std::vector<t_tscalar>
 t_gstate::get_row_data_pkeys(const std::vector<t_tscalar>& pkeys) const {
     t_uindex ncols = m_table->num_columns();
@@ -691,12 +761,12 @@ t_gstate::get_row_data_pkeys(const std::vector<t_tscalar>& pkeys) const {
     auto none = mknone();
 
     for (const auto& pkey : pkeys) {
-        t_mapping::const_iterator iter = m_mapping.find(pkey);
-        if (iter == m_mapping.end())
+        t_uindex ridx;
+        if (!m_mapping.find(pkey, ridx))
             continue;
 
         for (t_uindex cidx = 0; cidx < ncols; ++cidx) {
-            auto v = columns[cidx]->get_scalar(iter->second);
+            auto v = columns[cidx]->get_scalar(ridx);
             if (v.is_valid()) {
                 rval.push_back(v);
             } else {
@@ -709,7 +779,7 @@ t_gstate::get_row_data_pkeys(const std::vector<t_tscalar>& pkeys) const {
 
 bool
 t_gstate::has_pkey(t_tscalar pkey) const {
-    return m_mapping.find(pkey) != m_mapping.end();
+    return m_mapping.contains(pkey);
 }
 
 std::vector<t_tscalar>
@@ -722,7 +792,7 @@ t_gstate::has_pkeys(const std::vector<t_tscalar>& pkeys) const {
 
     for (const auto& p : pkeys) {
         t_tscalar tval;
-        tval.set(m_mapping.find(p) != m_mapping.end());
+        tval.set(m_mapping.contains(p));
         rval[idx].set(tval);
         ++idx;
     }
@@ -734,13 +804,42 @@ std::vector<t_tscalar>
 t_gstate::get_pkeys() const {
     std::vector<t_tscalar> rval(m_mapping.size());
     t_uindex idx = 0;
-    for (const auto& kv : m_mapping) {
-        rval[idx].set(kv.first);
+    m_mapping.for_each([&rval, &idx](const t_tscalar& pkey, t_uindex ridx) {
+        rval[idx].set(pkey);
         ++idx;
-    }
+    });
     return rval;
 }
 
+t_minmax
+t_gstate::get_min_max(
+    const std::vector<t_tscalar>& pkeys, const std::string& colname) const {
+    std::shared_ptr<const t_column> col = m_table->get_const_column(colname);
+    return get_column_min_max(*col, get_row_indices(pkeys));
+}
+
+t_histogram
+t_gstate::get_histogram(const std::vector<t_tscalar>& pkeys, const std::string& colname,
+    t_uindex nbuckets, t_binning binning) const {
+    std::shared_ptr<const t_column> col = m_table->get_const_column(colname);
+    return make_histogram(*col, get_row_indices(pkeys), nbuckets, binning);
+}
+
+std::vector<t_uindex>
+t_gstate::get_row_indices(const std::vector<t_tscalar>& pkeys) const {
+    std::vector<t_uindex> indices;
+    indices.reserve(pkeys.size());
+
+    for (const auto& pkey : pkeys) {
+        t_uindex ridx;
+        if (m_mapping.find(pkey, ridx)) {
+            indices.push_back(ridx);
+        }
+    }
+
+    return indices;
+}
+
 std::pair<t_tscalar, t_tscalar>
 get_vec_min_max(const std::vector<t_tscalar>& vec) {
     t_tscalar min = mknone();
@@ -771,8 +870,580 @@ t_gstate::mapping_size() const {
 void
 t_gstate::reset() {
     m_table->reset();
+    // `t_data_table::reset` recreates the table's columns.
+    m_pkcol = m_table->get_column("psp_pkey");
+    m_opcol = m_table->get_column("psp_op");
     m_mapping.clear();
     m_free.clear();
+    m_vocab_scan_sizes.clear();
+    _attach_shared_vocabularies();
+    for (const auto& index : m_sorted_indexes) {
+        index->clear();
+    }
+}
+
+void
+t_gstate::set_row_limit(t_uindex row_limit) {
+    m_row_limit = row_limit;
+}
+
+void
+t_gstate::share_vocabulary(const std::string& colname, std::shared_ptr<t_vocab> vocab) {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    if (!m_table->get_schema().has_column(colname)
+        || m_table->get_schema().get_dtype(colname) != DTYPE_STR) {
+        PSP_COMPLAIN_AND_ABORT("Cannot share the vocabulary of `" + colname
+            + "`, which is not a string column");
+    }
+
+    m_table->get_column(colname)->share_vocabulary(vocab);
+    m_shared_vocabs[colname] = vocab;
+    _invalidate_index(colname);
+}
+
+std::shared_ptr<t_vocab>
+t_gstate::get_shared_vocabulary(const std::string& colname) {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    if (!m_table->get_schema().has_column(colname)
+        || m_table->get_schema().get_dtype(colname) != DTYPE_STR) {
+        PSP_COMPLAIN_AND_ABORT("Cannot share the vocabulary of `" + colname
+            + "`, which is not a string column");
+    }
+
+    std::shared_ptr<t_vocab> vocab = m_table->get_column(colname)->get_shared_vocabulary();
+    m_shared_vocabs[colname] = vocab;
+    return vocab;
+}
+
+void
+t_gstate::_attach_shared_vocabularies() {
+    // The master table's columns have been recreated or replaced.
+    _invalidate_indexes();
+    for (const auto& kv : m_shared_vocabs) {
+        m_table->get_column(kv.first)->share_vocabulary(kv.second);
+    }
+}
+
+// Vocabularies smaller than this are never compacted.
+#define PSP_VOCAB_COMPACTION_MIN_SIZE 1024
+
+void
+t_gstate::compact_vocabularies() {
+    double ratio = t_env::vocab_compaction_ratio();
+    if (ratio <= 0) {
+        return;
+    }
+
+    m_mapping.compact(ratio);
+
+    const t_schema& schema = m_table->get_schema();
+    for (t_uindex idx = 0, loop_end = schema.size(); idx < loop_end; ++idx) {
+        if (schema.m_types[idx] != DTYPE_STR) {
+            continue;
+        }
+
+        const std::string& colname = schema.m_columns[idx];
+        std::shared_ptr<t_column> column = m_table->get_column(colname);
+        t_uindex vlenidx = column->get_vlenidx();
+
+        if (vlenidx < PSP_VOCAB_COMPACTION_MIN_SIZE) {
+            continue;
+        }
+
+        t_uindex scanned = m_vocab_scan_sizes[colname];
+        if (static_cast<double>(vlenidx) < (1 + ratio) * double(scanned)) {
+            continue;
+        }
+
+        if (column->compact_vocabulary(ratio) > 0) {
+            _invalidate_index(colname);
+        }
+        m_vocab_scan_sizes[colname] = column->get_vlenidx();
+    }
+}
+
+t_uindex
+t_gstate::compact_rows(double min_free_ratio) {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    t_uindex nrows = m_table->size();
+    t_uindex nfree = m_free.size();
+    if (nfree == 0 || static_cast<double>(nfree) < min_free_ratio * double(nrows)) {
+        return 0;
+    }
+
+    std::vector<std::pair<t_tscalar, t_uindex>> rows;
+    rows.reserve(m_mapping.size());
+    m_mapping.for_each(
+        [&rows](const t_tscalar& pkey, t_uindex ridx) { rows.push_back(std::make_pair(pkey, ridx)); });
+
+    std::sort(rows.begin(), rows.end(),
+        [](const std::pair<t_tscalar, t_uindex>& a, const std::pair<t_tscalar, t_uindex>& b) {
+            return a.second < b.second;
+        });
+
+    std::vector<t_uindex> live_rows(rows.size());
+    for (t_uindex idx = 0, loop_end = rows.size(); idx < loop_end; ++idx) {
+        live_rows[idx] = rows[idx].second;
+        m_mapping.insert(rows[idx].first, idx);
+    }
+
+    t_data_table* master_table = m_table.get();
+    const t_schema& schema = master_table->get_schema();
+    t_scheduler::current().parallel_for(schema.size(),
+        [master_table, &schema, &live_rows](t_uindex idx) {
+            master_table->get_column(schema.m_columns[idx])->compact_rows(live_rows);
+        });
+
+    master_table->set_size(live_rows.size());
+    master_table->set_capacity(live_rows.size());
+    m_free.clear();
+    _invalidate_indexes();
+    return nrows - live_rows.size();
+}
+
+void
+t_gstate::create_index(const std::string& colname) {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    if (!m_table->get_schema().has_column(colname)
+        || m_table->get_schema().get_dtype(colname) != DTYPE_STR) {
+        PSP_COMPLAIN_AND_ABORT(
+            "Cannot index `" + colname + "`, which is not a string column");
+    }
+
+    if (m_indexes.find(colname) == m_indexes.end()) {
+        m_indexes[colname] = nullptr;
+    }
+}
+
+bool
+t_gstate::has_index(const std::string& colname) const {
+    return m_indexes.find(colname) != m_indexes.end();
+}
+
+void
+t_gstate::create_sorted_index(const std::string& colname, t_sorttype order) {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    if (!m_table->get_schema().has_column(colname)) {
+        PSP_COMPLAIN_AND_ABORT("Cannot index `" + colname + "`, which is not a column");
+    }
+
+    if (get_sorted_index(colname, order)) {
+        return;
+    }
+
+    auto index = std::make_shared<t_sorted_column_index>(colname, order);
+    m_sorted_indexes.push_back(index);
+    _build_sorted_indexes();
+}
+
+std::shared_ptr<const t_sorted_column_index>
+t_gstate::get_sorted_index(const std::string& colname, t_sorttype order) const {
+    for (const auto& index : m_sorted_indexes) {
+        if (index->get_colname() == colname && index->get_order() == order) {
+            return index;
+        }
+    }
+
+    return nullptr;
+}
+
+bool
+t_gstate::get_index_mask(const t_config& config, t_mask& out_mask) {
+    if (!config.has_filters()) {
+        return false;
+    }
+
+    // Terms which cannot be read from an index are skipped when every term
+    // must match, and give up on the index when any may. Zone maps are only
+    // read when every term must match, as invalid values, which they do not
+    // summarize, may match the others.
+    bool is_and = config.get_combiner() == FILTER_OP_AND;
+    t_uindex nrows = m_table->size();
+    t_mask rval(nrows);
+    bool indexed = false;
+    bool zoned = false;
+
+    for (const t_fterm& fterm : config.get_fterms()) {
+        const t_column_index* index = _get_index(fterm);
+        if (!index) {
+            const t_zone_map* zone_map = is_and ? _get_zone_map(fterm) : nullptr;
+            if (!zone_map) {
+                if (!is_and) {
+                    return false;
+                }
+                continue;
+            }
+
+            t_fterm coerced = fterm;
+            coerced.coerce_numeric(m_table->get_const_column(fterm.m_colname)->get_dtype());
+            t_mask term_mask(nrows);
+            zone_map->get_rows(coerced, term_mask);
+            if (!indexed) {
+                rval = term_mask;
+                indexed = true;
+            } else {
+                rval &= term_mask;
+            }
+            zoned = true;
+            continue;
+        }
+
+        const t_column* column = m_table->get_const_column(fterm.m_colname).get();
+        const std::vector<t_tscalar>& values = fterm.m_op == FILTER_OP_IN
+            ? fterm.m_bag
+            : std::vector<t_tscalar>{fterm.m_threshold};
+
+        std::vector<t_stridx> ids;
+        ids.reserve(values.size());
+        for (const t_tscalar& value : values) {
+            // A string which is not interned is held by no row.
+            t_uindex id;
+            if (column->_get_vocab()->string_exists(value.get_char_ptr(), id)) {
+                ids.push_back(static_cast<t_stridx>(id));
+            }
+        }
+
+        t_mask term_mask(nrows);
+        index->get_rows(*column, ids, term_mask);
+        if (!indexed) {
+            rval = term_mask;
+            indexed = true;
+        } else if (is_and) {
+            rval &= term_mask;
+        } else {
+            rval |= term_mask;
+        }
+    }
+
+    if (!indexed) {
+        return false;
+    }
+
+    // Zone maps read whole blocks, which may include erased rows.
+    if (zoned) {
+        for (t_uindex ridx : m_free) {
+            if (ridx < nrows) {
+                rval.set(ridx, false);
+            }
+        }
+    }
+
+    std::swap(rval, out_mask);
+    return true;
+}
+
+std::vector<t_tscalar>
+t_gstate::get_pkeys_where(const std::vector<t_fterm>& fterms, t_filter_op combiner) const {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    const t_schema& schema = m_table->get_schema();
+    for (const t_fterm& fterm : fterms) {
+        if (!schema.has_column(fterm.m_colname)) {
+            PSP_COMPLAIN_AND_ABORT(
+                "Cannot filter by `" + fterm.m_colname + "`, which is not a column");
+        }
+    }
+
+    // Erased rows are invalid, so they are only told apart from live rows
+    // by the mapping.
+    t_mask mask = m_table->filter_cpp(combiner, fterms);
+    std::vector<t_tscalar> rval;
+    m_mapping.for_each([&mask, &rval](const t_tscalar& pkey, t_uindex ridx) {
+        if (mask.get(ridx)) {
+            rval.push_back(pkey);
+        }
+    });
+
+    std::sort(rval.begin(), rval.end());
+    return rval;
+}
+
+t_uindex
+t_gstate::index_nbytes() const {
+    t_uindex rval = 0;
+    for (const auto& kv : m_indexes) {
+        if (kv.second) {
+            rval += kv.second->nbytes();
+        }
+    }
+
+    for (const auto& kv : m_zone_maps) {
+        rval += kv.second->nbytes();
+    }
+
+    for (const auto& index : m_sorted_indexes) {
+        rval += index->nbytes();
+    }
+    return rval;
+}
+
+const t_column_index*
+t_gstate::_get_index(const t_fterm& fterm) {
+    if (fterm.m_negated || (fterm.m_op != FILTER_OP_EQ && fterm.m_op != FILTER_OP_IN)) {
+        return nullptr;
+    }
+
+    auto iter = m_indexes.find(fterm.m_colname);
+    if (iter == m_indexes.end()) {
+        return nullptr;
+    }
+
+    // Only strings are held by the rows of an index.
+    const std::vector<t_tscalar>& values = fterm.m_op == FILTER_OP_IN
+        ? fterm.m_bag
+        : std::vector<t_tscalar>{fterm.m_threshold};
+    for (const t_tscalar& value : values) {
+        if (!value.is_valid() || value.get_dtype() != DTYPE_STR) {
+            return nullptr;
+        }
+    }
+
+    std::shared_ptr<t_column_index> index = iter->second;
+    t_uindex nrows = m_table->size();
+    if (!index || index->needs_rebuild(nrows)) {
+        index = std::make_shared<t_column_index>();
+        index->build(*m_table->get_const_column(fterm.m_colname), nrows);
+        m_indexes[fterm.m_colname] = index;
+    }
+
+    return index.get();
+}
+
+const t_zone_map*
+t_gstate::_get_zone_map(const t_fterm& fterm) {
+    const t_schema& schema = m_table->get_schema();
+    if (!schema.has_column(fterm.m_colname)) {
+        return nullptr;
+    }
+
+    t_dtype dtype = schema.get_dtype(fterm.m_colname);
+    t_fterm coerced = fterm;
+    coerced.coerce_numeric(dtype);
+    if (!t_zone_map::is_supported(coerced, dtype)) {
+        return nullptr;
+    }
+
+    auto iter = m_zone_maps.find(fterm.m_colname);
+    if (iter != m_zone_maps.end()) {
+        return iter->second.get();
+    }
+
+    auto zone_map = std::make_shared<t_zone_map>();
+    zone_map->build(*m_table->get_const_column(fterm.m_colname), m_table->size());
+    m_zone_maps[fterm.m_colname] = zone_map;
+    return zone_map.get();
+}
+
+void
+t_gstate::_invalidate_index(const std::string& colname) {
+    auto iter = m_indexes.find(colname);
+    if (iter != m_indexes.end()) {
+        m_indexes[colname] = nullptr;
+    }
+}
+
+void
+t_gstate::_invalidate_indexes() {
+    std::vector<std::string> colnames;
+    for (const auto& kv : m_indexes) {
+        colnames.push_back(kv.first);
+    }
+
+    for (const std::string& colname : colnames) {
+        m_indexes[colname] = nullptr;
+    }
+
+    m_zone_maps.clear();
+}
+
+void
+t_gstate::_update_indexes(
+    const t_data_table* flattened, const std::vector<t_uindex>& master_table_indexes) {
+    const t_column* op_col = flattened->get_const_column("psp_op").get();
+    for (const auto& kv : m_indexes) {
+        if (!kv.second) {
+            continue;
+        }
+
+        auto flattened_column = flattened->get_const_column_safe(kv.first);
+        if (!flattened_column) {
+            continue;
+        }
+
+        const t_column* master_column = m_table->get_const_column(kv.first).get();
+        for (t_uindex idx = 0, loop_end = flattened->num_rows(); idx < loop_end; ++idx) {
+            t_op op = static_cast<t_op>(*(op_col->get_nth<std::uint8_t>(idx)));
+            if (op != OP_INSERT || !flattened_column->is_valid(idx)) {
+                continue;
+            }
+
+            t_uindex ridx = master_table_indexes[idx];
+            kv.second->add(ridx, *(master_column->get_nth<t_stridx>(ridx)));
+        }
+    }
+
+    for (const auto& kv : m_zone_maps) {
+        auto flattened_column = flattened->get_const_column_safe(kv.first);
+        if (!flattened_column) {
+            continue;
+        }
+
+        const t_column* master_column = m_table->get_const_column(kv.first).get();
+        for (t_uindex idx = 0, loop_end = flattened->num_rows(); idx < loop_end; ++idx) {
+            t_op op = static_cast<t_op>(*(op_col->get_nth<std::uint8_t>(idx)));
+            if (op == OP_INSERT) {
+                kv.second->add(*master_column, master_table_indexes[idx]);
+            }
+        }
+    }
+
+    const t_column* pkey_col = flattened->get_const_column("psp_pkey").get();
+    for (const auto& index : m_sorted_indexes) {
+        auto flattened_column = flattened->get_const_column_safe(index->get_colname());
+        const t_column* master_column = m_table->get_const_column(index->get_colname()).get();
+        for (t_uindex idx = 0, loop_end = flattened->num_rows(); idx < loop_end; ++idx) {
+            t_op op = static_cast<t_op>(*(op_col->get_nth<std::uint8_t>(idx)));
+            if (op != OP_INSERT) {
+                continue;
+            }
+
+            // A cell neither written nor cleared keeps its value, and so
+            // its place, unless its row is new.
+            t_tscalar pkey = pkey_col->get_scalar(idx);
+            bool written = flattened_column
+                && (flattened_column->is_valid(idx) || flattened_column->is_cleared(idx));
+            if (written || !index->contains(pkey)) {
+                index->update(pkey, master_column->get_scalar(master_table_indexes[idx]));
+            }
+        }
+    }
+}
+
+void
+t_gstate::_build_sorted_indexes() {
+    if (m_sorted_indexes.empty()) {
+        return;
+    }
+
+    std::vector<std::pair<t_tscalar, t_uindex>> rows;
+    rows.reserve(m_mapping.size());
+    m_mapping.for_each([&rows](const t_tscalar& pkey, t_uindex ridx) {
+        rows.push_back(std::make_pair(pkey, ridx));
+    });
+
+    for (const auto& index : m_sorted_indexes) {
+        index->build(*m_table->get_const_column(index->get_colname()), rows);
+    }
+}
+
+// Bump when the layout of a snapshot changes.
+#define PSP_GSTATE_SNAPSHOT_VERSION 2
+
+void
+t_gstate::save(const std::string& dirname) const {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    const t_schema& schema = m_table->get_schema();
+    t_uindex nrows = m_table->size();
+
+    std::ofstream manifest(dirname + "/manifest");
+    PSP_VERBOSE_ASSERT(manifest.good(), "Could not write snapshot manifest");
+    manifest << "perspective-gstate " << PSP_GSTATE_SNAPSHOT_VERSION << "\n"
+             << nrows << " " << schema.size() << " " << m_free.size() << "\n";
+
+    for (t_uindex cidx = 0, loop_end = schema.size(); cidx < loop_end; ++cidx) {
+        const std::string& colname = schema.m_columns[cidx];
+        auto column = m_table->get_const_column(colname);
+        t_column_recipe recipe = column->get_recipe();
+        t_uindex status_size = recipe.m_status_enabled ? recipe.m_status.m_size : 0;
+        t_uindex vlendata_size = recipe.m_isvlen ? recipe.m_vlendata.m_size : 0;
+        t_uindex extents_size = recipe.m_isvlen ? recipe.m_extents.m_size : 0;
+
+        std::stringstream prefix;
+        prefix << dirname << "/column_" << cidx;
+        column->save(prefix.str());
+
+        // Column names may contain spaces, so give them their own line.
+        manifest << colname << "\n"
+                 << recipe.m_dtype << " " << recipe.m_status_enabled << " "
+                 << recipe.m_size << " " << recipe.m_vlenidx << " " << recipe.m_data.m_size
+                 << " " << status_size << " " << vlendata_size << " " << extents_size << "\n";
+    }
+
+    std::vector<t_uindex> free_items(m_free.begin(), m_free.end());
+    std::ofstream free_file(dirname + "/free", std::ios::binary);
+    free_file.write(reinterpret_cast<const char*>(free_items.data()),
+        free_items.size() * sizeof(t_uindex));
+
+    PSP_VERBOSE_ASSERT(manifest.good() && free_file.good(), "Could not write snapshot");
+}
+
+void
+t_gstate::load(const std::string& dirname) {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    std::ifstream manifest(dirname + "/manifest");
+    if (!manifest.good()) {
+        PSP_COMPLAIN_AND_ABORT("Could not read snapshot manifest in `" + dirname + "`");
+    }
+
+    std::string magic;
+    t_uindex version, nrows, ncols, nfree;
+    manifest >> magic >> version >> nrows >> ncols >> nfree;
+    if (magic != "perspective-gstate" || version != PSP_GSTATE_SNAPSHOT_VERSION) {
+        PSP_COMPLAIN_AND_ABORT("Unsupported snapshot in `" + dirname + "`");
+    }
+
+    const t_schema& schema = m_table->get_schema();
+    if (ncols != schema.size()) {
+        PSP_COMPLAIN_AND_ABORT("Snapshot schema does not match table schema");
+    }
+
+    // The columns read from mappings of the saved files, so there is
+    // nothing to reserve.
+    reset();
+
+    for (t_uindex cidx = 0; cidx < ncols; ++cidx) {
+        std::string colname;
+        manifest >> std::ws;
+        std::getline(manifest, colname);
+
+        t_column_recipe recipe;
+        std::int32_t dtype;
+        manifest >> dtype >> recipe.m_status_enabled >> recipe.m_size >> recipe.m_vlenidx
+            >> recipe.m_data.m_size >> recipe.m_status.m_size >> recipe.m_vlendata.m_size
+            >> recipe.m_extents.m_size;
+        recipe.m_dtype = static_cast<t_dtype>(dtype);
+
+        if (!manifest.good() || !schema.has_column(colname)
+            || schema.get_dtype(colname) != recipe.m_dtype || recipe.m_size != nrows) {
+            PSP_COMPLAIN_AND_ABORT("Snapshot column `" + colname + "` does not match table schema");
+        }
+
+        std::stringstream prefix;
+        prefix << dirname << "/column_" << cidx;
+        m_table->get_column(colname)->load(prefix.str(), recipe);
+    }
+
+    // Loaded columns are made from their recipes, which do not record an
+    // owner.
+    m_table->set_alloc_owner(ALLOC_OWNER_MASTER_TABLE);
+    m_table->set_size(nrows);
+
+    std::vector<t_uindex> free_items(nfree);
+    std::ifstream free_file(dirname + "/free", std::ios::binary);
+    free_file.read(reinterpret_cast<char*>(free_items.data()), nfree * sizeof(t_uindex));
+    if (!free_file.good() && nfree > 0) {
+        PSP_COMPLAIN_AND_ABORT("Could not read snapshot free list in `" + dirname + "`");
+    }
+    m_free.insert(free_items.begin(), free_items.end());
+
+    for (t_uindex idx = 0; idx < nrows; ++idx) {
+        if (m_free.find(idx) == m_free.end()) {
+            m_mapping.insert(m_pkcol->get_scalar(idx), idx);
+        }
+    }
+
+    // Loading gave shared columns a vocabulary of their own.
+    _attach_shared_vocabularies();
+    _build_sorted_indexes();
 }
 
 t_tscalar
@@ -781,9 +1452,9 @@ t_gstate::get_value(const t_tscalar& pkey, const std::string& colname) const {
     const t_column* col_ = col.get();
     t_tscalar rval = mknone();
 
-    auto iter = m_mapping.find(pkey);
-    if (iter != m_mapping.end()) {
-        rval.set(col_->get_scalar(iter->second));
+    t_uindex ridx;
+    if (m_mapping.find(pkey, ridx)) {
+        rval.set(col_->get_scalar(ridx));
     }
 
     return rval;
@@ -9,6 +9,8 @@
 
 #include <perspective/first.h>
 #include <perspective/histogram.h>
+#include <perspective/column.h>
+#include <algorithm>
 
 namespace perspective {
 t_hist_bucket::t_hist_bucket(t_tscalar begin, t_tscalar end, t_uindex count)
@@ -24,4 +26,114 @@ t_histogram::t_histogram() {}
 t_histogram::t_histogram(t_uindex nbuckets)
     : m_buckets(std::vector<t_hist_bucket>(nbuckets)) {}
 
+namespace {
+
+/**
+ * @brief Append the valid values of `column` at `indices` to `out` as
+ * doubles, in one pass over the typed buffer.
+ */
+template <typename T>
+void
+gather_values(
+    const t_column& column, const std::vector<t_uindex>& indices, std::vector<double>& out) {
+    const T* data = column.get_nth<T>(0);
+    const t_status* status = column.is_status_enabled() ? column.get_nth_status(0) : nullptr;
+
+    out.reserve(indices.size());
+    for (t_uindex ridx : indices) {
+        if (status && status[ridx] != STATUS_VALID) {
+            continue;
+        }
+
+        out.push_back(static_cast<double>(data[ridx]));
+    }
+}
+
+t_tscalar
+make_bound(double value, bool is_time) {
+    t_tscalar rval;
+    if (is_time) {
+        rval.set(t_time(static_cast<std::int64_t>(value)));
+    } else {
+        rval.set(value);
+    }
+
+    return rval;
+}
+
+} // end anonymous namespace
+
+t_histogram
+make_histogram(const t_column& column, const std::vector<t_uindex>& indices,
+    t_uindex nbuckets, t_binning binning) {
+    t_histogram rval;
+    std::vector<double> values;
+
+    switch (column.get_dtype()) {
+        case DTYPE_INT64: gather_values<std::int64_t>(column, indices, values); break;
+        case DTYPE_INT32: gather_values<std::int32_t>(column, indices, values); break;
+        case DTYPE_INT16: gather_values<std::int16_t>(column, indices, values); break;
+        case DTYPE_INT8: gather_values<std::int8_t>(column, indices, values); break;
+        case DTYPE_UINT64: gather_values<std::uint64_t>(column, indices, values); break;
+        case DTYPE_UINT32: gather_values<std::uint32_t>(column, indices, values); break;
+        case DTYPE_UINT16: gather_values<std::uint16_t>(column, indices, values); break;
+        case DTYPE_UINT8: gather_values<std::uint8_t>(column, indices, values); break;
+        case DTYPE_FLOAT64: gather_values<double>(column, indices, values); break;
+        case DTYPE_FLOAT32: gather_values<float>(column, indices, values); break;
+        case DTYPE_TIME: gather_values<t_time::t_rawtype>(column, indices, values); break;
+        default: return rval;
+    }
+
+    t_uindex nvalues = values.size();
+    if (nbuckets == 0 || nvalues == 0) {
+        return rval;
+    }
+
+    bool is_time = column.get_dtype() == DTYPE_TIME;
+
+    if (binning == BINNING_QUANTILE) {
+        std::sort(values.begin(), values.end());
+
+        for (t_uindex bidx = 0; bidx < nbuckets; ++bidx) {
+            t_uindex begin = bidx * nvalues / nbuckets;
+            t_uindex end = (bidx + 1) * nvalues / nbuckets;
+            if (end == begin) {
+                continue;
+            }
+
+            rval.m_buckets.push_back(t_hist_bucket(make_bound(values[begin], is_time),
+                make_bound(values[end - 1], is_time), end - begin));
+        }
+
+        return rval;
+    }
+
+    auto extents = std::minmax_element(values.begin(), values.end());
+    double min = *extents.first;
+    double max = *extents.second;
+
+    // A single value fills a single bucket
+    if (min == max) {
+        rval.m_buckets.push_back(
+            t_hist_bucket(make_bound(min, is_time), make_bound(max, is_time), nvalues));
+        return rval;
+    }
+
+    double width = (max - min) / nbuckets;
+    std::vector<t_uindex> counts(nbuckets, 0);
+
+    for (double value : values) {
+        t_uindex bidx = static_cast<t_uindex>((value - min) / width);
+        counts[std::min(bidx, nbuckets - 1)] += 1;
+    }
+
+    for (t_uindex bidx = 0; bidx < nbuckets; ++bidx) {
+        double end = bidx == nbuckets - 1 ? max : min + (bidx + 1) * width;
+        rval.m_buckets.push_back(t_hist_bucket(
+            make_bound(min + bidx * width, is_time), make_bound(end, is_time), counts[bidx]));
+    }
+
+    return rval;
+}
+
 } // end namespace perspective
@@ -0,0 +1,164 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2017, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#include <perspective/first.h>
+#include <perspective/hll_sketch.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// The sketch has 2^PSP_HLL_PRECISION registers.
+#define PSP_HLL_PRECISION 12
+#define PSP_HLL_REGISTERS (1u << PSP_HLL_PRECISION)
+
+// The sorted list of set registers is converted to an array once it would
+// be as large.
+#define PSP_HLL_MAX_SPARSE (PSP_HLL_REGISTERS / sizeof(std::uint32_t))
+
+namespace perspective {
+
+namespace {
+    // The finalizer of splitmix64, which spreads the differences between
+    // nearby integers across every bit of the hash.
+    std::uint64_t
+    mix_hash(std::uint64_t h) {
+        h ^= h >> 30;
+        h *= 0xbf58476d1ce4e5b9ULL;
+        h ^= h >> 27;
+        h *= 0x94d049bb133111ebULL;
+        h ^= h >> 31;
+        return h;
+    }
+
+    // Hashes a value as `t_value_multiset` compares it: strings by their
+    // characters, every null alike, and negative zero as zero.
+    std::uint64_t
+    hash_value_64(const t_tscalar& value) {
+        if (!value.is_valid()) {
+            return mix_hash(0);
+        }
+
+        std::uint64_t h;
+        if (value.m_type == DTYPE_STR) {
+            // FNV-1a
+            h = 0xcbf29ce484222325ULL;
+            for (const char* c = value.get_char_ptr(); *c != '\0'; ++c) {
+                h ^= static_cast<unsigned char>(*c);
+                h *= 0x100000001b3ULL;
+            }
+        } else if (value.is_floating_point() && value.to_double() == 0) {
+            h = 0;
+        } else {
+            h = value.m_data.m_uint64;
+        }
+
+        return mix_hash(h ^ (std::uint64_t(value.m_type) << 56));
+    }
+} // namespace
+
+t_hll_sketch::t_hll_sketch()
+    : m_inserted(0)
+    , m_removed(0) {}
+
+void
+t_hll_sketch::insert(const t_tscalar& value) {
+    insert_hash(hash_value_64(value));
+    ++m_inserted;
+}
+
+void
+t_hll_sketch::remove() {
+    ++m_removed;
+}
+
+bool
+t_hll_sketch::needs_rebuild() const {
+    return m_removed > 0 && 2 * m_removed > m_inserted;
+}
+
+void
+t_hll_sketch::clear() {
+    m_sparse.clear();
+    m_registers.clear();
+    m_inserted = 0;
+    m_removed = 0;
+}
+
+void
+t_hll_sketch::insert_hash(std::uint64_t hash) {
+    std::uint32_t reg = static_cast<std::uint32_t>(hash >> (64 - PSP_HLL_PRECISION));
+
+    // The rank is the position of the first set bit after the register bits.
+    std::uint64_t w = hash << PSP_HLL_PRECISION;
+    std::uint8_t rank = 1;
+    while (rank <= 64 - PSP_HLL_PRECISION && (w & (std::uint64_t(1) << 63)) == 0) {
+        w <<= 1;
+        ++rank;
+    }
+
+    if (!m_registers.empty()) {
+        m_registers[reg] = std::max(m_registers[reg], rank);
+        return;
+    }
+
+    std::uint32_t entry = (reg << 8) | rank;
+    auto iter = std::lower_bound(m_sparse.begin(), m_sparse.end(), reg << 8);
+    if (iter != m_sparse.end() && (*iter >> 8) == reg) {
+        *iter = std::max(*iter, entry);
+        return;
+    }
+
+    m_sparse.insert(iter, entry);
+    if (m_sparse.size() > PSP_HLL_MAX_SPARSE) {
+        densify();
+    }
+}
+
+void
+t_hll_sketch::densify() {
+    m_registers.assign(PSP_HLL_REGISTERS, 0);
+    for (std::uint32_t entry : m_sparse) {
+        m_registers[entry >> 8] = static_cast<std::uint8_t>(entry & 0xff);
+    }
+    std::vector<std::uint32_t>().swap(m_sparse);
+}
+
+std::uint64_t
+t_hll_sketch::estimate() const {
+    const double m = PSP_HLL_REGISTERS;
+
+    // Few enough registers are set that counting the empty ones is the
+    // more accurate estimate.
+    if (m_registers.empty()) {
+        double zeros = m - m_sparse.size();
+        return static_cast<std::uint64_t>(std::llround(m * std::log(m / zeros)));
+    }
+
+    double sum = 0;
+    t_uindex zeros = 0;
+    for (std::uint8_t rank : m_registers) {
+        sum += std::ldexp(1.0, -static_cast<int>(rank));
+        zeros += rank == 0;
+    }
+
+    double alpha = 0.7213 / (1 + 1.079 / m);
+    double estimate = alpha * m * m / sum;
+    if (estimate <= 2.5 * m && zeros > 0) {
+        estimate = m * std::log(m / zeros);
+    }
+
+    return static_cast<std::uint64_t>(std::llround(estimate));
+}
+
+t_uindex
+t_hll_sketch::nbytes() const {
+    return m_sparse.capacity() * sizeof(std::uint32_t) + m_registers.capacity();
+}
+
+} // end namespace perspective
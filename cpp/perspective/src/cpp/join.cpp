@@ -0,0 +1,411 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#include <perspective/first.h>
+#include <perspective/join.h>
+#include <perspective/sym_table.h>
+#include <limits>
+
+namespace perspective {
+
+namespace {
+
+bool
+is_internal_column(const std::string& name) {
+    return name == "psp_pkey" || name == "psp_okey" || name == "psp_op";
+}
+
+/**
+ * @brief Returns `s` with its string, if any, interned, so that it outlives
+ * the table it was read from. Nulls are kept as null.
+ */
+t_tscalar
+intern(const t_tscalar& s) {
+    if (!s.is_valid()) {
+        return mknone();
+    }
+    return get_interned_tscalar(s);
+}
+
+void
+set_value(t_column& col, t_uindex idx, const t_tscalar& value) {
+    if (value.is_valid()) {
+        col.set_scalar(idx, value);
+    } else {
+        col.clear(idx);
+    }
+}
+
+/**
+ * @brief Returns the keys and ops of the rows of a flattened update.
+ */
+void
+read_keys(const t_data_table& flattened, std::vector<t_tscalar>& upserts,
+    std::vector<t_tscalar>& deletes) {
+    const t_column* pkey_col = flattened.get_const_column("psp_pkey").get();
+    const t_column* op_col = flattened.get_const_column("psp_op").get();
+    for (t_uindex idx = 0, loop_end = flattened.size(); idx < loop_end; ++idx) {
+        t_tscalar pkey = intern(pkey_col->get_scalar(idx));
+        if (*op_col->get_nth<std::uint8_t>(idx) == OP_DELETE) {
+            deletes.push_back(pkey);
+        } else {
+            upserts.push_back(pkey);
+        }
+    }
+}
+
+} // end anonymous namespace
+
+t_join::t_join(std::shared_ptr<Table> left, std::shared_ptr<Table> right,
+    const std::string& on)
+    : m_left(left)
+    , m_right(right)
+    , m_on(on)
+    , m_attached(false)
+    , m_left_listener(0)
+    , m_right_listener(0) {
+    t_schema left_schema = m_left->get_schema();
+    t_schema right_schema = m_right->get_schema();
+
+    if (m_left->get_index().empty()) {
+        PSP_COMPLAIN_AND_ABORT("Cannot join a table without an index");
+    }
+
+    if (m_right->get_index() != m_on) {
+        PSP_COMPLAIN_AND_ABORT(
+            "Cannot join on `" + m_on + "`, as the right table is not indexed by it");
+    }
+
+    if (!left_schema.has_column(m_on)) {
+        PSP_COMPLAIN_AND_ABORT("Cannot join on `" + m_on + "`, as the left table lacks it");
+    }
+
+    if (left_schema.get_dtype(m_on) != right_schema.get_dtype(m_on)) {
+        PSP_COMPLAIN_AND_ABORT(
+            "Cannot join on `" + m_on + "`, as its types differ between the tables");
+    }
+
+    for (const std::string& name : left_schema.columns()) {
+        if (!is_internal_column(name)) {
+            m_left_columns.push_back(name);
+            m_left_types.push_back(left_schema.get_dtype(name));
+        }
+    }
+
+    for (const std::string& name : right_schema.columns()) {
+        if (is_internal_column(name) || name == m_on) {
+            continue;
+        }
+        if (left_schema.has_column(name)) {
+            PSP_COMPLAIN_AND_ABORT("Cannot join, as both tables have a column `" + name + "`");
+        }
+        m_right_columns.push_back(name);
+        m_right_types.push_back(right_schema.get_dtype(name));
+    }
+
+    std::vector<std::string> names(m_left_columns);
+    names.insert(names.end(), m_right_columns.begin(), m_right_columns.end());
+    std::vector<t_dtype> types(m_left_types);
+    types.insert(types.end(), m_right_types.begin(), m_right_types.end());
+
+    const std::string& index = m_left->get_index();
+    m_joined = std::make_shared<Table>(std::make_shared<t_pool>(), names, types,
+        std::numeric_limits<std::uint32_t>::max(), index);
+
+    auto data = std::make_shared<t_data_table>(t_schema(names, types));
+    data->init();
+    data->clone_column(index, "psp_pkey");
+    data->clone_column(index, "psp_okey");
+    m_joined->init(data, 0, OP_INSERT, 0);
+}
+
+t_join::~t_join() { detach(); }
+
+void
+t_join::init() {
+    std::shared_ptr<t_gnode> left_gnode = m_left->get_gnode();
+    std::shared_ptr<t_gnode> right_gnode = m_right->get_gnode();
+
+    // The gnodes are locked left first, and the join last, as processing
+    // each side locks its gnode then the join.
+    auto left_lock = m_left->get_pool()->lock_gnode(left_gnode->get_id());
+    auto right_lock = m_right->get_pool()->lock_gnode(right_gnode->get_id());
+    std::lock_guard<std::mutex> lock(m_mtx);
+    if (m_attached) {
+        return;
+    }
+
+    std::vector<t_tscalar> rkeys = right_gnode->get_pkeys();
+    for (t_tscalar& rkey : rkeys) {
+        rkey = intern(rkey);
+    }
+
+    std::vector<t_tscalar> values;
+    for (t_uindex cidx = 0, cloop_end = m_right_columns.size(); cidx < cloop_end; ++cidx) {
+        right_gnode->read_column(m_right_columns[cidx], rkeys, values);
+        for (t_uindex idx = 0, loop_end = rkeys.size(); idx < loop_end; ++idx) {
+            std::vector<t_tscalar>& row = m_right_rows[rkeys[idx]];
+            row.resize(m_right_columns.size());
+            row[cidx] = intern(values[idx]);
+        }
+    }
+
+    std::vector<t_tscalar> pkeys = left_gnode->get_pkeys();
+    for (t_tscalar& pkey : pkeys) {
+        pkey = intern(pkey);
+    }
+
+    send_left_rows(pkeys);
+
+    m_left_listener = left_gnode->add_update_listener(
+        [this](const t_data_table& flattened) { on_left_update(flattened); });
+    m_right_listener = right_gnode->add_update_listener(
+        [this](const t_data_table& flattened) { on_right_update(flattened); });
+    m_attached = true;
+}
+
+void
+t_join::detach() {
+    std::shared_ptr<t_gnode> left_gnode = m_left->get_gnode();
+    std::shared_ptr<t_gnode> right_gnode = m_right->get_gnode();
+
+    auto left_lock = m_left->get_pool()->lock_gnode(left_gnode->get_id());
+    auto right_lock = m_right->get_pool()->lock_gnode(right_gnode->get_id());
+    std::lock_guard<std::mutex> lock(m_mtx);
+    if (!m_attached) {
+        return;
+    }
+
+    left_gnode->remove_update_listener(m_left_listener);
+    right_gnode->remove_update_listener(m_right_listener);
+    m_matches.clear();
+    m_matched_by.clear();
+    m_right_rows.clear();
+    m_attached = false;
+}
+
+std::shared_ptr<Table>
+t_join::get_table() const {
+    return m_joined;
+}
+
+t_uindex
+t_join::num_matched_keys() const {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    return m_matched_by.size();
+}
+
+void
+t_join::on_left_update(const t_data_table& flattened) {
+    std::vector<t_tscalar> upserts;
+    std::vector<t_tscalar> deletes;
+    read_keys(flattened, upserts, deletes);
+
+    std::lock_guard<std::mutex> lock(m_mtx);
+    for (const t_tscalar& pkey : deletes) {
+        set_match(pkey, mknone(), false);
+    }
+
+    send_deletes(deletes);
+    send_left_rows(upserts);
+}
+
+void
+t_join::on_right_update(const t_data_table& flattened) {
+    std::vector<t_tscalar> upserts;
+    std::vector<t_tscalar> deletes;
+    read_keys(flattened, upserts, deletes);
+
+    // Read the new rows before locking the join, as only this thread
+    // processes `right`.
+    std::vector<std::vector<t_tscalar>> columns(m_right_columns.size());
+    std::shared_ptr<t_gnode> right_gnode = m_right->get_gnode();
+    for (t_uindex cidx = 0, loop_end = m_right_columns.size(); cidx < loop_end; ++cidx) {
+        right_gnode->read_column(m_right_columns[cidx], upserts, columns[cidx]);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mtx);
+    for (const t_tscalar& rkey : deletes) {
+        m_right_rows.erase(rkey);
+    }
+
+    for (t_uindex idx = 0, loop_end = upserts.size(); idx < loop_end; ++idx) {
+        std::vector<t_tscalar>& row = m_right_rows[upserts[idx]];
+        row.resize(m_right_columns.size());
+        for (t_uindex cidx = 0, cloop_end = m_right_columns.size(); cidx < cloop_end; ++cidx) {
+            row[cidx] = intern(columns[cidx][idx]);
+        }
+    }
+
+    send_right_columns(deletes);
+    send_right_columns(upserts);
+}
+
+void
+t_join::send_left_rows(const std::vector<t_tscalar>& pkeys) {
+    if (pkeys.empty()) {
+        return;
+    }
+
+    std::vector<std::string> names(m_left_columns);
+    names.insert(names.end(), m_right_columns.begin(), m_right_columns.end());
+    std::vector<t_dtype> types(m_left_types);
+    types.insert(types.end(), m_right_types.begin(), m_right_types.end());
+
+    auto data = std::make_shared<t_data_table>(t_schema(names, types));
+    data->init();
+    data->extend(pkeys.size());
+
+    std::shared_ptr<t_gnode> left_gnode = m_left->get_gnode();
+    for (t_uindex cidx = 0, cloop_end = m_left_columns.size(); cidx < cloop_end; ++cidx) {
+        left_gnode->copy_column(
+            m_left_columns[cidx], pkeys, *data->get_column(m_left_columns[cidx]));
+    }
+
+    // Only the values matched on are read as scalars.
+    std::vector<t_tscalar> values;
+    left_gnode->read_column(m_on, pkeys, values);
+    for (t_uindex idx = 0, loop_end = pkeys.size(); idx < loop_end; ++idx) {
+        set_match(pkeys[idx], intern(values[idx]), true);
+    }
+
+    std::vector<t_column*> right_cols(m_right_columns.size());
+    for (t_uindex cidx = 0, cloop_end = m_right_columns.size(); cidx < cloop_end; ++cidx) {
+        right_cols[cidx] = data->get_column(m_right_columns[cidx]).get();
+    }
+
+    for (t_uindex idx = 0, loop_end = pkeys.size(); idx < loop_end; ++idx) {
+        const std::vector<t_tscalar>* row = nullptr;
+        auto match = m_matches.find(pkeys[idx]);
+        if (match != m_matches.end()) {
+            auto right_row = m_right_rows.find(match->second);
+            if (right_row != m_right_rows.end()) {
+                row = &right_row->second;
+            }
+        }
+
+        for (t_uindex cidx = 0, cloop_end = right_cols.size(); cidx < cloop_end; ++cidx) {
+            if (row) {
+                set_value(*right_cols[cidx], idx, (*row)[cidx]);
+            } else {
+                right_cols[cidx]->clear(idx);
+            }
+        }
+    }
+
+    const std::string& index = m_left->get_index();
+    data->clone_column(index, "psp_pkey");
+    data->clone_column(index, "psp_okey");
+    m_joined->init(data, pkeys.size(), OP_INSERT, 0);
+}
+
+void
+t_join::send_right_columns(const std::vector<t_tscalar>& rkeys) {
+    std::vector<t_tscalar> pkeys;
+    std::vector<const std::vector<t_tscalar>*> rows;
+    for (const t_tscalar& rkey : rkeys) {
+        auto matched = m_matched_by.find(rkey);
+        if (matched == m_matched_by.end()) {
+            continue;
+        }
+
+        const std::vector<t_tscalar>* row = nullptr;
+        auto right_row = m_right_rows.find(rkey);
+        if (right_row != m_right_rows.end()) {
+            row = &right_row->second;
+        }
+
+        for (const t_tscalar& pkey : matched->second) {
+            pkeys.push_back(pkey);
+            rows.push_back(row);
+        }
+    }
+
+    if (pkeys.empty()) {
+        return;
+    }
+
+    // A partial update of the columns of `right`, keyed by the index of
+    // `left`, so that the columns of `left` are left as they are.
+    const std::string& index = m_left->get_index();
+    std::vector<std::string> names{index};
+    names.insert(names.end(), m_right_columns.begin(), m_right_columns.end());
+    std::vector<t_dtype> types{m_left->get_schema().get_dtype(index)};
+    types.insert(types.end(), m_right_types.begin(), m_right_types.end());
+
+    auto data = std::make_shared<t_data_table>(t_schema(names, types));
+    data->init();
+    data->extend(pkeys.size());
+
+    t_column* index_col = data->get_column(index).get();
+    for (t_uindex idx = 0, loop_end = pkeys.size(); idx < loop_end; ++idx) {
+        index_col->set_scalar(idx, pkeys[idx]);
+    }
+
+    for (t_uindex cidx = 0, cloop_end = m_right_columns.size(); cidx < cloop_end; ++cidx) {
+        t_column* col = data->get_column(m_right_columns[cidx]).get();
+        for (t_uindex idx = 0, loop_end = pkeys.size(); idx < loop_end; ++idx) {
+            if (rows[idx]) {
+                set_value(*col, idx, (*rows[idx])[cidx]);
+            } else {
+                col->clear(idx);
+            }
+        }
+    }
+
+    data->clone_column(index, "psp_pkey");
+    data->clone_column(index, "psp_okey");
+    m_joined->init(data, pkeys.size(), OP_INSERT, 0);
+}
+
+void
+t_join::send_deletes(const std::vector<t_tscalar>& pkeys) {
+    if (pkeys.empty()) {
+        return;
+    }
+
+    // The index and primary key columns, as `Table::remove_where` sends.
+    const std::string& index = m_left->get_index();
+    auto data = std::make_shared<t_data_table>(
+        t_schema({index}, {m_left->get_schema().get_dtype(index)}));
+    data->init();
+    data->extend(pkeys.size());
+    t_column* index_col = data->get_column(index).get();
+    for (t_uindex idx = 0, loop_end = pkeys.size(); idx < loop_end; ++idx) {
+        index_col->set_scalar(idx, pkeys[idx]);
+    }
+
+    data->clone_column(index, "psp_pkey");
+    data->clone_column(index, "psp_okey");
+    m_joined->init(data, pkeys.size(), OP_DELETE, 0);
+}
+
+void
+t_join::set_match(const t_tscalar& pkey, const t_tscalar& rkey, bool has_rkey) {
+    auto match = m_matches.find(pkey);
+    if (match != m_matches.end()) {
+        if (has_rkey && rkey.is_valid() && match->second == rkey) {
+            return;
+        }
+
+        tsl::hopscotch_set<t_tscalar>& matched = m_matched_by[match->second];
+        matched.erase(pkey);
+        if (matched.empty()) {
+            m_matched_by.erase(match->second);
+        }
+        m_matches.erase(match);
+    }
+
+    if (has_rkey && rkey.is_valid()) {
+        m_matches[pkey] = rkey;
+        m_matched_by[rkey].insert(pkey);
+    }
+}
+
+} // end namespace perspective
@@ -0,0 +1,632 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#include <perspective/first.h>
+#include <perspective/json_loader.h>
+#include <perspective/date_parser.h>
+#include <perspective/column.h>
+#include <perspective/scheduler.h>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace perspective {
+namespace json {
+
+    namespace {
+
+        const t_json_cell EMPTY_CELL = {0, 0, false};
+
+        const char*
+        skip_whitespace(const char* p, const char* end) {
+            while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) {
+                ++p;
+            }
+            return p;
+        }
+
+        const char*
+        skip_bom(const char* p, const char* end) {
+            if (end - p >= 3 && std::memcmp(p, "\xEF\xBB\xBF", 3) == 0) {
+                p += 3;
+            }
+            return p;
+        }
+
+        bool
+        starts_with(const char* p, const char* end, const char* word) {
+            std::size_t length = std::strlen(word);
+            return std::size_t(end - p) >= length && std::memcmp(p, word, length) == 0;
+        }
+
+        std::int32_t
+        hex_value(char c) {
+            if (c >= '0' && c <= '9') {
+                return c - '0';
+            } else if (c >= 'a' && c <= 'f') {
+                return c - 'a' + 10;
+            } else if (c >= 'A' && c <= 'F') {
+                return c - 'A' + 10;
+            }
+            return -1;
+        }
+
+        /**
+         * @brief Read the four hex digits of a `\u` escape at `p`, returning
+         * -1 if they are invalid.
+         */
+        std::int32_t
+        read_code_unit(const char* p, const char* end) {
+            if (end - p < 4) {
+                return -1;
+            }
+
+            std::int32_t code = 0;
+            for (std::int32_t i = 0; i < 4; ++i) {
+                std::int32_t digit = hex_value(p[i]);
+                if (digit < 0) {
+                    return -1;
+                }
+                code = code * 16 + digit;
+            }
+
+            return code;
+        }
+
+        void
+        append_utf8(std::string& out, std::uint32_t code) {
+            if (code < 0x80) {
+                out.push_back(static_cast<char>(code));
+            } else if (code < 0x800) {
+                out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+                out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+            } else if (code < 0x10000) {
+                out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+                out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+            } else {
+                out.push_back(static_cast<char>(0xF0 | (code >> 18)));
+                out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+            }
+        }
+
+    } // end anonymous namespace
+
+    bool
+    is_json(const char* data, std::size_t length) {
+        const char* end = data + length;
+        const char* p = skip_whitespace(skip_bom(data, end), end);
+        if (p == end || (*p != '[' && *p != '{')) {
+            return false;
+        }
+
+        // Check the next token too, as an Arrow stream may start with `{`.
+        char open = *p;
+        p = skip_whitespace(p + 1, end);
+        if (p == end) {
+            return false;
+        }
+
+        return open == '[' ? (*p == '{' || *p == ']') : (*p == '"' || *p == '}');
+    }
+
+    JsonLoader::JsonLoader()
+        : m_data(nullptr)
+        , m_end(nullptr)
+        , m_row_count(0) {}
+
+    JsonLoader::~JsonLoader() {}
+
+    void
+    JsonLoader::initialize(const char* data, std::size_t length) {
+        PSP_VERBOSE_ASSERT(length < std::numeric_limits<std::uint32_t>::max(),
+            "JSON documents must be smaller than 4GB");
+        m_data = data;
+        m_end = data + length;
+        m_unescaped.clear();
+        m_names.clear();
+        m_column_indices.clear();
+        m_columns.clear();
+        m_row_count = 0;
+
+        const char* p = skip_whitespace(skip_bom(m_data, m_end), m_end);
+        if (p == m_end || (*p != '[' && *p != '{')) {
+            error(p, "Expected a JSON array or object");
+        }
+
+        if (*p == '[') {
+            parse_rows(p, true);
+        } else {
+            // An object whose first value is an array holds columns, and
+            // otherwise is the first of newline-delimited rows.
+            bool is_columns = false;
+            const char* q = skip_whitespace(p + 1, m_end);
+            if (q < m_end && *q == '"') {
+                std::string key;
+                q = skip_whitespace(parse_key(q, key), m_end);
+                if (q < m_end && *q == ':') {
+                    q = skip_whitespace(q + 1, m_end);
+                    is_columns = q < m_end && *q == '[';
+                }
+            }
+
+            if (is_columns) {
+                parse_columns(p);
+            } else {
+                parse_rows(p, false);
+            }
+        }
+
+        m_types = infer_types();
+    }
+
+    void
+    JsonLoader::parse_rows(const char* p, bool is_array) {
+        if (!is_array) {
+            while (true) {
+                p = skip_whitespace(p, m_end);
+                if (p == m_end) {
+                    return;
+                } else if (*p != '{') {
+                    error(p, "Expected a row object");
+                }
+                p = parse_row(p);
+            }
+        }
+
+        p = skip_whitespace(p + 1, m_end);
+        if (p < m_end && *p == ']') {
+            ++p;
+        } else {
+            while (true) {
+                if (p == m_end || *p != '{') {
+                    error(p, "Expected a row object");
+                }
+
+                p = skip_whitespace(parse_row(p), m_end);
+                if (p < m_end && *p == ',') {
+                    p = skip_whitespace(p + 1, m_end);
+                } else if (p < m_end && *p == ']') {
+                    ++p;
+                    break;
+                } else {
+                    error(p, "Expected `,` or `]`");
+                }
+            }
+        }
+
+        if (skip_whitespace(p, m_end) != m_end) {
+            error(p, "Unexpected text after the rows");
+        }
+    }
+
+    const char*
+    JsonLoader::parse_row(const char* p) {
+        std::string key;
+        t_uindex hint = 0;
+
+        p = skip_whitespace(p + 1, m_end);
+        if (p < m_end && *p == '}') {
+            ++p;
+        } else {
+            while (true) {
+                if (p == m_end || *p != '"') {
+                    error(p, "Expected a key");
+                }
+
+                p = skip_whitespace(parse_key(p, key), m_end);
+                if (p == m_end || *p != ':') {
+                    error(p, "Expected `:`");
+                }
+
+                // Rows usually repeat the keys of the row before them, in
+                // the same order.
+                t_uindex cidx = get_column(key, hint);
+                hint = cidx + 1;
+
+                t_json_cell cell;
+                p = skip_whitespace(parse_value(skip_whitespace(p + 1, m_end), cell), m_end);
+
+                // The last of duplicate keys wins
+                std::vector<t_json_cell>& column = m_columns[cidx];
+                if (column.size() > m_row_count) {
+                    column.back() = cell;
+                } else {
+                    column.push_back(cell);
+                }
+
+                if (p < m_end && *p == ',') {
+                    p = skip_whitespace(p + 1, m_end);
+                } else if (p < m_end && *p == '}') {
+                    ++p;
+                    break;
+                } else {
+                    error(p, "Expected `,` or `}`");
+                }
+            }
+        }
+
+        ++m_row_count;
+        for (auto& column : m_columns) {
+            if (column.size() < m_row_count) {
+                column.push_back(EMPTY_CELL);
+            }
+        }
+
+        return p;
+    }
+
+    void
+    JsonLoader::parse_columns(const char* p) {
+        std::string key;
+        t_uindex hint = 0;
+
+        p = skip_whitespace(p + 1, m_end);
+        while (p < m_end && *p != '}') {
+            if (*p != '"') {
+                error(p, "Expected a key");
+            }
+
+            p = skip_whitespace(parse_key(p, key), m_end);
+            if (p == m_end || *p != ':') {
+                error(p, "Expected `:`");
+            }
+
+            p = skip_whitespace(p + 1, m_end);
+            if (p == m_end || *p != '[') {
+                error(p, "Expected an array of column values");
+            }
+
+            t_uindex cidx = get_column(key, hint);
+            hint = cidx + 1;
+            std::vector<t_json_cell>& column = m_columns[cidx];
+            column.clear();
+
+            p = skip_whitespace(p + 1, m_end);
+            if (p < m_end && *p == ']') {
+                ++p;
+            } else {
+                while (true) {
+                    t_json_cell cell;
+                    p = skip_whitespace(parse_value(p, cell), m_end);
+                    column.push_back(cell);
+
+                    if (p < m_end && *p == ',') {
+                        p = skip_whitespace(p + 1, m_end);
+                    } else if (p < m_end && *p == ']') {
+                        ++p;
+                        break;
+                    } else {
+                        error(p, "Expected `,` or `]`");
+                    }
+                }
+            }
+
+            p = skip_whitespace(p, m_end);
+            if (p < m_end && *p == ',') {
+                p = skip_whitespace(p + 1, m_end);
+            } else if (p == m_end || *p != '}') {
+                error(p, "Expected `,` or `}`");
+            }
+        }
+
+        if (p == m_end || skip_whitespace(p + 1, m_end) != m_end) {
+            error(p, "Unexpected text after the columns");
+        }
+
+        // Short columns are missing their last values
+        for (const auto& column : m_columns) {
+            m_row_count = std::max<t_uindex>(m_row_count, column.size());
+        }
+
+        for (auto& column : m_columns) {
+            column.resize(m_row_count, EMPTY_CELL);
+        }
+    }
+
+    const char*
+    JsonLoader::parse_value(const char* p, t_json_cell& cell) {
+        if (p == m_end) {
+            error(p, "Expected a value");
+        }
+
+        const char* begin = p;
+        switch (*p) {
+            case '"': {
+                return parse_string(p, cell);
+            }
+            case '{':
+            case '[': {
+                // Keep the text of nested values, skipping over their strings
+                std::int32_t depth = 0;
+                for (; p < m_end; ++p) {
+                    if (*p == '"') {
+                        for (++p; p < m_end && *p != '"'; ++p) {
+                            if (*p == '\\') {
+                                ++p;
+                            }
+                        }
+                    } else if (*p == '{' || *p == '[') {
+                        ++depth;
+                    } else if ((*p == '}' || *p == ']') && --depth == 0) {
+                        ++p;
+                        break;
+                    }
+                }
+
+                if (depth != 0) {
+                    error(begin, "Unterminated value");
+                }
+            } break;
+            case 'n': {
+                if (!starts_with(p, m_end, "null")) {
+                    error(p, "Invalid value");
+                }
+                cell = EMPTY_CELL;
+                return p + 4;
+            }
+            case 't':
+            case 'f': {
+                const char* word = *p == 't' ? "true" : "false";
+                if (!starts_with(p, m_end, word)) {
+                    error(p, "Invalid value");
+                }
+                p += std::strlen(word);
+            } break;
+            default: {
+                while (p < m_end
+                    && ((*p >= '0' && *p <= '9') || *p == '-' || *p == '+' || *p == '.'
+                        || *p == 'e' || *p == 'E')) {
+                    ++p;
+                }
+
+                if (p == begin) {
+                    error(p, "Invalid value");
+                }
+            } break;
+        }
+
+        cell.m_offset = begin - m_data;
+        cell.m_length = p - begin;
+        cell.m_unescaped = false;
+        return p;
+    }
+
+    const char*
+    JsonLoader::parse_string(const char* p, t_json_cell& cell) {
+        const char* begin = ++p;
+        while (p < m_end && *p != '"' && *p != '\\') {
+            ++p;
+        }
+
+        // Most strings have no escapes, and can be read in place.
+        if (p < m_end && *p == '"') {
+            cell.m_offset = begin - m_data;
+            cell.m_length = p - begin;
+            cell.m_unescaped = false;
+            return p + 1;
+        }
+
+        std::size_t start = m_unescaped.size();
+        m_unescaped.append(begin, p);
+
+        while (true) {
+            if (p == m_end) {
+                error(begin - 1, "Unterminated string");
+            }
+
+            char c = *p++;
+            if (c == '"') {
+                break;
+            } else if (c != '\\') {
+                m_unescaped.push_back(c);
+                continue;
+            } else if (p == m_end) {
+                error(begin - 1, "Unterminated string");
+            }
+
+            char escape = *p++;
+            switch (escape) {
+                case '"':
+                case '\\':
+                case '/': m_unescaped.push_back(escape); break;
+                case 'b': m_unescaped.push_back('\b'); break;
+                case 'f': m_unescaped.push_back('\f'); break;
+                case 'n': m_unescaped.push_back('\n'); break;
+                case 'r': m_unescaped.push_back('\r'); break;
+                case 't': m_unescaped.push_back('\t'); break;
+                case 'u': {
+                    std::int32_t code = read_code_unit(p, m_end);
+                    if (code < 0) {
+                        error(p, "Invalid `\\u` escape");
+                    }
+                    p += 4;
+
+                    // Combine a surrogate pair into one code point
+                    if (code >= 0xD800 && code <= 0xDBFF && starts_with(p, m_end, "\\u")) {
+                        std::int32_t low = read_code_unit(p + 2, m_end);
+                        if (low >= 0xDC00 && low <= 0xDFFF) {
+                            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                            p += 6;
+                        }
+                    }
+
+                    append_utf8(m_unescaped, code);
+                } break;
+                default: {
+                    error(p - 1, "Invalid escape");
+                }
+            }
+        }
+
+        cell.m_offset = start;
+        cell.m_length = m_unescaped.size() - start;
+        cell.m_unescaped = true;
+        return p;
+    }
+
+    const char*
+    JsonLoader::parse_key(const char* p, std::string& key) {
+        t_json_cell cell;
+        p = parse_string(p, cell);
+        csv::t_csv_field field = to_field(cell);
+        key.assign(field.m_begin, field.m_end);
+
+        // Keys are copied, so drop their unescaped text.
+        if (cell.m_unescaped) {
+            m_unescaped.resize(cell.m_offset);
+        }
+
+        return p;
+    }
+
+    t_uindex
+    JsonLoader::get_column(const std::string& name, t_uindex hint) {
+        if (hint < m_names.size() && m_names[hint] == name) {
+            return hint;
+        }
+
+        auto it = m_column_indices.find(name);
+        if (it != m_column_indices.end()) {
+            return it->second;
+        }
+
+        t_uindex cidx = m_names.size();
+        m_names.push_back(name);
+        m_column_indices[name] = cidx;
+        m_columns.push_back(std::vector<t_json_cell>(m_row_count, EMPTY_CELL));
+        return cidx;
+    }
+
+    csv::t_csv_field
+    JsonLoader::to_field(const t_json_cell& cell) const {
+        const char* base = cell.m_unescaped ? m_unescaped.data() : m_data;
+        csv::t_csv_field field = {
+            base + cell.m_offset, base + cell.m_offset + cell.m_length, false};
+        return field;
+    }
+
+    std::vector<t_dtype>
+    JsonLoader::infer_types() const {
+        t_uindex ncols = m_names.size();
+        std::vector<t_dtype> rval(ncols, DTYPE_NONE);
+        t_date_parser parser;
+
+        auto infer_column = [&](t_uindex cidx) {
+            t_dtype type = DTYPE_NONE;
+            for (const auto& cell : m_columns[cidx]) {
+                // Strings hold every value, so stop parsing the column
+                if (type == DTYPE_STR) {
+                    break;
+                }
+                type = csv::merge_types(type, csv::infer_field(parser, to_field(cell)));
+            }
+
+            // Columns without any value are read as strings
+            rval[cidx] = type == DTYPE_NONE ? DTYPE_STR : type;
+        };
+
+        t_scheduler::current().parallel_for(ncols,
+            [&infer_column](t_uindex cidx) { infer_column(cidx); });
+
+        return rval;
+    }
+
+    void
+    JsonLoader::fill_table(t_data_table& tbl, const std::string& index, std::uint32_t offset,
+        std::uint32_t limit, bool is_update) {
+        bool implicit_index = false;
+        t_uindex ncols = m_names.size();
+
+        // The column each key is written to, if it is in the table
+        std::vector<t_column*> columns(ncols, nullptr);
+        for (t_uindex cidx = 0; cidx < ncols; ++cidx) {
+            const std::string& name = m_names[cidx];
+            if (name == "__INDEX__") {
+                implicit_index = true;
+                columns[cidx] = tbl.add_column_sptr("psp_pkey", m_types[cidx], true).get();
+            } else if (tbl.get_schema().has_column(name)) {
+                columns[cidx] = tbl.get_column(name).get();
+            }
+        }
+
+        t_date_parser parser;
+
+        // Each column interns into its own vocabulary, so columns can be
+        // filled in parallel.
+        auto fill_column = [&](t_uindex cidx) {
+            t_column* col = columns[cidx];
+            if (col == nullptr) {
+                return;
+            }
+
+            const std::vector<t_json_cell>& cells = m_columns[cidx];
+            bool is_string = col->get_dtype() == DTYPE_STR;
+            csv::t_csv_date_layout layout;
+            for (t_uindex ridx = 0; ridx < m_row_count; ++ridx) {
+                csv::t_csv_field field = to_field(cells[ridx]);
+                if (!is_string) {
+                    csv::fill_value(parser, field, *col, ridx, is_update, layout);
+                } else if (field.m_begin != field.m_end) {
+                    col->set_nth(ridx, csv::field_to_string(field));
+                } else if (is_update) {
+                    col->unset(ridx);
+                } else {
+                    col->clear(ridx);
+                }
+            }
+        };
+
+        t_scheduler::current().parallel_for(ncols,
+            [&fill_column](t_uindex cidx) { fill_column(cidx); });
+
+        if (implicit_index) {
+            tbl.clone_column("psp_pkey", "psp_okey");
+        } else if (index == "") {
+            // Use row number as index if not explicitly provided or provided with
+            // `__INDEX__`
+            auto key_col = tbl.add_column("psp_pkey", DTYPE_INT32, true);
+            auto okey_col = tbl.add_column("psp_okey", DTYPE_INT32, true);
+
+            for (std::uint32_t ridx = 0; ridx < tbl.size(); ++ridx) {
+                key_col->set_nth<std::int32_t>(ridx, (ridx + offset) % limit);
+                okey_col->set_nth<std::int32_t>(ridx, (ridx + offset) % limit);
+            }
+        } else {
+            tbl.clone_column(index, "psp_pkey");
+            tbl.clone_column(index, "psp_okey");
+        }
+    }
+
+    void
+    JsonLoader::error(const char* p, const std::string& message) const {
+        std::stringstream ss;
+        ss << message << " at offset " << (p - m_data) << " of JSON";
+        PSP_COMPLAIN_AND_ABORT(ss.str());
+    }
+
+    std::vector<std::string>
+    JsonLoader::names() const {
+        return m_names;
+    }
+
+    std::vector<t_dtype>
+    JsonLoader::types() const {
+        return m_types;
+    }
+
+    std::uint32_t
+    JsonLoader::row_count() const {
+        return m_row_count;
+    }
+
+} // namespace json
+} // namespace perspective
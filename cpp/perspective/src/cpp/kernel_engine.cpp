@@ -1,8 +1,47 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#include <perspective/first.h>
 #include <perspective/kernel_engine.h>
 
 namespace perspective {
+
 t_kernel_evaluator::t_kernel_evaluator() {}
 
+void
+t_kernel_evaluator::register_reducer(const std::string& name, t_udf_reducer reducer) {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    m_reducers[name] = std::move(reducer);
+}
+
+void
+t_kernel_evaluator::unregister_reducer(const std::string& name) {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    m_reducers.erase(name);
+}
+
+bool
+t_kernel_evaluator::has_reducer(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    return m_reducers.find(name) != m_reducers.end();
+}
+
+t_udf_reducer
+t_kernel_evaluator::get_reducer(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    auto iter = m_reducers.find(name);
+    if (iter == m_reducers.end()) {
+        PSP_COMPLAIN_AND_ABORT("No reducer is registered as `" + name + "`.");
+    }
+    return iter->second;
+}
+
 t_kernel_evaluator*
 get_evaluator() {
     static t_kernel_evaluator* evaluator = new t_kernel_evaluator();
@@ -0,0 +1,269 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#include <perspective/first.h>
+#include <perspective/kernels.h>
+#include <perspective/env_vars.h>
+#include <perspective/portable.h>
+#include <algorithm>
+#include <atomic>
+
+// The variants are built with GCC or Clang target attributes, so need no
+// flags of the build's own.
+#if defined(PSP_CPU_DISPATCH) && (defined(__x86_64__) || defined(__i386__))                     \
+    && (defined(__GNUC__) || defined(__clang__))
+#define PSP_KERNEL_VARIANTS
+#define PSP_TARGET_AVX2 __attribute__((target("avx2")))
+#define PSP_TARGET_AVX512 __attribute__((target("avx512f,avx512bw,avx512vl,avx512dq")))
+#endif
+
+namespace perspective {
+
+std::string
+isa_to_str(t_isa isa) {
+    switch (isa) {
+        case ISA_AVX2:
+            return "avx2";
+        case ISA_AVX512:
+            return "avx512";
+        default:
+            return "default";
+    }
+}
+
+t_isa
+str_to_isa(const std::string& str) {
+    if (str == "default") {
+        return ISA_DEFAULT;
+    } else if (str == "avx2") {
+        return ISA_AVX2;
+    } else if (str == "avx512") {
+        return ISA_AVX512;
+    }
+
+    PSP_COMPLAIN_AND_ABORT("Unknown instruction set `" + str + "`");
+    return ISA_DEFAULT;
+}
+
+t_isa
+get_detected_isa() {
+    static const t_isa rv = []() {
+#ifdef PSP_KERNEL_VARIANTS
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")
+            && __builtin_cpu_supports("avx512vl") && __builtin_cpu_supports("avx512dq")) {
+            return ISA_AVX512;
+        }
+        if (__builtin_cpu_supports("avx2")) {
+            return ISA_AVX2;
+        }
+#endif
+        return ISA_DEFAULT;
+    }();
+    return rv;
+}
+
+namespace {
+    std::atomic<int>&
+    selected_isa() {
+        static std::atomic<int> rv([]() {
+            t_isa detected = get_detected_isa();
+            std::string env = t_env::isa();
+            if (env.empty()) {
+                return static_cast<int>(detected);
+            }
+            return static_cast<int>(std::min(detected, str_to_isa(env)));
+        }());
+        return rv;
+    }
+} // namespace
+
+t_isa
+get_isa() {
+    return static_cast<t_isa>(selected_isa().load(std::memory_order_relaxed));
+}
+
+void
+set_isa(t_isa isa) {
+    selected_isa().store(std::min(isa, get_detected_isa()), std::memory_order_relaxed);
+}
+
+namespace {
+
+    // The kernels, written as plain loops for the compiler to vectorize
+    // under each variant's instruction set.
+
+    template <typename DATA_T>
+    inline __ALWAYS_INLINE__ void
+    compare_impl(const DATA_T* data, DATA_T threshold, t_filter_op op, t_uindex nrows,
+        std::uint8_t* out) {
+        switch (op) {
+            case FILTER_OP_LT: {
+                for (t_uindex idx = 0; idx < nrows; ++idx) {
+                    out[idx] = data[idx] < threshold;
+                }
+            } break;
+            case FILTER_OP_LTEQ: {
+                for (t_uindex idx = 0; idx < nrows; ++idx) {
+                    out[idx] = data[idx] < threshold || filter_bits_eq(data[idx], threshold);
+                }
+            } break;
+            case FILTER_OP_GT: {
+                for (t_uindex idx = 0; idx < nrows; ++idx) {
+                    out[idx] = data[idx] > threshold;
+                }
+            } break;
+            case FILTER_OP_GTEQ: {
+                for (t_uindex idx = 0; idx < nrows; ++idx) {
+                    out[idx] = data[idx] > threshold || filter_bits_eq(data[idx], threshold);
+                }
+            } break;
+            case FILTER_OP_EQ: {
+                for (t_uindex idx = 0; idx < nrows; ++idx) {
+                    out[idx] = filter_bits_eq(data[idx], threshold);
+                }
+            } break;
+            case FILTER_OP_NE: {
+                for (t_uindex idx = 0; idx < nrows; ++idx) {
+                    out[idx] = !filter_bits_eq(data[idx], threshold);
+                }
+            } break;
+            default: { PSP_COMPLAIN_AND_ABORT("Unexpected comparison"); }
+        }
+    }
+
+    inline __ALWAYS_INLINE__ void
+    mask_and_impl(std::uint8_t* out, const std::uint8_t* in, t_uindex nrows) {
+        for (t_uindex idx = 0; idx < nrows; ++idx) {
+            out[idx] &= in[idx];
+        }
+    }
+
+    inline __ALWAYS_INLINE__ void
+    mask_or_impl(std::uint8_t* out, const std::uint8_t* in, t_uindex nrows) {
+        for (t_uindex idx = 0; idx < nrows; ++idx) {
+            out[idx] |= in[idx];
+        }
+    }
+
+    inline __ALWAYS_INLINE__ t_uindex
+    count_nonzero_impl(const std::uint8_t* values, t_uindex nrows) {
+        t_uindex count = 0;
+        for (t_uindex idx = 0; idx < nrows; ++idx) {
+            count += values[idx] != 0;
+        }
+        return count;
+    }
+
+    template <typename DATA_T>
+    inline __ALWAYS_INLINE__ void
+    min_max_impl(const DATA_T* data, t_uindex nrows, DATA_T& min, DATA_T& max) {
+        DATA_T lo = data[0];
+        DATA_T hi = data[0];
+        for (t_uindex idx = 1; idx < nrows; ++idx) {
+            DATA_T value = data[idx];
+            lo = value < lo ? value : lo;
+            hi = value > hi ? value : hi;
+        }
+        min = lo;
+        max = hi;
+    }
+
+#ifdef PSP_KERNEL_VARIANTS
+#define PSP_DEFINE_KERNEL_VARIANTS(SUFFIX, TARGET)                                              \
+    template <typename DATA_T>                                                                  \
+    TARGET void compare_##SUFFIX(const DATA_T* data, DATA_T threshold, t_filter_op op,          \
+        t_uindex nrows, std::uint8_t* out) {                                                    \
+        compare_impl(data, threshold, op, nrows, out);                                          \
+    }                                                                                           \
+    TARGET void mask_and_##SUFFIX(std::uint8_t* out, const std::uint8_t* in, t_uindex nrows) {  \
+        mask_and_impl(out, in, nrows);                                                          \
+    }                                                                                           \
+    TARGET void mask_or_##SUFFIX(std::uint8_t* out, const std::uint8_t* in, t_uindex nrows) {   \
+        mask_or_impl(out, in, nrows);                                                           \
+    }                                                                                           \
+    TARGET t_uindex count_nonzero_##SUFFIX(const std::uint8_t* values, t_uindex nrows) {        \
+        return count_nonzero_impl(values, nrows);                                               \
+    }                                                                                           \
+    template <typename DATA_T>                                                                  \
+    TARGET void min_max_##SUFFIX(const DATA_T* data, t_uindex nrows, DATA_T& min, DATA_T& max) { \
+        min_max_impl(data, nrows, min, max);                                                    \
+    }
+
+    PSP_DEFINE_KERNEL_VARIANTS(avx2, PSP_TARGET_AVX2)
+    PSP_DEFINE_KERNEL_VARIANTS(avx512, PSP_TARGET_AVX512)
+
+#undef PSP_DEFINE_KERNEL_VARIANTS
+
+// Returns from the enclosing kernel with the variant of `NAME` for the
+// selected instruction set.
+#define PSP_DISPATCH_KERNEL(NAME, ...)                                                          \
+    switch (get_isa()) {                                                                        \
+        case ISA_AVX512:                                                                        \
+            return NAME##_avx512(__VA_ARGS__);                                                  \
+        case ISA_AVX2:                                                                          \
+            return NAME##_avx2(__VA_ARGS__);                                                    \
+        default:                                                                                \
+            return NAME##_impl(__VA_ARGS__);                                                    \
+    }
+#else
+#define PSP_DISPATCH_KERNEL(NAME, ...) return NAME##_impl(__VA_ARGS__);
+#endif
+
+} // end anonymous namespace
+
+template <typename DATA_T>
+void
+kernel_compare(
+    const DATA_T* data, DATA_T threshold, t_filter_op op, t_uindex nrows, std::uint8_t* out) {
+    PSP_DISPATCH_KERNEL(compare, data, threshold, op, nrows, out);
+}
+
+void
+kernel_and(std::uint8_t* out, const std::uint8_t* in, t_uindex nrows) {
+    PSP_DISPATCH_KERNEL(mask_and, out, in, nrows);
+}
+
+void
+kernel_or(std::uint8_t* out, const std::uint8_t* in, t_uindex nrows) {
+    PSP_DISPATCH_KERNEL(mask_or, out, in, nrows);
+}
+
+t_uindex
+kernel_count_nonzero(const std::uint8_t* values, t_uindex nrows) {
+    PSP_DISPATCH_KERNEL(count_nonzero, values, nrows);
+}
+
+template <typename DATA_T>
+void
+kernel_min_max(const DATA_T* data, t_uindex nrows, DATA_T& min, DATA_T& max) {
+    PSP_DISPATCH_KERNEL(min_max, data, nrows, min, max);
+}
+
+#define PSP_INSTANTIATE_KERNELS(DATA_T)                                                         \
+    template void kernel_compare<DATA_T>(                                                       \
+        const DATA_T* data, DATA_T threshold, t_filter_op op, t_uindex nrows, std::uint8_t* out); \
+    template void kernel_min_max<DATA_T>(                                                       \
+        const DATA_T* data, t_uindex nrows, DATA_T& min, DATA_T& max);
+
+PSP_INSTANTIATE_KERNELS(std::int64_t)
+PSP_INSTANTIATE_KERNELS(std::int32_t)
+PSP_INSTANTIATE_KERNELS(std::int16_t)
+PSP_INSTANTIATE_KERNELS(std::int8_t)
+PSP_INSTANTIATE_KERNELS(std::uint64_t)
+PSP_INSTANTIATE_KERNELS(std::uint32_t)
+PSP_INSTANTIATE_KERNELS(std::uint16_t)
+PSP_INSTANTIATE_KERNELS(std::uint8_t)
+PSP_INSTANTIATE_KERNELS(double)
+PSP_INSTANTIATE_KERNELS(float)
+PSP_INSTANTIATE_KERNELS(bool)
+
+#undef PSP_INSTANTIATE_KERNELS
+
+} // end namespace perspective
@@ -0,0 +1,145 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2017, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#include <perspective/first.h>
+#include <perspective/base.h>
+#include <perspective/latency_histogram.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace perspective {
+
+namespace {
+    // Each power of two is split into `SUB_BUCKETS / 2` buckets, and values
+    // below `SUB_BUCKETS` are exact.
+    const t_uindex SUB_BUCKET_BITS = 5;
+    const t_uindex SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    const t_uindex HALF_SUB_BUCKETS = SUB_BUCKETS / 2;
+
+    void
+    store_min(std::atomic<std::uint64_t>& target, std::uint64_t v) {
+        std::uint64_t prev = target.load(std::memory_order_relaxed);
+        while (v < prev
+            && !target.compare_exchange_weak(prev, v, std::memory_order_relaxed)) {
+        }
+    }
+
+    void
+    store_max(std::atomic<std::uint64_t>& target, std::uint64_t v) {
+        std::uint64_t prev = target.load(std::memory_order_relaxed);
+        while (v > prev
+            && !target.compare_exchange_weak(prev, v, std::memory_order_relaxed)) {
+        }
+    }
+} // namespace
+
+constexpr t_uindex t_latency_histogram::NUM_BUCKETS;
+
+t_latency_histogram::t_latency_histogram() { reset(); }
+
+t_uindex
+t_latency_histogram::bucket_of(std::uint64_t ns) {
+    if (ns < SUB_BUCKETS) {
+        return ns;
+    }
+
+    t_uindex shift = psp_log2_64(ns) - (SUB_BUCKET_BITS - 1);
+    t_uindex idx = shift * HALF_SUB_BUCKETS + (ns >> shift);
+    return std::min(idx, NUM_BUCKETS - 1);
+}
+
+std::uint64_t
+t_latency_histogram::bucket_max(t_uindex idx) {
+    if (idx < SUB_BUCKETS) {
+        return idx;
+    }
+
+    t_uindex shift = idx / HALF_SUB_BUCKETS - 1;
+    std::uint64_t sub = idx % HALF_SUB_BUCKETS + HALF_SUB_BUCKETS;
+    return ((sub + 1) << shift) - 1;
+}
+
+void
+t_latency_histogram::record(std::int64_t ns) {
+    std::uint64_t v = ns > 0 ? static_cast<std::uint64_t>(ns) : 0;
+    m_buckets[bucket_of(v)].fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(v, std::memory_order_relaxed);
+    store_min(m_min, v);
+    store_max(m_max, v);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+t_uindex
+t_latency_histogram::count() const {
+    return m_count.load(std::memory_order_relaxed);
+}
+
+std::int64_t
+t_latency_histogram::percentile(double p) const {
+    std::uint64_t total = 0;
+    for (t_uindex idx = 0; idx < NUM_BUCKETS; ++idx) {
+        total += m_buckets[idx].load(std::memory_order_relaxed);
+    }
+
+    if (total == 0) {
+        return 0;
+    }
+
+    // The rank of the `p`th quantile, counting from 1.
+    p = std::max(0.0, std::min(1.0, p));
+    std::uint64_t rank
+        = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(p * total)));
+    std::uint64_t seen = 0;
+    std::uint64_t max = m_max.load(std::memory_order_relaxed);
+    for (t_uindex idx = 0; idx < NUM_BUCKETS; ++idx) {
+        seen += m_buckets[idx].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return std::min(bucket_max(idx), max);
+        }
+    }
+
+    return max;
+}
+
+void
+t_latency_histogram::write_stats(
+    std::map<std::string, double>& stats, const std::string& prefix) const {
+    std::uint64_t count = m_count.load(std::memory_order_relaxed);
+    stats[prefix + "count"] = count;
+    if (count == 0) {
+        stats[prefix + "min_ns"] = 0;
+        stats[prefix + "max_ns"] = 0;
+        stats[prefix + "mean_ns"] = 0;
+    } else {
+        stats[prefix + "min_ns"] = m_min.load(std::memory_order_relaxed);
+        stats[prefix + "max_ns"] = m_max.load(std::memory_order_relaxed);
+        stats[prefix + "mean_ns"]
+            = static_cast<double>(m_sum.load(std::memory_order_relaxed)) / count;
+    }
+
+    stats[prefix + "p50_ns"] = percentile(0.5);
+    stats[prefix + "p90_ns"] = percentile(0.9);
+    stats[prefix + "p99_ns"] = percentile(0.99);
+    stats[prefix + "p999_ns"] = percentile(0.999);
+}
+
+void
+t_latency_histogram::reset() {
+    for (t_uindex idx = 0; idx < NUM_BUCKETS; ++idx) {
+        m_buckets[idx].store(0, std::memory_order_relaxed);
+    }
+
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_min.store(std::numeric_limits<std::uint64_t>::max(), std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+} // end namespace perspective
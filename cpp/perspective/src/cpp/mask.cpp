@@ -9,89 +9,440 @@
 
 #include <perspective/first.h>
 #include <perspective/mask.h>
+#include <perspective/portable.h>
+#include <perspective/kernels.h>
 #include <perspective/raii.h>
+#include <algorithm>
+#include <iterator>
+
+// Indices are split into chunks of 2^PSP_MASK_CHUNK_BITS, whose containers
+// are arrays while they hold at most PSP_MASK_ARRAY_MAX indices, the count
+// at which an array is as large as a bitmap.
+#define PSP_MASK_CHUNK_BITS 16
+#define PSP_MASK_CHUNK_SIZE (t_uindex(1) << PSP_MASK_CHUNK_BITS)
+#define PSP_MASK_BITMAP_WORDS (PSP_MASK_CHUNK_SIZE / 64)
+#define PSP_MASK_ARRAY_MAX 4096
 
 namespace perspective {
 
-t_mask::t_mask() { LOG_CONSTRUCTOR("t_mask"); }
+namespace {
 
-t_mask::t_mask(t_uindex size)
-    : m_bitmap(t_msize(size)) {
+    t_uindex
+    popcount(std::uint64_t word) {
+        return psp_popcount64(word);
+    }
+
+    t_uindex
+    count_words(const std::vector<std::uint64_t>& words) {
+        t_uindex rval = 0;
+        for (std::uint64_t word : words) {
+            rval += popcount(word);
+        }
+        return rval;
+    }
+
+    void
+    to_bitmap(t_mask_container& c) {
+        if (c.is_bitmap()) {
+            return;
+        }
+
+        c.m_bitmap.assign(PSP_MASK_BITMAP_WORDS, 0);
+        for (std::uint16_t low : c.m_array) {
+            c.m_bitmap[low >> 6] |= std::uint64_t(1) << (low & 63);
+        }
+
+        std::vector<std::uint16_t>().swap(c.m_array);
+    }
+
+    /**
+     * @brief Convert a bitmap container that has become sparse back to an
+     * array, after `m_count` has been recomputed.
+     */
+    void
+    normalize(t_mask_container& c) {
+        if (!c.is_bitmap() || c.m_count > PSP_MASK_ARRAY_MAX) {
+            return;
+        }
+
+        std::vector<std::uint16_t> array;
+        array.reserve(c.m_count);
+        for (t_uindex widx = 0; widx < PSP_MASK_BITMAP_WORDS; ++widx) {
+            for (std::uint64_t word = c.m_bitmap[widx]; word != 0; word &= word - 1) {
+                array.push_back(widx * 64 + psp_ctz64(word));
+            }
+        }
+
+        c.m_array.swap(array);
+        std::vector<std::uint64_t>().swap(c.m_bitmap);
+    }
+
+    /**
+     * @brief Returns the first index in `c` at or after `low`, or
+     * `PSP_MASK_CHUNK_SIZE` if there is none.
+     */
+    t_uindex
+    container_find(const t_mask_container& c, t_uindex low) {
+        if (!c.is_bitmap()) {
+            auto it = std::lower_bound(c.m_array.begin(), c.m_array.end(), low);
+            return it == c.m_array.end() ? PSP_MASK_CHUNK_SIZE : *it;
+        }
+
+        t_uindex widx = low >> 6;
+        std::uint64_t word = c.m_bitmap[widx] & (~std::uint64_t(0) << (low & 63));
+        while (word == 0) {
+            if (++widx == PSP_MASK_BITMAP_WORDS) {
+                return PSP_MASK_CHUNK_SIZE;
+            }
+            word = c.m_bitmap[widx];
+        }
+
+        return widx * 64 + psp_ctz64(word);
+    }
+
+    /**
+     * @brief Combine the words of two bitmap containers with `fn` into `a`.
+     */
+    template <typename FN_T>
+    void
+    combine_bitmaps(t_mask_container& a, const t_mask_container& b, FN_T fn) {
+        t_uindex count = 0;
+        for (t_uindex widx = 0; widx < PSP_MASK_BITMAP_WORDS; ++widx) {
+            a.m_bitmap[widx] = fn(a.m_bitmap[widx], b.m_bitmap[widx]);
+            count += popcount(a.m_bitmap[widx]);
+        }
+
+        a.m_count = count;
+        normalize(a);
+    }
+
+    /**
+     * @brief Keep the indices of array container `a` for which `pred`.
+     */
+    template <typename PRED_T>
+    void
+    filter_array(t_mask_container& a, PRED_T pred) {
+        auto end = std::remove_if(
+            a.m_array.begin(), a.m_array.end(), [&pred](std::uint16_t low) { return !pred(low); });
+        a.m_array.erase(end, a.m_array.end());
+        a.m_count = a.m_array.size();
+    }
+
+    bool
+    container_test(const t_mask_container& c, t_uindex low) {
+        if (c.is_bitmap()) {
+            return (c.m_bitmap[low >> 6] >> (low & 63)) & 1;
+        }
+        return std::binary_search(c.m_array.begin(), c.m_array.end(), low);
+    }
+
+    void
+    container_and(t_mask_container& a, const t_mask_container& b) {
+        if (a.m_count == 0) {
+            return;
+        } else if (b.m_count == 0) {
+            a = t_mask_container();
+        } else if (!a.is_bitmap()) {
+            filter_array(a, [&b](std::uint16_t low) { return container_test(b, low); });
+        } else if (!b.is_bitmap()) {
+            t_mask_container rval = b;
+            filter_array(rval, [&a](std::uint16_t low) { return container_test(a, low); });
+            a = std::move(rval);
+        } else {
+            combine_bitmaps(a, b, [](std::uint64_t x, std::uint64_t y) { return x & y; });
+        }
+    }
+
+    void
+    container_andnot(t_mask_container& a, const t_mask_container& b) {
+        if (a.m_count == 0 || b.m_count == 0) {
+            return;
+        } else if (!a.is_bitmap()) {
+            filter_array(a, [&b](std::uint16_t low) { return !container_test(b, low); });
+        } else if (!b.is_bitmap()) {
+            for (std::uint16_t low : b.m_array) {
+                std::uint64_t bit = std::uint64_t(1) << (low & 63);
+                a.m_count -= (a.m_bitmap[low >> 6] & bit) != 0;
+                a.m_bitmap[low >> 6] &= ~bit;
+            }
+            normalize(a);
+        } else {
+            combine_bitmaps(a, b, [](std::uint64_t x, std::uint64_t y) { return x & ~y; });
+        }
+    }
+
+    void
+    container_or(t_mask_container& a, const t_mask_container& b) {
+        if (b.m_count == 0) {
+            return;
+        } else if (!a.is_bitmap() && !b.is_bitmap()
+            && a.m_count + b.m_count <= PSP_MASK_ARRAY_MAX) {
+            std::vector<std::uint16_t> merged;
+            merged.reserve(a.m_count + b.m_count);
+            std::set_union(a.m_array.begin(), a.m_array.end(), b.m_array.begin(),
+                b.m_array.end(), std::back_inserter(merged));
+            a.m_array.swap(merged);
+            a.m_count = a.m_array.size();
+        } else if (!b.is_bitmap()) {
+            to_bitmap(a);
+            for (std::uint16_t low : b.m_array) {
+                std::uint64_t bit = std::uint64_t(1) << (low & 63);
+                a.m_count += (a.m_bitmap[low >> 6] & bit) == 0;
+                a.m_bitmap[low >> 6] |= bit;
+            }
+            normalize(a);
+        } else {
+            to_bitmap(a);
+            combine_bitmaps(a, b, [](std::uint64_t x, std::uint64_t y) { return x | y; });
+        }
+    }
+
+    void
+    container_xor(t_mask_container& a, const t_mask_container& b) {
+        if (b.m_count == 0) {
+            return;
+        } else if (!a.is_bitmap() && !b.is_bitmap()) {
+            std::vector<std::uint16_t> merged;
+            merged.reserve(a.m_count + b.m_count);
+            std::set_symmetric_difference(a.m_array.begin(), a.m_array.end(),
+                b.m_array.begin(), b.m_array.end(), std::back_inserter(merged));
+            a.m_array.swap(merged);
+            a.m_count = a.m_array.size();
+            if (a.m_count > PSP_MASK_ARRAY_MAX) {
+                to_bitmap(a);
+            }
+        } else {
+            t_mask_container other = b;
+            to_bitmap(a);
+            to_bitmap(other);
+            combine_bitmaps(a, other, [](std::uint64_t x, std::uint64_t y) { return x ^ y; });
+        }
+    }
+
+    t_uindex
+    num_containers(t_uindex size) {
+        return (size + PSP_MASK_CHUNK_SIZE - 1) >> PSP_MASK_CHUNK_BITS;
+    }
+
+} // end anonymous namespace
+
+t_mask_container::t_mask_container()
+    : m_count(0) {}
+
+bool
+t_mask_container::is_bitmap() const {
+    return !m_bitmap.empty();
+}
+
+t_mask::t_mask()
+    : m_size(0) {
     LOG_CONSTRUCTOR("t_mask");
 }
 
-t_mask::t_mask(const t_simple_bitmask& m) {
-    m_bitmap = boost::dynamic_bitset<>(static_cast<size_t>(m.size()));
+t_mask::t_mask(t_uindex size)
+    : m_size(size)
+    , m_containers(num_containers(size)) {
+    LOG_CONSTRUCTOR("t_mask");
+}
 
+t_mask::t_mask(const t_simple_bitmask& m)
+    : m_size(m.size())
+    , m_containers(num_containers(m.size())) {
     for (t_uindex idx = 0, loop_end = m.size(); idx < loop_end; ++idx) {
-        set(idx, m.is_set(idx));
+        if (m.is_set(idx)) {
+            set(idx);
+        }
+    }
+    LOG_CONSTRUCTOR("t_mask");
+}
+
+t_mask::t_mask(const std::uint8_t* values, t_uindex size)
+    : m_size(size)
+    , m_containers(num_containers(size)) {
+    for (t_uindex cidx = 0, loop_end = m_containers.size(); cidx < loop_end; ++cidx) {
+        t_mask_container& c = m_containers[cidx];
+        const std::uint8_t* chunk = values + (cidx << PSP_MASK_CHUNK_BITS);
+        t_uindex chunk_size = std::min(PSP_MASK_CHUNK_SIZE, size - (cidx << PSP_MASK_CHUNK_BITS));
+
+        t_uindex count = kernel_count_nonzero(chunk, chunk_size);
+
+        c.m_count = count;
+        if (count == 0) {
+            continue;
+        } else if (count <= PSP_MASK_ARRAY_MAX) {
+            c.m_array.reserve(count);
+            for (t_uindex idx = 0; idx < chunk_size; ++idx) {
+                if (chunk[idx] != 0) {
+                    c.m_array.push_back(idx);
+                }
+            }
+        } else {
+            c.m_bitmap.assign(PSP_MASK_BITMAP_WORDS, 0);
+            for (t_uindex idx = 0; idx < chunk_size; ++idx) {
+                c.m_bitmap[idx >> 6] |= std::uint64_t(chunk[idx] != 0) << (idx & 63);
+            }
+        }
     }
+    LOG_CONSTRUCTOR("t_mask");
 }
 
 t_mask::~t_mask() { LOG_DESTRUCTOR("t_mask"); }
 
 void
 t_mask::clear() {
-    m_bitmap.clear();
+    m_size = 0;
+    m_containers.clear();
 }
 
 t_uindex
 t_mask::count() const {
-    return m_bitmap.count();
+    t_uindex rval = 0;
+    for (const auto& c : m_containers) {
+        rval += c.m_count;
+    }
+    return rval;
 }
 
 t_uindex
 t_mask::size() const {
-    return m_bitmap.size();
+    return m_size;
+}
+
+t_uindex
+t_mask::num_bitmap_chunks() const {
+    t_uindex rval = 0;
+    for (const auto& c : m_containers) {
+        rval += c.is_bitmap();
+    }
+    return rval;
+}
+
+t_uindex
+t_mask::nbytes() const {
+    t_uindex rval = m_containers.capacity() * sizeof(t_mask_container);
+    for (const auto& c : m_containers) {
+        rval += c.m_array.capacity() * sizeof(std::uint16_t)
+            + c.m_bitmap.capacity() * sizeof(std::uint64_t);
+    }
+    return rval;
 }
 
 bool
 t_mask::get(t_uindex idx) const {
-    return m_bitmap.test(t_msize(idx));
+    return container_test(
+        m_containers[idx >> PSP_MASK_CHUNK_BITS], idx & (PSP_MASK_CHUNK_SIZE - 1));
 }
 
 void
 t_mask::set(t_uindex idx, bool v) {
-    m_bitmap.set(t_msize(idx), v);
+    if (v) {
+        set(idx);
+        return;
+    }
+
+    t_mask_container& c = m_containers[idx >> PSP_MASK_CHUNK_BITS];
+    std::uint16_t low = idx & (PSP_MASK_CHUNK_SIZE - 1);
+
+    // Bitmaps are not converted back to arrays here, so that clearing bits
+    // one at a time does not convert a chunk back and forth.
+    if (c.is_bitmap()) {
+        std::uint64_t bit = std::uint64_t(1) << (low & 63);
+        c.m_count -= (c.m_bitmap[low >> 6] & bit) != 0;
+        c.m_bitmap[low >> 6] &= ~bit;
+    } else {
+        auto it = std::lower_bound(c.m_array.begin(), c.m_array.end(), low);
+        if (it != c.m_array.end() && *it == low) {
+            c.m_array.erase(it);
+            --c.m_count;
+        }
+    }
 }
 
 void
 t_mask::set(t_uindex idx) {
-    m_bitmap.set(t_msize(idx), true);
+    t_mask_container& c = m_containers[idx >> PSP_MASK_CHUNK_BITS];
+    std::uint16_t low = idx & (PSP_MASK_CHUNK_SIZE - 1);
+
+    if (c.is_bitmap()) {
+        std::uint64_t bit = std::uint64_t(1) << (low & 63);
+        c.m_count += (c.m_bitmap[low >> 6] & bit) == 0;
+        c.m_bitmap[low >> 6] |= bit;
+        return;
+    }
+
+    // Indices are usually set in increasing order, so check the end first.
+    auto it = c.m_array.empty() || c.m_array.back() < low
+        ? c.m_array.end()
+        : std::lower_bound(c.m_array.begin(), c.m_array.end(), low);
+    if (it != c.m_array.end() && *it == low) {
+        return;
+    }
+
+    c.m_array.insert(it, low);
+    if (++c.m_count > PSP_MASK_ARRAY_MAX) {
+        to_bitmap(c);
+    }
 }
 
 t_mask&
 t_mask::operator&=(const t_mask& b) {
-    m_bitmap &= b.m_bitmap;
+    PSP_VERBOSE_ASSERT(m_size == b.m_size, "Masks are of different sizes");
+    for (t_uindex cidx = 0, loop_end = m_containers.size(); cidx < loop_end; ++cidx) {
+        container_and(m_containers[cidx], b.m_containers[cidx]);
+    }
     return *this;
 }
 
 t_mask&
 t_mask::operator|=(const t_mask& b) {
-    m_bitmap |= b.m_bitmap;
+    PSP_VERBOSE_ASSERT(m_size == b.m_size, "Masks are of different sizes");
+    for (t_uindex cidx = 0, loop_end = m_containers.size(); cidx < loop_end; ++cidx) {
+        container_or(m_containers[cidx], b.m_containers[cidx]);
+    }
     return *this;
 }
 
 t_mask&
 t_mask::operator^=(const t_mask& b) {
-    m_bitmap ^= b.m_bitmap;
+    PSP_VERBOSE_ASSERT(m_size == b.m_size, "Masks are of different sizes");
+    for (t_uindex cidx = 0, loop_end = m_containers.size(); cidx < loop_end; ++cidx) {
+        container_xor(m_containers[cidx], b.m_containers[cidx]);
+    }
     return *this;
 }
 
 t_mask&
 t_mask::operator-=(const t_mask& b) {
-    m_bitmap -= b.m_bitmap;
+    PSP_VERBOSE_ASSERT(m_size == b.m_size, "Masks are of different sizes");
+    for (t_uindex cidx = 0, loop_end = m_containers.size(); cidx < loop_end; ++cidx) {
+        container_andnot(m_containers[cidx], b.m_containers[cidx]);
+    }
     return *this;
 }
 
 t_uindex
 t_mask::find_first() const {
-    return m_bitmap.find_first();
+    if (m_size == 0) {
+        return m_npos;
+    }
+    return get(0) ? 0 : find_next(0);
 }
 
 t_uindex
 t_mask::find_next(t_uindex pos) const {
-    return m_bitmap.find_next(t_msize(pos));
+    t_uindex next = pos + 1;
+    for (t_uindex cidx = next >> PSP_MASK_CHUNK_BITS, loop_end = m_containers.size();
+         cidx < loop_end; ++cidx) {
+        const t_mask_container& c = m_containers[cidx];
+        t_uindex chunk_begin = cidx << PSP_MASK_CHUNK_BITS;
+        if (c.m_count > 0) {
+            t_uindex low = container_find(c, next > chunk_begin ? next - chunk_begin : 0);
+            if (low < PSP_MASK_CHUNK_SIZE) {
+                return chunk_begin + low;
+            }
+        }
+    }
+    return m_npos;
 }
 
 void
@@ -9,6 +9,8 @@
 
 #include <perspective/first.h>
 #include <perspective/min_max.h>
+#include <perspective/kernels.h>
+#include <type_traits>
 
 namespace perspective {
 
@@ -19,6 +21,109 @@ t_minmax::t_minmax()
     m_max = mknone();
 }
 
+namespace {
+
+/**
+ * @brief The rows of a whole column, which without a status column are
+ * folded by the vectorized kernel.
+ */
+struct t_all_rows {
+    t_uindex
+    operator()(t_uindex idx) const {
+        return idx;
+    }
+};
+
+/**
+ * @brief Fold the valid values of `data` at `count` rows, where `row` maps
+ * the nth row to an index into `data`, into `min` and `max`. Returns false
+ * if no row is valid.
+ */
+template <typename T, typename ROW_T>
+bool
+fold_min_max(const T* data, const t_status* status, t_uindex count, ROW_T row, T& min, T& max) {
+    bool found = false;
+
+    for (t_uindex idx = 0; idx < count; ++idx) {
+        t_uindex ridx = row(idx);
+        if (status && status[ridx] != STATUS_VALID) {
+            continue;
+        }
+
+        T value = data[ridx];
+        if (!found) {
+            min = value;
+            max = value;
+            found = true;
+            continue;
+        }
+
+        min = value < min ? value : min;
+        max = value > max ? value : max;
+    }
+
+    return found;
+}
+
+template <typename T, typename SCALAR_T, typename ROW_T>
+t_minmax
+typed_min_max(const t_column& column, t_uindex count, ROW_T row) {
+    t_minmax rval;
+    const T* data = column.get_nth<T>(0);
+    const t_status* status = column.is_status_enabled() ? column.get_nth_status(0) : nullptr;
+
+    T min;
+    T max;
+    if (std::is_same<ROW_T, t_all_rows>::value && !status) {
+        kernel_min_max(data, count, min, max);
+        rval.m_min.set(SCALAR_T(min));
+        rval.m_max.set(SCALAR_T(max));
+    } else if (fold_min_max(data, status, count, row, min, max)) {
+        rval.m_min.set(SCALAR_T(min));
+        rval.m_max.set(SCALAR_T(max));
+    }
+
+    return rval;
+}
+
+template <typename ROW_T>
+t_minmax
+column_min_max(const t_column& column, t_uindex count, ROW_T row) {
+    if (count == 0) {
+        return t_minmax();
+    }
+
+    switch (column.get_dtype()) {
+        case DTYPE_INT64: return typed_min_max<std::int64_t, std::int64_t>(column, count, row);
+        case DTYPE_INT32: return typed_min_max<std::int32_t, std::int32_t>(column, count, row);
+        case DTYPE_INT16: return typed_min_max<std::int16_t, std::int16_t>(column, count, row);
+        case DTYPE_INT8: return typed_min_max<std::int8_t, std::int8_t>(column, count, row);
+        case DTYPE_UINT64: return typed_min_max<std::uint64_t, std::uint64_t>(column, count, row);
+        case DTYPE_UINT32: return typed_min_max<std::uint32_t, std::uint32_t>(column, count, row);
+        case DTYPE_UINT16: return typed_min_max<std::uint16_t, std::uint16_t>(column, count, row);
+        case DTYPE_UINT8: return typed_min_max<std::uint8_t, std::uint8_t>(column, count, row);
+        case DTYPE_FLOAT64: return typed_min_max<double, double>(column, count, row);
+        case DTYPE_FLOAT32: return typed_min_max<float, float>(column, count, row);
+        case DTYPE_BOOL: return typed_min_max<bool, bool>(column, count, row);
+        case DTYPE_DATE: return typed_min_max<t_date::t_rawtype, t_date>(column, count, row);
+        case DTYPE_TIME: return typed_min_max<t_time::t_rawtype, t_time>(column, count, row);
+        default: return t_minmax();
+    }
+}
+
+} // end anonymous namespace
+
+t_minmax
+get_column_min_max(const t_column& column) {
+    return column_min_max(column, column.size(), t_all_rows());
+}
+
+t_minmax
+get_column_min_max(const t_column& column, const std::vector<t_uindex>& indices) {
+    const t_uindex* rows = indices.data();
+    return column_min_max(column, indices.size(), [rows](t_uindex idx) { return rows[idx]; });
+}
+
 } // end namespace perspective
 
 namespace std {
@@ -49,6 +49,7 @@ t_mselem::t_mselem(const t_mselem& other) {
     m_deleted = other.m_deleted;
     m_updated = other.m_updated;
     m_order = other.m_order;
+    m_key = other.m_key;
 }
 
 t_mselem::t_mselem(t_mselem&& other) {
@@ -57,6 +58,7 @@ t_mselem::t_mselem(t_mselem&& other) {
     m_deleted = other.m_deleted;
     m_updated = other.m_updated;
     m_order = other.m_order;
+    m_key = std::move(other.m_key);
 }
 
 t_mselem&
@@ -66,6 +68,7 @@ t_mselem::operator=(const t_mselem& other) {
     m_deleted = other.m_deleted;
     m_order = other.m_order;
     m_updated = other.m_updated;
+    m_key = other.m_key;
     return *this;
 }
 
@@ -76,6 +79,7 @@ t_mselem::operator=(t_mselem&& other) {
     m_deleted = other.m_deleted;
     m_updated = other.m_updated;
     m_order = other.m_order;
+    m_key = std::move(other.m_key);
     return *this;
 }
 
@@ -218,6 +222,10 @@ t_multisorter::t_multisorter(
 
 bool
 t_multisorter::operator()(const t_mselem& a, const t_mselem& b) const {
+    if (!a.m_key.empty() && !b.m_key.empty()) {
+        return a.m_key < b.m_key;
+    }
+
     return cmp_mselem(a, b, m_sort_order);
 }
 
@@ -0,0 +1,410 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2017, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#include <perspective/first.h>
+#include <perspective/packed_column.h>
+
+namespace perspective {
+
+namespace {
+
+// Reads the value at `idx` sign- or zero-extended to 64 bits.
+std::int64_t
+read_value(const t_column& column, t_uindex idx) {
+    switch (column.get_dtype()) {
+        case DTYPE_INT64:
+        case DTYPE_TIME: {
+            return *(column.get_nth<std::int64_t>(idx));
+        }
+        case DTYPE_INT32: {
+            return *(column.get_nth<std::int32_t>(idx));
+        }
+        case DTYPE_INT16: {
+            return *(column.get_nth<std::int16_t>(idx));
+        }
+        case DTYPE_INT8: {
+            return *(column.get_nth<std::int8_t>(idx));
+        }
+        case DTYPE_UINT64: {
+            return static_cast<std::int64_t>(*(column.get_nth<std::uint64_t>(idx)));
+        }
+        case DTYPE_UINT32:
+        case DTYPE_DATE: {
+            return *(column.get_nth<std::uint32_t>(idx));
+        }
+        case DTYPE_UINT16: {
+            return *(column.get_nth<std::uint16_t>(idx));
+        }
+        case DTYPE_UINT8:
+        case DTYPE_BOOL: {
+            return *(column.get_nth<std::uint8_t>(idx));
+        }
+        default: { PSP_COMPLAIN_AND_ABORT("Cannot pack column of this dtype"); }
+    }
+
+    return 0;
+}
+
+template <typename DATA_T>
+void
+unpack_values(const t_packed_column& packed, t_lstore& data) {
+    DATA_T* out = data.get_nth<DATA_T>(0);
+    for (t_uindex idx = 0, loop_end = packed.size(); idx < loop_end; ++idx) {
+        out[idx] = static_cast<DATA_T>(packed.get(idx));
+    }
+}
+
+} // end anonymous namespace
+
+t_bitpacked::t_bitpacked()
+    : m_width(0)
+    , m_mask(0) {}
+
+void
+t_bitpacked::init(t_uindex size, std::uint8_t width) {
+    PSP_VERBOSE_ASSERT(width <= 64, "Invalid bit width");
+    m_width = width;
+    m_mask = width == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << width) - 1;
+    m_words.assign((size * width + 63) / 64, 0);
+}
+
+void
+t_bitpacked::set(t_uindex idx, std::uint64_t value) {
+    if (m_width == 0) {
+        return;
+    }
+
+    value &= m_mask;
+    t_uindex bitpos = idx * m_width;
+    t_uindex word = bitpos >> 6;
+    t_uindex shift = bitpos & 63;
+
+    m_words[word] = (m_words[word] & ~(m_mask << shift)) | (value << shift);
+
+    if (shift + m_width > 64) {
+        t_uindex spill = shift + m_width - 64;
+        std::uint64_t spill_mask = (std::uint64_t(1) << spill) - 1;
+        m_words[word + 1] = (m_words[word + 1] & ~spill_mask) | (value >> (64 - shift));
+    }
+}
+
+std::uint8_t
+t_bitpacked::get_width() const {
+    return m_width;
+}
+
+t_uindex
+t_bitpacked::nbytes() const {
+    return m_words.size() * sizeof(std::uint64_t);
+}
+
+std::uint8_t
+t_bitpacked::bit_width(std::uint64_t value) {
+    std::uint8_t rval = 0;
+    while (value) {
+        ++rval;
+        value >>= 1;
+    }
+    return rval;
+}
+
+t_packed_column::t_packed_column()
+    : m_dtype(DTYPE_NONE)
+    , m_packing(PACKING_FOR)
+    , m_size(0)
+    , m_signed(false)
+    , m_base(0) {}
+
+t_packed_column::t_packed_column(const t_column& column)
+    : m_dtype(column.get_dtype())
+    , m_packing(PACKING_FOR)
+    , m_size(column.size())
+    , m_signed(false)
+    , m_base(0) {
+    PSP_VERBOSE_ASSERT(is_packable(m_dtype), "Cannot pack column of this dtype");
+
+    switch (m_dtype) {
+        case DTYPE_INT64:
+        case DTYPE_INT32:
+        case DTYPE_INT16:
+        case DTYPE_INT8:
+        case DTYPE_TIME: {
+            m_signed = true;
+        } break;
+        default: break;
+    }
+
+    bool status_enabled = column.is_status_enabled();
+    std::vector<std::uint64_t> ordered(m_size);
+    std::vector<bool> valid(m_size);
+
+    // Statuses are stored relative to STATUS_VALID so a column without
+    // nulls needs no bits for them.
+    std::uint8_t max_status = 0;
+
+    std::uint64_t min = ~std::uint64_t(0);
+    std::uint64_t max = 0;
+    bool monotonic = true;
+    bool seen = false;
+    std::uint64_t last = 0;
+
+    for (t_uindex idx = 0; idx < m_size; ++idx) {
+        t_status status = status_enabled ? *(column.get_nth_status(idx)) : STATUS_VALID;
+        max_status = std::max<std::uint8_t>(max_status, status ^ STATUS_VALID);
+        valid[idx] = status == STATUS_VALID;
+
+        if (!valid[idx]) {
+            continue;
+        }
+
+        std::uint64_t value = to_ordered(read_value(column, idx));
+        ordered[idx] = value;
+        min = std::min(min, value);
+        max = std::max(max, value);
+
+        if (seen && value < last) {
+            monotonic = false;
+        }
+
+        seen = true;
+        last = value;
+    }
+
+    if (!seen) {
+        min = max = 0;
+    }
+
+    std::uint8_t for_width = t_bitpacked::bit_width(max - min);
+
+    // For a column that never decreases, each block's first valid value is
+    // its minimum, so the block only needs to cover its own spread.
+    t_uindex nblocks = (m_size + PACKED_BLOCK_SIZE - 1) / PACKED_BLOCK_SIZE;
+    std::vector<std::uint64_t> block_bases;
+    std::uint8_t delta_width = 0;
+
+    if (monotonic && seen) {
+        block_bases.resize(nblocks, 0);
+
+        for (t_uindex bidx = 0; bidx < nblocks; ++bidx) {
+            t_uindex begin = bidx * PACKED_BLOCK_SIZE;
+            t_uindex end = std::min(begin + PACKED_BLOCK_SIZE, m_size);
+            bool block_seen = false;
+
+            for (t_uindex idx = begin; idx < end; ++idx) {
+                if (!valid[idx]) {
+                    continue;
+                }
+
+                if (!block_seen) {
+                    block_bases[bidx] = ordered[idx];
+                    block_seen = true;
+                }
+
+                delta_width = std::max(
+                    delta_width, t_bitpacked::bit_width(ordered[idx] - block_bases[bidx]));
+            }
+        }
+
+        t_uindex for_bytes = (m_size * for_width + 63) / 64 * 8;
+        t_uindex delta_bytes = (m_size * delta_width + 63) / 64 * 8 + nblocks * 8;
+
+        if (delta_bytes < for_bytes) {
+            m_packing = PACKING_DELTA;
+        }
+    }
+
+    m_statuses.init(m_size, t_bitpacked::bit_width(max_status));
+
+    if (m_packing == PACKING_DELTA) {
+        m_block_bases.swap(block_bases);
+        m_values.init(m_size, delta_width);
+    } else {
+        m_base = min;
+        m_values.init(m_size, for_width);
+    }
+
+    for (t_uindex idx = 0; idx < m_size; ++idx) {
+        t_status status = status_enabled ? *(column.get_nth_status(idx)) : STATUS_VALID;
+        m_statuses.set(idx, status ^ STATUS_VALID);
+
+        if (!valid[idx]) {
+            continue;
+        }
+
+        if (m_packing == PACKING_DELTA) {
+            m_values.set(idx, ordered[idx] - m_block_bases[idx / PACKED_BLOCK_SIZE]);
+        } else {
+            m_values.set(idx, ordered[idx] - m_base);
+        }
+    }
+}
+
+bool
+t_packed_column::is_packable(t_dtype dtype) {
+    switch (dtype) {
+        case DTYPE_INT64:
+        case DTYPE_INT32:
+        case DTYPE_INT16:
+        case DTYPE_INT8:
+        case DTYPE_UINT64:
+        case DTYPE_UINT32:
+        case DTYPE_UINT16:
+        case DTYPE_UINT8:
+        case DTYPE_BOOL:
+        case DTYPE_TIME:
+        case DTYPE_DATE: {
+            return true;
+        }
+        default: { return false; }
+    }
+}
+
+t_dtype
+t_packed_column::get_dtype() const {
+    return m_dtype;
+}
+
+t_packing
+t_packed_column::get_packing() const {
+    return m_packing;
+}
+
+t_uindex
+t_packed_column::size() const {
+    return m_size;
+}
+
+t_uindex
+t_packed_column::nbytes() const {
+    return m_values.nbytes() + m_statuses.nbytes()
+        + m_block_bases.size() * sizeof(std::uint64_t);
+}
+
+t_status
+t_packed_column::get_status(t_uindex idx) const {
+    return static_cast<t_status>(m_statuses.get(idx) ^ STATUS_VALID);
+}
+
+t_tscalar
+t_packed_column::get_scalar(t_uindex idx) const {
+    std::int64_t value = get(idx);
+    t_tscalar rv;
+    rv.clear();
+
+    switch (m_dtype) {
+        case DTYPE_INT64: {
+            rv.set(value);
+        } break;
+        case DTYPE_INT32: {
+            rv.set(static_cast<std::int32_t>(value));
+        } break;
+        case DTYPE_INT16: {
+            rv.set(static_cast<std::int16_t>(value));
+        } break;
+        case DTYPE_INT8: {
+            rv.set(static_cast<std::int8_t>(value));
+        } break;
+        case DTYPE_UINT64: {
+            rv.set(static_cast<std::uint64_t>(value));
+        } break;
+        case DTYPE_UINT32: {
+            rv.set(static_cast<std::uint32_t>(value));
+        } break;
+        case DTYPE_UINT16: {
+            rv.set(static_cast<std::uint16_t>(value));
+        } break;
+        case DTYPE_UINT8: {
+            rv.set(static_cast<std::uint8_t>(value));
+        } break;
+        case DTYPE_BOOL: {
+            rv.set(value != 0);
+        } break;
+        case DTYPE_TIME: {
+            rv.set(t_time(value));
+        } break;
+        case DTYPE_DATE: {
+            rv.set(t_date(static_cast<t_date::t_rawtype>(value)));
+        } break;
+        default: { PSP_COMPLAIN_AND_ABORT("Unexpected type"); }
+    }
+
+    rv.m_status = get_status(idx);
+    return rv;
+}
+
+void
+t_packed_column::decode(t_uindex bidx, t_uindex eidx, std::int64_t* out) const {
+    PSP_VERBOSE_ASSERT(bidx <= eidx && eidx <= m_size, "Invalid decode range");
+
+    for (t_uindex idx = bidx; idx < eidx; ++idx) {
+        *out++ = get(idx);
+    }
+}
+
+void
+t_packed_column::gather(const t_uindex* bidx, const t_uindex* eidx, std::int64_t* out) const {
+    for (const t_uindex* iter = bidx; iter < eidx; ++iter) {
+        *out++ = get(*iter);
+    }
+}
+
+void
+t_packed_column::decode_status(t_uindex bidx, t_uindex eidx, t_status* out) const {
+    PSP_VERBOSE_ASSERT(bidx <= eidx && eidx <= m_size, "Invalid decode range");
+
+    for (t_uindex idx = bidx; idx < eidx; ++idx) {
+        *out++ = get_status(idx);
+    }
+}
+
+void
+t_packed_column::unpack(t_lstore& data, t_lstore* status) const {
+    t_uindex nbytes = m_size * get_dtype_size(m_dtype);
+    data.reserve(nbytes);
+    data.set_size(nbytes);
+
+    switch (m_dtype) {
+        case DTYPE_INT64:
+        case DTYPE_TIME: {
+            unpack_values<std::int64_t>(*this, data);
+        } break;
+        case DTYPE_INT32: {
+            unpack_values<std::int32_t>(*this, data);
+        } break;
+        case DTYPE_INT16: {
+            unpack_values<std::int16_t>(*this, data);
+        } break;
+        case DTYPE_INT8: {
+            unpack_values<std::int8_t>(*this, data);
+        } break;
+        case DTYPE_UINT64: {
+            unpack_values<std::uint64_t>(*this, data);
+        } break;
+        case DTYPE_UINT32:
+        case DTYPE_DATE: {
+            unpack_values<std::uint32_t>(*this, data);
+        } break;
+        case DTYPE_UINT16: {
+            unpack_values<std::uint16_t>(*this, data);
+        } break;
+        case DTYPE_UINT8:
+        case DTYPE_BOOL: {
+            unpack_values<std::uint8_t>(*this, data);
+        } break;
+        default: { PSP_COMPLAIN_AND_ABORT("Unexpected type"); }
+    }
+
+    if (status) {
+        status->reserve(m_size * sizeof(t_status));
+        status->set_size(m_size * sizeof(t_status));
+        decode_status(0, m_size, status->get_nth<t_status>(0));
+    }
+}
+
+} // end namespace perspective
@@ -9,25 +9,60 @@
 
 #include <perspective/first.h>
 #include <perspective/pivot.h>
+#include <perspective/computed.h>
+#include <map>
 #include <sstream>
 
 namespace perspective {
 
+namespace {
+
+// The computed functions a pivot may bucket its column by.
+t_computed_function_name
+get_bucket_function_name(const std::string& name) {
+    static const std::map<std::string, t_computed_function_name> functions{
+        {"bin10", BUCKET_10}, {"bin100", BUCKET_100}, {"bin1000", BUCKET_1000},
+        {"bin10th", BUCKET_0_1}, {"bin100th", BUCKET_0_0_1}, {"bin1000th", BUCKET_0_0_0_1},
+        {"second_bucket", SECOND_BUCKET}, {"minute_bucket", MINUTE_BUCKET},
+        {"hour_bucket", HOUR_BUCKET}, {"day_bucket", DAY_BUCKET},
+        {"week_bucket", WEEK_BUCKET}, {"month_bucket", MONTH_BUCKET},
+        {"year_bucket", YEAR_BUCKET}};
+    auto iter = functions.find(name);
+    return iter == functions.end() ? INVALID_COMPUTED_FUNCTION : iter->second;
+}
+
+} // end anonymous namespace
+
 t_pivot::t_pivot(const t_pivot_recipe& r) {
     m_colname = r.m_colname;
     m_name = r.m_name;
     m_mode = r.m_mode;
+    m_bucket = r.m_bucket;
 }
 
 t_pivot::t_pivot(const std::string& colname)
     : m_colname(colname)
     , m_name(colname)
-    , m_mode(PIVOT_MODE_NORMAL) {}
+    , m_mode(PIVOT_MODE_NORMAL)
+    , m_bucket(INVALID_COMPUTED_FUNCTION) {
+    // `function(column)` buckets `column` by `function`.
+    std::string::size_type open = colname.find('(');
+    if (open == std::string::npos || open == 0 || colname.back() != ')') {
+        return;
+    }
+
+    t_computed_function_name bucket = get_bucket_function_name(colname.substr(0, open));
+    if (bucket != INVALID_COMPUTED_FUNCTION && colname.size() > open + 2) {
+        m_bucket = bucket;
+        m_colname = colname.substr(open + 1, colname.size() - open - 2);
+    }
+}
 
 t_pivot::t_pivot(const std::string& colname, t_pivot_mode mode)
     : m_colname(colname)
     , m_name(colname)
-    , m_mode(mode) {}
+    , m_mode(mode)
+    , m_bucket(INVALID_COMPUTED_FUNCTION) {}
 
 const std::string&
 t_pivot::name() const {
@@ -44,12 +79,44 @@ t_pivot::mode() const {
     return m_mode;
 }
 
+bool
+t_pivot::is_bucketed() const {
+    return m_bucket != INVALID_COMPUTED_FUNCTION;
+}
+
+t_dtype
+t_pivot::get_dtype(t_dtype dtype) const {
+    if (!is_bucketed()) {
+        return dtype;
+    }
+
+    return t_computed_column::get_computation(m_bucket, {dtype}).m_return_type;
+}
+
+std::function<t_tscalar(t_tscalar)>
+t_pivot::get_bucket_function(t_dtype dtype) const {
+    if (!is_bucketed()) {
+        return std::function<t_tscalar(t_tscalar)>();
+    }
+
+    t_computation computation = t_computed_column::get_computation(m_bucket, {dtype});
+    if (computation.m_name == INVALID_COMPUTED_FUNCTION) {
+        std::stringstream ss;
+        ss << "Cannot pivot on `" << m_name << "` of a column of type `"
+           << get_dtype_descr(dtype) << "`";
+        PSP_COMPLAIN_AND_ABORT(ss.str());
+    }
+
+    return t_computed_column::get_computed_function_1(computation);
+}
+
 t_pivot_recipe
 t_pivot::get_recipe() const {
     t_pivot_recipe rv;
     rv.m_colname = m_colname;
     rv.m_name = m_name;
     rv.m_mode = m_mode;
+    rv.m_bucket = m_bucket;
     return rv;
 }
 
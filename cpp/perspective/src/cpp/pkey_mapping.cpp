@@ -0,0 +1,390 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2017, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#include <perspective/first.h>
+#include <perspective/pkey_mapping.h>
+#include <perspective/env_vars.h>
+#include <algorithm>
+#include <limits>
+
+namespace perspective {
+
+// Integer keys stay in the dense vector while they are within this many
+// slots of twice the number of keys.
+#define PSP_PKEY_MAPPING_DENSE_SLACK 1024
+
+t_pkey_mapping::t_pkey_mapping()
+    : m_dtype(DTYPE_NONE)
+    , m_mode(MODE_SCALAR)
+    , m_typed_size(0)
+    , m_bloom_limit(0)
+    , m_bloom_stale(0) {}
+
+void
+t_pkey_mapping::init(t_dtype dtype) {
+    m_dtype = dtype;
+
+    switch (dtype) {
+        case DTYPE_INT64:
+        case DTYPE_INT32:
+        case DTYPE_INT16:
+        case DTYPE_INT8:
+        case DTYPE_UINT64:
+        case DTYPE_UINT32:
+        case DTYPE_UINT16:
+        case DTYPE_UINT8: {
+            m_mode = MODE_DENSE;
+        } break;
+        case DTYPE_STR: {
+            m_mode = MODE_STR;
+        } break;
+        default: { m_mode = MODE_SCALAR; } break;
+    }
+
+    clear();
+}
+
+bool
+t_pkey_mapping::is_typed(const t_tscalar& pkey) const {
+    return m_mode != MODE_SCALAR && pkey.get_dtype() == m_dtype
+        && pkey.m_status == STATUS_VALID;
+}
+
+std::int64_t
+t_pkey_mapping::to_int_key(const t_tscalar& pkey) const {
+    switch (m_dtype) {
+        case DTYPE_INT64:
+            return pkey.get<std::int64_t>();
+        case DTYPE_INT32:
+            return pkey.get<std::int32_t>();
+        case DTYPE_INT16:
+            return pkey.get<std::int16_t>();
+        case DTYPE_INT8:
+            return pkey.get<std::int8_t>();
+        case DTYPE_UINT64:
+            return static_cast<std::int64_t>(pkey.get<std::uint64_t>());
+        case DTYPE_UINT32:
+            return pkey.get<std::uint32_t>();
+        case DTYPE_UINT16:
+            return pkey.get<std::uint16_t>();
+        case DTYPE_UINT8:
+            return pkey.get<std::uint8_t>();
+        default: { PSP_COMPLAIN_AND_ABORT("Unexpected pkey dtype"); }
+    }
+    return 0;
+}
+
+t_tscalar
+t_pkey_mapping::from_int_key(std::int64_t key) const {
+    t_tscalar rval;
+    switch (m_dtype) {
+        case DTYPE_INT64: {
+            rval.set(key);
+        } break;
+        case DTYPE_INT32: {
+            rval.set(static_cast<std::int32_t>(key));
+        } break;
+        case DTYPE_INT16: {
+            rval.set(static_cast<std::int16_t>(key));
+        } break;
+        case DTYPE_INT8: {
+            rval.set(static_cast<std::int8_t>(key));
+        } break;
+        case DTYPE_UINT64: {
+            rval.set(static_cast<std::uint64_t>(key));
+        } break;
+        case DTYPE_UINT32: {
+            rval.set(static_cast<std::uint32_t>(key));
+        } break;
+        case DTYPE_UINT16: {
+            rval.set(static_cast<std::uint16_t>(key));
+        } break;
+        case DTYPE_UINT8: {
+            rval.set(static_cast<std::uint8_t>(key));
+        } break;
+        default: { PSP_COMPLAIN_AND_ABORT("Unexpected pkey dtype"); }
+    }
+    return rval;
+}
+
+bool
+t_pkey_mapping::find(const t_tscalar& pkey, t_uindex& idx) const {
+    if (!is_typed(pkey)) {
+        auto iter = m_scalar.find(pkey);
+        if (iter == m_scalar.end())
+            return false;
+        idx = iter->second;
+        return true;
+    }
+
+    switch (m_mode) {
+        case MODE_DENSE: {
+            std::int64_t key = to_int_key(pkey);
+            if (key < 0 || static_cast<t_uindex>(key) >= m_dense.size()
+                || m_dense[key] == 0) {
+                return false;
+            }
+            idx = m_dense[key] - 1;
+            return true;
+        } break;
+        case MODE_INT: {
+            if (!m_bloom.empty() && !m_bloom.may_contain(bloom_hash(pkey)))
+                return false;
+            auto iter = m_int.find(to_int_key(pkey));
+            if (iter == m_int.end())
+                return false;
+            idx = iter->second;
+            return true;
+        } break;
+        case MODE_STR: {
+            if (!m_bloom.empty() && !m_bloom.may_contain(bloom_hash(pkey)))
+                return false;
+            auto iter = m_str.find(pkey.get_char_ptr());
+            if (iter == m_str.end())
+                return false;
+            idx = iter->second;
+            return true;
+        } break;
+        default: { PSP_COMPLAIN_AND_ABORT("Unexpected pkey mapping mode"); }
+    }
+    return false;
+}
+
+bool
+t_pkey_mapping::contains(const t_tscalar& pkey) const {
+    t_uindex idx;
+    return find(pkey, idx);
+}
+
+void
+t_pkey_mapping::insert_dense(std::int64_t key, t_uindex idx) {
+    t_uindex limit = 2 * (m_typed_size + 1) + PSP_PKEY_MAPPING_DENSE_SLACK;
+    if (key < 0 || static_cast<t_uindex>(key) >= limit) {
+        migrate_dense();
+        auto iter = m_int.find(key);
+        if (iter == m_int.end()) {
+            ++m_typed_size;
+        }
+        m_int[key] = idx;
+        return;
+    }
+
+    if (static_cast<t_uindex>(key) >= m_dense.size()) {
+        m_dense.resize(
+            std::min(limit, std::max(static_cast<t_uindex>(key) + 1, 2 * m_dense.size())),
+            0);
+    }
+
+    if (m_dense[key] == 0) {
+        ++m_typed_size;
+    }
+    m_dense[key] = idx + 1;
+}
+
+void
+t_pkey_mapping::migrate_dense() {
+    m_int.reserve(m_typed_size);
+    for (t_uindex key = 0, loop_end = m_dense.size(); key < loop_end; ++key) {
+        if (m_dense[key] != 0) {
+            m_int[static_cast<std::int64_t>(key)] = m_dense[key] - 1;
+        }
+    }
+    std::vector<t_uindex>().swap(m_dense);
+    m_mode = MODE_INT;
+}
+
+void
+t_pkey_mapping::insert(const t_tscalar& pkey, t_uindex idx) {
+    if (!is_typed(pkey)) {
+        m_scalar[pkey] = idx;
+        return;
+    }
+
+    switch (m_mode) {
+        case MODE_DENSE: {
+            insert_dense(to_int_key(pkey), idx);
+        } break;
+        case MODE_INT: {
+            std::int64_t key = to_int_key(pkey);
+            auto iter = m_int.find(key);
+            if (iter == m_int.end()) {
+                ++m_typed_size;
+                if (!m_bloom.empty()) {
+                    m_bloom.insert(bloom_hash(pkey));
+                }
+            }
+            m_int[key] = idx;
+        } break;
+        case MODE_STR: {
+            const char* key = pkey.get_char_ptr();
+            if (m_str.find(key) == m_str.end()) {
+                // Only the interned copy outlives `pkey`.
+                key = m_symtable.get_interned_cstr(key);
+                ++m_typed_size;
+                if (!m_bloom.empty()) {
+                    m_bloom.insert(bloom_hash(pkey));
+                }
+            }
+            m_str[key] = idx;
+        } break;
+        default: { PSP_COMPLAIN_AND_ABORT("Unexpected pkey mapping mode"); }
+    }
+
+    if (m_mode != MODE_DENSE && m_typed_size > m_bloom_limit) {
+        rebuild_bloom();
+    }
+}
+
+bool
+t_pkey_mapping::erase(const t_tscalar& pkey, t_uindex& idx) {
+    if (!is_typed(pkey)) {
+        auto iter = m_scalar.find(pkey);
+        if (iter == m_scalar.end())
+            return false;
+        idx = iter->second;
+        m_scalar.erase(iter);
+        return true;
+    }
+
+    switch (m_mode) {
+        case MODE_DENSE: {
+            std::int64_t key = to_int_key(pkey);
+            if (key < 0 || static_cast<t_uindex>(key) >= m_dense.size()
+                || m_dense[key] == 0) {
+                return false;
+            }
+            idx = m_dense[key] - 1;
+            m_dense[key] = 0;
+        } break;
+        case MODE_INT: {
+            auto iter = m_int.find(to_int_key(pkey));
+            if (iter == m_int.end())
+                return false;
+            idx = iter->second;
+            m_int.erase(iter);
+        } break;
+        case MODE_STR: {
+            auto iter = m_str.find(pkey.get_char_ptr());
+            if (iter == m_str.end())
+                return false;
+            idx = iter->second;
+            m_str.erase(iter);
+        } break;
+        default: { PSP_COMPLAIN_AND_ABORT("Unexpected pkey mapping mode"); }
+    }
+
+    --m_typed_size;
+    if (!m_bloom.empty() && ++m_bloom_stale > m_typed_size) {
+        rebuild_bloom();
+    }
+    return true;
+}
+
+std::uint64_t
+t_pkey_mapping::bloom_hash(const t_tscalar& pkey) const {
+    if (m_mode == MODE_STR) {
+        return t_cchar_umap_hash()(pkey.get_char_ptr());
+    }
+    return static_cast<std::uint64_t>(to_int_key(pkey));
+}
+
+void
+t_pkey_mapping::rebuild_bloom() {
+    m_bloom_stale = 0;
+    t_uindex min_size = t_env::pkey_bloom_filter_min_size();
+    if (min_size == 0 || m_mode == MODE_DENSE || m_mode == MODE_SCALAR
+        || m_typed_size < min_size) {
+        m_bloom.clear();
+        m_bloom_limit = min_size == 0 ? std::numeric_limits<t_uindex>::max() : min_size - 1;
+        return;
+    }
+
+    // Sized for twice the keys, so that it is rebuilt once per doubling.
+    m_bloom_limit = 2 * m_typed_size;
+    m_bloom.reset(m_bloom_limit);
+    if (m_mode == MODE_INT) {
+        for (const auto& kv : m_int) {
+            m_bloom.insert(static_cast<std::uint64_t>(kv.first));
+        }
+    } else {
+        for (const auto& kv : m_str) {
+            m_bloom.insert(t_cchar_umap_hash()(kv.first));
+        }
+    }
+}
+
+void
+t_pkey_mapping::clear() {
+    if (m_mode == MODE_INT) {
+        // Start over from the dense index, as after `init`.
+        m_mode = MODE_DENSE;
+    }
+
+    m_typed_size = 0;
+    std::vector<t_uindex>().swap(m_dense);
+    m_int.clear();
+    m_str.clear();
+    m_scalar.clear();
+    rebuild_bloom();
+}
+
+t_uindex
+t_pkey_mapping::size() const {
+    return m_typed_size + m_scalar.size();
+}
+
+t_uindex
+t_pkey_mapping::nbytes() const {
+    return m_dense.capacity() * sizeof(t_uindex) + hash_map_nbytes(m_int)
+        + hash_map_nbytes(m_str) + hash_map_nbytes(m_scalar) + m_symtable.nbytes()
+        + m_bloom.nbytes();
+}
+
+bool
+t_pkey_mapping::empty() const {
+    return size() == 0;
+}
+
+t_uindex
+t_pkey_mapping::compact(double min_dead_ratio) {
+    if (m_mode != MODE_STR)
+        return 0;
+
+    // Every key in `m_str` points to its own interned copy.
+    t_uindex ninterned = m_symtable.size();
+    t_uindex ndead = ninterned - m_str.size();
+
+    if (ndead == 0 || static_cast<double>(ndead) < min_dead_ratio * double(ninterned))
+        return 0;
+
+    t_symtable symtable;
+    t_str_mapping str;
+    str.reserve(m_str.size());
+
+    for (const auto& kv : m_str) {
+        str[symtable.get_interned_cstr(kv.first)] = kv.second;
+    }
+
+    m_str.swap(str);
+    m_symtable.swap(symtable);
+    return ndead;
+}
+
+t_dtype
+t_pkey_mapping::get_dtype() const {
+    if (m_typed_size > 0)
+        return m_dtype;
+
+    if (!m_scalar.empty())
+        return m_scalar.begin()->first.get_dtype();
+
+    return DTYPE_NONE;
+}
+
+} // end namespace perspective
@@ -18,12 +18,93 @@
 
 namespace perspective {
 
+namespace {
+    /**
+     * @brief Prefers the memory of NUMA node `node`, unless it is -1, on the
+     * calling thread while in scope, so that the storage an update grows on
+     * the thread processing it is allocated on the node of the pool's
+     * scheduler, like that grown by its workers.
+     */
+    struct t_numa_guard {
+        t_numa_guard(t_index node)
+            : m_node(node)
+            , m_prev(-1) {
+            if (m_node >= 0) {
+                m_prev = get_thread_numa_node();
+                set_thread_numa_node(m_node);
+            }
+        }
+
+        ~t_numa_guard() {
+            if (m_node >= 0) {
+                set_thread_numa_node(m_prev);
+            }
+        }
+
+        t_index m_node;
+        t_index m_prev;
+    };
+} // namespace
+
 t_updctx::t_updctx() {}
 
 t_updctx::t_updctx(t_uindex gnode_id, const std::string& ctx)
     : m_gnode_id(gnode_id)
     , m_ctx(ctx) {}
 
+t_gnode_slot::t_gnode_slot(t_gnode* gnode)
+    : m_gnode(gnode)
+    , m_cleared(false)
+    , m_senders(0)
+    , m_dirty(false) {}
+
+t_gnode*
+t_gnode_slot::begin_send() {
+    // Announced before `m_cleared` is read, so that `clear` either sees this
+    // send or this send sees `m_cleared`.
+    m_senders.fetch_add(1);
+    if (m_cleared.load()) {
+        return nullptr;
+    }
+
+    return m_gnode;
+}
+
+void
+t_gnode_slot::end_send() {
+    m_senders.fetch_sub(1);
+}
+
+void
+t_gnode_slot::clear() {
+    m_cleared.store(true);
+    while (m_senders.load() > 0) {
+        std::this_thread::yield();
+    }
+
+    m_gnode = nullptr;
+}
+
+std::unique_lock<std::recursive_mutex>
+t_gnode_slot::lock() {
+#ifdef PSP_ENABLE_PYTHON
+    // Update callbacks acquire the GIL while the slot is locked, so a thread
+    // that holds the GIL must not wait for the slot with it.
+    std::unique_lock<std::recursive_mutex> lock(m_mtx, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        if (PyGILState_Check()) {
+            py::gil_scoped_release release;
+            lock.lock();
+        } else {
+            lock.lock();
+        }
+    }
+    return lock;
+#else
+    return std::unique_lock<std::recursive_mutex>(m_mtx);
+#endif
+}
+
 #if defined PSP_ENABLE_WASM
 
 t_val
@@ -34,10 +115,17 @@ empty_callback() {
 }
 
 t_pool::t_pool()
-    : m_update_delegate(empty_callback()) 
-    , m_sleep(0) {
-        m_run.clear();
-    }
+    : m_num_slots(0)
+    , m_update_delegate(empty_callback())
+    , m_scheduler(t_scheduler::get_default())
+    , m_data_remaining(false)
+    , m_num_threads(0)
+    , m_notify_threads(0)
+    , m_coalesce_max_rows(0)
+    , m_coalesce_max_wait(0)
+    , m_pending_rows(0)
+    , m_pending_since(0)
+    , m_running(false) {}
 
 #elif defined PSP_ENABLE_PYTHON
 
@@ -47,42 +135,88 @@ empty_callback() {
 }
 
 t_pool::t_pool()
-    : m_update_delegate(empty_callback())
-    , m_sleep(0) {
-        m_run.clear();
-    }
+    : m_num_slots(0)
+    , m_update_delegate(empty_callback())
+    , m_scheduler(t_scheduler::get_default())
+    , m_data_remaining(false)
+    , m_num_threads(0)
+    , m_notify_threads(0)
+    , m_coalesce_max_rows(0)
+    , m_coalesce_max_wait(0)
+    , m_pending_rows(0)
+    , m_pending_since(0)
+    , m_running(false) {}
 
 #else
 
 t_pool::t_pool()
-    : m_sleep(0) {
-        m_run.clear();
-    }
+    : m_num_slots(0)
+    , m_scheduler(t_scheduler::get_default())
+    , m_data_remaining(false)
+    , m_num_threads(0)
+    , m_notify_threads(0)
+    , m_coalesce_max_rows(0)
+    , m_coalesce_max_wait(0)
+    , m_pending_rows(0)
+    , m_pending_since(0)
+    , m_running(false) {}
 
 #endif
 
-t_pool::~t_pool() {}
+t_pool::~t_pool() {
+    stop_loop();
+}
+
+static std::int64_t
+steady_now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
 
 void
 t_pool::init() {
     if (t_env::log_progress()) {
         std::cout << "t_pool.init " << std::endl;
     }
-    m_run.test_and_set(std::memory_order_acquire);
-    m_data_remaining.store(false);
-    std::thread t(&t_pool::_process, this);
-    set_thread_name(t, "psp_pool_thread");
-    t.detach();
+    std::lock_guard<std::mutex> lk(m_wake_mtx);
+    if (m_running.exchange(true)) {
+        return;
+    }
+
+    m_thread = std::thread(&t_pool::run_loop, this);
+    set_thread_name(m_thread, "psp_pool_thread");
 }
 
 t_uindex
 t_pool::register_gnode(t_gnode* node) {
     std::lock_guard<std::mutex> lg(m_mtx);
 
-    m_gnodes.push_back(node);
+    auto slot = std::make_shared<t_gnode_slot>(node);
+    m_gnodes.push_back(slot);
     t_uindex id = m_gnodes.size() - 1;
     node->set_id(id);
-    node->set_pool_cleanup([this, id]() { this->m_gnodes[id] = 0; });
+    node->set_scheduler(m_scheduler);
+    node->set_num_threads(m_num_threads.load());
+    node->set_notify_threads(m_notify_threads.load());
+
+    // The slot outlives the gnode, so clearing it under its own lock never
+    // races a task processing the gnode.
+    node->set_pool_cleanup([slot]() {
+        auto slg = slot->lock();
+        slot->clear();
+    });
+
+    // Published after the slot is written, for `find_slot`.
+    t_uindex segment = psp_log2_64(id + 1);
+    if (segment >= PSP_POOL_SLOT_SEGMENTS) {
+        PSP_COMPLAIN_AND_ABORT("Too many gnodes registered with the pool");
+    }
+    if (!m_slot_segments[segment]) {
+        m_slot_segments[segment].reset(new t_gnode_slot*[t_uindex(1) << segment]);
+    }
+    m_slot_segments[segment][id + 1 - (t_uindex(1) << segment)] = slot.get();
+    m_num_slots.store(id + 1, std::memory_order_release);
 
     if (t_env::log_progress()) {
         std::cout << "t_pool.register_gnode node => " << node << " rv => " << id << std::endl;
@@ -93,41 +227,96 @@ t_pool::register_gnode(t_gnode* node) {
 
 void
 t_pool::unregister_gnode(t_uindex idx) {
-    std::lock_guard<std::mutex> lgxo(m_mtx);
+    auto slot = get_slot(idx);
 
     if (t_env::log_progress()) {
         std::cout << "t_pool.unregister_gnode idx => " << idx << std::endl;
     }
 
-    m_gnodes[idx] = 0;
+    if (slot) {
+        auto slg = slot->lock();
+        slot->clear();
+    }
 }
 
 void
 t_pool::send(t_uindex gnode_id, t_uindex port_id, const t_data_table& table) {
-    {
-        std::lock_guard<std::mutex> lg(m_mtx);
-        m_data_remaining.store(true);
+    t_gnode_slot* slot = find_slot(gnode_id);
+    PSP_VERBOSE_ASSERT(slot, "Bad gnode encountered");
+    log_send(table);
+    t_gnode* gnode = slot->begin_send();
+    if (gnode) {
+        gnode->send(port_id, table);
+        slot->m_dirty.store(true);
+    }
+    slot->end_send();
 
-        if (m_gnodes[gnode_id]) {
-            m_gnodes[gnode_id]->send(port_id, table);
-        }
+    mark_sent(gnode_id, port_id, table.size());
+}
 
-        if (t_env::log_progress()) {
-            std::cout << "t_pool.send gnode_id => " << gnode_id << " port_id => " << port_id
-                      << " tbl_size => " << table.size() << std::endl;
-        }
+void
+t_pool::send(t_uindex gnode_id, t_uindex port_id, std::shared_ptr<t_data_table>&& table) {
+    t_gnode_slot* slot = find_slot(gnode_id);
+    PSP_VERBOSE_ASSERT(slot, "Bad gnode encountered");
+
+    // Once the port takes `table`, it may be processed and recycled on
+    // another thread.
+    t_uindex size = table->size();
+    log_send(*table);
+    t_gnode* gnode = slot->begin_send();
+    if (gnode) {
+        gnode->send(port_id, std::move(table));
+        slot->m_dirty.store(true);
+    }
+    slot->end_send();
+
+    mark_sent(gnode_id, port_id, size);
+}
+
+void
+t_pool::log_send(const t_data_table& table) const {
+    if (t_env::log_data_pool_send()) {
+        std::cout << "t_pool.send" << std::endl;
+        table.pprint();
+    }
+}
 
-        if (t_env::log_data_pool_send()) {
-            std::cout << "t_pool.send" << std::endl;
-            table.pprint();
+void
+t_pool::mark_sent(t_uindex gnode_id, t_uindex port_id, t_uindex size) {
+    // Marked after the gnode is dirty, so the task that clears
+    // `m_data_remaining` always sees this update.
+    t_uindex pending_rows;
+    bool was_remaining;
+    {
+        std::lock_guard<std::mutex> lk(m_pending_mtx);
+        pending_rows = m_pending_rows.fetch_add(size) + size;
+        was_remaining = m_data_remaining.exchange(true);
+        if (!was_remaining) {
+            m_pending_since.store(steady_now_us());
         }
     }
+
+    // Wake the processing thread when there is new work, or when this
+    // update ends the coalescing window early; otherwise it is already
+    // waiting out the window.
+    t_uindex max_rows = m_coalesce_max_rows.load();
+    if (m_running.load()
+        && (!was_remaining || (max_rows > 0 && pending_rows >= max_rows))) {
+        { std::lock_guard<std::mutex> lk(m_wake_mtx); }
+        m_wake_cv.notify_one();
+    }
+
+    if (t_env::log_progress()) {
+        std::cout << "t_pool.send gnode_id => " << gnode_id << " port_id => " << port_id
+                  << " tbl_size => " << size << std::endl;
+    }
 }
 
 void
 t_pool::_process_helper() {
     auto work_to_do = m_data_remaining.load();
     if (work_to_do) {
+        t_numa_guard guard(get_scheduler()->get_numa_node());
         t_update_task task(*this);
         task.run();
     }
@@ -135,14 +324,50 @@ t_pool::_process_helper() {
 
 void
 t_pool::_process() {
-    t_uindex sleep_time = m_sleep.load();
     _process_helper();
-    std::this_thread::sleep_for(std::chrono::milliseconds(sleep_time));
+}
+
+void
+t_pool::run_loop() {
+    std::unique_lock<std::mutex> lk(m_wake_mtx);
+    while (m_running.load()) {
+        m_wake_cv.wait(lk, [this]() {
+            return !m_running.load() || (m_data_remaining.load() && !has_update_delegate());
+        });
+
+        if (!m_running.load()) {
+            break;
+        }
+
+        // `send` wakes the thread again if the window ends early.
+        t_uindex delay = get_process_delay();
+        if (delay > 0) {
+            m_wake_cv.wait_for(lk, std::chrono::microseconds(delay));
+            continue;
+        }
+
+        lk.unlock();
+        _process_helper();
+        lk.lock();
+    }
+}
+
+void
+t_pool::stop_loop() {
+    {
+        std::lock_guard<std::mutex> lk(m_wake_mtx);
+        m_running.store(false);
+    }
+
+    m_wake_cv.notify_one();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
 }
 
 void
 t_pool::stop() {
-    m_run.clear(std::memory_order_release);
+    stop_loop();
     _process_helper();
 
     if (t_env::log_progress()) {
@@ -151,20 +376,134 @@ t_pool::stop() {
 }
 
 void
-t_pool::set_sleep(t_uindex ms) {
-    m_sleep.store(ms);
+t_pool::set_num_threads(t_uindex num_threads) {
+    m_num_threads.store(num_threads);
+
+    for (auto& slot : get_slots()) {
+        auto slg = slot->lock();
+        if (!slot->m_gnode)
+            continue;
+        slot->m_gnode->set_num_threads(num_threads);
+    }
+
+    if (t_env::log_progress()) {
+        std::cout << "t_pool.set_num_threads num_threads => " << num_threads << std::endl;
+    }
+}
+
+t_uindex
+t_pool::get_num_threads() const {
+    return m_num_threads.load();
+}
+
+void
+t_pool::set_notify_threads(t_uindex notify_threads) {
+    m_notify_threads.store(notify_threads);
+
+    for (auto& slot : get_slots()) {
+        auto slg = slot->lock();
+        if (!slot->m_gnode)
+            continue;
+        slot->m_gnode->set_notify_threads(notify_threads);
+    }
+
+    if (t_env::log_progress()) {
+        std::cout << "t_pool.set_notify_threads notify_threads => " << notify_threads
+                  << std::endl;
+    }
+}
+
+t_uindex
+t_pool::get_notify_threads() const {
+    return m_notify_threads.load();
+}
+
+void
+t_pool::set_scheduler(std::shared_ptr<t_scheduler> scheduler) {
+    PSP_VERBOSE_ASSERT(scheduler, "Pool scheduler must not be null");
+    {
+        std::lock_guard<std::mutex> lg(m_mtx);
+        m_scheduler = scheduler;
+    }
+
+    for (auto& slot : get_slots()) {
+        auto slg = slot->lock();
+        if (!slot->m_gnode)
+            continue;
+        slot->m_gnode->set_scheduler(scheduler);
+    }
+}
+
+std::shared_ptr<t_scheduler>
+t_pool::get_scheduler() const {
+    std::lock_guard<std::mutex> lg(m_mtx);
+    return m_scheduler;
+}
+
+void
+t_pool::set_coalesce_policy(t_uindex max_rows, t_uindex max_wait_us) {
+    m_coalesce_max_rows.store(max_rows);
+    m_coalesce_max_wait.store(max_wait_us);
+
     if (t_env::log_progress()) {
-        std::cout << "t_pool.set_sleep ms => " << ms << std::endl;
+        std::cout << "t_pool.set_coalesce_policy max_rows => " << max_rows
+                  << " max_wait_us => " << max_wait_us << std::endl;
     }
 }
 
+t_uindex
+t_pool::get_coalesce_max_rows() const {
+    return m_coalesce_max_rows.load();
+}
+
+t_uindex
+t_pool::get_coalesce_max_wait() const {
+    return m_coalesce_max_wait.load();
+}
+
+bool
+t_pool::is_coalescing() const {
+    return m_coalesce_max_wait.load() > 0;
+}
+
+t_uindex
+t_pool::get_pending_rows() const {
+    return m_pending_rows.load();
+}
+
+t_uindex
+t_pool::get_process_delay() const {
+    t_uindex max_wait = m_coalesce_max_wait.load();
+    if (max_wait == 0 || !m_data_remaining.load()) {
+        return 0;
+    }
+
+    t_uindex max_rows = m_coalesce_max_rows.load();
+    if (max_rows > 0 && m_pending_rows.load() >= max_rows) {
+        return 0;
+    }
+
+    std::int64_t elapsed = steady_now_us() - m_pending_since.load();
+    if (elapsed < 0 || static_cast<t_uindex>(elapsed) < max_wait) {
+        return max_wait - static_cast<t_uindex>(std::max<std::int64_t>(elapsed, 0));
+    }
+
+    return 0;
+}
+
+bool
+t_pool::should_process() const {
+    return get_process_delay() == 0;
+}
+
 std::vector<t_stree*>
 t_pool::get_trees() {
     std::vector<t_stree*> rval;
-    for (auto& g : m_gnodes) {
-        if (!g)
+    for (auto& slot : get_slots()) {
+        auto slg = slot->lock();
+        if (!slot->m_gnode)
             continue;
-        auto trees = g->get_trees();
+        auto trees = slot->m_gnode->get_trees();
         rval.insert(std::end(rval), std::begin(trees), std::end(trees));
     }
 
@@ -178,22 +517,28 @@ t_pool::get_trees() {
 
 #ifdef PSP_ENABLE_WASM
 void
-t_pool::register_context(
-    t_uindex gnode_id, const std::string& name, t_ctx_type type, std::int32_t ptr) {
-    std::lock_guard<std::mutex> lg(m_mtx);
-    if (!validate_gnode_id(gnode_id))
+t_pool::register_context(t_uindex gnode_id, const std::string& name, t_ctx_type type,
+    std::uintptr_t ptr, bool deferred) {
+    auto slot = get_slot(gnode_id);
+    if (!slot)
+        return;
+    auto slg = slot->lock();
+    if (!slot->m_gnode)
         return;
-    m_gnodes[gnode_id]->_register_context(name, type, ptr);
+    slot->m_gnode->_register_context(name, type, ptr, deferred);
 }
 
 #else
 void
-t_pool::register_context(
-    t_uindex gnode_id, const std::string& name, t_ctx_type type, std::int64_t ptr) {
-    std::lock_guard<std::mutex> lg(m_mtx);
-    if (!validate_gnode_id(gnode_id))
+t_pool::register_context(t_uindex gnode_id, const std::string& name, t_ctx_type type,
+    std::int64_t ptr, bool deferred) {
+    auto slot = get_slot(gnode_id);
+    if (!slot)
+        return;
+    auto slg = slot->lock();
+    if (!slot->m_gnode)
         return;
-    m_gnodes[gnode_id]->_register_context(name, type, ptr);
+    slot->m_gnode->_register_context(name, type, ptr, deferred);
 }
 #endif
 
@@ -204,29 +549,97 @@ t_pool::set_update_delegate(t_val ud) {
 }
 #endif
 
+bool
+t_pool::has_update_delegate() const {
+    #if defined PSP_ENABLE_WASM
+        return true;
+    #elif defined PSP_ENABLE_PYTHON
+        return !m_update_delegate.is_none();
+    #else
+        return false;
+    #endif
+}
+
 void
-t_pool::notify_userspace(t_uindex port_id) {
+t_pool::notify_userspace(t_uindex port_id, t_ctx_priority priority) {
     #if defined PSP_ENABLE_WASM
-        m_update_delegate.call<void>("_update_callback", port_id);
+        m_update_delegate.call<void>(
+            "_update_callback", port_id, static_cast<std::int32_t>(priority));
     #elif PSP_ENABLE_PYTHON
         if (!m_update_delegate.is_none()) {
-            m_update_delegate.attr("_update_callback")(port_id);
+            // `_process` releases the GIL, so it is reacquired to call back.
+            py::gil_scoped_acquire acquire;
+            m_update_delegate.attr("_update_callback")(
+                port_id, static_cast<std::int32_t>(priority));
         }
     #endif
 }
 
 void
 t_pool::unregister_context(t_uindex gnode_id, const std::string& name) {
-    std::lock_guard<std::mutex> lg(m_mtx);
-
     if (t_env::log_progress()) {
         std::cout << repr() << " << t_pool.unregister_context: "
                   << " gnode_id => " << gnode_id << " name => " << name << std::endl;
     }
 
-    if (!validate_gnode_id(gnode_id))
+    auto slot = get_slot(gnode_id);
+    if (!slot)
         return;
-    m_gnodes[gnode_id]->_unregister_context(name);
+    auto slg = slot->lock();
+    if (!slot->m_gnode)
+        return;
+    slot->m_gnode->_unregister_context(name);
+}
+
+bool
+t_pool::set_context_priority(
+    t_uindex gnode_id, const std::string& name, t_ctx_priority priority) {
+    if (t_env::log_progress()) {
+        std::cout << repr() << " << t_pool.set_context_priority: "
+                  << " gnode_id => " << gnode_id << " name => " << name
+                  << " priority => " << priority << std::endl;
+    }
+
+    auto slot = get_slot(gnode_id);
+    if (!slot)
+        return false;
+    auto slg = slot->lock();
+    if (!slot->m_gnode)
+        return false;
+    return slot->m_gnode->set_context_priority(name, priority);
+}
+
+void
+t_pool::freeze_context(t_uindex gnode_id, const std::string& name) {
+    auto slot = get_slot(gnode_id);
+    if (!slot)
+        return;
+    auto slg = slot->lock();
+    if (!slot->m_gnode)
+        return;
+    slot->m_gnode->freeze_context(name);
+}
+
+bool
+t_pool::thaw_context(t_uindex gnode_id, const std::string& name) {
+    auto slot = get_slot(gnode_id);
+    if (!slot)
+        return false;
+    auto slg = slot->lock();
+    if (!slot->m_gnode)
+        return false;
+    return slot->m_gnode->thaw_context(name);
+}
+
+bool
+t_pool::build_context(t_uindex gnode_id, const std::string& name, t_uindex max_rows) {
+    auto slot = get_slot(gnode_id);
+    if (!slot)
+        return true;
+    auto slg = slot->lock();
+    if (!slot->m_gnode)
+        return true;
+    return slot->m_gnode->build_context(name, max_rows);
 }
 
 bool
@@ -237,12 +650,15 @@ t_pool::get_data_remaining() const {
 
 std::vector<t_tscalar>
 t_pool::get_row_data_pkeys(t_uindex gnode_id, const std::vector<t_tscalar>& pkeys) {
-    std::lock_guard<std::mutex> lg(m_mtx);
+    auto slot = get_slot(gnode_id);
+    if (!slot)
+        return std::vector<t_tscalar>();
 
-    if (!validate_gnode_id(gnode_id))
+    auto slg = slot->lock();
+    if (!slot->m_gnode)
         return std::vector<t_tscalar>();
 
-    auto rv = m_gnodes[gnode_id]->get_row_data_pkeys(pkeys);
+    auto rv = slot->m_gnode->get_row_data_pkeys(pkeys);
 
     if (t_env::log_progress()) {
         std::cout << "t_pool.get_row_data_pkeys: "
@@ -255,15 +671,15 @@ t_pool::get_row_data_pkeys(t_uindex gnode_id, const std::vector<t_tscalar>& pkey
 
 std::vector<t_updctx>
 t_pool::get_contexts_last_updated() {
-    std::lock_guard<std::mutex> lg(m_mtx);
     std::vector<t_updctx> rval;
 
-    for (t_uindex idx = 0, loop_end = m_gnodes.size(); idx < loop_end; ++idx) {
-        if (!m_gnodes[idx])
+    for (auto& slot : get_slots()) {
+        auto slg = slot->lock();
+        if (!slot->m_gnode)
             continue;
 
-        auto updated_contexts = m_gnodes[idx]->get_contexts_last_updated();
-        auto gnode_id = m_gnodes[idx]->get_id();
+        auto updated_contexts = slot->m_gnode->get_contexts_last_updated();
+        auto gnode_id = slot->m_gnode->get_id();
 
         for (const auto& ctx_name : updated_contexts) {
             if (t_env::log_progress()) {
@@ -279,7 +695,30 @@ t_pool::get_contexts_last_updated() {
 
 bool
 t_pool::validate_gnode_id(t_uindex gnode_id) const {
-    return m_gnodes[gnode_id] && gnode_id < m_gnodes.size();
+    auto slot = get_slot(gnode_id);
+    return slot && slot->m_gnode;
+}
+
+std::shared_ptr<t_gnode_slot>
+t_pool::get_slot(t_uindex gnode_id) const {
+    std::lock_guard<std::mutex> lg(m_mtx);
+    if (gnode_id >= m_gnodes.size())
+        return nullptr;
+    return m_gnodes[gnode_id];
+}
+
+t_gnode_slot*
+t_pool::find_slot(t_uindex gnode_id) const {
+    if (gnode_id >= m_num_slots.load(std::memory_order_acquire))
+        return nullptr;
+    t_uindex segment = psp_log2_64(gnode_id + 1);
+    return m_slot_segments[segment][gnode_id + 1 - (t_uindex(1) << segment)];
+}
+
+std::vector<std::shared_ptr<t_gnode_slot>>
+t_pool::get_slots() const {
+    std::lock_guard<std::mutex> lg(m_mtx);
+    return m_gnodes;
 }
 
 std::string
@@ -293,11 +732,12 @@ void
 t_pool::pprint_registered() const {
     auto self = repr();
 
-    for (t_uindex idx = 0, loop_end = m_gnodes.size(); idx < loop_end; ++idx) {
-        if (!m_gnodes[idx])
+    for (auto& slot : get_slots()) {
+        auto slg = slot->lock();
+        if (!slot->m_gnode)
             continue;
-        auto gnode_id = m_gnodes[idx]->get_id();
-        auto ctxnames = m_gnodes[idx]->get_registered_contexts();
+        auto gnode_id = slot->m_gnode->get_id();
+        auto ctxnames = slot->m_gnode->get_registered_contexts();
 
         for (const auto& cname : ctxnames) {
             std::cout << self << " gnode_id => " << gnode_id << " ctxname => " << cname
@@ -318,24 +758,33 @@ t_pool::inc_epoch() {
 
 std::vector<t_uindex>
 t_pool::get_gnodes_last_updated() {
-    std::lock_guard<std::mutex> lg(m_mtx);
     std::vector<t_uindex> rv;
+    auto slots = get_slots();
 
-    for (t_uindex idx = 0, loop_end = m_gnodes.size(); idx < loop_end; ++idx) {
-        if (!m_gnodes[idx] || !m_gnodes[idx]->was_updated())
+    for (t_uindex idx = 0, loop_end = slots.size(); idx < loop_end; ++idx) {
+        auto slg = slots[idx]->lock();
+        t_gnode* gnode = slots[idx]->m_gnode;
+        if (!gnode || !gnode->was_updated())
             continue;
 
         rv.push_back(idx);
-        m_gnodes[idx]->clear_updated();
+        gnode->clear_updated();
     }
     return rv;
 }
 
 t_gnode*
 t_pool::get_gnode(t_uindex idx) {
-    std::lock_guard<std::mutex> lg(m_mtx);
-    PSP_VERBOSE_ASSERT(idx < m_gnodes.size() && m_gnodes[idx], "Bad gnode encountered");
-    return m_gnodes[idx];
+    auto slot = get_slot(idx);
+    PSP_VERBOSE_ASSERT(slot && slot->m_gnode, "Bad gnode encountered");
+    return slot->m_gnode;
+}
+
+std::unique_lock<std::recursive_mutex>
+t_pool::lock_gnode(t_uindex gnode_id) {
+    auto slot = get_slot(gnode_id);
+    PSP_VERBOSE_ASSERT(slot, "Bad gnode encountered");
+    return slot->lock();
 }
 
 } // end namespace perspective
@@ -9,6 +9,7 @@
 
 #include <perspective/first.h>
 #include <perspective/port.h>
+#include <perspective/tracing.h>
 
 namespace perspective {
 
@@ -16,17 +17,23 @@ t_port::t_port(t_port_mode mode, const t_schema& schema)
     : m_schema(schema)
     , m_init(false)
     , m_table(nullptr)
-    , m_prevsize(0) {
+    , m_prevsize(0)
+    , m_alloc_owner(ALLOC_OWNER_OTHER)
+    , m_pending(nullptr) {
     LOG_CONSTRUCTOR("t_port");
 }
 
-t_port::~t_port() { LOG_DESTRUCTOR("t_port"); }
+t_port::~t_port() {
+    LOG_DESTRUCTOR("t_port");
+    delete_batches(m_pending.exchange(nullptr));
+}
 
 void
 t_port::init() {
     m_table = nullptr;
     m_table = std::make_shared<t_data_table>(
         "", "", m_schema, DEFAULT_EMPTY_CAPACITY, BACKING_STORE_MEMORY);
+    m_table->set_alloc_owner(m_alloc_owner);
     m_table->init();
     m_init = true;
 }
@@ -40,16 +47,94 @@ void
 t_port::set_table(std::shared_ptr<t_data_table> table) {
     m_table = nullptr;
     m_table = table;
+    if (m_table) {
+        m_table->set_alloc_owner(m_alloc_owner);
+    }
+}
+
+void
+t_port::set_alloc_owner(t_alloc_owner owner) {
+    m_alloc_owner = owner;
+    if (m_table) {
+        m_table->set_alloc_owner(owner);
+    }
 }
 
 void
 t_port::send(std::shared_ptr<const t_data_table> table) {
-    m_table->append(*table.get());
+    send(*table.get());
 }
 
 void
 t_port::send(const t_data_table& table) {
-    m_table->append(table);
+    auto copy = std::make_shared<t_data_table>(
+        "", "", m_schema, DEFAULT_EMPTY_CAPACITY, BACKING_STORE_MEMORY);
+    copy->init();
+    copy->append(table);
+    send(std::move(copy));
+}
+
+void
+t_port::send(std::shared_ptr<t_data_table>&& table) {
+    t_port_batch* batch = new t_port_batch{std::move(table), t_tracer::now(), nullptr};
+    batch->m_next = m_pending.load(std::memory_order_relaxed);
+    while (!m_pending.compare_exchange_weak(
+        batch->m_next, batch, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+}
+
+std::int64_t
+t_port::swap_buffers() {
+    // Batches are pushed in front of each other, so are reversed into the
+    // order they were sent in.
+    t_port_batch* batch = m_pending.exchange(nullptr, std::memory_order_acquire);
+    t_port_batch* first = nullptr;
+    while (batch) {
+        t_port_batch* next = batch->m_next;
+        batch->m_next = first;
+        first = batch;
+        batch = next;
+    }
+
+    if (!first) {
+        return -1;
+    }
+
+    std::int64_t since = first->m_sent_at;
+    t_uindex nrows = 0;
+    t_uindex nbatches = 0;
+    for (batch = first; batch; batch = batch->m_next) {
+        nrows += batch->m_table->size();
+        ++nbatches;
+    }
+
+    for (batch = first; batch; batch = batch->m_next) {
+        // The port's table is empty unless it was not processed since the
+        // last swap.
+        if (m_table->size() == 0 && batch->m_table->get_schema() == m_schema) {
+            set_table(batch->m_table);
+        } else {
+            m_table->append(*batch->m_table);
+        }
+
+        // The batches after the first are appended to a table grown once
+        // for all of them.
+        if (batch == first && nbatches > 1) {
+            m_table->reserve(m_table->size() + nrows - batch->m_table->size() + 1);
+        }
+    }
+
+    delete_batches(first);
+    return since;
+}
+
+void
+t_port::delete_batches(t_port_batch* batch) {
+    while (batch) {
+        t_port_batch* next = batch->m_next;
+        delete batch;
+        batch = next;
+    }
 }
 
 t_schema
@@ -69,6 +154,7 @@ t_port::release()
     m_table = nullptr;
     m_table = std::make_shared<t_data_table>(
         "", "", m_schema, DEFAULT_EMPTY_CAPACITY, BACKING_STORE_MEMORY);
+    m_table->set_alloc_owner(m_alloc_owner);
     m_table->init();
 
     m_prevsize = size;
@@ -83,17 +169,42 @@ t_port::release_or_clear()
 
     t_uindex size = m_table->size();
 
-    if (static_cast<double>(size) < 0.4 * double(m_prevsize)) {
-        m_table->clear();
-    } else {
+    // Keep the table and its storage for the next update unless it has
+    // grown well past what the last two updates needed.
+    t_uindex high_water = std::max(size, m_prevsize);
+    t_uindex capacity = m_table->get_capacity();
+
+    if (capacity > DEFAULT_EMPTY_CAPACITY
+        && static_cast<double>(high_water) < 0.4 * double(capacity)) {
         release();
+    } else {
+        m_table->recycle();
     }
 
     m_prevsize = size;
 }
 
+std::shared_ptr<t_data_table>
+t_port::take_table(std::shared_ptr<t_data_table> spare) {
+    std::shared_ptr<t_data_table> table = m_table;
+    if (!table.get())
+        return table;
+
+    if (spare && spare->get_schema() == m_schema) {
+        spare->recycle();
+        set_table(spare);
+        m_prevsize = table->size();
+    } else {
+        release();
+    }
+
+    return table;
+}
+
 void
 t_port::clear() {
+    delete_batches(m_pending.exchange(nullptr, std::memory_order_acquire));
+
      if (!m_table.get())
         return;
     
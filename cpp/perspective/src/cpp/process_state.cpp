@@ -15,11 +15,11 @@ t_process_state::t_process_state() {};
 
 void
 t_process_state::clear_transitional_data_tables() {
-    m_delta_data_table->clear();
-    m_prev_data_table->clear();
-    m_current_data_table->clear();
-    m_transitions_data_table->clear();
-    m_existed_data_table->clear();
+    m_delta_data_table->recycle();
+    m_prev_data_table->recycle();
+    m_current_data_table->recycle();
+    m_transitions_data_table->recycle();
+    m_existed_data_table->recycle();
 };
 
 void
@@ -40,4 +40,24 @@ t_process_state::set_size_transitional_data_tables(t_uindex size) {
     m_existed_data_table->set_size(size);
 };
 
+void
+t_process_state::reserve_transitional_data_tables(
+    t_uindex size, const std::vector<std::string>& columns) {
+    m_delta_data_table->reserve(size, columns);
+    m_prev_data_table->reserve(size, columns);
+    m_current_data_table->reserve(size, columns);
+    m_transitions_data_table->reserve(size, columns);
+    m_existed_data_table->reserve(size);
+};
+
+void
+t_process_state::set_size_transitional_data_tables(
+    t_uindex size, const std::vector<std::string>& columns) {
+    m_delta_data_table->set_size(size, columns);
+    m_prev_data_table->set_size(size, columns);
+    m_current_data_table->set_size(size, columns);
+    m_transitions_data_table->set_size(size, columns);
+    m_existed_data_table->set_size(size);
+};
+
 } // end namespace persective
\ No newline at end of file
@@ -0,0 +1,248 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#include <perspective/first.h>
+#include <perspective/replication.h>
+#include <perspective/arrow_loader.h>
+#include <perspective/arrow_writer.h>
+#include <perspective/slice_column.h>
+#include <arrow/api.h>
+#include <arrow/io/memory.h>
+#include <arrow/ipc/reader.h>
+#include <arrow/ipc/writer.h>
+#include <arrow/util/key_value_metadata.h>
+#include <cstring>
+#include <numeric>
+#include <sstream>
+
+#define PSP_REPLICATION_CLEAR_PREFIX "psp_clear:"
+
+namespace perspective {
+
+namespace {
+
+    // Returns the value of `key` in `metadata`, aborting if it is missing.
+    std::string
+    get_metadata(const ::arrow::KeyValueMetadata& metadata, const std::string& key) {
+        int idx = metadata.FindKey(key);
+        if (idx < 0) {
+            PSP_COMPLAIN_AND_ABORT("Not a replication batch: missing `" + key + "`");
+        }
+        return metadata.value(idx);
+    }
+
+} // end anonymous namespace
+
+t_replication_publisher::t_replication_publisher(
+    const t_schema& schema, const std::string& index, std::uint32_t limit)
+    : m_schema(schema)
+    , m_index(index)
+    , m_limit(limit) {}
+
+void
+t_replication_publisher::publish(const t_data_table& flattened) {
+    std::shared_ptr<std::string> batch = encode(flattened, REPLICATION_UPDATE);
+    std::lock_guard<std::mutex> lock(m_mtx);
+    m_pending.push_back(batch);
+}
+
+void
+t_replication_publisher::publish_clear() {
+    t_data_table empty(m_schema);
+    empty.init();
+    std::shared_ptr<std::string> batch = encode(empty, REPLICATION_CLEAR);
+    std::lock_guard<std::mutex> lock(m_mtx);
+    m_pending.push_back(batch);
+}
+
+std::vector<std::shared_ptr<std::string>>
+t_replication_publisher::take() {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    std::vector<std::shared_ptr<std::string>> rval;
+    rval.swap(m_pending);
+    return rval;
+}
+
+std::shared_ptr<std::string>
+t_replication_publisher::encode(const t_data_table& tbl, t_replication_kind kind) const {
+    t_uindex nrows = tbl.size();
+    std::vector<t_index> rows(nrows);
+    std::iota(rows.begin(), rows.end(), 0);
+
+    std::vector<std::shared_ptr<::arrow::Field>> fields;
+    std::vector<std::shared_ptr<::arrow::Array>> arrays;
+    std::stringstream dtypes;
+    for (t_uindex cidx = 0, loop_end = m_schema.size(); cidx < loop_end; ++cidx) {
+        const std::string& name = m_schema.m_columns[cidx];
+        t_dtype dtype = m_schema.m_types[cidx];
+        if (!t_slice_column::is_supported(dtype)) {
+            PSP_COMPLAIN_AND_ABORT(
+                "Cannot replicate column `" + name + "` of type " + get_dtype_descr(dtype));
+        }
+
+        std::shared_ptr<const t_column> col = tbl.get_const_column(name);
+        arrays.push_back(arrow::slice_column_to_array(t_slice_column(col, rows)));
+        fields.push_back(::arrow::field(name, arrays.back()->type()));
+        dtypes << (cidx == 0 ? "" : ",") << static_cast<std::int32_t>(dtype);
+
+        if (!col->is_status_enabled()) {
+            continue;
+        }
+
+        std::vector<std::uint8_t> cleared(nrows);
+        bool has_cleared = false;
+        for (t_uindex ridx = 0; ridx < nrows; ++ridx) {
+            cleared[ridx] = col->is_cleared(ridx);
+            has_cleared = has_cleared || cleared[ridx];
+        }
+
+        if (has_cleared) {
+            ::arrow::BooleanBuilder builder;
+            PSP_CHECK_ARROW_STATUS(builder.AppendValues(cleared.data(), nrows));
+            std::shared_ptr<::arrow::Array> array;
+            PSP_CHECK_ARROW_STATUS(builder.Finish(&array));
+            arrays.push_back(array);
+            fields.push_back(
+                ::arrow::field(PSP_REPLICATION_CLEAR_PREFIX + name, ::arrow::boolean()));
+        }
+    }
+
+    auto metadata = std::make_shared<::arrow::KeyValueMetadata>(
+        std::vector<std::string>{"perspective.replication", "perspective.index",
+            "perspective.limit", "perspective.dtypes"},
+        std::vector<std::string>{kind == REPLICATION_CLEAR ? "clear" : "update", m_index,
+            std::to_string(m_limit), dtypes.str()});
+    auto schema = ::arrow::schema(fields, metadata);
+    auto batch = ::arrow::RecordBatch::Make(schema, nrows, arrays);
+
+    std::shared_ptr<::arrow::ResizableBuffer> buffer;
+    PSP_CHECK_ARROW_STATUS(::arrow::AllocateResizableBuffer(0, &buffer));
+    ::arrow::io::BufferOutputStream sink(buffer);
+    auto res = ::arrow::ipc::RecordBatchStreamWriter::Open(
+        &sink, schema, ::arrow::ipc::IpcOptions::Defaults());
+    PSP_CHECK_ARROW_STATUS(res.status());
+    std::shared_ptr<::arrow::ipc::RecordBatchWriter> writer = *res;
+    PSP_CHECK_ARROW_STATUS(writer->WriteRecordBatch(*batch));
+    PSP_CHECK_ARROW_STATUS(writer->Close());
+    PSP_CHECK_ARROW_STATUS(sink.Close());
+    return std::make_shared<std::string>(buffer->ToString());
+}
+
+t_replication_batch::t_replication_batch(const std::string& bytes)
+    : m_bytes(std::make_shared<std::string>(bytes)) {
+    auto buffer = std::make_shared<::arrow::Buffer>(
+        reinterpret_cast<const std::uint8_t*>(m_bytes->data()), m_bytes->size());
+    ::arrow::io::BufferReader buffer_reader(buffer);
+    std::shared_ptr<::arrow::ipc::RecordBatchReader> reader;
+    PSP_CHECK_ARROW_STATUS(::arrow::ipc::RecordBatchStreamReader::Open(&buffer_reader, &reader));
+    PSP_CHECK_ARROW_STATUS(reader->ReadNext(&m_batch));
+    if (m_batch == nullptr) {
+        PSP_COMPLAIN_AND_ABORT("Not a replication batch: no record batch");
+    }
+
+    std::shared_ptr<const ::arrow::KeyValueMetadata> metadata = m_batch->schema()->metadata();
+    if (metadata == nullptr) {
+        PSP_COMPLAIN_AND_ABORT("Not a replication batch: no metadata");
+    }
+
+    std::string kind = get_metadata(*metadata, "perspective.replication");
+    if (kind == "update") {
+        m_kind = REPLICATION_UPDATE;
+    } else if (kind == "clear") {
+        m_kind = REPLICATION_CLEAR;
+    } else {
+        PSP_COMPLAIN_AND_ABORT("Unknown replication batch `" + kind + "`");
+    }
+    m_index = get_metadata(*metadata, "perspective.index");
+    m_limit = std::stoul(get_metadata(*metadata, "perspective.limit"));
+
+    // The columns of the input schema, in order, each followed by its
+    // cleared cells if it has any.
+    std::stringstream dtypes(get_metadata(*metadata, "perspective.dtypes"));
+    std::string dtype;
+    for (t_uindex cidx = 0, loop_end = m_batch->num_columns(); cidx < loop_end; ++cidx) {
+        const std::string& name = m_batch->schema()->field(cidx)->name();
+        if (name.compare(0, std::strlen(PSP_REPLICATION_CLEAR_PREFIX),
+                PSP_REPLICATION_CLEAR_PREFIX) == 0) {
+            continue;
+        }
+        if (!std::getline(dtypes, dtype, ',')) {
+            PSP_COMPLAIN_AND_ABORT("Not a replication batch: no dtype for `" + name + "`");
+        }
+        m_schema.add_column(name, static_cast<t_dtype>(std::stoi(dtype)));
+    }
+}
+
+t_replication_kind
+t_replication_batch::get_kind() const {
+    return m_kind;
+}
+
+const std::string&
+t_replication_batch::get_index() const {
+    return m_index;
+}
+
+std::uint32_t
+t_replication_batch::get_limit() const {
+    return m_limit;
+}
+
+const t_schema&
+t_replication_batch::get_schema() const {
+    return m_schema;
+}
+
+t_uindex
+t_replication_batch::size() const {
+    return m_batch->num_rows();
+}
+
+std::shared_ptr<t_data_table>
+t_replication_batch::make_table(const t_schema& schema) const {
+    if (!(schema == m_schema)) {
+        PSP_COMPLAIN_AND_ABORT(
+            "Cannot apply a replication batch of a table with a different schema");
+    }
+
+    t_uindex nrows = size();
+    auto tbl = std::make_shared<t_data_table>(schema);
+    tbl->init();
+    tbl->extend(nrows);
+
+    for (const std::string& name : schema.m_columns) {
+        std::shared_ptr<t_column> col = tbl->get_column(name);
+        std::shared_ptr<::arrow::Array> array = m_batch->GetColumnByName(name);
+        arrow::copy_array(col, array, 0, nrows);
+        if (!col->is_status_enabled()) {
+            continue;
+        }
+
+        if (array->null_count() == 0) {
+            col->valid_raw_fill();
+        } else {
+            col->set_valid_bitmap(array->null_bitmap_data(), array->offset(), 0, nrows);
+        }
+
+        std::shared_ptr<::arrow::Array> cleared
+            = m_batch->GetColumnByName(PSP_REPLICATION_CLEAR_PREFIX + name);
+        if (cleared != nullptr) {
+            auto flags = std::static_pointer_cast<::arrow::BooleanArray>(cleared);
+            for (t_uindex ridx = 0; ridx < nrows; ++ridx) {
+                if (flags->Value(ridx)) {
+                    col->unset(ridx);
+                }
+            }
+        }
+    }
+
+    return tbl;
+}
+
+} // end namespace perspective
@@ -0,0 +1,91 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2017, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#include <perspective/first.h>
+#include <perspective/rolling_window.h>
+#include <cmath>
+#include <limits>
+
+// The number of buckets a window is divided into, which bounds both the
+// memory of each node's window and the granularity of its expiry.
+#define PSP_ROLLING_BUCKETS 60
+
+namespace perspective {
+
+t_rolling_window::t_rolling_window() {}
+
+std::int64_t
+t_rolling_window::get_bucket(double t, double window) {
+    return static_cast<std::int64_t>(std::floor(t * PSP_ROLLING_BUCKETS / window));
+}
+
+t_uindex
+t_rolling_window::get_num_buckets() {
+    return PSP_ROLLING_BUCKETS;
+}
+
+void
+t_rolling_window::insert(std::int64_t bucket, double nr, double dr) {
+    if (m_buckets.empty()) {
+        m_buckets.assign(
+            PSP_ROLLING_BUCKETS, t_bucket{std::numeric_limits<std::int64_t>::min(), 0, 0});
+    }
+
+    t_bucket& b = m_buckets[static_cast<t_uindex>(bucket % PSP_ROLLING_BUCKETS
+        + PSP_ROLLING_BUCKETS) % PSP_ROLLING_BUCKETS];
+    if (b.m_bucket > bucket) {
+        // Older than the window of a later row.
+        return;
+    }
+
+    if (b.m_bucket < bucket) {
+        b = t_bucket{bucket, 0, 0};
+    }
+
+    b.m_nr += nr;
+    b.m_dr += dr;
+}
+
+void
+t_rolling_window::remove(std::int64_t bucket, double nr, double dr) {
+    if (m_buckets.empty()) {
+        return;
+    }
+
+    t_bucket& b = m_buckets[static_cast<t_uindex>(bucket % PSP_ROLLING_BUCKETS
+        + PSP_ROLLING_BUCKETS) % PSP_ROLLING_BUCKETS];
+    if (b.m_bucket != bucket) {
+        // Already expired along with its bucket.
+        return;
+    }
+
+    b.m_nr -= nr;
+    b.m_dr -= dr;
+}
+
+std::pair<double, double>
+t_rolling_window::get(std::int64_t now) const {
+    double nr = 0;
+    double dr = 0;
+    for (const t_bucket& b : m_buckets) {
+        if (b.m_bucket <= now && b.m_bucket > now - PSP_ROLLING_BUCKETS) {
+            nr += b.m_nr;
+            dr += b.m_dr;
+        }
+    }
+
+    return std::make_pair(nr, dr);
+}
+
+t_uindex
+t_rolling_window::nbytes() const {
+    return m_buckets.capacity() * sizeof(t_bucket);
+}
+
+} // end namespace perspective
@@ -0,0 +1,72 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#include <perspective/first.h>
+#include <perspective/row_paths.h>
+#include <algorithm>
+
+namespace perspective {
+
+t_row_paths::t_row_paths() {}
+
+void
+t_row_paths::push_back(const std::vector<t_tscalar>& path) {
+    t_uindex depth = path.size();
+    t_uindex shared = 0;
+    t_uindex max_shared = std::min(depth, t_uindex(m_last.size()));
+    while (shared < max_shared && m_values[m_last[shared]] == path[depth - 1 - shared]) {
+        ++shared;
+    }
+
+    m_last.resize(shared);
+    for (t_uindex level = shared; level < depth; ++level) {
+        const t_tscalar& value = path[depth - 1 - level];
+        auto iter = m_value_ids.find(value);
+        std::int32_t id;
+        if (iter == m_value_ids.end()) {
+            id = static_cast<std::int32_t>(m_values.size());
+            m_values.push_back(value);
+            m_value_ids[value] = id;
+        } else {
+            id = iter->second;
+        }
+        m_ids.push_back(id);
+        m_last.push_back(id);
+    }
+
+    m_depths.push_back(depth);
+    m_shared.push_back(shared);
+}
+
+t_uindex
+t_row_paths::size() const {
+    return m_depths.size();
+}
+
+const std::vector<t_tscalar>&
+t_row_paths::get_values() const {
+    return m_values;
+}
+
+const std::vector<t_uindex>&
+t_row_paths::get_depths() const {
+    return m_depths;
+}
+
+const std::vector<t_uindex>&
+t_row_paths::get_shared() const {
+    return m_shared;
+}
+
+const std::vector<std::int32_t>&
+t_row_paths::get_ids() const {
+    return m_ids;
+}
+
+} // end namespace perspective
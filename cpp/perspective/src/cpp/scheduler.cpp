@@ -0,0 +1,279 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2020, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#include <perspective/first.h>
+#include <perspective/scheduler.h>
+#include <perspective/compat.h>
+#include <perspective/env_vars.h>
+#include <iostream>
+
+#ifdef PSP_PARALLEL_FOR
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+#include <tbb/task_scheduler_observer.h>
+#endif
+
+namespace perspective {
+
+namespace {
+    // The scheduler running the task on this thread, if any.
+    thread_local t_scheduler* CURRENT_SCHEDULER = nullptr;
+
+    struct t_current_guard {
+        t_current_guard(t_scheduler* scheduler)
+            : m_prev(CURRENT_SCHEDULER) {
+            CURRENT_SCHEDULER = scheduler;
+        }
+
+        ~t_current_guard() { CURRENT_SCHEDULER = m_prev; }
+
+        t_scheduler* m_prev;
+    };
+} // namespace
+
+#ifdef PSP_PARALLEL_FOR
+
+namespace {
+    /**
+     * @brief Pins the worker threads that enter an arena to a set of CPUs,
+     * and restores their previous affinity when they leave it, since TBB
+     * shares its workers between arenas.
+     */
+    class t_affinity_observer : public tbb::task_scheduler_observer {
+    public:
+        t_affinity_observer(
+            tbb::task_arena& arena, const std::vector<t_uindex>& cpus, t_index numa_node)
+            : tbb::task_scheduler_observer(arena)
+            , m_cpus(cpus)
+            , m_numa_node(numa_node) {
+            observe(true);
+        }
+
+        ~t_affinity_observer() { observe(false); }
+
+        void
+        on_scheduler_entry(bool is_worker) override {
+            if (is_worker) {
+                prev_affinity() = get_thread_affinity();
+                set_thread_affinity(m_cpus);
+                if (m_numa_node >= 0) {
+                    prev_numa_node() = get_thread_numa_node();
+                    set_thread_numa_node(m_numa_node);
+                }
+            }
+        }
+
+        void
+        on_scheduler_exit(bool is_worker) override {
+            if (is_worker) {
+                set_thread_affinity(prev_affinity());
+                if (m_numa_node >= 0) {
+                    set_thread_numa_node(prev_numa_node());
+                }
+            }
+        }
+
+    private:
+        static std::vector<t_uindex>&
+        prev_affinity() {
+            static thread_local std::vector<t_uindex> cpus;
+            return cpus;
+        }
+
+        static t_index&
+        prev_numa_node() {
+            static thread_local t_index node = -1;
+            return node;
+        }
+
+        std::vector<t_uindex> m_cpus;
+        t_index m_numa_node;
+    };
+} // namespace
+
+struct t_scheduler::t_arena {
+    t_arena(t_uindex num_threads, const std::vector<t_uindex>& cpus, t_index numa_node)
+        : m_arena(num_threads == 0 ? static_cast<int>(tbb::task_arena::automatic)
+                                   : static_cast<int>(num_threads)) {
+        if (!cpus.empty() || numa_node >= 0) {
+            m_observer.reset(new t_affinity_observer(m_arena, cpus, numa_node));
+        }
+    }
+
+    // Declared after the arena, so that it stops observing first.
+    tbb::task_arena m_arena;
+    std::unique_ptr<t_affinity_observer> m_observer;
+};
+
+#endif
+
+t_scheduler::t_scheduler()
+    : m_num_threads(0)
+    , m_numa_node(-1) {}
+
+t_scheduler::~t_scheduler() {}
+
+std::shared_ptr<t_scheduler>
+t_scheduler::get_default() {
+    static std::shared_ptr<t_scheduler> scheduler = std::make_shared<t_scheduler>();
+    return scheduler;
+}
+
+t_scheduler&
+t_scheduler::current() {
+    if (CURRENT_SCHEDULER) {
+        return *CURRENT_SCHEDULER;
+    }
+
+    static std::shared_ptr<t_scheduler> scheduler = get_default();
+    return *scheduler;
+}
+
+void
+t_scheduler::set_num_threads(t_uindex num_threads) {
+    std::lock_guard<std::mutex> lg(m_mtx);
+    m_num_threads = num_threads;
+#ifdef PSP_PARALLEL_FOR
+    m_arena.reset();
+#endif
+
+    if (t_env::log_progress()) {
+        std::cout << "t_scheduler.set_num_threads num_threads => " << num_threads
+                  << std::endl;
+    }
+}
+
+t_uindex
+t_scheduler::get_num_threads() const {
+    std::lock_guard<std::mutex> lg(m_mtx);
+    return m_num_threads;
+}
+
+void
+t_scheduler::set_affinity(const std::vector<t_uindex>& cpus) {
+    std::lock_guard<std::mutex> lg(m_mtx);
+    m_affinity = cpus;
+#ifdef PSP_PARALLEL_FOR
+    m_arena.reset();
+#endif
+}
+
+std::vector<t_uindex>
+t_scheduler::get_affinity() const {
+    std::lock_guard<std::mutex> lg(m_mtx);
+    return m_affinity;
+}
+
+void
+t_scheduler::set_numa_node(t_index node) {
+    std::lock_guard<std::mutex> lg(m_mtx);
+    m_numa_node = node;
+#ifdef PSP_PARALLEL_FOR
+    m_arena.reset();
+#endif
+
+    if (t_env::log_progress()) {
+        std::cout << "t_scheduler.set_numa_node node => " << node << std::endl;
+    }
+}
+
+t_index
+t_scheduler::get_numa_node() const {
+    std::lock_guard<std::mutex> lg(m_mtx);
+    return m_numa_node;
+}
+
+bool
+t_scheduler::is_inline() const {
+#ifdef PSP_PARALLEL_FOR
+    std::lock_guard<std::mutex> lg(m_mtx);
+    return m_num_threads == 1;
+#else
+    return true;
+#endif
+}
+
+t_uindex
+t_scheduler::max_concurrency() const {
+#ifdef PSP_PARALLEL_FOR
+    if (!is_inline()) {
+        auto arena = get_arena();
+        return static_cast<t_uindex>(arena->m_arena.max_concurrency());
+    }
+#endif
+    return 1;
+}
+
+void
+t_scheduler::parallel_for(t_uindex num_tasks, const std::function<void(t_uindex)>& task,
+    t_uindex max_concurrency) {
+    t_current_guard guard(this);
+
+#ifdef PSP_PARALLEL_FOR
+    if (num_tasks > 1 && max_concurrency != 1 && !is_inline()) {
+        // Bound the concurrency of this loop by splitting its tasks into at
+        // most `max_concurrency` contiguous chunks.
+        t_uindex num_chunks = num_tasks;
+        if (max_concurrency > 0 && max_concurrency < num_tasks) {
+            num_chunks = max_concurrency;
+        }
+
+        auto arena = get_arena();
+        arena->m_arena.execute([this, num_tasks, num_chunks, &task]() {
+            tbb::parallel_for(t_uindex(0), num_chunks, t_uindex(1),
+                [this, num_tasks, num_chunks, &task](t_uindex chunk) {
+                    t_current_guard guard(this);
+                    t_uindex begin = chunk * num_tasks / num_chunks;
+                    t_uindex end = (chunk + 1) * num_tasks / num_chunks;
+                    for (t_uindex idx = begin; idx < end; ++idx) {
+                        task(idx);
+                    }
+                });
+        });
+        return;
+    }
+#endif
+
+    for (t_uindex idx = 0; idx < num_tasks; ++idx) {
+        task(idx);
+    }
+}
+
+void
+t_scheduler::execute(const std::function<void()>& fn) {
+    t_current_guard guard(this);
+
+#ifdef PSP_PARALLEL_FOR
+    if (!is_inline()) {
+        auto arena = get_arena();
+        arena->m_arena.execute(fn);
+        return;
+    }
+#endif
+
+    fn();
+}
+
+#ifdef PSP_PARALLEL_FOR
+std::shared_ptr<t_scheduler::t_arena>
+t_scheduler::get_arena() const {
+    std::lock_guard<std::mutex> lg(m_mtx);
+    if (!m_arena) {
+        // Workers run on the CPUs of the NUMA node unless pinned otherwise.
+        std::vector<t_uindex> cpus = m_affinity;
+        if (cpus.empty() && m_numa_node >= 0) {
+            cpus = get_numa_node_cpus(static_cast<t_uindex>(m_numa_node));
+        }
+        m_arena = std::make_shared<t_arena>(m_num_threads, cpus, m_numa_node);
+    }
+    return m_arena;
+}
+#endif
+
+} // end namespace perspective
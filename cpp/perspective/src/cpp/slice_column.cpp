@@ -0,0 +1,302 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2017, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#include <perspective/first.h>
+#include <perspective/slice_column.h>
+#include <perspective/vocab.h>
+#include <tsl/hopscotch_map.h>
+#include <cstring>
+
+namespace perspective {
+
+namespace {
+    template <typename T>
+    void
+    copy_rows(const t_column& col, const std::vector<t_index>& rows,
+        const std::vector<std::uint8_t>& valid, T* out) {
+        for (t_uindex idx = 0, loop_end = rows.size(); idx < loop_end; ++idx) {
+            out[idx] = valid[idx] ? *(col.get_nth<T>(rows[idx])) : T();
+        }
+    }
+
+    template <typename T>
+    void
+    write_rows(const T* values, const std::vector<std::uint8_t>& valid, t_uindex offset,
+        t_column& dest) {
+        for (t_uindex idx = 0, loop_end = valid.size(); idx < loop_end; ++idx) {
+            if (valid[idx]) {
+                dest.set_nth<T>(offset + idx, values[idx]);
+            } else {
+                dest.clear(offset + idx);
+            }
+        }
+    }
+} // namespace
+
+t_slice_column::t_slice_column()
+    : m_dtype(DTYPE_NONE)
+    , m_size(0)
+    , m_null_count(0) {}
+
+t_slice_column::t_slice_column(
+    std::shared_ptr<const t_column> col, const std::vector<t_index>& rows)
+    : m_dtype(col->get_dtype())
+    , m_size(rows.size())
+    , m_valid(rows.size())
+    , m_valid_bitmap((rows.size() + 7) / 8)
+    , m_null_count(0) {
+    PSP_VERBOSE_ASSERT(is_supported(m_dtype), "Unsupported slice column type");
+    bool has_status = col->is_status_enabled();
+    bool contiguous = m_size > 0 && rows[0] >= 0;
+    for (t_uindex idx = 0; idx < m_size; ++idx) {
+        t_index row = rows[idx];
+        m_valid[idx] = row >= 0 && (!has_status || col->is_valid(row));
+        contiguous = contiguous && row == rows[0] + t_index(idx);
+    }
+
+    // A range of rows takes its bitmap from the column's statuses a byte at
+    // a time; rows gathered from anywhere are packed from `m_valid`.
+    if (contiguous) {
+        m_null_count = col->get_valid_bitmap(rows[0], rows[0] + m_size, m_valid_bitmap.data());
+    } else {
+        for (t_uindex idx = 0; idx < m_size; ++idx) {
+            m_valid_bitmap[idx / 8] |= std::uint8_t(m_valid[idx] != 0) << (idx % 8);
+            m_null_count += m_valid[idx] == 0;
+        }
+    }
+
+    switch (m_dtype) {
+        case DTYPE_STR: {
+            // Ids are taken from the vocabulary rather than strings copied.
+            m_data.resize(m_size * sizeof(std::int32_t));
+            std::int32_t* ids = reinterpret_cast<std::int32_t*>(m_data.data());
+            for (t_uindex idx = 0; idx < m_size; ++idx) {
+                ids[idx] = m_valid[idx]
+                    ? static_cast<std::int32_t>(*(col->get_nth<t_stridx>(rows[idx])))
+                    : -1;
+            }
+            m_column = col;
+        } break;
+        case DTYPE_INT64:
+        case DTYPE_UINT64:
+        case DTYPE_TIME: {
+            m_data.resize(m_size * sizeof(std::int64_t));
+            copy_rows(*col, rows, m_valid, reinterpret_cast<std::int64_t*>(m_data.data()));
+        } break;
+        case DTYPE_INT32:
+        case DTYPE_UINT32:
+        case DTYPE_DATE: {
+            m_data.resize(m_size * sizeof(std::int32_t));
+            copy_rows(*col, rows, m_valid, reinterpret_cast<std::int32_t*>(m_data.data()));
+        } break;
+        case DTYPE_INT16:
+        case DTYPE_UINT16: {
+            m_data.resize(m_size * sizeof(std::int16_t));
+            copy_rows(*col, rows, m_valid, reinterpret_cast<std::int16_t*>(m_data.data()));
+        } break;
+        case DTYPE_INT8:
+        case DTYPE_UINT8:
+        case DTYPE_BOOL: {
+            m_data.resize(m_size);
+            copy_rows(*col, rows, m_valid, reinterpret_cast<std::uint8_t*>(m_data.data()));
+        } break;
+        case DTYPE_FLOAT64: {
+            m_data.resize(m_size * sizeof(double));
+            copy_rows(*col, rows, m_valid, reinterpret_cast<double*>(m_data.data()));
+        } break;
+        case DTYPE_FLOAT32: {
+            m_data.resize(m_size * sizeof(float));
+            copy_rows(*col, rows, m_valid, reinterpret_cast<float*>(m_data.data()));
+        } break;
+        default: { PSP_COMPLAIN_AND_ABORT("Unexpected type"); }
+    }
+}
+
+bool
+t_slice_column::is_supported(t_dtype dtype) {
+    switch (dtype) {
+        case DTYPE_INT64:
+        case DTYPE_INT32:
+        case DTYPE_INT16:
+        case DTYPE_INT8:
+        case DTYPE_UINT64:
+        case DTYPE_UINT32:
+        case DTYPE_UINT16:
+        case DTYPE_UINT8:
+        case DTYPE_FLOAT64:
+        case DTYPE_FLOAT32:
+        case DTYPE_BOOL:
+        case DTYPE_TIME:
+        case DTYPE_DATE:
+        case DTYPE_STR: {
+            return true;
+        }
+        default: { return false; }
+    }
+}
+
+t_dtype
+t_slice_column::get_dtype() const {
+    return m_dtype;
+}
+
+t_uindex
+t_slice_column::size() const {
+    return m_size;
+}
+
+const std::uint8_t*
+t_slice_column::get_valid() const {
+    return m_valid.data();
+}
+
+const std::uint8_t*
+t_slice_column::get_valid_bitmap() const {
+    return m_valid_bitmap.data();
+}
+
+t_uindex
+t_slice_column::get_null_count() const {
+    return m_null_count;
+}
+
+bool
+t_slice_column::is_valid(t_uindex idx) const {
+    return m_valid[idx] != 0;
+}
+
+t_tscalar
+t_slice_column::get_scalar(t_uindex idx) const {
+    if (!m_valid[idx]) {
+        return mknone();
+    }
+
+    t_tscalar rv;
+    rv.clear();
+    switch (m_dtype) {
+        case DTYPE_INT64: {
+            rv.set(get_values<std::int64_t>()[idx]);
+        } break;
+        case DTYPE_INT32: {
+            rv.set(get_values<std::int32_t>()[idx]);
+        } break;
+        case DTYPE_INT16: {
+            rv.set(get_values<std::int16_t>()[idx]);
+        } break;
+        case DTYPE_INT8: {
+            rv.set(get_values<std::int8_t>()[idx]);
+        } break;
+        case DTYPE_UINT64: {
+            rv.set(get_values<std::uint64_t>()[idx]);
+        } break;
+        case DTYPE_UINT32: {
+            rv.set(get_values<std::uint32_t>()[idx]);
+        } break;
+        case DTYPE_UINT16: {
+            rv.set(get_values<std::uint16_t>()[idx]);
+        } break;
+        case DTYPE_UINT8: {
+            rv.set(get_values<std::uint8_t>()[idx]);
+        } break;
+        case DTYPE_FLOAT64: {
+            rv.set(get_values<double>()[idx]);
+        } break;
+        case DTYPE_FLOAT32: {
+            rv.set(get_values<float>()[idx]);
+        } break;
+        case DTYPE_BOOL: {
+            rv.set(get_values<std::uint8_t>()[idx] != 0);
+        } break;
+        case DTYPE_TIME: {
+            rv.set(t_time(get_values<t_time::t_rawtype>()[idx]));
+        } break;
+        case DTYPE_DATE: {
+            rv.set(t_date(get_values<t_date::t_rawtype>()[idx]));
+        } break;
+        case DTYPE_STR: {
+            rv.set(m_column->unintern_c(get_values<std::int32_t>()[idx]));
+        } break;
+        default: { PSP_COMPLAIN_AND_ABORT("Unexpected type"); }
+    }
+
+    return rv;
+}
+
+const t_vocab&
+t_slice_column::get_vocab() const {
+    PSP_VERBOSE_ASSERT(m_dtype == DTYPE_STR, "Expected a string column");
+    return *m_column->_get_vocab();
+}
+
+void
+t_slice_column::write_into(t_column& dest, t_uindex offset) const {
+    PSP_VERBOSE_ASSERT(dest.get_dtype() == m_dtype, "Mismatched slice column type");
+    switch (m_dtype) {
+        case DTYPE_STR: {
+            const std::int32_t* ids = get_values<std::int32_t>();
+            const t_vocab* vocab = m_column->_get_vocab();
+            t_vocab* dest_vocab = dest._get_vocab();
+            bool is_shared = dest_vocab == vocab;
+
+            // The id in `dest_vocab` of each id of `vocab` interned so far.
+            tsl::hopscotch_map<std::int32_t, t_stridx> interned;
+            for (t_uindex idx = 0; idx < m_size; ++idx) {
+                if (!m_valid[idx]) {
+                    dest.clear(offset + idx);
+                    continue;
+                }
+
+                t_stridx id = static_cast<t_stridx>(ids[idx]);
+                if (!is_shared) {
+                    auto it = interned.find(ids[idx]);
+                    if (it == interned.end()) {
+                        it = interned.emplace(ids[idx],
+                            dest_vocab->get_interned(m_column->unintern_c(ids[idx])))
+                                 .first;
+                    }
+                    id = it->second;
+                }
+                dest.set_nth<t_stridx>(offset + idx, id);
+            }
+        } break;
+        case DTYPE_INT64:
+        case DTYPE_UINT64:
+        case DTYPE_TIME: {
+            write_rows(get_values<std::int64_t>(), m_valid, offset, dest);
+        } break;
+        case DTYPE_INT32:
+        case DTYPE_UINT32:
+        case DTYPE_DATE: {
+            write_rows(get_values<std::int32_t>(), m_valid, offset, dest);
+        } break;
+        case DTYPE_INT16:
+        case DTYPE_UINT16: {
+            write_rows(get_values<std::int16_t>(), m_valid, offset, dest);
+        } break;
+        case DTYPE_INT8:
+        case DTYPE_UINT8:
+        case DTYPE_BOOL: {
+            write_rows(get_values<std::uint8_t>(), m_valid, offset, dest);
+        } break;
+        case DTYPE_FLOAT64: {
+            write_rows(get_values<double>(), m_valid, offset, dest);
+        } break;
+        case DTYPE_FLOAT32: {
+            write_rows(get_values<float>(), m_valid, offset, dest);
+        } break;
+        default: { PSP_COMPLAIN_AND_ABORT("Unexpected type"); }
+    }
+}
+
+t_uindex
+t_slice_column::nbytes() const {
+    return m_data.capacity() + m_valid.capacity() + m_valid_bitmap.capacity();
+}
+
+} // end namespace perspective
@@ -0,0 +1,130 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#include <perspective/first.h>
+#include <perspective/sort_arena.h>
+#include <perspective/multi_sort.h>
+#include <perspective/sort_key.h>
+#include <algorithm>
+#include <cstring>
+
+// Keys are compacted once released keys are both more than half of the
+// buffer and more than this many bytes.
+#define PSP_SORT_ARENA_MIN_GARBAGE 4096
+
+namespace perspective {
+
+t_sort_arena::t_sort_arena()
+    : m_ncols(0)
+    , m_encodable(true)
+    , m_garbage(0)
+    , m_nslots(0) {}
+
+void
+t_sort_arena::init(const std::vector<t_sorttype>& sort_order) {
+    clear();
+    m_sort_order = sort_order;
+    m_ncols = sort_order.size();
+    m_encodable = is_sort_key_encodable(sort_order);
+}
+
+void
+t_sort_arena::clear() {
+    m_values.clear();
+    m_keys.clear();
+    m_key_offsets.clear();
+    m_key_sizes.clear();
+    m_garbage = 0;
+    m_nslots = 0;
+    m_free.clear();
+}
+
+const std::vector<t_sorttype>&
+t_sort_arena::get_sort_order() const {
+    return m_sort_order;
+}
+
+t_uindex
+t_sort_arena::add(const t_tscalar* row, const t_tscalar& pkey) {
+    t_uindex slot;
+    if (!m_free.empty()) {
+        slot = m_free.back();
+        m_free.pop_back();
+    } else {
+        slot = m_nslots++;
+        if (m_encodable) {
+            m_key_offsets.push_back(0);
+            m_key_sizes.push_back(0);
+        } else {
+            m_values.resize(m_nslots * m_ncols);
+        }
+    }
+
+    if (m_encodable) {
+        t_uindex offset = m_keys.size();
+        append_sort_key(m_sort_order, row, 0, pkey, m_keys);
+        m_key_offsets[slot] = offset;
+        m_key_sizes[slot] = m_keys.size() - offset;
+    } else {
+        std::copy(row, row + m_ncols, m_values.begin() + slot * m_ncols);
+    }
+
+    return slot;
+}
+
+void
+t_sort_arena::release(t_uindex slot) {
+    if (m_encodable) {
+        m_garbage += m_key_sizes[slot];
+        m_key_sizes[slot] = 0;
+        if (m_garbage > PSP_SORT_ARENA_MIN_GARBAGE && m_garbage * 2 > m_keys.size()) {
+            compact();
+        }
+    }
+
+    m_free.push_back(slot);
+}
+
+bool
+t_sort_arena::less(const t_ftelem& a, const t_ftelem& b) const {
+    if (m_encodable) {
+        std::uint32_t a_size = m_key_sizes[a.m_slot];
+        std::uint32_t b_size = m_key_sizes[b.m_slot];
+        int cmp = std::memcmp(m_keys.data() + m_key_offsets[a.m_slot],
+            m_keys.data() + m_key_offsets[b.m_slot], std::min(a_size, b_size));
+        return cmp != 0 ? cmp < 0 : a_size < b_size;
+    }
+
+    const t_tscalar* values = m_values.data();
+    return cmp_sort_values(values + a.m_slot * m_ncols, a.m_pkey, 0,
+        values + b.m_slot * m_ncols, b.m_pkey, 0, m_sort_order);
+}
+
+t_uindex
+t_sort_arena::nbytes() const {
+    return m_values.capacity() * sizeof(t_tscalar) + m_keys.capacity()
+        + m_key_offsets.capacity() * sizeof(t_uindex)
+        + m_key_sizes.capacity() * sizeof(std::uint32_t) + m_free.capacity() * sizeof(t_uindex);
+}
+
+void
+t_sort_arena::compact() {
+    std::string keys;
+    keys.reserve(m_keys.size() - m_garbage);
+    for (t_uindex slot = 0; slot < m_nslots; ++slot) {
+        t_uindex offset = keys.size();
+        keys.append(m_keys, m_key_offsets[slot], m_key_sizes[slot]);
+        m_key_offsets[slot] = offset;
+    }
+
+    m_keys.swap(keys);
+    m_garbage = 0;
+}
+
+} // end namespace perspective
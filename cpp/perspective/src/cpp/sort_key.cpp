@@ -0,0 +1,161 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2017, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#include <perspective/first.h>
+#include <perspective/sort_key.h>
+#include <cmath>
+#include <cstring>
+
+namespace perspective {
+
+namespace {
+
+template <typename T>
+void
+append_big_endian(T value, std::string& out) {
+    for (int shift = (sizeof(T) - 1) * 8; shift >= 0; shift -= 8) {
+        out.push_back(static_cast<char>((value >> shift) & 0xFF));
+    }
+}
+
+// Maps the bits of an IEEE float onto an unsigned integer of the same order:
+// negative values have every bit flipped, positive values only the sign bit.
+template <typename FLOAT_T, typename UINT_T>
+UINT_T
+float_order_bits(FLOAT_T value) {
+    // -0.0 and 0.0 compare equal, so they should encode equally
+    if (value == 0) {
+        value = 0;
+    }
+
+    UINT_T bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const UINT_T sign = UINT_T(1) << (sizeof(UINT_T) * 8 - 1);
+    return (bits & sign) ? ~bits : (bits | sign);
+}
+
+void
+append_scalar(const t_tscalar& value, std::string& out) {
+    out.push_back(static_cast<char>(value.m_type));
+
+    // NaN compares before any other value of its type, whatever its status
+    if (value.is_floating_point()) {
+        if (std::isnan(value.to_double())) {
+            out.push_back(0);
+            return;
+        }
+
+        out.push_back(1);
+    }
+
+    out.push_back(static_cast<char>(value.m_status));
+
+    switch (value.m_type) {
+        case DTYPE_INT64:
+        case DTYPE_TIME: {
+            append_big_endian(
+                std::uint64_t(value.m_data.m_int64) ^ (std::uint64_t(1) << 63), out);
+        } break;
+        case DTYPE_INT32: {
+            append_big_endian(std::uint32_t(value.m_data.m_int32) ^ (std::uint32_t(1) << 31), out);
+        } break;
+        case DTYPE_INT16: {
+            append_big_endian(std::uint16_t(std::uint16_t(value.m_data.m_int16) ^ 0x8000), out);
+        } break;
+        case DTYPE_INT8: {
+            append_big_endian(std::uint8_t(std::uint8_t(value.m_data.m_int8) ^ 0x80), out);
+        } break;
+        case DTYPE_UINT64:
+        case DTYPE_OBJECT: {
+            append_big_endian(value.m_data.m_uint64, out);
+        } break;
+        case DTYPE_UINT32:
+        case DTYPE_DATE: {
+            append_big_endian(value.m_data.m_uint32, out);
+        } break;
+        case DTYPE_UINT16: {
+            append_big_endian(value.m_data.m_uint16, out);
+        } break;
+        case DTYPE_UINT8: {
+            append_big_endian(value.m_data.m_uint8, out);
+        } break;
+        case DTYPE_FLOAT64: {
+            append_big_endian(float_order_bits<double, std::uint64_t>(value.m_data.m_float64), out);
+        } break;
+        case DTYPE_FLOAT32: {
+            append_big_endian(float_order_bits<float, std::uint32_t>(value.m_data.m_float32), out);
+        } break;
+        case DTYPE_BOOL: {
+            out.push_back(value.m_data.m_bool ? 1 : 0);
+        } break;
+        case DTYPE_STR: {
+            // `strcmp` order, terminator included
+            const char* str = value.get_char_ptr();
+            if (str) {
+                out.append(str);
+            }
+            out.push_back(0);
+        } break;
+        default: {
+            // DTYPE_NONE and the remaining types compare equal within their
+            // type, so only the type and status are written.
+        } break;
+    }
+}
+
+} // end anonymous namespace
+
+bool
+is_sort_key_encodable(const std::vector<t_sorttype>& sort_order) {
+    for (t_sorttype order : sort_order) {
+        if (order != SORTTYPE_ASCENDING && order != SORTTYPE_DESCENDING) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void
+append_sort_key(const std::vector<t_sorttype>& sort_order, const t_tscalar* row,
+    t_uindex order, const t_tscalar& pkey, std::string& out) {
+    for (t_uindex idx = 0, loop_end = sort_order.size(); idx < loop_end; ++idx) {
+        t_uindex begin = out.size();
+        append_scalar(row[idx], out);
+
+        if (sort_order[idx] == SORTTYPE_DESCENDING) {
+            for (t_uindex bidx = begin, bend = out.size(); bidx < bend; ++bidx) {
+                out[bidx] = ~out[bidx];
+            }
+        }
+    }
+
+    // ties break on the order, then the primary key
+    append_big_endian(std::uint64_t(order), out);
+    append_scalar(pkey, out);
+}
+
+void
+encode_sort_key(
+    const std::vector<t_sorttype>& sort_order, const t_mselem& elem, std::string& out) {
+    PSP_VERBOSE_ASSERT(elem.m_row.size() == sort_order.size(), "Mismatched sort key size");
+    out.clear();
+    append_sort_key(sort_order, elem.m_row.data(), elem.m_order, elem.m_pkey, out);
+}
+
+void
+set_sort_key(const std::vector<t_sorttype>& sort_order, t_mselem& elem) {
+    if (is_sort_key_encodable(sort_order)) {
+        encode_sort_key(sort_order, elem, elem.m_key);
+    } else {
+        elem.m_key.clear();
+    }
+}
+
+} // end namespace perspective
@@ -0,0 +1,106 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#include <perspective/first.h>
+#include <perspective/sorted_column_index.h>
+#include <perspective/sort_key.h>
+#include <algorithm>
+
+namespace perspective {
+
+t_sorted_column_index::t_sorted_column_index(const std::string& colname, t_sorttype order)
+    : m_colname(colname)
+    , m_order(order)
+    , m_arena(std::make_shared<t_sort_arena>())
+    , m_index(m_arena) {
+    if (!is_sort_key_encodable(std::vector<t_sorttype>{order})) {
+        PSP_COMPLAIN_AND_ABORT("Cannot index `" + colname + "` in order `"
+            + sorttype_to_str(order) + "`, which is not ascending or descending");
+    }
+    m_arena->init(std::vector<t_sorttype>{order});
+}
+
+const std::string&
+t_sorted_column_index::get_colname() const {
+    return m_colname;
+}
+
+t_sorttype
+t_sorted_column_index::get_order() const {
+    return m_order;
+}
+
+void
+t_sorted_column_index::build(
+    const t_column& column, const std::vector<std::pair<t_tscalar, t_uindex>>& rows) {
+    clear();
+
+    std::vector<t_ftelem> elems;
+    elems.reserve(rows.size());
+    for (const auto& row : rows) {
+        t_tscalar pkey = m_symtable.get_interned_tscalar(row.first);
+        t_tscalar value = column.get_scalar(row.second);
+        elems.push_back(t_ftelem{pkey, m_arena->add(&value, pkey)});
+    }
+
+    const t_sort_arena* arena = m_arena.get();
+    std::sort(elems.begin(), elems.end(),
+        [arena](const t_ftelem& a, const t_ftelem& b) { return arena->less(a, b); });
+
+    m_index.build(elems);
+    m_nodes.reserve(elems.size());
+    for (auto node = m_index.select(0); node; node = t_sorted_index::next(node)) {
+        m_nodes[node->m_elem.m_pkey] = node;
+    }
+}
+
+void
+t_sorted_column_index::update(const t_tscalar& pkey, const t_tscalar& value) {
+    erase(pkey);
+    t_tscalar interned = m_symtable.get_interned_tscalar(pkey);
+    t_ftelem elem{interned, m_arena->add(&value, interned)};
+    m_nodes[interned] = m_index.insert(elem);
+}
+
+void
+t_sorted_column_index::erase(const t_tscalar& pkey) {
+    auto iter = m_nodes.find(pkey);
+    if (iter == m_nodes.end()) {
+        return;
+    }
+
+    m_arena->release(iter->second->m_elem.m_slot);
+    m_index.erase(iter->second);
+    m_nodes.erase(iter);
+}
+
+void
+t_sorted_column_index::clear() {
+    m_index.clear();
+    m_nodes.clear();
+    m_arena->init(std::vector<t_sorttype>{m_order});
+}
+
+bool
+t_sorted_column_index::contains(const t_tscalar& pkey) const {
+    return m_nodes.find(pkey) != m_nodes.end();
+}
+
+t_uindex
+t_sorted_column_index::size() const {
+    return m_index.size();
+}
+
+t_uindex
+t_sorted_column_index::nbytes() const {
+    return m_index.size() * sizeof(t_sorted_index::t_node) + m_arena->nbytes()
+        + hash_map_nbytes(m_nodes) + m_symtable.nbytes();
+}
+
+} // end namespace perspective
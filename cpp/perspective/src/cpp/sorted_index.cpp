@@ -0,0 +1,305 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2017, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#include <perspective/first.h>
+#include <perspective/sorted_index.h>
+
+namespace perspective {
+
+t_sorted_index::t_node::t_node(const t_ftelem& elem, std::uint32_t priority)
+    : m_elem(elem)
+    , m_left(nullptr)
+    , m_right(nullptr)
+    , m_parent(nullptr)
+    , m_size(1)
+    , m_priority(priority) {}
+
+t_sorted_index::t_sorted_index(std::shared_ptr<const t_sort_arena> arena)
+    : m_root(nullptr)
+    , m_arena(arena)
+    , m_seed(2463534242) {}
+
+t_sorted_index::~t_sorted_index() {
+    clear();
+}
+
+void
+t_sorted_index::build(const std::vector<t_ftelem>& elems) {
+    clear();
+
+    // Build the treap of the sorted elements as a cartesian tree on their
+    // priorities: the rightmost path of the tree so far is kept on a stack.
+    std::vector<t_node*> spine;
+
+    for (const auto& elem : elems) {
+        t_node* node = new t_node(elem, next_priority());
+        t_node* last = nullptr;
+
+        while (!spine.empty() && spine.back()->m_priority < node->m_priority) {
+            last = spine.back();
+            spine.pop_back();
+        }
+
+        node->m_left = last;
+
+        if (!spine.empty()) {
+            spine.back()->m_right = node;
+        }
+
+        spine.push_back(node);
+    }
+
+    if (!spine.empty()) {
+        m_root = spine.front();
+        fix_subtree(m_root);
+        m_root->m_parent = nullptr;
+    }
+}
+
+const t_sorted_index::t_node*
+t_sorted_index::insert(const t_ftelem& elem) {
+    t_node* node = new t_node(elem, next_priority());
+    m_root = insert(m_root, node);
+    m_root->m_parent = nullptr;
+    return node;
+}
+
+const t_sorted_index::t_node*
+t_sorted_index::push_back(const t_ftelem& elem) {
+    t_node* node = new t_node(elem, next_priority());
+    m_root = merge(m_root, node);
+    m_root->m_parent = nullptr;
+    return node;
+}
+
+const t_sorted_index::t_node*
+t_sorted_index::push_front(const t_ftelem& elem) {
+    t_node* node = new t_node(elem, next_priority());
+    m_root = merge(node, m_root);
+    m_root->m_parent = nullptr;
+    return node;
+}
+
+void
+t_sorted_index::erase(const t_node* node) {
+    t_node* target = const_cast<t_node*>(node);
+    t_node* parent = target->m_parent;
+    t_node* replacement = merge(target->m_left, target->m_right);
+
+    if (replacement) {
+        replacement->m_parent = parent;
+    }
+
+    if (!parent) {
+        m_root = replacement;
+    } else if (parent->m_left == target) {
+        parent->m_left = replacement;
+    } else {
+        parent->m_right = replacement;
+    }
+
+    for (t_node* ancestor = parent; ancestor; ancestor = ancestor->m_parent) {
+        --ancestor->m_size;
+    }
+
+    delete target;
+}
+
+void
+t_sorted_index::clear() {
+    destroy(m_root);
+    m_root = nullptr;
+}
+
+t_uindex
+t_sorted_index::size() const {
+    return subtree_size(m_root);
+}
+
+t_uindex
+t_sorted_index::rank(const t_node* node) const {
+    t_uindex rval = subtree_size(node->m_left);
+
+    for (; node->m_parent; node = node->m_parent) {
+        if (node->m_parent->m_right == node) {
+            rval += subtree_size(node->m_parent->m_left) + 1;
+        }
+    }
+
+    return rval;
+}
+
+const t_sorted_index::t_node*
+t_sorted_index::select(t_uindex idx) const {
+    const t_node* node = m_root;
+
+    while (node) {
+        t_uindex lsize = subtree_size(node->m_left);
+        if (idx < lsize) {
+            node = node->m_left;
+        } else if (idx == lsize) {
+            return node;
+        } else {
+            idx -= lsize + 1;
+            node = node->m_right;
+        }
+    }
+
+    return nullptr;
+}
+
+const t_sorted_index::t_node*
+t_sorted_index::next(const t_node* node) {
+    if (node->m_right) {
+        node = node->m_right;
+        while (node->m_left) {
+            node = node->m_left;
+        }
+        return node;
+    }
+
+    while (node->m_parent && node->m_parent->m_right == node) {
+        node = node->m_parent;
+    }
+
+    return node->m_parent;
+}
+
+t_uindex
+t_sorted_index::lower_bound(const t_ftelem& elem) const {
+    t_uindex rval = 0;
+    const t_node* node = m_root;
+
+    while (node) {
+        if (m_arena->less(node->m_elem, elem)) {
+            rval += subtree_size(node->m_left) + 1;
+            node = node->m_right;
+        } else {
+            node = node->m_left;
+        }
+    }
+
+    return rval;
+}
+
+t_uindex
+t_sorted_index::subtree_size(const t_node* node) {
+    return node ? node->m_size : 0;
+}
+
+void
+t_sorted_index::update(t_node* node) {
+    node->m_size = 1 + subtree_size(node->m_left) + subtree_size(node->m_right);
+
+    if (node->m_left) {
+        node->m_left->m_parent = node;
+    }
+
+    if (node->m_right) {
+        node->m_right->m_parent = node;
+    }
+}
+
+void
+t_sorted_index::destroy(t_node* node) {
+    if (!node) {
+        return;
+    }
+
+    destroy(node->m_left);
+    destroy(node->m_right);
+    delete node;
+}
+
+// Splits the subtree at `node` into the elements that sort before `elem`
+// and the rest.
+void
+t_sorted_index::split(t_node* node, const t_ftelem& elem, t_node*& left, t_node*& right) const {
+    if (!node) {
+        left = nullptr;
+        right = nullptr;
+        return;
+    }
+
+    if (m_arena->less(node->m_elem, elem)) {
+        split(node->m_right, elem, node->m_right, right);
+        left = node;
+    } else {
+        split(node->m_left, elem, left, node->m_left);
+        right = node;
+    }
+
+    update(node);
+}
+
+// Joins two subtrees, every element of `left` sorting before `right`.
+t_sorted_index::t_node*
+t_sorted_index::merge(t_node* left, t_node* right) const {
+    if (!left) {
+        return right;
+    }
+
+    if (!right) {
+        return left;
+    }
+
+    if (left->m_priority > right->m_priority) {
+        left->m_right = merge(left->m_right, right);
+        update(left);
+        return left;
+    }
+
+    right->m_left = merge(left, right->m_left);
+    update(right);
+    return right;
+}
+
+t_sorted_index::t_node*
+t_sorted_index::insert(t_node* root, t_node* node) const {
+    if (!root) {
+        return node;
+    }
+
+    if (node->m_priority > root->m_priority) {
+        split(root, node->m_elem, node->m_left, node->m_right);
+        update(node);
+        return node;
+    }
+
+    if (m_arena->less(node->m_elem, root->m_elem)) {
+        root->m_left = insert(root->m_left, node);
+    } else {
+        root->m_right = insert(root->m_right, node);
+    }
+
+    update(root);
+    return root;
+}
+
+void
+t_sorted_index::fix_subtree(t_node* node) {
+    if (!node) {
+        return;
+    }
+
+    fix_subtree(node->m_left);
+    fix_subtree(node->m_right);
+    update(node);
+}
+
+std::uint32_t
+t_sorted_index::next_priority() {
+    // xorshift32
+    m_seed ^= m_seed << 13;
+    m_seed ^= m_seed >> 17;
+    m_seed ^= m_seed << 5;
+    return m_seed;
+}
+
+} // end namespace perspective
@@ -11,6 +11,7 @@
 #include <algorithm>
 #include <cmath>
 #include <fstream>
+#include <limits>
 #include <perspective/base.h>
 #include <perspective/compat.h>
 #include <perspective/extract_aggregate.h>
@@ -27,10 +28,59 @@
 #include <perspective/data_table.h>
 #include <perspective/filter_utils.h>
 #include <perspective/context_two.h>
+#include <perspective/kernel_engine.h>
+#include <perspective/scheduler.h>
 #include <set>
 
+// Aggregate rows a tree must hold before it relays them out.
+#define PSP_AGG_RELAYOUT_MIN_ROWS 1024
+
 namespace perspective {
 
+template <typename T>
+static void
+swap_agg_state(T& a, T& b) {
+    std::swap(a, b);
+}
+
+static void
+swap_agg_state(t_value_multiset& a, t_value_multiset& b) {
+    a.swap(b);
+}
+
+// Rekey the per-row state of each aggregate column in `maps` from the old
+// aggregate rows to `new_rows[old]`.
+template <typename T>
+static void
+remap_agg_rows(std::vector<std::unordered_map<t_uindex, T>>& maps,
+    const std::vector<t_uindex>& new_rows) {
+    for (auto& rows : maps) {
+        if (rows.empty()) {
+            continue;
+        }
+
+        std::unordered_map<t_uindex, T> remapped;
+        remapped.reserve(rows.size());
+        for (auto& kv : rows) {
+            swap_agg_state(remapped[new_rows[kv.first]], kv.second);
+        }
+        rows.swap(remapped);
+    }
+}
+
+// Returns the value of row `idx` of `col` for a pivot-like column of a
+// strand table, bucketed if `bucket` is set.
+static t_tscalar
+get_pivot_like_value(
+    const t_column* col, t_uindex idx, const std::function<t_tscalar(t_tscalar)>& bucket) {
+    t_tscalar value = col->get_scalar(idx);
+    if (!bucket || !value.is_valid()) {
+        return value;
+    }
+
+    return bucket(value);
+}
+
 t_tscalar
 get_dominant(std::vector<t_tscalar>& values) {
     if (values.empty())
@@ -63,6 +113,8 @@ get_dominant(std::vector<t_tscalar>& values) {
     return delem;
 }
 
+const t_depth t_stree::LAZY_DEPTH_NONE = std::numeric_limits<t_depth>::max();
+
 t_tree_unify_rec::t_tree_unify_rec(
     t_uindex sptidx, t_uindex daggidx, t_uindex saggidx, t_uindex nstrands)
     : m_sptidx(sptidx)
@@ -78,7 +130,9 @@ t_stree::t_stree(const std::vector<t_pivot>& pivots, const std::vector<t_aggspec
     , m_aggspecs(aggspecs)
     , m_schema(schema)
     , m_cur_aggidx(1)
+    , m_agg_churn(0)
     , m_minmax(aggspecs.size())
+    , m_lazy_depth(LAZY_DEPTH_NONE)
     , m_has_delta(false) {
     auto g_agg_str = cfg.get_grand_agg_str();
     m_grand_agg_str = g_agg_str.empty() ? "Grand Aggregate" : g_agg_str;
@@ -111,6 +165,8 @@ t_stree::init() {
     t_tscalar value = m_symtable.get_interned_tscalar(m_grand_agg_str.c_str());
     t_tnode node(0, root_pidx(), value, 0, value, 1, 0);
     m_nodes->insert(node);
+    m_nodestore.clear();
+    m_nodestore.insert(node);
 
     std::vector<std::string> columns;
     std::vector<t_dtype> dtypes;
@@ -128,6 +184,7 @@ t_stree::init() {
 
     t_uindex capacity = DEFAULT_EMPTY_CAPACITY;
     m_aggregates = std::make_shared<t_data_table>(schema, capacity);
+    m_aggregates->set_alloc_owner(ALLOC_OWNER_AGGREGATE);
     m_aggregates->init();
     m_aggregates->set_size(capacity);
 
@@ -137,6 +194,14 @@ t_stree::init() {
         m_aggcols[idx] = m_aggregates->get_const_column(columns[idx]).get();
     }
 
+    m_multisets = std::vector<std::unordered_map<t_uindex, t_value_multiset>>(columns.size());
+    m_sketches = std::vector<std::unordered_map<t_uindex, t_hll_sketch>>(columns.size());
+    m_digests = std::vector<std::unordered_map<t_uindex, t_tdigest>>(columns.size());
+    m_windows = std::vector<std::unordered_map<t_uindex, t_rolling_window>>(columns.size());
+    m_rolling_now
+        = std::vector<double>(columns.size(), -std::numeric_limits<double>::infinity());
+    m_open.clear();
+
     m_deltas = std::make_shared<t_tcdeltas>();
     m_features = std::vector<bool>(CTX_FEAT_LAST_FEATURE);
     m_init = true;
@@ -144,16 +209,14 @@ t_stree::init() {
 
 t_tscalar
 t_stree::get_value(t_index idx) const {
-    iter_by_idx iter = m_nodes->get<by_idx>().find(idx);
-    PSP_VERBOSE_ASSERT(iter != m_nodes->get<by_idx>().end(), "Reached end iterator");
-    return iter->m_value;
+    PSP_VERBOSE_ASSERT(m_nodestore.contains(idx), "Reached end iterator");
+    return m_nodestore.get_value(idx);
 }
 
 t_tscalar
 t_stree::get_sortby_value(t_index idx) const {
-    iter_by_idx iter = m_nodes->get<by_idx>().find(idx);
-    PSP_VERBOSE_ASSERT(iter != m_nodes->get<by_idx>().end(), "Reached end iterator");
-    return iter->m_sort_value;
+    PSP_VERBOSE_ASSERT(m_nodestore.contains(idx), "Reached end iterator");
+    return m_nodestore.get_sort_value(idx);
 }
 
 void
@@ -164,8 +227,8 @@ t_stree::build_strand_table_phase_1(t_tscalar pkey, t_op op, t_uindex idx, t_uin
     const std::vector<const t_column*>& agg_ccols,
     const std::vector<const t_column*>& agg_dcols, std::vector<t_column*>& piv_scols,
     std::vector<t_column*>& agg_acols, t_column* agg_scount, t_column* spkey,
-    t_uindex& insert_count, bool& pivots_neq,
-    const std::vector<std::string>& pivot_like) const {
+    t_uindex& insert_count, bool& pivots_neq, const std::vector<std::string>& pivot_like,
+    const std::vector<std::function<t_tscalar(t_tscalar)>>& pivot_buckets) const {
     pivots_neq = false;
     std::set<std::string> pivmap;
     bool all_eq_tt = true;
@@ -176,7 +239,8 @@ t_stree::build_strand_table_phase_1(t_tscalar pkey, t_op op, t_uindex idx, t_uin
             continue;
         }
         pivmap.insert(colname);
-        piv_scols[pidx]->push_back(piv_ccols[pidx]->get_scalar(idx));
+        piv_scols[pidx]->push_back(
+            get_pivot_like_value(piv_ccols[pidx], idx, pivot_buckets[pidx]));
         const std::uint8_t* trans_ = piv_tcols[pidx]->get_nth<std::uint8_t>(idx);
         t_value_transition trans = static_cast<t_value_transition>(*trans_);
         if (trans != VALUE_TRANSITION_EQ_TT)
@@ -221,7 +285,8 @@ t_stree::build_strand_table_phase_2(t_tscalar pkey, t_uindex idx, t_uindex npivo
     const std::vector<const t_column*>& piv_pcols,
     const std::vector<const t_column*>& agg_pcols, std::vector<t_column*>& piv_scols,
     std::vector<t_column*>& agg_acols, t_column* agg_scount, t_column* spkey,
-    t_uindex& insert_count, const std::vector<std::string>& pivot_like) const {
+    t_uindex& insert_count, const std::vector<std::string>& pivot_like,
+    const std::vector<std::function<t_tscalar(t_tscalar)>>& pivot_buckets) const {
     std::set<std::string> pivmap;
     for (t_uindex pidx = 0, ploop_end = pivot_like.size(); pidx < ploop_end; ++pidx) {
         const std::string& colname = pivot_like.at(pidx);
@@ -229,7 +294,8 @@ t_stree::build_strand_table_phase_2(t_tscalar pkey, t_uindex idx, t_uindex npivo
             continue;
         }
         pivmap.insert(colname);
-        piv_scols[pidx]->push_back(piv_pcols[pidx]->get_scalar(idx));
+        piv_scols[pidx]->push_back(
+            get_pivot_like_value(piv_pcols[pidx], idx, pivot_buckets[pidx]));
     }
 
     for (t_uindex aggidx = 0; aggidx < aggcolsize; ++aggidx) {
@@ -254,19 +320,27 @@ t_stree::build_strand_table_common(const t_data_table& flattened,
     rv.m_flattened_schema = flattened.get_schema();
     std::set<std::string> sschema_colset;
 
-    for (const auto& piv : m_pivots) {
-        const std::string& colname = piv.colname();
-        std::string sortby_colname = config.get_sort_by(colname);
-        auto add_col = [&sschema_colset, &rv](const std::string& cname) {
-            if (sschema_colset.find(cname) == sschema_colset.end()) {
-                rv.m_pivot_like_columns.push_back(cname);
-                rv.m_strand_schema.add_column(cname, rv.m_flattened_schema.get_dtype(cname));
-                sschema_colset.insert(cname);
-            }
-        };
+    // A bucketed pivot reads its column into a strand column of its own
+    // name, holding the buckets of its values.
+    auto add_col = [&sschema_colset, &rv](const std::string& cname, const t_pivot* pivot) {
+        if (sschema_colset.find(cname) == sschema_colset.end()) {
+            std::string source = pivot ? pivot->colname() : cname;
+            t_dtype dtype = rv.m_flattened_schema.get_dtype(source);
+            rv.m_pivot_like_columns.push_back(cname);
+            rv.m_pivot_like_sources.push_back(source);
+            rv.m_pivot_like_buckets.push_back(pivot
+                    ? pivot->get_bucket_function(dtype)
+                    : std::function<t_tscalar(t_tscalar)>());
+            rv.m_strand_schema.add_column(cname, pivot ? pivot->get_dtype(dtype) : dtype);
+            sschema_colset.insert(cname);
+        }
+    };
 
-        add_col(colname);
-        add_col(sortby_colname);
+    for (const auto& piv : m_pivots) {
+        const std::string& name = piv.name();
+        std::string sortby_colname = config.get_sort_by(name);
+        add_col(name, &piv);
+        add_col(sortby_colname, nullptr);
     }
 
     rv.m_pivsize = sschema_colset.size();
@@ -278,12 +352,8 @@ t_stree::build_strand_table_common(const t_data_table& flattened,
                 const std::string& depname = dep.name();
                 aggcolset.insert(depname);
 
-                if (aggspec.is_non_delta()
-                    && sschema_colset.find(depname) == sschema_colset.end()) {
-                    rv.m_pivot_like_columns.push_back(depname);
-                    rv.m_strand_schema.add_column(
-                        depname, rv.m_flattened_schema.get_dtype(depname));
-                    sschema_colset.insert(depname);
+                if (aggspec.is_non_delta()) {
+                    add_col(depname, nullptr);
                 }
             }
         }
@@ -298,15 +368,313 @@ t_stree::build_strand_table_common(const t_data_table& flattened,
     }
 
     rv.m_aggschema.add_column("psp_strand_count", DTYPE_INT8);
+    rv.m_aggcolsize = rv.m_aggschema.size();
+
+    for (const auto& aggspec : aggspecs) {
+        if (!aggspec.is_running_agg()
+            || rv.m_aggschema.has_column(aggspec.get_running_nr_name())) {
+            continue;
+        }
+
+        rv.m_running_aggs.push_back(aggspec);
+        rv.m_aggschema.add_column(aggspec.get_running_nr_name(), DTYPE_FLOAT64);
+        rv.m_aggschema.add_column(aggspec.get_running_dr_name(), DTYPE_FLOAT64);
+    }
+
+    for (const auto& aggspec : aggspecs) {
+        if (!(aggspec.is_multiset_agg() || aggspec.is_sketch_agg())
+            || rv.m_aggschema.has_column(aggspec.get_multiset_op_name())) {
+            continue;
+        }
+
+        t_dtype dtype = rv.m_flattened_schema.get_dtype(aggspec.get_first_depname());
+        rv.m_multiset_aggs.push_back(aggspec);
+        rv.m_aggschema.add_column(aggspec.get_multiset_add_name(), dtype);
+        rv.m_aggschema.add_column(aggspec.get_multiset_sub_name(), dtype);
+        rv.m_aggschema.add_column(aggspec.get_multiset_op_name(), DTYPE_INT8);
+    }
+
+    for (const auto& aggspec : aggspecs) {
+        if (!aggspec.is_rolling_agg()
+            || rv.m_aggschema.has_column(aggspec.get_rolling_name("add_t"))) {
+            continue;
+        }
+
+        rv.m_rolling_aggs.push_back(aggspec);
+        for (const char* field : {"add_t", "add_nr", "add_dr", "sub_t", "sub_nr", "sub_dr"}) {
+            rv.m_aggschema.add_column(aggspec.get_rolling_name(field), DTYPE_FLOAT64);
+        }
+    }
+
     return rv;
 }
 
+std::vector<t_running_agg_cols>
+t_stree::get_running_agg_cols(const t_build_strand_table_common_rval& rv,
+    const t_data_table& flattened, const t_data_table* prev, const t_data_table* current,
+    t_data_table& aggs) const {
+    std::vector<t_running_agg_cols> rval;
+    rval.reserve(rv.m_running_aggs.size());
+
+    for (const auto& aggspec : rv.m_running_aggs) {
+        const std::vector<t_dep>& deps = aggspec.get_dependencies();
+        const std::string& value = deps[0].name();
+
+        t_running_agg_cols cols;
+        cols.m_agg = aggspec.agg();
+        cols.m_fvalue = flattened.get_const_column(value).get();
+        cols.m_pvalue = prev ? prev->get_const_column(value).get() : nullptr;
+        cols.m_cvalue = current ? current->get_const_column(value).get() : cols.m_fvalue;
+        cols.m_fweight = nullptr;
+        cols.m_pweight = nullptr;
+        cols.m_cweight = nullptr;
+
+        if (cols.m_agg == AGGTYPE_WEIGHTED_MEAN) {
+            const std::string& weight = deps[1].name();
+            cols.m_fweight = flattened.get_const_column(weight).get();
+            cols.m_pweight = prev ? prev->get_const_column(weight).get() : nullptr;
+            cols.m_cweight
+                = current ? current->get_const_column(weight).get() : cols.m_fweight;
+        }
+
+        cols.m_nr = aggs.get_column(aggspec.get_running_nr_name()).get();
+        cols.m_dr = aggs.get_column(aggspec.get_running_dr_name()).get();
+        rval.push_back(cols);
+    }
+
+    return rval;
+}
+
+// Pushes the change in (numerator, denominator) contributed by row `idx` to
+// each running aggregate - the current row's contribution if `add_current`,
+// less the previous row's if `sub_prev`. Null, cleared and NaN values
+// contribute nothing, as they would to a mean over the leaf rows.
+void
+t_stree::build_strand_table_running(t_uindex idx, bool add_current, bool sub_prev,
+    std::vector<t_running_agg_cols>& running_cols) const {
+    for (auto& cols : running_cols) {
+        double nr = 0;
+        double dr = 0;
+
+        auto accumulate = [&cols, idx, &nr, &dr](
+                              const t_column* vcol, const t_column* wcol, double sign) {
+            if (!vcol->is_valid(idx)) {
+                return;
+            }
+
+            t_tscalar value = vcol->get_scalar(idx);
+            if (value.is_nan()) {
+                return;
+            }
+
+            if (cols.m_agg == AGGTYPE_WEIGHTED_MEAN) {
+                if (!wcol->is_valid(idx)) {
+                    return;
+                }
+
+                t_tscalar weight = wcol->get_scalar(idx);
+                if (weight.is_nan()) {
+                    return;
+                }
+
+                nr += sign * weight.to_double() * value.to_double();
+                dr += sign * weight.to_double();
+            } else {
+                nr += sign * value.to_double();
+                dr += sign;
+            }
+        };
+
+        if (add_current) {
+            bool cleared = cols.m_fvalue->is_cleared(idx)
+                || (cols.m_fweight && cols.m_fweight->is_cleared(idx));
+            if (!cleared) {
+                accumulate(cols.m_cvalue, cols.m_cweight, 1);
+            }
+        }
+
+        if (sub_prev) {
+            accumulate(cols.m_pvalue, cols.m_pweight, -1);
+        }
+
+        cols.m_nr->push_back<double>(nr);
+        cols.m_dr->push_back<double>(dr);
+    }
+}
+
+std::vector<t_multiset_agg_cols>
+t_stree::get_multiset_agg_cols(const t_build_strand_table_common_rval& rv,
+    const t_data_table& flattened, const t_data_table* prev, const t_data_table* current,
+    t_data_table& aggs) const {
+    std::vector<t_multiset_agg_cols> rval;
+    rval.reserve(rv.m_multiset_aggs.size());
+
+    for (const auto& aggspec : rv.m_multiset_aggs) {
+        const std::string& value = aggspec.get_first_depname();
+
+        t_multiset_agg_cols cols;
+        cols.m_dtype = rv.m_flattened_schema.get_dtype(value);
+        cols.m_fvalue = flattened.get_const_column(value).get();
+        cols.m_pvalue = prev ? prev->get_const_column(value).get() : nullptr;
+        cols.m_cvalue = current ? current->get_const_column(value).get() : cols.m_fvalue;
+        cols.m_add = aggs.get_column(aggspec.get_multiset_add_name()).get();
+        cols.m_sub = aggs.get_column(aggspec.get_multiset_sub_name()).get();
+        cols.m_op = aggs.get_column(aggspec.get_multiset_op_name()).get();
+        rval.push_back(cols);
+    }
+
+    return rval;
+}
+
+// Pushes the values added to and removed from each multiset aggregate by
+// row `idx` - the current row's value if `add_current`, and the previous
+// row's if `sub_prev`. Nulls are pushed as a null of the column's dtype,
+// matching how the gnode state stores them.
+void
+t_stree::build_strand_table_multiset(t_uindex idx, bool add_current, bool sub_prev,
+    std::vector<t_multiset_agg_cols>& multiset_cols) const {
+    for (auto& cols : multiset_cols) {
+        std::int8_t op = 0;
+        t_tscalar add = mknull(cols.m_dtype);
+        t_tscalar sub = mknull(cols.m_dtype);
+
+        if (add_current) {
+            op |= MULTISET_OP_ADD;
+            if (!cols.m_fvalue->is_cleared(idx) && cols.m_cvalue->is_valid(idx)) {
+                add = cols.m_cvalue->get_scalar(idx);
+            }
+        }
+
+        if (sub_prev) {
+            op |= MULTISET_OP_SUB;
+            if (cols.m_pvalue->is_valid(idx)) {
+                sub = cols.m_pvalue->get_scalar(idx);
+            }
+        }
+
+        cols.m_add->push_back(add);
+        cols.m_sub->push_back(sub);
+        cols.m_op->push_back<std::int8_t>(op);
+    }
+}
+
+std::vector<t_rolling_agg_cols>
+t_stree::get_rolling_agg_cols(const t_build_strand_table_common_rval& rv,
+    const t_data_table& flattened, const t_data_table* prev, const t_data_table* current,
+    t_data_table& aggs) const {
+    std::vector<t_rolling_agg_cols> rval;
+    rval.reserve(rv.m_rolling_aggs.size());
+
+    auto get_cols = [&flattened, prev, current](const std::string& name, const t_column*& f,
+                        const t_column*& p, const t_column*& c) {
+        f = flattened.get_const_column(name).get();
+        p = prev ? prev->get_const_column(name).get() : nullptr;
+        c = current ? current->get_const_column(name).get() : f;
+    };
+
+    for (const auto& aggspec : rv.m_rolling_aggs) {
+        const std::vector<t_dep>& deps = aggspec.get_dependencies();
+
+        t_rolling_agg_cols cols;
+        cols.m_agg = aggspec.agg();
+        get_cols(deps[0].name(), cols.m_fvalue, cols.m_pvalue, cols.m_cvalue);
+        get_cols(deps[1].name(), cols.m_ftime, cols.m_ptime, cols.m_ctime);
+        cols.m_fweight = nullptr;
+        cols.m_pweight = nullptr;
+        cols.m_cweight = nullptr;
+
+        if (cols.m_agg == AGGTYPE_ROLLING_WEIGHTED_MEAN) {
+            get_cols(deps[2].name(), cols.m_fweight, cols.m_pweight, cols.m_cweight);
+        }
+
+        cols.m_add_t = aggs.get_column(aggspec.get_rolling_name("add_t")).get();
+        cols.m_add_nr = aggs.get_column(aggspec.get_rolling_name("add_nr")).get();
+        cols.m_add_dr = aggs.get_column(aggspec.get_rolling_name("add_dr")).get();
+        cols.m_sub_t = aggs.get_column(aggspec.get_rolling_name("sub_t")).get();
+        cols.m_sub_nr = aggs.get_column(aggspec.get_rolling_name("sub_nr")).get();
+        cols.m_sub_dr = aggs.get_column(aggspec.get_rolling_name("sub_dr")).get();
+        rval.push_back(cols);
+    }
+
+    return rval;
+}
+
+// Pushes the (time, numerator, denominator) added to each rolling aggregate
+// by row `idx` if `add_current`, and removed if `sub_prev`, as the running
+// aggregates count them. Rows with a null time or a null or NaN value or
+// weight, and cleared rows, contribute nothing.
+void
+t_stree::build_strand_table_rolling(t_uindex idx, bool add_current, bool sub_prev,
+    std::vector<t_rolling_agg_cols>& rolling_cols) const {
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+
+    for (auto& cols : rolling_cols) {
+        auto contribution = [&cols, idx, nan](const t_column* vcol, const t_column* tcol,
+                                const t_column* wcol, double& t, double& nr, double& dr) {
+            t = nan;
+            nr = 0;
+            dr = 0;
+            if (!vcol->is_valid(idx) || !tcol->is_valid(idx)) {
+                return;
+            }
+
+            t_tscalar value = vcol->get_scalar(idx);
+            if (value.is_nan()) {
+                return;
+            }
+
+            if (cols.m_agg == AGGTYPE_ROLLING_WEIGHTED_MEAN) {
+                if (!wcol->is_valid(idx)) {
+                    return;
+                }
+
+                t_tscalar weight = wcol->get_scalar(idx);
+                if (weight.is_nan()) {
+                    return;
+                }
+
+                nr = weight.to_double() * value.to_double();
+                dr = weight.to_double();
+            } else {
+                nr = value.to_double();
+                dr = 1;
+            }
+
+            t = tcol->get_scalar(idx).to_double();
+        };
+
+        double add_t = nan, add_nr = 0, add_dr = 0;
+        double sub_t = nan, sub_nr = 0, sub_dr = 0;
+
+        if (add_current) {
+            bool cleared = cols.m_fvalue->is_cleared(idx) || cols.m_ftime->is_cleared(idx)
+                || (cols.m_fweight && cols.m_fweight->is_cleared(idx));
+            if (!cleared) {
+                contribution(
+                    cols.m_cvalue, cols.m_ctime, cols.m_cweight, add_t, add_nr, add_dr);
+            }
+        }
+
+        if (sub_prev) {
+            contribution(cols.m_pvalue, cols.m_ptime, cols.m_pweight, sub_t, sub_nr, sub_dr);
+        }
+
+        cols.m_add_t->push_back<double>(add_t);
+        cols.m_add_nr->push_back<double>(add_nr);
+        cols.m_add_dr->push_back<double>(add_dr);
+        cols.m_sub_t->push_back<double>(sub_t);
+        cols.m_sub_nr->push_back<double>(sub_nr);
+        cols.m_sub_dr->push_back<double>(sub_dr);
+    }
+}
+
 // can contain additional rows
 // notably pivot changed rows will be added
 std::pair<std::shared_ptr<t_data_table>, std::shared_ptr<t_data_table>>
 t_stree::build_strand_table(const t_data_table& flattened, const t_data_table& delta,
     const t_data_table& prev, const t_data_table& current, const t_data_table& transitions,
-    const std::vector<t_aggspec>& aggspecs, const t_config& config) const {
+    const t_data_table& existed, const std::vector<t_aggspec>& aggspecs,
+    const t_config& config) const {
 
     PSP_TRACE_SENTINEL();
     PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
@@ -334,13 +702,14 @@ t_stree::build_strand_table(const t_data_table& flattened, const t_data_table& d
 
     for (t_uindex pidx = 0; pidx < npivotlike; ++pidx) {
         const std::string& piv = rv.m_strand_schema.m_columns[pidx];
-        piv_pcols[pidx] = prev.get_const_column(piv).get();
-        piv_ccols[pidx] = current.get_const_column(piv).get();
-        piv_tcols[pidx] = transitions.get_const_column(piv).get();
+        const std::string& source = rv.m_pivot_like_sources[pidx];
+        piv_pcols[pidx] = prev.get_const_column(source).get();
+        piv_ccols[pidx] = current.get_const_column(source).get();
+        piv_tcols[pidx] = transitions.get_const_column(source).get();
         piv_scols[pidx] = strands->get_column(piv).get();
     }
 
-    t_uindex aggcolsize = rv.m_aggschema.m_columns.size();
+    t_uindex aggcolsize = rv.m_aggcolsize;
     std::vector<const t_column*> agg_ccols(aggcolsize);
     std::vector<const t_column*> agg_pcols(aggcolsize);
     std::vector<const t_column*> agg_dcols(aggcolsize);
@@ -368,11 +737,41 @@ t_stree::build_strand_table(const t_data_table& flattened, const t_data_table& d
 
     t_column* spkey = strands->get_column("psp_pkey").get();
 
+    auto running_cols = get_running_agg_cols(rv, flattened, &prev, &current, *aggs);
+    auto multiset_cols = get_multiset_agg_cols(rv, flattened, &prev, &current, *aggs);
+    auto rolling_cols = get_rolling_agg_cols(rv, flattened, &prev, &current, *aggs);
+    const t_column* existed_col = existed.get_const_column("psp_existed").get();
+
+    // Unlike the running sums, a null previous value is itself a member of
+    // the multiset, so only remove previous values of rows which existed.
+    auto push_running
+        = [this, &running_cols, &multiset_cols, &rolling_cols, existed_col](
+              t_uindex idx, bool add_current, bool sub_prev) {
+              build_strand_table_running(idx, add_current, sub_prev, running_cols);
+              build_strand_table_multiset(idx, add_current,
+                  sub_prev && *(existed_col->get_nth<bool>(idx)), multiset_cols);
+              build_strand_table_rolling(idx, add_current, sub_prev, rolling_cols);
+          };
+
+    // Rows applied in full (pivot changed or newly passing the filter)
+    // contribute their current value, other rows only the change from
+    // their previous value; deletes remove the previous value.
+    auto push_running_phase_1
+        = [&push_running](t_uindex idx, t_op op, bool force_current_row, bool pivots_neq) {
+              if (op == OP_DELETE) {
+                  push_running(idx, false, true);
+              } else {
+                  push_running(idx, true, !(pivots_neq || force_current_row));
+              }
+          };
+
     t_mask msk_prev, msk_curr;
 
     if (config.has_filters()) {
-        msk_prev = filter_table_for_config(prev, config);
         msk_curr = filter_table_for_config(current, config);
+        msk_prev = filter_columns_changed(transitions, config)
+            ? filter_table_for_config(prev, config)
+            : msk_curr;
     }
 
     bool has_filters = config.has_filters();
@@ -395,18 +794,21 @@ t_stree::build_strand_table(const t_data_table& flattened, const t_data_table& d
                 build_strand_table_phase_1(pkey, op, idx, rv.m_pivsize, strand_count_idx,
                     aggcolsize, true, piv_ccols, piv_tcols, agg_ccols, agg_dcols, piv_scols,
                     agg_acols, agg_scount, spkey, insert_count, pivots_neq,
-                    rv.m_pivot_like_columns);
+                    rv.m_pivot_like_columns, rv.m_pivot_like_buckets);
+                push_running_phase_1(idx, op, true, pivots_neq);
             } else if (filter_prev && !filter_curr) {
                 // reverse prev row
                 build_strand_table_phase_2(pkey, idx, rv.m_pivsize, strand_count_idx,
                     aggcolsize, piv_pcols, agg_pcols, piv_scols, agg_acols, agg_scount, spkey,
-                    insert_count, rv.m_pivot_like_columns);
+                    insert_count, rv.m_pivot_like_columns, rv.m_pivot_like_buckets);
+                push_running(idx, false, true);
             } else if (filter_prev && filter_curr) {
                 // should be handled as normal
                 build_strand_table_phase_1(pkey, op, idx, rv.m_pivsize, strand_count_idx,
                     aggcolsize, false, piv_ccols, piv_tcols, agg_ccols, agg_dcols, piv_scols,
                     agg_acols, agg_scount, spkey, insert_count, pivots_neq,
-                    rv.m_pivot_like_columns);
+                    rv.m_pivot_like_columns, rv.m_pivot_like_buckets);
+                push_running_phase_1(idx, op, false, pivots_neq);
 
                 if (op == OP_DELETE || !pivots_neq) {
                     continue;
@@ -414,7 +816,8 @@ t_stree::build_strand_table(const t_data_table& flattened, const t_data_table& d
 
                 build_strand_table_phase_2(pkey, idx, rv.m_pivsize, strand_count_idx,
                     aggcolsize, piv_pcols, agg_pcols, piv_scols, agg_acols, agg_scount, spkey,
-                    insert_count, rv.m_pivot_like_columns);
+                    insert_count, rv.m_pivot_like_columns, rv.m_pivot_like_buckets);
+                push_running(idx, false, true);
             }
         }
     } else {
@@ -428,7 +831,8 @@ t_stree::build_strand_table(const t_data_table& flattened, const t_data_table& d
             build_strand_table_phase_1(pkey, op, idx, rv.m_pivsize, strand_count_idx,
                 aggcolsize, false, piv_ccols, piv_tcols, agg_ccols, agg_dcols, piv_scols,
                 agg_acols, agg_scount, spkey, insert_count, pivots_neq,
-                rv.m_pivot_like_columns);
+                rv.m_pivot_like_columns, rv.m_pivot_like_buckets);
+            push_running_phase_1(idx, op, false, pivots_neq);
 
             if (op == OP_DELETE || !pivots_neq) {
                 continue;
@@ -436,7 +840,8 @@ t_stree::build_strand_table(const t_data_table& flattened, const t_data_table& d
 
             build_strand_table_phase_2(pkey, idx, rv.m_pivsize, strand_count_idx, aggcolsize,
                 piv_pcols, agg_pcols, piv_scols, agg_acols, agg_scount, spkey, insert_count,
-                rv.m_pivot_like_columns);
+                rv.m_pivot_like_columns, rv.m_pivot_like_buckets);
+            push_running(idx, false, true);
         }
     }
 
@@ -445,6 +850,19 @@ t_stree::build_strand_table(const t_data_table& flattened, const t_data_table& d
     aggs->reserve(insert_count);
     aggs->set_size(insert_count);
     agg_scount->valid_raw_fill();
+    for (auto& cols : running_cols) {
+        cols.m_nr->valid_raw_fill();
+        cols.m_dr->valid_raw_fill();
+    }
+    for (auto& cols : multiset_cols) {
+        cols.m_op->valid_raw_fill();
+    }
+    for (auto& cols : rolling_cols) {
+        for (t_column* col : {cols.m_add_t, cols.m_add_nr, cols.m_add_dr, cols.m_sub_t,
+                 cols.m_sub_nr, cols.m_sub_dr}) {
+            col->valid_raw_fill();
+        }
+    }
     return std::pair<std::shared_ptr<t_data_table>, std::shared_ptr<t_data_table>>(
         strands, aggs);
 }
@@ -457,6 +875,22 @@ t_stree::build_strand_table(const t_data_table& flattened,
     PSP_TRACE_SENTINEL();
     PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
 
+    t_mask msk;
+
+    if (config.has_filters()) {
+        msk = filter_table_for_config(flattened, config);
+    }
+
+    return build_strand_table(flattened, config.has_filters() ? &msk : nullptr, 0,
+        flattened.size(), aggspecs, config);
+}
+
+std::pair<std::shared_ptr<t_data_table>, std::shared_ptr<t_data_table>>
+t_stree::build_strand_table(const t_data_table& flattened, const t_mask* msk, t_uindex bidx,
+    t_uindex eidx, const std::vector<t_aggspec>& aggspecs, const t_config& config) const {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+
     auto rv = build_strand_table_common(flattened, aggspecs, config);
 
     // strand table
@@ -479,11 +913,11 @@ t_stree::build_strand_table(const t_data_table& flattened,
 
     for (t_uindex pidx = 0; pidx < npivotlike; ++pidx) {
         const std::string& piv = rv.m_strand_schema.m_columns[pidx];
-        piv_fcols[pidx] = flattened.get_const_column(piv).get();
+        piv_fcols[pidx] = flattened.get_const_column(rv.m_pivot_like_sources[pidx]).get();
         piv_scols[pidx] = strands->get_column(piv).get();
     }
 
-    t_uindex aggcolsize = rv.m_aggschema.m_columns.size();
+    t_uindex aggcolsize = rv.m_aggcolsize;
     std::vector<const t_column*> agg_fcols(aggcolsize);
     std::vector<t_column*> agg_acols(aggcolsize);
 
@@ -505,16 +939,12 @@ t_stree::build_strand_table(const t_data_table& flattened,
 
     t_column* spkey = strands->get_column("psp_pkey").get();
 
-    t_mask msk;
-
-    if (config.has_filters()) {
-        msk = filter_table_for_config(flattened, config);
-    }
-
-    bool has_filters = config.has_filters();
+    auto running_cols = get_running_agg_cols(rv, flattened, nullptr, nullptr, *aggs);
+    auto multiset_cols = get_multiset_agg_cols(rv, flattened, nullptr, nullptr, *aggs);
+    auto rolling_cols = get_rolling_agg_cols(rv, flattened, nullptr, nullptr, *aggs);
 
-    for (t_uindex idx = 0, loop_end = flattened.size(); idx < loop_end; ++idx) {
-        bool filter = !has_filters || msk.get(idx);
+    for (t_uindex idx = bidx; idx < eidx; ++idx) {
+        bool filter = !msk || msk->get(idx);
         t_tscalar pkey = pkey_col->get_scalar(idx);
         std::uint8_t op_ = *(op_col->get_nth<std::uint8_t>(idx));
         t_op op = static_cast<t_op>(op_);
@@ -526,7 +956,8 @@ t_stree::build_strand_table(const t_data_table& flattened,
 
         for (t_uindex pidx = 0, ploop_end = rv.m_pivot_like_columns.size(); pidx < ploop_end;
              ++pidx) {
-            piv_scols[pidx]->push_back(piv_fcols[pidx]->get_scalar(idx));
+            piv_scols[pidx]->push_back(
+                get_pivot_like_value(piv_fcols[pidx], idx, rv.m_pivot_like_buckets[pidx]));
         }
 
         for (t_uindex aggidx = 0; aggidx < aggcolsize; ++aggidx) {
@@ -535,6 +966,10 @@ t_stree::build_strand_table(const t_data_table& flattened,
             }
         }
 
+        build_strand_table_running(idx, true, false, running_cols);
+        build_strand_table_multiset(idx, true, false, multiset_cols);
+        build_strand_table_rolling(idx, true, false, rolling_cols);
+
         agg_scount->push_back<std::int8_t>(1);
         spkey->push_back(pkey);
         ++insert_count;
@@ -545,6 +980,19 @@ t_stree::build_strand_table(const t_data_table& flattened,
     aggs->reserve(insert_count);
     aggs->set_size(insert_count);
     agg_scount->valid_raw_fill();
+    for (auto& cols : running_cols) {
+        cols.m_nr->valid_raw_fill();
+        cols.m_dr->valid_raw_fill();
+    }
+    for (auto& cols : multiset_cols) {
+        cols.m_op->valid_raw_fill();
+    }
+    for (auto& cols : rolling_cols) {
+        for (t_column* col : {cols.m_add_t, cols.m_add_nr, cols.m_add_dr, cols.m_sub_t,
+                 cols.m_sub_nr, cols.m_sub_dr}) {
+            col->valid_raw_fill();
+        }
+    }
     return std::pair<std::shared_ptr<t_data_table>, std::shared_ptr<t_data_table>>(
         strands, aggs);
 }
@@ -606,6 +1054,7 @@ t_stree::update_shape_from_static(const t_dtree_ctx& ctx) {
     t_index root_nstrands = *(scount->get_nth<t_index>(0)) + root_node.m_nstrands;
     root_node.set_nstrands(root_nstrands);
     m_nodes->get<by_idx>().replace(root_iter, root_node);
+    m_nodestore.insert(root_node);
 
     t_tree_unify_rec unif_rec(0, 0, 0, root_nstrands);
     m_tree_unification_records.push_back(unif_rec);
@@ -631,15 +1080,15 @@ t_stree::update_shape_from_static(const t_dtree_ctx& ctx) {
 
         t_uindex src_ridx = dptidx;
 
-        auto iter = m_nodes->get<by_pidx_hash>().find(std::make_tuple(p_sptidx, value));
+        t_uindex cidx = m_nodestore.find_child(p_sptidx, value);
 
         auto nstrands = *(scount->get_nth<std::int64_t>(dptidx));
 
-        if (iter == m_nodes->get<by_pidx_hash>().end() && nstrands < 0) {
+        if (cidx == t_stnode_store::NOT_FOUND && nstrands < 0) {
             continue;
         }
 
-        if (iter == m_nodes->get<by_pidx_hash>().end()) {
+        if (cidx == t_stnode_store::NOT_FOUND) {
             // create node and enqueue
             sptidx = genidx();
             t_uindex aggsize = m_aggregates->size();
@@ -665,12 +1114,14 @@ t_stree::update_shape_from_static(const t_dtree_ctx& ctx) {
                 std::cout << "failed because of " << failed_because << std::endl;
             }
             PSP_VERBOSE_ASSERT(insert_pair.second, "Failed to insert node");
+            m_nodestore.insert(node);
             t_tree_unify_rec unif_rec(sptidx, src_ridx, dst_ridx, nstrands);
             m_tree_unification_records.push_back(unif_rec);
         } else {
-            sptidx = iter->m_idx;
+            sptidx = cidx;
 
             // update node
+            auto iter = m_nodes->get<by_idx>().find(sptidx);
             t_tnode node = *iter;
             node.set_sort_value(sortby_value);
 
@@ -681,10 +1132,10 @@ t_stree::update_shape_from_static(const t_dtree_ctx& ctx) {
             t_tree_unify_rec unif_rec(sptidx, src_ridx, dst_ridx, nstrands);
             m_tree_unification_records.push_back(unif_rec);
 
-            sptidx = iter->m_idx;
             node.set_nstrands(nstrands);
-            PSP_VERBOSE_ASSERT(m_nodes->get<by_pidx_hash>().replace(iter, node), ,
+            PSP_VERBOSE_ASSERT(m_nodes->get<by_idx>().replace(iter, node), ,
                 "Failed to replace"); // middle argument ignored
+            m_nodestore.insert(node);
         }
 
         populate_pkey_idx(ctx, dtree, dptidx, sptidx, ndepth, new_idx_pkey);
@@ -717,20 +1168,62 @@ t_stree::mark_zero_desc() {
         auto node = *iter;
         node.set_nstrands(0);
         m_nodes->get<by_idx>().replace(iter, node);
+        m_nodestore.insert(node);
     }
 }
 
 void
-t_stree::update_aggs_from_static(const t_dtree_ctx& ctx, const t_gstate& gstate) {
+t_stree::build_agg_update_info(const t_dtree_ctx& ctx, t_agg_update_info& agg_update_info) const {
     const t_data_table& src_aggtable = ctx.get_aggtable();
 
-    t_agg_update_info agg_update_info;
+    agg_update_info.m_dctx = &ctx;
     t_schema aggschema = m_aggregates->get_schema();
+    std::shared_ptr<const t_data_table> strand_deltas = ctx.get_strand_deltas();
 
     for (auto colname : aggschema.m_columns) {
         agg_update_info.m_src.push_back(src_aggtable.get_const_column(colname).get());
         agg_update_info.m_dst.push_back(m_aggregates->get_column(colname).get());
-        agg_update_info.m_aggspecs.push_back(ctx.get_aggspec(colname));
+        const t_aggspec& aggspec = ctx.get_aggspec(colname);
+        agg_update_info.m_aggspecs.push_back(aggspec);
+
+        if (aggspec.is_running_agg()) {
+            agg_update_info.m_src_running_nr.push_back(
+                src_aggtable.get_const_column(aggspec.get_running_nr_name()).get());
+            agg_update_info.m_src_running_dr.push_back(
+                src_aggtable.get_const_column(aggspec.get_running_dr_name()).get());
+        } else {
+            agg_update_info.m_src_running_nr.push_back(nullptr);
+            agg_update_info.m_src_running_dr.push_back(nullptr);
+        }
+
+        if (aggspec.is_multiset_agg() || aggspec.is_sketch_agg()) {
+            agg_update_info.m_src_multiset_add.push_back(
+                strand_deltas->get_const_column(aggspec.get_multiset_add_name()).get());
+            agg_update_info.m_src_multiset_sub.push_back(
+                strand_deltas->get_const_column(aggspec.get_multiset_sub_name()).get());
+            agg_update_info.m_src_multiset_op.push_back(
+                strand_deltas->get_const_column(aggspec.get_multiset_op_name()).get());
+        } else {
+            agg_update_info.m_src_multiset_add.push_back(nullptr);
+            agg_update_info.m_src_multiset_sub.push_back(nullptr);
+            agg_update_info.m_src_multiset_op.push_back(nullptr);
+        }
+
+        t_rolling_agg_src rolling{nullptr, nullptr, nullptr, nullptr, nullptr, nullptr};
+        if (aggspec.is_rolling_agg()) {
+            auto get_col = [&strand_deltas, &aggspec](const char* field) {
+                return strand_deltas->get_const_column(aggspec.get_rolling_name(field)).get();
+            };
+
+            rolling.m_add_t = get_col("add_t");
+            rolling.m_add_nr = get_col("add_nr");
+            rolling.m_add_dr = get_col("add_dr");
+            rolling.m_sub_t = get_col("sub_t");
+            rolling.m_sub_nr = get_col("sub_nr");
+            rolling.m_sub_dr = get_col("sub_dr");
+        }
+        agg_update_info.m_src_rolling.push_back(rolling);
+        agg_update_info.m_reducer_nodes.emplace_back();
     }
 
     auto is_col_scaled_aggregate = [&](int col_idx) -> bool {
@@ -780,80 +1273,599 @@ t_stree::update_aggs_from_static(const t_dtree_ctx& ctx, const t_gstate& gstate)
             push_column(i);
         }
     }
+}
 
-    for (const auto& r : m_tree_unification_records) {
-        if (!node_exists(r.m_sptidx)) {
+void
+t_stree::update_aggs_from_static(const t_dtree_ctx& ctx, const t_gstate& gstate) {
+    t_agg_update_info agg_update_info;
+    build_agg_update_info(ctx, agg_update_info);
+
+    std::vector<double> prev_now = m_rolling_now;
+    update_rolling_now(agg_update_info);
+
+    // The records are ordered parents first, so are walked backwards for
+    // each node's children to be updated before it.
+    agg_update_info.m_children_first = true;
+    for (auto iter = m_tree_unification_records.rbegin();
+         iter != m_tree_unification_records.rend(); ++iter) {
+        const t_tree_unify_rec& r = *iter;
+        if (!node_exists(r.m_sptidx) || !is_aggregated(r.m_sptidx)) {
             continue;
         }
 
-        update_agg_table(
-            r.m_sptidx, agg_update_info, r.m_daggidx, r.m_saggidx, r.m_nstrands, gstate);
+        // Nodes whose aggregates are unchanged need not be re-sorted or
+        // re-read.
+        if (update_agg_table(
+                r.m_sptidx, agg_update_info, r.m_daggidx, r.m_saggidx, r.m_nstrands, gstate)) {
+            m_updated.insert(r.m_sptidx);
+        }
+    }
+
+    expire_windows(agg_update_info, prev_now);
+    update_reducers(agg_update_info, gstate);
+
+    double ratio = t_env::agg_relayout_ratio();
+    if (ratio > 0 && m_cur_aggidx >= PSP_AGG_RELAYOUT_MIN_ROWS
+        && static_cast<double>(m_agg_churn) >= ratio * double(m_cur_aggidx)) {
+        relayout_aggregates();
     }
 }
 
+void
+t_stree::set_lazy_depth(t_depth depth) {
+    if (depth == m_lazy_depth) {
+        return;
+    }
+
+    m_lazy_depth = depth;
+    m_open.clear();
+}
+
+t_depth
+t_stree::get_lazy_depth() const {
+    return m_lazy_depth;
+}
+
+bool
+t_stree::is_aggregated(t_uindex nidx) const {
+    if (m_lazy_depth == LAZY_DEPTH_NONE || m_nodestore.get_depth(nidx) <= m_lazy_depth) {
+        return true;
+    }
+
+    return m_open.find(m_nodestore.get_pidx(nidx)) != m_open.end();
+}
+
+void
+t_stree::materialize(t_depth depth, const t_gstate& gstate, const t_config& config) {
+    if (depth <= m_lazy_depth) {
+        return;
+    }
+
+    materialize_below(0, std::min<t_depth>(depth, last_level()), gstate, config);
+}
+
+void
+t_stree::materialize_children(
+    t_uindex nidx, const t_gstate& gstate, const t_config& config) {
+    if (m_lazy_depth == LAZY_DEPTH_NONE || m_open.find(nidx) != m_open.end()) {
+        return;
+    }
+
+    t_depth depth = m_nodestore.get_depth(nidx) + 1;
+    if (depth > m_lazy_depth && depth <= last_level()) {
+        materialize_below(nidx, depth, gstate, config);
+    }
+
+    m_open.insert(nidx);
+}
+
+void
+t_stree::reclaim(t_depth depth, const std::set<t_uindex>& open) {
+    m_lazy_depth = depth;
+    m_open = open;
+
+    std::vector<t_uindex> stale;
+    for (const t_stnode& node : *m_nodes) {
+        if (!is_aggregated(node.m_idx)) {
+            stale.push_back(node.m_aggidx);
+        }
+    }
+
+    reset_aggregates(stale);
+}
+
+// Rebuilds the rows under `nidx` as a dense tree pivoted down to `depth`,
+// and applies each of its nodes to the matching stale node of this tree as
+// if that node were new.
+void
+t_stree::materialize_below(
+    t_uindex nidx, t_depth depth, const t_gstate& gstate, const t_config& config) {
+    auto pkeys = get_pkeys(nidx);
+    if (pkeys.empty()) {
+        return;
+    }
+
+    std::shared_ptr<t_data_table> flattened(gstate._get_pkeyed_table(pkeys));
+    auto strand_values = build_strand_table(*flattened, m_aggspecs, config);
+    auto strands = strand_values.first;
+    auto strand_deltas = strand_values.second;
+
+    t_dtree dtree(strands, m_pivots, config.get_sortby_pairs());
+    dtree.init();
+
+    t_filter filter;
+    dtree.check_pivot(filter, depth + 1);
+
+    t_dtree_ctx dctx(strands, strand_deltas, dtree, m_aggspecs);
+    dctx.init();
+
+    t_agg_update_info agg_update_info;
+    build_agg_update_info(dctx, agg_update_info);
+
+    // The stale values are not meaningful, so don't report deltas from
+    // them.
+    bool deltas_enabled = m_features[CTX_FEAT_DELTA];
+    bool has_delta = m_has_delta;
+    m_features[CTX_FEAT_DELTA] = false;
+
+    t_depth min_depth = m_nodestore.get_depth(nidx);
+
+    // map dptidx to sptidx
+    std::map<t_uindex, t_uindex> nmap;
+    nmap[0] = 0;
+
+    for (auto dptidx : dtree.dfs()) {
+        if (dptidx == 0) {
+            continue;
+        }
+
+        t_uindex p_sptidx = nmap[dtree.get_parent(dptidx)];
+        t_uindex sptidx = t_stnode_store::NOT_FOUND;
+
+        if (p_sptidx != t_stnode_store::NOT_FOUND) {
+            t_tscalar value = m_symtable.get_interned_tscalar(dtree.get_value(filter, dptidx));
+            sptidx = m_nodestore.find_child(p_sptidx, value);
+        }
+
+        nmap[dptidx] = sptidx;
+
+        if (sptidx == t_stnode_store::NOT_FOUND || dtree.get_depth(dptidx) <= min_depth
+            || is_aggregated(sptidx)) {
+            continue;
+        }
+
+        t_uindex aggidx = m_nodestore.get_aggidx(sptidx);
+        reset_aggregates(std::vector<t_uindex>{aggidx});
+        update_agg_table(sptidx, agg_update_info, dptidx, aggidx,
+            m_nodestore.get_nstrands(sptidx), gstate);
+        m_updated.insert(sptidx);
+    }
+
+    update_reducers(agg_update_info, gstate);
+
+    m_features[CTX_FEAT_DELTA] = deltas_enabled;
+    m_has_delta = has_delta;
+}
+
 t_uindex
 t_stree::genidx() {
     return m_curidx++;
 }
 
-std::vector<t_uindex>
-t_stree::get_children(t_uindex idx) const {
-    t_by_pidx_ipair iterators = m_nodes->get<by_pidx>().equal_range(idx);
+std::vector<t_uindex>
+t_stree::get_children(t_uindex idx) const {
+    t_by_pidx_ipair iterators = m_nodes->get<by_pidx>().equal_range(idx);
+
+    t_uindex nchild = std::distance(iterators.first, iterators.second);
+
+    std::vector<t_uindex> temp(nchild);
+
+    t_index count = 0;
+    for (iter_by_pidx iter = iterators.first; iter != iterators.second; ++iter) {
+        temp[count] = iter->m_idx;
+        ++count;
+    }
+    return temp;
+}
+
+t_uindex
+t_stree::size() const {
+    return m_nodes->size();
+}
+
+std::vector<t_uindex>
+t_stree::get_num_nodes_by_depth() const {
+    std::vector<t_uindex> rv(last_level() + 1, 0);
+    for (const auto& node : *m_nodes) {
+        if (node.m_depth < rv.size()) {
+            ++rv[node.m_depth];
+        }
+    }
+    return rv;
+}
+
+t_uindex
+t_stree::nbytes() const {
+    // A boost::multi_index_container node carries a parent, two children and
+    // a colour per ordered index, and a link per hashed index plus a bucket.
+    const t_uindex ordered_nbytes = 4 * sizeof(void*);
+    const t_uindex hashed_nbytes = 2 * sizeof(void*);
+
+    t_uindex rv = m_nodes->size() * (sizeof(t_stnode) + 2 * ordered_nbytes + 2 * hashed_nbytes);
+    rv += m_idxpkey->size() * (sizeof(t_stpkey) + ordered_nbytes);
+    rv += m_idxleaf->size() * (sizeof(t_stleaves) + ordered_nbytes);
+    rv += m_nodestore.nbytes();
+    rv += m_agg_freelist.capacity() * sizeof(t_uindex);
+    rv += m_symtable.nbytes();
+    for (const auto& multisets : m_multisets) {
+        for (const auto& kv : multisets) {
+            rv += sizeof(kv.first) + kv.second.nbytes();
+        }
+    }
+    for (const auto& sketches : m_sketches) {
+        for (const auto& kv : sketches) {
+            rv += sizeof(kv) + kv.second.nbytes();
+        }
+    }
+    for (const auto& digests : m_digests) {
+        for (const auto& kv : digests) {
+            rv += sizeof(kv) + kv.second.nbytes();
+        }
+    }
+    for (const auto& windows : m_windows) {
+        for (const auto& kv : windows) {
+            rv += sizeof(kv) + kv.second.nbytes();
+        }
+    }
+    return rv;
+}
+
+void
+t_stree::get_child_nodes(t_uindex idx, t_tnodevec& nodes) const {
+    t_index num_children = get_num_children(idx);
+    t_tnodevec temp(num_children);
+    auto iterators = m_nodes->get<by_pidx>().equal_range(idx);
+    std::copy(iterators.first, iterators.second, temp.begin());
+    std::swap(nodes, temp);
+}
+
+t_uindex
+t_stree::get_num_children(t_uindex ptidx) const {
+    auto iterators = m_nodes->get<by_pidx>().equal_range(ptidx);
+    return std::distance(iterators.first, iterators.second);
+}
+
+t_uindex
+t_stree::gen_aggidx() {
+    ++m_agg_churn;
+    if (!m_agg_freelist.empty()) {
+        t_uindex rval = m_agg_freelist.back();
+        m_agg_freelist.pop_back();
+        return rval;
+    }
+
+    t_uindex cur_cap = m_aggregates->size();
+    t_uindex rval = m_cur_aggidx;
+    ++m_cur_aggidx;
+    if (rval >= cur_cap) {
+        double nrows = ceil(.3 * double(rval));
+        m_aggregates->extend(static_cast<t_uindex>(nrows));
+    }
+
+    return rval;
+}
+
+// Applies the values added and removed by the strands under dtree node
+// `src_ridx` to the multiset of aggregate `idx` at row `dst_ridx`.
+t_value_multiset&
+t_stree::update_multiset(
+    const t_agg_update_info& info, t_uindex idx, t_uindex src_ridx, t_uindex dst_ridx) {
+    t_value_multiset& values = m_multisets[idx][dst_ridx];
+
+    const t_column* add_col = info.m_src_multiset_add[idx];
+    const t_column* sub_col = info.m_src_multiset_sub[idx];
+    const t_column* op_col = info.m_src_multiset_op[idx];
+    t_dtype dtype = add_col->get_dtype();
+
+    auto read_value = [this, dtype](const t_column* col, t_uindex lfidx) {
+        if (!col->is_valid(lfidx)) {
+            return mknull(dtype);
+        }
+        return m_symtable.get_interned_tscalar(col->get_scalar(lfidx));
+    };
+
+    auto liters = info.m_dctx->get_leaf_iterators(src_ridx);
+    for (auto lfiter = liters.first; lfiter != liters.second; ++lfiter) {
+        t_uindex lfidx = *lfiter;
+        std::int8_t op = *(op_col->get_nth<std::int8_t>(lfidx));
+
+        if (op & MULTISET_OP_SUB) {
+            values.erase(read_value(sub_col, lfidx));
+        }
+
+        if (op & MULTISET_OP_ADD) {
+            values.insert(read_value(add_col, lfidx));
+        }
+    }
+
+    return values;
+}
+
+// Adds the values added by the strands under dtree node `src_ridx` to the
+// sketch of aggregate `idx` at row `dst_ridx`. A sketch cannot forget a
+// value, so removed values are only counted, and once they are more than
+// half of the values inserted the sketch is rebuilt from the rows of node
+// `nidx` in the master table.
+t_hll_sketch&
+t_stree::update_sketch(const t_agg_update_info& info, t_uindex idx, t_uindex src_ridx,
+    t_uindex dst_ridx, t_uindex nidx, const t_gstate& gstate) {
+    t_hll_sketch& sketch = m_sketches[idx][dst_ridx];
+
+    const t_column* add_col = info.m_src_multiset_add[idx];
+    const t_column* sub_col = info.m_src_multiset_sub[idx];
+    const t_column* op_col = info.m_src_multiset_op[idx];
+    t_dtype dtype = add_col->get_dtype();
+
+    auto read_value = [this, dtype](const t_column* col, t_uindex lfidx) {
+        if (!col->is_valid(lfidx)) {
+            return mknull(dtype);
+        }
+        return m_symtable.get_interned_tscalar(col->get_scalar(lfidx));
+    };
+
+    auto liters = info.m_dctx->get_leaf_iterators(src_ridx);
+    for (auto lfiter = liters.first; lfiter != liters.second; ++lfiter) {
+        t_uindex lfidx = *lfiter;
+        std::int8_t op = *(op_col->get_nth<std::int8_t>(lfidx));
+
+        if (op & MULTISET_OP_ADD) {
+            t_tscalar value = read_value(add_col, lfidx);
+            // An update which rewrites a row's value leaves the sketch as it
+            // was.
+            if ((op & MULTISET_OP_SUB) && read_value(sub_col, lfidx) == value) {
+                continue;
+            }
+            sketch.insert(value);
+        }
+
+        if (op & MULTISET_OP_SUB) {
+            sketch.remove();
+        }
+    }
+
+    if (sketch.needs_rebuild()) {
+        sketch.clear();
+        std::vector<t_tscalar> values;
+        gstate.read_column(
+            info.m_aggspecs[idx].get_first_depname(), get_pkeys(nidx), values);
+        for (const auto& value : values) {
+            sketch.insert(value);
+        }
+    }
+
+    return sketch;
+}
+
+// Applies the values added and removed by the strands under dtree node
+// `src_ridx` to the digest of aggregate `idx` at row `dst_ridx`, rebuilding
+// it from the rows of node `nidx` in the master table once its removals
+// have blurred it.
+t_tdigest&
+t_stree::update_digest(const t_agg_update_info& info, t_uindex idx, t_uindex src_ridx,
+    t_uindex dst_ridx, t_uindex nidx, const t_gstate& gstate) {
+    t_tdigest& digest = m_digests[idx][dst_ridx];
+
+    const t_column* add_col = info.m_src_multiset_add[idx];
+    const t_column* sub_col = info.m_src_multiset_sub[idx];
+    const t_column* op_col = info.m_src_multiset_op[idx];
+
+    auto liters = info.m_dctx->get_leaf_iterators(src_ridx);
+    for (auto lfiter = liters.first; lfiter != liters.second; ++lfiter) {
+        t_uindex lfidx = *lfiter;
+        std::int8_t op = *(op_col->get_nth<std::int8_t>(lfidx));
+
+        if ((op & MULTISET_OP_SUB) && sub_col->is_valid(lfidx)) {
+            digest.remove(sub_col->get_scalar(lfidx).to_double());
+        }
+
+        if ((op & MULTISET_OP_ADD) && add_col->is_valid(lfidx)) {
+            digest.insert(add_col->get_scalar(lfidx).to_double());
+        }
+    }
+
+    if (digest.needs_rebuild()) {
+        digest.clear();
+        std::vector<t_tscalar> values;
+        gstate.read_column(
+            info.m_aggspecs[idx].get_first_depname(), get_pkeys(nidx), values);
+        for (const auto& value : values) {
+            if (value.is_valid()) {
+                digest.insert(value.to_double());
+            }
+        }
+    }
+
+    return digest;
+}
+
+// Applies the times and partial sums added and removed by the strands under
+// dtree node `src_ridx` to the window of aggregate `idx` at row `dst_ridx`.
+void
+t_stree::update_window(
+    const t_agg_update_info& info, t_uindex idx, t_uindex src_ridx, t_uindex dst_ridx) {
+    t_rolling_window& window = m_windows[idx][dst_ridx];
+    const t_rolling_agg_src& src = info.m_src_rolling[idx];
+    double length = info.m_aggspecs[idx].get_window();
+
+    auto liters = info.m_dctx->get_leaf_iterators(src_ridx);
+    for (auto lfiter = liters.first; lfiter != liters.second; ++lfiter) {
+        t_uindex lfidx = *lfiter;
+
+        double sub_t = *(src.m_sub_t->get_nth<double>(lfidx));
+        if (!std::isnan(sub_t)) {
+            window.remove(t_rolling_window::get_bucket(sub_t, length),
+                *(src.m_sub_nr->get_nth<double>(lfidx)),
+                *(src.m_sub_dr->get_nth<double>(lfidx)));
+        }
+
+        double add_t = *(src.m_add_t->get_nth<double>(lfidx));
+        if (!std::isnan(add_t)) {
+            window.insert(t_rolling_window::get_bucket(add_t, length),
+                *(src.m_add_nr->get_nth<double>(lfidx)),
+                *(src.m_add_dr->get_nth<double>(lfidx)));
+        }
+    }
+}
+
+// Returns the value of rolling aggregate `idx` at row `dst_ridx` over the
+// window ending at the latest time seen.
+t_tscalar
+t_stree::get_rolling_value(const t_aggspec& spec, t_uindex idx, t_uindex dst_ridx) const {
+    std::pair<double, double> sums(0, 0);
+    auto iter = m_windows[idx].find(dst_ridx);
+    if (iter != m_windows[idx].end() && !std::isinf(m_rolling_now[idx])) {
+        sums = iter->second.get(
+            t_rolling_window::get_bucket(m_rolling_now[idx], spec.get_window()));
+    }
+
+    t_tscalar rval;
+    switch (spec.agg()) {
+        case AGGTYPE_ROLLING_SUM: {
+            rval.set(sums.first);
+        } break;
+        case AGGTYPE_ROLLING_COUNT: {
+            rval.set(static_cast<std::int64_t>(std::llround(sums.second)));
+        } break;
+        default: {
+            if (sums.second == 0) {
+                return mknull(DTYPE_FLOAT64);
+            }
+            rval.set(sums.first / sums.second);
+        } break;
+    }
+
+    return rval;
+}
+
+// Advances the latest time seen by each rolling aggregate to the latest time
+// added by the strand deltas.
+void
+t_stree::update_rolling_now(const t_agg_update_info& info) {
+    for (t_uindex idx = 0, loop_end = info.m_aggspecs.size(); idx < loop_end; ++idx) {
+        const t_column* add_t = info.m_src_rolling[idx].m_add_t;
+        if (!add_t) {
+            continue;
+        }
+
+        double now = m_rolling_now[idx];
+        for (t_uindex ridx = 0, nrows = add_t->size(); ridx < nrows; ++ridx) {
+            // NaN compares false, so rows which add nothing are skipped.
+            double t = *(add_t->get_nth<double>(ridx));
+            if (t > now) {
+                now = t;
+            }
+        }
+
+        m_rolling_now[idx] = now;
+    }
+}
+
+// Re-reads the rolling aggregates of every aggregated node whose window has
+// moved on to a later bucket since `prev_now`, as rows expire from the
+// windows of nodes which were not themselves updated.
+void
+t_stree::expire_windows(const t_agg_update_info& info, const std::vector<double>& prev_now) {
+    bool deltas_enabled = m_features.at(CTX_FEAT_DELTA);
+
+    for (t_uindex idx = 0, loop_end = info.m_aggspecs.size(); idx < loop_end; ++idx) {
+        const t_aggspec& spec = info.m_aggspecs[idx];
+        if (!spec.is_rolling_agg() || m_windows[idx].empty() || std::isinf(prev_now[idx])
+            || t_rolling_window::get_bucket(prev_now[idx], spec.get_window())
+                == t_rolling_window::get_bucket(m_rolling_now[idx], spec.get_window())) {
+            continue;
+        }
 
-    t_uindex nchild = std::distance(iterators.first, iterators.second);
+        t_column* dst = info.m_dst[idx];
+        for (const auto& node : m_nodes->get<by_idx>()) {
+            if (m_windows[idx].find(node.m_aggidx) == m_windows[idx].end()
+                || !is_aggregated(node.m_idx)) {
+                continue;
+            }
 
-    std::vector<t_uindex> temp(nchild);
+            t_tscalar old_value = dst->get_scalar(node.m_aggidx);
+            t_tscalar new_value = get_rolling_value(spec, idx, node.m_aggidx);
+            dst->set_scalar(node.m_aggidx, new_value);
+            new_value = dst->get_scalar(node.m_aggidx);
+            if (old_value == new_value) {
+                continue;
+            }
 
-    t_index count = 0;
-    for (iter_by_pidx iter = iterators.first; iter != iterators.second; ++iter) {
-        temp[count] = iter->m_idx;
-        ++count;
+            m_has_delta = true;
+            m_updated.insert(node.m_idx);
+            if (deltas_enabled) {
+                m_deltas->insert(t_tcdelta(node.m_idx, idx, old_value, new_value));
+            }
+        }
     }
-    return temp;
-}
-
-t_uindex
-t_stree::size() const {
-    return m_nodes->size();
 }
 
 void
-t_stree::get_child_nodes(t_uindex idx, t_tnodevec& nodes) const {
-    t_index num_children = get_num_children(idx);
-    t_tnodevec temp(num_children);
-    auto iterators = m_nodes->get<by_pidx>().equal_range(idx);
-    std::copy(iterators.first, iterators.second, temp.begin());
-    std::swap(nodes, temp);
-}
+t_stree::update_reducers(t_agg_update_info& info, const t_gstate& gstate) {
+    bool deltas_enabled = m_features.at(CTX_FEAT_DELTA);
 
-t_uindex
-t_stree::get_num_children(t_uindex ptidx) const {
-    auto iterators = m_nodes->get<by_pidx>().equal_range(ptidx);
-    return std::distance(iterators.first, iterators.second);
-}
+    for (t_uindex idx = 0, loop_end = info.m_aggspecs.size(); idx < loop_end; ++idx) {
+        std::vector<std::pair<t_uindex, t_uindex>>& nodes = info.m_reducer_nodes[idx];
+        const t_aggspec& spec = info.m_aggspecs[idx];
+        if (nodes.empty() || spec.get_kernel().empty()) {
+            continue;
+        }
 
-t_uindex
-t_stree::gen_aggidx() {
-    if (!m_agg_freelist.empty()) {
-        t_uindex rval = m_agg_freelist.back();
-        m_agg_freelist.pop_back();
-        return rval;
-    }
+        // The leaf values of every node, end to end, and the offset at which
+        // each node's values begin.
+        std::vector<double> values;
+        std::vector<t_uindex> offsets;
+        offsets.reserve(nodes.size() + 1);
+        offsets.push_back(0);
+        std::vector<double> node_values;
+        for (const auto& node : nodes) {
+            gstate.read_column(spec.get_first_depname(), get_pkeys(node.first), node_values);
+            values.insert(values.end(), node_values.begin(), node_values.end());
+            offsets.push_back(values.size());
+        }
 
-    t_uindex cur_cap = m_aggregates->size();
-    t_uindex rval = m_cur_aggidx;
-    ++m_cur_aggidx;
-    if (rval >= cur_cap) {
-        double nrows = ceil(.3 * double(rval));
-        m_aggregates->extend(static_cast<t_uindex>(nrows));
-    }
+        std::vector<double> out(nodes.size(), std::numeric_limits<double>::quiet_NaN());
+        t_udf_reducer reducer = get_evaluator()->get_reducer(spec.get_kernel());
+        reducer(values.data(), offsets.data(), nodes.size(), out.data());
 
-    return rval;
+        t_column* dst = info.m_dst[idx];
+        for (t_uindex nodeidx = 0, nodes_end = nodes.size(); nodeidx < nodes_end; ++nodeidx) {
+            t_uindex nidx = nodes[nodeidx].first;
+            t_uindex ridx = nodes[nodeidx].second;
+            t_tscalar old_value = dst->get_scalar(ridx);
+            t_tscalar new_value = mknone();
+            if (!std::isnan(out[nodeidx])) {
+                new_value.set(out[nodeidx]);
+            }
+            dst->set_scalar(ridx, new_value);
+            if (old_value == new_value) {
+                continue;
+            }
+
+            m_has_delta = true;
+            m_updated.insert(nidx);
+            if (deltas_enabled) {
+                m_deltas->insert(t_tcdelta(nidx, idx, old_value, new_value));
+            }
+        }
+
+        nodes.clear();
+    }
 }
 
-void
+bool
 t_stree::update_agg_table(t_uindex nidx, t_agg_update_info& info, t_uindex src_ridx,
     t_uindex dst_ridx, t_index nstrands, const t_gstate& gstate) {
+    bool changed = false;
     for (t_uindex idx : info.m_dst_topo_sorted) {
         const t_column* src = info.m_src[idx];
         t_column* dst = info.m_dst[idx];
@@ -889,67 +1901,49 @@ t_stree::update_agg_table(t_uindex nidx, t_agg_update_info& info, t_uindex src_r
 
                 dst->set_scalar(dst_ridx, new_value);
             } break;
-            case AGGTYPE_MEAN: {
-                auto pkeys = get_pkeys(nidx);
-                std::vector<double> values;
-
-                gstate.read_column(spec.get_dependencies()[0].name(), pkeys, values, false);
-
-                auto nr = std::accumulate(values.begin(), values.end(), double(0));
-                double dr = values.size();
+            case AGGTYPE_MEAN:
+            case AGGTYPE_WEIGHTED_MEAN: {
+                // Numerator and denominator change by the sums of the
+                // running columns over this node's strands.
+                const t_column* src_nr = info.m_src_running_nr[idx];
+                const t_column* src_dr = info.m_src_running_dr[idx];
 
                 std::pair<double, double>* dst_pair
                     = dst->get_nth<std::pair<double, double>>(dst_ridx);
 
-                old_value.set(dst_pair->first / dst_pair->second);
-
-                dst_pair->first = nr;
-                dst_pair->second = dr;
-
-                dst->set_valid(dst_ridx, true);
-
-                new_value.set(nr / dr);
-            } break;
-            case AGGTYPE_WEIGHTED_MEAN: {
-                auto pkeys = get_pkeys(nidx);
-
-                double nr = 0;
-                double dr = 0;
-                std::vector<t_tscalar> values;
-                std::vector<t_tscalar> weights;
-
-                gstate.read_column(spec.get_dependencies()[0].name(), pkeys, values);
-                gstate.read_column(spec.get_dependencies()[1].name(), pkeys, weights);
-
-                auto weights_it = weights.begin();
-                auto values_it = values.begin();
-
-                for (; weights_it != weights.end() && values_it != values.end();
-                     ++weights_it, ++values_it) {
-                    if (weights_it->is_valid() && values_it->is_valid() && !weights_it->is_nan()
-                        && !values_it->is_nan()) {
-                        nr += weights_it->to_double() * values_it->to_double();
-                        dr += weights_it->to_double();
-                    }
+                // A weighted mean with no weight left is also invalid, but
+                // keeps its numerator, which weights of mixed sign need.
+                if (!dst->is_valid(dst_ridx)
+                    && (spec.agg() == AGGTYPE_MEAN || m_newids.count(nidx) > 0)) {
+                    // new node, or an aggregate row recycled from the
+                    // freelist
+                    dst_pair->first = 0;
+                    dst_pair->second = 0;
                 }
 
-                std::pair<double, double>* dst_pair
-                    = dst->get_nth<std::pair<double, double>>(dst_ridx);
                 old_value.set(dst_pair->first / dst_pair->second);
 
-                dst_pair->first = nr;
-                dst_pair->second = dr;
+                dst_pair->first += *(src_nr->get_nth<double>(src_ridx));
+                dst_pair->second += *(src_dr->get_nth<double>(src_ridx));
+
+                if (spec.agg() == AGGTYPE_MEAN && dst_pair->second == 0) {
+                    // drop accumulated rounding error once the node
+                    // has no values left
+                    dst_pair->first = 0;
+                }
 
-                bool valid = (dr != 0);
-                dst->set_valid(dst_ridx, valid);
-                new_value.set(nr / dr);
+                if (spec.agg() == AGGTYPE_WEIGHTED_MEAN) {
+                    dst->set_valid(dst_ridx, dst_pair->second != 0);
+                } else {
+                    dst->set_valid(dst_ridx, true);
+                }
+                new_value.set(dst_pair->first / dst_pair->second);
             } break;
             case AGGTYPE_UNIQUE: {
-                auto pkeys = get_pkeys(nidx);
                 old_value.set(dst->get_scalar(dst_ridx));
 
                 bool is_unique
-                    = gstate.is_unique(pkeys, spec.get_dependencies()[0].name(), new_value);
+                    = update_multiset(info, idx, src_ridx, dst_ridx).unique(new_value);
 
                 if (new_value.m_type == DTYPE_STR) {
                     if (is_unique) {
@@ -970,39 +1964,34 @@ t_stree::update_agg_table(t_uindex nidx, t_agg_update_info& info, t_uindex src_r
             case AGGTYPE_OR:
             case AGGTYPE_ANY: {
                 old_value.set(dst->get_scalar(dst_ridx));
-                auto pkeys = get_pkeys(nidx);
-                gstate.apply(pkeys, spec.get_dependencies()[0].name(), new_value,
-                    [](const t_tscalar& row_value, t_tscalar& output) {
-                        if (row_value) {
-                            output.set(row_value);
-                            return true;
-                        }
-                        return false;
-                    });
+                if (!info.m_children_first
+                    || !roll_up_children(nidx, spec.agg(), dst, new_value)) {
+                    auto pkeys = get_pkeys(nidx);
+                    gstate.apply(pkeys, spec.get_dependencies()[0].name(), new_value,
+                        [](const t_tscalar& row_value, t_tscalar& output) {
+                            if (row_value) {
+                                output.set(row_value);
+                                return true;
+                            }
+                            return false;
+                        });
+                }
 
                 dst->set_scalar(dst_ridx, new_value);
             } break;
             case AGGTYPE_MEDIAN: {
                 old_value.set(dst->get_scalar(dst_ridx));
-                auto pkeys = get_pkeys(nidx);
-
-                new_value.set(
-                    gstate.reduce<std::function<t_tscalar(std::vector<t_tscalar>&)>>(pkeys,
-                        spec.get_dependencies()[0].name(), [](std::vector<t_tscalar>& values) {
-                            if (values.size() == 0) {
-                                return t_tscalar();
-                            } else if (values.size() == 1) {
-                                return values[0];
-                            } else {
-                                std::vector<t_tscalar>::iterator middle
-                                    = values.begin() + (values.size() / 2);
-
-                                std::nth_element(values.begin(), middle, values.end());
-
-                                return *middle;
-                            }
-                        }));
-
+                new_value.set(update_multiset(info, idx, src_ridx, dst_ridx).median());
+                dst->set_scalar(dst_ridx, new_value);
+            } break;
+            case AGGTYPE_MIN: {
+                old_value.set(dst->get_scalar(dst_ridx));
+                new_value.set(update_multiset(info, idx, src_ridx, dst_ridx).min());
+                dst->set_scalar(dst_ridx, new_value);
+            } break;
+            case AGGTYPE_MAX: {
+                old_value.set(dst->get_scalar(dst_ridx));
+                new_value.set(update_multiset(info, idx, src_ridx, dst_ridx).max());
                 dst->set_scalar(dst_ridx, new_value);
             } break;
             case AGGTYPE_JOIN: {
@@ -1074,12 +2063,7 @@ t_stree::update_agg_table(t_uindex nidx, t_agg_update_info& info, t_uindex src_r
             } break;
             case AGGTYPE_DOMINANT: {
                 old_value.set(dst->get_scalar(dst_ridx));
-                auto pkeys = get_pkeys(nidx);
-
-                new_value.set(gstate.reduce<std::function<t_tscalar(std::vector<t_tscalar>&)>>(
-                    pkeys, spec.get_dependencies()[0].name(),
-                    [](std::vector<t_tscalar>& values) { return get_dominant(values); }));
-
+                new_value.set(update_multiset(info, idx, src_ridx, dst_ridx).dominant());
                 dst->set_scalar(dst_ridx, new_value);
             } break;
             case AGGTYPE_FIRST:
@@ -1090,22 +2074,26 @@ t_stree::update_agg_table(t_uindex nidx, t_agg_update_info& info, t_uindex src_r
             } break;
             case AGGTYPE_AND: {
                 old_value.set(dst->get_scalar(dst_ridx));
-                auto pkeys = get_pkeys(nidx);
-
-                new_value.set(
-                    gstate.reduce<std::function<t_tscalar(std::vector<t_tscalar>&)>>(pkeys,
-                        spec.get_dependencies()[0].name(), [](std::vector<t_tscalar>& values) {
-                            t_tscalar rval;
-                            rval.set(true);
+                if (!info.m_children_first
+                    || !roll_up_children(nidx, spec.agg(), dst, new_value)) {
+                    auto pkeys = get_pkeys(nidx);
 
-                            for (const auto& v : values) {
-                                if (!v) {
-                                    rval.set(false);
-                                    break;
+                    new_value.set(
+                        gstate.reduce<std::function<t_tscalar(std::vector<t_tscalar>&)>>(pkeys,
+                            spec.get_dependencies()[0].name(),
+                            [](std::vector<t_tscalar>& values) {
+                                t_tscalar rval;
+                                rval.set(true);
+
+                                for (const auto& v : values) {
+                                    if (!v) {
+                                        rval.set(false);
+                                        break;
+                                    }
                                 }
-                            }
-                            return rval;
-                        }));
+                                return rval;
+                            }));
+                }
                 dst->set_scalar(dst_ridx, new_value);
             } break;
             case AGGTYPE_LAST_VALUE: {
@@ -1142,10 +2130,14 @@ t_stree::update_agg_table(t_uindex nidx, t_agg_update_info& info, t_uindex src_r
                 }
                 dst->set_scalar(dst_ridx, new_value);
             } break;
-            case AGGTYPE_UDF_COMBINER:
-            case AGGTYPE_UDF_REDUCER: {
+            case AGGTYPE_UDF_COMBINER: {
                 // these will be filled in later
             } break;
+            case AGGTYPE_UDF_REDUCER: {
+                // Reduced in one call for all of the updated nodes by
+                // `update_reducers`.
+                info.m_reducer_nodes[idx].push_back(std::make_pair(nidx, dst_ridx));
+            } break;
             case AGGTYPE_SUM_NOT_NULL: {
                 old_value.set(dst->get_scalar(dst_ridx));
                 auto pkeys = get_pkeys(nidx);
@@ -1225,19 +2217,35 @@ t_stree::update_agg_table(t_uindex nidx, t_agg_update_info& info, t_uindex src_r
             } break;
             case AGGTYPE_DISTINCT_COUNT: {
                 old_value.set(dst->get_scalar(dst_ridx));
-                auto pkeys = get_pkeys(nidx);
-
-                new_value.set(
-                    gstate.reduce<std::function<std::uint32_t(std::vector<t_tscalar>&)>>(pkeys,
-                        spec.get_dependencies()[0].name(), [](std::vector<t_tscalar>& values) {
-                            tsl::hopscotch_set<t_tscalar> vset;
-                            for (const auto& v : values) {
-                                vset.insert(v);
-                            }
-                            std::uint32_t rv = vset.size();
-                            return rv;
-                        }));
-
+                std::uint32_t distinct
+                    = update_multiset(info, idx, src_ridx, dst_ridx).distinct_size();
+                new_value.set(distinct);
+                dst->set_scalar(dst_ridx, new_value);
+            } break;
+            case AGGTYPE_APPROX_DISTINCT_COUNT: {
+                old_value.set(dst->get_scalar(dst_ridx));
+                std::uint32_t estimate = static_cast<std::uint32_t>(
+                    update_sketch(info, idx, src_ridx, dst_ridx, nidx, gstate).estimate());
+                new_value.set(estimate);
+                dst->set_scalar(dst_ridx, new_value);
+            } break;
+            case AGGTYPE_ROLLING_SUM:
+            case AGGTYPE_ROLLING_COUNT:
+            case AGGTYPE_ROLLING_MEAN:
+            case AGGTYPE_ROLLING_WEIGHTED_MEAN: {
+                old_value.set(dst->get_scalar(dst_ridx));
+                update_window(info, idx, src_ridx, dst_ridx);
+                new_value = get_rolling_value(spec, idx, dst_ridx);
+                dst->set_scalar(dst_ridx, new_value);
+            } break;
+            case AGGTYPE_APPROX_PERCENTILE: {
+                old_value.set(dst->get_scalar(dst_ridx));
+                t_tdigest& digest = update_digest(info, idx, src_ridx, dst_ridx, nidx, gstate);
+                if (digest.weight() > 0) {
+                    new_value.set(digest.quantile(spec.get_quantile()));
+                } else {
+                    new_value = mknull(DTYPE_FLOAT64);
+                }
                 dst->set_scalar(dst_ridx, new_value);
             } break;
             case AGGTYPE_DISTINCT_LEAF: {
@@ -1269,12 +2277,44 @@ t_stree::update_agg_table(t_uindex nidx, t_agg_update_info& info, t_uindex src_r
         bool val_neq = old_value != new_value;
 
         m_has_delta = m_has_delta || val_neq;
+        changed = changed || val_neq;
         bool deltas_enabled = m_features.at(CTX_FEAT_DELTA);
         if (deltas_enabled && val_neq) {
             m_deltas->insert(t_tcdelta(nidx, idx, old_value, new_value));
         }
 
     } // end for
+    return changed;
+}
+
+bool
+t_stree::roll_up_children(
+    t_uindex nidx, t_aggtype agg, const t_column* dst, t_tscalar& out) const {
+    if (is_leaf(nidx) || (agg != AGGTYPE_AND && dst->get_dtype() != DTYPE_BOOL)) {
+        return false;
+    }
+
+    auto iterators = m_nodes->get<by_pidx>().equal_range(nidx);
+    if (iterators.first == iterators.second || !is_aggregated(iterators.first->m_idx)) {
+        return false;
+    }
+
+    bool any = false;
+    bool all = true;
+    for (auto iter = iterators.first; iter != iterators.second; ++iter) {
+        if (dst->get_scalar(iter->m_aggidx)) {
+            any = true;
+        } else {
+            all = false;
+        }
+    }
+
+    if (agg == AGGTYPE_AND) {
+        out.set(all);
+    } else if (any) {
+        out.set(true);
+    }
+    return true;
 }
 
 std::vector<t_uindex>
@@ -1319,12 +2359,11 @@ t_stree::non_zero_ids(
 
 t_uindex
 t_stree::get_parent_idx(t_uindex ptidx) const {
-    iter_by_idx iter = m_nodes->get<by_idx>().find(ptidx);
-    if (iter == m_nodes->get<by_idx>().end()) {
+    if (!m_nodestore.contains(ptidx)) {
         std::cout << "Failed in tree => " << repr() << std::endl;
         PSP_VERBOSE_ASSERT(false, "Did not find node");
     }
-    return iter->m_pidx;
+    return m_nodestore.get_pidx(ptidx);
 }
 
 std::vector<t_uindex>
@@ -1350,9 +2389,8 @@ t_stree::get_sibling_idx(t_index p_ptidx, t_index p_nchild, t_uindex c_ptidx) co
 
 t_uindex
 t_stree::get_aggidx(t_uindex idx) const {
-    iter_by_idx iter = m_nodes->get<by_idx>().find(idx);
-    PSP_VERBOSE_ASSERT(iter != m_nodes->get<by_idx>().end(), "Failed in get_aggidx");
-    return iter->m_aggidx;
+    PSP_VERBOSE_ASSERT(m_nodestore.contains(idx), "Failed in get_aggidx");
+    return m_nodestore.get_aggidx(idx);
 }
 
 std::shared_ptr<const t_data_table>
@@ -1367,42 +2405,111 @@ t_stree::_get_aggtable() {
 
 t_stree::t_tnode
 t_stree::get_node(t_uindex idx) const {
-    iter_by_idx iter = m_nodes->get<by_idx>().find(idx);
-    PSP_VERBOSE_ASSERT(iter != m_nodes->get<by_idx>().end(), "Failed in get_node");
-    return *iter;
+    PSP_VERBOSE_ASSERT(m_nodestore.contains(idx), "Failed in get_node");
+    return m_nodestore.get_node(idx);
 }
 
 void
 t_stree::get_path(t_uindex idx, std::vector<t_tscalar>& rval) const {
-    t_uindex curidx = idx;
-
-    if (curidx == 0)
-        return;
+    const std::vector<t_tscalar>& path = m_nodestore.get_path(idx);
+    rval.insert(rval.end(), path.begin(), path.end());
+}
 
-    while (1) {
-        iter_by_idx iter = m_nodes->get<by_idx>().find(curidx);
-        rval.push_back(iter->m_value);
-        curidx = iter->m_pidx;
-        if (curidx == 0) {
-            break;
-        }
-    }
-    return;
+const std::vector<t_tscalar>&
+t_stree::get_path(t_uindex idx) const {
+    return m_nodestore.get_path(idx);
 }
 
 t_uindex
 t_stree::resolve_child(t_uindex root, const t_tscalar& datum) const {
-    auto iter = m_nodes->get<by_pidx_hash>().find(std::make_tuple(root, datum));
+    return m_nodestore.find_child(root, datum);
+}
+
+void
+t_stree::clear_aggregates(const std::vector<t_uindex>& indices) {
+    reset_aggregates(indices);
+    m_agg_freelist.insert(std::end(m_agg_freelist), std::begin(indices), std::end(indices));
+    m_agg_churn += indices.size();
+}
+
+void
+t_stree::relayout_aggregates() {
+    t_uindex nrows = m_aggregates->size();
+
+    // The aggregate row of each node breadth first, from the root.
+    std::vector<t_uindex> nodes;
+    nodes.reserve(m_nodes->size());
+    nodes.push_back(0);
+    for (t_uindex pos = 0; pos < nodes.size(); ++pos) {
+        auto iterators = m_nodes->get<by_pidx>().equal_range(nodes[pos]);
+        for (auto iter = iterators.first; iter != iterators.second; ++iter) {
+            nodes.push_back(iter->m_idx);
+        }
+    }
 
-    if (iter == m_nodes->get<by_pidx_hash>().end()) {
-        return INVALID_INDEX;
+    // `rows[new]` is the old row moved to `new`; rows no node owns follow
+    // the live ones in their old order.
+    std::vector<t_uindex> rows;
+    rows.reserve(nrows);
+    std::vector<bool> live(nrows, false);
+    for (t_uindex nidx : nodes) {
+        t_uindex aggidx = m_nodestore.get_aggidx(nidx);
+        PSP_VERBOSE_ASSERT(aggidx < nrows, "Aggregate row out of the table");
+        rows.push_back(aggidx);
+        live[aggidx] = true;
     }
 
-    return iter->m_idx;
+    t_uindex nlive = rows.size();
+    for (t_uindex aggidx = 0; aggidx < nrows; ++aggidx) {
+        if (!live[aggidx]) {
+            rows.push_back(aggidx);
+        }
+    }
+
+    std::vector<t_uindex> new_rows(nrows);
+    for (t_uindex idx = 0; idx < nrows; ++idx) {
+        new_rows[rows[idx]] = idx;
+    }
+
+    // Columns may be listed under more than one name, and are moved once.
+    std::vector<t_column*> columns;
+    tsl::hopscotch_set<t_column*> seen;
+    for (t_column* column : m_aggregates->get_columns()) {
+        if (seen.insert(column).second) {
+            columns.push_back(column);
+        }
+    }
+    t_scheduler::current().parallel_for(columns.size(),
+        [&columns, &rows](t_uindex idx) { columns[idx]->permute_rows(rows); });
+
+    for (t_uindex nidx : nodes) {
+        auto iter = m_nodes->get<by_idx>().find(nidx);
+        t_tnode node = *iter;
+        node.m_aggidx = new_rows[node.m_aggidx];
+        m_nodes->get<by_idx>().replace(iter, node);
+        m_nodestore.set_aggidx(nidx, node.m_aggidx);
+    }
+
+    remap_agg_rows(m_multisets, new_rows);
+    remap_agg_rows(m_sketches, new_rows);
+    remap_agg_rows(m_digests, new_rows);
+    remap_agg_rows(m_windows, new_rows);
+
+    // The rows that were allocated and are now unowned follow the live
+    // ones, and are allocated again in order from now on.
+    std::vector<t_uindex> unowned;
+    for (t_uindex aggidx = nlive; aggidx < m_cur_aggidx; ++aggidx) {
+        unowned.push_back(aggidx);
+    }
+    reset_aggregates(unowned);
+
+    m_agg_freelist.clear();
+    m_cur_aggidx = nlive;
+    m_agg_churn = 0;
 }
 
 void
-t_stree::clear_aggregates(const std::vector<t_uindex>& indices) {
+t_stree::reset_aggregates(const std::vector<t_uindex>& indices) {
     auto cols = m_aggregates->get_columns();
     for (auto c : cols) {
         for (auto aggidx : indices) {
@@ -1410,7 +2517,45 @@ t_stree::clear_aggregates(const std::vector<t_uindex>& indices) {
         }
     }
 
-    m_agg_freelist.insert(std::end(m_agg_freelist), std::begin(indices), std::end(indices));
+    for (auto& multisets : m_multisets) {
+        if (multisets.empty()) {
+            continue;
+        }
+
+        for (auto aggidx : indices) {
+            multisets.erase(aggidx);
+        }
+    }
+
+    for (auto& sketches : m_sketches) {
+        if (sketches.empty()) {
+            continue;
+        }
+
+        for (auto aggidx : indices) {
+            sketches.erase(aggidx);
+        }
+    }
+
+    for (auto& digests : m_digests) {
+        if (digests.empty()) {
+            continue;
+        }
+
+        for (auto aggidx : indices) {
+            digests.erase(aggidx);
+        }
+    }
+
+    for (auto& windows : m_windows) {
+        if (windows.empty()) {
+            continue;
+        }
+
+        for (auto aggidx : indices) {
+            windows.erase(aggidx);
+        }
+    }
 }
 
 void
@@ -1443,6 +2588,12 @@ t_stree::drop_zero_strands() {
 
     auto iterators2 = m_nodes->get<by_nstrands>().equal_range(0);
 
+    for (auto iter = iterators2.first; iter != iterators2.second; ++iter) {
+        m_nodestore.erase(iter->m_idx);
+        m_open.erase(iter->m_idx);
+        m_dropped.push_back(iter->m_idx);
+    }
+
     m_nodes->get<by_nstrands>().erase(iterators2.first, iterators2.second);
 }
 
@@ -1515,8 +2666,7 @@ t_stree::get_leaves(t_uindex idx) const {
 
 t_depth
 t_stree::get_depth(t_uindex ptidx) const {
-    auto iter = m_nodes->get<by_idx>().find(ptidx);
-    return iter->m_depth;
+    return m_nodestore.get_depth(ptidx);
 }
 
 void
@@ -1598,9 +2748,8 @@ t_stree::last_level() const {
 
 bool
 t_stree::is_leaf(t_uindex nidx) const {
-    auto iter = m_nodes->get<by_idx>().find(nidx);
-    PSP_VERBOSE_ASSERT(iter != m_nodes->get<by_idx>().end(), "Did not find node");
-    return iter->m_depth == last_level();
+    PSP_VERBOSE_ASSERT(m_nodestore.contains(nidx), "Did not find node");
+    return m_nodestore.get_depth(nidx) == last_level();
 }
 
 std::vector<t_uindex>
@@ -1628,21 +2777,10 @@ t_stree::get_pivots() const {
 
 t_index
 t_stree::resolve_path(t_uindex root, const std::vector<t_tscalar>& path) const {
-    t_index curidx = root;
-
     if (path.empty())
-        return curidx;
-
-    for (t_index i = path.size() - 1; i >= 0; i--) {
-        iter_by_pidx_hash iter
-            = m_nodes->get<by_pidx_hash>().find(std::make_tuple(curidx, path[i]));
-        if (iter == m_nodes->get<by_pidx_hash>().end()) {
-            return INVALID_INDEX;
-        }
-        curidx = iter->m_idx;
-    }
+        return root;
 
-    return curidx;
+    return m_nodestore.find_path(root, path);
 }
 
 // aggregates should be presized to be same size
@@ -1736,6 +2874,24 @@ t_stree::clear_deltas() {
 void
 t_stree::clear() {
     m_nodes->clear();
+    m_nodestore.clear();
+    for (auto& multisets : m_multisets) {
+        multisets.clear();
+    }
+    for (auto& sketches : m_sketches) {
+        sketches.clear();
+    }
+    for (auto& digests : m_digests) {
+        digests.clear();
+    }
+    for (auto& windows : m_windows) {
+        windows.clear();
+    }
+    std::fill(m_rolling_now.begin(), m_rolling_now.end(),
+        -std::numeric_limits<double>::infinity());
+    m_open.clear();
+    m_updated.clear();
+    m_dropped.clear();
     clear_deltas();
 }
 
@@ -1783,6 +2939,22 @@ t_stree::get_deltas() const {
     return m_deltas;
 }
 
+const tsl::hopscotch_set<t_uindex>&
+t_stree::get_updated() const {
+    return m_updated;
+}
+
+const std::vector<t_uindex>&
+t_stree::get_dropped() const {
+    return m_dropped;
+}
+
+void
+t_stree::clear_updated() {
+    m_updated.clear();
+    m_dropped.clear();
+}
+
 t_tscalar
 t_stree::first_last_helper(t_uindex nidx, const t_aggspec& spec, const t_gstate& gstate) const {
     auto pkeys = get_pkeys(nidx);
@@ -1833,8 +3005,7 @@ t_stree::first_last_helper(t_uindex nidx, const t_aggspec& spec, const t_gstate&
 
 bool
 t_stree::node_exists(t_uindex idx) {
-    iter_by_idx iter = m_nodes->get<by_idx>().find(idx);
-    return iter != m_nodes->get<by_idx>().end();
+    return m_nodestore.contains(idx);
 }
 
 t_data_table*
@@ -1844,7 +3015,17 @@ t_stree::get_aggtable() {
 
 std::pair<iter_by_idx, bool>
 t_stree::insert_node(const t_tnode& node) {
-    return m_nodes->insert(node);
+    // Children of a node are unique by value.
+    t_uindex cidx = m_nodestore.find_child(node.m_pidx, node.m_value);
+    if (cidx != t_stnode_store::NOT_FOUND) {
+        return std::make_pair(m_nodes->get<by_idx>().find(cidx), false);
+    }
+
+    auto rval = m_nodes->insert(node);
+    if (rval.second) {
+        m_nodestore.insert(node);
+    }
+    return rval;
 }
 
 bool
@@ -1860,9 +3041,8 @@ t_stree::get_sortby_path(t_uindex idx, std::vector<t_tscalar>& rval) const {
         return;
 
     while (1) {
-        iter_by_idx iter = m_nodes->get<by_idx>().find(curidx);
-        rval.push_back(iter->m_sort_value);
-        curidx = iter->m_pidx;
+        rval.push_back(m_nodestore.get_sort_value(curidx));
+        curidx = m_nodestore.get_pidx(curidx);
         if (curidx == 0) {
             break;
         }
@@ -9,6 +9,8 @@
 
 #include <perspective/first.h>
 #include <perspective/sparse_tree_node.h>
+#include <boost/functional/hash.hpp>
+#include <algorithm>
 
 namespace perspective {
 
@@ -35,6 +37,216 @@ t_stnode::set_sort_value(t_tscalar sv) {
     m_sort_value.set(sv);
 }
 
+const t_uindex t_stnode_store::NOT_FOUND;
+
+t_stnode_store::t_stnode_store() {}
+
+void
+t_stnode_store::insert(const t_stnode& node) {
+    t_uindex idx = node.m_idx;
+
+    if (idx >= m_exists.size()) {
+        t_uindex size = std::max(idx + 1, 2 * m_exists.size());
+        m_pidx.resize(size);
+        m_depth.resize(size);
+        m_value.resize(size);
+        m_sort_value.resize(size);
+        m_nstrands.resize(size);
+        m_aggidx.resize(size);
+        m_exists.resize(size, 0);
+        m_path.resize(size);
+        m_path_hash.resize(size);
+    }
+
+    bool reindex = !m_exists[idx] || m_pidx[idx] != node.m_pidx || m_value[idx] != node.m_value;
+
+    if (m_exists[idx]) {
+        m_children.erase(t_child_key{m_pidx[idx], m_value[idx]});
+        if (reindex) {
+            unindex_path(idx);
+        }
+    }
+
+    m_pidx[idx] = node.m_pidx;
+    m_depth[idx] = node.m_depth;
+    m_value[idx] = node.m_value;
+    m_sort_value[idx] = node.m_sort_value;
+    m_nstrands[idx] = node.m_nstrands;
+    m_aggidx[idx] = node.m_aggidx;
+    m_exists[idx] = 1;
+    m_children[t_child_key{node.m_pidx, node.m_value}] = idx;
+
+    if (reindex) {
+        index_path(idx);
+    }
+}
+
+void
+t_stnode_store::erase(t_uindex idx) {
+    if (!contains(idx))
+        return;
+
+    m_children.erase(t_child_key{m_pidx[idx], m_value[idx]});
+    unindex_path(idx);
+    m_exists[idx] = 0;
+}
+
+void
+t_stnode_store::clear() {
+    m_pidx.clear();
+    m_depth.clear();
+    m_value.clear();
+    m_sort_value.clear();
+    m_nstrands.clear();
+    m_aggidx.clear();
+    m_exists.clear();
+    m_children.clear();
+    m_path.clear();
+    m_path_hash.clear();
+    m_paths.clear();
+}
+
+t_uindex
+t_stnode_store::nbytes() const {
+    t_uindex rv = m_pidx.capacity() * sizeof(t_uindex) + m_depth.capacity()
+        + m_value.capacity() * sizeof(t_tscalar) + m_sort_value.capacity() * sizeof(t_tscalar)
+        + m_nstrands.capacity() * sizeof(t_uindex) + m_aggidx.capacity() * sizeof(t_uindex)
+        + m_exists.capacity() + m_path.capacity() * sizeof(std::vector<t_tscalar>)
+        + m_path_hash.capacity() * sizeof(std::size_t) + hash_map_nbytes(m_children)
+        + hash_map_nbytes(m_paths);
+
+    for (const auto& path : m_path) {
+        rv += path.capacity() * sizeof(t_tscalar);
+    }
+
+    return rv;
+}
+
+bool
+t_stnode_store::contains(t_uindex idx) const {
+    return idx < m_exists.size() && m_exists[idx];
+}
+
+t_uindex
+t_stnode_store::find_child(t_uindex pidx, const t_tscalar& value) const {
+    auto iter = m_children.find(t_child_key{pidx, value});
+    if (iter == m_children.end())
+        return NOT_FOUND;
+    return iter->second;
+}
+
+t_uindex
+t_stnode_store::find_path(t_uindex root, const std::vector<t_tscalar>& path) const {
+    if (!contains(root))
+        return NOT_FOUND;
+
+    if (path.empty())
+        return root;
+
+    std::size_t hash = m_path_hash[root];
+    for (auto iter = path.rbegin(); iter != path.rend(); ++iter) {
+        hash = hash_path_step(hash, *iter);
+    }
+
+    auto piter = m_paths.find(hash);
+    if (piter == m_paths.end())
+        return NOT_FOUND;
+
+    // Check the candidate's path, as a different path may share its hash.
+    t_uindex idx = piter->second;
+    if (idx != NOT_FOUND) {
+        const std::vector<t_tscalar>& cpath = m_path[idx];
+        const std::vector<t_tscalar>& rpath = m_path[root];
+        bool match = cpath.size() == path.size() + rpath.size()
+            && std::equal(path.begin(), path.end(), cpath.begin())
+            && std::equal(rpath.begin(), rpath.end(), cpath.begin() + path.size());
+        if (match)
+            return idx;
+    }
+
+    t_uindex curidx = root;
+    for (auto iter = path.rbegin(); iter != path.rend(); ++iter) {
+        curidx = find_child(curidx, *iter);
+        if (curidx == NOT_FOUND)
+            return NOT_FOUND;
+    }
+
+    return curidx;
+}
+
+std::size_t
+t_stnode_store::hash_scalar(const t_tscalar& value) {
+    // `t_tscalar::operator==` compares bools by value only.
+    return value.get_dtype() == DTYPE_BOOL ? std::hash<bool>()(value.get<bool>())
+                                           : hash_value(value);
+}
+
+std::size_t
+t_stnode_store::hash_path_step(std::size_t parent_hash, const t_tscalar& value) {
+    std::size_t seed = parent_hash;
+    boost::hash_combine(seed, hash_scalar(value));
+    return seed;
+}
+
+void
+t_stnode_store::index_path(t_uindex idx) {
+    std::vector<t_tscalar>& path = m_path[idx];
+    path.clear();
+
+    if (idx == 0) {
+        m_path_hash[idx] = 0;
+        return;
+    }
+
+    t_uindex pidx = m_pidx[idx];
+    path.push_back(m_value[idx]);
+    std::size_t hash = hash_path_step(0, m_value[idx]);
+
+    if (contains(pidx)) {
+        const std::vector<t_tscalar>& ppath = m_path[pidx];
+        path.insert(path.end(), ppath.begin(), ppath.end());
+        hash = hash_path_step(m_path_hash[pidx], m_value[idx]);
+    }
+
+    m_path_hash[idx] = hash;
+
+    auto iter = m_paths.find(hash);
+    if (iter == m_paths.end()) {
+        m_paths[hash] = idx;
+    } else if (iter->second != idx) {
+        m_paths[hash] = NOT_FOUND;
+    }
+}
+
+void
+t_stnode_store::unindex_path(t_uindex idx) {
+    auto iter = m_paths.find(m_path_hash[idx]);
+    if (iter != m_paths.end() && iter->second == idx) {
+        m_paths.erase(iter);
+    }
+
+    std::vector<t_tscalar>().swap(m_path[idx]);
+}
+
+t_stnode
+t_stnode_store::get_node(t_uindex idx) const {
+    PSP_VERBOSE_ASSERT(contains(idx), "Did not find node");
+    return t_stnode(idx, m_pidx[idx], m_value[idx], m_depth[idx], m_sort_value[idx],
+        m_nstrands[idx], m_aggidx[idx]);
+}
+
+bool
+t_stnode_store::t_child_key::operator==(const t_child_key& other) const {
+    return m_pidx == other.m_pidx && m_value == other.m_value;
+}
+
+std::size_t
+t_stnode_store::t_child_key_hash::operator()(const t_child_key& key) const {
+    std::size_t seed = hash_scalar(key.m_value);
+    boost::hash_combine(seed, key.m_pidx);
+    return seed;
+}
+
 t_stpkey::t_stpkey(t_uindex idx, t_tscalar pkey)
     : m_idx(idx)
     , m_pkey(pkey) {}
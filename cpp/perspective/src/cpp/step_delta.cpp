@@ -9,6 +9,8 @@
 
 #include <perspective/first.h>
 #include <perspective/step_delta.h>
+#include <algorithm>
+#include <limits>
 
 namespace perspective {
 
@@ -52,6 +54,45 @@ t_rowdelta::t_rowdelta(
     : rows_changed(rows_changed)
     , num_rows_changed(num_rows_changed)
     , data(data) {}
+
+// t_viewport is the window of a context that deltas are reported for
+t_viewport::t_viewport()
+    : m_start_row(0)
+    , m_end_row(std::numeric_limits<t_uindex>::max())
+    , m_start_col(0)
+    , m_end_col(std::numeric_limits<t_uindex>::max()) {}
+
+t_viewport::t_viewport(
+    t_uindex start_row, t_uindex end_row, t_uindex start_col, t_uindex end_col)
+    : m_start_row(start_row)
+    , m_end_row(end_row)
+    , m_start_col(start_col)
+    , m_end_col(end_col) {}
+
+bool
+t_viewport::contains_row(t_uindex ridx) const {
+    return m_start_row <= ridx && ridx < m_end_row;
+}
+
+bool
+t_viewport::contains_column(t_uindex cidx) const {
+    return m_start_col <= cidx && cidx < m_end_col;
+}
+
+void
+t_viewport::clip_rows(t_index& bidx, t_index& eidx) const {
+    t_uindex max_row = std::numeric_limits<t_index>::max();
+    eidx = std::min(eidx, t_index(std::min(m_end_row, max_row)));
+    bidx = std::max(bidx, t_index(std::min(m_start_row, max_row)));
+    bidx = std::min(bidx, std::max(eidx, t_index(0)));
+}
+
+bool
+t_viewport::is_unbounded() const {
+    return m_start_row == 0 && m_start_col == 0
+        && m_end_row == std::numeric_limits<t_uindex>::max()
+        && m_end_col == std::numeric_limits<t_uindex>::max();
+}
 } // end namespace perspective
 
 namespace std {
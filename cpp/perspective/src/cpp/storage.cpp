@@ -38,9 +38,39 @@ SUPPRESS_WARNINGS_VC(4505)
 
 namespace perspective {
 
+namespace {
+
+// Disk backed stores are mapped from their file, so only heap stores are
+// aligned or backed by huge pages.
+t_uindex
+default_alignment(t_backing_store backing_store) {
+    return backing_store == BACKING_STORE_MEMORY ? t_env::lstore_alignment() : 0;
+}
+
+t_page_policy
+default_page_policy(t_backing_store backing_store) {
+    if (backing_store != BACKING_STORE_MEMORY) {
+        return PAGE_POLICY_DEFAULT;
+    }
+
+    switch (t_env::lstore_huge_pages()) {
+        case 1:
+            return PAGE_POLICY_TRANSPARENT_HUGE;
+        case 2:
+            return PAGE_POLICY_EXPLICIT_HUGE;
+        default:
+            return PAGE_POLICY_DEFAULT;
+    }
+}
+
+} // end anonymous namespace
+
 t_lstore_recipe::t_lstore_recipe()
     : m_alignment(0)
-    , m_from_recipe(false) {}
+    , m_from_recipe(false)
+    , m_page_policy(PAGE_POLICY_DEFAULT)
+    , m_growth_factor(t_env::lstore_growth_factor())
+    , m_alloc_owner(ALLOC_OWNER_OTHER) {}
 
 t_lstore_recipe::t_lstore_recipe(t_uindex capacity)
     : m_dirname("")
@@ -48,7 +78,7 @@ t_lstore_recipe::t_lstore_recipe(t_uindex capacity)
     , m_fname("")
     , m_capacity(capacity)
     , m_size(0)
-    , m_alignment(0)
+    , m_alignment(default_alignment(BACKING_STORE_MEMORY))
     , m_fflags(PSP_DEFAULT_FFLAGS)
     , m_fmode(PSP_DEFAULT_FMODE)
     , m_creation_disposition(PSP_DEFAULT_CREATION_DISPOSITION)
@@ -56,6 +86,9 @@ t_lstore_recipe::t_lstore_recipe(t_uindex capacity)
     , m_mflags(PSP_DEFAULT_MFLAGS)
     , m_backing_store(BACKING_STORE_MEMORY)
     , m_from_recipe(false)
+    , m_page_policy(default_page_policy(BACKING_STORE_MEMORY))
+    , m_growth_factor(t_env::lstore_growth_factor())
+    , m_alloc_owner(ALLOC_OWNER_OTHER)
 
 {
     PSP_TRACE_SENTINEL();
@@ -68,14 +101,17 @@ t_lstore_recipe::t_lstore_recipe(const std::string& dirname, const std::string&
     , m_colname(colname)
     , m_capacity(capacity)
     , m_size(0)
-    , m_alignment(0)
+    , m_alignment(default_alignment(backing_store))
     , m_fflags(PSP_DEFAULT_FFLAGS)
     , m_fmode(PSP_DEFAULT_FMODE)
     , m_creation_disposition(PSP_DEFAULT_CREATION_DISPOSITION)
     , m_mprot(PSP_DEFAULT_MPROT)
     , m_mflags(PSP_DEFAULT_MFLAGS)
     , m_backing_store(backing_store)
-    , m_from_recipe(false) {
+    , m_from_recipe(false)
+    , m_page_policy(default_page_policy(backing_store))
+    , m_growth_factor(t_env::lstore_growth_factor())
+    , m_alloc_owner(ALLOC_OWNER_OTHER) {
     PSP_TRACE_SENTINEL();
     LOG_CONSTRUCTOR("t_lstore_recipe");
 }
@@ -87,14 +123,17 @@ t_lstore_recipe::t_lstore_recipe(const std::string& dirname, const std::string&
     , m_colname(colname)
     , m_capacity(capacity)
     , m_size(0)
-    , m_alignment(0)
+    , m_alignment(default_alignment(backing_store))
     , m_fflags(fflags)
     , m_fmode(fmode)
     , m_creation_disposition(creation_disposition)
     , m_mprot(mprot)
     , m_mflags(mflags)
     , m_backing_store(backing_store)
-    , m_from_recipe(false) {
+    , m_from_recipe(false)
+    , m_page_policy(default_page_policy(backing_store))
+    , m_growth_factor(t_env::lstore_growth_factor())
+    , m_alloc_owner(ALLOC_OWNER_OTHER) {
     PSP_TRACE_SENTINEL();
     LOG_CONSTRUCTOR("t_lstore_recipe");
 }
@@ -105,14 +144,17 @@ t_lstore_recipe::t_lstore_recipe(const std::string& colname, t_uindex capacity,
     , m_colname(colname)
     , m_capacity(capacity)
     , m_size(0)
-    , m_alignment(0)
+    , m_alignment(default_alignment(backing_store))
     , m_fflags(PSP_DEFAULT_FFLAGS)
     , m_fmode(PSP_DEFAULT_FMODE)
     , m_creation_disposition(PSP_DEFAULT_CREATION_DISPOSITION)
     , m_mprot(mprot)
     , m_mflags(mflags)
     , m_backing_store(backing_store)
-    , m_from_recipe(false) {
+    , m_from_recipe(false)
+    , m_page_policy(default_page_policy(backing_store))
+    , m_growth_factor(t_env::lstore_growth_factor())
+    , m_alloc_owner(ALLOC_OWNER_OTHER) {
     PSP_TRACE_SENTINEL();
     LOG_CONSTRUCTOR("t_lstore_recipe");
 }
@@ -125,8 +167,12 @@ t_lstore::t_lstore()
     , m_alignment(0)
     , m_backing_store(BACKING_STORE_MEMORY)
     , m_init(false)
-    , m_resize_factor(1.2)
-    , m_version(0) {
+    , m_page_policy(PAGE_POLICY_DEFAULT)
+    , m_mapped(false)
+    , m_resize_factor(t_env::lstore_growth_factor())
+    , m_version(0)
+    , m_alloc_owner(ALLOC_OWNER_OTHER)
+    , m_spilled(false) {
 
     PSP_TRACE_SENTINEL();
     LOG_CONSTRUCTOR("t_lstore");
@@ -143,7 +189,6 @@ t_lstore::t_lstore(const t_lstore& s, t_lstore_tmp_init_tag t) {
     m_version = 0;
     m_base = 0;
     m_size = 0;
-    m_alignment = 0;
     m_fd = 0;
     m_init = false;
     if (s.m_backing_store == BACKING_STORE_DISK)
@@ -193,9 +238,14 @@ t_lstore::copy_helper_(const t_lstore& other) {
     m_mflags = other.m_mflags;
     m_backing_store = other.m_backing_store;
     m_init = false;
+    m_page_policy = other.m_page_policy;
+    m_mapped = false;
     m_resize_factor = other.m_resize_factor;
     m_version = other.m_version;
     m_from_recipe = other.m_from_recipe;
+    m_alloc_owner = other.m_alloc_owner;
+    m_allocator = other.m_allocator;
+    m_spilled = false;
     PSP_CHECK_CAPACITY();
 }
 
@@ -219,9 +269,13 @@ t_lstore::operator=(t_lstore&& other) {
 
 t_lstore::~t_lstore() {
     PSP_TRACE_SENTINEL();
-    if (!m_init)
+    if (!m_init || m_owner)
         return;
 
+    if (t_alloc_stats::is_enabled()) {
+        t_alloc_stats::record(m_alloc_owner, ALLOC_OP_FREE, -static_cast<std::int64_t>(m_capacity));
+    }
+
     switch (m_backing_store) {
         case BACKING_STORE_DISK: {
             destroy_mapping();
@@ -234,14 +288,7 @@ t_lstore::~t_lstore() {
             }
         } break;
         case BACKING_STORE_MEMORY: {
-#ifdef _MSC_VER
-            if (m_alignment >= 2) {
-                _aligned_free(m_base); // seriously
-            } else
-#endif // _MSC_VER
-            {
-                free(m_base);
-            }
+            heap_free(m_base, m_capacity, m_mapped);
 
 #ifdef PSP_MPROTECT
             unfreeze_impl();
@@ -264,6 +311,11 @@ t_lstore::set_size(t_uindex idx) // in bytes
 
 void
 t_lstore::init() {
+    init_impl(ALLOC_OP_INIT);
+}
+
+void
+t_lstore::init_impl(t_alloc_op op) {
     PSP_TRACE_SENTINEL();
     PSP_VERBOSE_ASSERT(!m_init, "Already inited column");
     LOG_INIT("t_lstore");
@@ -278,63 +330,73 @@ t_lstore::init() {
             m_base = create_mapping();
         } break;
         case BACKING_STORE_MEMORY: {
-            size_t const alloc_size
-                = std::max(std::max(size_t(m_alignment), size_t(8u)), size_t(capacity()));
-
-            if (m_alignment < 2) {
-                m_base = calloc(alloc_size, 1);
-            } else {
-                // nontrivial alignment
-                PSP_VERBOSE_ASSERT(!(m_alignment & (m_alignment - 1)),
-                    "store alignment must be a power of two!");
-
-#ifdef _MSC_VER
-                m_base = _aligned_malloc(alloc_size, size_t(m_alignment));
-#else
-                int result = posix_memalign(
-                    &m_base, std::max(sizeof(void*), size_t(m_alignment)), alloc_size);
-                if (result != 0)
-                    m_base = nullptr;
-#endif
-
-                PSP_VERBOSE_ASSERT(m_base,
-                    "MALLOC_FAILED"); // ensure we check before trying to memset() in this case
-                memset(m_base, 0, alloc_size);
-            }
-
-            PSP_VERBOSE_ASSERT(m_base, "MALLOC_FAILED");
+            PSP_VERBOSE_ASSERT(!(m_alignment & (m_alignment - 1)),
+                "store alignment must be a power of two!");
+            m_allocator = t_allocator::current();
+            m_capacity = heap_capacity(std::max(m_alignment, capacity()));
+            m_base = heap_alloc(m_capacity, true, m_mapped);
         } break;
         default: { PSP_VERBOSE_ASSERT(false, "Unknown backing store"); } break;
     }
 
     m_init = true;
+
+    if (t_alloc_stats::is_enabled()) {
+        t_alloc_stats::record(m_alloc_owner, op, m_capacity);
+    }
 }
 
 void
 t_lstore::reserve(t_uindex capacity) {
-    reserve_impl(capacity, false);
+    reserve_impl(capacity, false, ALLOC_OP_RESERVE);
 }
 
 void
 t_lstore::shrink(t_uindex capacity) {
-    reserve_impl(capacity, true);
+    reserve_impl(capacity, true, ALLOC_OP_SHRINK);
+}
+
+void
+t_lstore::set_alloc_owner(t_alloc_owner owner) {
+    if (m_init && !m_owner && t_alloc_stats::is_enabled()) {
+        t_alloc_stats::transfer(m_alloc_owner, owner, m_capacity);
+    }
+    m_alloc_owner = owner;
+}
+
+t_alloc_owner
+t_lstore::get_alloc_owner() const {
+    return m_alloc_owner;
 }
 
 void
-t_lstore::reserve_impl(t_uindex capacity, bool allow_shrink) {
+t_lstore::reserve_impl(t_uindex capacity, bool allow_shrink, t_alloc_op op) {
     PSP_TRACE_SENTINEL();
     PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
     if ((capacity < m_capacity) && !allow_shrink)
         return;
 
+    if (m_owner)
+        unborrow();
+
     PSP_VERBOSE_ASSERT(capacity >= m_size, "reduce size before reducing capacity!");
     capacity = std::max(capacity, m_size);
 
-    capacity = 4 * std::uint64_t(ceil(double(capacity * m_resize_factor) / 4));
+    // Grow geometrically, but never past what a single large reserve (such
+    // as a row count hint) asks for.
+    if (capacity > m_capacity) {
+        capacity = std::max(capacity, static_cast<t_uindex>(m_capacity * m_resize_factor));
+    }
+
+    capacity = 4 * std::uint64_t(ceil(double(capacity) / 4));
     capacity = std::max(capacity, static_cast<t_uindex>(8));
-    if (m_alignment > 1)
-        capacity = (capacity + m_alignment - 1) & ~(m_alignment - 1);
+    if (m_backing_store == BACKING_STORE_MEMORY) {
+        capacity = heap_capacity(capacity);
+    }
+
     t_uindex ocapacity = m_capacity;
+    if (capacity == ocapacity)
+        return;
 
     if (t_env::log_storage_resize()) {
         std::cout << repr() << " ocap => " << ocapacity << " ncap => " << capacity << std::endl;
@@ -343,39 +405,23 @@ t_lstore::reserve_impl(t_uindex capacity, bool allow_shrink) {
     switch (m_backing_store) {
         case BACKING_STORE_MEMORY: {
             void* base = 0;
+            bool mapped = false;
 
-            if (m_alignment < 2) {
-                base = realloc(m_base, size_t(capacity));
+            if (m_page_policy == PAGE_POLICY_DEFAULT) {
+                base = m_allocator->reallocate(m_base, ocapacity, capacity, m_alignment);
+                PSP_VERBOSE_ASSERT(base != 0, "realloc failed");
             } else {
-// nontrivial alignment
-#if _MSC_VER
-                base = _aligned_realloc(m_base, size_t(capacity), size_t(m_alignment));
-#else
-                base = realloc(m_base, size_t(capacity));
-
-                if ((uintptr_t(base) & (m_alignment - 1)) != 0) {
-                    // realloc() hasn't given us the correct alignment
-                    // so we need to fix it up
-                    PSP_VERBOSE_ASSERT(!(m_alignment & (m_alignment - 1)),
-                        "store alignment must be a power of two!");
-
-                    void* aligned_base = nullptr;
-                    int result = posix_memalign(&aligned_base,
-                        std::max(sizeof(void*), size_t(m_alignment)), size_t(capacity));
-                    PSP_VERBOSE_ASSERT(result, == 0, "posix_memalign failed");
-
-                    memcpy(aligned_base, base, ocapacity);
-                    free(base);
-                    base = aligned_base;
-                }
-#endif
+                // a mapping cannot be moved by the allocator
+                base = heap_alloc(capacity, false, mapped);
+                memcpy(base, m_base, size_t(std::min(capacity, ocapacity)));
+                heap_free(m_base, ocapacity, m_mapped);
             }
 
-            PSP_VERBOSE_ASSERT(base != 0, "realloc failed");
             {
                 t_unlock_store tmp(this);
                 m_base = base;
                 m_capacity = capacity;
+                m_mapped = mapped;
                 ++m_version;
             }
         } break;
@@ -389,18 +435,95 @@ t_lstore::reserve_impl(t_uindex capacity, bool allow_shrink) {
         default: { PSP_COMPLAIN_AND_ABORT("unknown backing medium"); }
     }
 
+    if (t_alloc_stats::is_enabled()) {
+        t_alloc_stats::record(m_alloc_owner, capacity < ocapacity ? ALLOC_OP_SHRINK : op,
+            static_cast<std::int64_t>(capacity) - static_cast<std::int64_t>(ocapacity));
+    }
+
     if (capacity > ocapacity) {
         memset(
             static_cast<unsigned char*>(m_base) + ocapacity, 0, size_t(capacity - ocapacity));
     }
 }
 
+t_uindex
+t_lstore::heap_capacity(t_uindex capacity) const {
+    capacity = std::max(capacity, static_cast<t_uindex>(8));
+    if (m_alignment > 1)
+        capacity = (capacity + m_alignment - 1) & ~(m_alignment - 1);
+#ifdef __linux__
+    // Huge page mappings are made, and must be unmapped, in whole pages
+    if (m_page_policy == PAGE_POLICY_EXPLICIT_HUGE && capacity >= PSP_HUGE_PAGE_SIZE)
+        capacity = (capacity + PSP_HUGE_PAGE_SIZE - 1) & ~(PSP_HUGE_PAGE_SIZE - 1);
+#endif
+    if (m_allocator && m_page_policy == PAGE_POLICY_DEFAULT)
+        capacity = m_allocator->good_size(capacity);
+    return capacity;
+}
+
+void*
+t_lstore::heap_alloc(t_uindex capacity, bool zero, bool& mapped) const {
+    mapped = false;
+    size_t alignment = size_t(m_alignment);
+
+#ifdef __linux__
+    bool huge = m_page_policy != PAGE_POLICY_DEFAULT && capacity >= PSP_HUGE_PAGE_SIZE;
+
+    if (huge && m_page_policy == PAGE_POLICY_EXPLICIT_HUGE) {
+        // Anonymous mappings are zeroed
+        void* base = mmap(nullptr, size_t(capacity), PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (base != MAP_FAILED) {
+            mapped = true;
+            return base;
+        }
+    }
+
+    if (huge) {
+        alignment = std::max(alignment, size_t(PSP_HUGE_PAGE_SIZE));
+    }
+#endif
+
+    void* base = m_allocator->allocate(capacity, alignment, zero);
+    PSP_VERBOSE_ASSERT(base, "MALLOC_FAILED");
+
+#ifdef __linux__
+    if (huge) {
+        // Advice only; the kernel may not support transparent huge pages
+        madvise(base, size_t(capacity), MADV_HUGEPAGE);
+    }
+#endif
+
+    return base;
+}
+
+static void
+free_heap(void* base, t_uindex capacity, bool mapped, t_uindex alignment,
+    t_allocator& allocator) {
+#ifdef __linux__
+    if (mapped) {
+        munmap(base, size_t(capacity));
+        return;
+    }
+#endif
+
+    allocator.deallocate(base, capacity, alignment);
+}
+
+void
+t_lstore::heap_free(void* base, t_uindex capacity, bool mapped) const {
+    free_heap(base, capacity, mapped, m_alignment, *m_allocator);
+}
+
 // Assumes store has been initted
 void
 t_lstore::load(const std::string& fname) {
     PSP_TRACE_SENTINEL();
     PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
 
+    if (m_owner)
+        unborrow();
+
     t_rfmapping imap;
     map_file_read(fname, imap);
     reserve(imap.m_size);
@@ -409,12 +532,36 @@ t_lstore::load(const std::string& fname) {
     PSP_CHECK_CAPACITY();
 }
 
+void
+t_lstore::map(const std::string& fname, t_uindex size) {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+
+    // Nothing to read, and a file can't be mapped for zero bytes.
+    if (size == 0) {
+        if (m_owner)
+            unborrow();
+        set_size(0);
+        return;
+    }
+
+    std::shared_ptr<t_rfmapping> imap(new t_rfmapping());
+    map_file_read(fname, *imap);
+    PSP_VERBOSE_ASSERT(size <= imap->m_size, "Mapped file is too small");
+    borrow(imap->m_base, size, imap);
+}
+
 void
 t_lstore::save(const std::string& fname) {
     PSP_TRACE_SENTINEL();
     PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
     PSP_VERBOSE_ASSERT(m_init, "Store not inited.");
 
+    // A store read from a mapping (see `map`) may be saved over the file
+    // it maps, which is truncated first.
+    if (m_owner)
+        unborrow();
+
     t_rfmapping omap;
     map_file_write(fname, capacity(), omap);
     memcpy(omap.m_base, m_base, size_t(capacity()));
@@ -462,9 +609,12 @@ t_lstore::get_fname() const {
 void
 t_lstore::push_back(const void* ptr, t_uindex len) {
     PSP_TRACE_SENTINEL();
+    if (m_owner)
+        unborrow();
+
     if (m_size + len >= m_capacity) {
-        reserve(static_cast<t_uindex>(
-            m_size + len)); // reserve() will multiply by m_resize_factor internally
+        reserve_impl(static_cast<t_uindex>(m_size + len + 1), false,
+            ALLOC_OP_EXTEND); // reserve() will grow by m_resize_factor internally
     }
 
     PSP_VERBOSE_ASSERT(m_size + len < m_capacity, "Insufficient capacity.");
@@ -480,6 +630,8 @@ t_lstore::push_back(const void* ptr, t_uindex len) {
 
 void*
 t_lstore::get_ptr(t_uindex offset) {
+    if (m_owner)
+        unborrow();
     return static_cast<void*>(static_cast<unsigned char*>(m_base) + offset);
 }
 
@@ -513,6 +665,8 @@ void
 t_lstore::clear() {
     PSP_TRACE_SENTINEL();
     PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    if (m_owner)
+        unborrow();
 #ifndef PSP_ENABLE_WASM
     memset(m_base, 0, size_t(capacity()));
 #endif
@@ -531,6 +685,9 @@ t_lstore::get_recipe() const {
     rval.m_from_recipe = true;
     rval.m_size = m_size;
     rval.m_alignment = m_alignment;
+    rval.m_page_policy = m_page_policy;
+    rval.m_growth_factor = m_resize_factor;
+    rval.m_alloc_owner = m_alloc_owner;
     return rval;
 }
 
@@ -538,6 +695,8 @@ void
 t_lstore::fill(const t_lstore& other) {
     PSP_TRACE_SENTINEL();
     PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    if (m_owner)
+        unborrow();
     reserve(other.size());
     memcpy(m_base, const_cast<void*>(other.m_base), size_t(other.size()));
     set_size(other.size());
@@ -547,6 +706,8 @@ void
 t_lstore::fill(const t_lstore& other, const t_mask& mask, t_uindex elem_size) {
     PSP_TRACE_SENTINEL();
     PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    if (m_owner)
+        unborrow();
     reserve(mask.size() * elem_size);
 
     PSP_VERBOSE_ASSERT(mask.size() * elem_size <= m_size, "Not enough space to fill");
@@ -581,12 +742,146 @@ std::shared_ptr<t_lstore>
 t_lstore::clone() const {
     auto recipe = get_recipe();
     std::shared_ptr<t_lstore> rval(new t_lstore(recipe));
-    rval->init();
+    rval->init_impl(ALLOC_OP_CLONE);
     rval->set_size(m_size);
     rval->fill(*this);
     return rval;
 }
 
+void
+t_lstore::borrow(const void* base, t_uindex size, std::shared_ptr<const void> owner) {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    PSP_VERBOSE_ASSERT(
+        m_backing_store == BACKING_STORE_MEMORY, "Can only borrow into BACKING_STORE_MEMORY");
+    PSP_VERBOSE_ASSERT(owner.get() != nullptr, "Cannot borrow without an owner");
+
+    if (!m_owner) {
+        heap_free(m_base, m_capacity, m_mapped);
+        if (t_alloc_stats::is_enabled()) {
+            t_alloc_stats::record(
+                m_alloc_owner, ALLOC_OP_FREE, -static_cast<std::int64_t>(m_capacity));
+        }
+    }
+
+    t_unlock_store tmp(this);
+    m_base = const_cast<void*>(base);
+    m_size = size;
+    m_capacity = size;
+    m_mapped = false;
+    m_owner = owner;
+    m_spilled = false;
+    ++m_version;
+}
+
+std::shared_ptr<t_lstore>
+t_lstore::snapshot() {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+
+    if (m_backing_store != BACKING_STORE_MEMORY || !m_base)
+        return clone();
+
+    if (!m_owner) {
+        void* base = m_base;
+        t_uindex capacity = m_capacity;
+        bool mapped = m_mapped;
+        t_uindex alignment = m_alignment;
+        t_alloc_owner alloc_owner = m_alloc_owner;
+        std::shared_ptr<t_allocator> allocator = m_allocator;
+
+        // The memory is counted as the store's until the last store reading
+        // it lets go.
+        t_unlock_store tmp(this);
+        m_owner = std::shared_ptr<const void>(
+            base, [capacity, mapped, alignment, alloc_owner, allocator](const void* ptr) {
+                free_heap(const_cast<void*>(ptr), capacity, mapped, alignment, *allocator);
+                if (t_alloc_stats::is_enabled()) {
+                    t_alloc_stats::record(
+                        alloc_owner, ALLOC_OP_FREE, -static_cast<std::int64_t>(capacity));
+                }
+            });
+    }
+
+    auto recipe = get_recipe();
+    recipe.m_capacity = 0;
+    std::shared_ptr<t_lstore> rval(new t_lstore(recipe));
+    rval->init();
+    rval->borrow(m_base, m_size, m_owner);
+    return rval;
+}
+
+bool
+t_lstore::is_borrowed() const {
+    return m_owner != nullptr;
+}
+
+bool
+t_lstore::spill(const std::string& dirname) {
+    PSP_TRACE_SENTINEL();
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+
+    if (m_backing_store != BACKING_STORE_MEMORY || m_owner || m_size == 0)
+        return false;
+
+    std::stringstream ss;
+    ss << dirname << "/"
+       << "_spill_" << m_colname << "_" << this;
+    std::string fname = unique_path(ss.str());
+
+    {
+        t_rfmapping omap;
+        map_file_write(fname, m_size, omap);
+        memcpy(omap.m_base, m_base, size_t(m_size));
+    }
+
+    // The file is removed once neither the store nor a snapshot of it
+    // reads the mapping.
+    std::shared_ptr<t_rfmapping> imap(new t_rfmapping(), [fname](t_rfmapping* ptr) {
+        delete ptr;
+        rmfile(fname);
+    });
+    map_file_read(fname, *imap);
+
+    borrow(imap->m_base, m_size, imap);
+    m_spilled = true;
+    return true;
+}
+
+void
+t_lstore::reload() {
+    if (m_spilled)
+        unborrow();
+}
+
+bool
+t_lstore::is_spilled() const {
+    return m_spilled;
+}
+
+void
+t_lstore::unborrow() {
+    PSP_TRACE_SENTINEL();
+    t_uindex capacity = heap_capacity(std::max(m_alignment, m_capacity));
+    bool mapped = false;
+    void* base = heap_alloc(capacity, false, mapped);
+    memcpy(base, m_base, size_t(m_size));
+    memset(static_cast<unsigned char*>(base) + m_size, 0, size_t(capacity - m_size));
+
+    // Copying on write is counted as a clone.
+    if (t_alloc_stats::is_enabled()) {
+        t_alloc_stats::record(m_alloc_owner, ALLOC_OP_CLONE, capacity);
+    }
+
+    t_unlock_store tmp(this);
+    m_base = base;
+    m_capacity = capacity;
+    m_mapped = mapped;
+    m_owner.reset();
+    m_spilled = false;
+    ++m_version;
+}
+
 #ifdef PSP_ENABLE_PYTHON
 py::array
 t_lstore::_as_numpy(t_dtype dtype) {
@@ -47,9 +47,13 @@ t_lstore::t_lstore(const t_lstore_recipe& a)
     , m_mflags(a.m_mflags)
     , m_backing_store(a.m_backing_store)
     , m_init(false)
-    , m_resize_factor(1.3)
+    , m_page_policy(a.m_page_policy)
+    , m_mapped(false)
+    , m_resize_factor(a.m_growth_factor)
     , m_version(0)
-    , m_from_recipe(a.m_from_recipe) {
+    , m_from_recipe(a.m_from_recipe)
+    , m_alloc_owner(a.m_alloc_owner)
+    , m_spilled(false) {
     if (m_from_recipe) {
         m_fname = a.m_fname;
         return;
@@ -12,21 +12,68 @@
 #include <perspective/sym_table.h>
 #include <perspective/column.h>
 #include <tsl/hopscotch_map.h>
+#include <tsl/hopscotch_set.h>
+#include <cstring>
 #include <functional>
 #include <mutex>
 
 namespace perspective {
 
-std::mutex sym_table_mutex;
+// Size of the blocks strings are copied into; longer strings get a block of
+// their own.
+#define PSP_STRING_ARENA_BLOCK_SIZE 65536
 
-t_symtable::t_symtable() {}
+t_string_arena::t_string_arena()
+    : m_cur(nullptr)
+    , m_remaining(0)
+    , m_nbytes(0) {}
 
-t_symtable::~t_symtable() {
-    for (auto& kv : m_mapping) {
-        free(const_cast<char*>(kv.second));
+const char*
+t_string_arena::copy(const char* s, t_uindex len) {
+    t_uindex size = len + 1;
+
+    if (size > m_remaining) {
+        if (size > PSP_STRING_ARENA_BLOCK_SIZE / 4) {
+            // Keep filling the current block after a long string.
+            m_blocks.emplace_back(new char[size]);
+            m_nbytes += size;
+            char* rval = m_blocks.back().get();
+            std::memcpy(rval, s, len);
+            rval[len] = 0;
+            return rval;
+        }
+
+        m_blocks.emplace_back(new char[PSP_STRING_ARENA_BLOCK_SIZE]);
+        m_nbytes += PSP_STRING_ARENA_BLOCK_SIZE;
+        m_cur = m_blocks.back().get();
+        m_remaining = PSP_STRING_ARENA_BLOCK_SIZE;
     }
+
+    char* rval = m_cur;
+    std::memcpy(rval, s, len);
+    rval[len] = 0;
+    m_cur += size;
+    m_remaining -= size;
+    return rval;
+}
+
+t_uindex
+t_string_arena::nbytes() const {
+    return m_nbytes;
+}
+
+void
+t_string_arena::swap(t_string_arena& other) {
+    m_blocks.swap(other.m_blocks);
+    std::swap(m_cur, other.m_cur);
+    std::swap(m_remaining, other.m_remaining);
+    std::swap(m_nbytes, other.m_nbytes);
 }
 
+t_symtable::t_symtable() {}
+
+t_symtable::~t_symtable() {}
+
 const char*
 t_symtable::get_interned_cstr(const char* s) {
     auto iter = m_mapping.find(s);
@@ -35,7 +82,7 @@ t_symtable::get_interned_cstr(const char* s) {
         return iter->second;
     }
 
-    auto scopy = strdup(s);
+    auto scopy = m_arena.copy(s, std::strlen(s));
     m_mapping[scopy] = scopy;
     return scopy;
 }
@@ -69,21 +116,71 @@ t_symtable::size() const {
     return m_mapping.size();
 }
 
-static t_symtable*
-get_symtable() {
-    static t_symtable* sym = 0;
+t_uindex
+t_symtable::nbytes() const {
+    return m_arena.nbytes() + hash_map_nbytes(m_mapping);
+}
 
-    if (!sym) {
-        sym = new t_symtable;
-    }
-    return sym;
+void
+t_symtable::swap(t_symtable& other) {
+    m_mapping.swap(other.m_mapping);
+    m_arena.swap(other.m_arena);
+}
+
+namespace {
+
+// Number of independently locked shards of the global symbol table.
+#define PSP_SYMTABLE_SHARDS 64
+
+// Strings each thread remembers having interned before it starts over.
+#define PSP_SYMTABLE_CACHE_SIZE 65536
+
+struct t_symtable_shard {
+    std::mutex m_mutex;
+    t_symtable m_symtable;
+};
+
+// Never freed, so that interned strings outlive every static that holds one.
+t_symtable_shard*
+get_symtable_shards() {
+    static t_symtable_shard* shards = new t_symtable_shard[PSP_SYMTABLE_SHARDS];
+    return shards;
+}
+
+t_symtable_shard&
+get_symtable_shard(const char* s) {
+    // Mix the hash, so that its high bits pick the shard.
+    std::uint64_t hash = std::uint64_t(t_cchar_umap_hash()(s)) * 0x9E3779B97F4A7C15ULL;
+    return get_symtable_shards()[(hash >> 32) % PSP_SYMTABLE_SHARDS];
 }
 
+typedef tsl::hopscotch_set<const char*, t_cchar_umap_hash, t_cchar_umap_cmp> t_symtable_cache;
+
+} // end anonymous namespace
+
 const char*
 get_interned_cstr(const char* s) {
-    std::lock_guard<std::mutex> guard(sym_table_mutex);
-    auto sym = get_symtable();
-    return sym->get_interned_cstr(s);
+    // Keyed by interned copies, which are never freed, so hits are found
+    // without a lock.
+    static thread_local t_symtable_cache cache;
+
+    auto iter = cache.find(s);
+    if (iter != cache.end()) {
+        return *iter;
+    }
+
+    t_symtable_shard& shard = get_symtable_shard(s);
+    const char* rval;
+    {
+        std::lock_guard<std::mutex> guard(shard.m_mutex);
+        rval = shard.m_symtable.get_interned_cstr(s);
+    }
+
+    if (cache.size() >= PSP_SYMTABLE_CACHE_SIZE) {
+        cache.clear();
+    }
+    cache.insert(rval);
+    return rval;
 }
 
 t_tscalar
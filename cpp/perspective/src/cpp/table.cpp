@@ -8,6 +8,22 @@
  */
 
 #include <perspective/table.h>
+#include <perspective/compat.h>
+#include <perspective/update_log.h>
+#include <perspective/view_config.h>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+
+// The most digits after the point an int64 fixed-point column can hold.
+#define PSP_DECIMAL_MAX_SCALE 18
+
+// The cost of updating a multiset aggregate, e.g. a median, which keeps
+// every value of its group, and of a leaf-scan aggregate, which rereads
+// the rows of its group, relative to a sum.
+#define PSP_VIEW_COST_MULTISET_WEIGHT 8
+#define PSP_VIEW_COST_LEAF_SCAN_WEIGHT 4
 
 // Give each Table a unique ID so that operations on it map back correctly
 static perspective::t_uindex GLOBAL_TABLE_ID = 0;
@@ -27,29 +43,31 @@ Table::Table(
     , m_offset(0)
     , m_limit(limit)
     , m_index(index)
-    , m_gnode_set(false) {
+    , m_gnode_set(false)
+    , m_checkpoint_slot(0)
+    , m_replication_listener(0) {
         validate_columns(m_column_names);
     }
 
 void
-Table::init(t_data_table& data_table, std::uint32_t row_count, const t_op op, const t_uindex port_id) {
+Table::init(std::shared_ptr<t_data_table> data_table, std::uint32_t row_count, const t_op op, const t_uindex port_id) {
     /**
      * For the Table to be initialized correctly, make sure that the operation and index columns are
      * processed before the new offset is calculated. Calculating the offset before the `process_op_column`
      * and `process_index_column` causes primary keys to be misaligned.
      */
-    process_op_column(data_table, op);
+    process_op_column(*data_table, op);
     calculate_offset(row_count);
 
     if (!m_gnode_set) {
         // create a new gnode, send it to the table
-        auto new_gnode = make_gnode(data_table.get_schema());
+        auto new_gnode = make_gnode(data_table->get_schema());
         set_gnode(new_gnode);
         m_pool->register_gnode(m_gnode.get());
     }
 
     PSP_VERBOSE_ASSERT(m_gnode_set, "gnode is not set!");
-    m_pool->send(m_gnode->get_id(), port_id, data_table);
+    m_pool->send(m_gnode->get_id(), port_id, std::move(data_table));
 
     m_init = true;
 }
@@ -60,6 +78,30 @@ Table::size() const {
     return m_gnode->get_table()->size();
 }
 
+std::map<std::string, t_uindex>
+Table::get_memory_usage() const {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    return m_gnode->get_memory_usage();
+}
+
+std::map<std::string, double>
+Table::get_update_stats() const {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    return m_gnode->get_update_stats();
+}
+
+std::map<std::string, double>
+Table::get_latency_stats() const {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    return m_gnode->get_latency_stats();
+}
+
+void
+Table::reset_latency_stats() {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    m_gnode->reset_latency_stats();
+}
+
 t_schema
 Table::get_schema() const {
     PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
@@ -170,11 +212,93 @@ Table::get_computed_schema(
     return computed_schema;
 }
 
+std::map<std::string, double>
+Table::estimate_view_cost(const t_view_config& config) const {
+    std::shared_ptr<t_data_table> master = m_gnode->get_table_sptr();
+    const t_schema& schema = master->get_schema();
+    double rows = m_gnode->mapping_size();
+
+    // The distinct values of a string pivot are bounded by its vocabulary,
+    // and of other pivots by the rows.
+    auto cardinality = [&](const std::string& name) -> double {
+        if (!schema.has_column(name)) {
+            return rows;
+        }
+        switch (schema.get_dtype(name)) {
+            case DTYPE_STR: {
+                return std::max<double>(master->get_const_column(name)->get_vlenidx(), 1);
+            }
+            case DTYPE_BOOL: {
+                return 2;
+            }
+            default: { return rows; }
+        }
+    };
+
+    // The nodes of a tree of `pivots`, and its leaves, where each depth has
+    // at most a node for each row.
+    auto count_nodes = [&](const std::vector<std::string>& pivots, double& leaves) {
+        double nodes = 1;
+        leaves = 1;
+        for (const std::string& pivot : pivots) {
+            leaves = std::min(rows, leaves * cardinality(pivot));
+            nodes += leaves;
+        }
+        return nodes;
+    };
+
+    std::vector<std::string> row_pivots = config.get_row_pivots();
+    std::vector<std::string> column_pivots = config.get_column_pivots();
+    double depth = row_pivots.size() + column_pivots.size();
+    double row_leaves = 0;
+    double column_leaves = 0;
+    double nodes = count_nodes(row_pivots, row_leaves);
+    double column_nodes = count_nodes(column_pivots, column_leaves);
+    if (!column_pivots.empty()) {
+        // Each cell of a two-sided view is a node of its own.
+        nodes = std::min(rows * (depth + 1), nodes * column_nodes);
+    }
+    double groups = depth > 0 ? std::min(rows, row_leaves * column_leaves) : rows;
+
+    // Each row is filtered and computed, then updates each of its nodes.
+    double row_cost = 1 + config.get_fterm().size() + config.get_filter_expr().num_terms()
+        + config.get_computed_columns().size();
+    if (depth > 0) {
+        double aggregate_cost = 0;
+        for (const t_aggspec& aggspec : config.get_aggspecs()) {
+            if (aggspec.is_multiset_agg()) {
+                aggregate_cost += PSP_VIEW_COST_MULTISET_WEIGHT;
+            } else if (aggspec.is_leaf_scan_agg()) {
+                aggregate_cost += PSP_VIEW_COST_LEAF_SCAN_WEIGHT;
+            } else {
+                aggregate_cost += 1;
+            }
+        }
+        row_cost += (depth + 1) * aggregate_cost;
+    }
+
+    double cost = rows * row_cost;
+    if (!config.get_sortspec().empty()) {
+        double sorted = depth > 0 ? nodes : rows;
+        cost += sorted * std::log2(std::max(sorted, 2.0));
+    }
+
+    return {{"rows", rows}, {"groups", groups}, {"nodes", depth > 0 ? nodes : 0},
+        {"cost", cost}};
+}
+
 std::shared_ptr<t_gnode>
 Table::make_gnode(const t_schema& in_schema) {
     t_schema out_schema = in_schema.drop({"psp_pkey", "psp_op"}); 
     auto gnode = std::make_shared<t_gnode>(in_schema, out_schema);
     gnode->init();
+
+    // Rows of an implicitly indexed table past its limit replace the rows
+    // with the same key modulo the limit, so the state never holds more.
+    if (m_index.empty() && m_limit != std::numeric_limits<std::uint32_t>::max()) {
+        gnode->set_row_limit(m_limit);
+    }
+
     return gnode;
 }
 
@@ -195,6 +319,9 @@ Table::reset_gnode(t_uindex id) {
     PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
     t_gnode* gnode = m_pool->get_gnode(id);
     gnode->reset();
+    if (m_replication_publisher) {
+        m_replication_publisher->publish_clear();
+    }
 }
 
 t_uindex
@@ -216,6 +343,355 @@ Table::calculate_offset(std::uint32_t row_count) {
     m_offset = (m_offset + row_count) % m_limit;
 }
 
+void
+Table::save_snapshot(const std::string& dirname) const {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    PSP_VERBOSE_ASSERT(m_gnode_set, "Cannot save snapshot of a gnode that does not exist.");
+    m_gnode->save_snapshot(dirname);
+
+    // The offset positions the implicit index of the next update.
+    std::ofstream table_file(dirname + "/table");
+    table_file << m_index << "\n" << m_offset << "\n";
+    PSP_VERBOSE_ASSERT(table_file.good(), "Could not write snapshot");
+}
+
+void
+Table::load_snapshot(const std::string& dirname) {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    PSP_VERBOSE_ASSERT(m_gnode_set, "Cannot load snapshot into a gnode that does not exist.");
+
+    std::ifstream table_file(dirname + "/table");
+    std::string index;
+    std::uint32_t offset;
+    std::getline(table_file, index);
+    table_file >> offset;
+    if (!table_file.good()) {
+        PSP_COMPLAIN_AND_ABORT("Could not read snapshot in `" + dirname + "`");
+    }
+
+    if (index != m_index) {
+        PSP_COMPLAIN_AND_ABORT("Snapshot index `" + index + "` does not match table index `"
+            + m_index + "`");
+    }
+
+    m_gnode->load_snapshot(dirname);
+    m_offset = offset;
+}
+
+namespace {
+
+std::string
+checkpoint_dirname(const std::string& dirname, t_uindex slot) {
+    std::stringstream ss;
+    ss << dirname << "/checkpoint." << slot;
+    return ss.str();
+}
+
+// Returns whether the checkpoint `slot` was completely written, and if so
+// sets `seq` to the last update log record it contains.
+bool
+read_checkpoint_marker(const std::string& dirname, t_uindex slot, std::uint64_t& seq) {
+    std::ifstream marker(checkpoint_dirname(dirname, slot) + "/checkpoint");
+    std::string magic;
+    marker >> magic >> seq;
+    return !marker.fail() && magic == "perspective-checkpoint";
+}
+
+} // namespace
+
+void
+Table::enable_update_log(const std::string& dirname) {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    PSP_VERBOSE_ASSERT(m_gnode_set, "Cannot log updates to a gnode that does not exist.");
+
+    // Checkpoints left in `dirname` by another log would be newer than the
+    // first one of this log.
+    for (t_uindex slot = 0; slot < 2; ++slot) {
+        std::string slot_dirname = checkpoint_dirname(dirname, slot);
+        rmfile(slot_dirname + "/checkpoint");
+        sync_dir(slot_dirname);
+    }
+
+    m_log_dirname = dirname;
+    m_checkpoint_slot = 0;
+    m_gnode->set_update_log(std::make_shared<t_update_log>(dirname, true));
+    checkpoint();
+}
+
+void
+Table::checkpoint() {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    std::shared_ptr<t_update_log> update_log = m_gnode->get_update_log();
+    PSP_VERBOSE_ASSERT(update_log, "Cannot checkpoint a table without an update log.");
+
+    // Invalidate the older checkpoint before overwriting it, so that a crash
+    // part way through leaves only the newer one to recover from. The log
+    // is truncated only once the new checkpoint is on disk.
+    std::string slot_dirname = checkpoint_dirname(m_log_dirname, m_checkpoint_slot);
+    std::string marker_fname = slot_dirname + "/checkpoint";
+    rmfile(marker_fname);
+    sync_dir(slot_dirname);
+
+    std::uint64_t seq = update_log->last_seq();
+    save_snapshot(slot_dirname);
+    std::ofstream marker(marker_fname);
+    marker << "perspective-checkpoint " << seq << "\n";
+    marker.close();
+    PSP_VERBOSE_ASSERT(marker.good(), "Could not write checkpoint");
+    sync_dir(slot_dirname);
+
+    update_log->truncate();
+    m_checkpoint_slot = 1 - m_checkpoint_slot;
+}
+
+void
+Table::flush_update_log() {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    std::shared_ptr<t_update_log> update_log = m_gnode->get_update_log();
+    PSP_VERBOSE_ASSERT(update_log, "Cannot flush a table without an update log.");
+    update_log->flush();
+}
+
+void
+Table::recover_from_log(const std::string& dirname) {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    PSP_VERBOSE_ASSERT(m_gnode_set, "Cannot recover into a gnode that does not exist.");
+
+    std::uint64_t seqs[2];
+    bool valid[2];
+    for (t_uindex slot = 0; slot < 2; ++slot) {
+        valid[slot] = read_checkpoint_marker(dirname, slot, seqs[slot]);
+    }
+
+    if (!valid[0] && !valid[1]) {
+        PSP_COMPLAIN_AND_ABORT("No checkpoint to recover from in `" + dirname + "`");
+    }
+
+    t_uindex slot = (valid[0] && (!valid[1] || seqs[0] >= seqs[1])) ? 0 : 1;
+    std::uint64_t checkpoint_seq = seqs[slot];
+
+    m_gnode->set_update_log(nullptr);
+    load_snapshot(checkpoint_dirname(dirname, slot));
+
+    // Records up to the checkpoint's are already in it. Each record was sent
+    // after its primary keys were assigned, so only the offset needs to be
+    // advanced as it is replayed onto the port it was sent to.
+    t_update_log::read(dirname,
+        [this, checkpoint_seq](std::uint64_t seq, t_uindex port_id, const t_data_table& tbl) {
+            if (seq <= checkpoint_seq) {
+                return;
+            }
+
+            m_gnode->make_input_port(port_id);
+            m_gnode->send(port_id, tbl);
+            m_gnode->process(port_id);
+            calculate_offset(tbl.size());
+        });
+
+    m_log_dirname = dirname;
+    m_checkpoint_slot = 1 - slot;
+    m_gnode->set_update_log(std::make_shared<t_update_log>(dirname, false, checkpoint_seq));
+}
+
+void
+Table::enable_replication() {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    PSP_VERBOSE_ASSERT(m_gnode_set, "Cannot replicate a gnode that does not exist.");
+    if (m_replication_publisher) {
+        return;
+    }
+
+    auto publisher = std::make_shared<t_replication_publisher>(
+        m_gnode->get_state_input_schema(), m_index, m_limit);
+    m_replication_listener = m_gnode->add_update_listener(
+        [publisher](const t_data_table& flattened) { publisher->publish(flattened); });
+    m_replication_publisher = publisher;
+}
+
+std::vector<std::shared_ptr<std::string>>
+Table::take_replication_batches() {
+    PSP_VERBOSE_ASSERT(m_replication_publisher, "Replication is not enabled.");
+    return m_replication_publisher->take();
+}
+
+std::shared_ptr<std::string>
+Table::get_replication_snapshot() const {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    PSP_VERBOSE_ASSERT(m_gnode_set, "Cannot replicate a gnode that does not exist.");
+    const t_schema& schema = m_gnode->get_state_input_schema();
+    t_replication_publisher publisher(schema, m_index, m_limit);
+    std::unique_ptr<t_data_table> rows(m_gnode->_get_pkeyed_table());
+    return publisher.encode(*rows, REPLICATION_UPDATE);
+}
+
+void
+Table::apply_replication_batch(const std::string& bytes) {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    PSP_VERBOSE_ASSERT(m_gnode_set, "Cannot apply a batch to a gnode that does not exist.");
+    t_replication_batch batch(bytes);
+    if (batch.get_index() != m_index) {
+        PSP_COMPLAIN_AND_ABORT("Cannot apply a replication batch of a table indexed by `"
+            + batch.get_index() + "` to a table indexed by `" + m_index + "`");
+    }
+
+    // Batches sent before a reset must have been processed, as the reset
+    // is not queued behind them.
+    if (batch.get_kind() == REPLICATION_CLEAR) {
+        reset_gnode(m_gnode->get_id());
+        return;
+    }
+
+    // The rows are flattened and their ops set, so they are sent as they
+    // are rather than through `init`.
+    m_pool->send(m_gnode->get_id(), 0, batch.make_table(m_gnode->get_state_input_schema()));
+    calculate_offset(batch.size());
+}
+
+std::shared_ptr<Table>
+Table::make_replica(std::shared_ptr<t_pool> pool, const std::string& snapshot) {
+    t_replication_batch batch(snapshot);
+    if (batch.get_kind() != REPLICATION_UPDATE) {
+        PSP_COMPLAIN_AND_ABORT("Cannot create a replica from a batch which is not a snapshot");
+    }
+
+    const t_schema& schema = batch.get_schema();
+    t_schema columns = schema.drop({"psp_pkey", "psp_okey", "psp_op"});
+    auto table = std::make_shared<Table>(
+        pool, columns.m_columns, columns.m_types, batch.get_limit(), batch.get_index());
+    table->init(batch.make_table(schema), batch.size(), OP_INSERT, 0);
+    return table;
+}
+
+void
+Table::share_dictionary(const std::string& colname, std::shared_ptr<Table> other,
+    const std::string& other_colname) {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    PSP_VERBOSE_ASSERT(m_gnode_set && other->m_gnode_set,
+        "Cannot share a dictionary with a gnode that does not exist.");
+    m_gnode->share_vocabulary(colname, other->m_gnode->get_shared_vocabulary(other_colname));
+}
+
+void
+Table::create_index(const std::string& colname) {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    PSP_VERBOSE_ASSERT(m_gnode_set, "Cannot index a column of a gnode that does not exist.");
+    m_gnode->create_index(colname);
+}
+
+void
+Table::create_sorted_index(const std::string& colname, const std::string& order) {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    PSP_VERBOSE_ASSERT(m_gnode_set, "Cannot index a column of a gnode that does not exist.");
+    m_gnode->create_sorted_index(colname, str_to_sorttype(order));
+}
+
+t_uindex
+Table::remove_where(
+    const std::vector<t_fterm>& fterms, t_filter_op combiner, t_uindex port_id) {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    PSP_VERBOSE_ASSERT(m_gnode_set, "Cannot remove from a gnode that does not exist.");
+    if (m_index == "") {
+        return 0;
+    }
+
+    std::vector<t_tscalar> pkeys;
+    {
+        auto lock = m_pool->lock_gnode(m_gnode->get_id());
+        pkeys = m_gnode->get_pkeys_where(fterms, combiner);
+    }
+
+    if (pkeys.empty()) {
+        return 0;
+    }
+
+    // The index and primary key columns, as the bindings send removes.
+    auto data = std::make_shared<t_data_table>(
+        t_schema({m_index}, {m_gnode->get_table()->get_schema().get_dtype(m_index)}));
+    data->init();
+    data->extend(pkeys.size());
+    std::shared_ptr<t_column> index_col = data->get_column(m_index);
+    for (t_uindex idx = 0, loop_end = pkeys.size(); idx < loop_end; ++idx) {
+        index_col->set_scalar(idx, pkeys[idx]);
+    }
+
+    data->clone_column(m_index, "psp_pkey");
+    data->clone_column(m_index, "psp_okey");
+    init(data, pkeys.size(), OP_DELETE, port_id);
+    return pkeys.size();
+}
+
+t_uindex
+Table::compact_rows() {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    PSP_VERBOSE_ASSERT(m_gnode_set, "Cannot compact a gnode that does not exist.");
+    return m_gnode->compact_rows();
+}
+
+void
+Table::set_column_spill(const std::string& dirname, double idle_seconds) {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    PSP_VERBOSE_ASSERT(m_gnode_set, "Cannot spill a gnode that does not exist.");
+    m_gnode->set_column_spill(dirname, idle_seconds);
+}
+
+t_uindex
+Table::spill_cold_columns() {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    PSP_VERBOSE_ASSERT(m_gnode_set, "Cannot spill a gnode that does not exist.");
+    return m_gnode->spill_cold_columns();
+}
+
+void
+Table::set_column_packing(bool enabled, double idle_seconds) {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    PSP_VERBOSE_ASSERT(m_gnode_set, "Cannot pack a gnode that does not exist.");
+    m_gnode->set_column_packing(enabled, idle_seconds);
+}
+
+t_uindex
+Table::pack_cold_columns() {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    PSP_VERBOSE_ASSERT(m_gnode_set, "Cannot pack a gnode that does not exist.");
+    return m_gnode->pack_cold_columns();
+}
+
+t_uindex
+Table::reclaim_memory(t_uindex nbytes) {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    PSP_VERBOSE_ASSERT(m_gnode_set, "Cannot reclaim a gnode that does not exist.");
+    auto lock = m_pool->lock_gnode(m_gnode->get_id());
+    return m_gnode->reclaim_memory(nbytes);
+}
+
+void
+Table::set_column_scale(const std::string& name, std::int32_t scale) {
+    auto iter = std::find(m_column_names.begin(), m_column_names.end(), name);
+    if (iter == m_column_names.end()
+        || m_data_types[std::distance(m_column_names.begin(), iter)] != DTYPE_INT64) {
+        PSP_COMPLAIN_AND_ABORT("Cannot set the scale of `" + name + "`, which is not an int64 column");
+    }
+    if (scale < 0 || scale > PSP_DECIMAL_MAX_SCALE) {
+        PSP_COMPLAIN_AND_ABORT("Decimal scale of `" + name + "` must be between 0 and 18");
+    }
+
+    if (scale == 0) {
+        m_column_scales.erase(name);
+    } else {
+        m_column_scales[name] = scale;
+    }
+}
+
+std::int32_t
+Table::get_column_scale(const std::string& name) const {
+    auto iter = m_column_scales.find(name);
+    return iter == m_column_scales.end() ? 0 : iter->second;
+}
+
+const std::map<std::string, std::int32_t>&
+Table::get_column_scales() const {
+    return m_column_scales;
+}
+
 t_uindex
 Table::get_id() const {
     return m_id;
@@ -0,0 +1,239 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2017, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#include <perspective/first.h>
+#include <perspective/tdigest.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// The compression of the digest; a digest holds at most about this many
+// centroids.
+#define PSP_TDIGEST_COMPRESSION 100
+
+// Values are merged into the centroids once this many have been buffered.
+#define PSP_TDIGEST_BUFFER_SIZE (5 * PSP_TDIGEST_COMPRESSION)
+
+namespace perspective {
+
+namespace {
+    // The k1 scale function, which bounds the weight of a centroid by its
+    // distance from the tails.
+    double
+    scale_k(double q) {
+        return PSP_TDIGEST_COMPRESSION / (2 * std::acos(-1.0)) * std::asin(2 * q - 1);
+    }
+} // namespace
+
+t_tdigest::t_tdigest()
+    : m_weight(0)
+    , m_min(std::numeric_limits<double>::infinity())
+    , m_max(-std::numeric_limits<double>::infinity())
+    , m_inserted(0)
+    , m_removed(0) {}
+
+void
+t_tdigest::insert(double value) {
+    if (std::isnan(value)) {
+        return;
+    }
+
+    m_buffer.push_back(value);
+    m_weight += 1;
+    m_min = std::min(m_min, value);
+    m_max = std::max(m_max, value);
+    ++m_inserted;
+
+    if (m_buffer.size() >= PSP_TDIGEST_BUFFER_SIZE) {
+        flush();
+    }
+}
+
+void
+t_tdigest::remove(double value) {
+    if (std::isnan(value) || m_weight == 0) {
+        return;
+    }
+
+    ++m_removed;
+    m_weight -= 1;
+
+    auto buffered = std::find(m_buffer.begin(), m_buffer.end(), value);
+    if (buffered != m_buffer.end()) {
+        *buffered = m_buffer.back();
+        m_buffer.pop_back();
+        return;
+    }
+
+    if (m_centroids.empty()) {
+        // Removed more values than were buffered.
+        m_weight = static_cast<double>(m_buffer.size());
+        return;
+    }
+
+    auto iter = std::lower_bound(m_centroids.begin(), m_centroids.end(),
+        std::make_pair(value, -std::numeric_limits<double>::infinity()));
+    if (iter == m_centroids.end()
+        || (iter != m_centroids.begin()
+            && value - std::prev(iter)->first < iter->first - value)) {
+        --iter;
+    }
+
+    if (iter->second <= 1) {
+        m_centroids.erase(iter);
+    } else {
+        iter->first = (iter->first * iter->second - value) / (iter->second - 1);
+        iter->second -= 1;
+    }
+}
+
+void
+t_tdigest::merge(const t_tdigest& other) {
+    if (other.m_weight == 0) {
+        return;
+    }
+
+    flush();
+    m_centroids.insert(
+        m_centroids.end(), other.m_centroids.begin(), other.m_centroids.end());
+    for (double value : other.m_buffer) {
+        m_centroids.emplace_back(value, 1);
+    }
+
+    m_weight += other.m_weight;
+    m_min = std::min(m_min, other.m_min);
+    m_max = std::max(m_max, other.m_max);
+    m_inserted += other.m_inserted;
+    m_removed += other.m_removed;
+    compress();
+}
+
+bool
+t_tdigest::needs_rebuild() const {
+    return m_removed > 0 && 2 * m_removed > m_inserted;
+}
+
+void
+t_tdigest::clear() {
+    m_centroids.clear();
+    m_buffer.clear();
+    m_weight = 0;
+    m_min = std::numeric_limits<double>::infinity();
+    m_max = -std::numeric_limits<double>::infinity();
+    m_inserted = 0;
+    m_removed = 0;
+}
+
+double
+t_tdigest::weight() const {
+    return m_weight;
+}
+
+void
+t_tdigest::flush() {
+    if (m_buffer.empty()) {
+        return;
+    }
+
+    for (double value : m_buffer) {
+        m_centroids.emplace_back(value, 1);
+    }
+
+    m_buffer.clear();
+    compress();
+}
+
+void
+t_tdigest::compress() {
+    std::vector<std::pair<double, double>> centroids;
+    centroids.swap(m_centroids);
+    std::sort(centroids.begin(), centroids.end());
+
+    double total = 0;
+    for (const auto& c : centroids) {
+        total += c.second;
+    }
+
+    // Each centroid absorbs its successors for as long as it spans at most
+    // one unit of the scale function.
+    double so_far = 0;
+    for (const auto& c : centroids) {
+        if (!m_centroids.empty()) {
+            auto& last = m_centroids.back();
+            double q0 = (so_far - last.second) / total;
+            double q2 = (so_far + c.second) / total;
+            if (scale_k(q2) - scale_k(q0) <= 1) {
+                last.first += (c.first - last.first) * c.second / (last.second + c.second);
+                last.second += c.second;
+                so_far += c.second;
+                continue;
+            }
+        }
+
+        m_centroids.push_back(c);
+        so_far += c.second;
+    }
+}
+
+double
+t_tdigest::quantile(double q) {
+    flush();
+
+    if (m_centroids.empty()) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    if (m_centroids.size() == 1) {
+        return m_centroids[0].first;
+    }
+
+    q = std::min(std::max(q, 0.0), 1.0);
+    double target = q * m_weight;
+
+    // Each centroid's mean is taken to sit at the middle of its weight, and
+    // the quantiles between two means are interpolated linearly; beyond the
+    // outermost means, towards the smallest and largest values seen.
+    double lo = std::min(m_min, m_centroids.front().first);
+    double hi = std::max(m_max, m_centroids.back().first);
+    double first_center = m_centroids.front().second / 2;
+    if (target <= first_center) {
+        if (first_center == 0) {
+            return m_centroids.front().first;
+        }
+        return lo + (m_centroids.front().first - lo) * target / first_center;
+    }
+
+    double so_far = 0;
+    for (t_uindex i = 0; i + 1 < m_centroids.size(); ++i) {
+        const auto& a = m_centroids[i];
+        const auto& b = m_centroids[i + 1];
+        double a_center = so_far + a.second / 2;
+        double b_center = so_far + a.second + b.second / 2;
+        if (target <= b_center) {
+            return a.first + (b.first - a.first) * (target - a_center) / (b_center - a_center);
+        }
+        so_far += a.second;
+    }
+
+    const auto& last = m_centroids.back();
+    double last_center = m_weight - last.second / 2;
+    double rest = m_weight - last_center;
+    if (rest <= 0) {
+        return last.first;
+    }
+    return last.first + (hi - last.first) * (target - last_center) / rest;
+}
+
+t_uindex
+t_tdigest::nbytes() const {
+    return m_centroids.capacity() * sizeof(std::pair<double, double>)
+        + m_buffer.capacity() * sizeof(double);
+}
+
+} // end namespace perspective
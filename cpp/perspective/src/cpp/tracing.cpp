@@ -10,51 +10,411 @@
 #include <perspective/first.h>
 #include <perspective/base.h>
 #include <perspective/tracing.h>
-#include <perspective/compat.h>
-#include <sys/types.h>
-#include <sys/syscall.h>
-#include <sys/resource.h>
-#include <sys/mman.h>
-#include <sys/stat.h>
-#include <fcntl.h>
-#include <stdlib.h>
-#include <stdio.h>
-#include <sstream>
-#include <cxxabi.h>
-#include <fstream>
-#include <tsl/hopscotch_set.h>
-#include <execinfo.h>
+#include <perspective/env_vars.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <cstring>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace perspective {
 
-#define THR_BUFFER_NELEMS 1000000
-#define THR_MAX_FUNCNAME_LEN 16000;
+namespace {
+    /**
+     * @brief The spans recorded by one thread. The buffer outlives its
+     * thread, so that the spans of exited threads are exported too.
+     */
+    struct t_trace_buffer {
+        t_trace_buffer(t_uindex tid, t_uindex capacity)
+            : m_tid(tid)
+            , m_next(0)
+            , m_wrapped(false)
+            , m_records(capacity == 0 ? 1 : capacity) {}
 
-static thread_local perspective::t_instrec th_trace_buffer[THR_BUFFER_NELEMS];
-static thread_local perspective::std::int32_t th_traceidx;
-static thread_local FILE* th_file;
+        // Only contended while the buffer is exported or cleared.
+        std::mutex m_mtx;
+        t_uindex m_tid;
+        t_uindex m_next;
+        bool m_wrapped;
+        std::vector<t_instrec> m_records;
+    };
 
-namespace perspective {
-t_trace::t_trace() { write_record(TRACE_TYPE_FNTRACE_BEGIN); }
+    struct t_trace_registry {
+        std::mutex m_mtx;
+        std::vector<std::shared_ptr<t_trace_buffer>> m_buffers;
+        std::vector<std::string> m_names;
+        std::unordered_map<std::string, std::uint64_t> m_name_ids;
+    };
+
+    t_trace_registry&
+    get_registry() {
+        static t_trace_registry* registry = new t_trace_registry();
+        return *registry;
+    }
+
+    thread_local std::uint16_t TRACE_DEPTH = 0;
+
+    t_trace_buffer&
+    get_thread_buffer() {
+        static thread_local std::shared_ptr<t_trace_buffer> buffer;
+        if (!buffer) {
+            t_trace_registry& registry = get_registry();
+            std::lock_guard<std::mutex> lg(registry.m_mtx);
+            buffer = std::make_shared<t_trace_buffer>(
+                registry.m_buffers.size() + 1, t_env::trace_buffer_size());
+            registry.m_buffers.push_back(buffer);
+        }
+        return *buffer;
+    }
+
+    /**
+     * @brief The phase of one thread, `1 +` the name id of its innermost
+     * span or 0 outside every span, written by the thread and read by the
+     * sampler.
+     */
+    struct t_phase_slot {
+        t_phase_slot()
+            : m_phase(0) {}
+
+        std::atomic<std::uint64_t> m_phase;
+    };
+
+    struct t_profile_state {
+        std::mutex m_mtx;
+        std::condition_variable m_enabled_cv;
+        std::vector<std::shared_ptr<t_phase_slot>> m_slots;
+
+        // samples by phase, and the ticks they were taken in
+        std::vector<std::uint64_t> m_samples;
+        std::uint64_t m_ticks = 0;
+#ifndef PSP_PARALLEL_FOR
+        std::int64_t m_last_tick = 0;
+#endif
+    };
+
+    t_profile_state&
+    get_profile_state() {
+        static t_profile_state* state = new t_profile_state();
+        return *state;
+    }
+
+    t_phase_slot&
+    get_thread_slot() {
+        static thread_local std::shared_ptr<t_phase_slot> slot;
+        if (!slot) {
+            t_profile_state& state = get_profile_state();
+            std::lock_guard<std::mutex> lg(state.m_mtx);
+            slot = std::make_shared<t_phase_slot>();
+            state.m_slots.push_back(slot);
+        }
+        return *slot;
+    }
+
+    // Count the phase of every thread `nticks` times; `state.m_mtx` is held.
+    void
+    sample(t_profile_state& state, std::uint64_t nticks) {
+        for (const auto& slot : state.m_slots) {
+            std::uint64_t phase = slot->m_phase.load(std::memory_order_relaxed);
+            if (phase >= state.m_samples.size()) {
+                state.m_samples.resize(phase + 1, 0);
+            }
+            state.m_samples[phase] += nticks;
+        }
+        state.m_ticks += nticks;
+    }
+
+#ifdef PSP_PARALLEL_FOR
+    void
+    run_sampler() {
+        t_profile_state& state = get_profile_state();
+        auto interval = std::chrono::microseconds(
+            std::max<t_uindex>(t_env::profile_interval_us(), 1));
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(state.m_mtx);
+                state.m_enabled_cv.wait(lock, [] { return t_profiler::is_enabled(); });
+            }
+
+            std::this_thread::sleep_for(interval);
+            std::lock_guard<std::mutex> lg(state.m_mtx);
+            if (t_profiler::is_enabled()) {
+                sample(state, 1);
+            }
+        }
+    }
+#else
+    // Without a sampler thread, credit the current phase with every tick
+    // elapsed since the last, before the phase changes.
+    void
+    sample_elapsed() {
+        t_profile_state& state = get_profile_state();
+        std::int64_t interval
+            = std::max<std::int64_t>(t_env::profile_interval_us(), 1) * 1000;
+        std::int64_t now = t_tracer::now();
+        std::lock_guard<std::mutex> lg(state.m_mtx);
+        if (state.m_last_tick == 0) {
+            state.m_last_tick = now;
+            return;
+        }
 
-t_trace::~t_trace() { write_record(TRACE_TYPE_FNTRACE_END); }
+        std::int64_t nticks = (now - state.m_last_tick) / interval;
+        if (nticks > 0) {
+            sample(state, nticks);
+            state.m_last_tick += nticks * interval;
+        }
+    }
+#endif
+} // namespace
+
+std::atomic<bool> t_tracer::ENABLED(t_env::trace());
+
+void
+t_tracer::set_enabled(bool enabled) {
+    ENABLED.store(enabled, std::memory_order_relaxed);
+}
+
+std::uint64_t
+t_tracer::intern(const char* name) {
+    t_trace_registry& registry = get_registry();
+    std::lock_guard<std::mutex> lg(registry.m_mtx);
+    auto iter = registry.m_name_ids.find(name);
+    if (iter != registry.m_name_ids.end()) {
+        return iter->second;
+    }
+
+    std::uint64_t name_id = registry.m_names.size();
+    registry.m_names.push_back(name);
+    registry.m_name_ids[name] = name_id;
+    return name_id;
+}
+
+std::int64_t
+t_tracer::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
 
 void
-t_trace::write_record(t_trace_type ttype) const {
-    if (th_traceidx == THR_BUFFER_NELEMS) {
-        flush_thbuffer(THR_BUFFER_NELEMS);
-        th_traceidx = 0;
-    }
-    t_instrec* ptr = th_trace_buffer + th_traceidx;
-    ptr = th_trace_buffer + th_traceidx;
-    ptr->m_trace_type = ttype;
-    ptr->m_time = psp_curtime();
-    ptr->t_fntrace.m_fn = __builtin_extract_return_addr(__builtin_return_address(0));
-    ++th_traceidx;
-}
-
-t_uindex
-get_instrec_size() {
-    return sizeof(t_instrec);
+t_tracer::write_span(std::uint64_t name_id, std::int64_t begin, std::uint64_t duration,
+    std::uint16_t depth, const char* arg) {
+    t_trace_buffer& buffer = get_thread_buffer();
+    std::lock_guard<std::mutex> lg(buffer.m_mtx);
+
+    t_instrec& rec = buffer.m_records[buffer.m_next];
+    rec.m_time = begin;
+    rec.m_id = name_id;
+    rec.m_trace_type = TRACE_TYPE_DURATION_TWO_SIDED;
+    rec.t_fntrace.m_duration = duration;
+    rec.t_fntrace.m_depth = depth;
+    std::memset(rec.t_fntrace.m_payload, 0, sizeof(rec.t_fntrace.m_payload));
+    if (arg != nullptr) {
+        std::strncpy(rec.t_fntrace.m_payload, arg, sizeof(rec.t_fntrace.m_payload));
+    }
+
+    if (++buffer.m_next == buffer.m_records.size()) {
+        buffer.m_next = 0;
+        buffer.m_wrapped = true;
+    }
+}
+
+std::string
+t_tracer::to_chrome_json() {
+    t_trace_registry& registry = get_registry();
+    std::vector<std::shared_ptr<t_trace_buffer>> buffers;
+    std::vector<std::string> names;
+    {
+        std::lock_guard<std::mutex> lg(registry.m_mtx);
+        buffers = registry.m_buffers;
+        names = registry.m_names;
+    }
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(3);
+    ss << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    for (const auto& buffer : buffers) {
+        std::lock_guard<std::mutex> lg(buffer->m_mtx);
+        t_uindex size = buffer->m_wrapped ? buffer->m_records.size() : buffer->m_next;
+        t_uindex start = buffer->m_wrapped ? buffer->m_next : 0;
+        for (t_uindex idx = 0; idx < size; ++idx) {
+            const t_instrec& rec
+                = buffer->m_records[(start + idx) % buffer->m_records.size()];
+            const std::string& name = names[rec.m_id];
+
+            if (!first) {
+                ss << ",";
+            }
+            first = false;
+
+            // Chrome trace timestamps are in microseconds.
+            ss << "{\"name\":";
+            write_json_string(ss, name.c_str(), name.size());
+            ss << ",\"cat\":\"perspective\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->m_tid
+               << ",\"ts\":" << rec.m_time / 1000.0
+               << ",\"dur\":" << rec.t_fntrace.m_duration / 1000.0
+               << ",\"args\":{\"depth\":" << rec.t_fntrace.m_depth;
+            std::size_t arg_len = strnlen(rec.t_fntrace.m_payload, sizeof(rec.t_fntrace.m_payload));
+            if (arg_len > 0) {
+                ss << ",\"arg\":";
+                write_json_string(ss, rec.t_fntrace.m_payload, arg_len);
+            }
+            ss << "}}";
+        }
+    }
+    ss << "]}";
+    return ss.str();
+}
+
+void
+t_tracer::clear() {
+    t_trace_registry& registry = get_registry();
+    std::vector<std::shared_ptr<t_trace_buffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lg(registry.m_mtx);
+        buffers = registry.m_buffers;
+    }
+
+    for (const auto& buffer : buffers) {
+        std::lock_guard<std::mutex> lg(buffer->m_mtx);
+        buffer->m_next = 0;
+        buffer->m_wrapped = false;
+    }
+}
+
+std::atomic<bool> t_profiler::ENABLED(false);
+
+namespace {
+    // Start sampling at load if `PSP_PROFILE` is set, which must follow the
+    // initialization of `ENABLED`.
+    struct t_profiler_autostart {
+        t_profiler_autostart() {
+            if (t_env::profile()) {
+                t_profiler::set_enabled(true);
+            }
+        }
+    };
+
+    t_profiler_autostart PROFILER_AUTOSTART;
+} // namespace
+
+void
+t_profiler::set_enabled(bool enabled) {
+    t_profile_state& state = get_profile_state();
+#ifdef PSP_PARALLEL_FOR
+    if (enabled) {
+        static std::once_flag started;
+        std::call_once(started, [] { std::thread(run_sampler).detach(); });
+    }
+#endif
+
+    {
+        std::lock_guard<std::mutex> lg(state.m_mtx);
+#ifndef PSP_PARALLEL_FOR
+        state.m_last_tick = 0;
+#endif
+        ENABLED.store(enabled, std::memory_order_relaxed);
+    }
+    state.m_enabled_cv.notify_all();
+}
+
+std::map<std::string, double>
+t_profiler::get_profile() {
+    std::vector<std::uint64_t> samples;
+    {
+        t_profile_state& state = get_profile_state();
+        std::lock_guard<std::mutex> lg(state.m_mtx);
+        samples = state.m_samples;
+    }
+
+    std::vector<std::string> names;
+    {
+        t_trace_registry& registry = get_registry();
+        std::lock_guard<std::mutex> lg(registry.m_mtx);
+        names = registry.m_names;
+    }
+
+    std::map<std::string, double> rv;
+    for (t_uindex phase = 0; phase < samples.size(); ++phase) {
+        if (samples[phase] == 0) {
+            continue;
+        }
+        rv[phase == 0 ? "idle" : names[phase - 1]] += samples[phase];
+    }
+    return rv;
+}
+
+double
+t_profiler::get_ticks() {
+    t_profile_state& state = get_profile_state();
+    std::lock_guard<std::mutex> lg(state.m_mtx);
+    return state.m_ticks;
+}
+
+double
+t_profiler::get_interval_us() {
+    return std::max<t_uindex>(t_env::profile_interval_us(), 1);
+}
+
+void
+t_profiler::clear() {
+    t_profile_state& state = get_profile_state();
+    std::lock_guard<std::mutex> lg(state.m_mtx);
+    state.m_samples.clear();
+    state.m_ticks = 0;
+}
+
+std::uint64_t
+t_profiler::enter_phase(std::uint64_t name_id) {
+#ifndef PSP_PARALLEL_FOR
+    sample_elapsed();
+#endif
+    return get_thread_slot().m_phase.exchange(name_id + 1, std::memory_order_relaxed);
+}
+
+void
+t_profiler::leave_phase(std::uint64_t prev_phase) {
+#ifndef PSP_PARALLEL_FOR
+    sample_elapsed();
+#endif
+    get_thread_slot().m_phase.store(prev_phase, std::memory_order_relaxed);
+}
+
+t_trace_span::t_trace_span(std::uint64_t name_id, const char* arg)
+    : m_active(t_tracer::is_enabled())
+    , m_profiled(t_profiler::is_enabled()) {
+    if (m_profiled) {
+        m_prev_phase = t_profiler::enter_phase(name_id);
+    }
+
+    if (!m_active) {
+        return;
+    }
+
+    m_name_id = name_id;
+    m_arg = arg;
+    m_depth = TRACE_DEPTH++;
+    m_begin = t_tracer::now();
+}
+
+t_trace_span::~t_trace_span() {
+    if (m_profiled) {
+        t_profiler::leave_phase(m_prev_phase);
+    }
+
+    if (!m_active) {
+        return;
+    }
+
+    std::int64_t end = t_tracer::now();
+    --TRACE_DEPTH;
+    t_tracer::write_span(m_name_id, m_begin, end - m_begin, m_depth, m_arg);
 }
 
 } // end namespace perspective
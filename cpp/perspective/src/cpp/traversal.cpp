@@ -32,7 +32,8 @@ t_vdnode::t_vdnode(bool expanded, bool has_children)
     , m_has_children(has_children) {}
 
 t_traversal::t_traversal(std::shared_ptr<const t_stree> tree)
-    : m_tree(tree) {
+    : m_tree(tree)
+    , m_version(0) {
     t_stnode_vec rchildren;
     tree->get_child_nodes(0, rchildren);
     populate_root_children(rchildren);
@@ -41,6 +42,7 @@ t_traversal::t_traversal(std::shared_ptr<const t_stree> tree)
 void
 t_traversal::populate_root_children(const t_stnode_vec& rchildren) {
     m_nodes = std::make_shared<std::vector<t_tvnode>>(rchildren.size() + 1);
+    ++m_version;
 
     // Initialize root
     (*m_nodes)[0].m_expanded = true;
@@ -106,6 +108,7 @@ t_traversal::expand_node(t_index exp_idx) {
 
     // insert children of node into the traversal
     m_nodes->insert(m_nodes->begin() + exp_idx + 1, children.begin(), children.end());
+    ++m_version;
 
     // update ancestors about their new descendents
     update_ancestors(exp_idx, n_changed);
@@ -114,16 +117,11 @@ t_traversal::expand_node(t_index exp_idx) {
     return n_changed;
 }
 
-t_index
-t_traversal::expand_node(const std::vector<t_sortspec>& sortby, t_index exp_idx, t_ctx2* ctx2) {
-    t_tvnode& exp_tvnode = (*m_nodes)[exp_idx];
-
-    if (exp_tvnode.m_expanded) {
-        return 0;
-    }
-
+void
+t_traversal::get_sorted_children(const std::vector<t_sortspec>& sortby, t_index tnid,
+    t_ctx2* ctx2, std::vector<t_index>& out_tnids) const {
     t_stnode_vec tchildren;
-    m_tree->get_child_nodes(exp_tvnode.m_tnid, tchildren);
+    m_tree->get_child_nodes(tnid, tchildren);
     t_index n_changed = tchildren.size();
     t_index count = 0;
     std::vector<t_index> sorted_idx(n_changed);
@@ -159,26 +157,43 @@ t_traversal::expand_node(const std::vector<t_sortspec>& sortby, t_index exp_idx,
             sorted_idx[i] = i;
     }
 
+    out_tnids.resize(n_changed);
+    for (t_index idx = 0; idx < n_changed; ++idx) {
+        out_tnids[idx] = tchildren[sorted_idx[idx]].m_idx;
+    }
+}
+
+t_index
+t_traversal::expand_node(const std::vector<t_sortspec>& sortby, t_index exp_idx, t_ctx2* ctx2) {
+    t_tvnode& exp_tvnode = (*m_nodes)[exp_idx];
+
+    if (exp_tvnode.m_expanded) {
+        return 0;
+    }
+
+    std::vector<t_index> tnids;
+    get_sorted_children(sortby, exp_tvnode.m_tnid, ctx2, tnids);
+    t_index n_changed = tnids.size();
+
     std::vector<t_tvnode> children = std::vector<t_tvnode>(n_changed);
-    count = 0;
-    for (t_index idx = 0, loop_end = sorted_idx.size(); idx < loop_end; ++idx) {
-        t_tvnode& tv_node = children[count];
+    for (t_index idx = 0; idx < n_changed; ++idx) {
+        t_tvnode& tv_node = children[idx];
         tv_node.m_expanded = false;
         tv_node.m_depth = exp_tvnode.m_depth + 1;
-        tv_node.m_rel_pidx = count + 1;
-        tv_node.m_tnid = tchildren[sorted_idx[idx]].m_idx;
+        tv_node.m_rel_pidx = idx + 1;
+        tv_node.m_tnid = tnids[idx];
         tv_node.m_ndesc = 0;
         tv_node.m_nchild = 0;
-        count += 1;
     }
 
     // Update node being expanded
-    exp_tvnode.m_expanded = !sorted_idx.empty();
+    exp_tvnode.m_expanded = !tnids.empty();
     exp_tvnode.m_ndesc += n_changed;
     exp_tvnode.m_nchild = n_changed;
 
     // insert children of node into the traversal
     m_nodes->insert(m_nodes->begin() + exp_idx + 1, children.begin(), children.end());
+    ++m_version;
 
     // update ancestors about their new descendents
     update_ancestors(exp_idx, n_changed);
@@ -203,6 +218,7 @@ t_traversal::collapse_node(t_index idx) {
 
     // remove entries from traversal
     m_nodes->erase(m_nodes->begin() + bidx, m_nodes->begin() + eidx);
+    ++m_version;
 
     // Update node being collapsed
     node.m_expanded = false;
@@ -246,6 +262,7 @@ t_traversal::add_node(const std::vector<t_sortspec>& sortby,
         fill_travnode(&new_node, false, depth, cur_cidx - p_tvidx, 0, c_ptidx);
         auto insert_iter = m_nodes->begin() + cur_cidx;
         m_nodes->insert(insert_iter, new_node);
+        ++m_version;
         update_ancestors(cur_cidx, 1);
         update_sucessors(cur_cidx, 1);
     }
@@ -310,6 +327,16 @@ t_traversal::size() const {
     return m_nodes->size();
 }
 
+t_uindex
+t_traversal::get_version() const {
+    return m_version;
+}
+
+t_uindex
+t_traversal::nbytes() const {
+    return m_nodes->capacity() * sizeof(t_tvnode);
+}
+
 t_depth
 t_traversal::get_depth(t_index idx) const {
     return (*m_nodes)[idx].m_depth;
@@ -424,6 +451,7 @@ t_traversal::remove_subtree(t_index idx) {
 
     // remove entries from traversal
     m_nodes->erase(m_nodes->begin() + bidx, m_nodes->begin() + eidx);
+    ++m_version;
 
     return n_changed;
 }
@@ -508,35 +536,154 @@ t_traversal::post_order(t_index nidx, std::vector<t_index>& out_vec) {
 // Traversal
 t_index
 t_traversal::set_depth(const std::vector<t_sortspec>& sortby, t_depth depth, t_ctx2* ctx2) {
-    std::vector<t_index> pending;
-    depth = depth + 1;
-    pending.push_back(0);
+    // The traversal is written out again in one pass, rather than by
+    // expanding and collapsing nodes in place, each of which shifts the
+    // nodes after it and walks the siblings of its ancestors. Nodes already
+    // expanded keep the order of their children, and nodes newly expanded
+    // order them as `expand_node` would.
+    t_depth final_depth = depth + 1;
     t_index n_changed = 0;
-    while (pending.size() > 0) {
-        t_index curidx = pending.back();
+
+    if (final_depth == 0) {
+        return 0;
+    }
+
+    struct t_pending {
+        // The node's index in the current traversal, or `INVALID_INDEX` for
+        // a child of a newly expanded node.
+        t_index m_otvidx;
+        t_index m_tnid;
+        t_index m_ptvidx;
+        t_uindex m_depth;
+    };
+
+    const std::vector<t_tvnode>& old_nodes = *m_nodes;
+    std::vector<t_tvnode> new_nodes;
+    new_nodes.reserve(old_nodes.size());
+
+    std::vector<t_pending> pending;
+    pending.push_back(t_pending{0, old_nodes[0].m_tnid, INVALID_INDEX, 0});
+
+    std::vector<std::pair<t_index, t_index>> children;
+    std::vector<t_index> tnids;
+
+    while (!pending.empty()) {
+        t_pending cur = pending.back();
         pending.pop_back();
-        n_changed += expand_node(sortby, curidx, ctx2);
-        std::vector<std::pair<t_index, t_index>> children;
-        get_child_indices(curidx, children);
-        std::vector<t_index> collapse;
-        for (t_index idx = 0, loop_end = children.size(); idx < loop_end; ++idx) {
-            const std::pair<t_index, t_index>& child = children[idx];
-            const t_tvnode& tv_node = (*m_nodes)[child.first];
-
-            if (tv_node.m_depth < depth) {
-                pending.push_back(child.first);
-            } else if (tv_node.m_depth == depth && tv_node.m_expanded) {
-                collapse.push_back(child.first);
+
+        t_index tvidx = new_nodes.size();
+        t_tvnode node;
+        t_index rel_pidx = cur.m_ptvidx == INVALID_INDEX ? INVALID_INDEX : tvidx - cur.m_ptvidx;
+        fill_travnode(&node, false, cur.m_depth, rel_pidx, 0, cur.m_tnid);
+
+        bool was_expanded = cur.m_otvidx != INVALID_INDEX && old_nodes[cur.m_otvidx].m_expanded;
+
+        if (cur.m_depth < final_depth) {
+            if (was_expanded) {
+                children.clear();
+                get_child_indices(cur.m_otvidx, children);
+                for (auto iter = children.rbegin(); iter != children.rend(); ++iter) {
+                    pending.push_back(
+                        t_pending{iter->first, iter->second, tvidx, cur.m_depth + 1});
+                }
+                node.m_expanded = true;
+            } else {
+                get_sorted_children(sortby, cur.m_tnid, ctx2, tnids);
+                for (auto iter = tnids.rbegin(); iter != tnids.rend(); ++iter) {
+                    pending.push_back(t_pending{INVALID_INDEX, *iter, tvidx, cur.m_depth + 1});
+                }
+                node.m_expanded = !tnids.empty();
+                n_changed += tnids.size();
             }
+        } else if (was_expanded) {
+            n_changed += old_nodes[cur.m_otvidx].m_ndesc;
         }
-        // Now collapse any children
-        for (std::vector<t_index>::reverse_iterator rit = collapse.rbegin();
-             rit != collapse.rend(); ++rit) {
-            t_index curidx = *rit;
-            n_changed += collapse_node(curidx);
+
+        new_nodes.push_back(node);
+    }
+
+    // Each node follows its parent, so the counts of descendents are summed
+    // from the last node back.
+    for (t_index idx = new_nodes.size() - 1; idx > 0; --idx) {
+        const t_tvnode& node = new_nodes[idx];
+        t_tvnode& parent = new_nodes[idx - node.m_rel_pidx];
+        parent.m_ndesc += node.m_ndesc + 1;
+        parent.m_nchild += 1;
+    }
+
+    std::swap(*m_nodes, new_nodes);
+    ++m_version;
+    return n_changed;
+}
+
+t_index
+t_traversal::expand_tree_nodes(const std::vector<t_sortspec>& sortby,
+    const tsl::hopscotch_set<t_index>& tnids, t_ctx2* ctx2) {
+    if (tnids.empty()) {
+        return 0;
+    }
+
+    // As `set_depth`, nodes already expanded keep the order of their
+    // children, and nodes newly expanded order them as `expand_node` would.
+    struct t_pending {
+        t_index m_otvidx;
+        t_index m_tnid;
+        t_index m_ptvidx;
+        t_uindex m_depth;
+    };
+
+    const std::vector<t_tvnode>& old_nodes = *m_nodes;
+    std::vector<t_tvnode> new_nodes;
+    new_nodes.reserve(old_nodes.size());
+
+    std::vector<t_pending> pending;
+    pending.push_back(t_pending{0, old_nodes[0].m_tnid, INVALID_INDEX, old_nodes[0].m_depth});
+
+    std::vector<std::pair<t_index, t_index>> children;
+    std::vector<t_index> sorted_tnids;
+    t_index n_changed = 0;
+
+    while (!pending.empty()) {
+        t_pending cur = pending.back();
+        pending.pop_back();
+
+        t_index tvidx = new_nodes.size();
+        t_tvnode node;
+        t_index rel_pidx = cur.m_ptvidx == INVALID_INDEX ? INVALID_INDEX : tvidx - cur.m_ptvidx;
+        fill_travnode(&node, false, cur.m_depth, rel_pidx, 0, cur.m_tnid);
+
+        if (cur.m_otvidx != INVALID_INDEX && old_nodes[cur.m_otvidx].m_expanded) {
+            children.clear();
+            get_child_indices(cur.m_otvidx, children);
+            for (auto iter = children.rbegin(); iter != children.rend(); ++iter) {
+                pending.push_back(t_pending{iter->first, iter->second, tvidx, cur.m_depth + 1});
+            }
+            node.m_expanded = true;
+        } else if (tnids.find(cur.m_tnid) != tnids.end()) {
+            get_sorted_children(sortby, cur.m_tnid, ctx2, sorted_tnids);
+            for (auto iter = sorted_tnids.rbegin(); iter != sorted_tnids.rend(); ++iter) {
+                pending.push_back(t_pending{INVALID_INDEX, *iter, tvidx, cur.m_depth + 1});
+            }
+            node.m_expanded = !sorted_tnids.empty();
+            n_changed += sorted_tnids.size();
         }
+
+        new_nodes.push_back(node);
+    }
+
+    if (n_changed == 0) {
+        return 0;
+    }
+
+    for (t_index idx = new_nodes.size() - 1; idx > 0; --idx) {
+        const t_tvnode& node = new_nodes[idx];
+        t_tvnode& parent = new_nodes[idx - node.m_rel_pidx];
+        parent.m_ndesc += node.m_ndesc + 1;
+        parent.m_nchild += 1;
     }
 
+    std::swap(*m_nodes, new_nodes);
+    ++m_version;
     return n_changed;
 }
 
@@ -10,61 +10,38 @@
 #include <perspective/first.h>
 #include <perspective/base.h>
 #include <perspective/filter.h>
+#include <perspective/filter_utils.h>
 #include <perspective/path.h>
 #include <perspective/sparse_tree.h>
 #include <perspective/data_table.h>
 #include <perspective/traversal.h>
+#include <perspective/tree_context_common.h>
 #include <perspective/env_vars.h>
 #include <perspective/dense_tree.h>
 #include <perspective/dense_tree_context.h>
+#include <perspective/scheduler.h>
 #include <tsl/hopscotch_set.h>
+#ifdef PSP_PARALLEL_FOR
+#include <tbb/tbb.h>
+#endif
 
 namespace perspective {
 
-void
-notify_sparse_tree_common(std::shared_ptr<t_data_table> strands,
-    std::shared_ptr<t_data_table> strand_deltas, std::shared_ptr<t_stree> tree,
-    std::shared_ptr<t_traversal> traversal, bool process_traversal,
-    const std::vector<t_aggspec>& aggregates,
-    const std::vector<std::pair<std::string, std::string>>& tree_sortby,
-    const std::vector<t_sortspec>& ctx_sortby, const t_gstate& gstate) {
-    t_filter fltr;
-    if (t_env::log_data_nsparse_strands()) {
-        std::cout << "nsparse_strands" << std::endl;
-        strands->pprint();
-    }
-
-    if (t_env::log_data_nsparse_strand_deltas()) {
-        std::cout << "nsparse_strand_deltas" << std::endl;
-        strand_deltas->pprint();
-    }
-
-    auto pivots = tree->get_pivots();
-
-    t_dtree dtree(strands, pivots, tree_sortby);
-    dtree.init();
-
-    dtree.check_pivot(fltr, pivots.size() + 1);
-
-    if (t_env::log_data_nsparse_dtree()) {
-        std::cout << "nsparse_dtree" << std::endl;
-        dtree.pprint(fltr);
-    }
-
-    t_dtree_ctx dctx(strands, strand_deltas, dtree, aggregates);
-
-    dctx.init();
-
+// Merges the dense tree of one strand table into `tree`, and adds the new
+// leaves to each of `traversals`.
+static void
+notify_sparse_tree_merge(const t_dtree_ctx& dctx, std::shared_ptr<t_stree> tree,
+    const std::vector<t_tree_traversal>& traversals, const t_gstate& gstate) {
     tree->update_shape_from_static(dctx);
 
     auto zero_strands = tree->zero_strands();
 
-    t_uindex t_osize = process_traversal ? traversal->size() : 0;
-    if (process_traversal)
-        traversal->drop_tree_indices(zero_strands);
-    t_uindex t_nsize = process_traversal ? traversal->size() : 0;
-    if (t_osize != t_nsize)
-        tree->set_has_deltas(true);
+    for (const auto& trav : traversals) {
+        t_uindex t_osize = trav.m_traversal->size();
+        trav.m_traversal->drop_tree_indices(zero_strands);
+        if (t_osize != trav.m_traversal->size())
+            tree->set_has_deltas(true);
+    }
 
     auto non_zero_ids = tree->non_zero_ids(zero_strands);
     auto non_zero_leaves = tree->non_zero_leaves(zero_strands);
@@ -75,7 +52,8 @@ notify_sparse_tree_common(std::shared_ptr<t_data_table> strands,
 
     tree->update_aggs_from_static(dctx, gstate);
 
-    std::set<t_uindex> visited;
+    if (traversals.empty() || non_zero_leaves.empty())
+        return;
 
     struct t_leaf_path {
         std::vector<t_tscalar> m_path;
@@ -96,11 +74,18 @@ notify_sparse_tree_common(std::shared_ptr<t_data_table> strands,
     std::sort(leaf_paths.begin(), leaf_paths.end(),
         [](const t_leaf_path& a, const t_leaf_path& b) { return a.m_path < b.m_path; });
 
-    if (!leaf_paths.empty() && traversal.get() && traversal->size() == 1) {
-        if (traversal->get_node(0).m_expanded) {
-            traversal->populate_root_children(tree);
+    for (const auto& trav : traversals) {
+        auto traversal = trav.m_traversal;
+
+        if (traversal->size() == 1) {
+            if (traversal->get_node(0).m_expanded) {
+                traversal->populate_root_children(tree);
+            }
+            continue;
         }
-    } else {
+
+        std::set<t_uindex> visited;
+
         for (const auto& lpath : leaf_paths) {
             t_uindex lfidx = lpath.m_lfidx;
             auto ancestry = tree->get_ancestry(lfidx);
@@ -116,9 +101,7 @@ notify_sparse_tree_common(std::shared_ptr<t_data_table> strands,
                 }
             }
 
-            if (process_traversal) {
-                traversal->add_node(ctx_sortby, ancestry, num_tnodes_existed);
-            }
+            traversal->add_node(*trav.m_sortby, ancestry, num_tnodes_existed);
 
             for (auto nidx : ancestry) {
                 visited.insert(nidx);
@@ -127,6 +110,115 @@ notify_sparse_tree_common(std::shared_ptr<t_data_table> strands,
     }
 }
 
+static std::vector<t_tree_traversal>
+get_tree_traversals(std::shared_ptr<t_traversal> traversal, bool process_traversal,
+    const std::vector<t_sortspec>& ctx_sortby) {
+    std::vector<t_tree_traversal> rval;
+    if (process_traversal) {
+        rval.push_back(t_tree_traversal{traversal, &ctx_sortby});
+    }
+    return rval;
+}
+
+static void
+notify_sparse_tree_strands(std::shared_ptr<t_data_table> strands,
+    std::shared_ptr<t_data_table> strand_deltas, std::shared_ptr<t_stree> tree,
+    const std::vector<t_tree_traversal>& traversals, const std::vector<t_aggspec>& aggregates,
+    const std::vector<std::pair<std::string, std::string>>& tree_sortby,
+    const t_gstate& gstate) {
+    t_filter fltr;
+    if (t_env::log_data_nsparse_strands()) {
+        std::cout << "nsparse_strands" << std::endl;
+        strands->pprint();
+    }
+
+    if (t_env::log_data_nsparse_strand_deltas()) {
+        std::cout << "nsparse_strand_deltas" << std::endl;
+        strand_deltas->pprint();
+    }
+
+    auto pivots = tree->get_pivots();
+
+    t_dtree dtree(strands, pivots, tree_sortby);
+    dtree.init();
+
+    dtree.check_pivot(fltr, pivots.size() + 1);
+
+    if (t_env::log_data_nsparse_dtree()) {
+        std::cout << "nsparse_dtree" << std::endl;
+        dtree.pprint(fltr);
+    }
+
+    t_dtree_ctx dctx(strands, strand_deltas, dtree, aggregates);
+
+    dctx.init();
+
+    notify_sparse_tree_merge(dctx, tree, traversals, gstate);
+}
+
+std::set<std::string>
+get_tree_transitional_columns(const t_config& config) {
+    std::set<std::string> rval;
+    for (const t_pivot& pivot : config.get_pivots()) {
+        // A bucketed pivot reads its column, and sorts by its buckets.
+        rval.insert(pivot.colname());
+        std::string sortby = config.get_sort_by(pivot.name());
+        if (sortby != pivot.name()) {
+            rval.insert(sortby);
+        }
+    }
+
+    for (const t_aggspec& aggspec : config.get_aggregates()) {
+        for (const t_dep& dep : aggspec.get_dependencies()) {
+            if (dep.type() == DEPTYPE_COLUMN) {
+                rval.insert(dep.name());
+            }
+        }
+    }
+
+    for (const std::string& name : config.get_filter_columns()) {
+        rval.insert(name);
+    }
+
+    return rval;
+}
+
+void
+notify_sparse_tree_common(std::shared_ptr<t_data_table> strands,
+    std::shared_ptr<t_data_table> strand_deltas, std::shared_ptr<t_stree> tree,
+    std::shared_ptr<t_traversal> traversal, bool process_traversal,
+    const std::vector<t_aggspec>& aggregates,
+    const std::vector<std::pair<std::string, std::string>>& tree_sortby,
+    const std::vector<t_sortspec>& ctx_sortby, const t_gstate& gstate) {
+    notify_sparse_tree_strands(strands, strand_deltas, tree,
+        get_tree_traversals(traversal, process_traversal, ctx_sortby), aggregates, tree_sortby,
+        gstate);
+}
+
+// The dense tree of one partition of the rows of a table, built
+// independently of every other partition.
+struct t_tree_build_partition {
+    std::shared_ptr<t_data_table> m_strands;
+    std::shared_ptr<t_data_table> m_strand_deltas;
+    std::shared_ptr<t_dtree> m_dtree;
+    std::shared_ptr<t_dtree_ctx> m_dctx;
+};
+
+static t_uindex
+get_tree_build_partitions(t_uindex nrows) {
+#ifdef PSP_PARALLEL_FOR
+    t_uindex partition_rows = t_env::tree_build_partition_rows();
+    if (partition_rows == 0) {
+        return 1;
+    }
+
+    t_uindex max_partitions = t_scheduler::current().max_concurrency();
+    return std::max<t_uindex>(1, std::min(max_partitions, nrows / partition_rows));
+#else
+    return 1;
+#endif
+}
+
 void
 notify_sparse_tree(std::shared_ptr<t_stree> tree, std::shared_ptr<t_traversal> traversal,
     bool process_traversal, const std::vector<t_aggspec>& aggregates,
@@ -135,14 +227,26 @@ notify_sparse_tree(std::shared_ptr<t_stree> tree, std::shared_ptr<t_traversal> t
     const t_data_table& delta, const t_data_table& prev, const t_data_table& current,
     const t_data_table& transitions, const t_data_table& existed, const t_config& config,
     const t_gstate& gstate) {
+    notify_sparse_tree(tree, get_tree_traversals(traversal, process_traversal, ctx_sortby),
+        aggregates, tree_sortby, flattened, delta, prev, current, transitions, existed, config,
+        gstate);
+}
+
+void
+notify_sparse_tree(std::shared_ptr<t_stree> tree,
+    const std::vector<t_tree_traversal>& traversals, const std::vector<t_aggspec>& aggregates,
+    const std::vector<std::pair<std::string, std::string>>& tree_sortby,
+    const t_data_table& flattened, const t_data_table& delta, const t_data_table& prev,
+    const t_data_table& current, const t_data_table& transitions, const t_data_table& existed,
+    const t_config& config, const t_gstate& gstate) {
 
     auto strand_values = tree->build_strand_table(
-        flattened, delta, prev, current, transitions, aggregates, config);
+        flattened, delta, prev, current, transitions, existed, aggregates, config);
 
     auto strands = strand_values.first;
     auto strand_deltas = strand_values.second;
-    notify_sparse_tree_common(strands, strand_deltas, tree, traversal, process_traversal,
-        aggregates, tree_sortby, ctx_sortby, gstate);
+    notify_sparse_tree_strands(
+        strands, strand_deltas, tree, traversals, aggregates, tree_sortby, gstate);
 }
 
 void
@@ -151,12 +255,80 @@ notify_sparse_tree(std::shared_ptr<t_stree> tree, std::shared_ptr<t_traversal> t
     const std::vector<std::pair<std::string, std::string>>& tree_sortby,
     const std::vector<t_sortspec>& ctx_sortby, const t_data_table& flattened,
     const t_config& config, const t_gstate& gstate) {
-    auto strand_values = tree->build_strand_table(flattened, aggregates, config);
+    notify_sparse_tree(tree, get_tree_traversals(traversal, process_traversal, ctx_sortby),
+        aggregates, tree_sortby, flattened, config, gstate);
+}
 
-    auto strands = strand_values.first;
-    auto strand_deltas = strand_values.second;
-    notify_sparse_tree_common(strands, strand_deltas, tree, traversal, process_traversal,
-        aggregates, tree_sortby, ctx_sortby, gstate);
+void
+notify_sparse_tree(std::shared_ptr<t_stree> tree,
+    const std::vector<t_tree_traversal>& traversals, const std::vector<t_aggspec>& aggregates,
+    const std::vector<std::pair<std::string, std::string>>& tree_sortby,
+    const t_data_table& flattened, const t_config& config, const t_gstate& gstate) {
+    t_uindex nrows = flattened.size();
+    t_uindex npartitions = get_tree_build_partitions(nrows);
+
+    // Only the last partition's leaves are added to the traversals, which are
+    // complete only if they are rebuilt from the root's children.
+    bool fresh_traversal = true;
+    for (const auto& trav : traversals) {
+        fresh_traversal = fresh_traversal && trav.m_traversal->size() <= 1;
+    }
+
+    if (npartitions <= 1 || !fresh_traversal || t_env::log_data_nsparse_strands()
+        || t_env::log_data_nsparse_strand_deltas() || t_env::log_data_nsparse_dtree()) {
+        auto strand_values = tree->build_strand_table(flattened, aggregates, config);
+
+        auto strands = strand_values.first;
+        auto strand_deltas = strand_values.second;
+        notify_sparse_tree_strands(
+            strands, strand_deltas, tree, traversals, aggregates, tree_sortby, gstate);
+        return;
+    }
+
+    // Build the strand table and dense tree of each partition of the rows in
+    // parallel, then merge them into the sparse tree one at a time as if
+    // each partition were a separate update.
+    t_mask msk;
+
+    if (config.has_filters()) {
+        msk = filter_table_for_config(flattened, config);
+    }
+
+    const t_mask* mskptr = config.has_filters() ? &msk : nullptr;
+    auto pivots = tree->get_pivots();
+    std::vector<t_tree_build_partition> partitions(npartitions);
+
+    auto build_partition = [&](t_uindex pidx) {
+        t_uindex bidx = nrows * pidx / npartitions;
+        t_uindex eidx = nrows * (pidx + 1) / npartitions;
+        t_tree_build_partition& partition = partitions[pidx];
+
+        auto strand_values
+            = tree->build_strand_table(flattened, mskptr, bidx, eidx, aggregates, config);
+
+        partition.m_strands = strand_values.first;
+        partition.m_strand_deltas = strand_values.second;
+
+        t_filter fltr;
+        partition.m_dtree = std::make_shared<t_dtree>(partition.m_strands, pivots, tree_sortby);
+        partition.m_dtree->init();
+        partition.m_dtree->check_pivot(fltr, pivots.size() + 1);
+
+        partition.m_dctx = std::make_shared<t_dtree_ctx>(
+            partition.m_strands, partition.m_strand_deltas, *partition.m_dtree, aggregates);
+        partition.m_dctx->init();
+    };
+
+    t_scheduler::current().parallel_for(npartitions, build_partition);
+
+    for (t_uindex pidx = 0; pidx < npartitions; ++pidx) {
+        bool last = pidx == npartitions - 1;
+        notify_sparse_tree_merge(*partitions[pidx].m_dctx, tree,
+            last ? traversals : std::vector<t_tree_traversal>(), gstate);
+
+        // release the partition's tables as soon as they are merged
+        partitions[pidx] = t_tree_build_partition();
+    }
 }
 
 std::vector<t_path>
@@ -174,6 +346,28 @@ ctx_get_expansion_state(
     return paths;
 }
 
+std::vector<t_index>
+ctx_resolve_expansion_state(
+    std::shared_ptr<const t_stree> tree, const std::vector<t_path>& paths) {
+    tsl::hopscotch_set<t_index> resolved;
+    std::vector<t_index> nodes;
+
+    for (const t_path& path : paths) {
+        // Paths share their ancestors, so each walk up the tree stops at
+        // the first node already resolved.
+        t_index nidx = tree->resolve_path(0, path.path());
+        while (nidx > 0 && resolved.insert(nidx).second) {
+            nodes.push_back(nidx);
+            nidx = tree->get_parent_idx(nidx);
+        }
+    }
+
+    std::stable_sort(nodes.begin(), nodes.end(), [&tree](t_index a, t_index b) {
+        return tree->get_depth(a) < tree->get_depth(b);
+    });
+    return nodes;
+}
+
 std::vector<t_tscalar>
 ctx_get_path(std::shared_ptr<const t_stree> tree, std::shared_ptr<const t_traversal> traversal,
     t_index idx) {
@@ -188,6 +382,22 @@ ctx_get_path(std::shared_ptr<const t_stree> tree, std::shared_ptr<const t_traver
     return rval;
 }
 
+t_row_paths
+ctx_get_paths(std::shared_ptr<const t_stree> tree,
+    std::shared_ptr<const t_traversal> traversal, t_index start_row, t_index end_row) {
+    t_row_paths rval;
+    std::vector<t_tscalar> empty;
+    t_index nrows = traversal->size();
+    for (t_index ridx = start_row; ridx < end_row; ++ridx) {
+        if (ridx < 0 || ridx >= nrows) {
+            rval.push_back(empty);
+            continue;
+        }
+        rval.push_back(tree->get_path(traversal->get_tree_index(ridx)));
+    }
+    return rval;
+}
+
 std::vector<t_ftreenode>
 ctx_get_flattened_tree(t_index idx, t_depth stop_depth, t_traversal& trav,
     const t_config& config, const std::vector<t_sortspec>& sortby) {
@@ -0,0 +1,234 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#include <perspective/first.h>
+#include <perspective/union.h>
+#include <perspective/sym_table.h>
+#include <limits>
+
+namespace perspective {
+
+namespace {
+
+bool
+is_internal_column(const std::string& name) {
+    return name == "psp_pkey" || name == "psp_okey" || name == "psp_op";
+}
+
+} // end anonymous namespace
+
+t_union::t_union(const std::vector<std::shared_ptr<Table>>& members)
+    : m_members(members)
+    , m_row_keys(members.size())
+    , m_next_row_key(0)
+    , m_attached(false) {
+    if (m_members.empty()) {
+        PSP_COMPLAIN_AND_ABORT("Cannot create a union of no tables");
+    }
+
+    t_schema schema = m_members[0]->get_schema();
+    m_index = m_members[0]->get_index();
+    for (const std::string& name : schema.columns()) {
+        if (!is_internal_column(name)) {
+            m_columns.push_back(name);
+            m_types.push_back(schema.get_dtype(name));
+        }
+    }
+
+    for (const std::shared_ptr<Table>& member : m_members) {
+        t_schema member_schema = member->get_schema();
+        bool matches = member->get_index() == m_index
+            && member_schema.columns().size() == schema.columns().size();
+        for (t_uindex cidx = 0, loop_end = m_columns.size(); matches && cidx < loop_end;
+             ++cidx) {
+            matches = member_schema.has_column(m_columns[cidx])
+                && member_schema.get_dtype(m_columns[cidx]) == m_types[cidx];
+        }
+        if (!matches) {
+            PSP_COMPLAIN_AND_ABORT("Cannot create a union of tables with different schemas or indices");
+        }
+    }
+
+    m_table = std::make_shared<Table>(std::make_shared<t_pool>(), m_columns, m_types,
+        std::numeric_limits<std::uint32_t>::max(), m_index);
+
+    auto data = std::make_shared<t_data_table>(t_schema(m_columns, m_types));
+    data->init();
+    if (m_index.empty()) {
+        data->add_column("psp_pkey", DTYPE_INT32, true);
+        data->add_column("psp_okey", DTYPE_INT32, true);
+    } else {
+        data->clone_column(m_index, "psp_pkey");
+        data->clone_column(m_index, "psp_okey");
+    }
+    m_table->init(data, 0, OP_INSERT, 0);
+}
+
+t_union::~t_union() { detach(); }
+
+void
+t_union::init() {
+    // Members are locked in order, and the union last, as processing a
+    // member locks its gnode then the union.
+    std::vector<std::unique_lock<std::recursive_mutex>> locks;
+    for (const std::shared_ptr<Table>& member : m_members) {
+        locks.push_back(member->get_pool()->lock_gnode(member->get_gnode()->get_id()));
+    }
+    std::lock_guard<std::mutex> lock(m_mtx);
+    if (m_attached) {
+        return;
+    }
+
+    for (t_uindex midx = 0, loop_end = m_members.size(); midx < loop_end; ++midx) {
+        std::shared_ptr<t_gnode> gnode = m_members[midx]->get_gnode();
+        send_rows(midx, gnode->get_pkeys());
+        m_listeners.push_back(gnode->add_update_listener(
+            [this, midx](const t_data_table& flattened) { on_update(midx, flattened); }));
+    }
+    m_attached = true;
+}
+
+void
+t_union::detach() {
+    std::vector<std::unique_lock<std::recursive_mutex>> locks;
+    for (const std::shared_ptr<Table>& member : m_members) {
+        locks.push_back(member->get_pool()->lock_gnode(member->get_gnode()->get_id()));
+    }
+    std::lock_guard<std::mutex> lock(m_mtx);
+    if (!m_attached) {
+        return;
+    }
+
+    for (t_uindex midx = 0, loop_end = m_members.size(); midx < loop_end; ++midx) {
+        m_members[midx]->get_gnode()->remove_update_listener(m_listeners[midx]);
+    }
+    m_listeners.clear();
+    m_attached = false;
+}
+
+std::shared_ptr<Table>
+t_union::get_table() const {
+    return m_table;
+}
+
+void
+t_union::on_update(t_uindex midx, const t_data_table& flattened) {
+    std::vector<t_tscalar> upserts;
+    std::vector<t_tscalar> deletes;
+    const t_column* pkey_col = flattened.get_const_column("psp_pkey").get();
+    const t_column* op_col = flattened.get_const_column("psp_op").get();
+    for (t_uindex idx = 0, loop_end = flattened.size(); idx < loop_end; ++idx) {
+        t_tscalar pkey = pkey_col->get_scalar(idx);
+        if (*op_col->get_nth<std::uint8_t>(idx) == OP_DELETE) {
+            deletes.push_back(pkey);
+        } else {
+            upserts.push_back(pkey);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_mtx);
+    send_deletes(midx, deletes);
+    send_rows(midx, upserts);
+}
+
+void
+t_union::send_rows(t_uindex midx, const std::vector<t_tscalar>& pkeys) {
+    if (pkeys.empty()) {
+        return;
+    }
+
+    auto data = std::make_shared<t_data_table>(t_schema(m_columns, m_types));
+    data->init();
+    data->extend(pkeys.size());
+
+    std::shared_ptr<t_gnode> gnode = m_members[midx]->get_gnode();
+    for (const std::string& name : m_columns) {
+        gnode->copy_column(name, pkeys, *data->get_column(name));
+    }
+
+    if (m_index.empty()) {
+        auto pkey_col = data->add_column("psp_pkey", DTYPE_INT32, true);
+        for (t_uindex idx = 0, loop_end = pkeys.size(); idx < loop_end; ++idx) {
+            pkey_col->set_scalar(idx, get_key(midx, pkeys[idx], true));
+        }
+        data->clone_column("psp_pkey", "psp_okey");
+    } else {
+        data->clone_column(m_index, "psp_pkey");
+        data->clone_column(m_index, "psp_okey");
+    }
+    m_table->init(data, pkeys.size(), OP_INSERT, 0);
+}
+
+void
+t_union::send_deletes(t_uindex midx, const std::vector<t_tscalar>& pkeys) {
+    std::vector<t_tscalar> keys;
+    keys.reserve(pkeys.size());
+    for (const t_tscalar& pkey : pkeys) {
+        t_tscalar key = get_key(midx, pkey, false);
+        if (key.is_valid()) {
+            keys.push_back(key);
+        }
+    }
+
+    if (keys.empty()) {
+        return;
+    }
+
+    // The primary key columns, and the index if any, as
+    // `Table::remove_where` sends.
+    std::shared_ptr<t_data_table> data;
+    if (m_index.empty()) {
+        data = std::make_shared<t_data_table>(t_schema({"psp_pkey"}, {DTYPE_INT32}));
+    } else {
+        data = std::make_shared<t_data_table>(
+            t_schema({m_index}, {m_table->get_schema().get_dtype(m_index)}));
+    }
+    data->init();
+    data->extend(keys.size());
+
+    const std::string& key_column = m_index.empty() ? std::string("psp_pkey") : m_index;
+    t_column* key_col = data->get_column(key_column).get();
+    for (t_uindex idx = 0, loop_end = keys.size(); idx < loop_end; ++idx) {
+        key_col->set_scalar(idx, keys[idx]);
+    }
+
+    if (m_index.empty()) {
+        data->clone_column("psp_pkey", "psp_okey");
+    } else {
+        data->clone_column(m_index, "psp_pkey");
+        data->clone_column(m_index, "psp_okey");
+    }
+    m_table->init(data, keys.size(), OP_DELETE, 0);
+}
+
+t_tscalar
+t_union::get_key(t_uindex midx, const t_tscalar& pkey, bool assign) {
+    if (!m_index.empty()) {
+        return pkey;
+    }
+
+    tsl::hopscotch_map<t_tscalar, std::int32_t>& row_keys = m_row_keys[midx];
+    auto iter = row_keys.find(pkey);
+    t_tscalar rval;
+    if (iter != row_keys.end()) {
+        rval.set(iter->second);
+        if (!assign) {
+            row_keys.erase(iter);
+        }
+    } else if (assign) {
+        std::int32_t key = m_next_row_key++;
+        row_keys[pkey] = key;
+        rval.set(key);
+    } else {
+        rval = mknone();
+    }
+    return rval;
+}
+
+} // end namespace perspective
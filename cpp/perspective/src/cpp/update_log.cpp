@@ -0,0 +1,445 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#include <perspective/first.h>
+#include <perspective/update_log.h>
+#include <perspective/column.h>
+#include <perspective/compat.h>
+#include <perspective/schema.h>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+// "PSPL", which starts every record
+#define PSP_UPDATE_LOG_MAGIC 0x4c505350
+
+// The magic, payload length and payload checksum of a record
+#define PSP_UPDATE_LOG_HEADER_SIZE                                                             \
+    (sizeof(std::uint32_t) + sizeof(std::uint64_t) + sizeof(std::uint64_t))
+
+// The id a logged string column writes for a null row
+#define PSP_UPDATE_LOG_NULL_STRIDX std::numeric_limits<t_stridx>::max()
+
+namespace perspective {
+
+namespace {
+
+    std::string
+    log_fname(const std::string& dirname) {
+        return dirname + "/log";
+    }
+
+    // FNV-1a, which is enough to tell a torn write from a whole one.
+    std::uint64_t
+    checksum(const char* data, std::size_t length) {
+        std::uint64_t hash = 14695981039346656037ULL;
+        for (std::size_t i = 0; i < length; ++i) {
+            hash ^= static_cast<std::uint8_t>(data[i]);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    template <typename T>
+    void
+    write_value(std::string& out, T value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void
+    write_bytes(std::string& out, const void* data, std::size_t length) {
+        out.append(static_cast<const char*>(data), length);
+    }
+
+    struct t_record_reader {
+        t_record_reader(const char* begin, const char* end)
+            : m_pos(begin)
+            , m_end(end) {}
+
+        const char*
+        read_bytes(std::size_t length) {
+            PSP_VERBOSE_ASSERT(
+                length <= std::size_t(m_end - m_pos), "Malformed update log record");
+            const char* rv = m_pos;
+            m_pos += length;
+            return rv;
+        }
+
+        template <typename T>
+        T
+        read_value() {
+            T value;
+            std::memcpy(&value, read_bytes(sizeof(T)), sizeof(T));
+            return value;
+        }
+
+        const char* m_pos;
+        const char* m_end;
+    };
+
+    void
+    serialize_column(std::string& out, const t_column& col, t_uindex nrows) {
+        t_dtype dtype = col.get_dtype();
+        PSP_VERBOSE_ASSERT(dtype != DTYPE_OBJECT, "Cannot log a column of objects");
+        bool status_enabled = col.is_status_enabled();
+
+        write_value<std::int32_t>(out, dtype);
+        write_value<std::uint8_t>(out, status_enabled);
+        if (status_enabled && nrows > 0) {
+            write_bytes(out, col.get_nth_status(0), nrows * sizeof(t_status));
+        }
+
+        if (dtype != DTYPE_STR) {
+            if (nrows > 0) {
+                write_bytes(out, col.get_nth<std::uint8_t>(0), nrows * get_dtype_size(dtype));
+            }
+            return;
+        }
+
+        // A port table's vocabulary may be shared, so write only the strings
+        // its rows use, renumbered in order of first use.
+        const t_vocab* vocab = col._get_vocab();
+        std::unordered_map<t_stridx, t_stridx> local_ids;
+        std::vector<t_stridx> ids(nrows);
+        std::vector<t_stridx> used;
+        for (t_uindex ridx = 0; ridx < nrows; ++ridx) {
+            if (status_enabled && *col.get_nth_status(ridx) != STATUS_VALID) {
+                ids[ridx] = PSP_UPDATE_LOG_NULL_STRIDX;
+                continue;
+            }
+
+            t_stridx id = *col.get_nth<t_stridx>(ridx);
+            auto it = local_ids.find(id);
+            if (it == local_ids.end()) {
+                it = local_ids.emplace(id, t_stridx(used.size())).first;
+                used.push_back(id);
+            }
+            ids[ridx] = it->second;
+        }
+
+        write_value<std::uint64_t>(out, used.size());
+        for (t_stridx id : used) {
+            const char* str = vocab->unintern_c(id);
+            std::uint64_t length = std::strlen(str);
+            write_value<std::uint64_t>(out, length);
+            write_bytes(out, str, length);
+        }
+
+        if (nrows > 0) {
+            write_bytes(out, ids.data(), nrows * sizeof(t_stridx));
+        }
+    }
+
+    void
+    deserialize_column(t_record_reader& reader, t_column& col, t_uindex nrows) {
+        t_dtype dtype = col.get_dtype();
+        bool status_enabled = reader.read_value<std::uint8_t>() != 0;
+        const t_status* statuses = nullptr;
+        if (status_enabled && nrows > 0) {
+            statuses = reinterpret_cast<const t_status*>(
+                reader.read_bytes(nrows * sizeof(t_status)));
+        }
+
+        if (dtype != DTYPE_STR) {
+            if (nrows > 0) {
+                std::size_t nbytes = nrows * get_dtype_size(dtype);
+                std::memcpy(col.get_nth<std::uint8_t>(0), reader.read_bytes(nbytes), nbytes);
+            }
+        } else {
+            std::uint64_t nstrings = reader.read_value<std::uint64_t>();
+            std::vector<t_stridx> remap(nstrings);
+            t_vocab* vocab = col._get_vocab();
+            for (std::uint64_t sidx = 0; sidx < nstrings; ++sidx) {
+                std::uint64_t length = reader.read_value<std::uint64_t>();
+                std::string str(reader.read_bytes(length), length);
+                remap[sidx] = vocab->get_interned(str);
+            }
+
+            for (t_uindex ridx = 0; ridx < nrows; ++ridx) {
+                t_stridx id = reader.read_value<t_stridx>();
+                if (id == PSP_UPDATE_LOG_NULL_STRIDX) {
+                    col.clear(ridx);
+                    continue;
+                }
+
+                PSP_VERBOSE_ASSERT(id < remap.size(), "Malformed update log record");
+                col.set_nth<t_stridx>(ridx, remap[id]);
+            }
+        }
+
+        if (!col.is_status_enabled()) {
+            return;
+        }
+
+        if (statuses != nullptr) {
+            for (t_uindex ridx = 0; ridx < nrows; ++ridx) {
+                col.set_status(ridx, statuses[ridx]);
+            }
+        } else {
+            col.valid_raw_fill();
+        }
+    }
+
+    std::string
+    serialize_table(t_uindex port_id, const t_data_table& tbl) {
+        const t_schema& schema = tbl.get_schema();
+        t_uindex nrows = tbl.size();
+
+        std::string out;
+        write_value<std::uint64_t>(out, 0); // the sequence number, set on append
+        write_value<std::uint64_t>(out, port_id);
+        write_value<std::uint64_t>(out, nrows);
+        write_value<std::uint64_t>(out, schema.size());
+        for (t_uindex cidx = 0, loop_end = schema.size(); cidx < loop_end; ++cidx) {
+            const std::string& colname = schema.m_columns[cidx];
+            write_value<std::uint64_t>(out, colname.size());
+            write_bytes(out, colname.data(), colname.size());
+            serialize_column(out, *tbl.get_const_column(colname), nrows);
+        }
+
+        return out;
+    }
+
+} // namespace
+
+t_update_log::t_update_log(const std::string& dirname, bool truncate, std::uint64_t last_seq)
+    : m_fname(log_fname(dirname))
+    , m_file(nullptr)
+    , m_last_seq(last_seq)
+    , m_durable_seq(last_seq)
+    , m_stop(false) {
+    if (!truncate) {
+        std::uint64_t valid_size = 0;
+        std::uint64_t logged_seq = read_records(m_fname, nullptr, valid_size);
+        m_last_seq = std::max(m_last_seq, logged_seq);
+        m_durable_seq = m_last_seq;
+
+        // Drop a torn record, so that new records follow the valid ones.
+        std::string valid;
+        std::FILE* existing = std::fopen(m_fname.c_str(), "rb");
+        if (existing != nullptr) {
+            valid.resize(valid_size);
+            std::size_t nread = std::fread(&valid[0], 1, valid_size, existing);
+            bool torn = std::fgetc(existing) != EOF;
+            std::fclose(existing);
+            PSP_VERBOSE_ASSERT(nread == valid_size, "Could not read update log");
+            if (torn) {
+                m_file = std::fopen(m_fname.c_str(), "wb");
+                PSP_VERBOSE_ASSERT(m_file != nullptr, "Could not open update log");
+                std::fwrite(valid.data(), 1, valid.size(), m_file);
+                sync_file(m_file);
+                std::fclose(m_file);
+            }
+        }
+    }
+
+    m_file = std::fopen(m_fname.c_str(), truncate ? "wb" : "ab");
+    if (m_file == nullptr) {
+        PSP_COMPLAIN_AND_ABORT("Could not open update log `" + m_fname + "`");
+    }
+
+    m_flusher = std::thread(&t_update_log::run_flusher, this);
+}
+
+t_update_log::~t_update_log() {
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_stop = true;
+    }
+
+    // The flusher writes whatever is still pending before it stops.
+    m_pending_cv.notify_one();
+    m_flusher.join();
+    std::fclose(m_file);
+}
+
+std::uint64_t
+t_update_log::append(t_uindex port_id, const t_data_table& tbl) {
+    std::string record = serialize_table(port_id, tbl);
+    std::uint64_t seq;
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        seq = ++m_last_seq;
+        std::memcpy(&record[0], &seq, sizeof(seq));
+        m_pending.push_back(std::move(record));
+    }
+
+    m_pending_cv.notify_one();
+    return seq;
+}
+
+void
+t_update_log::flush() {
+    std::unique_lock<std::mutex> lock(m_mtx);
+    m_durable_cv.wait(
+        lock, [this] { return m_durable_seq == m_last_seq || !m_error.empty(); });
+    if (!m_error.empty()) {
+        PSP_COMPLAIN_AND_ABORT(m_error);
+    }
+}
+
+void
+t_update_log::truncate() {
+    flush();
+
+    // Every record is durable, so the flusher is idle until the next append.
+    std::lock_guard<std::mutex> lock(m_mtx);
+    std::fclose(m_file);
+    m_file = std::fopen(m_fname.c_str(), "wb");
+    if (m_file == nullptr) {
+        PSP_COMPLAIN_AND_ABORT("Could not truncate update log `" + m_fname + "`");
+    }
+    sync_file(m_file);
+}
+
+std::uint64_t
+t_update_log::last_seq() const {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    return m_last_seq;
+}
+
+std::uint64_t
+t_update_log::read(const std::string& dirname, const t_replay_callback& callback) {
+    std::uint64_t valid_size = 0;
+    return read_records(log_fname(dirname), &callback, valid_size);
+}
+
+void
+t_update_log::run_flusher() {
+    std::unique_lock<std::mutex> lock(m_mtx);
+    while (true) {
+        m_pending_cv.wait(lock, [this] { return m_stop || !m_pending.empty(); });
+        if (m_pending.empty()) {
+            break;
+        }
+
+        // Every record queued while the last batch was written goes out in
+        // this one, under a single sync.
+        std::vector<std::string> batch;
+        batch.swap(m_pending);
+        std::uint64_t batch_seq = m_last_seq;
+        lock.unlock();
+
+        std::string error;
+        try {
+            write_batch(batch);
+        } catch (const std::exception& e) {
+            error = e.what();
+        } catch (...) {
+            error = "Could not write update log `" + m_fname + "`";
+        }
+
+        lock.lock();
+        if (error.empty()) {
+            m_durable_seq = batch_seq;
+        } else if (m_error.empty()) {
+            m_error = error;
+        }
+        m_durable_cv.notify_all();
+    }
+}
+
+void
+t_update_log::write_batch(const std::vector<std::string>& batch) {
+    std::string buffer;
+    for (const std::string& record : batch) {
+        write_value<std::uint32_t>(buffer, PSP_UPDATE_LOG_MAGIC);
+        write_value<std::uint64_t>(buffer, record.size());
+        write_value<std::uint64_t>(buffer, checksum(record.data(), record.size()));
+        buffer.append(record);
+    }
+
+    std::size_t nwritten = std::fwrite(buffer.data(), 1, buffer.size(), m_file);
+    PSP_VERBOSE_ASSERT(nwritten == buffer.size(), "Could not write update log");
+    sync_file(m_file);
+}
+
+std::uint64_t
+t_update_log::read_records(const std::string& fname, const t_replay_callback* callback,
+    std::uint64_t& valid_size) {
+    valid_size = 0;
+    std::uint64_t last_seq = 0;
+    std::FILE* file = std::fopen(fname.c_str(), "rb");
+    if (file == nullptr) {
+        return last_seq;
+    }
+
+    char header[PSP_UPDATE_LOG_HEADER_SIZE];
+    std::string payload;
+    while (std::fread(header, 1, PSP_UPDATE_LOG_HEADER_SIZE, file) == PSP_UPDATE_LOG_HEADER_SIZE) {
+        t_record_reader header_reader(header, header + PSP_UPDATE_LOG_HEADER_SIZE);
+        std::uint32_t magic = header_reader.read_value<std::uint32_t>();
+        std::uint64_t length = header_reader.read_value<std::uint64_t>();
+        std::uint64_t expected = header_reader.read_value<std::uint64_t>();
+        if (magic != PSP_UPDATE_LOG_MAGIC || length < sizeof(std::uint64_t)) {
+            break;
+        }
+
+        payload.resize(length);
+        if (std::fread(&payload[0], 1, length, file) != length
+            || checksum(payload.data(), length) != expected) {
+            break;
+        }
+
+        t_record_reader reader(payload.data(), payload.data() + length);
+        std::uint64_t seq = reader.read_value<std::uint64_t>();
+        if (callback != nullptr) {
+            t_uindex port_id = reader.read_value<std::uint64_t>();
+            t_uindex nrows = reader.read_value<std::uint64_t>();
+            t_uindex ncols = reader.read_value<std::uint64_t>();
+
+            // Column names come before their data, so read each column's
+            // header first to build the schema.
+            std::vector<std::string> names;
+            std::vector<t_dtype> types;
+            std::vector<t_record_reader> columns;
+            for (t_uindex cidx = 0; cidx < ncols; ++cidx) {
+                std::uint64_t name_length = reader.read_value<std::uint64_t>();
+                names.push_back(std::string(reader.read_bytes(name_length), name_length));
+                t_dtype dtype = static_cast<t_dtype>(reader.read_value<std::int32_t>());
+                types.push_back(dtype);
+                columns.push_back(reader);
+
+                // Skip over the column to reach the next one.
+                bool status_enabled = reader.read_value<std::uint8_t>() != 0;
+                if (status_enabled) {
+                    reader.read_bytes(nrows * sizeof(t_status));
+                }
+
+                if (dtype == DTYPE_STR) {
+                    std::uint64_t nstrings = reader.read_value<std::uint64_t>();
+                    for (std::uint64_t sidx = 0; sidx < nstrings; ++sidx) {
+                        reader.read_bytes(reader.read_value<std::uint64_t>());
+                    }
+                    reader.read_bytes(nrows * sizeof(t_stridx));
+                } else {
+                    reader.read_bytes(nrows * get_dtype_size(dtype));
+                }
+            }
+
+            t_schema schema(names, types);
+            t_data_table tbl(schema);
+            tbl.init();
+            tbl.extend(nrows);
+            for (t_uindex cidx = 0; cidx < ncols; ++cidx) {
+                deserialize_column(columns[cidx], *tbl.get_column(names[cidx]), nrows);
+            }
+
+            (*callback)(seq, port_id, tbl);
+        }
+
+        last_seq = seq;
+        valid_size += PSP_UPDATE_LOG_HEADER_SIZE + length;
+    }
+
+    std::fclose(file);
+    return last_seq;
+}
+
+} // end namespace perspective
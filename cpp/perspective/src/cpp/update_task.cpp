@@ -17,27 +17,77 @@ t_update_task::t_update_task(t_pool& pool)
 
 void
 t_update_task::run() {
-    auto work_to_do = m_pool.m_data_remaining.load();
-    m_pool.m_data_remaining.store(false);
+    bool work_to_do;
+    {
+        std::lock_guard<std::mutex> lk(m_pool.m_pending_mtx);
+        work_to_do = m_pool.m_data_remaining.exchange(false);
+        m_pool.m_pending_rows.store(0);
+    }
 
     if (work_to_do) {
-        for (auto g : m_pool.m_gnodes) {
-            if (g) {
-                t_uindex num_input_ports = g->num_input_ports();
-
-                // Call process for each port, and notify the updates from
-                // each port individually.
-                for (t_uindex port_id = 0; port_id < num_input_ports; ++port_id) {
-                    bool did_notify_context = g->process(port_id);
-                    if (did_notify_context) {
-                        m_pool.notify_userspace(port_id);
-                    }
-                    g->clear_output_ports();
-                }
+        std::vector<std::shared_ptr<t_gnode_slot>> dirty;
+        for (auto& slot : m_pool.get_slots()) {
+            if (slot->m_dirty.load()) {
+                dirty.push_back(slot);
             }
         }
+
+        // Without an update delegate there is nothing to call back on this
+        // thread, so gnodes are processed concurrently, each under its own
+        // lock.
+        t_uindex max_concurrency
+            = m_pool.has_update_delegate() ? 1 : m_pool.m_num_threads.load();
+        m_pool.get_scheduler()->parallel_for(dirty.size(),
+            [this, &dirty](t_uindex idx) { process_gnode(*dirty[idx]); }, max_concurrency);
     }
 
     m_pool.inc_epoch();
 }
+
+void
+t_update_task::process_gnode(t_gnode_slot& slot) {
+    auto slg = slot.lock();
+    slot.m_dirty.store(false);
+
+    t_gnode* g = slot.m_gnode;
+    if (!g) {
+        return;
+    }
+
+    t_uindex num_input_ports = g->num_input_ports();
+
+    // Call process for each port, and notify the updates from each port
+    // individually. The callback may delete the gnode's table, which clears
+    // the slot.
+    for (t_uindex port_id = 0; port_id < num_input_ports; ++port_id) {
+        // Visible contexts are called back before background contexts are
+        // notified.
+        bool did_notify_context = g->process(port_id, true);
+        bool has_update_delegate = m_pool.has_update_delegate();
+        if (did_notify_context) {
+            if (has_update_delegate) {
+                g->record_callback_latency();
+            }
+            m_pool.notify_userspace(port_id, CTX_PRIORITY_VISIBLE);
+        }
+
+        if (!slot.m_gnode) {
+            return;
+        }
+
+        if (g->notify_background_contexts() && did_notify_context) {
+            if (has_update_delegate) {
+                g->record_callback_latency();
+            }
+            m_pool.notify_userspace(port_id, CTX_PRIORITY_BACKGROUND);
+        }
+
+        if (!slot.m_gnode) {
+            return;
+        }
+
+        g->clear_output_ports();
+    }
+}
+
 } // end namespace perspective
@@ -0,0 +1,234 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2017, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#include <perspective/first.h>
+#include <perspective/value_multiset.h>
+
+namespace perspective {
+
+bool
+t_value_multiset::t_value_cmp::operator()(const t_tscalar& a, const t_tscalar& b) const {
+    if (a.m_type == b.m_type && a.m_status == b.m_status && a.is_floating_point()) {
+        bool a_nan = a.is_nan();
+        bool b_nan = b.is_nan();
+        if (a_nan || b_nan) {
+            return !a_nan && b_nan;
+        }
+    }
+    return a < b;
+}
+
+bool
+t_value_multiset::t_by_count_cmp::operator()(
+    const std::pair<t_uindex, t_tscalar>& a, const std::pair<t_uindex, t_tscalar>& b) const {
+    if (a.first != b.first) {
+        return a.first > b.first;
+    }
+    return t_value_cmp()(a.second, b.second);
+}
+
+t_value_multiset::t_value_multiset()
+    : m_size(0)
+    , m_median(m_counts.end())
+    , m_median_offset(0)
+    , m_median_pos(0) {}
+
+std::pair<t_uindex, t_tscalar>
+t_value_multiset::by_count_key(t_counts::const_iterator iter) const {
+    t_uindex count = iter->first.is_valid() ? iter->second : 1;
+    return std::make_pair(count, iter->first);
+}
+
+void
+t_value_multiset::insert(const t_tscalar& value) {
+    auto iter = m_counts.find(value);
+    if (iter == m_counts.end()) {
+        iter = m_counts.insert(std::make_pair(value, t_uindex(0))).first;
+    } else {
+        m_by_count.erase(by_count_key(iter));
+    }
+
+    ++iter->second;
+    ++m_size;
+    m_by_count.insert(by_count_key(iter));
+
+    if (m_size == 1) {
+        m_median = iter;
+        m_median_offset = 0;
+        m_median_pos = 0;
+        return;
+    }
+
+    if (m_counts.key_comp()(value, m_median->first)) {
+        ++m_median_pos;
+    }
+
+    seek_median();
+}
+
+void
+t_value_multiset::erase(const t_tscalar& value) {
+    auto iter = m_counts.find(value);
+    if (iter == m_counts.end()) {
+        return;
+    }
+
+    if (m_size == 1) {
+        clear();
+        return;
+    }
+
+    m_by_count.erase(by_count_key(iter));
+    bool before_median = m_counts.key_comp()(value, m_median->first);
+
+    --iter->second;
+    --m_size;
+
+    if (before_median) {
+        --m_median_pos;
+    } else if (iter == m_median && m_median_offset >= iter->second) {
+        // The occurrence under the median was removed, so the same position
+        // now holds the first occurrence of the next value (if any).
+        ++m_median;
+        m_median_offset = 0;
+    }
+
+    if (iter->second == 0) {
+        m_counts.erase(iter);
+    } else {
+        m_by_count.insert(by_count_key(iter));
+    }
+
+    seek_median();
+}
+
+void
+t_value_multiset::seek_median() {
+    t_uindex target = m_size / 2;
+
+    while (m_median_pos < target) {
+        if (++m_median_offset >= m_median->second) {
+            ++m_median;
+            m_median_offset = 0;
+        }
+        ++m_median_pos;
+    }
+
+    while (m_median_pos > target) {
+        if (m_median == m_counts.end() || m_median_offset == 0) {
+            --m_median;
+            m_median_offset = m_median->second - 1;
+        } else {
+            --m_median_offset;
+        }
+        --m_median_pos;
+    }
+}
+
+void
+t_value_multiset::clear() {
+    m_counts.clear();
+    m_by_count.clear();
+    m_size = 0;
+    m_median = m_counts.end();
+    m_median_offset = 0;
+    m_median_pos = 0;
+}
+
+void
+t_value_multiset::swap(t_value_multiset& other) {
+    // Swapping the maps keeps iterators to their elements, but not to their
+    // ends.
+    bool at_end = m_median == m_counts.end();
+    bool other_at_end = other.m_median == other.m_counts.end();
+    m_counts.swap(other.m_counts);
+    m_by_count.swap(other.m_by_count);
+    std::swap(m_size, other.m_size);
+    std::swap(m_median, other.m_median);
+    std::swap(m_median_offset, other.m_median_offset);
+    std::swap(m_median_pos, other.m_median_pos);
+    if (other_at_end) {
+        m_median = m_counts.end();
+    }
+    if (at_end) {
+        other.m_median = other.m_counts.end();
+    }
+}
+
+t_uindex
+t_value_multiset::size() const {
+    return m_size;
+}
+
+t_uindex
+t_value_multiset::distinct_size() const {
+    return m_counts.size();
+}
+
+t_uindex
+t_value_multiset::nbytes() const {
+    // A std::map or std::set node carries a parent, two children and a
+    // colour besides its value.
+    const t_uindex node_nbytes = 4 * sizeof(void*);
+    return sizeof(*this) + m_counts.size() * (sizeof(t_counts::value_type) + node_nbytes)
+        + m_by_count.size() * (sizeof(t_by_count::value_type) + node_nbytes);
+}
+
+t_tscalar
+t_value_multiset::median() const {
+    if (m_size == 0) {
+        return t_tscalar();
+    }
+    return m_median->first;
+}
+
+t_tscalar
+t_value_multiset::min() const {
+    for (auto iter = m_counts.begin(); iter != m_counts.end(); ++iter) {
+        if (iter->first.is_valid() && !iter->first.is_nan()) {
+            return iter->first;
+        }
+    }
+    return mknone();
+}
+
+t_tscalar
+t_value_multiset::max() const {
+    for (auto iter = m_counts.rbegin(); iter != m_counts.rend(); ++iter) {
+        if (iter->first.is_valid() && !iter->first.is_nan()) {
+            return iter->first;
+        }
+    }
+    return mknone();
+}
+
+t_tscalar
+t_value_multiset::dominant() const {
+    if (m_size == 0) {
+        return mknone();
+    }
+    return m_by_count.begin()->second;
+}
+
+bool
+t_value_multiset::unique(t_tscalar& value) const {
+    value = mknone();
+    if (m_counts.empty()) {
+        return true;
+    }
+
+    if (m_counts.size() > 1) {
+        return false;
+    }
+
+    value = m_counts.begin()->first;
+    return true;
+}
+
+} // end namespace perspective
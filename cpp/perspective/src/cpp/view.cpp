@@ -10,11 +10,71 @@
 #include <perspective/first.h>
 #include <perspective/view.h>
 #include <perspective/arrow_writer.h>
+#include <perspective/filter_utils.h>
+#include <perspective/env_vars.h>
+#include <chrono>
+#include <cmath>
+#include <limits>
 #include <sstream>
 
+#ifdef PSP_ENABLE_PARQUET
+#include <parquet/arrow/writer.h>
+#endif
+
+// Slices of at least this many rows are read from copy-on-write snapshots
+// of the tables they refer to, so that the gnode is only locked while the
+// snapshots are taken rather than for the whole read.
+#define PSP_SNAPSHOT_MIN_ROWS 65536
 
 namespace perspective {
 
+/**
+ * @brief Snapshot the string columns of the aggregate table of each of
+ * `ctx`'s trees, which the string scalars of a slice read from them point
+ * into.
+ */
+template <typename CTX_T>
+static std::shared_ptr<t_ctx_snapshot>
+snapshot_tree_strings(CTX_T& ctx) {
+    auto snapshot = std::make_shared<t_ctx_snapshot>();
+
+    for (t_stree* tree : ctx.get_trees()) {
+        t_data_table* aggtable = tree->_get_aggtable();
+        const t_schema& schema = aggtable->get_schema();
+        std::vector<std::string> columns;
+
+        for (t_uindex idx = 0, loop_end = schema.size(); idx < loop_end; ++idx) {
+            if (schema.m_types[idx] == DTYPE_STR) {
+                columns.push_back(schema.m_columns[idx]);
+            }
+        }
+
+        if (!columns.empty()) {
+            snapshot->m_tables.push_back(aggtable->snapshot(columns));
+        }
+    }
+
+    return snapshot;
+}
+
+/**
+ * @brief Returns the indices of the columns of the sorted `ctx` which its
+ * view shows, the row path column first: the context makes header columns
+ * for sorted columns, which the view hides.
+ */
+static std::vector<t_uindex>
+sorted_column_indices(t_ctx2& ctx, t_uindex depth) {
+    std::vector<t_uindex> column_indices;
+    column_indices.push_back(0);
+    for (t_uindex i = 0, loop_end = ctx.unity_get_column_count(); i < loop_end; ++i) {
+        if (ctx.unity_get_column_path(i + 1).size() == depth) {
+            column_indices.push_back(i + 1);
+        }
+    }
+
+    return column_indices;
+}
+
 std::string
 join_column_names(
     const std::vector<t_tscalar>& names, const std::string& separator) {
@@ -45,7 +105,10 @@ View<CTX_T>::View(
     , m_ctx(ctx)
     , m_name(name)
     , m_separator(separator)
-    , m_view_config(view_config) {
+    , m_view_config(view_config)
+    , m_last_cursor_id(0)
+    , m_notify_interval(0)
+    , m_notified_at(0) {
     m_row_pivots = m_view_config->get_row_pivots();
     m_column_pivots = m_view_config->get_column_pivots();
     m_aggregates = m_view_config->get_aggspecs();
@@ -116,6 +179,12 @@ View<CTX_T>::num_rows() const {
     }
 }
 
+template <typename CTX_T>
+std::map<std::string, t_uindex>
+View<CTX_T>::get_memory_usage() const {
+    return m_ctx->get_memory_usage();
+}
+
 template <typename CTX_T>
 std::int32_t
 View<CTX_T>::num_columns() const {
@@ -231,6 +300,117 @@ View<CTX_T>::column_paths() const {
     return names;
 }
 
+template <>
+std::int32_t
+View<t_ctx0>::get_column_scale(t_uindex idx) const {
+    if (idx >= static_cast<t_uindex>(m_ctx->get_column_count())) {
+        return 0;
+    }
+    return m_table->get_column_scale(m_ctx->get_config().col_at(idx));
+}
+
+template <>
+std::int32_t
+View<t_ctx1>::get_column_scale(t_uindex idx) const {
+    const std::vector<t_aggspec>& aggspecs = m_ctx->get_config().get_aggregates();
+    if (idx == 0 || idx > aggspecs.size()) {
+        return 0;
+    }
+    return get_aggregate_scale(aggspecs[idx - 1]);
+}
+
+template <>
+std::int32_t
+View<t_ctx2>::get_column_scale(t_uindex idx) const {
+    const std::vector<t_aggspec>& aggspecs = m_ctx->get_config().get_aggregates();
+    if (idx == 0 || aggspecs.empty()) {
+        return 0;
+    }
+    return get_aggregate_scale(aggspecs[(idx - 1) % aggspecs.size()]);
+}
+
+template <typename CTX_T>
+std::int32_t
+View<CTX_T>::get_aggregate_scale(const t_aggspec& aggspec) const {
+    if (m_table->get_column_scales().empty() || aggspec.get_dependencies().empty()) {
+        return 0;
+    }
+
+    // Aggregates in the units of their column, unlike counts or variances.
+    switch (aggspec.agg()) {
+        case AGGTYPE_SUM:
+        case AGGTYPE_MEAN:
+        case AGGTYPE_WEIGHTED_MEAN:
+        case AGGTYPE_UNIQUE:
+        case AGGTYPE_ANY:
+        case AGGTYPE_MEDIAN:
+        case AGGTYPE_MIN:
+        case AGGTYPE_MAX:
+        case AGGTYPE_DOMINANT:
+        case AGGTYPE_FIRST:
+        case AGGTYPE_LAST:
+        case AGGTYPE_LAST_VALUE:
+        case AGGTYPE_HIGH_WATER_MARK:
+        case AGGTYPE_LOW_WATER_MARK:
+        case AGGTYPE_SUM_ABS:
+        case AGGTYPE_ABS_SUM:
+        case AGGTYPE_SUM_NOT_NULL:
+        case AGGTYPE_MEAN_BY_COUNT:
+        case AGGTYPE_IDENTITY:
+        case AGGTYPE_DISTINCT_LEAF:
+        case AGGTYPE_APPROX_PERCENTILE:
+        case AGGTYPE_ROLLING_SUM:
+        case AGGTYPE_ROLLING_MEAN:
+        case AGGTYPE_ROLLING_WEIGHTED_MEAN: {
+            return m_table->get_column_scale(aggspec.get_first_depname());
+        }
+        default: { return 0; }
+    }
+}
+
+template <typename CTX_T>
+void
+View<CTX_T>::scale_slice(
+    std::vector<t_tscalar>& slice, const std::vector<t_uindex>& indices) const {
+    if (m_table->get_column_scales().empty() || indices.empty()
+        || slice.size() % indices.size() != 0) {
+        return;
+    }
+
+    std::vector<double> divisors(indices.size(), 0);
+    bool is_scaled = false;
+    for (t_uindex cidx = 0, loop_end = indices.size(); cidx < loop_end; ++cidx) {
+        std::int32_t scale = get_column_scale(indices[cidx]);
+        if (scale > 0) {
+            divisors[cidx] = std::pow(10.0, scale);
+            is_scaled = true;
+        }
+    }
+
+    if (!is_scaled) {
+        return;
+    }
+
+    for (t_uindex idx = 0, loop_end = slice.size(); idx < loop_end; ++idx) {
+        double divisor = divisors[idx % indices.size()];
+        t_tscalar& value = slice[idx];
+        if (divisor > 0 && value.is_valid() && value.is_numeric()) {
+            value.set(value.to_double() / divisor);
+        }
+    }
+}
+
+template <typename CTX_T>
+std::vector<t_uindex>
+View<CTX_T>::column_range(t_uindex start_col, t_uindex end_col) const {
+    std::vector<t_uindex> indices;
+    t_uindex loop_end = std::min(end_col, static_cast<t_uindex>(m_ctx->get_column_count()));
+    for (t_uindex idx = start_col; idx < loop_end; ++idx) {
+        indices.push_back(idx);
+    }
+    return indices;
+}
+
 template <typename CTX_T>
 std::map<std::string, std::string>
 View<CTX_T>::schema() const {
@@ -256,6 +436,12 @@ View<CTX_T>::schema() const {
         if (m_row_pivots.size() > 0 && !is_column_only()) {
             new_schema[agg_name] = _map_aggregate_types(agg_name, new_schema[agg_name]);
         }
+
+        for (const t_aggspec& aggspec : m_aggregates) {
+            if (aggspec.name() == agg_name && get_aggregate_scale(aggspec) > 0) {
+                new_schema[agg_name] = "float";
+            }
+        }
     }
 
     return new_schema;
@@ -281,7 +467,8 @@ View<t_ctx0>::schema() const {
         if (name == "psp_okey") {
             continue;
         }
-        new_schema[name] = dtype_to_str(types[name]);
+        new_schema[name]
+            = m_table->get_column_scale(name) > 0 ? "float" : dtype_to_str(types[name]);
     }
 
     return new_schema;
@@ -339,10 +526,39 @@ template <>
 std::shared_ptr<t_data_slice<t_ctx0>>
 View<t_ctx0>::get_data(
     t_uindex start_row, t_uindex end_row, t_uindex start_col, t_uindex end_col) const {
-    std::vector<t_tscalar> slice = m_ctx->get_data(start_row, end_row, start_col, end_col);
-    auto col_names = column_names();
+    PSP_TRACE_SPAN("view.get_data");
+    std::vector<t_tscalar> slice;
+    std::vector<t_slice_column> columns;
+    std::vector<std::vector<t_tscalar>> col_names;
+    std::shared_ptr<t_ctx_snapshot> snapshot;
+
+    {
+        auto lock = lock_gnode();
+        col_names = column_names();
+        if (end_row > start_row && end_row - start_row >= PSP_SNAPSHOT_MIN_ROWS) {
+            snapshot = m_ctx->get_snapshot(start_row, end_row, start_col, end_col);
+        } else {
+            slice = m_ctx->get_data(start_row, end_row, start_col, end_col);
+        }
+    }
+
+    // Copy the rows out of the snapshot while updates are processed, as a
+    // typed buffer for each column rather than a scalar for each cell.
+    // Fixed-point columns are read as scalars, which are scaled below.
+    if (snapshot) {
+        if (m_table->get_column_scales().empty()) {
+            columns = m_ctx->get_columns(*snapshot, start_col, end_col);
+        }
+        if (columns.empty()) {
+            slice = m_ctx->get_data(*snapshot, start_col, end_col);
+        }
+    }
+    scale_slice(slice, column_range(start_col, end_col));
+
     auto data_slice_ptr = std::make_shared<t_data_slice<t_ctx0>>(m_ctx, start_row, end_row,
         start_col, end_col, m_row_offset, m_col_offset, slice, col_names);
+    data_slice_ptr->set_snapshot(snapshot);
+    data_slice_ptr->set_columns(std::move(columns));
     return data_slice_ptr;
 }
 
@@ -350,13 +566,21 @@ template <>
 std::shared_ptr<t_data_slice<t_ctx1>>
 View<t_ctx1>::get_data(
     t_uindex start_row, t_uindex end_row, t_uindex start_col, t_uindex end_col) const {
+    PSP_TRACE_SPAN("view.get_data");
+    auto lock = lock_gnode();
     std::vector<t_tscalar> slice = m_ctx->get_data(start_row, end_row, start_col, end_col);
+    scale_slice(slice, column_range(start_col, end_col));
     auto col_names = column_names();
     t_tscalar row_path;
     row_path.set("__ROW_PATH__");
     col_names.insert(col_names.begin(), std::vector<t_tscalar>{row_path});
     auto data_slice_ptr = std::make_shared<t_data_slice<t_ctx1>>(m_ctx, start_row, end_row,
         start_col, end_col, m_row_offset, m_col_offset, slice, col_names);
+
+    // Large slices outlive the lock, so keep the strings they refer to.
+    if (end_row > start_row && end_row - start_row >= PSP_SNAPSHOT_MIN_ROWS) {
+        data_slice_ptr->set_snapshot(snapshot_tree_strings(*m_ctx));
+    }
     return data_slice_ptr;
 }
 
@@ -364,6 +588,8 @@ template <>
 std::shared_ptr<t_data_slice<t_ctx2>>
 View<t_ctx2>::get_data(
     t_uindex start_row, t_uindex end_row, t_uindex start_col, t_uindex end_col) const {
+    PSP_TRACE_SPAN("view.get_data");
+    auto lock = lock_gnode();
     std::vector<t_tscalar> slice;
     std::vector<t_uindex> column_indices;
     std::vector<std::vector<t_tscalar>> cols;
@@ -380,14 +606,7 @@ View<t_ctx2>::get_data(
          * skip them in the underlying slice.
          */
         auto depth = m_column_pivots.size();
-        auto col_length = m_ctx->unity_get_column_count();
-        column_indices.push_back(0);
-        for (t_uindex i = 0; i < col_length; ++i) {
-            if (m_ctx->unity_get_column_path(i + 1).size() == depth) {
-                column_indices.push_back(i + 1);
-            }
-        }
-
+        column_indices = sorted_column_indices(*m_ctx, depth);
         cols = column_names(true, depth);
         column_indices = std::vector<t_uindex>(column_indices.begin() + start_col,
             column_indices.begin() + std::min(end_col, (t_uindex)column_indices.size()));
@@ -407,9 +626,11 @@ View<t_ctx2>::get_data(
             if (iter != slice_with_headers.end())
                 iter++;
         }
+        scale_slice(slice, column_indices);
     } else {
         cols = column_names();
         slice = m_ctx->get_data(start_row, end_row, start_col, end_col);
+        scale_slice(slice, column_range(start_col, end_col));
     }
     // TODO: we need to just use column_paths everywhere instead of row path insertion manually,
     // this causes issues with needing to skip row paths
@@ -418,6 +639,11 @@ View<t_ctx2>::get_data(
     cols.insert(cols.begin(), std::vector<t_tscalar>{row_path});
     auto data_slice_ptr = std::make_shared<t_data_slice<t_ctx2>>(m_ctx, start_row, end_row,
         start_col, end_col, m_row_offset, m_col_offset, slice, cols, column_indices);
+
+    // Large slices outlive the lock, so keep the strings they refer to.
+    if (end_row > start_row && end_row - start_row >= PSP_SNAPSHOT_MIN_ROWS) {
+        data_slice_ptr->set_snapshot(snapshot_tree_strings(*m_ctx));
+    }
     return data_slice_ptr;
 }
 
@@ -425,16 +651,271 @@ template <typename CTX_T>
 std::shared_ptr<std::string>
 View<CTX_T>::to_arrow(std::int32_t start_row, std::int32_t end_row,
     std::int32_t start_col, std::int32_t end_col) const {
+    PSP_TRACE_SPAN("view.to_arrow");
+
+    // The version is read before the data, so that an update in between
+    // serializes its data under the older version, which is not served.
+    t_slice_cache_entry entry{0, start_row, end_row, start_col, end_col, get_data_version()};
+    entry.m_bytes = get_cached_slice(entry);
+    if (entry.m_bytes) {
+        return entry.m_bytes;
+    }
+
     std::shared_ptr<t_data_slice<CTX_T>> data_slice = get_data(
         start_row, end_row, start_col, end_col
     );
-    return data_slice_to_arrow(data_slice);
+    entry.m_bytes = batch_to_arrow(data_slice_to_batch(data_slice, true));
+    cache_slice(entry);
+    return entry.m_bytes;
 };
 
+template <typename CTX_T>
+void
+View<CTX_T>::to_arrow_chunked(std::int32_t start_row, std::int32_t end_row,
+    std::int32_t start_col, std::int32_t end_col, std::int32_t chunk_size,
+    const std::function<void(std::shared_ptr<std::string>)>& callback) const {
+    PSP_VERBOSE_ASSERT(chunk_size > 0, "Arrow chunk size must be positive");
+    std::int32_t chunk_start = start_row;
+    do {
+        std::int32_t chunk_end = end_row;
+        if (chunk_end - chunk_start > chunk_size) {
+            chunk_end = chunk_start + chunk_size;
+        }
+
+        // Release each chunk's data slice before building the next one.
+        callback(to_arrow(chunk_start, chunk_end, start_col, end_col));
+        chunk_start = chunk_end;
+    } while (chunk_start < end_row);
+}
+
+template <typename CTX_T>
+std::int32_t
+View<CTX_T>::open_cursor(std::int32_t start_col, std::int32_t end_col, bool snapshot) {
+    t_view_cursor cursor{start_col, end_col, snapshot, 0, 0, nullptr, {}};
+    {
+        auto lock = lock_gnode();
+        cursor.m_version = m_ctx->get_data_version();
+        if (snapshot) {
+            snapshot_cursor(cursor);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_cursor_mutex);
+    std::int32_t cursor_id = ++m_last_cursor_id;
+    m_cursors[cursor_id] = std::move(cursor);
+    return cursor_id;
+}
+
+template <typename CTX_T>
+std::shared_ptr<std::string>
+View<CTX_T>::cursor_to_arrow(std::int32_t cursor_id, std::int32_t page_size) {
+    PSP_VERBOSE_ASSERT(page_size > 0, "Cursor page size must be positive");
+    PSP_TRACE_SPAN("view.cursor_to_arrow");
+    t_view_cursor cursor;
+    t_uindex start_row;
+    t_uindex end_row;
+
+    // The page is claimed under the lock, so that concurrent calls on one
+    // cursor read successive pages.
+    {
+        std::lock_guard<std::mutex> lock(m_cursor_mutex);
+        auto iter = m_cursors.find(cursor_id);
+        if (iter == m_cursors.end()) {
+            PSP_COMPLAIN_AND_ABORT("Cursor is not open");
+        }
+
+        t_view_cursor& open = iter->second;
+        t_uindex nrows = open.m_ctx_snapshot ? open.m_ctx_snapshot->m_rows.size() : num_rows();
+        if (open.m_position >= nrows) {
+            return nullptr;
+        }
+
+        start_row = open.m_position;
+        end_row = std::min(nrows, start_row + page_size);
+        open.m_position = end_row;
+        cursor = open;
+    }
+
+    return batch_to_arrow(data_slice_to_batch(get_cursor_data(cursor, start_row, end_row), true));
+}
+
+template <typename CTX_T>
+void
+View<CTX_T>::close_cursor(std::int32_t cursor_id) {
+    std::lock_guard<std::mutex> lock(m_cursor_mutex);
+    m_cursors.erase(cursor_id);
+}
+
+template <typename CTX_T>
+void
+View<CTX_T>::snapshot_cursor(t_view_cursor& cursor) const {}
+
+template <>
+void
+View<t_ctx0>::snapshot_cursor(t_view_cursor& cursor) const {
+    cursor.m_ctx_snapshot = m_ctx->get_snapshot(
+        0, m_ctx->get_row_count(), cursor.m_start_col, cursor.m_end_col);
+    cursor.m_column_names = column_names();
+}
+
+template <typename CTX_T>
+std::shared_ptr<t_data_slice<CTX_T>>
+View<CTX_T>::get_cursor_data(
+    const t_view_cursor& cursor, t_uindex start_row, t_uindex end_row) const {
+    auto lock = lock_gnode();
+    if (cursor.m_snapshot && m_ctx->get_data_version() != cursor.m_version) {
+        PSP_COMPLAIN_AND_ABORT("View was updated while a snapshot cursor was open");
+    }
+    return get_data(start_row, end_row, cursor.m_start_col, cursor.m_end_col);
+}
+
+template <>
+std::shared_ptr<t_data_slice<t_ctx0>>
+View<t_ctx0>::get_cursor_data(
+    const t_view_cursor& cursor, t_uindex start_row, t_uindex end_row) const {
+    if (!cursor.m_ctx_snapshot) {
+        return get_data(start_row, end_row, cursor.m_start_col, cursor.m_end_col);
+    }
+
+    // The page is read from the snapshot without the gnode's lock, as a
+    // snapshot of its rows of the cursor's snapshot.
+    const std::vector<t_index>& rows = cursor.m_ctx_snapshot->m_rows;
+    auto page = std::make_shared<t_ctx_snapshot>();
+    page->m_tables = cursor.m_ctx_snapshot->m_tables;
+    page->m_rows.assign(rows.begin() + start_row, rows.begin() + end_row);
+
+    std::vector<t_tscalar> slice;
+    std::vector<t_slice_column> columns;
+    if (m_table->get_column_scales().empty()) {
+        columns = m_ctx->get_columns(*page, cursor.m_start_col, cursor.m_end_col);
+    }
+    if (columns.empty()) {
+        slice = m_ctx->get_data(*page, cursor.m_start_col, cursor.m_end_col);
+        scale_slice(slice, column_range(cursor.m_start_col, cursor.m_end_col));
+    }
+
+    auto data_slice_ptr = std::make_shared<t_data_slice<t_ctx0>>(m_ctx, start_row, end_row,
+        cursor.m_start_col, cursor.m_end_col, m_row_offset, m_col_offset, slice,
+        cursor.m_column_names);
+    data_slice_ptr->set_snapshot(page);
+    data_slice_ptr->set_columns(std::move(columns));
+    return data_slice_ptr;
+}
+
 template <typename CTX_T>
 std::shared_ptr<std::string>
 View<CTX_T>::data_slice_to_arrow(
     std::shared_ptr<t_data_slice<CTX_T>> data_slice) const {
+    return batch_to_arrow(data_slice_to_batch(data_slice));
+}
+
+template <typename CTX_T>
+std::shared_ptr<std::string>
+View<CTX_T>::batch_to_arrow(std::shared_ptr<::arrow::RecordBatch> batches) const {
+    PSP_TRACE_SPAN("view.write_arrow");
+    auto arrow_schema = batches->schema();
+
+    // The stream is written over the buffer of the last call, which closing
+    // the sink trims to the length of its output, so that a view serialized
+    // repeatedly at a similar size does not regrow a buffer each time.
+    std::lock_guard<std::mutex> lock(m_arrow_mutex);
+    if (m_arrow_buffer == nullptr) {
+        auto allocated = ::arrow::AllocateResizableBuffer(0, &m_arrow_buffer);
+        if (!allocated.ok()) {
+            std::stringstream ss;
+            ss << "Failed to allocate buffer: " << allocated.message() << std::endl;
+            PSP_COMPLAIN_AND_ABORT(ss.str());
+        }
+    }
+    std::shared_ptr<::arrow::ResizableBuffer> buffer = m_arrow_buffer;
+
+    ::arrow::io::BufferOutputStream sink(buffer);
+    
+    auto options = ::arrow::ipc::IpcOptions::Defaults();
+    // options.allow_64bit = true;
+    // options.write_legacy_ipc_format = true;
+    // options.alignment = 64;
+
+    auto res = ::arrow::ipc::RecordBatchStreamWriter::Open(&sink, arrow_schema, options);
+    std::shared_ptr<::arrow::ipc::RecordBatchWriter> writer = *res;
+
+    PSP_CHECK_ARROW_STATUS(writer->WriteRecordBatch(*batches));
+    PSP_CHECK_ARROW_STATUS(writer->Close());
+    PSP_CHECK_ARROW_STATUS(sink.Close());
+    return std::make_shared<std::string>(buffer->ToString());
+}
+
+#ifdef PSP_ENABLE_PARQUET
+template <typename CTX_T>
+std::shared_ptr<std::string>
+View<CTX_T>::to_parquet(std::int32_t start_row, std::int32_t end_row,
+    std::int32_t start_col, std::int32_t end_col, std::int32_t row_group_size) const {
+    PSP_VERBOSE_ASSERT(row_group_size > 0, "Parquet row group size must be positive");
+    PSP_TRACE_SPAN("view.to_parquet");
+    t_slice_cache_entry entry{
+        row_group_size, start_row, end_row, start_col, end_col, get_data_version()};
+    entry.m_bytes = get_cached_slice(entry);
+    if (entry.m_bytes) {
+        return entry.m_bytes;
+    }
+
+    std::shared_ptr<t_data_slice<CTX_T>> data_slice = get_data(
+        start_row, end_row, start_col, end_col
+    );
+
+    std::shared_ptr<::arrow::RecordBatch> batches = data_slice_to_batch(data_slice, true);
+    std::shared_ptr<::arrow::Table> table;
+    PSP_CHECK_ARROW_STATUS(::arrow::Table::FromRecordBatches({batches}, &table));
+
+    std::shared_ptr<::arrow::io::BufferOutputStream> sink;
+    PSP_CHECK_ARROW_STATUS(::arrow::io::BufferOutputStream::Create(
+        0, ::arrow::default_memory_pool(), &sink));
+    PSP_CHECK_ARROW_STATUS(::parquet::arrow::WriteTable(
+        *table, ::arrow::default_memory_pool(), sink, row_group_size));
+
+    std::shared_ptr<::arrow::Buffer> buffer;
+    PSP_CHECK_ARROW_STATUS(sink->Finish(&buffer));
+    entry.m_bytes = std::make_shared<std::string>(buffer->ToString());
+    cache_slice(entry);
+    return entry.m_bytes;
+}
+#endif
+
+template <typename CTX_T>
+std::shared_ptr<::arrow::Array>
+View<CTX_T>::string_col_to_array(const std::vector<t_tscalar>& slice, std::int32_t cidx,
+    std::int32_t stride, t_get_data_extents extents, bool from_get_data,
+    const t_ctx_snapshot* snapshot) const {
+    return arrow::string_col_to_dictionary_array(slice, cidx, stride, extents);
+}
+
+template <>
+std::shared_ptr<::arrow::Array>
+View<t_ctx0>::string_col_to_array(const std::vector<t_tscalar>& slice, std::int32_t cidx,
+    std::int32_t stride, t_get_data_extents extents, bool from_get_data,
+    const t_ctx_snapshot* snapshot) const {
+    // Other slices, such as row deltas, are not a range of the view's rows.
+    if (!from_get_data) {
+        return arrow::string_col_to_dictionary_array(slice, cidx, stride, extents);
+    }
+
+    std::vector<std::int32_t> ids;
+    if (snapshot) {
+        std::shared_ptr<const t_column> col = m_ctx->get_string_ids(*snapshot, cidx, ids);
+        return arrow::vocab_to_dictionary_array(ids, *col->_get_vocab());
+    }
+
+    auto lock = lock_gnode();
+    std::shared_ptr<const t_column> col
+        = m_ctx->get_string_ids(cidx, extents.m_srow, extents.m_erow, ids);
+    return arrow::vocab_to_dictionary_array(ids, *col->_get_vocab());
+}
+
+template <typename CTX_T>
+std::shared_ptr<::arrow::RecordBatch>
+View<CTX_T>::data_slice_to_batch(
+    std::shared_ptr<t_data_slice<CTX_T>> data_slice, bool from_get_data) const {
+    PSP_TRACE_SPAN("view.slice_to_batch");
     // From the data slice, get all the metadata we need
     t_get_data_extents extents = data_slice->get_data_extents();
     std::int32_t start_col = extents.m_scol;
@@ -442,12 +923,15 @@ View<CTX_T>::data_slice_to_arrow(
     std::int32_t col_offset = data_slice->get_col_offset();
     start_col += col_offset;
 
-    auto slice = data_slice->get_slice();
+    const auto& slice = data_slice->get_slice();
     auto stride = data_slice->get_stride();
-    auto names = data_slice->get_column_names();
+    auto snapshot = data_slice->get_snapshot();
+    const auto& names = data_slice->get_column_names();
+    bool has_columns = data_slice->has_columns();
 
     std::vector<std::shared_ptr<::arrow::Array>> vectors;
-    std::vector<std::shared_ptr<::arrow::Field>> fields;
+    t_arrow_schema_key schema_key;
+    schema_key.reserve(std::max(end_col - start_col, 0));
 
     for (auto cidx = start_col; cidx < end_col; ++cidx) {
         std::vector<t_tscalar> col_path = names.at(cidx);
@@ -459,67 +943,61 @@ View<CTX_T>::data_slice_to_arrow(
         } else {
             name = col_path.at(col_path.size() - 1).to_string();
         }
+        schema_key.emplace_back(name, dtype);
 
         std::shared_ptr<::arrow::Array> arr;
+        // A slice read as columns has no scalars to fall back to.
+        if (has_columns) {
+            arr = arrow::slice_column_to_array(data_slice->get_column(cidx));
+            vectors.push_back(arr);
+            continue;
+        }
+
         switch (dtype) {
             case DTYPE_INT8: {
-                fields.push_back(::arrow::field(name, ::arrow::int8()));
                 arr = arrow::numeric_col_to_array<::arrow::Int8Type, std::int8_t>(slice, cidx, stride, extents);
             } break;
             case DTYPE_UINT8: {
-                fields.push_back(::arrow::field(name, ::arrow::uint8()));
                 arr = arrow::numeric_col_to_array<::arrow::UInt8Type, std::uint8_t>(slice, cidx, stride, extents);
             } break;
             case DTYPE_INT16: {
-                fields.push_back(::arrow::field(name, ::arrow::int16()));
                 arr = arrow::numeric_col_to_array<::arrow::Int16Type, std::int16_t>(slice, cidx, stride, extents);
             } break;
             case DTYPE_UINT16: {
-                fields.push_back(::arrow::field(name, ::arrow::uint16()));
                 arr = arrow::numeric_col_to_array<::arrow::UInt16Type, std::uint16_t>(slice, cidx, stride, extents);
             } break;
             case DTYPE_INT32: {
-                fields.push_back(::arrow::field(name, ::arrow::int32()));
                 arr = arrow::numeric_col_to_array<::arrow::Int32Type, std::int32_t>(slice, cidx, stride, extents);
             } break;
             case DTYPE_UINT32: {
-                fields.push_back(::arrow::field(name, ::arrow::uint32()));
                 arr = arrow::numeric_col_to_array<::arrow::UInt32Type, std::uint32_t>(slice, cidx, stride, extents);
             } break;
             case DTYPE_INT64: {
-                fields.push_back(::arrow::field(name, ::arrow::int64()));
                 arr = arrow::numeric_col_to_array<::arrow::Int64Type, std::int64_t>(slice, cidx, stride, extents);
             } break;
             case DTYPE_UINT64: {
-                fields.push_back(::arrow::field(name, ::arrow::uint64()));
                 arr = arrow::numeric_col_to_array<::arrow::UInt64Type, std::uint64_t>(slice, cidx, stride, extents);
             } break;
             case DTYPE_FLOAT32: {
-                fields.push_back(::arrow::field(name, ::arrow::float32()));
                 arr = arrow::numeric_col_to_array<::arrow::FloatType, float>(slice, cidx, stride, extents);
             } break;
             case DTYPE_FLOAT64: {
-                fields.push_back(::arrow::field(name, ::arrow::float64()));
                 arr = arrow::numeric_col_to_array<::arrow::DoubleType, double>(slice, cidx, stride, extents);
             } break;
             case DTYPE_DATE: {
-                fields.push_back(::arrow::field(name, ::arrow::date32()));
                 arr = arrow::date_col_to_array(slice, cidx, stride, extents);
             } break;
             case DTYPE_TIME: {
-                fields.push_back(::arrow::field(name, ::arrow::timestamp(::arrow::TimeUnit::MILLI)));
                 arr = arrow::timestamp_col_to_array(slice, cidx, stride, extents);
             } break;
             case DTYPE_BOOL: {
-                fields.push_back(::arrow::field(name, ::arrow::boolean()));
                 arr = arrow::boolean_col_to_array(slice, cidx, stride, extents);
             } break;
             case DTYPE_STR: {
-                fields.push_back(::arrow::field(name, ::arrow::dictionary(::arrow::int32(), ::arrow::utf8())));
-                arr = arrow::string_col_to_dictionary_array(slice, cidx, stride, extents);
+                arr = string_col_to_array(
+                    slice, cidx, stride, extents, from_get_data, snapshot.get());
             } break;
             case DTYPE_OBJECT: {
-                fields.push_back(::arrow::field(name, ::arrow::uint64()));
                 arr = arrow::numeric_col_to_array<::arrow::UInt64Type, std::uint64_t>(slice, cidx, stride, extents);
             } break;
             default: {
@@ -534,7 +1012,7 @@ View<CTX_T>::data_slice_to_arrow(
         vectors.push_back(arr);
     }
 
-    auto arrow_schema = ::arrow::schema(fields);
+    auto arrow_schema = get_arrow_schema(schema_key);
     auto num_rows = data_slice->num_rows();
     std::shared_ptr<::arrow::RecordBatch> batches = 
         ::arrow::RecordBatch::Make(arrow_schema, num_rows, vectors);
@@ -545,27 +1023,82 @@ View<CTX_T>::data_slice_to_arrow(
         PSP_COMPLAIN_AND_ABORT(ss.str());
     }
 
-    std::shared_ptr<::arrow::ResizableBuffer> buffer;
-    auto allocated = ::arrow::AllocateResizableBuffer(0, &buffer);
-    if (!allocated.ok()) {
-        std::stringstream ss;
-        ss << "Failed to allocate buffer: " << allocated.message() << std::endl;
-        PSP_COMPLAIN_AND_ABORT(ss.str());
+    return batches;
+}
+
+template <typename CTX_T>
+std::shared_ptr<::arrow::Schema>
+View<CTX_T>::get_arrow_schema(const t_arrow_schema_key& key) const {
+    std::lock_guard<std::mutex> lock(m_arrow_mutex);
+    if (m_arrow_schema == nullptr || m_arrow_schema_key != key) {
+        std::vector<std::shared_ptr<::arrow::Field>> fields;
+        fields.reserve(key.size());
+        for (const auto& column : key) {
+            fields.push_back(::arrow::field(column.first, arrow::dtype_to_arrow_type(column.second)));
+        }
+        m_arrow_schema = ::arrow::schema(fields);
+        m_arrow_schema_key = key;
     }
-    
-    ::arrow::io::BufferOutputStream sink(buffer);    
-    
-    auto options = ::arrow::ipc::IpcOptions::Defaults();
-    // options.allow_64bit = true;
-    // options.write_legacy_ipc_format = true;
-    // options.alignment = 64;
+    return m_arrow_schema;
+}
 
-    auto res = ::arrow::ipc::RecordBatchStreamWriter::Open(&sink, arrow_schema, options);
-    std::shared_ptr<::arrow::ipc::RecordBatchWriter> writer = *res;
+template <typename CTX_T>
+std::unique_lock<std::recursive_mutex>
+View<CTX_T>::lock_gnode() const {
+    return m_table->get_pool()->lock_gnode(m_table->get_gnode()->get_id());
+}
 
-    PSP_CHECK_ARROW_STATUS(writer->WriteRecordBatch(*batches));
-    PSP_CHECK_ARROW_STATUS(writer->Close());
-    return std::make_shared<std::string>(buffer->ToString());
+template <typename CTX_T>
+t_uindex
+View<CTX_T>::get_data_version() const {
+    auto lock = lock_gnode();
+    return m_ctx->get_data_version();
+}
+
+template <typename CTX_T>
+std::shared_ptr<std::string>
+View<CTX_T>::get_cached_slice(const t_slice_cache_entry& key) const {
+    if (t_env::view_slice_cache_size() == 0) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(m_slice_cache_mutex);
+    m_slice_cache.erase(std::remove_if(m_slice_cache.begin(), m_slice_cache.end(),
+                            [&key](const t_slice_cache_entry& entry) {
+                                return entry.m_version < key.m_version;
+                            }),
+        m_slice_cache.end());
+
+    for (auto iter = m_slice_cache.begin(); iter != m_slice_cache.end(); ++iter) {
+        if (iter->m_format == key.m_format && iter->m_start_row == key.m_start_row
+            && iter->m_end_row == key.m_end_row && iter->m_start_col == key.m_start_col
+            && iter->m_end_col == key.m_end_col && iter->m_version == key.m_version) {
+            std::rotate(m_slice_cache.begin(), iter, iter + 1);
+            return m_slice_cache.front().m_bytes;
+        }
+    }
+    return nullptr;
+}
+
+template <typename CTX_T>
+void
+View<CTX_T>::cache_slice(const t_slice_cache_entry& entry) const {
+    t_uindex capacity = t_env::view_slice_cache_size();
+    if (capacity == 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_slice_cache_mutex);
+
+    // An update while this slice was read has already made it stale.
+    if (!m_slice_cache.empty() && m_slice_cache.front().m_version > entry.m_version) {
+        return;
+    }
+
+    if (m_slice_cache.size() >= capacity) {
+        m_slice_cache.pop_back();
+    }
+    m_slice_cache.insert(m_slice_cache.begin(), entry);
 }
 
 // Delta calculation
@@ -662,6 +1195,55 @@ View<t_ctx2>::set_depth(std::int32_t depth, std::int32_t row_pivot_length) {
     }
 }
 
+template <>
+std::vector<std::vector<t_tscalar>>
+View<t_ctx0>::get_expansion_state() const {
+    return std::vector<std::vector<t_tscalar>>();
+}
+
+template <typename CTX_T>
+std::vector<std::vector<t_tscalar>>
+View<CTX_T>::get_expansion_state() const {
+    std::vector<std::vector<t_tscalar>> rval;
+    for (const t_path& path : m_ctx->get_expansion_state()) {
+        rval.push_back(path.path());
+    }
+    return rval;
+}
+
+template <>
+void
+View<t_ctx0>::set_expansion_state(const std::vector<std::vector<t_tscalar>>& paths) {}
+
+template <typename CTX_T>
+void
+View<CTX_T>::set_expansion_state(const std::vector<std::vector<t_tscalar>>& paths) {
+    std::vector<t_path> expansion_state(paths.begin(), paths.end());
+    m_ctx->set_expansion_state(expansion_state);
+}
+
+template <>
+void
+View<t_ctx0>::set_lazy_aggregates(bool enabled) {}
+
+template <typename CTX_T>
+void
+View<CTX_T>::set_lazy_aggregates(bool enabled) {
+    m_ctx->set_lazy_aggregates(enabled);
+}
+
+template <>
+bool
+View<t_ctx0>::get_lazy_aggregates() const {
+    return false;
+}
+
+template <typename CTX_T>
+bool
+View<CTX_T>::get_lazy_aggregates() const {
+    return m_ctx->get_lazy_aggregates();
+}
+
 // Getters
 template <typename CTX_T>
 std::shared_ptr<CTX_T>
@@ -669,6 +1251,12 @@ View<CTX_T>::get_context() const {
     return m_ctx;
 }
 
+template <typename CTX_T>
+std::shared_ptr<Table>
+View<CTX_T>::get_table() const {
+    return m_table;
+}
+
 template <typename CTX_T>
 std::vector<std::string>
 View<CTX_T>::get_row_pivots() const {
@@ -727,7 +1315,7 @@ template <typename CTX_T>
 std::shared_ptr<t_data_slice<CTX_T>>
 View<CTX_T>::get_row_delta() const {
     t_rowdelta delta = m_ctx->get_row_delta();
-    const std::vector<t_tscalar>& data = delta.data;
+    std::vector<t_tscalar>& data = delta.data;
     t_uindex num_rows_changed = delta.num_rows_changed;
     
     auto paths = column_paths();
@@ -741,24 +1329,479 @@ View<CTX_T>::get_row_delta() const {
 
     // Column count for row delta needs to include `__ROW_PATH__`
     t_uindex num_columns = m_ctx->get_column_count();
+    scale_slice(data, column_range(0, num_columns));
 
     return std::make_shared<t_data_slice<CTX_T>>(
         m_ctx, 0, num_rows_changed, 0, num_columns,
         m_row_offset, m_col_offset, data, paths);
 }
 
+// Rows of a flat view past its viewport are only sorted as they are read.
+template <>
+void
+View<t_ctx0>::set_viewport(
+    t_uindex start_row, t_uindex end_row, t_uindex start_col, t_uindex end_col) {
+    auto lock = lock_gnode();
+    m_ctx->set_viewport(t_viewport(start_row, end_row, start_col, end_col));
+    m_ctx->set_sort_limit(end_row);
+}
+
+template <>
+void
+View<t_ctx0>::clear_viewport() {
+    auto lock = lock_gnode();
+    m_ctx->clear_viewport();
+    m_ctx->set_sort_limit(t_env::sort_limit());
+}
+
+// A sorted view hides the header columns its context makes for sorted
+// columns, so the viewport's columns are those the view's columns are read
+// from, as of the call.
+template <>
+void
+View<t_ctx2>::set_viewport(
+    t_uindex start_row, t_uindex end_row, t_uindex start_col, t_uindex end_col) {
+    auto lock = lock_gnode();
+    if (m_sort.size() > 0) {
+        std::vector<t_uindex> column_indices
+            = sorted_column_indices(*m_ctx, m_column_pivots.size());
+        t_uindex ncols = column_indices.size();
+
+        // Columns past those the view has now are any the context adds.
+        t_uindex ctx_start_col
+            = start_col < ncols ? column_indices[start_col] : column_indices.back() + 1;
+        t_uindex ctx_end_col = ctx_start_col;
+        if (end_col <= start_col) {
+            // An empty viewport stays empty.
+        } else if (end_col >= ncols) {
+            ctx_end_col = std::numeric_limits<t_uindex>::max();
+        } else {
+            ctx_end_col = column_indices[end_col - 1] + 1;
+        }
+
+        start_col = ctx_start_col;
+        end_col = ctx_end_col;
+    }
+
+    m_ctx->set_viewport(t_viewport(start_row + m_row_offset, end_row + m_row_offset,
+        start_col, end_col));
+}
+
+template <typename CTX_T>
+void
+View<CTX_T>::set_viewport(
+    t_uindex start_row, t_uindex end_row, t_uindex start_col, t_uindex end_col) {
+    // Column-only contexts have a header row that the view hides.
+    m_ctx->set_viewport(t_viewport(start_row + m_row_offset, end_row + m_row_offset,
+        start_col, end_col));
+}
+
+template <typename CTX_T>
+void
+View<CTX_T>::clear_viewport() {
+    m_ctx->clear_viewport();
+}
+
+template <typename CTX_T>
+bool
+View<CTX_T>::set_priority(t_ctx_priority priority) {
+    return m_table->get_pool()->set_context_priority(
+        m_table->get_gnode()->get_id(), m_name, priority);
+}
+
+template <typename CTX_T>
+t_ctx_priority
+View<CTX_T>::get_priority() const {
+    auto lock = lock_gnode();
+    return m_table->get_gnode()->get_context_priority(m_name);
+}
+
+template <typename CTX_T>
+void
+View<CTX_T>::freeze() {
+    m_table->get_pool()->freeze_context(m_table->get_gnode()->get_id(), m_name);
+}
+
+template <typename CTX_T>
+bool
+View<CTX_T>::thaw() {
+    return m_table->get_pool()->thaw_context(m_table->get_gnode()->get_id(), m_name);
+}
+
+template <typename CTX_T>
+bool
+View<CTX_T>::is_frozen() const {
+    auto lock = lock_gnode();
+    return m_table->get_gnode()->is_context_frozen(m_name);
+}
+
+template <typename CTX_T>
+void
+View<CTX_T>::set_memory_budget(t_uindex nbytes) {
+    auto lock = lock_gnode();
+    m_table->get_gnode()->set_context_memory_budget(m_name, nbytes);
+}
+
+template <typename CTX_T>
+t_uindex
+View<CTX_T>::get_memory_budget() const {
+    auto lock = lock_gnode();
+    return m_table->get_gnode()->get_context_memory_budget(m_name);
+}
+
+template <typename CTX_T>
+t_uindex
+View<CTX_T>::reclaim_memory() {
+    auto lock = lock_gnode();
+    return m_table->get_gnode()->reclaim_context(m_name);
+}
+
+template <typename CTX_T>
+bool
+View<CTX_T>::build(t_uindex max_rows) {
+    return m_table->get_pool()->build_context(
+        m_table->get_gnode()->get_id(), m_name, max_rows);
+}
+
+template <typename CTX_T>
+double
+View<CTX_T>::get_build_progress() const {
+    auto lock = lock_gnode();
+    return m_table->get_gnode()->get_context_build_progress(m_name);
+}
+
+template <typename CTX_T>
+std::map<std::string, double>
+View<CTX_T>::get_latency_stats() const {
+    auto lock = lock_gnode();
+    return m_table->get_gnode()->get_context_latency_stats(m_name);
+}
+
+template <typename CTX_T>
+void
+View<CTX_T>::reset_latency_stats() {
+    auto lock = lock_gnode();
+    m_table->get_gnode()->reset_context_latency_stats(m_name);
+}
+
+template <typename CTX_T>
+bool
+View<CTX_T>::get_row_count_changed() const {
+    return m_ctx->get_row_count_changed();
+}
+
+static std::int64_t
+steady_now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+template <typename CTX_T>
+void
+View<CTX_T>::set_notify_interval(t_uindex interval_us) {
+    auto lock = lock_gnode();
+    m_ctx->set_coalesce_deltas(interval_us > 0);
+    m_notify_interval.store(interval_us);
+}
+
+template <typename CTX_T>
+t_uindex
+View<CTX_T>::get_notify_interval() const {
+    return m_notify_interval.load();
+}
+
+template <typename CTX_T>
+t_uindex
+View<CTX_T>::get_notify_delay() const {
+    t_uindex interval = m_notify_interval.load();
+    if (interval == 0) {
+        return 0;
+    }
+
+    std::int64_t elapsed = steady_now_us() - m_notified_at.load();
+    if (elapsed >= 0 && static_cast<t_uindex>(elapsed) >= interval) {
+        return 0;
+    }
+
+    return interval - static_cast<t_uindex>(std::max<std::int64_t>(elapsed, 0));
+}
+
+template <typename CTX_T>
+void
+View<CTX_T>::set_notified() {
+    m_notified_at.store(steady_now_us());
+}
+
+template <>
+std::vector<t_tscalar>
+View<t_ctx0>::get_value_pkeys(std::int32_t ridx) const {
+    std::vector<std::pair<t_uindex, t_uindex>> cells;
+    t_uindex num_rows = m_ctx->get_row_count();
+    cells.reserve(num_rows);
+
+    for (t_uindex idx = 0; idx < num_rows; ++idx) {
+        cells.push_back(std::pair<t_uindex, t_uindex>(idx, 0));
+    }
+
+    return m_ctx->get_pkeys(cells);
+}
+
+template <>
+std::vector<t_tscalar>
+View<t_ctx1>::get_value_pkeys(std::int32_t ridx) const {
+    std::vector<std::pair<t_uindex, t_uindex>> cells{std::pair<t_uindex, t_uindex>(ridx, 0)};
+    return m_ctx->get_pkeys(cells);
+}
+
+template <>
+std::vector<t_tscalar>
+View<t_ctx2>::get_value_pkeys(std::int32_t ridx) const {
+    return m_ctx->get_row_pkeys(ridx);
+}
+
+template <typename CTX_T>
+t_histogram
+View<CTX_T>::get_histogram(const std::string& column_name, std::uint32_t nbuckets,
+    t_binning binning, std::int32_t ridx) const {
+    return m_ctx->get_histogram(get_value_pkeys(ridx), column_name, nbuckets, binning);
+}
+
+template <typename CTX_T>
+t_minmax
+View<CTX_T>::get_min_max(const std::string& column_name, std::int32_t ridx) const {
+    return m_ctx->get_values_min_max(get_value_pkeys(ridx), column_name);
+}
+
 template <typename CTX_T>
 t_dtype
 View<CTX_T>::get_column_dtype(t_uindex idx) const {
+    if (get_column_scale(idx) > 0) {
+        return DTYPE_FLOAT64;
+    }
     return m_ctx->get_column_dtype(idx);
 }
 
+
 template <typename CTX_T>
 bool
 View<CTX_T>::is_column_only() const {
     return m_view_config->is_column_only();
 }
 
+template <typename CTX_T>
+std::shared_ptr<t_slice_column>
+View<CTX_T>::get_column(t_uindex start_row, t_uindex end_row, t_uindex cidx) const {
+    return nullptr;
+}
+
+template <>
+std::shared_ptr<t_slice_column>
+View<t_ctx0>::get_column(t_uindex start_row, t_uindex end_row, t_uindex cidx) const {
+    PSP_TRACE_SPAN("view.get_column");
+    auto lock = lock_gnode();
+    auto ext = sanitize_get_data_extents(m_ctx->get_row_count(), m_ctx->get_column_count(),
+        start_row, end_row, cidx, cidx + 1);
+    if (ext.m_scol >= ext.m_ecol || get_column_scale(ext.m_scol) > 0) {
+        return nullptr;
+    }
+
+    return m_ctx->get_column(ext.m_scol, ext.m_srow, ext.m_erow);
+}
+
+namespace {
+    void
+    write_json_strings(std::ostream& os, const std::vector<std::string>& strs) {
+        os << "[";
+        for (t_uindex idx = 0; idx < strs.size(); ++idx) {
+            if (idx > 0) {
+                os << ",";
+            }
+            write_json_string(os, strs[idx]);
+        }
+        os << "]";
+    }
+
+    const char*
+    aggregate_update_strategy(const t_aggspec& aggspec) {
+        if (aggspec.is_running_agg()) {
+            return "running";
+        } else if (aggspec.is_multiset_agg()) {
+            return "multiset";
+        } else if (aggspec.is_sketch_agg()) {
+            return "sketch";
+        } else if (aggspec.is_rolling_agg()) {
+            return "rolling";
+        } else if (aggspec.is_reducer_agg()) {
+            return "reducer";
+        } else if (aggspec.is_leaf_scan_agg()) {
+            return "leaf_scan";
+        }
+        return "incremental";
+    }
+} // namespace
+
+template <typename CTX_T>
+std::string
+View<CTX_T>::explain() const {
+    PSP_TRACE_SPAN("view.explain");
+    auto lock = lock_gnode();
+    const t_config& config = m_ctx->get_config();
+    std::shared_ptr<t_gnode> gnode = m_table->get_gnode();
+    t_uindex table_rows = gnode->mapping_size();
+
+    std::stringstream ss;
+    ss << std::setprecision(6);
+    ss << "{\"sides\":" << sides() << ",\"table_rows\":" << table_rows
+       << ",\"num_rows\":" << num_rows() << ",\"num_columns\":" << num_columns();
+    ss << ",\"row_pivots\":";
+    write_json_strings(ss, m_row_pivots);
+    ss << ",\"column_pivots\":";
+    write_json_strings(ss, m_column_pivots);
+
+    // Filters are measured one term at a time and combined, against the
+    // rows of the master table, computed columns included.
+    const std::vector<t_fterm>& fterms = config.get_fterms();
+    t_uindex filtered_rows = table_rows;
+    std::shared_ptr<t_data_table> rows;
+    if (config.has_filters() && table_rows > 0) {
+        rows = gnode->get_pkeyed_table_sptr();
+    }
+
+    ss << ",\"filter_combiner\":";
+    write_json_string(ss, filter_op_to_str(config.get_combiner()));
+    if (config.get_fmode() == FMODE_JIT_EXPR) {
+        ss << ",\"filter_expression\":";
+        write_json_string(ss, config.get_filter_expr().get_expr());
+    }
+    ss << ",\"filters\":[";
+    bool measurable = rows != nullptr;
+    for (t_uindex idx = 0; idx < fterms.size(); ++idx) {
+        const t_fterm& fterm = fterms[idx];
+        if (idx > 0) {
+            ss << ",";
+        }
+        ss << "{\"column\":";
+        write_json_string(ss, fterm.m_colname);
+        ss << ",\"op\":";
+        write_json_string(ss, filter_op_to_str(fterm.m_op));
+        ss << ",\"expr\":";
+        write_json_string(ss, fterm.get_expr());
+        if (rows && rows->get_schema().has_column(fterm.m_colname)) {
+            t_uindex matched = rows->filter_cpp(FILTER_OP_AND, {fterm}).count();
+            ss << ",\"matched_rows\":" << matched
+               << ",\"selectivity\":" << static_cast<double>(matched) / table_rows;
+        } else {
+            measurable = false;
+        }
+        ss << "}";
+    }
+    ss << "]";
+
+    if (measurable) {
+        filtered_rows = filter_table_for_config(*rows, config).count();
+    }
+    double pass_rate = table_rows > 0 ? static_cast<double>(filtered_rows) / table_rows : 1;
+    ss << ",\"filtered_rows\":" << filtered_rows;
+
+    ss << ",\"sort\":[";
+    for (t_uindex idx = 0; idx < m_sort.size(); ++idx) {
+        if (idx > 0) {
+            ss << ",";
+        }
+        ss << "{\"column\":";
+        write_json_string(ss, m_sort[idx].m_colname);
+        ss << ",\"order\":";
+        write_json_string(ss, sorttype_to_str(m_sort[idx].m_sort_type));
+        ss << "}";
+    }
+    ss << "]";
+
+    // Zero-sided contexts read the table's columns directly.
+    t_uindex num_aggregates = 0;
+    t_uindex num_multiset = 0;
+    t_uindex num_leaf_scan = 0;
+    ss << ",\"aggregates\":[";
+    if (sides() > 0) {
+        for (const t_aggspec& aggspec : config.get_aggregates()) {
+            if (num_aggregates > 0) {
+                ss << ",";
+            }
+            ++num_aggregates;
+            num_multiset += aggspec.is_multiset_agg();
+            num_leaf_scan += aggspec.is_leaf_scan_agg();
+            ss << "{\"column\":";
+            write_json_string(ss, aggspec.name());
+            ss << ",\"aggregate\":";
+            write_json_string(ss, aggspec.agg_str());
+            ss << ",\"strategy\":";
+            write_json_string(ss, aggregate_update_strategy(aggspec));
+            ss << "}";
+        }
+    }
+    ss << "]";
+
+    ss << ",\"computed_columns\":[";
+    for (t_uindex idx = 0; idx < m_computed_columns.size(); ++idx) {
+        const auto& computed = m_computed_columns[idx];
+        if (idx > 0) {
+            ss << ",";
+        }
+        ss << "{\"column\":";
+        write_json_string(ss, std::get<0>(computed));
+        ss << ",\"function\":";
+        write_json_string(ss, computed_function_name_to_string(std::get<1>(computed)));
+        ss << ",\"inputs\":";
+        write_json_strings(ss, std::get<2>(computed));
+        ss << "}";
+    }
+    ss << "]";
+
+    // An updated row passing the filter touches one node per depth of each
+    // tree, and a leaf-scan aggregate rereads every row under each of them.
+    double node_updates = 0;
+    double leaf_reads = 0;
+    ss << ",\"trees\":[";
+    std::vector<t_stree*> trees = m_ctx->get_trees();
+    for (t_uindex idx = 0; idx < trees.size(); ++idx) {
+        const t_stree* tree = trees[idx];
+        if (idx > 0) {
+            ss << ",";
+        }
+        std::vector<std::string> pivots;
+        for (const t_pivot& pivot : tree->get_pivots()) {
+            pivots.push_back(pivot.name());
+        }
+        std::vector<t_uindex> nodes_by_depth = tree->get_num_nodes_by_depth();
+        ss << "{\"pivots\":";
+        write_json_strings(ss, pivots);
+        ss << ",\"nodes\":" << tree->size() << ",\"nodes_by_depth\":[";
+        for (t_uindex depth = 0; depth < nodes_by_depth.size(); ++depth) {
+            if (depth > 0) {
+                ss << ",";
+            }
+            ss << nodes_by_depth[depth];
+            node_updates += pass_rate;
+            leaf_reads += pass_rate * num_leaf_scan * filtered_rows
+                / std::max<t_uindex>(nodes_by_depth[depth], 1);
+        }
+        ss << "],\"nbytes\":" << tree->nbytes() << "}";
+    }
+    ss << "]";
+
+    // Estimated operations per updated row.
+    ss << ",\"estimated_update_cost\":{\"filter_terms\":" << fterms.size()
+       << ",\"computed_columns\":" << m_computed_columns.size()
+       << ",\"node_updates\":" << node_updates
+       << ",\"aggregate_updates\":" << node_updates * num_aggregates
+       << ",\"multiset_updates\":" << node_updates * num_multiset
+       << ",\"leaf_reads\":" << leaf_reads
+       << ",\"sorted\":" << (m_sort.empty() ? "false" : "true") << "}";
+
+    ss << "}";
+    return ss.str();
+}
+
 /******************************************************************************
  *
  * Private
@@ -773,11 +1816,18 @@ View<CTX_T>::_map_aggregate_types(
         if (agg.name() == name) {
             switch (agg.agg()) {
                 case AGGTYPE_DISTINCT_COUNT:
+                case AGGTYPE_APPROX_DISTINCT_COUNT:
+                case AGGTYPE_ROLLING_COUNT:
                 case AGGTYPE_COUNT: {
                     return "integer";
                 } break;
                 case AGGTYPE_MEAN:
                 case AGGTYPE_MEAN_BY_COUNT:
+                case AGGTYPE_APPROX_PERCENTILE:
+                case AGGTYPE_ROLLING_SUM:
+                case AGGTYPE_ROLLING_MEAN:
+                case AGGTYPE_ROLLING_WEIGHTED_MEAN:
+                case AGGTYPE_UDF_REDUCER:
                 case AGGTYPE_WEIGHTED_MEAN:
                 case AGGTYPE_PCT_SUM_PARENT:
                 case AGGTYPE_PCT_SUM_GRAND_TOTAL: {
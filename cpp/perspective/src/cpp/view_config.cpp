@@ -8,9 +8,179 @@
  */
 
 #include <perspective/view_config.h>
+#include <perspective/kernel_engine.h>
+#include <cmath>
 
 namespace perspective {
 
+namespace {
+    // Returns the quantile of an approximate percentile aggregate, written as
+    // `"approx p<N>"` or `["approx percentile", "<N>"]` for a percentile `N`
+    // in `[0, 100]`, or -1 for any other aggregate.
+    double
+    parse_approx_percentile(const std::vector<std::string>& aggregate) {
+        const std::string& name = aggregate.at(0);
+        std::string percentile;
+        if (name == "approx percentile" || name == "approx_percentile") {
+            if (aggregate.size() < 2) {
+                PSP_COMPLAIN_AND_ABORT("`approx percentile` requires a percentile.");
+            }
+            percentile = aggregate.at(1);
+        } else if (name.compare(0, 8, "approx p") == 0 && name.size() > 8) {
+            percentile = name.substr(8);
+        } else {
+            return -1;
+        }
+
+        std::size_t end = 0;
+        double value = -1;
+        try {
+            value = std::stod(percentile, &end);
+        } catch (const std::exception&) {
+            end = 0;
+        }
+
+        if (end != percentile.size() || !(value >= 0 && value <= 100)) {
+            PSP_COMPLAIN_AND_ABORT("Invalid percentile `" + percentile + "`.");
+        }
+
+        return value / 100;
+    }
+
+    // Returns the reducer of a UDF reducer aggregate, written as
+    // `["reducer", "<name>"]` for a reducer registered with the
+    // `t_kernel_evaluator`, or an empty string for any other aggregate.
+    std::string
+    parse_reducer(const std::vector<std::string>& aggregate) {
+        if (aggregate.at(0) != "reducer") {
+            return "";
+        }
+
+        if (aggregate.size() != 2) {
+            PSP_COMPLAIN_AND_ABORT("`reducer` requires the name of a registered reducer.");
+        }
+
+        if (!get_evaluator()->has_reducer(aggregate.at(1))) {
+            PSP_COMPLAIN_AND_ABORT("No reducer is registered as `" + aggregate.at(1) + "`.");
+        }
+
+        return aggregate.at(1);
+    }
+
+    // Returns the window of a rolling aggregate, written as
+    // `["rolling <aggregate>", "<time column>", "<window>"]`, with the
+    // weight column last for `rolling weighted mean`, and appends its time
+    // and weight columns to `dependencies`; or returns -1 for any other
+    // aggregate. The window of a datetime column may end with a unit of
+    // `ms`, `s`, `m`, `h` or `d`, and is otherwise in the column's units.
+    double
+    parse_rolling_window(const std::vector<std::string>& aggregate, const t_schema& schema,
+        std::vector<t_dep>& dependencies) {
+        const std::string& name = aggregate.at(0);
+        if (name.compare(0, 7, "rolling") != 0) {
+            return -1;
+        }
+
+        bool weighted = str_to_aggtype(name) == AGGTYPE_ROLLING_WEIGHTED_MEAN;
+        if (aggregate.size() != (weighted ? 4 : 3)) {
+            PSP_COMPLAIN_AND_ABORT("`" + name + "` requires a time column and a window"
+                + (weighted ? " and a weight column." : "."));
+        }
+
+        const std::string& time = aggregate.at(1);
+        if (!schema.has_column(time)) {
+            PSP_COMPLAIN_AND_ABORT("Unknown time column `" + time + "`.");
+        }
+
+        t_dtype dtype = schema.get_dtype(time);
+        bool is_datetime = dtype == DTYPE_TIME;
+        if (!is_datetime && !is_numeric_type(dtype)) {
+            PSP_COMPLAIN_AND_ABORT(
+                "Rolling time column `" + time + "` must be a datetime or number.");
+        }
+
+        const std::string& spelling = aggregate.at(2);
+        std::size_t end = 0;
+        double window = -1;
+        try {
+            window = std::stod(spelling, &end);
+        } catch (const std::exception&) {
+            end = 0;
+        }
+
+        std::string unit = spelling.substr(end);
+        double scale = 0;
+        if (end == 0) {
+            // not a number
+        } else if (unit.empty()) {
+            scale = 1;
+        } else if (is_datetime && unit == "ms") {
+            scale = 1;
+        } else if (is_datetime && unit == "s") {
+            scale = 1000;
+        } else if (is_datetime && unit == "m") {
+            scale = 60 * 1000;
+        } else if (is_datetime && unit == "h") {
+            scale = 60 * 60 * 1000;
+        } else if (is_datetime && unit == "d") {
+            scale = 24 * 60 * 60 * 1000;
+        }
+
+        if (scale == 0 || !(window > 0)) {
+            PSP_COMPLAIN_AND_ABORT("Invalid rolling window `" + spelling + "`.");
+        }
+
+        dependencies.push_back(t_dep(time, DEPTYPE_COLUMN));
+        if (weighted) {
+            dependencies.push_back(t_dep(aggregate.at(3), DEPTYPE_COLUMN));
+        }
+
+        return window * scale;
+    }
+
+    // Rescales the numeric threshold of a term on a fixed-point column into
+    // the units of the column.
+    void
+    scale_fterm(t_fterm& fterm, const std::map<std::string, std::int32_t>& scales) {
+        auto iter = scales.find(fterm.m_colname);
+        if (iter == scales.end()) {
+            return;
+        }
+
+        t_tscalar& threshold = fterm.m_threshold;
+        if (threshold.is_valid() && threshold.is_numeric()) {
+            threshold.set(std::round(threshold.to_double() * std::pow(10.0, iter->second)));
+        }
+    }
+
+    // Rescales the terms of `fexpr`. Fixed-point columns compare to each
+    // other by their raw values, so only columns of the same scale may be
+    // compared.
+    void
+    scale_fexpr(t_fexpr& fexpr, const std::map<std::string, std::int32_t>& scales) {
+        switch (fexpr.m_type) {
+            case FEXPR_TERM: {
+                scale_fterm(fexpr.m_term, scales);
+            } break;
+            case FEXPR_COLUMNS: {
+                auto lhs = scales.find(fexpr.m_term.m_colname);
+                auto rhs = scales.find(fexpr.m_other_colname);
+                std::int32_t lhs_scale = lhs == scales.end() ? 0 : lhs->second;
+                std::int32_t rhs_scale = rhs == scales.end() ? 0 : rhs->second;
+                if (lhs_scale != rhs_scale) {
+                    PSP_COMPLAIN_AND_ABORT("Cannot compare `" + fexpr.m_term.m_colname
+                        + "` to `" + fexpr.m_other_colname + "`, which have different scales");
+                }
+            } break;
+            case FEXPR_GROUP: {
+                for (t_fexpr& child : fexpr.m_children) {
+                    scale_fexpr(child, scales);
+                }
+            } break;
+        }
+    }
+} // namespace
+
 t_view_config::t_view_config(
         const std::vector<std::string>& row_pivots,
         const std::vector<std::string>& column_pivots,
@@ -50,6 +220,42 @@ t_view_config::add_filter_term(
     m_filter.push_back(term);
 }
 
+void
+t_view_config::scale_filters(const std::map<std::string, std::int32_t>& scales) {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    if (scales.empty()) {
+        return;
+    }
+
+    for (t_fterm& fterm : m_fterm) {
+        scale_fterm(fterm, scales);
+    }
+
+    scale_fexpr(m_fexpr, scales);
+}
+
+void
+t_view_config::set_filter_expr(const t_fexpr& fexpr) {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    m_fexpr = fexpr;
+}
+
+t_fterm
+t_view_config::make_fterm(
+    const std::tuple<std::string, std::string, std::vector<t_tscalar>>& filter) {
+    t_filter_op op = str_to_filter_op(std::get<1>(filter));
+    switch (op) {
+        case FILTER_OP_NOT_IN:
+        case FILTER_OP_IN: {
+            return t_fterm(std::get<0>(filter), op, mktscalar(0), std::get<2>(filter));
+        } break;
+        default: {
+            t_tscalar filter_term = std::get<2>(filter)[0];
+            return t_fterm(std::get<0>(filter), op, filter_term, std::vector<t_tscalar>());
+        }
+    }
+}
+
 void
 t_view_config::set_row_pivot_depth(std::int32_t depth) {
     PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
@@ -92,6 +298,12 @@ t_view_config::get_fterm() const {
     return m_fterm;
 }
 
+const t_fexpr&
+t_view_config::get_filter_expr() const {
+    PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+    return m_fexpr;
+}
+
 std::vector<t_sortspec>
 t_view_config::get_sortspec() const {
     PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
@@ -173,13 +385,21 @@ t_view_config::fill_aggspecs(std::shared_ptr<t_schema> schema) {
 
         std::vector<t_dep> dependencies{t_dep(column, DEPTYPE_COLUMN)};
         t_aggtype agg_type;
+        double quantile = -1;
+        double window = -1;
+        std::string kernel;
 
         if (m_column_only) {
             agg_type = t_aggtype::AGGTYPE_ANY;
         } else {
+            quantile = parse_approx_percentile(aggregate);
+            window = parse_rolling_window(aggregate, *schema, dependencies);
+            kernel = parse_reducer(aggregate);
             if (aggregate.at(0) == "weighted mean") {
                 dependencies.push_back(t_dep(aggregate.at(1), DEPTYPE_COLUMN));
                 agg_type = AGGTYPE_WEIGHTED_MEAN;
+            } else if (quantile >= 0) {
+                agg_type = AGGTYPE_APPROX_PERCENTILE;
             } else {
                 agg_type = str_to_aggtype(aggregate.at(0));
             }
@@ -189,6 +409,12 @@ t_view_config::fill_aggspecs(std::shared_ptr<t_schema> schema) {
             dependencies.push_back(t_dep("psp_pkey", DEPTYPE_COLUMN));
             m_aggspecs.push_back(
                 t_aggspec(column, column, agg_type, dependencies, SORTTYPE_ASCENDING));
+        } else if (agg_type == AGGTYPE_APPROX_PERCENTILE) {
+            m_aggspecs.push_back(t_aggspec(column, agg_type, dependencies, quantile));
+        } else if (window > 0) {
+            m_aggspecs.push_back(t_aggspec(column, agg_type, dependencies, window));
+        } else if (!kernel.empty()) {
+            m_aggspecs.push_back(t_aggspec(column, agg_type, dependencies, kernel));
         } else {
             m_aggspecs.push_back(t_aggspec(column, agg_type, dependencies));
         }
@@ -210,6 +436,9 @@ t_view_config::fill_aggspecs(std::shared_ptr<t_schema> schema) {
 
             std::vector<t_dep> dependencies{t_dep(column, DEPTYPE_COLUMN)};
             t_aggtype agg_type;
+            double quantile = -1;
+            double window = -1;
+            std::string kernel;
 
             if (is_column_only) {
                 // Always sort by `ANY` in column only views
@@ -219,9 +448,14 @@ t_view_config::fill_aggspecs(std::shared_ptr<t_schema> schema) {
                 agg_type = t_aggtype::AGGTYPE_UNIQUE;      
             } else if (m_aggregates.count(column) > 0) {
                 auto col = m_aggregates.at(column);
+                quantile = parse_approx_percentile(col);
+                window = parse_rolling_window(col, *schema, dependencies);
+                kernel = parse_reducer(col);
                 if (col.at(0) == "weighted mean") {
                     dependencies.push_back(t_dep(col.at(1), DEPTYPE_COLUMN));
                     agg_type = AGGTYPE_WEIGHTED_MEAN;
+                } else if (quantile >= 0) {
+                    agg_type = AGGTYPE_APPROX_PERCENTILE;
                 } else {
                     agg_type = str_to_aggtype(col.at(0));
                 }
@@ -230,7 +464,15 @@ t_view_config::fill_aggspecs(std::shared_ptr<t_schema> schema) {
                 agg_type = _get_default_aggregate(dtype);
             }
 
-            m_aggspecs.push_back(t_aggspec(column, agg_type, dependencies));
+            if (agg_type == AGGTYPE_APPROX_PERCENTILE) {
+                m_aggspecs.push_back(t_aggspec(column, agg_type, dependencies, quantile));
+            } else if (window > 0) {
+                m_aggspecs.push_back(t_aggspec(column, agg_type, dependencies, window));
+            } else if (!kernel.empty()) {
+                m_aggspecs.push_back(t_aggspec(column, agg_type, dependencies, kernel));
+            } else {
+                m_aggspecs.push_back(t_aggspec(column, agg_type, dependencies));
+            }
             m_aggregate_names.push_back(column);
         }
     }
@@ -238,20 +480,8 @@ t_view_config::fill_aggspecs(std::shared_ptr<t_schema> schema) {
 
 void
 t_view_config::fill_fterm() {
-    for (auto filter : m_filter) {
-        t_filter_op op = str_to_filter_op(std::get<1>(filter));
-        switch (op) {
-            case FILTER_OP_NOT_IN:
-            case FILTER_OP_IN: {
-                m_fterm.push_back(
-                    t_fterm(std::get<0>(filter), op, mktscalar(0), std::get<2>(filter)));
-            } break;
-            default: {
-                t_tscalar filter_term = std::get<2>(filter)[0];
-                m_fterm.push_back(
-                    t_fterm(std::get<0>(filter), op, filter_term, std::vector<t_tscalar>()));
-            }
-        }
+    for (const auto& filter : m_filter) {
+        m_fterm.push_back(make_fterm(filter));
     }
 }
 
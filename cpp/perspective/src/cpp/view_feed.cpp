@@ -0,0 +1,258 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#include <perspective/first.h>
+#include <perspective/view_feed.h>
+#include <perspective/sparse_tree.h>
+#include <perspective/sym_table.h>
+#include <algorithm>
+#include <limits>
+
+namespace perspective {
+
+// The index of a feed's table with several row pivots, and the separator of
+// the pivots' values in it.
+#define PSP_VIEW_FEED_PATH_COLUMN "__ROW_PATH__"
+#define PSP_VIEW_FEED_PATH_SEPARATOR "|"
+
+namespace {
+
+t_tscalar
+intern(const t_tscalar& s) {
+    if (!s.is_valid()) {
+        return mknone();
+    }
+    return get_interned_tscalar(s);
+}
+
+void
+set_value(t_column& col, t_uindex idx, const t_tscalar& value) {
+    if (value.is_valid()) {
+        col.set_scalar(idx, value);
+    } else {
+        col.clear(idx);
+    }
+}
+
+} // end anonymous namespace
+
+t_view_feed::t_view_feed(std::shared_ptr<View<t_ctx1>> view)
+    : m_view(view)
+    , m_source(view->get_table())
+    , m_ctx(view->get_context())
+    , m_attached(false)
+    , m_listener(0) {
+    m_pivots = m_view->get_row_pivots();
+    if (m_pivots.empty()) {
+        PSP_COMPLAIN_AND_ABORT("Cannot feed a table from a view without row pivots");
+    }
+
+    t_schema schema = m_source->get_schema();
+    t_schema computed_schema = m_source->get_computed_schema(m_view->get_computed_columns());
+    for (const std::string& pivot : m_pivots) {
+        if (schema.has_column(pivot)) {
+            m_pivot_types.push_back(schema.get_dtype(pivot));
+        } else if (computed_schema.has_column(pivot)) {
+            m_pivot_types.push_back(computed_schema.get_dtype(pivot));
+        } else {
+            PSP_COMPLAIN_AND_ABORT("Cannot feed a table from pivot `" + pivot + "`");
+        }
+    }
+
+    m_index = m_pivots.size() == 1 ? m_pivots[0] : PSP_VIEW_FEED_PATH_COLUMN;
+
+    // An aggregate of a pivot column is superseded by the pivot itself.
+    for (t_uindex aggidx = 0, loop_end = m_ctx->get_aggregates().size(); aggidx < loop_end;
+         ++aggidx) {
+        std::string name = m_ctx->get_aggregate_name(aggidx).to_string();
+        if (name == m_index
+            || std::find(m_pivots.begin(), m_pivots.end(), name) != m_pivots.end()) {
+            continue;
+        }
+        m_aggregates.push_back(name);
+        m_aggregate_types.push_back(m_ctx->get_column_dtype(aggidx + 1));
+        m_aggregate_indices.push_back(aggidx);
+    }
+
+    std::vector<std::string> names;
+    std::vector<t_dtype> types;
+    if (m_pivots.size() > 1) {
+        names.push_back(m_index);
+        types.push_back(DTYPE_STR);
+    }
+    names.insert(names.end(), m_pivots.begin(), m_pivots.end());
+    types.insert(types.end(), m_pivot_types.begin(), m_pivot_types.end());
+    names.insert(names.end(), m_aggregates.begin(), m_aggregates.end());
+    types.insert(types.end(), m_aggregate_types.begin(), m_aggregate_types.end());
+
+    m_table = std::make_shared<Table>(std::make_shared<t_pool>(), names, types,
+        std::numeric_limits<std::uint32_t>::max(), m_index);
+
+    auto data = std::make_shared<t_data_table>(t_schema(names, types));
+    data->init();
+    data->clone_column(m_index, "psp_pkey");
+    data->clone_column(m_index, "psp_okey");
+    m_table->init(data, 0, OP_INSERT, 0);
+}
+
+t_view_feed::~t_view_feed() { detach(); }
+
+void
+t_view_feed::init() {
+    std::shared_ptr<t_gnode> gnode = m_source->get_gnode();
+    auto lock = m_source->get_pool()->lock_gnode(gnode->get_id());
+    if (m_attached) {
+        return;
+    }
+
+    // Every group is read, not only those the view has expanded.
+    m_ctx->set_lazy_aggregates(false);
+
+    std::vector<t_uindex> nidxs;
+    std::shared_ptr<t_stree> tree = m_ctx->get_tree();
+    if (tree->size() > 0) {
+        tree->get_drd_indices(0, m_pivots.size(), nidxs);
+    }
+    std::sort(nidxs.begin(), nidxs.end());
+    send_groups(nidxs);
+
+    m_listener = gnode->add_update_listener([this](const t_data_table&) { on_update(); });
+    m_attached = true;
+}
+
+void
+t_view_feed::detach() {
+    std::shared_ptr<t_gnode> gnode = m_source->get_gnode();
+    auto lock = m_source->get_pool()->lock_gnode(gnode->get_id());
+    if (!m_attached) {
+        return;
+    }
+
+    gnode->remove_update_listener(m_listener);
+    m_keys.clear();
+    m_attached = false;
+}
+
+std::shared_ptr<Table>
+t_view_feed::get_table() const {
+    return m_table;
+}
+
+void
+t_view_feed::on_update() {
+    std::shared_ptr<t_stree> tree = m_ctx->get_tree();
+
+    std::vector<t_tscalar> deletes;
+    for (t_uindex nidx : tree->get_dropped()) {
+        auto iter = m_keys.find(nidx);
+        if (iter != m_keys.end()) {
+            deletes.push_back(iter->second);
+            m_keys.erase(iter);
+        }
+    }
+
+    std::vector<t_uindex> nidxs;
+    t_depth depth = m_pivots.size();
+    for (t_uindex nidx : tree->get_updated()) {
+        if (tree->node_exists(nidx) && tree->get_depth(nidx) == depth) {
+            nidxs.push_back(nidx);
+        }
+    }
+    std::sort(nidxs.begin(), nidxs.end());
+
+    send_deletes(deletes);
+    send_groups(nidxs);
+}
+
+void
+t_view_feed::send_groups(const std::vector<t_uindex>& nidxs) {
+    if (nidxs.empty()) {
+        return;
+    }
+
+    t_schema schema = m_table->get_schema().drop({"psp_okey"});
+    auto data = std::make_shared<t_data_table>(schema);
+    data->init();
+    data->extend(nidxs.size());
+
+    std::vector<t_column*> pivot_cols(m_pivots.size());
+    for (t_uindex pidx = 0, loop_end = m_pivots.size(); pidx < loop_end; ++pidx) {
+        pivot_cols[pidx] = data->get_column(m_pivots[pidx]).get();
+    }
+
+    std::vector<t_column*> agg_cols(m_aggregates.size());
+    for (t_uindex aidx = 0, loop_end = m_aggregates.size(); aidx < loop_end; ++aidx) {
+        agg_cols[aidx] = data->get_column(m_aggregates[aidx]).get();
+    }
+
+    t_column* index_col = data->get_column(m_index).get();
+    std::shared_ptr<t_stree> tree = m_ctx->get_tree();
+    std::vector<t_tscalar> path;
+    for (t_uindex idx = 0, loop_end = nidxs.size(); idx < loop_end; ++idx) {
+        t_uindex nidx = nidxs[idx];
+        path.clear();
+        tree->get_path(nidx, path);
+        for (t_uindex pidx = 0, ploop_end = pivot_cols.size(); pidx < ploop_end; ++pidx) {
+            set_value(*pivot_cols[pidx], idx, path[ploop_end - 1 - pidx]);
+        }
+
+        t_tscalar key = get_key(path);
+        if (m_pivots.size() > 1) {
+            index_col->set_scalar(idx, key);
+        }
+        m_keys[nidx] = key;
+
+        for (t_uindex aidx = 0, aloop_end = agg_cols.size(); aidx < aloop_end; ++aidx) {
+            set_value(*agg_cols[aidx], idx, tree->get_aggregate(nidx, m_aggregate_indices[aidx]));
+        }
+    }
+
+    data->clone_column(m_index, "psp_pkey");
+    data->clone_column(m_index, "psp_okey");
+    m_table->init(data, nidxs.size(), OP_INSERT, 0);
+}
+
+void
+t_view_feed::send_deletes(const std::vector<t_tscalar>& keys) {
+    if (keys.empty()) {
+        return;
+    }
+
+    // The index and primary key columns, as `Table::remove_where` sends.
+    auto data = std::make_shared<t_data_table>(
+        t_schema({m_index}, {m_table->get_schema().get_dtype(m_index)}));
+    data->init();
+    data->extend(keys.size());
+    t_column* index_col = data->get_column(m_index).get();
+    for (t_uindex idx = 0, loop_end = keys.size(); idx < loop_end; ++idx) {
+        set_value(*index_col, idx, keys[idx]);
+    }
+
+    data->clone_column(m_index, "psp_pkey");
+    data->clone_column(m_index, "psp_okey");
+    m_table->init(data, keys.size(), OP_DELETE, 0);
+}
+
+t_tscalar
+t_view_feed::get_key(const std::vector<t_tscalar>& path) const {
+    if (m_pivots.size() == 1) {
+        return intern(path[0]);
+    }
+
+    std::string key;
+    for (t_uindex idx = path.size(); idx > 0; --idx) {
+        if (idx < path.size()) {
+            key += PSP_VIEW_FEED_PATH_SEPARATOR;
+        }
+        key += path[idx - 1].to_string();
+    }
+    return get_interned_tscalar(key.c_str());
+}
+
+} // end namespace perspective
@@ -10,17 +10,26 @@
 #include <perspective/first.h>
 #include <perspective/vocab.h>
 #include <tsl/hopscotch_set.h>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <numeric>
 
 namespace perspective {
 
 t_vocab::t_vocab()
-    : m_vlenidx(0) {
+    : m_vlenidx(0)
+    , m_shared(false)
+    , m_ranks_valid(false) {
     m_vlendata.reset(new t_lstore);
     m_extents.reset(new t_lstore);
+    set_alloc_owner();
 }
 
 t_vocab::t_vocab(const t_column_recipe& r)
-    : m_vlenidx(r.m_vlenidx) {
+    : m_vlenidx(r.m_vlenidx)
+    , m_shared(false)
+    , m_ranks_valid(false) {
     if (is_vlen_dtype(r.m_dtype)) {
         m_vlendata.reset(new t_lstore(r.m_vlendata));
         m_extents.reset(new t_lstore(r.m_extents));
@@ -28,12 +37,22 @@ t_vocab::t_vocab(const t_column_recipe& r)
         m_vlendata.reset(new t_lstore);
         m_extents.reset(new t_lstore);
     }
+    set_alloc_owner();
 }
 
 t_vocab::t_vocab(const t_lstore_recipe& vlendata_recipe, const t_lstore_recipe& extents_recipe)
-    : m_vlenidx(0) {
+    : m_vlenidx(0)
+    , m_shared(false)
+    , m_ranks_valid(false) {
     m_vlendata.reset(new t_lstore(vlendata_recipe));
     m_extents.reset(new t_lstore(extents_recipe));
+    set_alloc_owner();
+}
+
+void
+t_vocab::set_alloc_owner() {
+    m_vlendata->set_alloc_owner(ALLOC_OWNER_VOCAB);
+    m_extents->set_alloc_owner(ALLOC_OWNER_VOCAB);
 }
 
 void
@@ -52,6 +71,29 @@ t_vocab::reserve(size_t total_string_size, size_t string_count) {
     rebuild_map();
 }
 
+void
+t_vocab::reserve_additional(size_t string_size, size_t string_count) {
+    // `push_back` grows a store that would be filled exactly.
+    t_uindex vlendata_size = m_vlendata->size() + string_size + 1;
+    t_uindex extents_size
+        = m_extents->size() + sizeof(std::pair<t_uindex, t_uindex>) * string_count + 1;
+
+    const t_lstore& vlendata = *m_vlendata;
+    const void* obase = vlendata.get_nth<const char>(0);
+    if (vlendata_size > m_vlendata->capacity()) {
+        m_vlendata->reserve(vlendata_size);
+    }
+    if (extents_size > m_extents->capacity()) {
+        m_extents->reserve(extents_size);
+    }
+
+    // The map is keyed by the strings' addresses.
+    if (vlendata.get_nth<const char>(0) != obase) {
+        rebuild_map();
+    }
+    m_map.reserve(m_map.size() + string_count);
+}
+
 bool
 t_vocab::string_exists(const char* c, t_uindex& interned) const {
     auto iter = m_map.find(c);
@@ -76,11 +118,16 @@ t_vocab::get_interned(const char* s) {
 
     if (iter == m_map.end()) {
         idx = genidx();
+        m_ranks_valid = false;
 
         bidx = m_vlendata->size();
         eidx = bidx + len;
-        const void* obase = m_vlendata->get_nth<const char>(0);
-        const void* oebase = m_extents->get_nth<std::pair<t_uindex, t_uindex>>(0);
+        // Read through the const stores, so that a store shared with a
+        // snapshot is seen to move when `push_back` copies it.
+        const t_lstore& vlendata = *m_vlendata;
+        const t_lstore& extents = *m_extents;
+        const void* obase = vlendata.get_nth<const char>(0);
+        const void* oebase = extents.get_nth<std::pair<t_uindex, t_uindex>>(0);
         m_vlendata->push_back(static_cast<const void*>(s), len);
         m_extents->push_back(std::pair<t_uindex, t_uindex>(bidx, eidx));
         const void* nbase = m_vlendata->get_nth<const char>(0);
@@ -99,6 +146,8 @@ t_vocab::get_interned(const char* s) {
 
 t_uindex
 t_vocab::genidx() {
+    PSP_VERBOSE_ASSERT(m_vlenidx < std::numeric_limits<t_stridx>::max(),
+        "Vocabulary has more strings than string column ids can address");
     return m_vlenidx++;
 }
 
@@ -153,6 +202,7 @@ t_vocab::nbytes() const {
     t_uindex rv = 0;
     rv += m_vlendata->capacity();
     rv += m_extents->capacity();
+    rv += (m_ranks.capacity() + m_sorted_ids.capacity()) * sizeof(std::uint32_t);
     return rv;
 }
 
@@ -161,16 +211,80 @@ t_vocab::fill(const t_lstore& o_vlen, const t_lstore& o_extents, t_uindex vlenid
     m_vlendata->fill(o_vlen);
     m_extents->fill(o_extents);
     m_vlenidx = vlenidx;
+    m_ranks_valid = false;
 }
 
 void
 t_vocab::copy_vocabulary(const t_vocab& other) {
+    // fill into the existing stores so a recycled column keeps its storage
     m_vlenidx = other.m_vlenidx;
-    m_vlendata = other.m_vlendata->clone();
-    m_extents = other.m_extents->clone();
+    m_vlendata->fill(*(other.m_vlendata));
+    m_extents->fill(*(other.m_extents));
+    m_ranks_valid = false;
+    rebuild_map();
+}
+
+void
+t_vocab::compact(const std::vector<bool>& live, std::vector<t_uindex>& remap) {
+    PSP_VERBOSE_ASSERT(live.size() == m_vlenidx, "Mismatched liveness size");
+    remap.assign(m_vlenidx, 0);
+
+    t_extent_pair* extents = get_extents_base();
+    unsigned char* base = get_vlen_base();
+
+    // Strings are stored in id order, so each live string only ever moves
+    // towards the start of the store.
+    t_uindex nidx = 0;
+    t_uindex offset = 0;
+
+    for (t_uindex idx = 0; idx < m_vlenidx; ++idx) {
+        if (!live[idx]) {
+            continue;
+        }
+
+        t_uindex bidx = extents[idx].m_begin;
+        t_uindex len = extents[idx].m_end - bidx;
+        PSP_VERBOSE_ASSERT(bidx >= offset, "Vocabulary out of order");
+
+        if (bidx != offset) {
+            memmove(base + offset, base + bidx, size_t(len));
+        }
+
+        extents[nidx].m_begin = offset;
+        extents[nidx].m_end = offset + len;
+        remap[idx] = nidx;
+        ++nidx;
+        offset += len;
+    }
+
+    m_vlenidx = nidx;
+    m_vlendata->set_size(offset);
+    m_extents->set_size(nidx * sizeof(t_extent_pair));
+    m_vlendata->shrink(offset);
+    m_extents->shrink(nidx * sizeof(t_extent_pair));
+    m_ranks_valid = false;
     rebuild_map();
 }
 
+void
+t_vocab::clear() {
+    m_vlendata->set_size(0);
+    m_extents->set_size(0);
+    m_vlenidx = 0;
+    m_map.clear();
+    m_ranks_valid = false;
+}
+
+void
+t_vocab::set_shared(bool shared) {
+    m_shared = shared;
+}
+
+bool
+t_vocab::is_shared() const {
+    return m_shared;
+}
+
 void
 t_vocab::pprint_vocabulary() const {
     std::cout << "vocabulary =========\n";
@@ -183,9 +297,13 @@ t_vocab::pprint_vocabulary() const {
 
 const char*
 t_vocab::unintern_c(t_uindex idx) const {
+    // Read through the const stores, so that a store shared with a
+    // snapshot is not copied by reads.
+    const t_lstore& vlendata = *m_vlendata;
+    const t_lstore& extents = *m_extents;
     const std::pair<t_uindex, t_uindex>* p
-        = m_extents->get_nth<std::pair<t_uindex, t_uindex>>(idx);
-    const char* rv = static_cast<const char*>(m_vlendata->get_ptr(p->first));
+        = extents.get_nth<std::pair<t_uindex, t_uindex>>(idx);
+    const char* rv = static_cast<const char*>(vlendata.get_ptr(p->first));
     return rv;
 }
 
@@ -194,12 +312,59 @@ t_vocab::clone(const t_vocab& v) {
     m_vlendata->fill(*(v.m_vlendata));
     m_extents->fill(*(v.m_extents));
     m_vlenidx = v.m_vlenidx;
+    m_ranks_valid = false;
     rebuild_map();
 }
 
+std::shared_ptr<t_vocab>
+t_vocab::snapshot() {
+    auto rval = std::make_shared<t_vocab>();
+    rval->m_vlendata = m_vlendata->snapshot();
+    rval->m_extents = m_extents->snapshot();
+    rval->m_vlenidx = m_vlenidx;
+    return rval;
+}
+
 void
 t_vocab::set_vlenidx(t_uindex idx) {
     m_vlenidx = idx;
+    m_ranks_valid = false;
+}
+
+const std::vector<std::uint32_t>&
+t_vocab::get_ranks() const {
+    update_ranks();
+    return m_ranks;
+}
+
+const std::vector<std::uint32_t>&
+t_vocab::get_sorted_ids() const {
+    update_ranks();
+    return m_sorted_ids;
+}
+
+void
+t_vocab::update_ranks() const {
+    std::lock_guard<std::mutex> lock(m_ranks_mtx);
+    if (m_ranks_valid) {
+        return;
+    }
+
+    std::vector<const char*> strs(m_vlenidx);
+    for (t_uindex idx = 0; idx < m_vlenidx; ++idx) {
+        strs[idx] = unintern_c(idx);
+    }
+
+    m_sorted_ids.resize(m_vlenidx);
+    std::iota(m_sorted_ids.begin(), m_sorted_ids.end(), 0);
+    std::sort(m_sorted_ids.begin(), m_sorted_ids.end(),
+        [&strs](std::uint32_t a, std::uint32_t b) { return std::strcmp(strs[a], strs[b]) < 0; });
+
+    m_ranks.resize(m_vlenidx);
+    for (t_uindex pos = 0; pos < m_vlenidx; ++pos) {
+        m_ranks[m_sorted_ids[pos]] = pos;
+    }
+    m_ranks_valid = true;
 }
 
 t_extent_pair*
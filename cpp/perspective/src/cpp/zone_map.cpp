@@ -0,0 +1,115 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#include <perspective/first.h>
+#include <perspective/zone_map.h>
+#include <cmath>
+#include <limits>
+
+// Rows summarized by each minimum and maximum of a zone map.
+#define PSP_ZONE_MAP_BLOCK_SIZE 1024
+
+namespace perspective {
+
+t_zone_map::t_zone_map() {}
+
+bool
+t_zone_map::is_supported(const t_fterm& fterm, t_dtype dtype) {
+    if (fterm.m_negated || dtype == DTYPE_BOOL
+        || !(is_numeric_type(dtype) || dtype == DTYPE_DATE || dtype == DTYPE_TIME)) {
+        return false;
+    }
+
+    switch (fterm.m_op) {
+        case FILTER_OP_LT:
+        case FILTER_OP_LTEQ:
+        case FILTER_OP_GT:
+        case FILTER_OP_GTEQ:
+        case FILTER_OP_EQ: break;
+        default: return false;
+    }
+
+    // Thresholds of another dtype are not compared by value.
+    const t_tscalar& threshold = fterm.m_threshold;
+    return threshold.is_valid() && threshold.get_dtype() == dtype
+        && !std::isnan(threshold.to_double());
+}
+
+void
+t_zone_map::build(const t_column& column, t_uindex nrows) {
+    m_min.clear();
+    m_max.clear();
+    for (t_uindex ridx = 0; ridx < nrows; ++ridx) {
+        add(column, ridx);
+    }
+}
+
+void
+t_zone_map::add(const t_column& column, t_uindex ridx) {
+    if (!column.is_valid(ridx)) {
+        return;
+    }
+
+    double value = column.get_scalar(ridx).to_double();
+    if (!std::isnan(value)) {
+        add_value(ridx, value);
+    }
+}
+
+void
+t_zone_map::add_value(t_uindex ridx, double value) {
+    t_uindex block = ridx / PSP_ZONE_MAP_BLOCK_SIZE;
+    if (block >= m_min.size()) {
+        m_min.resize(block + 1, std::numeric_limits<double>::infinity());
+        m_max.resize(block + 1, -std::numeric_limits<double>::infinity());
+    }
+
+    m_min[block] = std::min(m_min[block], value);
+    m_max[block] = std::max(m_max[block], value);
+}
+
+void
+t_zone_map::get_rows(const t_fterm& fterm, t_mask& mask) const {
+    // Values are compared as doubles, which may round them together, so a
+    // block is only skipped if it cannot match inclusively.
+    double threshold = fterm.m_threshold.to_double();
+    t_uindex nrows = mask.size();
+    for (t_uindex block = 0, loop_end = m_min.size(); block < loop_end; ++block) {
+        bool may_match;
+        switch (fterm.m_op) {
+            case FILTER_OP_LT:
+            case FILTER_OP_LTEQ: {
+                may_match = m_min[block] <= threshold;
+            } break;
+            case FILTER_OP_GT:
+            case FILTER_OP_GTEQ: {
+                may_match = m_max[block] >= threshold;
+            } break;
+            default: {
+                may_match = m_min[block] <= threshold && threshold <= m_max[block];
+            } break;
+        }
+
+        if (!may_match) {
+            continue;
+        }
+
+        t_uindex end = std::min(nrows, (block + 1) * PSP_ZONE_MAP_BLOCK_SIZE);
+        for (t_uindex ridx = block * PSP_ZONE_MAP_BLOCK_SIZE; ridx < end; ++ridx) {
+            mask.set(ridx, true);
+        }
+    }
+}
+
+t_uindex
+t_zone_map::nbytes() const {
+    return (m_min.capacity() + m_max.capacity()) * sizeof(double);
+}
+
+} // end namespace perspective
@@ -48,6 +48,12 @@ public:
         t_uindex agg_one_idx, t_uindex agg_two_idx, double agg_one_weight,
         double agg_two_weight);
 
+    t_aggspec(const std::string& aggname, t_aggtype agg, const std::vector<t_dep>& dependencies,
+        double param);
+
+    t_aggspec(const std::string& aggname, t_aggtype agg, const std::vector<t_dep>& dependencies,
+        const std::string& kernel);
+
     std::string name() const;
     t_tscalar name_scalar() const;
     std::string disp_name() const;
@@ -62,6 +68,18 @@ public:
     double get_agg_one_weight() const;
     double get_agg_two_weight() const;
 
+    // The quantile in `[0, 1]` estimated by an `APPROX_PERCENTILE`
+    // aggregate.
+    double get_quantile() const;
+
+    // The length of the window of a rolling aggregate, in the units of its
+    // time column.
+    double get_window() const;
+
+    // The name of the `t_kernel_evaluator` reducer of a `UDF_REDUCER`
+    // aggregate.
+    const std::string& get_kernel() const;
+
     t_invmode get_inv_mode() const;
 
     std::vector<std::string> get_input_depnames() const;
@@ -75,6 +93,37 @@ public:
 
     bool is_non_delta() const;
 
+    // Aggregates maintained from running numerator/denominator columns
+    // carried through the strand delta table, rather than rereading the
+    // leaf rows of every updated node.
+    bool is_running_agg() const;
+    std::string get_running_nr_name() const;
+    std::string get_running_dr_name() const;
+
+    // Aggregates maintained from a multiset of the values under each node,
+    // fed by the added/removed values carried through the strand delta
+    // table.
+    bool is_multiset_agg() const;
+    std::string get_multiset_add_name() const;
+    std::string get_multiset_sub_name() const;
+    std::string get_multiset_op_name() const;
+
+    // Aggregates maintained from a `t_hll_sketch` or `t_tdigest` of the
+    // values under each node, fed by the same strand delta columns as the
+    // multiset aggregates.
+    bool is_sketch_agg() const;
+
+    // Aggregates maintained from the partial sums of the values under each
+    // node over a trailing window of a time column, their second dependency,
+    // fed by a time, numerator and denominator added and removed per strand.
+    bool is_rolling_agg() const;
+    std::string get_rolling_name(const std::string& field) const;
+
+    // Aggregates recomputed from the leaf rows of every updated node, read
+    // back from the master table, so their cost grows with the number of
+    // rows under each node.
+    bool is_leaf_scan_agg() const;
+
     std::string get_first_depname() const;
 
 private:
@@ -88,8 +137,10 @@ private:
     t_uindex m_agg_two_idx;
     double m_agg_one_weight;
     double m_agg_two_weight;
+    // The quantile or window of the aggregates which take one.
+    double m_param;
     t_invmode m_invmode;
-    // t_uindex m_kernel;
+    std::string m_kernel;
 };
 
 PERSPECTIVE_EXPORT t_dtype get_simple_accumulator_type(t_dtype coltype);
@@ -0,0 +1,105 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2017, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#pragma once
+#include <perspective/first.h>
+#include <perspective/raw_types.h>
+#include <perspective/exports.h>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace perspective {
+
+/**
+ * @brief What a `t_lstore`'s memory belongs to, which its allocations are
+ * counted under. Stores take the owner of the `t_data_table` that makes
+ * their column, of the recipe they are made from, or of the store they are
+ * cloned from.
+ */
+enum t_alloc_owner {
+    ALLOC_OWNER_OTHER,
+    ALLOC_OWNER_MASTER_TABLE,
+    ALLOC_OWNER_INPUT_PORT,
+    ALLOC_OWNER_TRANSITIONAL,
+    ALLOC_OWNER_AGGREGATE,
+    ALLOC_OWNER_VOCAB,
+    ALLOC_OWNER_NUM_OWNERS
+};
+
+/**
+ * @brief The `t_lstore` operation that allocated, resized or freed memory.
+ * `ALLOC_OP_EXTEND` is growth by `extend` or `push_back`, and
+ * `ALLOC_OP_RESERVE` growth by an explicit `reserve`.
+ */
+enum t_alloc_op {
+    ALLOC_OP_INIT,
+    ALLOC_OP_RESERVE,
+    ALLOC_OP_EXTEND,
+    ALLOC_OP_SHRINK,
+    ALLOC_OP_CLONE,
+    ALLOC_OP_FREE,
+    ALLOC_OP_NUM_OPS
+};
+
+/**
+ * @brief Counts the allocations of every `t_lstore` by owner: the number of
+ * each operation, the bytes allocated and freed, and the bytes live and
+ * their high-water mark.
+ *
+ * Counting is off unless `PSP_ALLOC_STATS` is set or `set_enabled` is
+ * called, and an allocation costs one relaxed atomic load while it is off.
+ * Only changes made while counting are seen, so live bytes are relative to
+ * when counting was enabled or last `reset`.
+ */
+class PERSPECTIVE_EXPORT t_alloc_stats {
+public:
+    static inline bool
+    is_enabled() {
+        return ENABLED.load(std::memory_order_relaxed);
+    }
+
+    static void set_enabled(bool enabled);
+
+    /**
+     * @brief Count `op` on a store of `owner`, which changed its capacity
+     * by `delta` bytes. Operations that do not change the capacity, such
+     * as a clone's copy into an allocation it already made, pass 0.
+     *
+     * @param owner
+     * @param op
+     * @param delta
+     */
+    static void record(t_alloc_owner owner, t_alloc_op op, std::int64_t delta);
+
+    /**
+     * @brief Move `bytes` of live memory from `from` to `to`, when a store
+     * changes owner.
+     */
+    static void transfer(t_alloc_owner from, t_alloc_owner to, std::int64_t bytes);
+
+    /**
+     * @brief Returns the counters of every owner, keyed
+     * `"<owner>.<counter>"`, e.g. `"aggregate.extend"` or
+     * `"master_table.high_water_bytes"`.
+     */
+    static std::map<std::string, double> get_stats();
+
+    /**
+     * @brief Zero every counter, so that live bytes and high-water marks
+     * are measured from now.
+     */
+    static void reset();
+
+private:
+    static std::atomic<bool> ENABLED;
+};
+
+} // end namespace perspective
@@ -0,0 +1,187 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#pragma once
+#include <perspective/first.h>
+#include <perspective/base.h>
+#include <perspective/raw_types.h>
+#include <perspective/exports.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace perspective {
+
+/**
+ * @brief The heap behind the memory of `BACKING_STORE_MEMORY` `t_lstore`s,
+ * which hold the columns of master, input and transitional tables,
+ * vocabularies and aggregate tables. A store allocates from the
+ * `current` allocator when it is initialized, and keeps it for its
+ * lifetime, so every resize and free goes back to the allocator it came
+ * from.
+ *
+ * The default is chosen at startup by `PSP_ALLOCATOR`: `system` (the
+ * default) allocates with `malloc`, so that a preloaded allocator such as
+ * mimalloc or jemalloc is used, and `arena` gives each gnode an arena of
+ * its own. An allocator of the user's can be installed with `set_default`
+ * before any table is made.
+ */
+class PERSPECTIVE_EXPORT t_allocator {
+public:
+    virtual ~t_allocator();
+
+    /**
+     * @brief Allocate `nbytes` aligned to `alignment`, a power of two or 0
+     * for the heap's alignment, zeroed if `zero` is set. Returns nullptr if
+     * the allocation failed.
+     */
+    virtual void* allocate(t_uindex nbytes, t_uindex alignment, bool zero) = 0;
+
+    /**
+     * @brief Free `ptr`, an allocation of `nbytes` aligned to `alignment`.
+     */
+    virtual void deallocate(void* ptr, t_uindex nbytes, t_uindex alignment) = 0;
+
+    /**
+     * @brief Resize `ptr` from `nbytes` to `new_nbytes`, keeping the bytes
+     * both sizes hold, and returning the new allocation. Allocates, copies
+     * and frees unless overridden.
+     */
+    virtual void* reallocate(void* ptr, t_uindex nbytes, t_uindex new_nbytes, t_uindex alignment);
+
+    /**
+     * @brief Returns the bytes an allocation of `nbytes` really takes, so
+     * that a store can use all of them.
+     */
+    virtual t_uindex good_size(t_uindex nbytes) const;
+
+    /**
+     * @brief Returns the bytes the allocator holds from the system, live or
+     * free, or 0 if it does not know.
+     */
+    virtual t_uindex reserved_nbytes() const;
+
+    virtual std::string name() const = 0;
+
+    /**
+     * @brief Returns the allocator of `name`, `system` or `arena`, aborting
+     * for any other name.
+     */
+    static std::shared_ptr<t_allocator> make(const std::string& name);
+
+    /**
+     * @brief The allocator gnodes allocate from if they are not each given
+     * an arena.
+     */
+    static std::shared_ptr<t_allocator> get_default();
+
+    /**
+     * @brief Allocate from `allocator` from now on, which stops gnodes
+     * being given arenas of their own. Stores already allocated keep their
+     * allocators.
+     */
+    static void set_default(std::shared_ptr<t_allocator> allocator);
+
+    /**
+     * @brief Returns the allocator for a new gnode: an arena of its own if
+     * `PSP_ALLOCATOR` is `arena` and no default was set, so that dropping
+     * the gnode's table releases its memory at once, or the default.
+     */
+    static std::shared_ptr<t_allocator> for_gnode();
+
+    /**
+     * @brief Returns the allocator of the innermost `t_allocator_scope` on
+     * this thread, or the default.
+     */
+    static std::shared_ptr<t_allocator> current();
+};
+
+/**
+ * @brief Allocates with `malloc`, `calloc`, `realloc` and `posix_memalign`.
+ */
+class PERSPECTIVE_EXPORT t_system_allocator : public t_allocator {
+public:
+    void* allocate(t_uindex nbytes, t_uindex alignment, bool zero) override;
+    void deallocate(void* ptr, t_uindex nbytes, t_uindex alignment) override;
+    void* reallocate(
+        void* ptr, t_uindex nbytes, t_uindex new_nbytes, t_uindex alignment) override;
+    std::string name() const override;
+};
+
+/**
+ * @brief Serves allocations of up to half a chunk from chunks of
+ * the system's, each holding blocks of one power of two size, and larger
+ * ones from the system. As a gnode's stores grow geometrically they move
+ * between size classes of its own arena instead of fragmenting the heap
+ * shared with other tables, a chunk is returned to the system once none
+ * of its blocks are live, and every chunk is freed when the arena is.
+ */
+class PERSPECTIVE_EXPORT t_arena_allocator : public t_allocator {
+public:
+    /**
+     * @brief Construct an arena of chunks of `PSP_ARENA_CHUNK_SIZE` bytes,
+     * or of `chunk_nbytes`, a power of two.
+     */
+    t_arena_allocator();
+    explicit t_arena_allocator(t_uindex chunk_nbytes);
+    ~t_arena_allocator();
+    PSP_NON_COPYABLE(t_arena_allocator);
+
+    void* allocate(t_uindex nbytes, t_uindex alignment, bool zero) override;
+    void deallocate(void* ptr, t_uindex nbytes, t_uindex alignment) override;
+    void* reallocate(
+        void* ptr, t_uindex nbytes, t_uindex new_nbytes, t_uindex alignment) override;
+    t_uindex good_size(t_uindex nbytes) const override;
+    t_uindex reserved_nbytes() const override;
+    std::string name() const override;
+
+    static const t_uindex MIN_BLOCK_NBYTES;
+
+private:
+    struct t_chunk {
+        unsigned char* m_base;
+        t_uindex m_block_nbytes;
+        t_uindex m_nblocks;
+        // Blocks carved from the chunk so far, those of them live, and the
+        // freed ones, linked through their first bytes.
+        t_uindex m_carved;
+        t_uindex m_live;
+        void* m_free;
+    };
+
+    // Whether an allocation of `nbytes` aligned to `alignment` is served
+    // from a chunk.
+    bool is_small(t_uindex nbytes, t_uindex alignment) const;
+    t_uindex size_class(t_uindex nbytes) const;
+    t_chunk* find_chunk(void* ptr);
+
+    t_uindex m_chunk_nbytes;
+    t_system_allocator m_system;
+    mutable std::mutex m_mtx;
+    std::unordered_map<std::uintptr_t, t_chunk> m_chunks;
+    // Per size class, the chunks with a free block.
+    std::vector<std::vector<std::uintptr_t>> m_partial;
+    t_uindex m_large_nbytes;
+};
+
+/**
+ * @brief Makes `allocator` the `t_allocator::current` allocator of this
+ * thread for the scope's lifetime.
+ */
+struct PERSPECTIVE_EXPORT t_allocator_scope {
+    explicit t_allocator_scope(std::shared_ptr<t_allocator> allocator);
+    ~t_allocator_scope();
+    PSP_NON_COPYABLE(t_allocator_scope);
+
+    std::shared_ptr<t_allocator> m_prev;
+};
+
+} // end namespace perspective
@@ -19,6 +19,10 @@
 #include <arrow/io/memory.h>
 #include <arrow/ipc/reader.h>
 
+#ifdef PSP_ENABLE_PARQUET
+#include <parquet/arrow/reader.h>
+#endif
+
 #include <chrono>
 #include <date/date.h>
 
@@ -30,7 +34,36 @@ namespace arrow {
         ArrowLoader();
         ~ArrowLoader();
 
-        void initialize(uintptr_t ptr, std::uint32_t);
+        /**
+         * @brief Read an Arrow IPC file or stream, or a Parquet file if
+         * `ptr` starts with the Parquet magic bytes.
+         *
+         * Columns filled from the file may borrow its memory rather than
+         * copy it, so the file must outlive them: if `owned`, `ptr` was
+         * allocated with `malloc` and is freed once nothing reads it,
+         * otherwise the caller keeps it alive.
+         *
+         * @param ptr
+         * @param length
+         * @param owned
+         */
+        void initialize(uintptr_t ptr, std::uint32_t length, bool owned = false);
+
+#ifdef PSP_ENABLE_PARQUET
+        /**
+         * @brief Read the `columns` of a Parquet file, or every column if
+         * `columns` is empty. Names that are not in the file are ignored.
+         * Row groups are read in parallel, each by its own reader over the
+         * same buffer, and then concatenated.
+         *
+         * @param ptr
+         * @param length
+         * @param columns
+         * @param owned as for `initialize`.
+         */
+        void initialize_parquet(uintptr_t ptr, std::uint32_t length,
+            const std::vector<std::string>& columns, bool owned = false);
+#endif
 
         void fill_table(
             t_data_table& tbl,
@@ -43,6 +76,21 @@ namespace arrow {
         std::vector<t_dtype> types() const;
         std::uint32_t row_count() const;
 
+        /**
+         * @brief The scale of each decimal column, whose values are loaded
+         * into int64 columns as integers of `10^-scale`.
+         */
+        const std::map<std::string, std::int32_t>& scales() const;
+
+        /**
+         * @brief Rescale the decimal columns in `scales` to their scale
+         * there, e.g. the scales of the table being updated, rather than
+         * the scale of the file.
+         *
+         * @param scales
+         */
+        void set_scales(const std::map<std::string, std::int32_t>& scales);
+
     private:
         void fill_column(
             t_data_table& tbl, 
@@ -53,11 +101,27 @@ namespace arrow {
             std::string& raw_type,
             bool is_update);
 
+        /**
+         * @brief Set `m_names` and `m_types` from the schema of `m_table`.
+         */
+        void init_schema();
+
         std::shared_ptr<::arrow::Table> m_table;
         std::vector<std::string> m_names;
         std::vector<t_dtype> m_types;
+        std::map<std::string, std::int32_t> m_scales;
+        std::map<std::string, std::int32_t> m_target_scales;
     };
 
+    /**
+     * @brief Whether the buffer at `ptr` starts with the Parquet magic bytes.
+     *
+     * @param ptr
+     * @param length
+     * @return bool
+     */
+    PERSPECTIVE_EXPORT bool is_parquet(uintptr_t ptr, std::uint32_t length);
+
     template <typename T, typename V>
     void
     iter_col_copy(
@@ -66,6 +130,19 @@ namespace arrow {
         const int64_t offset,
         const int64_t len);
 
+    /**
+     * @brief Write the vocabulary ids of the dictionary indices in `src`,
+     * where `ids` holds the id that each dictionary entry was interned at.
+     */
+    template <typename T>
+    void
+    remap_dictionary_indices(
+        std::shared_ptr<t_column> dest,
+        std::shared_ptr<::arrow::Array> src,
+        const std::vector<t_stridx>& ids,
+        const int64_t offset,
+        const int64_t len);
+
     void
     copy_array(
         std::shared_ptr<t_column> dest,
@@ -73,5 +150,19 @@ namespace arrow {
         const int64_t offset,
         const int64_t len);
 
+    /**
+     * @brief Write the decimals in `src`, of `scale`, into the int64 column
+     * `dest` as integers of `10^-target_scale`, aborting if a value does not
+     * fit or would lose digits.
+     */
+    void
+    copy_decimal_array(
+        std::shared_ptr<t_column> dest,
+        std::shared_ptr<::arrow::Array> src,
+        const int64_t offset,
+        const int64_t len,
+        std::int32_t scale,
+        std::int32_t target_scale);
+
 } // namespace arrow
 } // namespace perspective
\ No newline at end of file
@@ -15,12 +15,14 @@
 #include <perspective/scalar.h>
 #include <perspective/data_table.h>
 #include <perspective/get_data_extents.h>
+#include <perspective/slice_column.h>
 
 #include <arrow/api.h>
 #include <arrow/util/decimal.h>
 #include <arrow/io/memory.h>
 #include <arrow/ipc/reader.h>
 #include <arrow/ipc/writer.h>
+#include <arrow/util/compression.h>
 
 #include <chrono>
 #include <date/date.h>
@@ -28,6 +30,82 @@
 namespace perspective {
 namespace arrow {
 
+    /**
+     * @brief The magic bytes that start an Arrow IPC buffer compressed by
+     * `compress_arrow`. They are followed by the compression as a single
+     * byte, the uncompressed length as a little-endian `int64`, and the
+     * compressed buffer.
+     */
+    static const char PSP_ARROW_COMPRESSED_MAGIC[] = "PSPZ";
+    static const std::size_t PSP_ARROW_COMPRESSED_HEADER_SIZE = 13;
+
+    enum t_arrow_compression {
+        ARROW_COMPRESSION_NONE = 0,
+        ARROW_COMPRESSION_LZ4 = 1,
+        ARROW_COMPRESSION_ZSTD = 2
+    };
+
+    /**
+     * @brief Returns the compression named `name`, which is one of "lz4",
+     * "zstd" or "" for none.
+     *
+     * @param name
+     * @return t_arrow_compression
+     */
+    PERSPECTIVE_EXPORT t_arrow_compression str_to_arrow_compression(const std::string& name);
+
+    /**
+     * @brief Whether `compression` is available in this build, as Arrow
+     * only provides the codecs it was built with.
+     *
+     * @param compression
+     * @return bool
+     */
+    PERSPECTIVE_EXPORT bool is_arrow_compression_available(t_arrow_compression compression);
+
+    /**
+     * @brief Compress a whole serialized Arrow IPC buffer. Arrow 0.15 does
+     * not compress IPC bodies itself, so the result is framed with
+     * `PSP_ARROW_COMPRESSED_MAGIC` and can only be read by `ArrowLoader` or
+     * by `decompress_arrow`. `ARROW_COMPRESSION_NONE` returns a copy of
+     * `arrow`.
+     *
+     * @param arrow
+     * @param compression
+     * @return std::shared_ptr<std::string>
+     */
+    PERSPECTIVE_EXPORT std::shared_ptr<std::string> compress_arrow(
+        const std::string& arrow, t_arrow_compression compression);
+
+    /**
+     * @brief Whether the buffer at `ptr` was framed by `compress_arrow`.
+     *
+     * @param ptr
+     * @param length
+     * @return bool
+     */
+    PERSPECTIVE_EXPORT bool is_compressed_arrow(const std::uint8_t* ptr, std::uint64_t length);
+
+    /**
+     * @brief Decompress a buffer framed by `compress_arrow` into a buffer
+     * owned by Arrow, which arrays read from it keep alive.
+     *
+     * @param ptr
+     * @param length
+     * @return std::shared_ptr<::arrow::Buffer>
+     */
+    PERSPECTIVE_EXPORT std::shared_ptr<::arrow::Buffer> decompress_arrow(
+        const std::uint8_t* ptr, std::uint64_t length);
+
+    /**
+     * @brief The Arrow type a column of `dtype` is serialized as, which is a
+     * dictionary of `int32` ids for strings.
+     *
+     * @param dtype
+     * @return std::shared_ptr<::arrow::DataType>
+     */
+    PERSPECTIVE_EXPORT std::shared_ptr<::arrow::DataType> dtype_to_arrow_type(t_dtype dtype);
+
     /**
      * @brief Return a value from a `t_scalar` cast to `T`.
      * 
@@ -120,6 +198,35 @@ namespace arrow {
         std::int32_t stride,
         t_get_data_extents extents);
 
+    /**
+     * @brief Build an `arrow::DictionaryArray` for a string column from the
+     * vocabulary ids of its cells, with -1 for nulls, and the column's
+     * `vocab`, without reading or hashing the string of each cell. When
+     * there are fewer cells than strings in `vocab`, the dictionary is pruned
+     * to the strings the cells use. The dictionary is sorted, in the order
+     * of `t_vocab::get_ranks`, so that its indices compare as its strings
+     * do.
+     *
+     * @param ids
+     * @param vocab
+     * @return std::shared_ptr<::arrow::Array>
+     */
+    std::shared_ptr<::arrow::Array>
+    vocab_to_dictionary_array(
+        const std::vector<std::int32_t>& ids,
+        const t_vocab& vocab);
+
+    /**
+     * @brief Build an `arrow::Array` from a `t_slice_column`, appending its
+     * values and validity as buffers rather than a cell at a time; string
+     * columns are built by `vocab_to_dictionary_array`.
+     *
+     * @param col
+     * @return std::shared_ptr<::arrow::Array>
+     */
+    std::shared_ptr<::arrow::Array>
+    slice_column_to_array(const t_slice_column& col);
+
     /**
      * @brief Build an `arrow::Array` from a column contained in `data`. Column
      * building methods read from the vector of scalars that make up the data
@@ -178,6 +178,21 @@ enum t_select_mode {
 
 enum t_backing_store { BACKING_STORE_MEMORY, BACKING_STORE_DISK };
 
+// How the heap allocations of a `BACKING_STORE_MEMORY` store at least
+// `PSP_HUGE_PAGE_SIZE` bytes are backed. Huge pages are only available on
+// Linux; elsewhere every policy allocates from the heap.
+enum t_page_policy : std::uint8_t {
+    PAGE_POLICY_DEFAULT,
+    // Aligned to huge pages, and advised to be backed by transparent huge
+    // pages
+    PAGE_POLICY_TRANSPARENT_HUGE,
+    // Mapped from the reserved huge page pool, falling back to transparent
+    // huge pages when the pool is exhausted
+    PAGE_POLICY_EXPLICIT_HUGE
+};
+
+const t_uindex PSP_HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
 enum t_filter_op {
     FILTER_OP_LT,
     FILTER_OP_LTEQ,
@@ -312,7 +327,15 @@ enum t_aggtype {
     AGGTYPE_DISTINCT_COUNT,
     AGGTYPE_DISTINCT_LEAF,
     AGGTYPE_PCT_SUM_PARENT,
-    AGGTYPE_PCT_SUM_GRAND_TOTAL
+    AGGTYPE_PCT_SUM_GRAND_TOTAL,
+    AGGTYPE_APPROX_DISTINCT_COUNT,
+    AGGTYPE_APPROX_PERCENTILE,
+    AGGTYPE_ROLLING_SUM,
+    AGGTYPE_ROLLING_COUNT,
+    AGGTYPE_ROLLING_MEAN,
+    AGGTYPE_ROLLING_WEIGHTED_MEAN,
+    AGGTYPE_MIN,
+    AGGTYPE_MAX
 };
 
 PERSPECTIVE_EXPORT t_aggtype str_to_aggtype(const std::string& str);
@@ -332,6 +355,14 @@ enum t_ctx_type {
 
 enum t_op { OP_INSERT, OP_DELETE, OP_CLEAR };
 
+/**
+ * @brief The order in which a `t_gnode` notifies its contexts of an update.
+ * Visible contexts are notified first, then background contexts. Paused
+ * contexts are not notified, and are rebuilt from the gnode's state when
+ * they are resumed.
+ */
+enum t_ctx_priority { CTX_PRIORITY_VISIBLE, CTX_PRIORITY_BACKGROUND, CTX_PRIORITY_PAUSED };
+
 enum t_value_transition {
     VALUE_TRANSITION_EQ_FF,
     // VALUE_TRANSITION_EQ_FT nonsensical
@@ -491,6 +522,16 @@ struct t_cchar_umap_hash {
     }
 };
 
+/**
+ * @brief Returns an estimate of the bytes used by the buckets of an
+ * open-addressing hash map or set, not counting memory its values own.
+ */
+template <typename MAP_T>
+inline t_uindex
+hash_map_nbytes(const MAP_T& map) {
+    return map.bucket_count() * (sizeof(typename MAP_T::value_type) + sizeof(std::uint64_t));
+}
+
 bool is_internal_colname(const std::string& c);
 
 bool is_deterministic_sized(t_dtype dtype);
@@ -548,6 +589,17 @@ PERSPECTIVE_EXPORT t_dtype type_to_dtype<t_date>();
 template <>
 PERSPECTIVE_EXPORT t_dtype type_to_dtype<std::string>();
 
+/**
+ * @brief Write the first `len` characters of `str` to `os` as a quoted,
+ * escaped JSON string.
+ */
+PERSPECTIVE_EXPORT void write_json_string(std::ostream& os, const char* str, std::size_t len);
+
+inline void
+write_json_string(std::ostream& os, const std::string& str) {
+    write_json_string(os, str.c_str(), str.size());
+}
+
 } // end namespace perspective
 
 namespace std {
@@ -11,16 +11,21 @@
 #if defined(PSP_ENABLE_WASM) || defined(PSP_ENABLE_PYTHON)
 
 #include <perspective/base.h>
+#include <perspective/compat.h>
 #include <perspective/gnode.h>
+#include <perspective/data_generator.h>
 #include <perspective/data_table.h>
+#include <perspective/join.h>
 #include <perspective/pool.h>
 #include <perspective/context_zero.h>
 #include <perspective/context_one.h>
 #include <perspective/context_two.h>
 #include <perspective/sym_table.h>
 #include <perspective/table.h>
+#include <perspective/union.h>
 #include <perspective/view.h>
 #include <perspective/view_config.h>
+#include <perspective/view_feed.h>
 #include <random>
 #include <cmath>
 #include <sstream>
@@ -239,6 +244,27 @@ namespace binding {
         bool is_arrow,
         t_uindex port_id);
 
+    /**
+     * @brief Create a `t_data_generator` from the binding language's spec
+     * object, which continues after `num_keys` keys have been inserted in
+     * `num_batches` batches:
+     *
+     * `{seed, rows, columns: {name: {cardinality, null_ratio, string_length,
+     * sortedness}}}`
+     *
+     * where every field is optional, and columns not in `columns` take the
+     * defaults of `t_generator_column`.
+     *
+     * @tparam T
+     * @param spec
+     * @param num_keys
+     * @param num_batches
+     * @return std::shared_ptr<t_data_generator>
+     */
+    template <typename T>
+    std::shared_ptr<t_data_generator> make_data_generator(
+        T spec, t_uindex num_keys, t_uindex num_batches);
+
     /******************************************************************************
      *
      * View API
@@ -302,17 +328,21 @@ namespace binding {
      * Two sided views have one or more `row_pivots` and `column_pivots` applied, or they have
      * one or more `column_pivots` applied without any row pivots, hence the term `column_only`.
      *
+     * A `deferred` view is returned before its context is built, to be
+     * built in steps by `View::build`.
+     *
      * @tparam T
      * @param table
      * @param name
      * @param separator
      * @param config
      * @param date_parser
+     * @param deferred
      * @return std::shared_ptr<View<CTX_T>>
      */
     template <typename T, typename CTX_T>
     std::shared_ptr<View<CTX_T>> make_view(std::shared_ptr<Table> table, const std::string& name,
-        const std::string& separator, T view_config, T date_parser);
+        const std::string& separator, T view_config, T date_parser, bool deferred);
 
     /**
      * @brief Create a new context of type `CTX_T`, which will be one of 3 types:
@@ -323,6 +353,9 @@ namespace binding {
      * Contexts contain the underlying aggregates, sort specifications, filter terms, and other
      * metadata allowing for data manipulation and view creation.
      *
+     * A `deferred` context is registered without reading the table, to be
+     * built in steps by `t_pool::build_context`.
+     *
      * @return std::shared_ptr<CTX_T>
      */
     template <typename CTX_T>
@@ -330,7 +363,8 @@ namespace binding {
         std::shared_ptr<Table> table,
         std::shared_ptr<t_schema> schema,
         std::shared_ptr<t_view_config> view_config,
-        const std::string& name);
+        const std::string& name,
+        bool deferred = false);
 
     /**
      * @brief Given a table and a vector of computed column definitions,
@@ -0,0 +1,68 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#pragma once
+#include <perspective/first.h>
+#include <perspective/base.h>
+#include <perspective/exports.h>
+#include <cstdint>
+#include <vector>
+
+namespace perspective {
+
+/**
+ * @brief A blocked Bloom filter over 64-bit hashes. Each hash sets and
+ * tests bits of a single 64-byte block, so a probe reads one cache line,
+ * and a filter sized for `n` keys holds about 10 bits per key, a fraction
+ * of the size of a hash map of them.
+ *
+ * Keys cannot be removed, so a filter over a set that keys leave must be
+ * rebuilt to stay selective (see `t_pkey_mapping`).
+ */
+class PERSPECTIVE_EXPORT t_bloom_filter {
+public:
+    t_bloom_filter();
+
+    /**
+     * @brief Clear the filter and size it for `nkeys` keys.
+     *
+     * @param nkeys
+     */
+    void reset(t_uindex nkeys);
+
+    /**
+     * @brief Clear the filter and release its storage.
+     */
+    void clear();
+
+    /**
+     * @brief Returns whether the filter has no storage, i.e. has not been
+     * `reset` since it was constructed or cleared.
+     */
+    bool empty() const;
+
+    void insert(std::uint64_t hash);
+
+    /**
+     * @brief Returns false if `hash` was not inserted since the filter was
+     * last reset, or true if it may have been.
+     *
+     * @param hash
+     */
+    bool may_contain(std::uint64_t hash) const;
+
+    t_uindex nbytes() const;
+
+private:
+    // 8 words of each block, a bit of each set for every hash.
+    std::vector<std::uint64_t> m_words;
+    std::uint64_t m_block_mask;
+};
+
+} // end namespace perspective
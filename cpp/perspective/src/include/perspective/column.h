@@ -17,9 +17,11 @@
 #include <perspective/mask.h>
 #include <perspective/compat.h>
 #include <perspective/vocab.h>
+#include <atomic>
 #include <functional>
 #include <limits>
 #include <cmath>
+#include <mutex>
 #include <tsl/hopscotch_map.h>
 
 
@@ -34,6 +36,7 @@ accessors!
 namespace perspective {
 
 class t_column;
+class t_packed_column;
 
 #ifdef PSP_COLUMN_VERIFY
 #define COLUMN_CHECK_ACCESS(idx) PSP_VERBOSE_ASSERT((idx) <= m_size, "Invalid column access")
@@ -116,6 +119,15 @@ public:
 
     void reserve(t_uindex idx);
 
+    /**
+     * @brief Count the allocations of the column's values and statuses
+     * under `owner`; see `t_lstore::set_alloc_owner`. Its vocabulary is
+     * always counted under `ALLOC_OWNER_VOCAB`.
+     *
+     * @param owner
+     */
+    void set_alloc_owner(t_alloc_owner owner);
+
     //object storage
     template <typename T>
     void object_copied(std::uint64_t ptr) const;
@@ -138,6 +150,13 @@ public:
     t_lstore* _get_data_lstore();
 
     t_vocab* _get_vocab();
+    const t_vocab* _get_vocab() const;
+
+    /**
+     * @brief Returns the number of bytes allocated for the column's values
+     * and statuses, not counting its vocabulary.
+     */
+    t_uindex nbytes() const;
 
     t_tscalar get_scalar(t_uindex idx) const;
     void set_scalar(t_uindex idx, t_tscalar value);
@@ -173,8 +192,80 @@ public:
 
     void copy_vocabulary(const t_column* other);
 
+    /**
+     * @brief Make room in the vocabulary for `string_count` more strings of
+     * `string_size` bytes in all; see `t_vocab::reserve_additional`.
+     *
+     * @param string_size
+     * @param string_count
+     */
+    void reserve_vocabulary(t_uindex string_size, t_uindex string_count);
+
     void pprint_vocabulary() const;
 
+    /**
+     * @brief Clear the strings interned by this column, keeping the storage
+     * behind its vocabulary. A vocabulary shared with another column (see
+     * `borrow_vocabulary` and `share_vocabulary`) is left untouched.
+     */
+    void clear_vocabulary();
+
+    /**
+     * @brief Drop the strings that no valid row refers to from the
+     * vocabulary and remap every row to the renumbered ids, provided at
+     * least `min_dead_ratio` of the vocabulary is dead. Rows that are not
+     * valid and referred to a dropped string are pointed at id 0, which is
+     * always kept. A vocabulary shared with another column is left as is.
+     *
+     * @param min_dead_ratio
+     * @return t_uindex the number of strings dropped.
+     */
+    t_uindex compact_vocabulary(double min_dead_ratio);
+
+    /**
+     * @brief Move the values of `rows`, which must be ascending, to the
+     * front of the column in order, then truncate it and release the
+     * storage past them. The vocabulary is left as is.
+     *
+     * @param rows
+     */
+    void compact_rows(const std::vector<t_uindex>& rows);
+
+    /**
+     * @brief Move the value of each row `rows[idx]` to `idx`, where `rows`
+     * is a permutation of the column's rows. The vocabulary is left as is.
+     *
+     * @param rows
+     */
+    void permute_rows(const std::vector<t_uindex>& rows);
+
+    /**
+     * @brief Intern this column's valid strings into `vocab` and use it from
+     * now on, so that every column attached to `vocab` stores each string
+     * once and copies strings from the others as ids. Clones of the column,
+     * and columns that `copy_vocabulary` or `append` from it, attach to
+     * `vocab` too.
+     *
+     * A shared vocabulary only ever grows: it is never cleared or
+     * compacted, and the columns attached to it must not be written to
+     * concurrently.
+     */
+    void share_vocabulary(std::shared_ptr<t_vocab> vocab);
+
+    /**
+     * @brief Returns this column's vocabulary, marked as shared, for other
+     * columns to `share_vocabulary`.
+     */
+    std::shared_ptr<t_vocab> get_shared_vocabulary();
+
+    bool is_vocabulary_shared() const;
+
+    /**
+     * @brief Returns whether this column and `other` intern their strings
+     * into the same vocabulary, so that ids can be copied between them.
+     */
+    bool shares_vocabulary(const t_column& other) const;
+
     template <typename DATA_T>
     void raw_fill(DATA_T v);
 
@@ -182,8 +273,34 @@ public:
 
     std::shared_ptr<t_column> clone(const t_mask& mask) const;
 
+    /**
+     * @brief Returns a column that reads this column's storage as of the
+     * call without copying it (see `t_lstore::snapshot`), so that it can be
+     * read from another thread while this column is written. The snapshot
+     * is for reading only.
+     */
+    std::shared_ptr<t_column> snapshot();
+
     void valid_raw_fill();
 
+    /**
+     * @brief Set the status of the `len` rows from `offset` from a validity
+     * bitmap in Arrow's layout, where bit `bit_offset + i` (least significant
+     * bit first) marks row `offset + i` as valid.
+     *
+     * Whole bytes of the bitmap are expanded at once, so importing a column
+     * with nulls costs a table lookup per eight rows.
+     */
+    void set_valid_bitmap(
+        const std::uint8_t* bitmap, t_uindex bit_offset, t_uindex offset, t_uindex len);
+
+    /**
+     * @brief Write the validity of rows `[bidx, eidx)` into `out` as a
+     * bitmap in Arrow's layout, `(eidx - bidx + 7) / 8` bytes long; cleared
+     * rows are written as null. Returns the number of null rows.
+     */
+    t_uindex get_valid_bitmap(t_uindex bidx, t_uindex eidx, std::uint8_t* out) const;
+
     template <typename DATA_T>
     void copy_helper(
         const t_column* other, const std::vector<t_uindex>& indices, t_uindex offset);
@@ -205,7 +322,86 @@ public:
 
     void borrow_vocabulary(const t_column& o);
 
+    /**
+     * @brief Give the column a new, empty vocabulary of its own if it
+     * shares one, without remapping its rows.
+     */
+    void _unshare_vocabulary();
+
+    /**
+     * @brief Write the column's storage to files whose names start with
+     * `prefix`, which can be read back with `load`. The sizes needed to do
+     * so are those of the recipe returned by `get_recipe`.
+     *
+     * @param prefix
+     */
+    void save(const std::string& prefix) const;
+
+    /**
+     * @brief Replace the column's contents with the storage written by
+     * `save`, given the recipe of the saved column.
+     *
+     * @param prefix
+     * @param recipe
+     */
+    void load(const std::string& prefix, const t_column_recipe& recipe);
+
+    /**
+     * @brief Read the column's `size` values from `base`, which must be laid
+     * out as the column stores them, without copying them; see
+     * `t_lstore::borrow`. The column's status, if enabled, is unaffected.
+     *
+     * @param base
+     * @param size in items
+     * @param owner keeps the memory at `base` alive while it is borrowed.
+     */
+    void borrow_data(const void* base, t_uindex size, std::shared_ptr<const void> owner);
+
+    /**
+     * @brief Spill the column's values and statuses to files in `dirname`,
+     * releasing their memory until they are written to or `reload`ed; see
+     * `t_lstore::spill`. The vocabulary, which interned strings are looked
+     * up in by address, stays in memory.
+     *
+     * @param dirname
+     * @return bool whether anything was spilled.
+     */
+    bool spill(const std::string& dirname);
+
+    void reload();
+
+    bool is_spilled() const;
+
+    /**
+     * @brief Replace the column's values and statuses with a bit-packed copy
+     * (see `t_packed_column`), releasing their storage. `get_scalar`,
+     * `is_valid`, `is_cleared` and `fill` read a packed column in place;
+     * any other access to its values or statuses, and any write, unpacks it
+     * first. Only integer, bool, date and time columns are packed, and only
+     * when the copy is smaller.
+     *
+     * @return bool whether the column was packed.
+     */
+    bool pack();
+
+    void unpack();
+
+    bool is_packed() const;
+
+    /**
+     * @brief Decode the values of the rows `*bidx` to `*(eidx - 1)` into
+     * `out` if the column is packed; see `t_packed_column::gather`.
+     *
+     * @return bool whether the column was packed.
+     */
+    bool _gather_packed(const t_uindex* bidx, const t_uindex* eidx, std::int64_t* out) const;
+
 private:
+    // Restores the values and statuses of a packed column before they are
+    // read or written directly.
+    void unpack_if_packed() const;
+    void _unpack() const;
+
     t_dtype m_dtype;
     bool m_init;
     bool m_isvlen;
@@ -226,6 +422,12 @@ private:
     bool m_from_recipe;
 
     std::uint32_t m_elemsize;
+
+    // Set by `pack`, while `m_data` and `m_status` are empty. Readers of
+    // the packed copy may race with `_unpack`, which takes `m_packed_mtx`.
+    mutable std::shared_ptr<const t_packed_column> m_packed;
+    mutable std::atomic<bool> m_is_packed;
+    mutable std::mutex m_packed_mtx;
 };
 
 template <>
@@ -257,22 +459,35 @@ PERSPECTIVE_EXPORT void t_column::set_nth<std::string>(
 template <>
 PERSPECTIVE_EXPORT const char* t_column::get_nth<const char>(t_uindex idx) const;
 
+inline void
+t_column::unpack_if_packed() const {
+    if (m_is_packed.load(std::memory_order_acquire)) {
+        _unpack();
+    }
+}
+
 template <typename T>
 T*
 t_column::get(t_uindex idx) {
+    unpack_if_packed();
     return m_data->get<T>(idx);
 }
 
 template <typename T>
 const T*
 t_column::get(t_uindex idx) const {
-    return m_data->get<T>(idx);
+    unpack_if_packed();
+    // Read through the const overload, so that a borrowed store is not
+    // copied by reads.
+    const t_lstore& data = *m_data;
+    return data.get<T>(idx);
 }
 
 template <typename T>
 T*
 t_column::get_nth(t_uindex idx) {
     COLUMN_CHECK_ACCESS(idx);
+    unpack_if_packed();
     return m_data->get_nth<T>(idx);
 }
 
@@ -280,7 +495,9 @@ template <typename T>
 const T*
 t_column::get_nth(t_uindex idx) const {
     COLUMN_CHECK_ACCESS(idx);
-    return m_data->get_nth<T>(idx);
+    unpack_if_packed();
+    const t_lstore& data = *m_data;
+    return data.get_nth<T>(idx);
 }
 
 template <typename T>
@@ -292,6 +509,7 @@ t_column::extend() {
 template <typename T>
 T*
 t_column::extend(t_uindex idx) {
+    unpack_if_packed();
     T* rv = m_data->extend<T>(idx);
     m_size += idx;
     return rv;
@@ -300,6 +518,7 @@ t_column::extend(t_uindex idx) {
 template <typename DATA_T>
 void
 t_column::push_back(DATA_T elem) {
+    unpack_if_packed();
     m_data->push_back(elem);
     ++m_size;
 }
@@ -308,6 +527,7 @@ template <typename DATA_T>
 void
 t_column::push_back(DATA_T elem, t_status status) {
     PSP_VERBOSE_ASSERT(is_status_enabled(), "Validity not enabled for column");
+    unpack_if_packed();
     m_data->push_back(elem);
     m_status->push_back(status);
     ++m_size;
@@ -319,6 +539,7 @@ template <typename T>
 void
 t_column::set_nth(t_uindex idx, T v) {
     COLUMN_CHECK_ACCESS(idx);
+    unpack_if_packed();
     m_data->set_nth<T>(idx, v);
 
     if (is_status_enabled()) {
@@ -330,6 +551,7 @@ template <typename T>
 void
 t_column::set_nth(t_uindex idx, T v, t_status status) {
     COLUMN_CHECK_ACCESS(idx);
+    unpack_if_packed();
     m_data->set_nth<T>(idx, v);
 
     if (is_status_enabled()) {
@@ -347,7 +569,28 @@ t_column::fill(VEC_T& vec, const t_uindex* bidx, const t_uindex* eidx) const {
 
     PSP_VERBOSE_ASSERT(eidx - bidx > 0, "Invalid pointers passed in");
 
-    for (t_uindex idx = 0, loop_end = eidx - bidx; idx < loop_end; ++idx)
+    t_uindex idx = 0;
+    t_uindex loop_end = eidx - bidx;
+
+    // A packed column is decoded a chunk at a time rather than unpacked.
+    if (is_packed()) {
+        const t_uindex chunk_size = 256;
+        std::int64_t chunk[chunk_size];
+
+        while (idx < loop_end) {
+            t_uindex len = std::min(chunk_size, loop_end - idx);
+            if (!_gather_packed(bidx + idx, bidx + idx + len, chunk))
+                break;
+
+            for (t_uindex cidx = 0; cidx < len; ++cidx) {
+                vec[idx + cidx] = static_cast<typename VEC_T::value_type>(chunk[cidx]);
+            }
+
+            idx += len;
+        }
+    }
+
+    for (; idx < loop_end; ++idx)
 
     {
         vec[idx] = *(get_nth<typename VEC_T::value_type>(*(bidx + idx)));
@@ -359,8 +602,8 @@ void
 t_column::set_nth_body(t_uindex idx, DATA_T elem, t_status status) {
     COLUMN_CHECK_ACCESS(idx);
     PSP_VERBOSE_ASSERT(m_dtype == DTYPE_STR, "Setting non string column");
-    t_uindex interned = m_vocab->get_interned(elem);
-    m_data->set_nth<t_uindex>(idx, interned);
+    t_stridx interned = m_vocab->get_interned(elem);
+    m_data->set_nth<t_stridx>(idx, interned);
 
     if (is_status_enabled()) {
         m_status->set_nth<t_status>(idx, status);
@@ -377,6 +620,7 @@ void t_column::object_cleared<std::uint64_t>(std::uint64_t ptr) const;
 template <typename DATA_T>
 void
 t_column::raw_fill(DATA_T v) {
+    unpack_if_packed();
     m_data->raw_fill(v);
 }
 
@@ -0,0 +1,76 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2017, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#pragma once
+
+#include <perspective/first.h>
+#include <perspective/base.h>
+#include <perspective/column.h>
+#include <perspective/exports.h>
+#include <perspective/filter.h>
+#include <perspective/mask.h>
+#include <vector>
+
+namespace perspective {
+
+/**
+ * @brief Evaluate `fterm` over the first `nrows` rows of `column`, writing
+ * 1 into `out` for each row that passes and 0 for each row that fails.
+ *
+ * Comparisons between a column and a threshold of the same dtype run as
+ * one typed loop over the raw column buffer, with large `in` bags looked up
+ * in a hash set. String equality and `in` terms compare vocabulary ids,
+ * and other string terms evaluate `fterm` once per distinct vocabulary
+ * entry; any other term falls back to evaluating `fterm` on each cell's
+ * `t_tscalar`.
+ *
+ * @param column
+ * @param fterm a term whose threshold has already been coerced to the dtype
+ * of `column` (and interned, if `m_use_interned`).
+ * @param fail_invalid if true, rows with an invalid value fail every term
+ * other than `FILTER_OP_IS_NULL`, as under `FILTER_OP_AND`.
+ * @param nrows
+ * @param out a buffer of at least `nrows` bytes.
+ */
+PERSPECTIVE_EXPORT void filter_column(const t_column& column, const t_fterm& fterm,
+    bool fail_invalid, t_uindex nrows, std::uint8_t* out);
+
+/**
+ * @brief Compare the first `nrows` rows of `lhs` to the same rows of `rhs`
+ * by `op`, writing 1 into `out` for each row that passes and 0 for each row
+ * that fails, including every row where either value is invalid.
+ *
+ * Columns of the same numeric dtype compare in one typed loop over their
+ * raw buffers; numeric columns of different dtypes compare as doubles, and
+ * any others by their `t_tscalar`s.
+ *
+ * @param lhs
+ * @param op a comparison, or `FILTER_OP_BEGINS_WITH`, `FILTER_OP_ENDS_WITH`
+ * or `FILTER_OP_CONTAINS` for string columns.
+ * @param rhs
+ * @param nrows
+ * @param out a buffer of at least `nrows` bytes.
+ */
+PERSPECTIVE_EXPORT void filter_column_pair(const t_column& lhs, t_filter_op op,
+    const t_column& rhs, t_uindex nrows, std::uint8_t* out);
+
+/**
+ * @brief Combine the `fterms` filters over `columns` with `combiner`,
+ * evaluating each term for all rows before combining the per-term results.
+ *
+ * @param columns the column for each term in `fterms`.
+ * @param fterms
+ * @param combiner `FILTER_OP_AND` or `FILTER_OP_OR`.
+ * @param nrows
+ * @return t_mask
+ */
+PERSPECTIVE_EXPORT t_mask filter_columns(const std::vector<const t_column*>& columns,
+    const std::vector<t_fterm>& fterms, t_filter_op combiner, t_uindex nrows);
+
+} // end namespace perspective
@@ -0,0 +1,84 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#pragma once
+#include <perspective/first.h>
+#include <perspective/base.h>
+#include <perspective/exports.h>
+#include <perspective/column.h>
+#include <perspective/mask.h>
+#include <vector>
+
+namespace perspective {
+
+/**
+ * @brief An inverted index over a string column of the master table, from
+ * each vocabulary id to the rows which hold it, so that an equality filter
+ * reads only the rows it matches rather than scanning the column.
+ *
+ * A row is appended to the rows of its id whenever it is written, and is
+ * not removed from those of the id it held before, so the rows of an id may
+ * include rows which have since been overwritten or erased, or the same row
+ * more than once. `get_rows` checks each row against the column, and the
+ * index asks to be rebuilt once these stale rows outnumber the live ones.
+ *
+ * The index is only valid for as long as the column's vocabulary ids are,
+ * i.e. until the vocabulary is compacted, replaced or re-interned.
+ */
+class PERSPECTIVE_EXPORT t_column_index {
+public:
+    t_column_index();
+
+    /**
+     * @brief Index the first `nrows` rows of `column`.
+     *
+     * @param column
+     * @param nrows
+     */
+    void build(const t_column& column, t_uindex nrows);
+
+    /**
+     * @brief Record that vocabulary id `id` was written to row `ridx`.
+     *
+     * @param ridx
+     * @param id
+     */
+    void add(t_uindex ridx, t_stridx id);
+
+    /**
+     * @brief Set the rows of `column` which hold one of `ids` in `mask`,
+     * which must be at least as large as the column.
+     *
+     * @param column
+     * @param ids
+     * @param mask
+     */
+    void get_rows(const t_column& column, const std::vector<t_stridx>& ids, t_mask& mask) const;
+
+    /**
+     * @brief Returns whether the stale rows of the index outnumber the
+     * `nrows` rows of its column.
+     *
+     * @param nrows
+     */
+    bool needs_rebuild(t_uindex nrows) const;
+
+    /**
+     * @brief Returns an estimate of the bytes used by the index.
+     */
+    t_uindex nbytes() const;
+
+private:
+    std::vector<std::vector<t_uindex>> m_rows;
+
+    // The number of rows recorded, including stale ones.
+    t_uindex m_size;
+};
+
+} // end namespace perspective
@@ -11,7 +11,9 @@
 #include <perspective/first.h>
 #include <perspective/base.h>
 #include <perspective/raw_types.h>
+#include <cstdio>
 #include <thread>
+#include <vector>
 #ifndef WIN32
 #include <sys/mman.h>
 #endif
@@ -23,6 +25,12 @@ void close_file(t_handle h);
 void flush_mapping(void* base, t_uindex len);
 void rmfile(const std::string& fname);
 
+// Flush `file` and block until its contents are on disk.
+void sync_file(std::FILE* file);
+
+// Block until the files directly in `dirname`, and its entries, are on disk.
+void sync_dir(const std::string& dirname);
+
 struct t_rfmapping {
     t_rfmapping();
     t_rfmapping(t_handle fd, void* base, t_uindex size);
@@ -41,6 +49,30 @@ void map_file_write(const std::string& fname, t_uindex size, t_rfmapping& out);
 void set_thread_name(std::thread& thr, const std::string& name);
 void set_thread_name(const std::string& name);
 
+// The CPUs the calling thread may run on, or empty where this is not
+// supported.
+std::vector<t_uindex> get_thread_affinity();
+
+// Restrict the calling thread to the CPUs `cpus`. Does nothing if `cpus` is
+// empty or where this is not supported.
+void set_thread_affinity(const std::vector<t_uindex>& cpus);
+
+// The number of NUMA nodes of the machine, or 1 where this is not supported.
+t_uindex get_num_numa_nodes();
+
+// The CPUs of NUMA node `node`, or empty if there is no such node or where
+// this is not supported.
+std::vector<t_uindex> get_numa_node_cpus(t_uindex node);
+
+// The NUMA node the calling thread prefers to allocate memory on, or -1 if
+// it allocates on the node it runs on, as threads do by default.
+t_index get_thread_numa_node();
+
+// Prefer NUMA node `node` for the memory the calling thread touches first,
+// or the node it runs on if `node` is -1. Does nothing where this is not
+// supported.
+void set_thread_numa_node(t_index node);
+
 void launch_proc(const std::string& cmdline);
 
 std::string cwd();
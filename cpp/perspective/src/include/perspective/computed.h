@@ -9,6 +9,8 @@
 
 #pragma once
 #include <cmath>
+#include <unordered_map>
+#include <limits>
 #include <type_traits>
 #include <perspective/first.h>
 #include <perspective/base.h>
@@ -170,15 +172,27 @@ public:
         t_computation computation);
 
     /**
-     * @brief Pregenerate all combinations of `t_computation` structs for
-     * each `t_dtype` and `t_computed_function_name`. This method should be run
-     * once at initialization of the Perspective C++ module.
+     * @brief Generate the `t_computation` structs of `get_computations` now,
+     * rather than when a computed column first looks one up.
      */
     static void make_computations();
 
-    static std::vector<t_computation> computations;
+    /**
+     * @brief Returns every combination of `t_computation` structs for each
+     * `t_dtype` and `t_computed_function_name`, generated on first use so
+     * that modules which never compute a column do not pay for them.
+     */
+    static const std::vector<t_computation>& get_computations();
+
+    /**
+     * @brief Returns the metadata of every computed function by name,
+     * built on first use.
+     */
+    static const std::map<std::string, std::map<std::string, std::string>>&
+    get_computed_functions();
 
-    static std::map<std::string, std::map<std::string, std::string>> computed_functions;
+private:
+    static std::vector<t_computation> generate_computations();
 };
 
 } // end namespace perspective
\ No newline at end of file
@@ -14,7 +14,11 @@
 #include <perspective/exports.h>
 #include <perspective/raw_types.h>
 #include <perspective/computed.h>
+#include <perspective/computed_expression.h>
 #include <tsl/ordered_map.h>
+#include <map>
+#include <memory>
+#include <set>
 
 namespace perspective {
 
@@ -26,6 +30,14 @@ namespace perspective {
  * new computed columns. When contexts are deleted, call the 
  * `remove_computed_columns` method to stop tracking the context's computed
  * columns.
+ *
+ * Columns are reference counted by name, so contexts that declare the same
+ * computed column share a single column in the gnode's tables, which is
+ * only dropped once the last of them is deleted.
+ *
+ * Once the set of tracked columns changes, call `update_expressions` with
+ * the names of the columns that contexts read, so that chains of computed
+ * columns are fused and only the columns that are read are materialized.
  * 
  */
 struct PERSPECTIVE_EXPORT t_computed_column_map {
@@ -33,10 +45,12 @@ struct PERSPECTIVE_EXPORT t_computed_column_map {
     t_computed_column_map();
 
     /**
-     * @brief Add computed column definitions to be tracked.
+     * @brief Add computed column definitions to be tracked, counting a
+     * reference to each.
      * 
      * Column definitions with duplicate names will replace the stored
-     * column definition.
+     * column definition. Columns that are new or whose definition changed
+     * are marked stale.
      * 
      * @param columns 
      */
@@ -44,11 +58,45 @@ struct PERSPECTIVE_EXPORT t_computed_column_map {
         const std::vector<t_computed_column_definition>& columns);
 
     /**
-     * @brief Remove computed columns by name.
+     * @brief Release a reference to each of the computed columns in `names`,
+     * and stop tracking the columns that are no longer referenced.
      * 
      * @param names 
+     * @return std::vector<std::string> the names of the columns that are no
+     * longer tracked
+     */
+    std::vector<std::string> remove_computed_columns(const std::vector<std::string>& names);
+
+    /**
+     * @brief Rebuild `m_expressions` for the computed columns that should be
+     * materialized: those named in `referenced`, and those returning
+     * strings, which cannot be fused. Inputs that are computed columns but
+     * are not materialized are fused into the expression that reads them.
+     * Also rebuilds `m_read_columns` and `m_transitional_columns`.
+     *
+     * @param referenced
+     */
+    void update_expressions(const std::set<std::string>& referenced);
+
+    /**
+     * @brief Returns the expression computing `name`, or nullptr if the
+     * column is not materialized or its computation is invalid.
+     *
+     * @param name
+     * @return std::shared_ptr<t_computed_expression>
+     */
+    std::shared_ptr<t_computed_expression> get_expression(const std::string& name) const;
+
+    /**
+     * @brief Returns the names of the computed columns that read any of
+     * `changed_columns`, directly or through other computed columns, and so
+     * must be recomputed when they change.
+     *
+     * @param changed_columns
+     * @return std::set<std::string>
      */
-    void remove_computed_columns(const std::vector<std::string>& names);
+    std::set<std::string> get_affected_columns(
+        const std::set<std::string>& changed_columns) const;
 
     /**
      * @brief An ordered map of computed column names to computed column
@@ -56,6 +104,71 @@ struct PERSPECTIVE_EXPORT t_computed_column_map {
      * 
      */
     tsl::ordered_map<std::string, t_computed_column_definition> m_computed_columns;
+
+    /**
+     * @brief Expressions for the computed columns that are materialized,
+     * keyed by column name.
+     * 
+     */
+    tsl::ordered_map<std::string, std::shared_ptr<t_computed_expression>> m_expressions;
+
+    /**
+     * @brief The number of references to each tracked computed column.
+     * 
+     */
+    std::map<std::string, t_uindex> m_reference_counts;
+
+    /**
+     * @brief Materialized computed columns whose values in the gnode's master
+     * table are missing or out of date, because they are new, were redefined
+     * or have only just become materialized. Cleared by the gnode once it
+     * computes them.
+     * 
+     */
+    std::set<std::string> m_stale_columns;
+
+    /**
+     * @brief The computed columns that contexts read. Only these are
+     * processed into the gnode's transitional tables on each update, so a
+     * materialized column that no context reads costs nothing there.
+     * 
+     */
+    std::set<std::string> m_read_columns;
+
+    /**
+     * @brief The computed columns to compute on the gnode's transitional
+     * tables: `m_read_columns`, and the materialized columns they read.
+     * 
+     */
+    std::set<std::string> m_transitional_columns;
+
+    /**
+     * @brief The names of the materialized computed columns, grouped so that
+     * each group only reads the computed columns of earlier groups. Columns
+     * within a group are independent of each other.
+     * 
+     */
+    std::vector<std::vector<std::string>> m_levels;
+
+    /**
+     * @brief For each column read by a computed column, the names of the
+     * computed columns that read it directly - the edges of the dependency
+     * graph, rebuilt whenever columns are added or removed.
+     * 
+     */
+    std::map<std::string, std::vector<std::string>> m_dependents;
+
+private:
+    void update_dependents();
+
+    void update_levels();
+
+    t_uindex get_level(const std::string& name, std::map<std::string, t_uindex>& levels,
+        std::set<std::string>& visiting) const;
+
+    std::shared_ptr<t_computed_expression> build_expression(
+        const t_computed_column_definition& column, const std::set<std::string>& materialized,
+        std::set<std::string>& visiting) const;
 };
 
 } // end namespace perspective
\ No newline at end of file
@@ -0,0 +1,137 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#pragma once
+
+#include <perspective/first.h>
+#include <perspective/base.h>
+#include <perspective/exports.h>
+#include <perspective/raw_types.h>
+#include <perspective/column.h>
+#include <perspective/data_table.h>
+#include <perspective/rlookup.h>
+#include <perspective/computed.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace perspective {
+
+/**
+ * @brief A tree of computations over the columns of a `t_data_table`.
+ *
+ * Leaves read a column of the table, and every other node applies a
+ * `t_computation` to the values of its inputs. A chain of computed columns,
+ * i.e. `(a - b) / c` where `a - b` is itself a computed column, is fused
+ * into a single tree so that it can be evaluated in one pass without
+ * materializing the intermediate column.
+ *
+ * Only the root of a tree may return a string, as string functions write
+ * directly into their output column's vocabulary.
+ */
+class PERSPECTIVE_EXPORT t_computed_expression {
+public:
+    /**
+     * @brief Construct a leaf reading `column_name`. `is_computed` marks
+     * leaves that are themselves computed columns, which are recomputed on
+     * every update and so never fall back to the master table.
+     *
+     * @param column_name
+     * @param is_computed
+     */
+    t_computed_expression(const std::string& column_name, bool is_computed);
+
+    /**
+     * @brief Construct a node applying `computation` to `inputs`, which
+     * become part of this tree and must not be shared with another.
+     *
+     * @param computation
+     * @param inputs
+     */
+    t_computed_expression(const t_computation& computation,
+        const std::vector<std::shared_ptr<t_computed_expression>>& inputs);
+
+    bool is_leaf() const;
+
+    /**
+     * @brief Whether any input of this node is itself a computation.
+     */
+    bool is_fused() const;
+
+    const std::string& get_column_name() const;
+
+    /**
+     * @brief Whether this leaf reads a computed column.
+     */
+    bool is_computed() const;
+
+    /**
+     * @brief Returns the leaves of the tree; only valid on its root.
+     */
+    const std::vector<const t_computed_expression*>& get_leaves() const;
+
+    const t_computation& get_computation() const;
+
+    /**
+     * @brief Evaluate the tree over every row of `tbl`, writing into
+     * `output_column`.
+     *
+     * @param tbl
+     * @param output_column
+     */
+    void compute(const t_data_table& tbl, std::shared_ptr<t_column> output_column) const;
+
+    /**
+     * @brief Evaluate the tree over the rows of `flattened`, reading the
+     * master `tbl` for inputs that `flattened` does not set. Follows the
+     * same rules as `t_computed_column::reapply_computation`.
+     *
+     * @param tbl
+     * @param flattened
+     * @param changed_rows
+     * @param output_column
+     */
+    void recompute(const t_data_table& tbl, const t_data_table& flattened,
+        const std::vector<t_rlookup>& changed_rows,
+        std::shared_ptr<t_column> output_column) const;
+
+private:
+    void collect_leaves(std::vector<const t_computed_expression*>& leaves);
+
+    /**
+     * @brief Evaluate a node that does not return a string from the leaf
+     * values of a single row, returning `mknone()` if any input is invalid.
+     */
+    t_tscalar evaluate(const std::vector<t_tscalar>& leaf_values) const;
+
+    /**
+     * @brief Evaluate the root over a row whose leaf values have been read,
+     * writing the result or clearing the row in `output_column`.
+     */
+    void write_row(const std::vector<t_tscalar>& leaf_values, t_uindex idx,
+        std::shared_ptr<t_column> output_column) const;
+
+    // Leaves
+    std::string m_column_name;
+    bool m_is_computed;
+    t_uindex m_leaf_idx;
+
+    // Nodes
+    t_computation m_computation;
+    std::vector<std::shared_ptr<t_computed_expression>> m_inputs;
+    std::function<t_tscalar(t_tscalar)> m_function_1;
+    std::function<t_tscalar(t_tscalar, t_tscalar)> m_function_2;
+    std::function<void(t_tscalar, std::int32_t, std::shared_ptr<t_column>)> m_string_function_1;
+    std::function<void(t_tscalar, t_tscalar, std::int32_t, std::shared_ptr<t_column>)> m_string_function_2;
+
+    // Set on the root only - the leaves of the tree, by `m_leaf_idx`
+    std::vector<const t_computed_expression*> m_leaves;
+};
+
+} // end namespace perspective
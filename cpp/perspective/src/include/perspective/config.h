@@ -97,6 +97,24 @@ public:
         const std::vector<t_computed_column_definition>& computed_columns,
         bool column_only);
 
+    /**
+     * @brief Construct a new config for a `t_ctx_grouped_pkey` object, whose
+     * tree nests each row under the row whose `child_pkey_column` equals its
+     * `parent_pkey_column`, showing `detail_columns` as-is.
+     *
+     * @param detail_columns
+     * @param parent_pkey_column
+     * @param child_pkey_column
+     * @param grouping_label_column the column shown as each row's name, or
+     * empty to show its `child_pkey_column`
+     * @param fterms
+     * @param combiner
+     */
+    t_config(const std::vector<std::string>& detail_columns,
+        const std::string& parent_pkey_column, const std::string& child_pkey_column,
+        const std::string& grouping_label_column, const std::vector<t_fterm>& fterms,
+        t_filter_op combiner);
+
     // Constructors used for C++ tests, not exposed to other parts of the engine
     t_config(const std::vector<std::string>& row_pivots,
         const std::vector<std::string>& col_pivots, const std::vector<t_aggspec>& aggregates);
@@ -132,6 +150,14 @@ public:
 
     std::string repr() const;
 
+    /**
+     * @brief Returns a string which is equal for two configs exactly when
+     * contexts built from them over the same table build identical trees:
+     * the same pivots, aggregates, tree sorts, filters and computed
+     * columns, in the same order.
+     */
+    std::string get_tree_signature() const;
+
     t_uindex get_num_aggregates() const;
 
     t_uindex get_num_columns() const;
@@ -164,6 +190,20 @@ public:
 
     const std::vector<t_fterm>& get_fterms() const;
 
+    /**
+     * @brief Filter by `fexpr` rather than by terms, in `FMODE_JIT_EXPR`,
+     * for filters which compare columns or nest groups.
+     */
+    void set_filter_expr(const t_fexpr& fexpr);
+
+    const t_fexpr& get_filter_expr() const;
+
+    /**
+     * @brief Returns the columns read by the config's filters, whether terms
+     * or an expression.
+     */
+    std::set<std::string> get_filter_columns() const;
+
     // TOOD: const vec&?
     std::vector<t_computed_column_definition>
     get_computed_columns() const;
@@ -212,6 +252,7 @@ private:
     std::string m_grouping_label_column;
     t_fmode m_fmode;
     std::vector<std::string> m_filter_exprs;
+    t_fexpr m_fexpr;
     std::string m_grand_agg_str;
 };
 
@@ -20,10 +20,25 @@
 #include <perspective/step_delta.h>
 #include <perspective/slice.h>
 #include <perspective/range.h>
+#include <perspective/row_paths.h>
 #include <perspective/gnode_state.h>
+#include <map>
 
 namespace perspective {
 
+/**
+ * @brief Copy-on-write snapshots of the tables a read from a context refers
+ * to, taken under the gnode's lock (see `t_data_table::snapshot`), so that
+ * the read can finish while the gnode processes updates.
+ */
+struct PERSPECTIVE_EXPORT t_ctx_snapshot {
+    std::vector<std::shared_ptr<t_data_table>> m_tables;
+
+    // For flat contexts, the row of `m_tables[0]` holding each row read, or
+    // -1 if its primary key has been removed.
+    std::vector<t_index> m_rows;
+};
+
 template <typename CTX_T>
 class t_ctx_common {
 public:
@@ -67,6 +82,36 @@ public:
 
     bool failed() const;
 
+    /**
+     * @brief Limit the changes tracked and returned by `get_step_delta` and
+     * `get_row_delta` to those that intersect `viewport`.
+     */
+    void set_viewport(const t_viewport& viewport);
+    void clear_viewport();
+    const t_viewport& get_viewport() const;
+
+    /**
+     * @brief Return whether the number of rows in the context has changed
+     * since the beginning of the current step, without computing any deltas.
+     */
+    bool get_row_count_changed() const;
+
+    /**
+     * @brief Returns a count which changes whenever a step, reset or
+     * expansion changes the data the context serves, and is otherwise
+     * stable, so that readers can cache what they read from it.
+     */
+    t_uindex get_data_version() const;
+
+    /**
+     * @brief While coalescing, the deltas of successive steps accumulate
+     * until they are read by `get_step_delta` or `get_row_delta`, instead of
+     * being reset at the beginning of each step, so that a reader notified
+     * of only some steps still reads every change since its last read.
+     */
+    void set_coalesce_deltas(bool coalesce);
+    bool get_coalesce_deltas() const;
+
     t_ctx_common<t_ctxbase>
     common() {
         return t_ctx_common<t_ctxbase>(this);
@@ -81,6 +126,20 @@ public:
 
     std::vector<t_tscalar> get_data() const;
 
+    /**
+     * @brief Bin the values of `colname` in the master table at the rows
+     * `pkeys`, which can be read from `get_pkeys`.
+     */
+    t_histogram get_histogram(const std::vector<t_tscalar>& pkeys, const std::string& colname,
+        t_uindex nbuckets, t_binning binning) const;
+
+    /**
+     * @brief Returns the min and max of the valid values of `colname` in
+     * the master table at the rows `pkeys`.
+     */
+    t_minmax get_values_min_max(
+        const std::vector<t_tscalar>& pkeys, const std::string& colname) const;
+
 protected:
     t_schema m_schema;
     t_config m_config;
@@ -91,6 +150,20 @@ protected:
     bool m_init;
     std::vector<bool> m_features;
     std::vector<t_minmax> m_minmax;
+    t_viewport m_viewport;
+    t_uindex m_step_row_count;
+    t_uindex m_data_version;
+    bool m_coalesce_deltas;
+
+    // Whether a step has begun since the deltas were last read.
+    bool m_deltas_pending;
+
+    /**
+     * @brief Called by `step_begin`, returns whether the step should reset
+     * the delta state of the last, which it should unless coalescing deltas
+     * that have not yet been read.
+     */
+    bool begin_step_deltas();
 };
 
 template <typename DERIVED_T>
@@ -105,7 +178,11 @@ template <typename DERIVED_T>
 t_ctxbase<DERIVED_T>::t_ctxbase()
     : m_rows_changed(true)
     , m_columns_changed(true)
-    , m_init(false) {
+    , m_init(false)
+    , m_step_row_count(0)
+    , m_data_version(0)
+    , m_coalesce_deltas(false)
+    , m_deltas_pending(false) {
     m_features = std::vector<bool>(CTX_FEAT_LAST_FEATURE);
     m_features[CTX_FEAT_ENABLED] = true;
 }
@@ -117,7 +194,11 @@ t_ctxbase<DERIVED_T>::t_ctxbase(const t_schema& schema, const t_config& config)
     , m_config(config)
     , m_rows_changed(true)
     , m_columns_changed(true)
-    , m_init(false) {
+    , m_init(false)
+    , m_step_row_count(0)
+    , m_data_version(0)
+    , m_coalesce_deltas(false)
+    , m_deltas_pending(false) {
     m_features = std::vector<bool>(CTX_FEAT_LAST_FEATURE);
     m_features[CTX_FEAT_ENABLED] = true;
 }
@@ -194,6 +275,57 @@ t_ctxbase<DERIVED_T>::failed() const {
     return false;
 }
 
+template <typename DERIVED_T>
+void
+t_ctxbase<DERIVED_T>::set_viewport(const t_viewport& viewport) {
+    m_viewport = viewport;
+}
+
+template <typename DERIVED_T>
+void
+t_ctxbase<DERIVED_T>::set_coalesce_deltas(bool coalesce) {
+    m_coalesce_deltas = coalesce;
+}
+
+template <typename DERIVED_T>
+bool
+t_ctxbase<DERIVED_T>::get_coalesce_deltas() const {
+    return m_coalesce_deltas;
+}
+
+template <typename DERIVED_T>
+bool
+t_ctxbase<DERIVED_T>::begin_step_deltas() {
+    bool reset = !m_coalesce_deltas || !m_deltas_pending;
+    m_deltas_pending = true;
+    return reset;
+}
+
+template <typename DERIVED_T>
+void
+t_ctxbase<DERIVED_T>::clear_viewport() {
+    m_viewport = t_viewport();
+}
+
+template <typename DERIVED_T>
+const t_viewport&
+t_ctxbase<DERIVED_T>::get_viewport() const {
+    return m_viewport;
+}
+
+template <typename DERIVED_T>
+bool
+t_ctxbase<DERIVED_T>::get_row_count_changed() const {
+    auto ctx = reinterpret_cast<const DERIVED_T*>(this);
+    return t_uindex(ctx->get_row_count()) != m_step_row_count;
+}
+
+template <typename DERIVED_T>
+t_uindex
+t_ctxbase<DERIVED_T>::get_data_version() const {
+    return m_data_version;
+}
+
 template <typename DERIVED_T>
 bool
 t_ctxbase<DERIVED_T>::get_feature_state(t_ctx_feature feature) const {
@@ -302,4 +434,18 @@ t_ctxbase<DERIVED_T>::get_data() const {
     return cptr->get_data(0, cptr->get_row_count(), 0, cptr->get_column_count());
 }
 
+template <typename DERIVED_T>
+t_histogram
+t_ctxbase<DERIVED_T>::get_histogram(const std::vector<t_tscalar>& pkeys,
+    const std::string& colname, t_uindex nbuckets, t_binning binning) const {
+    return m_gstate->get_histogram(pkeys, colname, nbuckets, binning);
+}
+
+template <typename DERIVED_T>
+t_minmax
+t_ctxbase<DERIVED_T>::get_values_min_max(
+    const std::vector<t_tscalar>& pkeys, const std::string& colname) const {
+    return m_gstate->get_min_max(pkeys, colname);
+}
+
 } // end namespace perspective
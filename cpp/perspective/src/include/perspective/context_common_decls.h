@@ -31,6 +31,8 @@ void step_begin();
 void step_end();
 
 std::string repr() const;
+// bytes used by each component of the context
+std::map<std::string, t_uindex> get_memory_usage() const;
 
 void init();
 
@@ -75,6 +77,9 @@ std::vector<t_stree*> get_trees();
 
 bool has_deltas() const;
 
+// the columns `notify` reads from its transitional tables
+std::set<std::string> get_transitional_columns() const;
+
 void pprint() const;
 
 t_dtype get_column_dtype(t_uindex idx) const;
@@ -85,6 +90,7 @@ std::shared_ptr<t_data_table> get_table() const;
 std::vector<t_tscalar> unity_get_row_data(t_uindex idx) const;
 std::vector<t_tscalar> unity_get_column_data(t_uindex idx) const;
 std::vector<t_tscalar> unity_get_row_path(t_uindex idx) const;
+t_row_paths unity_get_row_paths(t_uindex start_row, t_uindex end_row) const;
 std::vector<t_tscalar> unity_get_column_path(t_uindex idx) const;
 t_uindex unity_get_row_depth(t_uindex ridx) const;
 t_uindex unity_get_column_depth(t_uindex cidx) const;
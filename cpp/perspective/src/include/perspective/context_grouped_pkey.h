@@ -16,6 +16,7 @@
 #include <perspective/data_table.h>
 #include <perspective/path.h>
 #include <perspective/sym_table.h>
+#include <tsl/hopscotch_map.h>
 
 namespace perspective {
 
@@ -57,6 +58,20 @@ public:
 private:
     void rebuild();
 
+    /**
+     * @brief Apply the rows of `flattened` to the tree in place, by copying
+     * the new values of the rows it updates into their nodes' aggregates.
+     *
+     * Returns false without changing the tree if any row must be inserted,
+     * moved or removed, i.e. if a row enters or leaves the filtered rows, or
+     * changes its child, parent or sort value, in which case the tree must be
+     * rebuilt.
+     *
+     * @param flattened
+     * @return bool
+     */
+    bool update(const t_data_table& flattened);
+
     std::shared_ptr<t_traversal> m_traversal;
     std::shared_ptr<t_stree> m_tree;
     std::vector<t_sortspec> m_sortby;
@@ -64,6 +79,19 @@ private:
     bool m_has_label;
     t_depth m_depth;
     bool m_depth_set;
+
+    // The node of each filtered row's pkey, and of each child value, as of
+    // the last rebuild, or 0 for a row which is not in the tree.
+    tsl::hopscotch_map<t_tscalar, t_uindex> m_pkey_nidx;
+    tsl::hopscotch_map<t_tscalar, t_uindex> m_child_nidx;
+
+    // Whether `update` can be used, which it cannot when child values repeat.
+    bool m_incremental;
+
+    // Whether this step rebuilt the tree, or changed aggregate values in
+    // place under a sort.
+    bool m_rebuilt;
+    bool m_resort;
 };
 
 typedef std::shared_ptr<t_ctx_grouped_pkey> t_ctx_grouped_pkey_sptr;
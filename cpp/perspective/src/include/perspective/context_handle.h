@@ -11,10 +11,13 @@
 #include <perspective/first.h>
 #include <perspective/base.h>
 #include <map>
+#include <memory>
 #include <vector>
 
 namespace perspective {
 
+class t_data_table;
+
 struct t_ctx_handle {
     t_ctx_handle();
     t_ctx_handle(void* ctx, t_ctx_type ctx_type);
@@ -33,5 +36,26 @@ struct t_ctx_handle {
 
     t_ctx_type m_ctx_type;
     void* m_ctx;
+    t_ctx_priority m_priority;
+
+    // Whether updates were processed while the context was paused.
+    bool m_stale;
+
+    // Whether the context is being built in steps by `build_context`, and
+    // how many rows of `m_build_table` it has read so far.
+    bool m_building;
+    t_uindex m_build_offset;
+    std::shared_ptr<t_data_table> m_build_table;
+
+    // Whether the context is frozen by `t_gnode::freeze_context`, the
+    // number of updates the gnode had processed when it was, and, for a
+    // context paused instead as it shares a tree, its priority before.
+    bool m_frozen;
+    t_uindex m_frozen_at;
+    t_ctx_priority m_thaw_priority;
+
+    // The bytes the context may use before `t_gnode` reclaims its derived
+    // state after an update, or 0 for no budget.
+    t_uindex m_memory_budget;
 };
 } // end namespace perspective
@@ -18,6 +18,8 @@
 
 namespace perspective {
 
+struct t_tree_traversal;
+
 class PERSPECTIVE_EXPORT t_ctx1 : public t_ctxbase<t_ctx1> {
 public:
     t_ctx1();
@@ -38,20 +40,101 @@ public:
     std::vector<t_tscalar> get_row_path(t_index idx) const;
     void set_depth(t_depth depth);
 
+    /**
+     * @brief Returns the paths of the deepest expanded rows, which
+     * `set_expansion_state` expands again.
+     */
+    std::vector<t_path> get_expansion_state() const;
+
+    /**
+     * @brief Expand the rows of `paths` and their ancestors, as `open` on
+     * each of them would, in one pass over the traversal.
+     *
+     * @param paths
+     */
+    void set_expansion_state(const std::vector<t_path>& paths);
+
     t_minmax get_agg_min_max(t_uindex aggidx, t_depth depth) const;
 
     t_index get_row_idx(const std::vector<t_tscalar>& path) const;
 
     t_depth get_trav_depth(t_index idx) const;
 
+    /**
+     * @brief Only aggregate the nodes which are visible, or have been
+     * visible since the last `set_depth`, computing the rest when `open` or
+     * `set_depth` first reveals them. Defaults to `PSP_LAZY_AGGREGATES`.
+     *
+     * A context sharing its tree keeps it fully aggregated, and ignores
+     * this.
+     */
+    void set_lazy_aggregates(bool enabled);
+    bool get_lazy_aggregates() const;
+
+    /**
+     * @brief Release the aggregates of the nodes under collapsed nodes,
+     * which are aggregated lazily from now on and recomputed when `open`
+     * reveals them again. A context sharing its tree keeps it.
+     */
+    void reclaim();
+
+    /**
+     * @brief Returns whether this context can share its tree with other
+     * contexts of the same `t_config::get_tree_signature`. A context which
+     * aggregates lazily materializes its tree as it is expanded, so keeps a
+     * tree of its own.
+     */
+    bool can_share_tree() const;
+
+    /**
+     * @brief Read the tree of `leader` instead of building one, through a
+     * traversal, sort and depth of this context's own. `leader` updates the
+     * tree and this context's traversal when it is notified, and steps this
+     * context with it, so a follower is not notified itself.
+     *
+     * The deltas of a shared tree are read by every context sharing it, so
+     * they are cleared when the tree is next notified rather than when read.
+     */
+    void share_tree(t_ctx1* leader);
+
+    /**
+     * @brief Stop sharing a tree: a follower is no longer updated, and a
+     * leader hands its tree and followers over to its first follower.
+     */
+    void leave_tree_group();
+
+    /**
+     * @brief Returns the tree the context reads, which is its leader's if
+     * it shares one.
+     */
+    std::shared_ptr<t_stree> get_tree() const;
+
+    t_ctx1* get_tree_leader() const;
+    bool is_tree_follower() const;
+    bool is_tree_shared() const;
+
     using t_ctxbase<t_ctx1>::get_data;
 
+    /**
+     * @brief Returns the data version of `t_ctxbase`, which also counts the
+     * changes to the context's traversals.
+     */
+    t_uindex get_data_version() const;
+
 private:
+    void update_tree_features();
+    std::vector<t_tree_traversal> get_tree_traversals();
+
     std::shared_ptr<t_traversal> m_traversal;
     std::shared_ptr<t_stree> m_tree;
     std::vector<t_sortspec> m_sortby;
     t_depth m_depth;
     bool m_depth_set;
+    bool m_lazy_aggregates;
+    // The context whose tree this context reads, or null if it owns its tree,
+    // and the contexts reading this context's tree.
+    t_ctx1* m_tree_leader;
+    std::vector<t_ctx1*> m_tree_followers;
 };
 
 } // end namespace perspective
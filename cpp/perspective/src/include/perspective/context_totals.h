@@ -0,0 +1,132 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#pragma once
+#include <perspective/first.h>
+#include <perspective/base.h>
+#include <perspective/exports.h>
+#include <perspective/aggspec.h>
+#include <perspective/config.h>
+#include <perspective/data_table.h>
+#include <perspective/filter.h>
+#include <perspective/scalar.h>
+#include <perspective/sym_table.h>
+#include <perspective/value_multiset.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace perspective {
+
+/**
+ * @brief Maintains the grand totals of a table, the aggregates of the root
+ * node of a pivot, without a tree, traversal or sort. Each update adds the
+ * rows it inserts and subtracts the previous values of the rows it updates
+ * or removes, read from the gnode's transitional tables, so that a totals
+ * context costs a few operations per updated row and no memory per row.
+ *
+ * `SUM`, `COUNT`, `MEAN`, `WEIGHTED_MEAN`, `HIGH_WATER_MARK` and
+ * `LOW_WATER_MARK` are kept as running sums or bounds, and `MEDIAN`, `MIN`,
+ * `MAX`, `DISTINCT_COUNT`, `UNIQUE` and `DOMINANT` from a multiset of the
+ * column's values. Other aggregates read rows under a node, so need a
+ * `t_ctx1`.
+ */
+class PERSPECTIVE_EXPORT t_ctx_totals {
+public:
+    /**
+     * @brief Construct a totals context of `aggspecs` over the rows of a
+     * table with `schema` which pass `fterms` combined by `combiner`, with
+     * the aggregates in the units of a scaled column divided by its scale.
+     */
+    t_ctx_totals(const t_schema& schema, const std::vector<t_aggspec>& aggspecs,
+        const std::vector<t_fterm>& fterms, t_filter_op combiner,
+        const std::map<std::string, std::int32_t>& scales);
+
+    /**
+     * @brief Filter by `fexpr` instead of the terms the context was
+     * constructed with.
+     */
+    void set_filter_expr(const t_fexpr& fexpr);
+
+    /**
+     * @brief Forget every row, as when the table is cleared.
+     */
+    void reset();
+
+    /**
+     * @brief Add every row of `tbl` that is not a delete, each of which is
+     * new to the context.
+     */
+    void update_from_state(const t_data_table& tbl);
+
+    /**
+     * @brief Apply the rows of an update, with their values after it in
+     * `current`, before it in `prev`, and whether they `existed`.
+     */
+    void notify(const t_data_table& flattened, const t_data_table& prev,
+        const t_data_table& current, const t_data_table& transitions,
+        const t_data_table& existed);
+
+    std::vector<std::string> get_column_names() const;
+
+    /**
+     * @brief Returns the total of each aggregate, in the order of
+     * `get_column_names`.
+     */
+    std::vector<t_tscalar> get_values() const;
+
+    /**
+     * @brief Returns the columns the context reads, for the gnode to keep in
+     * its transitional tables.
+     */
+    std::vector<std::string> get_referenced_columns() const;
+
+private:
+    struct t_total {
+        t_total();
+        PSP_NON_COPYABLE(t_total);
+
+        t_aggspec m_spec;
+        t_dtype m_dtype;
+        std::int32_t m_scale;
+
+        // The number of rows, and the sums and number of the values which
+        // are not null or NaN, and the number of NaNs.
+        std::int64_t m_count;
+        std::int64_t m_isum;
+        double m_sum;
+        double m_weights;
+        std::int64_t m_nvalues;
+        std::int64_t m_nans;
+
+        // The bounds of a high or low water mark, which only ever widen.
+        t_tscalar m_bound;
+
+        t_value_multiset m_values;
+    };
+
+    /**
+     * @brief Add row `idx` of `tbl` to each total, or subtract it if
+     * `sign` is negative. A value which `flattened` clears is null.
+     */
+    void apply(const t_data_table& tbl, const t_data_table* flattened, t_uindex idx,
+        std::int64_t sign);
+
+    t_tscalar get_value(const t_total& total) const;
+
+    t_config m_config;
+    std::vector<std::unique_ptr<t_total>> m_totals;
+
+    // The strings of the multisets, which outlive the vocabularies of the
+    // tables they are read from.
+    t_symtable m_symtable;
+};
+
+} // end namespace perspective
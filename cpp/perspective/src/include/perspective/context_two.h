@@ -39,6 +39,12 @@ public:
     std::vector<t_tscalar> get_row_path(t_index idx) const;
     std::vector<t_tscalar> get_row_path(const t_tvnode& node) const;
 
+    /**
+     * @brief Returns the primary keys aggregated by row `idx`, or nothing if
+     * `idx` is not a row.
+     */
+    std::vector<t_tscalar> get_row_pkeys(t_index idx) const;
+
     std::vector<t_tscalar> get_column_path(t_index idx) const;
     std::vector<t_tscalar> get_column_path(const t_tvnode& node) const;
     std::vector<t_tscalar> get_column_path_userspace(t_index idx) const;
@@ -50,8 +56,43 @@ public:
 
     void set_depth(t_header header, t_depth depth);
 
+    /**
+     * @brief Returns the paths of the deepest expanded rows, which
+     * `set_expansion_state` expands again.
+     */
+    std::vector<t_path> get_expansion_state() const;
+
+    /**
+     * @brief Expand the rows of `paths` and their ancestors, as `open` on
+     * each of them would, in one pass over the row traversal.
+     *
+     * @param paths
+     */
+    void set_expansion_state(const std::vector<t_path>& paths);
+
+    /**
+     * @brief Only maintain the cell trees of row depths which are visible,
+     * rebuilding a tree when `open` or `set_depth` first reveals its depth.
+     * Defaults to `PSP_LAZY_AGGREGATES`.
+     */
+    void set_lazy_aggregates(bool enabled);
+    bool get_lazy_aggregates() const;
+
+    /**
+     * @brief Release the cell trees of the row depths which are not
+     * visible, which are maintained lazily from now on, and the cached
+     * paths of the view's columns.
+     */
+    void reclaim();
+
     using t_ctxbase<t_ctx2>::get_data;
 
+    /**
+     * @brief Returns the data version of `t_ctxbase`, which also counts the
+     * changes to the context's traversals.
+     */
+    t_uindex get_data_version() const;
+
 protected:
     std::vector<t_cellinfo> resolve_cells(
         const std::vector<std::pair<t_uindex, t_uindex>>& cells) const;
@@ -67,10 +108,22 @@ protected:
 
     t_index translate_column_index(t_index idx) const;
 
+    /**
+     * @brief Returns the column traversal indices of the view's columns, in
+     * the order of `get_ctraversal_indices`, recomputing them, and dropping
+     * the column paths cached for them, only when the column traversal has
+     * changed since they were last computed.
+     */
+    const std::vector<t_index>& get_column_cache() const;
+
     t_uindex get_num_trees() const;
 
     t_uindex calc_translated_colidx(t_uindex n_aggs, t_uindex cidx) const;
 
+    std::shared_ptr<t_stree> make_tree(t_uindex treeidx) const;
+    void set_lazy_row_depth(t_depth depth);
+    void materialize_tree(t_uindex tree_idx);
+
 private:
     std::shared_ptr<t_traversal> m_rtraversal;
     std::shared_ptr<t_traversal> m_ctraversal;
@@ -82,6 +135,16 @@ private:
     bool m_row_depth_set;
     t_depth m_column_depth;
     bool m_column_depth_set;
+    bool m_lazy_aggregates;
+    std::vector<bool> m_stale_trees;
+
+    // The column traversal indices and lazily-computed paths of the view's
+    // columns, valid while `m_ctraversal` is at `m_column_cache_version`.
+    mutable bool m_column_cache_valid;
+    mutable t_uindex m_column_cache_version;
+    mutable std::vector<t_index> m_ctraversal_indices;
+    mutable std::vector<std::vector<t_tscalar>> m_column_paths;
+    mutable std::vector<bool> m_column_path_cached;
 };
 
 } // end namespace perspective
@@ -17,6 +17,7 @@
 #include <perspective/traversal.h>
 #include <perspective/flat_traversal.h>
 #include <perspective/data_table.h>
+#include <perspective/slice_column.h>
 #include <tsl/hopscotch_set.h>
 
 namespace perspective {
@@ -41,6 +42,61 @@ public:
     void sort_by();
     std::vector<t_sortspec> get_sort_by() const;
 
+    /**
+     * @brief Fully sort only the first `limit` rows when sorting, sorting the
+     * rest in batches as they are read; 0 sorts every row up front.
+     */
+    void set_sort_limit(t_uindex limit);
+    t_uindex get_sort_limit() const;
+
+    /**
+     * @brief Read the vocabulary ids of the string column at `cidx` for rows
+     * `start_row` to `end_row`, the rows `get_data` would read, with -1 for
+     * nulls. Returns the column whose vocabulary the ids index into.
+     */
+    std::shared_ptr<const t_column> get_string_ids(t_index cidx, t_index start_row,
+        t_index end_row, std::vector<std::int32_t>& ids) const;
+
+    /**
+     * @brief Read the column at `cidx` for rows `start_row` to `end_row`, the
+     * rows `get_data` would read, into a `t_slice_column`, or return null if
+     * the column is of a type a `t_slice_column` cannot hold.
+     */
+    std::shared_ptr<t_slice_column> get_column(
+        t_index cidx, t_index start_row, t_index end_row) const;
+
+    /**
+     * @brief Snapshot the columns `start_col` to `end_col` of the master
+     * table, and look up the rows `start_row` to `end_row` in it. This is
+     * the part of `get_data` that reads the traversal and gnode state, and
+     * must not run concurrently with updates; the snapshot can then be read
+     * from while they are processed.
+     */
+    std::shared_ptr<t_ctx_snapshot> get_snapshot(
+        t_index start_row, t_index end_row, t_index start_col, t_index end_col);
+
+    /**
+     * @brief Read the columns `start_col` to `end_col` of the rows in
+     * `snapshot`, as `get_data` does from the gnode state.
+     */
+    std::vector<t_tscalar> get_data(
+        const t_ctx_snapshot& snapshot, t_index start_col, t_index end_col) const;
+
+    /**
+     * @brief As `get_string_ids`, for the rows in `snapshot`. Returns the
+     * snapshot's column.
+     */
+    std::shared_ptr<const t_column> get_string_ids(const t_ctx_snapshot& snapshot,
+        t_index cidx, std::vector<std::int32_t>& ids) const;
+
+    /**
+     * @brief Read the columns `start_col` to `end_col` of the rows in
+     * `snapshot` into a `t_slice_column` each, or return none if any of them
+     * is of a type a `t_slice_column` cannot hold.
+     */
+    std::vector<t_slice_column> get_columns(
+        const t_ctx_snapshot& snapshot, t_index start_col, t_index end_col) const;
+
     using t_ctxbase<t_ctx0>::get_data;
 
 protected:
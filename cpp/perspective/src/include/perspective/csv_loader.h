@@ -0,0 +1,163 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#pragma once
+#include <perspective/first.h>
+#include <perspective/base.h>
+#include <perspective/exports.h>
+#include <perspective/data_table.h>
+#include <perspective/date_parser.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace perspective {
+namespace csv {
+
+    /**
+     * @brief A field of a CSV row, which points into the loaded text.
+     */
+    struct t_csv_field {
+        const char* m_begin;
+        const char* m_end;
+        bool m_quoted;
+    };
+
+    /**
+     * @brief Returns the text of `field`, with doubled quotes unescaped if
+     * it is quoted.
+     */
+    std::string field_to_string(const t_csv_field& field);
+
+    /**
+     * @brief Returns the type of the value in `field`, or `DTYPE_NONE` if it
+     * is empty.
+     */
+    t_dtype infer_field(const t_date_parser& parser, const t_csv_field& field);
+
+    /**
+     * @brief Returns the narrowest type that can hold values of both `a`
+     * and `b`, where `DTYPE_NONE` holds nothing.
+     */
+    t_dtype merge_types(t_dtype a, t_dtype b);
+
+    /**
+     * @brief The layout of the datetimes of a column, detected once from
+     * its first datetime, so that the rest of the column is read at fixed
+     * offsets rather than by probing formats. Values that do not match the
+     * layout are parsed as if no layout had been detected.
+     *
+     * A layout is also a cache of the local time offset of the last hour
+     * read, and so is used by one thread at a time.
+     */
+    struct PERSPECTIVE_EXPORT t_csv_date_layout {
+        t_csv_date_layout();
+
+        bool m_detected;
+
+        // The characters of a value, with `0` for each digit, or empty if
+        // the first datetime does not have a fixed layout.
+        std::string m_template;
+
+        // The offsets of each component, or -1 if it is absent
+        std::int32_t m_year;
+        std::int32_t m_month;
+        std::int32_t m_day;
+        std::int32_t m_hour;
+        std::int32_t m_minute;
+        std::int32_t m_second;
+        std::int32_t m_fraction;
+        std::int32_t m_fraction_end;
+        std::int32_t m_utc_offset;
+        bool m_is_utc;
+
+        // The hour since epoch whose local time offset was last computed
+        std::int64_t m_local_hour;
+        std::int64_t m_local_offset;
+    };
+
+    /**
+     * @brief Write a non-string field into row `ridx` of `col`, or clear
+     * the row if the field is empty or cannot be read as the column's
+     * type. `layout` is the datetime layout of the column.
+     */
+    void fill_value(const t_date_parser& parser, const t_csv_field& field, t_column& col,
+        t_uindex ridx, bool is_update, t_csv_date_layout& layout);
+
+    /**
+     * @brief Loads CSV text with a header row directly into a `t_data_table`.
+     *
+     * Rows are split sequentially, as a quoted field may hold a newline, and
+     * are then parsed in parallel chunks of rows, both to infer the type of
+     * each column and to fill the table. Strings are interned in a final
+     * pass, in parallel across columns, as a vocabulary cannot be written
+     * from several threads.
+     *
+     * Types are inferred from every row: integers, floats, booleans, dates
+     * and datetimes, falling back to strings. Datetimes are read in ISO 8601
+     * or in one of the formats of `t_date_parser`, as local time unless they
+     * end with `Z` or a UTC offset. Empty fields are null.
+     */
+    class PERSPECTIVE_EXPORT CsvLoader {
+    public:
+        CsvLoader();
+        ~CsvLoader();
+
+        /**
+         * @brief Split `data` into rows, and infer the names and types of
+         * its columns. `data` is not copied, and must outlive the loader.
+         *
+         * @param data
+         * @param length
+         * @param delimiter
+         */
+        void initialize(const char* data, std::size_t length, char delimiter = ',');
+
+        void fill_table(
+            t_data_table& tbl,
+            const std::string& index,
+            std::uint32_t offset,
+            std::uint32_t limit,
+            bool is_update);
+
+        std::vector<std::string> names() const;
+        std::vector<t_dtype> types() const;
+        std::uint32_t row_count() const;
+
+    private:
+        /**
+         * @brief Split the row starting at `begin` into `fields`, returning
+         * the end of the row.
+         */
+        const char* split_row(const char* begin, std::vector<t_csv_field>& fields) const;
+
+        /**
+         * @brief Infer the types of the columns over every row, merging the
+         * types inferred for each chunk.
+         */
+        std::vector<t_dtype> infer_types() const;
+
+        /**
+         * @brief Returns the number of chunks that rows are parsed in.
+         */
+        t_uindex num_chunks() const;
+
+        const char* m_data;
+        const char* m_end;
+        char m_delimiter;
+
+        // The start of each row after the header
+        std::vector<const char*> m_rows;
+
+        std::vector<std::string> m_names;
+        std::vector<t_dtype> m_types;
+    };
+
+} // namespace csv
+} // namespace perspective
@@ -0,0 +1,148 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#pragma once
+#include <perspective/first.h>
+#include <perspective/base.h>
+#include <perspective/exports.h>
+#include <perspective/data_table.h>
+#include <perspective/schema.h>
+#include <perspective/table.h>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace perspective {
+
+/**
+ * @brief The shape of the values generated for one column.
+ */
+struct PERSPECTIVE_EXPORT t_generator_column {
+    t_generator_column();
+
+    // The number of distinct values, or 0 for a distinct value per row.
+    t_uindex m_cardinality;
+
+    // The fraction of rows which are null, in `[0, 1]`.
+    double m_null_ratio;
+
+    // The length of each string value.
+    t_uindex m_string_length;
+
+    // The fraction of rows whose value is in key order, in `[0, 1]`; the
+    // rest are uniformly random.
+    double m_sortedness;
+};
+
+/**
+ * @brief The columns and seed of a `t_data_generator`.
+ */
+struct PERSPECTIVE_EXPORT t_generator_spec {
+    t_generator_spec();
+
+    std::uint64_t m_seed;
+
+    // The number of rows that sorted columns, and columns with a distinct
+    // value per row, spread their values over; the number of keys after each
+    // batch's inserts if that is more.
+    t_uindex m_rows;
+
+    // Columns not named here are generated with `m_default`.
+    std::map<std::string, t_generator_column> m_columns;
+    t_generator_column m_default;
+};
+
+/**
+ * @brief Generates `t_data_table`s for scale testing directly, without the
+ * serialization of a binding's input format.
+ *
+ * Rows are identified by an integer key, `0` for the first row inserted,
+ * which is written to the index column. Every value is a hash of the seed,
+ * its column, its row's key and the batch which wrote it, so a generator is
+ * deterministic for a given spec, and values are generated a column per
+ * scheduler worker. Values are written as the dtype of the column they are
+ * generated for, so one spec serves any table schema.
+ *
+ * Updates and deletes pick keys uniformly from those inserted so far,
+ * including keys already deleted, which updates insert again and deletes
+ * ignore.
+ */
+class PERSPECTIVE_EXPORT t_data_generator {
+public:
+    /**
+     * @brief Continue generating after `num_keys` keys have been inserted in
+     * `num_batches` batches.
+     *
+     * @param spec
+     * @param num_keys
+     * @param num_batches
+     */
+    t_data_generator(
+        const t_generator_spec& spec, t_uindex num_keys = 0, t_uindex num_batches = 0);
+
+    /**
+     * @brief Returns a batch of `num_inserts` rows with new keys and
+     * `num_updates` rows with existing keys, interleaved evenly, with the
+     * columns of `schema`. `index` is the column that keys are written to,
+     * or `""` for a batch with no key column, which can only be inserted.
+     *
+     * @param schema
+     * @param index
+     * @param num_inserts
+     * @param num_updates
+     * @return std::shared_ptr<t_data_table>
+     */
+    std::shared_ptr<t_data_table> make_batch(const t_schema& schema, const std::string& index,
+        t_uindex num_inserts, t_uindex num_updates);
+
+    /**
+     * @brief Returns a batch of `num_deletes` existing keys, with the one
+     * column `index` of `schema`.
+     *
+     * @param schema
+     * @param index
+     * @param num_deletes
+     * @return std::shared_ptr<t_data_table>
+     */
+    std::shared_ptr<t_data_table> make_deletes(
+        const t_schema& schema, const std::string& index, t_uindex num_deletes);
+
+    /**
+     * @brief Send a batch of `num_inserts` and `num_updates` rows to `port_id`
+     * of `table`, then a batch of `num_deletes` deletes, as the bindings send
+     * `update` and `remove`. `table` must have been initialized, and must be
+     * indexed to be updated or deleted from. The caller processes the
+     * table's pool.
+     *
+     * @param table
+     * @param num_inserts
+     * @param num_updates
+     * @param num_deletes
+     * @param port_id
+     */
+    void generate(std::shared_ptr<Table> table, t_uindex num_inserts, t_uindex num_updates,
+        t_uindex num_deletes, t_uindex port_id);
+
+    t_uindex get_num_keys() const;
+    t_uindex get_num_batches() const;
+
+private:
+    void fill_column(t_column& column, const std::string& name, bool is_key,
+        const std::vector<t_uindex>& keys, t_uindex batch) const;
+
+    const t_generator_column& get_column_spec(const std::string& name) const;
+
+    t_generator_spec m_spec;
+    t_uindex m_num_keys;
+    t_uindex m_num_batches;
+    t_uindex m_num_values;
+};
+
+} // end namespace perspective
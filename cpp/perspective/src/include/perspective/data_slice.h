@@ -14,6 +14,7 @@
 #include <perspective/raw_types.h>
 #include <perspective/scalar.h>
 #include <perspective/get_data_extents.h>
+#include <perspective/slice_column.h>
 #include <perspective/context_zero.h>
 #include <perspective/context_one.h>
 #include <perspective/context_two.h>
@@ -34,6 +35,8 @@ namespace perspective {
  * - m_column_names: a reference to a vector of string column names from the view.
  * - m_column_indices: an optional reference to a vector of t_uindex column indices, which
  * we use for column-pivoted views.
+ * - m_columns: the slice's columns, when they were read into a `t_slice_column`
+ * each instead of `m_slice`.
  *
  */
 template <typename CTX_T>
@@ -96,6 +99,17 @@ public:
      */
     std::vector<t_tscalar> get_row_path(t_uindex ridx) const;
 
+    /**
+     * @brief Returns the row paths of the rows `start_row` to `end_row` of
+     * the context, read in one pass and encoded against one another, for
+     * serializers which write the path of every row of the slice.
+     *
+     * @param start_row
+     * @param end_row
+     * @return t_row_paths
+     */
+    t_row_paths get_row_paths(t_uindex start_row, t_uindex end_row) const;
+
     std::vector<t_tscalar> get_column_slice(t_uindex cidx) const;
 
     // Getters
@@ -110,6 +124,34 @@ public:
     t_uindex get_col_offset() const;
     bool is_column_only() const;
 
+    /**
+     * @brief Keep `snapshot` alive with the slice, when the slice was read
+     * from it (or its scalars point into it) rather than into the context's
+     * live tables.
+     *
+     * @param snapshot
+     */
+    void set_snapshot(std::shared_ptr<const t_ctx_snapshot> snapshot);
+    std::shared_ptr<const t_ctx_snapshot> get_snapshot() const;
+
+    /**
+     * @brief Hold the slice's data as `columns`, one for each of its columns
+     * from `start_col`, in place of the scalars it was constructed with,
+     * which should be empty.
+     *
+     * @param columns
+     */
+    void set_columns(std::vector<t_slice_column> columns);
+    bool has_columns() const;
+
+    /**
+     * @brief Returns the `t_slice_column` of the column at `cidx`, which must
+     * be in the slice when `has_columns` is true.
+     *
+     * @param cidx
+     */
+    const t_slice_column& get_column(t_uindex cidx) const;
+
 private:
     /**
      * @brief Calculates the index into the underlying data slice for the
@@ -132,5 +174,7 @@ private:
     std::vector<t_tscalar> m_slice;
     std::vector<std::vector<t_tscalar>> m_column_names;
     std::vector<t_uindex> m_column_indices;
+    std::shared_ptr<const t_ctx_snapshot> m_snapshot;
+    std::vector<t_slice_column> m_columns;
 };
 } // end namespace perspective
\ No newline at end of file
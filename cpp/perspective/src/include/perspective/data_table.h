@@ -17,6 +17,7 @@
 #include <perspective/mask.h>
 #include <perspective/filter.h>
 #include <perspective/compat.h>
+#include <perspective/scheduler.h>
 #ifdef PSP_PARALLEL_FOR
 #include <tbb/parallel_sort.h>
 #include <tbb/tbb.h>
@@ -82,6 +83,18 @@ public:
     t_uindex get_capacity() const;
     t_dtype get_dtype(const std::string& colname) const;
 
+    /**
+     * @brief Returns the number of bytes allocated for the values and
+     * statuses of every column.
+     */
+    t_uindex nbytes() const;
+
+    /**
+     * @brief Returns the number of bytes allocated by the vocabularies of
+     * the string columns, counting a vocabulary shared between columns once.
+     */
+    t_uindex vocab_nbytes() const;
+
     std::shared_ptr<t_column> get_column(const std::string& colname);
 
     std::shared_ptr<t_column> get_column_safe(const std::string& colname);
@@ -98,18 +111,52 @@ public:
 
     std::shared_ptr<const t_column> get_const_column_safe(t_uindex idx) const;
 
+    /**
+     * @brief Count the allocations of the table's columns, including those
+     * it makes from now on, under `owner`; see `t_lstore::set_alloc_owner`.
+     *
+     * @param owner
+     */
+    void set_alloc_owner(t_alloc_owner owner);
+    t_alloc_owner get_alloc_owner() const;
+
     // Only increment capacity
     void reserve(t_uindex nelems);
 
+    // Only increment the capacity of `columns`; the table's own capacity is
+    // unchanged, as its other columns may not have it
+    void reserve(t_uindex nelems, const std::vector<std::string>& columns);
+
     // Increment capacity and size
     void extend(t_uindex nelems);
 
     void set_size(t_uindex size);
 
+    // Set the size of the table and of `columns`, whose other columns are
+    // left as they are, i.e. empty if the table was just recycled
+    void set_size(t_uindex size, const std::vector<std::string>& columns);
+
     t_column* _get_column(const std::string& colname);
 
     std::shared_ptr<t_data_table> flatten() const;
 
+    /**
+     * @brief Flatten into `flattened`, an empty table with this table's
+     * columns (and possibly more), reusing its storage.
+     *
+     * @param flattened
+     */
+    void flatten_into(std::shared_ptr<t_data_table> flattened) const;
+
+    /**
+     * @brief Returns whether this table is already flat: every row is an
+     * `OP_INSERT` of a valid primary key, in strictly increasing order, so
+     * that `flatten` would return the same rows in the same order.
+     *
+     * @return bool
+     */
+    bool is_flattened() const;
+
     bool is_pkey_table() const;
     bool is_same_shape(t_data_table& tbl) const;
 
@@ -123,8 +170,21 @@ public:
     void clear();
     void reset();
 
+    /**
+     * @brief Clear the table and the vocabularies its columns own, keeping
+     * their storage so that the table can be refilled without allocating.
+     */
+    void recycle();
+
     t_mask filter_cpp(
         t_filter_op combiner, const std::vector<t_fterm>& fops) const;
+
+    /**
+     * @brief Returns the mask of the rows which pass `fexpr`, evaluating
+     * each of its terms for all rows as `filter_cpp` does, and combining
+     * them group by group.
+     */
+    t_mask filter_expr(const t_fexpr& fexpr) const;
     t_data_table* clone_(const t_mask& mask) const;
     std::shared_ptr<t_data_table> clone(const t_mask& mask) const;
     std::shared_ptr<t_data_table> clone() const;
@@ -139,6 +199,15 @@ public:
     std::shared_ptr<t_data_table> borrow(
         const std::vector<std::string>& columns) const;
 
+    /**
+     * @brief Create a new `t_data_table` of the specified columns, each a
+     * copy-on-write snapshot of the current instance's column (see
+     * `t_column::snapshot`), which can be read while this table is written.
+     *
+     * @return std::shared_ptr<t_data_table>
+     */
+    std::shared_ptr<t_data_table> snapshot(const std::vector<std::string>& columns);
+
     t_column* clone_column(
         const std::string& existing_col, const std::string& new_colname);
 
@@ -179,7 +248,7 @@ public:
      * 
      * @param dropped_columns 
      */
-    void reindex(const std::vector<std::string&> dropped_columns);
+    void reindex(const std::vector<std::string>& dropped_columns);
 
     void verify() const;
     void set_capacity(t_uindex idx);
@@ -194,6 +263,9 @@ protected:
     template <typename FLATTENED_T, typename PKEY_T>
     void flatten_helper_1(FLATTENED_T flattened) const;
 
+    template <typename PKEY_T>
+    bool is_flattened_helper() const;
+
     template <typename DATA_T, typename ROWPACK_VEC_T>
     void flatten_helper_2(ROWPACK_VEC_T& sorted, std::vector<t_flatten_record>& fltrecs,
         const t_column* scol, t_column* dcol) const;
@@ -207,6 +279,7 @@ private:
     t_uindex m_capacity;
     t_backing_store m_backing_store;
     bool m_init;
+    t_alloc_owner m_alloc_owner;
     std::vector<std::shared_ptr<t_column>> m_columns;
 };
 
@@ -252,7 +325,7 @@ t_data_table::flatten_body(FLATTENED_T flattened) const {
             flatten_helper_1<FLATTENED_T, std::uint32_t>(flattened);
         } break;
         case DTYPE_STR: {
-            flatten_helper_1<FLATTENED_T, t_uindex>(flattened);
+            flatten_helper_1<FLATTENED_T, t_stridx>(flattened);
         } break;
         case DTYPE_FLOAT64: {
             flatten_helper_1<FLATTENED_T, double>(flattened);
@@ -301,8 +374,6 @@ t_data_table::flatten_helper_1(FLATTENED_T flattened) const {
 
     t_uindex frags_size = size();
 
-    PSP_VERBOSE_ASSERT(is_same_shape(*flattened), "Misaligned shaped found");
-
     if (frags_size == 0)
         return;
 
@@ -339,8 +410,31 @@ t_data_table::flatten_helper_1(FLATTENED_T flattened) const {
         }
     };
 
-    t_packcomp cmp;
-    std::sort(sorted.begin(), sorted.end(), cmp);
+    // Implicitly indexed tables write increasing primary keys, which wrap
+    // around once past a `limit`; a batch of unique keys in that order is
+    // put in order by rotating it at the wrap rather than sorting it.
+    t_uindex wrap = 0;
+    bool rotated = sorted[0].m_pkey_is_valid;
+    for (t_uindex idx = 1; rotated && idx < frags_size; ++idx) {
+        const auto& prev = sorted[idx - 1];
+        const auto& cur = sorted[idx];
+        if (!cur.m_pkey_is_valid) {
+            rotated = false;
+        } else if (cur.m_pkey < prev.m_pkey && wrap == 0
+            && !(sorted[0].m_pkey < sorted[frags_size - 1].m_pkey)
+            && !(sorted[0].m_pkey == sorted[frags_size - 1].m_pkey)) {
+            wrap = idx;
+        } else if (!(prev.m_pkey < cur.m_pkey)) {
+            rotated = false;
+        }
+    }
+
+    if (rotated) {
+        std::rotate(sorted.begin(), sorted.begin() + wrap, sorted.end());
+    } else {
+        t_packcomp cmp;
+        std::sort(sorted.begin(), sorted.end(), cmp);
+    }
 
     std::vector<t_index> edges;
     edges.push_back(0);
@@ -404,13 +498,8 @@ t_data_table::flatten_helper_1(FLATTENED_T flattened) const {
     flattened->set_size(store_idx);
     t_uindex ndata_cols = d_columns.size();
 
-#ifdef PSP_PARALLEL_FOR
-    tbb::parallel_for(0, int(ndata_cols), 1,
-        [&s_columns, &sorted, &d_columns, &fltrecs, this](int colidx)
-#else
-    for (t_uindex colidx = 0; colidx < ndata_cols; ++colidx)
-#endif
-        {
+    t_scheduler::current().parallel_for(ndata_cols,
+        [&s_columns, &sorted, &d_columns, &fltrecs, this](t_uindex colidx) {
             auto scol = s_columns[colidx];
             auto dcol = d_columns[colidx];
 
@@ -455,35 +544,23 @@ t_data_table::flatten_helper_1(FLATTENED_T flattened) const {
                     this->flatten_helper_2<std::uint32_t, t_rpvec>(sorted, fltrecs, scol, dcol);
                 } break;
                 case DTYPE_STR: {
-                    this->flatten_helper_2<t_uindex, t_rpvec>(sorted, fltrecs, scol, dcol);
+                    this->flatten_helper_2<t_stridx, t_rpvec>(sorted, fltrecs, scol, dcol);
                 } break;
                 case DTYPE_OBJECT: {
                     this->flatten_helper_2<void *, t_rpvec>(sorted, fltrecs, scol, dcol);
                 } break;
                 default: { PSP_COMPLAIN_AND_ABORT("Unsupported column dtype"); }
             }
-        }
-#ifdef PSP_PARALLEL_FOR
-    );
-#endif
+        });
 
-#ifdef PSP_PARALLEL_FOR
-    tbb::parallel_for(0, int(m_schema.get_num_columns()),
-        [&flattened, this](int colidx)
-#else
-    for (t_uindex colidx = 0, loop_end = m_schema.get_num_columns(); colidx < loop_end;
-         ++colidx)
-#endif
-        {
+    t_scheduler::current().parallel_for(m_schema.get_num_columns(),
+        [&flattened, this](t_uindex colidx) {
             const auto& colname = this->m_schema.m_columns[colidx];
             auto col = get_const_column(colname).get();
             if (col->get_dtype() == DTYPE_STR) {
                 flattened->get_column(colname)->copy_vocabulary(col);
             }
-        }
-#ifdef PSP_PARALLEL_FOR
-    );
-#endif
+        });
 
     d_op_col->valid_raw_fill();
 }
@@ -10,6 +10,7 @@
 #pragma once
 #include <memory>
 #include <locale>
+#include <ctime>
 #include <perspective/base.h>
 #include <perspective/first.h>
 #include <perspective/exports.h>
@@ -22,6 +23,17 @@ public:
 
     bool is_valid(std::string const& datestring);
 
+    /**
+     * @brief Parse `datestring` with the first format that accepts it,
+     * setting `has_time` if that format has a time of day.
+     *
+     * @param datestring
+     * @param out
+     * @param has_time
+     * @return bool whether any format accepted `datestring`.
+     */
+    bool parse(std::string const& datestring, std::tm& out, bool& has_time) const;
+
 private:
     static const std::string VALID_FORMATS[12];
 };
@@ -10,7 +10,9 @@
 #pragma once
 #include <perspective/first.h>
 #include <perspective/exports.h>
+#include <perspective/raw_types.h>
 #include <cstdlib>
+#include <string>
 
 namespace perspective {
 
@@ -129,6 +131,45 @@ struct PERSPECTIVE_EXPORT t_env {
         return rv;
     }
 
+    // Count `t_lstore` allocations for `t_alloc_stats` from startup.
+    static inline bool
+    alloc_stats() {
+        static const bool rv = std::getenv("PSP_ALLOC_STATS") != 0;
+        return rv;
+    }
+
+    // Record engine spans for `t_tracer` from startup.
+    static inline bool
+    trace() {
+        static const bool rv = std::getenv("PSP_TRACE") != 0;
+        return rv;
+    }
+
+    // Spans each thread keeps for `t_tracer`, the oldest being overwritten.
+    static inline t_uindex
+    trace_buffer_size() {
+        static const t_uindex rv = std::getenv("PSP_TRACE_BUFFER_SIZE")
+            ? std::strtoull(std::getenv("PSP_TRACE_BUFFER_SIZE"), nullptr, 10)
+            : 65536;
+        return rv;
+    }
+
+    // Sample engine phases for `t_profiler` from startup.
+    static inline bool
+    profile() {
+        static const bool rv = std::getenv("PSP_PROFILE") != 0;
+        return rv;
+    }
+
+    // Microseconds between the samples of `t_profiler`.
+    static inline t_uindex
+    profile_interval_us() {
+        static const t_uindex rv = std::getenv("PSP_PROFILE_INTERVAL_US")
+            ? std::strtoull(std::getenv("PSP_PROFILE_INTERVAL_US"), nullptr, 10)
+            : 1000;
+        return rv;
+    }
+
     static inline bool
     show_svg_browser() {
         static const bool rv = std::getenv("PSP_SHOW_SVG_BROWSER") != 0;
@@ -158,6 +199,160 @@ struct PERSPECTIVE_EXPORT t_env {
         static const bool rv = std::getenv("PSP_BACKOUT_EQ_INVALID_INVALID") != 0;
         return rv;
     }
+
+    static inline bool
+    lazy_aggregates() {
+        static const bool rv = std::getenv("PSP_LAZY_AGGREGATES") != 0;
+        return rv;
+    }
+
+    // Keep a tree of its own for every t_ctx1, rather than sharing one
+    // between contexts with the same pivots, aggregates and filters.
+    static inline bool
+    disable_shared_trees() {
+        static const bool rv = std::getenv("PSP_DISABLE_SHARED_TREES") != 0;
+        return rv;
+    }
+
+    // Trees of unregistered t_ctx1s a gnode keeps up to date, the least
+    // recently shared first dropped, for new contexts building the same tree
+    // to share rather than build; 0 drops a tree with its last context.
+    static inline t_uindex
+    cube_cache_size() {
+        static const t_uindex rv = std::getenv("PSP_CUBE_CACHE_SIZE")
+            ? std::strtoull(std::getenv("PSP_CUBE_CACHE_SIZE"), nullptr, 10)
+            : 4;
+        return rv;
+    }
+
+    // Share of a string column's vocabulary that must be dead before the
+    // gnode state compacts it; 0 disables compaction.
+    static inline double
+    vocab_compaction_ratio() {
+        static const double rv = std::getenv("PSP_VOCAB_COMPACTION_RATIO")
+            ? std::strtod(std::getenv("PSP_VOCAB_COMPACTION_RATIO"), nullptr)
+            : 0.5;
+        return rv;
+    }
+
+    // Share of the master table's rows that must be erased and not reused
+    // before the gnode state moves the live rows together; 0 disables
+    // compaction.
+    static inline double
+    row_compaction_ratio() {
+        static const double rv = std::getenv("PSP_ROW_COMPACTION_RATIO")
+            ? std::strtod(std::getenv("PSP_ROW_COMPACTION_RATIO"), nullptr)
+            : 0.5;
+        return rv;
+    }
+
+    // Share of a tree's aggregate rows that must have been allocated or freed
+    // since its last layout before the tree moves them back into depth
+    // order; 0 disables relayout.
+    static inline double
+    agg_relayout_ratio() {
+        static const double rv = std::getenv("PSP_AGG_RELAYOUT_RATIO")
+            ? std::strtod(std::getenv("PSP_AGG_RELAYOUT_RATIO"), nullptr)
+            : 0.5;
+        return rv;
+    }
+
+    // Keys a gnode state's primary key map must hold before a Bloom filter
+    // of them is probed ahead of it; 0 disables the filter.
+    static inline t_uindex
+    pkey_bloom_filter_min_size() {
+        static const t_uindex rv = std::getenv("PSP_PKEY_BLOOM_FILTER_MIN_SIZE")
+            ? std::strtoull(std::getenv("PSP_PKEY_BLOOM_FILTER_MIN_SIZE"), nullptr, 10)
+            : 1048576;
+        return rv;
+    }
+
+    // Rows a sorted t_ctx0 fully sorts up front, the rest being sorted in
+    // batches as they are read; 0 sorts every row.
+    static inline t_uindex
+    sort_limit() {
+        static const t_uindex rv = std::getenv("PSP_SORT_LIMIT")
+            ? std::strtoull(std::getenv("PSP_SORT_LIMIT"), nullptr, 10)
+            : 0;
+        return rv;
+    }
+
+    // Alignment in bytes of the heap allocations of column stores, which
+    // must be a power of two; 0 uses the allocator's alignment.
+    static inline t_uindex
+    lstore_alignment() {
+        static const t_uindex rv = std::getenv("PSP_LSTORE_ALIGNMENT")
+            ? std::strtoull(std::getenv("PSP_LSTORE_ALIGNMENT"), nullptr, 10)
+            : 64;
+        return rv;
+    }
+
+    // Huge pages for large column stores, as a `t_page_policy`: 0 for none,
+    // 1 for transparent huge pages, 2 for the reserved huge page pool.
+    static inline t_uindex
+    lstore_huge_pages() {
+        static const t_uindex rv = std::getenv("PSP_LSTORE_HUGE_PAGES")
+            ? std::strtoull(std::getenv("PSP_LSTORE_HUGE_PAGES"), nullptr, 10)
+            : 0;
+        return rv;
+    }
+
+    // The `t_allocator` column stores allocate from: `system`, or `arena`
+    // for an arena per gnode.
+    static inline std::string
+    allocator() {
+        static const std::string rv
+            = std::getenv("PSP_ALLOCATOR") ? std::getenv("PSP_ALLOCATOR") : "system";
+        return rv;
+    }
+
+    // Bytes of each chunk a `t_arena_allocator` takes from the system, a
+    // power of two.
+    static inline t_uindex
+    arena_chunk_size() {
+        static const t_uindex rv = std::getenv("PSP_ARENA_CHUNK_SIZE")
+            ? std::strtoull(std::getenv("PSP_ARENA_CHUNK_SIZE"), nullptr, 10)
+            : 256 * 1024;
+        return rv;
+    }
+
+    // Caps the instruction set vectorized kernels run, as a `t_isa` name:
+    // `default`, `avx2` or `avx512`. Unset, the CPU's widest is used.
+    static inline std::string
+    isa() {
+        static const std::string rv = std::getenv("PSP_ISA") ? std::getenv("PSP_ISA") : "";
+        return rv;
+    }
+
+    // Factor by which a column store's capacity at least grows when it
+    // runs out of room.
+    static inline double
+    lstore_growth_factor() {
+        static const double rv = std::getenv("PSP_LSTORE_GROWTH_FACTOR")
+            ? std::strtod(std::getenv("PSP_LSTORE_GROWTH_FACTOR"), nullptr)
+            : 1.5;
+        return rv;
+    }
+
+    // Rows per partition when a pivoted context builds its tree from a whole
+    // table in parallel; 0 builds it in one thread.
+    static inline t_uindex
+    tree_build_partition_rows() {
+        static const t_uindex rv = std::getenv("PSP_TREE_BUILD_PARTITION_ROWS")
+            ? std::strtoull(std::getenv("PSP_TREE_BUILD_PARTITION_ROWS"), nullptr, 10)
+            : 1000000;
+        return rv;
+    }
+
+    // Serialized windows each view keeps to serve repeated requests while
+    // its context is unchanged; 0 disables the cache.
+    static inline t_uindex
+    view_slice_cache_size() {
+        static const t_uindex rv = std::getenv("PSP_VIEW_SLICE_CACHE_SIZE")
+            ? std::strtoull(std::getenv("PSP_VIEW_SLICE_CACHE_SIZE"), nullptr, 10)
+            : 8;
+        return rv;
+    }
 };
 
 } // end namespace perspective
@@ -163,6 +163,53 @@ struct PERSPECTIVE_EXPORT t_fterm {
     bool m_use_interned;
 };
 
+enum t_fexpr_type { FEXPR_TERM, FEXPR_COLUMNS, FEXPR_GROUP };
+
+/**
+ * @brief A node of a filter expression: a `t_fterm` comparing a column to a
+ * value, a comparison of two columns of the same row, or an `and`/`or`
+ * group of other nodes, which may be groups themselves.
+ *
+ * Expressions filter in the same engine as terms, so that comparing two
+ * columns or nesting boolean logic does not need a computed column per
+ * predicate.
+ */
+struct PERSPECTIVE_EXPORT t_fexpr {
+    t_fexpr();
+
+    explicit t_fexpr(const t_fterm& term);
+
+    /**
+     * @brief Construct a comparison of `colname` to `other_colname` by `op`,
+     * which fails rows where either is null.
+     */
+    t_fexpr(const std::string& colname, t_filter_op op, const std::string& other_colname);
+
+    t_fexpr(t_filter_op combiner, const std::vector<t_fexpr>& children);
+
+    /**
+     * @brief Add the columns read by this node and its children to `out`.
+     */
+    void get_columns(std::set<std::string>& out) const;
+
+    /**
+     * @brief Returns the number of terms and column comparisons under this
+     * node.
+     */
+    t_uindex num_terms() const;
+
+    std::string get_expr() const;
+
+    t_fexpr_type m_type;
+
+    // The term of `FEXPR_TERM`, and the column and op of `FEXPR_COLUMNS`.
+    t_fterm m_term;
+    std::string m_other_colname;
+
+    t_filter_op m_combiner;
+    std::vector<t_fexpr> m_children;
+};
+
 class PERSPECTIVE_EXPORT t_filter {
 public:
     t_filter();
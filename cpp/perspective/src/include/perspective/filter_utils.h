@@ -12,6 +12,8 @@
 #include <perspective/config.h>
 #include <perspective/data_table.h>
 #include <perspective/mask.h>
+#include <set>
+#include <string>
 
 namespace perspective {
 
@@ -22,10 +24,46 @@ filter_table_for_config(const t_data_table& tbl, const t_config& config) {
         case FMODE_SIMPLE_CLAUSES: {
             return tbl.filter_cpp(config.get_combiner(), config.get_fterms());
         } break;
+        case FMODE_JIT_EXPR: {
+            return tbl.filter_expr(config.get_filter_expr());
+        } break;
         default: {}
     }
 
     return t_mask(tbl.size());
 }
 
+/**
+ * @brief Returns whether an update changed a column the config's filters
+ * read for any of its rows, as recorded in `transitions`. If not, each row
+ * passes the filters in `curr` exactly as it did in `prev`, so contexts
+ * evaluate them once. Computed columns have no transitions, so filters
+ * which read one are always treated as changed.
+ */
+inline bool
+filter_columns_changed(const t_data_table& transitions, const t_config& config) {
+    std::set<std::string> computed;
+    for (const t_computed_column_definition& definition : config.get_computed_columns()) {
+        computed.insert(std::get<0>(definition));
+    }
+
+    const t_schema& schema = transitions.get_schema();
+    t_uindex nrows = transitions.size();
+    for (const std::string& name : config.get_filter_columns()) {
+        if (computed.count(name) || !schema.has_column(name)) {
+            return true;
+        }
+
+        const std::uint8_t* trans
+            = transitions.get_const_column(name)->get_nth<std::uint8_t>(0);
+        for (t_uindex idx = 0; idx < nrows; ++idx) {
+            if (trans[idx] != VALUE_TRANSITION_EQ_TT && trans[idx] != VALUE_TRANSITION_EQ_FF) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
 } // end namespace perspective
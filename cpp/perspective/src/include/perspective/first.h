@@ -7,7 +7,9 @@
  *
  */
 
-#ifndef PSP_ENABLE_WASM
+// WASM is single-threaded unless it is built with pthreads, which run on
+// Web Workers sharing the module's memory.
+#if !defined(PSP_ENABLE_WASM) || defined(PSP_WASM_PTHREADS)
 #ifndef PSP_PARALLEL_FOR
 #define PSP_PARALLEL_FOR
 #endif
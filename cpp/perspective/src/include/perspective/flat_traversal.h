@@ -21,14 +21,18 @@
 #include <perspective/config.h>
 #include <perspective/exports.h>
 #include <perspective/sym_table.h>
+#include <perspective/sort_arena.h>
+#include <perspective/sorted_index.h>
+#include <perspective/sorted_column_index.h>
 #include <set>
 #include <tsl/hopscotch_map.h>
 
 namespace perspective {
 
 class PERSPECTIVE_EXPORT t_ftrav {
-    typedef tsl::hopscotch_map<t_tscalar, t_uindex> t_pkeyidx_map;
-    typedef tsl::hopscotch_map<t_tscalar, t_mselem> t_pkmselem_map;
+    typedef tsl::hopscotch_map<t_tscalar, const t_sorted_index::t_node*> t_pkeyidx_map;
+    typedef tsl::hopscotch_map<t_tscalar, t_ftelem> t_pkelem_map;
+    typedef tsl::hopscotch_map<t_tscalar, t_uindex> t_pkeypos_map;
 
 public:
     t_ftrav();
@@ -42,22 +46,28 @@ public:
         const std::vector<std::pair<t_uindex, t_uindex>>& cells) const;
 
     std::vector<t_tscalar> get_pkeys() const;
+
+    /**
+     * @brief Returns the primary keys of every row, in no particular order,
+     * without sorting any rows that are not sorted yet.
+     */
+    std::vector<t_tscalar> get_unordered_pkeys() const;
     std::vector<t_tscalar> get_pkeys(t_index begin_row, t_index end_row) const;
     std::vector<t_tscalar> get_pkeys(const std::vector<t_uindex>& rows) const;
 
     t_tscalar get_pkey(t_index idx) const;
 
-    void fill_sort_elem(std::shared_ptr<const t_gstate> gstate, const t_config& config,
-        const std::vector<t_tscalar>& row, t_mselem& out_elem) const;
-
-    void fill_sort_elem(std::shared_ptr<const t_gstate> gstate, const t_config& config,
-        t_tscalar pkey, t_mselem& out_elem);
-
     void sort_by(std::shared_ptr<const t_gstate> gstate, const t_config& config,
         const std::vector<t_sortspec>& sortby);
 
     t_index size() const;
 
+    /**
+     * @brief Returns an estimate of the bytes used by the sorted rows, their
+     * sort values and the indices over them.
+     */
+    t_uindex nbytes() const;
+
     void get_row_indices(const tsl::hopscotch_set<t_tscalar>& pkeys,
         tsl::hopscotch_map<t_tscalar, t_index>& out_map) const;
 
@@ -66,6 +76,18 @@ public:
 
     std::vector<t_uindex> get_row_indices(const tsl::hopscotch_set<t_tscalar>& pkeys) const;
 
+    /**
+     * @brief Returns the rows in [`bidx`, `eidx`) of `pkeys`, in ascending
+     * order, read out of a bitmap of the rows rather than sorted.
+     *
+     * @param bidx
+     * @param eidx
+     * @param pkeys
+     * @return std::vector<t_uindex>
+     */
+    std::vector<t_uindex> get_row_indices(
+        t_index bidx, t_index eidx, const tsl::hopscotch_set<t_tscalar>& pkeys) const;
+
     void reset();
 
     void check_size();
@@ -83,6 +105,20 @@ public:
 
     void delete_row(t_tscalar pkey);
 
+    /**
+     * @brief Add, update or delete a batch of rows, as `add_row`,
+     * `update_row` and `delete_row` do for each row, but reading the sort
+     * values of the rows from `gstate` a sort column at a time. A pkey may
+     * only appear in one of the batches of a step.
+     */
+    void add_rows(std::shared_ptr<const t_gstate> gstate, const t_config& config,
+        const std::vector<t_tscalar>& pkeys);
+
+    void update_rows(std::shared_ptr<const t_gstate> gstate, const t_config& config,
+        const std::vector<t_tscalar>& pkeys);
+
+    void delete_rows(const std::vector<t_tscalar>& pkeys);
+
     std::vector<t_sortspec> get_sort_by() const;
     bool empty_sort_by() const;
 
@@ -93,14 +129,105 @@ public:
 
     t_index get_row_idx(t_tscalar pkey) const;
 
+    /**
+     * @brief Sort only the first `limit` rows when sorting, and the rest in
+     * batches of `limit` as they are read. 0 sorts every row up front. An
+     * existing sorted prefix longer than `limit` is cut back to it.
+     */
+    void set_sort_limit(t_uindex limit);
+    t_uindex get_sort_limit() const;
+
 private:
+    /**
+     * @brief Returns the names of the columns of `config` the rows are
+     * sorted by, one per sort spec.
+     */
+    std::vector<std::string> get_sort_colnames(const t_config& config) const;
+
+    /**
+     * @brief Store the sort values of each of `pkeys` in `m_arena`, reading
+     * them from `gstate` a sort column and a batch of rows at a time, and
+     * append their elements to `out_elems`.
+     */
+    void fill_elems(std::shared_ptr<const t_gstate> gstate, const t_config& config,
+        const std::vector<t_tscalar>& pkeys, std::vector<t_ftelem>& out_elems);
+
+    /**
+     * @brief As `fill_elems`, into `m_new_elems`, releasing the elements of
+     * the rows it already holds.
+     */
+    void fill_new_elems(std::shared_ptr<const t_gstate> gstate, const t_config& config,
+        const std::vector<t_tscalar>& pkeys);
+
+    void clear_new_elems();
+
+    /**
+     * @brief Release the slots of every indexed row, sorted or unsorted.
+     */
+    void release_rows();
+
+    /**
+     * @brief If `m_sorted_index` holds the rows in the order of the sort,
+     * and reading it in O(n) is cheaper than sorting `elems`, reorder
+     * `elems` as it holds them and return true. Returns false, leaving
+     * `elems` as it is, if not, or if some of `elems` are not in it.
+     */
+    bool order_by_sorted_index(std::vector<t_ftelem>& elems) const;
+
+    /**
+     * @brief Rebuild the index from its rows merged with the step's, in
+     * O(n + k log k) for k new or updated rows, rather than inserting each.
+     */
+    void merge_rows();
+
+    /**
+     * @brief Take the rows added during the step out of `m_new_elems` into
+     * `out_elems`, in sort order, if they were added in sort order or in
+     * reverse sort order, as rows appended in time order to a view sorted
+     * by time are. Returns false, leaving `m_new_elems` as it is, if not.
+     */
+    bool take_ordered_appends(std::vector<t_ftelem>& out_elems);
+
+    /**
+     * @brief Add `elems`, in sort order, to the index: to its end or front
+     * without searching for their place if they all sort after or before
+     * its rows, or else one at a time.
+     */
+    void append_rows(const std::vector<t_ftelem>& elems);
+
+    bool is_indexed(t_tscalar pkey) const;
+    void erase_row(t_tscalar pkey);
+    void insert_row(const t_ftelem& elem);
+
+    /**
+     * @brief Extend the sorted prefix of the rows to at least `end_row` rows.
+     */
+    void ensure_sorted(t_uindex end_row) const;
+
     t_index m_step_deletes;
     t_index m_step_inserts;
-    t_pkeyidx_map m_pkeyidx;
-    t_pkmselem_map m_new_elems;
+    mutable t_pkeyidx_map m_pkeyidx;
+    t_pkelem_map m_new_elems;
+    // rows deleted during the current step, removed from the index at
+    // `step_end` so that row indices stay stable until then
+    std::vector<t_tscalar> m_deleted_pkeys;
+    // rows added during the current step, in the order they were added
+    std::vector<t_tscalar> m_appended_pkeys;
     std::vector<t_sortspec> m_sortby;
-    std::shared_ptr<std::vector<t_mselem>> m_index;
+    std::vector<t_sorttype> m_sort_orders;
+    // The sort values of every row, those of `m_new_elems` included.
+    std::shared_ptr<t_sort_arena> m_arena;
+    std::shared_ptr<t_sorted_index> m_index;
+    // The state's index of the column the rows are sorted by, in their
+    // order, if the sort is by one column and the state has one.
+    std::shared_ptr<const t_sorted_column_index> m_sorted_index;
     t_symtable m_symtable;
+    t_uindex m_sort_limit;
+    // With a sort limit, `m_index` holds a sorted prefix of the rows, and
+    // the rows that sort after all of them are kept unsorted here until
+    // they are read. Reads extend the prefix, hence `mutable`.
+    mutable std::vector<t_ftelem> m_unsorted;
+    mutable t_pkeypos_map m_unsorted_pos;
 };
 
 } // end namespace perspective
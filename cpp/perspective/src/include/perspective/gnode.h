@@ -14,6 +14,7 @@
 #include <perspective/schema.h>
 #include <perspective/exports.h>
 #include <perspective/context_handle.h>
+#include <perspective/context_totals.h>
 #include <perspective/pivot.h>
 #include <perspective/env_vars.h>
 #include <perspective/custom_column.h>
@@ -24,9 +25,16 @@
 #include <perspective/computed.h>
 #include <perspective/computed_column_map.h>
 #include <perspective/computed_function.h>
+#include <perspective/update_log.h>
+#include <perspective/latency_histogram.h>
+#include <perspective/scheduler.h>
+#include <perspective/allocator.h>
+#include <list>
+#include <set>
 #include <tsl/ordered_map.h>
 #ifdef PSP_PARALLEL_FOR
 #include <tbb/parallel_sort.h>
+#include <tbb/task_arena.h>
 #include <tbb/tbb.h>
 #endif
 #include <chrono>
@@ -67,6 +75,67 @@ struct PERSPECTIVE_EXPORT t_process_table_result {
     std::shared_ptr<t_data_table> m_flattened_data_table;
     bool m_should_notify_userspace;
 };
+
+/**
+ * @brief A function a `t_gnode` calls with the flattened table of each
+ * update it processes, once the state reflects the update, e.g. to derive
+ * another table from it. It is called on the processing thread, with the
+ * gnode locked.
+ */
+typedef std::function<void(const t_data_table& flattened)> t_update_listener;
+
+/**
+ * @brief The row counts and phase timings of the last update a `t_gnode`
+ * processed, in nanoseconds. A row is added if its primary key was not in
+ * the state, updated if it was, and removed if the update deleted it.
+ */
+struct PERSPECTIVE_EXPORT t_update_stats {
+    t_update_stats();
+
+    t_uindex m_port_id;
+    t_uindex m_rows_in;
+    t_uindex m_rows_flattened;
+
+    // Whether the input was already flat, and used as the flattened table.
+    bool m_flatten_passthrough;
+
+    // Whether every row was new, so was appended without looking it up.
+    bool m_append;
+
+    t_uindex m_rows_added;
+    t_uindex m_rows_updated;
+    t_uindex m_rows_removed;
+
+    // The columns that no context reads, so were not processed into the
+    // transitional tables.
+    t_uindex m_columns_skipped;
+    std::int64_t m_total_ns;
+    std::int64_t m_flatten_ns;
+    std::int64_t m_lookup_ns;
+    std::int64_t m_process_columns_ns;
+    std::int64_t m_computed_columns_ns;
+    std::int64_t m_update_master_table_ns;
+    std::int64_t m_notify_ns;
+    std::vector<std::pair<std::string, std::int64_t>> m_context_notify_ns;
+};
+
+/**
+ * @brief The latencies of the updates of one context, in nanoseconds: how
+ * long it took to notify (`m_notify`), from the end of its notification to
+ * the update delegate's callback (`m_callback_wait`), and from the first
+ * `send` of the update to the callback (`m_end_to_end`). A context sharing
+ * another's tree is notified with it, so records no `m_notify`.
+ */
+struct PERSPECTIVE_EXPORT t_context_latency {
+    t_context_latency();
+
+    t_latency_histogram m_notify;
+    t_latency_histogram m_callback_wait;
+    t_latency_histogram m_end_to_end;
+
+    // When the context was last notified, until its callback; 0 otherwise.
+    std::int64_t m_notified_at;
+};
 class PERSPECTIVE_EXPORT t_gnode {
 public:
     /**
@@ -93,24 +162,291 @@ public:
     void init();
     void reset();
 
+    /**
+     * @brief Write a snapshot of the gnode's state to the existing directory
+     * `dirname`; see `t_gstate::save`.
+     *
+     * @param dirname
+     */
+    void save_snapshot(const std::string& dirname) const;
+
+    /**
+     * @brief Replace the gnode's state with the snapshot in `dirname`. As
+     * contexts are not part of the snapshot, this must be called before any
+     * contexts are registered.
+     *
+     * @param dirname
+     */
+    void load_snapshot(const std::string& dirname);
+
+    /**
+     * @brief Attach the string column `colname` to `vocab`, which it then
+     * shares with the columns of other gnodes; see
+     * `t_gstate::share_vocabulary`. Gnodes sharing a vocabulary must not
+     * process updates concurrently.
+     *
+     * @param colname
+     * @param vocab
+     */
+    void share_vocabulary(const std::string& colname, std::shared_ptr<t_vocab> vocab);
+
+    /**
+     * @brief Index the string column `colname`, so that contexts filtering
+     * it with `==` or `in` read only the rows they match when created; see
+     * `t_gstate::create_index`.
+     *
+     * @param colname
+     */
+    void create_index(const std::string& colname);
+
+    /**
+     * @brief Keep the rows of the state in the order of `colname`, so that
+     * flat contexts sorted by it alone are created without sorting; see
+     * `t_gstate::create_sorted_index`.
+     *
+     * @param colname
+     * @param order
+     */
+    void create_sorted_index(const std::string& colname, t_sorttype order);
+
+    /**
+     * @brief Returns the primary keys of the rows of the state which pass
+     * `fterms` combined by `combiner`; see `t_gstate::get_pkeys_where`.
+     *
+     * @param fterms
+     * @param combiner
+     * @return std::vector<t_tscalar>
+     */
+    std::vector<t_tscalar> get_pkeys_where(
+        const std::vector<t_fterm>& fterms, t_filter_op combiner) const;
+
+    /**
+     * @brief Move the live rows of the state's master table together and
+     * release the rows erased since; see `t_gstate::compact_rows`. The
+     * state is also compacted after each update once
+     * `t_env::row_compaction_ratio()` of a large table's rows are erased.
+     *
+     * @return t_uindex the number of rows released.
+     */
+    t_uindex compact_rows();
+
+    /**
+     * @brief Spill the columns of the state that no context has referenced
+     * for `idle_seconds` to files in `dirname` from now on, releasing their
+     * memory until a context references them again or an update writes to
+     * them; see `t_column::spill`. Cold columns are spilled after each
+     * update and by `spill_cold_columns`. An empty `dirname` reloads every
+     * spilled column and spills no more.
+     *
+     * @param dirname
+     * @param idle_seconds
+     */
+    void set_column_spill(const std::string& dirname, double idle_seconds);
+
+    /**
+     * @brief Reload the spilled columns referenced by a context, and spill
+     * those left cold, as set by `set_column_spill`.
+     *
+     * @return t_uindex the number of columns spilled.
+     */
+    t_uindex spill_cold_columns();
+
+    /**
+     * @brief Pack the integer, bool, date and time columns of the state
+     * whose full-width values have not been accessed for `idle_seconds`
+     * from now on; see `t_column::pack`. Contexts read a packed column's
+     * scalars and aggregate over it in place, and anything else unpacks it
+     * until it is idle again. Cold columns are packed after each update and
+     * by `pack_cold_columns`. Disabling packing unpacks every packed column.
+     *
+     * @param enabled
+     * @param idle_seconds
+     */
+    void set_column_packing(bool enabled, double idle_seconds);
+
+    /**
+     * @brief Pack the columns left cold, as set by `set_column_packing`.
+     *
+     * @return t_uindex the number of columns packed.
+     */
+    t_uindex pack_cold_columns();
+
+    /**
+     * @brief Bound the number of rows the gnode's state holds; see
+     * `t_gstate::set_row_limit`.
+     *
+     * @param row_limit
+     */
+    void set_row_limit(t_uindex row_limit);
+
+    /**
+     * @brief Returns the vocabulary of the string column `colname`, marked
+     * as shared, for other gnodes to `share_vocabulary`.
+     *
+     * @param colname
+     * @return std::shared_ptr<t_vocab>
+     */
+    std::shared_ptr<t_vocab> get_shared_vocabulary(const std::string& colname);
+
+    /**
+     * @brief Append every table sent to an input port to `update_log`, or
+     * stop logging if it is null.
+     *
+     * @param update_log
+     */
+    void set_update_log(std::shared_ptr<t_update_log> update_log);
+    std::shared_ptr<t_update_log> get_update_log() const;
+
     /**
      * @brief Send a t_data_table with a schema that matches the gnode's
-     * input schema to the input port at `port_id`.
+     * input schema to the input port at `port_id`. Sends need not be
+     * serialized with `process`, as they are buffered by the port until
+     * `process` swaps them in.
      * 
      * @param port_id 
      * @param fragments 
      */
     void send(t_uindex port_id, const t_data_table& fragments);
 
+    /**
+     * @brief Send `fragments` to the input port at `port_id`, which takes
+     * it without a copy if the port is empty.
+     *
+     * @param port_id
+     * @param fragments
+     */
+    void send(t_uindex port_id, std::shared_ptr<t_data_table>&& fragments);
+
     /**
      * @brief Given a port_id, call `process_table` on the port's data table,
      * reconciling all queued calls to `update` and `remove` on that port.
      * Returns a boolean indicating whether the update was valid and whether
      * contexts were notified.
+     *
+     * Visible contexts are notified before background contexts. If
+     * `defer_background` is set, only visible contexts are notified, and
+     * background contexts are notified by `notify_background_contexts`,
+     * e.g. once the update delegate has been called for the visible ones.
      * 
      * @param port_id 
+     * @param defer_background
+     */
+    bool process(t_uindex port_id, bool defer_background = false);
+
+    /**
+     * @brief Notify background contexts of the update deferred by
+     * `process`, returning whether there was one. This must be called
+     * before the output ports are cleared.
+     *
+     * @return bool
+     */
+    bool notify_background_contexts();
+
+    /**
+     * @brief Record the latency of the update delegate's callback for the
+     * update last `process`ed, which is about to be called: for the gnode
+     * on its first callback, and for each context notified since its last.
+     * Called by `t_update_task` before `t_pool::notify_userspace`.
      */
-    bool process(t_uindex port_id);
+    void record_callback_latency();
+
+    /**
+     * @brief Set the priority with which the context `name` is notified of
+     * updates. A paused context is not notified, and a context which missed
+     * updates while paused is rebuilt from the gnode's state when it is
+     * resumed, in which case this returns true.
+     *
+     * A context that shares the tree of another is notified through it, so
+     * a tree is notified with the highest priority of the contexts sharing
+     * it.
+     *
+     * @param name
+     * @param priority
+     * @return bool
+     */
+    bool set_context_priority(const std::string& name, t_ctx_priority priority);
+    t_ctx_priority get_context_priority(const std::string& name) const;
+
+    /**
+     * @brief Freeze the context `name`, which is then not notified of
+     * updates and serves the rows and aggregates it held when frozen, and
+     * is taken out of the contexts the gnode visits on each update, unlike
+     * a paused context. A context sharing its tree with another cannot be
+     * detached from it, so is paused instead.
+     *
+     * @param name
+     */
+    void freeze_context(const std::string& name);
+
+    /**
+     * @brief Thaw the frozen context `name`, rebuilding it from the gnode's
+     * state if an update was processed since it was frozen, in which case
+     * this returns true.
+     *
+     * @param name
+     * @return bool
+     */
+    bool thaw_context(const std::string& name);
+    bool is_context_frozen(const std::string& name) const;
+
+    /**
+     * @brief Let the context `name` use up to `nbytes`, after which its
+     * derived state is reclaimed by `reclaim_context` at the end of each
+     * update that leaves it over budget; `0` removes the budget.
+     *
+     * @param name
+     * @param nbytes
+     */
+    void set_context_memory_budget(const std::string& name, t_uindex nbytes);
+    t_uindex get_context_memory_budget(const std::string& name) const;
+
+    /**
+     * @brief Release the state of the context `name` which it can compute
+     * again when it is read: the aggregates of the collapsed subtrees of a
+     * `t_ctx1`, and the cell trees of hidden row depths and cached column
+     * paths of a `t_ctx2`, which are aggregated lazily from then on.
+     * Returns the number of bytes released.
+     *
+     * @param name
+     * @return t_uindex
+     */
+    t_uindex reclaim_context(const std::string& name);
+
+    /**
+     * @brief Release at least `nbytes` of derived state under memory
+     * pressure, or as much as possible if `0`: the cached trees of
+     * unregistered contexts first, then `reclaim_context` of each context,
+     * largest first. Returns the number of bytes released.
+     *
+     * @param nbytes
+     * @return t_uindex
+     */
+    t_uindex reclaim_memory(t_uindex nbytes);
+
+    /**
+     * @brief Read up to `max_rows` more rows of the gnode's state into the
+     * context `name`, registered with `deferred`, returning whether it is
+     * built; `0` reads every remaining row.
+     *
+     * The context is not notified of updates while it is built, as if it
+     * were paused, and serves the aggregates of the rows read so far. If an
+     * update is processed before it is built, the rows it read are out of
+     * date, so the next step rebuilds it from the gnode's state at once.
+     *
+     * @param name
+     * @param max_rows
+     * @return bool
+     */
+    bool build_context(const std::string& name, t_uindex max_rows);
+
+    /**
+     * @brief Returns the fraction of the gnode's rows that `build_context`
+     * has read into the context `name`, which is `1` once it is built.
+     *
+     * @param name
+     * @return double
+     */
+    double get_context_build_progress(const std::string& name) const;
 
     /**
      * @brief Create a new input port, store it in `m_input_ports`, and
@@ -120,6 +456,15 @@ public:
      */
     t_uindex make_input_port();
 
+    /**
+     * @brief Create the input port `port_id` if it does not exist, as for
+     * updates replayed onto the ports they were first sent to. Ports made
+     * later by `make_input_port` are numbered after it.
+     *
+     * @param port_id
+     */
+    void make_input_port(t_uindex port_id);
+
     /**
      * @brief Given a port ID, remove the input port that belongs to that
      * input ID and clean up its associated table.
@@ -128,9 +473,86 @@ public:
      */
     void remove_input_port(t_uindex port_id);
 
-    void _register_context(const std::string& name, t_ctx_type type, std::int64_t ptr);
+    /**
+     * @brief Register the context `ptr` as `name`, building it from the
+     * gnode's state, or, if `deferred`, leaving it to be built in steps by
+     * `build_context`.
+     *
+     * @param name
+     * @param type
+     * @param ptr
+     * @param deferred
+     */
+    void _register_context(
+        const std::string& name, t_ctx_type type, std::int64_t ptr, bool deferred = false);
     void _unregister_context(const std::string& name);
 
+    /**
+     * @brief Returns a registered `t_ctx1` which builds the same tree as
+     * `ctx` and owns it, for `ctx` to share, or null if there is none.
+     */
+    t_ctx1* _find_tree_leader(const t_ctx1* ctx) const;
+
+    /**
+     * @brief Keep the tree of `ctx`, which is being unregistered and shares
+     * it with no other context, in a hidden `t_ctx1` that is notified like any
+     * other until `t_env::cube_cache_size` more recently shared trees
+     * replace it.
+     *
+     * @param ctx
+     */
+    void _retain_cube(t_ctx1* ctx);
+
+    /**
+     * @brief Mark the retained tree of `cube`, if it is one, as the most
+     * recently shared.
+     *
+     * @param cube
+     */
+    void _touch_cube(const t_ctx1* cube);
+
+    /**
+     * @brief Unregister the least recently shared retained trees until at
+     * most `size` remain.
+     *
+     * @param size
+     */
+    void _evict_cubes(t_uindex size);
+
+    /**
+     * @brief Returns the bytes used by the context of `ctxh`, the sum of
+     * its `get_memory_usage`.
+     */
+    t_uindex _get_context_nbytes(const t_ctx_handle& ctxh) const;
+    t_uindex _get_contexts_nbytes() const;
+
+    /**
+     * @brief Reclaim each context whose memory budget the last update left
+     * it over.
+     */
+    void _enforce_memory_budgets();
+    bool _is_cube(const std::string& name) const;
+
+    /**
+     * @brief Returns the rows of the state a new context of `type` at `ptr`
+     * is built from: those its filters match on indexed columns, or every
+     * row.
+     */
+    std::shared_ptr<t_data_table> _get_context_rows(t_ctx_type type, void* ptr);
+
+    /**
+     * @brief Returns the names of every column read by a registered
+     * context, through its columns, aggregates, pivots, sorts or filters.
+     */
+    std::set<std::string> _get_referenced_columns() const;
+
+    /**
+     * @brief Rebuild the computed column expressions after the registered
+     * contexts change, so that only the computed columns they read are
+     * materialized.
+     */
+    void _update_computed_expressions();
+
     const t_data_table* get_table() const;
     t_data_table* get_table();
 
@@ -145,6 +567,48 @@ public:
     t_uindex num_input_ports() const;
     t_uindex num_output_ports() const;
 
+    /**
+     * @brief Returns the bytes used by the master table's columns
+     * (`"table"`), its vocabularies (`"vocabularies"`), the primary key map
+     * (`"primary_keys"`), the column indexes and zone maps (`"indexes"`), the tables
+     * queued on the input ports
+     * (`"input_ports"`) and the transitional tables of the last update
+     * (`"output_ports"`). Contexts are accounted separately.
+     */
+    std::map<std::string, t_uindex> get_memory_usage() const;
+
+    /**
+     * @brief Returns the `t_update_stats` of the last update `process`ed,
+     * as `"port_id"`, `"rows_in"`, `"rows_flattened"`, `"rows_added"`,
+     * `"rows_updated"`, `"rows_removed"` and the nanoseconds spent in each
+     * phase, e.g. `"flatten_ns"`, and in notifying each context, keyed
+     * `"context_notify_ns.<name>"`. A deferred background notify is
+     * included once it has run. Empty before the first update.
+     */
+    std::map<std::string, double> get_update_stats() const;
+
+    /**
+     * @brief Returns the latency histograms of the updates processed since
+     * the last `reset_latency_stats`, keyed `"<histogram>.<stat>"`; see
+     * `t_latency_histogram::write_stats`. The histograms are `"send_wait"`,
+     * from the first `send` of an update to its `process`; `"process"`, the
+     * duration of `process`; `"callback_wait"`, from the end of `process`
+     * to the update delegate's first callback; and `"end_to_end"`, from the
+     * first `send` to that callback.
+     */
+    std::map<std::string, double> get_latency_stats() const;
+    void reset_latency_stats();
+
+    /**
+     * @brief Returns the `t_context_latency` histograms of the context
+     * `name` as `"notify"`, `"callback_wait"` and `"end_to_end"`, keyed as
+     * by `get_latency_stats`.
+     *
+     * @param name
+     */
+    std::map<std::string, double> get_context_latency_stats(const std::string& name) const;
+    void reset_context_latency_stats(const std::string& name);
+
     std::vector<t_pivot> get_pivots() const;
     std::vector<t_stree*> get_trees();
 
@@ -167,6 +631,40 @@ public:
     bool has_pkey(t_tscalar pkey) const;
 
     std::vector<t_tscalar> get_row_data_pkeys(const std::vector<t_tscalar>& pkeys) const;
+
+    /**
+     * @brief Read the values of `colname` in the state for `pkeys`, with
+     * none for keys that are not in the state.
+     */
+    void read_column(const std::string& colname, const std::vector<t_tscalar>& pkeys,
+        std::vector<t_tscalar>& out_data) const;
+
+    /**
+     * @brief Write the values with `pkeys` from the column `colname` of the
+     * state into rows `[0, pkeys.size())` of `dest`, as `t_gstate::copy_column`.
+     */
+    void copy_column(const std::string& colname, const std::vector<t_tscalar>& pkeys,
+        t_column& dest) const;
+
+    /**
+     * @brief Call `listener` after each update from now on, returning an id
+     * for `remove_update_listener`.
+     *
+     * @param listener
+     * @return t_uindex
+     */
+    t_uindex add_update_listener(t_update_listener listener);
+    void remove_update_listener(t_uindex id);
+
+    /**
+     * @brief Register a totals context under `name`, adding the rows of the
+     * table to it, and notify it of each update from now on.
+     *
+     * @param name
+     * @param totals
+     */
+    void register_totals(const std::string& name, std::shared_ptr<t_ctx_totals> totals);
+    void unregister_totals(const std::string& name);
     std::vector<t_tscalar> has_pkeys(const std::vector<t_tscalar>& pkeys) const;
     std::vector<t_tscalar> get_pkeys() const;
 
@@ -178,6 +676,50 @@ public:
 
     t_uindex mapping_size() const;
 
+    /**
+     * @brief Set the maximum number of threads used to process the columns
+     * of each update in `_process_table`. Columns write into disjoint
+     * transitional columns, so they can be processed independently.
+     *
+     * `0` allows as many threads as the gnode's `t_scheduler`, and `1`
+     * processes columns serially on the calling thread.
+     *
+     * @param num_threads
+     */
+    void set_num_threads(t_uindex num_threads);
+    t_uindex get_num_threads() const;
+
+    /**
+     * @brief Set the scheduler that runs the gnode's parallel work, which
+     * is `t_scheduler::get_default()` until the gnode is registered with a
+     * `t_pool`.
+     *
+     * @param scheduler
+     */
+    void set_scheduler(std::shared_ptr<t_scheduler> scheduler);
+    std::shared_ptr<t_scheduler> get_scheduler() const;
+
+    /**
+     * @brief Returns the allocator the gnode's tables allocate from, an
+     * arena of its own under `PSP_ALLOCATOR=arena`. Stores initialized by
+     * worker threads of a parallel update allocate from the default.
+     */
+    std::shared_ptr<t_allocator> get_allocator() const;
+
+    /**
+     * @brief Set the maximum number of threads used to notify registered
+     * contexts of each update in `notify_contexts`. Contexts only read the
+     * shared flattened, delta, prev, current and transitions tables and
+     * write to their own trees, so they can be notified independently.
+     *
+     * `0` allows as many threads as the gnode's `t_scheduler`, and `1`
+     * notifies contexts serially on the calling thread.
+     *
+     * @param notify_threads
+     */
+    void set_notify_threads(t_uindex notify_threads);
+    t_uindex get_notify_threads() const;
+
     // helper function for JS interface
     void promote_column(const std::string& name, t_dtype new_type);
 
@@ -226,8 +768,56 @@ protected:
     void set_ctx_state(void* ptr);
 
     bool have_context(const std::string& name) const;
+
+    /**
+     * @brief Notify every context that is not paused of an update.
+     *
+     * @param flattened
+     */
     void notify_contexts(const t_data_table& flattened);
 
+    /**
+     * @brief Notify the contexts of `priority` of an update, returning
+     * whether there were any.
+     *
+     * @param flattened
+     * @param priority
+     * @return bool
+     */
+    bool notify_contexts(const t_data_table& flattened, t_ctx_priority priority);
+
+    /**
+     * @brief Returns the priority with which `ctxh` is notified, which for a
+     * context owning a shared tree is the highest of the contexts sharing
+     * it, and is paused while it is being built by `build_context`.
+     */
+    t_ctx_priority _get_effective_priority(const t_ctx_handle& ctxh) const;
+
+    /**
+     * @brief Compact the rows and vocabularies of the state, once every
+     * context has read the transitional tables of the last update.
+     */
+    void _compact_state();
+
+    /**
+     * @brief Mark the contexts that `notify_contexts` skips as paused as
+     * having missed an update.
+     */
+    void _mark_paused_contexts_stale();
+
+    /**
+     * @brief Rebuild the contexts which missed updates while paused and are
+     * no longer paused, returning the rebuilt contexts.
+     */
+    std::set<void*> _refresh_stale_contexts();
+
+    /**
+     * @brief The columns of the output schema that the contexts which are
+     * not paused read from the transitional tables, or which the computed
+     * columns processed into them read, so that the others can be skipped.
+     */
+    std::set<std::string> _get_transitional_columns() const;
+
     template <typename CTX_T>
     void notify_context(const t_data_table& flattened, const t_ctx_handle& ctxh);
 
@@ -246,6 +836,14 @@ protected:
      */
     t_mask _process_mask_existed_rows(t_process_state& process_state);
 
+    /**
+     * @brief `_process_mask_existed_rows` for a `flattened` of only new rows,
+     * which are all kept and none of which existed.
+     *
+     * @param process_state
+     */
+    t_mask _process_mask_appended_rows(t_process_state& process_state);
+
     /**
      * @brief Given a flattened column, the master column from `m_gstate`, and
      * all transitional columns containing metadata, process and calculate
@@ -266,7 +864,8 @@ protected:
 
     /**
      * @brief Calculate the transition state for a single cell, which depends
-     * on whether the cell is/was valid, existed, or is new.
+     * on whether the cell is/was valid, existed, or is new. Called for every
+     * cell of an update, so it is defined inline.
      * 
      * @param prev_existed 
      * @param row_pre_existed 
@@ -280,9 +879,28 @@ protected:
     t_value_transition calc_transition(bool prev_existed, bool row_pre_existed, bool exists,
         bool prev_valid, bool cur_valid, bool prev_cur_eq, bool prev_pkey_eq);
 
+    /**
+     * @brief `_process_column` for a `flattened` of only new rows, whose
+     * transitional values depend only on whether each cell is valid.
+     *
+     * @tparam DATA_T
+     * @param fcolumn
+     * @param dcolumn
+     * @param pcolumn
+     * @param ccolumn
+     * @param tcolumn
+     */
+    template <typename DATA_T>
+    void _process_appended_column(const t_column* fcolumn, t_column* dcolumn, t_column* pcolumn,
+        t_column* ccolumn, t_column* tcolumn);
+
     /**
      * @brief For all valid computed columns registered with the gnode,
-     * the master `m_table` of `m_state`.
+     * recompute their values on `flattened`, using the master `m_table` of
+     * `m_state` for values the update does not set. When every row already
+     * exists, only the computed columns that read a column set by the
+     * update (directly or through other computed columns) are recomputed,
+     * and the rest are left unset.
      * 
      * @param tbl 
      * @param flattened 
@@ -294,14 +912,57 @@ protected:
         std::shared_ptr<t_data_table> flattened,
         const std::vector<t_rlookup>& changed_rows);
 
+    /**
+     * @brief Run `task` for every index in `[0, num_tasks)`, in parallel on
+     * the gnode's scheduler when it is enabled.
+     *
+     * @param num_tasks
+     * @param task
+     */
+    void _run_tasks(t_uindex num_tasks, const std::function<void(t_uindex)>& task) const;
+
+    /**
+     * @brief Whether an update set any value of `column`, i.e. whether any
+     * of its statuses is not `STATUS_INVALID`.
+     *
+     * @param column
+     * @return bool
+     */
+    bool _is_column_updated(const t_column& column) const;
+
     /**
      * @brief For each `t_data_table` in tables, apply computations for each
-     * computed column registered with the gnode.
+     * computed column registered with the gnode, or only those in
+     * `only_columns` if it is set. Columns that do not read each other are
+     * computed in parallel, across all of `tables`.
      * 
      * @param table 
+     * @param only_columns
      */
     void _compute_all_columns(
-        std::vector<std::shared_ptr<t_data_table>> tables);
+        std::vector<std::shared_ptr<t_data_table>> tables,
+        const std::set<std::string>* only_columns = nullptr);
+
+    /**
+     * @brief Track the computed columns of a newly registered context, and
+     * compute them on `flattened` if it is set. Only the stale columns are
+     * computed on the master table, so columns that other contexts already
+     * declare are not computed again.
+     *
+     * @param computed_columns
+     * @param flattened
+     */
+    void _register_computed_columns(
+        const std::vector<t_computed_column_definition>& computed_columns,
+        std::shared_ptr<t_data_table> flattened);
+
+    /**
+     * @brief Remove the columns `names` from the master table and the
+     * output port tables, once no context declares them.
+     *
+     * @param names
+     */
+    void _drop_computed_columns(const std::vector<std::string>& names);
 
     /**
      * @brief Add all valid computed columns to `table` with the specified
@@ -358,6 +1019,68 @@ private:
      */
     t_process_table_result _process_table(t_uindex port_id);
 
+    /**
+     * @brief Log `fragments` before it is sent to `port_id`, returning
+     * whether the port exists.
+     *
+     * @param port_id
+     * @param fragments
+     * @return bool
+     */
+    bool _begin_send(t_uindex port_id, const t_data_table& fragments);
+
+    /**
+     * @brief Call each update listener with the flattened table of the
+     * update just processed.
+     */
+    void _notify_update_listeners(const t_data_table& flattened);
+    void _notify_totals(const t_data_table& flattened);
+
+    /**
+     * @brief Return an empty table to flatten `tbl` into: the previous
+     * update's flattened table once nothing but the flattened port holds
+     * it and its columns still match, or a new table otherwise.
+     *
+     * @param tbl
+     * @return std::shared_ptr<t_data_table>
+     */
+    std::shared_ptr<t_data_table> _get_flattened_table(const t_data_table& tbl);
+
+    /**
+     * @brief Whether `tbl` has exactly the columns of `schema` followed by
+     * the computed columns currently registered on the gnode, so that it can
+     * be cleared and refilled in place.
+     *
+     * @param tbl
+     * @param schema
+     * @return bool
+     */
+    bool _is_recyclable(const t_data_table& tbl, const t_schema& schema) const;
+
+    /**
+     * @brief Whether every row of `flattened`, which `is_flattened`, is new:
+     * its keys are in increasing order, so it is, if its first key is greater
+     * than any key in the state.
+     *
+     * @param flattened
+     * @return bool
+     */
+    bool _is_append(const t_data_table& flattened) const;
+
+    /**
+     * @brief Raise `m_max_pkey` to the greatest key in `flattened`, which
+     * is sorted by key.
+     *
+     * @param flattened
+     */
+    void _update_max_pkey(const t_data_table& flattened);
+
+    /**
+     * @brief Set `m_max_pkey` to the greatest key in the state's master
+     * table, including its freed rows.
+     */
+    void _reset_max_pkey();
+
     t_gnode_processing_mode m_mode;
     t_gnode_type m_gnode_type;
 
@@ -385,11 +1108,80 @@ private:
     // `t_gnode_port` enum.
     std::vector<std::shared_ptr<t_port>> m_oports;
     std::map<std::string, t_ctx_handle> m_contexts;
+
+    // The contexts frozen by `freeze_context` which do not share a tree,
+    // out of `m_contexts` until thawed, and the number of updates
+    // processed, to tell whether they missed any.
+    std::map<std::string, t_ctx_handle> m_frozen_contexts;
+    t_uindex m_num_processed;
+
+    // Set by `set_column_spill`, and when each column of the state was
+    // last referenced by a context or reloaded, in `t_tracer::now()` ns.
+    std::string m_spill_dirname;
+    std::int64_t m_spill_idle_ns;
+    std::map<std::string, std::int64_t> m_column_used_at;
+    std::set<std::string> m_spilled_columns;
+
+    // Set by `set_column_packing`, and when each column of the state was
+    // last found unpacked, or failed to pack, in `t_tracer::now()` ns.
+    bool m_pack_enabled;
+    std::int64_t m_pack_idle_ns;
+    std::map<std::string, std::int64_t> m_column_unpacked_at;
+    std::set<std::string> m_packed_columns;
     std::shared_ptr<t_gstate> m_gstate;
     std::chrono::high_resolution_clock::time_point m_epoch;
     std::vector<t_custom_column> m_custom_columns;
     std::function<void()> m_pool_cleanup;
     bool m_was_updated;
+
+    std::shared_ptr<t_scheduler> m_scheduler;
+
+    // The allocator of the stores the gnode, its ports and its contexts
+    // initialize while it is processing.
+    std::shared_ptr<t_allocator> m_allocator;
+
+    // The flattened table of the last update, while its background contexts
+    // are yet to be notified.
+    std::shared_ptr<t_data_table> m_background_flattened;
+
+    // A key at least as great as any in the state, unless keys are strings,
+    // which are not ordered by value.
+    t_tscalar m_max_pkey;
+
+    bool m_has_update_stats;
+    t_update_stats m_update_stats;
+
+    // When the update last processed was first sent and finished
+    // processing, and whether its callback is yet to be recorded.
+    std::int64_t m_sent_at;
+    std::int64_t m_processed_at;
+    bool m_awaiting_callback;
+
+    t_latency_histogram m_send_wait_latency;
+    t_latency_histogram m_process_latency;
+    t_latency_histogram m_callback_wait_latency;
+    t_latency_histogram m_end_to_end_latency;
+    std::map<std::string, std::shared_ptr<t_context_latency>> m_context_latency;
+
+    // Maximum concurrency for per-column processing, where 0 is automatic.
+    t_uindex m_num_threads;
+
+    // Maximum concurrency for context notification, where 0 is automatic.
+    t_uindex m_notify_threads;
+
+    // Logs the tables sent to the input ports, if set.
+    std::shared_ptr<t_update_log> m_update_log;
+
+    // The hidden contexts holding the trees of unregistered t_ctx1s, by
+    // their name in `m_contexts`, the most recently shared first.
+    std::list<std::pair<std::string, std::shared_ptr<t_ctx1>>> m_cubes;
+    t_uindex m_last_cube_id;
+
+    std::map<t_uindex, t_update_listener> m_update_listeners;
+    t_uindex m_last_listener_id;
+
+    // The totals contexts, which are notified with the visible contexts.
+    std::map<std::string, std::shared_ptr<t_ctx_totals>> m_totals;
 };
 
 /**
@@ -464,16 +1256,8 @@ t_gnode::update_context_from_state(
     if (flattened->size() == 0)
         return;
 
-    // Flattened won't have the computed columns if it didn't pass through the
-    // main body of `process_table`, i.e. creating a 1/2 sided context, so
-    // compute again here.
-    auto computed_columns = m_computed_column_map.m_computed_columns;
-
-    if (computed_columns.size() > 0) {
-        for (const auto& computed : computed_columns) {
-            _compute_column(computed.second, flattened);
-        }
-    }
+    // Computed columns are computed on `flattened` by the caller, once for
+    // all contexts.
 
     // Need to cast shared ptr to a const reference before passing to notify,
     // reference is valid as `notify` is not async
@@ -485,6 +1269,85 @@ t_gnode::update_context_from_state(
     ctx->step_end();
 }
 
+inline t_value_transition
+t_gnode::calc_transition(
+    bool prev_existed,
+    bool row_pre_existed,
+    bool exists,
+    bool prev_valid,
+    bool cur_valid,
+    bool prev_cur_eq,
+    bool prev_pkey_eq) {
+    t_value_transition trans = VALUE_TRANSITION_EQ_FF;
+
+    if (!row_pre_existed && !cur_valid && !t_env::backout_invalid_neq_ft()) {
+        trans = VALUE_TRANSITION_NEQ_FT;
+    } else if (row_pre_existed && !prev_valid && !cur_valid
+        && !t_env::backout_eq_invalid_invalid()) {
+        trans = VALUE_TRANSITION_EQ_TT;
+    } else if (!prev_existed && !exists) {
+        trans = VALUE_TRANSITION_EQ_FF;
+    } else if (row_pre_existed && exists && !prev_valid && cur_valid
+        && !t_env::backout_nveq_ft()) {
+        trans = VALUE_TRANSITION_NVEQ_FT;
+    } else if (prev_existed && exists && prev_cur_eq) {
+        trans = VALUE_TRANSITION_EQ_TT;
+    } else if (!prev_existed && exists) {
+        trans = VALUE_TRANSITION_NEQ_FT;
+    } else if (prev_existed && !exists) {
+        trans = VALUE_TRANSITION_NEQ_TF;
+    } else if (prev_existed && exists && !prev_cur_eq) {
+        trans = VALUE_TRANSITION_NEQ_TT;
+    } else if (prev_pkey_eq) {
+        // prev op must have been a delete
+        trans = VALUE_TRANSITION_NEQ_TDT;
+    } else {
+        PSP_COMPLAIN_AND_ABORT("Hit unexpected condition");
+    }
+    return trans;
+}
+
+template <typename DATA_T>
+void
+t_gnode::_process_appended_column(const t_column* fcolumn, t_column* dcolumn,
+    t_column* pcolumn, t_column* ccolumn, t_column* tcolumn) {
+    // As `calc_transition` for a row that did not exist.
+    std::uint8_t invalid_trans
+        = t_env::backout_invalid_neq_ft() ? VALUE_TRANSITION_EQ_FF : VALUE_TRANSITION_NEQ_FT;
+    bool is_object = dcolumn->get_dtype() == DTYPE_OBJECT;
+
+    DATA_T zero;
+    memset(&zero, 0, sizeof(DATA_T));
+
+    for (t_uindex idx = 0, loop_end = fcolumn->size(); idx < loop_end; ++idx) {
+        DATA_T cur_value = *(fcolumn->get_nth<DATA_T>(idx));
+        bool cur_valid = fcolumn->is_valid(idx);
+
+        dcolumn->set_nth<DATA_T>(idx, cur_valid && !is_object ? cur_value : DATA_T(0));
+        dcolumn->set_valid(idx, true);
+
+        pcolumn->set_nth<DATA_T>(idx, zero);
+        pcolumn->set_valid(idx, false);
+
+        ccolumn->set_nth<DATA_T>(idx, cur_valid ? cur_value : zero);
+        ccolumn->set_valid(idx, cur_valid);
+
+        tcolumn->set_nth<std::uint8_t>(
+            idx, cur_valid ? std::uint8_t(VALUE_TRANSITION_NEQ_FT) : invalid_trans);
+
+        // As in `_process_column`, a value equal to the zeroed previous
+        // value releases the reference `fill` took.
+        if (is_object && cur_valid && cur_value == zero) {
+            fcolumn->notify_object_cleared(idx);
+        }
+    }
+}
+
+template <>
+void
+t_gnode::_process_appended_column<std::string>(const t_column* fcolumn, t_column* dcolumn,
+    t_column* pcolumn, t_column* ccolumn, t_column* tcolumn);
+
 template <>
 void
 t_gnode::_process_column<std::string>(
@@ -506,6 +1369,10 @@ t_gnode::_process_column(
     t_column* ccolumn,
     t_column* tcolumn,
     const t_process_state& process_state) {
+    // The storage type is fixed by `DATA_T`, so the only per-cell branches
+    // are on the op and validity of each cell.
+    bool is_object = dcolumn->get_dtype() == DTYPE_OBJECT;
+
     for (t_uindex idx = 0, loop_end = fcolumn->size(); idx < loop_end; ++idx) {
         std::uint8_t op_ = process_state.m_op_base[idx];
         t_op op = static_cast<t_op>(op_);
@@ -538,7 +1405,7 @@ t_gnode::_process_column(
                 auto trans = calc_transition(prev_existed, row_pre_existed, exists, prev_valid,
                     cur_valid, prev_cur_eq, prev_pkey_eq);
 
-                if (dcolumn->get_dtype() == DTYPE_OBJECT){
+                if (is_object) {
                     // unsigned types, dates, etc don't make sense
                     // TODO remove dcolumn?
                     dcolumn->set_nth<DATA_T>(
@@ -560,7 +1427,7 @@ t_gnode::_process_column(
                 // if object type and its a duplicate, decrement
                 // the ref count to account for the increment in
                 // fill.cpp
-                if(ccolumn->get_dtype() == DTYPE_OBJECT) {
+                if (is_object) {
                     if (cur_valid && prev_cur_eq) {
                         fcolumn->notify_object_cleared(idx);
                     }
@@ -581,7 +1448,7 @@ t_gnode::_process_column(
                     ccolumn->set_nth<DATA_T>(added_count, prev_value);
                     ccolumn->set_valid(added_count, prev_valid);
 
-                    if(ccolumn->get_dtype() == DTYPE_OBJECT) {
+                    if (is_object) {
                         if (prev_valid)
                             pcolumn->notify_object_cleared(added_count);
                     }
@@ -15,8 +15,15 @@
 #include <tsl/hopscotch_map.h>
 #include <tsl/hopscotch_set.h>
 #include <perspective/mask.h>
-#include <perspective/sym_table.h>
+#include <perspective/min_max.h>
+#include <perspective/histogram.h>
+#include <perspective/pkey_mapping.h>
 #include <perspective/rlookup.h>
+#include <perspective/slice_column.h>
+#include <perspective/column_index.h>
+#include <perspective/sorted_column_index.h>
+#include <perspective/zone_map.h>
+#include <perspective/config.h>
 
 namespace perspective {
 
@@ -24,9 +31,10 @@ std::pair<t_tscalar, t_tscalar> get_vec_min_max(const std::vector<t_tscalar>& ve
 
 class PERSPECTIVE_EXPORT t_gstate {
     /**
-     * @brief A mapping of `t_tscalar` primary keys to `t_uindex` row indices.
+     * @brief A mapping of `t_tscalar` primary keys to `t_uindex` row indices,
+     * specialized on the dtype of the `psp_pkey` column.
      */
-    typedef tsl::hopscotch_map<t_tscalar, t_uindex> t_mapping;
+    typedef t_pkey_mapping t_mapping;
 
     typedef tsl::hopscotch_set<t_uindex> t_free_items;
 
@@ -109,6 +117,31 @@ public:
     void read_column(const std::string& colname, const std::vector<t_tscalar>& pkeys,
         std::vector<double>& out_data, bool include_nones) const;
 
+    /**
+     * @brief Read the values with `pkeys` from the column `colname` into
+     * `out_data` as a typed buffer, with strings by vocabulary id and nulls
+     * for keys that are not in the state, rather than as a `t_tscalar` each.
+     * The column must be of a type `t_slice_column::is_supported`.
+     *
+     * @param colname
+     * @param pkeys
+     * @param out_data
+     */
+    void read_column(const std::string& colname, const std::vector<t_tscalar>& pkeys,
+        t_slice_column& out_data) const;
+
+    /**
+     * @brief Write the values with `pkeys` from the column `colname` into rows
+     * `[0, pkeys.size())` of `dest`, a column of the same dtype, through a
+     * `t_slice_column` if its type allows and through scalars otherwise.
+     *
+     * @param colname
+     * @param pkeys
+     * @param dest
+     */
+    void copy_column(const std::string& colname, const std::vector<t_tscalar>& pkeys,
+        t_column& dest) const;
+
     /**
      * @brief Apply the lambda `fn` to each primary-keyed value in the column,
      * stopping when the lambda returns `true`.
@@ -123,6 +156,30 @@ public:
     bool apply(const std::vector<t_tscalar>& pkeys, const std::string& colname,
         t_tscalar& value, std::function<bool(const t_tscalar&, t_tscalar&)> fn) const;
 
+    /**
+     * @brief Returns the min and max of the valid values in `colname` for
+     * the rows at `pkeys`, read directly from the column's typed buffer.
+     * 
+     * @param pkeys 
+     * @param colname 
+     * @return t_minmax 
+     */
+    t_minmax get_min_max(
+        const std::vector<t_tscalar>& pkeys, const std::string& colname) const;
+
+    /**
+     * @brief Bin the valid values in `colname` for the rows at `pkeys`, read
+     * directly from the column's typed buffer.
+     * 
+     * @param pkeys 
+     * @param colname 
+     * @param nbuckets 
+     * @param binning 
+     * @return t_histogram 
+     */
+    t_histogram get_histogram(const std::vector<t_tscalar>& pkeys, const std::string& colname,
+        t_uindex nbuckets, t_binning binning) const;
+
     /**
      * @brief Reduce the column's values at the specified primary keys, and
      * return a single, reduced value.
@@ -175,6 +232,13 @@ public:
      */
     t_uindex size() const;
 
+    /**
+     * @brief Returns the number of bytes used by the primary key map.
+     *
+     * @return t_uindex
+     */
+    t_uindex mapping_nbytes() const;
+
     /**
      * @brief Returns the size of the underlying primary key map.
      * 
@@ -189,6 +253,163 @@ public:
      */
     void reset();
 
+    /**
+     * @brief Free the strings that no live row refers to from the
+     * vocabularies of the master table's string columns, and the interned
+     * copies of erased primary keys.
+     *
+     * A column is only scanned once its vocabulary has grown by
+     * `t_env::vocab_compaction_ratio()` since its last scan, and only
+     * compacted if at least that share of it is dead, so the scans are paid
+     * for by the strings interned in between.
+     */
+    void compact_vocabularies();
+
+    /**
+     * @brief Move the live rows of the master table to its front, in the
+     * order they were in, and release the storage of the rest, provided at
+     * least `min_free_ratio` of its rows were erased and not reused. New
+     * rows are then appended after the live ones rather than written over
+     * erased rows in the free list's order.
+     *
+     * Contexts refer to rows by primary key, so only the mapping, the row
+     * indexes and zone maps are rebuilt.
+     *
+     * @param min_free_ratio
+     * @return t_uindex the number of rows released.
+     */
+    t_uindex compact_rows(double min_free_ratio);
+
+    /**
+     * @brief Bound the number of rows of the master table, as for tables
+     * with a `limit` and an implicit index, whose primary keys wrap around
+     * at `row_limit` so that new rows overwrite the oldest ones in place.
+     * The master table then grows to at most `row_limit` rows instead of
+     * overshooting it by the usual growth ratio. This only bounds storage:
+     * an overwritten row still reaches contexts as an update of its primary
+     * key, not as the eviction of a range of rows.
+     *
+     * @param row_limit the maximum number of rows, or 0 for no limit.
+     */
+    void set_row_limit(t_uindex row_limit);
+
+    /**
+     * @brief Attach the master table column `colname` to `vocab`, interning
+     * its strings there, so that it shares one copy of each string with
+     * every other column attached to `vocab`, including those of other
+     * tables. The column stays attached across `reset` and `load`.
+     *
+     * @param colname a string column of the master table.
+     * @param vocab
+     */
+    void share_vocabulary(const std::string& colname, std::shared_ptr<t_vocab> vocab);
+
+    /**
+     * @brief Returns the vocabulary of the master table column `colname`,
+     * marked as shared, for other tables to `share_vocabulary`.
+     *
+     * @param colname a string column of the master table.
+     * @return std::shared_ptr<t_vocab>
+     */
+    std::shared_ptr<t_vocab> get_shared_vocabulary(const std::string& colname);
+
+    /**
+     * @brief Maintain an inverted index from each string of the master table
+     * column `colname` to the rows which hold it, which `get_index_mask`
+     * reads instead of scanning the column. The index is built when it is
+     * first read, and rebuilt after its column's vocabulary changes, so a
+     * table pays for it only once a view filters on the column.
+     *
+     * @param colname a string column of the master table.
+     */
+    void create_index(const std::string& colname);
+
+    /**
+     * @brief Returns whether `colname` has an index from `create_index`.
+     *
+     * @param colname
+     */
+    bool has_index(const std::string& colname) const;
+
+    /**
+     * @brief Maintain the live rows of the master table in the order of
+     * `colname`, ascending or descending as `order` is, from now on, which
+     * flat contexts sorted by the column alone read instead of sorting
+     * their rows; see `t_sorted_column_index`. Unlike `create_index`, the
+     * index is built here, as contexts only read the state.
+     *
+     * @param colname a column of the master table.
+     * @param order `SORTTYPE_ASCENDING` or `SORTTYPE_DESCENDING`.
+     */
+    void create_sorted_index(const std::string& colname, t_sorttype order);
+
+    /**
+     * @brief Returns the index of `create_sorted_index` over `colname` in
+     * `order`, or null if there is none. The index lives as long as the
+     * state, and is rebuilt in place when the rows are replaced.
+     *
+     * @param colname
+     * @param order
+     * @return std::shared_ptr<const t_sorted_column_index>
+     */
+    std::shared_ptr<const t_sorted_column_index> get_sorted_index(
+        const std::string& colname, t_sorttype order) const;
+
+    /**
+     * @brief If the filters of `config` must match some `==` or `in` term
+     * over an indexed column, or every filter must match and some filter is
+     * a range over a numeric, date or time column, set in `out_mask` the
+     * live rows of the master table which may match those terms, read from
+     * the indexes and zone maps, and return true. The rows are a superset of
+     * those that pass every filter, which must still be applied to them.
+     *
+     * Zone maps are built for a column when a range filter is first applied
+     * to it, so a table pays for them only for the columns views filter on.
+     *
+     * @param config
+     * @param out_mask
+     * @return bool
+     */
+    bool get_index_mask(const t_config& config, t_mask& out_mask);
+
+    /**
+     * @brief Returns the primary keys of the live rows of the master table
+     * which pass `fterms` combined by `combiner`, in ascending order. The
+     * filters are applied to each column once, rather than per row.
+     *
+     * @param fterms
+     * @param combiner
+     * @return std::vector<t_tscalar>
+     */
+    std::vector<t_tscalar> get_pkeys_where(
+        const std::vector<t_fterm>& fterms, t_filter_op combiner) const;
+
+    /**
+     * @brief Returns an estimate of the bytes used by the indexes and zone
+     * maps.
+     */
+    t_uindex index_nbytes() const;
+
+    /**
+     * @brief Write a snapshot of the master table, its vocabularies and the
+     * free list to the existing directory `dirname`, which `load` can read
+     * back into a `t_gstate` of the same schema.
+     *
+     * @param dirname
+     */
+    void save(const std::string& dirname) const;
+
+    /**
+     * @brief Replace the gnode state with the snapshot in `dirname`, which
+     * must have been saved from a `t_gstate` of the same schema. The columns
+     * read from mappings of the saved files, each copied by the first write
+     * to it (see `t_lstore::map`). The primary key mapping is rebuilt from
+     * the `psp_pkey` column of the live rows.
+     *
+     * @param dirname
+     */
+    void load(const std::string& dirname);
+
     // Getters
     std::shared_ptr<t_data_table> get_table();
     std::shared_ptr<const t_data_table> get_table() const;
@@ -240,11 +461,64 @@ protected:
      */
     t_mask get_cpp_mask() const;
 
+    /**
+     * @brief Returns the row indices of the `pkeys` that exist in the state.
+     * 
+     * @param pkeys 
+     * @return std::vector<t_uindex> 
+     */
+    std::vector<t_uindex> get_row_indices(const std::vector<t_tscalar>& pkeys) const;
+
     void _mark_deleted(t_uindex idx);
+
+    /**
+     * @brief Attach the master table columns to the vocabularies recorded
+     * by `share_vocabulary`, after they have been recreated or replaced.
+     */
+    void _attach_shared_vocabularies();
+
     bool has_pkey(t_tscalar pkey) const;
     t_dtype get_pkey_dtype() const;
 
 private:
+    /**
+     * @brief Returns the index of `colname`, building it if it is not built
+     * or has too many stale rows, or null if `fterm` cannot be read from it.
+     */
+    const t_column_index* _get_index(const t_fterm& fterm);
+
+    /**
+     * @brief Returns the zone map of the column of `fterm`, building it if
+     * it is not built, or null if `fterm` cannot be read from one.
+     */
+    const t_zone_map* _get_zone_map(const t_fterm& fterm);
+
+    /**
+     * @brief Drop the built index of `colname`, if any, as the vocabulary
+     * ids it records are no longer those of the column.
+     */
+    void _invalidate_index(const std::string& colname);
+
+    /**
+     * @brief Drop every built index and zone map, as the rows of the master
+     * table were replaced.
+     */
+    void _invalidate_indexes();
+
+    /**
+     * @brief Record the rows of `flattened` written to the master table at
+     * `master_table_indexes` in the built indexes, zone maps and sorted
+     * indexes.
+     */
+    void _update_indexes(
+        const t_data_table* flattened, const std::vector<t_uindex>& master_table_indexes);
+
+    /**
+     * @brief Rebuild every sorted index from the live rows of the master
+     * table.
+     */
+    void _build_sorted_indexes();
+
     // Unused methods
     std::vector<t_uindex> get_pkeys_idx(const std::vector<t_tscalar>& pkeys) const;
     std::vector<t_tscalar> has_pkeys(const std::vector<t_tscalar>& pkeys) const;
@@ -262,9 +536,26 @@ private:
     std::shared_ptr<t_data_table> m_table;
     t_mapping m_mapping;
     t_free_items m_free;
-    t_symtable m_symtable;
     std::shared_ptr<t_column> m_pkcol;
     std::shared_ptr<t_column> m_opcol;
+    t_uindex m_row_limit;
+
+    // Vocabulary size of each string column when it was last scanned by
+    // `compact_vocabularies`.
+    tsl::hopscotch_map<std::string, t_uindex> m_vocab_scan_sizes;
+
+    // Vocabularies shared by master table columns, by column name.
+    tsl::hopscotch_map<std::string, std::shared_ptr<t_vocab>> m_shared_vocabs;
+
+    // The indexes of `create_index`, by column name, null until built.
+    tsl::hopscotch_map<std::string, std::shared_ptr<t_column_index>> m_indexes;
+
+    // The zone maps built by range filters, by column name.
+    tsl::hopscotch_map<std::string, std::shared_ptr<t_zone_map>> m_zone_maps;
+
+    // The indexes of `create_sorted_index`, which are never replaced, as
+    // the traversals of contexts hold them.
+    std::vector<std::shared_ptr<t_sorted_column_index>> m_sorted_indexes;
 };
 
 template <typename FN_T>
@@ -12,9 +12,19 @@
 #include <perspective/raw_types.h>
 #include <perspective/scalar.h>
 #include <perspective/exports.h>
+#include <vector>
 
 namespace perspective {
 
+class t_column;
+
+enum t_binning {
+    // Buckets of equal width between the min and max values
+    BINNING_FIXED_WIDTH,
+    // Buckets holding an equal number of values
+    BINNING_QUANTILE
+};
+
 struct PERSPECTIVE_EXPORT t_hist_bucket {
     t_hist_bucket(t_tscalar begin, t_tscalar end, t_uindex count);
     t_hist_bucket();
@@ -32,4 +42,20 @@ struct PERSPECTIVE_EXPORT t_histogram {
     std::vector<t_hist_bucket> m_buckets;
 };
 
+/**
+ * @brief Bin the valid values of a numeric or datetime `column` at the rows
+ * `indices` into at most `nbuckets` buckets, reading the column's typed
+ * buffer. Bucket bounds are inclusive and are float64 scalars, or datetimes
+ * for datetime columns; quantile bins drop empty buckets. Returns an empty
+ * histogram for other column types, or if no value is valid.
+ *
+ * @param column
+ * @param indices
+ * @param nbuckets
+ * @param binning
+ * @return t_histogram
+ */
+PERSPECTIVE_EXPORT t_histogram make_histogram(const t_column& column,
+    const std::vector<t_uindex>& indices, t_uindex nbuckets, t_binning binning);
+
 } // end namespace perspective
@@ -0,0 +1,71 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2017, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#pragma once
+
+#include <perspective/first.h>
+#include <perspective/base.h>
+#include <perspective/exports.h>
+#include <perspective/scalar.h>
+#include <cstdint>
+#include <vector>
+
+namespace perspective {
+
+/**
+ * @brief A HyperLogLog sketch of the values under a `t_stree` node, from
+ * which the `APPROX_DISTINCT_COUNT` aggregate estimates their number in a
+ * bounded space per node, to a standard error of about 1.6%.
+ *
+ * The registers are only stored as an array once enough of them are set;
+ * until then the set registers are kept as a sorted list, so that the many
+ * small nodes of a deep pivot cost bytes rather than kilobytes.
+ *
+ * Values cannot be removed from a sketch. Instead, it counts the values
+ * removed from it since it was built, and `needs_rebuild` asks its owner to
+ * build it again from the node's rows once they outnumber half of the values
+ * inserted, so a removal costs amortized O(1) reads.
+ */
+class PERSPECTIVE_EXPORT t_hll_sketch {
+public:
+    t_hll_sketch();
+
+    void insert(const t_tscalar& value);
+
+    /**
+     * @brief Record that one of the values inserted was removed from the
+     * node.
+     */
+    void remove();
+
+    bool needs_rebuild() const;
+
+    void clear();
+
+    /**
+     * @brief Return the estimated number of distinct values inserted.
+     */
+    std::uint64_t estimate() const;
+
+    t_uindex nbytes() const;
+
+private:
+    void insert_hash(std::uint64_t hash);
+    void densify();
+
+    // `(register << 8) | rank` for each set register, by register, or empty
+    // once the registers are stored in `m_registers`.
+    std::vector<std::uint32_t> m_sparse;
+    std::vector<std::uint8_t> m_registers;
+
+    t_uindex m_inserted;
+    t_uindex m_removed;
+};
+
+} // end namespace perspective
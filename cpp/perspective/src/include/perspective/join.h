@@ -0,0 +1,123 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#pragma once
+#include <perspective/first.h>
+#include <perspective/base.h>
+#include <perspective/exports.h>
+#include <perspective/data_table.h>
+#include <perspective/scalar.h>
+#include <perspective/table.h>
+#include <tsl/hopscotch_map.h>
+#include <tsl/hopscotch_set.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace perspective {
+
+/**
+ * @brief Maintains `joined` as the left join of `left` with `right` on the
+ * column `on`, incrementally from the updates each side processes.
+ *
+ * `left` and `right` must both have an index, and `right` must be indexed
+ * by `on`, so that each row of `left` matches at most one row of `right`,
+ * e.g. trades matched to the reference data of their symbol. `joined` is
+ * indexed like `left`, and has the columns of `left` followed by those of
+ * `right` but `on`; a row of `left` without a match has nulls in the
+ * columns of `right`.
+ *
+ * An update to `left` sends the rows it changed, with their match, to
+ * `joined`. An update to `right` sends only the columns of `right`, to the
+ * rows of `left` it matches, which are found through an index of the left
+ * keys by their value of `on`. Rows of `right` are kept by the join, so
+ * that neither side is read while the other is processed. Updates are sent
+ * to `joined` like any other, and are processed by its pool.
+ */
+class PERSPECTIVE_EXPORT t_join {
+public:
+    /**
+     * @brief Construct a join of `left` with `right` on `on`, and the empty
+     * table `joined` it maintains, with a pool of its own.
+     */
+    t_join(std::shared_ptr<Table> left, std::shared_ptr<Table> right, const std::string& on);
+    ~t_join();
+
+    /**
+     * @brief Send every row of `left` to `joined`, and follow the updates of
+     * both sides from now on.
+     */
+    void init();
+
+    /**
+     * @brief Stop following the updates of both sides, leaving `joined` as
+     * it is.
+     */
+    void detach();
+
+    std::shared_ptr<Table> get_table() const;
+
+    /**
+     * @brief Returns the number of values of `on` that rows of `left` match,
+     * including values `right` does not have yet.
+     */
+    t_uindex num_matched_keys() const;
+
+private:
+    void on_left_update(const t_data_table& flattened);
+    void on_right_update(const t_data_table& flattened);
+
+    /**
+     * @brief Send the rows of `left` with `pkeys`, and their matches, to
+     * `joined`.
+     */
+    void send_left_rows(const std::vector<t_tscalar>& pkeys);
+
+    /**
+     * @brief Send the columns of `right` of the rows of `left` matching
+     * `rkeys` to `joined`.
+     */
+    void send_right_columns(const std::vector<t_tscalar>& rkeys);
+
+    void send_deletes(const std::vector<t_tscalar>& pkeys);
+
+    /**
+     * @brief Point the left key `pkey` at `rkey`, or at no key if `rkey` is
+     * null or `has_rkey` is false.
+     */
+    void set_match(const t_tscalar& pkey, const t_tscalar& rkey, bool has_rkey);
+
+    std::shared_ptr<Table> m_left;
+    std::shared_ptr<Table> m_right;
+    std::string m_on;
+    std::shared_ptr<Table> m_joined;
+
+    std::vector<std::string> m_left_columns;
+    std::vector<std::string> m_right_columns;
+    std::vector<t_dtype> m_left_types;
+    std::vector<t_dtype> m_right_types;
+
+    // Guards everything below, as both sides may be processed at once.
+    mutable std::mutex m_mtx;
+
+    // The key of `right` each left key matches, and the left keys matching
+    // each key of `right`, with strings interned.
+    tsl::hopscotch_map<t_tscalar, t_tscalar> m_matches;
+    tsl::hopscotch_map<t_tscalar, tsl::hopscotch_set<t_tscalar>> m_matched_by;
+
+    // The values of `m_right_columns` of each row of `right`.
+    tsl::hopscotch_map<t_tscalar, std::vector<t_tscalar>> m_right_rows;
+
+    bool m_attached;
+    t_uindex m_left_listener;
+    t_uindex m_right_listener;
+};
+
+} // end namespace perspective
@@ -0,0 +1,120 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#pragma once
+#include <perspective/first.h>
+#include <perspective/base.h>
+#include <perspective/exports.h>
+#include <perspective/csv_loader.h>
+#include <perspective/data_table.h>
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace perspective {
+namespace json {
+
+    /**
+     * @brief Returns whether `data` looks like a JSON array of rows, an
+     * object of columns or newline-delimited rows, rather than an Arrow or
+     * Parquet binary.
+     *
+     * @param data
+     * @param length
+     */
+    bool is_json(const char* data, std::size_t length);
+
+    /**
+     * @brief A scalar of a JSON document, as the span of its text in the
+     * document or, for strings with escapes, in the loader's buffer of
+     * unescaped strings. Nulls and missing values are empty.
+     */
+    struct t_json_cell {
+        std::uint32_t m_offset;
+        std::uint32_t m_length;
+        bool m_unescaped;
+    };
+
+    /**
+     * @brief Loads a JSON document directly into a `t_data_table`, without
+     * building a Javascript or Python object for each value.
+     *
+     * The document is an array of row objects, newline-delimited row
+     * objects, or an object of column arrays. It is parsed in one pass into
+     * the text of each value by column, which is then typed and written
+     * exactly like CSV fields by `csv::CsvLoader`: numbers, booleans and
+     * strings holding numbers, booleans or dates are inferred as such, and
+     * `null`, missing keys and empty strings are null. Nested objects and
+     * arrays are read as strings of their JSON text.
+     */
+    class PERSPECTIVE_EXPORT JsonLoader {
+    public:
+        JsonLoader();
+        ~JsonLoader();
+
+        /**
+         * @brief Parse `data`, and infer the names and types of its columns.
+         * `data` is not copied, and must outlive the loader.
+         *
+         * @param data
+         * @param length
+         */
+        void initialize(const char* data, std::size_t length);
+
+        void fill_table(
+            t_data_table& tbl,
+            const std::string& index,
+            std::uint32_t offset,
+            std::uint32_t limit,
+            bool is_update);
+
+        std::vector<std::string> names() const;
+        std::vector<t_dtype> types() const;
+        std::uint32_t row_count() const;
+
+    private:
+        void parse_rows(const char* p, bool is_array);
+        void parse_columns(const char* p);
+
+        /**
+         * @brief Parse the object at `p` into row `m_row_count`, returning
+         * the end of the object.
+         */
+        const char* parse_row(const char* p);
+        const char* parse_value(const char* p, t_json_cell& cell);
+        const char* parse_string(const char* p, t_json_cell& cell);
+        const char* parse_key(const char* p, std::string& key);
+
+        /**
+         * @brief Returns the index of column `name`, adding it with
+         * `m_row_count` missing values if it is new. `hint` is the index the
+         * column had in the previous row.
+         */
+        t_uindex get_column(const std::string& name, t_uindex hint);
+
+        csv::t_csv_field to_field(const t_json_cell& cell) const;
+        std::vector<t_dtype> infer_types() const;
+        void error(const char* p, const std::string& message) const;
+
+        const char* m_data;
+        const char* m_end;
+
+        // Strings that had escapes, after unescaping
+        std::string m_unescaped;
+
+        std::vector<std::string> m_names;
+        std::unordered_map<std::string, t_uindex> m_column_indices;
+        std::vector<std::vector<t_json_cell>> m_columns;
+        std::vector<t_dtype> m_types;
+        t_uindex m_row_count;
+    };
+
+} // namespace json
+} // namespace perspective
@@ -12,6 +12,10 @@
 #include <perspective/base.h>
 #include <perspective/raw_types.h>
 #include <perspective/schema.h>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
 
 #ifdef PSP_ENABLE_WASM
 #include <emscripten.h>
@@ -19,19 +23,52 @@
 typedef emscripten::val t_kernel;
 namespace em = emscripten;
 #else
-typedef perspective::t_str t_kernel;
+typedef std::string t_kernel;
 #endif
 
 namespace perspective {
 
-class t_kernel_evaluator {
+/**
+ * @brief A native reducer of `AGGTYPE_UDF_REDUCER` aggregates, called once
+ * per update with the leaf values of every node whose leaves changed. The
+ * values of the `i`th of `nnodes` nodes are `values[offsets[i]]` up to
+ * `values[offsets[i + 1]]`, and its aggregate is written to `out[i]`, which
+ * is NaN until then.
+ */
+typedef std::function<void(
+    const double* values, const t_uindex* offsets, t_uindex nnodes, double* out)>
+    t_udf_reducer;
+
+class PERSPECTIVE_EXPORT t_kernel_evaluator {
 public:
     t_kernel_evaluator();
     template <typename T>
     T reduce(const t_kernel& fn, t_uindex lvl_depth, std::vector<T> data);
 
+    /**
+     * @brief Register `reducer` under `name`, so that aggregates written as
+     * `["reducer", name]` are computed by it, replacing any reducer already
+     * registered under `name`.
+     */
+    void register_reducer(const std::string& name, t_udf_reducer reducer);
+
+    void unregister_reducer(const std::string& name);
+
+    bool has_reducer(const std::string& name) const;
+
+    /**
+     * @brief Returns the reducer registered under `name`, aborting if there
+     * is none.
+     */
+    t_udf_reducer get_reducer(const std::string& name) const;
+
 private:
-    std::vector<t_uint8> m_kernels;
+    std::vector<std::uint8_t> m_kernels;
+
+    // Guards `m_reducers`, which are registered from the binding's thread
+    // and read from the threads processing updates.
+    mutable std::mutex m_mtx;
+    std::map<std::string, t_udf_reducer> m_reducers;
 };
 
 #ifdef PSP_ENABLE_WASM
@@ -51,6 +88,6 @@ t_kernel_evaluator::reduce(const t_kernel& fn, t_uindex lvl_depth, std::vector<T
 }
 #endif
 
-t_kernel_evaluator* get_evaluator();
+PERSPECTIVE_EXPORT t_kernel_evaluator* get_evaluator();
 
-} // namespace perspective
\ No newline at end of file
+} // namespace perspective
@@ -0,0 +1,119 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#pragma once
+#include <perspective/first.h>
+#include <perspective/base.h>
+#include <perspective/exports.h>
+#include <cstring>
+#include <string>
+
+namespace perspective {
+
+/**
+ * @brief The instruction sets the kernels below are built for. Under
+ * `PSP_CPU_DISPATCH` each kernel is compiled once per instruction set of
+ * x86, and each call runs the widest variant the CPU supports, so that one
+ * binary takes the fast path where it exists. Elsewhere, including
+ * WebAssembly (vectorized with `PSP_WASM_SIMD`), there is only the
+ * `ISA_DEFAULT` variant of the build's target.
+ */
+enum t_isa { ISA_DEFAULT, ISA_AVX2, ISA_AVX512 };
+
+PERSPECTIVE_EXPORT std::string isa_to_str(t_isa isa);
+PERSPECTIVE_EXPORT t_isa str_to_isa(const std::string& str);
+
+/**
+ * @brief Returns the widest instruction set of the CPU, as detected once.
+ */
+PERSPECTIVE_EXPORT t_isa get_detected_isa();
+
+/**
+ * @brief Returns the instruction set the kernels run: the detected one,
+ * unless capped by `PSP_ISA` or `set_isa`.
+ */
+PERSPECTIVE_EXPORT t_isa get_isa();
+
+/**
+ * @brief Run the kernels for `isa`, or for the detected instruction set if
+ * the CPU does not support `isa`.
+ */
+PERSPECTIVE_EXPORT void set_isa(t_isa isa);
+
+// Floats compare by bit pattern for equality, as `t_tscalar::operator==`
+// does, so compare them through an unsigned integer of the same width (and
+// bools through a byte, to keep them out of `std::vector<bool>`).
+template <typename DATA_T>
+struct t_filter_bits {
+    typedef DATA_T type;
+};
+
+template <>
+struct t_filter_bits<double> {
+    typedef std::uint64_t type;
+};
+
+template <>
+struct t_filter_bits<float> {
+    typedef std::uint32_t type;
+};
+
+template <>
+struct t_filter_bits<bool> {
+    typedef std::uint8_t type;
+};
+
+template <typename DATA_T>
+inline typename t_filter_bits<DATA_T>::type
+filter_bits(DATA_T value) {
+    typename t_filter_bits<DATA_T>::type rval = 0;
+    std::memcpy(&rval, &value, sizeof(DATA_T));
+    return rval;
+}
+
+template <typename DATA_T>
+inline bool
+filter_bits_eq(DATA_T a, DATA_T b) {
+    return filter_bits(a) == filter_bits(b);
+}
+
+/**
+ * @brief Write into `out` whether each of the `nrows` values of `data`
+ * compares to `threshold` by `op`, one of `FILTER_OP_LT`, `FILTER_OP_LTEQ`,
+ * `FILTER_OP_GT`, `FILTER_OP_GTEQ`, `FILTER_OP_EQ` or `FILTER_OP_NE`.
+ * Equality is by bit pattern, as `filter_bits_eq`.
+ */
+template <typename DATA_T>
+PERSPECTIVE_EXPORT void kernel_compare(
+    const DATA_T* data, DATA_T threshold, t_filter_op op, t_uindex nrows, std::uint8_t* out);
+
+/**
+ * @brief `out[idx] &= in[idx]` for each of `nrows` bytes.
+ */
+PERSPECTIVE_EXPORT void kernel_and(std::uint8_t* out, const std::uint8_t* in, t_uindex nrows);
+
+/**
+ * @brief `out[idx] |= in[idx]` for each of `nrows` bytes.
+ */
+PERSPECTIVE_EXPORT void kernel_or(std::uint8_t* out, const std::uint8_t* in, t_uindex nrows);
+
+/**
+ * @brief Returns how many of `nrows` bytes are not zero.
+ */
+PERSPECTIVE_EXPORT t_uindex kernel_count_nonzero(const std::uint8_t* values, t_uindex nrows);
+
+/**
+ * @brief Fold the `nrows` values of `data`, at least one, into `min` and
+ * `max`, as `value < min ? value : min` from the first value on.
+ */
+template <typename DATA_T>
+PERSPECTIVE_EXPORT void kernel_min_max(
+    const DATA_T* data, t_uindex nrows, DATA_T& min, DATA_T& max);
+
+} // end namespace perspective
@@ -0,0 +1,84 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2017, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#pragma once
+#include <perspective/first.h>
+#include <perspective/base.h>
+#include <perspective/exports.h>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace perspective {
+
+/**
+ * @brief A histogram of latencies in nanoseconds, with log-linear buckets in
+ * the manner of HdrHistogram: values below 32ns have a bucket each, and each
+ * power of two above is split into 16 buckets, so a percentile is within
+ * 1/16th of the value recorded, from 1ns to over 4 hours. Larger values are
+ * counted in the last bucket.
+ *
+ * Recording is a handful of relaxed atomic operations, so a histogram can be
+ * read or reset on one thread while another records into it; a read
+ * concurrent with a record may miss it.
+ */
+class PERSPECTIVE_EXPORT t_latency_histogram {
+public:
+    PSP_NON_COPYABLE(t_latency_histogram);
+
+    t_latency_histogram();
+
+    /**
+     * @brief Count a latency of `ns` nanoseconds, where a negative latency
+     * is counted as 0.
+     *
+     * @param ns
+     */
+    void record(std::int64_t ns);
+
+    t_uindex count() const;
+
+    /**
+     * @brief Returns the highest latency of the bucket holding the `p`th
+     * quantile, for `p` in `[0, 1]`, clamped to the largest latency
+     * recorded; 0 if nothing has been.
+     *
+     * @param p
+     * @return std::int64_t
+     */
+    std::int64_t percentile(double p) const;
+
+    /**
+     * @brief Write `"count"`, `"min_ns"`, `"max_ns"`, `"mean_ns"`,
+     * `"p50_ns"`, `"p90_ns"`, `"p99_ns"` and `"p999_ns"` to `stats`, each
+     * key prefixed by `prefix`.
+     *
+     * @param stats
+     * @param prefix
+     */
+    void write_stats(std::map<std::string, double>& stats, const std::string& prefix) const;
+
+    void reset();
+
+    // 32 exact buckets, then 16 for each power of two up to 2^44ns.
+    static constexpr t_uindex NUM_BUCKETS = 656;
+
+private:
+    static t_uindex bucket_of(std::uint64_t ns);
+    static std::uint64_t bucket_max(t_uindex idx);
+
+    std::atomic<std::uint64_t> m_count;
+    std::atomic<std::uint64_t> m_sum;
+    std::atomic<std::uint64_t> m_min;
+    std::atomic<std::uint64_t> m_max;
+    std::atomic<std::uint64_t> m_buckets[NUM_BUCKETS];
+};
+
+} // end namespace perspective
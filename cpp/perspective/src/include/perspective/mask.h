@@ -14,20 +14,47 @@
 #include <boost/dynamic_bitset.hpp>
 #include <boost/shared_ptr.hpp>
 #include <perspective/simple_bitmask.h>
+#include <cstdint>
+#include <vector>
 
 namespace perspective {
 
 class t_mask_iterator;
 
-class PERSPECTIVE_EXPORT t_mask {
-    typedef boost::dynamic_bitset<>::size_type t_msize;
+/**
+ * @brief The set indices of one 2^16 index chunk of a `t_mask`, as the
+ * sorted low 16 bits of each while `m_bitmap` is empty, or as the words of
+ * a bitmap otherwise.
+ */
+struct PERSPECTIVE_EXPORT t_mask_container {
+    t_mask_container();
+
+    bool is_bitmap() const;
+
+    std::vector<std::uint16_t> m_array;
+    std::vector<std::uint64_t> m_bitmap;
+    t_uindex m_count;
+};
 
+/**
+ * @brief A set of row indices in [0, `size()`), stored as a compressed
+ * bitmap in the style of Roaring bitmaps: the indices are split into chunks
+ * of 2^16, and each chunk holds its set indices either as a sorted array of
+ * their low 16 bits, while it has few enough of them, or as a dense bitmap.
+ * A sparse mask costs memory in proportion to its count rather than its
+ * size, and combining masks skips the empty chunks of either.
+ */
+class PERSPECTIVE_EXPORT t_mask {
 public:
     t_mask();
     t_mask(t_uindex size);
 
     t_mask(const t_simple_bitmask& m);
 
+    // Builds a mask of `size` bits from one byte per bit, where any
+    // non-zero byte sets the bit.
+    t_mask(const std::uint8_t* values, t_uindex size);
+
     ~t_mask();
 
     void clear();
@@ -48,8 +75,20 @@ public:
     t_uindex size() const;
     void pprint() const;
 
+    /**
+     * @brief Returns the bytes held by the mask's chunks.
+     */
+    t_uindex nbytes() const;
+
+    /**
+     * @brief Returns the number of chunks held as bitmaps rather than
+     * arrays.
+     */
+    t_uindex num_bitmap_chunks() const;
+
 private:
-    boost::dynamic_bitset<> m_bitmap;
+    t_uindex m_size;
+    std::vector<t_mask_container> m_containers;
 };
 
 typedef std::shared_ptr<t_mask> t_masksptr;
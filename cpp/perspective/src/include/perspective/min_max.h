@@ -11,7 +11,9 @@
 #include <perspective/first.h>
 #include <perspective/base.h>
 #include <perspective/scalar.h>
+#include <perspective/column.h>
 #include <perspective/exports.h>
+#include <vector>
 
 namespace perspective {
 
@@ -26,6 +28,27 @@ struct PERSPECTIVE_EXPORT t_minmax {
     t_tscalar m_max;
 };
 
+/**
+ * @brief Returns the min and max of the valid values of `column`, read
+ * directly from its typed buffer; both are `mknone()` if the column has no
+ * valid values or is a string column.
+ *
+ * @param column
+ * @return t_minmax
+ */
+PERSPECTIVE_EXPORT t_minmax get_column_min_max(const t_column& column);
+
+/**
+ * @brief Returns the min and max of the valid values of `column` at the rows
+ * `indices`.
+ *
+ * @param column
+ * @param indices
+ * @return t_minmax
+ */
+PERSPECTIVE_EXPORT t_minmax get_column_min_max(
+    const t_column& column, const std::vector<t_uindex>& indices);
+
 } // end namespace perspective
 
 namespace std {
@@ -13,6 +13,8 @@
 #include <perspective/scalar.h>
 #include <perspective/exports.h>
 #include <perspective/comparators.h>
+#include <cmath>
+#include <string>
 #include <vector>
 
 namespace perspective {
@@ -32,6 +34,9 @@ struct PERSPECTIVE_EXPORT t_mselem {
     t_uindex m_order;
     bool m_deleted;
     bool m_updated;
+    // The normalized sort key (see `encode_sort_key`), or empty if the
+    // element is compared value by value.
+    std::string m_key;
 };
 
 } // end namespace perspective
@@ -80,24 +85,58 @@ struct PERSPECTIVE_EXPORT t_nancmp {
 PERSPECTIVE_EXPORT t_nancmp nan_compare(
     t_sorttype order, const t_tscalar& a, const t_tscalar& b);
 
-inline PERSPECTIVE_EXPORT bool
-cmp_mselem(const t_mselem& a, const t_mselem& b, const std::vector<t_sorttype>& sort_order) {
-    typedef std::pair<double, t_tscalar> dpair;
+/**
+ * @brief Returns -1, 0 or 1 as `a` sorts before, with or after `b` in an
+ * ascending column: as `t_tscalar::operator<` orders them, except that NaN
+ * sorts before every other value of its floating point type, whatever their
+ * statuses. Values neither sorts before are equal, as `-0.0` and `0.0` are.
+ */
+inline PERSPECTIVE_EXPORT int
+cmp_sort_value(const t_tscalar& a, const t_tscalar& b) {
+    if (a.m_type == b.m_type && a.is_floating_point()) {
+        bool a_nan = std::isnan(a.to_double());
+        bool b_nan = std::isnan(b.to_double());
+        if (a_nan || b_nan) {
+            return int(b_nan) - int(a_nan);
+        }
+    }
 
-    if (a.m_row.size() != b.m_row.size() || a.m_row.size() != sort_order.size()) {
-        std::cout << "ERROR detected in MultiSort." << std::endl;
-        return false;
+    if (a < b) {
+        return -1;
     }
 
-    t_tscalar first_pkey = a.m_pkey;
-    t_tscalar second_pkey = b.m_pkey;
+    return b < a ? 1 : 0;
+}
+
+/**
+ * @brief Returns whether the element of the sort values `a_row`, order
+ * `a_order` and primary key `a_pkey` sorts before that of `b_row`, `b_order`
+ * and `b_pkey`, each row holding one value per column of `sort_order`.
+ */
+inline PERSPECTIVE_EXPORT bool
+cmp_sort_values(const t_tscalar* a_row, const t_tscalar& a_pkey, t_uindex a_order,
+    const t_tscalar* b_row, const t_tscalar& b_pkey, t_uindex b_order,
+    const std::vector<t_sorttype>& sort_order) {
+    typedef std::pair<double, t_tscalar> dpair;
+
+    const t_tscalar& first_pkey = a_pkey;
+    const t_tscalar& second_pkey = b_pkey;
 
     for (int idx = 0, loop_end = sort_order.size(); idx < loop_end; ++idx) {
-        const t_tscalar& first = a.m_row[idx];
-        const t_tscalar& second = b.m_row[idx];
+        const t_tscalar& first = a_row[idx];
+        const t_tscalar& second = b_row[idx];
 
         t_sorttype order = sort_order[idx];
 
+        // The order `encode_sort_key` encodes, so keys and values agree.
+        if (order == SORTTYPE_ASCENDING || order == SORTTYPE_DESCENDING) {
+            int cmp = cmp_sort_value(first, second);
+            if (cmp != 0) {
+                return order == SORTTYPE_ASCENDING ? cmp < 0 : cmp > 0;
+            }
+            continue;
+        }
+
 #ifndef PSP_ENABLE_WASM
         t_nancmp nancmp = nan_compare(order, first, second);
 
@@ -119,12 +158,6 @@ cmp_mselem(const t_mselem& a, const t_mselem& b, const std::vector<t_sorttype>&
             continue;
 
         switch (order) {
-            case SORTTYPE_ASCENDING: {
-                return (first < second);
-            } break;
-            case SORTTYPE_DESCENDING: {
-                return (first > second);
-            } break;
             case SORTTYPE_ASCENDING_ABS: {
                 double val_a = first.to_double();
                 double val_b = second.to_double();
@@ -138,14 +171,26 @@ cmp_mselem(const t_mselem& a, const t_mselem& b, const std::vector<t_sorttype>&
             case SORTTYPE_NONE: {
                 return first_pkey < second_pkey;
             }
+            default: break;
         }
     }
 
-    if (a.m_order != b.m_order) {
-        return a.m_order < b.m_order;
+    if (a_order != b_order) {
+        return a_order < b_order;
+    }
+
+    return cmp_sort_value(first_pkey, second_pkey) < 0;
+}
+
+inline PERSPECTIVE_EXPORT bool
+cmp_mselem(const t_mselem& a, const t_mselem& b, const std::vector<t_sorttype>& sort_order) {
+    if (a.m_row.size() != b.m_row.size() || a.m_row.size() != sort_order.size()) {
+        std::cout << "ERROR detected in MultiSort." << std::endl;
+        return false;
     }
 
-    return first_pkey < second_pkey;
+    return cmp_sort_values(
+        a.m_row.data(), a.m_pkey, a.m_order, b.m_row.data(), b.m_pkey, b.m_order, sort_order);
 }
 
 inline PERSPECTIVE_EXPORT bool
@@ -154,7 +199,8 @@ cmp_mselem(const t_mselem* a, const t_mselem* b, const std::vector<t_sorttype>&
 }
 
 // Helper for sorting taking multiple sort specifications
-// into account
+// into account. Two elements that both carry a sort key are compared by
+// their keys alone.
 struct PERSPECTIVE_EXPORT t_multisorter {
     t_multisorter(const std::vector<t_sorttype>& order);
 
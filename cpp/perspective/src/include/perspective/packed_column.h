@@ -0,0 +1,191 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2017, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#pragma once
+
+#include <perspective/first.h>
+#include <perspective/base.h>
+#include <perspective/exports.h>
+#include <perspective/column.h>
+#include <perspective/scalar.h>
+#include <cstdint>
+#include <vector>
+
+namespace perspective {
+
+enum t_packing {
+    // Offsets from the column minimum, bit-packed
+    PACKING_FOR,
+    // Offsets from the first value of each block, bit-packed; only chosen
+    // for columns that never decrease, such as timestamps
+    PACKING_DELTA
+};
+
+/**
+ * @brief A fixed number of bits per entry, packed into 64-bit words.
+ */
+class PERSPECTIVE_EXPORT t_bitpacked {
+public:
+    t_bitpacked();
+
+    void init(t_uindex size, std::uint8_t width);
+
+    void set(t_uindex idx, std::uint64_t value);
+
+    std::uint64_t
+    get(t_uindex idx) const {
+        if (m_width == 0) {
+            return 0;
+        }
+
+        t_uindex bitpos = idx * m_width;
+        t_uindex word = bitpos >> 6;
+        t_uindex shift = bitpos & 63;
+        std::uint64_t rval = m_words[word] >> shift;
+
+        if (shift + m_width > 64) {
+            rval |= m_words[word + 1] << (64 - shift);
+        }
+
+        return rval & m_mask;
+    }
+
+    std::uint8_t get_width() const;
+
+    t_uindex nbytes() const;
+
+    /**
+     * @brief Returns the number of bits needed to store `value`.
+     */
+    static std::uint8_t bit_width(std::uint64_t value);
+
+private:
+    std::vector<std::uint64_t> m_words;
+    std::uint8_t m_width;
+    std::uint64_t m_mask;
+};
+
+/**
+ * @brief A compressed copy of an integer, bool, date or time `t_column`,
+ * which a packed column (see `t_column::pack`) reads its entries from.
+ *
+ * Values are mapped onto unsigned integers of the same order, then stored as
+ * frame-of-reference offsets bit-packed at the width of the largest offset,
+ * so a column of small quantities or status codes takes a few bits a row.
+ * Columns that never decrease are instead encoded against the first value
+ * of each block of `PACKED_BLOCK_SIZE` rows, which keeps timestamps narrow
+ * while every entry stays randomly accessible. Whichever encoding is smaller
+ * is kept; neither is ever wider than the column's own type.
+ *
+ * Statuses are bit-packed alongside the values. Entries whose status is not
+ * `STATUS_VALID` do not contribute to the frame, and decode to 0 as
+ * `t_column::clear` leaves them.
+ */
+class PERSPECTIVE_EXPORT t_packed_column {
+public:
+    PSP_NON_COPYABLE(t_packed_column);
+
+    t_packed_column();
+
+    explicit t_packed_column(const t_column& column);
+
+    /**
+     * @brief Returns whether columns of `dtype` can be packed.
+     */
+    static bool is_packable(t_dtype dtype);
+
+    t_dtype get_dtype() const;
+
+    t_packing get_packing() const;
+
+    t_uindex size() const;
+
+    /**
+     * @brief Returns the number of bytes used by the packed values and
+     * statuses.
+     */
+    t_uindex nbytes() const;
+
+    /**
+     * @brief Returns the value at `idx` widened to 64 bits; unsigned and
+     * date columns are returned as their unsigned value, bools as 0 or 1.
+     */
+    std::int64_t
+    get(t_uindex idx) const {
+        return m_statuses.get(idx) == 0 ? from_ordered(get_ordered(idx)) : 0;
+    }
+
+    t_status get_status(t_uindex idx) const;
+
+    t_tscalar get_scalar(t_uindex idx) const;
+
+    /**
+     * @brief Decode the values in `[bidx, eidx)` into `out`, which must have
+     * room for `eidx - bidx` values.
+     */
+    void decode(t_uindex bidx, t_uindex eidx, std::int64_t* out) const;
+
+    /**
+     * @brief Decode the values of the rows `*bidx` to `*(eidx - 1)`, in any
+     * order, into `out`.
+     */
+    void gather(const t_uindex* bidx, const t_uindex* eidx, std::int64_t* out) const;
+
+    /**
+     * @brief Decode the statuses in `[bidx, eidx)` into `out`.
+     */
+    void decode_status(t_uindex bidx, t_uindex eidx, t_status* out) const;
+
+    /**
+     * @brief Write the values back into `data` at the width of the column's
+     * type, and the statuses into `status` unless it is null, resizing both
+     * to the packed column's size.
+     */
+    void unpack(t_lstore& data, t_lstore* status) const;
+
+private:
+    std::uint64_t
+    get_ordered(t_uindex idx) const {
+        if (m_packing == PACKING_DELTA) {
+            return m_block_bases[idx / PACKED_BLOCK_SIZE] + m_values.get(idx);
+        }
+
+        return m_base + m_values.get(idx);
+    }
+
+    // Signed values have their sign bit flipped so that they order as
+    // unsigned integers.
+    std::uint64_t
+    to_ordered(std::int64_t value) const {
+        return m_signed ? std::uint64_t(value) ^ (std::uint64_t(1) << 63) : std::uint64_t(value);
+    }
+
+    std::int64_t
+    from_ordered(std::uint64_t value) const {
+        return m_signed ? std::int64_t(value ^ (std::uint64_t(1) << 63)) : std::int64_t(value);
+    }
+
+    static const t_uindex PACKED_BLOCK_SIZE = 128;
+
+    t_dtype m_dtype;
+    t_packing m_packing;
+    t_uindex m_size;
+    bool m_signed;
+
+    // PACKING_FOR
+    std::uint64_t m_base;
+
+    // PACKING_DELTA
+    std::vector<std::uint64_t> m_block_bases;
+
+    t_bitpacked m_values;
+    t_bitpacked m_statuses;
+};
+
+} // end namespace perspective
@@ -13,6 +13,8 @@
 #include <perspective/raw_types.h>
 #include <perspective/column.h>
 #include <perspective/node_processor_types.h>
+#include <cstring>
+#include <utility>
 #include <vector>
 #include <algorithm>
 
@@ -28,6 +30,10 @@ approaches
     c. ...?
 */
 
+// The most distinct values a column may have for `partition` to group its
+// rows by counting them into buckets indexed by value, rather than sorting.
+#define PSP_PARTITION_MAX_DIRECT_DOMAIN 256
+
 namespace perspective {
 
 template <typename DATA_T>
@@ -54,6 +60,168 @@ argsort(const DATA_T* b, std::vector<t_uindex>& output) {
     std::sort(output.begin(), output.end(), cmp);
 }
 
+/**
+ * @brief The group id of a row: its status and an integer equal for two
+ * valid rows exactly when their values are, as `t_tscalar::operator==` has
+ * it, so that rows are grouped without comparing their scalars.
+ */
+typedef std::pair<std::uint8_t, std::uint64_t> t_group_id;
+
+template <typename DATA_T>
+inline void
+fill_group_ids_typed(const t_column* PSP_RESTRICT data, const t_uindex* PSP_RESTRICT leaves,
+    t_uindex nelems, t_group_id* PSP_RESTRICT ids) {
+    const DATA_T* values = data->get_nth<DATA_T>(0);
+    bool has_status = data->is_status_enabled();
+    for (t_uindex idx = 0; idx < nelems; ++idx) {
+        t_uindex leaf = leaves[idx];
+        std::uint64_t bits = 0;
+        std::memcpy(&bits, values + leaf, sizeof(DATA_T));
+        ids[idx].first = has_status ? *data->get_nth_status(leaf) : STATUS_VALID;
+        ids[idx].second = bits;
+    }
+}
+
+/**
+ * @brief Fill `ids` with the group id of each of the `nelems` rows of
+ * `data` at `leaves`, in one pass over the column - the vocabulary index of
+ * a string, which is unique to its value in a column, or the bits of any
+ * other value.
+ */
+inline void
+fill_group_ids(const t_column* PSP_RESTRICT data, const t_uindex* PSP_RESTRICT leaves,
+    t_uindex nelems, std::vector<t_group_id>& ids) {
+    t_group_id* out = &ids[0];
+    switch (data->get_dtype()) {
+        case DTYPE_STR: {
+            fill_group_ids_typed<t_stridx>(data, leaves, nelems, out);
+        } break;
+        case DTYPE_INT64:
+        case DTYPE_UINT64:
+        case DTYPE_TIME:
+        case DTYPE_FLOAT64: {
+            fill_group_ids_typed<std::uint64_t>(data, leaves, nelems, out);
+        } break;
+        case DTYPE_INT32:
+        case DTYPE_UINT32:
+        case DTYPE_DATE:
+        case DTYPE_FLOAT32: {
+            fill_group_ids_typed<std::uint32_t>(data, leaves, nelems, out);
+        } break;
+        case DTYPE_INT16:
+        case DTYPE_UINT16: {
+            fill_group_ids_typed<std::uint16_t>(data, leaves, nelems, out);
+        } break;
+        case DTYPE_INT8:
+        case DTYPE_UINT8:
+        case DTYPE_BOOL: {
+            fill_group_ids_typed<std::uint8_t>(data, leaves, nelems, out);
+        } break;
+        default: {
+            for (t_uindex idx = 0; idx < nelems; ++idx) {
+                t_tscalar value = data->get_scalar(leaves[idx]);
+                out[idx].first = value.m_status;
+                out[idx].second = value.m_data.m_uint64;
+            }
+        } break;
+    }
+}
+
+/**
+ * @brief Returns the number of values which the valid rows of `data` can
+ * hold, for columns whose values index a small array directly - the size
+ * of the vocabulary of a string column, or the range of a boolean or a
+ * byte - or 0 if there are more than `PSP_PARTITION_MAX_DIRECT_DOMAIN`.
+ */
+inline t_uindex
+get_direct_domain(const t_column* data) {
+    switch (data->get_dtype()) {
+        case DTYPE_BOOL: return 2;
+        case DTYPE_INT8:
+        case DTYPE_UINT8: return 256;
+        case DTYPE_STR: {
+            t_uindex domain = data->_get_vocab()->get_vlenidx();
+            return domain <= PSP_PARTITION_MAX_DIRECT_DOMAIN ? domain : 0;
+        }
+        default: return 0;
+    }
+}
+
+/**
+ * @brief Fill `keys` with the bucket of each of the `nelems` rows of `data`
+ * at `leaves`: its value for a valid row, and `domain` plus its status for
+ * any other, so that rows share a bucket only if their values are equal.
+ */
+template <typename DATA_T>
+inline void
+fill_direct_keys(const t_column* PSP_RESTRICT data, const t_uindex* PSP_RESTRICT leaves,
+    t_uindex nelems, t_uindex domain, t_uindex* PSP_RESTRICT keys) {
+    const DATA_T* values = data->get_nth<DATA_T>(0);
+    bool has_status = data->is_status_enabled();
+    for (t_uindex idx = 0; idx < nelems; ++idx) {
+        t_uindex leaf = leaves[idx];
+        t_status status = has_status ? *data->get_nth_status(leaf) : STATUS_VALID;
+        keys[idx] = status == STATUS_VALID ? static_cast<t_uindex>(values[leaf]) : domain + status;
+    }
+}
+
+/**
+ * @brief Group the rows `bidx` to `eidx` of `leaves` as `partition` does,
+ * for a column of at most `domain` values (see `get_direct_domain`), by
+ * counting the rows of each value into an array indexed by it and then
+ * placing them, in two passes rather than a sort.
+ */
+inline void
+partition_direct(const t_column* PSP_RESTRICT data_, t_uindex* PSP_RESTRICT leaves,
+    t_uindex bidx, t_uindex eidx, t_uindex domain,
+    std::vector<t_chunk_value_span<t_tscalar>>& out_spans) {
+    typedef t_chunk_value_span<t_tscalar> t_cvs;
+    t_uindex nelems = eidx - bidx;
+
+    std::vector<t_uindex> keys(nelems);
+    switch (data_->get_dtype()) {
+        case DTYPE_STR: {
+            fill_direct_keys<t_stridx>(data_, leaves + bidx, nelems, domain, &keys[0]);
+        } break;
+        case DTYPE_BOOL: {
+            fill_direct_keys<bool>(data_, leaves + bidx, nelems, domain, &keys[0]);
+        } break;
+        default: {
+            fill_direct_keys<std::uint8_t>(data_, leaves + bidx, nelems, domain, &keys[0]);
+        } break;
+    }
+
+    // One bucket per value, then one per status of the other rows.
+    std::vector<t_uindex> offsets(domain + 4, 0);
+    for (t_uindex idx = 0; idx < nelems; ++idx) {
+        ++offsets[keys[idx] + 1];
+    }
+
+    for (t_uindex bucket = 1, loop_end = offsets.size(); bucket < loop_end; ++bucket) {
+        offsets[bucket] += offsets[bucket - 1];
+    }
+
+    std::vector<t_uindex> cursors(offsets.begin(), offsets.end() - 1);
+    std::vector<t_uindex> temp_leaves(nelems);
+    for (t_uindex idx = 0; idx < nelems; ++idx) {
+        temp_leaves[cursors[keys[idx]]++] = leaves[bidx + idx];
+    }
+
+    memcpy(leaves + bidx, &temp_leaves[0], sizeof(t_uindex) * nelems);
+    for (t_uindex bucket = 0, loop_end = offsets.size() - 1; bucket < loop_end; ++bucket) {
+        t_uindex begin = offsets[bucket];
+        t_uindex end = offsets[bucket + 1];
+        if (begin == end) {
+            continue;
+        }
+
+        out_spans.push_back(t_cvs());
+        t_cvs& cvs = out_spans.back();
+        fill_chunk_value_span<t_tscalar>(
+            cvs, data_->get_scalar(temp_leaves[begin]), bidx + begin, bidx + end);
+    }
+}
+
 inline void
 partition(const t_column* PSP_RESTRICT data_, t_column* PSP_RESTRICT leaves_, t_uindex bidx,
     t_uindex eidx, std::vector<t_chunk_value_span<t_tscalar>>& out_spans) {
@@ -69,55 +237,45 @@ partition(const t_column* PSP_RESTRICT data_, t_column* PSP_RESTRICT leaves_, t_
             fill_chunk_value_span<t_tscalar>(c, data_->get_scalar(leaves[bidx]), bidx, eidx);
         } break;
         default: {
-            std::vector<t_tscalar> buf(nelems);
-            for (t_uindex idx = 0; idx < nelems; ++idx) {
-                buf[idx] = data_->get_scalar(leaves[bidx + idx]);
+            // Columns of few distinct values, i.e. booleans or strings of a
+            // small vocabulary such as a side or a status, are grouped by
+            // counting rather than sorting when they have more rows than
+            // values.
+            t_uindex domain = get_direct_domain(data_);
+            if (domain > 0 && domain <= nelems) {
+                partition_direct(data_, leaves, bidx, eidx, domain, out_spans);
+                break;
             }
 
-            std::vector<t_uindex> order(nelems);
+            // Group the rows by their integer group ids, reading a scalar
+            // only for the first row of each group.
+            std::vector<t_group_id> ids(nelems);
+            fill_group_ids(data_, leaves + bidx, nelems, ids);
 
-            t_tscalar* buf_addr = &buf[0];
-            argsort(buf_addr, order);
+            std::vector<t_uindex> order(nelems);
+            argsort(&ids[0], order);
             std::vector<t_uindex> temp_leaves(nelems);
             for (t_uindex j = 0; j < nelems; ++j) {
                 temp_leaves[j] = leaves[bidx + order[j]];
             }
 
-            std::vector<t_tscalar> sdata(nelems);
-            std::vector<t_uindex> edges;
-            auto old_value = buf[order[0]];
-
-            sdata[0] = old_value;
-            for (t_uindex i = 0; i < nelems; ++i) {
-                auto new_value = buf[order[i]];
-                if (old_value != new_value) {
-                    sdata[i] = new_value;
-                    edges.push_back(i);
+            std::vector<t_uindex> boundaries;
+            boundaries.push_back(0);
+            for (t_uindex i = 1; i < nelems; ++i) {
+                if (ids[order[i]] != ids[order[i - 1]]) {
+                    boundaries.push_back(i);
                 }
-                old_value = new_value;
             }
+            boundaries.push_back(nelems);
 
-            if (edges.empty()) {
+            memcpy(leaves + bidx, &temp_leaves[0], sizeof(t_uindex) * nelems);
+            for (t_uindex i = 0, loop_end = boundaries.size() - 1; i < loop_end; ++i) {
+                t_uindex begin = boundaries[i];
+                t_uindex end = boundaries[i + 1];
                 out_spans.push_back(t_cvs());
-                t_cvs& c = out_spans.back();
-                fill_chunk_value_span<t_tscalar>(c, sdata[0], bidx, eidx);
-            } else {
-                t_tscalar value;
-                std::vector<t_uindex> boundaries;
-                boundaries.push_back(0);
-                boundaries.insert(boundaries.end(), edges.begin(), edges.end());
-                boundaries.push_back(order.size());
-
-                for (t_uindex i = 0, loop_end = boundaries.size() - 1; i < loop_end; ++i) {
-                    t_uindex begin = boundaries[i];
-                    t_uindex end = boundaries[i + 1];
-                    value = sdata[begin];
-                    t_uindex num_new_bytes = sizeof(t_uindex) * (end - begin);
-                    memcpy(leaves + begin + bidx, &temp_leaves[begin], num_new_bytes);
-                    out_spans.push_back(t_cvs());
-                    t_cvs& cvs = out_spans.back();
-                    fill_chunk_value_span<t_tscalar>(cvs, value, bidx + begin, bidx + end);
-                }
+                t_cvs& cvs = out_spans.back();
+                fill_chunk_value_span<t_tscalar>(
+                    cvs, data_->get_scalar(temp_leaves[begin]), bidx + begin, bidx + end);
             }
         }
 
@@ -13,16 +13,32 @@
 #include <perspective/base.h>
 #include <perspective/raw_types.h>
 #include <perspective/exports.h>
+#include <perspective/scalar.h>
+#include <functional>
 
 namespace perspective {
 
 struct PERSPECTIVE_EXPORT t_pivot_recipe {
-    t_pivot_recipe() {}
+    t_pivot_recipe()
+        : m_bucket(INVALID_COMPUTED_FUNCTION) {}
     std::string m_colname;
     std::string m_name;
     t_pivot_mode m_mode;
+    t_computed_function_name m_bucket;
 };
 
+/**
+ * @brief A pivot on a column, or on a bucketing function of a column.
+ *
+ * A pivot named `function(column)`, where `function` is one of the
+ * one-input bucketing functions of computed columns (`bin10`, `bin10th`,
+ * `hour_bucket`, `day_bucket` and so on), pivots on the bucket of each
+ * value of `column` without a computed column: the bucket is evaluated
+ * while building the strands of the rows being processed, so that nothing
+ * is added to the master or transitional tables. `colname` is the column
+ * the pivot reads, and `name` the column of the strand and dense trees
+ * holding its values.
+ */
 class PERSPECTIVE_EXPORT t_pivot {
 public:
     t_pivot(const t_pivot_recipe& r);
@@ -34,12 +50,30 @@ public:
 
     t_pivot_mode mode() const;
 
+    /**
+     * @brief Whether the pivot buckets the values of its column.
+     */
+    bool is_bucketed() const;
+
+    /**
+     * @brief Returns the dtype of the pivot's values, for a column of
+     * `dtype`.
+     */
+    t_dtype get_dtype(t_dtype dtype) const;
+
+    /**
+     * @brief Returns the function bucketing a value of a column of `dtype`,
+     * or an empty function if the pivot is not bucketed.
+     */
+    std::function<t_tscalar(t_tscalar)> get_bucket_function(t_dtype dtype) const;
+
     t_pivot_recipe get_recipe() const;
 
 private:
     std::string m_colname;
     std::string m_name;
     t_pivot_mode m_mode;
+    t_computed_function_name m_bucket;
 };
 
 } // namespace perspective
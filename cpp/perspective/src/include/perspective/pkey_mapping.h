@@ -0,0 +1,189 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2017, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#pragma once
+
+#include <perspective/first.h>
+#include <perspective/base.h>
+#include <perspective/bloom_filter.h>
+#include <perspective/exports.h>
+#include <perspective/scalar.h>
+#include <perspective/sym_table.h>
+#include <tsl/hopscotch_map.h>
+#include <vector>
+
+namespace perspective {
+
+/**
+ * @brief A mapping of primary keys to `t_uindex` row indices, specialized on
+ * the dtype of the `psp_pkey` column it indexes.
+ *
+ * Integer primary keys are stored in a vector indexed by the key for as
+ * long as the keys stay dense (as the implicit row-number index of an
+ * unindexed table does), and in a hash map of `std::int64_t` otherwise.
+ * String primary keys are interned and stored as `const char*`. Primary keys
+ * of any other dtype, or whose dtype or status do not match the column, are
+ * stored in a hash map of `t_tscalar`.
+ *
+ * Once the integer or string hash map holds
+ * `t_env::pkey_bloom_filter_min_size()` keys, a Bloom filter of them is
+ * probed before it, so that looking up a key that does not exist (as most
+ * of an insert-heavy workload's do) rarely misses the cache on the map.
+ * The filter keeps the keys erased since it was built, and is rebuilt once
+ * they outnumber the live ones, or the keys outgrow it.
+ */
+class PERSPECTIVE_EXPORT t_pkey_mapping {
+    typedef tsl::hopscotch_map<std::int64_t, t_uindex> t_int_mapping;
+    typedef tsl::hopscotch_map<const char*, t_uindex, t_cchar_umap_hash, t_cchar_umap_cmp>
+        t_str_mapping;
+    typedef tsl::hopscotch_map<t_tscalar, t_uindex> t_scalar_mapping;
+
+    enum t_mode { MODE_DENSE, MODE_INT, MODE_STR, MODE_SCALAR };
+
+public:
+    t_pkey_mapping();
+
+    /**
+     * @brief Select the specialized index used for primary keys of `dtype`,
+     * clearing the mapping.
+     *
+     * @param dtype the dtype of the `psp_pkey` column.
+     */
+    void init(t_dtype dtype);
+
+    /**
+     * @brief Look up `pkey`, writing its row index to `idx` if it exists.
+     *
+     * @param pkey
+     * @param idx
+     * @return bool whether `pkey` exists in the mapping.
+     */
+    bool find(const t_tscalar& pkey, t_uindex& idx) const;
+
+    bool contains(const t_tscalar& pkey) const;
+
+    /**
+     * @brief Map `pkey` to `idx`, overwriting any existing row index.
+     *
+     * @param pkey
+     * @param idx
+     */
+    void insert(const t_tscalar& pkey, t_uindex idx);
+
+    /**
+     * @brief Remove `pkey` from the mapping, writing its row index to `idx`.
+     *
+     * @param pkey
+     * @param idx
+     * @return bool whether `pkey` existed in the mapping.
+     */
+    bool erase(const t_tscalar& pkey, t_uindex& idx);
+
+    void clear();
+
+    t_uindex size() const;
+
+    bool empty() const;
+
+    /**
+     * @brief Returns the number of bytes used by the index and the interned
+     * copies of string primary keys.
+     */
+    t_uindex nbytes() const;
+
+    /**
+     * @brief Free the interned copies of string primary keys that have since
+     * been erased, provided at least `min_dead_ratio` of them are dead.
+     *
+     * @param min_dead_ratio
+     * @return t_uindex the number of copies freed.
+     */
+    t_uindex compact(double min_dead_ratio);
+
+    /**
+     * @brief Return the dtype of the primary keys in the mapping, or
+     * `DTYPE_NONE` if the mapping is empty.
+     */
+    t_dtype get_dtype() const;
+
+    /**
+     * @brief Call `fn(pkey, idx)` for every primary key in the mapping, in
+     * no particular order.
+     */
+    template <typename FN_T>
+    void for_each(FN_T fn) const;
+
+private:
+    bool is_typed(const t_tscalar& pkey) const;
+    std::int64_t to_int_key(const t_tscalar& pkey) const;
+    t_tscalar from_int_key(std::int64_t key) const;
+    void insert_dense(std::int64_t key, t_uindex idx);
+    void migrate_dense();
+
+    /**
+     * @brief Returns the hash of a typed key of the integer or string map
+     * that the Bloom filter records.
+     */
+    std::uint64_t bloom_hash(const t_tscalar& pkey) const;
+
+    /**
+     * @brief Rebuild the Bloom filter from the keys of the integer or string
+     * map, or drop it if there are too few.
+     */
+    void rebuild_bloom();
+
+    t_dtype m_dtype;
+    t_mode m_mode;
+    t_uindex m_typed_size;
+    // Row index + 1 for each key, or 0 where the key is absent.
+    std::vector<t_uindex> m_dense;
+    t_int_mapping m_int;
+    t_str_mapping m_str;
+    t_scalar_mapping m_scalar;
+    t_symtable m_symtable;
+    t_bloom_filter m_bloom;
+    // The filter is rebuilt once the typed keys exceed this.
+    t_uindex m_bloom_limit;
+    // Keys erased since the filter was built.
+    t_uindex m_bloom_stale;
+};
+
+template <typename FN_T>
+void
+t_pkey_mapping::for_each(FN_T fn) const {
+    switch (m_mode) {
+        case MODE_DENSE: {
+            for (t_uindex key = 0, loop_end = m_dense.size(); key < loop_end; ++key) {
+                if (m_dense[key] != 0) {
+                    fn(from_int_key(static_cast<std::int64_t>(key)), m_dense[key] - 1);
+                }
+            }
+        } break;
+        case MODE_INT: {
+            for (const auto& kv : m_int) {
+                fn(from_int_key(kv.first), kv.second);
+            }
+        } break;
+        case MODE_STR: {
+            for (const auto& kv : m_str) {
+                t_tscalar pkey;
+                pkey.set(kv.first);
+                fn(pkey, kv.second);
+            }
+        } break;
+        case MODE_SCALAR:
+            break;
+    }
+
+    for (const auto& kv : m_scalar) {
+        fn(kv.first, kv.second);
+    }
+}
+
+} // end namespace perspective
@@ -11,9 +11,17 @@
 #include <perspective/first.h>
 #include <perspective/data_table.h>
 #include <perspective/gnode.h>
+#include <perspective/scheduler.h>
 #include <perspective/exports.h>
 #include <mutex>
 #include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <thread>
+
+// The number of segments of the registry of gnodes, the `n`th of which
+// holds `2^n` slots.
+#define PSP_POOL_SLOT_SEGMENTS 32
 
 #if defined PSP_ENABLE_WASM
     #include <emscripten/val.h>
@@ -35,6 +43,52 @@ struct PERSPECTIVE_EXPORT t_updctx {
 
 class t_update_task;
 
+/**
+ * @brief A registered `t_gnode` and the lock that serializes processing
+ * and reading it, so that updates to one gnode never wait on another. The
+ * lock is recursive because update callbacks run while it is held, and may
+ * process the same gnode again.
+ *
+ * Sends take no lock, as the gnode's input ports queue them while the
+ * gnode is processed. Instead, a send is counted in `m_senders` while it
+ * reads `m_gnode`, and `clear` waits for every send in progress.
+ */
+struct PERSPECTIVE_EXPORT t_gnode_slot {
+    t_gnode_slot(t_gnode* gnode);
+
+    /**
+     * @brief Lock the slot. In the Python binding, the GIL is released while
+     * waiting for another thread to unlock it, since that thread may be
+     * calling back into Python.
+     *
+     * @return std::unique_lock<std::recursive_mutex>
+     */
+    std::unique_lock<std::recursive_mutex> lock();
+
+    /**
+     * @brief Begin a send, returning the gnode to send to, or `nullptr` if
+     * it is unregistered. Every call is followed by `end_send`.
+     *
+     * @return t_gnode*
+     */
+    t_gnode* begin_send();
+    void end_send();
+
+    /**
+     * @brief Unregister the gnode, with the slot locked, once no send is in
+     * progress.
+     */
+    void clear();
+
+    t_gnode* m_gnode;
+    std::recursive_mutex m_mtx;
+    std::atomic<bool> m_cleared;
+    std::atomic<t_uindex> m_senders;
+
+    // Whether updates have been sent since the gnode was last processed.
+    std::atomic<bool> m_dirty;
+};
+
 class PERSPECTIVE_EXPORT t_pool {
     friend class t_update_task;
     typedef std::pair<t_uindex, std::string> t_ctx_id;
@@ -49,21 +103,34 @@ public:
     void set_update_delegate(t_val ud);
 #endif
 
+    /**
+     * @brief Register the context `ptr` with gnode `gnode_id`, building it
+     * from the gnode's state, or, if `deferred`, leaving it to be built in
+     * steps by `build_context`.
+     *
+     * @param gnode_id
+     * @param name
+     * @param type
+     * @param ptr
+     * @param deferred
+     */
 #ifdef PSP_ENABLE_WASM
-    void register_context(
-        t_uindex gnode_id, const std::string& name, t_ctx_type type, std::int32_t ptr);
+    void register_context(t_uindex gnode_id, const std::string& name, t_ctx_type type,
+        std::uintptr_t ptr, bool deferred = false);
 #else
-    void register_context(
-        t_uindex gnode_id, const std::string& name, t_ctx_type type, std::int64_t ptr);
+    void register_context(t_uindex gnode_id, const std::string& name, t_ctx_type type,
+        std::int64_t ptr, bool deferred = false);
 #endif
 
     /**
      * @brief Call the binding language's `update_callback` method,
-     * set at initialize time.
+     * set at initialize time, for the views of contexts notified with
+     * `priority`.
      * 
      * @param port_id 
+     * @param priority
      */
-    void notify_userspace(t_uindex port_id);
+    void notify_userspace(t_uindex port_id, t_ctx_priority priority = CTX_PRIORITY_VISIBLE);
 
     ~t_pool();
 
@@ -71,13 +138,160 @@ public:
 
     void unregister_context(t_uindex gnode_id, const std::string& name);
 
+    /**
+     * @brief Set the priority with which the context `name` of gnode
+     * `gnode_id` is notified of updates, returning whether it was rebuilt
+     * after missing updates while paused.
+     *
+     * @param gnode_id
+     * @param name
+     * @param priority
+     * @return bool
+     */
+    bool set_context_priority(
+        t_uindex gnode_id, const std::string& name, t_ctx_priority priority);
+
+    /**
+     * @brief Freeze the context `name` of gnode `gnode_id`, see
+     * `t_gnode::freeze_context`.
+     *
+     * @param gnode_id
+     * @param name
+     */
+    void freeze_context(t_uindex gnode_id, const std::string& name);
+
+    /**
+     * @brief Thaw the context `name` of gnode `gnode_id`, returning whether
+     * it was rebuilt after missing updates while frozen.
+     *
+     * @param gnode_id
+     * @param name
+     * @return bool
+     */
+    bool thaw_context(t_uindex gnode_id, const std::string& name);
+
+    /**
+     * @brief Read up to `max_rows` more rows into the context `name` of
+     * gnode `gnode_id`, registered with `deferred`, returning whether it is
+     * built. The gnode is locked only for the step, so that updates and
+     * reads of other contexts proceed between steps.
+     *
+     * @param gnode_id
+     * @param name
+     * @param max_rows
+     * @return bool
+     */
+    bool build_context(t_uindex gnode_id, const std::string& name, t_uindex max_rows);
+
     void send(t_uindex gnode_id, t_uindex port_id, const t_data_table& table);
 
+    /**
+     * @brief Send `table` to the gnode `gnode_id`, which takes it without a
+     * copy if its port `port_id` is empty, as it is for the first update
+     * since the gnode was last processed.
+     *
+     * @param gnode_id
+     * @param port_id
+     * @param table
+     */
+    void send(t_uindex gnode_id, t_uindex port_id, std::shared_ptr<t_data_table>&& table);
+
+    /**
+     * @brief Process every pending update on the calling thread.
+     */
     void _process();
     void _process_helper();
+
+    /**
+     * @brief Start a thread that processes pending updates as they are
+     * sent, rather than waiting for `_process`. The thread sleeps until
+     * `send` wakes it, and then waits out the coalescing delay if there is
+     * one. It only processes while there is no update delegate, since the
+     * delegate must be called on the binding language's thread.
+     */
     void init();
+
+    /**
+     * @brief Stop and join the thread started by `init`, if any, and
+     * process the updates still pending.
+     */
     void stop();
-    void set_sleep(t_uindex ms);
+
+    /**
+     * @brief Set the scheduler that runs the parallel work of the pool and
+     * of its registered gnodes, applying to gnodes registered both before
+     * and after the call. Pools share `t_scheduler::get_default()` unless
+     * given their own, so that the process uses one bounded set of threads.
+     *
+     * @param scheduler
+     */
+    void set_scheduler(std::shared_ptr<t_scheduler> scheduler);
+    std::shared_ptr<t_scheduler> get_scheduler() const;
+
+    /**
+     * @brief Set the number of threads each registered `t_gnode` may use to
+     * process the columns of an update, applying to gnodes registered both
+     * before and after the call. `0` is as many as the pool's scheduler
+     * runs, and `1` is serial. This also bounds the threads used to process
+     * several gnodes with pending updates concurrently, which the pool does
+     * when there is no update delegate to notify.
+     *
+     * @param num_threads
+     */
+    void set_num_threads(t_uindex num_threads);
+    t_uindex get_num_threads() const;
+
+    /**
+     * @brief Set the number of threads each registered `t_gnode` may use to
+     * notify its contexts of an update, applying to gnodes registered both
+     * before and after the call. `0` is as many as the pool's scheduler
+     * runs, and `1` is serial.
+     *
+     * @param notify_threads
+     */
+    void set_notify_threads(t_uindex notify_threads);
+    t_uindex get_notify_threads() const;
+
+    /**
+     * @brief Set the policy used to coalesce consecutive updates. Updates
+     * sent to a gnode are appended to its input port tables, so deferring
+     * `_process` merges them into a single flatten and context notification.
+     *
+     * While coalescing, `should_process` returns false until either
+     * `max_rows` rows have been sent since the last `_process`, or
+     * `max_wait_us` microseconds have passed since the first of them was
+     * sent. `_process` itself always processes every pending update.
+     *
+     * @param max_rows the number of pending rows after which updates are
+     * processed regardless of their age, or `0` for no limit.
+     * @param max_wait_us the latency bound in microseconds, or `0` to
+     * disable coalescing.
+     */
+    void set_coalesce_policy(t_uindex max_rows, t_uindex max_wait_us);
+    t_uindex get_coalesce_max_rows() const;
+    t_uindex get_coalesce_max_wait() const;
+    bool is_coalescing() const;
+
+    /**
+     * @brief Return the number of microseconds until pending updates are
+     * due to be processed under the coalescing policy, which is `0` if
+     * they are due now, if there are no pending updates, or if coalescing
+     * is disabled.
+     */
+    t_uindex get_process_delay() const;
+
+    /**
+     * @brief Return whether pending updates are due to be processed under
+     * the coalescing policy, i.e. whether `get_process_delay` is `0`.
+     */
+    bool should_process() const;
+
+    /**
+     * @brief Return the number of rows sent since updates were last
+     * processed.
+     */
+    t_uindex get_pending_rows() const;
+
     std::vector<t_stree*> get_trees();
 
     bool get_data_remaining() const;
@@ -91,6 +305,18 @@ public:
     std::vector<t_uindex> get_gnodes_last_updated();
     t_gnode* get_gnode(t_uindex gnode_id);
 
+    /**
+     * @brief Lock the gnode `gnode_id` against processing on other threads
+     * until the returned lock is released, e.g. to snapshot the state a read
+     * refers to. Sends are buffered by the gnode's ports meanwhile. The lock
+     * is recursive, so the calling thread may still process the gnode while
+     * holding it.
+     *
+     * @param gnode_id
+     * @return std::unique_lock<std::recursive_mutex>
+     */
+    std::unique_lock<std::recursive_mutex> lock_gnode(t_uindex gnode_id);
+
 protected:
 
     // Unused methods
@@ -102,16 +328,88 @@ protected:
     bool validate_gnode_id(t_uindex gnode_id) const;
 
 private:
-    std::mutex m_mtx;
-    std::vector<t_gnode*> m_gnodes;
+    /**
+     * @brief Returns the slot of `gnode_id`, or `nullptr` if there is no
+     * such gnode.
+     */
+    std::shared_ptr<t_gnode_slot> get_slot(t_uindex gnode_id) const;
+
+    /**
+     * @brief Returns the slot of `gnode_id` as `get_slot` does, but without
+     * a lock, for `send`.
+     */
+    t_gnode_slot* find_slot(t_uindex gnode_id) const;
+
+    /**
+     * @brief Returns the slots of every registered gnode, in id order.
+     */
+    std::vector<std::shared_ptr<t_gnode_slot>> get_slots() const;
+
+    /**
+     * @brief Print `table` before it is sent, if `PSP_LOG_DATA_POOL_SEND`
+     * is set.
+     */
+    void log_send(const t_data_table& table) const;
+
+    /**
+     * @brief Count the `size` rows just sent as pending and wake the
+     * processing thread if needed.
+     */
+    void mark_sent(t_uindex gnode_id, t_uindex port_id, t_uindex size);
+
+    /**
+     * @brief Returns whether `notify_userspace` calls into the binding
+     * language, in which case gnodes must be processed and notified on the
+     * calling thread.
+     */
+    bool has_update_delegate() const;
+
+    /**
+     * @brief The body of the thread started by `init`.
+     */
+    void run_loop();
+
+    /**
+     * @brief Stop and join the thread started by `init`, if it is running.
+     */
+    void stop_loop();
+
+    // Guards the registry of slots only; each gnode is guarded by the lock
+    // of its slot.
+    mutable std::mutex m_mtx;
+    std::vector<std::shared_ptr<t_gnode_slot>> m_gnodes;
+
+    // The slots of `m_gnodes` again, read by `find_slot` without `m_mtx`.
+    // A slot is written before `m_num_slots` is raised past it, and neither
+    // slots nor segments move or are freed before the pool.
+    std::unique_ptr<t_gnode_slot*[]> m_slot_segments[PSP_POOL_SLOT_SEGMENTS];
+    std::atomic<t_uindex> m_num_slots;
 
 #if defined PSP_ENABLE_WASM || defined PSP_ENABLE_PYTHON
     t_val m_update_delegate;
 #endif
-    std::atomic_flag m_run;
+    std::shared_ptr<t_scheduler> m_scheduler;
     std::atomic<bool> m_data_remaining;
-    std::atomic<t_uindex> m_sleep;
     std::atomic<t_uindex> m_epoch;
+    std::atomic<t_uindex> m_num_threads;
+    std::atomic<t_uindex> m_notify_threads;
+    std::atomic<t_uindex> m_coalesce_max_rows;
+    std::atomic<t_uindex> m_coalesce_max_wait;
+
+    // Rows sent since the last `_process`, and when the first of them was
+    // sent, in microseconds of `std::chrono::steady_clock`. They are reset
+    // together with `m_data_remaining` under `m_pending_mtx`, so a row sent
+    // while a task starts is counted towards the next window.
+    std::atomic<t_uindex> m_pending_rows;
+    std::atomic<std::int64_t> m_pending_since;
+    std::mutex m_pending_mtx;
+
+    // The thread started by `init`, which waits on `m_wake_cv` until
+    // `send` or `stop` notifies it.
+    std::atomic<bool> m_running;
+    std::mutex m_wake_mtx;
+    std::condition_variable m_wake_cv;
+    std::thread m_thread;
 };
 
 } // end namespace perspective
@@ -11,6 +11,7 @@
 #include <perspective/first.h>
 #include <perspective/base.h>
 #include <perspective/data_table.h>
+#include <atomic>
 
 namespace perspective {
 
@@ -19,6 +20,25 @@ enum t_port_mode {
     PORT_MODE_PKEYED, // pkeys and op present
 };
 
+/**
+ * @brief A batch of updates sent to a port, in the port's queue of pending
+ * batches.
+ */
+struct t_port_batch {
+    std::shared_ptr<t_data_table> m_table;
+    std::int64_t m_sent_at;
+    t_port_batch* m_next;
+};
+
+/**
+ * @brief A table passed between the stages of a gnode.
+ *
+ * An input port queues the batches it is sent without a lock: `send` pushes
+ * onto a lock-free stack from any thread, and `swap_buffers`, called by the
+ * one thread processing the gnode, takes every pending batch at once and
+ * merges them into the port's table in the order they were sent. Updates
+ * can therefore be sent while the previous ones are processed.
+ */
 class PERSPECTIVE_EXPORT t_port {
 public:
     t_port(t_port_mode mode, const t_schema& schema);
@@ -27,14 +47,49 @@ public:
     std::shared_ptr<t_data_table> get_table();
     void set_table(std::shared_ptr<t_data_table> tbl);
 
-    // append to existing table
+    /**
+     * @brief Count the allocations of the port's tables under `owner`,
+     * including tables it makes or is given from now on.
+     *
+     * @param owner
+     */
+    void set_alloc_owner(t_alloc_owner owner);
+
+    // queue a copy of the table, from any thread
     void send(std::shared_ptr<const t_data_table> tbl);
     void send(const t_data_table& tbl);
 
+    /**
+     * @brief Queue `tbl` without copying it, from any thread. The port takes
+     * the first batch it merges as its table if the table is empty and
+     * `tbl` has the port's schema.
+     *
+     * @param tbl
+     */
+    void send(std::shared_ptr<t_data_table>&& tbl);
+
+    /**
+     * @brief Merge the batches sent since the last swap into the port's
+     * table, to be processed.
+     *
+     * @return std::int64_t the `t_tracer::now` of the first of those sends,
+     * or -1 if nothing was sent.
+     */
+    std::int64_t swap_buffers();
+
     t_schema get_schema() const;
 
     void release();
     void release_or_clear();
+
+    /**
+     * @brief Returns the port's table, leaving in its place `spare`, cleared,
+     * if it has the port's schema, or else a new table.
+     *
+     * @param spare
+     * @return std::shared_ptr<t_data_table>
+     */
+    std::shared_ptr<t_data_table> take_table(std::shared_ptr<t_data_table> spare);
     void clear();
 
 private:
@@ -43,6 +98,12 @@ private:
     bool m_init;
     std::shared_ptr<t_data_table> m_table;
     t_uindex m_prevsize;
+    t_alloc_owner m_alloc_owner;
+
+    static void delete_batches(t_port_batch* batch);
+
+    // The batches sent since the last `swap_buffers`, latest first.
+    std::atomic<t_port_batch*> m_pending;
 };
 
 } // end namespace perspective
@@ -49,3 +49,72 @@
 
 #define SUPPRESS_WARNINGS_VC(X_) PRAGMA_VC(warning(push)) PRAGMA_VC(warning(disable : X_))
 #define RESTORE_WARNINGS_VC() PRAGMA_VC(warning(pop))
+
+#include <cstdint>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace perspective {
+
+/**
+ * @brief Returns the number of set bits in `v`.
+ */
+inline unsigned
+psp_popcount64(std::uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(v);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return unsigned(__popcnt64(v));
+#else
+    v = v - ((v >> 1) & 0x5555555555555555ULL);
+    v = (v & 0x3333333333333333ULL) + ((v >> 2) & 0x3333333333333333ULL);
+    v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return unsigned((v * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+/**
+ * @brief Returns the index of the lowest set bit of `v`, which must not be
+ * zero.
+ */
+inline unsigned
+psp_ctz64(std::uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(v);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+    unsigned long rv;
+    _BitScanForward64(&rv, v);
+    return unsigned(rv);
+#else
+    unsigned rv = 0;
+    while ((v & 1) == 0) {
+        v >>= 1;
+        ++rv;
+    }
+    return rv;
+#endif
+}
+
+/**
+ * @brief Returns the index of the highest set bit of `v`, i.e.
+ * `floor(log2(v))`, which must not be zero.
+ */
+inline unsigned
+psp_log2_64(std::uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(v);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+    unsigned long rv;
+    _BitScanReverse64(&rv, v);
+    return unsigned(rv);
+#else
+    unsigned rv = 0;
+    while (v >>= 1) {
+        ++rv;
+    }
+    return rv;
+#endif
+}
+
+} // end namespace perspective
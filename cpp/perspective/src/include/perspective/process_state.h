@@ -25,7 +25,7 @@ struct t_process_state {
 
     /**
      * @brief Clear each transitional `t_data_table`, i.e. all tables except
-     * `flattened` and `state`.
+     * `flattened` and `state`, keeping their storage for the next update.
      */
     void clear_transitional_data_tables();
 
@@ -43,6 +43,28 @@ struct t_process_state {
      */
     void set_size_transitional_data_tables(t_uindex size);
 
+    /**
+     * @brief Reserve `size` elements for `columns` of the delta, prev,
+     * current and transitions tables, whose other columns are not read, and
+     * for the existed table.
+     *
+     * @param size
+     * @param columns
+     */
+    void reserve_transitional_data_tables(
+        t_uindex size, const std::vector<std::string>& columns);
+
+    /**
+     * @brief Set the size of the delta, prev, current and transitions
+     * tables, and of their `columns`, and of the existed table, to `size`.
+     * Their other columns are left empty.
+     *
+     * @param size
+     * @param columns
+     */
+    void set_size_transitional_data_tables(
+        t_uindex size, const std::vector<std::string>& columns);
+
     std::shared_ptr<t_data_table> m_state_data_table;
     std::shared_ptr<t_data_table> m_flattened_data_table;
     std::shared_ptr<t_data_table> m_delta_data_table;
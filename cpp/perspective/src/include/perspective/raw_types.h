@@ -60,6 +60,15 @@ typedef std::uint64_t t_uindex;
 typedef std::int64_t t_index;
 #endif
 
+// The vocabulary ids stored in the data of `DTYPE_STR` columns. 32-bit ids
+// halve the memory of string columns and limit a vocabulary to as many
+// strings; build with `PSP_WIDE_STRING_IDS` for `t_uindex` ids.
+#ifdef PSP_WIDE_STRING_IDS
+typedef t_uindex t_stridx;
+#else
+typedef std::uint32_t t_stridx;
+#endif
+
 #ifdef WIN32
 typedef std::uint32_t t_fflag;
 typedef void* t_handle;
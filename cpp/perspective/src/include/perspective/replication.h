@@ -0,0 +1,140 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#pragma once
+#include <perspective/first.h>
+#include <perspective/base.h>
+#include <perspective/exports.h>
+#include <perspective/data_table.h>
+#include <perspective/schema.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace arrow {
+class RecordBatch;
+} // namespace arrow
+
+namespace perspective {
+
+enum t_replication_kind { REPLICATION_UPDATE, REPLICATION_CLEAR };
+
+/**
+ * @brief Encodes the flattened tables a primary gnode has processed as
+ * batches for replicas to apply, and queues them until they are taken.
+ *
+ * A batch is an Arrow IPC stream of one record batch holding the columns of
+ * the gnode's input schema, `psp_pkey`, `psp_okey` and `psp_op` included,
+ * so that a replica sends it to its own gnode as it is, without parsing or
+ * inferring the types of the original update. Its schema metadata carries
+ * the dtype of each column, and the index and limit of the primary, from
+ * which a replica's table is created.
+ *
+ * Arrow has a single null, so the cells an update sets to null, which must
+ * be cleared on the replica, are flagged by a boolean column prefixed
+ * `psp_clear:` after the column, written only when there are any. Other
+ * nulls, such as the cells a partial update leaves as they were, are
+ * applied as such.
+ */
+class PERSPECTIVE_EXPORT t_replication_publisher {
+public:
+    /**
+     * @brief A publisher of the updates to a table of `index` and `limit`,
+     * whose gnode has the input schema `schema`.
+     *
+     * @param schema
+     * @param index
+     * @param limit
+     */
+    t_replication_publisher(const t_schema& schema, const std::string& index, std::uint32_t limit);
+
+    /**
+     * @brief Encode and queue `flattened`, a table the gnode has processed.
+     *
+     * @param flattened
+     */
+    void publish(const t_data_table& flattened);
+
+    /**
+     * @brief Queue a batch which clears every row of the replicas.
+     */
+    void publish_clear();
+
+    /**
+     * @brief Returns the queued batches, oldest first, and empties the queue.
+     *
+     * @return std::vector<std::shared_ptr<std::string>>
+     */
+    std::vector<std::shared_ptr<std::string>> take();
+
+    /**
+     * @brief Encode the rows of `tbl`, which has the columns of the input
+     * schema, as a batch of `kind`.
+     *
+     * @param tbl
+     * @param kind
+     * @return std::shared_ptr<std::string>
+     */
+    std::shared_ptr<std::string> encode(const t_data_table& tbl, t_replication_kind kind) const;
+
+private:
+    t_schema m_schema;
+    std::string m_index;
+    std::uint32_t m_limit;
+
+    std::mutex m_mtx;
+    std::vector<std::shared_ptr<std::string>> m_pending;
+};
+
+/**
+ * @brief A batch encoded by a `t_replication_publisher`, decoded.
+ */
+class PERSPECTIVE_EXPORT t_replication_batch {
+public:
+    /**
+     * @brief Decode `bytes`, aborting if they are not a replication batch.
+     *
+     * @param bytes
+     */
+    explicit t_replication_batch(const std::string& bytes);
+
+    t_replication_kind get_kind() const;
+    const std::string& get_index() const;
+    std::uint32_t get_limit() const;
+
+    /**
+     * @brief The input schema of the primary's gnode.
+     */
+    const t_schema& get_schema() const;
+
+    t_uindex size() const;
+
+    /**
+     * @brief Returns the rows of the batch as a table of `schema`, the input
+     * schema of the replica's gnode, which must have the columns and dtypes
+     * of the primary's.
+     *
+     * @param schema
+     * @return std::shared_ptr<t_data_table>
+     */
+    std::shared_ptr<t_data_table> make_table(const t_schema& schema) const;
+
+private:
+    // The stream the record batch reads its buffers from.
+    std::shared_ptr<std::string> m_bytes;
+    std::shared_ptr<::arrow::RecordBatch> m_batch;
+
+    t_replication_kind m_kind;
+    std::string m_index;
+    std::uint32_t m_limit;
+    t_schema m_schema;
+};
+
+} // end namespace perspective
@@ -0,0 +1,72 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2017, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#pragma once
+
+#include <perspective/first.h>
+#include <perspective/base.h>
+#include <perspective/exports.h>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace perspective {
+
+/**
+ * @brief The partial sums of the rows under a `t_stree` node over a trailing
+ * window of a time column, from which the `ROLLING_*` aggregates are read.
+ *
+ * The window is divided into a fixed number of buckets, each of which holds
+ * the sum of the numerators and denominators of the rows whose times fall in
+ * it, in a ring indexed by bucket. A bucket is reused by the first row to
+ * fall `get_num_buckets()` buckets later, so a window covers between
+ * `get_num_buckets() - 1` and `get_num_buckets()` buckets of time back from
+ * the latest, and rows older than that are dropped as they are inserted or
+ * removed.
+ */
+class PERSPECTIVE_EXPORT t_rolling_window {
+public:
+    t_rolling_window();
+
+    /**
+     * @brief Returns the bucket of time `t` in a window of length `window`.
+     *
+     * @param t
+     * @param window
+     */
+    static std::int64_t get_bucket(double t, double window);
+
+    static t_uindex get_num_buckets();
+
+    void insert(std::int64_t bucket, double nr, double dr);
+    void remove(std::int64_t bucket, double nr, double dr);
+
+    /**
+     * @brief Returns the sums of the numerators and denominators of the
+     * window ending with bucket `now`.
+     *
+     * @param now
+     */
+    std::pair<double, double> get(std::int64_t now) const;
+
+    t_uindex nbytes() const;
+
+private:
+    struct t_bucket {
+        std::int64_t m_bucket;
+        double m_nr;
+        double m_dr;
+    };
+
+    // Allocated by the first insert, as most nodes of a deep pivot only ever
+    // see a few rows.
+    std::vector<t_bucket> m_buckets;
+};
+
+} // end namespace perspective
@@ -0,0 +1,60 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#pragma once
+#include <perspective/first.h>
+#include <perspective/base.h>
+#include <perspective/exports.h>
+#include <perspective/scalar.h>
+#include <tsl/hopscotch_map.h>
+#include <cstdint>
+#include <vector>
+
+namespace perspective {
+
+/**
+ * @brief The row paths of a range of rows, encoded against the row before
+ * each: as the depth of its path, the number of leading values of its path
+ * it shares with the path of the row before it, and the ids of the rest of
+ * its values, root first, into one dictionary of the distinct values of the
+ * paths. Consecutive rows of a pivoted view mostly share all but their last
+ * value, so a serializer converts each distinct value once, and reads a
+ * value per row rather than a path.
+ */
+class PERSPECTIVE_EXPORT t_row_paths {
+public:
+    t_row_paths();
+
+    /**
+     * @brief Append a row of `path`, which lists its values deepest first,
+     * as `t_stree::get_path` does.
+     *
+     * @param path
+     */
+    void push_back(const std::vector<t_tscalar>& path);
+
+    t_uindex size() const;
+
+    const std::vector<t_tscalar>& get_values() const;
+    const std::vector<t_uindex>& get_depths() const;
+    const std::vector<t_uindex>& get_shared() const;
+    const std::vector<std::int32_t>& get_ids() const;
+
+private:
+    std::vector<t_tscalar> m_values;
+    std::vector<t_uindex> m_depths;
+    std::vector<t_uindex> m_shared;
+    std::vector<std::int32_t> m_ids;
+
+    tsl::hopscotch_map<t_tscalar, std::int32_t> m_value_ids;
+    // the ids of the last row's path, root first
+    std::vector<std::int32_t> m_last;
+};
+
+} // end namespace perspective
@@ -25,6 +25,7 @@
 #include <tsl/hopscotch_set.h>
 #include <tsl/hopscotch_map.h>
 #include <boost/algorithm/string/case_conv.hpp>
+#include <boost/functional/hash.hpp>
 #include <sstream>
 #include <functional> //std::hash
 
@@ -366,6 +367,134 @@ mktscalar(const T& v) {
 
 t_tscalar mktscalar();
 
+/**
+ * @brief The type of the value of a `t_tscalar` of `DTYPE_T`, and how to read
+ * it, for `t_tscalar_ops`. `ADDABLE` is whether `t_tscalar::add` sums it.
+ */
+template <t_dtype DTYPE_T>
+struct t_tscalar_value;
+
+#define PSP_TSCALAR_VALUE(DTYPE, TYPE, MEMBER, ADD)                                          \
+    template <>                                                                              \
+    struct t_tscalar_value<DTYPE> {                                                          \
+        typedef TYPE t_value;                                                                \
+        static const bool ADDABLE = ADD;                                                     \
+        static inline TYPE                                                                   \
+        get(const t_tscalar& s) {                                                            \
+            return s.m_data.MEMBER;                                                          \
+        }                                                                                    \
+    };
+
+PSP_TSCALAR_VALUE(DTYPE_INT64, std::int64_t, m_int64, true)
+PSP_TSCALAR_VALUE(DTYPE_INT32, std::int32_t, m_int32, true)
+PSP_TSCALAR_VALUE(DTYPE_UINT64, std::uint64_t, m_uint64, true)
+PSP_TSCALAR_VALUE(DTYPE_UINT32, std::uint32_t, m_uint32, true)
+PSP_TSCALAR_VALUE(DTYPE_FLOAT64, double, m_float64, true)
+PSP_TSCALAR_VALUE(DTYPE_FLOAT32, float, m_float32, true)
+PSP_TSCALAR_VALUE(DTYPE_DATE, std::uint32_t, m_uint32, false)
+PSP_TSCALAR_VALUE(DTYPE_TIME, std::int64_t, m_int64, false)
+PSP_TSCALAR_VALUE(DTYPE_BOOL, bool, m_bool, false)
+
+#undef PSP_TSCALAR_VALUE
+
+/**
+ * @brief `t_tscalar`'s `operator==`, `operator<`, `hash_value` and `add` for
+ * scalars the caller knows are of `DTYPE_T`, inlined without dispatching on
+ * the dtype. Each agrees with its generic counterpart for such scalars, so
+ * the two may be mixed, e.g. in one hash map; for scalars of any other
+ * dtype the result is meaningless. See `bench/scalar_bench.cpp`.
+ */
+template <t_dtype DTYPE_T>
+struct t_tscalar_ops {
+    typedef t_tscalar_value<DTYPE_T> t_traits;
+
+    static inline bool
+    eq(const t_tscalar& a, const t_tscalar& b) {
+        return a.m_status == b.m_status && a.m_data.m_uint64 == b.m_data.m_uint64;
+    }
+
+    static inline bool
+    lt(const t_tscalar& a, const t_tscalar& b) {
+        if (a.m_status != b.m_status) {
+            return a.m_status < b.m_status;
+        }
+        return t_traits::get(a) < t_traits::get(b);
+    }
+
+    static inline std::size_t
+    hash(const t_tscalar& s) {
+        std::size_t seed = 0;
+        boost::hash_combine(seed, s.m_data.m_uint64);
+        boost::hash_combine(seed, static_cast<unsigned char>(DTYPE_T));
+        boost::hash_combine(seed, s.m_status);
+        return seed;
+    }
+
+    static inline t_tscalar
+    add(const t_tscalar& a, const t_tscalar& b) {
+        static_assert(t_traits::ADDABLE, "t_tscalar::add does not sum this dtype");
+        if (!b.is_valid()) {
+            return a;
+        }
+        if (!a.is_valid()) {
+            return b;
+        }
+        t_tscalar rv;
+        rv.clear();
+        rv.set(static_cast<typename t_traits::t_value>(t_traits::get(a) + t_traits::get(b)));
+        return rv;
+    }
+};
+
+// `operator==` reads a bool alone rather than all of `m_data`.
+template <>
+inline bool
+t_tscalar_ops<DTYPE_BOOL>::eq(const t_tscalar& a, const t_tscalar& b) {
+    return a.m_status == b.m_status && a.m_data.m_bool == b.m_data.m_bool;
+}
+
+/**
+ * @brief `t_tscalar_ops` for strings, which compares the pointers of strings
+ * interned in one vocabulary before their characters.
+ */
+template <>
+struct t_tscalar_ops<DTYPE_STR> {
+    static inline const char*
+    chars(const t_tscalar& s) {
+        return s.m_inplace ? s.m_data.m_inplace_char : s.m_data.m_charptr;
+    }
+
+    static inline bool
+    eq(const t_tscalar& a, const t_tscalar& b) {
+        if (a.m_status != b.m_status) {
+            return false;
+        }
+        const char* x = chars(a);
+        const char* y = chars(b);
+        return x == y || std::strcmp(x, y) == 0;
+    }
+
+    static inline bool
+    lt(const t_tscalar& a, const t_tscalar& b) {
+        if (a.m_status != b.m_status) {
+            return a.m_status < b.m_status;
+        }
+        const char* x = chars(a);
+        const char* y = chars(b);
+        return x != y && std::strcmp(x, y) < 0;
+    }
+
+    static inline std::size_t
+    hash(const t_tscalar& s) {
+        std::size_t seed = 0;
+        const char* c = chars(s);
+        boost::hash_combine(seed, boost::hash_range(c, c + std::strlen(c)));
+        boost::hash_combine(seed, static_cast<unsigned char>(DTYPE_STR));
+        boost::hash_combine(seed, s.m_status);
+        return seed;
+    }
+};
+
 } // end namespace perspective
 
 namespace std {
@@ -0,0 +1,146 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2020, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#pragma once
+#include <perspective/first.h>
+#include <perspective/base.h>
+#include <perspective/exports.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace perspective {
+
+/**
+ * @brief A work-stealing task scheduler shared by the parallel paths of the
+ * engine - processing the columns of an update, notifying contexts,
+ * building trees, recomputing computed columns, loading tables and sorting -
+ * so that a process runs on one bounded set of worker threads rather than a
+ * set per call site.
+ *
+ * The scheduler is a `tbb::task_arena`, created on first use. Work submitted
+ * from inside a task runs on the arena of the scheduler that is running the
+ * task, so nested loops share its workers. Without `PSP_PARALLEL_FOR`, i.e.
+ * WASM without pthreads, and when set to one thread, every loop runs inline
+ * on the calling thread.
+ */
+class PERSPECTIVE_EXPORT t_scheduler {
+public:
+    PSP_NON_COPYABLE(t_scheduler);
+
+    t_scheduler();
+    ~t_scheduler();
+
+    /**
+     * @brief The scheduler of every `t_pool` that has not been given its
+     * own, and of engine work that does not run under a `t_pool`, such as
+     * loading a table.
+     *
+     * @return std::shared_ptr<t_scheduler>
+     */
+    static std::shared_ptr<t_scheduler> get_default();
+
+    /**
+     * @brief The scheduler running the task on the calling thread, or the
+     * default scheduler if the thread is not running one.
+     *
+     * @return t_scheduler&
+     */
+    static t_scheduler& current();
+
+    /**
+     * @brief Set the number of threads that run the scheduler's tasks,
+     * including the thread that submits them. `0` is one per core, and `1`
+     * runs every task inline. Loops already running finish on the previous
+     * threads.
+     *
+     * @param num_threads
+     */
+    void set_num_threads(t_uindex num_threads);
+    t_uindex get_num_threads() const;
+
+    /**
+     * @brief Pin the scheduler's worker threads to the CPUs `cpus`, or unpin
+     * them if `cpus` is empty. The threads that submit work are not pinned.
+     * This has no effect on macOS or in WASM.
+     *
+     * @param cpus
+     */
+    void set_affinity(const std::vector<t_uindex>& cpus);
+    std::vector<t_uindex> get_affinity() const;
+
+    /**
+     * @brief Bind the scheduler to NUMA node `node`, or unbind it if `node`
+     * is -1. Its worker threads are pinned to the CPUs of the node, unless
+     * pinned by `set_affinity`, and prefer the node's memory, as does a
+     * `t_pool` using the scheduler while it processes updates. The storage
+     * of the pool's gnodes, e.g. master tables and context trees, is then
+     * allocated on the node as it grows, on whichever thread touches it
+     * first. Storage allocated before the call is not moved. Memory is
+     * only preferred on Linux, and neither has an effect on macOS or in
+     * WASM.
+     *
+     * @param node
+     */
+    void set_numa_node(t_index node);
+    t_index get_numa_node() const;
+
+    /**
+     * @brief Returns whether tasks run inline on the calling thread.
+     */
+    bool is_inline() const;
+
+    /**
+     * @brief Returns the number of tasks that may run at once.
+     */
+    t_uindex max_concurrency() const;
+
+    /**
+     * @brief Run `task(0)` to `task(num_tasks - 1)`, returning once all of
+     * them have run. At most `max_concurrency` of the tasks run at once, or
+     * as many as the scheduler allows if it is `0`; `1` runs them inline.
+     *
+     * @param num_tasks
+     * @param task
+     * @param max_concurrency
+     */
+    void parallel_for(t_uindex num_tasks, const std::function<void(t_uindex)>& task,
+        t_uindex max_concurrency = 0);
+
+    /**
+     * @brief Run `fn` on the calling thread, inside the scheduler, so that
+     * any TBB algorithm it calls, e.g. `PSP_PSORT`, uses the scheduler's
+     * workers.
+     *
+     * @param fn
+     */
+    void execute(const std::function<void()>& fn);
+
+private:
+#ifdef PSP_PARALLEL_FOR
+    struct t_arena;
+
+    /**
+     * @brief Returns the arena for the current configuration, creating it if
+     * needed. Callers keep the arena alive while they use it, so that a
+     * reconfiguration never destroys an arena that is running tasks.
+     */
+    std::shared_ptr<t_arena> get_arena() const;
+
+    mutable std::shared_ptr<t_arena> m_arena;
+#endif
+
+    mutable std::mutex m_mtx;
+    t_uindex m_num_threads;
+    std::vector<t_uindex> m_affinity;
+    t_index m_numa_node;
+};
+
+} // end namespace perspective
@@ -0,0 +1,107 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2017, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#pragma once
+
+#include <perspective/first.h>
+#include <perspective/base.h>
+#include <perspective/exports.h>
+#include <perspective/scalar.h>
+#include <perspective/column.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace perspective {
+
+/**
+ * @brief One column of a `t_data_slice`, as a buffer of the column's type and
+ * a validity byte for each row, copied from a table's column without a
+ * `t_tscalar` for each cell.
+ *
+ * A string column holds the vocabulary id of each cell as an `int32`, with -1
+ * for nulls, and keeps the column whose vocabulary the ids index.
+ */
+class PERSPECTIVE_EXPORT t_slice_column {
+public:
+    t_slice_column();
+
+    /**
+     * @brief Copy the rows `rows` of `col`, where a row of -1 is null.
+     * `col` must be of a type for which `is_supported` is true.
+     *
+     * @param col
+     * @param rows
+     */
+    t_slice_column(std::shared_ptr<const t_column> col, const std::vector<t_index>& rows);
+
+    /**
+     * @brief Whether a column of `dtype` can be read into a `t_slice_column`.
+     *
+     * @param dtype
+     */
+    static bool is_supported(t_dtype dtype);
+
+    t_dtype get_dtype() const;
+    t_uindex size() const;
+
+    template <typename T>
+    const T*
+    get_values() const {
+        return reinterpret_cast<const T*>(m_data.data());
+    }
+
+    const std::uint8_t* get_valid() const;
+
+    /**
+     * @brief The validity of the cells as a bitmap in Arrow's layout,
+     * `(size() + 7) / 8` bytes long.
+     */
+    const std::uint8_t* get_valid_bitmap() const;
+    t_uindex get_null_count() const;
+
+    bool is_valid(t_uindex idx) const;
+
+    /**
+     * @brief Returns the cell at `idx` as `t_ctx0::get_data` reads it, which
+     * is none for a null.
+     *
+     * @param idx
+     */
+    t_tscalar get_scalar(t_uindex idx) const;
+
+    /**
+     * @brief The vocabulary the ids of a string column index.
+     */
+    const t_vocab& get_vocab() const;
+
+    /**
+     * @brief Write the cells into rows `[offset, offset + size())` of `dest`,
+     * a column of the same dtype, clearing those which are null. Strings are
+     * interned into `dest` once per distinct id, or written as ids if both
+     * columns share a vocabulary.
+     *
+     * @param dest
+     * @param offset
+     */
+    void write_into(t_column& dest, t_uindex offset = 0) const;
+
+    t_uindex nbytes() const;
+
+private:
+    t_dtype m_dtype;
+    t_uindex m_size;
+    std::vector<std::uint8_t> m_data;
+    std::vector<std::uint8_t> m_valid;
+    std::vector<std::uint8_t> m_valid_bitmap;
+    t_uindex m_null_count;
+    std::shared_ptr<const t_column> m_column;
+};
+
+} // end namespace perspective
@@ -0,0 +1,97 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#pragma once
+#include <perspective/first.h>
+#include <perspective/base.h>
+#include <perspective/exports.h>
+#include <perspective/scalar.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace perspective {
+
+/**
+ * @brief A row of a `t_ftrav`: its primary key, and the slot of its sort
+ * values in the traversal's `t_sort_arena`.
+ */
+struct PERSPECTIVE_EXPORT t_ftelem {
+    t_tscalar m_pkey;
+    t_uindex m_slot;
+};
+
+/**
+ * @brief The sort values of the rows of a `t_ftrav`, stored in buffers
+ * shared by every row rather than in a vector per row, so that sorting n rows
+ * does not allocate n times and comparing two rows reads contiguous memory.
+ *
+ * When the sort order can be encoded as normalized keys (see
+ * `is_sort_key_encodable`), each slot holds only its key, a span of one
+ * string of keys which is compacted once most of it belongs to released
+ * slots. Otherwise each slot holds its values, one per sort column, at
+ * `slot * ncols` of a row-major buffer. Released slots are reused.
+ */
+class PERSPECTIVE_EXPORT t_sort_arena {
+public:
+    PSP_NON_COPYABLE(t_sort_arena);
+
+    t_sort_arena();
+
+    /**
+     * @brief Release every slot and store values sorted by `sort_order` from
+     * now on.
+     */
+    void init(const std::vector<t_sorttype>& sort_order);
+
+    /**
+     * @brief Release every slot.
+     */
+    void clear();
+
+    const std::vector<t_sorttype>& get_sort_order() const;
+
+    /**
+     * @brief Store `row`, the sort values of the row `pkey`, one per sort
+     * column, and returns its slot.
+     */
+    t_uindex add(const t_tscalar* row, const t_tscalar& pkey);
+
+    void release(t_uindex slot);
+
+    /**
+     * @brief Returns whether `a` sorts before `b`, as `cmp_mselem` orders
+     * their values and primary keys.
+     */
+    bool less(const t_ftelem& a, const t_ftelem& b) const;
+
+    t_uindex nbytes() const;
+
+private:
+    void compact();
+
+    std::vector<t_sorttype> m_sort_order;
+    t_uindex m_ncols;
+    bool m_encodable;
+
+    // the values of each slot, if the sort order is not encodable
+    std::vector<t_tscalar> m_values;
+
+    // the key of each slot, if it is, as spans of `m_keys`; a released slot
+    // has an empty span, and `m_garbage` counts the bytes of released keys
+    std::string m_keys;
+    std::vector<t_uindex> m_key_offsets;
+    std::vector<std::uint32_t> m_key_sizes;
+    t_uindex m_garbage;
+
+    t_uindex m_nslots;
+    std::vector<t_uindex> m_free;
+};
+
+} // end namespace perspective
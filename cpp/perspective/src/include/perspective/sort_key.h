@@ -0,0 +1,63 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2017, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#pragma once
+
+#include <perspective/first.h>
+#include <perspective/base.h>
+#include <perspective/exports.h>
+#include <perspective/multi_sort.h>
+#include <perspective/scalar.h>
+#include <string>
+#include <vector>
+
+namespace perspective {
+
+/**
+ * @brief Returns whether `sort_order` can be encoded as a binary sort key,
+ * i.e. whether every column is sorted ascending or descending.
+ *
+ * The absolute and unsorted orders break ties on the primary key as soon as
+ * two values differ, so they are left to `cmp_mselem`.
+ */
+PERSPECTIVE_EXPORT bool is_sort_key_encodable(const std::vector<t_sorttype>& sort_order);
+
+/**
+ * @brief Encode the sort values, order and primary key of `elem` as a byte
+ * string that compares (as `memcmp` does) in the same order as
+ * `cmp_mselem`.
+ *
+ * Each value is written as its type, then its status, then its value in a
+ * big-endian, sign-adjusted form; strings are written with their
+ * terminator so that no key is a prefix of a key it should sort before.
+ * Descending columns are written with every byte inverted. As with
+ * `cmp_sort_value`, NaN sorts before every other value of its type in an
+ * ascending column and after them in a descending one, and `-0.0` is
+ * written as `0.0`, in every build.
+ *
+ * `sort_order` must be encodable (see `is_sort_key_encodable`).
+ */
+PERSPECTIVE_EXPORT void encode_sort_key(
+    const std::vector<t_sorttype>& sort_order, const t_mselem& elem, std::string& out);
+
+/**
+ * @brief Append the key `encode_sort_key` would encode for an element of
+ * the sort values `row`, one per column of `sort_order`, and of `order` and
+ * `pkey`, to `out`.
+ */
+PERSPECTIVE_EXPORT void append_sort_key(const std::vector<t_sorttype>& sort_order,
+    const t_tscalar* row, t_uindex order, const t_tscalar& pkey, std::string& out);
+
+/**
+ * @brief Set `elem.m_key` from its sort values if `sort_order` is encodable,
+ * and clear it otherwise.
+ */
+PERSPECTIVE_EXPORT void set_sort_key(const std::vector<t_sorttype>& sort_order, t_mselem& elem);
+
+} // end namespace perspective
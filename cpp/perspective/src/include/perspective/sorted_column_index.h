@@ -0,0 +1,113 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#pragma once
+#include <perspective/first.h>
+#include <perspective/base.h>
+#include <perspective/exports.h>
+#include <perspective/column.h>
+#include <perspective/scalar.h>
+#include <perspective/sort_arena.h>
+#include <perspective/sorted_index.h>
+#include <perspective/sym_table.h>
+#include <tsl/hopscotch_map.h>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace perspective {
+
+/**
+ * @brief The live rows of the master table in the order of one of its
+ * columns, ascending or descending, kept up to date by every update, so
+ * that a flat context sorted by the column reads its rows in order in O(n)
+ * rather than sorting them.
+ *
+ * Rows are ordered exactly as a `t_ftrav` sorted by the column orders them,
+ * by the same normalized keys, with ties broken by primary key. The index
+ * is keyed by primary key rather than by row, so it is unaffected by rows
+ * being compacted, and its keys copy the strings they encode, so it is
+ * unaffected by vocabularies being compacted.
+ */
+class PERSPECTIVE_EXPORT t_sorted_column_index {
+public:
+    PSP_NON_COPYABLE(t_sorted_column_index);
+
+    /**
+     * @brief An empty index of the column `colname` in `order`, which must
+     * be ascending or descending.
+     *
+     * @param colname
+     * @param order
+     */
+    t_sorted_column_index(const std::string& colname, t_sorttype order);
+
+    const std::string& get_colname() const;
+    t_sorttype get_order() const;
+
+    /**
+     * @brief Replace the contents of the index with `rows`, pairs of the
+     * primary key and the row of `column` which holds its value.
+     *
+     * @param column
+     * @param rows
+     */
+    void build(const t_column& column, const std::vector<std::pair<t_tscalar, t_uindex>>& rows);
+
+    /**
+     * @brief Set the value of `pkey`, moving it to its new place if it is
+     * indexed and inserting it if not.
+     *
+     * @param pkey
+     * @param value
+     */
+    void update(const t_tscalar& pkey, const t_tscalar& value);
+
+    void erase(const t_tscalar& pkey);
+
+    void clear();
+
+    bool contains(const t_tscalar& pkey) const;
+
+    t_uindex size() const;
+
+    /**
+     * @brief Call `fn` with the primary key of each row, in order.
+     *
+     * @param fn
+     */
+    template <typename FN_T>
+    void for_each_pkey(FN_T fn) const;
+
+    /**
+     * @brief Returns an estimate of the bytes used by the index.
+     */
+    t_uindex nbytes() const;
+
+private:
+    std::string m_colname;
+    t_sorttype m_order;
+    std::shared_ptr<t_sort_arena> m_arena;
+    t_sorted_index m_index;
+    tsl::hopscotch_map<t_tscalar, const t_sorted_index::t_node*> m_nodes;
+
+    // String primary keys, which outlive the rows they were read from.
+    t_symtable m_symtable;
+};
+
+template <typename FN_T>
+void
+t_sorted_column_index::for_each_pkey(FN_T fn) const {
+    for (auto node = m_index.select(0); node; node = t_sorted_index::next(node)) {
+        fn(node->m_elem.m_pkey);
+    }
+}
+
+} // end namespace perspective
@@ -0,0 +1,117 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2017, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#pragma once
+
+#include <perspective/first.h>
+#include <perspective/base.h>
+#include <perspective/exports.h>
+#include <perspective/sort_arena.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace perspective {
+
+/**
+ * @brief The rows of a `t_ftrav` in sort order, as an order-statistic tree
+ * (a treap whose nodes count the size of their subtree).
+ *
+ * Inserting or erasing a row, finding the position of a row and finding the
+ * row at a position are all O(log n), so an update only pays for the rows it
+ * touches rather than for re-merging the whole index.
+ *
+ * Elements are ordered by the sort values their slots hold in a
+ * `t_sort_arena`, which fall back to the primary key when they are equal,
+ * so no two rows compare equal.
+ */
+class PERSPECTIVE_EXPORT t_sorted_index {
+public:
+    struct t_node {
+        t_node(const t_ftelem& elem, std::uint32_t priority);
+
+        t_ftelem m_elem;
+        t_node* m_left;
+        t_node* m_right;
+        t_node* m_parent;
+        t_uindex m_size;
+        std::uint32_t m_priority;
+    };
+
+    PSP_NON_COPYABLE(t_sorted_index);
+
+    t_sorted_index(std::shared_ptr<const t_sort_arena> arena);
+    ~t_sorted_index();
+
+    /**
+     * @brief Replace the contents of the index with `elems`, which must
+     * already be sorted, in O(n).
+     */
+    void build(const std::vector<t_ftelem>& elems);
+
+    const t_node* insert(const t_ftelem& elem);
+
+    /**
+     * @brief Insert `elem`, which must sort after every element of the
+     * index, as its last element without comparing it to any of them.
+     */
+    const t_node* push_back(const t_ftelem& elem);
+
+    /**
+     * @brief Insert `elem`, which must sort before every element of the
+     * index, as its first element without comparing it to any of them.
+     */
+    const t_node* push_front(const t_ftelem& elem);
+
+    void erase(const t_node* node);
+
+    void clear();
+
+    t_uindex size() const;
+
+    /**
+     * @brief Returns the position of `node` in sort order.
+     */
+    t_uindex rank(const t_node* node) const;
+
+    /**
+     * @brief Returns the node at position `idx`, or null if `idx` is out of
+     * range.
+     */
+    const t_node* select(t_uindex idx) const;
+
+    /**
+     * @brief Returns the node after `node` in sort order, or null.
+     */
+    static const t_node* next(const t_node* node);
+
+    /**
+     * @brief Returns the position of the first element that does not sort
+     * before `elem`.
+     */
+    t_uindex lower_bound(const t_ftelem& elem) const;
+
+private:
+    static t_uindex subtree_size(const t_node* node);
+    static void update(t_node* node);
+    static void destroy(t_node* node);
+
+    void split(t_node* node, const t_ftelem& elem, t_node*& left, t_node*& right) const;
+    t_node* merge(t_node* left, t_node* right) const;
+    t_node* insert(t_node* root, t_node* node) const;
+    void fix_subtree(t_node* node);
+
+    std::uint32_t next_priority();
+
+    t_node* m_root;
+    std::shared_ptr<const t_sort_arena> m_arena;
+    std::uint32_t m_seed;
+};
+
+} // end namespace perspective
@@ -29,11 +29,17 @@ SUPPRESS_WARNINGS_VC(4503)
 #include <perspective/sym_table.h>
 #include <perspective/data_table.h>
 #include <perspective/dense_tree.h>
+#include <perspective/value_multiset.h>
+#include <perspective/hll_sketch.h>
+#include <perspective/tdigest.h>
+#include <perspective/rolling_window.h>
 #include <vector>
 #include <algorithm>
 #include <deque>
 #include <sstream>
 #include <queue>
+#include <unordered_map>
+#include <tsl/hopscotch_set.h>
 
 namespace perspective {
 
@@ -54,8 +60,6 @@ struct by_depth {};
 
 struct by_pidx {};
 
-struct by_pidx_hash {};
-
 struct by_nstrands {};
 
 struct by_idx_pkey {};
@@ -70,9 +74,84 @@ struct t_build_strand_table_common_rval {
     t_schema m_aggschema;
     t_uindex m_npivotlike;
     std::vector<std::string> m_pivot_like_columns;
+    // The column each pivot-like column is read from, and the function
+    // bucketing its values, empty unless its pivot is bucketed.
+    std::vector<std::string> m_pivot_like_sources;
+    std::vector<std::function<t_tscalar(t_tscalar)>> m_pivot_like_buckets;
     t_uindex m_pivsize;
+    // Number of leading aggschema columns (dependencies and
+    // psp_strand_count) that are copied from the input tables.
+    t_uindex m_aggcolsize;
+    std::vector<t_aggspec> m_running_aggs;
+    std::vector<t_aggspec> m_multiset_aggs;
+    std::vector<t_aggspec> m_rolling_aggs;
+};
+
+// Columns read and written for a single running aggregate while building
+// the strand delta table. The prev/current columns are null when the
+// strand table is built from a flattened table alone.
+struct t_running_agg_cols {
+    t_aggtype m_agg;
+    const t_column* m_fvalue;
+    const t_column* m_pvalue;
+    const t_column* m_cvalue;
+    const t_column* m_fweight;
+    const t_column* m_pweight;
+    const t_column* m_cweight;
+    t_column* m_nr;
+    t_column* m_dr;
+};
+
+// Columns read and written for a single multiset aggregate while building
+// the strand delta table. `m_op` flags whether each strand adds its `m_add`
+// value (`MULTISET_OP_ADD`) and/or removes its `m_sub` value
+// (`MULTISET_OP_SUB`) from the multiset of every node above it.
+struct t_multiset_agg_cols {
+    t_dtype m_dtype;
+    const t_column* m_fvalue;
+    const t_column* m_pvalue;
+    const t_column* m_cvalue;
+    t_column* m_add;
+    t_column* m_sub;
+    t_column* m_op;
+};
+
+// Columns read and written for a single rolling aggregate while building
+// the strand delta table. Each strand adds the time, numerator and
+// denominator `m_add_*` to the window of every node above it, and removes
+// `m_sub_*`; a NaN time adds or removes nothing.
+struct t_rolling_agg_cols {
+    t_aggtype m_agg;
+    const t_column* m_fvalue;
+    const t_column* m_pvalue;
+    const t_column* m_cvalue;
+    const t_column* m_ftime;
+    const t_column* m_ptime;
+    const t_column* m_ctime;
+    const t_column* m_fweight;
+    const t_column* m_pweight;
+    const t_column* m_cweight;
+    t_column* m_add_t;
+    t_column* m_add_nr;
+    t_column* m_add_dr;
+    t_column* m_sub_t;
+    t_column* m_sub_nr;
+    t_column* m_sub_dr;
+};
+
+// The columns of `t_rolling_agg_cols` as read back from the strand delta
+// table.
+struct t_rolling_agg_src {
+    const t_column* m_add_t;
+    const t_column* m_add_nr;
+    const t_column* m_add_dr;
+    const t_column* m_sub_t;
+    const t_column* m_sub_nr;
+    const t_column* m_sub_dr;
 };
 
+enum t_multiset_op : std::int8_t { MULTISET_OP_ADD = 1, MULTISET_OP_SUB = 2 };
+
 typedef multi_index_container<t_stnode,
     indexed_by<ordered_unique<tag<by_idx>, BOOST_MULTI_INDEX_MEMBER(t_stnode, t_uindex, m_idx)>,
         hashed_non_unique<tag<by_depth>,
@@ -82,9 +161,6 @@ typedef multi_index_container<t_stnode,
         ordered_unique<tag<by_pidx>,
             composite_key<t_stnode, BOOST_MULTI_INDEX_MEMBER(t_stnode, t_uindex, m_pidx),
                 BOOST_MULTI_INDEX_MEMBER(t_stnode, t_tscalar, m_sort_value),
-                BOOST_MULTI_INDEX_MEMBER(t_stnode, t_tscalar, m_value)>>,
-        ordered_unique<tag<by_pidx_hash>,
-            composite_key<t_stnode, BOOST_MULTI_INDEX_MEMBER(t_stnode, t_uindex, m_pidx),
                 BOOST_MULTI_INDEX_MEMBER(t_stnode, t_tscalar, m_value)>>>>
     t_treenodes;
 
@@ -105,7 +181,6 @@ typedef t_treenodes::index<by_pidx>::type index_by_pidx;
 
 typedef t_treenodes::index<by_idx>::type::iterator iter_by_idx;
 typedef t_treenodes::index<by_pidx>::type::iterator iter_by_pidx;
-typedef t_treenodes::index<by_pidx_hash>::type::iterator iter_by_pidx_hash;
 typedef std::pair<iter_by_pidx, iter_by_pidx> t_by_pidx_ipair;
 
 typedef t_idxpkey::index<by_idx_pkey>::type::iterator iter_by_idx_pkey;
@@ -117,7 +192,31 @@ struct PERSPECTIVE_EXPORT t_agg_update_info {
     std::vector<t_column*> m_dst;
     std::vector<t_aggspec> m_aggspecs;
 
+    // Running numerator/denominator sums per dtree node, null for
+    // aggregates which are not running aggregates.
+    std::vector<const t_column*> m_src_running_nr;
+    std::vector<const t_column*> m_src_running_dr;
+
+    // Added/removed values and op flags per strand, null for aggregates
+    // which are not multiset aggregates.
+    std::vector<const t_column*> m_src_multiset_add;
+    std::vector<const t_column*> m_src_multiset_sub;
+    std::vector<const t_column*> m_src_multiset_op;
+
+    // Added/removed times and partial sums per strand, null for aggregates
+    // which are not rolling aggregates.
+    std::vector<t_rolling_agg_src> m_src_rolling;
+
+    // The node and aggregate row of each node updated since the reducer of
+    // a UDF reducer aggregate was last called, empty for other aggregates.
+    std::vector<std::vector<std::pair<t_uindex, t_uindex>>> m_reducer_nodes;
+    const t_dtree_ctx* m_dctx;
+
     std::vector<t_uindex> m_dst_topo_sorted;
+
+    // Whether nodes are updated after their children, so that aggregates
+    // which scan leaves may be rolled up from the children instead.
+    bool m_children_first = false;
 };
 
 struct t_tree_unify_rec {
@@ -159,30 +258,93 @@ public:
         const std::vector<const t_column*>& agg_ccols,
         const std::vector<const t_column*>& agg_dcols, std::vector<t_column*>& piv_scols,
         std::vector<t_column*>& agg_acols, t_column* agg_scountspar, t_column* spkey,
-        t_uindex& insert_count, bool& pivots_neq,
-        const std::vector<std::string>& pivot_like) const;
+        t_uindex& insert_count, bool& pivots_neq, const std::vector<std::string>& pivot_like,
+        const std::vector<std::function<t_tscalar(t_tscalar)>>& pivot_buckets) const;
 
     void build_strand_table_phase_2(t_tscalar pkey, t_uindex idx, t_uindex npivots,
         t_uindex strand_count_idx, t_uindex aggcolsize,
         const std::vector<const t_column*>& piv_pcols,
         const std::vector<const t_column*>& agg_pcols, std::vector<t_column*>& piv_scols,
         std::vector<t_column*>& agg_acols, t_column* agg_scount, t_column* spkey,
-        t_uindex& insert_count, const std::vector<std::string>& pivot_like) const;
+        t_uindex& insert_count, const std::vector<std::string>& pivot_like,
+        const std::vector<std::function<t_tscalar(t_tscalar)>>& pivot_buckets) const;
 
     std::pair<std::shared_ptr<t_data_table>, std::shared_ptr<t_data_table>> build_strand_table(
         const t_data_table& flattened, const t_data_table& delta, const t_data_table& prev,
         const t_data_table& current, const t_data_table& transitions,
-        const std::vector<t_aggspec>& aggspecs, const t_config& config) const;
+        const t_data_table& existed, const std::vector<t_aggspec>& aggspecs,
+        const t_config& config) const;
 
     std::pair<std::shared_ptr<t_data_table>, std::shared_ptr<t_data_table>> build_strand_table(
         const t_data_table& flattened, const std::vector<t_aggspec>& aggspecs,
         const t_config& config) const;
 
+    /**
+     * @brief Build the strand table for rows `[bidx, eidx)` of `flattened`
+     * only. `msk`, if not null, is the config's filter mask over all of
+     * `flattened`, so that partitions of one table can share it.
+     */
+    std::pair<std::shared_ptr<t_data_table>, std::shared_ptr<t_data_table>> build_strand_table(
+        const t_data_table& flattened, const t_mask* msk, t_uindex bidx, t_uindex eidx,
+        const std::vector<t_aggspec>& aggspecs, const t_config& config) const;
+
     void update_shape_from_static(const t_dtree_ctx& ctx);
     void update_aggs_from_static(const t_dtree_ctx& ctx, const t_gstate& gstate);
 
+    /**
+     * @brief Aggregate lazily below `depth`: a node deeper than `depth` is
+     * only kept up to date once its parent has been opened with
+     * `materialize_children`, and is otherwise left stale by updates.
+     * Pass `LAZY_DEPTH_NONE` to aggregate every node.
+     *
+     * Increasing the depth does not bring the newly eager nodes up to date;
+     * call `materialize` with the new depth first.
+     */
+    void set_lazy_depth(t_depth depth);
+    t_depth get_lazy_depth() const;
+
+    static const t_depth LAZY_DEPTH_NONE;
+
+    /**
+     * @brief Whether the aggregates of node `nidx` are kept up to date.
+     */
+    bool is_aggregated(t_uindex nidx) const;
+
+    /**
+     * @brief Recompute the stale aggregates of every node up to `depth`
+     * from the rows of `gstate`.
+     */
+    void materialize(t_depth depth, const t_gstate& gstate, const t_config& config);
+
+    /**
+     * @brief Recompute the stale aggregates of the children of `nidx`, and
+     * keep them up to date from now on.
+     */
+    void materialize_children(t_uindex nidx, const t_gstate& gstate, const t_config& config);
+
+    /**
+     * @brief Aggregate lazily below `depth` with only the nodes in `open`
+     * opened, releasing the aggregates of every node that is no longer kept
+     * up to date, which `materialize_children` recomputes. Nodes which were
+     * stale stay stale, so every child of a node in `open` must be
+     * aggregated now.
+     */
+    void reclaim(t_depth depth, const std::set<t_uindex>& open);
+
     t_uindex size() const;
 
+    /**
+     * @brief Returns the number of nodes at each depth of the tree, from the
+     * root at depth 0 to the leaves at `last_level()`.
+     */
+    std::vector<t_uindex> get_num_nodes_by_depth() const;
+
+    /**
+     * @brief Returns an estimate of the bytes used by the nodes and indices
+     * of the tree, not counting the aggregate table.
+     */
+    t_uindex nbytes() const;
+
     t_uindex get_num_children(t_uindex idx) const;
     void get_child_nodes(t_uindex idx, t_tnodevec& nodes) const;
     std::vector<t_uindex> zero_strands() const;
@@ -207,12 +369,29 @@ public:
     t_tnode get_node(t_uindex idx) const;
 
     void get_path(t_uindex idx, std::vector<t_tscalar>& path) const;
+
+    /**
+     * @brief Returns the path of the node `idx`, deepest value first, without
+     * copying it.
+     */
+    const std::vector<t_tscalar>& get_path(t_uindex idx) const;
+
     void get_sortby_path(t_uindex idx, std::vector<t_tscalar>& path) const;
 
     t_uindex resolve_child(t_uindex root, const t_tscalar& datum) const;
 
     void drop_zero_strands();
 
+    /**
+     * @brief Move the aggregate rows of the nodes into breadth-first order,
+     * so that the rows of each depth are contiguous and siblings adjacent in
+     * their sort order, and reading a level of the tree is a sequential
+     * scan. Rows allocated since are appended, so the tree relays its rows
+     * out again once `t_env::agg_relayout_ratio` of them have been
+     * allocated or freed.
+     */
+    void relayout_aggregates();
+
     void add_pkey(t_uindex idx, t_tscalar pkey);
     void remove_pkey(t_uindex idx, t_tscalar pkey);
     void add_leaf(t_uindex nidx, t_uindex lfidx);
@@ -259,6 +438,21 @@ public:
 
     const std::shared_ptr<t_tcdeltas>& get_deltas() const;
 
+    /**
+     * @brief Returns the nodes whose aggregates have changed, or been
+     * materialized, since `clear_updated`, whose traversals may need to
+     * re-sort them among their siblings.
+     */
+    const tsl::hopscotch_set<t_uindex>& get_updated() const;
+
+    /**
+     * @brief Returns the nodes removed by `drop_zero_strands` since
+     * `clear_updated`, as they lost their last row.
+     */
+    const std::vector<t_uindex>& get_dropped() const;
+
+    void clear_updated();
+
     void clear();
 
     t_tscalar first_last_helper(
@@ -291,21 +485,83 @@ protected:
     t_uindex genidx();
     t_uindex gen_aggidx();
     std::vector<t_uindex> get_children(t_uindex idx) const;
-    void update_agg_table(t_uindex nidx, t_agg_update_info& info, t_uindex src_ridx,
+    // Returns whether any of the node's aggregates changed.
+    bool update_agg_table(t_uindex nidx, t_agg_update_info& info, t_uindex src_ridx,
         t_uindex dst_ridx, t_index nstrands, const t_gstate& gstate);
 
     bool is_leaf(t_uindex nidx) const;
 
+    /**
+     * @brief Roll up the AND, OR or ANY aggregate of the aggregated children
+     * of `nidx` from `dst` into `out`, rather than scan the rows under
+     * `nidx`. Returns false, leaving `out` as it is, if `nidx` is a leaf,
+     * its children are stale, or the aggregate is an OR or ANY of values
+     * other than booleans, as these keep the first truthy row's value.
+     */
+    bool roll_up_children(
+        t_uindex nidx, t_aggtype agg, const t_column* dst, t_tscalar& out) const;
+
     t_build_strand_table_common_rval build_strand_table_common(const t_data_table& flattened,
         const std::vector<t_aggspec>& aggspecs, const t_config& config) const;
 
+    std::vector<t_running_agg_cols> get_running_agg_cols(
+        const t_build_strand_table_common_rval& rv, const t_data_table& flattened,
+        const t_data_table* prev, const t_data_table* current, t_data_table& aggs) const;
+
+    void build_strand_table_running(t_uindex idx, bool add_current, bool sub_prev,
+        std::vector<t_running_agg_cols>& running_cols) const;
+
+    std::vector<t_multiset_agg_cols> get_multiset_agg_cols(
+        const t_build_strand_table_common_rval& rv, const t_data_table& flattened,
+        const t_data_table* prev, const t_data_table* current, t_data_table& aggs) const;
+
+    void build_strand_table_multiset(t_uindex idx, bool add_current, bool sub_prev,
+        std::vector<t_multiset_agg_cols>& multiset_cols) const;
+
+    std::vector<t_rolling_agg_cols> get_rolling_agg_cols(
+        const t_build_strand_table_common_rval& rv, const t_data_table& flattened,
+        const t_data_table* prev, const t_data_table* current, t_data_table& aggs) const;
+
+    void build_strand_table_rolling(t_uindex idx, bool add_current, bool sub_prev,
+        std::vector<t_rolling_agg_cols>& rolling_cols) const;
+
     void populate_pkey_idx(const t_dtree_ctx& ctx, const t_dtree& dtree, t_uindex dptidx,
         t_uindex sptidx, t_uindex ndepth, t_idxpkey& new_idx_pkey);
 
 private:
+    void build_agg_update_info(const t_dtree_ctx& ctx, t_agg_update_info& info) const;
+    void materialize_below(
+        t_uindex nidx, t_depth depth, const t_gstate& gstate, const t_config& config);
+    void reset_aggregates(const std::vector<t_uindex>& indices);
+
+    t_value_multiset& update_multiset(
+        const t_agg_update_info& info, t_uindex idx, t_uindex src_ridx, t_uindex dst_ridx);
+
+    t_hll_sketch& update_sketch(const t_agg_update_info& info, t_uindex idx, t_uindex src_ridx,
+        t_uindex dst_ridx, t_uindex nidx, const t_gstate& gstate);
+
+    t_tdigest& update_digest(const t_agg_update_info& info, t_uindex idx, t_uindex src_ridx,
+        t_uindex dst_ridx, t_uindex nidx, const t_gstate& gstate);
+
+    void update_window(
+        const t_agg_update_info& info, t_uindex idx, t_uindex src_ridx, t_uindex dst_ridx);
+    t_tscalar get_rolling_value(const t_aggspec& spec, t_uindex idx, t_uindex dst_ridx) const;
+    void update_rolling_now(const t_agg_update_info& info);
+    void expire_windows(const t_agg_update_info& info, const std::vector<double>& prev_now);
+
+    /**
+     * @brief Call the reducer of each UDF reducer aggregate once, with the
+     * leaf values of all of the nodes `update_agg_table` has queued for it,
+     * and write back their aggregates.
+     */
+    void update_reducers(t_agg_update_info& info, const t_gstate& gstate);
+
     std::vector<t_pivot> m_pivots;
     bool m_init;
+    // `m_nodes` orders nodes for traversal; `m_nodestore` serves lookups of
+    // a single node by index or by parent and value.
     std::shared_ptr<t_treenodes> m_nodes;
+    t_stnode_store m_nodestore;
     std::shared_ptr<t_idxpkey> m_idxpkey;
     std::shared_ptr<t_idxleaf> m_idxleaf;
     t_uindex m_curidx;
@@ -314,13 +570,33 @@ private:
     t_schema m_schema;
     std::vector<t_uindex> m_agg_freelist;
     t_uindex m_cur_aggidx;
+    // Aggregate rows allocated or freed since the last relayout.
+    t_uindex m_agg_churn;
     std::set<t_uindex> m_newids;
     std::set<t_uindex> m_newleaves;
+    tsl::hopscotch_set<t_uindex> m_updated;
+    std::vector<t_uindex> m_dropped;
     t_sidxmap m_smap;
     std::vector<const t_column*> m_aggcols;
     std::shared_ptr<t_tcdeltas> m_deltas;
     std::vector<t_minmax> m_minmax;
     t_tree_unify_rec_vec m_tree_unification_records;
+    // Per aggregate column, the value multiset of each aggregate row, for
+    // multiset aggregates only.
+    std::vector<std::unordered_map<t_uindex, t_value_multiset>> m_multisets;
+    // Per aggregate column, the sketch or digest of each aggregate row, for
+    // sketch aggregates only.
+    std::vector<std::unordered_map<t_uindex, t_hll_sketch>> m_sketches;
+    std::vector<std::unordered_map<t_uindex, t_tdigest>> m_digests;
+    // Per aggregate column, the window of each aggregate row, and the latest
+    // time seen, from which the windows of every row end, for rolling
+    // aggregates only.
+    std::vector<std::unordered_map<t_uindex, t_rolling_window>> m_windows;
+    std::vector<double> m_rolling_now;
+    // Nodes deeper than `m_lazy_depth` are aggregated only if their parent
+    // is in `m_open`.
+    t_depth m_lazy_depth;
+    std::set<t_uindex> m_open;
     std::vector<bool> m_features;
     t_symtable m_symtable;
     bool m_has_delta;
@@ -332,27 +608,21 @@ t_minmax
 t_stree::get_agg_min_max(ITER_T biter, ITER_T eiter, t_uindex aggidx) const {
     auto aggcols = m_aggregates->get_const_columns();
     auto col = aggcols[aggidx];
-    t_minmax minmax;
 
+    // Gather the aggregate rows of the nodes, then fold over the column's
+    // typed buffer rather than comparing scalars node by node.
+    std::vector<t_uindex> agg_indices;
     for (auto iter = biter; iter != eiter; ++iter) {
-        if (iter->m_idx == 0)
+        if (iter->m_idx == 0 || !is_aggregated(iter->m_idx))
             continue;
-        t_uindex aggidx = iter->m_aggidx;
-        t_tscalar v = col->get_scalar(aggidx);
-
-        if (minmax.m_min.is_none()) {
-            minmax.m_min = v;
-        } else {
-            minmax.m_min = std::min(v, minmax.m_min);
-        }
-
-        if (minmax.m_max.is_none()) {
-            minmax.m_max = v;
-        } else {
-            minmax.m_max = std::max(v, minmax.m_max);
-        }
+        agg_indices.push_back(iter->m_aggidx);
     }
-    return minmax;
+
+    // Read the rows in order, which is a sequential scan of a level once
+    // the tree has been relaid out.
+    std::sort(agg_indices.begin(), agg_indices.end());
+
+    return get_column_min_max(*col, agg_indices);
 }
 
 } // end namespace perspective
@@ -11,6 +11,8 @@
 #include <perspective/first.h>
 #include <perspective/base.h>
 #include <perspective/scalar.h>
+#include <tsl/hopscotch_map.h>
+#include <vector>
 
 namespace perspective {
 struct PERSPECTIVE_EXPORT t_stnode {
@@ -33,6 +35,102 @@ struct PERSPECTIVE_EXPORT t_stnode {
 
 typedef std::vector<t_stnode> t_stnode_vec;
 
+/**
+ * @brief Contiguous per-field arrays of the nodes of a `t_stree`, indexed
+ * directly by node index, with a hash of `(pidx, value)` to resolve a child
+ * of a node from its value without walking an ordered index.
+ *
+ * The path of each node is kept alongside it, along with a hash of the
+ * paths, so that a node is resolved from its path and a path is read
+ * without walking the node's ancestors. The root is node 0.
+ */
+class PERSPECTIVE_EXPORT t_stnode_store {
+public:
+    // The index `find_child` and `find_path` return for a node which does
+    // not exist, `INVALID_INDEX` as a `t_uindex`.
+    static const t_uindex NOT_FOUND = static_cast<t_uindex>(INVALID_INDEX);
+
+    t_stnode_store();
+
+    /**
+     * @brief Add `node`, or overwrite the node with the same index.
+     */
+    void insert(const t_stnode& node);
+
+    void erase(t_uindex idx);
+
+    void clear();
+
+    /**
+     * @brief Returns the number of bytes allocated for the nodes, their
+     * paths and the child and path indices.
+     */
+    t_uindex nbytes() const;
+
+    bool contains(t_uindex idx) const;
+
+    /**
+     * @brief Return the index of the child of `pidx` whose value is `value`,
+     * or `NOT_FOUND` if it does not exist.
+     */
+    t_uindex find_child(t_uindex pidx, const t_tscalar& value) const;
+
+    t_stnode get_node(t_uindex idx) const;
+
+    /**
+     * @brief Return the index of the node reached from `root` through
+     * `path`, which lists the values of the nodes deepest first as
+     * `get_path` does, or `NOT_FOUND` if it does not exist.
+     */
+    t_uindex find_path(t_uindex root, const std::vector<t_tscalar>& path) const;
+
+    /**
+     * @brief Return the values of `idx` and its ancestors below the root,
+     * deepest first.
+     */
+    const std::vector<t_tscalar>& get_path(t_uindex idx) const { return m_path[idx]; }
+
+    t_uindex get_pidx(t_uindex idx) const { return m_pidx[idx]; }
+    std::uint8_t get_depth(t_uindex idx) const { return m_depth[idx]; }
+    const t_tscalar& get_value(t_uindex idx) const { return m_value[idx]; }
+    const t_tscalar& get_sort_value(t_uindex idx) const { return m_sort_value[idx]; }
+    t_uindex get_nstrands(t_uindex idx) const { return m_nstrands[idx]; }
+    t_uindex get_aggidx(t_uindex idx) const { return m_aggidx[idx]; }
+    void set_aggidx(t_uindex idx, t_uindex aggidx) { m_aggidx[idx] = aggidx; }
+
+private:
+    struct t_child_key {
+        t_uindex m_pidx;
+        t_tscalar m_value;
+
+        bool operator==(const t_child_key& other) const;
+    };
+
+    struct t_child_key_hash {
+        std::size_t operator()(const t_child_key& key) const;
+    };
+
+    static std::size_t hash_scalar(const t_tscalar& value);
+    static std::size_t hash_path_step(std::size_t parent_hash, const t_tscalar& value);
+
+    void index_path(t_uindex idx);
+    void unindex_path(t_uindex idx);
+
+    std::vector<t_uindex> m_pidx;
+    std::vector<std::uint8_t> m_depth;
+    std::vector<t_tscalar> m_value;
+    std::vector<t_tscalar> m_sort_value;
+    std::vector<t_uindex> m_nstrands;
+    std::vector<t_uindex> m_aggidx;
+    std::vector<std::uint8_t> m_exists;
+    tsl::hopscotch_map<t_child_key, t_uindex, t_child_key_hash> m_children;
+    std::vector<std::vector<t_tscalar>> m_path;
+    std::vector<std::size_t> m_path_hash;
+    // Node index by path hash, or `NOT_FOUND` where two paths share a
+    // hash, which `find_path` then resolves level by level.
+    tsl::hopscotch_map<std::size_t, t_uindex> m_paths;
+};
+
 struct PERSPECTIVE_EXPORT t_stpkey {
     t_stpkey(t_uindex idx, t_tscalar pkey);
     t_stpkey();
@@ -12,55 +12,168 @@
 #include <perspective/base.h>
 #include <perspective/scalar.h>
 #include <perspective/exports.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <utility>
 #include <vector>
 #include <tsl/hopscotch_set.h>
-#include <boost/multi_index_container.hpp>
-#include <boost/multi_index/member.hpp>
-#include <boost/multi_index/hashed_index.hpp>
-#include <boost/multi_index/ordered_index.hpp>
-#include <boost/multi_index/composite_key.hpp>
-#include <boost/variant/apply_visitor.hpp>
 
 namespace perspective {
 
-using boost::multi_index_container;
-using namespace boost::multi_index;
-
 // Deltas for various contexts
 
 struct t_zcdelta {
+    typedef t_tscalar t_row_key;
+
     t_zcdelta(t_tscalar pkey, t_index colidx, t_tscalar old_value, t_tscalar new_value);
 
+    const t_row_key&
+    row_key() const {
+        return m_pkey;
+    }
+
+    bool
+    operator<(const t_zcdelta& other) const {
+        return m_pkey < other.m_pkey || (m_pkey == other.m_pkey && m_colidx < other.m_colidx);
+    }
+
     t_tscalar m_pkey;
     t_index m_colidx;
     t_tscalar m_old_value;
     t_tscalar m_new_value;
 };
 
-struct by_zc_pkey_colidx {};
-
-typedef multi_index_container<t_zcdelta,
-    indexed_by<ordered_unique<tag<by_zc_pkey_colidx>,
-        composite_key<t_zcdelta, BOOST_MULTI_INDEX_MEMBER(t_zcdelta, t_tscalar, m_pkey),
-            BOOST_MULTI_INDEX_MEMBER(t_zcdelta, t_index, m_colidx)>>>>
-    t_zcdeltas;
-
 struct t_tcdelta {
+    typedef t_uindex t_row_key;
+
     t_tcdelta(t_uindex nidx, t_uindex aggidx, t_tscalar old_value, t_tscalar new_value);
 
+    const t_row_key&
+    row_key() const {
+        return m_nidx;
+    }
+
+    bool
+    operator<(const t_tcdelta& other) const {
+        return m_nidx < other.m_nidx || (m_nidx == other.m_nidx && m_aggidx < other.m_aggidx);
+    }
+
     t_uindex m_nidx;
     t_uindex m_aggidx;
     t_tscalar m_old_value;
     t_tscalar m_new_value;
 };
 
-struct by_tc_nidx_aggidx {};
+/**
+ * @brief The changed cells of a context, appended to a flat vector as they
+ * change and, when next read, sorted by row and column with only the first
+ * delta of each cell kept. Appending a delta allocates only to grow the
+ * vector, whose capacity `clear` keeps for the next step, rather than a
+ * node per delta as an ordered container would.
+ */
+template <typename DELTA_T>
+class t_deltas {
+public:
+    typedef typename DELTA_T::t_row_key t_row_key;
+    typedef typename std::vector<DELTA_T>::const_iterator const_iterator;
+
+    t_deltas()
+        : m_sorted(true) {}
+
+    void
+    insert(const DELTA_T& delta) {
+        m_deltas.push_back(delta);
+        m_sorted = false;
+    }
+
+    void
+    clear() {
+        m_deltas.clear();
+        m_sorted = true;
+    }
+
+    bool
+    empty() const {
+        return m_deltas.empty();
+    }
+
+    t_uindex
+    size() const {
+        ensure_sorted();
+        return m_deltas.size();
+    }
+
+    const_iterator
+    begin() const {
+        ensure_sorted();
+        return m_deltas.begin();
+    }
+
+    const_iterator
+    end() const {
+        ensure_sorted();
+        return m_deltas.end();
+    }
+
+    /**
+     * @brief The delta of the highest row and column.
+     */
+    const DELTA_T&
+    back() const {
+        ensure_sorted();
+        return m_deltas.back();
+    }
+
+    /**
+     * @brief Returns the deltas of the cells of `row`, ordered by column.
+     */
+    std::pair<const_iterator, const_iterator>
+    equal_range(const t_row_key& row) const {
+        ensure_sorted();
+        return std::equal_range(m_deltas.begin(), m_deltas.end(), row, t_row_less());
+    }
+
+private:
+    struct t_row_less {
+        bool
+        operator()(const DELTA_T& a, const t_row_key& b) const {
+            return a.row_key() < b;
+        }
+
+        bool
+        operator()(const t_row_key& a, const DELTA_T& b) const {
+            return a < b.row_key();
+        }
+    };
+
+    // Contexts read their deltas from const methods, which may run
+    // concurrently, so the first of them to read sorts under a lock.
+    void
+    ensure_sorted() const {
+        if (m_sorted) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mtx);
+        if (m_sorted) {
+            return;
+        }
+
+        std::stable_sort(m_deltas.begin(), m_deltas.end());
+        auto last = std::unique(m_deltas.begin(), m_deltas.end(),
+            [](const DELTA_T& a, const DELTA_T& b) { return !(a < b) && !(b < a); });
+        m_deltas.erase(last, m_deltas.end());
+        m_sorted = true;
+    }
+
+    mutable std::vector<DELTA_T> m_deltas;
+    mutable std::atomic<bool> m_sorted;
+    mutable std::mutex m_mtx;
+};
 
-typedef multi_index_container<t_tcdelta,
-    indexed_by<ordered_unique<tag<by_tc_nidx_aggidx>,
-        composite_key<t_tcdelta, BOOST_MULTI_INDEX_MEMBER(t_tcdelta, t_uindex, m_nidx),
-            BOOST_MULTI_INDEX_MEMBER(t_tcdelta, t_uindex, m_aggidx)>>>>
-    t_tcdeltas;
+typedef t_deltas<t_zcdelta> t_zcdeltas;
+typedef t_deltas<t_tcdelta> t_tcdeltas;
 
 struct PERSPECTIVE_EXPORT t_cellupd {
     t_cellupd(
@@ -95,6 +208,32 @@ struct PERSPECTIVE_EXPORT t_rowdelta {
     std::vector<t_tscalar> data;
 };
 
+/**
+ * @brief The rows `[m_start_row, m_end_row)` and columns
+ * `[m_start_col, m_end_col)` of a context that a client renders, in the same
+ * coordinates as the context's `get_data`. Step and row deltas only report
+ * changes that intersect it; by default it covers the whole context.
+ */
+struct PERSPECTIVE_EXPORT t_viewport {
+    t_viewport();
+
+    t_viewport(t_uindex start_row, t_uindex end_row, t_uindex start_col, t_uindex end_col);
+
+    bool contains_row(t_uindex ridx) const;
+    bool contains_column(t_uindex cidx) const;
+    bool is_unbounded() const;
+
+    /**
+     * @brief Narrow the rows `[bidx, eidx)` to those inside the viewport.
+     */
+    void clip_rows(t_index& bidx, t_index& eidx) const;
+
+    t_uindex m_start_row;
+    t_uindex m_end_row;
+    t_uindex m_start_col;
+    t_uindex m_end_col;
+};
+
 } // end namespace perspective
 
 namespace std {
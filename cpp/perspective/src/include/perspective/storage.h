@@ -15,6 +15,8 @@
 #include <perspective/mask.h>
 #include <perspective/compat.h>
 #include <perspective/debug_helpers.h>
+#include <perspective/alloc_stats.h>
+#include <perspective/allocator.h>
 #include <cmath>
 
 
@@ -60,6 +62,12 @@ struct PERSPECTIVE_EXPORT t_lstore_recipe {
     t_fflag m_mflags;
     t_backing_store m_backing_store;
     bool m_from_recipe;
+    t_page_policy m_page_policy;
+    // Factor by which the capacity at least grows when the store runs out
+    // of room, so that stores grown an element at a time are copied a
+    // logarithmic number of times.
+    double m_growth_factor;
+    t_alloc_owner m_alloc_owner;
 };
 
 typedef std::vector<t_lstore_recipe> t_lstore_argvec;
@@ -122,8 +130,31 @@ public:
     void reserve(t_uindex capacity);
     void shrink(t_uindex capacity);
     void copy(t_lstore& out);
+
+    /**
+     * @brief Count the store's allocations under `owner` from now on,
+     * moving its live bytes to `owner` (see `t_alloc_stats`).
+     *
+     * @param owner
+     */
+    void set_alloc_owner(t_alloc_owner owner);
+    t_alloc_owner get_alloc_owner() const;
+
     void load(const std::string& fname);
     void save(const std::string& fname);
+
+    /**
+     * @brief Read the first `size` bytes of the file `fname`, written by
+     * `save`, from a read-only mapping of it rather than copying them, so
+     * that memory only holds the pages read since. The mapping is borrowed
+     * (see `borrow`), so it is copied into an allocation of the store's own
+     * by the first call to a non-const accessor or mutator. Only supported
+     * for `BACKING_STORE_MEMORY`.
+     *
+     * @param fname
+     * @param size in bytes
+     */
+    void map(const std::string& fname, t_uindex size);
     void warmup();
 
     t_uindex size() const;
@@ -194,6 +225,50 @@ public:
 
     std::shared_ptr<t_lstore> clone() const;
 
+    /**
+     * @brief Point the store at `size` bytes of memory owned by `owner`,
+     * freeing the store's own allocation, so that a buffer with the same
+     * layout can be read without copying it. The store holds a reference to
+     * `owner` until the first call to a non-const accessor or mutator, which
+     * copies the memory into an allocation of the store's own first (i.e.
+     * copy-on-write). Only supported for `BACKING_STORE_MEMORY`.
+     *
+     * @param base
+     * @param size in bytes
+     * @param owner keeps the memory at `base` alive while it is borrowed.
+     */
+    void borrow(const void* base, t_uindex size, std::shared_ptr<const void> owner);
+
+    bool is_borrowed() const;
+
+    /**
+     * @brief Write the store's contents to a file in `dirname` and read
+     * them from a read-only mapping of it, releasing the store's own
+     * allocation, so that memory only holds the pages read since. The
+     * store is reloaded into an allocation of its own, and the file
+     * removed, by `reload` or the first call to a non-const accessor or
+     * mutator (see `borrow`). Only `BACKING_STORE_MEMORY` stores which are
+     * not empty or borrowed are spilled.
+     *
+     * @param dirname
+     * @return bool whether the store was spilled.
+     */
+    bool spill(const std::string& dirname);
+
+    void reload();
+
+    bool is_spilled() const;
+
+    /**
+     * @brief Returns a store that reads this store's memory without copying
+     * it, as of the call. The memory is handed to an owner that both stores
+     * borrow (see `borrow`), so whichever is written to first copies it and
+     * the other keeps reading the original. The snapshot can be read from
+     * another thread while this store is written to. Stores not backed by
+     * `BACKING_STORE_MEMORY` are cloned instead.
+     */
+    std::shared_ptr<t_lstore> snapshot();
+
     bool
     get_init() const {
         return m_init;
@@ -215,7 +290,25 @@ protected:
     void unfreeze_impl();
 
 private:
-    void reserve_impl(t_uindex capacity, bool allow_shrink);
+    void unborrow();
+    void init_impl(t_alloc_op op);
+    void reserve_impl(t_uindex capacity, bool allow_shrink, t_alloc_op op);
+
+    /**
+     * @brief Round `capacity` up to the granularity of heap allocations of
+     * that size under the store's alignment and page policy.
+     */
+    t_uindex heap_capacity(t_uindex capacity) const;
+
+    /**
+     * @brief Allocate `capacity` bytes for a `BACKING_STORE_MEMORY` store,
+     * zeroed if `zero` is set, honoring its alignment and page policy.
+     * `mapped` is set if the memory was mapped rather than taken from the
+     * heap.
+     */
+    void* heap_alloc(t_uindex capacity, bool zero, bool& mapped) const;
+
+    void heap_free(void* base, t_uindex capacity, bool mapped) const;
     t_handle create_file();
     void* create_mapping();
     void resize_mapping(t_uindex cap_new);
@@ -237,9 +330,24 @@ private:
     t_fflag m_mflags;
     t_backing_store m_backing_store;
     bool m_init;
+    t_page_policy m_page_policy;
+    // Set while `m_base` is a mapping of huge pages rather than a heap
+    // allocation.
+    bool m_mapped;
     double m_resize_factor;
     t_uindex m_version;
     bool m_from_recipe;
+    t_alloc_owner m_alloc_owner;
+
+    // The allocator `m_base` came from, taken from `t_allocator::current`
+    // when the store is initialized.
+    std::shared_ptr<t_allocator> m_allocator;
+
+    // Set while `m_base` points at memory borrowed from `m_owner`.
+    std::shared_ptr<const void> m_owner;
+
+    // Set while `m_owner` is the mapping of a file written by `spill`.
+    bool m_spilled;
 
 #ifdef PSP_MPROTECT
     // size of padding + size of fields above
@@ -247,7 +355,7 @@ private:
     // page_size. this invariant is checked in
     // the constructor if
     // mprotect is enabled
-    char m_padding[3820];
+    char m_padding[3804];
 #endif
 };
 
@@ -275,9 +383,12 @@ struct t_unlock_store {
 template <typename T>
 void
 t_lstore::push_back(T value) {
+    if (m_owner)
+        unborrow();
+
     if (m_size + sizeof(T) >= m_capacity)
-        reserve(static_cast<t_uindex>(std::ceil(
-            m_capacity + m_size + sizeof(T)))); // reserve will multiply by m_resize_factor
+        reserve_impl(static_cast<t_uindex>(std::ceil(m_capacity + m_size + sizeof(T))), false,
+            ALLOC_OP_EXTEND); // reserve will multiply by m_resize_factor
 
     PSP_VERBOSE_ASSERT(m_size + sizeof(T) < m_capacity, "Insufficient capacity.");
     T* ptr = reinterpret_cast<T*>(static_cast<unsigned char*>(m_base) + m_size);
@@ -294,6 +405,8 @@ template <typename T>
 T*
 t_lstore::get(t_uindex idx) {
     STORAGE_CHECK_ACCESS_GET(idx);
+    if (m_owner)
+        unborrow();
     T* ptr = reinterpret_cast<T*>(static_cast<unsigned char*>(m_base) + idx);
     return ptr;
 }
@@ -310,6 +423,8 @@ template <typename T>
 T*
 t_lstore::get_nth(t_uindex idx) {
     STORAGE_CHECK_ACCESS_GET(idx);
+    if (m_owner)
+        unborrow();
     return static_cast<T*>(m_base) + idx;
 }
 
@@ -324,6 +439,8 @@ template <typename T>
 void
 t_lstore::set_nth(t_uindex idx, T v) {
     STORAGE_CHECK_ACCESS(idx);
+    if (m_owner)
+        unborrow();
     T* tgt = static_cast<T*>(m_base) + idx;
     *tgt = v;
 }
@@ -331,9 +448,12 @@ t_lstore::set_nth(t_uindex idx, T v) {
 template <typename T>
 T*
 t_lstore::extend(t_uindex idx) {
+    if (m_owner)
+        unborrow();
+
     t_uindex osize = m_size;
     t_uindex nsize = m_size + idx * sizeof(T);
-    reserve(nsize);
+    reserve_impl(nsize, false, ALLOC_OP_EXTEND);
     {
         t_unlock_store tmp(this);
         m_size = nsize;
@@ -352,6 +472,9 @@ t_lstore::extend() {
 template <typename DATA_T>
 void
 t_lstore::raw_fill(DATA_T v) {
+    if (m_owner)
+        unborrow();
+
     auto biter = static_cast<DATA_T*>(m_base);
     auto eiter = reinterpret_cast<DATA_T*>(static_cast<char*>(m_base) + size());
     std::fill(biter, eiter, v);
@@ -11,9 +11,42 @@
 #include <perspective/first.h>
 #include <perspective/scalar.h>
 #include <tsl/hopscotch_map.h>
+#include <memory>
+#include <vector>
 
 namespace perspective {
 
+/**
+ * @brief Append-only storage for interned strings, carved out of large
+ * blocks so that interning a string seldom allocates, and dropping the
+ * strings frees a handful of blocks rather than each string.
+ */
+class PERSPECTIVE_EXPORT t_string_arena {
+public:
+    PSP_NON_COPYABLE(t_string_arena);
+
+    t_string_arena();
+
+    /**
+     * @brief Copy the `len` characters of `s` and a terminator into the
+     * arena, returning the copy, which lives as long as the arena.
+     */
+    const char* copy(const char* s, t_uindex len);
+
+    /**
+     * @brief Returns the number of bytes allocated by the arena.
+     */
+    t_uindex nbytes() const;
+
+    void swap(t_string_arena& other);
+
+private:
+    std::vector<std::unique_ptr<char[]>> m_blocks;
+    char* m_cur;
+    t_uindex m_remaining;
+    t_uindex m_nbytes;
+};
+
 class PERSPECTIVE_EXPORT t_symtable {
     typedef tsl::hopscotch_map<const char*, const char*, t_cchar_umap_hash, t_cchar_umap_cmp>
         t_mapping;
@@ -27,10 +60,26 @@ public:
     t_tscalar get_interned_tscalar(const t_tscalar& s);
     t_uindex size() const;
 
+    /**
+     * @brief Returns the number of bytes used by the interned strings and
+     * the table that maps them.
+     */
+    t_uindex nbytes() const;
+
+    void swap(t_symtable& other);
+
 private:
     t_mapping m_mapping;
+    t_string_arena m_arena;
 };
 
+/**
+ * @brief Intern `s` in the process-wide symbol table, which is safe to call
+ * from any thread. The table is split into shards behind their own locks,
+ * and each thread remembers the strings it has interned before, so threads
+ * interning the same strings rarely wait on each other. Interned strings
+ * live as long as the process.
+ */
 PERSPECTIVE_EXPORT const char* get_interned_cstr(const char* s);
 PERSPECTIVE_EXPORT t_tscalar get_interned_tscalar(const char* s);
 PERSPECTIVE_EXPORT t_tscalar get_interned_tscalar(const t_tscalar& s);
@@ -16,9 +16,12 @@
 #include <perspective/pool.h>
 #include <perspective/computed.h>
 #include <perspective/data_table.h>
+#include <perspective/replication.h>
 
 namespace perspective {
 
+class t_view_config;
+
 /**
  * @brief the `Table` class encapsulates `t_data_table`, `t_pool` and `t_gnode`, offering
  * a unified public API for consumption by binding languages.
@@ -50,13 +53,14 @@ public:
 
     /**
      * @brief Register the given `t_data_table` with the underlying pool and gnode, thus
-     * allowing operations on it.
+     * allowing operations on it. The table is handed to the gnode's port, and
+     * must not be written to afterwards.
      *
      * @param data_table
      * @param row_count
      * @param op
      */
-    void init(t_data_table& data_table, std::uint32_t row_count, const t_op op, const t_uindex port_id);
+    void init(std::shared_ptr<t_data_table> data_table, std::uint32_t row_count, const t_op op, const t_uindex port_id);
 
     /**
      * @brief The size of the underlying `t_data_table`, i.e. a row count
@@ -65,6 +69,27 @@ public:
      */
     t_uindex size() const;
 
+    /**
+     * @brief The number of bytes used by each component of the underlying
+     * `t_gnode`, not counting the contexts of its views.
+     *
+     * @return std::map<std::string, t_uindex>
+     */
+    std::map<std::string, t_uindex> get_memory_usage() const;
+
+    /**
+     * @brief The row counts and phase timings of the last update processed
+     * by the table's gnode; see `t_gnode::get_update_stats`.
+     */
+    std::map<std::string, double> get_update_stats() const;
+
+    /**
+     * @brief The latency histograms of the updates processed by the table's
+     * gnode since they were last reset; see `t_gnode::get_latency_stats`.
+     */
+    std::map<std::string, double> get_latency_stats() const;
+    void reset_latency_stats();
+
     /**
      * @brief The schema of the underlying `t_data_table`, which contains the `psp_pkey`,
      * `psp_op` and `psp_pkey` meta columns.
@@ -88,6 +113,19 @@ public:
     t_schema get_computed_schema(
         std::vector<t_computed_column_definition> computed_columns) const;
 
+    /**
+     * @brief Estimate the cost of building a view of `config` from the size
+     * of the table, the cardinalities of its pivots and the complexity of
+     * its aggregates, filters and computed columns, without building it, so
+     * that expensive views can be refused or deferred.
+     *
+     * @param config an initialized view config of this table.
+     * @return std::map<std::string, double> the `rows` the view reads, the
+     * leaf `groups` and tree `nodes` it is estimated to build, and its
+     * `cost` in operations on rows.
+     */
+    std::map<std::string, double> estimate_view_cost(const t_view_config& config) const;
+
     /**
      * @brief Given a schema, create a `t_gnode` that manages the `t_data_table`.
      *
@@ -147,6 +185,218 @@ public:
      */
     void calculate_offset(std::uint32_t row_count);
 
+    /**
+     * @brief Write a snapshot of the Table's data to the existing directory
+     * `dirname`, as a set of files which `load_snapshot` reads back. All
+     * pending updates should be processed first.
+     *
+     * @param dirname
+     */
+    void save_snapshot(const std::string& dirname) const;
+
+    /**
+     * @brief Replace the Table's data with the snapshot in `dirname`, which
+     * must have been saved from a Table with the same schema and index.
+     * Must be called before any views are created on the Table.
+     *
+     * @param dirname
+     */
+    void load_snapshot(const std::string& dirname);
+
+    /**
+     * @brief Log every update sent to the Table in the existing directory
+     * `dirname`, which must contain the directories `checkpoint.0` and
+     * `checkpoint.1`, and write a first checkpoint. The Table can then be
+     * rebuilt with `recover_from_log` from the last checkpoint and the
+     * updates logged since. All pending updates should be processed first.
+     *
+     * @param dirname
+     */
+    void enable_update_log(const std::string& dirname);
+
+    /**
+     * @brief Snapshot the Table's data into the older of the two checkpoint
+     * directories, then discard the updates logged before it. All pending
+     * updates should be processed first.
+     */
+    void checkpoint();
+
+    /**
+     * @brief Block until every update sent to the Table has been logged.
+     */
+    void flush_update_log();
+
+    /**
+     * @brief Replace the Table's data with the last checkpoint in `dirname`,
+     * replay the updates logged after it, and keep logging to `dirname`.
+     * Must be called before any views are created on the Table.
+     *
+     * @param dirname
+     */
+    void recover_from_log(const std::string& dirname);
+
+    /**
+     * @brief Publish every update the Table processes, and every time it is
+     * reset, as a batch for replicas to apply with `apply_replication_batch`,
+     * queued until `take_replication_batches`. All pending updates should be
+     * processed first, and replicas created from `get_replication_snapshot`.
+     */
+    void enable_replication();
+
+    /**
+     * @brief Returns the batches published since the last call, oldest
+     * first.
+     *
+     * @return std::vector<std::shared_ptr<std::string>>
+     */
+    std::vector<std::shared_ptr<std::string>> take_replication_batches();
+
+    /**
+     * @brief Returns every row of the Table as a batch, from which
+     * `make_replica` creates a replica.
+     *
+     * @return std::shared_ptr<std::string>
+     */
+    std::shared_ptr<std::string> get_replication_snapshot() const;
+
+    /**
+     * @brief Send a batch published by the primary to the Table's gnode,
+     * as it was processed by the primary's, or reset the Table for a batch
+     * published by a reset.
+     *
+     * @param bytes
+     */
+    void apply_replication_batch(const std::string& bytes);
+
+    /**
+     * @brief Create a replica of the Table whose `get_replication_snapshot`
+     * is `snapshot`, with the same schema, index and limit, and send it the
+     * snapshot's rows.
+     *
+     * @param pool
+     * @param snapshot
+     * @return std::shared_ptr<Table>
+     */
+    static std::shared_ptr<Table> make_replica(
+        std::shared_ptr<t_pool> pool, const std::string& snapshot);
+
+    /**
+     * @brief Intern the string column `colname` into the same dictionary as
+     * column `other_colname` of `other`, so that both tables store each
+     * string once. Tables sharing a dictionary must be updated from the
+     * same thread.
+     *
+     * @param colname
+     * @param other
+     * @param other_colname
+     */
+    void share_dictionary(const std::string& colname, std::shared_ptr<Table> other,
+        const std::string& other_colname);
+
+    /**
+     * @brief Index the string column `colname`, so that views filtering it
+     * with `==` or `in` are created from the rows they match rather than
+     * scanning the table.
+     *
+     * @param colname
+     */
+    void create_index(const std::string& colname);
+
+    /**
+     * @brief Keep the rows of the table in the order of `colname`, "asc" or
+     * "desc" as `order` is, so that views sorted by that column alone are
+     * created from the rows in order rather than sorting them.
+     *
+     * @param colname
+     * @param order
+     */
+    void create_sorted_index(const std::string& colname, const std::string& order);
+
+    /**
+     * @brief Remove the rows which pass `fterms` combined by `combiner`, as
+     * one batch of deletes sent to `port_id`. The rows are found with a
+     * single pass over the table rather than by the caller, and their keys
+     * are sent in order. A table without an index is left as is.
+     *
+     * @param fterms
+     * @param combiner
+     * @param port_id
+     * @return t_uindex the number of rows removed.
+     */
+    t_uindex remove_where(
+        const std::vector<t_fterm>& fterms, t_filter_op combiner, t_uindex port_id);
+
+    /**
+     * @brief Move the live rows of the table together, releasing the rows
+     * of the primary keys removed since.
+     *
+     * @return t_uindex the number of rows released.
+     */
+    t_uindex compact_rows();
+
+    /**
+     * @brief Spill the columns no view has referenced for `idle_seconds` to
+     * files in `dirname`; see `t_gnode::set_column_spill`.
+     *
+     * @param dirname
+     * @param idle_seconds
+     */
+    void set_column_spill(const std::string& dirname, double idle_seconds);
+
+    /**
+     * @brief Spill the columns left cold now, rather than after the next
+     * update.
+     *
+     * @return t_uindex the number of columns spilled.
+     */
+    t_uindex spill_cold_columns();
+
+    /**
+     * @brief Pack the integer columns whose full-width values have not been
+     * accessed for `idle_seconds`; see `t_gnode::set_column_packing`.
+     *
+     * @param enabled
+     * @param idle_seconds
+     */
+    void set_column_packing(bool enabled, double idle_seconds);
+
+    /**
+     * @brief Pack the columns left cold now, rather than after the next
+     * update.
+     *
+     * @return t_uindex the number of columns packed.
+     */
+    t_uindex pack_cold_columns();
+
+    /**
+     * @brief Release at least `nbytes` of the state the contexts of the
+     * table's views can recompute on demand, or as much as possible if `0`,
+     * e.g. under memory pressure; see `t_gnode::reclaim_memory`.
+     *
+     * @return t_uindex the number of bytes released.
+     */
+    t_uindex reclaim_memory(t_uindex nbytes);
+
+    /**
+     * @brief Read the int64 column `name` as fixed-point decimals, whose
+     * values are stored as integers of `10^-scale`, e.g. cents for a scale
+     * of 2. Sums over it are exact and need no NaN handling, while views
+     * read its values, and the aggregates in its units, as floats.
+     *
+     * Arrow decimal columns set their scale when the table is created, and
+     * decimals of a different scale are rescaled to it on update.
+     *
+     * @param name
+     * @param scale
+     */
+    void set_column_scale(const std::string& name, std::int32_t scale);
+
+    /**
+     * @brief The scale of a fixed-point column, or 0 if `name` is not one.
+     */
+    std::int32_t get_column_scale(const std::string& name) const;
+    const std::map<std::string, std::int32_t>& get_column_scales() const;
+
     // Getters
     t_uindex get_id() const;
     std::shared_ptr<t_pool> get_pool() const;
@@ -204,6 +454,17 @@ private:
      */
     const std::string m_index;
     bool m_gnode_set;
+
+    // The scale of each fixed-point column, set before views are created.
+    std::map<std::string, std::int32_t> m_column_scales;
+
+    // The directory of the update log, and the checkpoint to write next.
+    std::string m_log_dirname;
+    t_uindex m_checkpoint_slot;
+
+    // Set by `enable_replication`, with the id of its update listener.
+    std::shared_ptr<t_replication_publisher> m_replication_publisher;
+    t_uindex m_replication_listener;
 };
 
 } // namespace perspective
\ No newline at end of file
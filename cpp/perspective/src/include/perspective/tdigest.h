@@ -0,0 +1,83 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2017, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#pragma once
+
+#include <perspective/first.h>
+#include <perspective/base.h>
+#include <perspective/exports.h>
+#include <utility>
+#include <vector>
+
+namespace perspective {
+
+/**
+ * @brief A merging t-digest of the values under a `t_stree` node, from which
+ * the `APPROX_PERCENTILE` aggregate estimates quantiles in a bounded space
+ * per node, most accurately towards the tails.
+ *
+ * Values are buffered and merged into the digest's centroids, each a mean
+ * and a weight, once enough have been buffered or a quantile is read. Two
+ * digests merge the same way, by merging each other's centroids.
+ *
+ * A removed value is taken from the centroid whose mean is nearest it,
+ * which keeps the digest's weight exact but blurs its centroids, so
+ * `needs_rebuild` asks its owner to build it again from the node's rows once
+ * the values removed outnumber half of the values inserted.
+ */
+class PERSPECTIVE_EXPORT t_tdigest {
+public:
+    t_tdigest();
+
+    void insert(double value);
+    void remove(double value);
+
+    /**
+     * @brief Merge the values of `other` into this digest.
+     *
+     * @param other
+     */
+    void merge(const t_tdigest& other);
+
+    bool needs_rebuild() const;
+
+    void clear();
+
+    /**
+     * @brief Returns the number of values in the digest.
+     */
+    double weight() const;
+
+    /**
+     * @brief Return the estimated `q` quantile of the values in the digest,
+     * for `q` in `[0, 1]`. The digest must not be empty.
+     *
+     * @param q
+     */
+    double quantile(double q);
+
+    t_uindex nbytes() const;
+
+private:
+    void flush();
+    void compress();
+
+    // `(mean, weight)` for each centroid, by mean.
+    std::vector<std::pair<double, double>> m_centroids;
+    std::vector<double> m_buffer;
+
+    double m_weight;
+    double m_min;
+    double m_max;
+
+    t_uindex m_inserted;
+    t_uindex m_removed;
+};
+
+} // end namespace perspective
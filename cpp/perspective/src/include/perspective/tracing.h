@@ -11,7 +11,10 @@
 #include <perspective/first.h>
 #include <perspective/raw_types.h>
 #include <perspective/exports.h>
+#include <atomic>
 #include <cstdint>
+#include <map>
+#include <string>
 
 namespace perspective {
 
@@ -44,10 +47,170 @@ struct t_instrec {
 };
 #pragma pack(pop)
 
-struct t_trace {
-    t_trace();
-    ~t_trace();
-    void write_record(t_trace_type ttype) const;
+/**
+ * @brief Records spans - named, nested intervals of engine work - as
+ * `t_instrec`s in a ring buffer per thread, and exports them in the Chrome
+ * trace event format, which Perfetto and `chrome://tracing` open.
+ *
+ * Tracing is off unless `PSP_TRACE` is set or `set_enabled` is called, and
+ * a span costs one relaxed atomic load while it is off. Each thread keeps
+ * the last `PSP_TRACE_BUFFER_SIZE` spans it recorded (65536 by default),
+ * so a trace shows the most recent ticks rather than growing without bound.
+ */
+class PERSPECTIVE_EXPORT t_tracer {
+public:
+    static inline bool
+    is_enabled() {
+        return ENABLED.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Start or stop recording spans, keeping those recorded so far.
+     *
+     * @param enabled
+     */
+    static void set_enabled(bool enabled);
+
+    /**
+     * @brief Returns the id of the span name `name`, which records a span's
+     * name in a `t_instrec`. Names are added once per call site, by
+     * `PSP_TRACE_SPAN`.
+     *
+     * @param name
+     * @return std::uint64_t
+     */
+    static std::uint64_t intern(const char* name);
+
+    /**
+     * @brief Returns a monotonic time in nanoseconds.
+     */
+    static std::int64_t now();
+
+    /**
+     * @brief Record a span on the calling thread's buffer, overwriting its
+     * oldest span if the buffer is full.
+     *
+     * @param name_id the id returned by `intern`.
+     * @param begin the time the span began, from `now`.
+     * @param duration in nanoseconds.
+     * @param depth the number of spans open on the thread when it began.
+     * @param arg a short label, e.g. a context name, truncated to the
+     * payload of a `t_instrec`. May be null.
+     */
+    static void write_span(std::uint64_t name_id, std::int64_t begin,
+        std::uint64_t duration, std::uint16_t depth, const char* arg);
+
+    /**
+     * @brief Returns the recorded spans of every thread as a Chrome trace
+     * JSON object.
+     */
+    static std::string to_chrome_json();
+
+    /**
+     * @brief Drop the recorded spans of every thread.
+     */
+    static void clear();
+
+private:
+    static std::atomic<bool> ENABLED;
+};
+
+/**
+ * @brief Samples which span - which phase of engine work - each thread is
+ * in, every `PSP_PROFILE_INTERVAL_US` microseconds (1000 by default), and
+ * counts the samples of each phase, so that a long-running process can
+ * report where its engine time goes without recording a trace.
+ *
+ * A thread's phase is the innermost span open on it, written to a slot of
+ * its own as spans open and close, and read by a sampler thread. Profiling
+ * is off unless `PSP_PROFILE` is set or `set_enabled` is called, and a span
+ * costs one more relaxed atomic load while it is off. Without threads, the
+ * calling thread samples itself whenever a span opens or closes.
+ */
+class PERSPECTIVE_EXPORT t_profiler {
+public:
+    static inline bool
+    is_enabled() {
+        return ENABLED.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Start or stop sampling, keeping the samples counted so far.
+     *
+     * @param enabled
+     */
+    static void set_enabled(bool enabled);
+
+    /**
+     * @brief Returns the samples counted of each phase, keyed by span name,
+     * summed over threads. Samples of threads outside every span are
+     * counted as `"idle"`.
+     */
+    static std::map<std::string, double> get_profile();
+
+    /**
+     * @brief Returns the number of times threads were sampled, each tick
+     * sampling every thread which has opened a span.
+     */
+    static double get_ticks();
+
+    /**
+     * @brief Returns the microseconds between ticks.
+     */
+    static double get_interval_us();
+
+    /**
+     * @brief Zero every counter.
+     */
+    static void clear();
+
+    /**
+     * @brief Make `name_id` the phase of the calling thread, and returns
+     * the phase it replaces, to be restored by `leave_phase`.
+     *
+     * @param name_id
+     * @return std::uint64_t
+     */
+    static std::uint64_t enter_phase(std::uint64_t name_id);
+
+    static void leave_phase(std::uint64_t prev_phase);
+
+private:
+    static std::atomic<bool> ENABLED;
+};
+
+/**
+ * @brief Records a span from its construction to its destruction, if
+ * tracing was enabled when it was constructed, and makes it the thread's
+ * phase meanwhile if profiling was.
+ */
+class PERSPECTIVE_EXPORT t_trace_span {
+public:
+    t_trace_span(std::uint64_t name_id, const char* arg = nullptr);
+    ~t_trace_span();
+
+private:
+    bool m_active;
+    bool m_profiled;
+    std::uint64_t m_prev_phase;
+    std::uint16_t m_depth;
+    std::uint64_t m_name_id;
+    std::int64_t m_begin;
+    const char* m_arg;
 };
 
 } // end namespace perspective
+
+#define PSP_TRACE_CONCAT_IMPL(A, B) A##B
+#define PSP_TRACE_CONCAT(A, B) PSP_TRACE_CONCAT_IMPL(A, B)
+
+// Record a span named `NAME`, a string literal, until the end of the scope.
+#define PSP_TRACE_SPAN(NAME) PSP_TRACE_SPAN_ARG(NAME, nullptr)
+
+// Record a span named `NAME` labelled by the C string `ARG`, which must
+// outlive the scope.
+#define PSP_TRACE_SPAN_ARG(NAME, ARG)                                                    \
+    static const std::uint64_t PSP_TRACE_CONCAT(_psp_trace_id_, __LINE__)               \
+        = perspective::t_tracer::intern(NAME);                                           \
+    perspective::t_trace_span PSP_TRACE_CONCAT(_psp_trace_span_, __LINE__)(             \
+        PSP_TRACE_CONCAT(_psp_trace_id_, __LINE__), ARG)
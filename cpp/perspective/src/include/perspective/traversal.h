@@ -22,6 +22,7 @@
 #include <algorithm>
 #include <cstdint>
 #include <queue>
+#include <tsl/hopscotch_set.h>
 
 SUPPRESS_WARNINGS_VC(4503)
 
@@ -52,6 +53,17 @@ public:
 
     t_uindex size() const;
 
+    /**
+     * @brief Returns a count which changes whenever the visible nodes or
+     * their order do, for callers which cache what they derive from them.
+     */
+    t_uindex get_version() const;
+
+    /**
+     * @brief Returns the number of bytes allocated for the visible nodes.
+     */
+    t_uindex nbytes() const;
+
     t_depth get_depth(t_index idx) const;
 
     t_index get_traversal_index(t_index idx);
@@ -76,6 +88,21 @@ public:
     void sort_by(const t_config& config, const std::vector<t_sortspec>& sortby,
         const SRC_T& src, t_ctx2* ctx2 = nullptr);
 
+    /**
+     * @brief Restore the order `sortby` gives the traversal after the
+     * aggregates of the tree nodes in `updated` have changed, by re-sorting
+     * only their siblings, and only moving the spans of nodes whose position
+     * changed. The other nodes must already be in that order.
+     *
+     * @param sortby
+     * @param updated
+     * @param src
+     * @param ctx2
+     */
+    template <typename SRC_T>
+    void resort_nodes(const std::vector<t_sortspec>& sortby,
+        const tsl::hopscotch_set<t_uindex>& updated, const SRC_T& src, t_ctx2* ctx2 = nullptr);
+
     void get_child_indices(
         t_index nidx, std::vector<std::pair<t_index, t_index>>& out_data) const;
 
@@ -89,6 +116,20 @@ public:
     t_index set_depth(
         const std::vector<t_sortspec>& sortby, t_depth depth, t_ctx2* ctx2 = nullptr);
 
+    /**
+     * @brief Expand the nodes of the tree in `tnids` which the traversal
+     * shows, including those it only shows once their ancestors in `tnids`
+     * are expanded, returning the number of nodes added. The traversal is
+     * written out again in one pass, as `set_depth` does, rather than
+     * expanding each node in place.
+     *
+     * @param sortby
+     * @param tnids
+     * @param ctx2
+     */
+    t_index expand_tree_nodes(const std::vector<t_sortspec>& sortby,
+        const tsl::hopscotch_set<t_index>& tnids, t_ctx2* ctx2 = nullptr);
+
     std::vector<t_ftreenode> get_flattened_tree(t_index idx, t_depth stop_depth) const;
 
     t_index tree_index_lookup(t_index idx, t_index bidx) const;
@@ -109,8 +150,21 @@ public:
     void populate_root_children(std::shared_ptr<const t_stree> tree);
 
 private:
+    /**
+     * @brief Write the children of tree node `tnid` to `out_tnids`, in the
+     * order `sortby` sorts them.
+     *
+     * @param sortby
+     * @param tnid
+     * @param ctx2
+     * @param out_tnids
+     */
+    void get_sorted_children(const std::vector<t_sortspec>& sortby, t_index tnid, t_ctx2* ctx2,
+        std::vector<t_index>& out_tnids) const;
+
     std::shared_ptr<const t_stree> m_tree;
     std::shared_ptr<std::vector<t_tvnode>> m_nodes;
+    t_uindex m_version;
 };
 
 template <typename SRC_T>
@@ -214,6 +268,127 @@ t_traversal::sort_by(const t_config& config, const std::vector<t_sortspec>& sort
     }
 
     std::swap(*m_nodes, new_nodes);
+    ++m_version;
+}
+
+template <typename SRC_T>
+void
+t_traversal::resort_nodes(const std::vector<t_sortspec>& sortby,
+    const tsl::hopscotch_set<t_uindex>& updated, const SRC_T& src, t_ctx2* ctx2) {
+    if (sortby.empty() || updated.empty()) {
+        return;
+    }
+
+    std::vector<t_index> sortby_agg_indices(sortby.size());
+
+    t_uindex scount = 0;
+    for (const auto& s : sortby) {
+        sortby_agg_indices[scount] = s.m_agg_index;
+        ++scount;
+    }
+
+    std::vector<t_sorttype> sort_orders = get_sort_orders(sortby);
+    std::vector<t_tscalar> aggregates(sortby.size());
+
+    // Every ancestor of an updated node is updated too, so only the children
+    // of updated, expanded nodes need to be visited.
+    std::vector<t_index> queue;
+    queue.push_back(0);
+
+    std::vector<std::pair<t_index, t_index>> h_children;
+    std::vector<t_tvnode> span;
+
+    while (!queue.empty()) {
+        t_index h_tvidx = queue.back();
+        queue.pop_back();
+
+        h_children.clear();
+        get_child_indices(h_tvidx, h_children);
+        t_index nchild = h_children.size();
+
+        std::vector<bool> changed(nchild);
+        bool any_changed = false;
+        for (t_index idx = 0; idx < nchild; ++idx) {
+            changed[idx] = updated.find(h_children[idx].second) != updated.end();
+            any_changed = any_changed || changed[idx];
+        }
+
+        if (!any_changed) {
+            continue;
+        }
+
+        auto sortelems = std::make_shared<std::vector<t_mselem>>(size_t(nchild));
+        for (t_index idx = 0; idx < nchild; ++idx) {
+            src.get_aggregates_for_sorting(
+                h_children[idx].second, sortby_agg_indices, aggregates, ctx2);
+            (*sortelems)[idx] = t_mselem(aggregates, static_cast<t_uindex>(idx));
+        }
+
+        t_multisorter sorter(sortelems, sort_orders);
+
+        // The unchanged children keep their order, so the changed ones are
+        // sorted and merged into them.
+        std::vector<t_index> kept;
+        std::vector<t_index> moved;
+        for (t_index idx = 0; idx < nchild; ++idx) {
+            (changed[idx] ? moved : kept).push_back(idx);
+        }
+
+        std::vector<t_index> sorted_idx;
+        if (std::is_sorted(kept.begin(), kept.end(), sorter)) {
+            std::sort(moved.begin(), moved.end(), sorter);
+            sorted_idx.reserve(nchild);
+            std::merge(kept.begin(), kept.end(), moved.begin(), moved.end(),
+                std::back_inserter(sorted_idx), sorter);
+        } else {
+            sorted_idx.resize(nchild);
+            argsort(sorted_idx, sorter);
+        }
+
+        // Only the children between the first and last to move change
+        // position, and they hold the same span between them.
+        t_index first = 0;
+        while (first < nchild && sorted_idx[first] == first) {
+            ++first;
+        }
+
+        std::vector<t_index> c_tvidx(nchild);
+        for (t_index idx = 0; idx < nchild; ++idx) {
+            c_tvidx[idx] = h_children[idx].first;
+        }
+
+        if (first < nchild) {
+            t_index last = nchild - 1;
+            while (sorted_idx[last] == last) {
+                --last;
+            }
+
+            t_index bidx = h_children[first].first;
+            t_index eidx
+                = h_children[last].first + (*m_nodes)[h_children[last].first].m_ndesc + 1;
+            span.assign(m_nodes->begin() + bidx, m_nodes->begin() + eidx);
+
+            t_index c_ntvidx = bidx;
+            for (t_index idx = first; idx <= last; ++idx) {
+                t_index cidx = sorted_idx[idx];
+                t_index c_offset = h_children[cidx].first - bidx;
+                t_index c_size = span[c_offset].m_ndesc + 1;
+                std::copy(span.begin() + c_offset, span.begin() + c_offset + c_size,
+                    m_nodes->begin() + c_ntvidx);
+                (*m_nodes)[c_ntvidx].m_rel_pidx = c_ntvidx - h_tvidx;
+                c_tvidx[cidx] = c_ntvidx;
+                c_ntvidx += c_size;
+            }
+
+            ++m_version;
+        }
+
+        for (t_index idx = 0; idx < nchild; ++idx) {
+            if (changed[idx] && (*m_nodes)[c_tvidx[idx]].m_expanded) {
+                queue.push_back(c_tvidx[idx]);
+            }
+        }
+    }
 }
 
 } // end namespace perspective
@@ -12,10 +12,31 @@
 #include <perspective/exports.h>
 #include <perspective/config.h>
 #include <perspective/gnode_state.h>
+#include <perspective/row_paths.h>
 #include <perspective/traversal.h>
 
 namespace perspective {
 
+/**
+ * @brief A traversal of a tree which is updated along with the tree, and the
+ * sort its nodes are kept in.
+ *
+ * A tree shared by several contexts is notified once, updating the
+ * traversal of every context reading it.
+ */
+struct PERSPECTIVE_EXPORT t_tree_traversal {
+    std::shared_ptr<t_traversal> m_traversal;
+    const std::vector<t_sortspec>* m_sortby;
+};
+
+/**
+ * @brief The columns that notifying a tree of `config` reads from the
+ * transitional tables: its pivots and the columns they are sorted by, the
+ * columns its aggregates read, and its filtered columns.
+ */
+PERSPECTIVE_EXPORT std::set<std::string> get_tree_transitional_columns(
+    const t_config& config);
+
 PERSPECTIVE_EXPORT void notify_sparse_tree_common(std::shared_ptr<t_data_table> strands,
     std::shared_ptr<t_data_table> strand_deltas, std::shared_ptr<t_stree> tree,
     std::shared_ptr<t_traversal> traversal, bool process_traversal,
@@ -39,6 +60,18 @@ PERSPECTIVE_EXPORT void notify_sparse_tree(std::shared_ptr<t_stree> tree,
     const std::vector<t_sortspec>& ctx_sortby, const t_data_table& flattened,
     const t_config& config, const t_gstate& gstate);
 
+PERSPECTIVE_EXPORT void notify_sparse_tree(std::shared_ptr<t_stree> tree,
+    const std::vector<t_tree_traversal>& traversals, const std::vector<t_aggspec>& aggregates,
+    const std::vector<std::pair<std::string, std::string>>& tree_sortby,
+    const t_data_table& flattened, const t_data_table& delta, const t_data_table& prev,
+    const t_data_table& current, const t_data_table& transitions, const t_data_table& existed,
+    const t_config& config, const t_gstate& gstate);
+
+PERSPECTIVE_EXPORT void notify_sparse_tree(std::shared_ptr<t_stree> tree,
+    const std::vector<t_tree_traversal>& traversals, const std::vector<t_aggspec>& aggregates,
+    const std::vector<std::pair<std::string, std::string>>& tree_sortby,
+    const t_data_table& flattened, const t_config& config, const t_gstate& gstate);
+
 template <typename CONTEXT_T>
 void
 ctx_expand_path(CONTEXT_T& ctx, t_header header, std::shared_ptr<t_stree> tree,
@@ -61,22 +94,29 @@ ctx_expand_path(CONTEXT_T& ctx, t_header header, std::shared_ptr<t_stree> tree,
     }
 }
 
-template <typename CONTEXT_T>
-void
-ctx_set_expansion_state(CONTEXT_T& ctx, t_header header, std::shared_ptr<t_stree> tree,
-    std::shared_ptr<t_traversal> traversal, const std::vector<t_path>& paths) {
-    for (int i = 0, loop_end = paths.size(); i < loop_end; i++) {
-        const t_path& path = paths[i];
-        ctx_expand_path(ctx, header, tree, traversal, path.m_path);
-    }
-}
-
 PERSPECTIVE_EXPORT std::vector<t_path> ctx_get_expansion_state(
     std::shared_ptr<const t_stree> tree, std::shared_ptr<const t_traversal> traversal);
 
+/**
+ * @brief Returns the tree nodes which restoring the expansion state `paths`,
+ * as `ctx_get_expansion_state` returns it, expands: the node of each path
+ * and its ancestors below the root, each once, shallowest first. Paths
+ * which are not in `tree` are skipped.
+ */
+PERSPECTIVE_EXPORT std::vector<t_index> ctx_resolve_expansion_state(
+    std::shared_ptr<const t_stree> tree, const std::vector<t_path>& paths);
+
 PERSPECTIVE_EXPORT std::vector<t_tscalar> ctx_get_path(std::shared_ptr<const t_stree> tree,
     std::shared_ptr<const t_traversal> traversal, t_index idx);
 
+/**
+ * @brief Returns the paths of the rows `start_row` to `end_row` of
+ * `traversal`, in one pass over the range; rows out of the traversal have an
+ * empty path, as `ctx_get_path` gives them.
+ */
+PERSPECTIVE_EXPORT t_row_paths ctx_get_paths(std::shared_ptr<const t_stree> tree,
+    std::shared_ptr<const t_traversal> traversal, t_index start_row, t_index end_row);
+
 PERSPECTIVE_EXPORT std::vector<t_ftreenode> ctx_get_flattened_tree(t_index idx,
     t_depth stop_depth, t_traversal& trav, const t_config& config,
     const std::vector<t_sortspec>& sortby);
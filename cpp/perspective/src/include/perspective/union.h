@@ -0,0 +1,94 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#pragma once
+#include <perspective/first.h>
+#include <perspective/base.h>
+#include <perspective/exports.h>
+#include <perspective/data_table.h>
+#include <perspective/scalar.h>
+#include <perspective/table.h>
+#include <tsl/hopscotch_map.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace perspective {
+
+/**
+ * @brief Maintains a table holding the rows of several tables with the same
+ * columns and index, e.g. a table per region or day, so that views of the
+ * union pivot and aggregate across them while each member stays small and
+ * fast to update.
+ *
+ * The rows each member processes are sent to the union as an update of
+ * their own, so that the union's views are updated incrementally rather
+ * than rebuilt. Members with an index are expected to hold distinct keys,
+ * as a key in several members is one row of the union. Rows of members
+ * without an index are each a row of the union.
+ */
+class PERSPECTIVE_EXPORT t_union {
+public:
+    /**
+     * @brief Construct a union of `members`, and the empty table it
+     * maintains, with a pool of its own.
+     */
+    t_union(const std::vector<std::shared_ptr<Table>>& members);
+    ~t_union();
+
+    /**
+     * @brief Send every row of the members to the union, and follow their
+     * updates from now on.
+     */
+    void init();
+
+    /**
+     * @brief Stop following the updates of the members, leaving the union
+     * as it is.
+     */
+    void detach();
+
+    std::shared_ptr<Table> get_table() const;
+
+private:
+    void on_update(t_uindex midx, const t_data_table& flattened);
+
+    /**
+     * @brief Send the rows of member `midx` with `pkeys` to the union.
+     */
+    void send_rows(t_uindex midx, const std::vector<t_tscalar>& pkeys);
+
+    void send_deletes(t_uindex midx, const std::vector<t_tscalar>& pkeys);
+
+    /**
+     * @brief Returns the key of the union's row for the row `pkey` of
+     * member `midx`, assigning one to a row it has not seen if `assign`.
+     */
+    t_tscalar get_key(t_uindex midx, const t_tscalar& pkey, bool assign);
+
+    std::vector<std::shared_ptr<Table>> m_members;
+    std::shared_ptr<Table> m_table;
+    std::string m_index;
+    std::vector<std::string> m_columns;
+    std::vector<t_dtype> m_types;
+
+    // Guards everything below, as members may be processed at once.
+    std::mutex m_mtx;
+
+    // For members without an index, the key of the union's row for each of
+    // their rows.
+    std::vector<tsl::hopscotch_map<t_tscalar, std::int32_t>> m_row_keys;
+    std::int32_t m_next_row_key;
+
+    bool m_attached;
+    std::vector<t_uindex> m_listeners;
+};
+
+} // end namespace perspective
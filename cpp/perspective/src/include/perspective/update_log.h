@@ -0,0 +1,122 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#pragma once
+#include <perspective/first.h>
+#include <perspective/base.h>
+#include <perspective/exports.h>
+#include <perspective/data_table.h>
+#include <condition_variable>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace perspective {
+
+/**
+ * @brief An append-only log of the port tables sent to a gnode, which
+ * together with a checkpoint of its state lets a table be recovered without
+ * re-ingesting its data.
+ *
+ * `append` serializes a table on the calling thread, which is a copy of its
+ * columns, and queues it. A background thread writes every queued record
+ * with a single write and `fsync` (a group commit), so the update path never
+ * waits on the disk. Each record has a sequence number and a checksum;
+ * reading stops at the first torn or corrupt record, which is where a crash
+ * during a write leaves the log.
+ *
+ * Records are replayed into port 0, so updates that were sent to different
+ * ports between two calls to `process` are replayed in the order they were
+ * sent rather than in port order.
+ */
+class PERSPECTIVE_EXPORT t_update_log {
+public:
+    typedef std::function<void(std::uint64_t, t_uindex, const t_data_table&)> t_replay_callback;
+
+    /**
+     * @brief Open the log in the existing directory `dirname`. Unless
+     * `truncate`, valid records already in the log are kept and any torn
+     * record after them is dropped. New records are numbered after both the
+     * last kept record and `last_seq`.
+     *
+     * @param dirname
+     * @param truncate
+     * @param last_seq
+     */
+    t_update_log(const std::string& dirname, bool truncate, std::uint64_t last_seq = 0);
+    ~t_update_log();
+
+    /**
+     * @brief Queue `tbl` to be written, returning its sequence number.
+     *
+     * @param port_id
+     * @param tbl
+     * @return std::uint64_t
+     */
+    std::uint64_t append(t_uindex port_id, const t_data_table& tbl);
+
+    /**
+     * @brief Block until every record appended so far is on disk.
+     */
+    void flush();
+
+    /**
+     * @brief Discard every record, after a checkpoint has made them
+     * redundant. Sequence numbers keep increasing.
+     */
+    void truncate();
+
+    /**
+     * @brief Returns the sequence number of the last appended record, or 0.
+     */
+    std::uint64_t last_seq() const;
+
+    /**
+     * @brief Call `callback` with each valid record of the log in
+     * `dirname`, in order, returning the sequence number of the last one.
+     *
+     * @param dirname
+     * @param callback
+     * @return std::uint64_t
+     */
+    static std::uint64_t read(const std::string& dirname, const t_replay_callback& callback);
+
+private:
+    void run_flusher();
+    void write_batch(const std::vector<std::string>& batch);
+
+    /**
+     * @brief Read the valid records of the log `fname`, calling `callback`
+     * with each one if it is set. `valid_size` is set to the number of bytes
+     * they span.
+     */
+    static std::uint64_t read_records(const std::string& fname,
+        const t_replay_callback* callback, std::uint64_t& valid_size);
+
+    std::string m_fname;
+    std::FILE* m_file;
+
+    mutable std::mutex m_mtx;
+    std::condition_variable m_pending_cv;
+    std::condition_variable m_durable_cv;
+    std::vector<std::string> m_pending;
+    std::uint64_t m_last_seq;
+    std::uint64_t m_durable_seq;
+    bool m_stop;
+
+    // Set by the flusher when a write fails, and raised by `flush`.
+    std::string m_error;
+    std::thread m_flusher;
+};
+
+} // end namespace perspective
@@ -14,13 +14,27 @@
 
 namespace perspective {
 class t_pool;
+struct t_gnode_slot;
 
+/**
+ * @brief Processes the gnodes of a `t_pool` that have pending updates. Each
+ * gnode is processed under the lock of its slot, so that other gnodes of the
+ * pool can be sent to and processed while it is.
+ */
 class PERSPECTIVE_EXPORT t_update_task {
 public:
     t_update_task(t_pool& pool);
     virtual void run();
 
 private:
+    /**
+     * @brief Process every input port of the gnode in `slot`, notifying the
+     * pool's update delegate of each port that notified a context.
+     *
+     * @param slot
+     */
+    void process_gnode(t_gnode_slot& slot);
+
     t_pool& m_pool;
 };
 
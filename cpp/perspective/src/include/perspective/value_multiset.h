@@ -0,0 +1,120 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2017, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#pragma once
+
+#include <perspective/first.h>
+#include <perspective/base.h>
+#include <perspective/exports.h>
+#include <perspective/scalar.h>
+#include <map>
+#include <set>
+#include <utility>
+
+namespace perspective {
+
+/**
+ * @brief A counted multiset of the values under a `t_stree` node, from which
+ * the `MEDIAN`, `MIN`, `MAX`, `UNIQUE`, `DISTINCT_COUNT` and `DOMINANT`
+ * aggregates are read without rereading every row of the node.
+ *
+ * Inserting or erasing a value is O(log n) in the number of distinct values:
+ * the median is tracked as a position in the sorted values that moves by at
+ * most one value per update, and the dominant value is kept in a set ordered
+ * by count.
+ *
+ * String values must outlive the multiset, i.e. be interned.
+ */
+class PERSPECTIVE_EXPORT t_value_multiset {
+    // Orders as `t_tscalar::operator<`, but with NaN after every other
+    // float so that the order stays strict weak.
+    struct t_value_cmp {
+        bool operator()(const t_tscalar& a, const t_tscalar& b) const;
+    };
+
+    typedef std::map<t_tscalar, t_uindex, t_value_cmp> t_counts;
+
+    struct t_by_count_cmp {
+        bool operator()(const std::pair<t_uindex, t_tscalar>& a,
+            const std::pair<t_uindex, t_tscalar>& b) const;
+    };
+
+    typedef std::set<std::pair<t_uindex, t_tscalar>, t_by_count_cmp> t_by_count;
+
+public:
+    PSP_NON_COPYABLE(t_value_multiset);
+
+    t_value_multiset();
+
+    void insert(const t_tscalar& value);
+
+    /**
+     * @brief Remove one occurrence of `value`, if it exists.
+     */
+    void erase(const t_tscalar& value);
+
+    void clear();
+
+    /**
+     * @brief Exchange the values of this multiset and `other`.
+     */
+    void swap(t_value_multiset& other);
+
+    t_uindex size() const;
+
+    t_uindex distinct_size() const;
+
+    /**
+     * @brief Returns the bytes used by the multiset's ordered indexes.
+     */
+    t_uindex nbytes() const;
+
+    /**
+     * @brief Return the value at position `size() / 2` of the sorted values,
+     * or a none scalar if the multiset is empty.
+     */
+    t_tscalar median() const;
+
+    /**
+     * @brief Return the smallest or largest valid value other than NaN, or a
+     * none scalar if there is none. Unlike the high and low water marks,
+     * these follow values which are updated or removed.
+     */
+    t_tscalar min() const;
+    t_tscalar max() const;
+
+    /**
+     * @brief Return the most frequent valid value, the smallest of any tie,
+     * as `get_dominant` does. Invalid values count once, however many times
+     * they occur.
+     */
+    t_tscalar dominant() const;
+
+    /**
+     * @brief Return whether every value in the multiset is equal, writing it
+     * to `value` (or a none scalar, if the multiset is empty).
+     */
+    bool unique(t_tscalar& value) const;
+
+private:
+    std::pair<t_uindex, t_tscalar> by_count_key(t_counts::const_iterator iter) const;
+    void seek_median();
+
+    t_counts m_counts;
+    t_by_count m_by_count;
+    t_uindex m_size;
+
+    // The median is occurrence `m_median_offset` of `m_median`, which is at
+    // position `m_median_pos` of the sorted values.
+    t_counts::iterator m_median;
+    t_uindex m_median_offset;
+    t_uindex m_median_pos;
+};
+
+} // end namespace perspective
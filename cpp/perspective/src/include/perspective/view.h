@@ -18,9 +18,21 @@
 #include <perspective/data_slice.h>
 #include <perspective/table.h>
 #include <perspective/view_config.h>
+#include <atomic>
 #include <cstddef>
+#include <functional>
 #include <memory>
 #include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace arrow {
+class RecordBatch;
+class ResizableBuffer;
+class Schema;
+}
 
 namespace perspective {
 
@@ -60,6 +72,40 @@ public:
      */
     std::int32_t num_rows() const;
 
+    /**
+     * @brief The number of bytes used by each component of this View's
+     * context, such as its traversal, tree and aggregates. Views that share
+     * a tree each report it.
+     *
+     * @return std::map<std::string, t_uindex>
+     */
+    std::map<std::string, t_uindex> get_memory_usage() const;
+
+    /**
+     * @brief Describe how this View is computed, as a JSON object: each
+     * filter term with the number and fraction of the table's rows it
+     * passes, the nodes at each depth of each of the context's trees, how
+     * each aggregate is maintained on update, the computed columns it
+     * materializes, and an estimate of the work each updated row costs.
+     *
+     * Filter selectivity is measured against a copy of the table's rows, so
+     * this is a diagnostic rather than something to call on every update.
+     *
+     * @return std::string
+     */
+    std::string explain() const;
+
+    /**
+     * @brief The latency histograms of this View's updates since they were
+     * last reset: how long its context took to notify, and how long from
+     * then, and from the update's first `send`, to the update delegate's
+     * callback; see `t_gnode::get_context_latency_stats`.
+     *
+     * @return std::map<std::string, double>
+     */
+    std::map<std::string, double> get_latency_stats() const;
+    void reset_latency_stats();
+
     /**
      * @brief The number of aggregated columns in this View. This is affected by
      * the "column_pivot" configuration parameter supplied to this View's
@@ -150,6 +196,66 @@ public:
         std::int32_t start_col,
         std::int32_t end_col) const;
 
+    /**
+     * @brief Serializes the `View`'s data into the Apache Arrow format in
+     * chunks of at most `chunk_size` rows, calling `callback` with each
+     * chunk as soon as it is serialized, so that only one chunk of the
+     * range is materialized at a time. Each chunk is a complete Arrow IPC
+     * stream containing the schema and a single record batch; at least one
+     * chunk is emitted, even if the range is empty.
+     *
+     * @param start_row
+     * @param end_row
+     * @param start_col
+     * @param end_col
+     * @param chunk_size the maximum number of rows in each chunk.
+     * @param callback
+     */
+    void to_arrow_chunked(
+        std::int32_t start_row,
+        std::int32_t end_row,
+        std::int32_t start_col,
+        std::int32_t end_col,
+        std::int32_t chunk_size,
+        const std::function<void(std::shared_ptr<std::string>)>& callback) const;
+
+    /**
+     * @brief Opens a cursor over the view's rows, from the first row, which
+     * `cursor_to_arrow` pages through.
+     *
+     * With `snapshot`, a flat view's cursor reads the rows as they were
+     * when it was opened, however the view is updated after, from a
+     * snapshot of its traversal and table (see `t_data_table::snapshot`),
+     * which makes updates to the table copy the columns it holds until the
+     * cursor is closed; a pivoted view's cursor fails once the view is
+     * updated. Otherwise the cursor reads the view's rows at the time of
+     * each page, so that updates may shift rows across pages.
+     *
+     * @param start_col
+     * @param end_col
+     * @param snapshot
+     * @return std::int32_t the id of the cursor.
+     */
+    std::int32_t open_cursor(std::int32_t start_col, std::int32_t end_col, bool snapshot);
+
+    /**
+     * @brief Serializes the next `page_size` rows of the cursor `cursor_id`
+     * into the Apache Arrow format, advancing it, or returns `nullptr` once
+     * the cursor has passed the last row.
+     *
+     * @param cursor_id
+     * @param page_size
+     * @return std::shared_ptr<std::string>
+     */
+    std::shared_ptr<std::string> cursor_to_arrow(std::int32_t cursor_id, std::int32_t page_size);
+
+    /**
+     * @brief Closes the cursor `cursor_id`, releasing its snapshot.
+     *
+     * @param cursor_id
+     */
+    void close_cursor(std::int32_t cursor_id);
+
     /**
      * @brief Serializes a given data slice into the Apache Arrow format. Can
      * be directly called with a pointer to a data slice in order to serialize
@@ -165,6 +271,26 @@ public:
     data_slice_to_arrow(
         std::shared_ptr<t_data_slice<CTX_T>> data_slice) const;
 
+#ifdef PSP_ENABLE_PARQUET
+    /**
+     * @brief Serializes the `View`'s data into a Parquet file as a
+     * bytestring, writing row groups of at most `row_group_size` rows.
+     *
+     * @param start_row
+     * @param end_row
+     * @param start_col
+     * @param end_col
+     * @param row_group_size
+     * @return std::shared_ptr<std::string>
+     */
+    std::shared_ptr<std::string> to_parquet(
+        std::int32_t start_row,
+        std::int32_t end_row,
+        std::int32_t start_col,
+        std::int32_t end_col,
+        std::int32_t row_group_size) const;
+#endif
+
     // Delta calculation
     bool _get_deltas_enabled() const;
     void _set_deltas_enabled(bool enabled_state);
@@ -204,6 +330,36 @@ public:
      */
     void set_depth(std::int32_t depth, std::int32_t row_pivot_length);
 
+    /**
+     * @brief Returns the row paths of the deepest expanded rows of the
+     * pivot tree, which `set_expansion_state` expands again, e.g. in a view
+     * of the same table and row pivots.
+     *
+     * @return std::vector<std::vector<t_tscalar>>
+     */
+    std::vector<std::vector<t_tscalar>> get_expansion_state() const;
+
+    /**
+     * @brief Expands the rows of `paths` and their ancestors, as `expand` on
+     * each of them would, in one pass. Paths which are not rows of the view
+     * are skipped.
+     *
+     * @param paths
+     */
+    void set_expansion_state(const std::vector<std::vector<t_tscalar>>& paths);
+
+    /**
+     * @brief Aggregate only the rows of the pivot tree which are visible,
+     * computing hidden rows when they are expanded, or aggregate every row
+     * on each update if `enabled` is false. Views without pivots are always
+     * eager.
+     *
+     * @param enabled
+     */
+    void set_lazy_aggregates(bool enabled);
+
+    bool get_lazy_aggregates() const;
+
     /**
      * @brief Returns a data slice that contains the dataset from the rows
      * that have been changed by a call to `update()`.
@@ -212,8 +368,154 @@ public:
      */
     std::shared_ptr<t_data_slice<CTX_T>> get_row_delta() const;
 
+    /**
+     * @brief Register the window of the view that is rendered, in the same
+     * coordinates as `get_data`. `get_step_delta` and `get_row_delta` then
+     * only track and return changes that intersect it.
+     *
+     * @param start_row
+     * @param end_row
+     * @param start_col
+     * @param end_col
+     */
+    void set_viewport(
+        t_uindex start_row, t_uindex end_row, t_uindex start_col, t_uindex end_col);
+
+    /**
+     * @brief Report changes across the whole view again.
+     */
+    void clear_viewport();
+
+    /**
+     * @brief Set the priority with which the view is updated. Visible views
+     * are updated, and their update callbacks run, before background views.
+     * Paused views are not updated, and are rebuilt when resumed, in which
+     * case this returns true.
+     *
+     * @param priority
+     * @return bool
+     */
+    bool set_priority(t_ctx_priority priority);
+    t_ctx_priority get_priority() const;
+
+    /**
+     * @brief Freeze the view, e.g. a snapshot for a report, which then
+     * serves the data it held when frozen and costs nothing per update of
+     * the table until thawed. Thawing rebuilds it once if it missed any
+     * updates, in which case `thaw` returns true.
+     */
+    void freeze();
+    bool thaw();
+    bool is_frozen() const;
+
+    /**
+     * @brief Let the view's context use up to `nbytes`, as reported by
+     * `get_memory_usage`, after which the state it can recompute on demand,
+     * such as the aggregates of its collapsed rows, is released at the end
+     * of an update; `0` removes the budget. See
+     * `t_gnode::set_context_memory_budget`.
+     *
+     * @param nbytes
+     */
+    void set_memory_budget(t_uindex nbytes);
+    t_uindex get_memory_budget() const;
+
+    /**
+     * @brief Release the state of the view's context which it can
+     * recompute on demand now, returning the number of bytes released.
+     *
+     * @return t_uindex
+     */
+    t_uindex reclaim_memory();
+
+    /**
+     * @brief Read up to `max_rows` more rows of the table into a view
+     * created with `deferred`, returning whether it is built. Until then the
+     * view is not updated, and reads the aggregates of the rows read so far.
+     *
+     * @param max_rows
+     * @return bool
+     */
+    bool build(t_uindex max_rows);
+
+    /**
+     * @brief Returns the fraction of the table's rows that `build` has read
+     * into the view, which is `1` once it is built.
+     *
+     * @return double
+     */
+    double get_build_progress() const;
+
+    /**
+     * @brief Returns whether the number of rows in the view has changed
+     * during the last update, without computing any deltas.
+     *
+     * @return bool
+     */
+    bool get_row_count_changed() const;
+
+    /**
+     * @brief Limit the view's update notifications to one per `interval_us`
+     * microseconds, or `0` for no limit. While limited, the view's context
+     * coalesces the deltas of every step between the notifications, so that
+     * `get_step_delta` and `get_row_delta` read every change since they were
+     * last read.
+     *
+     * The engine only decides when a notification is due: the binding skips
+     * those that `get_notify_delay` says are early, schedules one for when
+     * it is due, and calls `set_notified` as it notifies.
+     *
+     * @param interval_us
+     */
+    void set_notify_interval(t_uindex interval_us);
+    t_uindex get_notify_interval() const;
+
+    /**
+     * @brief Return the number of microseconds until the view's next update
+     * notification is due, which is `0` if it is due now or the view's
+     * notifications are not limited.
+     *
+     * @return t_uindex
+     */
+    t_uindex get_notify_delay() const;
+
+    /**
+     * @brief Record that the view's update callbacks were notified now.
+     */
+    void set_notified();
+
+    /**
+     * @brief Bin the values of `column_name` that the view aggregates into
+     * at most `nbuckets` buckets. Without row pivots every row of the view
+     * is binned; otherwise only those under row `ridx` of the pivot tree,
+     * where row 0 is the total. The column may be any numeric, datetime or
+     * computed column of the table, and is read as-is rather than
+     * aggregated.
+     *
+     * @param column_name
+     * @param nbuckets
+     * @param binning
+     * @param ridx
+     * @return t_histogram
+     */
+    t_histogram get_histogram(const std::string& column_name, std::uint32_t nbuckets,
+        t_binning binning, std::int32_t ridx) const;
+
+    /**
+     * @brief Returns the min and max of the valid values of `column_name`
+     * at the rows `get_histogram` would bin, read as-is rather than
+     * aggregated; both are none if there are no valid values or the column
+     * holds strings.
+     *
+     * @param column_name
+     * @param ridx
+     * @return t_minmax
+     */
+    t_minmax get_min_max(const std::string& column_name, std::int32_t ridx) const;
+
     // Getters
     std::shared_ptr<CTX_T> get_context() const;
+    std::shared_ptr<Table> get_table() const;
     std::vector<std::string> get_row_pivots() const;
     std::vector<std::string> get_column_pivots() const;
     std::vector<t_aggspec> get_aggregates() const;
@@ -223,8 +525,31 @@ public:
     std::vector<t_tscalar> get_row_path(t_uindex idx) const;
     t_stepdelta get_step_delta(t_index bidx, t_index eidx) const;
     t_dtype get_column_dtype(t_uindex idx) const;
+
+    /**
+     * @brief The decimal scale of the column at `idx`, if it reads a
+     * fixed-point column of the table, or an aggregate in its units, and 0
+     * otherwise. Such columns are read as floats.
+     *
+     * @param idx
+     * @return std::int32_t
+     */
+    std::int32_t get_column_scale(t_uindex idx) const;
     bool is_column_only() const;
 
+    /**
+     * @brief Read the column at `cidx` for rows `start_row` to `end_row`
+     * straight from the table into a `t_slice_column`, or return null if the
+     * view's columns are aggregated or of a type it cannot hold.
+     *
+     * @param start_row
+     * @param end_row
+     * @param cidx
+     * @return std::shared_ptr<t_slice_column>
+     */
+    std::shared_ptr<t_slice_column> get_column(
+        t_uindex start_row, t_uindex end_row, t_uindex cidx) const;
+
 private:
     /**
      * @brief Gets the number of hidden columns - columns used in sort but not
@@ -246,6 +571,176 @@ private:
 
     void _find_hidden_sort(const std::vector<t_sortspec>& sort);
 
+    /**
+     * @brief The decimal scale of an aggregate, which is the scale of its
+     * column if the aggregate is in the column's units, e.g. a sum rather
+     * than a count.
+     */
+    std::int32_t get_aggregate_scale(const t_aggspec& aggspec) const;
+
+    /**
+     * @brief Replace the unscaled integers of fixed-point columns in `slice`
+     * with floats, where `indices` is the context column of each column of
+     * the slice.
+     */
+    void scale_slice(std::vector<t_tscalar>& slice, const std::vector<t_uindex>& indices) const;
+
+    /**
+     * @brief The primary keys of the rows `get_histogram` and `get_min_max`
+     * read: every row of the view without row pivots, otherwise those under
+     * row `ridx` of the pivot tree.
+     */
+    std::vector<t_tscalar> get_value_pkeys(std::int32_t ridx) const;
+
+    /**
+     * @brief The context columns `start_col` to `end_col`, clamped to the
+     * columns of the context.
+     */
+    std::vector<t_uindex> column_range(t_uindex start_col, t_uindex end_col) const;
+
+    /**
+     * @brief Converts a data slice into a single `arrow::RecordBatch`, which
+     * is shared by the Arrow and Parquet serializers.
+     *
+     * @param data_slice
+     * @param from_get_data whether `data_slice` was read by `get_data`, so
+     * that its rows are the rows of its extents.
+     * @return std::shared_ptr<::arrow::RecordBatch>
+     */
+    std::shared_ptr<::arrow::RecordBatch> data_slice_to_batch(
+        std::shared_ptr<t_data_slice<CTX_T>> data_slice,
+        bool from_get_data = false) const;
+
+    /**
+     * @brief The name and type of each column of a record batch.
+     */
+    typedef std::vector<std::pair<std::string, t_dtype>> t_arrow_schema_key;
+
+    /**
+     * @brief Returns the Arrow schema of a record batch with the columns of
+     * `key`, which is reused for as long as the view is serialized with the
+     * same columns.
+     *
+     * @param key
+     * @return std::shared_ptr<::arrow::Schema>
+     */
+    std::shared_ptr<::arrow::Schema> get_arrow_schema(const t_arrow_schema_key& key) const;
+
+    /**
+     * @brief Serializes a record batch into an Arrow IPC stream.
+     *
+     * @param batch
+     * @return std::shared_ptr<std::string>
+     */
+    std::shared_ptr<std::string> batch_to_arrow(
+        std::shared_ptr<::arrow::RecordBatch> batch) const;
+
+    /**
+     * @brief Converts the string column at `cidx` of a data slice into an
+     * `arrow::DictionaryArray`. For a flat view's slice read by `get_data`,
+     * this takes the ids and vocabulary of the table's column instead of
+     * interning each string of the slice.
+     *
+     * @param slice
+     * @param cidx
+     * @param stride
+     * @param extents
+     * @param from_get_data
+     * @param snapshot the snapshot `data_slice` was read from, if any.
+     * @return std::shared_ptr<::arrow::Array>
+     */
+    std::shared_ptr<::arrow::Array> string_col_to_array(
+        const std::vector<t_tscalar>& slice,
+        std::int32_t cidx,
+        std::int32_t stride,
+        t_get_data_extents extents,
+        bool from_get_data,
+        const t_ctx_snapshot* snapshot) const;
+
+    /**
+     * @brief Lock the table's gnode against updates, for reading the
+     * context's traversal and tables.
+     *
+     * @return std::unique_lock<std::recursive_mutex>
+     */
+    std::unique_lock<std::recursive_mutex> lock_gnode() const;
+
+    /**
+     * @brief A serialized window of the view, which is served again for the
+     * same request for as long as the context's data version is `m_version`.
+     */
+    struct t_slice_cache_entry {
+        // 0 for Arrow, or the row group size of a Parquet file.
+        std::int32_t m_format;
+        std::int32_t m_start_row;
+        std::int32_t m_end_row;
+        std::int32_t m_start_col;
+        std::int32_t m_end_col;
+        t_uindex m_version;
+        std::shared_ptr<std::string> m_bytes;
+    };
+
+    /**
+     * @brief A position in the view's rows opened by `open_cursor`.
+     */
+    struct t_view_cursor {
+        std::int32_t m_start_col;
+        std::int32_t m_end_col;
+        bool m_snapshot;
+        t_uindex m_position;
+
+        // The data version the cursor was opened at.
+        t_uindex m_version;
+
+        // For a flat view's snapshot cursor, the rows of the view and its
+        // column names when the cursor was opened.
+        std::shared_ptr<t_ctx_snapshot> m_ctx_snapshot;
+        std::vector<std::vector<t_tscalar>> m_column_names;
+    };
+
+    /**
+     * @brief Reads the rows `[start_row, end_row)` of `cursor`.
+     *
+     * @param cursor
+     * @param start_row
+     * @param end_row
+     * @return std::shared_ptr<t_data_slice<CTX_T>>
+     */
+    std::shared_ptr<t_data_slice<CTX_T>> get_cursor_data(
+        const t_view_cursor& cursor, t_uindex start_row, t_uindex end_row) const;
+
+    /**
+     * @brief Snapshots the rows of a snapshot `cursor` as `open_cursor`
+     * opens it, under the gnode's lock; only flat views do.
+     *
+     * @param cursor
+     */
+    void snapshot_cursor(t_view_cursor& cursor) const;
+
+    /**
+     * @brief Returns the context's data version, under the gnode's lock.
+     *
+     * @return t_uindex
+     */
+    t_uindex get_data_version() const;
+
+    /**
+     * @brief Returns the bytes cached for `key` if they were serialized at
+     * `key.m_version`, or `nullptr`, dropping the entries of older versions.
+     *
+     * @param key
+     * @return std::shared_ptr<std::string>
+     */
+    std::shared_ptr<std::string> get_cached_slice(const t_slice_cache_entry& key) const;
+
+    /**
+     * @brief Cache `entry`, evicting the least recently used entry once the
+     * cache holds `t_env::view_slice_cache_size()` of them.
+     *
+     * @param entry
+     */
+    void cache_slice(const t_slice_cache_entry& entry) const;
+
     std::shared_ptr<Table> m_table;
     std::shared_ptr<CTX_T> m_ctx;
     std::string m_name;
@@ -264,5 +759,24 @@ private:
     t_uindex m_col_offset;
 
     std::shared_ptr<t_view_config> m_view_config;
+
+    // Most recently used first.
+    mutable std::vector<t_slice_cache_entry> m_slice_cache;
+    mutable std::mutex m_slice_cache_mutex;
+
+    // The schema of the last record batch, and the buffer the last Arrow
+    // was written into.
+    mutable t_arrow_schema_key m_arrow_schema_key;
+    mutable std::shared_ptr<::arrow::Schema> m_arrow_schema;
+    mutable std::shared_ptr<::arrow::ResizableBuffer> m_arrow_buffer;
+    mutable std::mutex m_arrow_mutex;
+
+    std::map<std::int32_t, t_view_cursor> m_cursors;
+    std::int32_t m_last_cursor_id;
+    std::mutex m_cursor_mutex;
+
+    // Limits the view's update notifications, see `set_notify_interval`.
+    std::atomic<t_uindex> m_notify_interval;
+    std::atomic<std::int64_t> m_notified_at;
 };
 } // end namespace perspective
\ No newline at end of file
@@ -15,6 +15,7 @@
 #include <perspective/scalar.h>
 #include <perspective/computed.h>
 #include <tsl/ordered_map.h>
+#include <map>
 #include <tuple>
 
 namespace perspective {
@@ -64,6 +65,33 @@ public:
      */
     void add_filter_term(std::tuple<std::string, std::string, std::vector<t_tscalar>> term);
 
+    /**
+     * @brief Filter by `fexpr` rather than by the filter terms, for filters
+     * which compare two columns or nest `and`/`or` groups. The binding
+     * builds the tree with terms from `make_fterm`, and the terms of the
+     * view's `filter` as the children of its root.
+     *
+     * @param fexpr
+     */
+    void set_filter_expr(const t_fexpr& fexpr);
+
+    /**
+     * @brief Returns the `t_fterm` of a filter term as the binding makes it.
+     *
+     * @param filter
+     */
+    static t_fterm make_fterm(
+        const std::tuple<std::string, std::string, std::vector<t_tscalar>>& filter);
+
+    /**
+     * @brief Rescale the numeric filter thresholds of fixed-point columns,
+     * which are written in the units the view reads, into the units of the
+     * column.
+     *
+     * @param scales the scale of each fixed-point column of the `Table`.
+     */
+    void scale_filters(const std::map<std::string, std::int32_t>& scales);
+
     /**
      * @brief Set the number of pivot levels the engine should generate.
      *
@@ -82,6 +110,8 @@ public:
 
     std::vector<t_fterm> get_fterm() const;
 
+    const t_fexpr& get_filter_expr() const;
+
     std::vector<t_sortspec> get_sortspec() const;
 
     std::vector<t_sortspec> get_col_sortspec() const;
@@ -169,6 +199,9 @@ private:
 
     std::vector<t_fterm> m_fterm;
 
+    // Empty unless the view filters by an expression.
+    t_fexpr m_fexpr;
+
     std::vector<t_sortspec> m_sortspec;
 
     std::vector<t_sortspec> m_col_sortspec;
@@ -0,0 +1,99 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#pragma once
+#include <perspective/first.h>
+#include <perspective/base.h>
+#include <perspective/exports.h>
+#include <perspective/context_one.h>
+#include <perspective/scalar.h>
+#include <perspective/table.h>
+#include <perspective/view.h>
+#include <tsl/hopscotch_map.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace perspective {
+
+/**
+ * @brief Maintains a table holding the rows of a view with row pivots, so
+ * that the aggregates of one view can be pivoted and aggregated again by
+ * the views of the table, e.g. trades to orders to desks.
+ *
+ * The table has a row for each innermost group of the view, with a column
+ * for each row pivot, outermost first, and one for each aggregate not
+ * named like a pivot. It is indexed by the pivot if there is one, and
+ * otherwise by `__ROW_PATH__`, the values of the pivots joined by `|`.
+ *
+ * After each update of the view's table, the groups of the view's tree that
+ * the update changed are sent to the table, and the groups it emptied are
+ * removed from it, with no serialization of the view. The view must be
+ * visible, as the groups are read once the visible views are updated, and
+ * aggregates every group rather than those it has expanded.
+ */
+class PERSPECTIVE_EXPORT t_view_feed {
+public:
+    t_view_feed(std::shared_ptr<View<t_ctx1>> view);
+    ~t_view_feed();
+
+    /**
+     * @brief Send every group of the view to the table, and follow the
+     * updates of the view's table from now on.
+     */
+    void init();
+
+    /**
+     * @brief Stop following the updates of the view's table, leaving the
+     * table as it is.
+     */
+    void detach();
+
+    std::shared_ptr<Table> get_table() const;
+
+private:
+    void on_update();
+
+    /**
+     * @brief Send the groups of the tree nodes `nidxs`, which are the
+     * innermost nodes of the tree.
+     */
+    void send_groups(const std::vector<t_uindex>& nidxs);
+
+    void send_deletes(const std::vector<t_tscalar>& keys);
+
+    /**
+     * @brief Returns the key of the group at `path`, deepest first as
+     * `t_stree::get_path` returns it.
+     */
+    t_tscalar get_key(const std::vector<t_tscalar>& path) const;
+
+    std::shared_ptr<View<t_ctx1>> m_view;
+    std::shared_ptr<Table> m_source;
+    std::shared_ptr<t_ctx1> m_ctx;
+    std::shared_ptr<Table> m_table;
+
+    std::string m_index;
+    std::vector<std::string> m_pivots;
+    std::vector<t_dtype> m_pivot_types;
+
+    // The aggregates sent, and their columns in the view.
+    std::vector<std::string> m_aggregates;
+    std::vector<t_dtype> m_aggregate_types;
+    std::vector<t_index> m_aggregate_indices;
+
+    // The key sent for each innermost node of the tree, with strings
+    // interned.
+    tsl::hopscotch_map<t_uindex, t_tscalar> m_keys;
+
+    bool m_attached;
+    t_uindex m_listener;
+};
+
+} // end namespace perspective
@@ -17,6 +17,9 @@
 #include <functional>
 #include <limits>
 #include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <vector>
 #include <tsl/hopscotch_map.h>
 
 namespace perspective {
@@ -44,6 +47,13 @@ public:
     void pprint_vocabulary() const;
     void clone(const t_vocab& v);
 
+    /**
+     * @brief Returns a copy-on-write snapshot of the vocabulary's strings
+     * (see `t_lstore::snapshot`), for reading only: strings cannot be
+     * interned into it.
+     */
+    std::shared_ptr<t_vocab> snapshot();
+
     t_uindex get_interned(const std::string& s);
     t_uindex get_interned(const char* s);
     void copy_vocabulary(const t_vocab& other);
@@ -53,11 +63,69 @@ public:
 
     void reserve(size_t total_string_size, size_t string_count);
 
+    /**
+     * @brief Make room for `string_count` more strings of `string_size`
+     * bytes in all, counting their terminators, so that a loader which
+     * knows the strings it will intern (e.g. an encoded dictionary) grows
+     * the vocabulary's storage and map at most once.
+     *
+     * @param string_size
+     * @param string_count
+     */
+    void reserve_additional(size_t string_size, size_t string_count);
+
+    /**
+     * @brief Forget every interned string while keeping the storage behind
+     * the vocabulary, so that it can be refilled without reallocating.
+     */
+    void clear();
+
+    /**
+     * @brief Drop every string not marked in `live`, renumbering the rest in
+     * their existing order and releasing the storage left over.
+     *
+     * @param live whether each id is still referenced, `get_vlenidx()` long.
+     * @param remap filled with the new id of each live id; dropped ids map
+     * to 0.
+     */
+    void compact(const std::vector<bool>& live, std::vector<t_uindex>& remap);
+
+    /**
+     * @brief Mark the vocabulary as shared between columns, which then
+     * borrow it rather than copy it (see `t_column::share_vocabulary`).
+     */
+    void set_shared(bool shared);
+    bool is_shared() const;
+
+    /**
+     * @brief Returns the rank of each id in the order of its string, as
+     * `strcmp` orders them, so that comparing the ranks of two ids compares
+     * their strings. Ranks are computed on first use, and again once
+     * strings have been interned or dropped since.
+     *
+     * @return const std::vector<std::uint32_t>& `get_vlenidx()` long.
+     */
+    const std::vector<std::uint32_t>& get_ranks() const;
+
+    /**
+     * @brief Returns the ids in the order of their strings, the inverse of
+     * `get_ranks`.
+     *
+     * @return const std::vector<std::uint32_t>&
+     */
+    const std::vector<std::uint32_t>& get_sorted_ids() const;
+
 protected:
     // vlen interface
     t_uindex genidx();
 
 private:
+    // Count the stores' allocations under `ALLOC_OWNER_VOCAB`.
+    void set_alloc_owner();
+
+    // Recompute the ranks if strings have changed since they were computed.
+    void update_ranks() const;
+
     // Max string id currently in use
     t_uindex m_vlenidx;
     // varlen
@@ -80,6 +148,17 @@ private:
     // for string with numeric id j.
     // These offsets index into m_vlendata
     std::shared_ptr<t_lstore> m_extents;
+
+    // Whether columns attached to this vocabulary share it rather than
+    // own it, see `set_shared`.
+    bool m_shared;
+
+    // The order of the strings, see `get_ranks`, computed lazily by readers
+    // under `m_ranks_mtx` and invalidated by every change to the strings.
+    mutable std::mutex m_ranks_mtx;
+    mutable bool m_ranks_valid;
+    mutable std::vector<std::uint32_t> m_ranks;
+    mutable std::vector<std::uint32_t> m_sorted_ids;
 };
 
 } // end namespace perspective
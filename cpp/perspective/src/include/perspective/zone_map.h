@@ -0,0 +1,84 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+#pragma once
+#include <perspective/first.h>
+#include <perspective/base.h>
+#include <perspective/exports.h>
+#include <perspective/column.h>
+#include <perspective/filter.h>
+#include <perspective/mask.h>
+#include <vector>
+
+namespace perspective {
+
+/**
+ * @brief The minimum and maximum of each block of `PSP_ZONE_MAP_BLOCK_SIZE`
+ * rows of a numeric, date or time column of the master table, so that a
+ * range filter reads only the blocks whose values may match it rather than
+ * scanning the column.
+ *
+ * A block is widened whenever one of its rows is written, and never
+ * narrowed, so its range may include values which have since been
+ * overwritten or erased. Invalid and NaN values are not summarized, as they
+ * match no range.
+ */
+class PERSPECTIVE_EXPORT t_zone_map {
+public:
+    t_zone_map();
+
+    /**
+     * @brief Returns whether `fterm`, coerced to the dtype of its column
+     * `dtype`, can be read from a zone map.
+     *
+     * @param fterm
+     * @param dtype
+     */
+    static bool is_supported(const t_fterm& fterm, t_dtype dtype);
+
+    /**
+     * @brief Summarize the first `nrows` rows of `column`.
+     *
+     * @param column
+     * @param nrows
+     */
+    void build(const t_column& column, t_uindex nrows);
+
+    /**
+     * @brief Widen the block of row `ridx` by the value `column` holds there.
+     *
+     * @param column
+     * @param ridx
+     */
+    void add(const t_column& column, t_uindex ridx);
+
+    /**
+     * @brief Set in `mask` every row of the blocks which may hold a value
+     * matching `fterm`, which must be supported; `mask` must be at least as
+     * large as the column.
+     *
+     * @param fterm
+     * @param mask
+     */
+    void get_rows(const t_fterm& fterm, t_mask& mask) const;
+
+    /**
+     * @brief Returns an estimate of the bytes used by the zone map.
+     */
+    t_uindex nbytes() const;
+
+private:
+    void add_value(t_uindex ridx, double value);
+
+    // Blocks with no valid values have a minimum above their maximum.
+    std::vector<double> m_min;
+    std::vector<double> m_max;
+};
+
+} // end namespace perspective
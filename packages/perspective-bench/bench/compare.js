@@ -0,0 +1,27 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2017, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+const fs = require("fs");
+const {report} = require("@finos/perspective-bench");
+
+// Compare two JSON reports written with `--json`, e.g.
+// `node bench/compare.js baseline.json current.json [threshold percent]`.
+// Exits with an error if any benchmark regressed.
+const [baseline_file, current_file, threshold] = process.argv.slice(2);
+if (!baseline_file || !current_file) {
+    console.error("Usage: node bench/compare.js <baseline.json> <current.json> [threshold percent]");
+    process.exit(2);
+}
+
+const baseline = JSON.parse(fs.readFileSync(baseline_file).toString());
+const current = JSON.parse(fs.readFileSync(current_file).toString());
+const rows = report.compare(baseline, current, threshold === undefined ? report.DEFAULT_THRESHOLD : parseFloat(threshold) / 100);
+if (report.print_comparison(rows, baseline, current) > 0) {
+    process.exitCode = 1;
+}
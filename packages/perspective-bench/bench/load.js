@@ -0,0 +1,330 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2017, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+/******************************************************************************
+ *
+ * Websocket Load Generator
+ *
+ * Simulates `--clients` clients, each of which opens a view of a remote table,
+ * subscribes to its `on_update`, and scrolls through it in `to_arrow` windows,
+ * while `--producers` producers `update()` it, then reports throughput,
+ * latency and server CPU.
+ *
+ * It runs against `python/perspective/bench/load_server.py`, which hosts the
+ * table `load` behind `PerspectiveManager` and `PerspectiveTornadoHandler`,
+ * and reports its CPU time at `/stats`:
+ *
+ *     python3 python/perspective/bench/load_server.py --port 8888
+ *     node bench/load.js --clients 50 --producers 4 --duration 30
+ *
+ * Update latency is measured, for every update and client, from the update's
+ * `update()` call to the first `on_update` notification the client receives
+ * after it - so an update the server had not yet processed when a
+ * notification was sent is credited to that notification.  Request latency is
+ * the round trip of each `to_arrow` window.
+ *
+ */
+
+const fs = require("fs");
+const http = require("http");
+const path = require("path");
+const program = require("commander");
+const perspective = require("@finos/perspective");
+const {report} = require("@finos/perspective-bench");
+
+const GROUPS = ["a", "b", "c", "d", "e", "f", "g", "h"];
+const SIDES = ["buy", "sell"];
+
+// The views clients open by default, in turn.
+const DEFAULT_VIEWS = [{}, {row_pivots: ["group"], columns: ["price", "qty"]}, {row_pivots: ["group"], column_pivots: ["side"], columns: ["qty"]}];
+
+const sleep = ms => new Promise(resolve => setTimeout(resolve, ms));
+
+/**
+ * GET the server's `/stats`, or `undefined` if it does not serve them.
+ */
+function get_stats(url) {
+    return new Promise(resolve => {
+        http.get(url, res => {
+            let body = "";
+            res.on("data", chunk => (body += chunk));
+            res.on("end", () => {
+                try {
+                    resolve(JSON.parse(body));
+                } catch (e) {
+                    resolve(undefined);
+                }
+            });
+        }).on("error", () => resolve(undefined));
+    });
+}
+
+/**
+ * The `update()` calls of every producer, in the order they were sent, which
+ * each client credits to the notifications it receives.
+ */
+class SendLog {
+    constructor() {
+        this.times = [];
+    }
+
+    push(time) {
+        this.times.push(time);
+    }
+}
+
+class LoadClient {
+    constructor(options, config, log) {
+        this._options = options;
+        this._config = config;
+        this._log = log;
+
+        // The index into `log.times` of the first update not yet credited
+        // to a notification.
+        this._cursor = 0;
+        this.notifications = 0;
+        this.update_latencies = [];
+        this.request_latencies = [];
+        this.windows = 0;
+        this.bytes = 0;
+        this.skipped_scrolls = 0;
+    }
+
+    async open() {
+        this._client = perspective.websocket(this._options.url);
+        const table = this._client.open_table(this._options.table);
+        const start = Date.now();
+        this._view = table.view(this._config);
+        this._num_rows = await this._view.num_rows();
+        this.open_latency = Date.now() - start;
+        this._cursor = this._log.times.length;
+        this._view.on_update(() => this._on_update());
+    }
+
+    _on_update() {
+        const now = Date.now();
+        const times = this._log.times;
+        this.notifications++;
+        for (; this._cursor < times.length && times[this._cursor] <= now; this._cursor++) {
+            this.update_latencies.push(now - times[this._cursor]);
+        }
+    }
+
+    /**
+     * Request the next `to_arrow` window every `scroll_interval`, skipping a
+     * scroll while the previous window is in flight.
+     */
+    async scroll(until) {
+        const window = this._options.window;
+        let offset = 0;
+        let in_flight = false;
+        while (Date.now() < until) {
+            if (in_flight) {
+                this.skipped_scrolls++;
+            } else {
+                in_flight = true;
+                const start_row = offset;
+                offset = offset + window >= this._num_rows ? 0 : offset + window;
+                const start = Date.now();
+                this._view
+                    .to_arrow({start_row, end_row: start_row + window})
+                    .then(async arrow => {
+                        this.request_latencies.push(Date.now() - start);
+                        this.windows++;
+                        this.bytes += arrow.byteLength;
+                        this._num_rows = await this._view.num_rows();
+                    })
+                    .finally(() => (in_flight = false));
+            }
+            await sleep(this._options.scrollInterval);
+        }
+    }
+
+    async close() {
+        await this._view.delete();
+        await this._client.terminate();
+    }
+}
+
+class LoadProducer {
+    constructor(options, log, seed) {
+        this._options = options;
+        this._log = log;
+        this._seed = seed;
+        this.updates = 0;
+        this.rows = 0;
+    }
+
+    async open() {
+        this._client = perspective.websocket(this._options.url);
+        this._table = this._client.open_table(this._options.table);
+        await this._table.size();
+    }
+
+    _make_rows() {
+        const rows = [];
+        for (let i = 0; i < this._options.batch; i++) {
+            const id = Math.floor(Math.random() * this._options.rows);
+            rows.push({
+                id,
+                group: GROUPS[id % GROUPS.length],
+                side: SIDES[(id + this._seed) % SIDES.length],
+                price: Math.random() * 100,
+                qty: Math.floor(Math.random() * 1000) + 1
+            });
+        }
+        return rows;
+    }
+
+    /**
+     * Send `rate` updates of `batch` rows a second until `until`.
+     */
+    async produce(until) {
+        const interval = 1000 / this._options.rate;
+        let next = Date.now();
+        while (next < until) {
+            const rows = this._make_rows();
+            this._log.push(Date.now());
+            this._table.update(rows);
+            this.updates++;
+            this.rows += rows.length;
+            next += interval;
+            await sleep(Math.max(0, next - Date.now()));
+        }
+    }
+
+    async close() {
+        await this._client.terminate();
+    }
+}
+
+function summarize(values) {
+    return values.length > 0 ? report.stats(values) : {samples: 0};
+}
+
+function sum(items, key) {
+    return items.reduce((total, item) => total + item[key], 0);
+}
+
+function concat(items, key) {
+    return [].concat(...items.map(item => item[key]));
+}
+
+function print_summary(result) {
+    const {throughput, latency, server} = result;
+    const fmt = stats => (stats.samples > 0 ? `p50 ${stats.median}ms  p95 ${stats.p95}ms  max ${stats.max}ms  (${stats.samples} samples)` : "no samples");
+    console.log(`\n${result.clients} clients, ${result.producers} producers, ${result.duration_s}s`);
+    console.log(`  updates sent         ${throughput.updates_per_s.toFixed(1)}/s  (${throughput.rows_per_s.toFixed(0)} rows/s)`);
+    console.log(`  notifications        ${throughput.notifications_per_s.toFixed(1)}/s`);
+    console.log(`  to_arrow windows     ${throughput.windows_per_s.toFixed(1)}/s  (${(throughput.bytes_per_s / 1024).toFixed(1)} KiB/s, ${throughput.skipped_scrolls} scrolls skipped)`);
+    console.log(`  update latency       ${fmt(latency.update)}`);
+    console.log(`  to_arrow latency     ${fmt(latency.request)}`);
+    console.log(`  view open latency    ${fmt(latency.open)}`);
+    if (server) {
+        console.log(`  server CPU           ${(100 * server.cpu_utilization).toFixed(1)}%  (${server.cpu_s.toFixed(2)}s)`);
+    } else {
+        console.log(`  server CPU           unavailable, the server does not serve /stats`);
+    }
+}
+
+async function run(options) {
+    const views = options.views ? JSON.parse(options.views) : DEFAULT_VIEWS;
+    const log = new SendLog();
+    const clients = [];
+    for (let i = 0; i < options.clients; i++) {
+        clients.push(new LoadClient(options, views[i % views.length], log));
+    }
+    const producers = [];
+    for (let i = 0; i < options.producers; i++) {
+        producers.push(new LoadProducer(options, log, i));
+    }
+
+    console.log(`Opening ${clients.length} clients and ${producers.length} producers against ${options.url}`);
+    await Promise.all([...clients.map(c => c.open()), ...producers.map(p => p.open())]);
+
+    const stats_before = await get_stats(options.statsUrl);
+    const start = Date.now();
+    const until = start + options.duration * 1000;
+    await Promise.all([...clients.map(c => c.scroll(until)), ...producers.map(p => p.produce(until))]);
+
+    // Wait for the last updates' notifications.
+    await sleep(options.drain);
+    const elapsed = (Date.now() - start) / 1000;
+    const stats_after = await get_stats(options.statsUrl);
+
+    const result = {
+        format: report.FORMAT_VERSION,
+        runtime: "load",
+        url: options.url,
+        clients: clients.length,
+        producers: producers.length,
+        duration_s: elapsed,
+        options: {rate: options.rate, batch: options.batch, window: options.window, scroll_interval_ms: options.scrollInterval, views},
+        throughput: {
+            updates_per_s: sum(producers, "updates") / elapsed,
+            rows_per_s: sum(producers, "rows") / elapsed,
+            notifications_per_s: sum(clients, "notifications") / elapsed,
+            windows_per_s: sum(clients, "windows") / elapsed,
+            bytes_per_s: sum(clients, "bytes") / elapsed,
+            skipped_scrolls: sum(clients, "skipped_scrolls")
+        },
+        latency: {
+            update: summarize(concat(clients, "update_latencies")),
+            request: summarize(concat(clients, "request_latencies")),
+            open: summarize(clients.map(c => c.open_latency))
+        }
+    };
+
+    if (stats_before && stats_after) {
+        const cpu_s = stats_after.cpu_user_s + stats_after.cpu_system_s - (stats_before.cpu_user_s + stats_before.cpu_system_s);
+        result.server = {
+            cpu_s,
+            cpu_utilization: cpu_s / (stats_after.wall_s - stats_before.wall_s),
+            max_rss_kb: stats_after.max_rss_kb,
+            latency: stats_after.latency
+        };
+    }
+
+    print_summary(result);
+    if (options.json) {
+        fs.writeFileSync(path.resolve(options.json), report.stable_stringify(result) + "\n");
+        console.log(`\nLoad report written to ${options.json}.`);
+    }
+
+    await Promise.all([...clients.map(c => c.close()), ...producers.map(p => p.close())]);
+}
+
+program
+    .description("Generate websocket load against a PerspectiveManager")
+    .option("-u, --url <url>", "The websocket to connect to", "ws://localhost:8888/websocket")
+    .option("-s, --stats-url <url>", "The server's CPU stats, defaults to `/stats` on the websocket's host")
+    .option("--table <name>", "The hosted table to open", "load")
+    .option("--rows <count>", "The rows of the hosted table, whose ids producers update", x => parseInt(x), 10000)
+    .option("-c, --clients <count>", "The number of clients", x => parseInt(x), 10)
+    .option("-p, --producers <count>", "The number of producers", x => parseInt(x), 1)
+    .option("-r, --rate <count>", "Updates each producer sends a second", x => parseFloat(x), 10)
+    .option("-b, --batch <rows>", "The rows of each update", x => parseInt(x), 100)
+    .option("-w, --window <rows>", "The rows of each `to_arrow` window", x => parseInt(x), 100)
+    .option("-i, --scroll-interval <ms>", "How often each client requests a window", x => parseInt(x), 250)
+    .option("-v, --views <json>", "A JSON array of view configs, which clients open in turn")
+    .option("-d, --duration <seconds>", "How long to generate load", x => parseFloat(x), 30)
+    .option("--drain <ms>", "How long to wait for notifications after the last update", x => parseInt(x), 1000)
+    .option("-j, --json <filename>", "Write a JSON report to this file")
+    .parse(process.argv);
+
+const options = program.opts();
+if (!options.statsUrl) {
+    const url = new URL(options.url);
+    options.statsUrl = `http://${url.host}/stats`;
+}
+
+run(options).catch(e => {
+    console.error(e);
+    process.exitCode = 1;
+});
@@ -0,0 +1,380 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2017, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+/******************************************************************************
+ *
+ * Regression Scenarios
+ *
+ * A fixed set of scenarios - ingestion, updates, view fan-out, pivot depth,
+ * sort, filter, computed columns and serialization - whose ids stay stable
+ * across versions, so that `--json` reports of two runs can be compared with
+ * `--baseline`.
+ *
+ */
+
+const ARROW = "https://unpkg.com/@jpmorganchase/perspective-examples@0.2.0-beta.2/build/superstore.arrow";
+
+const FORMATS = ["arrow", "csv", "rows", "columns"];
+const UPDATE_FORMATS = ["arrow", "rows", "columns"];
+const UPDATE_SIZE = 500;
+const FAN_OUT_VIEWS = [1, 10, 50];
+const PIVOT_COLUMNS = ["Region", "State", "City", "Category", "Sub-Category"];
+
+const SORT_OPTIONS = {
+    float: [["Sales", "desc"]],
+    string: [["Customer Name", "asc"]],
+    multi: [
+        ["Region", "asc"],
+        ["Sales", "desc"]
+    ]
+};
+
+const FILTER_OPTIONS = {
+    float: [["Sales", ">", 100]],
+    string: [["State", "==", "Texas"]],
+    "begins with": [["Customer Name", "begins with", "A"]],
+    multi: [
+        ["Sales", ">", 100],
+        ["Region", "==", "West"]
+    ]
+};
+
+const COMPUTED_OPTIONS = {
+    "+": ["Sales", "Profit"],
+    uppercase: ["Customer Name"],
+    week_bucket: ["Order Date"]
+};
+
+/******************************************************************************
+ *
+ * Benchmarks
+ *
+ */
+
+PerspectiveBench.setIterations(50);
+PerspectiveBench.setTimeout(2000);
+PerspectiveBench.setToss(5);
+
+let worker, data;
+
+beforeAll(async () => {
+    if (typeof module !== "undefined" && module.exports) {
+        worker = require("@finos/perspective");
+    } else {
+        await load_dynamic_browser("perspective", PerspectiveBench.commandArg(0));
+        window.perspective = window.perspective.default || window.perspective;
+        worker = window.perspective.worker();
+        await wait_for_perspective();
+    }
+    data = await get_data(worker);
+});
+
+describe("Ingest", async () => {
+    let table;
+
+    afterEach(async () => {
+        await table.delete();
+    });
+
+    for (const format of FORMATS) {
+        benchmark(format, async () => {
+            const test = data[format];
+            table = worker.table(test.slice ? test.slice() : test);
+            await table.size();
+        });
+    }
+});
+
+describe("Update", async () => {
+    for (const index of ["unindexed", "indexed"]) {
+        describe(index, async () => {
+            let table;
+
+            beforeAll(async () => {
+                const options = index === "indexed" ? {index: "Row ID"} : {};
+                table = worker.table(data.arrow.slice(), options);
+                await table.size();
+            });
+
+            afterAll(async () => {
+                await table.delete();
+            });
+
+            for (const format of UPDATE_FORMATS) {
+                benchmark(format, async () => {
+                    const test = data.updates[format];
+                    table.update(test.slice ? test.slice() : test);
+                    await table.size();
+                });
+            }
+        });
+    }
+});
+
+describe("Fan-out", async () => {
+    for (const count of FAN_OUT_VIEWS) {
+        describe(`${count} views`, async () => {
+            let table, views;
+
+            beforeAll(async () => {
+                table = worker.table(data.arrow.slice(), {index: "Row ID"});
+                views = [];
+                for (let i = 0; i < count; i++) {
+                    const view = table.view({row_pivots: [PIVOT_COLUMNS[i % PIVOT_COLUMNS.length]], columns: ["Sales", "Profit"]});
+                    view.on_update(() => {});
+                    views.push(view);
+                }
+                await table.size();
+            });
+
+            afterAll(async () => {
+                for (const view of views) {
+                    await view.delete();
+                }
+                await table.delete();
+            });
+
+            benchmark("update", async () => {
+                table.update(data.updates.arrow.slice());
+                await Promise.all(views.map(view => view.num_rows()));
+            });
+        });
+    }
+});
+
+describe("Pivot", async () => {
+    let table;
+
+    beforeAll(async () => {
+        table = worker.table(data.arrow.slice());
+        await table.size();
+    });
+
+    afterAll(async () => {
+        await table.delete();
+    });
+
+    for (let depth = 0; depth <= PIVOT_COLUMNS.length; depth++) {
+        describe(`depth ${depth}`, async () => {
+            let view;
+
+            afterEach(async () => {
+                await view.delete();
+            });
+
+            benchmark("row", async () => {
+                view = table.view({row_pivots: PIVOT_COLUMNS.slice(0, depth), columns: ["Sales", "Profit", "Quantity"]});
+                await view.num_rows();
+            });
+
+            benchmark("row and column", async () => {
+                view = table.view({row_pivots: PIVOT_COLUMNS.slice(0, depth), column_pivots: ["Segment"], columns: ["Sales", "Profit", "Quantity"]});
+                await view.num_rows();
+            });
+        });
+    }
+});
+
+describe("Sort", async () => {
+    let table;
+
+    beforeAll(async () => {
+        table = worker.table(data.arrow.slice());
+        await table.size();
+    });
+
+    afterAll(async () => {
+        await table.delete();
+    });
+
+    for (const name of Object.keys(SORT_OPTIONS)) {
+        describe(name, async () => {
+            let view;
+
+            afterEach(async () => {
+                await view.delete();
+            });
+
+            benchmark("flat", async () => {
+                view = table.view({sort: SORT_OPTIONS[name]});
+                await view.num_rows();
+            });
+
+            benchmark("pivoted", async () => {
+                view = table.view({row_pivots: ["State"], sort: SORT_OPTIONS[name].filter(([column]) => column !== "State")});
+                await view.num_rows();
+            });
+        });
+    }
+});
+
+describe("Filter", async () => {
+    let table;
+
+    beforeAll(async () => {
+        table = worker.table(data.arrow.slice());
+        await table.size();
+    });
+
+    afterAll(async () => {
+        await table.delete();
+    });
+
+    for (const name of Object.keys(FILTER_OPTIONS)) {
+        describe(name, async () => {
+            let view;
+
+            afterEach(async () => {
+                await view.delete();
+            });
+
+            benchmark("flat", async () => {
+                view = table.view({filter: FILTER_OPTIONS[name]});
+                await view.num_rows();
+            });
+
+            benchmark("pivoted", async () => {
+                view = table.view({row_pivots: ["Category"], filter: FILTER_OPTIONS[name]});
+                await view.num_rows();
+            });
+        });
+    }
+});
+
+describe("Computed", async () => {
+    let table;
+
+    beforeAll(async () => {
+        table = worker.table(data.arrow.slice());
+        await table.size();
+    });
+
+    afterAll(async () => {
+        await table.delete();
+    });
+
+    for (const name of Object.keys(COMPUTED_OPTIONS)) {
+        describe(name, async () => {
+            const computed_columns = [{column: "computed", computed_function_name: name, inputs: COMPUTED_OPTIONS[name]}];
+            let view;
+
+            afterEach(async () => {
+                await view.delete();
+            });
+
+            benchmark("flat", async () => {
+                view = table.view({computed_columns});
+                await view.num_rows();
+            });
+
+            benchmark("pivoted", async () => {
+                view = table.view({row_pivots: ["computed"], computed_columns});
+                await view.num_rows();
+            });
+        });
+    }
+});
+
+describe("Serialize", async () => {
+    let table;
+
+    beforeAll(async () => {
+        table = worker.table(data.arrow.slice());
+        await table.size();
+    });
+
+    afterAll(async () => {
+        await table.delete();
+    });
+
+    for (const [name, config] of [
+        ["flat", {}],
+        ["pivoted", {row_pivots: ["State", "City"]}]
+    ]) {
+        describe(name, async () => {
+            let view;
+
+            beforeAll(async () => {
+                view = table.view(config);
+                await view.num_rows();
+            });
+
+            afterAll(async () => {
+                await view.delete();
+            });
+
+            for (const format of ["json", "columns", "csv", "arrow"]) {
+                benchmark(format, async () => {
+                    await view[`to_${format}`]();
+                });
+            }
+        });
+    }
+});
+
+/******************************************************************************
+ *
+ * Utils
+ *
+ */
+
+const wait_for_perspective = () => new Promise(resolve => window.addEventListener("perspective-ready", resolve));
+
+const load_dynamic_browser = (name, url) => {
+    return new Promise(resolve => {
+        const existingScript = document.getElementById(name);
+        if (!existingScript) {
+            const script = document.createElement("script");
+            script.src = url;
+            script.id = name;
+            document.body.appendChild(script);
+            script.onload = () => {
+                if (resolve) resolve();
+            };
+        } else {
+            resolve();
+        }
+    });
+};
+
+async function get_arrow() {
+    if (typeof module !== "undefined" && module.exports) {
+        const fs = require("fs");
+        const path = require("path");
+        const ARROW_FILE = path.resolve(__dirname, "../../../../examples/simple/superstore.arrow");
+        return fs.readFileSync(ARROW_FILE, null).buffer;
+    }
+
+    const content = await fetch(ARROW);
+    return await content.arrayBuffer();
+}
+
+async function get_data(worker) {
+    console.log("Loading Arrow");
+    const arrow = await get_arrow();
+
+    console.log("Generating formats");
+    const tbl = worker.table(arrow.slice());
+    const view = tbl.view();
+    const rows = await view.to_json();
+    const columns = await view.to_columns();
+    const csv = await view.to_csv();
+
+    // Updates overwrite the first rows of an indexed table, and append to an
+    // unindexed one.
+    const updates = {
+        arrow: await view.to_arrow({end_row: UPDATE_SIZE}),
+        rows: await view.to_json({end_row: UPDATE_SIZE}),
+        columns: await view.to_columns({end_row: UPDATE_SIZE})
+    };
+    view.delete();
+    tbl.delete();
+
+    return {arrow, csv, rows, columns, updates};
+}
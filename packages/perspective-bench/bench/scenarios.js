@@ -0,0 +1,26 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2017, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+const PerspectiveBench = require("@finos/perspective-bench");
+
+// Runs the regression scenarios against the local build, writing a JSON
+// report to `dist/scenarios.json`.  Set `PSP_BENCH_BASELINE` to the report of
+// an earlier run to compare against it; a regression fails the run.
+async function run() {
+    await PerspectiveBench.run("master", "bench/scenarios.benchmark.js", `http://${process.env.PSP_DOCKER_PUPPETEER ? `localhost` : `host.docker.internal`}:8080/perspective.js`, {
+        output: "dist/scenarios",
+        puppeteer: true,
+        repeats: process.env.PSP_BENCH_REPEATS || 3,
+        json: "dist/scenarios.json",
+        baseline: process.env.PSP_BENCH_BASELINE,
+        failOnRegression: true
+    });
+}
+
+run();
@@ -12,6 +12,7 @@ const path = require("path");
 const perspective = require("@finos/perspective");
 const chalk = require("chalk");
 const program = require("commander");
+const report = require("./report.js");
 
 const execSync = require("child_process").execSync;
 
@@ -77,7 +78,8 @@ exports.run = async function run(version, benchmark, ...cmdArgs) {
     }
 
     const RUN_TEST = fs.readFileSync(path.resolve(benchmark)).toString();
-    let bins;
+    const repeats = Math.max(1, parseInt(options.repeats || 1));
+    let bins = [];
 
     if (options.puppeteer) {
         const puppeteer = require("puppeteer");
@@ -88,14 +90,25 @@ exports.run = async function run(version, benchmark, ...cmdArgs) {
 
         execSync(`renice -n -20 ${browser.process().pid}`, {stdio: "inherit"});
 
-        bins = await run_version(browser, cmdArgs, RUN_TEST);
+        for (let repeat = 0; repeat < repeats; repeat++) {
+            const results = await run_version(browser, cmdArgs, RUN_TEST);
+            bins = bins.concat(results.map(result => ({...result, repeat})));
+        }
 
         await browser.close();
 
         console.log(`Benchmark suite has finished running - results are in ${benchmark_name}.html.`);
     } else {
-        bins = await run_node_version(cmdArgs, RUN_TEST);
+        for (let repeat = 0; repeat < repeats; repeat++) {
+            const results = await run_node_version(cmdArgs, RUN_TEST);
+            bins = bins.concat(results.map(result => ({...result, repeat})));
+        }
+    }
+
+    if (options.json || options.baseline) {
+        write_report(bins, version, benchmark, repeats, options);
     }
+
     bins = bins.map(result => ({...result, version, version_index}));
     version_index++;
     if (table === undefined) {
@@ -110,6 +123,29 @@ exports.run = async function run(version, benchmark, ...cmdArgs) {
     fs.writeFileSync(path.join(process.cwd(), `${benchmark_name}.html`), fs.readFileSync(path.join(__dirname, "..", "html", `benchmark.html`)).toString());
 };
 
+/**
+ * Summarize `bins` as a JSON report, write it to `options.json` if set, and
+ * compare it against the report at `options.baseline` if set.  With
+ * `options.failOnRegression`, a regression sets the process's exit code.
+ */
+function write_report(bins, version, benchmark, repeats, options) {
+    const summary = report.summarize(bins, {version, suite: path.basename(benchmark), repeats});
+    if (options.json) {
+        fs.writeFileSync(path.resolve(options.json), report.stable_stringify(summary) + "\n");
+        console.log(`Benchmark report written to ${options.json}.`);
+    }
+
+    if (options.baseline) {
+        const baseline = JSON.parse(fs.readFileSync(path.resolve(options.baseline)).toString());
+        const threshold = options.threshold === undefined ? report.DEFAULT_THRESHOLD : parseFloat(options.threshold) / 100;
+        const rows = report.compare(baseline, summary, threshold);
+        const regressions = report.print_comparison(rows, baseline, summary);
+        if (regressions > 0 && options.failOnRegression) {
+            process.exitCode = 1;
+        }
+    }
+}
+
 exports.registerCmd = function registerCmd() {
     program
         .version(JSON.parse(fs.readFileSync(path.join(__dirname, "..", "..", "package.json")).toString()).version)
@@ -118,6 +154,11 @@ exports.registerCmd = function registerCmd() {
         .option("-o, --output <filename>", "Filename to write to, defaults to `benchmark`")
         .option("-r, --read", "Read from disk or overwrite")
         .option("-p, --puppeteer", "Should run the suite in Puppeteer (Headless)")
+        .option("-n, --repeats <count>", "Run the suite this many times, pooling the samples of each benchmark, defaults to 1")
+        .option("-j, --json <filename>", "Write a JSON report of each benchmark's statistics to this file")
+        .option("-b, --baseline <filename>", "Compare against the JSON report of a baseline run")
+        .option("-t, --threshold <percent>", "Change in median time reported as a regression, defaults to 10")
+        .option("--fail-on-regression", "Exit with an error when the comparison finds a regression")
         .action((...args) => {
             const options = args.splice(args.length - 1, 1)[0];
 
@@ -131,4 +172,6 @@ exports.registerCmd = function registerCmd() {
     }
 };
 
+exports.report = report;
+
 exports.default = exports;
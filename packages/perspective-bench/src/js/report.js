@@ -0,0 +1,201 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2017, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+const chalk = require("chalk");
+
+/**
+ * The version of the JSON report format, which `perspective-bench` and
+ * `python/perspective/bench` both write and compare.
+ */
+const FORMAT_VERSION = 1;
+
+/**
+ * The default relative change in median time past which a benchmark is
+ * reported as a regression or an improvement.
+ */
+const DEFAULT_THRESHOLD = 0.1;
+
+/**
+ * Serialize `obj` as JSON with its keys sorted, so reports of the same suite
+ * diff cleanly against each other.
+ */
+function stable_stringify(obj) {
+    return JSON.stringify(
+        obj,
+        (key, value) => {
+            if (value && typeof value === "object" && !Array.isArray(value)) {
+                const sorted = {};
+                for (const k of Object.keys(value).sort()) {
+                    sorted[k] = value[k];
+                }
+                return sorted;
+            }
+            return value;
+        },
+        4
+    );
+}
+
+function round(x) {
+    return Math.round(x * 1000) / 1000;
+}
+
+function percentile(sorted, p) {
+    if (sorted.length === 1) {
+        return sorted[0];
+    }
+    const idx = (sorted.length - 1) * p;
+    const lo = Math.floor(idx);
+    const hi = Math.ceil(idx);
+    return sorted[lo] + (sorted[hi] - sorted[lo]) * (idx - lo);
+}
+
+/**
+ * Returns the summary statistics of a list of times in milliseconds.
+ */
+function stats(times) {
+    const sorted = times.slice().sort((a, b) => a - b);
+    const mean = sorted.reduce((x, y) => x + y, 0) / sorted.length;
+    const variance = sorted.length > 1 ? sorted.map(x => Math.pow(x - mean, 2)).reduce((x, y) => x + y, 0) / (sorted.length - 1) : 0;
+    return {
+        samples: sorted.length,
+        mean: round(mean),
+        median: round(percentile(sorted, 0.5)),
+        stddev: round(Math.sqrt(variance)),
+        min: round(sorted[0]),
+        max: round(sorted[sorted.length - 1]),
+        p95: round(percentile(sorted, 0.95))
+    };
+}
+
+/**
+ * Returns the id of a result row from the browser runtime - its categories
+ * in order, then its test name, joined by `/`.
+ */
+function to_id(row) {
+    const path = [];
+    for (let idx = 1; row[`Category ${idx}`] !== undefined; idx++) {
+        const cat = row[`Category ${idx}`];
+        if (cat !== "-") {
+            path.push(cat);
+        }
+    }
+    path.push(row.test);
+    return path.join("/");
+}
+
+/**
+ * Summarize the result rows of one or more runs of a suite by benchmark,
+ * excluding the samples `filterOutliers` flagged.
+ *
+ * @param {Array<Object>} rows the rows returned by `PerspectiveBench.run()`.
+ * @param {Object} meta fields to record at the top level of the report, e.g.
+ * `version` and `repeats`.
+ * @returns {Object} a report, which `write_report` serializes.
+ */
+function summarize(rows, meta = {}) {
+    const times = {};
+    const all_times = {};
+    for (const row of rows) {
+        const id = to_id(row);
+        all_times[id] = all_times[id] || [];
+        all_times[id].push(row.time);
+        if (row.outlier !== true) {
+            times[id] = times[id] || [];
+            times[id].push(row.time);
+        }
+    }
+
+    const results = {};
+    for (const id of Object.keys(all_times)) {
+        // A benchmark whose every sample is an outlier keeps them all.
+        results[id] = stats(times[id] || all_times[id]);
+    }
+
+    return {format: FORMAT_VERSION, runtime: "js", ...meta, results};
+}
+
+/**
+ * Compare a report against a baseline report by median time.
+ *
+ * A benchmark is a regression (or improvement) when its median changed by
+ * more than `threshold`, and by more than twice the standard error of the
+ * difference of the two runs' means, so noisy benchmarks need a larger
+ * change to be flagged.
+ *
+ * @returns {Array<Object>} a row per benchmark in either report, sorted by
+ * id, with a `status` of "regression", "improvement", "unchanged", "added"
+ * or "removed".
+ */
+function compare(baseline, current, threshold = DEFAULT_THRESHOLD) {
+    const base = baseline.results || {};
+    const curr = current.results || {};
+    const ids = Array.from(new Set([...Object.keys(base), ...Object.keys(curr)])).sort();
+    return ids.map(id => {
+        const b = base[id];
+        const c = curr[id];
+        if (!b) {
+            return {id, status: "added", current: c.median};
+        }
+        if (!c) {
+            return {id, status: "removed", baseline: b.median};
+        }
+
+        const change = b.median > 0 ? c.median / b.median - 1 : 0;
+        const stderr = Math.sqrt(Math.pow(b.stddev, 2) / b.samples + Math.pow(c.stddev, 2) / c.samples);
+        const significant = Math.abs(c.median - b.median) > 2 * stderr;
+        let status = "unchanged";
+        if (significant && change > threshold) {
+            status = "regression";
+        } else if (significant && change < -threshold) {
+            status = "improvement";
+        }
+        return {id, status, baseline: b.median, current: c.median, change: round(change)};
+    });
+}
+
+const STATUS_COLORS = {
+    regression: "redBright",
+    improvement: "greenBright",
+    unchanged: "white",
+    added: "yellowBright",
+    removed: "yellowBright"
+};
+
+/**
+ * Print the rows returned by `compare`, and returns the number of
+ * regressions.
+ */
+function print_comparison(rows, baseline, current) {
+    console.log(chalk`\n{whiteBright Comparing ${current.version || "current"} against baseline ${baseline.version || "baseline"}}`);
+    let regressions = 0;
+    for (const row of rows) {
+        const color = STATUS_COLORS[row.status];
+        const base = row.baseline === undefined ? "-" : `${row.baseline.toFixed(3)}ms`;
+        const curr = row.current === undefined ? "-" : `${row.current.toFixed(3)}ms`;
+        const change = row.change === undefined ? "" : `${row.change > 0 ? "+" : ""}${(100 * row.change).toFixed(2)}%`;
+        console.log(chalk`  {${color} ${row.status.padEnd(11)}} ${base.padStart(12)} -> ${curr.padStart(12)} ${change.padStart(9)}  {whiteBright ${row.id}}`);
+        if (row.status === "regression") {
+            regressions++;
+        }
+    }
+    const counts = {};
+    for (const row of rows) {
+        counts[row.status] = (counts[row.status] || 0) + 1;
+    }
+    console.log(
+        `\n  ${Object.keys(STATUS_COLORS)
+            .filter(x => counts[x])
+            .map(x => `${counts[x]} ${x}`)
+            .join(", ")}`
+    );
+    return regressions;
+}
+
+module.exports = {FORMAT_VERSION, DEFAULT_THRESHOLD, stable_stringify, stats, summarize, compare, print_comparison};
@@ -109,7 +109,7 @@ class PerspectiveWebpackPlugin {
         }
 
         rules.push({
-            test: /psp\.async\.wasm\.js$/,
+            test: /psp\.async(\.64)?\.wasm\.js$/,
             include: this.options.load_path,
             use: {
                 loader: WASM_LOADER,
@@ -28,6 +28,10 @@ declare module "@finos/perspective" {
 
     enum NUMBER_AGGREGATES {
         ANY = "any",
+        APPROX_DISTINCT_COUNT = "approx distinct count",
+        APPROX_P50 = "approx p50",
+        APPROX_P90 = "approx p90",
+        APPROX_P99 = "approx p99",
         AVERAGE = "avg",
         COUNT = "count",
         DISTINCT_COUNT = "distinct count",
@@ -48,6 +52,7 @@ declare module "@finos/perspective" {
 
     enum STRING_AGGREGATES {
         ANY = "any",
+        APPROX_DISTINCT_COUNT = "approx distinct count",
         COUNT = "count",
         DISTINCT_COUNT = "distinct count",
         DISTINCT_LEAF = "distinct leaf",
@@ -60,6 +65,7 @@ declare module "@finos/perspective" {
     enum BOOLEAN_AGGREGATES {
         AND = "and",
         ANY = "any",
+        APPROX_DISTINCT_COUNT = "approx distinct count",
         COUNT = "count",
         DISTINCT_COUNT = "distinct count",
         DISTINCT_LEAF = "distinct leaf",
@@ -171,6 +177,21 @@ declare module "@finos/perspective" {
         close(): void;
     }
 
+    export type WorkerPoolOptions = {
+        workers?: number;
+    };
+
+    export class WorkerPoolManager extends WebSocketManager {
+        constructor(config?: WorkerPoolOptions);
+        table(data: TableData | Schema, options?: TableOptions): Table;
+        terminate(): Promise<void>;
+    }
+
+    export class WorkerPoolServer extends WorkerPoolManager {
+        constructor(config?: WebSocketServerOptions & WorkerPoolOptions);
+        close(): void;
+    }
+
     export function perspective_assets(assets: string[], host_psp: boolean): (request: any, response: any) => void;
 
     type perspective = {
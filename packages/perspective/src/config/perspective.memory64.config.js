@@ -0,0 +1,28 @@
+const path = require("path");
+const webpack = require("webpack");
+const common = require("./common.config.js");
+const {minimizer} = require("./minimizer.js");
+
+// The engine built with `PSP_WASM_MEMORY64`, in place of the default build.
+const MEMORY64_ENGINE = /psp\.async(\.wasm)?\.js$/;
+
+module.exports = common({build_worker: true}, config =>
+    Object.assign(config, {
+        entry: "./dist/esm/perspective.parallel.js",
+        output: {
+            filename: "perspective.memory64.js",
+            library: "perspective",
+            libraryTarget: "umd",
+            libraryExport: "default",
+            path: path.resolve(__dirname, "../../dist/umd")
+        },
+        plugins: config.plugins.concat([
+            new webpack.NormalModuleReplacementPlugin(MEMORY64_ENGINE, resource => {
+                resource.request = resource.request.replace("psp.async", "psp.async.64");
+            })
+        ]),
+        optimization: {
+            minimizer: minimizer
+        }
+    })
+);
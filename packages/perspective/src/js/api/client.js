@@ -30,6 +30,7 @@ export class Client {
             handlers: {},
             messages: []
         };
+        this._view_caches = new Map();
         bindall(this);
     }
 
@@ -49,7 +50,7 @@ export class Client {
      */
     post(msg, resolve, reject, keep_alive = false) {
         if (resolve || reject) {
-            this._worker.handlers[++this._worker.msg_id] = {resolve, reject, keep_alive};
+            this._worker.handlers[++this._worker.msg_id] = {resolve, reject, keep_alive, name: msg.name};
         }
         msg.id = this._worker.msg_id;
         if (this._worker.initialized.value) {
@@ -67,6 +68,128 @@ export class Client {
         }
     }
 
+    /**
+     * Start or stop recording engine spans on the server, as
+     * `perspective.set_tracing_enabled` does.
+     *
+     * @param {boolean} enabled
+     */
+    set_tracing_enabled(enabled) {
+        this.post({cmd: "set_tracing_enabled", enabled});
+    }
+
+    /**
+     * The engine spans recorded on the server, as a Chrome trace event
+     * object.
+     *
+     * @returns {Promise<Object>}
+     */
+    get_trace() {
+        return new Promise((resolve, reject) => this.post({cmd: "get_trace"}, resolve, reject));
+    }
+
+    /**
+     * Drop the engine spans recorded on the server.
+     */
+    clear_trace() {
+        this.post({cmd: "clear_trace"});
+    }
+
+    /**
+     * Start or stop sampling engine phases on the server, as
+     * `perspective.set_profiling_enabled` does.
+     *
+     * @param {boolean} enabled
+     */
+    set_profiling_enabled(enabled) {
+        this.post({cmd: "set_profiling_enabled", enabled});
+    }
+
+    /**
+     * The engine phases sampled on the server, as
+     * `perspective.get_profile` returns them.
+     *
+     * @returns {Promise<Object>}
+     */
+    get_profile() {
+        return new Promise((resolve, reject) => this.post({cmd: "get_profile"}, resolve, reject));
+    }
+
+    /**
+     * Zero the profiling counters of the server.
+     */
+    clear_profile() {
+        this.post({cmd: "clear_profile"});
+    }
+
+    /**
+     * Start or stop counting engine allocations on the server, as
+     * `perspective.set_alloc_stats_enabled` does.
+     *
+     * @param {boolean} enabled
+     */
+    set_alloc_stats_enabled(enabled) {
+        this.post({cmd: "set_alloc_stats_enabled", enabled});
+    }
+
+    /**
+     * The engine allocation counters of the server, by owner.
+     *
+     * @returns {Promise<Object>}
+     */
+    get_alloc_stats() {
+        return new Promise((resolve, reject) => this.post({cmd: "get_alloc_stats"}, resolve, reject));
+    }
+
+    /**
+     * Zero the engine allocation counters of the server.
+     */
+    reset_alloc_stats() {
+        this.post({cmd: "reset_alloc_stats"});
+    }
+
+    /**
+     * Make many table and view method calls in one round trip to the
+     * server, which calls them in order.
+     *
+     * @param {Array} calls Each call as `[table_or_view, method, ...args]`,
+     * where `table_or_view` is a table or view of this client.
+     *
+     * @returns {Promise<Array>} The result of each call, or an `Error` for
+     * each that failed.
+     *
+     * @example
+     * const [num_rows, schema, arrow] = await client.batch([
+     *     [view, "num_rows"],
+     *     [view, "schema"],
+     *     [view, "to_arrow", {end_row: 100}]
+     * ]);
+     */
+    batch(calls) {
+        const msg = {
+            cmd: "batch",
+            calls: calls.map(([obj, method, ...args]) => ({
+                cmd: obj instanceof proxy_view ? "view_method" : "table_method",
+                name: obj._name,
+                method,
+                args
+            }))
+        };
+        return new Promise((resolve, reject) => {
+            this.post(msg, results => resolve(results.map(result => (result.error !== undefined ? new Error(result.error) : result.data))), reject);
+        });
+    }
+
+    /**
+     * Drop the data cached for every view of this client, e.g. when one of
+     * its tables is updated.
+     */
+    clear_view_caches() {
+        for (const cache of this._view_caches.values()) {
+            cache.clear();
+        }
+    }
+
     /**
      * Must be implemented in order to transport commands to the server.
      */
@@ -123,6 +246,11 @@ export class Client {
         if (e.data.id) {
             var handler = this._worker.handlers[e.data.id];
             if (handler) {
+                // A pushed event of a view, e.g. `on_update`, drops its
+                // cached data before any listener reads it.
+                if (handler.keep_alive && this._view_caches.has(handler.name)) {
+                    this._view_caches.get(handler.name).clear();
+                }
                 if (e.data.error) {
                     handler.reject(e.data.error);
                 } else {
@@ -86,6 +86,33 @@ export class Server {
             case "init":
                 this.init(msg);
                 break;
+            case "set_tracing_enabled":
+                this.perspective.set_tracing_enabled(msg.enabled);
+                break;
+            case "get_trace":
+                this.post({id: msg.id, data: this.perspective.get_trace()});
+                break;
+            case "clear_trace":
+                this.perspective.clear_trace();
+                break;
+            case "set_profiling_enabled":
+                this.perspective.set_profiling_enabled(msg.enabled);
+                break;
+            case "get_profile":
+                this.post({id: msg.id, data: this.perspective.get_profile()});
+                break;
+            case "clear_profile":
+                this.perspective.clear_profile();
+                break;
+            case "set_alloc_stats_enabled":
+                this.perspective.set_alloc_stats_enabled(msg.enabled);
+                break;
+            case "get_alloc_stats":
+                this.post({id: msg.id, data: this.perspective.get_alloc_stats()});
+                break;
+            case "reset_alloc_stats":
+                this.perspective.reset_alloc_stats();
+                break;
             case "table":
                 if (typeof msg.args[0] === "undefined") {
                     this._tables[msg.name] = [];
@@ -119,6 +146,9 @@ export class Server {
             case "view_method":
                 this.process_method_call(msg);
                 break;
+            case "batch":
+                this.process_batch(msg);
+                break;
             case "view":
                 // create a new view and track it with `client_id`
                 this._views[msg.view_name] = this._tables[msg.table_name].view(msg.config);
@@ -188,7 +218,7 @@ export class Server {
         if (msg.method === "delete") {
             delete this._views[msg.name];
         }
-        if (msg.method === "to_arrow") {
+        if (msg.method === "to_arrow" || (msg.method === "cursor_to_arrow" && result)) {
             this.post(
                 {
                     id: msg.id,
@@ -204,6 +234,37 @@ export class Server {
         }
     }
 
+    /**
+     * Call each of the `table_method` and `view_method` messages in the
+     * `calls` of a `batch` message, and post their results in one message:
+     * for each call, `{data}` with its result or `{error}` if it failed.
+     *
+     * @param {Object} msg
+     */
+    process_batch(msg) {
+        const calls = (msg.calls || []).map(call => {
+            try {
+                if (call.subscribe || (call.cmd !== "table_method" && call.cmd !== "view_method")) {
+                    throw new Error("Only table and view method calls can be batched");
+                }
+                const obj = call.cmd === "table_method" ? this._tables[call.name] : this._views[call.name];
+                if (!obj || obj.push) {
+                    throw new Error(`${call.cmd === "table_method" ? "Table" : "View"} is not initialized`);
+                }
+                if (call.method === "delete" && call.cmd === "view_method") {
+                    delete this._views[call.name];
+                }
+                return Promise.resolve(obj[call.method].apply(obj, call.args || []));
+            } catch (error) {
+                return Promise.reject(error);
+            }
+        });
+        Promise.all(calls.map(call => call.then(data => ({data}), error => ({error: error.message || `${error}`})))).then(results => {
+            const transferable = results.filter(result => result.data instanceof ArrayBuffer).map(result => result.data);
+            this.post({id: msg.id, batch: true, data: results}, transferable.length > 0 ? transferable : undefined);
+        });
+    }
+
     /**
      * Given a call to a table or view method, process it.
      *
@@ -99,21 +99,54 @@ table.prototype.is_valid_filter = async_queue("is_valid_filter", "table_method")
 
 table.prototype.size = async_queue("size", "table_method");
 
+table.prototype.get_memory_usage = async_queue("get_memory_usage", "table_method");
+
+table.prototype.get_update_stats = async_queue("get_update_stats", "table_method");
+
+table.prototype.get_latency_stats = async_queue("get_latency_stats", "table_method");
+
+table.prototype.reset_latency_stats = async_queue("reset_latency_stats", "table_method");
+
 table.prototype.columns = async_queue("columns", "table_method");
 
-table.prototype.clear = async_queue("clear", "table_method");
+/**
+ * Add a table method call which changes its rows to the queue, dropping the
+ * data cached for the views of the client first.
+ *
+ * @param {*} method
+ */
+function invalidating_queue(method) {
+    const call = async_queue(method, "table_method");
+    return function() {
+        if (this._worker.clear_view_caches) {
+            this._worker.clear_view_caches();
+        }
+        return call.apply(this, arguments);
+    };
+}
+
+table.prototype.clear = invalidating_queue("clear");
 
-table.prototype.replace = async_queue("replace", "table_method");
+table.prototype.replace = invalidating_queue("replace");
 
 table.prototype.delete = async_queue("delete", "table_method");
 
 table.prototype.on_delete = subscribe("on_delete", "table_method", true);
 
-table.prototype.remove = async_queue("remove", "table_method");
+table.prototype.remove = invalidating_queue("remove");
+
+table.prototype.generate = async_queue("generate", "table_method");
 
 table.prototype.remove_delete = unsubscribe("remove_delete", "table_method", true);
 
+table.prototype.on_update_stats = subscribe("on_update_stats", "table_method", true);
+
+table.prototype.remove_update_stats = unsubscribe("remove_update_stats", "table_method", true);
+
 table.prototype.update = function(data, options) {
+    if (this._worker.clear_view_caches) {
+        this._worker.clear_view_caches();
+    }
     return new Promise((resolve, reject) => {
         var msg = {
             name: this._name,
@@ -45,38 +45,146 @@ export function proxy_view(worker, name) {
 
 proxy_view.prototype = view.prototype;
 
+/**
+ * Add a method call to the queue as `async_queue` does, returning the result
+ * of an earlier call with the same arguments while the view's cache is
+ * enabled and the server has pushed no updates of it since.
+ *
+ * @param {*} method
+ */
+function cached_queue(method) {
+    const call = async_queue(method);
+    return function() {
+        const cache = this._worker._view_caches && this._worker._view_caches.get(this._name);
+        if (!cache) {
+            return call.apply(this, arguments);
+        }
+
+        const key = method + JSON.stringify(Array.prototype.slice.call(arguments));
+        let result = cache.get(key);
+        if (result === undefined) {
+            result = call.apply(this, arguments);
+            cache.set(key, result);
+            result.catch(() => {
+                if (cache.get(key) === result) {
+                    cache.delete(key);
+                }
+            });
+        }
+        return result;
+    };
+}
+
+/**
+ * Add a method call which changes the rows of the view to the queue, dropping
+ * its cached data first.
+ *
+ * @param {*} method
+ */
+function invalidating_queue(method) {
+    const call = async_queue(method);
+    return function() {
+        const cache = this._worker._view_caches && this._worker._view_caches.get(this._name);
+        if (cache) {
+            cache.clear();
+        }
+        return call.apply(this, arguments);
+    };
+}
+
+/**
+ * Keep the results of `to_json`, `to_columns`, `to_arrow` and the view's
+ * dimensions on the client, so that reading a window again, e.g. when a grid
+ * re-renders, does not send a request to the server. The cache is dropped
+ * whenever the server pushes an update of the view, or a table of this client
+ * is updated, so that only windows read since are fetched. Cached results are
+ * shared by every caller, and must not be modified.
+ *
+ * @param {boolean} enabled
+ */
+view.prototype.set_cache_enabled = function(enabled) {
+    const caches = this._worker._view_caches;
+    if (enabled && !caches.has(this._name)) {
+        caches.set(this._name, new Map());
+        // The server only pushes updates of views with a listener.
+        this._cache_listener = () => {};
+        this.on_update(this._cache_listener);
+    } else if (!enabled && caches.has(this._name)) {
+        caches.delete(this._name);
+        this.remove_update(this._cache_listener);
+        this._cache_listener = undefined;
+    }
+};
+
 // Send view methods that do not create new objects (getters, setters etc.) to
 // the queue for processing.
 
 view.prototype.get_config = async_queue("get_config");
 
-view.prototype.to_json = async_queue("to_json");
+view.prototype.to_json = cached_queue("to_json");
 
-view.prototype.to_arrow = async_queue("to_arrow");
+view.prototype.to_arrow = cached_queue("to_arrow");
 
-view.prototype.to_columns = async_queue("to_columns");
+view.prototype.open_cursor = async_queue("open_cursor");
+
+view.prototype.cursor_to_arrow = async_queue("cursor_to_arrow");
+
+view.prototype.close_cursor = async_queue("close_cursor");
+
+view.prototype.set_update_interval = async_queue("set_update_interval");
+
+view.prototype.get_update_interval = async_queue("get_update_interval");
+
+view.prototype.to_columns = cached_queue("to_columns");
 
 view.prototype.to_csv = async_queue("to_csv");
 
-view.prototype.schema = async_queue("schema");
+view.prototype.schema = cached_queue("schema");
 
 view.prototype.computed_schema = async_queue("computed_schema");
 
-view.prototype.column_paths = async_queue("column_paths");
+view.prototype.column_paths = cached_queue("column_paths");
+
+view.prototype.num_columns = cached_queue("num_columns");
+
+view.prototype.num_rows = cached_queue("num_rows");
+
+view.prototype.get_memory_usage = async_queue("get_memory_usage");
+
+view.prototype.explain = async_queue("explain");
+
+view.prototype.get_latency_stats = async_queue("get_latency_stats");
+
+view.prototype.reset_latency_stats = async_queue("reset_latency_stats");
+
+view.prototype.set_depth = invalidating_queue("set_depth");
+
+view.prototype.set_viewport = async_queue("set_viewport");
+
+view.prototype.clear_viewport = async_queue("clear_viewport");
+
+view.prototype.set_priority = async_queue("set_priority");
+
+view.prototype.get_priority = async_queue("get_priority");
 
-view.prototype.num_columns = async_queue("num_columns");
+view.prototype.get_progress = async_queue("get_progress");
 
-view.prototype.num_rows = async_queue("num_rows");
+view.prototype.row_count_changed = async_queue("row_count_changed");
 
-view.prototype.set_depth = async_queue("set_depth");
+view.prototype.histogram = async_queue("histogram");
 
 view.prototype.get_row_expanded = async_queue("get_row_expanded");
 
-view.prototype.expand = async_queue("expand");
+view.prototype.expand = invalidating_queue("expand");
 
-view.prototype.collapse = async_queue("collapse");
+view.prototype.collapse = invalidating_queue("collapse");
 
-view.prototype.delete = async_queue("delete");
+view.prototype.delete = function() {
+    if (this._worker._view_caches) {
+        this._worker._view_caches.delete(this._name);
+    }
+    return async_queue("delete").apply(this, arguments);
+};
 
 view.prototype.col_to_js_typed_array = async_queue("col_to_js_typed_array");
 
@@ -0,0 +1,292 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2017, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+/**
+ * The binary protocol a client may negotiate with a Python
+ * `PerspectiveManager` in place of JSON messages, which is the subset of
+ * MessagePack (https://msgpack.org) that JSON values and binaries need: nil,
+ * booleans, numbers, strings, binaries, arrays and maps. A message's binary
+ * payload, e.g. an Arrow, is a field of the message itself, as an
+ * `ArrayBuffer`.
+ */
+
+const UTF8_ENCODER = new TextEncoder();
+const UTF8_DECODER = new TextDecoder();
+
+class Writer {
+    constructor() {
+        this.buffer = new ArrayBuffer(256);
+        this.view = new DataView(this.buffer);
+        this.bytes = new Uint8Array(this.buffer);
+        this.length = 0;
+    }
+
+    reserve(n) {
+        if (this.length + n <= this.buffer.byteLength) {
+            return;
+        }
+        let size = this.buffer.byteLength * 2;
+        while (size < this.length + n) {
+            size *= 2;
+        }
+        const bytes = new Uint8Array(size);
+        bytes.set(this.bytes.subarray(0, this.length));
+        this.buffer = bytes.buffer;
+        this.view = new DataView(this.buffer);
+        this.bytes = bytes;
+    }
+
+    tag(tag) {
+        this.reserve(1);
+        this.view.setUint8(this.length++, tag);
+    }
+
+    tag_length(length, [tag8, tag16, tag32]) {
+        if (tag8 !== undefined && length < 0x100) {
+            this.reserve(2);
+            this.view.setUint8(this.length, tag8);
+            this.view.setUint8(this.length + 1, length);
+            this.length += 2;
+        } else if (length < 0x10000) {
+            this.reserve(3);
+            this.view.setUint8(this.length, tag16);
+            this.view.setUint16(this.length + 1, length);
+            this.length += 3;
+        } else {
+            this.reserve(5);
+            this.view.setUint8(this.length, tag32);
+            this.view.setUint32(this.length + 1, length);
+            this.length += 5;
+        }
+    }
+
+    raw(bytes) {
+        this.reserve(bytes.length);
+        this.bytes.set(bytes, this.length);
+        this.length += bytes.length;
+    }
+
+    number(value) {
+        if (Number.isInteger(value) && value >= -0x80000000 && value < 0x100000000) {
+            if (value >= 0 && value < 0x80) {
+                this.tag(value);
+            } else if (value >= -0x20 && value < 0) {
+                this.tag(value & 0xff);
+            } else if (value < 0 || value < 0x80000000) {
+                this.reserve(5);
+                this.view.setUint8(this.length, 0xd2);
+                this.view.setInt32(this.length + 1, value);
+                this.length += 5;
+            } else {
+                this.reserve(5);
+                this.view.setUint8(this.length, 0xce);
+                this.view.setUint32(this.length + 1, value);
+                this.length += 5;
+            }
+        } else if (Number.isSafeInteger(value)) {
+            const high = Math.floor(value / 0x100000000);
+            this.reserve(9);
+            this.view.setUint8(this.length, 0xd3);
+            this.view.setInt32(this.length + 1, high);
+            this.view.setUint32(this.length + 5, value - high * 0x100000000);
+            this.length += 9;
+        } else {
+            this.reserve(9);
+            this.view.setUint8(this.length, 0xcb);
+            this.view.setFloat64(this.length + 1, value);
+            this.length += 9;
+        }
+    }
+
+    value(value) {
+        if (value === null || value === undefined) {
+            this.tag(0xc0);
+        } else if (value === true) {
+            this.tag(0xc3);
+        } else if (value === false) {
+            this.tag(0xc2);
+        } else if (typeof value === "number") {
+            this.number(value);
+        } else if (typeof value === "string") {
+            const encoded = UTF8_ENCODER.encode(value);
+            if (encoded.length < 0x20) {
+                this.tag(0xa0 | encoded.length);
+            } else {
+                this.tag_length(encoded.length, [0xd9, 0xda, 0xdb]);
+            }
+            this.raw(encoded);
+        } else if (value instanceof ArrayBuffer || ArrayBuffer.isView(value)) {
+            const bytes = value instanceof ArrayBuffer ? new Uint8Array(value) : new Uint8Array(value.buffer, value.byteOffset, value.byteLength);
+            this.tag_length(bytes.length, [0xc4, 0xc5, 0xc6]);
+            this.raw(bytes);
+        } else if (Array.isArray(value)) {
+            if (value.length < 0x10) {
+                this.tag(0x90 | value.length);
+            } else {
+                this.tag_length(value.length, [undefined, 0xdc, 0xdd]);
+            }
+            for (const item of value) {
+                this.value(item);
+            }
+        } else if (typeof value.toJSON === "function") {
+            this.value(value.toJSON());
+        } else {
+            // As `JSON.stringify` does, keys of undefined values are omitted.
+            const keys = Object.keys(value).filter(key => value[key] !== undefined && typeof value[key] !== "function");
+            if (keys.length < 0x10) {
+                this.tag(0x80 | keys.length);
+            } else {
+                this.tag_length(keys.length, [undefined, 0xde, 0xdf]);
+            }
+            for (const key of keys) {
+                this.value(key);
+                this.value(value[key]);
+            }
+        }
+    }
+}
+
+/**
+ * Encode a JSON-serializable value, which may contain `ArrayBuffer`s and
+ * typed arrays, as a binary message.
+ *
+ * @param {*} value
+ * @returns {ArrayBuffer}
+ */
+export function encode(value) {
+    const writer = new Writer();
+    writer.value(value);
+    return writer.buffer.slice(0, writer.length);
+}
+
+class Reader {
+    constructor(buffer) {
+        this.view = new DataView(buffer);
+        this.buffer = buffer;
+        this.pos = 0;
+    }
+
+    take(size) {
+        if (this.pos + size > this.buffer.byteLength) {
+            throw new Error("Binary message is truncated");
+        }
+        const pos = this.pos;
+        this.pos += size;
+        return pos;
+    }
+
+    string(length) {
+        const pos = this.take(length);
+        return UTF8_DECODER.decode(new Uint8Array(this.buffer, pos, length));
+    }
+
+    binary(length) {
+        const pos = this.take(length);
+        return this.buffer.slice(pos, pos + length);
+    }
+
+    array(length) {
+        const rval = new Array(length);
+        for (let i = 0; i < length; i++) {
+            rval[i] = this.value();
+        }
+        return rval;
+    }
+
+    map(length) {
+        const rval = {};
+        for (let i = 0; i < length; i++) {
+            const key = this.value();
+            rval[key] = this.value();
+        }
+        return rval;
+    }
+
+    int64(signed) {
+        const pos = this.take(8);
+        const high = signed ? this.view.getInt32(pos) : this.view.getUint32(pos);
+        return high * 0x100000000 + this.view.getUint32(pos + 4);
+    }
+
+    value() {
+        const tag = this.view.getUint8(this.take(1));
+        if (tag < 0x80) {
+            return tag;
+        } else if (tag >= 0xe0) {
+            return tag - 0x100;
+        } else if (tag < 0x90) {
+            return this.map(tag & 0x0f);
+        } else if (tag < 0xa0) {
+            return this.array(tag & 0x0f);
+        } else if (tag < 0xc0) {
+            return this.string(tag & 0x1f);
+        }
+        switch (tag) {
+            case 0xc0:
+                return null;
+            case 0xc2:
+                return false;
+            case 0xc3:
+                return true;
+            case 0xc4:
+                return this.binary(this.view.getUint8(this.take(1)));
+            case 0xc5:
+                return this.binary(this.view.getUint16(this.take(2)));
+            case 0xc6:
+                return this.binary(this.view.getUint32(this.take(4)));
+            case 0xca:
+                return this.view.getFloat32(this.take(4));
+            case 0xcb:
+                return this.view.getFloat64(this.take(8));
+            case 0xcc:
+                return this.view.getUint8(this.take(1));
+            case 0xcd:
+                return this.view.getUint16(this.take(2));
+            case 0xce:
+                return this.view.getUint32(this.take(4));
+            case 0xcf:
+                return this.int64(false);
+            case 0xd0:
+                return this.view.getInt8(this.take(1));
+            case 0xd1:
+                return this.view.getInt16(this.take(2));
+            case 0xd2:
+                return this.view.getInt32(this.take(4));
+            case 0xd3:
+                return this.int64(true);
+            case 0xd9:
+                return this.string(this.view.getUint8(this.take(1)));
+            case 0xda:
+                return this.string(this.view.getUint16(this.take(2)));
+            case 0xdb:
+                return this.string(this.view.getUint32(this.take(4)));
+            case 0xdc:
+                return this.array(this.view.getUint16(this.take(2)));
+            case 0xdd:
+                return this.array(this.view.getUint32(this.take(4)));
+            case 0xde:
+                return this.map(this.view.getUint16(this.take(2)));
+            case 0xdf:
+                return this.map(this.view.getUint32(this.take(4)));
+            default:
+                throw new Error(`Unsupported tag ${tag} in binary message`);
+        }
+    }
+}
+
+/**
+ * Decode a binary message into the value it encodes, with binaries decoded
+ * as `ArrayBuffer`s.
+ *
+ * @param {ArrayBuffer} buffer
+ * @returns {*}
+ */
+export function decode(buffer) {
+    return new Reader(buffer).value();
+}
@@ -0,0 +1,55 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2017, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+const fs = require("fs");
+const path = require("path");
+
+/**
+ * Load the memory64 build of the engine if `PSP_WASM_MEMORY64` is set and it
+ * was built, the pthreads build if it was built (see `PSP_WASM_PTHREADS`)
+ * and `SharedArrayBuffer` is available, and otherwise the single-threaded
+ * build.
+ */
+function load_engine() {
+    if (process.env.PSP_WASM_MEMORY64) {
+        try {
+            const UMD_PATH = path.join(__dirname, "..", "umd");
+            return {
+                load_perspective: require("./psp.async.64.js").default,
+                buffer: fs.readFileSync(
+                    path.join(UMD_PATH, "psp.async.64.wasm")
+                ).buffer
+            };
+        } catch (e) {
+            // Not built with memory64
+        }
+    }
+
+    if (typeof SharedArrayBuffer !== "undefined") {
+        try {
+            const UMD_PATH = path.join(__dirname, "..", "umd");
+            return {
+                load_perspective: require("./psp.async.mt.js").default,
+                buffer: fs.readFileSync(
+                    path.join(UMD_PATH, "psp.async.mt.wasm")
+                ).buffer,
+                locateFile: file => path.join(UMD_PATH, file)
+            };
+        } catch (e) {
+            // Not built with pthreads
+        }
+    }
+
+    return {
+        load_perspective: require("./psp.async.js").default,
+        buffer: require("./psp.async.wasm.js").default
+    };
+}
+
+module.exports.load_engine = load_engine;
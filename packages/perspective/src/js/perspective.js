@@ -12,7 +12,7 @@ import {get_type_config} from "./config/index.js";
 import {DataAccessor} from "./data_accessor";
 import {DateParser} from "./data_accessor/date_parser.js";
 import {extract_vector, extract_map, fill_vector} from "./emscripten.js";
-import {bindall, get_column_type} from "./utils.js";
+import {bindall, get_column_type, apply_cell_diff} from "./utils.js";
 import {Server} from "./api/server.js";
 
 import formatters from "./view_formatters";
@@ -41,6 +41,12 @@ export default function(Module) {
     let accessor = new DataAccessor();
     const SIDES = ["zero", "one", "two"];
 
+    // In the order of `t_ctx_priority`.
+    const PRIORITIES = ["visible", "background", "paused"];
+
+    // The number of rows a progressive view reads from its table at a time.
+    const BUILD_CHUNK_ROWS = 65536;
+
     /***************************************************************************
      *
      * Private
@@ -139,11 +145,11 @@ export default function(Module) {
         this.view_config = view_config || new view_config();
 
         if (sides === 0) {
-            this._View = __MODULE__.make_view_zero(table._Table, name, defaults.COLUMN_SEPARATOR_STRING, this.view_config, this.date_parser);
+            this._View = __MODULE__.make_view_zero(table._Table, name, defaults.COLUMN_SEPARATOR_STRING, this.view_config, this.date_parser, !!this.config.progressive);
         } else if (sides === 1) {
-            this._View = __MODULE__.make_view_one(table._Table, name, defaults.COLUMN_SEPARATOR_STRING, this.view_config, this.date_parser);
+            this._View = __MODULE__.make_view_one(table._Table, name, defaults.COLUMN_SEPARATOR_STRING, this.view_config, this.date_parser, !!this.config.progressive);
         } else if (sides === 2) {
-            this._View = __MODULE__.make_view_two(table._Table, name, defaults.COLUMN_SEPARATOR_STRING, this.view_config, this.date_parser);
+            this._View = __MODULE__.make_view_two(table._Table, name, defaults.COLUMN_SEPARATOR_STRING, this.view_config, this.date_parser, !!this.config.progressive);
         }
 
         this.table = table;
@@ -153,7 +159,15 @@ export default function(Module) {
         this.name = name;
         this.overridden_types = overridden_types;
         this._delete_callbacks = [];
+        this._priority = PRIORITIES.indexOf("visible");
+        this._update_interval = 0;
+        this._notify_port_id = 0;
+        this._notify_timeout = undefined;
         bindall(this);
+
+        if (this.config.progressive) {
+            setTimeout(this._build);
+        }
     }
 
     /**
@@ -177,6 +191,7 @@ export default function(Module) {
      */
     view.prototype.delete = function() {
         _remove_process(this.table.get_id());
+        clearTimeout(this._notify_timeout);
         this._View.delete();
         this.ctx.delete();
 
@@ -223,6 +238,33 @@ export default function(Module) {
         return extracted;
     }
 
+    const extract_map = function(map) {
+        // handles deletion already - do not call delete() on the input map
+        // again
+        let extracted = {};
+        const keys = map.keys();
+        for (let i = 0; i < keys.size(); i++) {
+            const key = keys.get(i);
+            extracted[key] = map.get(key);
+        }
+        keys.delete();
+        map.delete();
+        return extracted;
+    };
+
+    // Nests the flat `"<histogram>.<stat>"` keys of a latency stats map by
+    // histogram.
+    const extract_latency_stats = function(map) {
+        const extracted = extract_map(map);
+        const stats = {};
+        for (const key of Object.keys(extracted)) {
+            const [histogram, stat] = key.split(".");
+            stats[histogram] = stats[histogram] || {};
+            stats[histogram][stat] = extracted[key];
+        }
+        return stats;
+    };
+
     const extract_vector_scalar = function(vector) {
         // handles deletion already - do not call delete() on the input vector
         // again
@@ -470,23 +512,16 @@ export default function(Module) {
             idx++;
         }
 
-        // use a specified data slice, if provided
-        let slice, data_slice;
-
+        // read the column straight from the view, unless a data slice is
+        // specified
         if (!options.data_slice) {
-            data_slice = this.get_data_slice(start_row, end_row, idx, idx + 1);
-            slice = data_slice.get_slice();
-        } else {
-            slice = options.data_slice.get_column_slice(idx);
+            return __MODULE__[`col_to_js_typed_array_${SIDES[num_sides]}`](this._View, start_row, end_row, idx);
         }
 
+        const slice = options.data_slice.get_column_slice(idx);
         const dtype = this._View.get_column_dtype(idx);
-
         const rst = format_function(slice, dtype, idx);
         slice.delete();
-        if (data_slice) {
-            data_slice.delete();
-        }
         return rst;
     };
 
@@ -650,6 +685,97 @@ export default function(Module) {
         }
     };
 
+    /**
+     * Serializes a view to the Apache Arrow data format in chunks of at most
+     * `options.chunk_size` rows, calling `callback` with each chunk as soon
+     * as it is serialized rather than building the whole range at once.
+     * Each chunk is an `ArrayBuffer` containing a complete Arrow IPC stream
+     * of a single record batch.
+     *
+     * @param {function} callback Called with the `ArrayBuffer` of each chunk,
+     * in row order.
+     *
+     * @param {Object} [options] An optional configuration object, which
+     * accepts the same range options as `to_arrow`.
+     *
+     * @param {number} options.chunk_size The maximum number of rows in each
+     * chunk, defaulting to 65536.
+     */
+    view.prototype.to_arrow_chunked = function(callback, options = {}) {
+        _call_process(this.table.get_id());
+        options = _parse_format_options.bind(this)(options);
+        const chunk_size = options.chunk_size || 65536;
+        const args = [this._View, options.start_row, options.end_row, options.start_col, options.end_col, chunk_size, callback];
+        const sides = this.sides();
+
+        if (sides === 0) {
+            __MODULE__.to_arrow_chunked_zero(...args);
+        } else if (sides === 1) {
+            __MODULE__.to_arrow_chunked_one(...args);
+        } else if (sides === 2) {
+            __MODULE__.to_arrow_chunked_two(...args);
+        }
+    };
+
+    /**
+     * Opens a cursor over this view's rows, which `cursor_to_arrow` pages
+     * through from the first row without resolving each page's offset from
+     * the start of the view.
+     *
+     * With `options.snapshot`, the default, a flat view's cursor reads the
+     * rows as they were when it was opened, however the view is updated
+     * after, and a pivoted view's cursor throws once the view is updated.
+     * Otherwise each page reads the view's rows as they are then.
+     *
+     * @param {Object} [options] An optional configuration object, which
+     * accepts `start_col`, `end_col` as `to_arrow` does, and `snapshot`.
+     *
+     * @returns {number} The id of the cursor, to pass to `close_cursor` once
+     * done.
+     */
+    view.prototype.open_cursor = function(options = {}) {
+        _call_process(this.table.get_id());
+        const snapshot = options.snapshot === undefined ? true : !!options.snapshot;
+        options = _parse_format_options.bind(this)(options);
+        return this._View.open_cursor(options.start_col, options.end_col, snapshot);
+    };
+
+    /**
+     * Serializes the next `page_size` rows of a cursor opened by
+     * `open_cursor` to the Apache Arrow data format, advancing the cursor.
+     *
+     * @param {number} cursor_id The id of the cursor.
+     *
+     * @param {number} [page_size] The maximum number of rows in the page,
+     * defaulting to 65536.
+     *
+     * @returns {ArrayBuffer} The page, or `undefined` once the cursor has
+     * passed the last row.
+     */
+    view.prototype.cursor_to_arrow = function(cursor_id, page_size = 65536) {
+        if (page_size <= 0) {
+            throw new Error("cursor_to_arrow page_size must be positive!");
+        }
+        const sides = this.sides();
+
+        if (sides === 0) {
+            return __MODULE__.cursor_to_arrow_zero(this._View, cursor_id, page_size);
+        } else if (sides === 1) {
+            return __MODULE__.cursor_to_arrow_one(this._View, cursor_id, page_size);
+        } else if (sides === 2) {
+            return __MODULE__.cursor_to_arrow_two(this._View, cursor_id, page_size);
+        }
+    };
+
+    /**
+     * Closes a cursor opened by `open_cursor`, releasing its snapshot.
+     *
+     * @param {number} cursor_id The id of the cursor.
+     */
+    view.prototype.close_cursor = function(cursor_id) {
+        this._View.close_cursor(cursor_id);
+    };
+
     /**
      * The number of aggregated rows in this {@link module:perspective~view}.
      * This is affected by the "row_pivots" configuration parameter supplied to
@@ -663,6 +789,71 @@ export default function(Module) {
         return this._View.num_rows();
     };
 
+    /**
+     * The number of bytes used by each component of this
+     * {@link module:perspective~view}, such as its traversal, tree and
+     * aggregates. Views which share a tree each report it.
+     *
+     * @async
+     *
+     * @returns {Promise<Object>} A map of component name to bytes.
+     */
+    view.prototype.get_memory_usage = function() {
+        return extract_map(this._View.get_memory_usage());
+    };
+
+    /**
+     * Describe how this {@link module:perspective~view} is computed, to find
+     * which part of its config makes it slow: each filter term with the
+     * number and fraction of the table's rows it passes, the nodes at each
+     * depth of each of its trees, how each aggregate is maintained on update
+     * (`"incremental"`, `"running"`, `"multiset"`, or `"leaf_scan"` for
+     * aggregates which reread every row under an updated node), its computed
+     * columns, and an `estimated_update_cost` of the operations each updated
+     * row costs.  Filter selectivity is measured over a copy of the table,
+     * so this is a diagnostic rather than something to call on every update.
+     *
+     * @async
+     *
+     * @returns {Promise<Object>} The explanation.
+     */
+    view.prototype.explain = function() {
+        return JSON.parse(this._View.explain());
+    };
+
+    /**
+     * Latency histograms of this {@link module:perspective~view}'s updates
+     * since they were last reset, for verifying tail latencies rather than
+     * averages: `notify`, how long updating the view took; `callback_wait`,
+     * from then until its `on_update` callbacks were called; and
+     * `end_to_end`, from the first `update()` of the table that the update
+     * included until the callbacks. Each has a `count`, and the `min_ns`,
+     * `max_ns`, `mean_ns`, `p50_ns`, `p90_ns`, `p99_ns` and `p999_ns`
+     * latencies in nanoseconds; percentiles are within 1/16th of the
+     * latency recorded.
+     *
+     * Views which share a tree with another view are updated with it, and
+     * record no `notify`.
+     *
+     * @async
+     *
+     * @returns {Promise<Object>} A map of histogram to a map of statistic to
+     * value.
+     */
+    view.prototype.get_latency_stats = function() {
+        return extract_latency_stats(this._View.get_latency_stats());
+    };
+
+    /**
+     * Clear the histograms of
+     * {@link module:perspective~view#get_latency_stats}.
+     *
+     * @async
+     */
+    view.prototype.reset_latency_stats = function() {
+        this._View.reset_latency_stats();
+    };
+
     /**
      * The number of aggregated columns in this {@link view}.  This is affected
      * by the "column_pivots" configuration parameter supplied to this
@@ -719,6 +910,193 @@ export default function(Module) {
         return this._View.set_depth(depth, this.config.row_pivots.length);
     };
 
+    /**
+     * Register the window of this {@link module:perspective~view} that is
+     * rendered, in the same coordinates as `to_json`. Row and cell deltas
+     * passed to `on_update` callbacks then only contain changes that
+     * intersect it.
+     *
+     * @param {Object} [viewport] An optional object with `start_row`,
+     * `end_row`, `start_col` and `end_col` properties; omitted ends cover
+     * every row or column.
+     */
+    view.prototype.set_viewport = function(viewport = {}) {
+        const {start_row = 0, end_row = 2147483647, start_col = 0, end_col = 2147483647} = viewport;
+        return this._View.set_viewport(start_row, end_row, start_col, end_col);
+    };
+
+    /**
+     * Report deltas over the whole {@link module:perspective~view} again.
+     */
+    view.prototype.clear_viewport = function() {
+        return this._View.clear_viewport();
+    };
+
+    /**
+     * Set the priority with which this {@link module:perspective~view} is
+     * updated. "visible" views are updated, and their `on_update` callbacks
+     * called, before "background" views. "paused" views are not updated
+     * until resumed with another priority, when their `on_update` callbacks
+     * are called once on port 0 for every update they missed.
+     *
+     * @param {string} priority One of "visible" (the default), "background"
+     * or "paused".
+     */
+    view.prototype.set_priority = function(priority) {
+        const idx = PRIORITIES.indexOf(priority);
+        if (idx === -1) {
+            throw new Error(`Invalid priority "${priority}" - valid priorities are "visible", "background" and "paused".`);
+        }
+
+        // Updates already sent are processed with the previous priority.
+        _call_process(this.table.get_id());
+        const refreshed = this._View.set_priority(__MODULE__.t_ctx_priority[`CTX_PRIORITY_${priority.toUpperCase()}`]);
+        this._priority = idx;
+        if (refreshed) {
+            this._call_callbacks();
+        }
+    };
+
+    /**
+     * The priority set by `set_priority`.
+     *
+     * @returns {string} One of "visible", "background" or "paused".
+     */
+    view.prototype.get_priority = function() {
+        return PRIORITIES[this._priority];
+    };
+
+    /**
+     * How much of a {@link module:perspective~view} created with
+     * `progressive: true` has been built.
+     *
+     * @returns {Promise<number>} The fraction of the rows of the table read
+     * into the view, which is 1 once it is built.
+     */
+    view.prototype.get_progress = function() {
+        return this._View.get_build_progress();
+    };
+
+    /**
+     * Read the next chunk of rows of the table into a progressive view, and
+     * call its `on_update` callbacks so that they render the aggregates read
+     * so far, yielding to the event loop between chunks.
+     *
+     * @private
+     */
+    view.prototype._build = function() {
+        if (this.table === undefined) {
+            return;
+        }
+
+        const done = this._View.build(BUILD_CHUNK_ROWS);
+        if (this._priority !== PRIORITIES.indexOf("paused")) {
+            this._call_callbacks();
+        }
+
+        if (!done) {
+            setTimeout(this._build);
+        }
+    };
+
+    /**
+     * Call the `on_update` callbacks of this view alone, as if it were
+     * updated on `port_id`, by default port 0.
+     *
+     * @private
+     */
+    view.prototype._call_callbacks = function(port_id = 0) {
+        const cache = {};
+        for (const e of this.callbacks) {
+            if (e.view === this) {
+                e.callback(port_id, cache);
+            }
+        }
+    };
+
+    /**
+     * Limits this view's `on_update` callbacks to firing at most once every
+     * `interval` milliseconds. The deltas of every update in between are
+     * coalesced by the engine, so that "row", "cell" and "diff" callbacks
+     * are passed every change since they last fired, and an update that
+     * arrives early fires the callbacks once the interval has passed.
+     *
+     * @param {number} interval The minimum number of milliseconds between
+     * notifications, or 0 for no limit.
+     */
+    view.prototype.set_update_interval = function(interval) {
+        if (!(interval >= 0)) {
+            throw new Error("Update interval must be non-negative.");
+        }
+        this._View.set_notify_interval(Math.round(interval * 1000));
+        this._update_interval = interval;
+    };
+
+    /**
+     * The interval set by `set_update_interval`, in milliseconds.
+     *
+     * @returns {number}
+     */
+    view.prototype.get_update_interval = function() {
+        return this._update_interval;
+    };
+
+    /**
+     * Notify the callbacks of a view with an update interval that it was
+     * updated on `port_id`, now if a notification is due, or else once it is.
+     *
+     * @private
+     */
+    view.prototype._notify = function(port_id) {
+        this._notify_port_id = port_id;
+        if (this._notify_timeout !== undefined) {
+            return;
+        }
+        const delay = this._View.get_notify_delay();
+        if (delay > 0) {
+            this._notify_timeout = setTimeout(() => {
+                this._notify_timeout = undefined;
+                this._View.set_notified();
+                this._call_callbacks(this._notify_port_id);
+            }, delay / 1000);
+        } else {
+            this._View.set_notified();
+            this._call_callbacks(port_id);
+        }
+    };
+
+    /**
+     * Whether the number of rows in this {@link module:perspective~view}
+     * changed in the last update, which is cheaper to check than a row delta.
+     *
+     * @returns {Promise<boolean>}
+     */
+    view.prototype.row_count_changed = function() {
+        return this._View.get_row_count_changed();
+    };
+
+    /**
+     * Bins the values of a numeric or datetime column of the underlying
+     * {@link module:perspective~table} that this
+     * {@link module:perspective~view} aggregates.
+     *
+     * @param {string} column The name of a column or computed column.
+     * @param {Object} [options] An optional configuration object.
+     * @param {number} [options.bins=10] The maximum number of bins.
+     * @param {boolean} [options.quantile=false] Whether bins hold an equal
+     * number of values rather than spanning an equal width.
+     * @param {number} [options.row=0] With `row-pivots`, only bin the values
+     * under this row of the pivot tree, which defaults to the total row.
+     *
+     * @returns {Promise<Array<Object>>} An object for each bin, with its
+     * inclusive `begin` and `end` and the `count` of values in it.
+     */
+    view.prototype.histogram = function(column, options = {}) {
+        const {bins = 10, quantile = false, row = 0} = options;
+        const nidx = SIDES[this.sides()];
+        return __MODULE__[`get_histogram_${nidx}`](this._View, column, bins, quantile, row);
+    };
+
     /**
      * Returns the data of all changed rows in JSON format, or for 1+ sided
      * contexts the entire dataset of the view.
@@ -762,6 +1140,29 @@ export default function(Module) {
         return __MODULE__[`get_row_delta_${nidx}`](this._View);
     };
 
+    /**
+     * Returns the cells changed by the last update, within the viewport set
+     * by `set_viewport`, grouped by column name. Do not call this function
+     * directly, instead use the {@link module:perspective~view}'s
+     * `on_update` method with `{mode: "diff"}`.
+     *
+     * @private
+     */
+    view.prototype._get_cell_diff = async function() {
+        const nidx = SIDES[this.sides()];
+        const diff = __MODULE__[`get_cell_diff_${nidx}`](this._View);
+        const names = this._column_names();
+        const offset = this.sides() > 0 ? 1 : 0;
+        const columns = {};
+        for (const {column, ranges, values} of diff.columns) {
+            const name = names[column - offset];
+            if (name !== undefined) {
+                columns[name] = {ranges, values};
+            }
+        }
+        return {rows_changed: diff.rows_changed, columns};
+    };
+
     /**
      * Register a callback with this {@link module:perspective~view}.  Whenever
      * the {@link module:perspective~view}'s underlying table emits an update,
@@ -775,13 +1176,20 @@ export default function(Module) {
      *     - "cell": `delta` is the new data for each updated cell, serialized
      *          to JSON format.
      *     - "row": `delta` is an Arrow of the updated rows.
+     *     - "diff": `delta` is the new value of each updated cell, as an
+     *          object with `rows_changed` and `columns`, which maps each
+     *          updated column's name to the `ranges` of rows updated, as
+     *          `[start, end, start, end, ...]`, and their new `values` in
+     *          order; see `perspective.apply_cell_diff`. When `rows_changed`
+     *          is true, rows were added, removed or reordered, and a cache
+     *          of the view must be fetched again instead.
      */
     view.prototype.on_update = function(callback, {mode = "none"} = {}) {
         _call_process(this.table.get_id());
-        if (["none", "cell", "row"].indexOf(mode) === -1) {
-            throw new Error(`Invalid update mode "${mode}" - valid modes are "none", "cell" and "row".`);
+        if (["none", "cell", "row", "diff"].indexOf(mode) === -1) {
+            throw new Error(`Invalid update mode "${mode}" - valid modes are "none", "cell", "row" and "diff".`);
         }
-        if (mode === "cell" || mode === "row") {
+        if (mode === "cell" || mode === "row" || mode === "diff") {
             // Enable deltas only if needed by callback
             if (!this._View._get_deltas_enabled()) {
                 this._View._set_deltas_enabled(true);
@@ -817,6 +1225,14 @@ export default function(Module) {
                             updated.delta = cache[port_id]["row_delta"];
                         }
                         break;
+                    case "diff":
+                        {
+                            if (cache[port_id]["cell_diff"] === undefined) {
+                                cache[port_id]["cell_diff"] = await this._get_cell_diff();
+                            }
+                            updated.delta = cache[port_id]["cell_diff"];
+                        }
+                        break;
                     default:
                         break;
                 }
@@ -992,6 +1408,8 @@ export default function(Module) {
         this.limit = limit;
         this.overridden_types = overridden_types;
         this._delete_callbacks = [];
+        this._update_stats_callbacks = [];
+        this._generated = {num_keys: 0, num_batches: 0};
         bindall(this);
     }
 
@@ -1015,11 +1433,32 @@ export default function(Module) {
         this._Table.remove_port();
     };
 
-    table.prototype._update_callback = function(port_id) {
+    table.prototype._update_callback = function(port_id, priority = 0) {
         let cache = {};
+        const limited = new Set();
         for (let e in this.callbacks) {
+            // Visible and background views are called back separately, each
+            // once its contexts are notified.
+            const view = this.callbacks[e].view;
+            if (view._priority !== priority) {
+                continue;
+            }
+            if (view._update_interval > 0) {
+                // notified once for all of its callbacks, when due
+                limited.add(view);
+                continue;
+            }
             this.callbacks[e].callback(port_id, cache);
         }
+
+        for (const view of limited) {
+            view._notify(port_id);
+        }
+
+        if (priority === PRIORITIES.indexOf("visible") && this._update_stats_callbacks.length > 0) {
+            const stats = this._get_update_stats();
+            this._update_stats_callbacks.forEach(callback => callback(stats));
+        }
     };
 
     /**
@@ -1097,6 +1536,113 @@ export default function(Module) {
         return this._Table.size();
     };
 
+    /**
+     * The number of bytes used by each component of this
+     * {@link module:perspective~table}: its columns, vocabularies, primary
+     * keys and port tables. The memory used by its views is reported by
+     * {@link module:perspective~view#get_memory_usage}.
+     *
+     * @async
+     *
+     * @returns {Promise<Object>} A map of component name to bytes.
+     */
+    table.prototype.get_memory_usage = function() {
+        _call_process(this._Table.get_id());
+        return extract_map(this._Table.get_memory_usage());
+    };
+
+    /**
+     * Latency histograms of the updates of this
+     * {@link module:perspective~table} since they were last reset:
+     * `send_wait`, from the first `update()` an update included until it was
+     * processed; `process`, how long processing took; `callback_wait`, from
+     * then until the first `on_update` callbacks were called; and
+     * `end_to_end`, from the first `update()` until those callbacks. Each has
+     * a `count`, and the `min_ns`, `max_ns`, `mean_ns`, `p50_ns`, `p90_ns`,
+     * `p99_ns` and `p999_ns` latencies in nanoseconds; percentiles are within
+     * 1/16th of the latency recorded.
+     *
+     * Unlike {@link module:perspective~table#get_update_stats}, pending
+     * updates are not processed first, which would shorten their wait.
+     *
+     * @async
+     *
+     * @returns {Promise<Object>} A map of histogram to a map of statistic to
+     * value.
+     */
+    table.prototype.get_latency_stats = function() {
+        return extract_latency_stats(this._Table.get_latency_stats());
+    };
+
+    /**
+     * Clear the histograms of
+     * {@link module:perspective~table#get_latency_stats}.
+     *
+     * @async
+     */
+    table.prototype.reset_latency_stats = function() {
+        this._Table.reset_latency_stats();
+    };
+
+    /**
+     * The statistics of the last update this {@link module:perspective~table}
+     * processed: `port_id`; `rows_in` and `rows_flattened`, the rows in the
+     * update before and after rows sharing an index were merged;
+     * `rows_added`, `rows_updated` and `rows_removed`; the nanoseconds spent
+     * in the update and each of its phases, `total_ns`, `flatten_ns`,
+     * `lookup_ns`, `process_columns_ns`, `computed_columns_ns`,
+     * `update_master_table_ns` and `notify_ns`; and `context_notify_ns`, the
+     * nanoseconds spent updating each view, by its internal name. Views set
+     * to the "background" priority are included once they are updated.
+     *
+     * @async
+     *
+     * @returns {Promise<Object>} The statistics, or an empty Object if no
+     * update has been processed.
+     */
+    table.prototype.get_update_stats = function() {
+        _call_process(this._Table.get_id());
+        return this._get_update_stats();
+    };
+
+    table.prototype._get_update_stats = function() {
+        const prefix = "context_notify_ns.";
+        const extracted = extract_map(this._Table.get_update_stats());
+        const stats = {context_notify_ns: {}};
+        for (const key of Object.keys(extracted)) {
+            if (key.startsWith(prefix)) {
+                stats.context_notify_ns[key.slice(prefix.length)] = extracted[key];
+            } else {
+                stats[key] = extracted[key];
+            }
+        }
+        return Object.keys(stats).length > 1 ? stats : {};
+    };
+
+    /**
+     * Register a callback invoked with the
+     * {@link module:perspective~table#get_update_stats} of each update, once
+     * its visible views have been updated.
+     *
+     * @param {function} callback A callback function invoked with the
+     * statistics Object.
+     */
+    table.prototype.on_update_stats = function(callback) {
+        this._update_stats_callbacks.push(callback);
+    };
+
+    /**
+     * Unregister a callback registered with
+     * {@link module:perspective~table#on_update_stats}.
+     *
+     * @param {function} callback The callback function to be removed.
+     */
+    table.prototype.remove_update_stats = function(callback) {
+        const initial_length = this._update_stats_callbacks.length;
+        filterInPlace(this._update_stats_callbacks, cb => cb !== callback);
+        console.assert(initial_length > this._update_stats_callbacks.length, `"callback" does not match a registered update stats callback`);
+    };
+
     /**
      * The schema of this {@link module:perspective~table}.  A schema is an
      * Object whose keys are the columns of this
@@ -1257,6 +1803,11 @@ export default function(Module) {
      * apply. A sort configuration is an array of 2 elements: A column name, and
      * a sort direction, which are: "none", "asc", "desc", "col asc", "col
      * desc", "asc abs", "desc abs", "col asc abs", "col desc abs".
+     * @param {boolean} [config.progressive] Return the view before it is
+     * built, and read the table into it a chunk of rows at a time between
+     * tasks of the event loop. Until it is built, it serves the aggregates of
+     * the rows read so far, reports its progress through `get_progress()`,
+     * and calls its `on_update` callbacks after each chunk.
      *
      * @example
      * var view = table.view({
@@ -1480,6 +2031,49 @@ export default function(Module) {
         }
     };
 
+    /**
+     * Insert, update and remove generated rows, for testing at scale without
+     * serializing the input. Rows are generated directly in the engine, with
+     * the schema of this {@link module:perspective~table}, and are keyed by
+     * integers written to its index: updates and removes pick from the keys
+     * inserted by earlier calls, so a {@link module:perspective~table} without
+     * an index can only be inserted into.
+     *
+     * Values are deterministic for a given `spec`, so calling `generate` with
+     * the same arguments on two new tables gives them the same rows.
+     *
+     * @param {Object} spec How to generate each column.
+     * @param {number} [spec.seed] The seed of every value.
+     * @param {number} [spec.rows] The number of rows that sorted columns, and
+     * columns with a distinct value per row, spread their values over.
+     * @param {Object} [spec.columns] An Object of column names to their
+     * `cardinality` (the number of distinct values, or 0 for a distinct value
+     * per row), `null_ratio`, `string_length` and `sortedness` (the fraction
+     * of rows whose value is in key order).
+     * @param {Object} options The number of rows to `insert`, `update` and
+     * `remove`, and the `port_id` to send them to.
+     *
+     * @example
+     * const tbl = perspective.table({id: "integer", x: "float", g: "string"}, {index: "id"});
+     * tbl.generate({columns: {g: {cardinality: 100, null_ratio: 0.1}}}, {insert: 1000000});
+     * tbl.generate({columns: {g: {cardinality: 100, null_ratio: 0.1}}}, {insert: 100, update: 1000, remove: 10});
+     */
+    table.prototype.generate = function(spec, options) {
+        options = options || {};
+        if (!__MODULE__.make_data_generator) {
+            throw new Error("`generate()` is not built into the lean WASM profile");
+        }
+        const generator = __MODULE__.make_data_generator(spec || {}, this._generated.num_keys, this._generated.num_batches);
+        try {
+            generator.generate(this._Table, options.insert || 0, options.update || 0, options.remove || 0, options.port_id || 0);
+            this._generated = {num_keys: generator.get_num_keys(), num_batches: generator.get_num_batches()};
+            this.initialized = true;
+            _set_process(this._Table.get_pool(), this._Table.get_id());
+        } finally {
+            generator.delete();
+        }
+    };
+
     /**
      * Return an Object containing computed function metadata. Keys are strings,
      * and each value is an Object containing the following metadata:
@@ -1553,6 +2147,112 @@ export default function(Module) {
 
         initialize_profile_thread,
 
+        apply_cell_diff,
+
+        /**
+         * Start or stop recording spans of engine work - processing updates,
+         * notifying each context, sorting, filtering and serializing - into
+         * a ring buffer per thread, which keeps the most recent spans.
+         *
+         * @param {boolean} enabled
+         */
+        set_tracing_enabled: function(enabled) {
+            __MODULE__.set_tracing_enabled(!!enabled);
+        },
+
+        /**
+         * The spans recorded since tracing was enabled, or last cleared, as a
+         * Chrome trace event object, which `chrome://tracing` and Perfetto
+         * open when saved as JSON.
+         *
+         * @returns {Object}
+         */
+        get_trace: function() {
+            return JSON.parse(__MODULE__.get_trace());
+        },
+
+        /**
+         * Drop the recorded spans.
+         */
+        clear_trace: function() {
+            __MODULE__.clear_trace();
+        },
+
+        /**
+         * Start or stop sampling which phase of engine work - processing
+         * updates, notifying each context type, sorting, filtering,
+         * computing columns and serializing - each engine thread is in,
+         * counting the samples of each phase. Sampling is cheap enough to
+         * leave on in production.
+         *
+         * @param {boolean} enabled
+         */
+        set_profiling_enabled: function(enabled) {
+            __MODULE__.set_profiling_enabled(!!enabled);
+        },
+
+        /**
+         * The samples counted since profiling was enabled, or last cleared:
+         * `ticks`, the number of times threads were sampled, `interval_us`,
+         * the microseconds between ticks, and `phases`, a map of span name,
+         * e.g. `gnode.process_table` or `ctx1.notify`, to the samples of
+         * threads in it. Threads outside every span are counted as `idle`.
+         *
+         * @returns {Object}
+         */
+        get_profile: function() {
+            return {
+                ticks: __MODULE__.get_profile_ticks(),
+                interval_us: __MODULE__.get_profile_interval_us(),
+                phases: extract_map(__MODULE__.get_profile())
+            };
+        },
+
+        /**
+         * Zero the profiling counters.
+         */
+        clear_profile: function() {
+            __MODULE__.clear_profile();
+        },
+
+        /**
+         * Start or stop counting the allocations of the engine's column
+         * storage, by what owns it: `master_table`, `input_port`,
+         * `transitional`, `aggregate`, `vocab` or `other`.
+         *
+         * @param {boolean} enabled
+         */
+        set_alloc_stats_enabled: function(enabled) {
+            __MODULE__.set_alloc_stats_enabled(!!enabled);
+        },
+
+        /**
+         * The allocation counters of each owner, counted while enabled since
+         * the last reset: the number of `init`, `reserve`, `extend`,
+         * `shrink`, `clone` and `free` operations, and `allocated_bytes`,
+         * `freed_bytes`, `live_bytes` and `high_water_bytes`.
+         *
+         * @returns {Object} A map of owner to a map of counter to value.
+         */
+        get_alloc_stats: function() {
+            const extracted = extract_map(__MODULE__.get_alloc_stats());
+            const stats = {};
+            for (const key of Object.keys(extracted)) {
+                const [owner, counter] = key.split(".");
+                stats[owner] = stats[owner] || {};
+                stats[owner][counter] = extracted[key];
+            }
+            return stats;
+        },
+
+        /**
+         * Zero the allocation counters, so that live bytes and high-water
+         * marks are measured from now.
+         */
+        reset_alloc_stats: function() {
+            __MODULE__.reset_alloc_stats();
+        },
+
         /**
          * A factory method for constructing {@link module:perspective~table}s.
          *
@@ -1573,7 +2273,10 @@ export default function(Module) {
          *     key/value pairs as name/columns respectively. When an Array is
          *     supplied, a table is constructed using this Array's objects as
          *     rows. When a string is supplied, the parameter as parsed as a
-         *     CSV.
+         *     CSV. An ArrayBuffer holds either Arrow, or the UTF-8 text of a
+         *     JSON array of rows, object of columns or newline-delimited rows,
+         *     which is parsed in WebAssembly and is much faster to load than
+         *     the equivalent Javascript objects.
          * @param {Object} [options] An optional options dictionary.
          * @param {string} options.index The name of the column in the resulting
          *     table to treat as an index. When updating this table, rows
@@ -1674,20 +2377,28 @@ export default function(Module) {
 
         /**
          * When initialized, replace Perspective's internal `__MODULE` variable
-         * with the WASM binary.
+         * with the WASM module.
          *
-         * @param {ArrayBuffer} buffer an ArrayBuffer or Buffer containing the
-         * Perspective WASM code
+         * @param {Object} msg the `init` message, with either the compiled
+         * `WebAssembly.Module` of the Perspective WASM code as `module`, which
+         * is instantiated without compiling it again, or an ArrayBuffer or
+         * Buffer containing the code as `buffer`.
          */
         init(msg) {
             if (typeof WebAssembly === "undefined") {
                 throw new Error("WebAssembly not supported");
             } else {
                 console.log("Loading wasm");
-                __MODULE__ = __MODULE__({
-                    wasmBinary: msg.buffer,
-                    wasmJSMethod: "native-wasm"
-                }).then(() => super.init(msg));
+                const options = {wasmJSMethod: "native-wasm"};
+                if (msg.module) {
+                    options.instantiateWasm = (imports, receive) => {
+                        WebAssembly.instantiate(msg.module, imports).then(instance => receive(instance, msg.module));
+                        return {};
+                    };
+                } else {
+                    options.wasmBinary = msg.buffer;
+                }
+                __MODULE__ = __MODULE__(options).then(() => super.init(msg));
             }
         }
     }
@@ -10,6 +10,9 @@
 const {Client} = require("./api/client.js");
 const {Server} = require("./api/server.js");
 const {WebSocketManager, WebSocketClient} = require("./websocket");
+const {WorkerPoolManager} = require("./worker_pool.js");
+const {apply_cell_diff} = require("./utils.js");
+const {load_engine} = require("./engine.node.js");
 
 const perspective = require("./perspective.js").default;
 
@@ -20,18 +23,18 @@ const process = require("process");
 
 const path = require("path");
 
-const load_perspective = require("./psp.async.js").default;
+const {load_perspective, buffer, locateFile} = load_engine();
 
 // eslint-disable-next-line no-undef
 
 const LOCAL_PATH = path.join(process.cwd(), "node_modules");
-const buffer = require("./psp.async.wasm.js").default;
 
 const SYNC_SERVER = new (class extends Server {
     init(msg) {
         load_perspective({
             wasmBinary: buffer,
-            wasmJSMethod: "native-wasm"
+            wasmJSMethod: "native-wasm",
+            locateFile
         }).then(core => {
             this.perspective = perspective(core);
             super.init(msg);
@@ -145,44 +148,96 @@ function perspective_assets(assets, host_psp) {
     };
 }
 
-class WebSocketServer extends WebSocketManager {
-    constructor({assets, host_psp, port, on_start} = {}) {
-        super();
-        port = typeof port === "undefined" ? 8080 : port;
-        assets = assets || ["./"];
-
-        // Serve Perspective files through HTTP
-        this._server = http.createServer(perspective_assets(assets, host_psp));
-
-        // Serve Worker API through WebSockets
-        this._wss = new WebSocket.Server({noServer: true, perMessageDeflate: true});
+/**
+ * Serve `assets` over HTTP on `port`, and the websocket API of a `Manager`,
+ * a `WebSocketManager` or a class extending it, constructed with the rest
+ * of the options.
+ */
+const serve = Manager =>
+    class extends Manager {
+        constructor({assets, host_psp, port, on_start, ...options} = {}) {
+            super(options);
+            port = typeof port === "undefined" ? 8080 : port;
+            assets = assets || ["./"];
+
+            // Serve Perspective files through HTTP
+            this._server = http.createServer(perspective_assets(assets, host_psp));
+
+            // Serve Worker API through WebSockets
+            this._wss = new WebSocket.Server({noServer: true, perMessageDeflate: true});
+
+            // When the server starts, define how to handle messages
+            this._wss.on("connection", ws => this.add_connection(ws));
+
+            this._server.on("upgrade", (request, socket, head) => {
+                console.log("200    *** websocket upgrade ***");
+                this._wss.handleUpgrade(request, socket, head, sock => this._wss.emit("connection", sock, request));
+            });
+
+            this._server.listen(port, () => {
+                console.log(`Listening on port ${this._server.address().port}`);
+                if (on_start) {
+                    on_start();
+                }
+            });
+        }
 
-        // When the server starts, define how to handle messages
-        this._wss.on("connection", ws => this.add_connection(ws));
+        close() {
+            this._server.close();
+            if (this.terminate) {
+                this.terminate();
+            }
+        }
+    };
 
-        this._server.on("upgrade", (request, socket, head) => {
-            console.log("200    *** websocket upgrade ***");
-            this._wss.handleUpgrade(request, socket, head, sock => this._wss.emit("connection", sock, request));
-        });
+const WebSocketServer = serve(WebSocketManager);
 
-        this._server.listen(port, () => {
-            console.log(`Listening on port ${this._server.address().port}`);
-            if (on_start) {
-                on_start();
-            }
-        });
-    }
+/**
+ * A `WebSocketServer` whose tables are distributed across a pool of
+ * `workers` worker threads, by default one per CPU; see
+ * `WorkerPoolManager`.  Its hosted tables are created with its `table()`.
+ */
+const WorkerPoolServer = serve(WorkerPoolManager);
 
-    close() {
-        this._server.close();
+/**
+ * Read a binary message from the `shared_memory` descriptor a Python
+ * `PerspectiveManager` on the same host sends in its place, from the
+ * manager's POSIX shared memory, or `undefined` if the manager overwrote it
+ * before it was read.
+ */
+const read_shared_memory = ({name, position, length, capacity}) => {
+    const fd = fs.openSync(path.join("/dev/shm", name), "r");
+    try {
+        const binary = Buffer.alloc(length);
+        fs.readSync(fd, binary, 0, length, 8 + (position % capacity));
+        const header = Buffer.alloc(8);
+        fs.readSync(fd, header, 0, 8, 0);
+        const head = Number(header.readBigUInt64LE(0));
+        if (head > position + capacity) {
+            return undefined;
+        }
+        return binary.buffer.slice(binary.byteOffset, binary.byteOffset + length);
+    } finally {
+        fs.closeSync(fd);
     }
-}
+};
 
-const websocket = url => {
-    return new WebSocketClient(new WebSocket(url));
+/**
+ * Create a client of a websocket server at `url`.  With `shared_memory`, a
+ * client on the same host as a Python `PerspectiveManager` created with
+ * `shared_memory_size` reads Arrows from the manager's shared memory rather
+ * than the socket.  With `protocol: "binary"`, the client asks a Python
+ * server for its binary protocol in place of JSON.
+ */
+const websocket = (url, {shared_memory = false, protocol = "json"} = {}) => {
+    const options = shared_memory ? {read_shared_memory, protocol} : {protocol};
+    return new WebSocketClient(new WebSocket(url), options);
 };
 
 module.exports.websocket = websocket;
 module.exports.perspective_assets = perspective_assets;
 module.exports.WebSocketServer = WebSocketServer;
 module.exports.WebSocketManager = WebSocketManager;
+module.exports.WorkerPoolServer = WorkerPoolServer;
+module.exports.WorkerPoolManager = WorkerPoolManager;
+module.exports.apply_cell_diff = apply_cell_diff;
@@ -0,0 +1,61 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+/**
+ * The entry point of a `worker_threads` worker of a `WorkerPoolManager`,
+ * which runs an engine of its own and processes the messages the manager
+ * routes to it.  Each message arrives as `{msg, client_id}` and each reply
+ * is posted as `{msg, transferable}`.
+ */
+
+const {parentPort} = require("worker_threads");
+const {Server} = require("./api/server.js");
+const {load_engine} = require("./engine.node.js");
+
+const perspective = require("./perspective.js").default;
+
+const {load_perspective, buffer, locateFile} = load_engine();
+
+const SERVER = new (class extends Server {
+    post(msg, transferable) {
+        parentPort.postMessage({msg, transferable}, transferable);
+    }
+})();
+
+function handle({msg, client_id}) {
+    if (msg.cmd === "clear_views") {
+        SERVER.clear_views(client_id);
+    } else {
+        SERVER.process(msg, client_id);
+    }
+}
+
+// Messages routed while the engine loads are processed once it has.
+let pending = [];
+
+parentPort.on("message", message => {
+    if (pending) {
+        pending.push(message);
+    } else {
+        handle(message);
+    }
+});
+
+load_perspective({
+    wasmBinary: buffer,
+    wasmJSMethod: "native-wasm",
+    locateFile
+}).then(core => {
+    SERVER.perspective = perspective(core);
+    const messages = pending;
+    pending = undefined;
+    for (const message of messages) {
+        handle(message);
+    }
+});
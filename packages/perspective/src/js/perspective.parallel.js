@@ -10,6 +10,7 @@
 import * as defaults from "./config/constants.js";
 import {get_config} from "./config";
 import {Client} from "./api/client.js";
+import {apply_cell_diff} from "./utils.js";
 const {WebSocketClient} = require("./websocket");
 
 import wasm_worker from "./perspective.wasm.js";
@@ -22,7 +23,7 @@ const INLINE_WARNING = `Perspective has been compiled in INLINE mode.  While Per
 https://perspective.finos.org/docs/md/installation.html#-an-important-note-about-hosting`;
 
 /**
- * Singleton WASM file download cache.
+ * Singleton WASM file download and compilation cache.
  */
 const override = new (class {
     _fetch(url) {
@@ -41,14 +42,36 @@ const override = new (class {
         return wasm_worker();
     }
 
-    async wasm() {
+    /**
+     * Returns the engine compiled to a `WebAssembly.Module`, which workers
+     * instantiate without compiling it again, or its binary where modules
+     * cannot be compiled here.  The module is compiled while it downloads
+     * where `WebAssembly.compileStreaming` is supported, which also lets the
+     * browser cache the compiled code with the response.
+     */
+    wasm() {
+        if (this._wasm === undefined) {
+            this._wasm = this._compile();
+        }
+        return this._wasm;
+    }
+
+    async _compile() {
         if (wasm instanceof ArrayBuffer) {
             console.warn(INLINE_WARNING);
-            this._wasm = wasm;
-        } else {
-            this._wasm = await this._fetch(wasm);
+            return typeof WebAssembly.compile === "function" ? WebAssembly.compile(wasm) : wasm;
         }
-        return this._wasm;
+
+        if (typeof WebAssembly.compileStreaming === "function" && typeof fetch === "function") {
+            try {
+                return await WebAssembly.compileStreaming(fetch(wasm));
+            } catch (e) {
+                // e.g. served without the `application/wasm` MIME type
+                console.warn("Streaming compilation failed, falling back to download", e);
+            }
+        }
+
+        return this._fetch(wasm);
     }
 })();
 
@@ -79,7 +102,13 @@ class WebWorkerClient extends Client {
         if (typeof WebAssembly === "undefined") {
             throw new Error("WebAssembly not supported. Support for ASM.JS has been removed as of 0.3.1.");
         } else {
-            [_worker, msg.buffer] = await Promise.all([override.worker(), override.wasm()]);
+            let engine;
+            [_worker, engine] = await Promise.all([override.worker(), override.wasm()]);
+            if (engine instanceof WebAssembly.Module) {
+                msg.module = engine;
+            } else {
+                msg.buffer = engine;
+            }
         }
         for (var key in this._worker) {
             _worker[key] = this._worker[key];
@@ -166,15 +195,18 @@ const mod = {
      * Create a new WebSocketClient instance. The `url` parameter is provided,
      * load the worker at `url` using a WebSocket. s
      * @param {*} url Defaults to `window.location.origin`
-     * @param {*} [config] An optional perspective config object override
+     * @param {Object} [options] `{protocol: "binary"}` asks a Python server
+     * for its binary protocol in place of JSON.
      */
-    websocket(url = window.location.origin.replace("http", "ws")) {
-        return new WebSocketClient(new WebSocket(url));
+    websocket(url = window.location.origin.replace("http", "ws"), {protocol = "json"} = {}) {
+        return new WebSocketClient(new WebSocket(url), {protocol});
     },
 
     shared_worker(config) {
         return WORKER_SINGLETON.getInstance(config);
-    }
+    },
+
+    apply_cell_diff
 };
 
 for (let prop of Object.keys(defaults)) {
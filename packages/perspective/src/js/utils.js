@@ -164,3 +164,33 @@ if (!Array.prototype.includes) {
         }
     });
 }
+
+/**
+ * Apply a cell diff, as delivered to an `on_update` callback registered with
+ * `{mode: "diff"}`, to a cache of a view's columns in the form returned by
+ * `view.to_columns()`.
+ *
+ * Returns
+ * -------
+ * False if the diff could not be applied because rows were added, removed or
+ * reordered, in which case the cache must be fetched again; true otherwise.
+ */
+export function apply_cell_diff(columns, diff) {
+    if (diff.rows_changed) {
+        return false;
+    }
+    for (const name of Object.keys(diff.columns)) {
+        const column = columns[name];
+        if (column === undefined) {
+            continue;
+        }
+        const {ranges, values} = diff.columns[name];
+        let vidx = 0;
+        for (let ridx = 0; ridx < ranges.length; ridx += 2) {
+            for (let row = ranges[ridx]; row < ranges[ridx + 1]; ++row) {
+                column[row] = values[vidx++];
+            }
+        }
+    }
+    return true;
+}
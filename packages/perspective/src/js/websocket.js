@@ -1,16 +1,79 @@
 import {Client} from "./api/client.js";
 import {Server} from "./api/server.js";
+import {encode, decode} from "./binary_protocol.js";
 
 const HEARTBEAT_TIMEOUT = 15000;
 let CLIENT_ID_GEN = 0;
 
+/**
+ * Replace the `ArrayBuffer` results of a batch with `{binary: [offset,
+ * length]}` entries into one `ArrayBuffer` of them all, which is sent after
+ * the JSON message.
+ *
+ * @private
+ */
+function pack_batch(results) {
+    const buffers = [];
+    let length = 0;
+    const entries = results.map(result => {
+        if (!(result.data instanceof ArrayBuffer)) {
+            return result;
+        }
+        buffers.push(result.data);
+        length += result.data.byteLength;
+        return {binary: [length - result.data.byteLength, result.data.byteLength]};
+    });
+    if (buffers.length === 0) {
+        return {entries};
+    }
+    const binary = new Uint8Array(length);
+    let offset = 0;
+    for (const buffer of buffers) {
+        binary.set(new Uint8Array(buffer), offset);
+        offset += buffer.byteLength;
+    }
+    return {entries, binary: binary.buffer};
+}
+
+/**
+ * The inverse of `pack_batch`.
+ *
+ * @private
+ */
+function unpack_batch(entries, binary) {
+    return entries.map(entry => (entry.binary ? {data: binary.slice(entry.binary[0], entry.binary[0] + entry.binary[1])} : entry));
+}
+
 export class WebSocketClient extends Client {
-    constructor(ws) {
+    /**
+     * @param {WebSocket} ws
+     * @param {Object} [options]
+     * @param {Function} [options.read_shared_memory] For a client on the same
+     *     host as a Python server, a function that reads a binary message
+     *     from the `shared_memory` descriptor the server sends in its place,
+     *     returning an `ArrayBuffer`, or `undefined` if it was overwritten
+     *     before it was read. If set, the client asks the server for the
+     *     shared memory transport.
+     * @param {string} [options.protocol] "binary" to ask a Python server
+     *     for its binary protocol, which the client switches to if the
+     *     server agrees, or "json", the default.
+     */
+    constructor(ws, {read_shared_memory, protocol = "json"} = {}) {
         super();
         this._ws = ws;
         this._ws.binaryType = "arraybuffer";
+        this._read_shared_memory = read_shared_memory;
+        this._binary = false;
         this._ws.onopen = () => {
-            this.send({id: -1, cmd: "init"});
+            // A Python server may coalesce messages into one frame.
+            const init = {id: -1, cmd: "init", coalesce: true};
+            if (read_shared_memory) {
+                init.shared_memory = true;
+            }
+            if (protocol === "binary") {
+                init.protocol = ["binary"];
+            }
+            this.send(init);
         };
         const heartbeat = () => {
             this._ws.send("heartbeat");
@@ -21,7 +84,11 @@ export class WebSocketClient extends Client {
             if (msg.data === "heartbeat") {
                 return;
             }
-            if (this._pending_arrow) {
+            if (this._pending_batch) {
+                const pending = this._pending_batch;
+                delete this._pending_batch;
+                this._handle({data: {id: pending.id, data: unpack_batch(pending.data, msg.data)}});
+            } else if (this._pending_arrow) {
                 let result = {
                     data: {
                         id: this._pending_arrow,
@@ -41,30 +108,88 @@ export class WebSocketClient extends Client {
                 this._handle(result);
                 delete this._pending_port_id;
                 delete this._pending_arrow;
+            } else if (msg.data instanceof ArrayBuffer) {
+                // A message in the binary protocol carries its own binary,
+                // and a frame of several messages is an array of them.
+                msg = decode(msg.data);
+                for (const message of Array.isArray(msg) ? msg : [msg]) {
+                    this._on_binary_message(message);
+                }
             } else {
                 msg = JSON.parse(msg.data);
-
-                // If the `is_transferable` flag is set, the worker expects the
-                // next message to be a transferable object. This sets the
-                // `_pending_arrow` flag, which triggers a special handler for
-                // the ArrayBuffer containing arrow data.
-                if (msg.is_transferable) {
-                    this._pending_arrow = msg.id;
-
-                    // Check whether the message also contains a `port_id`,
-                    // indicating that we are in an `on_update` callback and
-                    // the pending arrow needs to be joined with the port_id
-                    // for on_update handlers to work properly.
-                    if (msg.data && msg.data.port_id !== undefined) {
-                        this._pending_port_id = msg.data.port_id;
-                    }
-                } else {
-                    this._handle({data: msg});
+                for (const message of Array.isArray(msg) ? msg : [msg]) {
+                    this._on_json_message(message);
                 }
             }
         };
     }
 
+    /**
+     * Handle a decoded message of the binary protocol.
+     *
+     * @private
+     */
+    _on_binary_message(msg) {
+        if (msg.shared_memory && this._read_shared_memory) {
+            this._handle({data: this._read_shared_memory_message(msg)});
+        } else {
+            this._handle({data: msg});
+        }
+    }
+
+    /**
+     * Handle a parsed JSON message.
+     *
+     * @private
+     */
+    _on_json_message(msg) {
+        // The server answers `init` in JSON, and sends every later
+        // message in the protocol it agreed to.
+        if (msg.id === -1 && msg.data && msg.data.protocol === "binary") {
+            this._binary = true;
+        }
+
+        // If the `is_transferable` flag is set, the worker expects the
+        // next message to be a transferable object. This sets the
+        // `_pending_arrow` flag, which triggers a special handler for
+        // the ArrayBuffer containing arrow data.
+        if (msg.is_transferable && msg.batch) {
+            // The binary results of a batch follow in one binary.
+            this._pending_batch = msg;
+        } else if (msg.is_transferable) {
+            this._pending_arrow = msg.id;
+
+            // Check whether the message also contains a `port_id`,
+            // indicating that we are in an `on_update` callback and
+            // the pending arrow needs to be joined with the port_id
+            // for on_update handlers to work properly.
+            if (msg.data && msg.data.port_id !== undefined) {
+                this._pending_port_id = msg.data.port_id;
+            }
+        } else if (msg.shared_memory && this._read_shared_memory) {
+            this._handle({data: this._read_shared_memory_message(msg)});
+        } else {
+            this._handle({data: msg});
+        }
+    }
+
+    /**
+     * Replace the `shared_memory` descriptor of a message with the binary it
+     * describes, as it would have been sent over the socket.
+     *
+     * @private
+     */
+    _read_shared_memory_message(msg) {
+        const binary = this._read_shared_memory(msg.shared_memory);
+        if (binary === undefined) {
+            return {id: msg.id, error: "Shared memory message was overwritten before it was read"};
+        }
+        if (msg.data && msg.data.port_id !== undefined) {
+            return {id: msg.id, data: {port_id: msg.data.port_id, delta: binary}};
+        }
+        return {id: msg.id, data: binary};
+    }
+
     /**
      * Send a message to the remote, checking whether the arguments contain an
      * ArrayBuffer.
@@ -74,9 +199,14 @@ export class WebSocketClient extends Client {
      * with the `is_transferable` flag set to true, and a second message
      * containing the ArrayBuffer. This allows for transport of metadata
      * alongside an ArrayBuffer, and the pattern should be implemented by the
-     * receiver.
+     * receiver. In the binary protocol, the message and its ArrayBuffer are
+     * sent together.
      */
     send(msg) {
+        if (this._binary) {
+            this._ws.send(encode(msg));
+            return;
+        }
         if (msg.args && msg.args.length > 0 && msg.args[0] instanceof ArrayBuffer && msg.args[0].byteLength !== undefined) {
             const pre_msg = msg;
             msg.is_transferable = true;
@@ -207,6 +337,14 @@ export class WebSocketManager extends Server {
             throw new Error("Connection closed");
         }
         msg.id = this.requests_id_map.get(id);
+        if (msg.batch) {
+            const {entries, binary} = pack_batch(msg.data);
+            msg.data = entries;
+            transferable = binary ? [binary] : undefined;
+            if (!transferable) {
+                delete msg.batch;
+            }
+        }
         if (transferable) {
             msg.is_transferable = true;
             req.ws.send(JSON.stringify(msg));
@@ -0,0 +1,412 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2019, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+const {Client} = require("./api/client.js");
+const {WebSocketManager} = require("./websocket");
+
+const os = require("os");
+const path = require("path");
+const {Worker} = require("worker_threads");
+
+const WORKER_PATH = path.join(__dirname, "perspective.node.worker.js");
+
+/**
+ * A `Client` of the engine of one worker of a `WorkerPoolManager`, through
+ * which the tables of the worker are created and updated on the main
+ * thread.
+ *
+ * @private
+ */
+class WorkerClient extends Client {
+    constructor(thread) {
+        super();
+        this._thread = thread;
+        this.send({id: -1, cmd: "init"});
+    }
+
+    send(msg) {
+        this._thread.postMessage({msg});
+    }
+
+    terminate() {
+        return this._thread.terminate();
+    }
+}
+
+/**
+ * Merge the Chrome trace event objects of each worker into one, with the
+ * events of each worker as a process of its own.
+ *
+ * @private
+ */
+function merge_traces(traces) {
+    const merged = {displayTimeUnit: "ns", traceEvents: []};
+    traces.forEach((trace, idx) => {
+        for (const event of trace.traceEvents || []) {
+            merged.traceEvents.push({...event, pid: idx});
+        }
+    });
+    return merged;
+}
+
+/**
+ * Sum the profiling samples of each worker, by phase.
+ *
+ * @private
+ */
+function merge_profiles(profiles) {
+    const merged = {ticks: 0, interval_us: 0, phases: {}};
+    for (const profile of profiles) {
+        merged.ticks += profile.ticks;
+        merged.interval_us = profile.interval_us;
+        for (const phase of Object.keys(profile.phases)) {
+            merged.phases[phase] = (merged.phases[phase] || 0) + profile.phases[phase];
+        }
+    }
+    return merged;
+}
+
+/**
+ * Sum the allocation counters of each worker, by owner.
+ *
+ * @private
+ */
+function merge_alloc_stats(stats) {
+    const merged = {};
+    for (const worker_stats of stats) {
+        for (const owner of Object.keys(worker_stats)) {
+            merged[owner] = merged[owner] || {};
+            for (const counter of Object.keys(worker_stats[owner])) {
+                merged[owner][counter] = (merged[owner][counter] || 0) + worker_stats[owner][counter];
+            }
+        }
+    }
+    return merged;
+}
+
+/**
+ * A `WebSocketManager` which distributes its tables across a pool of
+ * `worker_threads` workers, each with an engine of its own, so that the
+ * tables of one server are updated and queried on as many cores, and the
+ * main thread's event loop only routes messages.
+ *
+ * Every view lives on the worker of its table.  A table is placed on the
+ * worker hosting the fewest tables when it is created, by a remote client
+ * or with `table()`, and the messages of the `websocket.js` protocol are
+ * routed to it by the name of their table or view.  A `batch` of calls to
+ * tables of several workers is split between them, and its results are
+ * returned together.
+ *
+ * Tables hosted with `host_table()` must be created with the manager's
+ * `table()`, which returns a table of a worker to update on the main
+ * thread.
+ */
+class WorkerPoolManager extends WebSocketManager {
+    /**
+     * @param {Object} [options]
+     * @param {number} [options.workers] The number of workers, by default
+     *     one per CPU.
+     */
+    constructor({workers} = {}) {
+        super();
+        workers = typeof workers === "undefined" ? os.cpus().length : workers;
+        if (!(workers >= 1)) {
+            throw new Error("A worker pool needs at least one worker");
+        }
+
+        this._workers = [];
+        for (let idx = 0; idx < workers; idx++) {
+            const thread = new Worker(WORKER_PATH);
+            const entry = {thread, client: new WorkerClient(thread), num_tables: 0};
+            thread.on("message", message => this._on_worker_message(entry, message));
+            thread.on("error", console.error);
+            this._workers.push(entry);
+        }
+
+        // By hosted name, the worker of each table and view, and its name
+        // on the worker.
+        this._table_routes = {};
+        this._view_routes = {};
+
+        // By request id, the routes to drop once their `delete` succeeds.
+        this._deleting = new Map();
+
+        this._batch_id = 0;
+    }
+
+    /**
+     * The worker hosting the fewest tables.
+     *
+     * @private
+     */
+    _least_loaded() {
+        return this._workers.reduce((best, entry) => (entry.num_tables < best.num_tables ? entry : best));
+    }
+
+    /**
+     * Create a table on the worker hosting the fewest tables, which can be
+     * updated on the main thread and hosted with `host_table()`.
+     *
+     * @param {*} data
+     * @param {Object} [options]
+     * @returns {table}
+     */
+    table(data, options) {
+        const entry = this._least_loaded();
+        const table = entry.client.table(data, options);
+        entry.num_tables++;
+        table.on_delete(() => {
+            entry.num_tables--;
+        });
+        return table;
+    }
+
+    _host(routes, name, input) {
+        if (routes[name] !== undefined) {
+            throw new Error(`"${name}" already exists`);
+        }
+        const entry = this._workers.find(entry => entry.client === input._worker);
+        if (!entry) {
+            throw new Error(`"${name}" must be created with the worker pool's \`table()\``);
+        }
+        input.on_delete(() => {
+            if (routes[name] && routes[name].entry === entry) {
+                delete routes[name];
+            }
+        });
+        routes[name] = {entry, name: input._name};
+    }
+
+    host_table(name, table) {
+        this._host(this._table_routes, name, table);
+    }
+
+    host_view(name, view) {
+        this._host(this._view_routes, name, view);
+    }
+
+    eject_table(name) {
+        delete this._table_routes[name];
+    }
+
+    eject_view(name) {
+        delete this._view_routes[name];
+    }
+
+    /**
+     * Stop every worker, and with them their tables and views.
+     */
+    terminate() {
+        return Promise.all(this._workers.map(entry => entry.client.terminate()));
+    }
+
+    /**
+     * Delete the views of `client_id` from every worker.
+     */
+    clear_views(client_id) {
+        for (const name of Object.keys(this._view_routes)) {
+            if (this._view_routes[name].client_id === client_id) {
+                delete this._view_routes[name];
+            }
+        }
+        for (const entry of this._workers) {
+            entry.thread.postMessage({msg: {cmd: "clear_views"}, client_id});
+        }
+    }
+
+    /**
+     * Route a message of a remote client to the worker of its table or view.
+     */
+    process(msg, client_id) {
+        switch (msg.cmd) {
+            case "init":
+                super.process(msg, client_id);
+                break;
+            case "init_profile_thread":
+            case "set_tracing_enabled":
+            case "clear_trace":
+            case "set_profiling_enabled":
+            case "clear_profile":
+            case "set_alloc_stats_enabled":
+            case "reset_alloc_stats":
+                for (const entry of this._workers) {
+                    this._forward(entry, {...msg}, client_id);
+                }
+                break;
+            case "get_trace":
+                this._gather(msg, Promise.all(this._workers.map(entry => entry.client.get_trace())).then(merge_traces));
+                break;
+            case "get_profile":
+                this._gather(msg, Promise.all(this._workers.map(entry => entry.client.get_profile())).then(merge_profiles));
+                break;
+            case "get_alloc_stats":
+                this._gather(msg, Promise.all(this._workers.map(entry => entry.client.get_alloc_stats())).then(merge_alloc_stats));
+                break;
+            case "table":
+            case "table_generate": {
+                // A table created from another table's arrow is sent twice,
+                // and stays on the worker it was first sent to.
+                let route = this._table_routes[msg.name];
+                if (!route) {
+                    const entry = this._least_loaded();
+                    entry.num_tables++;
+                    route = this._table_routes[msg.name] = {entry, name: msg.name, remote: true};
+                }
+                this._forward(route.entry, {...msg, name: route.name}, client_id);
+                break;
+            }
+            case "table_method":
+            case "table_execute":
+                this._route(this._table_routes, "Table", msg, client_id);
+                break;
+            case "view": {
+                const route = this._table_routes[msg.table_name];
+                if (!route) {
+                    console.error(`Table "${msg.table_name}" is not hosted`);
+                    break;
+                }
+                this._view_routes[msg.view_name] = {entry: route.entry, name: msg.view_name, client_id};
+                this._forward(route.entry, {...msg, table_name: route.name}, client_id);
+                break;
+            }
+            case "view_method":
+                this._route(this._view_routes, "View", msg, client_id);
+                break;
+            case "batch":
+                this._process_batch(msg);
+                break;
+        }
+    }
+
+    /**
+     * Forward a table or view method call to the worker of its route.
+     *
+     * @private
+     */
+    _route(routes, type, msg, client_id) {
+        const route = routes[msg.name];
+        if (!route) {
+            this.process_error(msg, {message: `${type} is not initialized`});
+            return;
+        }
+        if (msg.method === "delete") {
+            // Tables of the manager's `table()` are counted off when deleted.
+            this._deleting.set(msg.id, {routes, name: msg.name, entry: route.remote ? route.entry : undefined});
+        }
+        this._forward(route.entry, {...msg, name: route.name}, client_id);
+    }
+
+    /**
+     * Post a message to a worker, transferring the arrow it was sent with.
+     *
+     * @private
+     */
+    _forward(entry, msg, client_id) {
+        const transferable = msg.args && msg.args[0] instanceof ArrayBuffer ? [msg.args[0]] : undefined;
+        entry.thread.postMessage({msg, client_id}, transferable);
+    }
+
+    /**
+     * Post the result of `promise`, gathered from the workers, in reply to
+     * `msg`.
+     *
+     * @private
+     */
+    _gather(msg, promise) {
+        promise.then(data => this.post({id: msg.id, data})).catch(error => this.process_error(msg, error));
+    }
+
+    /**
+     * Split the calls of a `batch` between the workers of their tables and
+     * views, and post their results in the order of the calls.
+     *
+     * @private
+     */
+    _process_batch(msg) {
+        const calls = msg.calls || [];
+        const results = new Array(calls.length);
+        const groups = new Map();
+        calls.forEach((call, idx) => {
+            const routes = call.cmd === "table_method" ? this._table_routes : call.cmd === "view_method" ? this._view_routes : undefined;
+            const route = routes && routes[call.name];
+            if (call.subscribe || !routes) {
+                results[idx] = {error: "Only table and view method calls can be batched"};
+            } else if (!route) {
+                results[idx] = {error: `${call.cmd === "table_method" ? "Table" : "View"} is not initialized`};
+            } else {
+                if (call.method === "delete" && call.cmd === "view_method") {
+                    delete routes[call.name];
+                }
+                if (!groups.has(route.entry)) {
+                    groups.set(route.entry, []);
+                }
+                groups.get(route.entry).push({idx, call: {...call, name: route.name}});
+            }
+        });
+
+        const batches = Array.from(groups.entries()).map(([entry, group]) => {
+            const id = `${msg.id}#${this._batch_id++}`;
+            return new Promise(resolve => {
+                entry.client._worker.handlers[id] = {
+                    resolve: data => {
+                        group.forEach(({idx}, jdx) => {
+                            results[idx] = data[jdx];
+                        });
+                        resolve();
+                    },
+                    reject: error => {
+                        for (const {idx} of group) {
+                            results[idx] = {error: error.message || `${error}`};
+                        }
+                        resolve();
+                    }
+                };
+                entry.thread.postMessage({msg: {id, cmd: "batch", calls: group.map(({call}) => call)}});
+            });
+        });
+
+        Promise.all(batches).then(() => {
+            const transferable = results.filter(result => result.data instanceof ArrayBuffer).map(result => result.data);
+            this.post({id: msg.id, batch: true, data: results}, transferable.length > 0 ? transferable : undefined);
+        });
+    }
+
+    /**
+     * Handle a reply of a worker: to its `WorkerClient` for requests of the
+     * main thread, which have numeric ids, or of a split `batch`, and to the
+     * websocket of the request otherwise.
+     *
+     * @private
+     */
+    _on_worker_message(entry, {msg, transferable}) {
+        if (typeof msg.id !== "string" || msg.id.indexOf("#") > -1) {
+            entry.client._handle({data: msg});
+            return;
+        }
+
+        const deleting = this._deleting.get(msg.id);
+        if (deleting) {
+            this._deleting.delete(msg.id);
+            if (!msg.error) {
+                delete deleting.routes[deleting.name];
+                if (deleting.entry) {
+                    deleting.entry.num_tables--;
+                }
+            }
+        }
+
+        try {
+            this.post(msg, transferable);
+        } catch (e) {
+            console.error(e);
+        }
+    }
+}
+
+module.exports.WorkerPoolManager = WorkerPoolManager;
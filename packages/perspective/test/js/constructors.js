@@ -9,6 +9,9 @@
 const papaparse = require("papaparse");
 const moment = require("moment");
 const arrows = require("./test_arrows.js");
+const {TextEncoder} = require("util");
+
+const to_json_buffer = text => new TextEncoder().encode(text).buffer;
 
 var data = [
     {x: 1, y: "a", z: true},
@@ -517,6 +520,21 @@ module.exports = perspective => {
             table.delete();
         });
 
+        it("Nulls, 0-sided view", async function() {
+            var table = perspective.table({int: [1, null, 3], float: [null, 2.5, null]});
+            var view = table.view();
+            const ints = await view.col_to_js_typed_array("int");
+            expect(Array.from(ints[0])).toEqual([1, 0, 3]);
+            expect(ints[1]).toEqual(1);
+            expect(ints[2][0]).toEqual(5);
+            const floats = await view.col_to_js_typed_array("float", {start_row: 1});
+            expect(Array.from(floats[0])).toEqual([2.5, 0]);
+            expect(floats[1]).toEqual(1);
+            expect(floats[2][0]).toEqual(1);
+            view.delete();
+            table.delete();
+        });
+
         it("Symmetric output with to_columns, 0-sided", async function() {
             let table = perspective.table(int_float_data);
             let view = table.view();
@@ -691,6 +709,44 @@ module.exports = perspective => {
             table.delete();
         });
 
+        it("JSON binary constructor", async function() {
+            var table = perspective.table(to_json_buffer(JSON.stringify(data)));
+            var view = table.view();
+            let result = await view.to_json();
+            expect(result).toEqual(data);
+            view.delete();
+            table.delete();
+        });
+
+        it("JSON binary column constructor", async function() {
+            var table = perspective.table(to_json_buffer(JSON.stringify({x: [1, 2, null], y: ["a", "b\n\"c\"", "\u00e9"]})));
+            var view = table.view();
+            let result = await view.to_columns();
+            expect(result).toEqual({x: [1, 2, null], y: ["a", 'b\n"c"', "é"]});
+            view.delete();
+            table.delete();
+        });
+
+        it("Newline-delimited JSON binary constructor", async function() {
+            var table = perspective.table(to_json_buffer('{"x": 1, "y": "a"}\n{"y": "b"}\n{"x": 3, "z": true}\n'));
+            var view = table.view();
+            let result = await view.to_columns();
+            expect(result).toEqual({x: [1, null, 3], y: ["a", "b", null], z: [null, null, true]});
+            view.delete();
+            table.delete();
+        });
+
+        it("Updates with a JSON binary", async function() {
+            var table = perspective.table(data, {index: "x"});
+            table.update(to_json_buffer(JSON.stringify([{x: 2, y: "z"}, {x: 5, y: "e", z: false}])));
+            var view = table.view();
+            let result = await view.to_columns();
+            expect(result.x).toEqual([1, 2, 3, 4, 5]);
+            expect(result.y).toEqual(["a", "z", "c", "d", "e"]);
+            view.delete();
+            table.delete();
+        });
+
         it("Meta constructor", async function() {
             var table = perspective.table(meta);
             var view = table.view();
@@ -79,6 +79,44 @@ module.exports = perspective => {
         });
     });
 
+    describe("Cell diff", function() {
+        it("returns ranges of the updated cells in 0-sided contexts", async function(done) {
+            let table = perspective.table(data, {index: "x"});
+            let view = table.view();
+            let cache = await view.to_columns();
+            view.on_update(
+                async function(updated) {
+                    expect(updated.delta.rows_changed).toEqual(false);
+                    expect(updated.delta.columns.y).toEqual({ranges: [0, 1, 3, 4], values: ["string1", "string2"]});
+                    expect(perspective.apply_cell_diff(cache, updated.delta)).toEqual(true);
+                    expect(cache).toEqual(await view.to_columns());
+                    view.delete();
+                    table.delete();
+                    done();
+                },
+                {mode: "diff"}
+            );
+            table.update(partial_change_nonseq);
+        });
+
+        it("reports added rows in 0-sided contexts", async function(done) {
+            let table = perspective.table(data, {index: "x"});
+            let view = table.view();
+            let cache = await view.to_columns();
+            view.on_update(
+                function(updated) {
+                    expect(updated.delta.rows_changed).toEqual(true);
+                    expect(perspective.apply_cell_diff(cache, updated.delta)).toEqual(false);
+                    view.delete();
+                    table.delete();
+                    done();
+                },
+                {mode: "diff"}
+            );
+            table.update([{x: 5, y: "e", z: true}]);
+        });
+    });
+
     describe("Row delta", function() {
         describe("0-sided row delta", function() {
             it("returns changed rows", async function(done) {
@@ -0,0 +1,109 @@
+/******************************************************************************
+ *
+ * Copyright (c) 2017, the Perspective Authors.
+ *
+ * This file is part of the Perspective library, distributed under the terms of
+ * the Apache License 2.0.  The full license can be found in the LICENSE file.
+ *
+ */
+
+const fs = require("fs");
+const path = require("path");
+const perspective = require("../../dist/cjs/perspective.js").default;
+const {load_engine} = require("../../dist/cjs/engine.node.js");
+
+const MEMORY64_WASM = path.join(__dirname, "..", "..", "dist", "umd", "psp.async.64.wasm");
+
+/**
+ * Round trip a table through Arrow and serve several views of it, which
+ * passes heap offsets and context pointers across embind.
+ */
+async function check_engine(core) {
+    const worker = perspective(core);
+    const tbl = worker.table({x: [1, 2, 3], y: ["a", "b", "c"]});
+    const arrow = await tbl.view().to_arrow();
+    const copy = worker.table(arrow);
+    expect(await copy.view().to_columns()).toEqual({x: [1, 2, 3], y: ["a", "b", "c"]});
+
+    const views = [];
+    for (let i = 0; i < 8; i++) {
+        views.push(tbl.view({row_pivots: ["y"], columns: ["x"]}));
+    }
+    views.shift().delete();
+    tbl.update({x: [4], y: ["a"]});
+    for (const view of views) {
+        expect((await view.to_columns()).x).toEqual([10, 5, 2, 3]);
+    }
+}
+
+function load(engine) {
+    return new Promise(resolve => {
+        engine
+            .load_perspective({
+                wasmBinary: engine.buffer,
+                wasmJSMethod: "native-wasm",
+                locateFile: engine.locateFile
+            })
+            .then(core => resolve({core}));
+    });
+}
+
+describe("engine.node.js", function() {
+    it("loads the single-threaded engine without SharedArrayBuffer", async () => {
+        const shared = global.SharedArrayBuffer;
+        const memory64 = process.env.PSP_WASM_MEMORY64;
+        let engine;
+        try {
+            delete global.SharedArrayBuffer;
+            delete process.env.PSP_WASM_MEMORY64;
+            engine = load_engine();
+        } finally {
+            global.SharedArrayBuffer = shared;
+            if (memory64 !== undefined) {
+                process.env.PSP_WASM_MEMORY64 = memory64;
+            }
+        }
+        expect(engine.locateFile).toBeUndefined();
+        const {core} = await load(engine);
+        expect(core.is_threaded()).toEqual(false);
+        const tbl = perspective(core).table({x: [1, 2, 3]});
+        expect(await tbl.size()).toEqual(3);
+    });
+
+    it("reports whether the engine it loads is threaded", async () => {
+        const engine = load_engine();
+        const {core} = await load(engine);
+        expect(core.is_threaded()).toEqual(engine.locateFile !== undefined);
+        const tbl = perspective(core).table({x: [1, 2, 3]});
+        const view = tbl.view({sort: [["x", "desc"]]});
+        expect(await view.to_columns()).toEqual({x: [3, 2, 1]});
+        view.delete();
+        tbl.delete();
+    });
+
+    it("loads the memory64 engine when PSP_WASM_MEMORY64 is set", async () => {
+        const memory64 = process.env.PSP_WASM_MEMORY64;
+        let engine;
+        try {
+            process.env.PSP_WASM_MEMORY64 = "1";
+            engine = load_engine();
+        } finally {
+            if (memory64 === undefined) {
+                delete process.env.PSP_WASM_MEMORY64;
+            } else {
+                process.env.PSP_WASM_MEMORY64 = memory64;
+            }
+        }
+        if (fs.existsSync(MEMORY64_WASM)) {
+            expect(engine.locateFile).toBeUndefined();
+            expect(engine.buffer.byteLength).toEqual(fs.statSync(MEMORY64_WASM).size);
+        }
+        const {core} = await load(engine);
+        await check_engine(core);
+    });
+
+    it("passes heap offsets and pointers from the default engine", async () => {
+        const {core} = await load(load_engine());
+        await check_engine(core);
+    });
+});
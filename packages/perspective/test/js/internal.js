@@ -46,5 +46,77 @@ module.exports = (perspective, mode) => {
             }
             table.delete();
         });
+
+        it("records engine spans while tracing is enabled", async function() {
+            if (perspective.sync_module) {
+                perspective = perspective.sync_module();
+            }
+            perspective.clear_trace();
+            perspective.set_tracing_enabled(true);
+            try {
+                const table = perspective.table([{x: 1}, {x: 2}]);
+                const view = table.view({row_pivots: ["x"]});
+                table.update([{x: 3}]);
+                await view.to_columns();
+                const names = perspective.get_trace().traceEvents.map(event => event.name);
+                expect(names).toContain("gnode.process");
+                expect(names).toContain("ctx.notify");
+                expect(names).toContain("view.get_data");
+                view.delete();
+                table.delete();
+            } finally {
+                perspective.set_tracing_enabled(false);
+                perspective.clear_trace();
+            }
+        });
+
+        it("samples engine phases while profiling", async function() {
+            if (perspective.sync_module) {
+                perspective = perspective.sync_module();
+            }
+            perspective.set_profiling_enabled(true);
+            perspective.clear_profile();
+            try {
+                const table = perspective.table([{x: 1}, {x: 2}]);
+                const view = table.view({row_pivots: ["x"]});
+                const start = Date.now();
+                while (perspective.get_profile().ticks === 0 && Date.now() - start < 5000) {
+                    table.update([{x: 3}]);
+                    await view.to_columns();
+                }
+                const profile = perspective.get_profile();
+                expect(profile.ticks).toBeGreaterThan(0);
+                expect(profile.interval_us).toBeGreaterThan(0);
+                expect(Object.keys(profile.phases).length).toBeGreaterThan(0);
+                view.delete();
+                table.delete();
+            } finally {
+                perspective.set_profiling_enabled(false);
+                perspective.clear_profile();
+            }
+        });
+
+        it("counts allocations by owner while enabled", async function() {
+            if (perspective.sync_module) {
+                perspective = perspective.sync_module();
+            }
+            perspective.set_alloc_stats_enabled(true);
+            perspective.reset_alloc_stats();
+            try {
+                const table = perspective.table([{x: 1, y: "a"}]);
+                const view = table.view({row_pivots: ["y"]});
+                table.update([{x: 2, y: "b"}]);
+                await view.to_columns();
+                const stats = perspective.get_alloc_stats();
+                expect(stats.master_table.init).toBeGreaterThan(0);
+                expect(stats.aggregate.init).toBeGreaterThan(0);
+                expect(stats.vocab.high_water_bytes).toBeGreaterThan(0);
+                view.delete();
+                table.delete();
+            } finally {
+                perspective.set_alloc_stats_enabled(false);
+                perspective.reset_alloc_stats();
+            }
+        });
     });
 };
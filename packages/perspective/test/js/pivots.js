@@ -753,6 +753,29 @@ module.exports = perspective => {
             view.delete();
             table.delete();
         });
+
+        it("['x', 'z'], pivot_depth = 1, sorted, after update", async function() {
+            var table = perspective.table(data);
+            var view = table.view({
+                row_pivots: ["x", "z"],
+                row_pivot_depth: 1,
+                sort: [["x", "desc"]],
+                aggregates: {y: "distinct count", z: "distinct count"}
+            });
+            table.update([{x: 5, y: "e", z: true}]);
+            var answer = [
+                {__ROW_PATH__: [], x: 15, y: 5, z: 2},
+                {__ROW_PATH__: [5], x: 5, y: 1, z: 1},
+                {__ROW_PATH__: [4], x: 4, y: 1, z: 1},
+                {__ROW_PATH__: [3], x: 3, y: 1, z: 1},
+                {__ROW_PATH__: [2], x: 2, y: 1, z: 1},
+                {__ROW_PATH__: [1], x: 1, y: 1, z: 1}
+            ];
+            let result2 = await view.to_json();
+            expect(result2).toEqual(answer);
+            view.delete();
+            table.delete();
+        });
     });
 
     describe("Column pivot", function() {
@@ -1158,4 +1181,56 @@ module.exports = perspective => {
             table.delete();
         });
     });
+
+    describe("Explain", function() {
+        it("reports filter selectivity, tree shape and aggregate strategies", async function() {
+            const table = perspective.table(data);
+            const view = table.view({
+                row_pivots: ["z"],
+                columns: ["x", "y"],
+                aggregates: {x: "median", y: "count"},
+                filter: [["x", ">", 1]]
+            });
+            const explain = await view.explain();
+            expect(explain.sides).toEqual(1);
+            expect(explain.table_rows).toEqual(4);
+            expect(explain.row_pivots).toEqual(["z"]);
+            expect(explain.filters.length).toEqual(1);
+            expect(explain.filters[0].column).toEqual("x");
+            expect(explain.filters[0].op).toEqual(">");
+            expect(explain.filters[0].matched_rows).toEqual(3);
+            expect(explain.filters[0].selectivity).toEqual(0.75);
+            expect(explain.filtered_rows).toEqual(3);
+            expect(explain.trees.length).toEqual(1);
+            expect(explain.trees[0].pivots).toEqual(["z"]);
+            expect(explain.trees[0].nodes_by_depth).toEqual([1, 2]);
+            const strategies = {};
+            for (const agg of explain.aggregates) {
+                strategies[agg.column] = agg.strategy;
+            }
+            expect(strategies.x).toEqual("multiset");
+            expect(strategies.y).toEqual("incremental");
+            expect(explain.estimated_update_cost.node_updates).toBeCloseTo(1.5);
+            view.delete();
+            table.delete();
+        });
+
+        it("reports computed columns and sort of a flat view", async function() {
+            const table = perspective.table(data);
+            const view = table.view({
+                computed_columns: [{column: "computed", computed_function_name: "+", inputs: ["x", "x"]}],
+                sort: [["x", "desc"]]
+            });
+            const explain = await view.explain();
+            expect(explain.sides).toEqual(0);
+            expect(explain.trees).toEqual([]);
+            expect(explain.filters).toEqual([]);
+            expect(explain.filtered_rows).toEqual(4);
+            expect(explain.sort).toEqual([{column: "x", order: "desc"}]);
+            expect(explain.computed_columns).toEqual([{column: "computed", function: "+", inputs: ["x", "x"]}]);
+            expect(explain.estimated_update_cost.sorted).toEqual(true);
+            view.delete();
+            table.delete();
+        });
+    });
 };
@@ -125,4 +125,149 @@ describe("WebSocketManager", function() {
         await client.terminate();
         server.eject_table("test");
     });
+
+    it("Batches method calls with their arraybuffers in one response", async () => {
+        const data = [{x: 1}, {x: 2}];
+        const table = perspective.table(data);
+        server.host_table("test", table);
+
+        const client = perspective.websocket(`ws://localhost:${port}`);
+        const client_table = client.open_table("test");
+        const client_view = client_table.view();
+
+        const [num_rows, arrow, error, schema, arrow2] = await client.batch([
+            [client_view, "num_rows"],
+            [client_view, "to_arrow"],
+            [client_view, "not_a_method"],
+            [client_table, "schema"],
+            [client_view, "to_arrow", {end_row: 1}]
+        ]);
+        expect(num_rows).toEqual(2);
+        expect(error).toBeInstanceOf(Error);
+        expect(schema).toEqual({x: "integer"});
+        expect(
+            await perspective
+                .table(arrow)
+                .view()
+                .to_json()
+        ).toEqual(data);
+        expect(
+            await perspective
+                .table(arrow2)
+                .view()
+                .to_json()
+        ).toEqual([{x: 1}]);
+
+        await client.terminate();
+        server.eject_table("test");
+    });
+
+    it("Reads cached data until the server pushes an update", done => {
+        const table = perspective.table([{x: 1}]);
+        server.host_table("test", table);
+
+        const client = perspective.websocket(`ws://localhost:${port}`);
+        const client_view = client.open_table("test").view();
+        client_view.set_cache_enabled(true);
+
+        client_view.on_update(async () => {
+            expect(await client_view.to_json()).toEqual([{x: 1}, {x: 2}]);
+            await client.terminate();
+            server.eject_table("test");
+            setTimeout(done);
+        });
+
+        Promise.all([client_view.to_json(), client_view.to_json()]).then(([first, second]) => {
+            expect(first).toEqual([{x: 1}]);
+            expect(second).toBe(first);
+            table.update([{x: 2}]);
+        });
+    });
+});
+
+describe("WorkerPoolServer", function() {
+    let pool;
+    let pool_port;
+
+    beforeAll(() => {
+        pool = new perspective.WorkerPoolServer({port: 0, workers: 2});
+        pool_port = pool._server.address().port;
+    });
+
+    afterAll(async () => {
+        pool.close();
+        await pool.terminate();
+    });
+
+    it("Places tables on the least loaded worker", async () => {
+        const first = pool.table([{x: 1}]);
+        const second = pool.table([{x: 2}]);
+        expect(first._worker).not.toBe(second._worker);
+        await first.delete();
+        await second.delete();
+    });
+
+    it("Routes views of hosted tables to their worker", async () => {
+        const east = pool.table([{x: 1}]);
+        const west = pool.table([{x: 2}, {x: 3}]);
+        pool.host_table("east", east);
+        pool.host_table("west", west);
+
+        const client = perspective.websocket(`ws://localhost:${pool_port}`);
+        const east_view = client.open_table("east").view();
+        const west_view = client.open_table("west").view();
+        expect(await east_view.to_json()).toEqual([{x: 1}]);
+        expect(await west_view.to_json()).toEqual([{x: 2}, {x: 3}]);
+
+        await east.update([{x: 4}]);
+        expect(await east_view.num_rows()).toEqual(2);
+
+        await client.terminate();
+        pool.eject_table("east");
+        pool.eject_table("west");
+    });
+
+    it("Splits batches across workers", async () => {
+        const east = pool.table([{x: 1}]);
+        const west = pool.table([{x: 2}, {x: 3}]);
+        pool.host_table("east", east);
+        pool.host_table("west", west);
+
+        const client = perspective.websocket(`ws://localhost:${pool_port}`);
+        const east_table = client.open_table("east");
+        const west_view = client.open_table("west").view();
+        const [east_size, west_rows, arrow, missing] = await client.batch([
+            [east_table, "size"],
+            [west_view, "num_rows"],
+            [west_view, "to_arrow"],
+            [client.open_table("missing"), "size"]
+        ]);
+        expect(east_size).toEqual(1);
+        expect(west_rows).toEqual(2);
+        expect(
+            await perspective
+                .table(arrow)
+                .view()
+                .to_json()
+        ).toEqual([{x: 2}, {x: 3}]);
+        expect(missing).toBeInstanceOf(Error);
+
+        await client.terminate();
+        pool.eject_table("east");
+        pool.eject_table("west");
+    });
+
+    it("Hosts tables created by remote clients", async () => {
+        const client = perspective.websocket(`ws://localhost:${pool_port}`);
+        const table = client.table([{x: 1}, {x: 2}]);
+        const view = table.view();
+        expect(await view.to_json()).toEqual([{x: 1}, {x: 2}]);
+        await view.delete();
+        await table.delete();
+        await client.terminate();
+    });
+
+    it("Rejects tables not created by the pool", () => {
+        expect(() => pool.host_table("test", perspective.table([{x: 1}]))).toThrow();
+    });
 });
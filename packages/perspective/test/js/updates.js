@@ -1176,6 +1176,284 @@ module.exports = perspective => {
         });
     });
 
+    describe("Priority", function() {
+        it("Defaults to visible", async function() {
+            const table = perspective.table(data);
+            const view = table.view();
+            expect(await view.get_priority()).toEqual("visible");
+            view.delete();
+            table.delete();
+        });
+
+        it("Calls back visible views before background views", function(done) {
+            const table = perspective.table(meta);
+            const background = table.view({row_pivots: ["y"]});
+            const visible = table.view();
+            const order = [];
+            background.set_priority("background");
+            background.on_update(() => order.push("background"));
+            visible.on_update(async () => {
+                order.push("visible");
+                if (order.length === 1) {
+                    setTimeout(async () => {
+                        expect(order).toEqual(["visible", "background"]);
+                        expect(await background.num_rows()).toEqual(5);
+                        background.delete();
+                        visible.delete();
+                        table.delete();
+                        done();
+                    }, 0);
+                }
+            });
+            table.update(data);
+        });
+
+        it("Batches the updates of a paused view until resumed", async function() {
+            const table = perspective.table(data, {index: "x"});
+            const view = table.view({row_pivots: ["y"], columns: ["x"]});
+            const cb = jest.fn();
+            view.on_update(cb);
+            view.set_priority("paused");
+            table.update([{x: 1, y: "b"}]);
+            table.update([{x: 5, y: "e"}]);
+            expect(await table.size()).toEqual(5);
+            expect(cb).toBeCalledTimes(0);
+            expect(await view.num_rows()).toEqual(5);
+            view.set_priority("visible");
+            expect(cb).toBeCalledTimes(1);
+            expect(await view.to_columns()).toEqual({
+                __ROW_PATH__: [[], ["b"], ["c"], ["d"], ["e"]],
+                x: [15, 3, 3, 4, 5]
+            });
+            view.delete();
+            table.delete();
+        });
+
+        it("Does not rebuild a view resumed without missed updates", async function() {
+            const table = perspective.table(data);
+            const view = table.view();
+            const cb = jest.fn();
+            view.on_update(cb);
+            view.set_priority("paused");
+            view.set_priority("background");
+            expect(cb).toBeCalledTimes(0);
+            expect(await view.to_json()).toEqual(data);
+            view.delete();
+            table.delete();
+        });
+
+        it("Rejects an invalid priority", async function() {
+            const table = perspective.table(data);
+            const view = table.view();
+            expect(() => view.set_priority("hidden")).toThrow();
+            view.delete();
+            table.delete();
+        });
+    });
+
+    describe("Update interval", function() {
+        it("Coalesces the row deltas of updates within the interval", function(done) {
+            const table = perspective.table(data, {index: "x"});
+            const view = table.view();
+            view.set_update_interval(50);
+            const deltas = [];
+            view.on_update(
+                async ({delta}) => {
+                    deltas.push(delta);
+                    if (deltas.length === 1) {
+                        table.update([{x: 2, y: "q"}]);
+                        table.update([{x: 5, y: "r"}]);
+                    } else {
+                        expect(deltas.length).toEqual(2);
+                        const rows = await perspective
+                            .table(delta)
+                            .view()
+                            .to_json();
+                        expect(rows.map(row => row.x)).toEqual([2, 5]);
+                        view.delete();
+                        table.delete();
+                        done();
+                    }
+                },
+                {mode: "row"}
+            );
+            table.update([{x: 1, y: "p"}]);
+        });
+
+        it("Rejects a negative interval", async function() {
+            const table = perspective.table(data);
+            const view = table.view();
+            expect(() => view.set_update_interval(-1)).toThrow();
+            view.delete();
+            table.delete();
+        });
+    });
+
+    describe("Progressive", function() {
+        function built(view) {
+            return new Promise(resolve => {
+                view.on_update(async () => {
+                    if ((await view.get_progress()) === 1) {
+                        resolve();
+                    }
+                });
+            });
+        }
+
+        it("Builds the same view as one built at once", async function() {
+            const table = perspective.table(data);
+            const view = table.view({row_pivots: ["y"], progressive: true});
+            await built(view);
+            const expected = table.view({row_pivots: ["y"]});
+            expect(await view.to_columns()).toEqual(await expected.to_columns());
+            expected.delete();
+            view.delete();
+            table.delete();
+        });
+
+        it("Is updated once built", async function() {
+            const table = perspective.table(data);
+            const view = table.view({row_pivots: ["z"], columns: ["x"], progressive: true});
+            await built(view);
+            table.update([{x: 5, y: "e", z: true}]);
+            expect(await view.to_columns()).toEqual({
+                __ROW_PATH__: [[], [false], [true]],
+                x: [15, 6, 9]
+            });
+            view.delete();
+            table.delete();
+        });
+    });
+
+    describe("Update stats", function() {
+        it("Counts the rows of the last update", async function() {
+            const table = perspective.table(data, {index: "x"});
+            expect((await table.get_update_stats()).rows_added).toEqual(4);
+            table.update([
+                {x: 1, y: "h", z: false},
+                {x: 5, y: "i", z: true}
+            ]);
+            table.remove([2]);
+            const stats = await table.get_update_stats();
+            expect(stats.rows_in).toEqual(3);
+            expect(stats.rows_added).toEqual(1);
+            expect(stats.rows_updated).toEqual(1);
+            expect(stats.rows_removed).toEqual(1);
+            expect(stats.total_ns).toBeGreaterThan(0);
+            table.delete();
+        });
+
+        it("Calls back with the stats of each update", async function() {
+            const table = perspective.table(data, {index: "x"});
+            const view = table.view();
+            const stats = await new Promise(resolve => {
+                table.on_update_stats(resolve);
+                table.update([
+                    {x: 1, y: "h", z: false},
+                    {x: 5, y: "i", z: true}
+                ]);
+            });
+            expect(stats.rows_added).toEqual(1);
+            expect(stats.rows_updated).toEqual(1);
+            expect(Object.keys(stats.context_notify_ns).length).toEqual(1);
+            view.delete();
+            table.delete();
+        });
+    });
+
+    describe("Latency stats", function() {
+        it("Records a histogram of each update's latencies", async function() {
+            const table = perspective.table(data, {index: "x"});
+            const view = table.view({row_pivots: ["y"]});
+            await table.reset_latency_stats();
+            for (let i = 0; i < 5; i++) {
+                await new Promise(resolve => {
+                    const callback = () => {
+                        view.remove_update(callback);
+                        resolve();
+                    };
+                    view.on_update(callback);
+                    table.update([{x: i, y: "h", z: false}]);
+                });
+            }
+            const stats = await table.get_latency_stats();
+            expect(Object.keys(stats).sort()).toEqual(["callback_wait", "end_to_end", "process", "send_wait"]);
+            for (const histogram of Object.values(stats)) {
+                expect(histogram.count).toEqual(5);
+                expect(histogram.p50_ns).toBeLessThanOrEqual(histogram.p99_ns);
+                expect(histogram.p99_ns).toBeLessThanOrEqual(histogram.max_ns);
+            }
+
+            const view_stats = await view.get_latency_stats();
+            expect(Object.keys(view_stats).sort()).toEqual(["callback_wait", "end_to_end", "notify"]);
+            expect(view_stats.end_to_end.count).toEqual(5);
+            view.delete();
+            table.delete();
+        });
+
+        it("Resets the histograms", async function() {
+            const table = perspective.table(data);
+            const view = table.view();
+            await table.size();
+            await table.reset_latency_stats();
+            await view.reset_latency_stats();
+            expect((await table.get_latency_stats()).process.count).toEqual(0);
+            expect((await view.get_latency_stats()).end_to_end.count).toEqual(0);
+            view.delete();
+            table.delete();
+        });
+    });
+
+    describe("Generate", function() {
+        const schema = {id: "integer", x: "float", g: "string", b: "boolean", d: "date", t: "datetime"};
+
+        it("Inserts generated rows with the table's schema", async function() {
+            const table = perspective.table(schema, {index: "id"});
+            table.generate({}, {insert: 1000});
+            expect(await table.size()).toEqual(1000);
+            const view = table.view();
+            const result = await view.to_columns();
+            expect(result.id).toEqual([...Array(1000).keys()]);
+            expect(new Set(result.x).size).toEqual(1000);
+            view.delete();
+            table.delete();
+        });
+
+        it("Generates the same rows for the same spec", async function() {
+            const spec = {seed: 3, columns: {g: {cardinality: 10, string_length: 4, null_ratio: 0.1}}};
+            const results = [];
+            for (let i = 0; i < 2; i++) {
+                const table = perspective.table(schema, {index: "id"});
+                table.generate(spec, {insert: 100});
+                table.generate(spec, {insert: 10, update: 50});
+                const view = table.view();
+                results.push(await view.to_columns());
+                view.delete();
+                table.delete();
+            }
+            expect(results[0]).toEqual(results[1]);
+            const values = new Set(results[0].g.filter(x => x !== null));
+            expect(values.size).toEqual(10);
+            expect([...values].every(x => x.length === 4)).toEqual(true);
+        });
+
+        it("Updates and removes generated rows", async function() {
+            const table = perspective.table(schema, {index: "id"});
+            const view = table.view({row_pivots: ["g"]});
+            table.generate({}, {insert: 1000});
+            const before = await view.to_columns();
+            table.generate({}, {update: 100});
+            expect(await table.size()).toEqual(1000);
+            expect(await view.to_columns()).not.toEqual(before);
+            table.generate({}, {insert: 10, remove: 100});
+            const size = await table.size();
+            expect(size).toBeGreaterThanOrEqual(910);
+            expect(size).toBeLessThan(1010);
+            view.delete();
+            table.delete();
+        });
+    });
+
     describe("implicit index", function() {
         it("should apply single partial update on unindexed table using row id from '__INDEX__'", async function() {
             let table = perspective.table(data);
@@ -10,12 +10,19 @@ import os
 import sys
 import signal
 import subprocess
+import tracemalloc
 import venv
 import tornado
 from datetime import datetime
-from timeit import timeit
+from timeit import repeat
 sys.path.insert(1, os.path.join(os.path.dirname(__file__), '..'))
 from perspective import Table, PerspectiveManager, PerspectiveTornadoHandler  # noqa: E402
+try:
+    from perspective import set_alloc_stats_enabled, get_alloc_stats, reset_alloc_stats  # noqa: E402
+except ImportError:
+    # Versions before allocation counting measure Python memory only.
+    set_alloc_stats_enabled = None
+from report import summarize, write_report, read_report, compare, print_comparison, DEFAULT_THRESHOLD  # noqa: E402
 
 logging.basicConfig(level=logging.INFO)
 
@@ -144,14 +151,23 @@ class Runner(object):
 
     ITERATIONS = 10
 
-    def __init__(self, suite):
+    def __init__(self, suite, repeats=1, memory=False):
         """Initializes a benchmark runner for the `Suite`.
 
         Args:
             suite (Suite) : A class that inherits from `Suite`, with any number
                 of instance methods decorated with `@benchmark`.
+            repeats (int) : the number of times to run each benchmark's
+                `ITERATIONS`, each iteration of which is timed as a sample
+                for `write_json`.
+            memory (bool) : whether to run each benchmark once more to
+                measure its peak memory, see `measure_memory`.
         """
         self._suite = suite
+        self._repeats = max(1, repeats)
+        self._memory = memory
+        self._samples = {}
+        self._metrics = {}
         self._benchmarks = []
         self._table = None
         self._WROTE_RESULTS = False
@@ -216,26 +232,90 @@ class Runner(object):
             file.write(arrow)
         self._WROTE_RESULTS = True
 
+    def write_json(self, path, version):
+        """Write a JSON report of each benchmark's statistics to `path`,
+        in the format `report.compare` reads, and return the report."""
+        result = summarize(
+            self._samples, version=version, suite=self._suite.__class__.__name__,
+            repeats=self._repeats, iterations=Runner.ITERATIONS)
+        for id, metrics in self._metrics.items():
+            if id in result["results"]:
+                result["results"][id].update(metrics)
+        logging.info("Writing report to `{}`".format(path))
+        write_report(result, path)
+        return result
+
+    def compare(self, baseline_path, version, threshold=DEFAULT_THRESHOLD):
+        """Compare this run against the JSON report at `baseline_path`,
+        printing the comparison and returning the number of regressions."""
+        current = summarize(self._samples, version=version)
+        baseline = read_report(baseline_path)
+        return print_comparison(
+            compare(baseline, current, threshold), baseline, current)
+
     def run_method(self, func, *args, **kwargs):
         """Wrap the benchmark `func` with timing code and run for n
-        `ITERATIONS`, returning a result row that can be fed into Perspective.
+        `ITERATIONS` times `repeats`, returning a result row that can be fed
+        into Perspective, with the mean time of an iteration.
         """
         overall_result = {
             k.replace("__BENCH__", ""):
                 v for (k, v) in func.__dict__.items() if "__BENCH__" in k
         }
 
-        result = timeit(func, number=Runner.ITERATIONS) / Runner.ITERATIONS
-        overall_result["__TIME__"] = result
+        times = repeat(func, number=1, repeat=Runner.ITERATIONS * self._repeats)
+        overall_result["__TIME__"] = sum(times) / len(times)
+        id = "{}/{}".format(overall_result.get("group"), overall_result.get("name"))
+        self._samples[id] = [t * 1000 for t in times]
+
+        metrics = {}
+        if overall_result.get("rows"):
+            metrics["rows_per_sec"] = round(overall_result["rows"] / overall_result["__TIME__"])
+        if self._memory:
+            metrics.update(self.measure_memory(func))
+        overall_result.update(metrics)
+        self._metrics[id] = metrics
         return overall_result
 
+    def measure_memory(self, func):
+        """Run `func` once, returning the peak bytes allocated by Python
+        during the call as `peak_python_bytes`, and the sum of the high-water
+        marks of the engine's column storage by owner as `peak_engine_bytes`,
+        if this version of `perspective` counts allocations.
+        """
+        if set_alloc_stats_enabled is not None:
+            reset_alloc_stats()
+            set_alloc_stats_enabled(True)
+
+        tracemalloc.start()
+        try:
+            func()
+            _, peak = tracemalloc.get_traced_memory()
+        finally:
+            tracemalloc.stop()
+
+        metrics = {"peak_python_bytes": peak}
+        if set_alloc_stats_enabled is not None:
+            set_alloc_stats_enabled(False)
+            metrics["peak_engine_bytes"] = sum(
+                owner["high_water_bytes"] for owner in get_alloc_stats().values())
+        return metrics
+
     def print_result(self, result):
-        print("{}::{} ({}):{:30}{:>30}".format(
+        extra = ""
+        if "rows_per_sec" in result:
+            extra += "{:>16} rows/sec".format(result["rows_per_sec"])
+        if "peak_python_bytes" in result:
+            extra += "{:>14} py bytes".format(result["peak_python_bytes"])
+        if "peak_engine_bytes" in result:
+            extra += "{:>14} engine bytes".format(result["peak_engine_bytes"])
+        print("{}::{} ({}):{:30}{:>30}{}".format(
             result["group"],
             result["name"],
             result["version"],
             "",
             result["__TIME__"],
+            extra
         ))
 
     def run(self, version):
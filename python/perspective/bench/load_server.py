@@ -0,0 +1,100 @@
+################################################################################
+#
+# Copyright (c) 2019, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+"""The server for the websocket load generator in
+`packages/perspective-bench/bench/load.js`: a `PerspectiveManager` hosting
+one indexed table as `load` behind `PerspectiveTornadoHandler`, and a
+`/stats` endpoint which reports the process' CPU time and the table's latency
+histograms, so the generator can report server CPU alongside its own
+measurements.
+
+Example:
+    >>> python3 load_server.py --port 8888 --rows 10000 --threaded
+"""
+import argparse
+import json
+import os
+import random
+import resource
+import sys
+import time
+import tornado.ioloop
+import tornado.web
+sys.path.insert(1, os.path.join(os.path.dirname(__file__), '..'))
+from perspective import Table, PerspectiveManager, PerspectiveTornadoHandler  # noqa: E402
+
+# The columns of the hosted table, which `load.js` generates updates for.
+GROUPS = ["a", "b", "c", "d", "e", "f", "g", "h"]
+SIDES = ["buy", "sell"]
+
+
+def make_rows(rows, seed=0):
+    """Returns `rows` rows of the hosted table, with ids `0` to `rows - 1`."""
+    rng = random.Random(seed)
+    return {
+        "id": list(range(rows)),
+        "group": [rng.choice(GROUPS) for _ in range(rows)],
+        "side": [rng.choice(SIDES) for _ in range(rows)],
+        "price": [rng.random() * 100 for _ in range(rows)],
+        "qty": [rng.randint(1, 1000) for _ in range(rows)]
+    }
+
+
+class StatsHandler(tornado.web.RequestHandler):
+    """Reports the CPU seconds the server has used, the seconds since it
+    started, and the latency histograms of the hosted table."""
+
+    def initialize(self, table, started):
+        self._table = table
+        self._started = started
+
+    def get(self):
+        usage = resource.getrusage(resource.RUSAGE_SELF)
+        self.set_header("Content-Type", "application/json")
+        self.write(json.dumps({
+            "cpu_user_s": usage.ru_utime,
+            "cpu_system_s": usage.ru_stime,
+            "max_rss_kb": usage.ru_maxrss,
+            "wall_s": time.time() - self._started,
+            "table_size": self._table.size(),
+            "latency": self._table.get_latency_stats()
+        }))
+
+
+def make_app(args):
+    manager = PerspectiveManager(threaded=args.threaded,
+                                 max_pending_rows=args.max_pending_rows,
+                                 max_pending_messages=args.max_pending_messages)
+    table = Table(make_rows(args.rows), index="id")
+    manager.host_table("load", table)
+    return tornado.web.Application([
+        (r"/websocket", PerspectiveTornadoHandler, {
+            "manager": manager,
+            "check_origin": True
+        }),
+        (r"/stats", StatsHandler, {
+            "table": table,
+            "started": time.time()
+        })
+    ])
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Serve a table for the websocket load generator.")
+    parser.add_argument("--port", type=int, default=8888)
+    parser.add_argument("--rows", type=int, default=10000,
+                        help="The number of rows of the hosted table.")
+    parser.add_argument("--threaded", action="store_true",
+                        help="Serialize `to_arrow` on the engine worker threads.")
+    parser.add_argument("--max-pending-rows", type=int, default=None)
+    parser.add_argument("--max-pending-messages", type=int, default=None)
+    args = parser.parse_args()
+
+    app = make_app(args)
+    app.listen(args.port)
+    print("Serving `load` ({} rows) at ws://localhost:{}/websocket".format(args.rows, args.port))
+    tornado.ioloop.IOLoop.current().start()
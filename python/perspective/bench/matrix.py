@@ -0,0 +1,129 @@
+################################################################################
+#
+# Copyright (c) 2019, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+"""A benchmark matrix of every ingestion path of `perspective-python` - dict
+of lists, list of dicts, dicts of numpy arrays and `DataFrame`s of each dtype
+handled by `NumpyLoader`, and Arrow - and every output format of
+`View`, reporting rows/sec and peak memory alongside time.
+
+Example:
+    >>> python3 matrix.py --rows 100000 --json matrix.json
+"""
+import argparse
+import os
+import sys
+from datetime import date, datetime, timedelta
+import numpy as np
+import pandas as pd
+from bench import Benchmark, Suite, Runner
+sys.path.insert(1, os.path.join(os.path.dirname(__file__), '..'))
+from perspective import Table  # noqa: E402
+
+# Output formats of `View`.
+OUTPUT_FORMATS = ["records", "dict", "numpy", "df", "arrow", "csv"]
+
+
+def make_columns(rows, seed=0):
+    """Returns a dict of numpy arrays, one column of each dtype
+    `NumpyLoader` fills from, of `rows` rows."""
+    rng = np.random.RandomState(seed)
+    words = np.array(["alpha", "beta", "gamma", "delta", "epsilon", "zeta", "eta", "theta"], dtype=object)
+    start = datetime(2020, 1, 1)
+    return {
+        "int64": rng.randint(0, 1000000, rows).astype(np.int64),
+        "int32": rng.randint(0, 1000000, rows).astype(np.int32),
+        "float64": rng.rand(rows).astype(np.float64),
+        "float32": rng.rand(rows).astype(np.float32),
+        "bool": rng.rand(rows) > 0.5,
+        "object_str": words[rng.randint(0, len(words), rows)],
+        "datetime64": (np.datetime64(start) + rng.randint(0, 86400 * 365, rows).astype("timedelta64[s]")).astype("datetime64[ns]"),
+        "object_date": np.array([date(2020, 1, 1) + timedelta(days=int(d)) for d in rng.randint(0, 365, rows)], dtype=object)
+    }
+
+
+def make_meta(group, name, rows):
+    return {
+        "group": group,
+        "name": name,
+        "rows": rows
+    }
+
+
+class IngestionMatrix(Suite):
+
+    def __init__(self, rows):
+        """Create the ingestion and serialization matrix over `rows` rows."""
+        self._rows = rows
+        self.numpy = make_columns(rows)
+        self.df = pd.DataFrame(self.numpy)
+        self.df["category"] = self.df["object_str"].astype("category")
+        table = Table(self.df)
+        self._table = table
+        self._flat = table.view()
+        self._pivoted = table.view(row_pivots=["object_str"])
+        self.records = self._flat.to_records()
+        self.dict = self._flat.to_dict()
+        self.arrow = self._flat.to_arrow()
+
+    def register_benchmarks(self):
+        """Register each input and output path as an attribute of the suite,
+        for the `Runner` to find."""
+        self.benchmark_ingest()
+        self.benchmark_ingest_dtypes()
+        self.benchmark_serialize()
+
+    def _register(self, group, name, func, rows):
+        setattr(self, "{}_{}".format(group, name).replace("/", "_"),
+                Benchmark(func, meta=make_meta(group, name, rows)))
+
+    def benchmark_ingest(self):
+        """Benchmark `Table` creation from each format, with every column."""
+        for name in ("dict", "records", "numpy", "df", "arrow"):
+            data = getattr(self, name)
+            self._register("ingest", name, lambda data=data: Table(data).size(), self._rows)
+
+    def benchmark_ingest_dtypes(self):
+        """Benchmark `Table` creation from a single column of each dtype, as
+        a `DataFrame` and as a dict of numpy arrays, so a regression in one
+        fill path is not averaged away by the others."""
+        for dtype in self.df.columns:
+            df = self.df[[dtype]]
+            self._register("ingest_df", dtype, lambda df=df: Table(df).size(), self._rows)
+            if dtype in self.numpy:
+                array = {dtype: self.numpy[dtype]}
+                self._register("ingest_numpy", dtype, lambda array=array: Table(array).size(), self._rows)
+
+    def benchmark_serialize(self):
+        """Benchmark each output format on flat and pivoted views."""
+        views = {"flat": self._flat, "pivoted": self._pivoted}
+        for view_name, view in views.items():
+            rows = view.num_rows()
+            for name in OUTPUT_FORMATS:
+                method = getattr(view, "to_{}".format(name))
+                self._register("serialize", "{}/{}".format(view_name, name), method, rows)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Run the ingestion and serialization matrix.")
+    parser.add_argument("version", nargs="?", default="master")
+    parser.add_argument("--rows", type=int, default=100000,
+                        help="The number of rows of each dataset.")
+    parser.add_argument("--repeats", type=int, default=3,
+                        help="Run each benchmark's iterations this many times.")
+    parser.add_argument("--no-memory", action="store_true",
+                        help="Skip measuring peak memory.")
+    parser.add_argument("--json", help="Write a JSON report to this file.")
+    args = parser.parse_args()
+
+    suite = IngestionMatrix(args.rows)
+    runner = Runner(suite, repeats=args.repeats, memory=not args.no_memory)
+
+    print("Benchmarking perspective-python=={} over {} rows".format(args.version, args.rows))
+    runner.run(args.version)
+
+    if args.json:
+        runner.write_json(args.json, args.version)
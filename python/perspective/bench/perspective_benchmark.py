@@ -321,7 +321,7 @@ class PerspectiveBenchmark(Suite):
 
 
 if __name__ == "__main__":
-    VERSION = "master"
+    VERSION = sys.argv[1] if len(sys.argv) > 1 else "master"
 
     # Initialize a suite and runner, then call `.run()`
     suite = PerspectiveBenchmark()
@@ -0,0 +1,152 @@
+################################################################################
+#
+# Copyright (c) 2019, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+"""Summarize benchmark timings as a JSON report, and compare a report
+against a baseline.
+
+The report format is shared with `perspective-bench`: an object with a
+`format` version, metadata such as `version` and `repeats`, and `results`
+keyed by benchmark id, each a dict of `samples`, `mean`, `median`, `stddev`,
+`min`, `max` and `p95` in milliseconds.
+
+Compare two reports with `python3 report.py baseline.json current.json`.
+"""
+import json
+import math
+import sys
+
+FORMAT_VERSION = 1
+
+# The default relative change in median time past which a benchmark is
+# reported as a regression or an improvement.
+DEFAULT_THRESHOLD = 0.1
+
+
+def _percentile(ordered, p):
+    if len(ordered) == 1:
+        return ordered[0]
+    idx = (len(ordered) - 1) * p
+    lo = int(math.floor(idx))
+    hi = int(math.ceil(idx))
+    return ordered[lo] + (ordered[hi] - ordered[lo]) * (idx - lo)
+
+
+def stats(times):
+    """Returns the summary statistics of a list of times in milliseconds."""
+    ordered = sorted(times)
+    n = len(ordered)
+    mean = sum(ordered) / n
+    variance = sum((x - mean) ** 2 for x in ordered) / (n - 1) if n > 1 else 0
+    return {
+        "samples": n,
+        "mean": round(mean, 3),
+        "median": round(_percentile(ordered, 0.5), 3),
+        "stddev": round(math.sqrt(variance), 3),
+        "min": round(ordered[0], 3),
+        "max": round(ordered[-1], 3),
+        "p95": round(_percentile(ordered, 0.95), 3)
+    }
+
+
+def summarize(samples, **meta):
+    """Returns a report of `samples`, a dict of benchmark id to a list of
+    times in milliseconds, with `meta` at its top level."""
+    report = {"format": FORMAT_VERSION, "runtime": "python"}
+    report.update(meta)
+    report["results"] = {
+        id: stats(times) for id, times in samples.items() if len(times) > 0
+    }
+    return report
+
+
+def write_report(report, path):
+    """Write `report` to `path` with sorted keys, so reports of the same
+    suite diff cleanly against each other."""
+    with open(path, "w") as f:
+        json.dump(report, f, indent=4, sort_keys=True)
+        f.write("\n")
+
+
+def read_report(path):
+    with open(path, "r") as f:
+        return json.load(f)
+
+
+def compare(baseline, current, threshold=DEFAULT_THRESHOLD):
+    """Compare the report `current` against `baseline` by median time.
+
+    A benchmark is a regression (or improvement) when its median changed by
+    more than `threshold`, and by more than twice the standard error of the
+    difference of the two runs' means, so noisy benchmarks need a larger
+    change to be flagged.
+
+    Returns:
+        (list) : a dict per benchmark in either report, sorted by id, with a
+            `status` of "regression", "improvement", "unchanged", "added" or
+            "removed".
+    """
+    base = baseline.get("results", {})
+    curr = current.get("results", {})
+    rows = []
+    for id in sorted(set(base) | set(curr)):
+        b = base.get(id)
+        c = curr.get(id)
+        if b is None:
+            rows.append({"id": id, "status": "added", "current": c["median"]})
+            continue
+        if c is None:
+            rows.append({"id": id, "status": "removed", "baseline": b["median"]})
+            continue
+
+        change = c["median"] / b["median"] - 1 if b["median"] > 0 else 0
+        stderr = math.sqrt(b["stddev"] ** 2 / b["samples"] + c["stddev"] ** 2 / c["samples"])
+        significant = abs(c["median"] - b["median"]) > 2 * stderr
+        status = "unchanged"
+        if significant and change > threshold:
+            status = "regression"
+        elif significant and change < -threshold:
+            status = "improvement"
+        rows.append({
+            "id": id,
+            "status": status,
+            "baseline": b["median"],
+            "current": c["median"],
+            "change": round(change, 3)
+        })
+    return rows
+
+
+def print_comparison(rows, baseline, current):
+    """Print the rows returned by `compare`, and returns the number of
+    regressions."""
+    print("\nComparing {} against baseline {}".format(
+        current.get("version", "current"), baseline.get("version", "baseline")))
+    counts = {}
+    for row in rows:
+        counts[row["status"]] = counts.get(row["status"], 0) + 1
+        base = "-" if "baseline" not in row else "{:.3f}ms".format(row["baseline"])
+        curr = "-" if "current" not in row else "{:.3f}ms".format(row["current"])
+        change = "" if "change" not in row else "{:+.2f}%".format(100 * row["change"])
+        print("  {:11} {:>12} -> {:>12} {:>9}  {}".format(
+            row["status"], base, curr, change, row["id"]))
+    print("\n  " + ", ".join(
+        "{} {}".format(counts[status], status) for status in
+        ("regression", "improvement", "unchanged", "added", "removed")
+        if status in counts))
+    return counts.get("regression", 0)
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 3:
+        print("Usage: python3 report.py <baseline.json> <current.json> [threshold percent]")
+        sys.exit(2)
+
+    baseline = read_report(sys.argv[1])
+    current = read_report(sys.argv[2])
+    threshold = float(sys.argv[3]) / 100 if len(sys.argv) > 3 else DEFAULT_THRESHOLD
+    rows = compare(baseline, current, threshold)
+    sys.exit(1 if print_comparison(rows, baseline, current) > 0 else 0)
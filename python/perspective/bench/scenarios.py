@@ -0,0 +1,218 @@
+################################################################################
+#
+# Copyright (c) 2019, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+"""A fixed set of regression scenarios - ingestion, updates, view fan-out,
+pivot depth, sort, filter, computed columns and serialization - whose ids
+stay stable across versions, so that the JSON reports of two runs can be
+compared.
+
+Example:
+    >>> python3 scenarios.py --json baseline.json
+    >>> python3 scenarios.py --json current.json --baseline baseline.json
+"""
+import argparse
+import os
+import sys
+from bench import Benchmark, Suite, Runner
+from report import DEFAULT_THRESHOLD
+sys.path.insert(1, os.path.join(os.path.dirname(__file__), '..'))
+from perspective import Table  # noqa: E402
+from perspective.tests.common import superstore  # noqa: E402
+
+SUPERSTORE = superstore(9994)
+
+UPDATE_SIZE = 500
+FAN_OUT_VIEWS = [1, 10, 50]
+PIVOT_COLUMNS = ["Region", "State", "City", "Category", "Sub-Category"]
+
+SORT_OPTIONS = {
+    "float": [["Sales", "desc"]],
+    "string": [["City", "asc"]],
+    "multi": [["Region", "asc"], ["Sales", "desc"]]
+}
+
+FILTER_OPTIONS = {
+    "float": [["Sales", ">", 5000]],
+    "string": [["Ship Mode", "==", "First Class"]],
+    "begins_with": [["City", "begins with", "A"]],
+    "multi": [["Sales", ">", 5000], ["Region", "==", "Region 0"]]
+}
+
+COMPUTED_OPTIONS = {
+    "add": ("+", ["Sales", "Profit"]),
+    "uppercase": ("uppercase", ["City"]),
+    "week_bucket": ("week_bucket", ["Order Date"])
+}
+
+
+def make_meta(group, name):
+    return {
+        "group": group,
+        "name": name
+    }
+
+
+def empty_callback(port_id):
+    pass
+
+
+class ScenarioBenchmark(Suite):
+
+    def __init__(self):
+        """Create the regression scenario suite for `perspective-python`."""
+        tbl = Table(SUPERSTORE)
+        self._schema = tbl.schema()
+        self._view = tbl.view()
+        self.df = SUPERSTORE
+        self.dict = self._view.to_dict()
+        self.records = self._view.to_records()
+        self.csv = self._view.to_csv()
+        self.arrow = self._view.to_arrow()
+        self._table = tbl
+
+        # Updates overwrite the first rows of an indexed table, and append
+        # to an unindexed one.
+        self.updates = {
+            "records": self._view.to_records(end_row=UPDATE_SIZE),
+            "dict": self._view.to_dict(end_row=UPDATE_SIZE),
+            "df": self._view.to_df(end_row=UPDATE_SIZE),
+            "arrow": self._view.to_arrow(end_row=UPDATE_SIZE)
+        }
+
+    def register_benchmarks(self):
+        """Register each scenario as an attribute of the suite, named
+        `<group>_<name>`, for the `Runner` to find."""
+        self.benchmark_ingest()
+        self.benchmark_update()
+        self.benchmark_fan_out()
+        self.benchmark_pivot()
+        self.benchmark_sort()
+        self.benchmark_filter()
+        self.benchmark_computed()
+        self.benchmark_serialize()
+
+    def _register(self, group, name, func):
+        setattr(self, "{}_{}".format(group, name).replace("/", "_"),
+                Benchmark(func, meta=make_meta(group, name)))
+
+    def _view_scenario(self, **config):
+        def create_view():
+            view = self._table.view(**config)
+            view.num_rows()
+            view.delete()
+        return create_view
+
+    def benchmark_ingest(self):
+        """Benchmark table creation from each format."""
+        for name in ("df", "dict", "records", "csv", "arrow"):
+            data = getattr(self, name)
+            self._register("ingest", name, lambda data=data: Table(data).size())
+
+    def benchmark_update(self):
+        """Benchmark updates from each format, with and without an index."""
+        for index in ("unindexed", "indexed"):
+            for name, data in self.updates.items():
+                kwargs = {"index": "Row ID"} if index == "indexed" else {}
+                table = Table(self.arrow, **kwargs)
+
+                def resolve_update(table=table, data=data):
+                    table.update(data)
+                    table.size()
+
+                self._register("update", "{}/{}".format(index, name), resolve_update)
+
+    def benchmark_fan_out(self):
+        """Benchmark how long an update takes to resolve across an
+        increasing number of views with `on_update` callbacks."""
+        for count in FAN_OUT_VIEWS:
+            table = Table(self.arrow, index="Row ID")
+            views = [table.view(
+                row_pivots=[PIVOT_COLUMNS[i % len(PIVOT_COLUMNS)]],
+                columns=["Sales", "Profit"]) for i in range(count)]
+            for view in views:
+                view.on_update(empty_callback)
+
+            def resolve_update(table=table, views=views):
+                table.update(self.updates["records"])
+                for view in views:
+                    view.num_rows()
+
+            self._register("fan_out", "{}_views".format(count), resolve_update)
+
+    def benchmark_pivot(self):
+        """Benchmark view creation with increasingly deep row pivots."""
+        columns = ["Sales", "Profit", "Quantity"]
+        for depth in range(len(PIVOT_COLUMNS) + 1):
+            row_pivots = PIVOT_COLUMNS[:depth]
+            self._register("pivot", "depth_{}/row".format(depth), self._view_scenario(
+                row_pivots=row_pivots, columns=columns))
+            self._register("pivot", "depth_{}/row_and_column".format(depth), self._view_scenario(
+                row_pivots=row_pivots, column_pivots=["Segment"], columns=columns))
+
+    def benchmark_sort(self):
+        """Benchmark view creation with sorts on flat and pivoted views."""
+        for name, sort in SORT_OPTIONS.items():
+            self._register("sort", "{}/flat".format(name), self._view_scenario(sort=sort))
+            self._register("sort", "{}/pivoted".format(name), self._view_scenario(
+                row_pivots=["State"], sort=[s for s in sort if s[0] != "State"]))
+
+    def benchmark_filter(self):
+        """Benchmark view creation with filters on flat and pivoted views."""
+        for name, filter in FILTER_OPTIONS.items():
+            self._register("filter", "{}/flat".format(name), self._view_scenario(filter=filter))
+            self._register("filter", "{}/pivoted".format(name), self._view_scenario(
+                row_pivots=["Category"], filter=filter))
+
+    def benchmark_computed(self):
+        """Benchmark view creation with a computed column, on flat views and
+        views pivoted by the computed column."""
+        for name, (func, inputs) in COMPUTED_OPTIONS.items():
+            computed_columns = [{
+                "column": "computed",
+                "computed_function_name": func,
+                "inputs": inputs
+            }]
+            self._register("computed", "{}/flat".format(name), self._view_scenario(
+                computed_columns=computed_columns))
+            self._register("computed", "{}/pivoted".format(name), self._view_scenario(
+                row_pivots=["computed"], computed_columns=computed_columns))
+
+    def benchmark_serialize(self):
+        """Benchmark each `to_format` method on flat and pivoted views."""
+        views = {
+            "flat": self._view,
+            "pivoted": self._table.view(row_pivots=["State", "City"])
+        }
+        for view_name, view in views.items():
+            for name in ("dict", "records", "numpy", "df", "csv", "arrow"):
+                method = getattr(view, "to_{}".format(name))
+                self._register("serialize", "{}/{}".format(view_name, name), method)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Run the regression scenarios.")
+    parser.add_argument("version", nargs="?", default="master")
+    parser.add_argument("--repeats", type=int, default=3,
+                        help="Run each scenario's iterations this many times.")
+    parser.add_argument("--json", help="Write a JSON report to this file.")
+    parser.add_argument("--baseline", help="Compare against the JSON report of a baseline run.")
+    parser.add_argument("--threshold", type=float, default=DEFAULT_THRESHOLD * 100,
+                        help="Change in median time reported as a regression, in percent.")
+    args = parser.parse_args()
+
+    suite = ScenarioBenchmark()
+    runner = Runner(suite, repeats=args.repeats)
+
+    print("Benchmarking perspective-python=={}".format(args.version))
+    runner.run(args.version)
+
+    if args.json:
+        runner.write_json(args.json, args.version)
+
+    if args.baseline:
+        regressions = runner.compare(args.baseline, args.version, args.threshold / 100)
+        sys.exit(1 if regressions > 0 else 0)
@@ -18,6 +18,10 @@ class Aggregate(Enum):
     '''
     AND = 'and'
     ANY = 'any'
+    APPROX_DISTINCT_COUNT = 'approx distinct count'
+    APPROX_P50 = 'approx p50'
+    APPROX_P90 = 'approx p90'
+    APPROX_P99 = 'approx p99'
     AVG = 'avg'
     COUNT = 'count'
     DISTINCT_COUNT = 'distinct count'
@@ -28,8 +32,10 @@ class Aggregate(Enum):
     LAST = 'last'
     HIGH = 'high'
     LOW = 'low'
+    MAX = 'max'
     MEAN = 'mean'
     MEDIAN = 'median'
+    MIN = 'min'
     OR = 'or'
     PCT_SUM_PARENT = 'pct sum parent'
     PCT_SUM_GRAND_TOTAL = 'pct sum grand total'
@@ -8,7 +8,6 @@
 
 import six
 import numpy as np
-from datetime import datetime
 
 DATE_DTYPES = [np.dtype("datetime64[D]"), np.dtype("datetime64[W]"), np.dtype("datetime64[M]"), np.dtype("datetime64[Y]")]
 
@@ -25,6 +24,12 @@ def make_null_mask(array):
     Args:
         array (:obj:`numpy.array`)
     """
+    if array.dtype.kind in "biuf":
+        # numeric arrays can only hold `nan`, so find them without iterating
+        return np.flatnonzero(np.isnan(array))
+    elif array.dtype.kind in "mM":
+        return np.flatnonzero(np.isnat(array))
+
     mask = []
 
     is_object_or_string_dtype = np.issubdtype(array.dtype, np.str_) or\
@@ -72,26 +77,11 @@ def deconstruct_numpy(array, mask=None):
         # bool => byte
         array = array.astype("b", copy=False)
     elif np.issubdtype(array.dtype, np.datetime64):
-        # treat days/weeks/months/years as datetime objects - avoid idiosyncracy
-        # with days of month, etc.
-        if array.dtype in DATE_DTYPES:
-            array = array.astype(datetime)
-
-        # cast datetimes to millisecond timestamps
-        # because datetime64("nat") is a double, cast to float64 here - C++
-        # handles the rest
-        if array.dtype == np.dtype("datetime64[us]"):
-            array = array.astype(np.float64, copy=False) / 1000
-        elif array.dtype == np.dtype("datetime64[ns]"):
-            array = array.astype(np.float64, copy=False) / 1000000
-        elif array.dtype == np.dtype("datetime64[ms]"):
-            array = array.astype(np.float64, copy=False)
-        elif array.dtype == np.dtype("datetime64[s]"):
-            array = array.astype(np.float64, copy=False) * 1000
-        elif array.dtype == np.dtype("datetime64[m]"):
-            array = array.astype(np.float64, copy=False) * 60000
-        elif array.dtype == np.dtype("datetime64[h]"):
-            array = array.astype(np.float64, copy=False) * 3600000
+        # datetimes are passed as their int64 representation, which C++
+        # rescales into millisecond timestamps or dates in one pass. Months and
+        # years are not of a fixed length, so are cast to days first.
+        if array.dtype in DATE_DTYPES and array.dtype != np.dtype("datetime64[D]"):
+            array = array.astype("datetime64[D]")
     elif np.issubdtype(array.dtype, np.timedelta64):
         array = array.astype(np.float64, copy=False)
 
@@ -0,0 +1,191 @@
+################################################################################
+#
+# Copyright (c) 2019, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+import json
+import threading
+import pyarrow as pa
+import pyarrow.flight as flight
+from ..core.exception import PerspectiveError
+from ..table import Table
+
+
+class PerspectiveFlightServer(flight.FlightServerBase):
+    '''PerspectiveFlightServer serves the tables and views of a
+    `PerspectiveManager` over Arrow Flight, so that clients can pull them as
+    Arrow record batches and push updates to them without going through the
+    websocket protocol.
+
+    Each hosted `Table` or `View` is a flight whose descriptor is the path
+    `[name]`:
+
+    - `get_flight_info` splits the rows of a view (or of a flat view of a
+        table) into up to `parallelism` endpoints, whose tickets a client can
+        redeem with `do_get` on parallel streams.
+    - `do_put` updates the table `name` with the uploaded stream, or hosts a
+        new table under `name` if there is none. Uploads are refused when the
+        manager is locked.
+
+    Flight calls each handler on a thread of its own, so the server reads and
+    updates tables under a lock; if the same tables are also served through a
+    `PerspectiveTornadoHandler`, they should only be updated through one of
+    the two.
+
+    Examples:
+        >>> MANAGER = PerspectiveManager()
+        >>> MANAGER.host_table("data_source_one", Table(
+        ...     pd.read_csv("superstore.csv")))
+        >>> server = PerspectiveFlightServer(MANAGER, "grpc://0.0.0.0:8815")
+        >>> server.serve()
+    '''
+
+    def __init__(self, manager=None, location="grpc://0.0.0.0:8815",
+                 parallelism=4, min_rows_per_stream=65536, **kwargs):
+        '''Create a new Flight server for the given Manager instance, which
+        listens on `location`.
+
+        Keyword Args:
+            manager (:obj`PerspectiveManager`): A `PerspectiveManager`
+                instance. Must be provided on initialization.
+            location (:obj`str`): The URI to listen on. Defaults to
+                "grpc://0.0.0.0:8815".
+            parallelism (:obj`int`): The maximum number of endpoints a
+                flight is split into. Defaults to 4.
+            min_rows_per_stream (:obj`int`): The minimum number of rows in
+                each endpoint but the last. Defaults to 65536.
+            **kwargs: passed to `pyarrow.flight.FlightServerBase`, e.g.
+                `auth_handler` or `tls_certificates`.
+        '''
+        if manager is None:
+            raise PerspectiveError("A `PerspectiveManager` instance must be provided to the flight server!")
+
+        if parallelism < 1 or min_rows_per_stream < 1:
+            raise PerspectiveError("`parallelism` and `min_rows_per_stream` must be positive!")
+
+        super(PerspectiveFlightServer, self).__init__(location, **kwargs)
+        self._manager = manager
+        self._parallelism = parallelism
+        self._min_rows_per_stream = min_rows_per_stream
+        self._lock = threading.RLock()
+
+        # A flat view of each hosted table, keyed by the table's name, which
+        # is reused while the same table is hosted under that name.
+        self._table_views = {}
+
+    def list_flights(self, context, criteria):
+        '''Yield the `FlightInfo` of every hosted table and view.'''
+        with self._lock:
+            names = list(self._manager._tables.keys()) + list(self._manager._views.keys())
+
+        for name in names:
+            yield self.get_flight_info(context, flight.FlightDescriptor.for_path(name))
+
+    def get_flight_info(self, context, descriptor):
+        '''Return the schema, row count and endpoints of the table or view
+        named by `descriptor`. The last endpoint reads to the end of the view,
+        so that rows added after this call are not missed.'''
+        name = self._descriptor_name(descriptor)
+
+        with self._lock:
+            view = self._get_view(name)
+            num_rows = view.num_rows()
+            schema = self._read_arrow(view.to_arrow_buffer(end_row=0)).schema
+
+        endpoints = []
+        for start_row, end_row in self._partition(num_rows):
+            ticket = json.dumps({
+                "name": name,
+                "start_row": start_row,
+                "end_row": end_row
+            }).encode("utf-8")
+
+            # No locations: the ticket is redeemed on this server.
+            endpoints.append(flight.FlightEndpoint(ticket, []))
+
+        return flight.FlightInfo(schema, descriptor, endpoints, num_rows, -1)
+
+    def do_get(self, context, ticket):
+        '''Stream the rows of a ticket returned by `get_flight_info`.'''
+        request = json.loads(ticket.ticket.decode("utf-8"))
+        options = {"start_row": request["start_row"]}
+
+        if request["end_row"] is not None:
+            options["end_row"] = request["end_row"]
+
+        with self._lock:
+            arrow = self._get_view(request["name"]).to_arrow_buffer(**options)
+
+        return flight.RecordBatchStream(self._read_arrow(arrow))
+
+    def do_put(self, context, descriptor, reader, writer=None):
+        '''Update the table named by `descriptor` with the uploaded stream,
+        or host it as a new table if there is none.'''
+        if self._manager._lock:
+            raise PerspectiveError("`update` failed - access denied")
+
+        name = self._descriptor_name(descriptor)
+        arrow_table = reader.read_all()
+
+        sink = pa.BufferOutputStream()
+        stream_writer = pa.RecordBatchStreamWriter(sink, arrow_table.schema)
+        stream_writer.write_table(arrow_table)
+        stream_writer.close()
+        arrow = sink.getvalue().to_pybytes()
+
+        with self._lock:
+            table = self._manager.get_table(name)
+            if table is None:
+                self._manager.host_table(name, Table(arrow))
+            else:
+                table.update(arrow)
+
+    def _descriptor_name(self, descriptor):
+        if descriptor.descriptor_type != flight.DescriptorType.PATH or len(descriptor.path) != 1:
+            raise PerspectiveError("Flight descriptors must be the path `[name]` of a table or view!")
+
+        name = descriptor.path[0]
+        if isinstance(name, bytes):
+            name = name.decode("utf-8")
+
+        return name
+
+    def _get_view(self, name):
+        '''Return the view `name`, or a flat view of the table `name`.'''
+        view = self._manager.get_view(name)
+        if view is not None:
+            return view
+
+        table = self._manager.get_table(name)
+        if table is None:
+            raise PerspectiveError("No table or view named `{0}` is hosted!".format(name))
+
+        cached = self._table_views.get(name, None)
+        if cached is not None and cached[0] is table:
+            return cached[1]
+
+        if cached is not None:
+            cached[1].delete()
+
+        view = table.view()
+        self._table_views[name] = (table, view)
+        return view
+
+    def _partition(self, num_rows):
+        '''Split `num_rows` into `(start_row, end_row)` ranges, the last of
+        which is open-ended.'''
+        num_streams = min(self._parallelism, -(-num_rows // self._min_rows_per_stream))
+
+        if num_streams <= 1:
+            return [(0, None)]
+
+        step = -(-num_rows // num_streams)
+        ranges = [(start_row, start_row + step) for start_row in range(0, num_rows, step)]
+        ranges[-1] = (ranges[-1][0], None)
+        return ranges
+
+    def _read_arrow(self, arrow):
+        return pa.ipc.open_stream(pa.BufferReader(arrow)).read_all()
@@ -30,6 +30,7 @@
 #include <perspective/binding.h>
 #include <perspective/exception.h>
 #include <perspective/exports.h>
+#include <perspective/kernels.h>
 #include <perspective/python/accessor.h>
 #include <perspective/python/base.h>
 #include <perspective/python/computed.h>
@@ -72,14 +73,129 @@ PYBIND11_MODULE(libbinding, m)
         .def(py::init<std::shared_ptr<t_pool>, std::vector<std::string>, std::vector<t_dtype>,
         std::uint32_t, std::string>())
         .def("size", &Table::size)
+        .def("get_memory_usage", &Table::get_memory_usage)
+        .def("get_update_stats", &Table::get_update_stats)
+        .def("get_latency_stats", &Table::get_latency_stats)
+        .def("reset_latency_stats", &Table::reset_latency_stats)
         .def("get_schema", &Table::get_schema)
         .def("unregister_gnode", &Table::unregister_gnode)
         .def("reset_gnode", &Table::reset_gnode)
         .def("make_port", &Table::make_port)
         .def("remove_port", &Table::remove_port)
         .def("get_id", &Table::get_id)
+        .def("get_index", &Table::get_index)
+        .def("get_limit", &Table::get_limit)
         .def("get_pool", &Table::get_pool)
-        .def("get_gnode", &Table::get_gnode);
+        .def("get_gnode", &Table::get_gnode)
+        .def("save_snapshot", &Table::save_snapshot)
+        .def("load_snapshot", &Table::load_snapshot)
+        .def("enable_update_log", &Table::enable_update_log)
+        .def("checkpoint", &Table::checkpoint)
+        .def("flush_update_log", &Table::flush_update_log)
+        .def("recover_from_log", &Table::recover_from_log)
+        .def("enable_replication", &Table::enable_replication)
+        .def("apply_replication_batch", &Table::apply_replication_batch)
+        .def("share_dictionary", &Table::share_dictionary)
+        .def("create_index", &Table::create_index)
+        .def("create_sorted_index", &Table::create_sorted_index)
+        .def("compact_rows", &Table::compact_rows)
+        .def("set_column_spill", &Table::set_column_spill)
+        .def("spill_cold_columns", &Table::spill_cold_columns)
+        .def("set_column_packing", &Table::set_column_packing)
+        .def("pack_cold_columns", &Table::pack_cold_columns)
+        .def("reclaim_memory", &Table::reclaim_memory,
+            py::call_guard<py::gil_scoped_release>())
+        .def("set_column_scale", &Table::set_column_scale)
+        .def("get_column_scales", &Table::get_column_scales);
+
+    /******************************************************************************
+     *
+     * t_data_generator
+     */
+    py::class_<t_data_generator, std::shared_ptr<t_data_generator>>(m, "t_data_generator")
+        .def("generate", &t_data_generator::generate,
+            py::call_guard<py::gil_scoped_release>())
+        .def("get_num_keys", &t_data_generator::get_num_keys)
+        .def("get_num_batches", &t_data_generator::get_num_batches);
+
+    /******************************************************************************
+     *
+     * t_mask
+     */
+    py::class_<t_mask, std::shared_ptr<t_mask>>(m, "t_mask")
+        .def(py::init<t_uindex>())
+        .def("size", &t_mask::size)
+        .def("count", &t_mask::count)
+        .def("get", &t_mask::get)
+        .def("set", static_cast<void (t_mask::*)(t_uindex, bool)>(&t_mask::set))
+        .def("find_first", &t_mask::find_first)
+        .def("find_next", &t_mask::find_next)
+        .def("num_bitmap_chunks", &t_mask::num_bitmap_chunks)
+        .def("__iand__", [](t_mask& a, const t_mask& b) -> t_mask& { return a &= b; })
+        .def("__ior__", [](t_mask& a, const t_mask& b) -> t_mask& { return a |= b; })
+        .def("__ixor__", [](t_mask& a, const t_mask& b) -> t_mask& { return a ^= b; })
+        .def("__isub__", [](t_mask& a, const t_mask& b) -> t_mask& { return a -= b; })
+        .def_property_readonly_static("npos", [](py::object) { return t_mask::m_npos; });
+
+    /******************************************************************************
+     *
+     * t_bloom_filter
+     */
+    py::class_<t_bloom_filter, std::shared_ptr<t_bloom_filter>>(m, "t_bloom_filter")
+        .def(py::init<>())
+        .def("reset", &t_bloom_filter::reset)
+        .def("clear", &t_bloom_filter::clear)
+        .def("empty", &t_bloom_filter::empty)
+        .def("insert", &t_bloom_filter::insert)
+        .def("may_contain", &t_bloom_filter::may_contain)
+        .def("nbytes", &t_bloom_filter::nbytes);
+
+    /******************************************************************************
+     *
+     * t_join
+     */
+    py::class_<t_join, std::shared_ptr<t_join>>(m, "t_join")
+        .def(py::init<std::shared_ptr<Table>, std::shared_ptr<Table>, std::string>())
+        .def("init", &t_join::init, py::call_guard<py::gil_scoped_release>())
+        .def("detach", &t_join::detach, py::call_guard<py::gil_scoped_release>())
+        .def("get_table", &t_join::get_table)
+        .def("num_matched_keys", &t_join::num_matched_keys);
+
+    /******************************************************************************
+     *
+     * t_union
+     */
+    py::class_<t_union, std::shared_ptr<t_union>>(m, "t_union")
+        .def(py::init<std::vector<std::shared_ptr<Table>>>())
+        .def("init", &t_union::init, py::call_guard<py::gil_scoped_release>())
+        .def("detach", &t_union::detach, py::call_guard<py::gil_scoped_release>())
+        .def("get_table", &t_union::get_table);
+
+    /******************************************************************************
+     *
+     * t_ctx_grouped_pkey
+     */
+    py::class_<t_ctx_grouped_pkey, std::shared_ptr<t_ctx_grouped_pkey>>(m, "t_ctx_grouped_pkey")
+        .def("get_row_count", &t_ctx_grouped_pkey::get_row_count)
+        .def("get_column_count", &t_ctx_grouped_pkey::get_column_count)
+        .def("set_depth", &t_ctx_grouped_pkey::set_depth);
+
+    /******************************************************************************
+     *
+     * t_ctx_totals
+     */
+    py::class_<t_ctx_totals, std::shared_ptr<t_ctx_totals>>(m, "t_ctx_totals")
+        .def("get_column_names", &t_ctx_totals::get_column_names);
+
+    /******************************************************************************
+     *
+     * t_view_feed
+     */
+    py::class_<t_view_feed, std::shared_ptr<t_view_feed>>(m, "t_view_feed")
+        .def(py::init<std::shared_ptr<View<t_ctx1>>>())
+        .def("init", &t_view_feed::init, py::call_guard<py::gil_scoped_release>())
+        .def("detach", &t_view_feed::detach, py::call_guard<py::gil_scoped_release>())
+        .def("get_table", &t_view_feed::get_table);
 
     /******************************************************************************
      *
@@ -92,6 +208,10 @@ PYBIND11_MODULE(libbinding, m)
             std::shared_ptr<t_view_config>>())
         .def("sides", &View<t_ctx0>::sides)
         .def("num_rows", &View<t_ctx0>::num_rows)
+        .def("get_memory_usage", &View<t_ctx0>::get_memory_usage)
+        .def("explain", &View<t_ctx0>::explain)
+        .def("get_latency_stats", &View<t_ctx0>::get_latency_stats)
+        .def("reset_latency_stats", &View<t_ctx0>::reset_latency_stats)
         .def("num_columns", &View<t_ctx0>::num_columns)
         .def("get_row_expanded", &View<t_ctx0>::get_row_expanded)
         .def("schema", &View<t_ctx0>::schema)
@@ -107,7 +227,34 @@ PYBIND11_MODULE(libbinding, m)
         .def("get_filter", &View<t_ctx0>::get_filter)
         .def("get_sort", &View<t_ctx0>::get_sort)
         .def("get_step_delta", &View<t_ctx0>::get_step_delta)
+        .def("set_viewport", &View<t_ctx0>::set_viewport)
+        .def("clear_viewport", &View<t_ctx0>::clear_viewport)
+        .def("set_priority", &View<t_ctx0>::set_priority,
+            py::call_guard<py::gil_scoped_release>())
+        .def("get_priority", &View<t_ctx0>::get_priority,
+            py::call_guard<py::gil_scoped_release>())
+        .def("freeze", &View<t_ctx0>::freeze, py::call_guard<py::gil_scoped_release>())
+        .def("thaw", &View<t_ctx0>::thaw, py::call_guard<py::gil_scoped_release>())
+        .def("is_frozen", &View<t_ctx0>::is_frozen,
+            py::call_guard<py::gil_scoped_release>())
+        .def("set_memory_budget", &View<t_ctx0>::set_memory_budget,
+            py::call_guard<py::gil_scoped_release>())
+        .def("get_memory_budget", &View<t_ctx0>::get_memory_budget,
+            py::call_guard<py::gil_scoped_release>())
+        .def("reclaim_memory", &View<t_ctx0>::reclaim_memory,
+            py::call_guard<py::gil_scoped_release>())
+        .def("build", &View<t_ctx0>::build, py::call_guard<py::gil_scoped_release>())
+        .def("get_build_progress", &View<t_ctx0>::get_build_progress,
+            py::call_guard<py::gil_scoped_release>())
+        .def("get_row_count_changed", &View<t_ctx0>::get_row_count_changed)
+        .def("set_notify_interval", &View<t_ctx0>::set_notify_interval)
+        .def("get_notify_interval", &View<t_ctx0>::get_notify_interval)
+        .def("get_notify_delay", &View<t_ctx0>::get_notify_delay)
+        .def("set_notified", &View<t_ctx0>::set_notified)
         .def("get_column_dtype", &View<t_ctx0>::get_column_dtype)
+        .def("open_cursor", &View<t_ctx0>::open_cursor,
+            py::call_guard<py::gil_scoped_release>())
+        .def("close_cursor", &View<t_ctx0>::close_cursor)
         .def("is_column_only", &View<t_ctx0>::is_column_only);
 
     py::class_<View<t_ctx1>, std::shared_ptr<View<t_ctx1>>>(m, "View_ctx1")
@@ -115,11 +262,19 @@ PYBIND11_MODULE(libbinding, m)
             std::shared_ptr<t_view_config>>())
         .def("sides", &View<t_ctx1>::sides)
         .def("num_rows", &View<t_ctx1>::num_rows)
+        .def("get_memory_usage", &View<t_ctx1>::get_memory_usage)
+        .def("explain", &View<t_ctx1>::explain)
+        .def("get_latency_stats", &View<t_ctx1>::get_latency_stats)
+        .def("reset_latency_stats", &View<t_ctx1>::reset_latency_stats)
         .def("num_columns", &View<t_ctx1>::num_columns)
         .def("get_row_expanded", &View<t_ctx1>::get_row_expanded)
         .def("expand", &View<t_ctx1>::expand)
         .def("collapse", &View<t_ctx1>::collapse)
         .def("set_depth", &View<t_ctx1>::set_depth)
+        .def("get_expansion_state", &View<t_ctx1>::get_expansion_state)
+        .def("set_expansion_state", &View<t_ctx1>::set_expansion_state)
+        .def("set_lazy_aggregates", &View<t_ctx1>::set_lazy_aggregates)
+        .def("get_lazy_aggregates", &View<t_ctx1>::get_lazy_aggregates)
         .def("schema", &View<t_ctx1>::schema)
         .def("computed_schema", &View<t_ctx1>::computed_schema)
         .def("column_names", &View<t_ctx1>::column_names)
@@ -133,7 +288,34 @@ PYBIND11_MODULE(libbinding, m)
         .def("get_filter", &View<t_ctx1>::get_filter)
         .def("get_sort", &View<t_ctx1>::get_sort)
         .def("get_step_delta", &View<t_ctx1>::get_step_delta)
+        .def("set_viewport", &View<t_ctx1>::set_viewport)
+        .def("clear_viewport", &View<t_ctx1>::clear_viewport)
+        .def("set_priority", &View<t_ctx1>::set_priority,
+            py::call_guard<py::gil_scoped_release>())
+        .def("get_priority", &View<t_ctx1>::get_priority,
+            py::call_guard<py::gil_scoped_release>())
+        .def("freeze", &View<t_ctx1>::freeze, py::call_guard<py::gil_scoped_release>())
+        .def("thaw", &View<t_ctx1>::thaw, py::call_guard<py::gil_scoped_release>())
+        .def("is_frozen", &View<t_ctx1>::is_frozen,
+            py::call_guard<py::gil_scoped_release>())
+        .def("set_memory_budget", &View<t_ctx1>::set_memory_budget,
+            py::call_guard<py::gil_scoped_release>())
+        .def("get_memory_budget", &View<t_ctx1>::get_memory_budget,
+            py::call_guard<py::gil_scoped_release>())
+        .def("reclaim_memory", &View<t_ctx1>::reclaim_memory,
+            py::call_guard<py::gil_scoped_release>())
+        .def("build", &View<t_ctx1>::build, py::call_guard<py::gil_scoped_release>())
+        .def("get_build_progress", &View<t_ctx1>::get_build_progress,
+            py::call_guard<py::gil_scoped_release>())
+        .def("get_row_count_changed", &View<t_ctx1>::get_row_count_changed)
+        .def("set_notify_interval", &View<t_ctx1>::set_notify_interval)
+        .def("get_notify_interval", &View<t_ctx1>::get_notify_interval)
+        .def("get_notify_delay", &View<t_ctx1>::get_notify_delay)
+        .def("set_notified", &View<t_ctx1>::set_notified)
         .def("get_column_dtype", &View<t_ctx1>::get_column_dtype)
+        .def("open_cursor", &View<t_ctx1>::open_cursor,
+            py::call_guard<py::gil_scoped_release>())
+        .def("close_cursor", &View<t_ctx1>::close_cursor)
         .def("is_column_only", &View<t_ctx1>::is_column_only);
 
     py::class_<View<t_ctx2>, std::shared_ptr<View<t_ctx2>>>(m, "View_ctx2")
@@ -141,11 +323,19 @@ PYBIND11_MODULE(libbinding, m)
             std::shared_ptr<t_view_config>>())
         .def("sides", &View<t_ctx2>::sides)
         .def("num_rows", &View<t_ctx2>::num_rows)
+        .def("get_memory_usage", &View<t_ctx2>::get_memory_usage)
+        .def("explain", &View<t_ctx2>::explain)
+        .def("get_latency_stats", &View<t_ctx2>::get_latency_stats)
+        .def("reset_latency_stats", &View<t_ctx2>::reset_latency_stats)
         .def("num_columns", &View<t_ctx2>::num_columns)
         .def("get_row_expanded", &View<t_ctx2>::get_row_expanded)
         .def("expand", &View<t_ctx2>::expand)
         .def("collapse", &View<t_ctx2>::collapse)
         .def("set_depth", &View<t_ctx2>::set_depth)
+        .def("get_expansion_state", &View<t_ctx2>::get_expansion_state)
+        .def("set_expansion_state", &View<t_ctx2>::set_expansion_state)
+        .def("set_lazy_aggregates", &View<t_ctx2>::set_lazy_aggregates)
+        .def("get_lazy_aggregates", &View<t_ctx2>::get_lazy_aggregates)
         .def("schema", &View<t_ctx2>::schema)
         .def("computed_schema", &View<t_ctx2>::computed_schema)
         .def("column_names", &View<t_ctx2>::column_names)
@@ -160,7 +350,34 @@ PYBIND11_MODULE(libbinding, m)
         .def("get_sort", &View<t_ctx2>::get_sort)
         .def("get_row_path", &View<t_ctx2>::get_row_path)
         .def("get_step_delta", &View<t_ctx2>::get_step_delta)
+        .def("set_viewport", &View<t_ctx2>::set_viewport)
+        .def("clear_viewport", &View<t_ctx2>::clear_viewport)
+        .def("set_priority", &View<t_ctx2>::set_priority,
+            py::call_guard<py::gil_scoped_release>())
+        .def("get_priority", &View<t_ctx2>::get_priority,
+            py::call_guard<py::gil_scoped_release>())
+        .def("freeze", &View<t_ctx2>::freeze, py::call_guard<py::gil_scoped_release>())
+        .def("thaw", &View<t_ctx2>::thaw, py::call_guard<py::gil_scoped_release>())
+        .def("is_frozen", &View<t_ctx2>::is_frozen,
+            py::call_guard<py::gil_scoped_release>())
+        .def("set_memory_budget", &View<t_ctx2>::set_memory_budget,
+            py::call_guard<py::gil_scoped_release>())
+        .def("get_memory_budget", &View<t_ctx2>::get_memory_budget,
+            py::call_guard<py::gil_scoped_release>())
+        .def("reclaim_memory", &View<t_ctx2>::reclaim_memory,
+            py::call_guard<py::gil_scoped_release>())
+        .def("build", &View<t_ctx2>::build, py::call_guard<py::gil_scoped_release>())
+        .def("get_build_progress", &View<t_ctx2>::get_build_progress,
+            py::call_guard<py::gil_scoped_release>())
+        .def("get_row_count_changed", &View<t_ctx2>::get_row_count_changed)
+        .def("set_notify_interval", &View<t_ctx2>::set_notify_interval)
+        .def("get_notify_interval", &View<t_ctx2>::get_notify_interval)
+        .def("get_notify_delay", &View<t_ctx2>::get_notify_delay)
+        .def("set_notified", &View<t_ctx2>::set_notified)
         .def("get_column_dtype", &View<t_ctx2>::get_column_dtype)
+        .def("open_cursor", &View<t_ctx2>::open_cursor,
+            py::call_guard<py::gil_scoped_release>())
+        .def("close_cursor", &View<t_ctx2>::close_cursor)
         .def("is_column_only", &View<t_ctx2>::is_column_only);
 
     /******************************************************************************
@@ -202,7 +419,16 @@ PYBIND11_MODULE(libbinding, m)
      * t_gnode
      */
     py::class_<t_gnode, std::shared_ptr<t_gnode>>(m, "t_gnode")
-        .def("get_id", reinterpret_cast<t_uindex (t_gnode::*)() const>(&t_gnode::get_id));
+        .def("get_id", reinterpret_cast<t_uindex (t_gnode::*)() const>(&t_gnode::get_id))
+        .def("get_allocator", &t_gnode::get_allocator);
+
+    /******************************************************************************
+     *
+     * t_allocator
+     */
+    py::class_<t_allocator, std::shared_ptr<t_allocator>>(m, "t_allocator")
+        .def("name", &t_allocator::name)
+        .def("reserved_nbytes", &t_allocator::reserved_nbytes);
 
     /******************************************************************************
      *
@@ -219,6 +445,7 @@ PYBIND11_MODULE(libbinding, m)
         .def("get_slice", &t_data_slice<t_ctx1>::get_slice)
         .def("get_column_names", &t_data_slice<t_ctx1>::get_column_names)
         .def("get_row_path", &t_data_slice<t_ctx1>::get_row_path)
+        .def("get_row_paths", &t_data_slice<t_ctx1>::get_row_paths)
         .def("get_pkeys", &t_data_slice<t_ctx1>::get_pkeys);
 
     py::class_<t_data_slice<t_ctx2>, std::shared_ptr<t_data_slice<t_ctx2>>>(m, "t_data_slice_ctx2")
@@ -226,8 +453,29 @@ PYBIND11_MODULE(libbinding, m)
         .def("get_slice", &t_data_slice<t_ctx2>::get_slice)
         .def("get_column_names", &t_data_slice<t_ctx2>::get_column_names)
         .def("get_row_path", &t_data_slice<t_ctx2>::get_row_path)
+        .def("get_row_paths", &t_data_slice<t_ctx2>::get_row_paths)
         .def("get_pkeys", &t_data_slice<t_ctx2>::get_pkeys);
 
+    /******************************************************************************
+     *
+     * t_row_paths
+     */
+    py::class_<t_row_paths>(m, "t_row_paths")
+        .def("size", &t_row_paths::size)
+        .def("get_values", &t_row_paths::get_values)
+        .def("get_depths", &t_row_paths::get_depths)
+        .def("get_shared", &t_row_paths::get_shared)
+        .def("get_ids", &t_row_paths::get_ids);
+
+    /******************************************************************************
+     *
+     * t_arrow_buffer
+     */
+    py::class_<t_arrow_buffer>(m, "t_arrow_buffer", py::buffer_protocol())
+        .def_buffer(&t_arrow_buffer::get_buffer_info)
+        .def("__len__", &t_arrow_buffer::size)
+        .def("to_bytes", &t_arrow_buffer::to_bytes);
+
     /******************************************************************************
      *
      * t_ctx0
@@ -247,6 +495,21 @@ PYBIND11_MODULE(libbinding, m)
     py::class_<t_ctx2>(m, "t_ctx2");
 
 
+    /******************************************************************************
+     *
+     * t_scheduler
+     */
+    py::class_<t_scheduler, std::shared_ptr<t_scheduler>>(m, "t_scheduler")
+        .def(py::init<>())
+        .def("set_num_threads", &t_scheduler::set_num_threads)
+        .def("get_num_threads", &t_scheduler::get_num_threads)
+        .def("set_affinity", &t_scheduler::set_affinity)
+        .def("get_affinity", &t_scheduler::get_affinity)
+        .def("set_numa_node", &t_scheduler::set_numa_node)
+        .def("get_numa_node", &t_scheduler::get_numa_node)
+        .def("is_inline", &t_scheduler::is_inline)
+        .def("max_concurrency", &t_scheduler::max_concurrency);
+
     /******************************************************************************
      *
      * t_pool
@@ -254,8 +517,23 @@ PYBIND11_MODULE(libbinding, m)
     py::class_<t_pool, std::shared_ptr<t_pool>>(m, "t_pool")
         .def(py::init<>())
         .def("set_update_delegate", &t_pool::set_update_delegate)
+        .def("init", &t_pool::init)
+        .def("stop", &t_pool::stop, py::call_guard<py::gil_scoped_release>())
         .def("unregister_gnode", &t_pool::unregister_gnode)
-        .def("_process", &t_pool::_process);
+        .def("set_scheduler", &t_pool::set_scheduler)
+        .def("get_scheduler", &t_pool::get_scheduler)
+        .def("set_num_threads", &t_pool::set_num_threads)
+        .def("get_num_threads", &t_pool::get_num_threads)
+        .def("set_notify_threads", &t_pool::set_notify_threads)
+        .def("get_notify_threads", &t_pool::get_notify_threads)
+        .def("set_coalesce_policy", &t_pool::set_coalesce_policy)
+        .def("get_coalesce_max_rows", &t_pool::get_coalesce_max_rows)
+        .def("get_coalesce_max_wait", &t_pool::get_coalesce_max_wait)
+        .def("is_coalescing", &t_pool::is_coalescing)
+        .def("get_process_delay", &t_pool::get_process_delay)
+        .def("get_pending_rows", &t_pool::get_pending_rows)
+        .def("should_process", &t_pool::should_process)
+        .def("_process", &t_pool::_process, py::call_guard<py::gil_scoped_release>());
 
     /******************************************************************************
      *
@@ -354,34 +632,112 @@ PYBIND11_MODULE(libbinding, m)
         .value("OP_DELETE", OP_DELETE)
         .value("OP_CLEAR", OP_CLEAR);
 
+    /******************************************************************************
+     *
+     * t_ctx_priority
+     */
+    py::enum_<t_ctx_priority>(m, "t_ctx_priority")
+        .value("CTX_PRIORITY_VISIBLE", CTX_PRIORITY_VISIBLE)
+        .value("CTX_PRIORITY_BACKGROUND", CTX_PRIORITY_BACKGROUND)
+        .value("CTX_PRIORITY_PAUSED", CTX_PRIORITY_PAUSED);
+
+    /******************************************************************************
+     *
+     * t_isa
+     */
+    py::enum_<t_isa>(m, "t_isa")
+        .value("ISA_DEFAULT", ISA_DEFAULT)
+        .value("ISA_AVX2", ISA_AVX2)
+        .value("ISA_AVX512", ISA_AVX512);
+
     /******************************************************************************
      *
      * Perspective defs
      */
     m.def("str_to_filter_op", &str_to_filter_op);
     m.def("make_table", &make_table_py);
+    m.def("remove_where", &remove_where_py);
+    m.def("make_replica", &make_replica_py);
+    m.def("get_replication_snapshot", &get_replication_snapshot_py);
+    m.def("take_replication_batches", &take_replication_batches_py);
+    m.def("make_data_generator", &make_data_generator<t_val>);
+    m.def("get_default_scheduler", &t_scheduler::get_default);
+    m.def("make_allocator", &t_allocator::make);
+    m.def("get_default_allocator", &t_allocator::get_default);
+    m.def("set_default_allocator", &t_allocator::set_default);
+    m.def("str_to_isa", &str_to_isa);
+    m.def("get_isa", &get_isa);
+    m.def("get_detected_isa", &get_detected_isa);
+    m.def("set_isa", &set_isa);
+    m.def("get_num_numa_nodes", &get_num_numa_nodes);
+    m.def("get_numa_node_cpus", &get_numa_node_cpus);
     m.def("make_view_zero", &make_view_ctx0);
     m.def("make_view_one", &make_view_ctx1);
     m.def("make_view_two", &make_view_ctx2);
+    m.def("estimate_view_cost", &estimate_view_cost);
+    m.def("make_totals", &make_totals);
+    m.def("get_totals_values", &get_totals_values);
+    m.def("unregister_totals", &unregister_totals);
+    m.def("make_grouped_pkey_context", &make_grouped_pkey_context);
+    m.def("get_grouped_pkey_data", &get_grouped_pkey_data);
+    m.def("unregister_grouped_pkey_context", &unregister_grouped_pkey_context);
     m.def("get_data_slice_zero", &get_data_slice_ctx0);
     m.def("get_from_data_slice_zero", &get_from_data_slice_ctx0);
     m.def("get_pkeys_from_data_slice_zero", &get_pkeys_from_data_slice_ctx0);
+    m.def("get_column_from_data_slice_zero", &get_column_from_data_slice_ctx0);
     m.def("get_data_slice_one", &get_data_slice_ctx1);
     m.def("get_from_data_slice_one", &get_from_data_slice_ctx1);
     m.def("get_pkeys_from_data_slice_one", &get_pkeys_from_data_slice_ctx1);
+    m.def("get_column_from_data_slice_one", &get_column_from_data_slice_ctx1);
     m.def("get_data_slice_two", &get_data_slice_ctx2);
     m.def("get_from_data_slice_two", &get_from_data_slice_ctx2);
     m.def("get_pkeys_from_data_slice_two", &get_pkeys_from_data_slice_ctx2);
+    m.def("get_column_from_data_slice_two", &get_column_from_data_slice_ctx2);
     m.def("to_arrow_zero", &to_arrow_zero);
     m.def("to_arrow_one", &to_arrow_one);
     m.def("to_arrow_two", &to_arrow_two);
+    m.def("to_parquet_zero", &to_parquet_zero);
+    m.def("to_parquet_one", &to_parquet_one);
+    m.def("to_parquet_two", &to_parquet_two);
+    m.def("to_arrow_chunked_zero", &to_arrow_chunked_zero);
+    m.def("to_arrow_chunked_one", &to_arrow_chunked_one);
+    m.def("to_arrow_chunked_two", &to_arrow_chunked_two);
+    m.def("cursor_to_arrow_zero", &cursor_to_arrow_zero);
+    m.def("cursor_to_arrow_one", &cursor_to_arrow_one);
+    m.def("cursor_to_arrow_two", &cursor_to_arrow_two);
     m.def("get_row_delta_zero", &get_row_delta_zero);
     m.def("get_row_delta_one", &get_row_delta_one);
     m.def("get_row_delta_two", &get_row_delta_two);
+    m.def("compress_arrow", &compress_arrow);
+    m.def("encode_sort_key", &encode_sort_key_py);
+    m.def("cmp_sort_values", &cmp_sort_values_py);
+    m.def("is_arrow_compression_available", &is_arrow_compression_available);
+    m.def("get_histogram_zero", &get_histogram_zero);
+    m.def("get_histogram_one", &get_histogram_one);
+    m.def("get_histogram_two", &get_histogram_two);
+    m.def("get_min_max_zero", &get_min_max_zero);
+    m.def("get_min_max_one", &get_min_max_one);
+    m.def("get_min_max_two", &get_min_max_two);
     m.def("get_table_computed_schema", &get_table_computed_schema_py);
     m.def("get_computation_input_types", &get_computation_input_types);
     m.def("get_computed_functions", &get_computed_functions);
     m.def("make_computations", &make_computations);
+    m.def("register_reducer", &register_reducer_py);
+    m.def("unregister_reducer", &unregister_reducer_py);
+    m.def("set_tracing_enabled", &t_tracer::set_enabled);
+    m.def("is_tracing_enabled", &t_tracer::is_enabled);
+    m.def("get_trace", &t_tracer::to_chrome_json);
+    m.def("clear_trace", &t_tracer::clear);
+    m.def("set_profiling_enabled", &t_profiler::set_enabled);
+    m.def("is_profiling_enabled", &t_profiler::is_enabled);
+    m.def("get_profile", &t_profiler::get_profile);
+    m.def("get_profile_ticks", &t_profiler::get_ticks);
+    m.def("get_profile_interval_us", &t_profiler::get_interval_us);
+    m.def("clear_profile", &t_profiler::clear);
+    m.def("set_alloc_stats_enabled", &t_alloc_stats::set_enabled);
+    m.def("is_alloc_stats_enabled", &t_alloc_stats::is_enabled);
+    m.def("get_alloc_stats", &t_alloc_stats::get_stats);
+    m.def("reset_alloc_stats", &t_alloc_stats::reset);
 }
 
 #endif
@@ -36,6 +36,20 @@ get_table_computed_schema_py(
     std::shared_ptr<Table> table,
     t_val p_computed_columns);
 
+/**
+ * @brief Register the Python callable `fn` as the reducer `name` of
+ * `["reducer", name]` aggregates. It is called once per update with a float64
+ * array of the leaf values of every updated node, end to end, and a uint64
+ * array of the offset at which each node's values begin, followed by their
+ * total length, and returns a sequence of each node's aggregate.
+ *
+ * @param name
+ * @param fn
+ */
+void register_reducer_py(const std::string& name, t_val fn);
+
+void unregister_reducer_py(const std::string& name);
+
 } //namespace binding
 } //namespace perspective
 
@@ -11,6 +11,7 @@
 
 #include <perspective/base.h>
 #include <perspective/binding.h>
+#include <perspective/context_grouped_pkey.h>
 #include <perspective/python/base.h>
 
 namespace perspective {
@@ -22,15 +23,33 @@ namespace binding {
  */
 template <>
 std::shared_ptr<t_ctx0>
-make_context(std::shared_ptr<Table> table, std::shared_ptr<t_schema> schema, std::shared_ptr<t_view_config> view_config, const std::string& name);
+make_context(std::shared_ptr<Table> table, std::shared_ptr<t_schema> schema, std::shared_ptr<t_view_config> view_config, const std::string& name, bool deferred);
 
 template <>
 std::shared_ptr<t_ctx1>
-make_context(std::shared_ptr<Table> table, std::shared_ptr<t_schema> schema, std::shared_ptr<t_view_config> view_config, const std::string& name);
+make_context(std::shared_ptr<Table> table, std::shared_ptr<t_schema> schema, std::shared_ptr<t_view_config> view_config, const std::string& name, bool deferred);
 
 template <>
 std::shared_ptr<t_ctx2>
-make_context(std::shared_ptr<Table> table, std::shared_ptr<t_schema> schema, std::shared_ptr<t_view_config> view_config, const std::string& name);
+make_context(std::shared_ptr<Table> table, std::shared_ptr<t_schema> schema, std::shared_ptr<t_view_config> view_config, const std::string& name, bool deferred);
+
+/**
+ * @brief Make a grouped-pkey context of `table` over `columns`, with rows
+ * nested by `parent` referencing `child` and labelled by `label` (if not
+ * empty), registered on its gnode under `name`.
+ */
+std::shared_ptr<t_ctx_grouped_pkey> make_grouped_pkey_context(std::shared_ptr<Table> table,
+    const std::string& name, const std::vector<std::string>& columns,
+    const std::string& parent, const std::string& child, const std::string& label);
+
+/**
+ * @brief Returns a list of the rows of `ctx`, each a list of its label
+ * followed by its `columns`, read while the gnode of `table` is locked.
+ */
+t_val get_grouped_pkey_data(
+    std::shared_ptr<Table> table, std::shared_ptr<t_ctx_grouped_pkey> ctx);
+
+void unregister_grouped_pkey_context(std::shared_ptr<Table> table, const std::string& name);
 
 } //namespace binding
 } //namespace perspective
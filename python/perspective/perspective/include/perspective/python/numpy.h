@@ -36,7 +36,8 @@ namespace numpy {
     };
 
     /**
-     * NumpyLoader fast-tracks the loading of Numpy arrays into Perspective, utilizing memcpy whenever possible.
+     * NumpyLoader fast-tracks the loading of Numpy arrays into Perspective, borrowing or copying arrays wholesale
+     * whenever possible.
      */
     class PERSPECTIVE_BINDING_EXPORT NumpyLoader {
         public:
@@ -67,9 +68,10 @@ namespace numpy {
                 std::uint32_t offset, std::uint32_t limit, bool is_update);
 
             /**
-             * Fill a column with a Numpy array by copying it wholesale into the column without iteration.
+             * Fill a column with a Numpy array without calling into Python for each value: an array of the column's
+             * dtype is borrowed or copied wholesale, and an array of another numeric dtype is cast in a single pass.
              * 
-             * If the copy operation fails, fill the column iteratively.
+             * If none of these apply, fill the column iteratively.
              * 
              * @param tbl
              * @param col
@@ -103,8 +105,8 @@ namespace numpy {
             template <typename T>
             void fill_object_iter(t_data_table& tbl, std::shared_ptr<t_column> col, const std::string& name, t_dtype np_dtype, t_dtype type, std::uint32_t cidx, bool is_update);
 
-            // Fill dates that might be `datetime.date` or strings
-            void fill_date_iter(std::shared_ptr<t_column> col, const std::string& name, t_dtype np_dtype, t_dtype type, std::uint32_t cidx, bool is_update);
+            // Fill dates from `datetime64` arrays, or from values that might be `datetime.date` or strings
+            void fill_date_iter(const py::array& array, std::shared_ptr<t_column> col, const std::string& name, t_dtype np_dtype, t_dtype type, std::uint32_t cidx, bool is_update);
 
             // Fill using numpy arrays with defined numpy dtypes that are not `object`
 
@@ -122,21 +124,43 @@ namespace numpy {
             
             void fill_bool_iter(const py::array& array, t_data_table& tbl, std::shared_ptr<t_column> col, const std::string& name, t_dtype np_dtype, t_dtype type, std::uint32_t cidx, bool is_update);
 
+            /**
+             * Fill a string column from the codes and categories of a `pandas.Categorical`, interning each category into the
+             * column's vocabulary once and then remapping the codes to their ids. Codes of -1 are null.
+             */
+            void fill_categorical(std::shared_ptr<t_column> col, const py::array& codes, const py::list& categories, bool is_update);
+
             /**
              * Extract a numpy array from src and copy it into dest.
              * 
-             * If `np_dtype` and `type` mismatch in the following cases, then fill iteratively:
-             * 
-             * - when `np_dtype` is int64 and `t_dtype` is `DTYPE_INT32` or `DTYPE_FLOAT64`
-             * - when `np_dtype` is float64 and `t_dtype` is `DTYPE_INT32` or `DTYPE_INT64`
-             * 
-             * These errors occur frqeuently when a Table is created from non-numpy data, then updated with a numpy array.
-             * The `t_dtype` of the Table always supercedes the array dtype, as the table is immutable after creation.
+             * Numeric arrays whose `np_dtype` and `type` mismatch are cast by `fill_numeric_convert` instead, as
+             * the `t_dtype` of the Table always supercedes the array dtype.
              * 
              * Returns a `t_fill_status` enum indicating success or failure of the copy operation.
              */
             t_fill_status try_copy_array(const py::array& src, std::shared_ptr<t_column> dest, t_dtype np_dtype, t_dtype type, const std::uint64_t offset);
 
+            /**
+             * Point `dest` at the memory of `src` instead of copying it, keeping `src` alive until the column is
+             * written to or destroyed; see `t_column::borrow_data`. `src` must be C-contiguous, of the same width
+             * as `type` and without nulls, as clearing a null would copy it anyway. Returns false if `src` must be
+             * copied.
+             *
+             * The column reads the array as it is when the table processes the update, so it should not be modified
+             * before then.
+             */
+            bool try_borrow_array(const py::array& src, std::shared_ptr<t_column> dest, t_dtype type, std::size_t mask_size);
+
+            /**
+             * Cast a C-contiguous numeric array of `np_dtype` into a column of numeric `type`, in one pass and without
+             * marshalling through Python. Nulls are left for `fill_validity_map`. As with `fill_object_iter`, an int32
+             * column that cannot hold the values is promoted to float64, except on update.
+             *
+             * Returns `FILL_FAIL` if either dtype is not numeric.
+             */
+            t_fill_status fill_numeric_convert(const py::array& array, t_data_table& tbl, std::shared_ptr<t_column> col,
+                const std::string& name, t_dtype np_dtype, t_dtype type, bool is_update);
+
             void fill_validity_map(std::shared_ptr<t_column> col, std::uint64_t* mask_ptr, std::size_t mask_size, bool is_update);
 
             // Return the column names from the Python data accessor
@@ -49,6 +49,24 @@ std::vector<t_val> get_pkeys_from_data_slice_ctx0(std::shared_ptr<t_data_slice<t
 std::vector<t_val> get_pkeys_from_data_slice_ctx1(std::shared_ptr<t_data_slice<t_ctx1>> data_slice, t_uindex ridx, t_uindex cidx);
 std::vector<t_val> get_pkeys_from_data_slice_ctx2(std::shared_ptr<t_data_slice<t_ctx2>> data_slice, t_uindex ridx, t_uindex cidx);
 
+/**
+ * @brief Copy column `cidx` of the rows `[start_row, end_row)` of a data
+ * slice into a single numpy array, without creating a Python object per
+ * value. Returns a tuple of the array and, for string columns, a list of
+ * categories which the array holds the codes of, -1 being null. Numeric nulls
+ * are NaN, and datetime nulls NaT; columns that cannot be typed, such as
+ * booleans with nulls, are returned as a list of Python values.
+ */
+template <typename CTX_T>
+py::tuple get_column_from_data_slice(std::shared_ptr<t_data_slice<CTX_T>> data_slice,
+    t_uindex cidx, t_uindex start_row, t_uindex end_row);
+py::tuple get_column_from_data_slice_ctx0(std::shared_ptr<t_data_slice<t_ctx0>> data_slice,
+    t_uindex cidx, t_uindex start_row, t_uindex end_row);
+py::tuple get_column_from_data_slice_ctx1(std::shared_ptr<t_data_slice<t_ctx1>> data_slice,
+    t_uindex cidx, t_uindex start_row, t_uindex end_row);
+py::tuple get_column_from_data_slice_ctx2(std::shared_ptr<t_data_slice<t_ctx2>> data_slice,
+    t_uindex cidx, t_uindex start_row, t_uindex end_row);
+
 } // end namespace binding
 } // end namespace perspective
 
@@ -20,7 +20,22 @@ namespace binding {
  *
  * Table API
  */
-std::shared_ptr<Table> make_table_py(t_val table, t_data_accessor accessor, std::uint32_t limit, py::str index, t_op op, bool is_update, bool is_arrow, t_uindex port_id);
+std::shared_ptr<Table> make_table_py(t_val table, t_data_accessor accessor, std::uint32_t limit, py::str index, t_op op, bool is_update, bool is_arrow, t_uindex port_id, std::vector<std::string> columns);
+
+/**
+ * @brief Remove the rows of `table` which pass the filters of the Python
+ * `ViewConfig` `view_config`, parsed as a view's are.
+ */
+t_uindex remove_where_py(std::shared_ptr<Table> table, t_val view_config, t_val date_parser, t_uindex port_id);
+
+/**
+ * @brief Create a replica, on a pool of its own, from the snapshot of
+ * another table's `get_replication_snapshot`.
+ */
+std::shared_ptr<Table> make_replica_py(py::bytes snapshot);
+
+py::bytes get_replication_snapshot_py(std::shared_ptr<Table> table);
+std::vector<py::bytes> take_replication_batches_py(std::shared_ptr<Table> table);
 
 } //namespace binding
 } //namespace perspective
@@ -45,6 +45,25 @@ t_dtype type_string_to_t_dtype(py::str type, py::str name = "");
 
 t_val scalar_to_py(const t_tscalar& scalar, bool cast_double = false, bool cast_string = false);
 
+/******************************************************************************
+ *
+ * Sort keys
+ */
+
+/**
+ * @brief Returns the key `append_sort_key` encodes for the sort values `row`
+ * and primary key `pkey`, each a Python `None`, `bool`, `int`, `float` or
+ * `str`, sorted by `orders` ("asc" or "desc").
+ */
+py::bytes encode_sort_key_py(t_val row, t_val pkey, std::vector<std::string> orders);
+
+/**
+ * @brief Returns whether `cmp_sort_values` sorts `a_row` and `a_pkey` before
+ * `b_row` and `b_pkey`, converted as by `encode_sort_key_py`.
+ */
+bool cmp_sort_values_py(t_val a_row, t_val a_pkey, t_val b_row, t_val b_pkey,
+    std::vector<std::string> orders);
+
 } //namespace binding
 } //namespace perspective
 
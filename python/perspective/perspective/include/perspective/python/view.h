@@ -28,41 +28,194 @@ template <>
 std::tuple<std::string, std::string, std::vector<t_tscalar>>
 make_filter_term(t_dtype column_type, t_val date_parser, const std::string& column_name, const std::string& filter_op_str, t_val filter_term);
 
+/**
+ * @brief Returns whether `filter`, an item of a view's `filter`, is an
+ * `and`/`or` group or a comparison of two columns, which filter by a
+ * `t_fexpr` rather than by a term.
+ */
+bool is_filter_expr(t_val filter);
+
+/**
+ * @brief Make the `t_fexpr` of `filter`, an item of a view's `filter`.
+ * Returns false for terms which are not valid filters, which views drop.
+ */
+bool make_filter_expr(std::shared_ptr<t_schema> schema, t_val date_parser, t_val filter, t_fexpr& out);
+
 template <>
 std::shared_ptr<t_view_config> make_view_config(std::shared_ptr<t_schema> schema, t_val date_parser, t_val config);
 
 template <typename CTX_T>
-std::shared_ptr<View<CTX_T>> make_view(std::shared_ptr<Table> table, const std::string& name, const std::string& separator, t_val view_config, t_val date_parser);
+std::shared_ptr<View<CTX_T>> make_view(std::shared_ptr<Table> table, const std::string& name, const std::string& separator, t_val view_config, t_val date_parser, bool deferred);
+
+std::shared_ptr<View<t_ctx0>> make_view_ctx0(std::shared_ptr<Table> table, std::string name, std::string separator, t_val view_config, t_val date_parser, bool deferred);
+std::shared_ptr<View<t_ctx1>> make_view_ctx1(std::shared_ptr<Table> table, std::string name, std::string separator, t_val view_config, t_val date_parser, bool deferred);
+std::shared_ptr<View<t_ctx2>> make_view_ctx2(std::shared_ptr<Table> table, std::string name, std::string separator, t_val view_config, t_val date_parser, bool deferred);
+
+/**
+ * @brief Estimate the cost of a view of `table` with `view_config` without
+ * creating it; see `Table::estimate_view_cost`.
+ */
+std::map<std::string, double> estimate_view_cost(std::shared_ptr<Table> table, t_val view_config, t_val date_parser);
+
+/**
+ * @brief Make a totals context of `table` with the aggregates and filters of
+ * `view_config`, registered on its gnode under `name`.
+ */
+std::shared_ptr<t_ctx_totals> make_totals(std::shared_ptr<Table> table, const std::string& name, t_val view_config, t_val date_parser);
+
+/**
+ * @brief Returns a dict of the totals of `totals`, read while the gnode of
+ * `table` is locked.
+ */
+t_val get_totals_values(std::shared_ptr<Table> table, std::shared_ptr<t_ctx_totals> totals);
+void unregister_totals(std::shared_ptr<Table> table, const std::string& name);
 
-std::shared_ptr<View<t_ctx0>> make_view_ctx0(std::shared_ptr<Table> table, std::string name, std::string separator, t_val view_config, t_val date_parser);
-std::shared_ptr<View<t_ctx1>> make_view_ctx1(std::shared_ptr<Table> table, std::string name, std::string separator, t_val view_config, t_val date_parser);
-std::shared_ptr<View<t_ctx2>> make_view_ctx2(std::shared_ptr<Table> table, std::string name, std::string separator, t_val view_config, t_val date_parser);
+/**
+ * @brief A serialized Arrow handed to Python without copying it into `bytes`.
+ * It owns the stream `View::to_arrow` returned and exposes it through the
+ * buffer protocol, so `memoryview`, `pyarrow.py_buffer` and the `pyarrow.ipc`
+ * readers read it in place, and record batches read from it share its memory
+ * for as long as they hold the view of it.
+ */
+class t_arrow_buffer {
+public:
+    explicit t_arrow_buffer(std::shared_ptr<std::string> arrow);
+
+    std::size_t size() const;
+
+    /**
+     * @brief A copy of the stream as `bytes`, for callers which need one.
+     */
+    py::bytes to_bytes() const;
 
-py::bytes to_arrow_zero(
+    /**
+     * @brief The stream as a one-dimensional buffer of bytes. The buffer is
+     * the only owner of the stream, so writes through it are not seen by the
+     * view that serialized it.
+     */
+    py::buffer_info get_buffer_info() const;
+
+private:
+    std::shared_ptr<std::string> m_arrow;
+};
+
+t_arrow_buffer to_arrow_zero(
     std::shared_ptr<View<t_ctx0>> view,
     std::int32_t start_row, 
     std::int32_t end_row,
     std::int32_t start_col, 
     std::int32_t end_col);
 
-py::bytes to_arrow_one(
+t_arrow_buffer to_arrow_one(
     std::shared_ptr<View<t_ctx1>> view,
     std::int32_t start_row, 
     std::int32_t end_row,
     std::int32_t start_col, 
     std::int32_t end_col);
 
-py::bytes to_arrow_two(
+t_arrow_buffer to_arrow_two(
     std::shared_ptr<View<t_ctx2>> view,
     std::int32_t start_row, 
     std::int32_t end_row,
     std::int32_t start_col, 
     std::int32_t end_col);
 
+py::bytes to_parquet_zero(
+    std::shared_ptr<View<t_ctx0>> view,
+    std::int32_t start_row,
+    std::int32_t end_row,
+    std::int32_t start_col,
+    std::int32_t end_col,
+    std::int32_t row_group_size);
+
+py::bytes to_parquet_one(
+    std::shared_ptr<View<t_ctx1>> view,
+    std::int32_t start_row,
+    std::int32_t end_row,
+    std::int32_t start_col,
+    std::int32_t end_col,
+    std::int32_t row_group_size);
+
+py::bytes to_parquet_two(
+    std::shared_ptr<View<t_ctx2>> view,
+    std::int32_t start_row,
+    std::int32_t end_row,
+    std::int32_t start_col,
+    std::int32_t end_col,
+    std::int32_t row_group_size);
+
+void to_arrow_chunked_zero(
+    std::shared_ptr<View<t_ctx0>> view,
+    std::int32_t start_row,
+    std::int32_t end_row,
+    std::int32_t start_col,
+    std::int32_t end_col,
+    std::int32_t chunk_size,
+    py::function callback);
+
+void to_arrow_chunked_one(
+    std::shared_ptr<View<t_ctx1>> view,
+    std::int32_t start_row,
+    std::int32_t end_row,
+    std::int32_t start_col,
+    std::int32_t end_col,
+    std::int32_t chunk_size,
+    py::function callback);
+
+void to_arrow_chunked_two(
+    std::shared_ptr<View<t_ctx2>> view,
+    std::int32_t start_row,
+    std::int32_t end_row,
+    std::int32_t start_col,
+    std::int32_t end_col,
+    std::int32_t chunk_size,
+    py::function callback);
+
+py::object cursor_to_arrow_zero(
+    std::shared_ptr<View<t_ctx0>> view, std::int32_t cursor_id, std::int32_t page_size);
+py::object cursor_to_arrow_one(
+    std::shared_ptr<View<t_ctx1>> view, std::int32_t cursor_id, std::int32_t page_size);
+py::object cursor_to_arrow_two(
+    std::shared_ptr<View<t_ctx2>> view, std::int32_t cursor_id, std::int32_t page_size);
+
 py::bytes get_row_delta_zero(std::shared_ptr<View<t_ctx0>> view);
 py::bytes get_row_delta_one(std::shared_ptr<View<t_ctx1>> view);
 py::bytes get_row_delta_two(std::shared_ptr<View<t_ctx2>> view);
 
+/**
+ * @brief Compress a serialized Arrow with the named compression, "lz4" or
+ * "zstd", for readers such as `Table` that understand the framing of
+ * `arrow::compress_arrow`.
+ */
+py::bytes compress_arrow(py::bytes arrow, const std::string& compression);
+
+/**
+ * @brief Whether the named compression can be used in this build.
+ */
+bool is_arrow_compression_available(const std::string& compression);
+
+/**
+ * @brief Bin a column of the view, returning a list of dicts with the
+ * `begin`, `end` and `count` of each bucket.
+ */
+py::list get_histogram_zero(std::shared_ptr<View<t_ctx0>> view,
+    const std::string& column_name, std::uint32_t nbuckets, bool quantile, std::int32_t ridx);
+py::list get_histogram_one(std::shared_ptr<View<t_ctx1>> view,
+    const std::string& column_name, std::uint32_t nbuckets, bool quantile, std::int32_t ridx);
+py::list get_histogram_two(std::shared_ptr<View<t_ctx2>> view,
+    const std::string& column_name, std::uint32_t nbuckets, bool quantile, std::int32_t ridx);
+
+/**
+ * @brief The min and max of a column of the view, as a dict with `min` and
+ * `max`.
+ */
+py::dict get_min_max_zero(
+    std::shared_ptr<View<t_ctx0>> view, const std::string& column_name, std::int32_t ridx);
+py::dict get_min_max_one(
+    std::shared_ptr<View<t_ctx1>> view, const std::string& column_name, std::int32_t ridx);
+py::dict get_min_max_two(
+    std::shared_ptr<View<t_ctx2>> view, const std::string& column_name, std::int32_t ridx);
+
 
 } //namespace binding
 } //namespace perspective
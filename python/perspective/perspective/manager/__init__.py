@@ -8,5 +8,9 @@
 
 from .manager import PerspectiveManager  # noqa: F401
 from .session import PerspectiveSession  # noqa: F401
+from .sharded_table import PerspectiveShardedTable, PerspectiveShardedView  # noqa: F401
+from ._shared_memory import read_shared_memory  # noqa: F401
 
-__all__ = ["PerspectiveManager", "PerspectiveSession"]
+__all__ = ["PerspectiveManager", "PerspectiveSession",
+           "PerspectiveShardedTable", "PerspectiveShardedView",
+           "read_shared_memory"]
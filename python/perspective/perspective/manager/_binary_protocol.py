@@ -0,0 +1,190 @@
+################################################################################
+#
+# Copyright (c) 2020, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+"""The binary protocol a :obj:`~perspective.PerspectiveManager` and a client
+may negotiate in place of JSON messages, which is the subset of MessagePack
+(https://msgpack.org) that JSON values and binaries need: nil, booleans,
+integers, doubles, strings, binaries, arrays and maps. A message's binary
+payload, e.g. an Arrow, is a field of the message itself, rather than a
+second message announced by the first.
+"""
+
+import datetime
+import struct
+import six
+from ..core.exception import PerspectiveError
+from ..table._date_validator import _PerspectiveDateValidator
+
+_date_validator = _PerspectiveDateValidator()
+
+
+def _pack_length(out, length, tags):
+    '''Write the tag and length of a string, binary, array or map, where
+    `tags` are its 8, 16 and 32 bit tags, or `None` for no 8 bit tag.'''
+    if tags[0] is not None and length < 0x100:
+        out.append(struct.pack(">BB", tags[0], length))
+    elif length < 0x10000:
+        out.append(struct.pack(">BH", tags[1], length))
+    else:
+        out.append(struct.pack(">BI", tags[2], length))
+
+
+def _pack(obj, out):
+    if obj is None:
+        out.append(b"\xc0")
+    elif obj is True:
+        out.append(b"\xc3")
+    elif obj is False:
+        out.append(b"\xc2")
+    elif isinstance(obj, six.integer_types):
+        if 0 <= obj < 0x80:
+            out.append(struct.pack(">B", obj))
+        elif -0x20 <= obj < 0:
+            out.append(struct.pack(">b", obj))
+        elif -0x80000000 <= obj < 0x80000000:
+            out.append(struct.pack(">Bi", 0xd2, obj))
+        elif -0x8000000000000000 <= obj < 0x8000000000000000:
+            out.append(struct.pack(">Bq", 0xd3, obj))
+        elif 0 <= obj < 0x10000000000000000:
+            out.append(struct.pack(">BQ", 0xcf, obj))
+        else:
+            raise PerspectiveError("Cannot encode integer `{}`".format(obj))
+    elif isinstance(obj, float):
+        out.append(struct.pack(">Bd", 0xcb, obj))
+    elif isinstance(obj, datetime.datetime):
+        _pack(_date_validator.to_timestamp(obj), out)
+    elif isinstance(obj, six.text_type):
+        encoded = obj.encode("utf-8")
+        if len(encoded) < 0x20:
+            out.append(struct.pack(">B", 0xa0 | len(encoded)))
+        else:
+            _pack_length(out, len(encoded), (0xd9, 0xda, 0xdb))
+        out.append(encoded)
+    elif isinstance(obj, (bytes, bytearray, memoryview)):
+        _pack_length(out, len(obj), (0xc4, 0xc5, 0xc6))
+        out.append(bytes(obj))
+    elif isinstance(obj, (list, tuple)):
+        if len(obj) < 0x10:
+            out.append(struct.pack(">B", 0x90 | len(obj)))
+        else:
+            _pack_length(out, len(obj), (None, 0xdc, 0xdd))
+        for item in obj:
+            _pack(item, out)
+    elif isinstance(obj, dict):
+        if len(obj) < 0x10:
+            out.append(struct.pack(">B", 0x80 | len(obj)))
+        else:
+            _pack_length(out, len(obj), (None, 0xde, 0xdf))
+        for key, value in six.iteritems(obj):
+            _pack(six.text_type(key), out)
+            _pack(value, out)
+    else:
+        raise PerspectiveError(
+            "Cannot encode `{}` in a binary message".format(type(obj).__name__))
+
+
+def encode(obj):
+    '''Encode `obj`, a JSON-serializable value that may contain `bytes`, as a
+    binary message.'''
+    out = []
+    _pack(obj, out)
+    return b"".join(out)
+
+
+def encode_messages(messages):
+    '''Returns the encoded `messages` as one encoded array of them, without
+    decoding them, so that a frame of several messages is written at once.'''
+    out = []
+    if len(messages) < 0x10:
+        out.append(struct.pack(">B", 0x90 | len(messages)))
+    else:
+        _pack_length(out, len(messages), (None, 0xdc, 0xdd))
+    out.extend(bytes(message) for message in messages)
+    return b"".join(out)
+
+
+# The `struct` format of each fixed-width MessagePack tag.
+_FIXED = {
+    0xca: ">f", 0xcb: ">d",
+    0xcc: ">B", 0xcd: ">H", 0xce: ">I", 0xcf: ">Q",
+    0xd0: ">b", 0xd1: ">h", 0xd2: ">i", 0xd3: ">q",
+}
+
+# The `struct` format of the length of each variable-width tag.
+_LENGTHS = {
+    0xc4: ">B", 0xc5: ">H", 0xc6: ">I",
+    0xd9: ">B", 0xda: ">H", 0xdb: ">I",
+    0xdc: ">H", 0xdd: ">I",
+    0xde: ">H", 0xdf: ">I",
+}
+
+
+class _Reader(object):
+
+    def __init__(self, buf):
+        self._buf = memoryview(buf)
+        self._pos = 0
+
+    def take(self, fmt):
+        value = struct.unpack_from(fmt, self._buf, self._pos)[0]
+        self._pos += struct.calcsize(fmt)
+        return value
+
+    def read(self, length):
+        if self._pos + length > len(self._buf):
+            raise PerspectiveError("Binary message is truncated")
+        value = self._buf[self._pos:self._pos + length].tobytes()
+        self._pos += length
+        return value
+
+    def unpack(self):
+        tag = self.take(">B")
+        if tag < 0x80:
+            return tag
+        elif tag >= 0xe0:
+            return tag - 0x100
+        elif tag < 0x90:
+            return self.unpack_map(tag & 0x0f)
+        elif tag < 0xa0:
+            return self.unpack_array(tag & 0x0f)
+        elif tag < 0xc0:
+            return self.read(tag & 0x1f).decode("utf-8")
+        elif tag == 0xc0:
+            return None
+        elif tag == 0xc2:
+            return False
+        elif tag == 0xc3:
+            return True
+        elif tag in _FIXED:
+            return self.take(_FIXED[tag])
+        elif tag in _LENGTHS:
+            length = self.take(_LENGTHS[tag])
+            if tag <= 0xc6:
+                return self.read(length)
+            elif tag <= 0xdb:
+                return self.read(length).decode("utf-8")
+            elif tag <= 0xdd:
+                return self.unpack_array(length)
+            return self.unpack_map(length)
+        raise PerspectiveError(
+            "Unsupported tag `{:#x}` in binary message".format(tag))
+
+    def unpack_array(self, length):
+        return [self.unpack() for _ in range(length)]
+
+    def unpack_map(self, length):
+        rval = {}
+        for _ in range(length):
+            key = self.unpack()
+            rval[key] = self.unpack()
+        return rval
+
+
+def decode(buf):
+    '''Decode a binary message into the value it encodes, with binaries
+    decoded as `bytes`.'''
+    return _Reader(buf).unpack()
@@ -0,0 +1,88 @@
+################################################################################
+#
+# Copyright (c) 2020, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+from collections import OrderedDict
+from threading import RLock
+
+
+class _PerspectiveClientQueue(object):
+    """Bounds the messages a :obj:`~perspective.PerspectiveManager` has posted
+    to one client that its transport has not yet written.
+
+    A message is pending from when it is posted until the Future returned by
+    `post_callback` resolves - e.g. Tornado's `write_message`, which resolves
+    once the message is written to the socket. A `post_callback` that returns
+    anything else is treated as having written the message immediately.
+
+    While `max_pending` messages are pending, the client is congested, and
+    each coalescable message is held instead of posted, keeping only the
+    latest for its key, until enough pending messages are written.
+    """
+
+    def __init__(self, max_pending):
+        self._max_pending = max_pending
+        self._pending = 0
+        self._held = OrderedDict()
+        self._drain_callbacks = []
+        self._lock = RLock()
+
+    def is_congested(self):
+        """Returns whether the client has `max_pending` messages pending."""
+        with self._lock:
+            return self._pending >= self._max_pending
+
+    def post(self, post, key=None):
+        """Post a message by calling `post`, which returns the results of the
+        `post_callback` calls that write it.
+
+        Args:
+            post (:obj:`callable`): posts the message.
+            key (:obj:`str`): if set, the message replaces any message with
+                the same key, and is held while the client is congested.
+        """
+        with self._lock:
+            if key is not None and (self.is_congested() or key in self._held):
+                self._held.pop(key, None)
+                self._held[key] = post
+                return
+        self._send(post)
+
+    def on_drained(self, callback):
+        """Call `callback` once the client is not congested, immediately if it
+        is not congested now."""
+        with self._lock:
+            if self.is_congested():
+                self._drain_callbacks.append(callback)
+                return
+        callback()
+
+    def _send(self, post):
+        for result in post() or []:
+            if hasattr(result, "add_done_callback"):
+                with self._lock:
+                    self._pending += 1
+                result.add_done_callback(self._on_written)
+
+    def _on_written(self, _result):
+        with self._lock:
+            self._pending -= 1
+            held = []
+            while self._held and self._pending + len(held) < self._max_pending:
+                held.append(self._held.popitem(last=False)[1])
+
+        for post in held:
+            self._send(post)
+
+        with self._lock:
+            if self.is_congested():
+                return
+            callbacks = self._drain_callbacks
+            self._drain_callbacks = []
+
+        for callback in callbacks:
+            callback()
@@ -0,0 +1,55 @@
+################################################################################
+#
+# Copyright (c) 2020, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+from ..table import Table
+
+
+def _run_shard(conn):
+    '''Serve the commands a :obj:`~perspective.PerspectiveShardedTable` sends
+    to one of its shards over `conn`, until it sends `None`.
+
+    Each shard process holds one :obj:`~perspective.Table`, i.e. its own
+    `t_gnode`, and the :obj:`~perspective.View` of each sharded view on it.
+    Every command is answered with a tuple of whether it succeeded, and its
+    result or the message of its error.
+    '''
+    table = None
+    views = {}
+    while True:
+        msg = conn.recv()
+        if msg is None:
+            break
+
+        cmd, args = msg
+        try:
+            result = None
+            if cmd == "table":
+                data, kwargs = args
+                table = Table(data, **kwargs)
+            elif cmd == "table_method":
+                method, method_args, kwargs = args
+                result = getattr(table, method)(*method_args, **kwargs)
+            elif cmd == "view":
+                view_id, config = args
+                views[view_id] = table.view(**config)
+            elif cmd == "view_method":
+                view_id, method, method_args, kwargs = args
+                result = getattr(views[view_id], method)(*method_args, **kwargs)
+            elif cmd == "view_delete":
+                view = views.pop(args, None)
+                if view is not None:
+                    view.delete()
+            conn.send((True, result))
+        except Exception as error:
+            conn.send((False, str(error)))
+
+    for view in views.values():
+        view.delete()
+    if table is not None:
+        table.delete()
+    conn.close()
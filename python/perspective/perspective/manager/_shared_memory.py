@@ -0,0 +1,115 @@
+################################################################################
+#
+# Copyright (c) 2020, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+import struct
+from threading import Lock
+from ..core.exception import PerspectiveError
+
+try:
+    from multiprocessing import shared_memory
+except ImportError:
+    shared_memory = None
+
+# The ring's header is the total bytes reserved by its writer, as a
+# little-endian `uint64`, followed by the ring's records.
+_HEADER = struct.Struct("<Q")
+
+
+def is_shared_memory_available():
+    """Returns whether this Python can create shared memory, which requires
+    Python 3.8 or later."""
+    return shared_memory is not None
+
+
+class _PerspectiveSharedMemoryRing(object):
+    """A ring of shared memory that a :obj:`~perspective.PerspectiveManager`
+    writes one client's binary messages into, so that only a descriptor of
+    each is sent over the client's socket.
+
+    Records are written at increasing positions in the stream of bytes
+    written to the ring, wrapping to its start rather than splitting a record
+    across its end. Before writing a record, the writer advances the header
+    past it, so that a reader can tell whether a record was overwritten while
+    it copied it: the record at `position` is intact while the header is no
+    more than `position` plus the ring's capacity. A client that has not read
+    a record by the time the ring wraps onto it must request it again, so the
+    ring should be large enough for the messages a client has in flight.
+    """
+
+    def __init__(self, size):
+        if size <= _HEADER.size:
+            raise PerspectiveError(
+                "`shared_memory_size` must be greater than {} bytes".format(_HEADER.size))
+        self._memory = shared_memory.SharedMemory(create=True, size=size)
+        self._capacity = size - _HEADER.size
+        self._head = 0
+        self._lock = Lock()
+        _HEADER.pack_into(self._memory.buf, 0, 0)
+
+    @property
+    def name(self):
+        return self._memory.name
+
+    def write(self, binary):
+        """Write `binary` into the ring, returning its descriptor, or `None`
+        if it is larger than the ring."""
+        length = len(binary)
+        if length > self._capacity:
+            return None
+        with self._lock:
+            position = self._head
+            offset = position % self._capacity
+            if offset + length > self._capacity:
+                position += self._capacity - offset
+                offset = 0
+            self._head = position + length
+            _HEADER.pack_into(self._memory.buf, 0, self._head)
+            start = _HEADER.size + offset
+            self._memory.buf[start:start + length] = binary
+        return {
+            "name": self.name,
+            "position": position,
+            "length": length,
+            "capacity": self._capacity
+        }
+
+    def close(self):
+        """Release and unlink the ring's shared memory."""
+        self._memory.close()
+        self._memory.unlink()
+
+
+def read_shared_memory(descriptor):
+    """Read the binary a :obj:`~perspective.PerspectiveManager` posted
+    through shared memory, from the `shared_memory` descriptor of its message.
+
+    Args:
+        descriptor (:obj:`dict`): the `shared_memory` field of the message.
+
+    Returns:
+        :obj:`bytes`: the binary, e.g. an Arrow.
+
+    Raises:
+        :obj:`PerspectiveError`: if the record was overwritten before it was
+            read, and so must be requested again.
+    """
+    if not is_shared_memory_available():
+        raise PerspectiveError("Shared memory requires Python 3.8 or later")
+    memory = shared_memory.SharedMemory(name=descriptor["name"])
+    try:
+        position = descriptor["position"]
+        capacity = descriptor["capacity"]
+        start = _HEADER.size + position % capacity
+        binary = bytes(memory.buf[start:start + descriptor["length"]])
+        (head,) = _HEADER.unpack_from(memory.buf, 0)
+    finally:
+        memory.close()
+    if head > position + capacity:
+        raise PerspectiveError(
+            "Shared memory record was overwritten before it was read")
+    return binary
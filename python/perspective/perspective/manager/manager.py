@@ -11,13 +11,20 @@ import json
 import random
 import string
 import datetime
+import threading
 from functools import partial
 from ..core.exception import PerspectiveError
 from ..table._callback_cache import _PerspectiveCallBackCache
 from ..table._date_validator import _PerspectiveDateValidator
-from ..table import Table, PerspectiveCppError
+from ..table import Table, PerspectiveCppError, get_profile
 from ..table.view import View
+from ..table.libbinding import compress_arrow, is_arrow_compression_available
+from ..table._executor import EXECUTOR
 from .session import PerspectiveSession
+from ._client_queue import _PerspectiveClientQueue
+from ._shared_memory import _PerspectiveSharedMemoryRing, is_shared_memory_available
+from . import _binary_protocol
+from .sharded_table import PerspectiveShardedTable, PerspectiveShardedView
 
 _date_validator = _PerspectiveDateValidator()
 
@@ -54,6 +61,64 @@ class PerspectiveManager(object):
         should be spawned using `new_session()`.
     - When the websocket closes, call `close()` on the session instance to
         clean up associated resources.
+
+    A manager created with `threaded=True` serializes `to_arrow` and
+    `to_parquet` calls on the engine worker threads (see
+    `perspective.set_threadpool_size`), so that one client's large export
+    does not hold up the messages of every other client. Their results are
+    posted from the worker thread, unless a loop callback is set, as
+    :obj:`~perspective.PerspectiveTornadoHandler` does.
+
+    Flow control bounds the memory held for fast producers and slow clients:
+
+    - `max_pending_rows` bounds the rows that clients' `update` calls leave
+        pending in a table, which the engine merges into one update until
+        it is processed. A client update that reaches the bound processes
+        the table at once, rather than on the next iteration of the loop.
+    - `max_pending_messages` bounds the messages posted to each session's
+        client that its transport has not written, for a `post_callback`
+        that returns a Future, as Tornado's `write_message` does. While a
+        client is at the bound, its `on_update` notifications without deltas
+        are coalesced, so that only the latest for each callback is sent
+        once it catches up, and :obj:`~perspective.PerspectiveTornadoHandler`
+        stops reading its messages. Notifications with deltas are never
+        dropped, since each holds rows the client has not seen.
+
+    A manager created with `shared_memory_size` offers clients on the same
+    host a shared memory transport: a client whose `init` message sets
+    `shared_memory` is given a ring of `shared_memory_size` bytes, named in
+    the `shared_memory` field of the response, and the Arrows of its
+    `to_arrow` calls and `on_update` row deltas are written into the ring,
+    with only a `shared_memory` descriptor of each sent over its socket, in
+    place of the binary message. These Arrows are not compressed. See
+    :func:`~perspective.read_shared_memory`.
+
+    A client whose `init` message lists "binary" in its `protocol` is sent
+    every later message in Perspective's binary protocol, a subset of
+    MessagePack, in place of JSON, including binary payloads such as Arrows,
+    which are a field of the message rather than a second message. Messages
+    from clients may be either JSON or binary, one per frame.
+
+    Unless created with `share_views=False`, a manager shares one
+    :obj:`~perspective.View` between the clients that open views of a table
+    with identical configs, so that each config is computed and updated
+    once however many clients open it. The shared view is deleted when the
+    last of its names is deleted or its clients' sessions close. A client
+    that expands, collapses or sets the depth of a shared view is given a
+    view of its own first, as these change the rows every sharer sees.
+
+    A `batch` message makes many `table_method` and `view_method` calls in
+    one round trip: they are called in order, and their results returned in
+    one message, with their binaries, such as Arrows, in one payload.
+
+    A manager created with `view_budget` estimates the cost of each view a
+    client opens before building it (see
+    :func:`~perspective.Table.estimate_view_cost`), so that one expensive
+    ad-hoc view does not hold up every update of the shared process. A view
+    above the budget is handled by the `view_admission` policy: "reject"
+    returns an error to the client, "queue" builds it progressively on a
+    worker thread after the other queued views, and "downgrade" builds it
+    progressively at once, with "background" priority.
     '''
 
     # Commands that should be blocked from execution when the manager is in
@@ -61,12 +126,72 @@ class PerspectiveManager(object):
     # modification.
     LOCKED_COMMANDS = ["table", "update", "remove", "replace", "clear"]
 
-    def __init__(self, lock=False):
+    # Arrow compressions a client may request in its `init` message, which
+    # are negotiated in the client's order of preference.
+    ARROW_COMPRESSIONS = ["zstd", "lz4"]
+
+    # Message protocols a client may request in its `init` message, besides
+    # JSON.
+    PROTOCOLS = ["binary"]
+
+    # View methods that a `threaded` manager runs on the engine worker
+    # threads, which the engine runs without the GIL.
+    THREADED_METHODS = ["to_arrow", "to_parquet", "cursor_to_arrow"]
+
+    # View methods that change the rows of the view they are called on, and
+    # so give their client a view of its own if the view is shared.
+    PRIVATE_VIEW_METHODS = ["expand", "collapse", "set_depth"]
+
+    # The policies for views above a manager's `view_budget`.
+    VIEW_ADMISSION_POLICIES = ["reject", "queue", "downgrade"]
+
+    def __init__(self, lock=False, threaded=False, max_pending_rows=None,
+                 max_pending_messages=None, shared_memory_size=None,
+                 share_views=True, view_budget=None, view_admission="reject"):
+        if view_admission not in PerspectiveManager.VIEW_ADMISSION_POLICIES:
+            raise PerspectiveError(
+                "Invalid view admission policy `{}`".format(view_admission))
         self._tables = {}
         self._views = {}
+
+        # The `client_id` that created each view name
+        self._view_clients = {}
+
+        # Views shared between identical configs, by `(table_name, config)`
+        # key, the names that reference each key, and the key of each name.
+        self._share_views = share_views
+        self._shared_views = {}
+        self._shared_view_names = {}
+        self._view_keys = {}
         self._callback_cache = _PerspectiveCallBackCache()
         self._queue_process_callback = None
+        self._queue_notify_callback = None
         self._lock = lock
+        self._threaded = threaded
+
+        # Schedules a function on the thread that owns `post_callback`, and
+        # that thread.
+        self._loop_callback = None
+        self._loop_thread = None
+
+        # The Arrow compression negotiated by each `client_id`
+        self._client_compression = {}
+
+        # Flow control, and the messages pending for each `client_id`
+        self._max_pending_rows = max_pending_rows
+        self._max_pending_messages = max_pending_messages
+        self._client_queues = {}
+
+        # The shared memory ring of each `client_id` that asked for one
+        self._shared_memory_size = shared_memory_size
+        self._client_shared_memory = {}
+
+        # The clients that negotiated the binary protocol
+        self._binary_clients = set()
+
+        # The estimated cost above which views are handled by the policy
+        self._view_budget = view_budget
+        self._view_admission = view_admission
 
     def lock(self):
         """Block messages that can mutate the state of `Table`s and `View`s
@@ -97,9 +222,9 @@ class PerspectiveManager(object):
                 provided.
         """
         name = name or gen_name()
-        if isinstance(item, Table):
+        if isinstance(item, (Table, PerspectiveShardedTable)):
             self.host_table(name, item)
-        elif isinstance(item, View):
+        elif isinstance(item, (View, PerspectiveShardedView)):
             self.host_view(name, item)
         else:
             raise PerspectiveError(
@@ -112,11 +237,16 @@ class PerspectiveManager(object):
         If a function for `queue_process` is defined (i.e., by
         :obj:`~perspective.PerspectiveTornadoHandler`), bind the function to
         `Table` and have it call the manager's version of `queue_process`.
+
+        A :obj:`~perspective.PerspectiveShardedTable` can be hosted in place
+        of a `Table`; its shards process their updates as they arrive.
         '''
-        if self._queue_process_callback is not None:
+        if self._queue_process_callback is not None and isinstance(table, Table):
             # always bind the callback to the table's state manager
             table._state_manager.queue_process = partial(
                 self._queue_process_callback, state_manager=table._state_manager)
+        if self._queue_notify_callback is not None and isinstance(table, Table):
+            table._state_manager.queue_notify = self._queue_notify_callback
         self._tables[name] = table
         return name
 
@@ -134,6 +264,24 @@ class PerspectiveManager(object):
         '''Return a view under management by name.'''
         return self._views.get(name, None)
 
+    def get_memory_usage(self):
+        '''Return the memory usage of every table and view under management,
+        as a :obj:`dict` of ``"tables"`` and ``"views"``, each mapping names
+        to the result of their ``get_memory_usage()``.'''
+        return {
+            "tables": {name: table.get_memory_usage()
+                       for name, table in self._tables.items()
+                       if isinstance(table, Table)},
+            "views": {name: view.get_memory_usage()
+                      for name, view in self._views.items()},
+        }
+
+    def get_profile(self):
+        '''Return the engine phases sampled in this process, as
+        :func:`perspective.table.get_profile` does, which clients also read
+        with a `get_profile` message.'''
+        return get_profile()
+
     def new_session(self):
         return PerspectiveSession(self)
 
@@ -146,9 +294,32 @@ class PerspectiveManager(object):
         """
         self._queue_process_callback = func
         for table in self._tables.values():
+            if not isinstance(table, Table):
+                continue
             table._state_manager.queue_process = partial(
                 self._queue_process_callback, state_manager=table._state_manager)
 
+    def _set_queue_notify(self, func):
+        """For each table under management, and those hosted after, run the
+        notifications of views with an update interval through `func`, which
+        takes the notification and the seconds until it is due, and should
+        run it then, e.g. with `IOLoop.call_later`.
+        """
+        self._queue_notify_callback = func
+        for table in self._tables.values():
+            if not isinstance(table, Table):
+                continue
+            table._state_manager.queue_notify = func
+
+    def _set_loop_callback(self, func):
+        """Post messages from other threads by passing `func` a function
+        that posts them, so that `post_callback` is only called on the
+        calling thread. `func` must be thread-safe, e.g. Tornado's
+        `IOLoop.add_callback`.
+        """
+        self._loop_callback = func
+        self._loop_thread = threading.current_thread()
+
     def _process(self, msg, post_callback, client_id=None):
         '''Given a message from the client, process it through the Perspective
         engine.
@@ -161,7 +332,9 @@ class PerspectiveManager(object):
                 parameters: `data` (str), and `binary` (bool), a kwarg that
                 specifies whether `data` is a binary string.
         '''
-        if isinstance(msg, str):
+        if isinstance(msg, (bytes, bytearray)) and not isinstance(msg, str):
+            msg = _binary_protocol.decode(msg)
+        elif isinstance(msg, str):
             if msg == "heartbeat":   # TODO fix this
                 return
             msg = json.loads(msg)
@@ -177,13 +350,24 @@ class PerspectiveManager(object):
             error_string = "`{0}` failed - access denied".format(
                 msg["cmd"] + (("." + msg["method"]) if msg.get("method", None) is not None else ""))
             error_message = self._make_error_message(msg["id"], error_string)
-            post_callback(self._message_to_json(msg["id"], error_message))
+            self._post(post_callback, self._serialize(msg["id"], error_message, client_id),
+                       client_id=client_id)
             return
 
         try:
             if cmd == "init":
-                # return empty response
-                message = self._make_message(msg["id"], None)
+                # return an empty response, unless the client asks for
+                # compressed Arrows and one of its compressions is available
+                compression = self._negotiate_compression(msg, client_id)
+                result = {"compression": compression} if compression else None
+                shared_memory = self._negotiate_shared_memory(msg, client_id)
+                if shared_memory:
+                    result = dict(result or {}, shared_memory=shared_memory)
+                protocol = self._negotiate_protocol(msg, client_id)
+                if protocol:
+                    result = dict(result or {}, protocol=protocol)
+                message = self._make_message(msg["id"], result)
+                # The response is JSON, as the client has not yet switched.
                 post_callback(self._message_to_json(msg["id"], message))
             elif cmd == "table":
                 try:
@@ -194,17 +378,31 @@ class PerspectiveManager(object):
                 except IndexError:
                     self._tables[msg["name"]] = []
             elif cmd == "view":
-                # create a new view and track it with the assigned client_id.
-                new_view = self._tables[msg["table_name"]].view(
-                    **msg.get("config", {}))
-                new_view._client_id = client_id
-                self._views[msg["view_name"]] = new_view
+                # create a new view, or share an identical one, and track it
+                # with the assigned client_id.
+                self._views[msg["view_name"]] = self._open_view(
+                    msg["table_name"], msg.get("config", {}), msg["view_name"])
+                self._view_clients[msg["view_name"]] = client_id
+            elif cmd == "view_method" and self._is_threaded_method(msg):
+                EXECUTOR.submit(self._process_method_call,
+                                msg, post_callback, client_id)
+            elif cmd == "batch":
+                if any(self._is_threaded_method(call) for call in msg.get("calls", [])):
+                    EXECUTOR.submit(self._process_batch,
+                                    msg, post_callback, client_id)
+                else:
+                    self._process_batch(msg, post_callback, client_id)
             elif cmd == "table_method" or cmd == "view_method":
                 self._process_method_call(msg, post_callback, client_id)
+            elif cmd == "get_profile":
+                message = self._make_message(msg["id"], get_profile())
+                self._post(post_callback, self._serialize(msg["id"], message, client_id),
+                           client_id=client_id)
         except(PerspectiveError, PerspectiveCppError) as e:
             # Catch errors and return them to client
             error_message = self._make_error_message(msg["id"], str(e))
-            post_callback(self._message_to_json(msg["id"], error_message))
+            self._post(post_callback, self._serialize(msg["id"], error_message, client_id),
+                       client_id=client_id)
 
     def _process_method_call(self, msg, post_callback, client_id):
         '''When the client calls a method, validate the instance it calls on
@@ -217,58 +415,130 @@ class PerspectiveManager(object):
             if table_or_view is None:
                 error_message = self._make_error_message(
                     msg["id"], "View is not initialized")
-                post_callback(self._message_to_json(msg["id"], error_message))
+                self._post(post_callback, self._serialize(msg["id"], error_message, client_id), client_id=client_id)
+            elif msg.get("method", None) in PerspectiveManager.PRIVATE_VIEW_METHODS:
+                table_or_view = self._make_view_private(msg["name"])
         try:
             if msg.get("subscribe", False) is True:
                 self._process_subscribe(
                     msg, table_or_view, post_callback, client_id)
             else:
-                args = {}
-                if msg["method"] in ("schema", "computed_schema", "get_computation_input_types"):
-                    # make sure schema returns string types
-                    args["as_string"] = True
-                elif msg["method"].startswith("to_"):
-                    # parse options in `to_format` calls
-                    for d in msg.get("args", []):
-                        args.update(d)
-                else:
-                    args = msg.get("args", [])
-
                 if msg["method"] == "delete" and msg["cmd"] == "view_method":
                     # views can be removed, but tables cannot
-                    self._views[msg["name"]].delete()
-                    self._views.pop(msg["name"], None)
+                    self._release_view(msg["name"])
                     return
 
-                if msg["method"].startswith("to_"):
-                    # to_format takes dictionary of options
-                    result = getattr(table_or_view, msg["method"])(**args)
-                elif msg["method"] in ("update", "remove"):
-                    # Apply first arg as position, then options dict as kwargs
-                    data = args[0]
-                    options = {}
-                    if (len(args) > 1 and isinstance(args[1], dict)):
-                        options = args[1]
-                    result = getattr(table_or_view, msg["method"])(data, **options)
-                elif msg["method"] in ("computed_schema", "get_computation_input_types"):
-                    # these methods take args and kwargs
-                    result = getattr(table_or_view, msg["method"])(*msg.get("args", []), **args)
-                elif msg["method"] != "delete":
-                    # otherwise parse args as list
-                    result = getattr(table_or_view, msg["method"])(*args)
+                result = self._call_method(msg, table_or_view)
                 if isinstance(result, bytes) and msg["method"] != "to_csv":
                     # return a binary to the client without JSON serialization,
                     # i.e. when we return an Arrow. If a method is added that
                     # returns a string, this condition needs to be updated as
                     # an Arrow binary is both `str` and `bytes` in Python 2.
-                    self._process_bytes(result, msg, post_callback)
+                    compression = None
+                    if msg["method"] == "to_arrow":
+                        compression = self._client_compression.get(client_id)
+                    self._process_bytes(result, msg, post_callback, compression, client_id)
                 else:
                     # return the result to the client
                     message = self._make_message(msg["id"], result)
-                    post_callback(self._message_to_json(msg["id"], message))
+                    self._post(post_callback, self._serialize(msg["id"], message, client_id), client_id=client_id)
         except Exception as error:
             message = self._make_error_message(msg["id"], str(error))
-            post_callback(self._message_to_json(msg["id"], message))
+            self._post(post_callback, self._serialize(msg["id"], message, client_id), client_id=client_id)
+
+    def _call_method(self, msg, table_or_view):
+        '''Call the method of a `table_method` or `view_method` message on
+        `table_or_view`, returning its result.'''
+        args = {}
+        if msg["method"] in ("schema", "computed_schema", "get_computation_input_types"):
+            # make sure schema returns string types
+            args["as_string"] = True
+        elif msg["method"].startswith("to_"):
+            # parse options in `to_format` calls
+            for d in msg.get("args", []):
+                args.update(d)
+        else:
+            args = msg.get("args", [])
+
+        result = None
+        if msg["method"] == "delete":
+            if msg["cmd"] == "view_method":
+                # views can be removed, but tables cannot
+                self._release_view(msg["name"])
+        elif msg["method"].startswith("to_"):
+            # to_format takes dictionary of options
+            result = getattr(table_or_view, msg["method"])(**args)
+        elif msg["method"] in ("update", "remove"):
+            # Apply first arg as position, then options dict as kwargs
+            data = args[0]
+            options = {}
+            if (len(args) > 1 and isinstance(args[1], dict)):
+                options = args[1]
+            result = getattr(table_or_view, msg["method"])(data, **options)
+            if msg["cmd"] == "table_method":
+                self._bound_pending_rows(table_or_view)
+        elif msg["method"] in ("computed_schema", "get_computation_input_types"):
+            # these methods take args and kwargs
+            result = getattr(table_or_view, msg["method"])(*msg.get("args", []), **args)
+        else:
+            # otherwise parse args as list
+            result = getattr(table_or_view, msg["method"])(*args)
+        return result
+
+    def _process_batch(self, msg, post_callback, client_id):
+        '''Call each of the `table_method` and `view_method` messages in the
+        `calls` of a `batch` message in order, and post their results as one
+        message.
+
+        The `data` of the response has an entry for each call, either its
+        result as `{"data": ...}`, or `{"error": ...}` if it failed. For a
+        binary protocol client, binary results are in their entries. For
+        others the binary results are concatenated into one binary, sent
+        after the message, which has `batch` and `is_transferable` set, and
+        each of their entries is `{"binary": [offset, length]}` into it.
+        Binary results of a batch are neither compressed nor written to
+        shared memory.
+        '''
+        results = []
+        binaries = []
+        offset = 0
+        for call in msg.get("calls", []):
+            try:
+                if self._is_locked_command(call):
+                    raise PerspectiveError("`{0}.{1}` failed - access denied".format(
+                        call["cmd"], call.get("method", None)))
+                if call.get("subscribe", False) or call.get("cmd") not in ("table_method", "view_method"):
+                    raise PerspectiveError(
+                        "Only table and view method calls can be batched")
+                if call["cmd"] == "table_method":
+                    table_or_view = self._tables.get(call["name"], None)
+                else:
+                    table_or_view = self._views.get(call["name"], None)
+                    if table_or_view is None:
+                        raise PerspectiveError("View is not initialized")
+                    elif call["method"] in PerspectiveManager.PRIVATE_VIEW_METHODS:
+                        table_or_view = self._make_view_private(call["name"])
+                result = self._call_method(call, table_or_view)
+            except Exception as error:
+                results.append({"error": str(error)})
+                continue
+            if isinstance(result, bytes) and call["method"] != "to_csv" and \
+                    client_id not in self._binary_clients:
+                results.append({"binary": [offset, len(result)]})
+                binaries.append(result)
+                offset += len(result)
+            else:
+                results.append({"data": result})
+
+        message = self._make_message(msg["id"], results)
+        if not binaries:
+            self._post(post_callback, self._serialize(msg["id"], message, client_id),
+                       client_id=client_id)
+            return
+        message["batch"] = True
+        message["is_transferable"] = True
+        self._post(post_callback, json.dumps(message, cls=DateTimeEncoder),
+                   b"".join(binaries), client_id=client_id)
 
     def _process_subscribe(self, msg, table_or_view, post_callback, client_id):
         '''When the client attempts to add or remove a subscription callback,
@@ -291,13 +561,17 @@ class PerspectiveManager(object):
             if method and method[:2] == "on":
                 # wrap the callback
                 callback = partial(
-                    self.callback, msg=msg, post_callback=post_callback)
+                    self.callback, msg=msg, post_callback=post_callback,
+                    compression=self._client_compression.get(client_id),
+                    client_id=client_id)
                 if callback_id:
                     self._callback_cache.add_callback({
                         "client_id": client_id,
                         "callback_id": callback_id,
                         "callback": callback,
-                        "name": msg.get("name", None)
+                        "name": msg.get("name", None),
+                        "method": method,
+                        "args": args
                     })
             elif callback_id is not None:
                 # remove the callback with `callback_id`
@@ -319,9 +593,53 @@ class PerspectiveManager(object):
                 logging.info("callback not found for remote call {}".format(msg))
         except Exception as error:
             message = self._make_error_message(msg["id"], str(error))
-            post_callback(self._message_to_json(msg["id"], message))
-
-    def _process_bytes(self, binary, msg, post_callback):
+            self._post(post_callback, self._serialize(msg["id"], message, client_id),
+                       client_id=client_id)
+
+    def _negotiate_compression(self, msg, client_id):
+        '''Choose the first Arrow compression in the `compression` list of a
+        client's `init` message that is available, and use it for the Arrows
+        sent to `client_id`.'''
+        for compression in msg.get("compression", None) or []:
+            if compression in PerspectiveManager.ARROW_COMPRESSIONS and \
+                    is_arrow_compression_available(compression):
+                if client_id is not None:
+                    self._client_compression[client_id] = compression
+                return compression
+        return None
+
+    def _negotiate_protocol(self, msg, client_id):
+        '''Choose the first protocol in the `protocol` list of a client's
+        `init` message that the manager speaks, and use it for the messages
+        sent to `client_id` after the response.'''
+        if client_id is None:
+            return None
+        for protocol in msg.get("protocol", None) or []:
+            if protocol in PerspectiveManager.PROTOCOLS:
+                self._binary_clients.add(client_id)
+                return protocol
+        return None
+
+    def _negotiate_shared_memory(self, msg, client_id):
+        '''Create a shared memory ring for `client_id` if its `init` message
+        asks for one and the manager offers them, returning the ring's name.'''
+        if not msg.get("shared_memory", False) or client_id is None or \
+                self._shared_memory_size is None or not is_shared_memory_available():
+            return None
+        ring = self._client_shared_memory.get(client_id)
+        if ring is None:
+            ring = _PerspectiveSharedMemoryRing(self._shared_memory_size)
+            self._client_shared_memory[client_id] = ring
+        return ring.name
+
+    def _close_shared_memory(self, client_id):
+        '''Release the shared memory ring of `client_id`, if it has one.'''
+        ring = self._client_shared_memory.pop(client_id, None)
+        if ring is not None:
+            ring.close()
+
+    def _process_bytes(self, binary, msg, post_callback, compression=None,
+                       client_id=None):
         """Send a bytestring message to the client without attempting to
         serialize as JSON.
 
@@ -339,15 +657,116 @@ class PerspectiveManager(object):
             post_callback (callable) : a function that passes data to the
                 client, with a `binary` (bool) kwarg that allows it to pass
                 byte messages without serializing to JSON.
+            compression (str) : if set, an Arrow `binary` is compressed and
+                the name of its compression is sent in the first message.
+            client_id (str) : the client the message is posted to. If it has
+                a shared memory ring, `binary` is written to the ring, and
+                only the first message is sent, with a `shared_memory`
+                descriptor of `binary` in place of `is_transferable`.
         """
+        ring = self._client_shared_memory.get(client_id)
+        descriptor = ring.write(binary) if ring is not None else None
+        if descriptor is not None:
+            msg["shared_memory"] = descriptor
+            self._post(post_callback, self._serialize(msg["id"], msg, client_id),
+                       client_id=client_id)
+            return
+        if compression:
+            binary = compress_arrow(binary, compression)
+            msg["compression"] = compression
+        if client_id in self._binary_clients:
+            # the binary is sent in the message, as the `data` it announces
+            message = {"id": msg["id"], "data": binary}
+            if isinstance(msg.get("data"), dict) and "port_id" in msg["data"]:
+                message["data"] = {"port_id": msg["data"]["port_id"], "delta": binary}
+            if compression:
+                message["compression"] = compression
+            self._post(post_callback, self._serialize(msg["id"], message, client_id),
+                       client_id=client_id)
+            return
         msg["is_transferable"] = True
-        post_callback(json.dumps(msg, cls=DateTimeEncoder))
-        post_callback(binary, binary=True)
+        self._post(post_callback, json.dumps(msg, cls=DateTimeEncoder), binary,
+                   client_id=client_id)
+
+    def _post(self, post_callback, message, binary=None, client_id=None,
+              coalesce_key=None):
+        '''Pass `message` to `post_callback`, followed by the bytestring
+        `binary` if it is set.
+
+        Off the thread that set the loop callback, both are posted by a single
+        function passed to the loop callback, so that no other message can be
+        sent between a binary and the message that announces it.
+
+        Under `max_pending_messages`, the message is posted through the queue
+        of `client_id`, which holds it while the client is congested if
+        `coalesce_key` is set, replacing the previous message with that key.
+        '''
+        def post():
+            if isinstance(message, bytes) and not isinstance(message, str):
+                results = [post_callback(message, binary=True)]
+            else:
+                results = [post_callback(message)]
+            if binary is not None:
+                results.append(post_callback(binary, binary=True))
+            return results
+
+        queue = self._get_client_queue(client_id)
+        if queue is not None:
+            post = partial(queue.post, post, coalesce_key)
+
+        if self._loop_callback is not None and \
+                threading.current_thread() is not self._loop_thread:
+            self._loop_callback(post)
+        else:
+            post()
+
+    def _get_client_queue(self, client_id):
+        '''Returns the queue of messages pending for `client_id`, or `None`
+        without `max_pending_messages`.'''
+        if self._max_pending_messages is None or client_id is None:
+            return None
+        queue = self._client_queues.get(client_id)
+        if queue is None:
+            queue = self._client_queues.setdefault(
+                client_id, _PerspectiveClientQueue(self._max_pending_messages))
+        return queue
+
+    def _on_client_drained(self, client_id, callback):
+        '''Call `callback` once `client_id` has fewer than
+        `max_pending_messages` messages pending, immediately if it does now.'''
+        queue = self._get_client_queue(client_id)
+        if queue is None:
+            callback()
+        else:
+            queue.on_drained(callback)
+
+    def _is_client_congested(self, client_id):
+        '''Returns whether `client_id` has `max_pending_messages` messages
+        pending.'''
+        queue = self._get_client_queue(client_id)
+        return queue is not None and queue.is_congested()
+
+    def _bound_pending_rows(self, table):
+        '''Process `table` now if clients' updates have left
+        `max_pending_rows` rows pending in it.'''
+        if self._max_pending_rows is None or not isinstance(table, Table):
+            return
+        if table._table.get_pool().get_pending_rows() >= self._max_pending_rows:
+            table._state_manager.call_process(table._table.get_id())
 
     def callback(self, *args, **kwargs):
         '''Return a message to the client using the `post_callback` method.'''
         id = kwargs.get("msg")["id"]
         post_callback = kwargs.get("post_callback")
+        client_id = kwargs.get("client_id")
+        if kwargs.get("msg").get("method") == "on_update_stats":
+            # Every update's statistics are sent, as each counts towards the
+            # client's totals.
+            msg = self._make_message(id, args[0])
+            self._post(post_callback, self._serialize(msg["id"], msg, client_id),
+                       client_id=client_id)
+            return
+
         # Coerce the message to be an object so it can be handled in
         # Javascript, where promises cannot be resolved with multiple args.
         updated = {
@@ -355,9 +774,12 @@ class PerspectiveManager(object):
         }
         msg = self._make_message(id, updated)
         if len(args) > 1 and type(args[1]) == bytes:
-            self._process_bytes(args[1], msg, post_callback)
+            self._process_bytes(args[1], msg, post_callback, kwargs.get("compression"), client_id)
         else:
-            post_callback(self._message_to_json(msg["id"], msg))
+            # A notification without a delta only says that the view changed,
+            # so a slow client needs only the latest.
+            self._post(post_callback, self._serialize(msg["id"], msg, client_id),
+                       client_id=client_id, coalesce_key=id)
 
     def clear_views(self, client_id):
         '''Garbage collect views that belong to closed connections.'''
@@ -367,17 +789,103 @@ class PerspectiveManager(object):
         if not client_id:
             raise PerspectiveError("Cannot garbage collect views that are not linked to a specific client ID!")
 
-        for name, view in self._views.items():
-            if view._client_id == client_id:
-                view.delete()
+        for name, view_client_id in self._view_clients.items():
+            if view_client_id == client_id:
                 names.append(name)
                 count += 1
 
         for name in names:
-            self._views.pop(name)
+            self._release_view(name)
 
         logging.warning("GC {} views in memory".format(count))
 
+    def _open_view(self, table_name, config, name):
+        '''Return a view of `table_name` with `config` for the view `name`,
+        which is the shared view of an identical config if there is one.'''
+        table = self._tables[table_name]
+        if not self._share_views:
+            return self._make_view(table, config)
+        key = (table_name, json.dumps(config, sort_keys=True, cls=DateTimeEncoder))
+        view = self._shared_views.get(key, None)
+        if view is None:
+            view = self._make_view(table, config)
+            self._shared_views[key] = view
+            self._shared_view_names[key] = set()
+        self._shared_view_names[key].add(name)
+        self._view_keys[name] = key
+        return view
+
+    def _make_view(self, table, config):
+        '''Returns a new view of `table` with `config`, built as the
+        `view_admission` policy has it if its estimated cost is above the
+        `view_budget`.'''
+        if self._view_budget is None:
+            return table.view(**config)
+        cost = table.estimate_view_cost(**config)["cost"]
+        if cost <= self._view_budget:
+            return table.view(**config)
+        if self._view_admission == "reject":
+            raise PerspectiveError(
+                "View with an estimated cost of {:.0f} is above the budget of {:.0f}".format(
+                    cost, self._view_budget))
+        elif self._view_admission == "queue":
+            return table.view(progressive="queued", **config)
+        view = table.view(progressive=True, **config)
+        view.set_priority("background")
+        return view
+
+    def _unshare_view(self, name):
+        '''Stop sharing the view of `name`, returning whether another name
+        still references it.'''
+        key = self._view_keys.pop(name, None)
+        if key is None:
+            return False
+        names = self._shared_view_names[key]
+        names.discard(name)
+        if names:
+            return True
+        self._shared_views.pop(key, None)
+        self._shared_view_names.pop(key, None)
+        return False
+
+    def _make_view_private(self, name):
+        '''Give the view `name` a view of its own, if it is shared, with the
+        callbacks its client registered on the shared view.'''
+        view = self._views[name]
+        key = self._view_keys.get(name, None)
+        if not self._unshare_view(name):
+            # The last name of a shared view keeps it, unshared.
+            return view
+        private = self._make_view(self._tables[key[0]], view.get_config())
+        for cb in self._callback_cache.get_callbacks():
+            if cb["name"] == name and cb.get("method", None) == "on_update":
+                view.remove_update(cb["callback"])
+                mode = cb["args"][0] if len(cb["args"]) > 0 else {"mode": "none"}
+                private.on_update(cb["callback"], **mode)
+            elif cb["name"] == name and cb.get("method", None) == "on_delete":
+                view.remove_delete(cb["callback"])
+                private.on_delete(cb["callback"])
+        self._views[name] = private
+        return private
+
+    def _release_view(self, name):
+        '''Remove the view `name`, deleting its view unless it is shared with
+        another name, in which case only the callbacks registered through
+        `name` are removed.'''
+        view = self._views.pop(name, None)
+        self._view_clients.pop(name, None)
+        if view is None:
+            return
+        if not self._unshare_view(name):
+            view.delete()
+            return
+        for cb in self._callback_cache.get_callbacks():
+            if cb["name"] == name and cb.get("method", None) == "on_update":
+                view.remove_update(cb["callback"])
+            elif cb["name"] == name and cb.get("method", None) == "on_delete":
+                view.remove_delete(cb["callback"])
+        self._callback_cache.remove_callbacks(lambda cb: cb["name"] != name)
+
     def _make_message(self, id, result):
         '''Return a serializable message for a successful result.'''
         return {
@@ -392,6 +900,19 @@ class PerspectiveManager(object):
             "error": error
         }
 
+    def _serialize(self, id, message, client_id=None):
+        '''Serialize `message` in the protocol `client_id` negotiated: as
+        JSON by `_message_to_json`, or in the binary protocol, which returns
+        `bytes`.'''
+        if client_id not in self._binary_clients:
+            return self._message_to_json(id, message)
+        try:
+            return _binary_protocol.encode(message)
+        except PerspectiveError as error:
+            error_message = self._make_error_message(id, str(error))
+            logging.warning(error_message["error"])
+            return _binary_protocol.encode(error_message)
+
     def _message_to_json(self, id, message):
         '''Given a message object to be passed to Perspective, serialize it
         into a string using `DateTimeEncoder` and `allow_nan=False`.
@@ -418,6 +939,12 @@ class PerspectiveManager(object):
             logging.warning(error_message["error"])
             return json.dumps(error_message)
 
+    def _is_threaded_method(self, msg):
+        '''Returns `True` if the manager is `threaded` and `msg` calls one of
+        `PerspectiveManager.THREADED_METHODS` on a view.'''
+        return self._threaded and not msg.get("subscribe", False) and \
+            msg.get("method", None) in PerspectiveManager.THREADED_METHODS
+
     def _is_locked_command(self, msg):
         '''Returns `True` if the manager instance is locked and the command
         is in `PerspectiveManager.LOCKED_COMMANDS`, and `False` otherwise.'''
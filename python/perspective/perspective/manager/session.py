@@ -40,6 +40,10 @@ class PerspectiveSession(object):
         when the session ends.
         '''
         self.manager.clear_views(self.client_id)
+        self.manager._client_compression.pop(self.client_id, None)
+        self.manager._client_queues.pop(self.client_id, None)
+        self.manager._close_shared_memory(self.client_id)
+        self.manager._binary_clients.discard(self.client_id)
         self._clear_callbacks()
 
     def _clear_callbacks(self):
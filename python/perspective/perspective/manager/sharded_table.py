@@ -0,0 +1,587 @@
+################################################################################
+#
+# Copyright (c) 2020, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+import multiprocessing
+import threading
+import zlib
+from ..core.exception import PerspectiveError
+from ..table import Table
+from ._shard import _run_shard
+
+# The aggregate each merged aggregate is computed with from the per-shard
+# aggregates of a pivot's leaves. Aggregates that are missing, such as
+# `median` or `distinct count`, cannot be merged from their parts.
+_MERGED_AGGREGATES = {
+    "sum": "sum",
+    "sum not null": "sum",
+    "count": "sum",
+    "high": "high",
+    "low": "low",
+    "min": "min",
+    "max": "max",
+    "any": "any",
+    "and": "and",
+    "or": "or",
+    "mean": "weighted mean",
+    "avg": "weighted mean",
+}
+
+# The names of the columns of a merged pivot's local table that hold the
+# pivot value of each leaf, and the number of rows it aggregates.
+_PIVOT_COLUMN = "__PIVOT_{}__"
+_COUNT_COLUMN = "__COUNT__"
+
+
+def _is_schema(data):
+    return isinstance(data, dict) and len(data) > 0 and \
+        all(isinstance(value, (type, str)) for value in data.values())
+
+
+def _shard_of(key, num_shards):
+    '''Returns the shard that holds the row with the primary key `key`, the
+    same in every process for keys that compare equal.'''
+    if isinstance(key, float) and key.is_integer():
+        key = int(key)
+    return zlib.crc32(str(key).encode("utf-8")) % num_shards
+
+
+class PerspectiveShardedTable(object):
+    '''A table whose rows are partitioned by the hash of their primary key
+    across worker processes, each holding a :obj:`~perspective.Table` of its
+    own, so that a dataset is bounded by the memory and update throughput of
+    all of its shards rather than those of one process.
+
+    A sharded table supports the `update`, `remove`, `clear`, `replace`,
+    `size`, `schema` and `view` methods of :obj:`~perspective.Table`, and can
+    be hosted by a :obj:`~perspective.PerspectiveManager` in place of one.
+    Updates are split by the hash of the `index` column, or round-robin
+    across the shards if the table has no index, and each shard processes its
+    part in parallel.
+
+    Its views are computed by each shard on its own rows, and merged by the
+    process that holds the sharded table:
+
+    - a flat view concatenates the rows of each shard, which are then sorted.
+    - a pivoted view merges the aggregates of the leaves of each shard, i.e.
+        the groups of every row and column pivot, which are then aggregated
+        into the pivot's totals. Only the mergeable aggregates - `sum`,
+        `sum not null`, `count`, `high`, `low`, `any`, `and`, `or` and
+        `mean`/`avg` - are supported. `mean` is merged weighted by the row
+        count of each shard's leaf, which is exact for columns without nulls.
+
+    Merged results are recomputed after each update, the first time they are
+    read. A sharded table created from data loads it through a
+    :obj:`~perspective.Table` in the calling process first, to infer its
+    schema; to load a dataset larger than one process, create it from a
+    schema and `update` it in batches.
+
+    Examples:
+        >>> table = PerspectiveShardedTable({"id": int, "x": float},
+        ...     index="id", shards=8)
+        >>> table.update(batch)
+        >>> MANAGER.host_table("data_source_one", table)
+    '''
+
+    def __init__(self, data, index=None, shards=4):
+        '''Start `shards` worker processes and load `data` into them.
+
+        Args:
+            data (:obj:`dict`|:obj:`list`|:obj:`pandas.DataFrame`|:obj:`bytes`):
+                the data or schema of the table, in any format
+                :obj:`~perspective.Table` accepts.
+
+        Keyword Args:
+            index (:obj:`str`): the primary key column, whose hash assigns
+                each row to a shard.
+            shards (:obj:`int`): the number of worker processes. Defaults to
+                4.
+        '''
+        if shards < 1:
+            raise PerspectiveError("A sharded table needs at least one shard!")
+
+        self._index = index
+        self._lock = threading.RLock()
+        self._next_shard = 0
+        self._views = []
+        self._delete_callbacks = []
+        self._shards = []
+
+        if _is_schema(data):
+            schema = data
+            columns = None
+        else:
+            local = Table(data, index=index)
+            view = local.view()
+            schema = local.schema()
+            columns = view.to_columns()
+            view.delete()
+            local.delete()
+
+        # Spawn rather than fork the shards, as the engine's worker threads
+        # do not survive a fork.
+        context = multiprocessing.get_context("spawn")
+        for _ in range(shards):
+            conn, shard_conn = context.Pipe()
+            process = context.Process(
+                target=_run_shard, args=(shard_conn,), daemon=True)
+            process.start()
+            shard_conn.close()
+            self._shards.append((process, conn))
+
+        self._call_shards("table", [(schema, {"index": index})] * shards)
+        self._schema = self._call_shard("table_method", ("schema", [], {}))
+        if columns is not None:
+            self._update_shards(columns)
+
+    def get_num_shards(self):
+        '''Returns the number of shards the table is partitioned across.'''
+        return len(self._shards)
+
+    def get_index(self):
+        '''Returns the primary key column of the table, or `None`.'''
+        return self._index
+
+    def size(self):
+        '''Returns the row count of the table, across all of its shards.'''
+        return sum(self._call_shards(
+            "table_method", [("size", [], {})] * len(self._shards)))
+
+    def schema(self, as_string=False):
+        '''Returns the schema of the table, as :func:`~perspective.Table.schema`
+        does.'''
+        return self._call_shard(
+            "table_method", ("schema", [], {"as_string": as_string}))
+
+    def computed_schema(self, computed_columns=None, **kwargs):
+        '''Returns the schema of `computed_columns`, as
+        :func:`~perspective.Table.computed_schema` does.'''
+        kwargs["computed_columns"] = computed_columns
+        return self._call_shard("table_method", ("computed_schema", [], kwargs))
+
+    def columns(self):
+        '''Returns the column names of the table.'''
+        return list(self._schema.keys())
+
+    def update(self, data, port_id=0):
+        '''Update the table with `data`, sending each row to the shard of its
+        primary key, and notify the table's views.
+
+        Args:
+            data (:obj:`dict`|:obj:`list`|:obj:`pandas.DataFrame`|:obj:`bytes`):
+                the rows to update, in any format :obj:`~perspective.Table`
+                accepts. Every row must contain the `index` column.
+        '''
+        with self._lock:
+            self._update_shards(data)
+            self._notify()
+
+    def remove(self, pkeys, port_id=0):
+        '''Remove the rows with the primary keys `pkeys` from their shards, and
+        notify the table's views.
+
+        Args:
+            pkeys (:obj:`list`): the primary keys of the rows to remove.
+        '''
+        if self._index is None:
+            raise PerspectiveError("Cannot remove rows from a sharded table without an index!")
+
+        num_shards = len(self._shards)
+        parts = [[] for _ in range(num_shards)]
+        for pkey in pkeys:
+            parts[_shard_of(pkey, num_shards)].append(pkey)
+
+        with self._lock:
+            self._call_shards("table_method", [
+                ("remove", [part], {}) if part else None for part in parts])
+            self._notify()
+
+    def clear(self):
+        '''Remove every row from every shard, keeping the schema.'''
+        with self._lock:
+            self._call_shards(
+                "table_method", [("clear", [], {})] * len(self._shards))
+            self._notify()
+
+    def replace(self, data):
+        '''Replace the rows of the table with `data`, keeping the schema.'''
+        with self._lock:
+            self._call_shards(
+                "table_method", [("clear", [], {})] * len(self._shards))
+            self._update_shards(data)
+            self._notify()
+
+    def view(self, columns=None, row_pivots=None, column_pivots=None,
+             aggregates=None, sort=None, filter=None, computed_columns=None,
+             **kwargs):
+        '''Create a :obj:`PerspectiveShardedView` of the table. Takes the
+        same keyword arguments as :func:`~perspective.Table.view()`.
+
+        Raises:
+            :obj:`PerspectiveError`: if a pivoted view aggregates a column
+                with an aggregate that cannot be merged across shards.
+        '''
+        config = {
+            "columns": columns,
+            "row_pivots": row_pivots or [],
+            "column_pivots": column_pivots or [],
+            "aggregates": aggregates or {},
+            "sort": sort or [],
+            "filter": filter or [],
+            "computed_columns": computed_columns or [],
+        }
+        for key in ("filter_op", "row_pivot_depth", "column_pivot_depth"):
+            if kwargs.get(key) is not None:
+                config[key] = kwargs[key]
+
+        if config["columns"] is None:
+            config["columns"] = self.columns() + \
+                [col["column"] for col in config["computed_columns"]]
+
+        view = PerspectiveShardedView(self, config)
+        with self._lock:
+            self._views.append(view)
+        return view
+
+    def on_delete(self, callback):
+        '''Register a callback to be invoked when the table is deleted.'''
+        if not callable(callback):
+            raise ValueError("on_delete callback must be a callable function!")
+        self._delete_callbacks.append(callback)
+
+    def remove_delete(self, callback):
+        '''De-register a callback registered with `on_delete`.'''
+        self._delete_callbacks = [
+            cb for cb in self._delete_callbacks if cb != callback]
+
+    def delete(self):
+        '''Stop the table's worker processes, once it has no views.'''
+        if len(self._views) > 0:
+            raise PerspectiveError(
+                "Cannot delete a Table with active views still linked to it " +
+                "- call delete() on each view, and try again.")
+
+        with self._lock:
+            for process, conn in self._shards:
+                conn.send(None)
+            for process, conn in self._shards:
+                process.join()
+                conn.close()
+            self._shards = []
+        [cb() for cb in self._delete_callbacks]
+
+    def _update_shards(self, data):
+        '''Split `data` by shard, and update each shard with its part.'''
+        if not isinstance(data, (dict, list)):
+            # Read any other format through a table of the same schema.
+            local = Table(self._schema, index=self._index)
+            local.update(data)
+            view = local.view()
+            data = view.to_columns()
+            view.delete()
+            local.delete()
+
+        self._call_shards("table_method", [
+            ("update", [part], {}) if part is not None else None
+            for part in self._partition(data)])
+
+    def _partition(self, data):
+        '''Split the columns or records `data` into the rows of each shard,
+        with `None` for a shard that has no rows.'''
+        num_shards = len(self._shards)
+        if isinstance(data, dict):
+            data = {name: column.tolist() if hasattr(column, "tolist") else list(column)
+                    for name, column in data.items()}
+            num_rows = len(next(iter(data.values()))) if data else 0
+            keys = data.get(self._index) if self._index is not None else None
+            shards = self._assign_shards(keys, num_rows)
+            parts = [{name: [] for name in data} for _ in range(num_shards)]
+            for name, column in data.items():
+                for ridx, shard in enumerate(shards):
+                    parts[shard][name].append(column[ridx])
+            counts = [0] * num_shards
+            for shard in shards:
+                counts[shard] += 1
+            return [part if count > 0 else None
+                    for part, count in zip(parts, counts)]
+
+        keys = None
+        if self._index is not None:
+            keys = [row.get(self._index) for row in data]
+        shards = self._assign_shards(keys, len(data))
+        parts = [[] for _ in range(num_shards)]
+        for row, shard in zip(data, shards):
+            parts[shard].append(row)
+        return [part or None for part in parts]
+
+    def _assign_shards(self, keys, num_rows):
+        num_shards = len(self._shards)
+        if self._index is None:
+            start = self._next_shard
+            self._next_shard = (start + num_rows) % num_shards
+            return [(start + ridx) % num_shards for ridx in range(num_rows)]
+
+        if keys is None or any(key is None for key in keys):
+            raise PerspectiveError(
+                "Every row of an update to a sharded table must set its index `{}`!".format(self._index))
+        return [_shard_of(key, num_shards) for key in keys]
+
+    def _notify(self):
+        for view in list(self._views):
+            view._on_table_update()
+
+    def _call_shards(self, cmd, args):
+        '''Send `cmd` with `args[i]` to shard `i`, skipping the shards whose
+        `args` are `None`, and return their results once all have run.'''
+        with self._lock:
+            conns = []
+            for (process, conn), shard_args in zip(self._shards, args):
+                if shard_args is not None:
+                    conn.send((cmd, shard_args))
+                    conns.append(conn)
+            replies = [conn.recv() for conn in conns]
+
+        for ok, result in replies:
+            if not ok:
+                raise PerspectiveError(result)
+        return [result for _, result in replies]
+
+    def _call_shard(self, cmd, args):
+        '''Send `cmd` to the first shard, e.g. to read the schema every shard
+        shares.'''
+        return self._call_shards(cmd, [args])[0]
+
+
+class PerspectiveShardedView(object):
+    '''A view of a :obj:`PerspectiveShardedTable`, merged from a
+    :obj:`~perspective.View` on each of its shards.
+
+    The merged rows are held in a :obj:`~perspective.View` of a local
+    :obj:`~perspective.Table`, through which every other method of
+    :obj:`~perspective.View` is served, e.g. `to_dict`, `to_arrow` or
+    `num_rows`. Its `on_update` callbacks are called without deltas.
+    '''
+
+    def __init__(self, table, config):
+        self._table = table
+        self._config = config
+        self._id = id(self)
+        self._callbacks = []
+        self._delete_callbacks = []
+        self._local_table = None
+        self._local_view = None
+        self._dirty = True
+
+        row_pivots = config["row_pivots"]
+        column_pivots = config["column_pivots"]
+        self._leaves = row_pivots + column_pivots
+        shard_base = {
+            "filter": config["filter"],
+            "computed_columns": config["computed_columns"],
+        }
+        if "filter_op" in config:
+            shard_base["filter_op"] = config["filter_op"]
+
+        # The shown and sorted columns, which are read from each shard.
+        columns = list(dict.fromkeys(
+            config["columns"] + [sort[0] for sort in config["sort"]]))
+
+        self._count_config = None
+        if not self._leaves:
+            index = table.get_index()
+            if index is not None and index not in columns:
+                columns.append(index)
+            self._shard_config = dict(shard_base, columns=columns)
+            self._local_config = {
+                "columns": config["columns"],
+                "sort": config["sort"],
+            }
+        else:
+            schema = dict(table._schema)
+            schema.update(
+                table.computed_schema(computed_columns=config["computed_columns"]))
+            shard_aggregates = {}
+            local_aggregates = {}
+            for column in columns:
+                aggregate = config["aggregates"].get(column)
+                if aggregate is None:
+                    aggregate = "sum" if schema.get(column) in (int, float) else "count"
+                merged = _MERGED_AGGREGATES.get(aggregate) \
+                    if isinstance(aggregate, str) else None
+                if merged is None:
+                    raise PerspectiveError(
+                        "Aggregate `{}` of column `{}` cannot be merged across shards!".format(aggregate, column))
+                shard_aggregates[column] = aggregate
+                if merged == "weighted mean":
+                    local_aggregates[column] = [merged, _COUNT_COLUMN]
+                    # a `count` of any column is the row count of a leaf
+                    self._count_config = dict(
+                        shard_base, row_pivots=self._leaves,
+                        columns=[self._leaves[0]],
+                        aggregates={self._leaves[0]: "count"})
+                else:
+                    local_aggregates[column] = merged
+
+            self._schema = schema
+            self._shard_config = dict(
+                shard_base, row_pivots=self._leaves, columns=columns,
+                aggregates=shard_aggregates)
+            pivots = [_PIVOT_COLUMN.format(i) for i in range(len(self._leaves))]
+            self._local_config = {
+                "row_pivots": pivots[:len(row_pivots)],
+                "column_pivots": pivots[len(row_pivots):],
+                "columns": config["columns"],
+                "aggregates": local_aggregates,
+                "sort": config["sort"],
+            }
+
+        num_shards = table.get_num_shards()
+        table._call_shards(
+            "view", [(self._id, self._shard_config)] * num_shards)
+        if self._count_config is not None:
+            table._call_shards(
+                "view", [(self._count_id(), self._count_config)] * num_shards)
+
+    def __getattr__(self, name):
+        if name.startswith("_"):
+            raise AttributeError(name)
+        return getattr(self._get_view(), name)
+
+    def get_config(self):
+        '''Returns a copy of the view's config.'''
+        return dict(self._config)
+
+    def on_update(self, callback, mode=None):
+        '''Call `callback(port_id)` after each update of the table.
+
+        Raises:
+            :obj:`PerspectiveError`: if `mode` asks for deltas, which are not
+                merged across shards.
+        '''
+        if mode not in (None, "none"):
+            raise PerspectiveError("A sharded view cannot send `{}` deltas!".format(mode))
+        if not callable(callback):
+            raise ValueError("Invalid callback - must be a callable function")
+        self._callbacks.append(callback)
+
+    def remove_update(self, callback):
+        '''Remove a callback registered with `on_update`.'''
+        self._callbacks = [cb for cb in self._callbacks if cb != callback]
+
+    def on_delete(self, callback):
+        '''Call `callback` when the view is deleted.'''
+        if not callable(callback):
+            raise ValueError("on_delete callback must be a callable function!")
+        self._delete_callbacks.append(callback)
+
+    def remove_delete(self, callback):
+        '''Remove a callback registered with `on_delete`.'''
+        self._delete_callbacks = [
+            cb for cb in self._delete_callbacks if cb != callback]
+
+    def delete(self):
+        '''Delete the view on every shard, and the local view it is merged
+        into.'''
+        table = self._table
+        with table._lock:
+            num_shards = table.get_num_shards()
+            table._call_shards("view_delete", [self._id] * num_shards)
+            if self._count_config is not None:
+                table._call_shards("view_delete", [self._count_id()] * num_shards)
+            table._views.remove(self)
+            if self._local_view is not None:
+                self._local_view.delete()
+                self._local_table.delete()
+                self._local_view = None
+        self._callbacks = []
+        [cb() for cb in self._delete_callbacks]
+
+    def _count_id(self):
+        return "{}.count".format(self._id)
+
+    def _on_table_update(self):
+        self._dirty = True
+        for callback in list(self._callbacks):
+            callback(0)
+
+    def _get_view(self):
+        '''Returns the local view of the merged rows, merging them again if
+        the table was updated since they were last merged.'''
+        table = self._table
+        with table._lock:
+            if self._dirty:
+                if self._leaves:
+                    schema, data = self._merge_leaves()
+                    index = None
+                else:
+                    schema, data = self._merge_rows()
+                    index = table.get_index()
+
+                if self._local_table is None:
+                    self._local_table = Table(schema, index=index)
+                    self._local_table.update(data)
+                    self._local_view = self._local_table.view(**self._local_config)
+                else:
+                    self._local_table.replace(data)
+                self._dirty = False
+            return self._local_view
+
+    def _merge_rows(self):
+        '''Concatenate the rows of a flat view on each shard.'''
+        table = self._table
+        num_shards = table.get_num_shards()
+        schema = table._call_shard("view_method", (self._id, "schema", [], {}))
+        parts = table._call_shards(
+            "view_method", [(self._id, "to_columns", [], {})] * num_shards)
+        data = {name: [] for name in schema}
+        for part in parts:
+            for name in schema:
+                data[name].extend(part.get(name, []))
+        return schema, data
+
+    def _merge_leaves(self):
+        '''Concatenate the aggregates of the leaves of a pivoted view on each
+        shard, with the pivot values of each leaf as columns, and its row
+        count if a `mean` is merged.'''
+        table = self._table
+        num_shards = table.get_num_shards()
+        depth = len(self._leaves)
+        aggregated = table._call_shard(
+            "view_method", (self._id, "schema", [], {}))
+
+        pivots = [_PIVOT_COLUMN.format(i) for i in range(depth)]
+        schema = {pivot: self._schema[leaf]
+                  for pivot, leaf in zip(pivots, self._leaves)}
+        schema.update(aggregated)
+        if self._count_config is not None:
+            schema[_COUNT_COLUMN] = int
+
+        data = {name: [] for name in schema}
+        parts = table._call_shards(
+            "view_method", [(self._id, "to_columns", [], {})] * num_shards)
+        counts = [None] * num_shards
+        if self._count_config is not None:
+            counts = table._call_shards(
+                "view_method", [(self._count_id(), "to_columns", [], {})] * num_shards)
+
+        for part, count in zip(parts, counts):
+            leaf_counts = {}
+            if count is not None:
+                for path, value in zip(count["__ROW_PATH__"], count[self._leaves[0]]):
+                    leaf_counts[tuple(path)] = value
+
+            for ridx, path in enumerate(part["__ROW_PATH__"]):
+                if len(path) != depth:
+                    # a total, which is merged from the leaves
+                    continue
+                for pivot, value in zip(pivots, path):
+                    data[pivot].append(value)
+                for name in aggregated:
+                    data[name].append(part[name][ridx])
+                if count is not None:
+                    data[_COUNT_COLUMN].append(leaf_counts.get(tuple(path), 0))
+        return schema, data
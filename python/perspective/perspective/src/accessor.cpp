@@ -66,6 +66,19 @@ get_column_names(t_val data, std::int32_t format) {
 
 t_dtype
 infer_type(t_val x, t_val date_validator) {
+    // Exact builtin types provide no type of their own, so are inferred
+    // without looking up their attributes.
+    PyObject* ptr = x.ptr();
+    if (ptr == Py_None) {
+        return t_dtype::DTYPE_NONE;
+    } else if (PyBool_Check(ptr)) {
+        return t_dtype::DTYPE_BOOL;
+    } else if (PyFloat_CheckExact(ptr)) {
+        return t_dtype::DTYPE_FLOAT64;
+    } else if (PyLong_CheckExact(ptr)) {
+        return t_dtype::DTYPE_INT64;
+    }
+
     std::string type_string = x.get_type().attr("__name__").cast<std::string>();
     t_dtype t = t_dtype::DTYPE_STR;
 
@@ -147,11 +160,12 @@ get_data_type(
         }
     } else if (format == 1) {
         py::dict data_dict = data.cast<py::dict>();
+        py::list data_list = data_dict[name].cast<py::list>();
 
         while (!inferredType.is_initialized() && i < 100
-            && i < data_dict[name].cast<py::list>().size()) {
-            if (!data_dict[name].cast<py::list>()[i].is_none()) {
-                inferredType = infer_type(data_dict[name].cast<py::list>()[i].cast<t_val>(), date_validator);
+            && i < data_list.size()) {
+            if (!data_list[i].is_none()) {
+                inferredType = infer_type(data_list[i].cast<t_val>(), date_validator);
             }
             i++;
         }
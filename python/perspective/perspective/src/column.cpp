@@ -21,7 +21,13 @@ void t_column::object_copied<PSP_OBJECT_TYPE>(std::uint64_t ptr) const {
     // get what was there and incref if can
     if (ptr){
         py::handle handle = reinterpret_cast<PSP_OBJECT_TYPE>(ptr);
-        handle.inc_ref();
+        if (PyGILState_Check()) {
+            handle.inc_ref();
+        } else {
+            // Updates are processed without the GIL
+            py::gil_scoped_acquire acquire;
+            handle.inc_ref();
+        }
     }
 }
 
@@ -30,7 +36,12 @@ void t_column::object_cleared<PSP_OBJECT_TYPE>(std::uint64_t ptr) const {
     // get what was there and decref if can
     if (ptr){
         py::handle handle = reinterpret_cast<PSP_OBJECT_TYPE>(ptr);
-        handle.dec_ref();
+        if (PyGILState_Check()) {
+            handle.dec_ref();
+        } else {
+            py::gil_scoped_acquire acquire;
+            handle.dec_ref();
+        }
     }
 }
 
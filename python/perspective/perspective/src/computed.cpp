@@ -9,13 +9,16 @@
 #ifdef PSP_ENABLE_PYTHON
 
 #include <perspective/python/computed.h>
+#include <perspective/kernel_engine.h>
+#include <cmath>
+#include <limits>
 
 namespace perspective {
 namespace binding {
 
 void
 make_computations() {
-    // seed the computations vector
+    // generate the computations now, rather than on first use
     t_computed_column::make_computations();
 }
 
@@ -56,7 +59,52 @@ get_computation_input_types(const std::string& computed_function_name) {
 
 std::map<std::string, std::map<std::string, std::string>>
 get_computed_functions() {
-    return t_computed_column::computed_functions;
+    return t_computed_column::get_computed_functions();
+}
+
+void
+register_reducer_py(const std::string& name, t_val fn) {
+    // The reducer is copied and released by the threads processing updates,
+    // which do not hold the GIL.
+    std::shared_ptr<t_val> callback(new t_val(fn), [](t_val* ptr) {
+        py::gil_scoped_acquire acquire;
+        delete ptr;
+    });
+
+    get_evaluator()->register_reducer(name,
+        [name, callback](
+            const double* values, const t_uindex* offsets, t_uindex nnodes, double* out) {
+            py::gil_scoped_acquire acquire;
+            std::string error;
+            try {
+                py::array_t<double> py_values(offsets[nnodes], values);
+                py::array_t<std::uint64_t> py_offsets(
+                    nnodes + 1, reinterpret_cast<const std::uint64_t*>(offsets));
+                py::sequence result = (*callback)(py_values, py_offsets);
+                if (py::len(result) != nnodes) {
+                    error = "Reducer `" + name + "` must return one value per node.";
+                } else {
+                    for (t_uindex idx = 0; idx < nnodes; ++idx) {
+                        py::object value = result[idx];
+                        out[idx] = value.is_none() ? std::numeric_limits<double>::quiet_NaN()
+                                                    : value.cast<double>();
+                    }
+                }
+            } catch (const py::error_already_set& err) {
+                error = "Reducer `" + name + "` failed: " + err.what();
+            } catch (const py::cast_error& err) {
+                error = "Reducer `" + name + "` must return numbers: " + err.what();
+            }
+
+            if (!error.empty()) {
+                PSP_COMPLAIN_AND_ABORT(error);
+            }
+        });
+}
+
+void
+unregister_reducer_py(const std::string& name) {
+    get_evaluator()->unregister_reducer(name);
 }
 
 } //namespace binding
@@ -12,6 +12,7 @@
 #include <perspective/binding.h>
 #include <perspective/python/base.h>
 #include <perspective/python/context.h>
+#include <perspective/python/utils.h>
 
 namespace perspective {
 namespace binding {
@@ -24,7 +25,8 @@ namespace binding {
 template <>
 std::shared_ptr<t_ctx0>
 make_context(std::shared_ptr<Table> table, std::shared_ptr<t_schema> schema,
-    std::shared_ptr<t_view_config> view_config, const std::string& name) {
+    std::shared_ptr<t_view_config> view_config, const std::string& name,
+    bool deferred) {
     auto columns = view_config->get_columns();
     auto filter_op = view_config->get_filter_op();
     auto fterm = view_config->get_fterm();
@@ -32,6 +34,9 @@ make_context(std::shared_ptr<Table> table, std::shared_ptr<t_schema> schema,
     auto computed_columns = view_config->get_computed_columns();
 
     auto cfg = t_config(columns, fterm, filter_op, computed_columns);
+    if (view_config->get_filter_expr().num_terms() > 0) {
+        cfg.set_filter_expr(view_config->get_filter_expr());
+    }
     auto ctx0 = std::make_shared<t_ctx0>(*(schema.get()), cfg);
     ctx0->init();
     ctx0->sort_by(sortspec);
@@ -39,7 +44,7 @@ make_context(std::shared_ptr<Table> table, std::shared_ptr<t_schema> schema,
     auto pool = table->get_pool();
     auto gnode = table->get_gnode();
     pool->register_context(gnode->get_id(), name, ZERO_SIDED_CONTEXT,
-        reinterpret_cast<std::uintptr_t>(ctx0.get()));
+        reinterpret_cast<std::uintptr_t>(ctx0.get()), deferred);
 
     return ctx0;
 }
@@ -47,7 +52,8 @@ make_context(std::shared_ptr<Table> table, std::shared_ptr<t_schema> schema,
 template <>
 std::shared_ptr<t_ctx1>
 make_context(std::shared_ptr<Table> table, std::shared_ptr<t_schema> schema,
-    std::shared_ptr<t_view_config> view_config, const std::string& name) {
+    std::shared_ptr<t_view_config> view_config, const std::string& name,
+    bool deferred) {
     auto row_pivots = view_config->get_row_pivots();
     auto aggspecs = view_config->get_aggspecs();
     auto filter_op = view_config->get_filter_op();
@@ -57,6 +63,9 @@ make_context(std::shared_ptr<Table> table, std::shared_ptr<t_schema> schema,
     auto computed_columns = view_config->get_computed_columns();
 
     auto cfg = t_config(row_pivots, aggspecs, fterm, filter_op, computed_columns);
+    if (view_config->get_filter_expr().num_terms() > 0) {
+        cfg.set_filter_expr(view_config->get_filter_expr());
+    }
     auto ctx1 = std::make_shared<t_ctx1>(*(schema.get()), cfg);
 
     ctx1->init();
@@ -65,7 +74,7 @@ make_context(std::shared_ptr<Table> table, std::shared_ptr<t_schema> schema,
     auto pool = table->get_pool();
     auto gnode = table->get_gnode();
     pool->register_context(gnode->get_id(), name, ONE_SIDED_CONTEXT,
-        reinterpret_cast<std::uintptr_t>(ctx1.get()));
+        reinterpret_cast<std::uintptr_t>(ctx1.get()), deferred);
 
     if (row_pivot_depth > -1) {
         ctx1->set_depth(row_pivot_depth - 1);
@@ -79,7 +88,8 @@ make_context(std::shared_ptr<Table> table, std::shared_ptr<t_schema> schema,
 template <>
 std::shared_ptr<t_ctx2>
 make_context(std::shared_ptr<Table> table, std::shared_ptr<t_schema> schema,
-    std::shared_ptr<t_view_config> view_config, const std::string& name) {
+    std::shared_ptr<t_view_config> view_config, const std::string& name,
+    bool deferred) {
     bool column_only = view_config->is_column_only();
     auto row_pivots = view_config->get_row_pivots();
     auto column_pivots = view_config->get_column_pivots();
@@ -96,6 +106,9 @@ make_context(std::shared_ptr<Table> table, std::shared_ptr<t_schema> schema,
 
     auto cfg = t_config(
         row_pivots, column_pivots, aggspecs, total, fterm, filter_op, computed_columns, column_only);
+    if (view_config->get_filter_expr().num_terms() > 0) {
+        cfg.set_filter_expr(view_config->get_filter_expr());
+    }
     auto ctx2 = std::make_shared<t_ctx2>(*(schema.get()), cfg);
 
     ctx2->init();
@@ -103,7 +116,7 @@ make_context(std::shared_ptr<Table> table, std::shared_ptr<t_schema> schema,
     auto pool = table->get_pool();
     auto gnode = table->get_gnode();
     pool->register_context(gnode->get_id(), name, TWO_SIDED_CONTEXT,
-        reinterpret_cast<std::uintptr_t>(ctx2.get()));
+        reinterpret_cast<std::uintptr_t>(ctx2.get()), deferred);
 
     if (row_pivot_depth > -1) {
         ctx2->set_depth(t_header::HEADER_ROW, row_pivot_depth - 1);
@@ -128,6 +141,53 @@ make_context(std::shared_ptr<Table> table, std::shared_ptr<t_schema> schema,
     return ctx2;
 }
 
+std::shared_ptr<t_ctx_grouped_pkey>
+make_grouped_pkey_context(std::shared_ptr<Table> table, const std::string& name,
+    const std::vector<std::string>& columns, const std::string& parent,
+    const std::string& child, const std::string& label) {
+    auto cfg = t_config(columns, parent, child, label, std::vector<t_fterm>{}, FILTER_OP_AND);
+    auto ctx = std::make_shared<t_ctx_grouped_pkey>(table->get_schema(), cfg);
+    ctx->init();
+
+    py::gil_scoped_release release;
+    auto pool = table->get_pool();
+    auto gnode = table->get_gnode();
+    pool->register_context(gnode->get_id(), name, GROUPED_PKEY_CONTEXT,
+        reinterpret_cast<std::uintptr_t>(ctx.get()), false);
+
+    return ctx;
+}
+
+t_val
+get_grouped_pkey_data(std::shared_ptr<Table> table, std::shared_ptr<t_ctx_grouped_pkey> ctx) {
+    std::vector<t_tscalar> values;
+    t_index nrows;
+    t_index ncols;
+    {
+        py::gil_scoped_release release;
+        auto lock = table->get_pool()->lock_gnode(table->get_gnode()->get_id());
+        nrows = ctx->get_row_count();
+        ncols = ctx->get_column_count();
+        values = ctx->get_data(0, nrows, 0, ncols);
+    }
+
+    py::list rval;
+    for (t_index ridx = 0; ridx < nrows; ++ridx) {
+        py::list row;
+        for (t_index cidx = 0; cidx < ncols; ++cidx) {
+            row.append(scalar_to_py(values[ridx * ncols + cidx]));
+        }
+        rval.append(row);
+    }
+    return rval;
+}
+
+void
+unregister_grouped_pkey_context(std::shared_ptr<Table> table, const std::string& name) {
+    py::gil_scoped_release release;
+    table->get_pool()->unregister_context(table->get_gnode()->get_id(), name);
+}
+
 } //namespace binding
 } //namespace perspective
 
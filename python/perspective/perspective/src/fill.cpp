@@ -13,6 +13,7 @@
 #include <perspective/python/base.h>
 #include <perspective/python/fill.h>
 #include <perspective/python/utils.h>
+#include <limits>
 
 namespace perspective {
 namespace binding {
@@ -337,10 +338,175 @@ _fill_col_numeric(t_data_accessor accessor, t_data_table& tbl,
     }
 }
 
+/**
+ * @brief Fill `col` from a list of records or a dict of lists whose values
+ * are all of the exact builtin type of the column, or `None`, reading them
+ * through the CPython API rather than marshalling each value.
+ *
+ * Returns false, leaving the rest of the column to be filled by the
+ * accessor, on the first value of any other type or out of the column's
+ * range, e.g. a custom object, or an int32 that must be promoted.
+ */
+bool
+_fill_col_fast(t_data_accessor accessor, std::shared_ptr<t_column> col, std::string name,
+    std::int32_t cidx, t_dtype type, bool is_update) {
+#if PY_MAJOR_VERSION < 3
+    return false;
+#else
+    switch (type) {
+        case DTYPE_BOOL:
+        case DTYPE_STR:
+        case DTYPE_INT32:
+        case DTYPE_INT64:
+        case DTYPE_FLOAT32:
+        case DTYPE_FLOAT64:
+            break;
+        default:
+            return false;
+    }
+
+    // The implicit index is filled under the name of the primary key.
+    py::list names = accessor.attr("names")();
+    if (names[cidx].cast<std::string>() != name) {
+        return false;
+    }
+
+    std::int32_t format = accessor.attr("format")().cast<std::int32_t>();
+    t_val data = accessor.attr("data")();
+    py::str key(name);
+    t_uindex nrows = col->size();
+
+    // The values of the column, borrowed from `data`, and `nullptr` for a
+    // record without the column.
+    std::vector<PyObject*> items;
+    items.reserve(nrows);
+    if (format == 0) {
+        if (!PyList_CheckExact(data.ptr())
+            || static_cast<t_uindex>(PyList_GET_SIZE(data.ptr())) < nrows) {
+            return false;
+        }
+        for (t_uindex i = 0; i < nrows; ++i) {
+            PyObject* row = PyList_GET_ITEM(data.ptr(), i);
+            if (!PyDict_CheckExact(row)) {
+                return false;
+            }
+            items.push_back(PyDict_GetItem(row, key.ptr()));
+        }
+    } else if (format == 1) {
+        PyObject* column
+            = PyDict_CheckExact(data.ptr()) ? PyDict_GetItem(data.ptr(), key.ptr()) : nullptr;
+        if (!column || !PyList_CheckExact(column)) {
+            return false;
+        }
+        t_uindex size = PyList_GET_SIZE(column);
+        for (t_uindex i = 0; i < nrows; ++i) {
+            items.push_back(i < size ? PyList_GET_ITEM(column, i) : Py_None);
+        }
+    } else {
+        return false;
+    }
+
+    for (t_uindex i = 0; i < nrows; ++i) {
+        PyObject* item = items[i];
+        if (!item) {
+            continue;
+        }
+
+        if (item == Py_None || (PyFloat_CheckExact(item) && std::isnan(PyFloat_AS_DOUBLE(item)))) {
+            if (is_update) {
+                col->unset(i);
+            } else {
+                col->clear(i);
+            }
+            continue;
+        }
+
+        switch (type) {
+            case DTYPE_BOOL: {
+                if (item != Py_True && item != Py_False) {
+                    return false;
+                }
+                col->set_nth(i, item == Py_True);
+            } break;
+            case DTYPE_STR: {
+                if (!PyUnicode_CheckExact(item)) {
+                    return false;
+                }
+                const char* elem = PyUnicode_AsUTF8(item);
+                if (!elem) {
+                    PyErr_Clear();
+                    return false;
+                }
+                col->set_nth(i, elem);
+            } break;
+            case DTYPE_INT32:
+            case DTYPE_INT64: {
+                std::int64_t elem;
+                if (PyLong_CheckExact(item)) {
+                    int overflow = 0;
+                    elem = PyLong_AsLongLongAndOverflow(item, &overflow);
+                    if (overflow) {
+                        return false;
+                    }
+                } else if (PyFloat_CheckExact(item)) {
+                    // Floats update int columns truncated, as `int()` does.
+                    double fval = PyFloat_AS_DOUBLE(item);
+                    if (!(fval >= -9223372036854775808.0 && fval < 9223372036854775808.0)) {
+                        return false;
+                    }
+                    elem = static_cast<std::int64_t>(fval);
+                } else {
+                    return false;
+                }
+
+                if (type == DTYPE_INT64) {
+                    col->set_nth(i, elem);
+                } else if (elem < std::numeric_limits<std::int32_t>::min()
+                    || elem > std::numeric_limits<std::int32_t>::max()) {
+                    return false;
+                } else {
+                    col->set_nth(i, static_cast<std::int32_t>(elem));
+                }
+            } break;
+            case DTYPE_FLOAT32:
+            case DTYPE_FLOAT64: {
+                double elem;
+                if (PyFloat_CheckExact(item)) {
+                    elem = PyFloat_AS_DOUBLE(item);
+                } else if (PyLong_CheckExact(item)) {
+                    elem = PyLong_AsDouble(item);
+                    if (elem == -1.0 && PyErr_Occurred()) {
+                        PyErr_Clear();
+                        return false;
+                    }
+                } else {
+                    return false;
+                }
+
+                if (type == DTYPE_FLOAT64) {
+                    col->set_nth(i, elem);
+                } else {
+                    col->set_nth(i, static_cast<float>(elem));
+                }
+            } break;
+            default:
+                return false;
+        }
+    }
+
+    return true;
+#endif
+}
+
 void
 _fill_data_helper(t_data_accessor accessor, t_data_table& tbl,
     std::shared_ptr<t_column> col, std::string name, std::int32_t cidx, t_dtype type, bool is_update) {
     switch (type) {
+    // Columns of mixed types are filled from the first row by the accessor.
+    if (_fill_col_fast(accessor, col, name, cidx, type, is_update)) {
+        return;
+    }
+
         case DTYPE_BOOL: {
             _fill_col_bool(accessor, col, name, cidx, type, is_update);
         } break;
@@ -9,6 +9,8 @@
 #ifdef PSP_ENABLE_PYTHON
 #include <perspective/python/fill.h>
 #include <perspective/python/numpy.h>
+#include <cctype>
+#include <limits>
 
 using namespace perspective;
 
@@ -148,37 +150,53 @@ namespace numpy {
         std::uint64_t* mask_ptr = (std::uint64_t*) mask.data();
         std::size_t mask_size = mask.size();
 
+        // Categorical string columns skip `marshal` entirely.
+        if (type == DTYPE_STR) {
+            t_val categorical = m_accessor.attr("_get_categorical_column")(name);
+            if (!categorical.is_none()) {
+                py::dict codes_and_categories = categorical.cast<py::dict>();
+                fill_categorical(col, codes_and_categories["codes"].cast<py::array>(),
+                    codes_and_categories["categories"].cast<py::list>(), is_update);
+                return;
+            }
+        }
+
         // Check array dtype to make sure that `deconstruct_numpy` didn't cast it to an object.
         if (array.dtype().kind() == 'O') {
             fill_column_iter(array, tbl, col, name, DTYPE_OBJECT, type, cidx, is_update);
             return;
         }
 
-        // Datetimes are not trivially copyable - they are float64 values that need to be read as int64
+        // Everything below reads `array.data()` directly, so a strided array (a column sliced out of a 2D array or
+        // a DataFrame, for example) is copied into a C-contiguous one first.
+        array = py::array::ensure(array, py::array::c_style);
+
+        // Datetimes are not trivially copyable - they are int64 values in the array's unit that are rescaled into milliseconds
         if (type == DTYPE_TIME || type == DTYPE_DATE) {
             fill_column_iter(array, tbl, col, name, np_dtype, type, cidx, is_update);
             fill_validity_map(col, mask_ptr, mask_size, is_update);
             return;
         }
         
-         /**
-         * Catch common type mismatches and fill iteratively when a numpy dtype is of greater bit width than the Perspective t_dtype:
+        /**
+         * When a numpy dtype differs from the Perspective `t_dtype`, cast the values in one pass over the array
+         * instead of marshalling each one through Python, e.g.:
          * - when `np_dtype` is int64 and `t_dtype` is `DTYPE_INT32` or `DTYPE_FLOAT64`
          * - when `np_dtype` is int32 and `t_dtype` is `DTYPE_INT64` or `DTYPE_FLOAT64`, which can happen on windows where np::int_ is int32
          * - when `np_dtype` is float64 and `t_dtype` is `DTYPE_INT32` or `DTYPE_INT64`
-         * - when `type` is float64 and `np_dtype` is `DTYPE_FLOAT32` or `DTYPE_FLOAT64`
-         * 
-         * These errors occur frqeuently when a Table is created from non-numpy data or schema, then updated with a numpy array.
+         * - when `np_dtype` is float32 and `t_dtype` is `DTYPE_FLOAT64`
+         *
+         * These occur frequently when a Table is created from non-numpy data or schema, then updated with a numpy array.
          * In these cases, the `t_dtype` of the Table supercedes the array dtype.
          */
-        bool should_iter = (np_dtype == DTYPE_INT64 && (type == DTYPE_INT32 || type == DTYPE_FLOAT64)) || \
-            (np_dtype == DTYPE_INT32 && (type == DTYPE_INT64 || type == DTYPE_FLOAT64)) || \
-            (np_dtype == DTYPE_FLOAT64 && (type == DTYPE_INT32 || type == DTYPE_INT64)) || \
-            (type == DTYPE_INT64 && (np_dtype == DTYPE_FLOAT32 || np_dtype == DTYPE_FLOAT64));
-
-        if (should_iter) {
-            // Skip straight to numeric fill
-            fill_numeric_iter(array, tbl, col, name, np_dtype, type, cidx, is_update);
+        if (np_dtype != type) {
+            if (fill_numeric_convert(array, tbl, col, name, np_dtype, type, is_update) == t_fill_status::FILL_SUCCESS) {
+                // `fill_numeric_convert` may have promoted the column
+                fill_validity_map(tbl.get_column(name), mask_ptr, mask_size, is_update);
+                return;
+            }
+        } else if (try_borrow_array(array, col, type, mask_size)) {
+            col->valid_raw_fill();
             return;
         }
 
@@ -330,8 +348,8 @@ namespace numpy {
                 }
             } break;
             case DTYPE_DATE: {
-                // `datetime.date` objects or `datetime64[D/W/M/Y]`, always fill by using `marshal`.
-                fill_date_iter(col, name, np_dtype, type, cidx, is_update);
+                // `datetime64` arrays are converted directly, and `datetime.date` objects or strings by using `marshal`.
+                fill_date_iter(array, col, name, np_dtype, type, cidx, is_update);
             } break;
             case DTYPE_BOOL: {
                 if (np_dtype == DTYPE_OBJECT) {
@@ -352,27 +370,130 @@ namespace numpy {
         }
     }
 
-    // `array.dtype=datetime64[ns/us/ms/s]`
+    /******************************************************************************
+     *
+     * Rescale numpy datetime64 arrays into millisecond timestamps and dates
+     */
+    namespace {
+        const std::int64_t NUMPY_DATETIME_NAT = std::numeric_limits<std::int64_t>::min();
+        const std::int64_t MS_PER_DAY = 86400000;
+
+        /**
+         * Read the unit of a `datetime64` array, e.g. `<M8[ns]` or `<M8[10ms]`, as the fraction
+         * `numerator / denominator` of milliseconds in one unit. Months and years are not of a fixed
+         * length, so return false.
+         */
+        bool
+        get_datetime_scale(const py::array& array, std::int64_t& numerator, std::int64_t& denominator) {
+            std::string descr = array.dtype().attr("str").cast<std::string>();
+            std::size_t begin = descr.find('[');
+            std::size_t end = descr.find(']');
+            if (begin == std::string::npos || end == std::string::npos || end <= begin + 1) {
+                return false;
+            }
+
+            std::string unit = descr.substr(begin + 1, end - begin - 1);
+            std::size_t digits = 0;
+            while (digits < unit.size() && std::isdigit(unit[digits])) {
+                ++digits;
+            }
+            numerator = digits > 0 ? std::stoll(unit.substr(0, digits)) : 1;
+            denominator = 1;
+            unit = unit.substr(digits);
+
+            if (unit == "ns") {
+                denominator = 1000000;
+            } else if (unit == "us") {
+                denominator = 1000;
+            } else if (unit == "ms") {
+            } else if (unit == "s") {
+                numerator *= 1000;
+            } else if (unit == "m") {
+                numerator *= 60000;
+            } else if (unit == "h") {
+                numerator *= 3600000;
+            } else if (unit == "D") {
+                numerator *= MS_PER_DAY;
+            } else if (unit == "W") {
+                numerator *= 7 * MS_PER_DAY;
+            } else {
+                return false;
+            }
+            return true;
+        }
+
+        // Truncates toward zero, as casting the float timestamp did, without overflowing on nanoseconds.
+        inline std::int64_t
+        rescale_datetime(std::int64_t value, std::int64_t numerator, std::int64_t denominator) {
+            return value / denominator * numerator + value % denominator * numerator / denominator;
+        }
+
+        /**
+         * The proleptic Gregorian date of `days` since epoch, with `month` in [1-12], using only integer
+         * arithmetic over 400-year eras.
+         */
+        void
+        civil_from_days(std::int64_t days, std::int32_t& year, std::int32_t& month, std::int32_t& day) {
+            days += 719468;
+            const std::int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+            const std::int64_t doe = days - era * 146097;
+            const std::int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+            const std::int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+            const std::int64_t mp = (5 * doy + 2) / 153;
+            day = static_cast<std::int32_t>(doy - (153 * mp + 2) / 5 + 1);
+            month = static_cast<std::int32_t>(mp < 10 ? mp + 3 : mp - 9);
+            year = static_cast<std::int32_t>(yoe + era * 400 + (month <= 2));
+        }
+    } // namespace
+
+    // `array.dtype=datetime64[ns/us/ms/s/m/h/D/W]`, rescaled into milliseconds in one pass.
     void
     NumpyLoader::fill_datetime_iter(const py::array& array, t_data_table& tbl, std::shared_ptr<t_column> col, 
         const std::string& name, t_dtype np_dtype, t_dtype type, std::uint32_t cidx, bool is_update) {
         PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
         t_uindex nrows = col->size();
 
-        // read the array as a double array because of `numpy.nat`
-        double* ptr = (double*) array.data();
+        std::int64_t numerator;
+        std::int64_t denominator;
+        if (!get_datetime_scale(array, numerator, denominator)) {
+            fill_object_iter<std::int64_t>(tbl, col, name, np_dtype, type, cidx, is_update);
+            return;
+        }
 
-        for (auto i = 0; i < nrows; ++i) {
-            std::int64_t item = ptr[i]; // Perspective stores datetimes using int64
-            col->set_nth(i, item);
+        // `numpy.nat` is cleared by the null mask afterwards.
+        const std::int64_t* ptr = (const std::int64_t*) array.data();
+        std::int64_t* dest_ptr = col->get_nth<std::int64_t>(0);
+        for (t_uindex i = 0; i < nrows; ++i) {
+            std::int64_t item = ptr[i];
+            dest_ptr[i] = item == NUMPY_DATETIME_NAT ? 0 : rescale_datetime(item, numerator, denominator);
         }
+        col->valid_raw_fill();
     }
 
     void
-    NumpyLoader::fill_date_iter(std::shared_ptr<t_column> col, const std::string& name, t_dtype np_dtype, t_dtype type, std::uint32_t cidx, bool is_update) {
+    NumpyLoader::fill_date_iter(const py::array& array, std::shared_ptr<t_column> col, const std::string& name, t_dtype np_dtype, t_dtype type, std::uint32_t cidx, bool is_update) {
         PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
         t_uindex nrows = col->size();
 
+        // `datetime64` arrays are converted to days since epoch, then to dates, without `marshal`.
+        std::int64_t numerator;
+        std::int64_t denominator;
+        if (array.dtype().kind() == 'M' && get_datetime_scale(array, numerator, denominator)) {
+            const std::int64_t* ptr = (const std::int64_t*) array.data();
+            std::int32_t year, month, day;
+            for (t_uindex i = 0; i < nrows; ++i) {
+                if (ptr[i] == NUMPY_DATETIME_NAT) {
+                    continue;
+                }
+
+                std::int64_t ms = rescale_datetime(ptr[i], numerator, denominator);
+                std::int64_t days = ms / MS_PER_DAY - (ms % MS_PER_DAY < 0 ? 1 : 0);
+                civil_from_days(days, year, month, day);
+                col->set_nth(i, t_date(year, month - 1, day));
+            }
+            return;
+        }
+
         for (auto i = 0; i < nrows; ++i) {
             t_val item = m_accessor.attr("marshal")(cidx, i, type);
 
@@ -519,6 +640,44 @@ namespace numpy {
         }
     }
 
+    void
+    NumpyLoader::fill_categorical(std::shared_ptr<t_column> col, const py::array& codes, const py::list& categories, bool is_update) {
+        std::vector<std::string> names;
+        names.reserve(categories.size());
+        t_uindex names_size = 0;
+        for (const auto& category : categories) {
+            names.push_back(category.cast<std::string>());
+            names_size += names.back().size() + 1;
+        }
+
+        col->reserve_vocabulary(names_size, names.size());
+        std::vector<t_stridx> ids;
+        ids.reserve(names.size());
+        for (const std::string& name : names) {
+            ids.push_back(col->get_interned(name));
+        }
+
+        py::array_t<std::int64_t, py::array::c_style | py::array::forcecast> codes_array(codes);
+        const std::int64_t* codes_ptr = codes_array.data();
+        t_uindex nrows = std::min<t_uindex>(col->size(), codes_array.size());
+        std::int64_t ncategories = ids.size();
+
+        for (t_uindex i = 0; i < nrows; ++i) {
+            std::int64_t code = codes_ptr[i];
+
+            if (code < 0 || code >= ncategories) {
+                if (is_update) {
+                    col->unset(i);
+                } else {
+                    col->clear(i);
+                }
+                continue;
+            }
+
+            col->set_nth<t_stridx>(i, ids[code]);
+        }
+    }
+
     /******************************************************************************
      *
      * Copy numpy arrays into columns
@@ -568,6 +727,211 @@ namespace numpy {
         return t_fill_status::FILL_SUCCESS;
     }
 
+    /******************************************************************************
+     *
+     * Borrow numpy arrays as the backing store of columns
+     */
+    namespace {
+        /**
+         * Release the reference to a borrowed array. A column can let go of its array on a worker thread while the
+         * thread that holds the GIL waits on it, so unless this thread holds the GIL, the reference is handed to the
+         * interpreter to drop.
+         */
+        void
+        release_array(py::object* array) {
+            if (PyGILState_Check()) {
+                delete array;
+                return;
+            }
+
+            int status = Py_AddPendingCall([](void* arg) -> int {
+                delete static_cast<py::object*>(arg);
+                return 0;
+            }, array);
+
+            if (status != 0) {
+                py::gil_scoped_acquire acquire;
+                delete array;
+            }
+        }
+    } // namespace
+
+    bool
+    NumpyLoader::try_borrow_array(const py::array& src, std::shared_ptr<t_column> dest, t_dtype type, std::size_t mask_size) {
+        PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+
+        switch (type) {
+            case DTYPE_BOOL:
+            case DTYPE_UINT8:
+            case DTYPE_UINT16:
+            case DTYPE_UINT32:
+            case DTYPE_UINT64:
+            case DTYPE_INT8:
+            case DTYPE_INT16:
+            case DTYPE_INT32:
+            case DTYPE_INT64:
+            case DTYPE_FLOAT32:
+            case DTYPE_FLOAT64:
+                break;
+            default:
+                return false;
+        }
+
+        // Clearing a null writes to the column, which would copy the array straight back out.
+        if (mask_size > 0 || static_cast<t_uindex>(src.size()) != dest->size()) {
+            return false;
+        }
+
+        t_uindex itemsize = get_dtype_size(type);
+        if (static_cast<t_uindex>(src.itemsize()) != itemsize || !(src.flags() & py::array::c_style)
+            || reinterpret_cast<std::uintptr_t>(src.data()) % itemsize != 0) {
+            return false;
+        }
+
+        std::shared_ptr<const void> owner(new py::object(src), release_array);
+        dest->borrow_data(src.data(), dest->size(), owner);
+        return true;
+    }
+
+    /******************************************************************************
+     *
+     * Cast numpy arrays into columns of a different numeric type
+     */
+    namespace {
+        template <typename DST, typename SRC>
+        inline DST
+        cast_value(SRC value, std::false_type) {
+            return static_cast<DST>(value);
+        }
+
+        // Casting NaN to an integer is undefined; the row is cleared by the null mask afterwards.
+        template <typename DST, typename SRC>
+        inline DST
+        cast_value(SRC value, std::true_type) {
+            return std::isnan(value) ? DST(0) : static_cast<DST>(value);
+        }
+
+        template <typename DST, typename SRC>
+        void
+        cast_values(const SRC* src, std::shared_ptr<t_column> dest, t_uindex nrows) {
+            typedef std::integral_constant<bool,
+                std::is_floating_point<SRC>::value && std::is_integral<DST>::value> t_float_to_int;
+            DST* dest_ptr = dest->get_nth<DST>(0);
+
+            for (t_uindex i = 0; i < nrows; ++i) {
+                dest_ptr[i] = cast_value<DST>(src[i], t_float_to_int());
+            }
+        }
+
+        template <typename SRC>
+        bool
+        fits_int32(const SRC* src, t_uindex nrows) {
+            for (t_uindex i = 0; i < nrows; ++i) {
+                double value = static_cast<double>(src[i]);
+                if (value > 2147483647 || value < -2147483648) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        template <typename SRC>
+        t_fill_status
+        convert_array(const py::array& array, t_data_table& tbl, std::shared_ptr<t_column> col,
+            const std::string& name, t_dtype type, bool is_update) {
+            const SRC* src = static_cast<const SRC*>(array.data());
+            t_uindex nrows = std::min<t_uindex>(col->size(), array.size());
+
+            if (type == DTYPE_INT32 && !is_update && !fits_int32(src, nrows)) {
+                binding::WARN("Promoting column `%s` to float from int32", name);
+                tbl.promote_column(name, DTYPE_FLOAT64, 0, false);
+                col = tbl.get_column(name);
+                type = DTYPE_FLOAT64;
+            }
+
+            switch (type) {
+                case DTYPE_UINT8: {
+                    cast_values<std::uint8_t>(src, col, nrows);
+                } break;
+                case DTYPE_UINT16: {
+                    cast_values<std::uint16_t>(src, col, nrows);
+                } break;
+                case DTYPE_UINT32: {
+                    cast_values<std::uint32_t>(src, col, nrows);
+                } break;
+                case DTYPE_UINT64: {
+                    cast_values<std::uint64_t>(src, col, nrows);
+                } break;
+                case DTYPE_INT8: {
+                    cast_values<std::int8_t>(src, col, nrows);
+                } break;
+                case DTYPE_INT16: {
+                    cast_values<std::int16_t>(src, col, nrows);
+                } break;
+                case DTYPE_INT32: {
+                    cast_values<std::int32_t>(src, col, nrows);
+                } break;
+                case DTYPE_INT64: {
+                    cast_values<std::int64_t>(src, col, nrows);
+                } break;
+                case DTYPE_FLOAT32: {
+                    cast_values<float>(src, col, nrows);
+                } break;
+                case DTYPE_FLOAT64: {
+                    cast_values<double>(src, col, nrows);
+                } break;
+                default: {
+                    return t_fill_status::FILL_FAIL;
+                }
+            }
+
+            return t_fill_status::FILL_SUCCESS;
+        }
+    } // namespace
+
+    t_fill_status
+    NumpyLoader::fill_numeric_convert(const py::array& array, t_data_table& tbl, std::shared_ptr<t_column> col,
+        const std::string& name, t_dtype np_dtype, t_dtype type, bool is_update) {
+        PSP_VERBOSE_ASSERT(m_init, "touching uninited object");
+
+        switch (np_dtype) {
+            case DTYPE_UINT8: {
+                return convert_array<std::uint8_t>(array, tbl, col, name, type, is_update);
+            } break;
+            case DTYPE_UINT16: {
+                return convert_array<std::uint16_t>(array, tbl, col, name, type, is_update);
+            } break;
+            case DTYPE_UINT32: {
+                return convert_array<std::uint32_t>(array, tbl, col, name, type, is_update);
+            } break;
+            case DTYPE_UINT64: {
+                return convert_array<std::uint64_t>(array, tbl, col, name, type, is_update);
+            } break;
+            case DTYPE_INT8: {
+                return convert_array<std::int8_t>(array, tbl, col, name, type, is_update);
+            } break;
+            case DTYPE_INT16: {
+                return convert_array<std::int16_t>(array, tbl, col, name, type, is_update);
+            } break;
+            case DTYPE_INT32: {
+                return convert_array<std::int32_t>(array, tbl, col, name, type, is_update);
+            } break;
+            case DTYPE_INT64: {
+                return convert_array<std::int64_t>(array, tbl, col, name, type, is_update);
+            } break;
+            case DTYPE_FLOAT32: {
+                return convert_array<float>(array, tbl, col, name, type, is_update);
+            } break;
+            case DTYPE_FLOAT64: {
+                return convert_array<double>(array, tbl, col, name, type, is_update);
+            } break;
+            default: {
+                return t_fill_status::FILL_FAIL;
+            }
+        }
+    }
+
     void
     NumpyLoader::fill_validity_map(
         std::shared_ptr<t_column> col, std::uint64_t* mask_ptr, std::size_t mask_size, bool is_update) {
@@ -13,6 +13,9 @@
 #include <perspective/python/serialization.h>
 #include <perspective/python/base.h>
 #include <perspective/python/utils.h>
+#include <ctime>
+#include <limits>
+#include <unordered_map>
 
 namespace perspective {
 namespace binding {
@@ -25,6 +28,7 @@ template <typename CTX_T>
 std::shared_ptr<t_data_slice<CTX_T>>
 get_data_slice(std::shared_ptr<View<CTX_T>> view, std::uint32_t start_row,
     std::uint32_t end_row, std::uint32_t start_col, std::uint32_t end_col) {
+    py::gil_scoped_release release;
     auto data_slice = view->get_data(start_row, end_row, start_col, end_col);
     return data_slice;
 }
@@ -99,6 +103,212 @@ get_pkeys_from_data_slice_ctx2(std::shared_ptr<t_data_slice<t_ctx2>> data_slice,
     return get_pkeys_from_data_slice<t_ctx2>(data_slice, ridx, cidx);
 }
 
+namespace {
+
+/**
+ * @brief Returns the number of days between 1970-01-01 and the civil date
+ * `year`-`month`-`day`, where `month` is 1-12.
+ */
+std::int64_t
+days_from_civil(std::int64_t year, std::int64_t month, std::int64_t day) {
+    year -= month <= 2;
+    std::int64_t era = (year >= 0 ? year : year - 399) / 400;
+    std::int64_t yoe = year - era * 400;
+    std::int64_t doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    std::int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+// Offsets from UTC only change on a quarter hour, so one is looked up per
+// quarter hour rather than per value.
+const std::int64_t LOCAL_OFFSET_PERIOD_MS = 15 * 60 * 1000;
+
+/**
+ * @brief Converts milliseconds since epoch in UTC to the local wall clock
+ * time, in the same way that pybind converts a `time_point` to a naive
+ * `datetime.datetime`.
+ */
+class t_local_time {
+public:
+    t_local_time()
+        : m_period(std::numeric_limits<std::int64_t>::min())
+        , m_offset(0) {}
+
+    std::int64_t
+    operator()(std::int64_t ms) {
+        std::int64_t period = ms >= 0
+            ? ms / LOCAL_OFFSET_PERIOD_MS
+            : (ms - LOCAL_OFFSET_PERIOD_MS + 1) / LOCAL_OFFSET_PERIOD_MS;
+
+        if (period != m_period) {
+            std::time_t seconds = static_cast<std::time_t>(period * (LOCAL_OFFSET_PERIOD_MS / 1000));
+            std::tm* local = std::localtime(&seconds);
+            std::int64_t wall = days_from_civil(
+                local->tm_year + 1900, local->tm_mon + 1, local->tm_mday) * 86400
+                + local->tm_hour * 3600 + local->tm_min * 60 + local->tm_sec;
+            m_offset = (wall - std::int64_t(seconds)) * 1000;
+            m_period = period;
+        }
+
+        return ms + m_offset;
+    }
+
+private:
+    std::int64_t m_period;
+    std::int64_t m_offset;
+};
+
+} // end anonymous namespace
+
+template <typename CTX_T>
+py::tuple
+get_column_from_data_slice(std::shared_ptr<t_data_slice<CTX_T>> data_slice, t_uindex cidx,
+    t_uindex start_row, t_uindex end_row) {
+    t_uindex nrows = end_row > start_row ? end_row - start_row : 0;
+    std::vector<t_tscalar> values;
+    values.reserve(nrows);
+
+    t_dtype dtype = DTYPE_NONE;
+    bool has_null = false;
+    bool is_mixed = false;
+
+    for (t_uindex ridx = start_row; ridx < end_row; ++ridx) {
+        values.push_back(data_slice->get(ridx, cidx));
+        const t_tscalar& value = values.back();
+
+        if (!value.is_valid()) {
+            has_null = true;
+        } else if (dtype == DTYPE_NONE) {
+            dtype = value.get_dtype();
+        } else if (value.get_dtype() != dtype) {
+            is_mixed = true;
+        }
+    }
+
+    bool is_int = false;
+    switch (dtype) {
+        case DTYPE_INT64:
+        case DTYPE_INT32:
+        case DTYPE_INT16:
+        case DTYPE_INT8:
+        case DTYPE_UINT64:
+        case DTYPE_UINT32:
+        case DTYPE_UINT16:
+        case DTYPE_UINT8: is_int = true; break;
+        default: break;
+    }
+
+    bool is_typed = is_int || dtype == DTYPE_FLOAT64 || dtype == DTYPE_FLOAT32
+        || dtype == DTYPE_TIME || dtype == DTYPE_DATE || dtype == DTYPE_STR
+        || (dtype == DTYPE_BOOL && !has_null);
+
+    // Columns without a single type, such as those with no valid values,
+    // are returned as Python values.
+    if (is_mixed || !is_typed) {
+        py::list rval;
+        for (const t_tscalar& value : values) {
+            rval.append(scalar_to_py(value));
+        }
+
+        return py::make_tuple(rval, py::none());
+    }
+
+    if (dtype == DTYPE_STR) {
+        py::array_t<std::int32_t> codes(nrows);
+        std::int32_t* out = codes.mutable_data();
+        py::list categories;
+        std::unordered_map<std::string, std::int32_t> category_map;
+
+        for (t_uindex idx = 0; idx < nrows; ++idx) {
+            if (!values[idx].is_valid()) {
+                out[idx] = -1;
+                continue;
+            }
+
+            std::string value = values[idx].get_char_ptr();
+            auto it = category_map.find(value);
+            if (it == category_map.end()) {
+                it = category_map.emplace(value, category_map.size()).first;
+                categories.append(py::str(value));
+            }
+
+            out[idx] = it->second;
+        }
+
+        return py::make_tuple(codes, categories);
+    }
+
+    if (dtype == DTYPE_BOOL) {
+        py::array_t<bool> rval(nrows);
+        bool* out = rval.mutable_data();
+        for (t_uindex idx = 0; idx < nrows; ++idx) {
+            out[idx] = values[idx].get<bool>();
+        }
+
+        return py::make_tuple(rval, py::none());
+    }
+
+    if (dtype == DTYPE_TIME || dtype == DTYPE_DATE) {
+        py::array_t<std::int64_t> rval(nrows);
+        std::int64_t* out = rval.mutable_data();
+        t_local_time local_time;
+
+        for (t_uindex idx = 0; idx < nrows; ++idx) {
+            const t_tscalar& value = values[idx];
+            if (!value.is_valid()) {
+                // NaT
+                out[idx] = std::numeric_limits<std::int64_t>::min();
+            } else if (dtype == DTYPE_TIME) {
+                out[idx] = local_time(value.to_int64());
+            } else {
+                t_date date = value.get<t_date>();
+                out[idx] = days_from_civil(date.year(), date.month() + 1, date.day()) * 86400000;
+            }
+        }
+
+        return py::make_tuple(rval.attr("view")("datetime64[ms]"), py::none());
+    }
+
+    // Nulls become NaN, so integer columns with nulls are returned as floats
+    // as in pandas.
+    if (is_int && !has_null) {
+        py::array_t<std::int64_t> rval(nrows);
+        std::int64_t* out = rval.mutable_data();
+        for (t_uindex idx = 0; idx < nrows; ++idx) {
+            out[idx] = values[idx].to_int64();
+        }
+
+        return py::make_tuple(rval, py::none());
+    }
+
+    py::array_t<double> rval(nrows);
+    double* out = rval.mutable_data();
+    for (t_uindex idx = 0; idx < nrows; ++idx) {
+        const t_tscalar& value = values[idx];
+        out[idx] = value.is_valid() ? value.to_double() : std::numeric_limits<double>::quiet_NaN();
+    }
+
+    return py::make_tuple(rval, py::none());
+}
+
+py::tuple
+get_column_from_data_slice_ctx0(std::shared_ptr<t_data_slice<t_ctx0>> data_slice, t_uindex cidx,
+    t_uindex start_row, t_uindex end_row) {
+    return get_column_from_data_slice<t_ctx0>(data_slice, cidx, start_row, end_row);
+}
+
+py::tuple
+get_column_from_data_slice_ctx1(std::shared_ptr<t_data_slice<t_ctx1>> data_slice, t_uindex cidx,
+    t_uindex start_row, t_uindex end_row) {
+    return get_column_from_data_slice<t_ctx1>(data_slice, cidx, start_row, end_row);
+}
+
+py::tuple
+get_column_from_data_slice_ctx2(std::shared_ptr<t_data_slice<t_ctx2>> data_slice, t_uindex cidx,
+    t_uindex start_row, t_uindex end_row) {
+    return get_column_from_data_slice<t_ctx2>(data_slice, cidx, start_row, end_row);
+}
+
 } // end namespace binding
 } // end namespace perspective
 
@@ -11,12 +11,14 @@
 #include <perspective/arrow_loader.h>
 #include <perspective/base.h>
 #include <perspective/binding.h>
+#include <perspective/csv_loader.h>
 #include <perspective/python/accessor.h>
 #include <perspective/python/base.h>
 #include <perspective/python/fill.h>
 #include <perspective/python/numpy.h>
 #include <perspective/python/table.h>
 #include <perspective/python/utils.h>
+#include <perspective/python/view.h>
 
 namespace perspective {
 namespace binding {
@@ -27,7 +29,8 @@ namespace binding {
  */
 
 std::shared_ptr<Table> make_table_py(t_val table, t_data_accessor accessor,
-        std::uint32_t limit, py::str index, t_op op, bool is_update, bool is_arrow, t_uindex port_id) {
+        std::uint32_t limit, py::str index, t_op op, bool is_update, bool is_arrow, t_uindex port_id,
+        std::vector<std::string> columns) {
     bool table_initialized = !table.is_none();
     std::shared_ptr<t_pool> pool;
     std::shared_ptr<Table> tbl;
@@ -46,10 +49,17 @@ std::shared_ptr<Table> make_table_py(t_val table, t_data_accessor accessor,
     std::vector<std::string> column_names;
     std::vector<t_dtype> data_types;
     arrow::ArrowLoader arrow_loader;
+    csv::CsvLoader csv_loader;
     numpy::NumpyLoader numpy_loader(accessor);
 
-    // don't call `is_numpy` on an arrow binary
-    bool is_numpy = !is_arrow && accessor.attr("_is_numpy").cast<bool>();
+    // CSV text is passed directly instead of through an accessor
+    bool is_csv = !is_arrow && py::isinstance<py::str>(accessor);
+
+    // `csv_loader` points into the text, so keep it alive until filled
+    std::string csv_text;
+
+    // don't call `is_numpy` on an arrow binary or CSV text
+    bool is_numpy = !is_arrow && !is_csv && accessor.attr("_is_numpy").cast<bool>();
 
     // Determine metadata
     bool is_delete = op == OP_DELETE;
@@ -58,7 +68,20 @@ std::shared_ptr<Table> make_table_py(t_val table, t_data_accessor accessor,
         std::int32_t size = bytes.attr("__len__")().cast<std::int32_t>();
         void * ptr = malloc(size);
         std::memcpy(ptr, bytes.cast<std::string>().c_str(), size);
-        arrow_loader.initialize((uintptr_t)ptr, size);
+
+        if (arrow::is_parquet((uintptr_t)ptr, size)) {
+            // Only read the columns of the `Table` on update
+            if (table_initialized && is_update) {
+                columns = gnode->get_output_schema().columns();
+                columns.push_back("__INDEX__");
+            }
+
+            py::gil_scoped_release release;
+            arrow_loader.initialize_parquet((uintptr_t)ptr, size, columns, true);
+        } else {
+            py::gil_scoped_release release;
+            arrow_loader.initialize((uintptr_t)ptr, size, true);
+        }
 
         // Always use the `Table` column names and data types on update.
         if (table_initialized && is_update) {
@@ -104,6 +127,22 @@ std::shared_ptr<Table> make_table_py(t_val table, t_data_accessor accessor,
             column_names = arrow_loader.names();
             data_types = arrow_loader.types();
         }
+    } else if (is_csv && !is_delete) {
+        csv_text = accessor.cast<std::string>();
+        {
+            py::gil_scoped_release release;
+            csv_loader.initialize(csv_text.data(), csv_text.size());
+        }
+
+        // Always use the `Table` column names and data types on update.
+        if (table_initialized && is_update) {
+            auto schema = gnode->get_output_schema().drop({"psp_okey"});
+            column_names = schema.columns();
+            data_types = schema.types();
+        } else {
+            column_names = csv_loader.names();
+            data_types = csv_loader.types();
+        }
     } else if (is_update || is_delete) {
         /**
          * Use the names and types of the python accessor when updating/deleting.
@@ -169,31 +208,131 @@ std::shared_ptr<Table> make_table_py(t_val table, t_data_accessor accessor,
 
     // Create output schema - contains only columns to be displayed to the user
     t_schema output_schema(column_names, data_types); // names + types might have been mutated at this point after implicit index removal
-    t_data_table data_table(output_schema);
-    data_table.init();
+    auto data_table = std::make_shared<t_data_table>(output_schema);
+    data_table->init();
     std::uint32_t row_count;
     if (is_arrow) {
         row_count = arrow_loader.row_count();
-        data_table.extend(arrow_loader.row_count());
+        data_table->extend(arrow_loader.row_count());
+
+        // Decimals are loaded as fixed-point columns, and updates are
+        // rescaled to the scale of the table's columns.
+        if (table_initialized) {
+            arrow_loader.set_scales(tbl->get_column_scales());
+        } else {
+            for (const auto& scale : arrow_loader.scales()) {
+                if (scale.first != "__INDEX__") {
+                    tbl->set_column_scale(scale.first, scale.second);
+                }
+            }
+        }
+
+        py::gil_scoped_release release;
+        arrow_loader.fill_table(*data_table, index, offset, limit, is_update);
+    } else if (is_csv) {
+        row_count = csv_loader.row_count();
+        data_table->extend(row_count);
 
-        arrow_loader.fill_table(data_table, index, offset, limit, is_update);
+        py::gil_scoped_release release;
+        csv_loader.fill_table(*data_table, index, offset, limit, is_update);
     } else if (is_numpy) {
         row_count = numpy_loader.row_count();
-        data_table.extend(row_count);
-        numpy_loader.fill_table(data_table, input_schema, index, offset, limit, is_update);
+        data_table->extend(row_count);
+        numpy_loader.fill_table(*data_table, input_schema, index, offset, limit, is_update);
     } else {
         row_count = accessor.attr("row_count")().cast<std::int32_t>();
-        data_table.extend(row_count);
-        _fill_data(data_table, accessor, input_schema, index, offset, limit, is_update);
+        data_table->extend(row_count);
+        _fill_data(*data_table, accessor, input_schema, index, offset, limit, is_update);
     }
 
-    // calculate offset, limit, and set the gnode
-    tbl->init(data_table, row_count, op, port_id);
+    // calculate offset, limit, and set the gnode. Sending hands the table
+    // to the gnode's port, which needs no GIL.
+    {
+        py::gil_scoped_release release;
+        tbl->init(std::move(data_table), row_count, op, port_id);
+    }
 
     //pool->_process();
     return tbl;
 }
 
+namespace {
+void
+read_generator_column(py::dict spec, t_generator_column& column) {
+    if (spec.contains("cardinality")) {
+        column.m_cardinality = spec["cardinality"].cast<t_uindex>();
+    }
+    if (spec.contains("null_ratio")) {
+        column.m_null_ratio = spec["null_ratio"].cast<double>();
+    }
+    if (spec.contains("string_length")) {
+        column.m_string_length = spec["string_length"].cast<t_uindex>();
+    }
+    if (spec.contains("sortedness")) {
+        column.m_sortedness = spec["sortedness"].cast<double>();
+    }
+}
+} // namespace
+
+template <>
+std::shared_ptr<t_data_generator>
+make_data_generator(t_val spec, t_uindex num_keys, t_uindex num_batches) {
+    py::dict spec_dict = spec.cast<py::dict>();
+    t_generator_spec generator_spec;
+    if (spec_dict.contains("seed")) {
+        generator_spec.m_seed = spec_dict["seed"].cast<std::uint64_t>();
+    }
+    if (spec_dict.contains("rows")) {
+        generator_spec.m_rows = spec_dict["rows"].cast<t_uindex>();
+    }
+    if (spec_dict.contains("columns")) {
+        for (auto item : spec_dict["columns"].cast<py::dict>()) {
+            read_generator_column(item.second.cast<py::dict>(),
+                generator_spec.m_columns[item.first.cast<std::string>()]);
+        }
+    }
+
+    return std::make_shared<t_data_generator>(generator_spec, num_keys, num_batches);
+}
+
+t_uindex
+remove_where_py(std::shared_ptr<Table> table, t_val view_config, t_val date_parser, t_uindex port_id) {
+    std::shared_ptr<t_schema> schema = std::make_shared<t_schema>(table->get_schema());
+    std::shared_ptr<t_view_config> config = make_view_config<t_val>(schema, date_parser, view_config);
+
+    // Views drop filters they cannot apply, which would remove more rows.
+    std::vector<t_fterm> fterms = config->get_fterm();
+    if (fterms.empty() || fterms.size() != view_config.attr("get_filter")().cast<py::list>().size()) {
+        PSP_COMPLAIN_AND_ABORT("Cannot remove rows by an empty or invalid filter");
+    }
+
+    return table->remove_where(fterms, config->get_filter_op(), port_id);
+}
+
+std::shared_ptr<Table>
+make_replica_py(py::bytes snapshot) {
+    return Table::make_replica(std::make_shared<t_pool>(), snapshot.cast<std::string>());
+}
+
+py::bytes
+get_replication_snapshot_py(std::shared_ptr<Table> table) {
+    std::shared_ptr<std::string> snapshot;
+    {
+        py::gil_scoped_release release;
+        snapshot = table->get_replication_snapshot();
+    }
+    return py::bytes(*snapshot);
+}
+
+std::vector<py::bytes>
+take_replication_batches_py(std::shared_ptr<Table> table) {
+    std::vector<py::bytes> rval;
+    for (const std::shared_ptr<std::string>& batch : table->take_replication_batches()) {
+        rval.push_back(py::bytes(*batch));
+    }
+    return rval;
+}
+
 } //namespace binding
 } //namespace perspective
 
@@ -12,6 +12,8 @@
 #include <perspective/binding.h>
 #include <perspective/python/base.h>
 #include <perspective/python/utils.h>
+#include <perspective/sort_key.h>
+#include <deque>
 
 namespace perspective {
 namespace binding {
@@ -183,6 +185,68 @@ scalar_to_py(const t_tscalar& scalar, bool cast_double, bool cast_string) {
     }
 }
 
+namespace {
+
+// `strings` holds the strings the scalars point to while they are compared.
+t_tscalar
+sort_scalar_from_py(t_val value, std::deque<std::string>& strings) {
+    t_tscalar rval = mknone();
+    if (value.is_none()) {
+        return rval;
+    } else if (py::isinstance<py::bool_>(value)) {
+        rval.set(value.cast<bool>());
+    } else if (py::isinstance<py::int_>(value)) {
+        rval.set(value.cast<std::int64_t>());
+    } else if (py::isinstance<py::float_>(value)) {
+        rval.set(value.cast<double>());
+    } else {
+        strings.push_back(value.cast<std::string>());
+        rval.set(strings.back().c_str());
+    }
+    return rval;
+}
+
+std::vector<t_tscalar>
+sort_row_from_py(t_val row, std::deque<std::string>& strings) {
+    std::vector<t_tscalar> rval;
+    for (auto value : row) {
+        rval.push_back(sort_scalar_from_py(py::reinterpret_borrow<t_val>(value), strings));
+    }
+    return rval;
+}
+
+std::vector<t_sorttype>
+sort_orders_from_py(const std::vector<std::string>& orders) {
+    std::vector<t_sorttype> rval;
+    for (const auto& order : orders) {
+        rval.push_back(str_to_sorttype(order));
+    }
+    return rval;
+}
+
+} // end anonymous namespace
+
+py::bytes
+encode_sort_key_py(t_val row, t_val pkey, std::vector<std::string> orders) {
+    std::deque<std::string> strings;
+    std::vector<t_tscalar> values = sort_row_from_py(row, strings);
+    std::string key;
+    append_sort_key(sort_orders_from_py(orders), values.data(), 0,
+        sort_scalar_from_py(pkey, strings), key);
+    return py::bytes(key);
+}
+
+bool
+cmp_sort_values_py(t_val a_row, t_val a_pkey, t_val b_row, t_val b_pkey,
+    std::vector<std::string> orders) {
+    std::deque<std::string> strings;
+    std::vector<t_tscalar> a_values = sort_row_from_py(a_row, strings);
+    std::vector<t_tscalar> b_values = sort_row_from_py(b_row, strings);
+    return cmp_sort_values(a_values.data(), sort_scalar_from_py(a_pkey, strings), 0,
+        b_values.data(), sort_scalar_from_py(b_pkey, strings), 0,
+        sort_orders_from_py(orders));
+}
+
 } //namespace binding
 } //namespace perspective
 
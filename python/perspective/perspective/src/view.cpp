@@ -12,6 +12,7 @@
 #include <pybind11/stl.h>
 #include <perspective/base.h>
 #include <perspective/binding.h>
+#include <perspective/arrow_writer.h>
 #include <perspective/python/base.h>
 #include <perspective/python/utils.h>
 #include <perspective/python/view.h>
@@ -109,6 +110,69 @@ make_filter_term(t_dtype column_type, t_val date_parser, const std::string& colu
     return std::make_tuple(column_name, filter_op_str, terms);
 }
 
+bool
+is_filter_expr(t_val filter) {
+    if (py::isinstance<py::dict>(filter)) {
+        return true;
+    }
+
+    auto term = filter.cast<std::vector<t_val>>();
+    return term.size() > 2 && py::isinstance<py::dict>(term[2]);
+}
+
+bool
+make_filter_expr(std::shared_ptr<t_schema> schema, t_val date_parser, t_val filter, t_fexpr& out) {
+    if (py::isinstance<py::dict>(filter)) {
+        auto group = filter.cast<std::map<std::string, std::vector<t_val>>>();
+        if (group.size() != 1 || (group.count("and") == 0 && group.count("or") == 0)) {
+            PSP_COMPLAIN_AND_ABORT("A filter group must be a dict of `and` or `or` to a list of filters");
+        }
+
+        std::vector<t_fexpr> children;
+        for (auto child : group.begin()->second) {
+            t_fexpr expr;
+            if (make_filter_expr(schema, date_parser, child, expr)) {
+                children.push_back(expr);
+            }
+        }
+        out = t_fexpr(str_to_filter_op(group.begin()->first), children);
+        return true;
+    }
+
+    auto f = filter.cast<std::vector<t_val>>();
+    std::string column_name = f[0].cast<std::string>();
+    std::string filter_op_str = f[1].cast<std::string>();
+    t_dtype column_type = schema->get_dtype(column_name);
+    t_filter_op filter_operator = str_to_filter_op(filter_op_str);
+
+    if (f.size() > 2 && py::isinstance<py::dict>(f[2])) {
+        auto other = f[2].cast<std::map<std::string, std::string>>();
+        if (other.count("column") == 0) {
+            PSP_COMPLAIN_AND_ABORT("A filter may only compare `" + column_name + "` to a value or a `column`");
+        }
+
+        std::string other_name = other["column"];
+        if (!schema->has_column(other_name)) {
+            PSP_COMPLAIN_AND_ABORT("Cannot compare `" + column_name + "` to `" + other_name + "`, which is not a column");
+        }
+        out = t_fexpr(column_name, filter_operator, other_name);
+        return true;
+    }
+
+    t_val filter_term = py::none();
+    if (f.size() > 2) {
+        filter_term = f[2];
+    }
+
+    if (!is_valid_filter(column_type, date_parser, filter_operator, filter_term)) {
+        return false;
+    }
+
+    out = t_fexpr(t_view_config::make_fterm(
+        make_filter_term(column_type, date_parser, column_name, filter_op_str, filter_term)));
+    return true;
+}
+
 template <>
 std::shared_ptr<t_view_config>
 make_view_config(std::shared_ptr<t_schema> schema, t_val date_parser, t_val config) {
@@ -193,10 +257,27 @@ make_view_config(std::shared_ptr<t_schema> schema, t_val date_parser, t_val conf
     }
 
     // construct filters with filter terms, and fill the vector of tuples
-    auto p_filter = config.attr("get_filter")().cast<std::vector<std::vector<t_val>>>();
+    auto p_filter = config.attr("get_filter")().cast<std::vector<t_val>>();
     std::vector<std::tuple<std::string, std::string, std::vector<t_tscalar>>> filter;
 
+    // Filters which compare columns or nest groups make the whole `filter`
+    // an expression, its items combined by `filter_op`.
+    bool has_filter_expr = false;
     for (auto f : p_filter) {
+        has_filter_expr = has_filter_expr || is_filter_expr(f);
+    }
+
+    std::vector<t_fexpr> filter_exprs;
+    for (auto item : p_filter) {
+        if (has_filter_expr) {
+            t_fexpr expr;
+            if (make_filter_expr(schema, date_parser, item, expr)) {
+                filter_exprs.push_back(expr);
+            }
+            continue;
+        }
+
+        auto f = item.cast<std::vector<t_val>>();
         // parse filter details
         std::string column_name = f[0].cast<std::string>();
         std::string filter_op_str = f[1].cast<std::string>();
@@ -230,6 +311,10 @@ make_view_config(std::shared_ptr<t_schema> schema, t_val date_parser, t_val conf
     // transform primitive values into abstractions that the engine can use
     view_config->init(schema);
 
+    if (has_filter_expr) {
+        view_config->set_filter_expr(t_fexpr(str_to_filter_op(filter_op), filter_exprs));
+    }
+
     // set pivot depths if provided
     if (! config.attr("row_pivot_depth").is_none()) {
         view_config->set_row_pivot_depth(config.attr("row_pivot_depth").cast<std::int32_t>());
@@ -245,34 +330,145 @@ make_view_config(std::shared_ptr<t_schema> schema, t_val date_parser, t_val conf
 template <typename CTX_T>
 std::shared_ptr<View<CTX_T>>
 make_view(std::shared_ptr<Table> table, const std::string& name, const std::string& separator,
-    t_val view_config, t_val date_parser) {
+    t_val view_config, t_val date_parser, bool deferred) {
     std::shared_ptr<t_schema> schema = std::make_shared<t_schema>(table->get_schema());
     std::shared_ptr<t_view_config> config = 
         make_view_config<t_val>(schema, date_parser, view_config);
-    auto ctx = make_context<CTX_T>(table, schema, config, name);
+    config->scale_filters(table->get_column_scales());
+
+    // The config is read from Python, but the context is built without the
+    // GIL. The gnode stays locked until the context is configured, so it
+    // is never notified half-built.
+    py::gil_scoped_release release;
+    auto lock = table->get_pool()->lock_gnode(table->get_gnode()->get_id());
+    t_allocator_scope allocator_scope(table->get_gnode()->get_allocator());
+    auto ctx = make_context<CTX_T>(table, schema, config, name, deferred);
     auto view_ptr = std::make_shared<View<CTX_T>>(table, ctx, name, separator, config);
     return view_ptr;
 }
 
 std::shared_ptr<View<t_ctx0>>
 make_view_ctx0(std::shared_ptr<Table> table, std::string name, std::string separator,
-    t_val view_config, t_val date_parser) {
-    return make_view<t_ctx0>(table, name, separator, view_config, date_parser);
+    t_val view_config, t_val date_parser, bool deferred) {
+    return make_view<t_ctx0>(table, name, separator, view_config, date_parser, deferred);
 }
 
 std::shared_ptr<View<t_ctx1>>
 make_view_ctx1(std::shared_ptr<Table> table, std::string name, std::string separator,
-    t_val view_config, t_val date_parser) {
-    return make_view<t_ctx1>(table, name, separator, view_config, date_parser);
+    t_val view_config, t_val date_parser, bool deferred) {
+    return make_view<t_ctx1>(table, name, separator, view_config, date_parser, deferred);
 }
 
 std::shared_ptr<View<t_ctx2>>
 make_view_ctx2(std::shared_ptr<Table> table, std::string name, std::string separator,
-    t_val view_config, t_val date_parser) {
-    return make_view<t_ctx2>(table, name, separator, view_config, date_parser);
+    t_val view_config, t_val date_parser, bool deferred) {
+    return make_view<t_ctx2>(table, name, separator, view_config, date_parser, deferred);
+}
+
+std::map<std::string, double>
+estimate_view_cost(std::shared_ptr<Table> table, t_val view_config, t_val date_parser) {
+    std::shared_ptr<t_schema> schema = std::make_shared<t_schema>(table->get_schema());
+    std::shared_ptr<t_view_config> config
+        = make_view_config<t_val>(schema, date_parser, view_config);
+    config->scale_filters(table->get_column_scales());
+
+    py::gil_scoped_release release;
+    auto lock = table->get_pool()->lock_gnode(table->get_gnode()->get_id());
+    return table->estimate_view_cost(*config);
+}
+
+std::shared_ptr<t_ctx_totals>
+make_totals(std::shared_ptr<Table> table, const std::string& name, t_val view_config,
+    t_val date_parser) {
+    std::shared_ptr<t_schema> schema = std::make_shared<t_schema>(table->get_schema());
+    std::shared_ptr<t_view_config> config
+        = make_view_config<t_val>(schema, date_parser, view_config);
+    const std::map<std::string, std::int32_t>& scales = table->get_column_scales();
+    config->scale_filters(scales);
+
+    auto totals = std::make_shared<t_ctx_totals>(
+        *schema, config->get_aggspecs(), config->get_fterm(), config->get_filter_op(), scales);
+    if (config->get_filter_expr().num_terms() > 0) {
+        totals->set_filter_expr(config->get_filter_expr());
+    }
+
+    py::gil_scoped_release release;
+    auto lock = table->get_pool()->lock_gnode(table->get_gnode()->get_id());
+    table->get_gnode()->register_totals(name, totals);
+    return totals;
+}
+
+t_val
+get_totals_values(std::shared_ptr<Table> table, std::shared_ptr<t_ctx_totals> totals) {
+    std::vector<t_tscalar> values;
+    {
+        py::gil_scoped_release release;
+        auto lock = table->get_pool()->lock_gnode(table->get_gnode()->get_id());
+        values = totals->get_values();
+    }
+
+    py::dict rval;
+    std::vector<std::string> names = totals->get_column_names();
+    for (t_uindex idx = 0, loop_end = names.size(); idx < loop_end; ++idx) {
+        rval[py::str(names[idx])] = scalar_to_py(values[idx]);
+    }
+    return rval;
+}
+
+void
+unregister_totals(std::shared_ptr<Table> table, const std::string& name) {
+    py::gil_scoped_release release;
+    auto lock = table->get_pool()->lock_gnode(table->get_gnode()->get_id());
+    table->get_gnode()->unregister_totals(name);
+}
+
+/**
+ * @brief Run `serialize` with the GIL released, so that other threads can
+ * update the table while it reads (large slices from a snapshot of the
+ * table; see `View::get_data`) and serializes.
+ */
+template <typename F>
+py::bytes
+serialize_without_gil(F serialize) {
+    std::shared_ptr<std::string> str;
+    {
+        py::gil_scoped_release release;
+        str = serialize();
+    }
+    return py::bytes(*str);
+}
+
+t_arrow_buffer::t_arrow_buffer(std::shared_ptr<std::string> arrow)
+    : m_arrow(arrow) {}
+
+std::size_t
+t_arrow_buffer::size() const {
+    return m_arrow->size();
 }
 
 py::bytes
+t_arrow_buffer::to_bytes() const {
+    return py::bytes(*m_arrow);
+}
+
+py::buffer_info
+t_arrow_buffer::get_buffer_info() const {
+    return py::buffer_info(&(*m_arrow)[0], sizeof(char),
+        py::format_descriptor<std::uint8_t>::format(), m_arrow->size());
+}
+
+template <typename F>
+t_arrow_buffer
+arrow_buffer_without_gil(F serialize) {
+    std::shared_ptr<std::string> str;
+    {
+        py::gil_scoped_release release;
+        str = serialize();
+    }
+    return t_arrow_buffer(str);
+}
+
+t_arrow_buffer
 to_arrow_zero(
     std::shared_ptr<View<t_ctx0>> view,
     std::int32_t start_row,
@@ -280,12 +476,12 @@ to_arrow_zero(
     std::int32_t start_col,
     std::int32_t end_col
 ) {
-    std::shared_ptr<std::string> str = 
-        view->to_arrow(start_row, end_row, start_col, end_col);
-    return py::bytes(*str);
+    return arrow_buffer_without_gil([&]() {
+        return view->to_arrow(start_row, end_row, start_col, end_col);
+    });
 }
 
-py::bytes
+t_arrow_buffer
 to_arrow_one(
     std::shared_ptr<View<t_ctx1>> view,
     std::int32_t start_row,
@@ -293,12 +489,12 @@ to_arrow_one(
     std::int32_t start_col, 
     std::int32_t end_col
 ) {
-    std::shared_ptr<std::string> str = 
-        view->to_arrow(start_row, end_row, start_col, end_col);
-    return py::bytes(*str);
+    return arrow_buffer_without_gil([&]() {
+        return view->to_arrow(start_row, end_row, start_col, end_col);
+    });
 }
 
-py::bytes
+t_arrow_buffer
 to_arrow_two(
     std::shared_ptr<View<t_ctx2>> view,
     std::int32_t start_row,
@@ -306,11 +502,138 @@ to_arrow_two(
     std::int32_t start_col, 
     std::int32_t end_col
 ) {
-    std::shared_ptr<std::string> str = 
-        view->to_arrow(start_row, end_row, start_col, end_col);
+    return arrow_buffer_without_gil([&]() {
+        return view->to_arrow(start_row, end_row, start_col, end_col);
+    });
+}
+
+py::bytes
+to_parquet_zero(
+    std::shared_ptr<View<t_ctx0>> view,
+    std::int32_t start_row,
+    std::int32_t end_row,
+    std::int32_t start_col,
+    std::int32_t end_col,
+    std::int32_t row_group_size
+) {
+    return serialize_without_gil([&]() {
+        return view->to_parquet(start_row, end_row, start_col, end_col, row_group_size);
+    });
+}
+
+py::bytes
+to_parquet_one(
+    std::shared_ptr<View<t_ctx1>> view,
+    std::int32_t start_row,
+    std::int32_t end_row,
+    std::int32_t start_col,
+    std::int32_t end_col,
+    std::int32_t row_group_size
+) {
+    return serialize_without_gil([&]() {
+        return view->to_parquet(start_row, end_row, start_col, end_col, row_group_size);
+    });
+}
+
+py::bytes
+to_parquet_two(
+    std::shared_ptr<View<t_ctx2>> view,
+    std::int32_t start_row,
+    std::int32_t end_row,
+    std::int32_t start_col,
+    std::int32_t end_col,
+    std::int32_t row_group_size
+) {
+    return serialize_without_gil([&]() {
+        return view->to_parquet(start_row, end_row, start_col, end_col, row_group_size);
+    });
+}
+
+template <typename CTX_T>
+void
+to_arrow_chunked(
+    std::shared_ptr<View<CTX_T>> view,
+    std::int32_t start_row,
+    std::int32_t end_row,
+    std::int32_t start_col,
+    std::int32_t end_col,
+    std::int32_t chunk_size,
+    py::function callback
+) {
+    view->to_arrow_chunked(start_row, end_row, start_col, end_col, chunk_size,
+        [&callback](std::shared_ptr<std::string> str) {
+            callback(py::bytes(*str));
+        });
+}
+
+void
+to_arrow_chunked_zero(
+    std::shared_ptr<View<t_ctx0>> view,
+    std::int32_t start_row,
+    std::int32_t end_row,
+    std::int32_t start_col,
+    std::int32_t end_col,
+    std::int32_t chunk_size,
+    py::function callback
+) {
+    to_arrow_chunked<t_ctx0>(view, start_row, end_row, start_col, end_col, chunk_size, callback);
+}
+
+void
+to_arrow_chunked_one(
+    std::shared_ptr<View<t_ctx1>> view,
+    std::int32_t start_row,
+    std::int32_t end_row,
+    std::int32_t start_col,
+    std::int32_t end_col,
+    std::int32_t chunk_size,
+    py::function callback
+) {
+    to_arrow_chunked<t_ctx1>(view, start_row, end_row, start_col, end_col, chunk_size, callback);
+}
+
+void
+to_arrow_chunked_two(
+    std::shared_ptr<View<t_ctx2>> view,
+    std::int32_t start_row,
+    std::int32_t end_row,
+    std::int32_t start_col,
+    std::int32_t end_col,
+    std::int32_t chunk_size,
+    py::function callback
+) {
+    to_arrow_chunked<t_ctx2>(view, start_row, end_row, start_col, end_col, chunk_size, callback);
+}
+
+template <typename CTX_T>
+py::object
+cursor_to_arrow(std::shared_ptr<View<CTX_T>> view, std::int32_t cursor_id, std::int32_t page_size) {
+    std::shared_ptr<std::string> str;
+    {
+        py::gil_scoped_release release;
+        str = view->cursor_to_arrow(cursor_id, page_size);
+    }
+    if (str == nullptr) {
+        return py::none();
+    }
     return py::bytes(*str);
 }
 
+py::object
+cursor_to_arrow_zero(std::shared_ptr<View<t_ctx0>> view, std::int32_t cursor_id, std::int32_t page_size) {
+    return cursor_to_arrow<t_ctx0>(view, cursor_id, page_size);
+}
+
+py::object
+cursor_to_arrow_one(std::shared_ptr<View<t_ctx1>> view, std::int32_t cursor_id, std::int32_t page_size) {
+    return cursor_to_arrow<t_ctx1>(view, cursor_id, page_size);
+}
+
+py::object
+cursor_to_arrow_two(std::shared_ptr<View<t_ctx2>> view, std::int32_t cursor_id, std::int32_t page_size) {
+    return cursor_to_arrow<t_ctx2>(view, cursor_id, page_size);
+}
+
 py::bytes
 get_row_delta_zero(std::shared_ptr<View<t_ctx0>> view) {
     std::shared_ptr<t_data_slice<t_ctx0>> slice = view->get_row_delta();
@@ -333,6 +656,85 @@ get_row_delta_two(
     return py::bytes(*arrow);
 }
 
+py::bytes
+compress_arrow(py::bytes arrow, const std::string& compression) {
+    std::shared_ptr<std::string> compressed = arrow::compress_arrow(
+        arrow.cast<std::string>(), arrow::str_to_arrow_compression(compression));
+    return py::bytes(*compressed);
+}
+
+bool
+is_arrow_compression_available(const std::string& compression) {
+    return arrow::is_arrow_compression_available(
+        arrow::str_to_arrow_compression(compression));
+}
+
+template <typename CTX_T>
+py::list
+get_histogram(std::shared_ptr<View<CTX_T>> view, const std::string& column_name,
+    std::uint32_t nbuckets, bool quantile, std::int32_t ridx) {
+    t_binning binning = quantile ? BINNING_QUANTILE : BINNING_FIXED_WIDTH;
+    t_histogram histogram = view->get_histogram(column_name, nbuckets, binning, ridx);
+
+    py::list rval;
+    for (const t_hist_bucket& bucket : histogram.m_buckets) {
+        py::dict item;
+        item["begin"] = scalar_to_py(bucket.m_begin);
+        item["end"] = scalar_to_py(bucket.m_end);
+        item["count"] = bucket.m_count;
+        rval.append(item);
+    }
+
+    return rval;
+}
+
+template <typename CTX_T>
+py::dict
+get_min_max(std::shared_ptr<View<CTX_T>> view, const std::string& column_name,
+    std::int32_t ridx) {
+    t_minmax minmax = view->get_min_max(column_name, ridx);
+    py::dict rval;
+    rval["min"] = scalar_to_py(minmax.m_min);
+    rval["max"] = scalar_to_py(minmax.m_max);
+    return rval;
+}
+
+py::list
+get_histogram_zero(std::shared_ptr<View<t_ctx0>> view, const std::string& column_name,
+    std::uint32_t nbuckets, bool quantile, std::int32_t ridx) {
+    return get_histogram<t_ctx0>(view, column_name, nbuckets, quantile, ridx);
+}
+
+py::list
+get_histogram_one(std::shared_ptr<View<t_ctx1>> view, const std::string& column_name,
+    std::uint32_t nbuckets, bool quantile, std::int32_t ridx) {
+    return get_histogram<t_ctx1>(view, column_name, nbuckets, quantile, ridx);
+}
+
+py::list
+get_histogram_two(std::shared_ptr<View<t_ctx2>> view, const std::string& column_name,
+    std::uint32_t nbuckets, bool quantile, std::int32_t ridx) {
+    return get_histogram<t_ctx2>(view, column_name, nbuckets, quantile, ridx);
+}
+
+py::dict
+get_min_max_zero(
+    std::shared_ptr<View<t_ctx0>> view, const std::string& column_name, std::int32_t ridx) {
+    return get_min_max<t_ctx0>(view, column_name, ridx);
+}
+
+py::dict
+get_min_max_one(
+    std::shared_ptr<View<t_ctx1>> view, const std::string& column_name, std::int32_t ridx) {
+    return get_min_max<t_ctx1>(view, column_name, ridx);
+}
+
+py::dict
+get_min_max_two(
+    std::shared_ptr<View<t_ctx2>> view, const std::string& column_name, std::int32_t ridx) {
+    return get_min_max<t_ctx2>(view, column_name, ridx);
+}
+
 
 
 
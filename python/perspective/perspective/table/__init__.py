@@ -8,5 +8,19 @@
 
 from .table import Table
 from .libbinding import PerspectiveCppError
+from ._executor import set_threadpool_size
+from ._tracing import set_tracing_enabled, is_tracing_enabled, get_trace, \
+    save_trace, clear_trace
+from ._profiling import set_profiling_enabled, is_profiling_enabled, \
+    get_profile, clear_profile
+from ._alloc_stats import set_alloc_stats_enabled, is_alloc_stats_enabled, \
+    get_alloc_stats, reset_alloc_stats
+from ._reducers import register_reducer, unregister_reducer
 
-__all__ = ["Table", "PerspectiveCppError"]
+__all__ = ["Table", "PerspectiveCppError", "set_threadpool_size",
+           "set_tracing_enabled", "is_tracing_enabled", "get_trace",
+           "save_trace", "clear_trace", "set_profiling_enabled",
+           "is_profiling_enabled", "get_profile", "clear_profile",
+           "set_alloc_stats_enabled", "is_alloc_stats_enabled",
+           "get_alloc_stats", "reset_alloc_stats",
+           "register_reducer", "unregister_reducer"]
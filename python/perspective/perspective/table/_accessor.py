@@ -27,6 +27,15 @@ def _flatten_structure(array):
     return dict(zip(array.dtype.names, columns))
 
 
+def _column_values(series):
+    '''Returns the values of a :class:`pandas.Series`, with timezone-aware
+    datetimes as `datetime64[ns]` in UTC rather than `Timestamp` objects, so
+    that they are loaded from their int64 representation.'''
+    if pandas.api.types.is_datetime64tz_dtype(series.dtype):
+        return series.dt.tz_convert("UTC").dt.tz_localize(None).values
+    return series.values
+
+
 def _type_to_format(data_or_schema):
     '''Deconstructs data passed in by the user into a standard format:
 
@@ -80,7 +89,7 @@ def _type_to_format(data_or_schema):
         else:
             # flatten column/index multiindex
             df, _ = deconstruct_pandas(data_or_schema)
-            return True, 1, df.columns.tolist(), {c: df[c].values for c in df.columns}
+            return True, 1, df.columns.tolist(), {c: _column_values(df[c]) for c in df.columns}
 
 
 class _PerspectiveAccessor(object):
@@ -100,6 +109,14 @@ class _PerspectiveAccessor(object):
 
         self._types = []
 
+        # When numpy arrays are cast from float to int, NaNs are lost. Use this
+        # map to store the pre-cast masks, as we know the indices of NaNs do
+        # not change when we cast from float to int.
+        self._numpy_column_masks = {}
+
+        # Codes and categories of `pandas.Categorical` columns of strings
+        self._categorical_columns = {}
+
         # Verify that column names are strings, and that numpy arrays are of
         # type `ndarray`
         for name in self._names:
@@ -109,6 +126,9 @@ class _PerspectiveAccessor(object):
             if self._is_numpy:
                 array = self._data_or_schema[name]
 
+                if isinstance(array, pandas.Categorical):
+                    array = self._unpack_categorical(name, array)
+
                 if not isinstance(array, numpy.ndarray):
                     raise PerspectiveError("Mixed datasets of numpy.ndarray and lists are not supported.")
 
@@ -122,10 +142,6 @@ class _PerspectiveAccessor(object):
                 # access to the char dtype code
                 self._types.append(str(dtype))
 
-        # When numpy arrays are cast from float to int, NaNs are lost. Use this
-        # map to store the pre-cast masks, as we know the indices of NaNs do
-        # not change when we cast from float to int.
-        self._numpy_column_masks = {}
 
     def data(self):
         return self._data_or_schema
@@ -217,14 +233,14 @@ class _PerspectiveAccessor(object):
         elif dtype == t_dtype.DTYPE_DATE:
             # return datetime.date
             if isinstance(val, str):
-                parsed = self._date_validator.parse(val)
+                parsed = self._date_validator.parse(val, cidx)
                 return self._date_validator.to_date_components(parsed)
             else:
                 return self._date_validator.to_date_components(val)
         elif dtype == t_dtype.DTYPE_TIME:
             # return unix timestamps for time
             if isinstance(val, str):
-                parsed = self._date_validator.parse(val)
+                parsed = self._date_validator.parse(val, cidx)
                 return self._date_validator.to_timestamp(parsed)
             else:
                 return self._date_validator.to_timestamp(val)
@@ -292,6 +308,36 @@ class _PerspectiveAccessor(object):
         mask = self._numpy_column_masks.get(name, None)
         return deconstruct_numpy(data, mask)
 
+    def _unpack_categorical(self, name, categorical):
+        '''Replace a `pandas.Categorical` column with an object array of
+        its values, which is used to infer its type, and keep its codes so
+        that a string column can be filled without reading each value.
+        '''
+        categories = categorical.categories.values.astype(object)
+        codes = numpy.asarray(categorical.codes)
+
+        # Missing values have a code of -1, which reads the trailing `None`
+        lookup = numpy.empty(len(categories) + 1, dtype=object)
+        lookup[:-1] = categories
+        lookup[-1] = None
+        array = lookup[codes]
+        self._data_or_schema[name] = array
+        self._numpy_column_masks[name] = numpy.flatnonzero(codes == -1)
+
+        if all(isinstance(c, six.string_types) for c in categories):
+            self._categorical_columns[name] = {
+                "codes": codes,
+                "categories": list(categories)
+            }
+
+        return array
+
+    def _get_categorical_column(self, name):
+        '''Returns the `codes` and `categories` of a column that was loaded
+        from a `pandas.Categorical` of strings, or None.
+        '''
+        return self._categorical_columns.get(name, None)
+
     def _has_column(self, ridx, name):
         '''Given a column name, validate that it is in the row.
 
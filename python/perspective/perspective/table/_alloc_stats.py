@@ -0,0 +1,43 @@
+################################################################################
+#
+# Copyright (c) 2020, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+from .libbinding import set_alloc_stats_enabled as _set_alloc_stats_enabled, \
+    is_alloc_stats_enabled, get_alloc_stats as _get_alloc_stats, \
+    reset_alloc_stats
+
+
+def set_alloc_stats_enabled(enabled):
+    """Start or stop counting the allocations of the engine's column storage,
+    by what owns it: `master_table`, `input_port`, `transitional`,
+    `aggregate`, `vocab` or `other`. Counting can also be enabled from startup
+    by setting the `PSP_ALLOC_STATS` environment variable.
+
+    Args:
+        enabled (:obj:`bool`): whether to count allocations.
+    """
+    _set_alloc_stats_enabled(bool(enabled))
+
+
+def get_alloc_stats():
+    """Returns the allocation counters of each owner, counted while enabled
+    since the last :func:`reset_alloc_stats`: the number of `init`, `reserve`,
+    `extend`, `shrink`, `clone` and `free` operations, and `allocated_bytes`,
+    `freed_bytes`, `live_bytes` and `high_water_bytes`.
+
+    Returns:
+        :obj:`dict`: a mapping of owner to a :obj:`dict` of counter to value.
+    """
+    stats = {}
+    for key, value in _get_alloc_stats().items():
+        owner, counter = key.split(".")
+        stats.setdefault(owner, {})[counter] = int(value)
+    return stats
+
+
+__all__ = ["set_alloc_stats_enabled", "is_alloc_stats_enabled",
+           "get_alloc_stats", "reset_alloc_stats"]
@@ -11,7 +11,8 @@ from math import trunc
 from ._constants import COLUMN_SEPARATOR_STRING
 from .libbinding import get_data_slice_zero, get_data_slice_one, get_data_slice_two, \
     get_from_data_slice_zero, get_from_data_slice_one, get_from_data_slice_two, \
-    get_pkeys_from_data_slice_zero, get_pkeys_from_data_slice_one, get_pkeys_from_data_slice_two
+    get_pkeys_from_data_slice_zero, get_pkeys_from_data_slice_one, get_pkeys_from_data_slice_two, \
+    get_column_from_data_slice_zero, get_column_from_data_slice_one, get_column_from_data_slice_two
 
 
 def _mod(a, b):
@@ -24,10 +25,33 @@ def _mod(a, b):
     return a - d * b
 
 
+def _get_row_paths(data_slice, start_row, end_row):
+    '''Returns the row path of each row from `start_row` to `end_row`, root
+    first, reading them from the data slice in one call and converting each
+    distinct value once rather than once per row.
+    '''
+    row_paths = data_slice.get_row_paths(start_row, end_row)
+    values = [value.to_string(False) for value in row_paths.get_values()]
+    ids = row_paths.get_ids()
+    paths = []
+    path = []
+    pos = 0
+    for depth, shared in zip(row_paths.get_depths(), row_paths.get_shared()):
+        path = path[:shared]
+        for _ in range(shared, depth):
+            path.append(values[ids[pos]])
+            pos += 1
+        paths.append(path)
+    return paths
+
+
 def to_format(options, view, output_format):
     view._table._state_manager.call_process(view._table._table.get_id())
     options, column_names, data_slice = _to_format_helper(view, options)
 
+    if output_format == 'numpy':
+        return _to_numpy(options, view, column_names, data_slice)
+
     if output_format == 'records':
         data = []
     elif output_format in ('dict', 'numpy'):
@@ -38,8 +62,11 @@ def to_format(options, view, output_format):
     num_columns = len(view._config.get_columns())
     num_hidden = view._num_hidden_cols()
 
+    if options["has_row_path"]:
+        row_paths = _get_row_paths(data_slice, options["start_row"], options["end_row"])
+
     for ridx in range(options["start_row"], options["end_row"]):
-        row_path = data_slice.get_row_path(ridx) if options["has_row_path"] else []
+        row_path = row_paths[ridx - options["start_row"]] if options["has_row_path"] else []
         if options["leaves_only"] and len(row_path) < len(view._config.get_row_pivots()):
             continue
 
@@ -54,8 +81,7 @@ def to_format(options, view, output_format):
                 continue
             elif cidx == options["start_col"] and view._sides > 0:
                 if options["has_row_path"]:
-                    paths = [path.to_string(False) for path in row_path]
-                    paths.reverse()
+                    paths = row_path
                     if output_format == 'records':
                         data[-1]["__ROW_PATH__"] = paths
                     elif output_format in ('dict', 'numpy'):
@@ -101,10 +127,84 @@ def to_format(options, view, output_format):
     if output_format in ('dict', 'numpy') and (not options["has_row_path"] and ("__ROW_PATH__" in data)):
         del data["__ROW_PATH__"]
 
-    if output_format == 'numpy':
-        for k, v in data.items():
-            # TODO push into C++
-            data[k] = np.array(v)
+    return data
+
+
+def _to_numpy(options, view, column_names, data_slice):
+    '''Serialize the data slice into numpy arrays, copying each column in
+    C++ rather than creating a Python object for every value.
+    '''
+    data = {}
+    start_row = options["start_row"]
+    end_row = max(options["end_row"], start_row)
+    num_columns = len(view._config.get_columns())
+    num_hidden = view._num_hidden_cols()
+
+    # With `leaves_only`, the rows to keep are found from their row paths
+    keep = None
+
+    if options["has_row_path"]:
+        num_row_pivots = len(view._config.get_row_pivots())
+        paths = []
+        keep = []
+        for row_path in _get_row_paths(data_slice, start_row, end_row):
+            is_leaf = not options["leaves_only"] or len(row_path) >= num_row_pivots
+            keep.append(is_leaf)
+            if is_leaf:
+                paths.append(row_path)
+        keep = np.array(keep, dtype=bool)
+
+    if options["index"]:
+        if view._sides == 0:
+            get_pkeys = get_pkeys_from_data_slice_zero
+        elif view._sides == 1:
+            get_pkeys = get_pkeys_from_data_slice_one
+        else:
+            get_pkeys = get_pkeys_from_data_slice_two
+        index = []
+        for i, ridx in enumerate(range(start_row, end_row)):
+            if keep is not None and not keep[i]:
+                continue
+            pkeys = get_pkeys(data_slice, ridx, 0)
+            if len(pkeys) == 0:
+                index.append([])
+            for pkey in pkeys:
+                index.append([pkey])
+        data["__INDEX__"] = np.array(index)
+
+    if options["has_row_path"]:
+        data["__ROW_PATH__"] = np.array(paths)
+
+    if view._sides == 0:
+        get_column = get_column_from_data_slice_zero
+    elif view._sides == 1:
+        get_column = get_column_from_data_slice_one
+    else:
+        get_column = get_column_from_data_slice_two
+
+    for cidx in range(options["start_col"], options["end_col"]):
+        if _mod((cidx - (1 if view._sides > 0 else 0)), (num_columns + num_hidden)) >= num_columns:
+            # don't emit columns used for hidden sort
+            continue
+        elif cidx == options["start_col"] and view._sides > 0:
+            # the row path column
+            continue
+
+        values, categories = get_column(data_slice, cidx, start_row, end_row)
+
+        if categories is not None:
+            # Strings are categorical codes, with -1 for null
+            lookup = np.empty(len(categories) + 1, dtype=object)
+            lookup[:-1] = categories
+            lookup[-1] = None
+            values = lookup[values]
+        elif isinstance(values, list):
+            values = np.array(values)
+
+        if keep is not None and options["leaves_only"]:
+            values = values[keep]
+
+        data[column_names[cidx]] = values
 
     return data
 
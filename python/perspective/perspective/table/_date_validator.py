@@ -11,9 +11,9 @@ import numpy
 from calendar import timegm
 from datetime import date, datetime
 from dateutil.parser import parse
-from dateutil.tz import UTC
+from dateutil.tz import UTC, tzoffset
 from pandas import Period
-from re import search
+from re import compile, search
 from time import mktime
 from .libbinding import t_dtype
 
@@ -34,13 +34,53 @@ def _normalize_timestamp(obj):
         return int(obj)
 
 
+# ISO 8601 dates and datetimes, with an optional `Z` or `+HH:MM` UTC offset.
+_ISO_8601 = compile(
+    r"([0-9]{4})-([0-9]{2})-([0-9]{2})"
+    r"(?:[T ]([0-9]{2}):([0-9]{2})(?::([0-9]{2})(?:\.([0-9]{1,6}))?)?"
+    r"(Z|[+-][0-9]{2}:[0-9]{2})?)?$")
+
+
+def _parse_iso(s):
+    '''Return a `datetime.datetime` for an ISO 8601 datestring, or None if
+    `s` is not ISO 8601.'''
+    match = _ISO_8601.match(s)
+    if match is None:
+        return None
+    year, month, day, hour, minute, second, fraction, offset = match.groups()
+    tzinfo = None
+    if offset == "Z":
+        tzinfo = UTC
+    elif offset is not None:
+        seconds = int(offset[1:3]) * 3600 + int(offset[4:6]) * 60
+        tzinfo = tzoffset(None, -seconds if offset[0] == "-" else seconds)
+    try:
+        return datetime(
+            int(year), int(month), int(day),
+            int(hour or 0), int(minute or 0), int(second or 0),
+            int(fraction.ljust(6, "0")) if fraction else 0,
+            tzinfo)
+    except ValueError:
+        return None
+
+
 class _PerspectiveDateValidator(object):
     '''Validate and parse dates using the `dateutil` package.'''
 
-    def parse(self, str):
+    def __init__(self):
+        # Whether each column's first datestring was ISO 8601, by column
+        self._is_iso = {}
+
+    def parse(self, str, column=None):
         '''Return a datetime.datetime object containing the parsed date, or
         None if the date is invalid.
 
+        The format of a column's datestrings is detected once, from the
+        first datestring parsed with its `column`: if it is ISO 8601, the
+        rest of the column is parsed directly, and only datestrings in other
+        formats are parsed with `dateutil`, which probes formats for every
+        datestring.
+
         If a ISO date string with a timezone is provided, there is no guarantee
         that timezones will be properly handled by the parser. Perspective
         stores and serializes times in UTC as a milliseconds
@@ -50,11 +90,21 @@ class _PerspectiveDateValidator(object):
 
         Args:
             str (str): the datestring to parse
+            column (:obj:`int`): the index of the column of `str`, if it is
+                one of a column of datestrings.
 
         Returns:
             (:class:`datetime.date`/`datetime.datetime`/`None`): if parse is
                 successful.
         '''
+        if column is not None:
+            is_iso = self._is_iso.get(column)
+            if is_iso is None:
+                is_iso = self._is_iso[column] = _ISO_8601.match(str) is not None
+            if is_iso:
+                parsed = _parse_iso(str)
+                if parsed is not None:
+                    return parsed
         try:
             return parse(str)
         except (ValueError, OverflowError):
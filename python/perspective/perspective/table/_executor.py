@@ -0,0 +1,75 @@
+################################################################################
+#
+# Copyright (c) 2020, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+from threading import Lock
+from concurrent.futures import ThreadPoolExecutor
+
+
+class _PerspectiveExecutor(object):
+    """The engine worker threads that run the `*_async` methods of
+    :class:`~perspective.Table` and :class:`~perspective.View`.
+
+    The engine releases the GIL while it builds contexts, processes updates
+    and serializes Arrows, so these threads run in parallel with the caller
+    and with each other. The pool is created on first use.
+    """
+
+    def __init__(self, max_workers=None):
+        self._lock = Lock()
+        self._executor = None
+        self._max_workers = max_workers
+
+    def set_max_workers(self, max_workers):
+        """Set the number of worker threads, or `None` for the default of
+        :class:`concurrent.futures.ThreadPoolExecutor`. Work already submitted
+        finishes on the previous threads.
+
+        Args:
+            max_workers (:obj:`int`): the number of worker threads.
+        """
+        if max_workers is not None and max_workers <= 0:
+            raise ValueError("max_workers must be positive!")
+        with self._lock:
+            executor = self._executor
+            self._executor = None
+            self._max_workers = max_workers
+        if executor is not None:
+            executor.shutdown(wait=False)
+
+    def submit(self, fn, *args, **kwargs):
+        """Run `fn(*args, **kwargs)` on a worker thread.
+
+        Returns:
+            :obj:`concurrent.futures.Future`: the result of `fn`.
+        """
+        with self._lock:
+            if self._executor is None:
+                self._executor = ThreadPoolExecutor(
+                    max_workers=self._max_workers)
+            executor = self._executor
+        return executor.submit(fn, *args, **kwargs)
+
+
+EXECUTOR = _PerspectiveExecutor()
+
+# The worker thread that builds views created with `progressive="queued"`,
+# one at a time.
+QUEUED_EXECUTOR = _PerspectiveExecutor(max_workers=1)
+
+
+def set_threadpool_size(max_workers):
+    """Set the number of engine worker threads that run the `*_async` methods
+    of :class:`~perspective.Table` and :class:`~perspective.View`, and the
+    serialization of a :class:`~perspective.PerspectiveManager` created with
+    `threaded=True`.
+
+    Args:
+        max_workers (:obj:`int`): the number of worker threads, or `None` for
+            the default of :class:`concurrent.futures.ThreadPoolExecutor`.
+    """
+    EXECUTOR.set_max_workers(max_workers)
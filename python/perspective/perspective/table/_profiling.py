@@ -0,0 +1,47 @@
+################################################################################
+#
+# Copyright (c) 2020, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+from .libbinding import set_profiling_enabled as _set_profiling_enabled, \
+    is_profiling_enabled, get_profile as _get_profile, get_profile_ticks, \
+    get_profile_interval_us, clear_profile
+
+
+def set_profiling_enabled(enabled):
+    """Start or stop sampling which phase of engine work - processing updates,
+    notifying each context type, sorting, filtering, computing columns and
+    serializing - each engine thread is in, counting the samples of each
+    phase. Sampling is cheap enough to leave on in production, and can also be
+    enabled from startup by setting the `PSP_PROFILE` environment variable;
+    `PSP_PROFILE_INTERVAL_US` sets the microseconds between samples.
+
+    Args:
+        enabled (:obj:`bool`): whether to sample.
+    """
+    _set_profiling_enabled(bool(enabled))
+
+
+def get_profile():
+    """Returns the samples counted since profiling was enabled, or last
+    cleared.
+
+    Returns:
+        :obj:`dict`: `ticks`, the number of times threads were sampled,
+            `interval_us`, the microseconds between ticks, and `phases`, a
+            mapping of span name, e.g. `gnode.process_table` or
+            `ctx1.notify`, to the samples of threads in it, summed over
+            threads. Threads outside every span are counted as `idle`.
+    """
+    return {
+        "ticks": int(get_profile_ticks()),
+        "interval_us": int(get_profile_interval_us()),
+        "phases": {name: int(samples) for name, samples in _get_profile().items()}
+    }
+
+
+__all__ = ["set_profiling_enabled", "is_profiling_enabled", "get_profile",
+           "clear_profile"]
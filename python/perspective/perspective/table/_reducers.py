@@ -0,0 +1,40 @@
+################################################################################
+#
+# Copyright (c) 2019, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+from .libbinding import register_reducer as _register_reducer, \
+    unregister_reducer
+
+
+def register_reducer(name, fn):
+    """Register `fn` as a reducer, so that views aggregate a column with it
+    when its aggregate is ``["reducer", name]``.
+
+    The reducer is called once per update with two numpy arrays: the float64
+    leaf values of every node whose rows changed, end to end, and the uint64
+    offsets at which each node's values begin, followed by their total
+    length, so that node ``i`` reduces ``values[offsets[i]:offsets[i + 1]]``.
+    It returns a sequence of one number, or ``None``, per node. Only the
+    nodes under updated rows are reduced, so each update costs one call
+    however many nodes it touches.
+
+    Args:
+        name (:obj:`str`): the name views refer to the reducer by.
+        fn (:obj:`callable`): the reducer, replacing any reducer already
+            registered as `name`.
+
+    Examples:
+        >>> def spread(values, offsets):
+        ...     return [values[b:e].max() - values[b:e].min() if e > b else None
+        ...             for b, e in zip(offsets[:-1], offsets[1:])]
+        >>> register_reducer("spread", spread)
+        >>> view = tbl.view(row_pivots=["desk"],
+        ...                 aggregates={"price": ["reducer", "spread"]})
+    """
+    if not callable(fn):
+        raise TypeError("A reducer must be callable")
+    _register_reducer(str(name), fn)
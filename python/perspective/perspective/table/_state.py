@@ -6,6 +6,8 @@
 # the Apache License 2.0.  The full license can be found in the LICENSE file.
 #
 
+import threading
+
 
 class _PerspectiveStateManager(object):
     """Internal state management class that controls when `_process` is called
@@ -32,6 +34,10 @@ class _PerspectiveStateManager(object):
     """
     TO_PROCESS = {}
 
+    # Held by `call_process`, which a coalescing timer may run on its own
+    # thread, and which calls the `call_process` of sources and dependents.
+    PROCESS_LOCK = threading.RLock()
+
     def __init__(self):
         """Create a new instance of the state manager, and enable the default behavior
         of calling `_process()` synchronously.
@@ -41,6 +47,41 @@ class _PerspectiveStateManager(object):
         overridden.
         """
         self.queue_process = self._queue_process_immediate
+        self.queue_notify = self._queue_notify_on_process
+        self._pending_notify = []
+
+        # Without an event loop, a coalesced `_process` which no later call
+        # flushes is run by this timer once it is due.
+        self._process_timer = None
+
+        # The state managers and table IDs of tables this table is derived
+        # from, and those of tables derived from this one, with their pools.
+        self._sources = []
+        self._dependents = []
+
+    def add_source(self, state_manager, table_id):
+        """Process the table `table_id` of `state_manager` before this
+        manager's table, as its updates are sent to this one.
+
+        Args:
+            state_manager (:obj:`_PerspectiveStateManager`): the manager of
+                the source table
+            table_id (:obj`int`): The unique ID of the source Table
+        """
+        self._sources.append((state_manager, table_id))
+
+    def add_dependent(self, state_manager, pool, table_id):
+        """Queue a `_process` call on the table `table_id` of
+        `state_manager` after each one on this manager's table, as it is
+        sent updates while this one is processed.
+
+        Args:
+            state_manager (:obj:`_PerspectiveStateManager`): the manager of
+                the dependent table
+            pool (:obj`libbinding.t_pool`): the pool of the dependent table
+            table_id (:obj`int`): The unique ID of the dependent Table
+        """
+        self._dependents.append((state_manager, pool, table_id))
 
     def set_process(self, pool, table_id):
         """Queue a `_process` call on the specified pool and table ID.
@@ -55,19 +96,47 @@ class _PerspectiveStateManager(object):
         if table_id not in _PerspectiveStateManager.TO_PROCESS:
             _PerspectiveStateManager.TO_PROCESS[table_id] = pool
             self.queue_process(table_id)
+        elif pool.is_coalescing() and pool.should_process():
+            # A coalesced `_process` is already queued, but enough rows have
+            # been sent since that it is now due.
+            self.queue_process(table_id)
 
     def call_process(self, table_id):
         """Given a table_id, find the corresponding pool and call `process()`
         on it, which takes all the updates that have been queued, applies each
         update to the global Table state, and then clears the queue.
 
+        Args:
+            table_id (:obj`int`): The unique ID of the Table
+        """
+        with _PerspectiveStateManager.PROCESS_LOCK:
+            self._cancel_process_timer()
+            for state_manager, source_id in self._sources:
+                state_manager.call_process(source_id)
+
+            pool = _PerspectiveStateManager.TO_PROCESS.get(table_id, None)
+            if pool is not None:
+                pool._process()
+                self.remove_process(table_id)
+                for state_manager, dependent_pool, dependent_id in self._dependents:
+                    state_manager.set_process(dependent_pool, dependent_id)
+            if self._pending_notify:
+                pending, self._pending_notify = self._pending_notify, []
+                for func in pending:
+                    func()
+
+    def get_process_delay(self, table_id):
+        """Return the number of seconds until the pending updates for a table
+        are due to be processed under its pool's coalescing policy, which is
+        0 if they are due now or if coalescing is disabled.
+
         Args:
             table_id (:obj`int`): The unique ID of the Table
         """
         pool = _PerspectiveStateManager.TO_PROCESS.get(table_id, None)
-        if pool is not None:
-            pool._process()
-            self.remove_process(table_id)
+        if pool is None:
+            return 0
+        return pool.get_process_delay() / 1e6
 
     def remove_process(self, table_id):
         """Remove a pool from the execution cache, indicating that it should no
@@ -78,15 +147,58 @@ class _PerspectiveStateManager(object):
         """
         _PerspectiveStateManager.TO_PROCESS.pop(table_id, None)
 
+    def _queue_notify_on_process(self, func, delay):
+        """Run `func`, the notification of a view with an update interval,
+        which is due in `delay` seconds, on the next `call_process`.
+
+        This is the default implementation of `queue_notify` for environments
+        without an event loop, which have no way to run it later; a
+        notification run before it is due queues itself again. Callers with
+        an event loop should set `queue_notify` to run `func` after `delay`.
+
+        Args:
+            func (:obj:`callable`): the notification
+            delay (:obj:`float`): the seconds until it is due
+        """
+        self._pending_notify.append(func)
+
     def _queue_process_immediate(self, table_id):
         """Immediately execute `call_process` on the pool as soon
         as `queue_process` is called.
 
         This is the default implementation of `queue_process` for environments
         without an event loop, meaning that calls to :obj:`~perspective.Table`'s
-        `update()` method are immediately followed by a call to `_process`.
+        `update()` method are immediately followed by a call to `_process`,
+        unless the pool is coalescing updates and they are not yet due, in
+        which case they are processed by a later `update()`, before output
+        is generated, or by a timer once they are due, whichever is first.
+
+        Args:
+            table_id (:obj`int`): The unique ID of the Table
+        """
+        delay = self.get_process_delay(table_id)
+        if delay == 0:
+            self.call_process(table_id)
+        elif self._process_timer is None:
+            self._process_timer = threading.Timer(
+                delay, self._process_when_due, [table_id])
+            self._process_timer.daemon = True
+            self._process_timer.start()
+
+    def _process_when_due(self, table_id):
+        """Run by the timer of `_queue_process_immediate`: process the
+        coalesced updates of `table_id` if nothing has since, queueing the
+        timer again if they are still not due.
 
         Args:
             table_id (:obj`int`): The unique ID of the Table
         """
-        self.call_process(table_id)
+        with _PerspectiveStateManager.PROCESS_LOCK:
+            self._process_timer = None
+            if table_id in _PerspectiveStateManager.TO_PROCESS:
+                self._queue_process_immediate(table_id)
+
+    def _cancel_process_timer(self):
+        if self._process_timer is not None:
+            self._process_timer.cancel()
+            self._process_timer = None
@@ -0,0 +1,48 @@
+################################################################################
+#
+# Copyright (c) 2020, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+import json
+from .libbinding import set_tracing_enabled as _set_tracing_enabled, \
+    is_tracing_enabled, get_trace as _get_trace, clear_trace
+
+
+def set_tracing_enabled(enabled):
+    """Start or stop recording spans of engine work - processing updates,
+    notifying each context, sorting, filtering and serializing - into a ring
+    buffer per thread, which keeps the most recent spans. Tracing can also be
+    enabled from startup by setting the `PSP_TRACE` environment variable.
+
+    Args:
+        enabled (:obj:`bool`): whether to record spans.
+    """
+    _set_tracing_enabled(bool(enabled))
+
+
+def get_trace():
+    """Returns the spans recorded since tracing was enabled, or last cleared,
+    as a Chrome trace event :obj:`dict`, which `chrome://tracing` and
+    Perfetto open when saved with :func:`save_trace`.
+
+    Returns:
+        :obj:`dict`: the trace, whose `traceEvents` are the spans.
+    """
+    return json.loads(_get_trace())
+
+
+def save_trace(path):
+    """Write the recorded spans to `path` as Chrome trace JSON.
+
+    Args:
+        path (:obj:`str`): the file to write.
+    """
+    with open(path, "w") as f:
+        f.write(_get_trace())
+
+
+__all__ = ["set_tracing_enabled", "is_tracing_enabled", "get_trace",
+           "save_trace", "clear_trace"]
@@ -6,21 +6,29 @@
 # the Apache License 2.0.  The full license can be found in the LICENSE file.
 #
 
+import os
+import six
 from datetime import date, datetime
-from .view import View
+from .view import View, _PRIORITIES
+from .totals import Totals
+from .view_config import ViewConfig
 from ._accessor import _PerspectiveAccessor
 from ._callback_cache import _PerspectiveCallBackCache
 from ..core.exception import PerspectiveError
 from ._date_validator import _PerspectiveDateValidator
 from ._state import _PerspectiveStateManager
+from ._executor import EXECUTOR
 from ._utils import _dtype_to_pythontype, _dtype_to_str
-from .libbinding import make_table, get_table_computed_schema, \
-                        get_computed_functions, get_computation_input_types, \
-                        str_to_filter_op, t_filter_op, t_op, t_dtype
+from .libbinding import make_table, make_data_generator, remove_where, \
+                        get_table_computed_schema, get_computed_functions, \
+                        get_computation_input_types, str_to_filter_op, \
+                        t_filter_op, t_op, t_dtype, t_join, t_union, \
+                        estimate_view_cost, make_replica, \
+                        get_replication_snapshot, take_replication_batches
 
 
 class Table(object):
-    def __init__(self, data, limit=None, index=None):
+    def __init__(self, data, limit=None, index=None, columns=None):
         '''Construct a :class:`~perspective.Table` using the provided data or
         schema and optional configuration dictionary.
 
@@ -30,8 +38,10 @@ class Table(object):
         conform to the column names and data types provided in the schema.
 
         Args:
-            data (:obj:`dict`/:obj:`list`/:obj:`pandas.DataFrame`): Data or
-                schema which initializes the :class:`~perspective.Table`.
+            data (:obj:`dict`/:obj:`list`/:obj:`pandas.DataFrame`/:obj:`str`):
+                Data or schema which initializes the
+                :class:`~perspective.Table`. A :obj:`str` is read as CSV
+                with a header row.
 
         Keyword Args:
             index (:obj:`str`): A string column name to use as the
@@ -39,10 +49,13 @@ class Table(object):
             limit (:obj:`int`): The maximum number of rows the
                 :class:`~perspective.Table` should have.  Cannot be set at the
                 same time as ``index``. Updates past the limit will begin
-                writing at row 0.
+                writing at row 0, replacing the oldest rows, which views see
+                as updates of those rows.
+            columns (:obj:`list`): For Parquet ``data``, the names of the
+                columns to read; every column is read if not provided.
         '''
         self._is_arrow = isinstance(data, (bytes, bytearray))
-        if (self._is_arrow):
+        if (self._is_arrow or isinstance(data, six.string_types)):
             _accessor = data
         else:
             _accessor = _PerspectiveAccessor(data)
@@ -53,16 +66,25 @@ class Table(object):
         self._index = index or ""
 
         # Always create tables on port 0
-        self._table = make_table(None, _accessor, self._limit,
-                                 self._index, t_op.OP_INSERT, False,
-                                 self._is_arrow, 0)
-
+        self._bind(make_table(None, _accessor, self._limit,
+                              self._index, t_op.OP_INSERT, False,
+                              self._is_arrow, 0, columns or []))
+
+    def _bind(self, table):
+        '''Wrap `table`, a C++ :obj:`libbinding.Table`, which has been sent
+        its first update.'''
+        self._table = table
         self._gnode_id = self._table.get_gnode().get_id()
         self._callbacks = _PerspectiveCallBackCache()
         self._delete_callbacks = _PerspectiveCallBackCache()
+        self._update_stats_callbacks = _PerspectiveCallBackCache()
         self._views = []
         self._delete_callback = None
 
+        # The keys and batches written by `generate()`.
+        self._num_generated_keys = 0
+        self._num_generated_batches = 0
+
         pool = self._table.get_pool()
         pool.set_update_delegate(self)
         pool._process()
@@ -70,6 +92,17 @@ class Table(object):
         # Each table always contains its own instance of state manager.
         self._state_manager = _PerspectiveStateManager()
 
+        # Set by `enable_log()` and `recover()`.
+        self._log_path = None
+        self._checkpoint_every = None
+        self._updates_since_checkpoint = 0
+
+        # The join or view feed this table is maintained by, if any.
+        self._source = None
+
+        # Called with each batch published by `enable_replication()`.
+        self._replication_callbacks = []
+
     def make_port(self):
         '''Create a new input port on the underlying `gnode`, and return an
         :obj:`int` containing the ID of the new input port.
@@ -91,6 +124,8 @@ class Table(object):
         '''
         self._state_manager.remove_process(self._table.get_id())
         self._table.reset_gnode(self._gnode_id)
+        self._checkpoint_cleared()
+        self._publish_replication()
 
     def replace(self, data):
         '''Replaces all rows in the :class:`~perspective.Table` with the new
@@ -102,9 +137,459 @@ class Table(object):
         '''
         self._state_manager.remove_process(self._table.get_id())
         self._table.reset_gnode(self._gnode_id)
+        self._checkpoint_cleared()
         self.update(data)
         self._state_manager.call_process(self._table.get_id())
 
+    def save_snapshot(self, path):
+        """Write a snapshot of all rows in the :class:`~perspective.Table`
+        to the directory at `path`, which is created if it does not exist.
+
+        A :class:`~perspective.Table` created later with the same schema and
+        index can read the snapshot back with :func:`load_snapshot()`, which
+        is much faster than re-ingesting the original data.
+
+        Args:
+            path (:obj:`str`): the directory to write the snapshot into.
+        """
+        self._state_manager.call_process(self._table.get_id())
+        if not os.path.isdir(path):
+            os.makedirs(path)
+        self._table.save_snapshot(path)
+
+    def load_snapshot(self, path):
+        """Replace all rows in the :class:`~perspective.Table` with the
+        snapshot written by :func:`save_snapshot()` to the directory at
+        `path`. The :class:`~perspective.Table` must have the same schema and
+        index as the one the snapshot was saved from, and no
+        :class:`~perspective.View` instances.
+
+        The snapshot's files are mapped rather than read, so rows are only
+        paged into memory as they are read, and each column is copied into
+        memory of its own the first time it is updated. The files must not be
+        changed, other than by :func:`save_snapshot()`, while the
+        :class:`~perspective.Table` reads them.
+
+        Args:
+            path (:obj:`str`): the directory containing the snapshot.
+        """
+        if len(self._views) > 0:
+            raise PerspectiveError(
+                "Cannot load a snapshot into a Table with active views.")
+        if not os.path.isdir(path):
+            raise PerspectiveError("Snapshot directory `{}` does not exist".format(path))
+        self._state_manager.call_process(self._table.get_id())
+        self._table.load_snapshot(path)
+
+    def enable_log(self, path, checkpoint_every=None):
+        """Log every update to the :class:`~perspective.Table` in the
+        directory at `path`, which is created if it does not exist, so that
+        its rows can be restored with :func:`recover()` after a crash without
+        re-ingesting the original data.
+
+        Updates are written to disk in the background, so they remain as fast
+        as without a log; :func:`flush_log()` waits until they are written.
+        A checkpoint, a snapshot of all rows, is written first and then by
+        each call to :func:`checkpoint()`, after which the updates before it
+        are discarded from the log.
+
+        Args:
+            path (:obj:`str`): the directory to write the log into.
+
+        Keyword Args:
+            checkpoint_every (:obj:`int`): write a checkpoint automatically
+                after this many updates.
+        """
+        self._state_manager.call_process(self._table.get_id())
+        self._make_log_dirs(path)
+        self._table.enable_update_log(path)
+        self._log_path = path
+        self._checkpoint_every = checkpoint_every
+        self._updates_since_checkpoint = 0
+
+    def checkpoint(self):
+        """Write a checkpoint of all rows to the log enabled by
+        :func:`enable_log()`, and discard the updates logged before it, which
+        keeps the log short and :func:`recover()` fast.
+        """
+        if self._log_path is None:
+            raise PerspectiveError("Cannot checkpoint a Table without a log.")
+        self._state_manager.call_process(self._table.get_id())
+        self._table.checkpoint()
+        self._updates_since_checkpoint = 0
+
+    def flush_log(self):
+        """Block until every update to the :class:`~perspective.Table` has
+        been written to its log.
+        """
+        if self._log_path is None:
+            raise PerspectiveError("Cannot flush a Table without a log.")
+        self._table.flush_update_log()
+
+    def recover(self, path, checkpoint_every=None):
+        """Replace all rows in the :class:`~perspective.Table` with the last
+        checkpoint in the log at `path`, and replay the updates logged after
+        it. The :class:`~perspective.Table` must have the same schema and
+        index as the one that was logged, and no
+        :class:`~perspective.View` instances. Later updates are logged to
+        `path` as by :func:`enable_log()`.
+
+        Args:
+            path (:obj:`str`): the directory containing the log.
+
+        Keyword Args:
+            checkpoint_every (:obj:`int`): write a checkpoint automatically
+                after this many updates.
+        """
+        if len(self._views) > 0:
+            raise PerspectiveError(
+                "Cannot recover a Table with active views.")
+        if not os.path.isdir(path):
+            raise PerspectiveError("Log directory `{}` does not exist".format(path))
+        self._state_manager.call_process(self._table.get_id())
+        self._make_log_dirs(path)
+        self._table.recover_from_log(path)
+        self._log_path = path
+        self._checkpoint_every = checkpoint_every
+        self._updates_since_checkpoint = 0
+
+    def enable_replication(self, callback):
+        """Publish every update the :class:`~perspective.Table` processes
+        to `callback`, as :obj:`bytes` which a replica created by
+        :func:`from_replication()` applies with :func:`apply()`, e.g. to
+        serve the views of one table from several processes or hosts.
+
+        A batch holds the rows of an update as this
+        :class:`~perspective.Table` processed them, in Arrow, so the replica
+        neither parses nor infers the types of the original data. Batches
+        must be applied in the order they are published, each once.
+
+        Args:
+            callback (:obj:`func`): called with each batch, after the
+                update it holds has been processed.
+
+        Returns:
+            :obj:`bytes`: a snapshot of every row, which the batches
+                published to `callback` follow, to create a replica from.
+        """
+        self._state_manager.call_process(self._table.get_id())
+        self._table.enable_replication()
+        self._replication_callbacks.append(callback)
+        return get_replication_snapshot(self._table)
+
+    @staticmethod
+    def from_replication(snapshot):
+        """Create a replica of a :class:`~perspective.Table` from the
+        snapshot returned by its :func:`enable_replication()`, with the same
+        schema, index and limit, and rows. The replica is kept up to date by
+        passing each batch published to :func:`apply()`, and should not be
+        updated otherwise.
+
+        Args:
+            snapshot (:obj:`bytes`): the snapshot to create the replica from.
+
+        Returns:
+            :class:`~perspective.Table`: the replica.
+        """
+        table = make_replica(snapshot)
+        replica = Table.__new__(Table)
+        replica._is_arrow = False
+        replica._date_validator = _PerspectiveDateValidator()
+        replica._limit = table.get_limit()
+        replica._index = table.get_index()
+        replica._bind(table)
+        return replica
+
+    def apply(self, batch):
+        """Apply a batch published by the :func:`enable_replication()` of
+        the :class:`~perspective.Table` this one is a replica of.
+
+        Args:
+            batch (:obj:`bytes`): the batch to apply.
+        """
+        # A batch which clears the table is applied immediately, so the
+        # batches before it are processed first.
+        self._state_manager.call_process(self._table.get_id())
+        self._table.apply_replication_batch(batch)
+        self._state_manager.set_process(self._table.get_pool(), self._table.get_id())
+
+    def _publish_replication(self):
+        """Call the callbacks of :func:`enable_replication()` with the
+        batches published since the last call."""
+        if len(self._replication_callbacks) == 0:
+            return
+        for batch in take_replication_batches(self._table):
+            for callback in self._replication_callbacks:
+                callback(batch)
+
+    def share_dictionary(self, column, other, other_column=None):
+        """Store the strings of `column` in the same dictionary as the
+        strings of `other_column` (`column` by default) in `other`, so that
+        tables holding the same symbols, names or codes keep one copy of each
+        string between them, and updates need not intern them again.
+
+        Tables sharing a dictionary must be updated from the same thread.
+
+        Args:
+            column (:obj:`str`): a string column of this
+                :class:`~perspective.Table`.
+            other (:class:`~perspective.Table`): the
+                :class:`~perspective.Table` whose dictionary to share.
+            other_column (:obj:`str`): a string column of `other`.
+        """
+        other_column = other_column or column
+        if self.schema().get(column) is not str or other.schema().get(other_column) is not str:
+            raise PerspectiveError(
+                "Cannot share a dictionary between `{}` and `{}`, which must both be string columns"
+                .format(column, other_column))
+        self._state_manager.call_process(self._table.get_id())
+        self._state_manager.call_process(other._table.get_id())
+        self._table.share_dictionary(column, other._table, other_column)
+
+    def join(self, right, on):
+        """Create a :class:`~perspective.Table` holding the left join of this
+        :class:`~perspective.Table` with `right` on the column `on`, which is
+        kept up to date as either side is updated, e.g. trades enriched with
+        the reference data of their symbol.
+
+        Each row of this :class:`~perspective.Table` matches the row of
+        `right` with the same value of `on`, so `right` must be indexed by
+        `on`. The joined :class:`~perspective.Table` is indexed like this
+        one, and has its columns followed by those of `right` but `on`,
+        which are null for rows without a match. An update to `right` only
+        touches the rows that match the rows it changed.
+
+        Args:
+            right (:class:`~perspective.Table`): the
+                :class:`~perspective.Table` to match rows with.
+            on (:obj:`str`): the column to match rows by, which is the index
+                of `right`.
+
+        Returns:
+            :class:`~perspective.Table`: the joined table, which should not
+                be updated directly.
+        """
+        if self._index == "":
+            raise PerspectiveError("Cannot join a Table without an index")
+        if right._index != on:
+            raise PerspectiveError(
+                "Cannot join on `{}`, which must be the index of the right Table".format(on))
+        self._state_manager.call_process(self._table.get_id())
+        right._state_manager.call_process(right._table.get_id())
+
+        join = t_join(self._table, right._table, on)
+        return Table._derive(join, self._index, [self, right])
+
+    def union(self, *others):
+        """Create a :class:`~perspective.Table` holding the rows of this
+        :class:`~perspective.Table` and of `others`, which is kept up to date
+        as any of them is updated, e.g. a table per region or per day viewed
+        as one.
+
+        Every :class:`~perspective.Table` must have the same columns, of the
+        same types, and the same index. The union is indexed like them, and
+        indexed tables are expected to hold distinct keys, as rows with the
+        same key are one row of the union. An update to one of the tables
+        only sends the rows it changed to the union.
+
+        Args:
+            others (:class:`~perspective.Table`): the tables to union with
+                this one.
+
+        Returns:
+            :class:`~perspective.Table`: the union, which should not be
+                updated directly.
+        """
+        schema = self.schema()
+        for other in others:
+            if other.schema() != schema:
+                raise PerspectiveError("Cannot union Tables with different schemas")
+            if other._index != self._index:
+                raise PerspectiveError("Cannot union Tables with different indices")
+        members = [self] + list(others)
+        for table in members:
+            table._state_manager.call_process(table._table.get_id())
+
+        union = t_union([table._table for table in members])
+        return Table._derive(union, self._index, members)
+
+    @staticmethod
+    def _derive(source, index, upstream):
+        '''Return a :class:`~perspective.Table` wrapping the table of
+        `source`, a join, union or view feed which sends it the updates processed
+        by the tables of `upstream`, and start `source`.'''
+        derived = Table.__new__(Table)
+        derived._is_arrow = False
+        derived._date_validator = _PerspectiveDateValidator()
+        derived._limit = 4294967295
+        derived._index = index
+        derived._bind(source.get_table())
+        derived._source = source
+        source.init()
+
+        # Updates processed upstream are sent to the derived table, whose
+        # pool is processed after theirs.
+        for table in upstream:
+            table._state_manager.add_dependent(
+                derived._state_manager, derived._table.get_pool(), derived._table.get_id())
+            derived._state_manager.add_source(table._state_manager, table._table.get_id())
+        derived._state_manager.set_process(derived._table.get_pool(), derived._table.get_id())
+        return derived
+
+    def create_index(self, column):
+        """Index the strings of `column`, so that views filtering it with
+        `==` or `in` are created from the rows they match, rather than from
+        a scan of every row. The index is built when a view first reads it,
+        and is kept up to date by every update after, so it suits columns
+        that views filter down to a small share of a large table, such as
+        symbols or desks.
+
+        Args:
+            column (:obj:`str`): a string column of this
+                :class:`~perspective.Table`.
+        """
+        if self.schema().get(column) is not str:
+            raise PerspectiveError(
+                "Cannot index `{}`, which must be a string column".format(column))
+        self._state_manager.call_process(self._table.get_id())
+        self._table.create_index(column)
+
+    def create_sorted_index(self, column, order="asc"):
+        """Keep the rows of this :class:`~perspective.Table` in the order of
+        `column`, so that views sorted by `column` alone, in `order`, are
+        created from the rows in order rather than by sorting them, as are
+        the rows later added to them in bulk. The index is built here and
+        kept up to date by every update after, so it suits columns that many
+        views sort by, such as the time of a trade.
+
+        Args:
+            column (:obj:`str`): a column of this :class:`~perspective.Table`.
+            order (:obj:`str`): "asc" or "desc", as a view's `sort`.
+        """
+        if column not in self.schema():
+            raise PerspectiveError(
+                "Cannot index `{}`, which is not a column".format(column))
+        if order not in ("asc", "desc"):
+            raise PerspectiveError(
+                "Cannot index `{}` in order `{}`, which must be \"asc\" or \"desc\"".format(column, order))
+        self._state_manager.call_process(self._table.get_id())
+        self._table.create_sorted_index(column, order)
+
+    def compact(self):
+        """Move the rows of this :class:`~perspective.Table` together and
+        release those of the primary keys removed since, so that a table
+        which has had most of its rows removed shrinks to the rows it holds.
+        Tables of more than a thousand rows are also compacted after an
+        update once half their rows have been removed.
+
+        Returns:
+            :obj:`int`: The number of rows released.
+        """
+        self._state_manager.call_process(self._table.get_id())
+        return self._table.compact_rows()
+
+    def set_column_spill(self, directory, idle=60):
+        """Spill the columns of this :class:`~perspective.Table` which no
+        view has referenced for `idle` seconds to files in `directory`,
+        releasing their memory. A spilled column is read from its file until
+        a view references it again or an update writes to it, when it is
+        reloaded into memory. Columns are spilled after each update, or by
+        :func:`spill_cold_columns`, so that a wide table whose views read a
+        few of its columns holds only those in memory.
+
+        Args:
+            directory (:obj:`str`): the directory to write spilled columns
+                to, or None to reload every spilled column and spill no
+                more.
+            idle (:obj:`float`): the number of seconds a column must be
+                unreferenced for before it is spilled.
+        """
+        if idle < 0:
+            raise PerspectiveError("Cannot spill columns idle for a negative time")
+        self._state_manager.call_process(self._table.get_id())
+        self._table.set_column_spill(directory or "", float(idle))
+
+    def spill_cold_columns(self):
+        """Spill the columns left cold under :func:`set_column_spill` now,
+        rather than after the next update.
+
+        Returns:
+            :obj:`int`: The number of columns spilled.
+        """
+        self._state_manager.call_process(self._table.get_id())
+        return self._table.spill_cold_columns()
+
+    def set_column_packing(self, idle=60):
+        """Bit-pack the integer, boolean, date and datetime columns of this
+        :class:`~perspective.Table` whose full-width values have not been
+        accessed for `idle` seconds, releasing their memory. Views read and
+        aggregate a packed column in place; anything else, such as sorting
+        on it or an update writing to it, unpacks it until it is idle again.
+        Columns are packed after each update, or by
+        :func:`pack_cold_columns`.
+
+        Args:
+            idle (:obj:`float`): the number of seconds a column must be
+                left unpacked before it is packed, or None to unpack every
+                packed column and pack no more.
+        """
+        if idle is not None and idle < 0:
+            raise PerspectiveError("Cannot pack columns idle for a negative time")
+        self._state_manager.call_process(self._table.get_id())
+        self._table.set_column_packing(idle is not None, float(idle or 0))
+
+    def pack_cold_columns(self):
+        """Pack the columns left cold under :func:`set_column_packing` now,
+        rather than after the next update.
+
+        Returns:
+            :obj:`int`: The number of columns packed.
+        """
+        self._state_manager.call_process(self._table.get_id())
+        return self._table.pack_cold_columns()
+
+    def reclaim_memory(self, nbytes=None):
+        """Release the state the views of this :class:`~perspective.Table`
+        can recompute on demand, e.g. under memory pressure: the cached trees
+        of deleted views first, then the state
+        :func:`~perspective.View.reclaim_memory` releases, from the largest
+        view down.
+
+        Args:
+            nbytes (:obj:`int`): the number of bytes to release, or None to
+                release as much as possible.
+
+        Returns:
+            :obj:`int`: The number of bytes released.
+        """
+        self._state_manager.call_process(self._table.get_id())
+        return self._table.reclaim_memory(int(nbytes or 0))
+
+    def set_column_scale(self, name, scale):
+        """Read the integer column `name` as a fixed-point decimal, which
+        holds its values multiplied by 10 to the power of `scale`, e.g. an
+        amount in cents at a scale of 2. Aggregates of the column are exact
+        integer sums, and views read them as floats divided by the scale.
+        Columns of Arrow decimals are fixed-point at the decimal's scale.
+
+        This must be called before any views of the table are created.
+
+        Args:
+            name (:obj:`str`): the name of an integer column.
+            scale (:obj:`int`): the number of decimal digits, from 0 to 18,
+                where 0 reads the column as integers.
+        """
+        self._table.set_column_scale(name, int(scale))
+
+    def column_scales(self):
+        """Returns a dict of the scale of each fixed-point column of this
+        :class:`~perspective.Table`.
+
+        Returns:
+            :obj:`dict`: the scale of each fixed-point column, by name.
+        """
+        return self._table.get_column_scales()
+
     def get_computed_functions(self):
         """Returns a dict of computed function metadata, where each value is a
         dict that contains the following metadata:
@@ -129,6 +614,118 @@ class Table(object):
         self._state_manager.call_process(self._table.get_id())
         return self._table.size()
 
+    def get_memory_usage(self):
+        '''Returns the number of bytes used by each component of this
+        :class:`~perspective.Table` - its columns, vocabularies, primary keys,
+        column indexes and zone maps and port tables - as a :obj:`dict`. The memory used by the views of
+        the table is reported by :func:`~perspective.View.get_memory_usage`.
+
+        Returns:
+            :obj:`dict`: A mapping of component name to bytes.
+        '''
+        self._state_manager.call_process(self._table.get_id())
+        return dict(self._table.get_memory_usage())
+
+    def get_update_stats(self):
+        '''Returns the statistics of the last update this
+        :class:`~perspective.Table` processed, as a :obj:`dict`:
+
+        - `port_id`, the port the update was processed on.
+        - `rows_in` and `rows_flattened`, the rows in the update before and
+          after rows sharing an index were merged.
+        - `flatten_passthrough`, whether the update's rows were already in
+          increasing index order with no index repeated or removed, so were
+          used as merged without being copied.
+        - `append`, whether every row's index was greater than any in the
+          table, as the rows of a table without an `index` which is only
+          updated are, so the rows were appended without being looked up.
+        - `rows_added`, `rows_updated` and `rows_removed`, the rows whose
+          index was new, already in the table, or removed.
+        - `columns_skipped`, the columns that no view reads on an update,
+          which were not compared with their previous values.
+        - `total_ns`, `flatten_ns`, `lookup_ns`, `process_columns_ns`,
+          `computed_columns_ns`, `update_master_table_ns` and `notify_ns`,
+          the nanoseconds spent in the update and in each of its phases.
+        - `context_notify_ns`, a :obj:`dict` of the nanoseconds spent
+          updating each view, by its internal name.
+
+        Views set to the "background" priority are updated after the
+        "visible" ones, and are included once they have been.
+
+        Returns:
+            :obj:`dict`: The statistics, or an empty :obj:`dict` if no update
+                has been processed.
+        '''
+        self._state_manager.call_process(self._table.get_id())
+        return self._get_update_stats()
+
+    def get_latency_stats(self):
+        '''Returns latency histograms of the updates of this
+        :class:`~perspective.Table` since they were last reset, for
+        verifying tail latencies rather than averages:
+
+        - `send_wait`, from the first `update()` an update included until it
+          was processed.
+        - `process`, how long processing took.
+        - `callback_wait`, from then until the first `on_update` callbacks
+          were called.
+        - `end_to_end`, from the first `update()` until those callbacks.
+
+        Each has a `count`, and the `min_ns`, `max_ns`, `mean_ns`, `p50_ns`,
+        `p90_ns`, `p99_ns` and `p999_ns` latencies in nanoseconds;
+        percentiles are within 1/16th of the latency recorded. Unlike
+        :func:`~perspective.Table.get_update_stats()`, pending updates are not
+        processed first, which would shorten their wait.
+
+        Returns:
+            :obj:`dict`: A mapping of histogram to a :obj:`dict` of statistic
+                to value.
+        '''
+        stats = {}
+        for key, value in self._table.get_latency_stats().items():
+            histogram, stat = key.split(".")
+            stats.setdefault(histogram, {})[stat] = value
+        return stats
+
+    def reset_latency_stats(self):
+        '''Clear the histograms of
+        :func:`~perspective.Table.get_latency_stats()`.'''
+        self._table.reset_latency_stats()
+
+    def on_update_stats(self, callback):
+        '''Register a callback to be invoked with the
+        :func:`~perspective.Table.get_update_stats()` of each update, once
+        its visible views have been updated.
+
+        Args:
+            callback (:obj:`func`): A callback function that takes the
+                statistics :obj:`dict`.
+
+        Examples:
+            >>> table.on_update_stats(lambda stats: print(stats["total_ns"]))
+        '''
+        if not callable(callback):
+            raise ValueError("on_update_stats callback must be a callable function!")
+        self._update_stats_callbacks.add_callback(callback)
+
+    def remove_update_stats(self, callback):
+        '''De-register a callback registered with
+        :func:`~perspective.Table.on_update_stats()`.
+        '''
+        if not callable(callback):
+            raise ValueError("remove_update_stats callback should be a callable function!")
+        self._update_stats_callbacks.remove_callbacks(lambda cb: cb != callback)
+
+    def _get_update_stats(self):
+        prefix = "context_notify_ns."
+        stats = {"context_notify_ns": {}}
+        for key, value in self._table.get_update_stats().items():
+            if key.startswith(prefix):
+                stats["context_notify_ns"][key[len(prefix):]] = value
+            else:
+                stats[key] = value
+        return stats if len(stats) > 1 else {}
+
     def schema(self, as_string=False):
         '''Returns the schema of this :class:`~perspective.Table`, a :obj:`dict`
         mapping of string column names to python data types.
@@ -265,8 +862,9 @@ class Table(object):
         append.
 
         Args:
-            data (:obj:`dict`/:obj:`list`/:obj:`pandas.DataFrame`): The data
-                with which to update the :class:`~perspective.Table`.
+            data (:obj:`dict`/:obj:`list`/:obj:`pandas.DataFrame`/:obj:`str`):
+                The data with which to update the :class:`~perspective.Table`.
+                A :obj:`str` is read as CSV with a header row.
 
         Examples:
             >>> tbl = Table({"a": [1, 2, 3], "b": ["a", "b", "c"]}, index="a")
@@ -281,9 +879,17 @@ class Table(object):
 
         if (_is_arrow):
             _accessor = data
-            self._table = make_table(self._table, _accessor, self._limit, self._index, t_op.OP_INSERT, True, True, port_id)
+            self._table = make_table(self._table, _accessor, self._limit, self._index, t_op.OP_INSERT, True, True, port_id, [])
+            self._state_manager.set_process(
+                self._table.get_pool(), self._table.get_id())
+            self._count_logged_update()
+            return
+
+        if isinstance(data, six.string_types):
+            self._table = make_table(self._table, data, self._limit, self._index, t_op.OP_INSERT, True, False, port_id, [])
             self._state_manager.set_process(
                 self._table.get_pool(), self._table.get_id())
+            self._count_logged_update()
             return
 
         columns = self.columns()
@@ -308,9 +914,10 @@ class Table(object):
                 _accessor._types.append(t_dtype.DTYPE_INT32)
 
         self._table = make_table(self._table, _accessor, self._limit,
-                                 self._index, t_op.OP_INSERT, True, False, port_id)
+                                 self._index, t_op.OP_INSERT, True, False, port_id, [])
         self._state_manager.set_process(
             self._table.get_pool(), self._table.get_id())
+        self._count_logged_update()
 
     def remove(self, pkeys, port_id=0):
         '''Removes the rows with the primary keys specified in ``pkeys``.
@@ -336,11 +943,99 @@ class Table(object):
         _accessor._names = [self._index]
         _accessor._types = types
         t = make_table(self._table, _accessor,  self._limit,
-                       self._index, t_op.OP_DELETE, True, False, port_id)
+                       self._index, t_op.OP_DELETE, True, False, port_id, [])
         self._state_manager.set_process(t.get_pool(), t.get_id())
+        self._count_logged_update()
+
+    def remove_where(self, filter, filter_op="and", port_id=0):
+        '''Removes the rows which pass ``filter``, as :meth:`view` filters
+        them, such as the rows older than a retention cutoff. The rows are
+        found in one pass over the table and removed as a single batch,
+        without reading their primary keys back into Python.
+
+        If the :class:`~perspective.Table` does not have an index,
+        ``remove_where()`` has no effect.
+
+        Args:
+            filter (:obj:`list`): a list of filters, e.g.
+                ``[["time", "<", cutoff]]``.
+            filter_op (:obj:`str`): ``"and"`` to remove the rows which
+                pass every filter, or ``"or"`` those which pass any.
+
+        Returns:
+            :obj:`int`: The number of rows removed.
+
+        Example:
+            >>> tbl = Table({"a": [1, 2, 3]}, index="a")
+            >>> tbl.remove_where([["a", ">", 1]])
+            2
+            >>> tbl.view().to_records()
+            [{"a": 1}]
+        '''
+        if self._index == "":
+            return 0
+        if len(filter) == 0:
+            raise PerspectiveError("`remove_where` requires at least one filter")
+        schema = self.schema()
+        for term in filter:
+            if term[0] not in schema:
+                raise PerspectiveError(
+                    "Cannot remove rows by `{}`, which is not a column".format(term[0]))
+        self._state_manager.call_process(self._table.get_id())
+        config = ViewConfig(filter=filter, filter_op=filter_op)
+        removed = remove_where(self._table, config, _PerspectiveDateValidator(), port_id)
+        if removed > 0:
+            self._state_manager.set_process(self._table.get_pool(), self._table.get_id())
+            self._count_logged_update()
+        return removed
+
+    def generate(self, spec=None, insert=0, update=0, remove=0, port_id=0):
+        '''Insert, update and remove generated rows, for testing at scale
+        without serializing the input. Rows are generated directly in the
+        engine, with the schema of the :class:`~perspective.Table`, and are
+        keyed by integers written to its ``index``: updates and removes pick
+        from the keys inserted by earlier calls, so a
+        :class:`~perspective.Table` without an ``index`` can only be inserted
+        into.
+
+        Values are deterministic for a given ``spec``, so calling
+        ``generate()`` with the same arguments on two new tables gives them
+        the same rows.
+
+        Args:
+            spec (:obj:`dict`): How to generate each column, with the
+                optional keys ``seed``; ``rows``, the number of rows that
+                sorted columns, and columns with a distinct value per row,
+                spread their values over; and ``columns``, a :obj:`dict` of
+                column names to their ``cardinality`` (the number of distinct
+                values, or 0 for a distinct value per row), ``null_ratio``,
+                ``string_length`` and ``sortedness`` (the fraction of rows
+                whose value is in key order).
+
+        Keyword Args:
+            insert (:obj:`int`): The number of rows to insert.
+            update (:obj:`int`): The number of existing rows to update.
+            remove (:obj:`int`): The number of existing rows to remove.
+            port_id (:obj:`int`): The port to send the rows to.
+
+        Examples:
+            >>> tbl = Table({"id": int, "x": float, "g": str}, index="id")
+            >>> spec = {"columns": {"g": {"cardinality": 100}}}
+            >>> tbl.generate(spec, insert=1000000)
+            >>> tbl.generate(spec, insert=100, update=1000, remove=10)
+        '''
+        generator = make_data_generator(spec or {}, self._num_generated_keys,
+                                        self._num_generated_batches)
+        generator.generate(self._table, insert, update, remove, port_id or 0)
+        self._num_generated_keys = generator.get_num_keys()
+        self._num_generated_batches = generator.get_num_batches()
+        self._state_manager.set_process(
+            self._table.get_pool(), self._table.get_id())
+        self._count_logged_update()
 
     def view(self, columns=None, row_pivots=None, column_pivots=None,
-             aggregates=None, sort=None, filter=None, computed_columns=None):
+             aggregates=None, sort=None, filter=None, computed_columns=None,
+             progressive=False):
         ''' Create a new :class:`~perspective.View` from this
         :class:`~perspective.Table` via the supplied keyword arguments.
 
@@ -352,19 +1047,36 @@ class Table(object):
             columns (:obj:`list` of :obj:`str`): A list of column names to be
                 visible to the user.
             row_pivots (:obj:`list` of :obj:`str`): A list of column names to
-                use as row pivots.
+                use as row pivots. A pivot of the form ``"function(column)"``,
+                where ``function`` is a bucketing computed function such as
+                ``"bin10"`` or ``"hour_bucket"``, pivots on the buckets of
+                ``column`` without adding a computed column to the table.
             column_pivots (:obj:`list` of :obj:`str`): A list of column names
-                to use as column pivots.
+                to use as column pivots, bucketed as ``row_pivots`` are.
             aggregates (:obj:`dict` of :obj:`str` to :obj:`str`):  A dictionary
                 of column names to aggregate types, which specify aggregates
-                for individual columns.
+                for individual columns. ``["reducer", name]`` aggregates a
+                column with a reducer registered by
+                :func:`~perspective.register_reducer`.
             sort (:obj:`list` of :obj:`list` of :obj:`str`): A list of lists,
                 each list containing a column name and a sort direction
                 (``asc``, ``desc``, ``asc abs``, ``desc abs``, ``col asc``,
                 ``col desc``, ``col asc abs``, ``col desc abs``).
             filter (:obj:`list` of :obj:`list` of :obj:`str`):  A list of lists,
                 each list containing a column name, a filter comparator, and a
-                value to filter by.
+                value to filter by. The value may be ``{"column": name}`` to
+                compare two columns of each row, e.g.
+                ``["bid", ">", {"column": "ask"}]``, and filters may be
+                nested in groups such as ``{"or": [filter, ...]}``.
+            progressive (:obj:`bool`): If True, return the
+                :class:`~perspective.View` at once and build it on an engine
+                worker thread, a chunk of rows at a time. Until it is built,
+                it serves the aggregates of the rows read so far, reports its
+                progress through :func:`~perspective.View.get_progress()`,
+                and calls its :func:`~perspective.View.on_update()` callbacks
+                after each chunk. If "queued", it is built in the same way
+                on a worker thread of its own, after the queued views before
+                it, so that expensive views are built one at a time.
 
         Returns:
             :class:`~perspective.View`: A new :class:`~perspective.View`
@@ -377,7 +1089,76 @@ class Table(object):
             >>> {"a": [1]}
         '''
         self._state_manager.call_process(self._table.get_id())
+        config = self._view_config(columns, row_pivots, column_pivots,
+                                   aggregates, sort, filter, computed_columns)
+        view = View(self, progressive=progressive, **config)
+        self._views.append(view._name)
+        return view
+
+    def estimate_view_cost(self, columns=None, row_pivots=None,
+                           column_pivots=None, aggregates=None, sort=None,
+                           filter=None, computed_columns=None):
+        '''Estimate the cost of building a :class:`~perspective.View` of this
+        :class:`~perspective.Table` with the supplied keyword arguments,
+        which are those of :func:`view`, without building it. The estimate
+        is made from the size of the table, the cardinalities of the pivots,
+        which are read from the vocabularies of string columns, and the
+        complexity of the aggregates, filters and computed columns.
+
+        Returns:
+            :obj:`dict`: the `rows` the view reads, the leaf `groups` and
+                tree `nodes` it is estimated to build, and its `cost` in
+                operations on rows, which is comparable between views.
+        '''
+        self._state_manager.call_process(self._table.get_id())
+        config = self._view_config(columns, row_pivots, column_pivots,
+                                   aggregates, sort, filter, computed_columns)
+        return estimate_view_cost(
+            self._table, ViewConfig(**config), _PerspectiveDateValidator())
+
+    def totals(self, columns=None, aggregates=None, filter=None):
+        '''Create the :class:`~perspective.Totals` of this
+        :class:`~perspective.Table`, the values of the root row of a
+        pivoted :func:`view` with the same arguments. Totals are kept up to
+        date as the table is updated by adding the rows each update inserts
+        and subtracting the previous values of the rows it changes or
+        removes, so they cost much less to maintain than a view without a
+        tree, traversal or sort to update.
+
+        The ``sum``, ``count``, ``mean``, ``weighted mean``, ``high``,
+        ``low``, ``median``, ``min``, ``max``, ``distinct count``,
+        ``unique`` and ``dominant`` aggregates are supported.
 
+        Keyword Arguments:
+            columns (:obj:`list` of :obj:`str`): the columns to total, every
+                column if not provided.
+            aggregates (:obj:`dict` of :obj:`str` to :obj:`str`): the
+                aggregate of each column, as in :func:`view`.
+            filter (:obj:`list` of :obj:`list` of :obj:`str`): the filters
+                of the rows to total, as in :func:`view`.
+
+        Returns:
+            :class:`~perspective.Totals`: the totals, which should be
+                deleted when no longer read.
+
+        Examples:
+            >>> tbl = Table({"a": [1, 2, 3]})
+            >>> totals = tbl.totals()
+            >>> tbl.update({"a": [4]})
+            >>> totals.to_dict()
+            >>> {"a": 10}
+        '''
+        self._state_manager.call_process(self._table.get_id())
+        config = self._view_config(columns, None, None, aggregates, None,
+                                   filter, None)
+        totals = Totals(self, **config)
+        self._views.append(totals._name)
+        return totals
+
+    def _view_config(self, columns, row_pivots, column_pivots, aggregates,
+                     sort, filter, computed_columns):
+        '''Returns the keyword arguments of a :class:`~perspective.ViewConfig`
+        of the arguments of :func:`view`.'''
         config = {}
         if columns is None:
             config["columns"] = self.columns()
@@ -399,10 +1180,23 @@ class Table(object):
             config["filter"] = filter
         if computed_columns is not None:
             config["computed_columns"] = computed_columns
+        return config
 
-        view = View(self, **config)
-        self._views.append(view._name)
-        return view
+    def view_async(self, **kwargs):
+        '''Create a new :class:`~perspective.View` on an engine worker thread,
+        so that the calling thread, e.g. an event loop, is not blocked while a
+        large context is built. Takes the same keyword arguments as
+        :func:`~perspective.Table.view()`.
+
+        Returns:
+            :obj:`concurrent.futures.Future`: resolves to the new
+                :class:`~perspective.View`.
+
+        Examples:
+            >>> future = tbl.view_async(row_pivots=["a"])
+            >>> view = future.result()
+        '''
+        return EXECUTOR.submit(self.view, **kwargs)
 
     def on_delete(self, callback):
         '''Register a callback to be invoked when the
@@ -454,15 +1248,57 @@ class Table(object):
         self._table.unregister_gnode(self._gnode_id)
         [cb() for cb in self._delete_callbacks.get_callbacks()]
 
-    def _update_callback(self, port_id):
+    def _make_log_dirs(self, path):
+        for checkpoint in ("checkpoint.0", "checkpoint.1"):
+            checkpoint_path = os.path.join(path, checkpoint)
+            if not os.path.isdir(checkpoint_path):
+                os.makedirs(checkpoint_path)
+
+    def _count_logged_update(self):
+        if self._checkpoint_every is None:
+            return
+        self._updates_since_checkpoint += 1
+        if self._updates_since_checkpoint >= self._checkpoint_every:
+            self.checkpoint()
+
+    def _checkpoint_cleared(self):
+        # Logged updates from before a clear must not be replayed after it.
+        if self._log_path is not None:
+            self.checkpoint()
+
+    def _update_callback(self, port_id, priority=0):
         """After `process` completes internally, this method is called by the
         C++ with a `port_id`, indicating the port on which the update was
-        processed.
+        processed, once for the visible views and once for the background
+        views.
 
         Arguments:
             port_id (:obj:`int`): an int indicating which port the update
             came from.
+            priority (:obj:`int`): the `t_ctx_priority` of the views that
+            were updated.
         """
         cache = {}
+        limited = []
         for callback in self._callbacks.get_callbacks():
+            view = callback["view"]
+            if view._priority != priority or view._frozen:
+                continue
+            if view._update_interval > 0:
+                # notified once for all of its callbacks, when due
+                if view not in limited:
+                    limited.append(view)
+                continue
             callback["callback"](port_id=port_id, cache=cache)
+
+        for view in limited:
+            view._notify(port_id)
+
+        if priority == _PRIORITIES.index("visible"):
+            self._publish_replication()
+
+        if priority == _PRIORITIES.index("visible") and \
+                len(self._update_stats_callbacks.get_callbacks()) > 0:
+            stats = self._get_update_stats()
+            for callback in self._update_stats_callbacks.get_callbacks():
+                callback(stats)
@@ -0,0 +1,49 @@
+################################################################################
+#
+# Copyright (c) 2019, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+from random import random
+from .view_config import ViewConfig
+from ._date_validator import _PerspectiveDateValidator
+from .libbinding import make_totals, get_totals_values, unregister_totals
+
+
+class Totals(object):
+    '''The grand totals of a :class:`~perspective.Table`, the aggregates of
+    the root row of a pivoted :class:`~perspective.View`, kept up to date
+    with each update without building a tree of its rows. Create one with
+    :func:`~perspective.Table.totals`.
+    '''
+
+    def __init__(self, Table, **kwargs):
+        self._table = Table
+        self._config = ViewConfig(**kwargs)
+        self._name = "py_totals_" + str(random())
+        self._totals = make_totals(self._table._table, self._name,
+                                   self._config, _PerspectiveDateValidator())
+
+    def get_config(self):
+        '''Returns a copy of the config the totals were created with.'''
+        return self._config.get_config()
+
+    def to_dict(self):
+        '''Returns a :obj:`dict` of each column's total, after processing
+        the updates queued on the :class:`~perspective.Table`.
+
+        Examples:
+            >>> tbl = Table({"a": [1, 2, 3]})
+            >>> tbl.totals().to_dict()
+            >>> {"a": 6}
+        '''
+        self._table._state_manager.call_process(self._table._table.get_id())
+        return get_totals_values(self._table._table, self._totals)
+
+    def delete(self):
+        '''Stop updating the totals, which otherwise last as long as the
+        :class:`~perspective.Table`.'''
+        unregister_totals(self._table._table, self._name)
+        self._table._views.pop(self._table._views.index(self._name))
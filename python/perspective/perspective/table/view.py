@@ -6,6 +6,7 @@
 # the Apache License 2.0.  The full license can be found in the LICENSE file.
 #
 
+import json
 import os
 import pandas
 from functools import partial, wraps
@@ -17,9 +18,25 @@ from ._constants import COLUMN_SEPARATOR_STRING
 from ._utils import _str_to_pythontype
 from ._callback_cache import _PerspectiveCallBackCache
 from ._date_validator import _PerspectiveDateValidator
+from ._executor import EXECUTOR, QUEUED_EXECUTOR
+from ..core.exception import PerspectiveError
 from .libbinding import make_view_zero, make_view_one, make_view_two,\
     to_arrow_zero, to_arrow_one, to_arrow_two, get_row_delta_zero,\
-    get_row_delta_one, get_row_delta_two
+    get_row_delta_one, get_row_delta_two, to_arrow_chunked_zero,\
+    to_arrow_chunked_one, to_arrow_chunked_two, get_histogram_zero,\
+    get_histogram_one, get_histogram_two, get_min_max_zero, get_min_max_one,\
+    get_min_max_two, to_parquet_zero, to_parquet_one,\
+    to_parquet_two, compress_arrow, t_ctx_priority, cursor_to_arrow_zero,\
+    cursor_to_arrow_one, cursor_to_arrow_two, t_view_feed
+
+# The end of a viewport that covers every row or column.
+_VIEWPORT_UNBOUNDED = 2147483647
+
+# In the order of `t_ctx_priority`.
+_PRIORITIES = ["visible", "background", "paused"]
+
+# The number of rows a progressive view reads from its table at a time.
+_BUILD_CHUNK_ROWS = 65536
 
 
 class View(object):
@@ -37,25 +54,41 @@ class View(object):
     process updates until :obj:`~perspective.View.delete()` method is called.
     '''
 
-    def __init__(self, Table, **kwargs):
+    def __init__(self, Table, progressive=False, **kwargs):
         self._name = "py_" + str(random())
         self._table = Table
         self._config = ViewConfig(**kwargs)
         self._sides = self.sides()
+        self._priority = _PRIORITIES.index("visible")
+        self._frozen = False
+        self._deleted = False
+
+        # Set by `set_update_interval`, and the port and whether a limited
+        # notification is queued.
+        self._update_interval = 0
+        self._notify_port_id = 0
+        self._notify_queued = False
 
         date_validator = _PerspectiveDateValidator()
 
         if self._sides == 0:
-            self._view = make_view_zero(self._table._table, self._name, COLUMN_SEPARATOR_STRING, self._config, date_validator)
+            self._view = make_view_zero(self._table._table, self._name, COLUMN_SEPARATOR_STRING, self._config, date_validator, bool(progressive))
         elif self._sides == 1:
-            self._view = make_view_one(self._table._table, self._name, COLUMN_SEPARATOR_STRING, self._config, date_validator)
+            self._view = make_view_one(self._table._table, self._name, COLUMN_SEPARATOR_STRING, self._config, date_validator, bool(progressive))
         else:
-            self._view = make_view_two(self._table._table, self._name, COLUMN_SEPARATOR_STRING, self._config, date_validator)
+            self._view = make_view_two(self._table._table, self._name, COLUMN_SEPARATOR_STRING, self._config, date_validator, bool(progressive))
 
         self._column_only = self._view.is_column_only()
         self._callbacks = self._table._callbacks
         self._delete_callbacks = _PerspectiveCallBackCache()
         self._client_id = None
+        if progressive == "queued":
+            self._build_future = QUEUED_EXECUTOR.submit(self._build)
+        else:
+            self._build_future = EXECUTOR.submit(self._build) if progressive else None
+
+        # The feeds of the tables created by `to_table()`.
+        self._feeds = []
 
     def get_config(self):
         '''Returns a copy of the immutable configuration ``kwargs`` from which
@@ -99,6 +132,68 @@ class View(object):
         '''
         return self._view.num_rows()
 
+    def get_memory_usage(self):
+        '''The number of bytes used by each component of the
+        :class:`~perspective.View`, such as its traversal, tree and
+        aggregates. Views which share a tree each report it.
+
+        Returns:
+            :obj:`dict`: A mapping of component name to bytes.
+        '''
+        self._table._state_manager.call_process(self._table._table.get_id())
+        return dict(self._view.get_memory_usage())
+
+    def explain(self):
+        '''Describe how the :class:`~perspective.View` is computed, to find
+        which part of its config makes it slow.
+
+        The result has each filter term with the number and fraction of the
+        table's rows it passes, the nodes at each depth of each of the
+        view's trees, how each aggregate is maintained on update
+        (``"incremental"``, ``"running"``, ``"multiset"``, ``"reducer"``
+        for registered reducers, or ``"leaf_scan"`` for aggregates which
+        reread every row under an updated node), its computed columns, and
+        an ``estimated_update_cost`` of the operations each updated row
+        costs. Filter selectivity is measured over a copy of the table, so
+        this is a diagnostic rather than something to call on every update.
+
+        Returns:
+            :obj:`dict`: The explanation.
+        '''
+        self._table._state_manager.call_process(self._table._table.get_id())
+        return json.loads(self._view.explain())
+
+    def get_latency_stats(self):
+        '''Returns latency histograms of the updates of this
+        :class:`~perspective.View` since they were last reset:
+
+        - `notify`, how long updating the view took.
+        - `callback_wait`, from then until its `on_update` callbacks were
+          called.
+        - `end_to_end`, from the first `update()` of the table that the
+          update included until the callbacks.
+
+        Each has a `count`, and the `min_ns`, `max_ns`, `mean_ns`, `p50_ns`,
+        `p90_ns`, `p99_ns` and `p999_ns` latencies in nanoseconds;
+        percentiles are within 1/16th of the latency recorded. Views which
+        share a tree with another view are updated with it, and record no
+        `notify`.
+
+        Returns:
+            :obj:`dict`: A mapping of histogram to a :obj:`dict` of statistic
+                to value.
+        '''
+        stats = {}
+        for key, value in self._view.get_latency_stats().items():
+            histogram, stat = key.split(".")
+            stats.setdefault(histogram, {})[stat] = value
+        return stats
+
+    def reset_latency_stats(self):
+        '''Clear the histograms of
+        :func:`~perspective.View.get_latency_stats()`.'''
+        self._view.reset_latency_stats()
+
     def num_columns(self):
         '''The number of aggregated columns in the :class:`~perspective.View`.
         This is affected by the ``column_pivots`` that are applied to the
@@ -143,6 +238,271 @@ class View(object):
         '''
         return self._view.set_depth(depth, len(self._config.get_row_pivots()))
 
+    def get_expansion_state(self):
+        '''Returns the expanded rows of the pivot tree, which
+        ``set_expansion_state`` expands again on this or another
+        :class:`~perspective.View` of the same table and ``row_pivots``, e.g.
+        when a view is replaced by one with a new ``sort``.
+
+        Returns:
+            (:obj:`list`): the paths of the deepest expanded rows, or an
+                empty list if the view has no ``row_pivots``.
+        '''
+        if len(self._config.get_row_pivots()) == 0:
+            return []
+        return self._view.get_expansion_state()
+
+    def set_expansion_state(self, state):
+        '''Expands the rows of ``state``, as returned by
+        ``get_expansion_state``, and their parents, all at once rather than
+        row by row as ``expand`` does. Rows which are no longer in the view
+        are skipped.
+
+        Args:
+            state (:obj:`list`): the expansion state to restore.
+        '''
+        if len(self._config.get_row_pivots()) == 0:
+            return
+        self._view.set_expansion_state(state)
+
+    def set_lazy_aggregates(self, enabled):
+        '''Aggregates only the rows of the pivot tree which are visible, and
+        computes hidden rows when they are expanded, rather than aggregating
+        every row on each update. Lazy aggregation can also be enabled for
+        every view by setting the `PSP_LAZY_AGGREGATES` environment variable.
+
+        Args:
+            enabled (:obj:`bool`): whether to aggregate lazily.
+        '''
+        if len(self._config.get_row_pivots()) == 0:
+            return
+        self._view.set_lazy_aggregates(bool(enabled))
+
+    def get_lazy_aggregates(self):
+        '''Returns whether hidden rows of the pivot tree are aggregated only
+        when they are expanded.'''
+        if len(self._config.get_row_pivots()) == 0:
+            return False
+        return self._view.get_lazy_aggregates()
+
+    def set_viewport(self, start_row=0, end_row=None, start_col=0, end_col=None):
+        '''Registers the window of the :class:`~perspective.View` that is
+        rendered, in the same coordinates as ``to_records``. Row and cell
+        deltas passed to ``on_update`` callbacks then only contain changes
+        that intersect it.
+
+        Args:
+            start_row (:obj:`int`): (Defaults to 0).
+            end_row (:obj:`int`): (Defaults to every row, however many the
+                view later has).
+            start_col (:obj:`int`): (Defaults to 0).
+            end_col (:obj:`int`): (Defaults to every column).
+        '''
+        end_row = _VIEWPORT_UNBOUNDED if end_row is None else end_row
+        end_col = _VIEWPORT_UNBOUNDED if end_col is None else end_col
+        self._view.set_viewport(max(start_row, 0), max(end_row, 0), max(start_col, 0), max(end_col, 0))
+
+    def clear_viewport(self):
+        '''Reports deltas over the whole :class:`~perspective.View` again.'''
+        self._view.clear_viewport()
+
+    def row_count_changed(self):
+        '''Whether the number of rows in the :class:`~perspective.View`
+        changed in the last update, which is cheaper to check than a row
+        delta.
+
+        Returns:
+            :obj:`bool`: True if rows were added or removed.
+        '''
+        return self._view.get_row_count_changed()
+
+    def set_priority(self, priority):
+        '''Set how eagerly this :class:`~perspective.View` is updated.
+
+        A "visible" view is updated, and its :func:`on_update` callbacks
+        fired, before any "background" view, so that the views on screen do
+        not wait for the rest. A "paused" view is not updated at all; it is
+        rebuilt from the :class:`~perspective.Table` when it is resumed,
+        which fires its callbacks once if it missed any updates.
+
+        Args:
+            priority (:obj:`str`): "visible", "background" or "paused".
+        '''
+        if priority not in _PRIORITIES:
+            raise ValueError(
+                'Invalid priority {} - valid priorities are "visible", "background", or "paused"'.format(priority))
+        self._table._state_manager.call_process(self._table._table.get_id())
+        refreshed = self._view.set_priority(
+            getattr(t_ctx_priority, "CTX_PRIORITY_" + priority.upper()))
+        self._priority = _PRIORITIES.index(priority)
+        if refreshed:
+            self._call_callbacks()
+
+    def set_update_interval(self, interval):
+        '''Limit this :class:`~perspective.View`'s :func:`on_update`
+        callbacks to firing at most once every `interval` seconds. The deltas
+        of every update in between are coalesced by the engine, so that a
+        "row" or "cell" callback is passed every change since it last fired,
+        and an update that arrives early fires the callbacks once the
+        interval has passed.
+
+        Outside of an event loop such as
+        :obj:`~perspective.PerspectiveTornadoHandler`'s, a notification that
+        is not yet due fires with the first update, or call on the
+        :class:`~perspective.Table` or its views, after it is.
+
+        Args:
+            interval (:obj:`float`): the minimum number of seconds between
+                notifications, or 0 for no limit.
+        '''
+        if interval < 0:
+            raise ValueError("update interval must be non-negative!")
+        self._view.set_notify_interval(int(interval * 1e6))
+        self._update_interval = interval
+
+    def get_update_interval(self):
+        '''Returns the interval set by :func:`set_update_interval`, in
+        seconds.'''
+        return self._update_interval
+
+    def freeze(self):
+        '''Freeze this :class:`~perspective.View`, e.g. a snapshot for a
+        report, so that it serves the data it held when frozen and costs
+        nothing when the :class:`~perspective.Table` is updated. Its
+        :func:`on_update` callbacks are not fired until it is thawed.
+        '''
+        self._table._state_manager.call_process(self._table._table.get_id())
+        self._view.freeze()
+        self._frozen = True
+
+    def thaw(self):
+        '''Thaw a :class:`~perspective.View` frozen by :func:`freeze`,
+        rebuilding it from the :class:`~perspective.Table` once if it missed
+        any updates, which fires its callbacks once.
+        '''
+        self._table._state_manager.call_process(self._table._table.get_id())
+        refreshed = self._view.thaw()
+        self._frozen = False
+        if refreshed:
+            self._call_callbacks()
+
+    def is_frozen(self):
+        '''Returns whether this :class:`~perspective.View` is frozen by
+        :func:`freeze`.'''
+        return self._frozen
+
+    def set_memory_budget(self, nbytes):
+        '''Let this :class:`~perspective.View` use up to ``nbytes``, as
+        reported by :func:`get_memory_usage`. Whenever an update leaves it
+        over budget, the state it can recompute on demand is released: the
+        aggregates of the rows under collapsed rows of a pivoted view, and
+        the cells of hidden row depths of a view with column pivots, which
+        are computed again when :func:`expand` or :func:`set_depth` reveals
+        them.
+
+        Args:
+            nbytes (:obj:`int`): the budget in bytes, or 0 or None for no
+                budget.
+        '''
+        if nbytes is not None and nbytes < 0:
+            raise PerspectiveError("Cannot set a negative memory budget")
+        self._table._state_manager.call_process(self._table._table.get_id())
+        self._view.set_memory_budget(int(nbytes or 0))
+
+    def get_memory_budget(self):
+        '''Returns the budget set by :func:`set_memory_budget`, or 0 if there
+        is none.'''
+        return self._view.get_memory_budget()
+
+    def reclaim_memory(self):
+        '''Release the state of this :class:`~perspective.View` which it can
+        recompute on demand now, as :func:`set_memory_budget` does once over
+        budget.
+
+        Returns:
+            :obj:`int`: the number of bytes released.
+        '''
+        self._table._state_manager.call_process(self._table._table.get_id())
+        return self._view.reclaim_memory()
+
+    def get_priority(self):
+        '''Returns the priority set by :func:`set_priority`.
+
+        Returns:
+            :obj:`str`: "visible", "background" or "paused".
+        '''
+        return _PRIORITIES[self._priority]
+
+    def get_progress(self):
+        '''Returns how much of a :class:`~perspective.View` created with
+        ``progressive=True`` has been built, which is 1 once it is built.
+
+        Returns:
+            :obj:`float`: the fraction of the rows of the
+                :class:`~perspective.Table` read into the view.
+        '''
+        return self._view.get_build_progress()
+
+    def wait(self, timeout=None):
+        '''Block until a :class:`~perspective.View` created with
+        ``progressive=True`` is built.
+
+        Args:
+            timeout (:obj:`float`): the number of seconds to wait, or `None`
+                to wait until it is built.
+        '''
+        if self._build_future is not None:
+            self._build_future.result(timeout=timeout)
+
+    def histogram(self, column, bins=10, quantile=False, row=0):
+        '''Bins the values of a numeric or datetime column of the
+        underlying :class:`~perspective.Table` that this
+        :class:`~perspective.View` aggregates.
+
+        Args:
+            column (:obj:`str`): the name of a column or computed column.
+
+        Keyword Args:
+            bins (:obj:`int`): the maximum number of bins to return.
+            quantile (:obj:`bool`): if True, bins hold an equal number of
+                values rather than spanning an equal width.
+            row (:obj:`int`): with ``row_pivots``, only bin the values under
+                this row of the pivot tree, which defaults to the total row.
+
+        Returns:
+            :obj:`list`: a :obj:`dict` for each bin, with its inclusive
+                ``begin`` and ``end`` and the ``count`` of values in it.
+        '''
+        if self._sides == 0:
+            return get_histogram_zero(self._view, column, bins, quantile, row)
+        elif self._sides == 1:
+            return get_histogram_one(self._view, column, bins, quantile, row)
+        else:
+            return get_histogram_two(self._view, column, bins, quantile, row)
+
+    def min_max(self, column, row=0):
+        '''Returns the smallest and largest valid values of a numeric or
+        datetime column of the underlying :class:`~perspective.Table`, at the
+        rows :meth:`histogram` would bin.
+
+        Args:
+            column (:obj:`str`): the name of a column or computed column.
+
+        Keyword Args:
+            row (:obj:`int`): with ``row_pivots``, only read the values under
+                this row of the pivot tree, which defaults to the total row.
+
+        Returns:
+            :obj:`dict`: the ``min`` and ``max`` of the values, both None if
+                no value is valid.
+        '''
+        if self._sides == 0:
+            return get_min_max_zero(self._view, column, row)
+        elif self._sides == 1:
+            return get_min_max_one(self._view, column, row)
+        else:
+            return get_min_max_two(self._view, column, row)
+
     def column_paths(self):
         '''Returns the names of the columns as they show in the
         :class:`~perspective.View`, i.e. the hierarchial columns when
@@ -229,6 +589,7 @@ class View(object):
 
         self._callbacks.add_callback({
             "name": self._name,
+            "view": self,
             "orig_callback": callback,
             "callback": wrapped_callback
         })
@@ -289,6 +650,9 @@ class View(object):
             >>> view = table.view()
             >>> view.delete()
         '''
+        self._deleted = True
+        for feed in self._feeds:
+            feed.detach()
         self._table._state_manager.remove_process(self._table._table.get_id())
         self._table._views.pop(self._table._views.index(self._name))
         # remove the callbacks associated with this view
@@ -320,14 +684,240 @@ class View(object):
             return ValueError("remove_delete callback should be a callable function!")
         self._delete_callbacks.remove_callbacks(lambda cb: cb != callback)
 
-    def to_arrow(self, **kwargs):
+    def to_arrow(self, compression=None, **kwargs):
+        '''Serialize the :class:`~perspective.View`'s dataset into an Apache
+        Arrow IPC stream.
+
+        Keyword Args:
+            compression (:obj:`str`): "lz4" or "zstd" to compress the whole
+                stream, which can then only be read by a
+                :class:`~perspective.Table`. Defaults to no compression.
+
+        Returns:
+            :obj:`bytes`: the Arrow.
+        '''
+        arrow = self.to_arrow_buffer(**kwargs).to_bytes()
+        if compression:
+            arrow = compress_arrow(arrow, compression)
+        return arrow
+
+    def to_arrow_buffer(self, **kwargs):
+        '''Serialize the :class:`~perspective.View`'s dataset into an Apache
+        Arrow IPC stream, as :func:`perspective.View.to_arrow()` does, but
+        without copying it into :obj:`bytes`.
+
+        The result owns the stream and exposes it through the buffer
+        protocol, so it can be read in place by `memoryview`,
+        `pyarrow.py_buffer` or `pyarrow.ipc.open_stream`, and the record
+        batches read from it share its memory.
+
+        Keyword Args:
+            start_row, end_row, start_col, end_col: as for
+                :func:`perspective.View.to_arrow()`.
+
+        Returns:
+            :obj:`t_arrow_buffer`: the Arrow, which `to_bytes()` copies into
+                :obj:`bytes`.
+
+        Examples:
+            >>> reader = pyarrow.ipc.open_stream(view.to_arrow_buffer())
+            >>> arrow_table = reader.read_all()
+        '''
+        options = _parse_format_options(self, kwargs)
+        args = (self._view, options["start_row"], options["end_row"], options["start_col"], options["end_col"])
+        if self._sides == 0:
+            return to_arrow_zero(*args)
+        elif self._sides == 1:
+            return to_arrow_one(*args)
+        else:
+            return to_arrow_two(*args)
+
+    def to_arrow_async(self, compression=None, **kwargs):
+        '''Serialize the :class:`~perspective.View` into an Apache Arrow on an
+        engine worker thread, taking the same arguments as
+        :func:`perspective.View.to_arrow()`. The engine does not hold the GIL
+        while it serializes, so other threads keep running.
+
+        Returns:
+            :obj:`concurrent.futures.Future`: resolves to the :obj:`bytes` of
+                the Arrow.
+        '''
+        return EXECUTOR.submit(self.to_arrow, compression=compression, **kwargs)
+
+    def to_parquet(self, row_group_size=65536, **kwargs):
+        """Serialize the :class:`~perspective.View`'s dataset into a Parquet
+        file, using the same column types as
+        :func:`perspective.View.to_arrow()`.
+
+        Args:
+            row_group_size (:obj:`int`): the maximum number of rows in each
+                row group of the file (Defaults to 65536).
+
+        Keyword Args:
+            start_row, end_row, start_col, end_col: as for
+            :func:`perspective.View.to_arrow()`.
+
+        Returns:
+            :obj:`bytes`: the Parquet file.
+
+        Examples:
+            >>> with open("out.parquet", "wb") as f:
+            ...     f.write(view.to_parquet())
+        """
+        if row_group_size <= 0:
+            raise ValueError("to_parquet row_group_size must be positive!")
+        self._table._state_manager.call_process(self._table._table.get_id())
+        options = _parse_format_options(self, kwargs)
+        args = (self._view, options["start_row"], options["end_row"], options["start_col"], options["end_col"], row_group_size)
+        if self._sides == 0:
+            return to_parquet_zero(*args)
+        elif self._sides == 1:
+            return to_parquet_one(*args)
+        else:
+            return to_parquet_two(*args)
+
+    def to_parquet_async(self, row_group_size=65536, **kwargs):
+        '''Serialize the :class:`~perspective.View` into a Parquet file on an
+        engine worker thread, taking the same arguments as
+        :func:`perspective.View.to_parquet()`.
+
+        Returns:
+            :obj:`concurrent.futures.Future`: resolves to the :obj:`bytes` of
+                the Parquet file.
+        '''
+        return EXECUTOR.submit(self.to_parquet, row_group_size=row_group_size, **kwargs)
+
+    def to_arrow_chunked(self, callback, chunk_size=65536, **kwargs):
+        """Serialize the :class:`~perspective.View`'s dataset into the Apache
+        Arrow format in chunks of at most `chunk_size` rows, calling
+        `callback` with each chunk as it is serialized rather than building
+        the entire range in memory at once.
+
+        Each chunk is a :obj:`bytes` containing a complete Arrow IPC stream
+        of one record batch, and at least one chunk is always emitted.
+
+        Args:
+            callback (:obj:`func`): called with the :obj:`bytes` of each
+                chunk, in row order.
+            chunk_size (:obj:`int`): the maximum number of rows in each
+                chunk (Defaults to 65536).
+
+        Keyword Args:
+            start_row, end_row, start_col, end_col: as for
+            :func:`perspective.View.to_arrow()`.
+
+        Examples:
+            Each chunk is a stream of its own, so to write one Arrow stream
+            read each chunk's batch and write it through a single writer:
+
+            >>> schema = pyarrow.ipc.open_stream(view.to_arrow(end_row=0)).schema
+            >>> with pyarrow.OSFile("out.arrow", "wb") as sink:
+            ...     writer = pyarrow.RecordBatchStreamWriter(sink, schema)
+            ...     view.to_arrow_chunked(lambda chunk: [
+            ...         writer.write_batch(batch) for batch in pyarrow.ipc.open_stream(chunk)])
+            ...     writer.close()
+        """
+        if not callable(callback):
+            raise ValueError("to_arrow_chunked callback should be a callable function!")
+        if chunk_size <= 0:
+            raise ValueError("to_arrow_chunked chunk_size must be positive!")
+        self._table._state_manager.call_process(self._table._table.get_id())
+        options = _parse_format_options(self, kwargs)
+        args = (self._view, options["start_row"], options["end_row"], options["start_col"], options["end_col"], chunk_size, callback)
+        if self._sides == 0:
+            to_arrow_chunked_zero(*args)
+        elif self._sides == 1:
+            to_arrow_chunked_one(*args)
+        else:
+            to_arrow_chunked_two(*args)
+
+    def open_cursor(self, snapshot=True, start_col=None, end_col=None):
+        """Open a cursor over the :class:`~perspective.View`'s rows, which
+        :func:`perspective.View.cursor_to_arrow()` pages through from the
+        first row, without resolving each page's offset from the start of
+        the view.
+
+        With `snapshot`, a flat view's cursor reads the rows as they were
+        when it was opened, however the view is updated after; updates
+        copy the table's columns the cursor holds until it is closed. A
+        pivoted view's snapshot cursor raises once the view is updated.
+        Without `snapshot`, each page reads the view's rows as they are
+        then, so updates may shift rows across pages.
+
+        Args:
+            snapshot (:obj:`bool`): whether pages are read from a snapshot
+                of the view (Defaults to ``True``).
+            start_col, end_col: as for :func:`perspective.View.to_arrow()`.
+
+        Returns:
+            :obj:`int`: the id of the cursor, which should be passed to
+                :func:`perspective.View.close_cursor()` once done.
+        """
+        self._table._state_manager.call_process(self._table._table.get_id())
+        kwargs = {}
+        if start_col is not None:
+            kwargs["start_col"] = start_col
+        if end_col is not None:
+            kwargs["end_col"] = end_col
         options = _parse_format_options(self, kwargs)
+        return self._view.open_cursor(options["start_col"], options["end_col"], snapshot)
+
+    def cursor_to_arrow(self, cursor_id, page_size=65536):
+        """Serialize the next `page_size` rows of a cursor opened by
+        :func:`perspective.View.open_cursor()` into an Apache Arrow IPC
+        stream, advancing the cursor.
+
+        Args:
+            cursor_id (:obj:`int`): the id of the cursor.
+            page_size (:obj:`int`): the maximum number of rows of the page
+                (Defaults to 65536).
+
+        Returns:
+            :obj:`bytes`: the Arrow, or ``None`` once the cursor has passed
+                the last row.
+        """
+        if page_size <= 0:
+            raise ValueError("cursor_to_arrow page_size must be positive!")
         if self._sides == 0:
-            return to_arrow_zero(self._view, options["start_row"], options["end_row"], options["start_col"], options["end_col"])
+            return cursor_to_arrow_zero(self._view, cursor_id, page_size)
         elif self._sides == 1:
-            return to_arrow_one(self._view, options["start_row"], options["end_row"], options["start_col"], options["end_col"])
+            return cursor_to_arrow_one(self._view, cursor_id, page_size)
         else:
-            return to_arrow_two(self._view, options["start_row"], options["end_row"], options["start_col"], options["end_col"])
+            return cursor_to_arrow_two(self._view, cursor_id, page_size)
+
+    def close_cursor(self, cursor_id):
+        """Close a cursor opened by :func:`perspective.View.open_cursor()`,
+        releasing its snapshot."""
+        self._view.close_cursor(cursor_id)
+
+    def arrow_pages(self, page_size=65536, snapshot=True, **kwargs):
+        """Iterate over the :class:`~perspective.View`'s rows as Arrows of
+        at most `page_size` rows each, through a cursor that is closed when
+        the iteration ends.
+
+        Args:
+            page_size (:obj:`int`): the maximum number of rows in each page
+                (Defaults to 65536).
+            snapshot (:obj:`bool`): as for
+                :func:`perspective.View.open_cursor()`.
+
+        Keyword Args:
+            start_col, end_col: as for :func:`perspective.View.to_arrow()`.
+
+        Examples:
+            >>> with open("out.arrow", "wb") as f:
+            ...     for page in view.arrow_pages():
+            ...         f.write(page)
+        """
+        cursor_id = self.open_cursor(snapshot=snapshot, **kwargs)
+        try:
+            while True:
+                page = self.cursor_to_arrow(cursor_id, page_size)
+                if page is None:
+                    return
+                yield page
+        finally:
+            self.close_cursor(cursor_id)
 
     def to_records(self, **kwargs):
         '''Serialize the :class:`~perspective.View`'s dataset into a :obj:`list`
@@ -462,6 +1052,38 @@ class View(object):
     def to_columns(self, **options):
         return self.to_dict(**options)
 
+    def to_table(self):
+        '''Create a :class:`~perspective.Table` holding the rows of this
+        :class:`~perspective.View`, which is kept up to date as its
+        :class:`~perspective.Table` is updated, so that its aggregates can be
+        pivoted and aggregated again, e.g. trades into orders into desks.
+
+        The :class:`~perspective.View` must have ``row_pivots`` and no
+        ``column_pivots``. The table has a row for each group of the
+        innermost pivot, with a column for each pivot and for each aggregate
+        not named like a pivot, and is indexed by the pivot, or by a
+        ``__ROW_PATH__`` column of the pivots' values joined by ``|`` if
+        there are several. Only the groups an update changes are sent to
+        the table, and the groups it empties are removed from it.
+
+        The :class:`~perspective.View` is fully aggregated from then on,
+        rather than only its expanded rows, and should stay "visible".
+
+        Returns:
+            :class:`~perspective.Table`: the table, which should not be
+                updated directly.
+        '''
+        if self._sides != 1:
+            raise PerspectiveError(
+                "Cannot create a Table from a View without row pivots, or with column pivots")
+        self.wait()
+        self._table._state_manager.call_process(self._table._table.get_id())
+        feed = t_view_feed(self._view)
+        self._feeds.append(feed)
+        row_pivots = self._config.get_row_pivots()
+        index = row_pivots[0] if len(row_pivots) == 1 else "__ROW_PATH__"
+        return self._table._derive(feed, index, [self._table])
+
     def _get_step_delta(self):
         pass
 
@@ -482,6 +1104,49 @@ class View(object):
                 hidden += 1
         return hidden
 
+    def _build(self):
+        '''Read the rows of the :class:`~perspective.Table` into a progressive
+        view a chunk at a time, calling its :func:`on_update` callbacks after
+        each so that they render the aggregates read so far.'''
+        done = False
+        while not done and not self._deleted:
+            done = self._view.build(_BUILD_CHUNK_ROWS)
+            if not self._deleted and self._priority != _PRIORITIES.index("paused"):
+                self._call_callbacks()
+
+    def _call_callbacks(self, port_id=0):
+        '''Call the :func:`on_update` callbacks of this view alone, as if it
+        were updated on `port_id`.'''
+        cache = {}
+        for callback in self._callbacks.get_callbacks():
+            if callback["name"] == self._name:
+                callback["callback"](port_id=port_id, cache=cache)
+
+    def _notify(self, port_id):
+        '''Notify the callbacks of a view with an update interval that it
+        was updated on `port_id`, now if a notification is due, or else once
+        it is.'''
+        self._notify_port_id = port_id
+        if self._notify_queued:
+            return
+        delay = self._view.get_notify_delay()
+        if delay > 0:
+            self._notify_queued = True
+            self._table._state_manager.queue_notify(self._flush_notify, delay / 1e6)
+        else:
+            self._flush_notify()
+
+    def _flush_notify(self):
+        self._notify_queued = False
+        if self._deleted:
+            return
+        if self._view.get_notify_delay() > 0:
+            # Queued by a `queue_notify` that runs it early.
+            self._notify(self._notify_port_id)
+            return
+        self._view.set_notified()
+        self._call_callbacks(self._notify_port_id)
+
     def _wrapped_on_update_callback(self, **kwargs):
         '''Provide the user-defined callback function with additional metadata
         from the view.
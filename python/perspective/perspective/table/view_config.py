@@ -105,7 +105,12 @@ class ViewConfig(object):
             0: `str` column name.
             1: a filter comparison string (i.e. "===", ">")
             2: a value to compare (this will be casted to match the type of
-                the column)
+                the column), or ``{"column": name}`` to compare to another
+                column of the same row, which fails rows where either is null.
+
+        A filter may also be a group of filters, ``{"and": [...]}`` or
+        ``{"or": [...]}``, which may be nested, e.g.
+        ``[{"or": [["bid", ">", {"column": "ask"}], ["halted", "==", True]]}]``.
 
         Returns:
             `list`: the filter configurations of the view stored in a `list` of
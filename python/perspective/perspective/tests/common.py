@@ -1,3 +1,7 @@
+import json
+import os
+import subprocess
+import sys
 import pandas as pd
 from random import random, randint, choice
 from faker import Faker
@@ -33,3 +37,24 @@ def superstore(count=50):
         dat['Profit'] = round(random() * 1000, 2)
         data.append(dat)
     return pd.DataFrame(data)
+
+
+def run_with_env(env, source, name="result"):
+    '''Run the python `source` in a new interpreter with the environment
+    variables `env` set, as the engine reads its `PSP_` settings once, and
+    return the JSON serializable value of its function `name`.
+    '''
+    full_env = dict(os.environ)
+    full_env.update(env)
+    source = source + "\nimport json\nprint(json.dumps({0}()))\n".format(name)
+    output = subprocess.check_output([sys.executable, "-c", source], env=full_env)
+    return json.loads(output.decode("utf-8").strip().splitlines()[-1])
+
+
+def run_in_process(source, name="result"):
+    '''Run the python `source` in this interpreter, and return the value of
+    its function `name` as `run_with_env` would.
+    '''
+    namespace = {}
+    exec(source, namespace)
+    return json.loads(json.dumps(namespace[name]()))
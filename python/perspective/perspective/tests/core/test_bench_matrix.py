@@ -0,0 +1,56 @@
+################################################################################
+#
+# Copyright (c) 2019, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+import os
+import sys
+
+BENCH_DIR = os.path.join(os.path.dirname(__file__), "..", "..", "..", "bench")
+sys.path.insert(0, os.path.abspath(BENCH_DIR))
+
+from perspective.table import Table  # noqa: E402
+
+ROWS = 200
+
+
+class TestBenchMatrix(object):
+
+    def test_matrix_inputs_load_the_same_rows(self):
+        from matrix import IngestionMatrix
+        suite = IngestionMatrix(ROWS)
+        expected = Table(suite.dict).view().to_dict()
+        for name in ("records", "arrow"):
+            assert Table(getattr(suite, name)).view().to_dict() == expected
+        for name in ("int64", "float64", "bool", "object_str"):
+            assert Table({name: suite.numpy[name]}).view().to_dict()[name] == expected[name]
+
+    def test_matrix_runs_with_metrics(self):
+        from bench import Runner
+        from matrix import IngestionMatrix, OUTPUT_FORMATS
+        suite = IngestionMatrix(ROWS)
+        runner = Runner(suite, memory=True)
+        iterations, Runner.ITERATIONS = Runner.ITERATIONS, 1
+        try:
+            results = [runner.run_method(benchmark) for benchmark in runner._benchmarks]
+        finally:
+            Runner.ITERATIONS = iterations
+
+        ids = set(runner._samples.keys())
+        for name in ("dict", "records", "numpy", "df", "arrow"):
+            assert "ingest/{}".format(name) in ids
+        for view_name in ("flat", "pivoted"):
+            for name in OUTPUT_FORMATS:
+                assert "serialize/{}/{}".format(view_name, name) in ids
+        assert "ingest_df/category" in ids
+
+        for result in results:
+            assert result["rows_per_sec"] > 0
+            assert result["peak_python_bytes"] >= 0
+            if "peak_engine_bytes" in result:
+                assert result["peak_engine_bytes"] >= 0
+        ingest = [r for r in results if r["group"] == "ingest" and r["name"] == "dict"][0]
+        assert ingest["rows"] == ROWS
@@ -0,0 +1,109 @@
+################################################################################
+#
+# Copyright (c) 2019, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+import os
+import sys
+
+BENCH_DIR = os.path.join(os.path.dirname(__file__), "..", "..", "..", "bench")
+sys.path.insert(0, os.path.abspath(BENCH_DIR))
+
+import report  # noqa: E402
+
+
+def result(median, stddev=0.0, samples=10):
+    return {"median": median, "stddev": stddev, "samples": samples}
+
+
+def statuses(rows):
+    return {row["id"]: row["status"] for row in rows}
+
+
+class TestBenchReport(object):
+
+    def test_stats(self):
+        stats = report.stats([4.0, 1.0, 3.0, 2.0, 5.0])
+        assert stats == {
+            "samples": 5,
+            "mean": 3.0,
+            "median": 3.0,
+            "stddev": round(2.5 ** 0.5, 3),
+            "min": 1.0,
+            "max": 5.0,
+            "p95": 4.8
+        }
+        assert report.stats([2.0])["stddev"] == 0
+
+    def test_summarize_skips_empty(self):
+        summary = report.summarize({"a/x": [1.0, 2.0], "a/y": []}, version="v")
+        assert summary["format"] == report.FORMAT_VERSION
+        assert summary["version"] == "v"
+        assert list(summary["results"].keys()) == ["a/x"]
+
+    def test_compare_statuses(self):
+        baseline = {"results": {
+            "slower": result(10.0), "faster": result(10.0), "same": result(10.0),
+            "removed": result(10.0)
+        }}
+        current = {"results": {
+            "slower": result(12.0), "faster": result(8.0), "same": result(10.5),
+            "added": result(1.0)
+        }}
+        assert statuses(report.compare(baseline, current)) == {
+            "added": "added",
+            "faster": "improvement",
+            "removed": "removed",
+            "same": "unchanged",
+            "slower": "regression"
+        }
+        assert [row["id"] for row in report.compare(baseline, current)] == \
+            ["added", "faster", "removed", "same", "slower"]
+
+    def test_compare_threshold(self):
+        baseline = {"results": {"a": result(10.0)}}
+        current = {"results": {"a": result(12.0)}}
+        assert statuses(report.compare(baseline, current, 0.1))["a"] == "regression"
+        assert statuses(report.compare(baseline, current, 0.25))["a"] == "unchanged"
+
+    def test_compare_noisy_change_is_unchanged(self):
+        baseline = {"results": {"a": result(10.0, stddev=5.0, samples=4)}}
+        current = {"results": {"a": result(14.0, stddev=5.0, samples=4)}}
+        assert statuses(report.compare(baseline, current))["a"] == "unchanged"
+
+    def test_write_read_round_trip(self, tmpdir):
+        path = str(tmpdir.join("report.json"))
+        summary = report.summarize({"a/x": [1.0, 2.0, 3.0]}, version="v")
+        report.write_report(summary, path)
+        assert report.read_report(path) == summary
+        rows = report.compare(summary, report.read_report(path))
+        assert statuses(rows) == {"a/x": "unchanged"}
+
+
+class TestBenchScenarios(object):
+
+    def test_scenarios_run_and_report(self, tmpdir):
+        from bench import Runner
+        from scenarios import ScenarioBenchmark
+        suite = ScenarioBenchmark()
+        runner = Runner(suite)
+        iterations, Runner.ITERATIONS = Runner.ITERATIONS, 1
+        try:
+            for benchmark in runner._benchmarks:
+                runner.run_method(benchmark)
+        finally:
+            Runner.ITERATIONS = iterations
+
+        ids = set(runner._samples.keys())
+        assert len(ids) == len(runner._benchmarks)
+        groups = set(id.split("/")[0] for id in ids)
+        assert groups >= {"ingest", "update", "fan_out", "pivot", "sort", "filter",
+                          "computed", "serialize"}
+
+        path = str(tmpdir.join("scenarios.json"))
+        written = runner.write_json(path, "test")
+        assert set(written["results"].keys()) == ids
+        assert runner.compare(path, "test") == 0
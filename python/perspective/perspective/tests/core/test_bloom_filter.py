@@ -0,0 +1,55 @@
+################################################################################
+#
+# Copyright (c) 2019, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+import random
+from perspective.table.libbinding import t_bloom_filter
+
+NKEYS = 20000
+
+
+def make_filter(keys, nkeys=NKEYS):
+    bloom = t_bloom_filter()
+    bloom.reset(nkeys)
+    for key in keys:
+        bloom.insert(key)
+    return bloom
+
+
+class TestBloomFilter(object):
+
+    def test_bloom_filter_empty(self):
+        bloom = t_bloom_filter()
+        assert bloom.empty()
+        assert bloom.nbytes() == 0
+        bloom.reset(100)
+        assert not bloom.empty()
+        assert bloom.nbytes() % 64 == 0
+        assert not bloom.may_contain(1)
+        bloom.clear()
+        assert bloom.empty()
+
+    def test_bloom_filter_no_false_negatives(self):
+        rng = random.Random(7)
+        keys = [rng.getrandbits(64) for _ in range(NKEYS)] + list(range(NKEYS))
+        bloom = make_filter(keys, 2 * NKEYS)
+        for key in keys:
+            assert bloom.may_contain(key)
+
+    def test_bloom_filter_false_positive_rate(self):
+        bloom = make_filter(range(NKEYS))
+        false_positives = sum(bloom.may_contain(key) for key in range(NKEYS, 11 * NKEYS))
+        assert false_positives < 0.05 * 10 * NKEYS
+
+    def test_bloom_filter_about_10_bits_per_key(self):
+        bloom = make_filter([], NKEYS)
+        assert NKEYS * 10 / 8 <= bloom.nbytes() <= NKEYS * 10 / 8 * 2 + 64
+
+    def test_bloom_filter_reset_forgets_keys(self):
+        bloom = make_filter(range(1000), 1000)
+        bloom.reset(1000)
+        assert sum(bloom.may_contain(key) for key in range(1000)) == 0
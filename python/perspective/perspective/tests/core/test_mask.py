@@ -0,0 +1,126 @@
+################################################################################
+#
+# Copyright (c) 2019, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+import random
+from perspective.table.libbinding import t_mask
+
+CHUNK = 1 << 16
+ARRAY_MAX = 4096
+SIZE = 3 * CHUNK + 123
+
+
+def make_mask(indices, size=SIZE):
+    mask = t_mask(size)
+    for idx in indices:
+        mask.set(idx, True)
+    return mask
+
+
+def to_list(mask):
+    rval = []
+    idx = mask.find_first()
+    while idx != t_mask.npos:
+        rval.append(idx)
+        idx = mask.find_next(idx)
+    return rval
+
+
+def random_indices(seed, count, size=SIZE):
+    rng = random.Random(seed)
+    return set(rng.sample(range(size), count))
+
+
+class TestMask(object):
+
+    def check(self, mask, expected):
+        expected = sorted(expected)
+        assert mask.count() == len(expected)
+        assert to_list(mask) == expected
+        for idx in expected[:100]:
+            assert mask.get(idx)
+
+    def test_mask_set_get_count(self):
+        indices = {0, 1, 63, 64, CHUNK - 1, CHUNK, 2 * CHUNK + 5, SIZE - 1}
+        mask = make_mask(indices)
+        assert mask.size() == SIZE
+        self.check(mask, indices)
+        assert not mask.get(2)
+        mask.set(63, False)
+        self.check(mask, indices - {63})
+
+    def test_mask_empty(self):
+        mask = t_mask(SIZE)
+        assert mask.count() == 0
+        assert mask.find_first() == t_mask.npos
+        assert t_mask(0).find_first() == t_mask.npos
+
+    def test_mask_find_next_crosses_chunks(self):
+        mask = make_mask([5, 3 * CHUNK + 1])
+        assert mask.find_first() == 5
+        assert mask.find_next(5) == 3 * CHUNK + 1
+        assert mask.find_next(3 * CHUNK + 1) == t_mask.npos
+
+    def test_mask_find_next_in_bitmap_words(self):
+        indices = set(range(CHUNK, CHUNK + ARRAY_MAX + 1)) | {CHUNK + 1000 * 64 + 63}
+        mask = make_mask(indices)
+        assert mask.num_bitmap_chunks() == 1
+        self.check(mask, indices)
+        assert mask.find_next(CHUNK + ARRAY_MAX) == CHUNK + 1000 * 64 + 63
+
+    def test_mask_array_becomes_bitmap(self):
+        mask = make_mask(range(ARRAY_MAX))
+        assert mask.num_bitmap_chunks() == 0
+        mask.set(ARRAY_MAX, True)
+        assert mask.num_bitmap_chunks() == 1
+        self.check(mask, range(ARRAY_MAX + 1))
+
+    def test_mask_and_normalizes_to_array(self):
+        a = make_mask(range(2 * ARRAY_MAX))
+        b = make_mask(range(ARRAY_MAX, 3 * ARRAY_MAX))
+        assert a.num_bitmap_chunks() == 1 and b.num_bitmap_chunks() == 1
+        a &= b
+        assert a.num_bitmap_chunks() == 0
+        self.check(a, range(ARRAY_MAX, 2 * ARRAY_MAX))
+
+    def test_mask_or_promotes_to_bitmap(self):
+        a = make_mask(range(0, 2 * ARRAY_MAX, 2))
+        b = make_mask(range(1, 2 * ARRAY_MAX, 2))
+        assert a.num_bitmap_chunks() == 0 and b.num_bitmap_chunks() == 0
+        a |= b
+        assert a.num_bitmap_chunks() == 1
+        self.check(a, range(2 * ARRAY_MAX))
+
+    def test_mask_xor_promotes_and_normalizes(self):
+        a = make_mask(range(0, 2 * ARRAY_MAX, 2))
+        b = make_mask(range(1, 2 * ARRAY_MAX, 2))
+        a ^= b
+        assert a.num_bitmap_chunks() == 1
+        self.check(a, range(2 * ARRAY_MAX))
+        a ^= make_mask(range(ARRAY_MAX, 2 * ARRAY_MAX))
+        assert a.num_bitmap_chunks() == 0
+        self.check(a, range(ARRAY_MAX))
+
+    def test_mask_andnot_normalizes_to_array(self):
+        a = make_mask(range(2 * ARRAY_MAX))
+        a -= make_mask(range(ARRAY_MAX, 2 * ARRAY_MAX, 2))
+        assert a.num_bitmap_chunks() == 1
+        self.check(a, set(range(2 * ARRAY_MAX)) - set(range(ARRAY_MAX, 2 * ARRAY_MAX, 2)))
+        a -= make_mask(range(ARRAY_MAX, 2 * ARRAY_MAX))
+        assert a.num_bitmap_chunks() == 0
+        self.check(a, range(ARRAY_MAX))
+
+    def test_mask_operators_match_sets(self):
+        for seed in range(4):
+            for count_a, count_b in ((100, 100), (20000, 300), (300, 20000), (40000, 40000)):
+                xs = random_indices(seed, count_a)
+                ys = random_indices(seed + 100, count_b)
+                for op, expected in (("__iand__", xs & ys), ("__ior__", xs | ys),
+                                     ("__ixor__", xs ^ ys), ("__isub__", xs - ys)):
+                    a = make_mask(xs)
+                    a = getattr(a, op)(make_mask(ys))
+                    self.check(a, expected)
@@ -0,0 +1,113 @@
+################################################################################
+#
+# Copyright (c) 2019, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+import socket
+import threading
+import pyarrow as pa
+from pytest import importorskip, fixture, raises
+from perspective import Table, PerspectiveManager
+
+flight = importorskip("pyarrow.flight")
+
+from perspective.flight_server import PerspectiveFlightServer  # noqa: E402
+
+data = {"a": [1, 2, 3, 4, 5], "b": ["a", "b", "c", "d", "e"]}
+
+
+def free_port():
+    sock = socket.socket()
+    sock.bind(("localhost", 0))
+    port = sock.getsockname()[1]
+    sock.close()
+    return port
+
+
+@fixture
+def client_for():
+    servers = []
+
+    def start(manager, **kwargs):
+        location = "grpc://localhost:{0}".format(free_port())
+        server = PerspectiveFlightServer(manager, location, **kwargs)
+        thread = threading.Thread(target=server.serve)
+        thread.daemon = True
+        thread.start()
+        servers.append(server)
+        return flight.FlightClient(location)
+
+    yield start
+
+    for server in servers:
+        server.shutdown()
+
+
+def read_flight(client, name):
+    info = client.get_flight_info(flight.FlightDescriptor.for_path(name))
+    tables = [client.do_get(endpoint.ticket).read_all() for endpoint in info.endpoints]
+    return info, pa.concat_tables(tables)
+
+
+class TestPerspectiveFlightServer(object):
+
+    def test_flight_get_table(self, client_for):
+        manager = PerspectiveManager()
+        manager.host_table("table1", Table(data))
+        client = client_for(manager)
+        info, arrow_table = read_flight(client, "table1")
+        assert info.total_records == 5
+        assert Table(arrow_table.to_pydict()).view().to_dict() == data
+
+    def test_flight_get_view_parallel_endpoints(self, client_for):
+        manager = PerspectiveManager()
+        table = Table(data)
+        manager.host_table("table1", table)
+        manager.host_view("view1", table.view(columns=["a"]))
+        client = client_for(manager, parallelism=2, min_rows_per_stream=2)
+        info, arrow_table = read_flight(client, "view1")
+        assert len(info.endpoints) == 2
+        assert arrow_table.to_pydict() == {"a": [1, 2, 3, 4, 5]}
+
+    def test_flight_list_flights(self, client_for):
+        manager = PerspectiveManager()
+        table = Table(data)
+        manager.host_table("table1", table)
+        manager.host_view("view1", table.view())
+        client = client_for(manager)
+        flights = list(client.list_flights())
+        assert sorted(info.descriptor.path[0] for info in flights) == [b"table1", b"view1"]
+
+    def test_flight_put_updates_table(self, client_for):
+        manager = PerspectiveManager()
+        table = Table(data)
+        manager.host_table("table1", table)
+        client = client_for(manager)
+        update = pa.Table.from_pydict({"a": [6], "b": ["f"]})
+        writer, _ = client.do_put(flight.FlightDescriptor.for_path("table1"), update.schema)
+        writer.write_table(update)
+        writer.close()
+        assert table.size() == 6
+
+    def test_flight_put_hosts_new_table(self, client_for):
+        manager = PerspectiveManager()
+        client = client_for(manager)
+        upload = pa.Table.from_pydict({"a": [1, 2]})
+        writer, _ = client.do_put(flight.FlightDescriptor.for_path("table2"), upload.schema)
+        writer.write_table(upload)
+        writer.close()
+        assert manager.get_table("table2").view().to_dict() == {"a": [1, 2]}
+
+    def test_flight_put_locked(self, client_for):
+        manager = PerspectiveManager(lock=True)
+        manager.host_table("table1", Table(data))
+        client = client_for(manager)
+        upload = pa.Table.from_pydict({"a": [6], "b": ["f"]})
+        with raises(Exception):
+            writer, _ = client.do_put(flight.FlightDescriptor.for_path("table1"), upload.schema)
+            writer.write_table(upload)
+            writer.close()
+        assert manager.get_table("table1").size() == 5
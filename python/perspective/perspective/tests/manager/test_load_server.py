@@ -0,0 +1,46 @@
+################################################################################
+#
+# Copyright (c) 2019, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+import argparse
+import json
+import os
+import sys
+from tornado.testing import AsyncHTTPTestCase
+
+BENCH_DIR = os.path.join(os.path.dirname(__file__), "..", "..", "..", "bench")
+sys.path.insert(0, os.path.abspath(BENCH_DIR))
+
+import load_server  # noqa: E402
+
+ROWS = 100
+
+
+class TestLoadServer(AsyncHTTPTestCase):
+
+    def get_app(self):
+        args = argparse.Namespace(rows=ROWS, threaded=False, max_pending_rows=None,
+                                  max_pending_messages=None)
+        return load_server.make_app(args)
+
+    def test_load_server_make_rows(self):
+        rows = load_server.make_rows(ROWS, seed=1)
+        assert rows["id"] == list(range(ROWS))
+        assert set(rows["group"]) <= set(load_server.GROUPS)
+        assert set(rows["side"]) <= set(load_server.SIDES)
+        assert rows == load_server.make_rows(ROWS, seed=1)
+
+    def test_load_server_stats(self):
+        response = self.fetch("/stats")
+        assert response.code == 200
+        assert response.headers["Content-Type"] == "application/json"
+        stats = json.loads(response.body.decode("utf-8"))
+        assert stats["table_size"] == ROWS
+        assert stats["cpu_user_s"] >= 0
+        assert stats["cpu_system_s"] >= 0
+        assert stats["wall_s"] >= 0
+        assert isinstance(stats["latency"], dict)
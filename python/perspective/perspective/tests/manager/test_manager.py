@@ -7,11 +7,15 @@
 #
 
 import json
+import threading
+import time
 import numpy as np
 import pyarrow as pa
 from functools import partial
-from pytest import raises
-from perspective import Table, PerspectiveError, PerspectiveManager
+from pytest import mark, raises
+from perspective import Table, PerspectiveError, PerspectiveManager, read_shared_memory
+from perspective.manager._shared_memory import _PerspectiveSharedMemoryRing, is_shared_memory_available
+from perspective.manager import _binary_protocol
 
 data = {"a": [1, 2, 3], "b": ["a", "b", "c"]}
 
@@ -169,6 +173,44 @@ class TestPerspectiveManager(object):
         manager._process(message, self.post)
         assert manager._views["view1"].num_rows() == 3
 
+    def test_manager_create_view_over_budget_rejected(self):
+        message = {"id": 1, "table_name": "table1", "view_name": "view1", "cmd": "view", "config": {"row_pivots": ["a"]}}
+        manager = PerspectiveManager(view_budget=1)
+        table = Table(data)
+        manager.host_table("table1", table)
+        posted = []
+        manager._process(message, lambda msg: posted.append(json.loads(msg)))
+        assert "view1" not in manager._views
+        assert "above the budget" in posted[0]["error"]
+
+    def test_manager_create_view_over_budget_downgraded(self):
+        message = {"id": 1, "table_name": "table1", "view_name": "view1", "cmd": "view", "config": {"row_pivots": ["a"]}}
+        manager = PerspectiveManager(view_budget=1, view_admission="downgrade")
+        table = Table(data)
+        manager.host_table("table1", table)
+        manager._process(message, self.post)
+        view = manager._views["view1"]
+        view.wait()
+        assert view.to_dict() == {
+            "__ROW_PATH__": [[], ["1"], ["2"], ["3"]],
+            "a": [6, 1, 2, 3],
+            "b": [3, 1, 1, 1]
+        }
+
+    def test_manager_create_view_over_budget_queued(self):
+        message = {"id": 1, "table_name": "table1", "view_name": "view1", "cmd": "view", "config": {"row_pivots": ["a"]}}
+        manager = PerspectiveManager(view_budget=1, view_admission="queue")
+        table = Table(data)
+        manager.host_table("table1", table)
+        manager._process(message, self.post)
+        view = manager._views["view1"]
+        view.wait()
+        assert view.num_rows() == 4
+
+    def test_manager_invalid_view_admission(self):
+        with raises(PerspectiveError):
+            PerspectiveManager(view_budget=1, view_admission="drop")
+
     def test_manager_create_view_one(self):
         message = {"id": 1, "table_name": "table1", "view_name": "view1", "cmd": "view", "config": {"row_pivots": ["a"]}}
         manager = PerspectiveManager()
@@ -197,6 +239,208 @@ class TestPerspectiveManager(object):
             "c|b": [1, None, None, 1]
         }
 
+    def test_manager_negotiates_arrow_compression(self):
+        manager = PerspectiveManager()
+        table = Table(data)
+        view = table.view()
+        manager.host_table("table1", table)
+        manager.host_view("view1", view)
+        session = manager.new_session()
+        posted = []
+
+        def post(msg, binary=False):
+            posted.append(msg if binary else json.loads(msg))
+
+        session.process({"id": 1, "cmd": "init", "compression": ["brotli", "zstd"]}, post)
+        assert posted[0]["data"] == {"compression": "zstd"}
+
+        session.process({"id": 2, "name": "view1", "cmd": "view_method", "method": "to_arrow", "args": []}, post)
+        assert posted[1]["compression"] == "zstd"
+        assert posted[2][:4] == b"PSPZ"
+        assert Table(posted[2]).view().to_dict() == data
+
+        session.close()
+        assert session.client_id not in manager._client_compression
+
+    def test_manager_without_arrow_compression(self):
+        manager = PerspectiveManager()
+        manager.host_view("view1", Table(data).view())
+        posted = []
+
+        def post(msg, binary=False):
+            posted.append(msg if binary else json.loads(msg))
+
+        manager._process({"id": 1, "cmd": "init"}, post)
+        assert posted[0]["data"] is None
+        manager._process({"id": 2, "name": "view1", "cmd": "view_method", "method": "to_arrow", "args": []}, post)
+        assert "compression" not in posted[1]
+        assert Table(posted[2]).view().to_dict() == data
+
+    def test_manager_binary_protocol(self):
+        manager = PerspectiveManager()
+        table = Table(data, index="a")
+        manager.host_table("table1", table)
+        manager.host_view("view1", table.view())
+        session = manager.new_session()
+        posted = []
+
+        def post(msg, binary=False):
+            posted.append(_binary_protocol.decode(msg) if binary else json.loads(msg))
+
+        session.process({"id": 1, "cmd": "init", "protocol": ["binary"]}, post)
+        assert posted[0]["data"] == {"protocol": "binary"}
+
+        session.process(_binary_protocol.encode(
+            {"id": 2, "name": "view1", "cmd": "view_method", "method": "to_dict", "args": []}), post)
+        assert posted[1] == {"id": 2, "data": data}
+
+        session.process(_binary_protocol.encode(
+            {"id": 3, "name": "view1", "cmd": "view_method", "method": "to_arrow", "args": []}), post)
+        assert len(posted) == 3
+        assert Table(posted[2]["data"]).view().to_dict() == data
+
+        arrow = Table({"a": [1], "b": ["x"]}).view().to_arrow()
+        session.process(_binary_protocol.encode(
+            {"id": 4, "name": "table1", "cmd": "table_method", "method": "update", "args": [arrow]}), post)
+        assert table.view().to_dict() == {"a": [1, 2, 3], "b": ["x", "b", "c"]}
+
+        session.close()
+        assert session.client_id not in manager._binary_clients
+
+    def test_manager_coalesce_frames(self):
+        from perspective.tornado_handler.tornado_handler import _coalesce_frames
+        frames = _coalesce_frames([
+            ('{"id": 1}', False),
+            ('{"id": 2, "is_transferable": true}', False),
+            (b"arrow", True),
+            ('{"id": 3}', False)
+        ], False)
+        assert [(json.loads(frame) if not binary else frame, count) for frame, binary, count in frames] == [
+            ([{"id": 1}, {"id": 2, "is_transferable": True}], 2),
+            (b"arrow", 1),
+            ({"id": 3}, 1)
+        ]
+
+        messages = [_binary_protocol.encode({"id": i}) for i in range(20)]
+        frames = _coalesce_frames([(message, True) for message in messages], True)
+        assert len(frames) == 1
+        assert _binary_protocol.decode(frames[0][0]) == [{"id": i} for i in range(20)]
+        assert frames[0][2] == 20
+
+    def test_manager_batch(self):
+        manager = PerspectiveManager()
+        table = Table(data)
+        manager.host_table("table1", table)
+        manager.host_view("view1", table.view())
+        posted = []
+
+        def post(msg, binary=False):
+            posted.append(msg if binary else json.loads(msg))
+
+        manager._process({"id": 1, "cmd": "batch", "calls": [
+            {"cmd": "view_method", "name": "view1", "method": "num_rows", "args": []},
+            {"cmd": "view_method", "name": "view1", "method": "to_arrow", "args": []},
+            {"cmd": "view_method", "name": "view2", "method": "num_rows", "args": []},
+            {"cmd": "table_method", "name": "table1", "method": "schema", "args": []},
+            {"cmd": "view_method", "name": "view1", "method": "to_arrow", "args": [{"end_row": 1}]}
+        ]}, post)
+        assert len(posted) == 2
+        message, binary = posted
+        assert message["batch"] is True
+        assert message["is_transferable"] is True
+        results = message["data"]
+        assert results[0] == {"data": 3}
+        assert results[2] == {"error": "View is not initialized"}
+        assert results[3] == {"data": {"a": "integer", "b": "string"}}
+        start, length = results[1]["binary"]
+        assert Table(binary[start:start + length]).view().to_dict() == data
+        start, length = results[4]["binary"]
+        assert Table(binary[start:start + length]).view().to_dict() == {"a": [1], "b": ["a"]}
+
+    def test_manager_batch_binary_protocol(self):
+        manager = PerspectiveManager()
+        table = Table(data)
+        manager.host_table("table1", table)
+        manager.host_view("view1", table.view())
+        session = manager.new_session()
+        posted = []
+
+        def post(msg, binary=False):
+            posted.append(_binary_protocol.decode(msg) if binary else json.loads(msg))
+
+        session.process({"id": 1, "cmd": "init", "protocol": ["binary"]}, post)
+        session.process({"id": 2, "cmd": "batch", "calls": [
+            {"cmd": "view_method", "name": "view1", "method": "num_rows", "args": []},
+            {"cmd": "view_method", "name": "view1", "method": "to_arrow", "args": []}
+        ]}, post)
+        assert len(posted) == 2
+        results = posted[1]["data"]
+        assert results[0] == {"data": 3}
+        assert Table(results[1]["data"]).view().to_dict() == data
+
+    def test_manager_binary_protocol_values(self):
+        value = {"a": [0, -1, 300, -70000, 2 ** 40, 2 ** 64 - 1, 1.5, None, True, False],
+                 "b": "x" * 300, "c": b"\x00" * 70000, "d": {str(i): i for i in range(20)}}
+        assert _binary_protocol.decode(_binary_protocol.encode(value)) == value
+
+    @mark.skipif(not is_shared_memory_available(), reason="requires Python 3.8")
+    def test_manager_shared_memory(self):
+        manager = PerspectiveManager(shared_memory_size=1024 * 1024)
+        table = Table(data, index="a")
+        view = table.view()
+        manager.host_table("table1", table)
+        manager.host_view("view1", view)
+        session = manager.new_session()
+        posted = []
+
+        def post(msg, binary=False):
+            posted.append(msg if binary else json.loads(msg))
+
+        session.process({"id": 1, "cmd": "init", "shared_memory": True}, post)
+        assert posted[0]["data"]["shared_memory"] == manager._client_shared_memory[session.client_id].name
+
+        session.process({"id": 2, "name": "view1", "cmd": "view_method", "method": "to_arrow", "args": []}, post)
+        assert len(posted) == 2
+        assert "is_transferable" not in posted[1]
+        assert Table(read_shared_memory(posted[1]["shared_memory"])).view().to_dict() == data
+
+        session.process({"id": 3, "name": "view1", "cmd": "view_method", "method": "on_update",
+                         "subscribe": True, "args": [{"mode": "row"}], "callback_id": "c1"}, post)
+        table.update({"a": [1], "b": ["x"]})
+        assert len(posted) == 3
+        assert Table(read_shared_memory(posted[2]["shared_memory"])).view().to_dict() == {"a": [1], "b": ["x"]}
+
+        session.close()
+        assert session.client_id not in manager._client_shared_memory
+
+    @mark.skipif(not is_shared_memory_available(), reason="requires Python 3.8")
+    def test_manager_shared_memory_overwritten(self):
+        arrow = Table(data).view().to_arrow()
+        ring = _PerspectiveSharedMemoryRing(len(arrow) * 2 + 8)
+        first = ring.write(arrow)
+        assert read_shared_memory(first) == arrow
+        ring.write(arrow)
+        ring.write(arrow)
+        with raises(PerspectiveError):
+            read_shared_memory(first)
+        assert ring.write(arrow * 3) is None
+        ring.close()
+
+    def test_manager_without_shared_memory(self):
+        manager = PerspectiveManager()
+        manager.host_view("view1", Table(data).view())
+        session = manager.new_session()
+        posted = []
+
+        def post(msg, binary=False):
+            posted.append(msg if binary else json.loads(msg))
+
+        session.process({"id": 1, "cmd": "init", "shared_memory": True}, post)
+        assert posted[0]["data"] is None
+        session.process({"id": 2, "name": "view1", "cmd": "view_method", "method": "to_arrow", "args": []}, post)
+        assert posted[1]["is_transferable"] is True
+        assert Table(posted[2]).view().to_dict() == data
+
     # clear views
 
     def test_manager_clear_view(self):
@@ -230,6 +474,53 @@ class TestPerspectiveManager(object):
         assert "view3" not in manager._views
         assert "view2" in manager._views
 
+    # shared views
+
+    def test_manager_shares_identical_view_configs(self):
+        manager = PerspectiveManager()
+        table = Table(data)
+        manager.host_table("table1", table)
+        config = {"row_pivots": ["b"], "filter": [["a", ">", 1]]}
+        for i, name in enumerate(["view1", "view2"], 1):
+            manager._process({"id": i, "table_name": "table1", "view_name": name,
+                              "cmd": "view", "config": config}, self.post, client_id=i)
+        manager._process({"id": 3, "table_name": "table1", "view_name": "view3",
+                          "cmd": "view", "config": {"row_pivots": ["a"]}}, self.post, client_id=1)
+        assert manager._views["view1"] is manager._views["view2"]
+        assert manager._views["view3"] is not manager._views["view1"]
+
+        shared = manager._views["view1"]
+        manager._process({"id": 4, "name": "view1", "cmd": "view_method", "method": "delete"},
+                         self.post, client_id=1)
+        assert "view1" not in manager._views
+        assert shared.num_rows() == 3
+        manager.clear_views(2)
+        assert "view2" not in manager._views
+        assert shared._deleted is True
+
+    def test_manager_expand_makes_shared_view_private(self):
+        manager = PerspectiveManager()
+        table = Table(data)
+        manager.host_table("table1", table)
+        config = {"row_pivots": ["b", "a"]}
+        for i, name in enumerate(["view1", "view2"], 1):
+            manager._process({"id": i, "table_name": "table1", "view_name": name,
+                              "cmd": "view", "config": config}, self.post, client_id=i)
+        manager._process({"id": 3, "name": "view1", "cmd": "view_method",
+                          "method": "collapse", "args": [0]}, self.post, client_id=1)
+        assert manager._views["view1"] is not manager._views["view2"]
+        assert manager._views["view1"].num_rows() == 1
+        assert manager._views["view2"].num_rows() == 7
+
+    def test_manager_share_views_disabled(self):
+        manager = PerspectiveManager(share_views=False)
+        table = Table(data)
+        manager.host_table("table1", table)
+        for i, name in enumerate(["view1", "view2"], 1):
+            manager._process({"id": i, "table_name": "table1", "view_name": name,
+                              "cmd": "view"}, self.post, client_id=i)
+        assert manager._views["view1"] is not manager._views["view2"]
+
     def test_manager_clear_view_no_client_id(self):
         messages = [
             {"id": 1, "table_name": "table1", "view_name": "view1", "cmd": "view"},
@@ -591,3 +882,146 @@ class TestPerspectiveManager(object):
         }
         assert s.get() == 0
         assert s2.get() == 1
+
+    def test_manager_get_memory_usage(self):
+        manager = PerspectiveManager()
+        table = Table(data)
+        view = table.view(row_pivots=["b"])
+        manager.host_table("table1", table)
+        manager.host_view("view1", view)
+        usage = manager.get_memory_usage()
+        assert usage["tables"]["table1"] == table.get_memory_usage()
+        assert usage["views"]["view1"] == view.get_memory_usage()
+
+    def test_manager_get_profile(self):
+        manager = PerspectiveManager(lock=True)
+        posted = []
+        manager._process({"id": 1, "cmd": "get_profile"}, lambda msg: posted.append(json.loads(msg)))
+        assert posted[0]["id"] == 1
+        assert set(posted[0]["data"].keys()) == set(["ticks", "interval_us", "phases"])
+        assert set(manager.get_profile().keys()) == set(["ticks", "interval_us", "phases"])
+
+    def test_manager_threaded_to_arrow(self):
+        manager = PerspectiveManager(threaded=True)
+        manager.host_view("view1", Table(data).view())
+        posted = []
+        done = threading.Event()
+
+        def post(msg, binary=False):
+            posted.append(msg if binary else json.loads(msg))
+            if binary:
+                done.set()
+
+        manager._process({"id": 1, "name": "view1", "cmd": "view_method", "method": "to_arrow", "args": []}, post)
+        assert done.wait(10)
+        assert posted[0]["id"] == 1
+        assert Table(posted[1]).view().to_dict() == data
+
+    def test_manager_threaded_loop_callback(self):
+        manager = PerspectiveManager(threaded=True)
+        manager.host_view("view1", Table(data).view())
+        scheduled = []
+        manager._set_loop_callback(scheduled.append)
+        posted = []
+
+        def post(msg, binary=False):
+            posted.append(msg if binary else json.loads(msg))
+
+        manager._process({"id": 1, "name": "view1", "cmd": "view_method", "method": "to_parquet", "args": []}, post)
+        deadline = time.time() + 10
+        while not scheduled and time.time() < deadline:
+            time.sleep(0.01)
+
+        # both messages are posted by the one function handed to the loop
+        assert posted == []
+        assert len(scheduled) == 1
+        scheduled[0]()
+        assert posted[0]["id"] == 1
+        assert Table(posted[1]).view().to_dict() == data
+
+    def test_manager_max_pending_rows(self):
+        manager = PerspectiveManager(max_pending_rows=4)
+        table = Table(data)
+        manager.host_table("table1", table)
+        manager._set_queue_process(lambda table_id, state_manager: None)
+        pool = table._table.get_pool()
+
+        update = {"id": 1, "name": "table1", "cmd": "table_method", "method": "update", "args": [{"a": [4, 5], "b": ["d", "e"]}]}
+        manager._process(update, self.post)
+        assert pool.get_pending_rows() == 2
+
+        # the second update reaches the bound, and is processed at once
+        update["id"] = 2
+        manager._process(update, self.post)
+        assert pool.get_pending_rows() == 0
+        assert table.size() == 7
+
+    def test_manager_max_pending_messages_coalesces_on_update(self):
+        manager = PerspectiveManager(max_pending_messages=1)
+        table = Table(data)
+        manager.host_table("table1", table)
+        manager.host_view("view1", table.view())
+        session = manager.new_session()
+        posted = []
+        writes = []
+
+        class Write(object):
+            def __init__(self):
+                self.callbacks = []
+
+            def add_done_callback(self, callback):
+                self.callbacks.append(callback)
+
+            def resolve(self):
+                for callback in self.callbacks:
+                    callback(self)
+
+        def post(msg, binary=False):
+            posted.append(json.loads(msg))
+            writes.append(Write())
+            return writes[-1]
+
+        session.process({"id": 1, "name": "view1", "cmd": "view_method", "method": "on_update", "subscribe": True, "callback_id": "cb1"}, post)
+        for i in range(3):
+            table.update({"a": [i], "b": ["x"]})
+
+        # the client has not read the first notification, so the rest are
+        # coalesced into the latest
+        assert len(posted) == 1
+        assert manager._is_client_congested(session.client_id)
+
+        drained = []
+        manager._on_client_drained(session.client_id, lambda: drained.append(True))
+        writes[0].resolve()
+        assert len(posted) == 2
+        assert drained == []
+
+        writes[1].resolve()
+        assert drained == [True]
+        assert not manager._is_client_congested(session.client_id)
+
+        session.close()
+        assert session.client_id not in manager._client_queues
+
+    def test_manager_max_pending_messages_keeps_deltas(self):
+        manager = PerspectiveManager(max_pending_messages=1)
+        table = Table(data)
+        manager.host_table("table1", table)
+        manager.host_view("view1", table.view())
+        session = manager.new_session()
+        posted = []
+
+        class Write(object):
+            def add_done_callback(self, callback):
+                pass
+
+        def post(msg, binary=False):
+            posted.append(msg if binary else json.loads(msg))
+            return Write()
+
+        session.process({"id": 1, "name": "view1", "cmd": "view_method", "method": "on_update", "subscribe": True, "callback_id": "cb1", "args": [{"mode": "row"}]}, post)
+        for i in range(3):
+            table.update({"a": [i], "b": ["x"]})
+
+        # every delta is posted, with its binary
+        assert len(posted) == 6
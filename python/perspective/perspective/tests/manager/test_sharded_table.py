@@ -0,0 +1,113 @@
+################################################################################
+#
+# Copyright (c) 2020, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+import json
+from pytest import raises
+from perspective import Table, PerspectiveError, PerspectiveManager, \
+    PerspectiveShardedTable
+
+data = {
+    "id": [1, 2, 3, 4, 5, 6],
+    "a": ["x", "y", "x", "y", "x", "z"],
+    "b": [1.5, 2.5, 3.5, 4.5, 5.5, 6.5],
+    "c": [1, 2, 3, 4, 5, 6]
+}
+
+
+class TestPerspectiveShardedTable(object):
+
+    def setup_method(self):
+        self.table = PerspectiveShardedTable(data, index="id", shards=3)
+        self.views = []
+
+    def teardown_method(self):
+        for view in self.views:
+            view.delete()
+        self.table.delete()
+
+    def view(self, **config):
+        view = self.table.view(**config)
+        self.views.append(view)
+        return view
+
+    def expected(self, **config):
+        return Table(data, index="id").view(**config).to_dict()
+
+    def test_sharded_table_partitions_rows(self):
+        assert self.table.get_num_shards() == 3
+        assert self.table.size() == 6
+        assert self.table.schema() == {"id": int, "a": str, "b": float, "c": int}
+        sizes = self.table._call_shards(
+            "table_method", [("size", [], {})] * 3)
+        assert sum(sizes) == 6
+        assert max(sizes) < 6
+
+    def test_sharded_table_flat_view(self):
+        assert self.view().to_dict() == self.expected()
+
+    def test_sharded_table_flat_view_sort_and_filter(self):
+        config = {
+            "columns": ["a", "b"],
+            "sort": [["b", "desc"]],
+            "filter": [["c", ">", 2]]
+        }
+        assert self.view(**config).to_dict() == self.expected(**config)
+
+    def test_sharded_table_pivot_merges_aggregates(self):
+        config = {
+            "row_pivots": ["a"],
+            "columns": ["b", "c", "id"],
+            "aggregates": {"b": "mean", "c": "high", "id": "count"}
+        }
+        assert self.view(**config).to_dict() == self.expected(**config)
+
+    def test_sharded_table_column_pivot(self):
+        config = {
+            "row_pivots": ["a"],
+            "column_pivots": ["c"],
+            "columns": ["b"]
+        }
+        assert self.view(**config).to_dict() == self.expected(**config)
+
+    def test_sharded_table_unmergeable_aggregate(self):
+        with raises(PerspectiveError):
+            self.table.view(row_pivots=["a"], columns=["b"],
+                            aggregates={"b": "median"})
+
+    def test_sharded_table_update_and_remove(self):
+        view = self.view(row_pivots=["a"], columns=["c"])
+        updates = []
+        view.on_update(lambda port_id: updates.append(port_id))
+        self.table.update({"id": [1, 7], "c": [10, 20], "a": ["x", "z"]})
+        self.table.remove([2])
+        assert updates == [0, 0]
+
+        expected = Table(data, index="id")
+        expected.update({"id": [1, 7], "c": [10, 20], "a": ["x", "z"]})
+        expected.remove([2])
+        assert self.table.size() == 6
+        assert view.to_dict() == expected.view(
+            row_pivots=["a"], columns=["c"]).to_dict()
+
+    def test_sharded_table_update_without_index(self):
+        with raises(PerspectiveError):
+            self.table.update([{"a": "x", "c": 10}])
+
+    def test_sharded_table_hosted_by_manager(self):
+        manager = PerspectiveManager()
+        manager.host_table("table1", self.table)
+        posted = []
+
+        def post(msg, binary=False):
+            posted.append(json.loads(msg))
+
+        manager._process({"id": 1, "table_name": "table1", "view_name": "view1", "cmd": "view", "config": {"row_pivots": ["a"], "columns": ["c"]}}, post)
+        view = manager.get_view("view1")
+        self.views.append(view)
+        manager._process({"id": 2, "name": "view1", "cmd": "view_method", "method": "to_columns", "args": []}, post)
+        assert posted[-1]["data"] == self.expected(row_pivots=["a"], columns=["c"])
@@ -0,0 +1,57 @@
+################################################################################
+#
+# Copyright (c) 2020, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+from perspective.table import Table, set_alloc_stats_enabled, \
+    is_alloc_stats_enabled, get_alloc_stats, reset_alloc_stats
+
+
+class TestAllocStats(object):
+
+    def setup_method(self):
+        reset_alloc_stats()
+
+    def teardown_method(self):
+        set_alloc_stats_enabled(False)
+        reset_alloc_stats()
+
+    def test_alloc_stats_disabled_counts_nothing(self):
+        set_alloc_stats_enabled(False)
+        tbl = Table({"a": [1, 2, 3]})
+        tbl.view().to_dict()
+        assert not is_alloc_stats_enabled()
+        for counters in get_alloc_stats().values():
+            assert all(value == 0 for value in counters.values())
+
+    def test_alloc_stats_counts_by_owner(self):
+        set_alloc_stats_enabled(True)
+        tbl = Table({"a": [1, 2, 3], "b": ["x", "y", "z"]})
+        view = tbl.view(row_pivots=["b"])
+        tbl.update({"a": list(range(1000)), "b": ["w"] * 1000})
+        view.to_dict()
+        stats = get_alloc_stats()
+        assert set(stats.keys()) == {"other", "master_table", "input_port",
+                                     "transitional", "aggregate", "vocab"}
+        assert stats["master_table"]["init"] > 0
+        assert stats["master_table"]["reserve"] + \
+            stats["master_table"]["extend"] > 0
+        assert stats["aggregate"]["init"] > 0
+        assert stats["transitional"]["allocated_bytes"] > 0
+        assert stats["vocab"]["high_water_bytes"] > 0
+
+    def test_alloc_stats_live_bytes_after_delete(self):
+        set_alloc_stats_enabled(True)
+        tbl = Table({"a": [1, 2, 3]})
+        view = tbl.view(row_pivots=["a"])
+        high_water = get_alloc_stats()["aggregate"]["high_water_bytes"]
+        assert high_water > 0
+        view.delete()
+        stats = get_alloc_stats()["aggregate"]
+        assert stats["live_bytes"] == 0
+        assert stats["high_water_bytes"] == high_water
+        assert stats["freed_bytes"] == stats["allocated_bytes"]
+        tbl.delete()
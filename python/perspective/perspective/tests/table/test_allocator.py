@@ -0,0 +1,44 @@
+# *****************************************************************************
+#
+# Copyright (c) 2019, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+from pytest import raises
+from perspective.table import Table, PerspectiveCppError
+from perspective.table.libbinding import make_allocator, get_default_allocator, \
+    set_default_allocator
+
+
+class TestAllocator(object):
+
+    def teardown_method(self):
+        set_default_allocator(make_allocator("system"))
+
+    def test_allocator_default(self):
+        assert get_default_allocator().name() in ("system", "arena")
+
+    def test_allocator_arena(self):
+        arena = make_allocator("arena")
+        set_default_allocator(arena)
+        tbl = Table({"a": ["abc", "def"], "b": [1, 2]}, index="a")
+        assert tbl._table.get_gnode().get_allocator() is arena
+        view = tbl.view(row_pivots=["a"])
+        tbl.update({"a": ["ghi"] * 1000, "b": list(range(1000))})
+        tbl.update({"a": ["abc"], "b": [10]})
+        assert view.to_dict()["b"] == [999 + 2 + 10, 10, 2, 999]
+        assert arena.reserved_nbytes() > 0
+
+    def test_allocator_tables_keep_allocator(self):
+        set_default_allocator(make_allocator("arena"))
+        tbl = Table({"a": [1, 2, 3]})
+        view = tbl.view()
+        set_default_allocator(make_allocator("system"))
+        tbl.update({"a": list(range(10000))})
+        assert tbl.size() == 10003
+        assert view.to_dict()["a"][:3] == [1, 2, 3]
+
+    def test_allocator_unknown(self):
+        with raises(PerspectiveCppError):
+            make_allocator("unknown")
@@ -0,0 +1,82 @@
+################################################################################
+#
+# Copyright (c) 2019, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+from perspective.table import Table
+
+# Listed out of dependency order: "d" reads "c", which reads "ab", while
+# "ab", "a2" and "b2" read only table columns.
+COMPUTED = [
+    {"column": "d", "computed_function_name": "-", "inputs": ["c", "a"]},
+    {"column": "a2", "computed_function_name": "pow2", "inputs": ["a"]},
+    {"column": "c", "computed_function_name": "*", "inputs": ["ab", "b"]},
+    {"column": "ab", "computed_function_name": "+", "inputs": ["a", "b"]},
+    {"column": "b2", "computed_function_name": "pow2", "inputs": ["b"]}
+]
+
+
+def expected(a, b):
+    ab = [x + y for x, y in zip(a, b)]
+    c = [x * y for x, y in zip(ab, b)]
+    return {
+        "a": a,
+        "b": b,
+        "d": [x - y for x, y in zip(c, a)],
+        "a2": [x * x for x in a],
+        "c": c,
+        "ab": ab,
+        "b2": [y * y for y in b]
+    }
+
+
+def columns(view):
+    return {name: values for name, values in view.to_columns().items() if name != "i"}
+
+
+class TestComputedLevels(object):
+
+    def test_computed_levels_create(self):
+        a, b = list(range(20)), list(range(100, 120))
+        tbl = Table({"a": a, "b": b})
+        assert columns(tbl.view(computed_columns=COMPUTED)) == expected(a, b)
+
+    def test_computed_levels_update_num_threads(self):
+        n = 200
+        a, b = list(range(n)), [i * 3 for i in range(n)]
+        tbl = Table({"i": list(range(n)), "a": a, "b": b}, index="i")
+        view = tbl.view(computed_columns=COMPUTED)
+        pool = tbl._table.get_pool()
+        for num_threads in (1, 2, 0):
+            pool.set_num_threads(num_threads)
+            for idx in range(num_threads, n, 7):
+                a[idx] += 5
+            tbl.update({"i": list(range(num_threads, n, 7)),
+                        "a": [a[idx] for idx in range(num_threads, n, 7)]})
+            assert columns(view) == expected(a, b)
+
+    def test_computed_levels_remove(self):
+        tbl = Table({"i": [0, 1, 2, 3], "a": [1, 2, 3, 4], "b": [5, 6, 7, 8]}, index="i")
+        view = tbl.view(computed_columns=COMPUTED)
+        tbl.remove([1, 3])
+        assert columns(view) == expected([1, 3], [5, 7])
+
+    def test_computed_levels_view_after_load(self):
+        tbl = Table({"i": [0, 1, 2], "a": [1, 2, 3], "b": [4, 5, 6]}, index="i")
+        tbl.update({"i": [1], "a": [10]})
+        view = tbl.view(computed_columns=COMPUTED)
+        assert columns(view) == expected([1, 10, 3], [4, 5, 6])
+        tbl.update({"i": [3], "a": [7], "b": [2]})
+        assert columns(view) == expected([1, 10, 3, 7], [4, 5, 6, 2])
+
+    def test_computed_levels_pivoted_hidden_dependency(self):
+        tbl = Table({"i": [0, 1, 2, 3], "a": [1, 2, 3, 4], "b": [5, 6, 7, 8]}, index="i")
+        view = tbl.view(row_pivots=["i"], columns=["d"], computed_columns=COMPUTED)
+        exp = expected([1, 2, 3, 4], [5, 6, 7, 8])["d"]
+        assert view.to_columns()["d"] == [sum(exp)] + exp
+        tbl.update({"i": [2], "b": [1]})
+        exp = expected([1, 2, 3, 4], [5, 6, 1, 8])["d"]
+        assert view.to_columns()["d"] == [sum(exp)] + exp
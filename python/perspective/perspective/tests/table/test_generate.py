@@ -0,0 +1,95 @@
+################################################################################
+#
+# Copyright (c) 2020, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+from datetime import date, datetime
+from pytest import raises
+from perspective.table import Table
+from perspective import PerspectiveCppError
+
+SCHEMA = {
+    "id": int,
+    "x": float,
+    "g": str,
+    "b": bool,
+    "d": date,
+    "t": datetime
+}
+
+
+class TestGenerate(object):
+
+    def test_generate_inserts(self):
+        tbl = Table(SCHEMA, index="id")
+        tbl.generate(insert=1000)
+        assert tbl.size() == 1000
+        data = tbl.view().to_dict()
+        assert data["id"] == list(range(1000))
+        assert len(set(data["x"])) == 1000
+
+    def test_generate_is_deterministic(self):
+        spec = {"seed": 3, "columns": {"g": {"cardinality": 10}}}
+        a = Table(SCHEMA, index="id")
+        b = Table(SCHEMA, index="id")
+        for tbl in (a, b):
+            tbl.generate(spec, insert=100)
+            tbl.generate(spec, insert=10, update=50)
+        assert a.view().to_dict() == b.view().to_dict()
+
+        c = Table(SCHEMA, index="id")
+        c.generate(dict(spec, seed=4), insert=100)
+        assert c.view().to_dict()["g"] != a.view().to_dict()["g"][:100]
+
+    def test_generate_cardinality_and_string_length(self):
+        tbl = Table(SCHEMA, index="id")
+        spec = {"columns": {"g": {"cardinality": 5, "string_length": 3}}}
+        tbl.generate(spec, insert=1000)
+        values = set(tbl.view().to_dict()["g"])
+        assert len(values) == 5
+        assert all(len(v) == 3 for v in values)
+
+    def test_generate_null_ratio(self):
+        tbl = Table(SCHEMA, index="id")
+        tbl.generate({"columns": {"x": {"null_ratio": 0.5}}}, insert=10000)
+        nulls = tbl.view().to_dict()["x"].count(None)
+        assert 4500 < nulls < 5500
+
+    def test_generate_sorted(self):
+        tbl = Table({"id": int, "s": int}, index="id")
+        spec = {"columns": {"s": {"cardinality": 10, "sortedness": 1}}}
+        tbl.generate(spec, insert=100)
+        data = tbl.view().to_dict()["s"]
+        assert data == sorted(data)
+        assert len(set(data)) == 10
+
+    def test_generate_updates_and_removes(self):
+        tbl = Table(SCHEMA, index="id")
+        tbl.generate(insert=1000)
+        before = tbl.view().to_dict()
+        tbl.generate(update=100)
+        assert tbl.size() == 1000
+        assert tbl.view().to_dict()["x"] != before["x"]
+        tbl.generate(insert=10, remove=100)
+        assert 910 <= tbl.size() < 1010
+
+    def test_generate_without_index_inserts(self):
+        tbl = Table(SCHEMA)
+        tbl.generate(insert=100)
+        tbl.generate(insert=100)
+        assert tbl.size() == 200
+        with raises(PerspectiveCppError):
+            tbl.generate(update=10)
+
+    def test_generate_notifies_views(self):
+        tbl = Table(SCHEMA, index="id")
+        view = tbl.view(row_pivots=["g"])
+        counts = []
+        view.on_update(lambda port_id: counts.append(port_id))
+        tbl.generate({"columns": {"g": {"cardinality": 4}}}, insert=100)
+        tbl.size()
+        assert len(counts) == 1
+        assert view.to_dict()["x"][0] is not None
@@ -0,0 +1,90 @@
+################################################################################
+#
+# Copyright (c) 2019, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+from perspective.table import Table
+from perspective.table.libbinding import make_grouped_pkey_context, \
+    get_grouped_pkey_data, unregister_grouped_pkey_context
+
+DATA = {
+    "id": [1, 2, 3, 4, 5],
+    "parent": [None, 1, 1, 2, 2],
+    "name": ["a", "b", "c", "d", "e"],
+    "x": [1.5, 2.5, 3.5, 4.5, 5.5]
+}
+
+
+def grouped(tbl, name):
+    ctx = make_grouped_pkey_context(tbl._table, name, ["name", "x"], "parent", "id", "name")
+    ctx.set_depth(10)
+    return ctx
+
+
+def rows(tbl, ctx):
+    # Skips the root, which has no pkey to label it.
+    return get_grouped_pkey_data(tbl._table, ctx)[1:]
+
+
+class TestGroupedPkey(object):
+
+    def check_against_rebuilt(self, tbl, ctx):
+        fresh = grouped(tbl, "fresh")
+        try:
+            assert ctx.get_row_count() == fresh.get_row_count()
+            assert sorted(rows(tbl, ctx)) == sorted(rows(tbl, fresh))
+        finally:
+            unregister_grouped_pkey_context(tbl._table, "fresh")
+
+    def test_grouped_pkey_tree(self):
+        tbl = Table(DATA, index="id")
+        ctx = grouped(tbl, "ctx")
+        assert ctx.get_column_count() == 3
+        assert ctx.get_row_count() == 6
+        assert sorted(rows(tbl, ctx)) == [
+            ["a", "a", 1.5], ["b", "b", 2.5], ["c", "c", 3.5], ["d", "d", 4.5],
+            ["e", "e", 5.5]
+        ]
+        unregister_grouped_pkey_context(tbl._table, "ctx")
+
+    def test_grouped_pkey_update_values_in_place(self):
+        tbl = Table(DATA, index="id")
+        ctx = grouped(tbl, "ctx")
+        before = [row[0] for row in rows(tbl, ctx)]
+        tbl.update({"id": [4, 3], "x": [40.5, 30.5]})
+        assert [row[0] for row in rows(tbl, ctx)] == before
+        assert sorted(rows(tbl, ctx)) == [
+            ["a", "a", 1.5], ["b", "b", 2.5], ["c", "c", 30.5], ["d", "d", 40.5],
+            ["e", "e", 5.5]
+        ]
+        self.check_against_rebuilt(tbl, ctx)
+        tbl.update({"id": [5], "name": ["f"]})
+        assert ["f", "f", 5.5] in rows(tbl, ctx)
+        self.check_against_rebuilt(tbl, ctx)
+        unregister_grouped_pkey_context(tbl._table, "ctx")
+
+    def test_grouped_pkey_update_parent(self):
+        tbl = Table(DATA, index="id")
+        ctx = grouped(tbl, "ctx")
+        tbl.update({"id": [4], "parent": [3]})
+        labels = [row[0] for row in rows(tbl, ctx)]
+        assert labels.index("d") > labels.index("c")
+        self.check_against_rebuilt(tbl, ctx)
+        tbl.update({"id": [6], "parent": [5], "name": ["f"], "x": [6.5]})
+        assert ctx.get_row_count() == 7
+        labels = [row[0] for row in rows(tbl, ctx)]
+        assert labels.index("f") > labels.index("e")
+        self.check_against_rebuilt(tbl, ctx)
+        unregister_grouped_pkey_context(tbl._table, "ctx")
+
+    def test_grouped_pkey_remove(self):
+        tbl = Table(DATA, index="id")
+        ctx = grouped(tbl, "ctx")
+        tbl.remove([5])
+        assert ctx.get_row_count() == 5
+        assert "e" not in [row[0] for row in rows(tbl, ctx)]
+        self.check_against_rebuilt(tbl, ctx)
+        unregister_grouped_pkey_context(tbl._table, "ctx")
@@ -0,0 +1,68 @@
+################################################################################
+#
+# Copyright (c) 2019, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+import threading
+from perspective.table import Table
+
+# Strings short enough to share the arena's 64KB blocks, and long enough to
+# be given blocks of their own.
+LENGTHS = [0, 1, 7, 100, 4095, 16383, 16385, 65535, 65537, 200000]
+
+
+def make_string(idx, length):
+    prefix = "{0}:".format(idx)
+    return (prefix + "x" * length)[:max(length, len(prefix))]
+
+
+class TestInterning(object):
+
+    def test_pivot_values_of_every_length(self):
+        values = [make_string(idx, length) for idx, length in enumerate(LENGTHS)]
+        tbl = Table({"a": values * 3, "b": list(range(3 * len(values)))})
+        view = tbl.view(row_pivots=["a"], columns=["b"], aggregates={"b": "count"})
+        rows = view.to_dict()
+        assert rows["__ROW_PATH__"] == [[]] + [[v] for v in sorted(values)]
+        assert rows["b"] == [3 * len(values)] + [3] * len(values)
+
+    def test_many_distinct_pivot_values(self):
+        values = ["value-{0}-{1}".format(i, "y" * (i % 300)) for i in range(5000)]
+        tbl = Table({"a": values, "b": [1] * len(values)})
+        view = tbl.view(row_pivots=["a"], columns=["b"], aggregates={"b": "sum"})
+        rows = view.to_dict()
+        assert rows["__ROW_PATH__"][1:] == [[v] for v in sorted(values)]
+        assert rows["b"][0] == len(values)
+
+    def test_pivot_values_outlive_updates(self):
+        tbl = Table({"id": [0, 1, 2], "a": ["p", "q", "r"]}, index="id")
+        view = tbl.view(row_pivots=["a"], columns=["id"], aggregates={"id": "count"})
+        tbl.update({"id": [0, 1, 2], "a": ["s", "s", "t"]})
+        tbl.update({"id": [2], "a": ["p"]})
+        assert view.to_dict() == {
+            "__ROW_PATH__": [[], ["p"], ["s"]],
+            "id": [3, 1, 2]
+        }
+
+    def test_pivot_values_interned_from_threads(self):
+        results = {}
+
+        def run(idx):
+            values = ["t{0}-{1}".format(idx % 2, i % 50) for i in range(2000)]
+            tbl = Table({"a": values, "b": list(range(len(values)))})
+            view = tbl.view(row_pivots=["a"], columns=["b"], aggregates={"b": "count"})
+            results[idx] = view.to_dict()
+
+        threads = [threading.Thread(target=run, args=(idx,)) for idx in range(8)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+
+        for idx in range(8):
+            expected = sorted(set("t{0}-{1}".format(idx % 2, i) for i in range(50)))
+            assert results[idx]["__ROW_PATH__"] == [[]] + [[v] for v in expected]
+            assert results[idx]["b"] == [2000] + [40] * 50
@@ -0,0 +1,61 @@
+# *****************************************************************************
+#
+# Copyright (c) 2019, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+from pytest import raises
+from perspective.table import Table, PerspectiveCppError
+from perspective.table.libbinding import t_isa, str_to_isa, get_isa, \
+    get_detected_isa, set_isa
+
+ISAS = [t_isa.ISA_DEFAULT, t_isa.ISA_AVX2, t_isa.ISA_AVX512]
+
+
+def run_views():
+    data = {
+        "a": [i % 7 for i in range(1000)],
+        "b": [i * 0.5 - 100 for i in range(1000)],
+        "c": [-0.0 if i % 3 else 0.0 for i in range(1000)],
+        "d": [i % 2 == 0 for i in range(1000)]
+    }
+    tbl = Table(data)
+    return [
+        tbl.view(filter=[["a", ">=", 3], ["b", "<", 200.0]]).to_dict(),
+        tbl.view(filter=[["c", "==", 0.0], ["d", "==", True]]).to_dict(),
+        tbl.view(filter=[["a", "!=", 4]], filter_op="or").to_dict(),
+        tbl.view(row_pivots=["a"], aggregates={"b": "min", "c": "max"},
+                 columns=["b", "c"]).to_dict()
+    ]
+
+
+class TestISA(object):
+
+    def teardown_method(self):
+        set_isa(get_detected_isa())
+
+    def test_isa_detected(self):
+        assert int(get_isa()) <= int(get_detected_isa())
+
+    def test_isa_capped_at_detected(self):
+        set_isa(t_isa.ISA_AVX512)
+        assert get_isa() == get_detected_isa()
+
+    def test_isa_views_equal(self):
+        expected = None
+        for isa in ISAS:
+            set_isa(isa)
+            rval = run_views()
+            if expected is None:
+                expected = rval
+            assert rval == expected
+
+    def test_isa_str(self):
+        assert str_to_isa("default") == t_isa.ISA_DEFAULT
+        assert str_to_isa("avx2") == t_isa.ISA_AVX2
+        assert str_to_isa("avx512") == t_isa.ISA_AVX512
+
+    def test_isa_str_unknown(self):
+        with raises(PerspectiveCppError):
+            str_to_isa("sse9")
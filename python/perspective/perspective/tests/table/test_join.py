@@ -0,0 +1,102 @@
+# *****************************************************************************
+#
+# Copyright (c) 2019, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+from pytest import raises
+from perspective.core.exception import PerspectiveError
+from perspective.table import Table
+
+
+def _trades():
+    return Table({
+        "id": [1, 2, 3],
+        "symbol": ["AAPL", "MSFT", "AAPL"],
+        "qty": [10, 20, 30]
+    }, index="id")
+
+
+def _symbols():
+    return Table({
+        "symbol": ["AAPL", "MSFT"],
+        "name": ["Apple", "Microsoft"]
+    }, index="symbol")
+
+
+class TestJoin(object):
+
+    def test_join(self):
+        joined = _trades().join(_symbols(), "symbol")
+        assert joined.columns() == ["id", "symbol", "qty", "name"]
+        assert joined.view().to_dict() == {
+            "id": [1, 2, 3],
+            "symbol": ["AAPL", "MSFT", "AAPL"],
+            "qty": [10, 20, 30],
+            "name": ["Apple", "Microsoft", "Apple"]
+        }
+
+    def test_join_unmatched_is_null(self):
+        trades = _trades()
+        trades.update([{"id": 4, "symbol": "IBM", "qty": 40}])
+        joined = trades.join(_symbols(), "symbol")
+        assert joined.view().to_dict()["name"] == ["Apple", "Microsoft", "Apple", None]
+
+    def test_join_update_left(self):
+        trades = _trades()
+        joined = trades.join(_symbols(), "symbol")
+        view = joined.view()
+        trades.update([{"id": 2, "symbol": "AAPL"}, {"id": 4, "symbol": "MSFT", "qty": 40}])
+        assert view.to_dict() == {
+            "id": [1, 2, 3, 4],
+            "symbol": ["AAPL", "AAPL", "AAPL", "MSFT"],
+            "qty": [10, 20, 30, 40],
+            "name": ["Apple", "Apple", "Apple", "Microsoft"]
+        }
+
+    def test_join_remove_left(self):
+        trades = _trades()
+        joined = trades.join(_symbols(), "symbol")
+        trades.remove([1, 3])
+        assert joined.view().to_dict() == {
+            "id": [2],
+            "symbol": ["MSFT"],
+            "qty": [20],
+            "name": ["Microsoft"]
+        }
+
+    def test_join_update_right(self):
+        trades = _trades()
+        symbols = _symbols()
+        joined = trades.join(symbols, "symbol")
+        view = joined.view()
+        symbols.update([{"symbol": "AAPL", "name": "Apple Inc."}])
+        assert view.to_dict()["name"] == ["Apple Inc.", "Microsoft", "Apple Inc."]
+        assert view.to_dict()["qty"] == [10, 20, 30]
+
+    def test_join_right_arrives_after_left(self):
+        trades = _trades()
+        symbols = Table({"symbol": str, "name": str}, index="symbol")
+        joined = trades.join(symbols, "symbol")
+        assert joined.view().to_dict()["name"] == [None, None, None]
+        symbols.update([{"symbol": "MSFT", "name": "Microsoft"}])
+        assert joined.view().to_dict()["name"] == [None, "Microsoft", None]
+
+    def test_join_remove_right(self):
+        trades = _trades()
+        symbols = _symbols()
+        joined = trades.join(symbols, "symbol")
+        symbols.remove(["AAPL"])
+        assert joined.view().to_dict()["name"] == [None, "Microsoft", None]
+
+    def test_join_left_without_index(self):
+        trades = Table({"symbol": ["AAPL"], "qty": [10]})
+        with raises(PerspectiveError):
+            trades.join(_symbols(), "symbol")
+
+    def test_join_right_not_indexed_by_on(self):
+        symbols = Table({"symbol": ["AAPL"], "name": ["Apple"]})
+        with raises(PerspectiveError):
+            _trades().join(symbols, "symbol")
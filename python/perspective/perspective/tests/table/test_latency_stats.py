@@ -0,0 +1,53 @@
+################################################################################
+#
+# Copyright (c) 2020, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+from perspective.table import Table
+
+
+class TestLatencyStats(object):
+
+    def test_latency_stats_records_each_update(self):
+        tbl = Table({"a": [1, 2, 3], "b": ["x", "y", "z"]}, index="a")
+        tbl.view()
+        tbl.reset_latency_stats()
+        for i in range(5):
+            tbl.update({"a": [i], "b": ["w"]})
+            tbl.size()
+        stats = tbl.get_latency_stats()
+        assert sorted(stats.keys()) == ["callback_wait", "end_to_end",
+                                        "process", "send_wait"]
+        for histogram in stats.values():
+            assert histogram["count"] == 5
+            assert histogram["min_ns"] <= histogram["p50_ns"]
+            assert histogram["p50_ns"] <= histogram["p99_ns"]
+            assert histogram["p99_ns"] <= histogram["max_ns"]
+        assert stats["end_to_end"]["min_ns"] >= stats["process"]["min_ns"]
+
+    def test_latency_stats_reset(self):
+        tbl = Table({"a": [1, 2, 3]})
+        tbl.update({"a": [4]})
+        tbl.size()
+        assert tbl.get_latency_stats()["process"]["count"] > 0
+        tbl.reset_latency_stats()
+        stats = tbl.get_latency_stats()
+        assert stats["process"]["count"] == 0
+        assert stats["process"]["p99_ns"] == 0
+
+    def test_view_latency_stats(self):
+        tbl = Table({"a": [1, 2, 3], "b": ["x", "y", "z"]}, index="a")
+        view = tbl.view(row_pivots=["b"])
+        tbl.update({"a": [1], "b": ["w"]})
+        tbl.size()
+        stats = view.get_latency_stats()
+        assert sorted(stats.keys()) == ["callback_wait", "end_to_end", "notify"]
+        assert stats["notify"]["count"] == 1
+        assert stats["end_to_end"]["count"] == 1
+        assert stats["end_to_end"]["max_ns"] >= stats["notify"]["max_ns"]
+
+        view.reset_latency_stats()
+        assert view.get_latency_stats()["end_to_end"]["count"] == 0
@@ -0,0 +1,38 @@
+################################################################################
+#
+# Copyright (c) 2019, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+from ..common import run_with_env, run_in_process
+
+# Inserts, updates, removes and re-inserts keys of an integer and a string
+# index, enough to grow and rebuild the filter of each many times over.
+SOURCE = """
+from perspective.table import Table
+
+
+def result():
+    rval = []
+    for key in (lambda i: i * 3, lambda i: "k{0}".format(i * 3)):
+        tbl = Table({"k": [key(i) for i in range(100)], "x": list(range(100))}, index="k")
+        for step in range(20):
+            ids = range(step * 50, step * 50 + 200)
+            tbl.update({"k": [key(i) for i in ids], "x": [i + step for i in ids]})
+            tbl.remove([key(i) for i in range(step * 50, step * 50 + 120)])
+        tbl.update({"k": [key(i) for i in range(0, 60)], "x": list(range(60))})
+        records = tbl.view(sort=[["x", "asc"], ["k", "asc"]]).to_records()
+        rval.append([tbl.size(), records])
+    return rval
+"""
+
+
+class TestPkeyBloomFilter(object):
+
+    def test_pkey_bloom_filter_matches_hash_map(self):
+        expected = run_in_process(SOURCE)
+        assert run_with_env({"PSP_PKEY_BLOOM_FILTER_MIN_SIZE": "1"}, SOURCE) == expected
+        assert run_with_env({"PSP_PKEY_BLOOM_FILTER_MIN_SIZE": "64"}, SOURCE) == expected
+        assert run_with_env({"PSP_PKEY_BLOOM_FILTER_MIN_SIZE": "0"}, SOURCE) == expected
@@ -0,0 +1,151 @@
+################################################################################
+#
+# Copyright (c) 2019, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+import threading
+import time
+from perspective.table import Table
+
+
+def threaded_table(max_rows=0, max_wait_us=0):
+    # A table whose pool is only processed by its own thread: no update
+    # delegate, and no `_process` queued by the binding.
+    tbl = Table({"a": [1]})
+    pool = tbl._table.get_pool()
+    pool.set_update_delegate(None)
+    pool.set_coalesce_policy(max_rows, max_wait_us)
+    tbl._state_manager.queue_process = lambda table_id: None
+    pool.init()
+    return tbl, pool
+
+
+def wait_processed(pool, timeout=5):
+    start = time.time()
+    while pool.get_pending_rows() > 0 and time.time() - start < timeout:
+        time.sleep(0.005)
+    return time.time() - start
+
+
+class TestPool(object):
+
+    def test_pool_update_from_callback(self):
+        tbl = Table({"a": [1, 2]})
+        view = tbl.view()
+        calls = []
+
+        def cb(port_id):
+            calls.append(port_id)
+            if len(calls) == 1:
+                tbl.update({"a": [4]})
+
+        view.on_update(cb)
+        tbl.update({"a": [3]})
+        assert view.to_dict() == {"a": [1, 2, 3, 4]}
+        assert len(calls) == 2
+
+    def test_pool_delete_table_from_callback(self):
+        tbl = Table({"a": [1, 2]})
+        other = Table({"a": [1, 2]})
+        view = tbl.view()
+        other_view = other.view()
+        deleted = []
+
+        def cb(port_id):
+            view.delete()
+            tbl.delete()
+            deleted.append(port_id)
+
+        view.on_update(cb)
+        tbl.update({"a": [3]})
+        assert len(deleted) == 1
+        other.update({"a": [3]})
+        assert other_view.to_dict() == {"a": [1, 2, 3]}
+
+    def test_pool_updates_queued_before_process(self):
+        # The first update is adopted by the empty port, the rest are
+        # appended to it; both must match updates processed one at a time.
+        def run(tbl):
+            tbl.update({"a": [1, 2], "b": ["x", "y"]})
+            tbl.update({"a": [2, 3], "b": ["z", None]})
+            tbl.update({"a": [4]})
+            tbl.remove([1])
+
+        expected = Table({"a": int, "b": str}, index="a")
+        run(expected)
+        tbl = Table({"a": int, "b": str}, index="a")
+        batches = []
+        replica = Table.from_replication(tbl.enable_replication(batches.append))
+        view = tbl.view()
+        tbl._state_manager.queue_process = lambda table_id: None
+        run(tbl)
+        assert tbl._table.get_pool().get_pending_rows() > 0
+        assert view.to_dict() == expected.view().to_dict()
+        assert view.to_dict() == {"a": [2, 3, 4], "b": ["z", None, None]}
+        for batch in batches:
+            replica.apply(batch)
+        assert replica.view().to_dict() == view.to_dict()
+
+        tbl.update({"a": [5], "b": ["w"]})
+        assert view.to_dict() == {"a": [2, 3, 4, 5], "b": ["z", None, None, "w"]}
+
+    def test_pool_tables_updated_from_threads(self):
+        tables = [Table({"a": int, "b": str}) for _ in range(4)]
+        views = [tbl.view(row_pivots=["b"]) for tbl in tables]
+
+        def run(tbl, offset):
+            for idx in range(50):
+                tbl.update({"a": [offset + idx], "b": [str(idx % 5)]})
+
+        threads = [threading.Thread(target=run, args=(tbl, idx * 1000))
+                   for idx, tbl in enumerate(tables)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+
+        for idx, view in enumerate(views):
+            assert view.num_rows() == 6
+            assert view.to_dict()["a"][0] == sum(idx * 1000 + i for i in range(50))
+
+
+class TestPoolThread(object):
+
+    def test_pool_thread_processes_sends(self):
+        tbl, pool = threaded_table()
+        tbl.update({"a": [2]})
+        wait_processed(pool)
+        assert pool.get_pending_rows() == 0
+        pool.stop()
+        assert tbl.view().to_dict() == {"a": [1, 2]}
+
+    def test_pool_thread_waits_out_coalescing_window(self):
+        tbl, pool = threaded_table(0, 300 * 1000)
+        tbl.update({"a": [2]})
+        assert pool.get_pending_rows() == 1
+        assert wait_processed(pool) >= 0.2
+        assert pool.get_pending_rows() == 0
+        pool.stop()
+        assert tbl.view().to_dict() == {"a": [1, 2]}
+
+    def test_pool_thread_max_rows_ends_window(self):
+        tbl, pool = threaded_table(2, 60 * 1000 * 1000)
+        tbl.update({"a": [2]})
+        time.sleep(0.05)
+        assert pool.get_pending_rows() == 1
+        tbl.update({"a": [3]})
+        wait_processed(pool)
+        assert pool.get_pending_rows() == 0
+        pool.stop()
+        assert tbl.view().to_dict() == {"a": [1, 2, 3]}
+
+    def test_pool_stop_processes_pending(self):
+        tbl, pool = threaded_table(0, 60 * 1000 * 1000)
+        tbl.update({"a": [2]})
+        assert pool.get_pending_rows() == 1
+        pool.stop()
+        assert pool.get_pending_rows() == 0
+        assert tbl.view().to_dict() == {"a": [1, 2]}
@@ -0,0 +1,77 @@
+################################################################################
+#
+# Copyright (c) 2020, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+import time
+from perspective.table import Table, set_profiling_enabled, \
+    is_profiling_enabled, get_profile, clear_profile
+
+
+def run_until_sampled(phase=None, timeout=5):
+    tbl = Table({"a": [1, 2, 3], "b": ["x", "y", "z"]})
+    view = tbl.view(row_pivots=["b"], sort=[["a", "desc"]])
+    start = time.time()
+    while time.time() - start < timeout:
+        tbl.update({"a": list(range(1000)), "b": [str(i % 10) for i in range(1000)]})
+        view.to_dict()
+        profile = get_profile()
+        if profile["ticks"] > 0 and (phase is None or phase in profile["phases"]):
+            break
+    return get_profile()
+
+
+class TestProfiling(object):
+
+    def setup_method(self):
+        clear_profile()
+
+    def teardown_method(self):
+        set_profiling_enabled(False)
+        clear_profile()
+
+    def test_profiling_disabled_samples_nothing(self):
+        set_profiling_enabled(False)
+        tbl = Table({"a": [1, 2, 3]})
+        tbl.view().to_dict()
+        time.sleep(0.01)
+        assert not is_profiling_enabled()
+        assert get_profile()["ticks"] == 0
+        assert get_profile()["phases"] == {}
+
+    def test_profiling_samples_phases(self):
+        set_profiling_enabled(True)
+        assert is_profiling_enabled()
+        profile = run_until_sampled("gnode.process")
+        assert profile["ticks"] > 0
+        assert profile["interval_us"] > 0
+        assert profile["phases"]["gnode.process"] > 0
+        for samples in profile["phases"].values():
+            assert samples > 0
+
+    def test_profiling_samples_idle_threads(self):
+        set_profiling_enabled(True)
+        profile = run_until_sampled()
+        time.sleep(0.05)
+        profile = get_profile()
+        assert profile["phases"].get("idle", 0) > 0
+
+    def test_profiling_keeps_samples_when_disabled(self):
+        set_profiling_enabled(True)
+        run_until_sampled()
+        set_profiling_enabled(False)
+        ticks = get_profile()["ticks"]
+        time.sleep(0.01)
+        assert ticks > 0
+        assert get_profile()["ticks"] == ticks
+
+    def test_profiling_clear(self):
+        set_profiling_enabled(True)
+        run_until_sampled()
+        set_profiling_enabled(False)
+        clear_profile()
+        assert get_profile()["ticks"] == 0
+        assert get_profile()["phases"] == {}
@@ -0,0 +1,86 @@
+################################################################################
+#
+# Copyright (c) 2019, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+from pytest import raises
+from perspective.table import Table, PerspectiveCppError, register_reducer, \
+    unregister_reducer
+
+
+def _spread(calls):
+    def spread(values, offsets):
+        calls.append(len(offsets) - 1)
+        return [values[b:e].max() - values[b:e].min() if e > b else None
+                for b, e in zip(offsets[:-1], offsets[1:])]
+    return spread
+
+
+def _trades():
+    return Table({
+        "id": [1, 2, 3],
+        "desk": ["x", "x", "y"],
+        "price": [1.0, 4.0, 10.0]
+    }, index="id")
+
+
+class TestReducers(object):
+
+    def teardown_method(self):
+        unregister_reducer("spread")
+
+    def test_reducer(self):
+        register_reducer("spread", _spread([]))
+        view = _trades().view(row_pivots=["desk"], columns=["price"],
+                              aggregates={"price": ["reducer", "spread"]})
+        assert view.to_dict() == {
+            "__ROW_PATH__": [[], ["x"], ["y"]],
+            "price": [9, 3, 0]
+        }
+
+    def test_reducer_called_once_for_updated_nodes(self):
+        calls = []
+        register_reducer("spread", _spread(calls))
+        tbl = _trades()
+        view = tbl.view(row_pivots=["desk"], columns=["price"],
+                        aggregates={"price": ["reducer", "spread"]})
+        view.to_dict()
+        del calls[:]
+        tbl.update([{"id": 3, "price": 12.0}, {"id": 4, "desk": "y", "price": 2.0}])
+        assert view.to_dict() == {
+            "__ROW_PATH__": [[], ["x"], ["y"]],
+            "price": [11, 3, 10]
+        }
+        # The root and `y`, but not `x`, in one call.
+        assert calls == [2]
+
+    def test_reducer_after_remove(self):
+        register_reducer("spread", _spread([]))
+        tbl = _trades()
+        view = tbl.view(row_pivots=["desk"], columns=["price"],
+                        aggregates={"price": ["reducer", "spread"]})
+        tbl.remove([2, 3])
+        assert view.to_dict() == {
+            "__ROW_PATH__": [[], ["x"]],
+            "price": [0, 0]
+        }
+
+    def test_reducer_explain(self):
+        register_reducer("spread", _spread([]))
+        view = _trades().view(row_pivots=["desk"], columns=["price"],
+                              aggregates={"price": ["reducer", "spread"]})
+        strategies = {agg["column"]: agg["strategy"]
+                      for agg in view.explain()["aggregates"]}
+        assert strategies == {"price": "reducer"}
+
+    def test_reducer_not_registered(self):
+        with raises(PerspectiveCppError):
+            _trades().view(row_pivots=["desk"], columns=["price"],
+                           aggregates={"price": ["reducer", "spread"]})
+
+    def test_reducer_not_callable(self):
+        with raises(TypeError):
+            register_reducer("spread", 1)
@@ -6,6 +6,9 @@
 # the Apache License 2.0.  The full license can be found in the LICENSE file.
 #
 
+from datetime import datetime, timedelta
+from pytest import raises
+from perspective.core.exception import PerspectiveError
 from perspective.table import Table
 
 
@@ -28,3 +31,71 @@ class TestRemove(object):
         for i in range(1, 10):
             tbl.remove([i])
         assert tbl.view().to_records() == [{"a": 0, "b": "0"}]
+
+    def test_remove_sparse_int_index(self):
+        tbl = Table({"a": int, "b": str}, index="a")
+        keys = [0, 1, 2, -5, 10 ** 12, 3]
+        tbl.update([{"a": k, "b": str(k)} for k in keys])
+        tbl.remove([1, 10 ** 12])
+        tbl.update([{"a": -5, "b": "x"}, {"a": 4, "b": "4"}])
+        assert tbl.size() == 5
+        assert sorted(tbl.view().to_records(), key=lambda r: r["a"]) == [
+            {"a": -5, "b": "x"},
+            {"a": 0, "b": "0"},
+            {"a": 2, "b": "2"},
+            {"a": 3, "b": "3"},
+            {"a": 4, "b": "4"}
+        ]
+
+    def test_remove_string_churn(self):
+        tbl = Table({"a": str, "b": str}, index="a")
+        view = tbl.view()
+        for i in range(0, 5):
+            tbl.update([{"a": "k{}_{}".format(i, j), "b": "v{}_{}".format(i, j)} for j in range(1000)])
+            tbl.remove(["k{}_{}".format(i, j) for j in range(1, 1000)])
+        tbl.update([{"a": "k4_0", "b": "x"}])
+        assert tbl.size() == 5
+        assert view.to_records() == [
+            {"a": "k0_0", "b": "v0_0"},
+            {"a": "k1_0", "b": "v1_0"},
+            {"a": "k2_0", "b": "v2_0"},
+            {"a": "k3_0", "b": "v3_0"},
+            {"a": "k4_0", "b": "x"}
+        ]
+
+    def test_remove_where(self):
+        start = datetime(2020, 1, 1)
+        tbl = Table({
+            "a": list(range(100)),
+            "t": [start + timedelta(minutes=i) for i in range(100)],
+            "b": ["x" if i % 2 else "y" for i in range(100)]
+        }, index="a")
+        view = tbl.view(row_pivots=["b"], columns=["a"], aggregates={"a": "count"})
+        assert tbl.remove_where([["t", "<", start + timedelta(minutes=90)]]) == 90
+        assert tbl.size() == 10
+        assert tbl.view(columns=["a"]).to_dict() == {"a": list(range(90, 100))}
+        assert view.to_dict() == {"__ROW_PATH__": [[], ["x"], ["y"]], "a": [10, 5, 5]}
+
+        assert tbl.remove_where([["b", "==", "x"], ["a", ">", 95]], filter_op="or") == 7
+        assert tbl.view(columns=["a"]).to_dict() == {"a": [90, 92, 94]}
+        assert tbl.remove_where([["a", ">", 1000]]) == 0
+        assert tbl.size() == 3
+
+    def test_remove_where_string_index(self):
+        tbl = Table({"a": ["k{}".format(i) for i in range(10)], "b": list(range(10))}, index="a")
+        assert tbl.remove_where([["b", ">=", 5]]) == 5
+        tbl.update([{"a": "k7", "b": 70}])
+        assert tbl.view().to_dict() == {"a": ["k0", "k1", "k2", "k3", "k4", "k7"], "b": [0, 1, 2, 3, 4, 70]}
+
+    def test_remove_where_no_index(self):
+        tbl = Table({"a": [1, 2, 3]})
+        assert tbl.remove_where([["a", ">", 1]]) == 0
+        assert tbl.size() == 3
+
+    def test_remove_where_invalid_filter(self):
+        tbl = Table({"a": [1, 2, 3]}, index="a")
+        with raises(PerspectiveError):
+            tbl.remove_where([])
+        with raises(PerspectiveError):
+            tbl.remove_where([["b", "==", 1]])
+        assert tbl.size() == 3
@@ -0,0 +1,156 @@
+# *****************************************************************************
+#
+# Copyright (c) 2019, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+from datetime import date, datetime
+from pytest import raises
+from perspective.table import Table, PerspectiveCppError
+
+
+def replicate(tbl):
+    batches = []
+    replica = Table.from_replication(tbl.enable_replication(batches.append))
+    return replica, batches
+
+
+def sync(replica, batches):
+    for batch in batches:
+        replica.apply(batch)
+    del batches[:]
+
+
+def rows(tbl):
+    return sorted(tbl.view().to_records(), key=lambda row: str(row))
+
+
+class TestReplication(object):
+
+    def test_replication_snapshot(self):
+        tbl = Table({"a": [1, 2, 3], "b": ["x", "y", None]}, index="a")
+        replica, _ = replicate(tbl)
+        assert replica.schema() == tbl.schema()
+        assert replica._index == "a"
+        assert rows(replica) == rows(tbl)
+
+    def test_replication_dtypes(self):
+        tbl = Table({
+            "a": int,
+            "b": float,
+            "c": str,
+            "d": bool,
+            "e": date,
+            "f": datetime
+        })
+        replica, batches = replicate(tbl)
+        tbl.update({
+            "a": [1, None],
+            "b": [1.5, None],
+            "c": ["x", None],
+            "d": [True, None],
+            "e": [date(2020, 1, 2), None],
+            "f": [datetime(2020, 1, 2, 3, 4, 5), None]
+        })
+        tbl.size()
+        sync(replica, batches)
+        assert replica.schema() == tbl.schema()
+        assert replica.view().to_dict() == tbl.view().to_dict()
+
+    def test_replication_updates(self):
+        tbl = Table({"a": [1, 2, 3], "b": [1.5, 2.5, 3.5], "c": ["x", "y", "z"]}, index="a")
+        replica, batches = replicate(tbl)
+        tbl.update({"a": [2, 4], "b": [20.5, 40.5], "c": ["yy", "w"]})
+        tbl.size()
+        sync(replica, batches)
+        assert rows(replica) == rows(tbl)
+
+    def test_replication_partial_updates(self):
+        tbl = Table({"a": [1, 2, 3], "b": [1.5, 2.5, 3.5], "c": ["x", "y", "z"]}, index="a")
+        replica, batches = replicate(tbl)
+
+        # `b` is left as it was, and `c` is cleared.
+        tbl.update([{"a": 1, "c": None}, {"a": 2, "b": None}])
+        tbl.size()
+        sync(replica, batches)
+        assert rows(replica) == rows(tbl)
+        assert replica.view().to_dict() == {
+            "a": [1, 2, 3],
+            "b": [1.5, None, 3.5],
+            "c": [None, "y", "z"]
+        }
+
+    def test_replication_remove(self):
+        tbl = Table({"a": [1, 2, 3], "b": ["x", "y", "z"]}, index="a")
+        replica, batches = replicate(tbl)
+        tbl.remove([1, 3])
+        tbl.size()
+        sync(replica, batches)
+        assert replica.view().to_dict() == {"a": [2], "b": ["y"]}
+
+    def test_replication_clear(self):
+        tbl = Table({"a": [1, 2, 3], "b": ["x", "y", "z"]}, index="a")
+        replica, batches = replicate(tbl)
+        tbl.update({"a": [4], "b": ["w"]})
+        tbl.clear()
+        tbl.update({"a": [5], "b": ["v"]})
+        tbl.size()
+        sync(replica, batches)
+        assert replica.view().to_dict() == {"a": [5], "b": ["v"]}
+
+    def test_replication_implicit_index(self):
+        tbl = Table({"a": [1, 2]})
+        replica, batches = replicate(tbl)
+        tbl.update({"a": [3, 4]})
+        tbl.size()
+        sync(replica, batches)
+        assert replica.view().to_dict() == tbl.view().to_dict()
+
+    def test_replication_limit(self):
+        tbl = Table({"a": [1, 2]}, limit=3)
+        replica, batches = replicate(tbl)
+        tbl.update({"a": [3, 4]})
+        tbl.size()
+        sync(replica, batches)
+        assert replica._limit == 3
+        assert replica.view().to_dict() == tbl.view().to_dict()
+
+    def test_replication_notifies_replica_views(self):
+        tbl = Table({"a": [1, 2], "b": [1.5, 2.5]}, index="a")
+        replica, batches = replicate(tbl)
+        view = replica.view(row_pivots=["a"], columns=["b"])
+        updates = []
+        view.on_update(lambda port_id: updates.append(port_id))
+        tbl.update({"a": [1], "b": [10.5]})
+        tbl.size()
+        sync(replica, batches)
+        replica.size()
+        assert len(updates) == 1
+        assert view.to_dict()["b"] == [13, 10.5, 2.5]
+
+    def test_replication_several_subscribers(self):
+        tbl = Table({"a": [1, 2], "b": ["x", "y"]}, index="a")
+        first, first_batches = replicate(tbl)
+        tbl.update({"a": [3], "b": ["z"]})
+        tbl.size()
+        second, second_batches = replicate(tbl)
+        tbl.update({"a": [1], "b": ["xx"]})
+        tbl.size()
+        sync(first, first_batches)
+        sync(second, second_batches)
+        assert rows(first) == rows(tbl)
+        assert rows(second) == rows(tbl)
+
+    def test_replication_different_schema(self):
+        tbl = Table({"a": [1, 2]})
+        other = Table({"b": ["x"]})
+        _, batches = replicate(tbl)
+        tbl.update({"a": [3]})
+        tbl.size()
+        with raises(PerspectiveCppError):
+            other.apply(batches[0])
+
+    def test_replication_invalid_batch(self):
+        with raises(PerspectiveCppError):
+            Table.from_replication(b"not a batch")
@@ -0,0 +1,126 @@
+################################################################################
+#
+# Copyright (c) 2019, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+import random
+from functools import cmp_to_key
+from perspective.table import Table
+from perspective.table.libbinding import encode_sort_key, cmp_sort_values
+
+NAN = float("nan")
+
+VALUES = [None, True, False, 0, 1, -1, 2 ** 40, -(2 ** 40), 0.0, -0.0, 1.5, -1.5,
+          NAN, float("inf"), float("-inf"), "", "a", "ab", "b", "B", "z"]
+
+
+def random_row(rng, ncols, values):
+    return [rng.choice(values) for _ in range(ncols)]
+
+
+def by_values(orders):
+    def cmp(a, b):
+        if cmp_sort_values(a[0], a[1], b[0], b[1], orders):
+            return -1
+        if cmp_sort_values(b[0], b[1], a[0], a[1], orders):
+            return 1
+        return 0
+    return cmp_to_key(cmp)
+
+
+def by_key(orders):
+    return lambda elem: encode_sort_key(elem[0], elem[1], orders)
+
+
+class TestSortKey(object):
+
+    def check_orders_agree(self, elems, orders):
+        for a in elems:
+            for b in elems:
+                a_key = encode_sort_key(a[0], a[1], orders)
+                b_key = encode_sort_key(b[0], b[1], orders)
+                assert (a_key < b_key) == cmp_sort_values(a[0], a[1], b[0], b[1], orders), \
+                    "{0} {1} {2}".format(a, b, orders)
+
+    def test_sort_key_matches_values_mixed_types(self):
+        rng = random.Random(3)
+        for orders in (["asc"], ["desc"], ["asc", "desc"], ["desc", "asc", "asc"]):
+            elems = [(random_row(rng, len(orders), VALUES), idx) for idx in range(60)]
+            self.check_orders_agree(elems, orders)
+
+    def test_sort_key_matches_values_none_and_nan(self):
+        rng = random.Random(5)
+        values = [None, NAN, 0.0, -0.0, 1.0, -1.0]
+        for orders in (["asc"], ["desc"], ["asc", "desc"]):
+            elems = [(random_row(rng, len(orders), values), idx) for idx in range(50)]
+            self.check_orders_agree(elems, orders)
+
+    def test_sort_key_sorted_order_matches_values(self):
+        rng = random.Random(11)
+        for orders in (["asc", "desc"], ["desc", "desc"]):
+            elems = [(random_row(rng, 2, VALUES), idx) for idx in range(500)]
+            assert sorted(elems, key=by_key(orders)) == sorted(elems, key=by_values(orders))
+
+    def test_sort_key_nan_placement(self):
+        elems = [([1.0], 0), ([NAN], 1), ([-1.0], 2)]
+        assert [e[1] for e in sorted(elems, key=by_key(["asc"]))] == [1, 2, 0]
+        assert [e[1] for e in sorted(elems, key=by_key(["desc"]))] == [0, 2, 1]
+
+    def test_sort_key_signed_zero_ties_on_next_column(self):
+        orders = ["asc", "asc"]
+        assert cmp_sort_values([-0.0, 1], 0, [0.0, 2], 1, orders)
+        assert not cmp_sort_values([0.0, 2], 0, [-0.0, 1], 1, orders)
+        assert encode_sort_key([-0.0, 1], 0, orders) < encode_sort_key([0.0, 2], 1, orders)
+
+    def test_sort_key_pkey_breaks_ties(self):
+        orders = ["desc"]
+        assert cmp_sort_values([1.0], 1, [1.0], 2, orders)
+        assert encode_sort_key([1.0], 1, orders) < encode_sort_key([1.0], 2, orders)
+
+    def test_view_sort_with_nan_and_none(self):
+        rng = random.Random(13)
+        n = 300
+        data = {
+            "a": [rng.choice([None, NAN, -0.0, 0.0, 1.5, -2.5]) for _ in range(n)],
+            "b": [rng.choice([None, "x", "y"]) for _ in range(n)],
+            "i": list(range(n))
+        }
+        tbl = Table(data, index="i")
+        for sort in ([["a", "asc"]], [["a", "desc"], ["b", "asc"]]):
+            rows = tbl.view(sort=sort).to_dict()["i"]
+            assert sorted(rows) == list(range(n))
+            assert rows == tbl.view(sort=sort).to_dict()["i"]
+
+    def test_view_sort_through_updates_and_removes(self):
+        rng = random.Random(7)
+        n = 200
+        tbl = Table({"i": int, "x": float, "s": str}, index="i")
+        sorts = ([["x", "asc"]], [["x", "desc"], ["s", "asc"]], [["x", "asc abs"]],
+                 [["s", "desc"], ["x", "asc abs"]])
+        views = [tbl.view(sort=sort) for sort in sorts]
+
+        def check():
+            for sort, view in zip(sorts, views):
+                assert view.to_dict() == tbl.view(sort=sort).to_dict()
+
+        # Enough rounds of rewrites and removes to release and compact the
+        # stored values of each view many times over.
+        for _ in range(10):
+            keys = rng.sample(range(n), n // 2)
+            tbl.update({
+                "i": keys,
+                "x": [rng.choice([None, -2.5, -1.0, 0.0, 1.0, 2.5]) for _ in keys],
+                "s": [rng.choice([None, "a", "b", "c" * 50]) for _ in keys]
+            })
+            check()
+            tbl.remove(rng.sample(range(n), n // 10))
+            check()
+
+        tbl.remove(list(range(n)))
+        tbl.update({"i": [3, 1, 2], "x": [3.0, -1.0, -2.0], "s": ["c", "a", "b"]})
+        check()
+        assert views[0].to_dict()["i"] == [2, 1, 3]
+        assert views[2].to_dict()["i"] == [1, 2, 3]
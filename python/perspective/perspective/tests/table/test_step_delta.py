@@ -0,0 +1,62 @@
+################################################################################
+#
+# Copyright (c) 2019, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+from perspective.table import Table
+
+
+def cells(view):
+    delta = view._view.get_step_delta(0, 1000)
+    return [(cell.row, cell.column, cell.new_value.to_string()) for cell in delta.cells]
+
+
+def delta_view(tbl, **config):
+    view = tbl.view(**config)
+    view._view._set_deltas_enabled(True)
+    return view
+
+
+class TestStepDelta(object):
+
+    def test_step_delta_changed_cells(self):
+        tbl = Table({"i": [1, 2, 3], "x": [1, 2, 3], "s": ["a", "b", "c"]}, index="i")
+        view = delta_view(tbl)
+        tbl.update({"i": [3, 1, 2], "x": [30, 10, 2], "s": ["c", "a", "bb"]})
+        tbl.size()
+        assert cells(view) == [(0, 1, "10"), (1, 2, "bb"), (2, 1, "30")]
+
+        # Reading the delta clears it.
+        assert cells(view) == []
+
+    def test_step_delta_cleared_each_step(self):
+        tbl = Table({"i": [1, 2, 3], "x": [1, 2, 3]}, index="i")
+        view = delta_view(tbl)
+        tbl.update({"i": [1], "x": [10]})
+        tbl.size()
+        tbl.update({"i": [2], "x": [20]})
+        tbl.size()
+        assert cells(view) == [(1, 1, "20")]
+
+        # A steady stream of updates reuses the same storage.
+        for value in range(100):
+            tbl.update({"i": [3], "x": [value]})
+            tbl.size()
+        assert cells(view) == [(2, 1, "99")]
+
+    def test_step_delta_sorted(self):
+        tbl = Table({"i": [1, 2, 3], "x": [3, 2, 1]}, index="i")
+        view = delta_view(tbl, sort=[["x", "asc"]])
+        tbl.update({"i": [1, 2, 4], "x": [0, 2, 5]})
+        tbl.size()
+        delta = view._view.get_step_delta(0, 1000)
+        assert delta.rows_changed
+        found = sorted((cell.row, cell.column, cell.new_value.to_string())
+                       for cell in delta.cells)
+        assert (0, 1, "0") in found
+        assert (3, 0, "4") in found
+        assert (3, 1, "5") in found
+        assert all(cell[0] != 2 for cell in found)
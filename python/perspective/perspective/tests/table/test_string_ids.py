@@ -0,0 +1,57 @@
+################################################################################
+#
+# Copyright (c) 2019, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+from perspective.table import Table
+
+# More distinct strings than 16-bit vocabulary ids can hold.
+N = 70000
+
+
+def values(n=N, prefix="s"):
+    return ["{0}{1:06d}".format(prefix, i) for i in range(n)]
+
+
+class TestStringIds(object):
+
+    def test_string_ids_past_16_bits(self):
+        data = {"a": values(), "b": list(range(N))}
+        tbl = Table(data)
+        view = tbl.view()
+        assert view.to_dict() == data
+        assert tbl.view(filter=[["a", "==", "s069999"]]).to_dict() == {
+            "a": ["s069999"], "b": [N - 1]}
+        assert tbl.view(filter=[["a", "in", ["s000001", "s065537"]]]).to_dict()["b"] == \
+            [1, 65537]
+
+    def test_string_ids_sorted(self):
+        data = {"a": list(reversed(values())), "b": list(range(N))}
+        tbl = Table(data)
+        rows = tbl.view(sort=[["a", "asc"]]).to_dict()
+        assert rows["a"] == values()
+        assert rows["b"] == list(reversed(range(N)))
+
+    def test_string_ids_index_updates(self):
+        tbl = Table({"a": values(), "b": [0] * N}, index="a")
+        tbl.update({"a": ["s065536", "s069999", "t"], "b": [1, 2, 3]})
+        tbl.remove(["s000000"])
+        assert tbl.size() == N
+        rows = tbl.view(filter=[["b", ">", 0]]).to_dict()
+        assert rows == {"a": ["s065536", "s069999", "t"], "b": [1, 2, 3]}
+
+    def test_string_ids_arrow_round_trip(self):
+        data = {"a": values(), "b": list(range(N))}
+        arrow = Table(data).view().to_arrow()
+        assert Table(arrow).view().to_dict() == data
+
+    def test_string_ids_snapshot_round_trip(self, tmpdir):
+        data = {"a": values(), "b": list(range(N))}
+        path = str(tmpdir.join("snapshot"))
+        Table(data).save_snapshot(path)
+        tbl = Table({"a": str, "b": int})
+        tbl.load_snapshot(path)
+        assert tbl.view().to_dict() == data
@@ -8,7 +8,7 @@
 #
 import six
 import sys
-from datetime import date, datetime
+from datetime import date, datetime, timedelta
 from pytest import raises
 from perspective.table import Table
 from perspective.core.exception import PerspectiveError
@@ -229,6 +229,39 @@ class TestTable(object):
         }
         assert tbl.view().to_records() == [{"a": 1.5, "b": 2.5}, {"a": 3.2, "b": None}]
 
+    def test_table_records_homogeneous(self):
+        data = [{"a": i, "b": i * 0.5, "c": str(i), "d": i % 2 == 0} for i in range(1000)]
+        data[10]["a"] = None
+        data[20]["b"] = float("nan")
+        del data[30]["c"]
+        tbl = Table(data)
+        assert tbl.schema() == {
+            "a": int,
+            "b": float,
+            "c": str,
+            "d": bool
+        }
+        records = tbl.view().to_records()
+        assert records[10]["a"] is None
+        assert records[20]["b"] is None
+        assert records[30]["c"] is None
+        assert records[999] == {"a": 999, "b": 499.5, "c": "999", "d": False}
+
+    def test_table_columnar_mixed_types(self):
+        class Float(object):
+            def __float__(self):
+                return 2.5
+
+        tbl = Table({"a": [1.5, 2, Float(), None], "b": [1, 2.7, 3, 4]})
+        assert tbl.schema() == {
+            "a": float,
+            "b": int
+        }
+        assert tbl.view().to_dict() == {
+            "a": [1.5, 2.0, 2.5, None],
+            "b": [1, 2, 3, 4]
+        }
+
     # schema
 
     def test_table_schema(self):
@@ -556,6 +589,18 @@ class TestTable(object):
             {"a": 3, "b": 4}
         ]
 
+    def test_table_limit_wraps_within_update(self):
+        tbl = Table({"a": int}, limit=5)
+        view = tbl.view(columns=["a"], aggregates={"a": "sum"}, row_pivots=["a"])
+        tbl.update({"a": [0, 1, 2]})
+        tbl.update({"a": [3, 4, 5, 6]})
+        assert tbl.size() == 5
+        assert tbl.view().to_dict() == {"a": [5, 6, 2, 3, 4]}
+        tbl.update({"a": [7, 8, 9, 10, 11, 12]})
+        assert tbl.size() == 5
+        assert tbl.view().to_dict() == {"a": [10, 11, 12, 8, 9]}
+        assert view.to_dict()["a"][0] == 50
+
     # clear
 
     def test_table_clear(self):
@@ -573,3 +618,371 @@ class TestTable(object):
         tbl = Table(data)
         tbl.replace(data2)
         assert tbl.view().to_records() == data2
+
+    # snapshot
+
+    def test_table_snapshot_indexed(self, tmpdir):
+        data = {"a": [1, 2, 3], "b": ["x", "y", None], "c": [1.5, None, 3.5]}
+        tbl = Table(data, index="a")
+        tbl.remove([2])
+        path = str(tmpdir.join("snapshot"))
+        tbl.save_snapshot(path)
+
+        tbl2 = Table(tbl.schema(), index="a")
+        tbl2.load_snapshot(path)
+        assert tbl2.size() == 2
+        assert tbl2.view().to_dict() == tbl.view().to_dict()
+
+        tbl2.update([{"a": 3, "b": "z"}, {"a": 4, "b": "w", "c": 4.5}])
+        tbl2.remove([1])
+        assert tbl2.view().to_dict() == {
+            "a": [3, 4],
+            "b": ["z", "w"],
+            "c": [3.5, 4.5]
+        }
+
+    def test_table_snapshot_unindexed(self, tmpdir):
+        tbl = Table([{"a": 1, "b": "x"}, {"a": 2, "b": "y"}])
+        path = str(tmpdir.join("snapshot"))
+        tbl.save_snapshot(path)
+
+        tbl2 = Table(tbl.schema())
+        tbl2.load_snapshot(path)
+        tbl2.update([{"a": 3, "b": "z"}])
+        assert tbl2.view().to_dict() == {"a": [1, 2, 3], "b": ["x", "y", "z"]}
+
+    def test_table_snapshot_save_over_loaded_snapshot(self, tmpdir):
+        data = {"a": [1, 2, 3], "b": ["x", "y", None]}
+        path = str(tmpdir.join("snapshot"))
+        Table(data, index="a").save_snapshot(path)
+
+        tbl = Table({"a": int, "b": str}, index="a")
+        tbl.load_snapshot(path)
+        tbl.save_snapshot(path)
+        assert tbl.view().to_dict() == data
+
+        tbl2 = Table({"a": int, "b": str}, index="a")
+        tbl2.load_snapshot(path)
+        assert tbl2.view().to_dict() == data
+
+    def test_table_snapshot_update_leaves_files(self, tmpdir):
+        data = {"a": [1, 2, 3], "b": ["x", "y", "z"]}
+        path = str(tmpdir.join("snapshot"))
+        Table(data, index="a").save_snapshot(path)
+
+        tbl = Table({"a": int, "b": str}, index="a")
+        tbl.load_snapshot(path)
+        tbl.update([{"a": 1, "b": "w"}, {"a": 4, "b": "v"}])
+        assert tbl.view().to_dict() == {"a": [1, 2, 3, 4], "b": ["w", "y", "z", "v"]}
+
+        tbl2 = Table({"a": int, "b": str}, index="a")
+        tbl2.load_snapshot(path)
+        assert tbl2.view().to_dict() == data
+
+    def test_table_snapshot_load_with_views(self, tmpdir):
+        tbl = Table({"a": [1, 2, 3]})
+        path = str(tmpdir.join("snapshot"))
+        tbl.save_snapshot(path)
+
+        tbl2 = Table(tbl.schema())
+        tbl2.view()
+        with raises(PerspectiveError):
+            tbl2.load_snapshot(path)
+
+    # update log
+
+    def test_table_recover_from_log(self, tmpdir):
+        path = str(tmpdir.join("log"))
+        tbl = Table({"a": [1, 2, 3], "b": ["x", "y", None]}, index="a")
+        tbl.enable_log(path)
+        tbl.update([{"a": 2, "b": "z"}, {"a": 4, "b": "w"}])
+        tbl.remove([1])
+        tbl.flush_log()
+
+        tbl2 = Table(tbl.schema(), index="a")
+        tbl2.recover(path)
+        assert tbl2.view().to_dict() == tbl.view().to_dict()
+
+        # Later updates are logged, after the recovered ones.
+        tbl2.update([{"a": 5, "b": "v"}])
+        tbl2.flush_log()
+        tbl3 = Table(tbl.schema(), index="a")
+        tbl3.recover(path)
+        assert tbl3.view().to_dict() == {
+            "a": [2, 3, 4, 5],
+            "b": ["z", None, "w", "v"]
+        }
+
+    def test_table_recover_onto_logged_ports(self, tmpdir):
+        path = str(tmpdir.join("log"))
+        tbl = Table({"a": [1, 2, 3], "b": ["x", "y", None]}, index="a")
+        tbl.enable_log(path)
+        port = tbl.make_port()
+        tbl.update([{"a": 2, "b": "z"}], port_id=port)
+        tbl.update([{"a": 4, "b": "w"}])
+        tbl.flush_log()
+
+        tbl2 = Table(tbl.schema(), index="a")
+        tbl2.recover(path)
+        assert tbl2.view().to_dict() == tbl.view().to_dict()
+
+        # The replayed port exists, and new ports are numbered after it.
+        tbl2.update([{"a": 5, "b": "v"}], port_id=port)
+        assert tbl2.make_port() == port + 1
+        assert tbl2.view().to_dict() == {
+            "a": [1, 2, 3, 4, 5],
+            "b": ["x", "z", None, "w", "v"]
+        }
+
+    def test_table_recover_from_checkpoint(self, tmpdir):
+        path = str(tmpdir.join("log"))
+        tbl = Table([{"a": 1, "b": "x"}])
+        tbl.enable_log(path, checkpoint_every=2)
+        for i in range(2, 6):
+            tbl.update([{"a": i, "b": str(i)}])
+        tbl.flush_log()
+
+        tbl2 = Table(tbl.schema())
+        tbl2.recover(path)
+        tbl2.update([{"a": 6, "b": "6"}])
+        assert tbl2.view().to_dict() == {
+            "a": [1, 2, 3, 4, 5, 6],
+            "b": ["x", "2", "3", "4", "5", "6"]
+        }
+
+    def test_table_recover_after_clear(self, tmpdir):
+        path = str(tmpdir.join("log"))
+        tbl = Table({"a": [1, 2]})
+        tbl.enable_log(path)
+        tbl.update({"a": [3]})
+        tbl.clear()
+        tbl.update({"a": [4]})
+        tbl.flush_log()
+
+        tbl2 = Table(tbl.schema())
+        tbl2.recover(path)
+        assert tbl2.view().to_dict() == {"a": [4]}
+
+    def test_table_recover_with_views(self, tmpdir):
+        path = str(tmpdir.join("log"))
+        tbl = Table({"a": [1, 2, 3]})
+        tbl.enable_log(path)
+
+        tbl2 = Table(tbl.schema())
+        tbl2.view()
+        with raises(PerspectiveError):
+            tbl2.recover(path)
+
+    # share_dictionary
+
+    def test_table_share_dictionary(self):
+        tbl = Table({"a": [1, 2, 3], "b": ["x", "y", None]}, index="a")
+        tbl2 = Table({"c": ["z", "x"], "d": [1, 2]})
+        view2 = tbl2.view(row_pivots=["c"])
+        tbl2.share_dictionary("c", tbl, "b")
+
+        tbl.update([{"a": 4, "b": "w"}, {"a": 1, "b": "z"}])
+        tbl2.update({"c": ["y", "w", None], "d": [3, 4, 5]})
+        tbl.remove([2])
+
+        assert tbl.view().to_dict() == {"a": [1, 3, 4], "b": ["z", None, "w"]}
+        assert tbl2.view().to_dict() == {
+            "c": ["z", "x", "y", "w", None],
+            "d": [1, 2, 3, 4, 5]
+        }
+        assert view2.num_rows() == 6
+        assert view2.to_dict()["d"][0] == 15
+
+    def test_table_share_dictionary_not_string(self):
+        tbl = Table({"a": [1, 2, 3], "b": ["x", "y", "z"]})
+        tbl2 = Table({"c": ["x"]})
+        with raises(PerspectiveError):
+            tbl2.share_dictionary("c", tbl, "a")
+
+    # create_index
+
+    def test_table_create_index(self):
+        tbl = Table({
+            "a": [1, 2, 3, 4, 5],
+            "b": ["x", "y", "x", "z", None],
+            "c": [1.5, 2.5, 3.5, 4.5, 5.5]
+        }, index="a")
+        tbl.create_index("b")
+        assert tbl.get_memory_usage()["indexes"] == 0
+
+        view = tbl.view(filter=[["b", "==", "x"]])
+        assert view.to_dict() == {"a": [1, 3], "b": ["x", "x"], "c": [1.5, 3.5]}
+        assert tbl.get_memory_usage()["indexes"] > 0
+
+        tbl.update([{"a": 2, "b": "x"}, {"a": 3, "b": "w"}, {"a": 6, "b": "x", "c": 6.5}])
+        tbl.remove([1])
+        assert view.to_dict() == {"a": [2, 6], "b": ["x", "x"], "c": [2.5, 6.5]}
+
+        # Views created after the update read the index it maintained.
+        assert tbl.view(filter=[["b", "==", "x"]]).to_dict() == {"a": [2, 6], "b": ["x", "x"], "c": [2.5, 6.5]}
+        assert tbl.view(filter=[["b", "in", ["w", "z"]], ["c", ">", 4]]).to_dict() == {"a": [4], "b": ["z"], "c": [4.5]}
+        assert tbl.view(filter=[["b", "==", "v"]]).num_rows() == 0
+        assert tbl.view(row_pivots=["b"], columns=["c"], filter=[["b", "in", ["x", "z"]]]).to_dict() == {
+            "__ROW_PATH__": [[], ["x"], ["z"]],
+            "c": [13.5, 9.0, 4.5]
+        }
+
+    def test_table_create_index_not_string(self):
+        tbl = Table({"a": [1, 2, 3], "b": ["x", "y", "z"]})
+        with raises(PerspectiveError):
+            tbl.create_index("a")
+
+    def test_table_create_sorted_index(self):
+        tbl = Table({"a": [1, 2, 3, 4], "b": [3.5, 1.5, None, 2.5]}, index="a")
+        tbl.create_sorted_index("b", "desc")
+        view = tbl.view(sort=[["b", "desc"]])
+        assert view.to_dict()["a"] == [1, 4, 2, 3]
+        tbl.update([{"a": 2, "b": 4.5}, {"a": 5, "b": 0.5}, {"a": 3, "b": 3.5}])
+        assert view.to_dict()["a"] == [2, 1, 3, 4, 5]
+        tbl.remove([1])
+        assert view.to_dict()["a"] == [2, 3, 4, 5]
+        assert tbl.view(sort=[["b", "desc"]]).to_dict()["a"] == [2, 3, 4, 5]
+
+    def test_table_create_sorted_index_partial_update(self):
+        tbl = Table({"a": [1, 2, 3], "b": [1.5, 2.5, 3.5], "c": ["x", "y", "z"]}, index="a")
+        tbl.create_sorted_index("b")
+        tbl.update([{"a": 3, "c": "zz"}, {"a": 1, "b": None}])
+        view = tbl.view(sort=[["b", "asc"]], filter=[["c", "!=", "y"]])
+        assert view.to_dict() == {"a": [1, 3], "b": [None, 3.5], "c": ["x", "zz"]}
+
+    def test_table_create_sorted_index_invalid(self):
+        tbl = Table({"a": [1, 2, 3]})
+        with raises(PerspectiveError):
+            tbl.create_sorted_index("b")
+        with raises(PerspectiveError):
+            tbl.create_sorted_index("a", "col asc")
+
+    def test_table_range_filter_zone_maps(self):
+        tbl = Table({
+            "a": list(range(5000)),
+            "t": [datetime(2019, 1, 1) + timedelta(seconds=i) for i in range(5000)],
+            "v": [float(i) for i in range(5000)]
+        }, index="a")
+        view = tbl.view(columns=["a"], filter=[["v", ">=", 4000], ["v", "<", 4003]])
+        assert view.to_dict() == {"a": [4000, 4001, 4002]}
+        assert tbl.get_memory_usage()["indexes"] > 0
+
+        # Rows written out of order widen their blocks, and erased rows are
+        # not read from them.
+        tbl.update([{"a": 5, "v": 4001.5}, {"a": 4001, "v": 1.0}, {"a": 6000, "v": 4002.5}])
+        tbl.remove([4002])
+        assert view.to_dict() == {"a": [5, 4000, 6000]}
+        assert tbl.view(columns=["a"], filter=[["v", ">=", 4000], ["v", "<", 4003]]).to_dict() == {
+            "a": [5, 4000, 6000]
+        }
+        assert tbl.view(columns=["a"], filter=[["v", "==", 1]]).to_dict() == {"a": [1, 4001]}
+
+        start = datetime(2019, 1, 1) + timedelta(seconds=4997)
+        assert tbl.view(columns=["a"], filter=[["t", ">", start]]).to_dict() == {"a": [4998, 4999]}
+
+    def test_table_compact(self):
+        tbl = Table({"a": list(range(100)), "b": [str(i % 7) for i in range(100)]}, index="a")
+        view = tbl.view(filter=[["b", "==", "3"]])
+        tbl.remove(list(range(0, 100, 2)))
+        assert tbl.compact() == 50
+        assert tbl.compact() == 0
+        assert tbl.size() == 50
+
+        tbl.update([{"a": 1, "b": "3"}, {"a": 200, "b": "3"}])
+        expected = [i for i in range(1, 100, 2) if i % 7 == 3 or i == 1] + [200]
+        assert view.to_dict()["a"] == expected
+        assert tbl.view(filter=[["b", "==", "3"]]).to_dict()["a"] == expected
+        assert tbl.view(columns=["a"], filter=[["a", ">", 95]]).to_dict() == {"a": [97, 99, 200]}
+
+    def test_table_compact_after_remove(self):
+        tbl = Table({"a": list(range(4000)), "b": [float(i) for i in range(4000)]}, index="a")
+        view = tbl.view(row_pivots=["a"], columns=["b"], filter=[["b", ">=", 3990]])
+        table_bytes = tbl.get_memory_usage()["table"]
+        tbl.remove(list(range(3000)))
+        assert tbl.size() == 1000
+        assert tbl.get_memory_usage()["table"] < table_bytes / 2
+        assert tbl.compact() == 0
+
+        tbl.update([{"a": 3995, "b": 0.5}, {"a": 5000, "b": 5000.0}])
+        assert view.to_dict()["__ROW_PATH__"] == [[]] + [[i] for i in range(3990, 4000) if i != 3995] + [[5000]]
+        assert tbl.view(filter=[["b", "<", 3001]]).to_dict() == {"a": [3000, 3995], "b": [3000.0, 0.5]}
+
+    def test_table_spill_cold_columns(self, tmp_path):
+        data = {"a": list(range(1000)), "b": [float(i) for i in range(1000)], "c": [i * 2.0 for i in range(1000)]}
+        tbl = Table(data, index="a")
+        view = tbl.view(columns=["b"])
+        table_bytes = tbl.get_memory_usage()["table"]
+        tbl.set_column_spill(str(tmp_path), idle=0)
+        assert tbl.spill_cold_columns() == 2
+        assert tbl.spill_cold_columns() == 0
+        assert tbl.get_memory_usage()["table"] < table_bytes
+        assert len(list(tmp_path.iterdir())) > 0
+
+        # read back from the spilled files, then reloaded by the view
+        assert tbl.view(columns=["c"]).to_dict()["c"] == data["c"]
+        tbl.update([{"a": 1, "b": 0.5, "c": 0.5}])
+        assert view.to_dict()["b"][:3] == [0.0, 0.5, 2.0]
+        assert tbl.view(columns=["a", "c"], filter=[["a", "<", 3]]).to_dict() == {
+            "a": [0, 1, 2],
+            "c": [0.0, 0.5, 4.0]
+        }
+
+        tbl.set_column_spill(None)
+        assert tbl.spill_cold_columns() == 0
+        assert tbl.view(columns=["c"]).to_dict()["c"][1] == 0.5
+
+    def test_table_spill_waits_for_idle(self, tmp_path):
+        tbl = Table({"a": [1, 2, 3], "b": [1.5, 2.5, 3.5]})
+        tbl.set_column_spill(str(tmp_path), idle=3600)
+        assert tbl.spill_cold_columns() == 0
+        assert tbl.view().to_dict() == {"a": [1, 2, 3], "b": [1.5, 2.5, 3.5]}
+
+    def test_table_pack_cold_columns(self):
+        data = {
+            "a": list(range(1000)),
+            "b": [i % 4 for i in range(1000)],
+            "c": [i * 0.5 for i in range(1000)],
+            "d": [i % 3 == 0 for i in range(1000)]
+        }
+        tbl = Table(data, index="a")
+        unpacked = Table(data, index="a")
+        config = {"group_by": ["b"], "columns": ["a", "d"], "aggregates": {"a": "sum", "d": "count"}}
+        view = tbl.view(**config)
+        table_bytes = tbl.get_memory_usage()["table"]
+        tbl.set_column_packing(idle=0)
+
+        # the float column is not packed
+        assert tbl.pack_cold_columns() == 3
+        assert tbl.pack_cold_columns() == 0
+        assert tbl.get_memory_usage()["table"] < table_bytes
+        assert tbl.view().to_dict() == data
+        assert tbl.view(**config).to_dict() == unpacked.view(**config).to_dict()
+
+        update = [{"a": 1, "b": 3}, {"a": 1000, "b": None, "c": 1.0, "d": True}, {"a": 2, "b": None}]
+        tbl.update(update)
+        unpacked.update(update)
+        assert view.to_dict() == unpacked.view(**config).to_dict()
+        assert tbl.view().to_dict() == unpacked.view().to_dict()
+        assert tbl.view(filter=[["b", "is null"]]).to_dict()["a"] == [2, 1000]
+
+        tbl.set_column_packing(None)
+        assert tbl.pack_cold_columns() == 0
+        assert tbl.view().to_dict() == unpacked.view().to_dict()
+
+    def test_table_pack_waits_for_idle(self):
+        tbl = Table({"a": [1, 2, 3], "b": [True, False, True]})
+        tbl.set_column_packing(idle=3600)
+        assert tbl.pack_cold_columns() == 0
+        assert tbl.view().to_dict() == {"a": [1, 2, 3], "b": [True, False, True]}
+
+    def test_table_get_memory_usage(self):
+        tbl = Table({"a": [1, 2, 3], "b": ["x", "y", "z"]}, index="a")
+        usage = tbl.get_memory_usage()
+        assert sorted(usage.keys()) == [
+            "indexes", "input_ports", "output_ports", "primary_keys", "table", "vocabularies"]
+        assert usage["table"] > 0
+        assert usage["vocabularies"] > 0
+        assert usage["primary_keys"] > 0
+
+        tbl.update({"a": list(range(4, 10000)), "b": ["x"] * 9996})
+        assert tbl.get_memory_usage()["table"] > usage["table"]
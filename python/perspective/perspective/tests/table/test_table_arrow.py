@@ -6,11 +6,13 @@
 # the Apache License 2.0.  The full license can be found in the LICENSE file.
 #
 
+import gc
 import os.path
 import numpy as np
 import pandas as pd
 import pyarrow as pa
 from datetime import date, datetime
+from decimal import Decimal
 from perspective.table import Table
 
 SUPERSTORE_ARROW = os.path.join(os.path.dirname(__file__), "..", "..", "..", "..", "..", "examples", "simple", "superstore.arrow")
@@ -119,6 +121,57 @@ class TestTableArrow(object):
             "b": data[1]
         }
 
+    def test_table_arrow_loads_fixed_width_stream_with_nulls_and_index(self, util):
+        data = [
+            [i for i in range(10)],
+            [i * 1.5 if i % 3 else None for i in range(10)]
+        ]
+        arrow_data = util.make_arrow(["a", "b"], data, types=[pa.int64(), pa.float64()])
+        tbl = Table(arrow_data, index="a")
+        tbl.update({"a": [3], "b": [100.5]})
+        assert tbl.size() == 10
+        expected = list(data[1])
+        expected[3] = 100.5
+        assert tbl.view().to_dict() == {
+            "a": data[0],
+            "b": expected
+        }
+
+    def test_table_arrow_loads_chunked_stream_with_nulls(self):
+        data = [i * 1.5 if i % 3 else None for i in range(21)]
+        batches = [
+            pa.RecordBatch.from_arrays([pa.array(data[i:i + 5], type=pa.float64())], ["a"])
+            for i in range(0, 21, 5)
+        ]
+        stream = pa.BufferOutputStream()
+        writer = pa.RecordBatchStreamWriter(stream, batches[0].schema)
+        for batch in batches:
+            writer.write_batch(batch)
+        writer.close()
+        tbl = Table(stream.getvalue().to_pybytes())
+        assert tbl.size() == 21
+        assert tbl.view().to_dict() == {
+            "a": data
+        }
+
+    def test_table_arrow_borrowed_columns_outlive_source(self, util):
+        data = [
+            [i for i in range(100)],
+            [i * 0.5 for i in range(100)]
+        ]
+        arrow_data = util.make_arrow(["a", "b"], data, types=[pa.int64(), pa.float64()])
+        tbl = Table(arrow_data)
+        del arrow_data
+        gc.collect()
+
+        # Loading more arrows reuses the freed heap, which borrowed columns
+        # would read if they were not keeping their source alive.
+        others = [Table(util.make_arrow(["a", "b"], [[-1] * 100, [-1.5] * 100],
+                                        types=[pa.int64(), pa.float64()]))
+                  for _ in range(10)]
+        assert tbl.view().to_dict() == {"a": data[0], "b": data[1]}
+        assert others[0].size() == 100
+
     def test_table_arrow_loads_decimal_stream(self, util):
         data = [
             [i * 1000 for i in range(10)]
@@ -133,6 +186,38 @@ class TestTableArrow(object):
             "a": data[0]
         }
 
+    def test_table_arrow_loads_decimal_scale_stream(self, util):
+        data = [
+            [Decimal("1.10"), Decimal("2.20"), Decimal("0.05"), None]
+        ]
+        arrow_data = util.make_arrow(["a"], data, types=[pa.decimal128(10, 2)])
+        tbl = Table(arrow_data)
+        assert tbl.column_scales() == {"a": 2}
+        view = tbl.view()
+        assert view.schema() == {
+            "a": float
+        }
+        assert view.to_dict() == {
+            "a": [1.1, 2.2, 0.05, None]
+        }
+
+    def test_table_arrow_decimal_scale_aggregates(self, util):
+        data = [
+            ["x", "x", "y"],
+            [Decimal("0.10"), Decimal("0.20"), Decimal("0.05")]
+        ]
+        arrow_data = util.make_arrow(["k", "a"], data, types=[pa.string(), pa.decimal128(10, 2)])
+        tbl = Table(arrow_data)
+        view = tbl.view(row_pivots=["k"], columns=["a"], aggregates={"a": "sum"})
+        assert view.to_dict() == {
+            "__ROW_PATH__": [[], ["x"], ["y"]],
+            "a": [0.35, 0.3, 0.05]
+        }
+        assert tbl.view(filter=[["a", ">", 0.1]]).to_dict() == {
+            "k": ["x"],
+            "a": [0.2]
+        }
+
     def test_table_arrow_loads_bool_stream(self, util):
         data = [
             [True if i % 2 == 0 else False for i in range(10)]
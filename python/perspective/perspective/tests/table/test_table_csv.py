@@ -0,0 +1,90 @@
+# *****************************************************************************
+#
+# Copyright (c) 2019, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+from datetime import date, datetime
+from dateutil import tz
+from perspective.table import Table
+
+
+def _utc_to_local(*args):
+    return datetime(*args, tzinfo=tz.UTC).astimezone(tz.tzlocal()).replace(tzinfo=None)
+
+
+class TestTableCSV(object):
+
+    def test_table_csv_infers_types(self):
+        csv = "a,b,c,d,e,f\n1,1.5,x,true,2019-01-01,2019-01-01 10:30:00\n2,2,y,false,2019-01-02,2019-01-02\n"
+        tbl = Table(csv)
+        assert tbl.size() == 2
+        assert tbl.schema() == {
+            "a": int,
+            "b": float,
+            "c": str,
+            "d": bool,
+            "e": date,
+            "f": datetime
+        }
+        assert tbl.view().to_dict() == {
+            "a": [1, 2],
+            "b": [1.5, 2.0],
+            "c": ["x", "y"],
+            "d": [True, False],
+            "e": [datetime(2019, 1, 1), datetime(2019, 1, 2)],
+            "f": [datetime(2019, 1, 1, 10, 30), datetime(2019, 1, 2)]
+        }
+
+    def test_table_csv_datetime_utc_offsets(self):
+        csv = "a\n2019-01-01T10:30:00Z\n2019-01-01T10:30:00+02:00\n2019-01-01T10:30:00-05:30\n"
+        tbl = Table(csv)
+        assert tbl.schema() == {"a": datetime}
+        assert tbl.view().to_dict() == {
+            "a": [
+                _utc_to_local(2019, 1, 1, 10, 30),
+                _utc_to_local(2019, 1, 1, 8, 30),
+                _utc_to_local(2019, 1, 1, 16, 0)
+            ]
+        }
+
+    def test_table_csv_datetime_mixed_layouts(self):
+        # The first value sets the column's layout, and values in other
+        # formats are still parsed.
+        csv = "a\n2019-01-01 10:30:00\n2019-01-02T11:00:00.250\n2019-01-03\n01/04/2019\n"
+        tbl = Table(csv)
+        assert tbl.schema() == {"a": datetime}
+        assert tbl.view().to_dict() == {
+            "a": [
+                datetime(2019, 1, 1, 10, 30),
+                datetime(2019, 1, 2, 11, 0, 0, 250000),
+                datetime(2019, 1, 3),
+                datetime(2019, 1, 4)
+            ]
+        }
+
+    def test_table_csv_quoted_and_null(self):
+        csv = 'a,b\r\n"x, ""y""",1\r\n"multi\nline",\r\n,3\r\n'
+        tbl = Table(csv)
+        assert tbl.view().to_dict() == {
+            "a": ['x, "y"', "multi\nline", None],
+            "b": [1, None, 3]
+        }
+
+    def test_table_csv_index_update(self):
+        tbl = Table("a,b\n1,x\n2,y\n", index="a")
+        tbl.update("a,b\n2,z\n3,w\n")
+        assert tbl.view().to_dict() == {
+            "a": [1, 2, 3],
+            "b": ["x", "z", "w"]
+        }
+
+    def test_table_csv_update_from_schema(self):
+        tbl = Table({"a": int, "b": str})
+        tbl.update("b,a\nx,1\ny,\n")
+        assert tbl.view().to_dict() == {
+            "a": [1, None],
+            "b": ["x", "y"]
+        }
@@ -261,6 +261,29 @@ if os.name != 'nt':
                 "a": [d.astimezone(PST).replace(tzinfo=None) for d in data["a"]]
             }
 
+        def test_table_should_convert_UTC_to_local_time_iso_strings(self):
+            """ISO 8601 strings with a `Z` suffix or a UTC offset are read as
+            UTC, and ISO 8601 strings without one as local time."""
+            table = Table({"a": datetime})
+            table.update({
+                "a": [
+                    "2019-01-11T00:10:20Z",
+                    "2019-01-11T19:10:20.500+09:00",
+                    "2019-01-11 11:10:20",
+                    "01/11/2019 11:10:20"
+                ]
+            })
+
+            os.environ["TZ"] = "US/Pacific"
+            time.tzset()
+
+            assert table.view().to_dict()["a"] == [
+                UTC.localize(datetime(2019, 1, 11, 0, 10, 20)).astimezone(PST).replace(tzinfo=None),
+                UTC.localize(datetime(2019, 1, 11, 10, 10, 20, 500000)).astimezone(PST).replace(tzinfo=None),
+                datetime(2019, 1, 11, 3, 10, 20),
+                datetime(2019, 1, 11, 3, 10, 20)
+            ]
+
         def test_table_should_convert_UTC_to_local_time_pytz_central(self):
             data = {
                 "a": UTC_DATETIMES
@@ -409,6 +409,44 @@ class TestTableNumpy(object):
             ]
         }
 
+    def test_table_np_datetime_D_before_epoch(self):
+        tbl = Table({
+            "a": np.array([
+                datetime(1900, 2, 28),
+                datetime(1965, 3, 1),
+                datetime(2000, 2, 29),
+                np.datetime64("nat")],
+                dtype="datetime64[D]")
+        })
+
+        assert tbl.view().to_dict() == {
+            "a": [
+                datetime(1900, 2, 28, 0, 0),
+                datetime(1965, 3, 1, 0, 0),
+                datetime(2000, 2, 29, 0, 0),
+                None
+            ]
+        }
+
+    def test_table_np_datetime_ns_update_date(self):
+        tbl = Table({
+            "a": date
+        })
+
+        tbl.update({
+            "a": np.array([
+                datetime(1969, 12, 31, 23, 59),
+                datetime(2019, 7, 12, 11, 0)],
+                dtype="datetime64[ns]")
+        })
+
+        assert tbl.view().to_dict() == {
+            "a": [
+                datetime(1969, 12, 31, 0, 0),
+                datetime(2019, 7, 12, 0, 0)
+            ]
+        }
+
     def test_table_np_datetime_ms_nat(self):
         tbl = Table({
             "a": np.array([datetime(2019, 7, 12, 11, 0), np.datetime64("nat")], dtype="datetime64[ms]")
@@ -1038,3 +1076,23 @@ class TestTableNumpy(object):
             "x": ["string1", "string3"],
             "y": ["string2", "string4"]
         }
+
+    def test_table_numpy_strided(self):
+        data = np.arange(12, dtype=np.float64).reshape(4, 3)
+        table = Table({
+            "a": data[:, 0],
+            "b": data[::2, 1].repeat(2)
+        })
+        assert table.view().to_dict() == {
+            "a": [0, 3, 6, 9],
+            "b": [1, 1, 7, 7]
+        }
+
+    def test_table_numpy_borrowed_array_unchanged(self):
+        data = np.array([1.5, 2.5, 3.5])
+        table = Table({"a": data})
+        table.update({"a": np.array([4.5])})
+        assert data.tolist() == [1.5, 2.5, 3.5]
+        assert table.view().to_dict() == {
+            "a": [1.5, 2.5, 3.5, 4.5]
+        }
@@ -437,6 +437,43 @@ class TestTablePandas(object):
         table = Table(df)
         assert table.view().to_dict()["a"] == data
 
+    def test_table_pandas_tz_aware_datetime(self):
+        utc = pd.date_range("2019-01-01", periods=3, freq="H")
+        aware = utc.tz_localize("UTC").tz_convert("US/Eastern")
+        table = Table(pd.DataFrame({"a": aware}))
+        assert table.schema()["a"] == datetime
+        assert table.view().to_dict()["a"] == Table(pd.DataFrame({"a": utc})).view().to_dict()["a"]
+
+    def test_table_pandas_categorical(self):
+        data = ["b", None, "a", "b", "c"]
+        df = pd.DataFrame({
+            "a": pd.Categorical(data, categories=["c", "b", "a"])
+        })
+        table = Table(df)
+        assert table.schema()["a"] == str
+        assert table.view().to_dict()["a"] == data
+
+    def test_table_pandas_categorical_update(self):
+        table = Table({
+            "a": ["x", "a"]
+        })
+        df = pd.DataFrame({
+            "a": pd.Categorical(["a", None, "b"])
+        })
+        table.update(df)
+        assert table.view().to_dict()["a"] == ["x", "a", "a", None, "b"]
+
+    def test_table_pandas_categorical_many_categories(self):
+        categories = ["category_{}".format(i) for i in range(5000)]
+        data = [categories[(i * 7) % 5000] for i in range(10000)]
+        table = Table({
+            "a": ["x"]
+        })
+        table.update(pd.DataFrame({
+            "a": pd.Categorical(data, categories=categories)
+        }))
+        assert table.view().to_dict()["a"] == ["x"] + data
+
     def test_table_pandas_symmetric_table(self):
         # make sure that updates are symmetric to table creation
         df = pd.DataFrame({
@@ -0,0 +1,90 @@
+# *****************************************************************************
+#
+# Copyright (c) 2019, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+import pyarrow as pa
+import pyarrow.parquet as pq
+from datetime import datetime
+from perspective.table import Table
+
+
+def _to_parquet(data, row_group_size=None):
+    sink = pa.BufferOutputStream()
+    pq.write_table(pa.Table.from_pydict(data), sink, row_group_size=row_group_size)
+    return sink.getvalue().to_pybytes()
+
+
+class TestTableParquet(object):
+
+    def test_table_parquet_loads(self):
+        data = {
+            "a": [1, 2, None, 4],
+            "b": [1.5, None, 3.5, 4.5],
+            "c": ["a", "b", "c", None],
+            "d": [True, False, None, True]
+        }
+        tbl = Table(_to_parquet(data))
+        assert tbl.size() == 4
+        assert tbl.schema() == {
+            "a": int,
+            "b": float,
+            "c": str,
+            "d": bool
+        }
+        assert tbl.view().to_dict() == data
+
+    def test_table_parquet_loads_row_groups(self):
+        data = {
+            "a": list(range(100)),
+            "b": [str(i) for i in range(100)]
+        }
+        tbl = Table(_to_parquet(data, row_group_size=7))
+        assert tbl.size() == 100
+        assert tbl.view().to_dict() == data
+
+    def test_table_parquet_column_projection(self):
+        data = {
+            "a": [1, 2, 3],
+            "b": ["x", "y", "z"],
+            "c": [1.5, 2.5, 3.5]
+        }
+        tbl = Table(_to_parquet(data, row_group_size=2), columns=["c", "a"])
+        assert sorted(tbl.columns()) == ["a", "c"]
+        assert tbl.view().to_dict() == {
+            "c": [1.5, 2.5, 3.5],
+            "a": [1, 2, 3]
+        }
+
+    def test_table_parquet_update(self):
+        tbl = Table({"a": [1, 2], "b": ["x", "y"]}, index="a")
+        tbl.update(_to_parquet({
+            "a": [2, 3],
+            "b": ["z", "w"],
+            "c": [100, 200]
+        }))
+        assert tbl.view().to_dict() == {
+            "a": [1, 2, 3],
+            "b": ["x", "z", "w"]
+        }
+
+    def test_view_to_parquet(self):
+        data = {
+            "a": [1, 2, 3],
+            "b": ["x", "y", None],
+            "c": [datetime(2019, 1, 1), None, datetime(2019, 1, 3)]
+        }
+        tbl = Table(data)
+        view = tbl.view()
+        parquet = view.to_parquet(row_group_size=2)
+        assert pq.ParquetFile(pa.BufferReader(parquet)).num_row_groups == 2
+        assert Table(parquet).view().to_dict() == view.to_dict()
+
+    def test_view_to_parquet_row_pivots(self):
+        tbl = Table({"a": [1, 2, 3], "b": ["x", "x", "y"]})
+        view = tbl.view(row_pivots=["b"], columns=["a"])
+        result = pq.read_table(pa.BufferReader(view.to_parquet())).to_pydict()
+        assert result["a"] == [6, 3, 3]
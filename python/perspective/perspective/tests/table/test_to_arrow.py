@@ -6,9 +6,13 @@
 # the Apache License 2.0.  The full license can be found in the LICENSE file.
 #
 
+import threading
 import pyarrow as pa
 from datetime import date, datetime
+from pytest import mark, raises
 from perspective import Table
+from perspective.table import PerspectiveCppError
+from perspective.table.libbinding import is_arrow_compression_available
 
 
 class TestToArrow(object):
@@ -27,6 +31,45 @@ class TestToArrow(object):
         tbl2 = Table(arr)
         assert tbl2.view().to_dict() == data
 
+    def _nulls_data(self, n=37):
+        return {
+            "i": [None if x % 3 == 0 else x for x in range(n)],
+            "f": [None if x % 5 in (1, 2) else x * 0.5 for x in range(n)],
+            "d": [None if x % 4 == 3 else date(2020, 1 + x % 12, 1) for x in range(n)],
+            "t": [None if x % 7 == 0 else datetime(2020, 1, 1, x % 24) for x in range(n)],
+            "k": list(range(n))
+        }
+
+    def test_to_arrow_nulls_round_trip_contiguous_rows(self):
+        tbl = Table(self._nulls_data())
+        view = tbl.view()
+        for start_row, end_row in ((0, 37), (3, 30), (8, 16), (5, 6)):
+            arr = view.to_arrow(start_row=start_row, end_row=end_row)
+            expected = view.to_dict(start_row=start_row, end_row=end_row)
+            assert Table(arr).view().to_dict() == expected
+            table = pa.ipc.open_stream(arr).read_all()
+            assert table.column("i").null_count == expected["i"].count(None)
+            assert table.column("f").null_count == expected["f"].count(None)
+
+    def test_to_arrow_nulls_round_trip_gathered_rows(self):
+        tbl = Table(self._nulls_data(), index="k")
+        for config in ({"sort": [["f", "desc"]]}, {"filter": [["k", ">", 10]]}):
+            view = tbl.view(**config)
+            arr = view.to_arrow(start_row=1, end_row=20)
+            assert Table(arr).view().to_dict() == view.to_dict(start_row=1, end_row=20)
+
+    def test_to_arrow_nulls_round_trip_after_updates(self):
+        tbl = Table(self._nulls_data(), index="k")
+        view = tbl.view()
+        tbl.update({"k": [0, 1, 2, 40], "i": [10, None, 12, None], "f": [None, 1.5, None, 2.5]})
+        assert Table(view.to_arrow()).view().to_dict() == view.to_dict()
+
+    def test_to_arrow_no_nulls_has_no_null_count(self):
+        tbl = Table({"a": [1, 2, 3], "b": [1.5, 2.5, 3.5]})
+        table = pa.ipc.open_stream(tbl.view().to_arrow()).read_all()
+        assert table.column("a").null_count == 0
+        assert table.column("b").null_count == 0
+
     def test_to_arrow_big_numbers_symmetric(self):
         data = {
             "a": [1, 2, 3, 4],
@@ -496,3 +539,305 @@ class TestToArrow(object):
         tbl2 = Table(arr)
         assert tbl2.view().to_dict() == tbl.view().to_dict(
             start_col=1, end_col=2, end_row=2)
+
+    def test_to_arrow_chunked_symmetric(self):
+        data = {
+            "a": [None, 1, None, 2, 3],
+            "b": [1.5, 2.5, None, 3.5, None],
+            "c": ["a", "b", "c", None, "e"]
+        }
+        tbl = Table(data)
+        chunks = []
+        tbl.view().to_arrow_chunked(chunks.append, chunk_size=2)
+        assert len(chunks) == 3
+        tbl2 = Table(chunks[0])
+        for chunk in chunks[1:]:
+            tbl2.update(chunk)
+        assert tbl2.view().to_dict() == data
+
+    def test_to_arrow_chunked_through_one_stream_writer(self):
+        data = {
+            "a": [None, 1, None, 2, 3],
+            "b": [1.5, 2.5, None, 3.5, None]
+        }
+        view = Table(data).view()
+        schema = pa.ipc.open_stream(view.to_arrow(end_row=0)).schema
+        sink = pa.BufferOutputStream()
+        writer = pa.RecordBatchStreamWriter(sink, schema)
+        view.to_arrow_chunked(lambda chunk: [
+            writer.write_batch(batch) for batch in pa.ipc.open_stream(chunk)], chunk_size=2)
+        writer.close()
+        arrow = sink.getvalue().to_pybytes()
+        assert len(list(pa.ipc.open_stream(arrow))) == 3
+        assert Table(arrow).view().to_dict() == data
+
+    def test_to_arrow_string_dictionary_pruned(self):
+        tbl = Table({
+            "a": ["a", "b", "c", "d", None, "a"]
+        })
+        arr = tbl.view().to_arrow(start_row=3, end_row=6)
+        arrow_table = pa.ipc.open_stream(pa.BufferReader(arr)).read_all()
+        column = arrow_table.column("a").chunk(0)
+        assert column.dictionary.to_pylist() == ["a", "d"]
+        assert column.to_pylist() == ["d", None, "a"]
+
+    def test_to_arrow_string_dictionary_in_string_order(self):
+        tbl = Table({
+            "a": ["d", "b", None, "c", "a", "b"]
+        })
+        arr = tbl.view().to_arrow()
+        arrow_table = pa.ipc.open_stream(pa.BufferReader(arr)).read_all()
+        column = arrow_table.column("a").chunk(0)
+        dictionary = column.dictionary.to_pylist()
+        assert dictionary == sorted(dictionary)
+        assert column.to_pylist() == ["d", "b", None, "c", "a", "b"]
+
+        tbl.update({"a": ["aa", "e"]})
+        arr = tbl.view().to_arrow(start_row=4)
+        arrow_table = pa.ipc.open_stream(pa.BufferReader(arr)).read_all()
+        column = arrow_table.column("a").chunk(0)
+        assert column.dictionary.to_pylist() == ["a", "aa", "b", "e"]
+        assert column.to_pylist() == ["a", "b", "aa", "e"]
+
+    def test_to_arrow_string_dictionary_sorted_filtered(self):
+        data = {
+            "a": ["x", "y", "z", "y", None],
+            "b": [1, 2, 3, 4, 5]
+        }
+        tbl = Table(data)
+        view = tbl.view(sort=[["b", "desc"]], filter=[["b", ">", 1]])
+        tbl2 = Table(view.to_arrow())
+        assert tbl2.view().to_dict() == {
+            "a": [None, "y", "z", "y"],
+            "b": [5, 4, 3, 2]
+        }
+
+    def test_to_arrow_string_dictionary_after_update(self):
+        tbl = Table({
+            "a": ["a", "b", "c"],
+            "b": [1, 2, 3]
+        }, index="b")
+        tbl.update({"a": ["d", None], "b": [1, 3]})
+        tbl2 = Table(tbl.view().to_arrow())
+        assert tbl2.view().to_dict() == {
+            "a": ["d", "b", None],
+            "b": [1, 2, 3]
+        }
+
+    def test_to_arrow_snapshot_concurrent_with_update(self):
+        # Large enough to be read from a snapshot of the table
+        rows = 70000
+        tbl = Table({
+            "a": list(range(rows)),
+            "b": [str(i % 100) for i in range(rows)]
+        }, index="a")
+        view = tbl.view()
+        results = []
+        thread = threading.Thread(target=lambda: results.append(view.to_arrow()))
+        thread.start()
+        for i in range(20):
+            tbl.update({"a": [0, rows + i], "b": ["updated", "new"]})
+        thread.join()
+
+        exported = Table(results[0]).view().to_dict()
+        assert len(exported["a"]) >= rows
+        assert exported["a"][:rows] == list(range(rows))
+        assert exported["b"][0] in ("0", "updated")
+        assert exported["b"][1:rows] == [str(i % 100) for i in range(1, rows)]
+        assert view.to_dict()["b"][0] == "updated"
+
+    def test_to_arrow_snapshot_columns_symmetric(self):
+        # Large enough to be read from a snapshot of the table as columns
+        rows = 70000
+        data = {
+            "a": [i if i % 7 else None for i in range(rows)],
+            "b": [i * 0.5 for i in range(rows)],
+            "c": [i % 3 == 0 for i in range(rows)],
+            "d": [str(i % 10) if i % 5 else None for i in range(rows)],
+            "e": [date(2020, 1 + i % 12, 1 + i % 28) for i in range(rows)],
+            "f": [datetime(2020, 1, 1, i % 24, i % 60) for i in range(rows)]
+        }
+        tbl = Table(data)
+        view = tbl.view()
+        exported = Table(view.to_arrow())
+        assert exported.schema() == tbl.schema()
+        result = view.to_dict()
+        assert exported.view().to_dict() == result
+        for name in ("a", "b", "c", "d"):
+            assert result[name] == data[name]
+        assert result["e"][:3] == [datetime(2020, 1, 1), datetime(2020, 2, 2), datetime(2020, 3, 3)]
+        assert result["f"][:3] == data["f"][:3]
+
+    def test_to_arrow_snapshot_pivoted_concurrent_with_update(self):
+        rows = 70000
+        tbl = Table({
+            "a": list(range(rows)),
+            "b": ["x{}".format(i) for i in range(rows)]
+        }, index="a")
+        view = tbl.view(row_pivots=["a"], aggregates={"b": "first by index"})
+        results = []
+        thread = threading.Thread(target=lambda: results.append(view.to_arrow()))
+        thread.start()
+        for i in range(20):
+            tbl.update({"a": [rows + i], "b": ["y{}".format(i)]})
+        thread.join()
+
+        exported = Table(results[0]).view().to_dict()
+        assert exported["b"][1:rows + 1] == ["x{}".format(i) for i in range(rows)]
+
+    def test_to_arrow_async(self):
+        tbl = Table({"a": [1, 2, 3], "b": ["x", "y", "z"]})
+        view = tbl.view(row_pivots=["b"])
+        future = view.to_arrow_async(start_row=1)
+        assert future.result() == view.to_arrow(start_row=1)
+
+    def test_to_parquet_async(self):
+        tbl = Table({"a": [1, 2, 3], "b": ["x", "y", "z"]})
+        view = tbl.view()
+        assert Table(view.to_parquet_async().result()).view().to_dict() == view.to_dict()
+
+    def test_view_async_concurrent_with_update(self):
+        tbl = Table({"a": list(range(1000)), "b": [i % 10 for i in range(1000)]})
+        futures = [tbl.view_async(row_pivots=["b"]) for _ in range(4)]
+        tbl.update({"a": [1000], "b": [10]})
+        for future in futures:
+            view = future.result()
+            assert view.num_rows() == 12
+            view.delete()
+
+    def test_to_arrow_repeated_window_after_changes(self):
+        tbl = Table({"a": [1, 2, 3, 4], "b": ["x", "y", "x", "y"]}, index="a")
+        config = {"row_pivots": ["b"], "filter": [["a", "<", 10]]}
+        view = tbl.view(**config)
+
+        def expected():
+            return tbl.view(**config).to_arrow(end_row=3)
+
+        before = view.to_arrow(end_row=3)
+        assert view.to_arrow(end_row=3) == before
+
+        # Filtered out of the view, so its windows are unchanged.
+        tbl.update({"a": [20], "b": ["z"]})
+        assert view.to_arrow(end_row=3) == before
+
+        tbl.update({"a": [1], "b": ["y"]})
+        assert view.to_arrow(end_row=3) != before
+        assert view.to_arrow(end_row=3) == expected()
+
+        view.collapse(0)
+        assert view.to_arrow(end_row=3) != expected()
+        view.expand(0)
+        assert view.to_arrow(end_row=3) == expected()
+
+    def test_to_arrow_repeated_as_schema_changes(self):
+        tbl = Table({"a": [1, 2, 3], "b": ["x", "y", "x"], "c": [1.5, 2.5, 3.5]}, index="a")
+        config = {"column_pivots": ["b"], "columns": ["a", "c"]}
+        view = tbl.view(**config)
+
+        def expected(**kwargs):
+            return tbl.view(**config).to_arrow(**kwargs)
+
+        assert view.to_arrow() == expected()
+        assert view.to_arrow(start_col=1) == expected(start_col=1)
+        assert view.to_arrow() == expected()
+
+        # A new column pivot value adds columns to the schema.
+        tbl.update({"a": [4], "b": ["z"], "c": [4.5]})
+        arrow = view.to_arrow()
+        assert arrow == expected()
+        assert "z|c" in Table(arrow).schema()
+
+    def test_to_arrow_repeated_as_output_shrinks_and_grows(self):
+        tbl = Table({"a": list(range(100)), "b": [str(i) for i in range(100)]}, index="a")
+        view = tbl.view()
+        full = view.to_arrow()
+        small = view.to_arrow(end_row=2)
+        assert len(small) < len(full)
+        assert Table(small).view().to_dict() == {"a": [0, 1], "b": ["0", "1"]}
+        assert view.to_arrow() == full
+
+        # Earlier results do not share the buffer of the next call.
+        tbl.remove(list(range(50)))
+        assert Table(full).size() == 100
+        assert Table(small).view().to_dict() == {"a": [0, 1], "b": ["0", "1"]}
+        assert Table(view.to_arrow()).view().to_dict() == tbl.view().to_dict()
+
+    def test_to_arrow_chunked_empty_range(self):
+        tbl = Table({"a": [1, 2, 3]})
+        chunks = []
+        tbl.view().to_arrow_chunked(chunks.append, chunk_size=2, start_row=3)
+        assert len(chunks) == 1
+        assert Table(chunks[0]).schema() == {"a": int}
+
+    def test_cursor_pages_snapshot_across_updates(self):
+        tbl = Table({"a": list(range(10)), "b": [str(i) for i in range(10)]}, index="a")
+        view = tbl.view()
+        expected = view.to_dict()
+        cursor_id = view.open_cursor()
+        first = view.cursor_to_arrow(cursor_id, 4)
+        tbl.update({"a": [0, 9, 10], "b": ["x", "y", "z"]})
+        tbl.remove([5])
+        pages = [first]
+        while True:
+            page = view.cursor_to_arrow(cursor_id, 4)
+            if page is None:
+                break
+            pages.append(page)
+        view.close_cursor(cursor_id)
+        assert len(pages) == 3
+        paged = Table(pages[0])
+        for page in pages[1:]:
+            paged.update(page)
+        assert paged.view().to_dict() == expected
+
+    def test_cursor_pages_live_and_pivoted(self):
+        tbl = Table({"a": list(range(10)), "b": [i % 3 for i in range(10)]})
+        view = tbl.view(row_pivots=["b"])
+        assert b"".join(view.arrow_pages(page_size=2)) != b""
+        cursor_id = view.open_cursor(snapshot=False)
+        view.cursor_to_arrow(cursor_id, 2)
+        tbl.update({"a": [10], "b": [3]})
+        assert Table(view.cursor_to_arrow(cursor_id, 10)).size() == 3
+        assert view.cursor_to_arrow(cursor_id, 10) is None
+        view.close_cursor(cursor_id)
+
+        cursor_id = view.open_cursor()
+        tbl.update({"a": [11], "b": [4]})
+        with raises(PerspectiveCppError):
+            view.cursor_to_arrow(cursor_id, 2)
+        view.close_cursor(cursor_id)
+
+    @mark.parametrize("compression", ["lz4", "zstd"])
+    def test_to_arrow_compressed_symmetric(self, compression):
+        if not is_arrow_compression_available(compression):
+            return
+        data = {
+            "a": [None, 1, None, 2, 3],
+            "b": ["a", "b", "c", None, "e"]
+        }
+        tbl = Table(data)
+        arrow = tbl.view().to_arrow(compression=compression)
+        assert arrow[:4] == b"PSPZ"
+        tbl2 = Table(arrow)
+        assert tbl2.schema() == tbl.schema()
+        assert tbl2.view().to_dict() == data
+        tbl2.update(tbl.view().to_arrow(compression=compression))
+        assert tbl2.size() == 10
+
+    def test_to_arrow_buffer_zero_copy(self):
+        data = {
+            "a": [1, 2, 3, 4],
+            "b": ["a", "b", "c", "d"]
+        }
+        tbl = Table(data)
+        view = tbl.view(row_pivots=["b"], columns=["a"])
+        arrow = view.to_arrow_buffer()
+        assert len(arrow) == len(view.to_arrow())
+        assert arrow.to_bytes() == view.to_arrow()
+
+        # the pyarrow buffer points at the memory of the result
+        buf = pa.py_buffer(arrow)
+        assert buf.address == pa.py_buffer(memoryview(arrow)).address
+        arrow_table = pa.ipc.open_stream(buf).read_all()
+        del arrow
+        assert arrow_table.column("a").to_pylist() == [10, 1, 2, 3, 4]
@@ -236,6 +236,19 @@ class TestToFormat(object):
             "2|b": [4, 4]
         }
 
+    def test_to_dict_nested_row_paths(self):
+        data = {"a": ["x", "x", "y", "x"], "b": ["p", "q", "p", "p"], "c": [1, 2, 3, 4]}
+        tbl = Table(data)
+        view = tbl.view(row_pivots=["a", "b"], columns=["c"])
+        paths = [[], ["x"], ["x", "p"], ["x", "q"], ["y"], ["y", "p"]]
+        assert view.to_dict()["__ROW_PATH__"] == paths
+        assert view.to_dict(start_row=3)["__ROW_PATH__"] == paths[3:]
+        assert view.to_dict(leaves_only=True) == {
+            "__ROW_PATH__": [["x", "p"], ["x", "q"], ["y", "p"]],
+            "c": [5, 2, 3]
+        }
+        assert [row["__ROW_PATH__"] for row in view.to_records()] == paths
+
     def test_to_dict_column_only(self):
         data = [{"a": 1, "b": 2}, {"a": 1, "b": 2}]
         tbl = Table(data)
@@ -369,6 +382,34 @@ class TestToFormat(object):
         assert np.array_equal(v["2|a"], np.array([1, 1]))
         assert np.array_equal(v["2|b"], np.array([2, 2]))
 
+    def test_to_numpy_typed_with_nulls(self):
+        dt = datetime(2019, 3, 15, 20, 30, 59, 6000)
+        data = {
+            "a": [1, None, 3],
+            "b": [1.5, 2.5, None],
+            "c": [dt, None, dt],
+            "d": ["x", None, "x"]
+        }
+        tbl = Table(data)
+        view = tbl.view()
+        v = view.to_numpy()
+        assert v["a"].dtype == np.float64
+        assert v["a"][0] == 1 and np.isnan(v["a"][1]) and v["a"][2] == 3
+        assert v["b"][0] == 1.5 and v["b"][1] == 2.5 and np.isnan(v["b"][2])
+        assert v["c"].dtype == np.dtype("datetime64[ms]")
+        assert v["c"][0] == dt
+        assert np.isnat(v["c"][1])
+        assert v["d"].tolist() == ["x", None, "x"]
+
+    def test_to_numpy_leaves_only(self):
+        data = {"a": [1, 2, 3], "b": ["x", "y", "x"]}
+        tbl = Table(data)
+        view = tbl.view(row_pivots=["b"])
+        v = view.to_numpy(leaves_only=True)
+        assert v["__ROW_PATH__"].tolist() == [["x"], ["y"]]
+        assert np.array_equal(v["a"], np.array([4, 2]))
+        assert v["b"].tolist() == [2, 1]
+
     def test_to_pandas_df_simple(self):
         data = [{"a": 1, "b": 2}, {"a": 1, "b": 2}]
         df = pd.DataFrame(data)
@@ -0,0 +1,82 @@
+# *****************************************************************************
+#
+# Copyright (c) 2019, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+from pytest import raises
+from perspective.table import Table, PerspectiveCppError
+
+
+class TestTotals(object):
+
+    def test_totals_default_aggregates(self):
+        tbl = Table({"a": [1, 2, 3], "b": ["x", "y", "z"]})
+        totals = tbl.totals()
+        assert totals.to_dict() == {"a": 6, "b": 3}
+
+    def test_totals_after_updates_and_removes(self):
+        tbl = Table({"id": [1, 2, 3], "qty": [1.5, 2.5, 3.0]}, index="id")
+        totals = tbl.totals(columns=["qty"], aggregates={"qty": "mean"})
+        tbl.update({"id": [2, 4], "qty": [4.5, 6.0]})
+        tbl.remove([1])
+        assert totals.to_dict() == {"qty": 4.5}
+
+    def test_totals_match_view_root(self):
+        tbl = Table({"id": [1, 2, 3], "qty": [1, 2, 3], "px": [10.0, 20.0, 30.0]}, index="id")
+        aggregates = {"qty": "sum", "px": ["weighted mean", "qty"]}
+        totals = tbl.totals(columns=["qty", "px"], aggregates=aggregates)
+        view = tbl.view(columns=["qty", "px"], aggregates=aggregates, row_pivots=["id"])
+        tbl.update({"id": [1, 5], "qty": [4, 2], "px": [5.0, 15.0]})
+        root = view.to_records()[0]
+        assert totals.to_dict() == {"qty": root["qty"], "px": root["px"]}
+
+    def test_totals_skip_nulls(self):
+        tbl = Table({"id": [1, 2, 3], "qty": [1, None, 3]}, index="id")
+        totals = tbl.totals(columns=["qty"], aggregates={"qty": "mean"})
+        assert totals.to_dict() == {"qty": 2}
+        tbl.update({"id": [3], "qty": [None]})
+        assert totals.to_dict() == {"qty": 1}
+
+    def test_totals_min_max(self):
+        tbl = Table({"id": [1, 2, 3], "qty": [5, 1, 9]}, index="id")
+        totals = tbl.totals(columns=["qty"], aggregates={"qty": "max"})
+        tbl.remove([3])
+        assert totals.to_dict() == {"qty": 5}
+        tbl.update({"id": [1], "qty": [0]})
+        assert totals.to_dict() == {"qty": 1}
+
+    def test_totals_filtered(self):
+        tbl = Table({"id": [1, 2, 3], "side": ["buy", "sell", "buy"], "qty": [1, 2, 3]}, index="id")
+        totals = tbl.totals(columns=["qty"], filter=[["side", "==", "buy"]])
+        assert totals.to_dict() == {"qty": 4}
+        tbl.update({"id": [1, 2], "side": ["sell", "buy"]})
+        assert totals.to_dict() == {"qty": 5}
+
+    def test_totals_clear(self):
+        tbl = Table({"qty": [1, 2, 3]})
+        totals = tbl.totals()
+        tbl.clear()
+        assert totals.to_dict() == {"qty": 0}
+        tbl.update({"qty": [4]})
+        assert totals.to_dict() == {"qty": 4}
+
+    def test_totals_of_empty_table(self):
+        tbl = Table({"qty": int})
+        totals = tbl.totals()
+        tbl.update({"qty": [1, 2]})
+        assert totals.to_dict() == {"qty": 3}
+
+    def test_totals_delete(self):
+        tbl = Table({"qty": [1]})
+        totals = tbl.totals()
+        totals.delete()
+        tbl.update({"qty": [2]})
+        tbl.delete()
+
+    def test_totals_unsupported_aggregate(self):
+        tbl = Table({"qty": [1]})
+        with raises(PerspectiveCppError):
+            tbl.totals(aggregates={"qty": "last"})
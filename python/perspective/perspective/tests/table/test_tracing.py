@@ -0,0 +1,70 @@
+################################################################################
+#
+# Copyright (c) 2020, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+import json
+from perspective.table import Table, set_tracing_enabled, is_tracing_enabled, \
+    get_trace, save_trace, clear_trace
+
+
+class TestTracing(object):
+
+    def setup_method(self):
+        clear_trace()
+
+    def teardown_method(self):
+        set_tracing_enabled(False)
+        clear_trace()
+
+    def test_tracing_disabled_records_nothing(self):
+        set_tracing_enabled(False)
+        tbl = Table({"a": [1, 2, 3]})
+        tbl.view().to_dict()
+        assert not is_tracing_enabled()
+        assert get_trace()["traceEvents"] == []
+
+    def test_tracing_records_spans(self):
+        set_tracing_enabled(True)
+        tbl = Table({"a": [1, 2, 3], "b": ["x", "y", "z"]})
+        view = tbl.view(row_pivots=["b"], sort=[["a", "desc"]], filter=[["a", ">", 1]])
+        tbl.update({"a": [4], "b": ["w"]})
+        view.to_dict()
+
+        events = get_trace()["traceEvents"]
+        names = set(event["name"] for event in events)
+        for name in ("gnode.process", "gnode.process_table", "gnode.notify_contexts",
+                     "ctx.notify", "ctx1.sort", "filter", "view.get_data"):
+            assert name in names
+
+        notify = [event for event in events if event["name"] == "ctx.notify"]
+        assert notify[0]["args"]["arg"]
+        for event in events:
+            assert event["ph"] == "X"
+            assert event["dur"] >= 0
+
+    def test_tracing_nests_spans(self):
+        set_tracing_enabled(True)
+        tbl = Table({"a": [1, 2, 3]})
+        tbl.view()
+        tbl.update({"a": [4]})
+        tbl.size()
+
+        events = get_trace()["traceEvents"]
+        process = [e for e in events if e["name"] == "gnode.process"][-1]
+        table = [e for e in events if e["name"] == "gnode.process_table"][-1]
+        assert table["args"]["depth"] > process["args"]["depth"]
+        assert process["ts"] <= table["ts"]
+        # timestamps are rounded to the nanosecond
+        assert table["ts"] + table["dur"] <= process["ts"] + process["dur"] + 0.002
+
+    def test_save_trace(self, tmp_path):
+        set_tracing_enabled(True)
+        Table({"a": [1, 2, 3]}).size()
+        path = str(tmp_path / "trace.json")
+        save_trace(path)
+        with open(path) as f:
+            assert len(json.load(f)["traceEvents"]) > 0
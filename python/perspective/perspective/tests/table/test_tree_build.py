@@ -0,0 +1,106 @@
+################################################################################
+#
+# Copyright (c) 2019, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+from datetime import date, datetime
+from perspective.table import Table
+from ..common import run_with_env, run_in_process
+
+# Integer values, so that sums merged from partitions in any order are exact.
+SOURCE = """
+from perspective.table import Table
+
+
+def result():
+    n = 5000
+    tbl = Table({
+        "id": list(range(n)),
+        "g": ["g{0}".format(i % 13) for i in range(n)],
+        "h": ["h{0}".format(i % 7) for i in range(n)],
+        "x": [(i * 7919) % 1009 for i in range(n)],
+        "s": [None if i % 11 == 0 else "s{0}".format(i % 5) for i in range(n)]
+    }, index="id")
+    aggregates = {"x": "sum", "s": "distinct count", "id": "count"}
+    views = [
+        tbl.view(row_pivots=["g"], columns=["x", "s", "id"], aggregates=aggregates),
+        tbl.view(row_pivots=["g", "h"], columns=["x"], aggregates={"x": "avg"},
+                 sort=[["x", "desc"]]),
+        tbl.view(row_pivots=["g"], column_pivots=["h"], columns=["x", "s"],
+                 aggregates={"x": "high", "s": "unique"}),
+        tbl.view(row_pivots=["h"], columns=["x"], aggregates={"x": "low"},
+                 filter=[["x", ">", 500]])
+    ]
+    rval = [view.to_dict() for view in views]
+    tbl.update({"id": [0, 1, 2, n], "g": ["g1", "g1", "g2", "g0"], "x": [1, 2, 3, 4]})
+    rval.extend(view.to_dict() for view in views)
+    return rval
+"""
+
+
+class TestTreeBuild(object):
+
+    def test_partitioned_tree_build_matches_single_partition(self):
+        expected = run_in_process(SOURCE)
+        assert run_with_env({"PSP_TREE_BUILD_PARTITION_ROWS": "0"}, SOURCE) == expected
+        assert run_with_env({"PSP_TREE_BUILD_PARTITION_ROWS": "100"}, SOURCE) == expected
+        assert run_with_env({"PSP_TREE_BUILD_PARTITION_ROWS": "1"}, SOURCE) == expected
+
+    def test_tree_build_groups_each_dtype(self):
+        n = 60
+        tbl = Table({
+            "id": list(range(n)),
+            "i": [None if i % 9 == 0 else i % 4 for i in range(n)],
+            "f": [None if i % 8 == 0 else (i % 3) * 0.5 for i in range(n)],
+            "b": [None if i % 7 == 0 else i % 2 == 0 for i in range(n)],
+            "s": [None if i % 6 == 0 else "s{0}".format(i % 5) for i in range(n)],
+            "d": [date(2020, 1, 1 + i % 3) for i in range(n)],
+            "t": [datetime(2020, 1, 1, i % 2) for i in range(n)],
+            "x": [1] * n
+        }, index="id")
+        configs = [{"row_pivots": [name], "columns": ["x"]} for name in "ifbsdt"]
+        configs.append({"row_pivots": ["s", "i", "b", "f"], "columns": ["x"]})
+        configs.append({"row_pivots": ["d", "s"], "column_pivots": ["b"], "columns": ["x"]})
+        views = [tbl.view(**config) for config in configs]
+
+        def check():
+            for config, view in zip(configs, views):
+                assert view.to_dict() == tbl.view(**config).to_dict()
+
+        check()
+        assert views[0].num_rows() == 6
+        assert views[3].to_dict()["x"] == [n, 10, 10, 10, 10, 10, 10]
+
+        # Values move between groups, become null, and empty a group.
+        tbl.update({"id": [0, 1, 2, 3], "i": [7, None, 7, 7], "s": ["s1", "new", None, "s9"],
+                    "f": [None, 2.5, 2.5, 0.0], "b": [True, None, False, True]})
+        check()
+        tbl.remove([i for i in range(n) if i % 5 == 4])
+        check()
+        assert "s4" not in [path[-1] for path in views[3].to_dict()["__ROW_PATH__"] if path]
+        tbl.update({"id": list(range(n, 2 * n)), "s": ["s4"] * n, "i": [1] * n, "x": [2] * n})
+        check()
+
+    def test_tree_build_count_over_strings(self):
+        # Odd row counts, so that reading string ids wider than they are
+        # stored runs past the end of the column.
+        n = 1001
+        tbl = Table({
+            "id": list(range(n)),
+            "g": ["g{0}".format(i % 3) for i in range(n)],
+            "s": [None if i % 4 == 0 else "s{0}".format(i % 17) for i in range(n)]
+        }, index="id")
+        config = {"row_pivots": ["g"], "columns": ["s"], "aggregates": {"s": "count"}}
+        view = tbl.view(**config)
+        expected = [len([i for i in range(n) if i % 4 != 0 and i % 3 == g]) for g in range(3)]
+        assert view.to_dict()["s"] == [sum(expected)] + expected
+
+        tbl.update({"id": [0, 1, 4, n], "s": ["new", None, "x", "y"],
+                    "g": ["g0", "g1", "g2", "g0"]})
+        assert view.to_dict() == tbl.view(**config).to_dict()
+        tbl.remove(list(range(0, n, 5)))
+        assert view.to_dict() == tbl.view(**config).to_dict()
+
@@ -0,0 +1,98 @@
+# *****************************************************************************
+#
+# Copyright (c) 2019, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+from datetime import date, datetime
+from pytest import raises
+from perspective.core.exception import PerspectiveError
+from perspective.table import Table
+
+
+class TestUnion(object):
+
+    def test_union_indexed(self):
+        east = Table({"id": [1, 2], "qty": [1, 2]}, index="id")
+        west = Table({"id": [3], "qty": [3]}, index="id")
+        union = east.union(west)
+        assert union.size() == 3
+        assert union.view().to_dict() == {
+            "id": [1, 2, 3],
+            "qty": [1, 2, 3]
+        }
+
+    def test_union_indexed_update(self):
+        east = Table({"id": [1, 2], "qty": [1, 2]}, index="id")
+        west = Table({"id": [3], "qty": [3]}, index="id")
+        view = east.union(west).view(columns=["qty"], aggregates={"qty": "sum"}, row_pivots=["id"])
+        west.update([{"id": 3, "qty": 10}, {"id": 4, "qty": 4}])
+        east.remove([1])
+        assert view.to_dict() == {
+            "__ROW_PATH__": [[], [2], [3], [4]],
+            "qty": [16, 2, 10, 4]
+        }
+
+    def test_union_unindexed(self):
+        east = Table({"desk": ["x", "y"], "qty": [1, 2]})
+        west = Table({"desk": ["x"], "qty": [3]})
+        union = east.union(west)
+        view = union.view(columns=["qty"], row_pivots=["desk"])
+        west.update({"desk": ["y"], "qty": [4]})
+        assert union.size() == 4
+        assert view.to_dict() == {
+            "__ROW_PATH__": [[], ["x"], ["y"]],
+            "qty": [10, 4, 6]
+        }
+
+    def test_union_dtypes_and_nulls(self):
+        schema = {
+            "id": int,
+            "a": float,
+            "b": str,
+            "c": bool,
+            "d": date,
+            "e": datetime
+        }
+        east = Table(schema, index="id")
+        west = Table(schema, index="id")
+        east.update({
+            "id": [1, 2],
+            "a": [1.5, None],
+            "b": ["x", None],
+            "c": [True, None],
+            "d": [date(2020, 1, 2), None],
+            "e": [datetime(2020, 1, 2, 3, 4, 5), None]
+        })
+        west.update({
+            "id": [3],
+            "a": [3.5],
+            "b": ["x"],
+            "c": [False],
+            "d": [date(2020, 3, 4)],
+            "e": [datetime(2020, 3, 4, 5, 6, 7)]
+        })
+        union = east.union(west)
+        assert union.view().to_dict() == {
+            "id": [1, 2, 3],
+            "a": [1.5, None, 3.5],
+            "b": ["x", None, "x"],
+            "c": [True, None, False],
+            "d": [datetime(2020, 1, 2), None, datetime(2020, 3, 4)],
+            "e": [datetime(2020, 1, 2, 3, 4, 5), None, datetime(2020, 3, 4, 5, 6, 7)]
+        }
+
+    def test_union_of_several(self):
+        tables = [Table({"qty": [i]}) for i in range(4)]
+        union = tables[0].union(*tables[1:])
+        assert sorted(union.view().to_dict()["qty"]) == [0, 1, 2, 3]
+
+    def test_union_different_schemas(self):
+        with raises(PerspectiveError):
+            Table({"a": [1]}).union(Table({"a": ["x"]}))
+
+    def test_union_different_indices(self):
+        with raises(PerspectiveError):
+            Table({"a": [1]}, index="a").union(Table({"a": [2]}))
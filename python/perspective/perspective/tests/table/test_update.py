@@ -5,9 +5,13 @@
 # This file is part of the Perspective library, distributed under the terms of
 # the Apache License 2.0.  The full license can be found in the LICENSE file.
 #
+import threading
+import time
 import numpy as np
 from datetime import date, datetime
 from perspective.table import Table
+from perspective.table.libbinding import get_default_scheduler, get_num_numa_nodes, \
+    get_numa_node_cpus, t_scheduler
 
 
 class TestUpdate(object):
@@ -48,6 +52,128 @@ class TestUpdate(object):
         tbl.update({"a": ["abc"], "b": [456]})
         assert tbl.view().to_records() == [{"a": "abc", "b": 456}]
 
+    def test_update_partial_num_threads(self):
+        tbl = Table({"a": ["abc", "def"], "b": [123, 456], "c": [1.5, 2.5]}, index="a")
+        pool = tbl._table.get_pool()
+        for num_threads in (1, 2, 0):
+            pool.set_num_threads(num_threads)
+            assert pool.get_num_threads() == num_threads
+            tbl.update({"a": ["abc"], "b": [num_threads], "c": [None]})
+            assert tbl.view().to_records() == [
+                {"a": "abc", "b": num_threads, "c": None},
+                {"a": "def", "b": 456, "c": 2.5}
+            ]
+
+    def test_update_notify_threads_many_views(self):
+        tbl = Table({"a": ["abc", "def"], "b": [1, 2]}, index="a")
+        pool = tbl._table.get_pool()
+        views = [tbl.view(), tbl.view(row_pivots=["a"]), tbl.view(row_pivots=["a"], column_pivots=["b"])]
+        for notify_threads in (1, 2, 0):
+            pool.set_notify_threads(notify_threads)
+            assert pool.get_notify_threads() == notify_threads
+            tbl.update({"a": ["abc"], "b": [notify_threads + 10]})
+            assert views[0].to_records() == [
+                {"a": "abc", "b": notify_threads + 10},
+                {"a": "def", "b": 2}
+            ]
+            assert views[1].to_dict()["b"] == [notify_threads + 12, notify_threads + 10, 2]
+
+    def test_update_shared_scheduler(self):
+        tbl = Table({"a": ["abc", "def"], "b": [1, 2]}, index="a")
+        tbl2 = Table({"a": ["abc"], "b": [1]}, index="a")
+        pool = tbl._table.get_pool()
+        assert pool.get_scheduler() is get_default_scheduler()
+        assert tbl2._table.get_pool().get_scheduler() is get_default_scheduler()
+
+    def test_update_scheduler_threads(self):
+        tbl = Table({"a": ["abc", "def"], "b": [1, 2], "c": [1.5, 2.5]}, index="a")
+        view = tbl.view(row_pivots=["a"])
+        scheduler = t_scheduler()
+        tbl._table.get_pool().set_scheduler(scheduler)
+        for num_threads in (1, 2, 0):
+            scheduler.set_num_threads(num_threads)
+            assert scheduler.get_num_threads() == num_threads
+            assert scheduler.is_inline() == (num_threads == 1)
+            tbl.update({"a": ["abc"], "b": [num_threads + 10]})
+            assert view.to_dict()["b"] == [num_threads + 12, num_threads + 10, 2]
+
+    def test_update_scheduler_affinity(self):
+        tbl = Table({"a": ["abc", "def"], "b": [1, 2]}, index="a")
+        scheduler = t_scheduler()
+        scheduler.set_affinity([0])
+        assert scheduler.get_affinity() == [0]
+        tbl._table.get_pool().set_scheduler(scheduler)
+        tbl.update({"a": ["abc"], "b": [3]})
+        assert tbl.view().to_records() == [{"a": "abc", "b": 3}, {"a": "def", "b": 2}]
+        scheduler.set_affinity([])
+        assert scheduler.get_affinity() == []
+
+    def test_update_scheduler_numa_node(self):
+        tbl = Table({"a": ["abc", "def"], "b": [1, 2]}, index="a")
+        view = tbl.view(row_pivots=["a"])
+        assert get_num_numa_nodes() >= 1
+        scheduler = t_scheduler()
+        assert scheduler.get_numa_node() == -1
+        for node in range(get_num_numa_nodes()):
+            assert isinstance(get_numa_node_cpus(node), list)
+            scheduler.set_numa_node(node)
+            assert scheduler.get_numa_node() == node
+            tbl._table.get_pool().set_scheduler(scheduler)
+            tbl.update({"a": ["abc"], "b": [node + 10]})
+            assert view.to_dict()["b"] == [node + 12, node + 10, 2]
+        scheduler.set_numa_node(-1)
+        assert scheduler.get_numa_node() == -1
+
+    def test_update_coalesce_max_rows(self):
+        tbl = Table({"a": [1], "b": ["x"]})
+        pool = tbl._table.get_pool()
+        pool.set_coalesce_policy(3, 60 * 1000 * 1000)
+        assert pool.is_coalescing()
+        view = tbl.view()
+        updates = []
+        view.on_update(lambda port_id: updates.append(port_id))
+        tbl.update({"a": [2], "b": ["y"]})
+        tbl.update({"a": [3], "b": ["z"]})
+        assert updates == []
+        assert pool.get_process_delay() > 0
+        tbl.update({"a": [4], "b": ["w"]})
+        assert len(updates) == 1
+        assert view.to_dict() == {"a": [1, 2, 3, 4], "b": ["x", "y", "z", "w"]}
+
+    def test_update_coalesce_flushed_by_timer(self):
+        tbl = Table({"a": [1]})
+        pool = tbl._table.get_pool()
+        pool.set_coalesce_policy(0, 50 * 1000)
+        view = tbl.view()
+        updates = []
+        view.on_update(lambda port_id: updates.append(port_id))
+        tbl.update({"a": [2]})
+        tbl.update({"a": [3]})
+        assert updates == []
+
+        # No event loop and no later call, so the timer flushes the updates
+        # within the coalescing window.
+        start = time.time()
+        while not updates and time.time() - start < 5:
+            time.sleep(0.01)
+        assert len(updates) == 1
+        assert pool.get_process_delay() == 0
+        assert view.to_dict() == {"a": [1, 2, 3]}
+
+    def test_update_coalesce_flushed_by_output(self):
+        tbl = Table({"a": [1]})
+        pool = tbl._table.get_pool()
+        pool.set_coalesce_policy(0, 60 * 1000 * 1000)
+        view = tbl.view()
+        tbl.update({"a": [2]})
+        tbl.update({"a": [3]})
+        assert view.to_dict() == {"a": [1, 2, 3]}
+        assert pool.get_process_delay() == 0
+        pool.set_coalesce_policy(0, 0)
+        assert not pool.is_coalescing()
+        tbl.update({"a": [4]})
+        assert tbl.size() == 4
+
     # bool
 
     def test_update_bool_from_schema(self):
@@ -235,6 +361,122 @@ class TestUpdate(object):
 
     # implicit index
 
+    def test_update_sorted_view_moves_updated_and_deleted_rows(self):
+        data = {"a": [1, 2, 3, 4], "b": [4, 3, 2, 1]}
+        tbl = Table(data, index="a")
+        view = tbl.view(sort=[["b", "asc"]])
+        tbl.update({"a": [4, 5], "b": [5, 0]})
+        tbl.remove([2])
+        assert view.to_dict() == {
+            "a": [5, 3, 1, 4],
+            "b": [0, 2, 4, 5]
+        }
+
+    def test_update_sorted_view_small_and_large_batches(self):
+        n = 1000
+        tbl = Table({"a": list(range(n)), "b": [(i * 7) % 13 for i in range(n)]}, index="a")
+        view = tbl.view(sort=[["b", "desc"]])
+        filtered = tbl.view(sort=[["b", "asc"]], filter=[["b", ">", 5]])
+        expected = {i: (i * 7) % 13 for i in range(n)}
+
+        def check():
+            rows = sorted(expected.items(), key=lambda kv: (-kv[1], kv[0]))
+            assert view.to_columns()["b"] == [b for _, b in rows]
+            assert sorted(view.to_columns()["a"]) == sorted(expected.keys())
+            rows = sorted([kv for kv in expected.items() if kv[1] > 5], key=lambda kv: (kv[1], kv[0]))
+            assert filtered.to_columns()["b"] == [b for _, b in rows]
+
+        # Few rows change, and are moved in the sorted index one at a time.
+        tbl.update({"a": [3, 500, n], "b": [100, -1, 6]})
+        expected.update({3: 100, 500: -1, n: 6})
+        check()
+
+        # Most rows change, and are merged into the sorted index at once.
+        keys = list(range(0, n + 200, 2))
+        tbl.update({"a": keys, "b": [(i * 5) % 11 for i in keys]})
+        expected.update({i: (i * 5) % 11 for i in keys})
+        tbl.remove(list(range(1, 400, 3)))
+        for i in range(1, 400, 3):
+            expected.pop(i, None)
+        check()
+
+    def test_update_sorted_pivot_moves_updated_groups(self):
+        n = 200
+        tbl = Table({
+            "a": list(range(n)),
+            "g": ["g{}".format(i % 7) for i in range(n)],
+            "h": ["h{}".format(i % 5) for i in range(n)],
+            "b": [(i * 7) % 13 for i in range(n)]
+        }, index="a")
+        config = {"row_pivots": ["g", "h"], "columns": ["b"], "sort": [["b", "desc"]]}
+        view = tbl.view(**config)
+
+        # A new view sorts the whole tree, which the updated view must match.
+        def check():
+            assert view.to_dict() == tbl.view(**config).to_dict()
+
+        tbl.update({"a": [3, 10], "b": [100, -50]})
+        check()
+
+        keys = list(range(0, n + 20, 3))
+        tbl.update({"a": keys, "g": ["g{}".format(i % 4) for i in keys], "b": [(i * 5) % 11 for i in keys]})
+        check()
+
+        tbl.remove(list(range(1, n, 4)))
+        check()
+
+    def test_update_each_dtype_partial(self):
+        data = {
+            "k": [1, 2, 3],
+            "i": [1, 2, 3],
+            "f": [1.5, 2.5, 3.5],
+            "b": [True, False, True],
+            "s": ["a", "b", "c"],
+            "d": [date(2020, 1, 1), date(2020, 1, 2), date(2020, 1, 3)],
+            "t": [datetime(2020, 1, 1, 1), datetime(2020, 1, 1, 2), datetime(2020, 1, 1, 3)]
+        }
+        tbl = Table(data, index="k")
+        view = tbl.view()
+        tbl.update({
+            "k": [3, 1, 4],
+            "i": [30, None, 40],
+            "f": [None, 10.5, 40.5],
+            "b": [False, None, True],
+            "s": ["a", None, "new"],
+            "d": [date(2021, 3, 3), None, date(2021, 4, 4)],
+            "t": [None, datetime(2021, 1, 1, 1), datetime(2021, 1, 1, 4)]
+        })
+        assert view.to_dict() == {
+            "k": [1, 2, 3, 4],
+            "i": [None, 2, 30, 40],
+            "f": [10.5, 2.5, None, 40.5],
+            "b": [None, False, False, True],
+            "s": [None, "b", "a", "new"],
+            "d": [None, datetime(2020, 1, 2), datetime(2021, 3, 3), datetime(2021, 4, 4)],
+            "t": [datetime(2021, 1, 1, 1), datetime(2020, 1, 1, 2), None,
+                  datetime(2021, 1, 1, 4)]
+        }
+
+    def test_update_each_dtype_aggregates(self):
+        tbl = Table({"k": [1, 2], "g": ["x", "x"], "i": [1, 2], "f": [0.5, 1.5],
+                     "s": ["a", "b"]}, index="k")
+        view = tbl.view(row_pivots=["g"], aggregates={"s": "distinct count"})
+        tbl.update({"k": [1, 3], "i": [10, 3], "f": [None, 2.5], "g": ["x", "y"],
+                    "s": ["b", "c"]})
+        assert view.to_dict() == {
+            "__ROW_PATH__": [[], ["x"], ["y"]],
+            "k": [6, 3, 3],
+            "g": [3, 2, 1],
+            "i": [15, 12, 3],
+            "f": [4.0, 1.5, 2.5],
+            "s": [2, 1, 1]
+        }
+        size = 1000
+        tbl.update({"k": list(range(size)), "g": ["x"] * size, "i": list(range(size)),
+                    "f": [None] * size, "s": [str(i % 7) for i in range(size)]})
+        assert view.to_dict()["i"][0] == sum(range(size))
+        assert view.to_dict()["s"][0] == 7
+
     def test_update_implicit_index(self):
         data = [{"a": 1, "b": 2}, {"a": 2, "b": 3}]
         tbl = Table(data)
@@ -349,3 +591,54 @@ class TestUpdate(object):
             "b": 3
         }])
         assert view.to_records() == [{"a": 1, "b": 3}, {"a": 2, "b": 3}]
+
+    def test_update_repeated_varying_sizes(self):
+        tbl = Table({"a": int, "b": str}, index="a")
+        view = tbl.view()
+        expected = {}
+        for size in [100, 10, 1, 50, 200, 3]:
+            data = [{"a": i, "b": "s{}_{}".format(i, size)} for i in range(size)]
+            tbl.update(data)
+            for row in data:
+                expected[row["a"]] = row
+            assert view.to_records() == [expected[k] for k in sorted(expected)]
+
+    def test_update_concurrent_with_process(self):
+        tbl = Table({"a": int, "b": int}, index="a")
+        view = tbl.view()
+        pool = tbl._table.get_pool()
+
+        def produce():
+            for i in range(200):
+                tbl.update({"a": [i % 50, 50 + i], "b": [i, i]})
+
+        producer = threading.Thread(target=produce)
+        producer.start()
+        while producer.is_alive():
+            pool._process()
+        producer.join()
+
+        result = view.to_dict()
+        assert tbl.size() == 250
+        assert result["a"] == list(range(250))
+        assert result["b"][:50] == list(range(150, 200))
+        assert result["b"][50:] == list(range(200))
+
+    def test_update_from_many_threads(self):
+        tbl = Table({"a": int, "b": int}, index="a")
+        view = tbl.view()
+
+        def produce(thread_id):
+            for i in range(50):
+                tbl.update({"a": [thread_id * 1000 + i], "b": [thread_id]})
+
+        producers = [threading.Thread(target=produce, args=(i,)) for i in range(4)]
+        for producer in producers:
+            producer.start()
+        for producer in producers:
+            producer.join()
+
+        result = view.to_dict()
+        assert tbl.size() == 200
+        assert result["a"] == [t * 1000 + i for t in range(4) for i in range(50)]
+        assert result["b"] == [t for t in range(4) for i in range(50)]
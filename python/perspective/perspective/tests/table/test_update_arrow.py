@@ -10,6 +10,7 @@ import os
 import random
 import uuid
 import pyarrow as pa
+from decimal import Decimal
 from datetime import date, datetime
 from pytest import mark
 from perspective.table import Table
@@ -141,6 +142,14 @@ class TestUpdateArrow(object):
             "a": data[0]
         }
 
+    def test_update_arrow_updates_decimal_rescaled_stream(self, util):
+        tbl = Table(util.make_arrow(["a"], [[Decimal("1.25")]], types=[pa.decimal128(10, 2)]))
+        tbl.update(util.make_arrow(["a"], [[Decimal("2.500")]], types=[pa.decimal128(10, 3)]))
+        assert tbl.column_scales() == {"a": 2}
+        assert tbl.view().to_dict() == {
+            "a": [1.25, 2.5]
+        }
+
     def test_update_arrow_updates_bool_stream(self, util):
         data = [
             [True if i % 2 == 0 else False for i in range(10)]
@@ -308,3 +308,32 @@ class TestUpdateNumpy(object):
             "index": list(range(5)),
             "a": [None for _ in range(5)]
         }
+
+    def test_update_np_int32_into_int64(self):
+        tbl = Table({"a": np.array([1, 2], dtype=np.int64)})
+        tbl.update({"a": np.array([3, 4], dtype=np.int32)})
+        assert tbl.schema() == {"a": int}
+        assert tbl.view().to_dict() == {
+            "a": [1, 2, 3, 4]
+        }
+
+    def test_update_np_float32_into_float64(self):
+        tbl = Table({"a": [1.5, 2.5]})
+        tbl.update({"a": np.array([3.5, np.nan], dtype=np.float32)})
+        assert tbl.view().to_dict() == {
+            "a": [1.5, 2.5, 3.5, None]
+        }
+
+    def test_update_np_float_nan_into_int(self):
+        tbl = Table({"a": [1, 2]})
+        tbl.update({"a": np.array([3.0, np.nan, 5.0])})
+        assert tbl.view().to_dict() == {
+            "a": [1, 2, 3, None, 5]
+        }
+
+    def test_update_np_strided(self):
+        tbl = Table({"a": [1, 2]})
+        tbl.update({"a": np.arange(10)[::3]})
+        assert tbl.view().to_dict() == {
+            "a": [1, 2, 0, 3, 6, 9]
+        }
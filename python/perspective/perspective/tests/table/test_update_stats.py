@@ -0,0 +1,161 @@
+################################################################################
+#
+# Copyright (c) 2020, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+from perspective.table import Table
+
+
+class TestUpdateStats(object):
+
+    def test_update_stats_empty_before_update(self):
+        tbl = Table({"a": int})
+        assert tbl.get_update_stats() == {}
+
+    def test_update_stats_counts_rows(self):
+        tbl = Table({"a": [1, 2, 3], "b": ["x", "y", "z"]}, index="a")
+        assert tbl.get_update_stats()["rows_added"] == 3
+
+        tbl.update({"a": [1, 4], "b": ["w", "v"]})
+        tbl.remove([2])
+        stats = tbl.get_update_stats()
+        assert stats["rows_in"] == 3
+        assert stats["rows_added"] == 1
+        assert stats["rows_updated"] == 1
+        assert stats["rows_removed"] == 1
+        assert stats["total_ns"] > 0
+
+    def test_update_stats_flatten_passthrough(self):
+        tbl = Table({"a": [1, 2, 3], "b": ["x", "y", "z"], "c": [1.5, 2.5, 3.5]}, index="a")
+        tbl.update({"a": [2, 3, 4], "b": ["w", "v", "u"]})
+        assert tbl.get_update_stats()["flatten_passthrough"] == 1
+        assert tbl.view().to_dict() == {
+            "a": [1, 2, 3, 4],
+            "b": ["x", "w", "v", "u"],
+            "c": [1.5, 2.5, 3.5, None]
+        }
+
+        tbl.update({"a": [5, 4], "b": ["t", "s"]})
+        assert tbl.get_update_stats()["flatten_passthrough"] == 0
+        tbl.update({"a": [5, 5], "b": ["r", "q"]})
+        assert tbl.get_update_stats()["flatten_passthrough"] == 0
+        assert tbl.view().to_dict()["b"] == ["x", "w", "v", "s", "q"]
+
+    def test_update_stats_flatten_passthrough_computed(self):
+        tbl = Table({"a": [1, 2, 3], "c": [1.5, 2.5, 3.5]}, index="a")
+        view = tbl.view(computed_columns=[{
+            "column": "d",
+            "computed_function_name": "+",
+            "inputs": ["a", "c"]
+        }])
+        for i in range(3):
+            tbl.update({"a": [3 + i, 4 + i], "c": [10.0 * i, 20.0 * i]})
+            assert tbl.get_update_stats()["flatten_passthrough"] == 1
+        assert view.to_dict()["d"] == [2.5, 4.5, 3.0, 14.0, 25.0, 46.0]
+
+    def test_update_stats_append(self):
+        tbl = Table({"a": [1, 2], "b": ["x", "y"]})
+        view = tbl.view(row_pivots=["b"], columns=["a"])
+        tbl.update({"a": [3, 4], "b": ["x", "z"]})
+        stats = tbl.get_update_stats()
+        assert stats["append"] == 1
+        assert stats["rows_added"] == 2
+        assert tbl.view().to_dict() == {"a": [1, 2, 3, 4], "b": ["x", "y", "x", "z"]}
+        assert view.to_dict() == {
+            "__ROW_PATH__": [[], ["x"], ["y"], ["z"]],
+            "a": [10, 4, 2, 4]
+        }
+
+    def test_update_stats_append_indexed(self):
+        tbl = Table({"a": [1, 2], "b": ["x", "y"]}, index="a")
+        tbl.update({"a": [3, 5], "b": ["z", "w"]})
+        assert tbl.get_update_stats()["append"] == 1
+        tbl.update({"a": [4, 6], "b": ["v", "u"]})
+        assert tbl.get_update_stats()["append"] == 0
+        tbl.update({"a": [7], "b": ["t"]})
+        assert tbl.get_update_stats()["append"] == 1
+        assert tbl.view().to_dict() == {
+            "a": [1, 2, 3, 4, 5, 6, 7],
+            "b": ["x", "y", "z", "v", "w", "u", "t"]
+        }
+
+    def test_update_stats_append_row_delta(self):
+        tbl = Table({"a": [1, 2], "b": ["x", "y"]})
+        view = tbl.view()
+        deltas = []
+
+        def callback(port_id, delta):
+            deltas.append(Table(delta).view().to_dict())
+
+        view.on_update(callback, mode="row")
+        tbl.update({"a": [3], "b": ["z"]})
+        assert tbl.get_update_stats()["append"] == 1
+        assert deltas == [{"a": [3], "b": ["z"]}]
+
+    def test_update_stats_skips_unread_columns(self):
+        tbl = Table({"a": [1, 2], "b": ["x", "y"], "c": [1.5, 2.5]}, index="a")
+        flat = tbl.view()
+        tbl.update({"a": [1], "c": [3.5]})
+        assert tbl.get_update_stats()["columns_skipped"] == 3
+
+        pivoted = tbl.view(row_pivots=["b"], columns=["c"], filter=[["a", ">", 0]])
+        tbl.update({"a": [2], "c": [4.5]})
+        assert tbl.get_update_stats()["columns_skipped"] == 0
+        assert pivoted.to_dict() == {"__ROW_PATH__": [[], ["x"], ["y"]], "c": [8.0, 3.5, 4.5]}
+
+        pivoted.delete()
+        filtered = tbl.view(filter=[["c", ">", 4]])
+        tbl.update({"a": [1], "c": [5.5]})
+        assert tbl.get_update_stats()["columns_skipped"] == 2
+        assert filtered.to_dict() == {"a": [1, 2], "b": ["x", "y"], "c": [5.5, 4.5]}
+        assert flat.to_dict() == {"a": [1, 2], "b": ["x", "y"], "c": [5.5, 4.5]}
+
+    def test_update_stats_wide_table_narrow_view(self):
+        data = {"k": list(range(4)), "g": ["x", "y", "x", "y"]}
+        for i in range(300):
+            data["c{}".format(i)] = [float(i * 10 + j) for j in range(4)]
+        tbl = Table(data, index="k")
+        columns = ["c{}".format(i) for i in range(0, 300, 30)]
+        view = tbl.view(row_pivots=["g"], columns=columns, sort=[["c0", "desc"]])
+
+        update = {"k": [1, 3]}
+        for i in range(300):
+            update["c{}".format(i)] = [100.0 + i, 200.0 + i]
+        tbl.update(update)
+        assert tbl.get_update_stats()["columns_skipped"] == 302 - 11
+        result = view.to_dict()
+        assert result["__ROW_PATH__"] == [[], ["y"], ["x"]]
+        assert result["c30"] == [130 + 230 + 300 + 302, 130 + 230, 300 + 302]
+
+        # The master table is updated for the columns the view does not read.
+        assert tbl.view(columns=["c299"]).to_dict() == {"c299": [2990, 399, 2992, 499]}
+
+    def test_update_stats_times_each_view(self):
+        tbl = Table({"a": [1, 2, 3], "b": ["x", "y", "z"]}, index="a")
+        view = tbl.view(row_pivots=["b"])
+        tbl.update({"a": [1], "b": ["w"]})
+        stats = tbl.get_update_stats()
+        assert list(stats["context_notify_ns"].keys()) == [view._name]
+        assert stats["notify_ns"] >= stats["context_notify_ns"][view._name]
+
+    def test_update_stats_callback(self):
+        tbl = Table({"a": [1, 2, 3]})
+        tbl.view()
+        received = []
+
+        def callback(stats):
+            received.append(stats)
+
+        tbl.on_update_stats(callback)
+        tbl.update({"a": [4, 5]})
+        tbl.size()
+        assert len(received) == 1
+        assert received[0]["rows_added"] == 2
+
+        tbl.remove_update_stats(callback)
+        tbl.update({"a": [6]})
+        tbl.size()
+        assert len(received) == 1
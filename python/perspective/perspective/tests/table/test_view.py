@@ -6,10 +6,14 @@
 # the Apache License 2.0.  The full license can be found in the LICENSE file.
 #
 
+import time
 import pandas as pd
 import numpy as np
-from perspective.table import Table
-from datetime import date, datetime
+import perspective.table.view as view_module
+from perspective.table import Table, PerspectiveCppError
+from perspective.core.exception import PerspectiveError
+from datetime import date, datetime, timedelta
+from pytest import raises
 
 
 def compare_delta(received, expected):
@@ -63,6 +67,29 @@ class TestView(object):
             {"2|a": None, "2|b": None, "4|a": 3, "4|b": 4, "__ROW_PATH__": ["3"]}
         ]
 
+    def test_view_two_sparse_column_pivot(self):
+        # Each row group holds only a few of the many column pivot values.
+        n = 300
+        data = {
+            "g": ["g{}".format(i % 3) for i in range(n)],
+            "h": ["h{}".format(i % 4) for i in range(n)],
+            "c": ["c{}".format((i * 7) % 100) for i in range(n)],
+            "v": [i for i in range(n)]
+        }
+        tbl = Table(data)
+        view = tbl.view(row_pivots=["g", "h"], column_pivots=["c"], columns=["v"])
+        records = view.to_records(start_col=10, end_col=40)
+        assert len(records) == view.num_rows()
+        for record in records:
+            path = record.pop("__ROW_PATH__")
+            assert len(record) > 0
+            for name in record:
+                c = name.split("|")[0]
+                values = [data["v"][i] for i in range(n)
+                          if data["c"][i] == c
+                          and [data["g"][i], data["h"][i]][:len(path)] == path]
+                assert record[name] == (sum(values) if values else None)
+
     def test_view_two_column_only(self):
         data = [{"a": 1, "b": 2}, {"a": 3, "b": 4}]
         tbl = Table(data)
@@ -140,6 +167,18 @@ class TestView(object):
         paths = view.column_paths()
         assert paths == ["__ROW_PATH__", "1.5|a", "1.5|b", "2.5|a", "2.5|b", "3.5|a", "3.5|b"]
 
+    def test_view_column_path_two_after_update(self):
+        data = {
+            "a": [1, 2, 3],
+            "b": [1.5, 2.5, 3.5]
+        }
+        tbl = Table(data)
+        view = tbl.view(row_pivots=["a"], column_pivots=["b"])
+        assert view.column_paths() == ["__ROW_PATH__", "1.5|a", "1.5|b", "2.5|a", "2.5|b", "3.5|a", "3.5|b"]
+        tbl.update({"a": [4], "b": [2.0]})
+        assert view.column_paths() == ["__ROW_PATH__", "1.5|a", "1.5|b", "2.0|a", "2.0|b", "2.5|a", "2.5|b", "3.5|a", "3.5|b"]
+        assert view.to_columns()["2.0|a"] == [4, None, None, None, 4]
+
     def test_view_column_path_two_column_only(self):
         data = {
             "a": [1, 2, 3],
@@ -183,6 +222,70 @@ class TestView(object):
         paths = view.column_paths()
         assert paths == ["false|a", "false|b", "false|c", "true|a", "true|b", "true|c"]
 
+    def test_view_row_pivot_low_cardinality(self):
+        data = {
+            "side": ["buy", "sell", "buy", None, "sell", "buy", "buy", "sell"],
+            "flag": [True, False, True, True, None, False, True, False],
+            "qty": [1, 2, 3, 4, 5, 6, 7, 8]
+        }
+        tbl = Table(data)
+        view = tbl.view(row_pivots=["side", "flag"], columns=["qty"])
+        tbl.update({"side": ["sell", None], "flag": [True, None], "qty": [10, 20]})
+        result = view.to_dict()
+        totals = dict(zip([tuple(path) for path in result["__ROW_PATH__"]], result["qty"]))
+        assert totals == {
+            (): 66,
+            ("buy",): 17,
+            ("buy", True): 11,
+            ("buy", False): 6,
+            ("sell",): 25,
+            ("sell", False): 10,
+            ("sell", None): 5,
+            ("sell", True): 10,
+            (None,): 24,
+            (None, True): 4,
+            (None, None): 20
+        }
+
+    def test_view_row_pivot_children_after_updates(self):
+        # Nodes are looked up by parent and value as updates arrive, so
+        # children must be found again, and not duplicated, across updates,
+        # removes and values which reappear.
+        tbl = Table({"k": [0], "a": [1], "b": [1.5], "c": [0]}, index="k")
+        view = tbl.view(row_pivots=["a", "b"], columns=["c"])
+        rows = {}
+        for step in range(1, 40):
+            row = {"k": step, "a": step % 5, "b": (step % 3) + 0.5, "c": step}
+            rows[step] = row
+            tbl.update([row])
+            if step % 7 == 0:
+                tbl.remove([step - 3])
+                rows.pop(step - 3, None)
+
+        final = [{"k": 0, "a": 1, "b": 1.5, "c": 0}] + list(rows.values())
+        expected = Table(final, index="k").view(row_pivots=["a", "b"], columns=["c"])
+        assert view.to_dict() == expected.to_dict()
+
+    def test_view_row_pivot_children_mixed_values(self):
+        tbl = Table({"a": [1, 1, 2], "b": [True, False, None], "c": [1, 2, 3]})
+        view = tbl.view(row_pivots=["a", "b"], columns=["c"])
+        tbl.update({"a": [2, 1, None], "b": [True, True, False], "c": [4, 5, 6]})
+        result = view.to_dict()
+        paths = [tuple(path) for path in result["__ROW_PATH__"]]
+        assert len(paths) == len(set(paths))
+        totals = dict(zip(paths, result["c"]))
+        assert totals == {
+            (): 21,
+            (1,): 8,
+            (1, True): 6,
+            (1, False): 2,
+            (2,): 7,
+            (2, True): 4,
+            (2, None): 3,
+            (None,): 6,
+            (None, False): 6
+        }
+
     # schema correctness
 
     def test_string_view_schema(self):
@@ -414,6 +517,271 @@ class TestView(object):
             {"__ROW_PATH__": ["a"], "y": (1 * 200 + (-2) * 100) / (1 - 2)}
         ]
 
+    def test_view_aggregate_mean_after_updates(self):
+        data = [
+            {"k": 1, "a": "a", "x": 1, "y": 200},
+            {"k": 2, "a": "a", "x": 2, "y": 100},
+            {"k": 3, "a": "b", "x": 3, "y": 50}
+        ]
+        tbl = Table(data, index="k")
+        view = tbl.view(
+            aggregates={"x": "mean", "y": ["weighted mean", "x"]},
+            row_pivots=["a"],
+            columns=["x", "y"]
+        )
+        tbl.update([
+            {"k": 2, "x": 4},
+            {"k": 3, "a": "a"},
+            {"k": 4, "a": "b", "x": None, "y": 10}
+        ])
+        assert view.to_records() == [
+            {"__ROW_PATH__": [], "x": 8 / 3, "y": (1.0 * 200 + 4 * 100 + 3 * 50) / (1 + 4 + 3)},
+            {"__ROW_PATH__": ["a"], "x": 8 / 3, "y": (1.0 * 200 + 4 * 100 + 3 * 50) / (1 + 4 + 3)},
+            {"__ROW_PATH__": ["b"], "x": None, "y": None}
+        ]
+        tbl.remove([1, 2])
+        tbl.update([{"k": 4, "x": 6}])
+        assert view.to_records() == [
+            {"__ROW_PATH__": [], "x": 4.5, "y": (3.0 * 50 + 6 * 10) / (3 + 6)},
+            {"__ROW_PATH__": ["a"], "x": 3, "y": 50},
+            {"__ROW_PATH__": ["b"], "x": 6, "y": 10}
+        ]
+
+    def test_view_aggregate_weighted_mean_without_weights(self):
+        data = [
+            {"k": 1, "a": "a", "w": None, "y": 200},
+            {"k": 2, "a": "a", "w": None, "y": 100},
+            {"k": 3, "a": "b", "w": 0, "y": 50},
+            {"k": 4, "a": "b", "w": 0, "y": 10}
+        ]
+        tbl = Table(data, index="k")
+        view = tbl.view(
+            aggregates={"y": ["weighted mean", "w"]},
+            row_pivots=["a"],
+            columns=["y"]
+        )
+        assert view.to_records() == [
+            {"__ROW_PATH__": [], "y": None},
+            {"__ROW_PATH__": ["a"], "y": None},
+            {"__ROW_PATH__": ["b"], "y": None}
+        ]
+
+        # Weights of mixed sign that sum to zero still contribute once
+        # another weight is added.
+        tbl.update([{"k": 3, "w": 1}, {"k": 4, "w": -1}])
+        assert view.to_records()[2] == {"__ROW_PATH__": ["b"], "y": None}
+        tbl.update([{"k": 5, "a": "b", "w": 2, "y": 20}])
+        assert view.to_records()[2] == {"__ROW_PATH__": ["b"], "y": (50.0 - 10 + 2 * 20) / 2}
+
+        tbl.update([{"k": 1, "w": 1}])
+        assert view.to_records()[1] == {"__ROW_PATH__": ["a"], "y": 200}
+        tbl.update([{"k": 1, "w": None}])
+        assert view.to_records()[1] == {"__ROW_PATH__": ["a"], "y": None}
+
+    def test_view_aggregate_median_distinct_count_after_updates(self):
+        data = [
+            {"k": 1, "a": "a", "x": 1, "y": "p"},
+            {"k": 2, "a": "a", "x": 2, "y": "p"},
+            {"k": 3, "a": "b", "x": 3, "y": "q"}
+        ]
+        tbl = Table(data, index="k")
+        view = tbl.view(
+            aggregates={"x": "median", "y": "distinct count"},
+            row_pivots=["a"],
+            columns=["x", "y"]
+        )
+        tbl.update([
+            {"k": 2, "x": 4, "y": "q"},
+            {"k": 3, "a": "a"},
+            {"k": 4, "a": "b", "x": 5, "y": "r"}
+        ])
+        assert view.to_records() == [
+            {"__ROW_PATH__": [], "x": 4, "y": 3},
+            {"__ROW_PATH__": ["a"], "x": 3, "y": 2},
+            {"__ROW_PATH__": ["b"], "x": 5, "y": 1}
+        ]
+        tbl.remove([1, 2])
+        tbl.update([{"k": 4, "x": 1}])
+        assert view.to_records() == [
+            {"__ROW_PATH__": [], "x": 3, "y": 2},
+            {"__ROW_PATH__": ["a"], "x": 3, "y": 1},
+            {"__ROW_PATH__": ["b"], "x": 1, "y": 1}
+        ]
+
+    def test_view_aggregate_min_max_after_updates(self):
+        data = [
+            {"k": 1, "a": "a", "x": 1, "z": 1},
+            {"k": 2, "a": "a", "x": 5, "z": 5},
+            {"k": 3, "a": "b", "x": 3, "z": 3}
+        ]
+        tbl = Table(data, index="k")
+        view = tbl.view(
+            aggregates={"x": "min", "z": "max"},
+            row_pivots=["a"],
+            columns=["x", "z"]
+        )
+        assert view.to_records() == [
+            {"__ROW_PATH__": [], "x": 1, "z": 5},
+            {"__ROW_PATH__": ["a"], "x": 1, "z": 5},
+            {"__ROW_PATH__": ["b"], "x": 3, "z": 3}
+        ]
+        tbl.update([{"k": 1, "x": 4}, {"k": 2, "z": 2}])
+        assert view.to_records() == [
+            {"__ROW_PATH__": [], "x": 3, "z": 3},
+            {"__ROW_PATH__": ["a"], "x": 4, "z": 2},
+            {"__ROW_PATH__": ["b"], "x": 3, "z": 3}
+        ]
+        tbl.remove([3])
+        assert view.to_records() == [
+            {"__ROW_PATH__": [], "x": 4, "z": 2},
+            {"__ROW_PATH__": ["a"], "x": 4, "z": 2}
+        ]
+
+    def test_view_aggregate_min_max_skip_nulls(self):
+        tbl = Table({"a": ["a", "a", "b"], "x": [None, 2.5, None]})
+        view = tbl.view(
+            aggregates={"x": "min"},
+            row_pivots=["a"],
+            columns=["x"]
+        )
+        assert view.to_dict() == {
+            "__ROW_PATH__": [[], ["a"], ["b"]],
+            "x": [2.5, 2.5, None]
+        }
+
+    def test_view_aggregate_and_or_after_updates(self):
+        data = [
+            {"k": 1, "a": "x", "b": "p", "f": True, "g": True},
+            {"k": 2, "a": "x", "b": "q", "f": False, "g": True},
+            {"k": 3, "a": "y", "b": "p", "f": True, "g": True}
+        ]
+        tbl = Table(data, index="k")
+        view = tbl.view(
+            aggregates={"f": "and", "g": "or"},
+            row_pivots=["a", "b"],
+            columns=["f", "g"]
+        )
+        tbl.update([{"k": 1, "f": False}, {"k": 4, "a": "x", "b": "p", "f": True, "g": True}])
+        assert view.to_dict() == {
+            "__ROW_PATH__": [[], ["x"], ["x", "p"], ["x", "q"], ["y"], ["y", "p"]],
+            "f": [False, False, False, False, True, True],
+            "g": [True, True, True, True, True, True]
+        }
+        tbl.update([{"k": 2, "f": True}, {"k": 1, "a": "y"}])
+        assert view.to_dict() == {
+            "__ROW_PATH__": [[], ["x"], ["x", "p"], ["x", "q"], ["y"], ["y", "p"]],
+            "f": [False, True, True, True, False, False],
+            "g": [True, True, True, True, True, True]
+        }
+
+    def test_view_aggregate_approx_distinct_count(self):
+        data = [{"a": "ab"[i % 2], "y": i % 1000} for i in range(5000)]
+        tbl = Table(data)
+        view = tbl.view(
+            aggregates={"y": "approx distinct count"},
+            row_pivots=["a"],
+            columns=["y"]
+        )
+        records = view.to_records()
+        assert [r["__ROW_PATH__"] for r in records] == [[], ["a"], ["b"]]
+        for record, exact in zip(records, [1000, 500, 500]):
+            assert abs(record["y"] - exact) <= exact * 0.05
+
+    def test_view_aggregate_approx_distinct_count_after_remove(self):
+        data = [{"k": i, "a": "ab"[i % 2], "y": str(i)} for i in range(100)]
+        tbl = Table(data, index="k")
+        view = tbl.view(
+            aggregates={"y": "approx distinct count"},
+            row_pivots=["a"],
+            columns=["y"]
+        )
+        records = view.to_records()
+        for record, exact in zip(records, [100, 50, 50]):
+            assert abs(record["y"] - exact) <= 2
+        # Removing most of the rows rebuilds each sketch from those left.
+        tbl.remove(list(range(80)))
+        assert view.to_records() == [
+            {"__ROW_PATH__": [], "y": 20},
+            {"__ROW_PATH__": ["a"], "y": 10},
+            {"__ROW_PATH__": ["b"], "y": 10}
+        ]
+
+    def test_view_aggregate_approx_percentile(self):
+        data = {"a": ["ab"[i % 2] for i in range(2000)], "x": list(range(2000)), "y": list(range(2000))}
+        tbl = Table(data)
+        view = tbl.view(
+            aggregates={"x": "approx p90", "y": ["approx percentile", "25"]},
+            row_pivots=["a"]
+        )
+        records = view.to_records()
+        assert [r["__ROW_PATH__"] for r in records] == [[], ["a"], ["b"]]
+        for record in records:
+            assert abs(record["x"] - 1800) <= 20
+            assert abs(record["y"] - 500) <= 20
+
+    def test_view_aggregate_approx_percentile_after_updates(self):
+        data = [{"k": i, "a": "ab"[i % 2], "x": float(i)} for i in range(1000)]
+        tbl = Table(data, index="k")
+        view = tbl.view(aggregates={"x": "approx p50"}, row_pivots=["a"], columns=["x"])
+        tbl.update([{"k": i, "x": float(i + 1000)} for i in range(200)])
+        tbl.remove(list(range(800, 1000)))
+        exact = sorted([float(i) for i in range(200, 800)] + [float(i + 1000) for i in range(200)])
+        assert abs(view.to_records()[0]["x"] - exact[len(exact) // 2]) <= 10
+
+    def test_view_aggregate_approx_percentile_invalid(self):
+        tbl = Table({"a": ["x"], "b": [1.5]})
+        with raises(PerspectiveCppError):
+            tbl.view(row_pivots=["a"], aggregates={"b": "approx p101"})
+
+    def test_view_aggregate_rolling_sum_expires(self):
+        start = datetime(2020, 1, 1)
+        data = {
+            "a": ["ab"[i % 2] for i in range(10)],
+            "t": [start + timedelta(minutes=i) for i in range(10)],
+            "x": [1.0] * 10
+        }
+        tbl = Table(data)
+        view = tbl.view(
+            aggregates={"x": ["rolling sum", "t", "5m"]},
+            row_pivots=["a"],
+            columns=["x"]
+        )
+        assert view.to_records() == [
+            {"__ROW_PATH__": [], "x": 5},
+            {"__ROW_PATH__": ["a"], "x": 2},
+            {"__ROW_PATH__": ["b"], "x": 3}
+        ]
+        # Rows expire from "b" though only "a" is updated.
+        tbl.update({"a": ["a"], "t": [start + timedelta(minutes=12)], "x": [1.0]})
+        assert view.to_records() == [
+            {"__ROW_PATH__": [], "x": 3},
+            {"__ROW_PATH__": ["a"], "x": 2},
+            {"__ROW_PATH__": ["b"], "x": 1}
+        ]
+
+    def test_view_aggregate_rolling_weighted_mean_after_updates(self):
+        data = [{"k": i, "t": i, "p": float(i % 7), "w": float(i % 3 + 1)} for i in range(20)]
+        tbl = Table(data, index="k")
+        view = tbl.view(
+            aggregates={"p": ["rolling weighted mean", "t", "10", "w"]},
+            row_pivots=["k"],
+            columns=["p"]
+        )
+
+        def vwap(rows):
+            return sum(r["p"] * r["w"] for r in rows) / sum(r["w"] for r in rows)
+
+        assert abs(view.to_records()[0]["p"] - vwap(data[10:])) < 1e-9
+        tbl.update([{"k": 15, "p": 100.0}])
+        tbl.remove([19])
+        data[15]["p"] = 100.0
+        assert abs(view.to_records()[0]["p"] - vwap(data[10:19])) < 1e-9
+
+    def test_view_aggregate_rolling_invalid_window(self):
+        tbl = Table({"a": ["x"], "t": [1], "b": [1.5]})
+        with raises(PerspectiveCppError):
+            tbl.view(row_pivots=["a"], aggregates={"b": ["rolling sum", "t", "5m"]})
+
     # sort
 
     def test_view_sort_int(self):
@@ -452,6 +820,31 @@ class TestView(object):
         view = tbl.view(sort=[["a", "desc"]], columns=["b"])
         assert view.to_records() == [{"b": 4}, {"b": 2}]
 
+    def test_view_sort_appended_in_order(self):
+        tbl = Table({"t": [1, 2], "b": [1, 2]})
+        asc = tbl.view(sort=[["t", "asc"]])
+        desc = tbl.view(sort=[["t", "desc"]])
+        tbl.update({"t": [3, 4, 5], "b": [3, 4, 5]})
+        tbl.update({"t": [6], "b": [6]})
+        assert asc.to_columns()["t"] == [1, 2, 3, 4, 5, 6]
+        assert desc.to_columns()["t"] == [6, 5, 4, 3, 2, 1]
+
+    def test_view_sort_appended_out_of_order(self):
+        tbl = Table({"t": [2, 4], "b": [1, 2]})
+        view = tbl.view(sort=[["t", "asc"]])
+        tbl.update({"t": [5, 3, 6], "b": [3, 4, 5]})
+        tbl.update({"t": [1, 0], "b": [6, 7]})
+        tbl.update({"t": [7, 8], "b": [8, 9]})
+        assert view.to_columns()["t"] == [0, 1, 2, 3, 4, 5, 6, 7, 8]
+
+    def test_view_sort_appended_with_updates(self):
+        tbl = Table({"id": [1, 2], "t": [1, 2]}, index="id")
+        view = tbl.view(sort=[["t", "asc"]])
+        tbl.update({"id": [1, 3, 4], "t": [10, 3, 4]})
+        assert view.to_columns()["t"] == [2, 3, 4, 10]
+        tbl.update({"id": [5, 6], "t": [11, 12]})
+        assert view.to_columns()["id"] == [2, 3, 4, 1, 5, 6]
+
     # filter
 
     def test_view_filter_int_eq(self):
@@ -598,6 +991,138 @@ class TestView(object):
         view = tbl.view(filter=[["a", "is not null"]])
         assert view.to_records() == [{"a": "abc", "b": 4}]
 
+    def test_view_filter_multiple_with_nulls(self):
+        data = [
+            {"a": 1.5, "b": "abc", "c": 1},
+            {"a": None, "b": "def", "c": 2},
+            {"a": 3.5, "b": None, "c": 3},
+            {"a": 2.5, "b": "abc", "c": None},
+            {"a": 0.5, "b": "ghi", "c": 5}
+        ]
+        tbl = Table(data)
+        view = tbl.view(filter=[["a", "<", 3], ["b", "!=", "def"], ["c", ">=", 1]])
+        assert view.to_records() == [
+            {"a": 1.5, "b": "abc", "c": 1},
+            {"a": 0.5, "b": "ghi", "c": 5}
+        ]
+        view2 = tbl.view(filter=[["b", "in", ["abc", "ghi"]], ["a", "is not null"]])
+        assert view2.to_records() == [
+            {"a": 1.5, "b": "abc", "c": 1},
+            {"a": 2.5, "b": "abc", "c": None},
+            {"a": 0.5, "b": "ghi", "c": 5}
+        ]
+
+    def test_view_filter_in_large_bags(self):
+        data = {"a": list(range(20)), "b": ["s{}".format(i) for i in range(20)]}
+        tbl = Table(data)
+        bag = [1, 3, 5, 7, 9, 11, 13, 15, 17, 100]
+        view = tbl.view(filter=[["a", "in", bag]])
+        assert view.to_dict()["a"] == [1, 3, 5, 7, 9, 11, 13, 15, 17]
+        view2 = tbl.view(filter=[["b", "not in", ["s{}".format(i) for i in bag]]])
+        assert view2.to_dict()["a"] == [0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 19]
+
+    def test_view_filter_string_in_updates(self):
+        tbl = Table({"a": ["abc", "def"], "b": [1, 2]}, index="b")
+        view = tbl.view(filter=[["a", "in", ["ghi", "abc"]]])
+        assert view.to_dict() == {"a": ["abc"], "b": [1]}
+        tbl.update({"a": ["ghi", None], "b": [3, 4]})
+        assert view.to_dict() == {"a": ["abc", "ghi"], "b": [1, 3]}
+        tbl.update({"a": ["xyz"], "b": [1]})
+        assert view.to_dict() == {"a": ["ghi"], "b": [3]}
+
+    def test_view_filter_selective_across_mask_chunks(self):
+        # Spans several 2^16 row chunks of a filter mask, both sparse and
+        # dense.
+        size = 200000
+        tbl = Table({"a": list(range(size)), "b": [i % 2 for i in range(size)]})
+        view = tbl.view(filter=[["a", "in", [5, 70000, 199999]]])
+        assert view.to_dict()["a"] == [5, 70000, 199999]
+        view2 = tbl.view(filter=[["b", "==", 1], ["a", ">", 65530]])
+        assert view2.num_rows() == (size - 65531) // 2
+        view3 = tbl.view(filter=[["a", ">", 199997]])
+        assert view3.to_dict()["a"] == [199998, 199999]
+
+    def test_view_filter_column_to_column(self):
+        tbl = Table({"bid": [1.5, 2.5, 3.5], "ask": [2.0, 2.0, 3.5]})
+        assert tbl.view(filter=[["bid", ">", {"column": "ask"}]]).to_dict() == {
+            "bid": [2.5], "ask": [2.0]
+        }
+        assert tbl.view(filter=[["bid", ">=", {"column": "ask"}]]).to_dict()["bid"] == [2.5, 3.5]
+        assert tbl.view(filter=[["bid", "!=", {"column": "ask"}]]).to_dict()["bid"] == [1.5, 2.5]
+
+    def test_view_filter_column_to_column_mixed_types(self):
+        tbl = Table({"a": [1, 2, 3], "b": [1.5, 2.0, 2.5]})
+        view = tbl.view(filter=[["a", "<=", {"column": "b"}]])
+        assert view.to_dict() == {"a": [1, 2], "b": [1.5, 2.0]}
+
+    def test_view_filter_column_to_column_strings(self):
+        tbl = Table({"a": ["x", "y", "z"], "b": ["x", "z", "y"]})
+        view = tbl.view(filter=[["a", "==", {"column": "b"}]])
+        assert view.to_dict() == {"a": ["x"], "b": ["x"]}
+
+    def test_view_filter_column_to_column_null(self):
+        tbl = Table({"a": [1, None, 3], "b": [0, 0, None]})
+        view = tbl.view(filter=[["a", ">", {"column": "b"}]])
+        assert view.to_dict() == {"a": [1], "b": [0]}
+        view2 = tbl.view(filter=[["a", "!=", {"column": "b"}]], filter_op="or")
+        assert view2.to_dict() == {"a": [1], "b": [0]}
+
+    def test_view_filter_nested_groups(self):
+        tbl = Table({
+            "sym": ["a", "b", "c", "d"],
+            "bid": [1, 2, 3, 4],
+            "ask": [2, 1, 4, 3],
+            "halted": [True, False, False, True]
+        })
+        view = tbl.view(columns=["sym"], filter=[
+            {"or": [
+                ["bid", ">", {"column": "ask"}],
+                {"and": [["halted", "==", True], ["sym", "in", ["a", "c"]]]}
+            ]},
+            ["bid", "<", 4]
+        ])
+        assert view.to_dict() == {"sym": ["a", "b"]}
+
+    def test_view_filter_expression_filter_op(self):
+        tbl = Table({"a": [1, 2, 3, 4], "b": [4, 3, 2, 1]})
+        view = tbl.view(filter=[["a", ">", {"column": "b"}], ["a", "==", 1]], filter_op="or")
+        assert view.to_dict()["a"] == [1, 3, 4]
+
+    def test_view_filter_expression_drops_invalid_terms(self):
+        tbl = Table({"a": [1, 2, 3], "b": [3, 2, 1]})
+        view = tbl.view(filter=[{"and": [["a", "==", None], ["a", "<", {"column": "b"}]]}])
+        assert view.to_dict()["a"] == [1]
+
+    def test_view_filter_column_to_column_updates(self):
+        tbl = Table({"id": [1, 2, 3], "bid": [1.0, 2.0, 3.0], "ask": [2.0, 2.0, 2.0]}, index="id")
+        view = tbl.view(filter=[["bid", ">", {"column": "ask"}]])
+        pivoted = tbl.view(row_pivots=["id"], columns=["bid"], filter=[
+            {"or": [["bid", ">", {"column": "ask"}], ["id", "==", 1]]}
+        ])
+        assert view.to_dict()["id"] == [3]
+        tbl.update({"id": [1, 3, 4], "bid": [1.0, 3.0, 5.0], "ask": [0.5, 4.0, 1.0]})
+        assert view.to_dict()["id"] == [1, 4]
+        assert pivoted.to_dict() == {
+            "__ROW_PATH__": [[], [1], [4]],
+            "bid": [6.0, 1.0, 5.0]
+        }
+
+    def test_view_filter_unchanged_filter_columns(self):
+        tbl = Table({"id": [1, 2, 3], "desk": ["x", "y", "x"], "price": [1.0, 2.0, 3.0]}, index="id")
+        view = tbl.view(filter=[["desk", "==", "x"]])
+        pivoted = tbl.view(row_pivots=["desk"], columns=["price"], filter=[["desk", "==", "x"]])
+        tbl.update({"id": [1, 2], "price": [10.0, 20.0]})
+        assert view.to_dict() == {"id": [1, 3], "desk": ["x", "x"], "price": [10.0, 3.0]}
+        assert pivoted.to_dict() == {"__ROW_PATH__": [[], ["x"]], "price": [13.0, 13.0]}
+        tbl.update({"id": [2, 3], "desk": ["x", "y"], "price": [20.0, 30.0]})
+        assert view.to_dict() == {"id": [1, 2], "desk": ["x", "x"], "price": [10.0, 20.0]}
+        assert pivoted.to_dict() == {"__ROW_PATH__": [[], ["x"]], "price": [30.0, 30.0]}
+
+    def test_view_filter_column_to_missing_column(self):
+        tbl = Table({"a": [1, 2, 3]})
+        with raises(PerspectiveCppError):
+            tbl.view(filter=[["a", ">", {"column": "b"}]])
+
     # on_update
     def test_view_on_update(self, sentinel):
         s = sentinel(False)
@@ -629,6 +1154,217 @@ class TestView(object):
         tbl.update(data)
         assert s.get() == 0
 
+    # priority
+
+    def test_view_priority_default(self):
+        tbl = Table({"a": [1, 2]})
+        view = tbl.view()
+        assert view.get_priority() == "visible"
+
+    def test_view_priority_invalid(self):
+        tbl = Table({"a": [1, 2]})
+        view = tbl.view()
+        with raises(ValueError):
+            view.set_priority("hidden")
+
+    def test_view_priority_visible_before_background(self):
+        order = []
+        tbl = Table({"a": [1, 2]})
+        background = tbl.view()
+        background.set_priority("background")
+        visible = tbl.view()
+        background.on_update(lambda port_id: order.append("background"))
+        visible.on_update(lambda port_id: order.append("visible"))
+        tbl.update({"a": [3]})
+        assert order == ["visible", "background"]
+
+    def test_view_priority_paused(self, sentinel):
+        s = sentinel(0)
+
+        def callback(port_id):
+            s.set(s.get() + 1)
+
+        tbl = Table({"a": [1, 2], "b": ["x", "y"]}, index="a")
+        view = tbl.view(row_pivots=["b"], columns=["a"])
+        view.on_update(callback)
+        view.set_priority("paused")
+        tbl.update({"a": [1], "b": ["y"]})
+        tbl.update({"a": [3], "b": ["z"]})
+        assert s.get() == 0
+        view.set_priority("visible")
+        assert s.get() == 1
+        assert view.to_columns() == {
+            "__ROW_PATH__": [[], ["y"], ["z"]],
+            "a": [6, 3, 3]
+        }
+
+    def test_view_priority_resume_without_updates(self, sentinel):
+        s = sentinel(0)
+
+        def callback(port_id):
+            s.set(s.get() + 1)
+
+        tbl = Table({"a": [1, 2]})
+        view = tbl.view()
+        view.on_update(callback)
+        view.set_priority("paused")
+        view.set_priority("visible")
+        assert s.get() == 0
+
+    # freeze
+
+    def test_view_freeze(self, sentinel):
+        s = sentinel(0)
+
+        def callback(port_id):
+            s.set(s.get() + 1)
+
+        tbl = Table({"a": [1, 2], "b": ["x", "y"]}, index="a")
+        view = tbl.view(row_pivots=["b"], columns=["a"])
+        view.on_update(callback)
+        view.freeze()
+        assert view.is_frozen()
+        tbl.update({"a": [3], "b": ["z"]})
+        assert s.get() == 0
+        assert view.to_columns() == {
+            "__ROW_PATH__": [[], ["x"], ["y"]],
+            "a": [3, 1, 2]
+        }
+        assert view.thaw()
+        assert not view.is_frozen()
+        assert s.get() == 1
+        assert view.to_columns() == {
+            "__ROW_PATH__": [[], ["x"], ["y"], ["z"]],
+            "a": [6, 1, 2, 3]
+        }
+        tbl.update({"a": [4], "b": ["z"]})
+        assert s.get() == 2
+
+    def test_view_freeze_thaw_without_updates(self, sentinel):
+        s = sentinel(0)
+
+        def callback(port_id):
+            s.set(s.get() + 1)
+
+        tbl = Table({"a": [1, 2]})
+        view = tbl.view()
+        view.on_update(callback)
+        view.freeze()
+        assert not view.thaw()
+        assert s.get() == 0
+
+    def test_view_freeze_shared_tree(self):
+        tbl = Table({"a": [1, 2], "b": ["x", "y"]}, index="a")
+        view = tbl.view(row_pivots=["b"], columns=["a"])
+        other = tbl.view(row_pivots=["b"], columns=["a"])
+        view.freeze()
+        tbl.update({"a": [3], "b": ["z"]})
+        assert view.to_columns() == {
+            "__ROW_PATH__": [[], ["x"], ["y"]],
+            "a": [3, 1, 2]
+        }
+        assert other.to_columns() == {
+            "__ROW_PATH__": [[], ["x"], ["y"], ["z"]],
+            "a": [6, 1, 2, 3]
+        }
+        view.thaw()
+        assert view.to_columns() == other.to_columns()
+
+    # update interval
+
+    def test_view_update_interval_coalesces_row_deltas(self):
+        deltas = []
+        tbl = Table({"a": [1, 2, 3], "b": ["x", "y", "z"]}, index="a")
+        view = tbl.view()
+        view.set_update_interval(0.05)
+        assert view.get_update_interval() == 0.05
+        view.on_update(lambda port_id, delta: deltas.append(delta), mode="row")
+        tbl.update({"a": [1], "b": ["p"]})
+        assert len(deltas) == 1
+        tbl.update({"a": [2], "b": ["q"]})
+        tbl.update({"a": [4], "b": ["r"]})
+        assert len(deltas) == 1
+        time.sleep(0.06)
+        assert tbl.size() == 4
+        assert len(deltas) == 2
+        assert Table(deltas[1]).view().to_dict() == {"a": [2, 4], "b": ["q", "r"]}
+
+    def test_view_update_interval_invalid(self):
+        view = Table({"a": [1, 2]}).view()
+        with raises(ValueError):
+            view.set_update_interval(-1)
+
+    # progressive
+
+    def test_view_progressive_one(self, monkeypatch):
+        monkeypatch.setattr(view_module, "_BUILD_CHUNK_ROWS", 3)
+        data = {"a": list(range(10)), "b": ["x", "y", "z", "x", "y"] * 2}
+        tbl = Table(data)
+        view = tbl.view(row_pivots=["b"], progressive=True)
+        view.wait()
+        assert view.get_progress() == 1
+        assert view.to_columns() == tbl.view(row_pivots=["b"]).to_columns()
+
+    def test_view_progressive_two(self, monkeypatch):
+        monkeypatch.setattr(view_module, "_BUILD_CHUNK_ROWS", 3)
+        data = {"a": list(range(10)), "b": ["x", "y", "z", "x", "y"] * 2}
+        tbl = Table(data)
+        view = tbl.view(row_pivots=["b"], column_pivots=["b"], progressive=True)
+        view.wait()
+        expected = tbl.view(row_pivots=["b"], column_pivots=["b"])
+        assert view.to_columns() == expected.to_columns()
+
+    def test_view_progressive_zero(self, monkeypatch):
+        monkeypatch.setattr(view_module, "_BUILD_CHUNK_ROWS", 3)
+        data = {"a": list(range(10))}
+        tbl = Table(data)
+        view = tbl.view(sort=[["a", "desc"]], progressive=True)
+        view.wait()
+        assert view.to_columns() == {"a": list(range(9, -1, -1))}
+
+    def test_view_progressive_updates_once_built(self):
+        tbl = Table({"a": [1, 2, 3], "b": ["x", "y", "x"]})
+        view = tbl.view(row_pivots=["b"], progressive=True)
+        view.wait()
+        tbl.update({"a": [4], "b": ["y"]})
+        assert view.to_columns() == {
+            "__ROW_PATH__": [[], ["x"], ["y"]],
+            "a": [10, 4, 6],
+            "b": [4, 2, 2]
+        }
+
+    def test_view_progressive_empty_table(self):
+        tbl = Table({"a": int})
+        view = tbl.view(row_pivots=["a"], progressive=True)
+        view.wait()
+        assert view.get_progress() == 1
+        tbl.update({"a": [1, 2]})
+        assert view.to_columns() == {
+            "__ROW_PATH__": [[], [1], [2]],
+            "a": [3, 1, 2]
+        }
+
+    # estimate_view_cost
+
+    def test_view_estimate_cost_groups(self):
+        tbl = Table({"a": list(range(10)), "b": ["x", "y", "z", "x", "y"] * 2})
+        estimate = tbl.estimate_view_cost(row_pivots=["b"])
+        assert estimate["rows"] == 10
+        assert estimate["groups"] == 3
+
+    def test_view_estimate_cost_grows_with_pivots(self):
+        tbl = Table({"a": list(range(10)), "b": ["x", "y", "z", "x", "y"] * 2})
+        flat = tbl.estimate_view_cost()["cost"]
+        one = tbl.estimate_view_cost(row_pivots=["b"])["cost"]
+        two = tbl.estimate_view_cost(row_pivots=["b"], column_pivots=["a"])["cost"]
+        assert flat < one < two
+
+    def test_view_estimate_cost_grows_with_aggregates(self):
+        tbl = Table({"a": list(range(10)), "b": ["x", "y", "z", "x", "y"] * 2})
+        sum_cost = tbl.estimate_view_cost(row_pivots=["b"], aggregates={"a": "sum"})["cost"]
+        median_cost = tbl.estimate_view_cost(row_pivots=["b"], aggregates={"a": "median"})["cost"]
+        assert sum_cost < median_cost
+
     # on_delete
 
     def test_view_on_delete(self, sentinel):
@@ -674,6 +1410,66 @@ class TestView(object):
         tbl.update(data)
         assert s.get() == 2
 
+    def test_view_delete_shared_pivot_tree(self):
+        data = [{"a": 1, "b": 2}, {"a": 3, "b": 4}]
+        tbl = Table(data)
+        v1 = tbl.view(row_pivots=["a"])
+        v2 = tbl.view(row_pivots=["a"], sort=[["b", "desc"]])
+        tbl.update([{"a": 1, "b": 10}])
+        assert v1.to_dict() == {
+            "__ROW_PATH__": [[], [1], [3]],
+            "a": [5, 2, 3],
+            "b": [16, 12, 4]
+        }
+        assert v2.to_dict() == {
+            "__ROW_PATH__": [[], [1], [3]],
+            "a": [5, 2, 3],
+            "b": [16, 12, 4]
+        }
+        v1.delete()
+        tbl.update([{"a": 5, "b": 20}])
+        assert v2.to_dict() == {
+            "__ROW_PATH__": [[], [5], [1], [3]],
+            "a": [10, 5, 2, 3],
+            "b": [36, 20, 12, 4]
+        }
+
+    def test_view_delete_retained_pivot_tree(self):
+        data = [{"a": 1, "b": 2}, {"a": 3, "b": 4}]
+        tbl = Table(data)
+        v1 = tbl.view(row_pivots=["a"])
+        v1.delete()
+        tbl.update([{"a": 1, "b": 10}])
+        v2 = tbl.view(row_pivots=["a"])
+        assert v2.to_dict() == {
+            "__ROW_PATH__": [[], [1], [3]],
+            "a": [5, 2, 3],
+            "b": [16, 12, 4]
+        }
+        tbl.update([{"a": 5, "b": 20}])
+        assert v2.to_dict() == {
+            "__ROW_PATH__": [[], [1], [3], [5]],
+            "a": [10, 2, 3, 5],
+            "b": [36, 12, 4, 20]
+        }
+
+    def test_view_delete_retained_pivot_tree_computed(self):
+        data = [{"a": 1, "b": 2}, {"a": 3, "b": 4}]
+        tbl = Table(data)
+        computed = [{
+            "column": "c",
+            "computed_function_name": "+",
+            "inputs": ["a", "b"]
+        }]
+        v1 = tbl.view(row_pivots=["a"], columns=["c"], computed_columns=computed)
+        v1.delete()
+        tbl.update([{"a": 1, "b": 10}])
+        v2 = tbl.view(row_pivots=["a"], columns=["c"], computed_columns=computed)
+        assert v2.to_dict() == {
+            "__ROW_PATH__": [[], [1], [3]],
+            "c": [21, 14, 7]
+        }
+
     def test_view_delete_full_cleanup(self, sentinel):
         s = sentinel(0)
 
@@ -774,6 +1570,230 @@ class TestView(object):
         view.on_update(cb1, mode="row")
         tbl.update(update_data)
 
+    def test_view_row_delta_one_viewport(self, util):
+        data = [{"a": 1, "b": 2}, {"a": 3, "b": 4}]
+        update_data = {
+            "a": [5],
+            "b": [6]
+        }
+
+        def cb1(port_id, delta):
+            compare_delta(delta, {
+                "a": [9],
+                "b": [12]
+            })
+            assert view.row_count_changed()
+
+        tbl = Table(data)
+        view = tbl.view(row_pivots=["a"])
+        view.set_viewport(0, 1)
+        view.on_update(cb1, mode="row")
+        tbl.update(update_data)
+
+    def test_view_row_delta_two_sorted_viewport_columns(self, util):
+        data = {"id": [0, 1], "g": ["a", "b"], "c": ["x", "y"], "v": [1, 2], "w": [3, 4]}
+        deltas = []
+
+        def cb1(port_id, delta):
+            deltas.append(Table(delta).size())
+
+        tbl = Table(data, index="id")
+        view = tbl.view(row_pivots=["g"], column_pivots=["c"], columns=["v", "w"],
+                        sort=[["v", "desc"]])
+        paths = view.column_paths()
+        assert paths[0] == "__ROW_PATH__"
+        start_col = paths.index("y|v")
+        assert paths[start_col + 1] == "y|w"
+        view.set_viewport(start_col=start_col, end_col=start_col + 2)
+        view.on_update(cb1, mode="row")
+
+        # The sorted context has total columns the view hides, which must not
+        # shift the viewport onto the columns of `x`.
+        tbl.update({"id": [0], "v": [10]})
+        tbl.update({"id": [1], "v": [20]})
+        assert len(deltas) == 2
+        assert deltas[0] == 0
+        assert deltas[1] > 0
+
+    def test_view_row_delta_zero_sorted_order(self, util):
+        data = {"a": [1, 2, 3, 4], "b": [10, 20, 30, 40]}
+        deltas = []
+
+        def cb1(port_id, delta):
+            deltas.append(delta)
+
+        tbl = Table(data, index="a")
+        view = tbl.view(sort=[["b", "desc"]])
+        view.on_update(cb1, mode="row")
+        tbl.update({"a": [1, 4, 2], "b": [15, 45, 25]})
+        assert len(deltas) == 1
+        compare_delta(deltas[0], {"a": [4, 2, 1], "b": [45, 25, 15]})
+
+    def _sort_limit_views(self, n=2000, end_row=50):
+        rng = np.random.RandomState(7)
+        tbl = Table({
+            "id": list(range(n)),
+            "x": [int(v) for v in rng.randint(0, 100, n)],
+            "y": ["s{}".format(v) for v in rng.randint(0, 20, n)]
+        }, index="id")
+        sort = [["x", "desc"], ["y", "asc"]]
+        limited = tbl.view(sort=sort)
+        full = tbl.view(sort=sort)
+        limited.set_viewport(0, end_row)
+        return tbl, limited, full, rng
+
+    def test_view_viewport_sort_limit_top_rows_match_full_sort(self):
+        tbl, limited, full, _ = self._sort_limit_views()
+        assert limited.to_dict(end_row=50) == full.to_dict(end_row=50)
+        assert limited.to_dict() == full.to_dict()
+
+    def test_view_viewport_sort_limit_after_updates(self):
+        n = 2000
+        tbl, limited, full, rng = self._sort_limit_views(n)
+        for step in range(10):
+            ids = [int(v) for v in rng.randint(0, n + 200, 100)]
+            tbl.update({
+                "id": ids,
+                "x": [int(v) for v in rng.randint(0, 110, 100)],
+                "y": ["s{}".format(v) for v in rng.randint(0, 20, 100)]
+            })
+            tbl.remove([int(v) for v in rng.randint(0, n, 20)])
+            assert limited.num_rows() == full.num_rows()
+            assert limited.to_dict(end_row=50) == full.to_dict(end_row=50)
+        assert limited.to_dict(start_row=40, end_row=400) == \
+            full.to_dict(start_row=40, end_row=400)
+        assert limited.to_dict() == full.to_dict()
+
+    def test_view_viewport_sort_limit_moved_and_cleared(self):
+        tbl, limited, full, rng = self._sort_limit_views()
+        limited.set_viewport(100, 120)
+        assert limited.to_dict(start_row=100, end_row=120) == \
+            full.to_dict(start_row=100, end_row=120)
+        limited.set_viewport(0, 10)
+        tbl.update({"id": [0, 1, 2], "x": [1000, -1, 50], "y": ["a", "b", "c"]})
+        assert limited.to_dict(end_row=10) == full.to_dict(end_row=10)
+        limited.clear_viewport()
+        tbl.update({"id": [3], "x": [-5], "y": ["d"]})
+        assert limited.to_dict() == full.to_dict()
+
+    def test_view_row_delta_one_nested_order(self, util):
+        data = {"a": ["x", "y", "x"], "b": ["p", "q", "q"], "c": [1, 2, 3]}
+        deltas = []
+
+        def cb1(port_id, delta):
+            deltas.append(delta)
+
+        tbl = Table(data)
+        view = tbl.view(row_pivots=["a", "b"], columns=["c"])
+        view.on_update(cb1, mode="row")
+        tbl.update({"a": ["y", "x"], "b": ["q", "p"], "c": [10, 20]})
+        assert len(deltas) == 1
+
+        # the root, then each changed node once, in the order of the view
+        compare_delta(deltas[0], {"c": [36, 24, 21, 12, 12]})
+
+    def test_view_aggregates_after_relayout(self):
+        # Enough nodes, allocated depth first and then churned by removes
+        # and new groups, for the tree to lay its aggregates out again.
+        n = 3000
+        data = {
+            "id": list(range(n)),
+            "g": ["g{}".format(i % 7) for i in range(n)],
+            "x": [i % 13 for i in range(n)]
+        }
+        tbl = Table(data, index="id")
+        aggregates = {"x": "median", "id": "count"}
+        view = tbl.view(row_pivots=["g", "id"], columns=["x", "id"], aggregates=aggregates)
+        tbl.remove(list(range(0, n, 2)))
+        tbl.update({
+            "id": list(range(n, 2 * n)),
+            "g": ["h{}".format(i % 11) for i in range(n)],
+            "x": [i % 17 for i in range(n)]
+        })
+
+        expected = Table(tbl.view().to_dict(), index="id")
+        expected_view = expected.view(
+            row_pivots=["g", "id"], columns=["x", "id"], aggregates=aggregates)
+        assert view.to_dict() == expected_view.to_dict()
+
+    def test_view_histogram_fixed_width(self):
+        data = {"a": [0, 1.5, 3, None, 6, 7.5, 9, 10.5, 12, 13.5]}
+        tbl = Table(data)
+        view = tbl.view()
+        assert view.histogram("a", bins=4) == [
+            {"begin": 0, "end": 3.375, "count": 3},
+            {"begin": 3.375, "end": 6.75, "count": 1},
+            {"begin": 6.75, "end": 10.125, "count": 2},
+            {"begin": 10.125, "end": 13.5, "count": 3}
+        ]
+
+    def test_view_histogram_quantile(self):
+        data = {"a": [0, 1.5, 3, None, 6, 7.5, 9, 10.5, 12, 13.5]}
+        tbl = Table(data)
+        view = tbl.view()
+        assert view.histogram("a", bins=4, quantile=True) == [
+            {"begin": 0, "end": 1.5, "count": 2},
+            {"begin": 3, "end": 6, "count": 2},
+            {"begin": 7.5, "end": 9, "count": 2},
+            {"begin": 10.5, "end": 13.5, "count": 3}
+        ]
+
+    def test_view_histogram_row_pivots(self):
+        data = {"a": [1, 2, 3, 4], "b": ["x", "x", "y", "y"]}
+        tbl = Table(data)
+        view = tbl.view(row_pivots=["b"])
+        assert view.histogram("a", bins=1) == [
+            {"begin": 1, "end": 4, "count": 4}
+        ]
+        assert view.histogram("a", bins=2, row=2) == [
+            {"begin": 3, "end": 3.5, "count": 1},
+            {"begin": 3.5, "end": 4, "count": 1}
+        ]
+
+    def test_view_histogram_after_update(self):
+        tbl = Table({"a": [1, 2]})
+        view = tbl.view(filter=[["a", ">", 1]])
+        tbl.update({"a": [3, 4]})
+        assert view.histogram("a", bins=1) == [
+            {"begin": 2, "end": 4, "count": 3}
+        ]
+
+    def test_view_histogram_string_column(self):
+        tbl = Table({"a": ["x", "y"]})
+        view = tbl.view()
+        assert view.histogram("a") == []
+
+    def test_view_min_max_skips_nulls(self):
+        tbl = Table({"a": [None, 2.5, -1.5, None, 4.0], "b": [3, None, 1, 9, None]})
+        view = tbl.view()
+        assert view.min_max("a") == {"min": -1.5, "max": 4.0}
+        assert view.min_max("b") == {"min": 1, "max": 9}
+
+    def test_view_min_max_no_valid_values(self):
+        tbl = Table({"a": float, "b": str})
+        tbl.update({"a": [None, None], "b": ["x", "y"]})
+        view = tbl.view()
+        assert view.min_max("a") == {"min": None, "max": None}
+        assert view.min_max("b") == {"min": None, "max": None}
+
+    def test_view_min_max_filtered_after_update_and_remove(self):
+        tbl = Table({"i": [0, 1, 2, 3], "a": [5, 1, 7, 3]}, index="i")
+        view = tbl.view(filter=[["a", ">", 2]])
+        assert view.min_max("a") == {"min": 3, "max": 7}
+        tbl.update({"i": [2, 4], "a": [10, 4]})
+        assert view.min_max("a") == {"min": 3, "max": 10}
+        tbl.remove([3])
+        assert view.min_max("a") == {"min": 4, "max": 10}
+
+    def test_view_min_max_row_and_column_pivots(self):
+        data = {"a": [1, 2, 3, 4], "b": ["x", "x", "y", "y"], "c": ["p", "q", "p", "q"]}
+        tbl = Table(data)
+        view = tbl.view(row_pivots=["b"])
+        assert view.min_max("a") == {"min": 1, "max": 4}
+        assert view.min_max("a", row=2) == {"min": 3, "max": 4}
+        view = tbl.view(row_pivots=["b"], column_pivots=["c"])
+        assert view.min_max("a", row=1) == {"min": 1, "max": 2}
+
     def test_view_row_delta_two(self, util):
         data = [{"a": 1, "b": 2}, {"a": 3, "b": 4}]
         update_data = {
@@ -831,6 +1851,261 @@ class TestView(object):
         view.on_update(cb1, mode="row")
         tbl.update(update_data)
 
+    # memory usage
+
+    def test_view_get_memory_usage_zero_sided(self):
+        tbl = Table({"a": [1, 2, 3], "b": ["x", "y", "z"]})
+        view = tbl.view(sort=[["a", "desc"]])
+        usage = view.get_memory_usage()
+        assert sorted(usage.keys()) == ["symbols", "traversal"]
+        assert usage["traversal"] > 0
+
+    def test_view_get_memory_usage_pivoted(self):
+        tbl = Table({"a": [1, 2, 3], "b": ["x", "y", "z"]})
+        view = tbl.view(row_pivots=["b"])
+        usage = view.get_memory_usage()
+        assert sorted(usage.keys()) == ["aggregates", "traversal", "tree"]
+        assert all(usage[key] > 0 for key in usage)
+
+        view2 = tbl.view(row_pivots=["b"], column_pivots=["a"])
+        usage2 = view2.get_memory_usage()
+        assert sorted(usage2.keys()) == [
+            "aggregates", "column_traversal", "row_traversal", "tree"]
+        assert all(usage2[key] > 0 for key in usage2)
+
+    def test_view_reclaim_memory_collapsed(self):
+        data = {"a": ["x", "x", "y", "y"], "b": ["p", "q", "p", "q"], "c": [1, 2, 3, 4]}
+        config = {"row_pivots": ["a", "b"], "aggregates": {"c": "median"}}
+        tbl = Table(data)
+        view = tbl.view(**config)
+        view.set_depth(0)
+        assert view.reclaim_memory() > 0
+        tbl.update({"a": ["x", "z"], "b": ["q", "p"], "c": [10, 5]})
+        view.set_depth(1)
+        expected = tbl.view(**config)
+        expected.set_depth(1)
+        assert view.to_dict() == expected.to_dict()
+
+    def test_view_reclaim_memory_column_pivots(self):
+        data = {"a": ["x", "x", "y"], "b": ["p", "q", "p"], "c": ["u", "v", "u"], "d": [1, 2, 3]}
+        config = {"row_pivots": ["a", "b"], "column_pivots": ["c"], "columns": ["d"]}
+        tbl = Table(data)
+        view = tbl.view(**config)
+        view.set_depth(0)
+        view.reclaim_memory()
+        tbl.update({"a": ["y"], "b": ["q"], "c": ["v"], "d": [4]})
+        view.set_depth(1)
+        expected = tbl.view(**config)
+        expected.set_depth(1)
+        assert view.to_dict() == expected.to_dict()
+
+    def test_view_memory_budget(self):
+        data = {"a": ["x", "x", "y", "y"], "b": ["p", "q", "p", "q"], "c": [1, 2, 3, 4]}
+        config = {"row_pivots": ["a", "b"], "aggregates": {"c": "distinct count"}}
+        tbl = Table(data)
+        view = tbl.view(**config)
+        assert view.get_memory_budget() == 0
+        view.set_depth(0)
+        view.set_memory_budget(1)
+        assert view.get_memory_budget() == 1
+        tbl.update({"a": ["y"], "b": ["r"], "c": [2]})
+        view.set_depth(1)
+        expected = tbl.view(**config)
+        expected.set_depth(1)
+        assert view.to_dict() == expected.to_dict()
+
+    def _lazy_and_eager_views(self, **config):
+        data = {
+            "a": ["x", "y", "z", "x", "y", "z"],
+            "b": ["p", "q", "p", "q", "p", "q"],
+            "c": [1, 2, 3, 4, 5, 6],
+            "d": [1.5, 2.5, 3.5, 4.5, 5.5, 6.5]
+        }
+        aggregates = {"c": "sum", "d": "max"}
+        lazy_tbl = Table(data, index="c")
+        eager_tbl = Table(data, index="c")
+        lazy = lazy_tbl.view(aggregates=aggregates, **config)
+        eager = eager_tbl.view(aggregates=aggregates, **config)
+        lazy.set_lazy_aggregates(True)
+        assert lazy.get_lazy_aggregates()
+        assert not eager.get_lazy_aggregates()
+        return (lazy_tbl, lazy), (eager_tbl, eager)
+
+    def test_view_lazy_aggregates_match_eager_after_updates(self):
+        (lazy_tbl, lazy), (eager_tbl, eager) = self._lazy_and_eager_views(
+            row_pivots=["a", "b"])
+        lazy.set_depth(0)
+        eager.set_depth(0)
+        for tbl in (lazy_tbl, eager_tbl):
+            tbl.update({"c": [1, 7], "a": ["z", "x"], "b": ["q", "p"], "d": [0.5, 9.5]})
+            tbl.update({"c": [5, 8], "a": ["y", "y"], "b": ["q", "q"], "d": [10.5, 1.5]})
+            tbl.remove([3])
+        assert lazy.to_dict() == eager.to_dict()
+
+        # Hidden rows were skipped by the updates, and are aggregated as
+        # they are revealed.
+        lazy.expand(1)
+        eager.expand(1)
+        assert lazy.to_dict() == eager.to_dict()
+        lazy.set_depth(1)
+        eager.set_depth(1)
+        assert lazy.to_dict() == eager.to_dict()
+
+        for tbl in (lazy_tbl, eager_tbl):
+            tbl.update({"c": [2, 9], "a": ["x", "z"], "b": ["p", "p"], "d": [20.5, 0.5]})
+        assert lazy.to_dict() == eager.to_dict()
+
+    def test_view_lazy_aggregates_collapse_and_reexpand(self):
+        (lazy_tbl, lazy), (eager_tbl, eager) = self._lazy_and_eager_views(
+            row_pivots=["a", "b"])
+        lazy.set_depth(0)
+        eager.set_depth(0)
+        lazy.expand(1)
+        eager.expand(1)
+        lazy.collapse(1)
+        eager.collapse(1)
+        for tbl in (lazy_tbl, eager_tbl):
+            tbl.update({"c": [4, 10], "a": ["x", "x"], "b": ["p", "q"], "d": [30.5, 0.5]})
+        lazy.set_depth(1)
+        eager.set_depth(1)
+        assert lazy.to_dict() == eager.to_dict()
+
+    def test_view_lazy_aggregates_column_pivots(self):
+        (lazy_tbl, lazy), (eager_tbl, eager) = self._lazy_and_eager_views(
+            row_pivots=["a", "b"], column_pivots=["b"])
+        lazy.set_depth(0)
+        eager.set_depth(0)
+        for tbl in (lazy_tbl, eager_tbl):
+            tbl.update({"c": [2, 11], "a": ["y", "z"], "b": ["p", "q"], "d": [7.5, 8.5]})
+        assert lazy.to_dict() == eager.to_dict()
+        lazy.set_depth(1)
+        eager.set_depth(1)
+        assert lazy.to_dict() == eager.to_dict()
+
+    def test_view_lazy_aggregates_disabled_catches_up(self):
+        (lazy_tbl, lazy), (eager_tbl, eager) = self._lazy_and_eager_views(
+            row_pivots=["a", "b"])
+        lazy.set_depth(0)
+        eager.set_depth(0)
+        for tbl in (lazy_tbl, eager_tbl):
+            tbl.update({"c": [6, 12], "a": ["x", "y"], "b": ["p", "p"], "d": [0.5, 40.5]})
+        lazy.set_lazy_aggregates(False)
+        lazy.set_depth(1)
+        eager.set_depth(1)
+        assert lazy.to_dict() == eager.to_dict()
+
+    def test_view_expansion_state(self):
+        data = {"a": ["x", "x", "y", "y", "z"], "b": ["p", "q", "p", "q", "p"], "c": [1, 2, 3, 4, 5]}
+        tbl = Table(data)
+        view = tbl.view(row_pivots=["a", "b"])
+        view.set_depth(0)
+        view.expand(1)
+        view.expand(4)
+        state = view.get_expansion_state()
+        assert len(state) == 2
+
+        config = {"row_pivots": ["a", "b"], "sort": [["c", "desc"]]}
+        restored = tbl.view(**config)
+        restored.set_depth(0)
+        restored.set_expansion_state(state)
+        assert restored.to_dict()["__ROW_PATH__"] == [
+            [], ["y"], ["y", "q"], ["y", "p"], ["z"], ["x"], ["x", "q"], ["x", "p"]]
+
+        expected = tbl.view(**config)
+        expected.set_depth(0)
+        expected.expand(1)
+        expected.expand(5)
+        assert restored.to_dict() == expected.to_dict()
+
+    def test_view_expansion_state_repeated_values(self):
+        # The same value at several depths makes distinct paths, which are
+        # resolved by their whole path rather than by their last value.
+        data = {"a": ["x", "x", "y", "y"], "b": ["x", "y", "x", "y"], "c": ["x", "x", "y", "x"],
+                "d": [1, 2, 3, 4]}
+        config = {"row_pivots": ["a", "b", "c"], "columns": ["d"]}
+        tbl = Table(data)
+        view = tbl.view(**config)
+        view.set_depth(0)
+        view.expand(2)
+        view.expand(3)
+        state = view.get_expansion_state()
+
+        restored = tbl.view(**config)
+        restored.set_depth(0)
+        restored.set_expansion_state(state)
+        assert restored.to_dict() == view.to_dict()
+        assert ["y", "x"] in restored.to_dict()["__ROW_PATH__"]
+
+    def test_view_expansion_state_removed_and_readded_rows(self):
+        tbl = Table({"k": [1, 2, 3], "a": ["x", "y", "y"], "b": ["p", "q", "p"],
+                     "d": [1, 2, 3]}, index="k")
+        config = {"row_pivots": ["a", "b"], "columns": ["d"]}
+        view = tbl.view(**config)
+        view.set_depth(0)
+        view.expand(2)
+        state = view.get_expansion_state()
+
+        # Paths of removed nodes are unindexed, and indexed again when the
+        # nodes are recreated under new indices.
+        tbl.remove([2, 3])
+        tbl.update([{"k": 4, "a": "z", "b": "p", "d": 4}, {"k": 5, "a": "y", "b": "r", "d": 5}])
+        restored = tbl.view(**config)
+        restored.set_depth(0)
+        restored.set_expansion_state(state)
+        assert restored.to_dict()["__ROW_PATH__"] == [[], ["x"], ["y"], ["y", "r"], ["z"]]
+        assert restored.to_dict()["d"] == [10, 1, 5, 5, 4]
+
+    def test_view_column_pivot_cells_after_removes(self):
+        # Cells of pivoted rows are read from the trees of each depth by
+        # path, which must follow nodes being removed and recreated.
+        rows = [{"k": i, "a": "abc"[i % 3], "b": i % 2, "c": "uv"[i % 2], "d": i}
+                for i in range(12)]
+        config = {"row_pivots": ["a", "b"], "column_pivots": ["c"], "columns": ["d"]}
+        tbl = Table(rows, index="k")
+        view = tbl.view(**config)
+        tbl.remove([0, 3, 6, 9])
+        readded = [{"k": 20 + i, "a": "a", "b": 0, "c": "u", "d": i} for i in range(3)]
+        tbl.update(readded)
+        final = [row for row in rows if row["k"] not in (0, 3, 6, 9)] + readded
+        expected = Table(final, index="k").view(**config)
+        assert view.to_dict() == expected.to_dict()
+
+    def test_view_expansion_state_column_pivots(self):
+        data = {"a": ["x", "x", "y"], "b": ["p", "q", "p"], "c": ["u", "v", "u"], "d": [1, 2, 3]}
+        config = {"row_pivots": ["a", "b"], "column_pivots": ["c"], "columns": ["d"]}
+        tbl = Table(data)
+        view = tbl.view(**config)
+        view.set_depth(0)
+        view.expand(2)
+        state = view.get_expansion_state()
+        view.set_depth(0)
+        view.set_expansion_state(state)
+        tbl.update({"a": ["y"], "b": ["q"], "c": ["v"], "d": [4]})
+        assert view.to_dict()["__ROW_PATH__"] == [[], ["x"], ["y"], ["y", "p"], ["y", "q"]]
+
+    def test_view_expansion_state_missing_rows(self):
+        tbl = Table({"a": ["x", "y"], "b": ["p", "q"]}, index="a")
+        view = tbl.view(row_pivots=["a", "b"])
+        state = view.get_expansion_state()
+        tbl.remove(["x"])
+        other = tbl.view(row_pivots=["a", "b"])
+        other.set_depth(0)
+        other.set_expansion_state(state)
+        assert other.to_dict()["__ROW_PATH__"] == [[], ["y"], ["y", "q"]]
+        assert tbl.view().get_expansion_state() == []
+
+    def test_view_memory_budget_negative(self):
+        tbl = Table({"a": [1]})
+        with raises(PerspectiveError):
+            tbl.view(row_pivots=["a"]).set_memory_budget(-1)
+
+    def test_table_reclaim_memory(self):
+        tbl = Table({"a": ["x", "y"], "b": [1, 2]})
+        view = tbl.view(row_pivots=["a"], aggregates={"b": "median"})
+        tbl.view(row_pivots=["b"]).delete()
+        assert tbl.reclaim_memory() >= 0
+        assert view.to_dict() == {"__ROW_PATH__": [[], ["x"], ["y"]], "a": [2, 1, 1], "b": [2, 1, 2]}
+
     # hidden rows
 
     def test_view_num_hidden_cols(self):
@@ -5,9 +5,30 @@
 # This file is part of the Perspective library, distributed under the terms of
 # the Apache License 2.0.  The full license can be found in the LICENSE file.
 #
+import os
 import numpy as np
 from datetime import date, datetime
 from perspective.table import Table
+from perspective.table.libbinding import get_computed_functions, get_computation_input_types
+from ..common import run_with_env, run_in_process
+
+# Reads the computed function metadata from the binding alone, without the
+# `make_computations` call made when `perspective` is imported, so that it
+# is built on first use.
+LAZY_SOURCE = """
+import sys
+sys.path.insert(0, {0!r})
+import libbinding
+
+
+def result():
+    functions = libbinding.get_computed_functions()
+    return {{
+        "functions": sorted(functions.keys()),
+        "add": functions["add"],
+        "input_types": [str(t) for t in libbinding.get_computation_input_types("add")]
+    }}
+"""
 
 
 class TestViewComputed(object):
@@ -51,6 +72,229 @@ class TestViewComputed(object):
             "final": [36, 64, 100, 144]
         }
 
+    def test_view_computed_hidden_dependency(self):
+        table = Table({
+            "a": [1, 2, 3, 4],
+            "b": [5, 6, 7, 8]
+        })
+        view = table.view(columns=["final"], computed_columns=[{
+                "column": "computed",
+                "computed_function_name": "+",
+                "inputs": ["a", "b"]
+            },
+            {
+                "column": "final",
+                "computed_function_name": "pow2",
+                "inputs": ["computed"]
+            }
+        ])
+        assert view.to_columns() == {
+            "final": [36, 64, 100, 144]
+        }
+        table.update({
+            "a": [5, None],
+            "b": [9, 10]
+        })
+        assert view.to_columns() == {
+            "final": [36, 64, 100, 144, 196, None]
+        }
+
+    def test_view_computed_unread_string_dependency(self):
+        table = Table({
+            "a": ["abc", "de", "f"],
+            "b": [1, 2, 3]
+        }, index="b")
+        view = table.view(columns=["final"], computed_columns=[{
+                "column": "upper",
+                "computed_function_name": "Uppercase",
+                "inputs": ["a"]
+            },
+            {
+                "column": "final",
+                "computed_function_name": "length",
+                "inputs": ["upper"]
+            }
+        ])
+        table.update({
+            "a": ["ghij", "kl"],
+            "b": [1, 4]
+        })
+        assert view.to_columns() == {
+            "final": [4, 2, 1, 2]
+        }
+
+        # An unread column is still kept up to date for later views
+        view2 = table.view(columns=["upper"], computed_columns=[{
+            "column": "upper",
+            "computed_function_name": "Uppercase",
+            "inputs": ["a"]
+        }])
+        assert view2.to_columns() == {
+            "upper": ["GHIJ", "DE", "F", "KL"]
+        }
+
+    def test_view_computed_dependency_partial_update(self):
+        table = Table({
+            "a": [1, 2, 3, 4],
+            "b": [5, 6, 7, 8],
+            "c": [2, 2, 0, 2]
+        }, index="a")
+        view = table.view(computed_columns=[{
+                "column": "computed",
+                "computed_function_name": "-",
+                "inputs": ["b", "c"]
+            },
+            {
+                "column": "final",
+                "computed_function_name": "/",
+                "inputs": ["computed", "c"]
+            }
+        ])
+        table.update({
+            "a": [1, 3],
+            "c": [0, 1]
+        })
+        assert view.to_columns() == {
+            "a": [1, 2, 3, 4],
+            "b": [5, 6, 7, 8],
+            "c": [0, 2, 1, 2],
+            "computed": [5, 4, 6, 6],
+            "final": [None, 2, 6, 3]
+        }
+
+    def test_view_computed_partial_update_unrelated_column(self):
+        table = Table({
+            "a": [1, 2, 3, 4],
+            "b": [5, 6, 7, 8],
+            "c": [1.5, 2.5, 3.5, 4.5],
+            "d": [1, 1, 1, 1]
+        }, index="a")
+        view = table.view(computed_columns=[{
+                "column": "b + d",
+                "computed_function_name": "+",
+                "inputs": ["b", "d"]
+            },
+            {
+                "column": "c * d",
+                "computed_function_name": "*",
+                "inputs": ["c", "d"]
+            }
+        ])
+        table.update({
+            "a": [2, 4],
+            "b": [10, None]
+        })
+        assert view.to_columns() == {
+            "a": [1, 2, 3, 4],
+            "b": [5, 10, 7, None],
+            "c": [1.5, 2.5, 3.5, 4.5],
+            "d": [1, 1, 1, 1],
+            "b + d": [6, 11, 8, None],
+            "c * d": [1.5, 2.5, 3.5, 4.5]
+        }
+        table.update({
+            "a": [1],
+            "d": [2]
+        })
+        assert view.to_columns() == {
+            "a": [1, 2, 3, 4],
+            "b": [5, 10, 7, None],
+            "c": [1.5, 2.5, 3.5, 4.5],
+            "d": [2, 1, 1, 1],
+            "b + d": [7, 11, 8, None],
+            "c * d": [3, 2.5, 3.5, 4.5]
+        }
+
+    def test_view_computed_partial_update_new_and_cleared_rows(self):
+        table = Table({
+            "a": [1, 2, 3],
+            "price": [1.5, 2.5, 3.5],
+            "qty": [2.0, 2.0, 2.0]
+        }, index="a")
+        view = table.view(computed_columns=[{
+                "column": "notional",
+                "computed_function_name": "*",
+                "inputs": ["price", "qty"]
+            },
+            {
+                "column": "above",
+                "computed_function_name": ">",
+                "inputs": ["price", "qty"]
+            }
+        ])
+        table.update([
+            {"a": 1, "price": 4.5},
+            {"a": 2, "qty": None},
+            {"a": 4, "price": 5.5},
+            {"a": 5, "price": 1.0, "qty": 3.0}
+        ])
+        assert view.to_columns() == {
+            "a": [1, 2, 3, 4, 5],
+            "price": [4.5, 2.5, 3.5, 5.5, 1.0],
+            "qty": [2.0, None, 2.0, None, 3.0],
+            "notional": [9, None, 7, None, 3],
+            "above": [True, None, True, None, False]
+        }
+
+    def test_view_computed_partial_update_datetime(self):
+        table = Table({
+            "a": [1, 2],
+            "b": [datetime(2020, 1, 1, 10, 30), datetime(2020, 1, 2, 11, 45)],
+            "c": ["x", "y"]
+        }, index="a")
+        computed = [{
+                "column": "hour",
+                "computed_function_name": "hour_bucket",
+                "inputs": ["b"]
+            },
+            {
+                "column": "day",
+                "computed_function_name": "day_of_week",
+                "inputs": ["b"]
+            }
+        ]
+        view = table.view(computed_columns=computed)
+        table.update([
+            {"a": 1, "c": "z"},
+            {"a": 2, "b": datetime(2020, 1, 4, 12, 15)},
+            {"a": 3, "c": "w"}
+        ])
+        expected = Table({
+            "a": [1, 2, 3],
+            "b": [datetime(2020, 1, 1, 10, 30), datetime(2020, 1, 4, 12, 15), None],
+            "c": ["z", "y", "w"]
+        }, index="a").view(computed_columns=computed)
+        assert view.to_dict() == expected.to_dict()
+
+    def test_view_computed_shared_column_survives_delete(self):
+        table = Table({
+            "a": [1, 2, 3, 4],
+            "b": [5, 6, 7, 8]
+        })
+
+        computed = [{
+            "column": "computed",
+            "computed_function_name": "+",
+            "inputs": ["a", "b"]
+        }]
+
+        view = table.view(computed_columns=computed)
+        view2 = table.view(computed_columns=computed)
+        view.delete()
+
+        table.update({"a": [5], "b": [10]})
+
+        assert view2.to_columns() == {
+            "a": [1, 2, 3, 4, 5],
+            "b": [5, 6, 7, 8, 10],
+            "computed": [6, 8, 10, 12, 15]
+        }
+
+        view2.delete()
+        view3 = table.view(computed_columns=computed)
+
+        assert view3.to_columns()["computed"] == [6, 8, 10, 12, 15]
+
     def test_view_computed_multiple_views_should_not_conflate(self):
         table = Table({
             "a": [1, 2, 3, 4],
@@ -326,6 +570,32 @@ class TestViewComputed(object):
             "computed": [3, 4]
         }
 
+    def test_view_computed_string_functions_repeated_with_null(self):
+        table = Table({
+            "a": ["abc", "def", None, "abc", "def"],
+            "b": ["x", "y", "x", None, "y"]
+        })
+        view = table.view(
+            computed_columns=[
+                {
+                    "column": "upper",
+                    "computed_function_name": "Uppercase",
+                    "inputs": ["a"]
+                },
+                {
+                    "column": "concat",
+                    "computed_function_name": "concat_comma",
+                    "inputs": ["a", "b"]
+                }
+            ]
+        )
+        assert view.to_columns() == {
+            "a": ["abc", "def", None, "abc", "def"],
+            "b": ["x", "y", "x", None, "y"],
+            "upper": ["ABC", "DEF", None, "ABC", "DEF"],
+            "concat": ["abc, x", "def, y", None, None, "def, y"]
+        }
+
     def test_view_day_of_week_date(self):
         table = Table({
             "a": [date(2020, 3, i) for i in range(9, 14)]
@@ -481,6 +751,28 @@ class TestViewComputed(object):
             "bucket": [datetime(2020, 1, 1), datetime(2020, 1, 1), datetime(2020, 2, 29), datetime(2020, 3, 1)]
         }
 
+    def test_view_week_bucket_datetime_with_null(self):
+        table = Table({
+            "a": [datetime(2019, 12, 31, 5), None, datetime(2020, 1, 5, 23), datetime(2020, 1, 6, 0)],
+        })
+        view = table.view(
+            computed_columns=[
+                {
+                    "column": "bucket",
+                    "computed_function_name": "week_bucket",
+                    "inputs": ["a"]
+                }
+            ]
+        )
+        assert view.schema() == {
+            "a": datetime,
+            "bucket": date
+        }
+        assert view.to_columns() == {
+            "a": [datetime(2019, 12, 31, 5), None, datetime(2020, 1, 5, 23), datetime(2020, 1, 6, 0)],
+            "bucket": [datetime(2019, 12, 30), None, datetime(2019, 12, 30), datetime(2020, 1, 6)]
+        }
+
     def test_view_month_bucket_date(self):
         table = Table({
             "a": [date(2020, 1, 1), date(2020, 1, 28), date(2020, 2, 29), date(2020, 3, 15)],
@@ -568,3 +860,102 @@ class TestViewComputed(object):
             "a": [datetime(2020, 1, 1), None, None, datetime(2020, 3, 15)],
             "bucket": [datetime(2020, 1, 1), None, None, datetime(2020, 3, 1)]
         }
+
+    def test_view_computed_divide_with_null_and_zero(self):
+        table = Table({
+            "a": [1, None, 3, 4],
+            "b": [2, 2, 0, None]
+        })
+        view = table.view(computed_columns=[{
+            "column": "computed",
+            "computed_function_name": "/",
+            "inputs": ["a", "b"]
+        }])
+        assert view.to_columns()["computed"] == [0.5, None, None, None]
+
+    def test_view_computed_comparison_with_null(self):
+        table = Table({
+            "a": [1.5, None, 3.5, 4.5],
+            "b": [2.5, 2.5, 0.5, 4.5]
+        })
+        view = table.view(computed_columns=[{
+            "column": "computed",
+            "computed_function_name": ">",
+            "inputs": ["a", "b"]
+        }])
+        assert view.schema()["computed"] == bool
+        assert view.to_columns()["computed"] == [False, None, True, False]
+
+    def test_view_computed_mixed_types(self):
+        table = Table({
+            "a": [1, 2, None, 4],
+            "b": [0.5, 1.5, 2.5, None]
+        })
+        view = table.view(computed_columns=[{
+            "column": "computed",
+            "computed_function_name": "*",
+            "inputs": ["a", "b"]
+        }])
+        assert view.to_columns()["computed"] == [0.5, 3.0, None, None]
+
+    # bucketed pivots
+
+    def test_view_bucketed_row_pivot(self):
+        table = Table({
+            "a": [1, 12, 15, 27],
+            "b": [1, 2, 3, 4]
+        })
+        view = table.view(row_pivots=["bin10(a)"], columns=["b"])
+        expected = table.view(row_pivots=["computed"], columns=["b"], computed_columns=[{
+            "column": "computed",
+            "computed_function_name": "bin10",
+            "inputs": ["a"]
+        }])
+        assert view.to_columns() == expected.to_columns()
+        assert view.to_columns()["b"] == [10, 1, 5, 4]
+
+    def test_view_bucketed_row_pivot_update(self):
+        table = Table({
+            "a": [1, 12, 15, 27],
+            "b": [1, 2, 3, 4]
+        })
+        view = table.view(row_pivots=["bin10(a)"], columns=["b"])
+        table.update({"a": [31, 3], "b": [5, 6]})
+        assert view.to_columns()["b"] == [21, 7, 5, 4, 5]
+
+    def test_view_bucketed_row_pivot_indexed_update(self):
+        table = Table({
+            "id": [1, 2, 3],
+            "a": [1, 12, 15],
+            "b": [1, 2, 3]
+        }, index="id")
+        view = table.view(row_pivots=["bin10(a)"], columns=["b"])
+        table.update([{"id": 1, "a": 14}])
+        assert view.to_columns()["b"] == [6, 6]
+
+    def test_view_bucketed_column_pivot_datetime(self):
+        table = Table({
+            "a": [datetime(2020, 1, 1, 1), datetime(2020, 1, 1, 13), datetime(2020, 1, 2, 5)],
+            "b": [1, 2, 3]
+        })
+        view = table.view(row_pivots=["day_bucket(a)"], column_pivots=["hour_bucket(a)"], columns=["b"])
+        expected = table.view(row_pivots=["day"], column_pivots=["hour"], columns=["b"], computed_columns=[{
+            "column": "day",
+            "computed_function_name": "day_bucket",
+            "inputs": ["a"]
+        }, {
+            "column": "hour",
+            "computed_function_name": "hour_bucket",
+            "inputs": ["a"]
+        }])
+        assert list(view.to_columns().values()) == list(expected.to_columns().values())
+
+    def test_view_computed_functions_built_on_first_use(self):
+        binding_dir = os.path.join(os.path.dirname(__file__), "..", "..", "table")
+        source = LAZY_SOURCE.format(os.path.abspath(binding_dir))
+        expected = run_in_process(
+            source.replace("import libbinding", "from perspective.table import libbinding"))
+        assert run_with_env({}, source) == expected
+        assert expected["functions"] == sorted(get_computed_functions().keys())
+        assert expected["input_types"] == [str(t) for t in get_computation_input_types("add")]
+        assert expected["add"]["num_params"] == "2"
@@ -0,0 +1,77 @@
+################################################################################
+#
+# Copyright (c) 2020, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+from perspective.table import Table
+
+data = {
+    "a": [1, 2, 3, 4],
+    "b": ["x", "y", "x", "z"],
+    "c": [1.5, 2.5, 3.5, 4.5]
+}
+
+
+class TestViewExplain(object):
+
+    def test_view_explain_flat(self):
+        tbl = Table(data)
+        view = tbl.view(sort=[["a", "desc"]])
+        explain = view.explain()
+        assert explain["sides"] == 0
+        assert explain["table_rows"] == 4
+        assert explain["num_rows"] == 4
+        assert explain["filters"] == []
+        assert explain["trees"] == []
+        assert explain["sort"] == [{"column": "a", "order": "desc"}]
+        assert explain["estimated_update_cost"]["sorted"] is True
+
+    def test_view_explain_filter_selectivity(self):
+        tbl = Table(data)
+        view = tbl.view(filter=[["a", ">", 1], ["b", "==", "x"]])
+        explain = view.explain()
+        assert explain["filter_combiner"] == "and"
+        assert [f["matched_rows"] for f in explain["filters"]] == [3, 2]
+        assert [f["selectivity"] for f in explain["filters"]] == [0.75, 0.5]
+        assert explain["filtered_rows"] == 1
+
+    def test_view_explain_tree_and_aggregates(self):
+        tbl = Table(data)
+        view = tbl.view(row_pivots=["b"], columns=["a", "c"],
+                        aggregates={"a": "median", "c": "and"})
+        explain = view.explain()
+        assert explain["sides"] == 1
+        assert explain["row_pivots"] == ["b"]
+        assert len(explain["trees"]) == 1
+        assert explain["trees"][0]["pivots"] == ["b"]
+        assert explain["trees"][0]["nodes_by_depth"] == [1, 3]
+        strategies = {agg["column"]: agg["strategy"] for agg in explain["aggregates"]}
+        assert strategies["a"] == "multiset"
+        assert strategies["c"] == "leaf_scan"
+        cost = explain["estimated_update_cost"]
+        assert cost["node_updates"] == 2
+        assert cost["leaf_reads"] > 0
+
+    def test_view_explain_two_sided(self):
+        tbl = Table(data)
+        view = tbl.view(row_pivots=["b"], column_pivots=["a"])
+        explain = view.explain()
+        assert explain["sides"] == 2
+        assert explain["column_pivots"] == ["a"]
+        # One tree per row pivot depth, each pivoted by the column pivots.
+        assert [tree["pivots"] for tree in explain["trees"]] == [["a"], ["b", "a"]]
+
+    def test_view_explain_computed_columns(self):
+        tbl = Table(data)
+        view = tbl.view(computed_columns=[{
+            "column": "computed",
+            "computed_function_name": "+",
+            "inputs": ["a", "c"]
+        }], filter=[["computed", ">", 5]])
+        explain = view.explain()
+        assert explain["computed_columns"] == [
+            {"column": "computed", "function": "+", "inputs": ["a", "c"]}]
+        assert explain["filters"][0]["matched_rows"] == 2
@@ -0,0 +1,71 @@
+# *****************************************************************************
+#
+# Copyright (c) 2019, the Perspective Authors.
+#
+# This file is part of the Perspective library, distributed under the terms of
+# the Apache License 2.0.  The full license can be found in the LICENSE file.
+#
+
+from pytest import raises
+from perspective.core.exception import PerspectiveError
+from perspective.table import Table
+
+
+def _trades():
+    return Table({
+        "id": [1, 2, 3, 4],
+        "desk": ["x", "x", "y", "y"],
+        "order": ["a", "a", "b", "c"],
+        "qty": [1, 2, 3, 4]
+    }, index="id")
+
+
+class TestViewToTable(object):
+
+    def test_view_to_table(self):
+        view = _trades().view(row_pivots=["order"], columns=["qty"])
+        orders = view.to_table()
+        assert orders.columns() == ["order", "qty"]
+        assert orders.view().to_dict() == {
+            "order": ["a", "b", "c"],
+            "qty": [3, 3, 4]
+        }
+
+    def test_view_to_table_update(self):
+        trades = _trades()
+        orders = trades.view(row_pivots=["order"], columns=["qty"]).to_table()
+        view = orders.view()
+        trades.update([{"id": 1, "qty": 10}, {"id": 5, "order": "d", "qty": 5}])
+        assert view.to_dict() == {
+            "order": ["a", "b", "c", "d"],
+            "qty": [12, 3, 4, 5]
+        }
+
+    def test_view_to_table_removes_empty_groups(self):
+        trades = _trades()
+        orders = trades.view(row_pivots=["order"], columns=["qty"]).to_table()
+        trades.remove([3])
+        trades.update([{"id": 4, "order": "a"}])
+        assert orders.view().to_dict() == {
+            "order": ["a"],
+            "qty": [7]
+        }
+
+    def test_view_to_table_chained(self):
+        trades = _trades()
+        orders = trades.view(row_pivots=["desk", "order"], columns=["qty"]).to_table()
+        assert orders.columns() == ["__ROW_PATH__", "desk", "order", "qty"]
+        desks = orders.view(row_pivots=["desk"], columns=["qty"])
+        assert desks.to_dict() == {
+            "__ROW_PATH__": [[], ["x"], ["y"]],
+            "qty": [10, 3, 7]
+        }
+        trades.update([{"id": 5, "desk": "x", "order": "d", "qty": 5}])
+        assert desks.to_dict() == {
+            "__ROW_PATH__": [[], ["x"], ["y"]],
+            "qty": [15, 8, 7]
+        }
+
+    def test_view_to_table_without_row_pivots(self):
+        with raises(PerspectiveError):
+            _trades().view().to_table()
@@ -8,14 +8,74 @@
 
 import json
 import tornado.websocket
+from functools import partial
+from tornado.concurrent import Future
 from tornado.ioloop import IOLoop
 from ..core.exception import PerspectiveError
+from ..manager import _binary_protocol
 
 
 # Redefine `queue_process` to take advantage of `tornado.ioloop`
 def _queue_process_tornado(table_id, state_manager):
     loop = IOLoop.current()
-    loop.add_callback(state_manager.call_process, table_id=table_id)
+    delay = state_manager.get_process_delay(table_id)
+    if delay > 0:
+        loop.call_later(delay, state_manager.call_process, table_id=table_id)
+    else:
+        loop.add_callback(state_manager.call_process, table_id=table_id)
+
+
+# Run the notifications of views with an update interval once they are due.
+def _queue_notify_tornado(func, delay):
+    IOLoop.current().call_later(delay, func)
+
+
+def _join_frame(messages, binary):
+    '''Returns the `(frame, binary, count)` of one frame of `messages`.'''
+    if len(messages) == 1:
+        return (messages[0], binary, 1)
+    elif binary:
+        return (_binary_protocol.encode_messages(messages), True, len(messages))
+    return ("[" + ",".join(messages) + "]", False, len(messages))
+
+
+def _coalesce_frames(messages, binary_protocol):
+    '''Returns the frames that write `messages`, a list of the `(message,
+    binary)` posted to a client in order, with consecutive messages joined in
+    one frame: JSON messages as a JSON array of them, and messages in the
+    binary protocol as an encoded array of them. The binary that follows a
+    JSON message announcing it is a frame of its own, after the frame that
+    ends with that message.
+
+    Args:
+        messages (:obj:`list`): the `(message, binary)` of each post.
+        binary_protocol (:obj:`bool`): whether the client negotiated the
+            binary protocol, in which each binary is a message.
+
+    Returns:
+        :obj:`list`: the `(frame, binary, count)` of each frame, where
+            `count` is the number of posts it writes.
+    '''
+    frames = []
+    group = []
+    group_binary = False
+    for message, binary in list(messages) + [(None, None)]:
+        is_message = binary is not None and (not binary or binary_protocol)
+        if group and (not is_message or binary != group_binary):
+            frames.append(_join_frame(group, group_binary))
+            group = []
+        if is_message:
+            group.append(message)
+            group_binary = binary
+        elif binary:
+            frames.append((message, True, 1))
+    return frames
+
+
+def _resolve_all(futures, *args):
+    for future in futures:
+        if not future.done():
+            future.set_result(None)
 
 
 class PerspectiveTornadoHandler(tornado.websocket.WebSocketHandler):
@@ -49,10 +109,30 @@ class PerspectiveTornadoHandler(tornado.websocket.WebSocketHandler):
                 Must be provided on initialization.
             check_origin (:obj`bool`): If True, all requests will be accepted
                 regardless of origin. Defaults to False.
+            flush_interval (:obj`float`): For clients that accept coalesced
+                frames, as Perspective's JS client does, the messages posted
+                within `flush_interval` seconds are written together, in as
+                few frames as their order allows. Defaults to 0, which
+                coalesces the messages posted in one iteration of the loop,
+                e.g. the `on_update` notifications of one update. If None,
+                each message is written as it is posted.
+            compression_options (:obj`dict`): If set, the websocket
+                negotiates permessage-deflate with clients that support it,
+                using Tornado's `compression_level` and `mem_level` options
+                if given, e.g. `{}` for the defaults. Arrows are compressed
+                by the manager instead, as negotiated by the client.
         '''
         self._manager = kwargs.pop("manager", None)
         self._session = self._manager.new_session()
         self._check_origin = kwargs.pop("check_origin", False)
+        self._flush_interval = kwargs.pop("flush_interval", 0)
+        self._compression_options = kwargs.pop("compression_options", None)
+
+        # The messages posted since the last flush, for a client that
+        # accepts coalesced frames.
+        self._coalesce = False
+        self._outbox = []
+        self._flush_scheduled = False
 
         # Trigger special flow when receiving an ArrayBuffer/binary
         self._is_transferable = False
@@ -65,6 +145,11 @@ class PerspectiveTornadoHandler(tornado.websocket.WebSocketHandler):
 
         # make sure each `Table` calls the asynchronous version of `queue_process`
         self._manager._set_queue_process(_queue_process_tornado)
+        self._manager._set_queue_notify(_queue_notify_tornado)
+
+        # post the results of a `threaded` manager's worker threads on the
+        # loop, where the websocket is written
+        self._manager._set_loop_callback(IOLoop.current().add_callback)
 
     def check_origin(self, origin):
         '''Returns whether the handler allows requests from origins outside
@@ -72,10 +157,21 @@ class PerspectiveTornadoHandler(tornado.websocket.WebSocketHandler):
         '''
         return self._check_origin
 
+    def get_compression_options(self):
+        '''Returns the permessage-deflate options of the websocket, or None
+        to not compress its frames.
+        '''
+        return self._compression_options
+
     def on_message(self, message):
         '''When the websocket receives a message, send it to the `process`
         method of the `PerspectiveManager` with a reference to the `post`
         callback.
+
+        If the manager bounds `max_pending_messages` and the client has not
+        read that many of the messages posted to it, a Future is returned that
+        resolves once it has, so that Tornado stops reading the client's
+        messages until then.
         '''
         if message == "heartbeat":
             return
@@ -99,9 +195,15 @@ class PerspectiveTornadoHandler(tornado.websocket.WebSocketHandler):
 
             self._is_transferable = False
             self._is_transferable_pre_message = None
+        elif isinstance(message, bytes):
+            # A message in the binary protocol, which the manager decodes.
+            pass
         else:
             message = json.loads(message)
 
+            if message.get("cmd") == "init" and message.get("coalesce", False):
+                self._coalesce = self._flush_interval is not None
+
             if message.get("is_transferable", None):
                 # cache the message and wait for the ArrayBuffer that will
                 # follow immediately after.
@@ -111,6 +213,12 @@ class PerspectiveTornadoHandler(tornado.websocket.WebSocketHandler):
 
         self._session.process(message, self.post)
 
+        if self._manager._is_client_congested(self._session.client_id):
+            drained = Future()
+            self._manager._on_client_drained(
+                self._session.client_id, lambda: drained.done() or drained.set_result(None))
+            return drained
+
     def post(self, message, binary=False):
         '''When `post` is called by `PerspectiveManager`, serialize the data to
         JSON and send it to the client.
@@ -118,11 +226,48 @@ class PerspectiveTornadoHandler(tornado.websocket.WebSocketHandler):
         Args:
             message (str): a JSON-serialized string containing a message to the
                 front-end `perspective-viewer`.
+
+        Returns:
+            :obj:`Future`: resolves once the message is written.
+        '''
+        if not self._coalesce:
+            return self.write_message(message, binary)
+
+        future = Future()
+        self._outbox.append((message, binary, future))
+        if not self._flush_scheduled:
+            self._flush_scheduled = True
+            if self._flush_interval > 0:
+                IOLoop.current().call_later(self._flush_interval, self._flush)
+            else:
+                IOLoop.current().add_callback(self._flush)
+        return future
+
+    def _flush(self):
+        '''Write the messages posted since the last flush, coalesced into
+        frames.
         '''
-        self.write_message(message, binary)
+        self._flush_scheduled = False
+        outbox, self._outbox = self._outbox, []
+        binary_protocol = self._session.client_id in self._manager._binary_clients
+        futures = [future for _, _, future in outbox]
+        frames = _coalesce_frames(
+            [(message, binary) for message, binary, _ in outbox], binary_protocol)
+        for frame, binary, count in frames:
+            written, futures = futures[:count], futures[count:]
+            try:
+                result = self.write_message(frame, binary)
+            except tornado.websocket.WebSocketClosedError:
+                result = None
+            if result is None:
+                _resolve_all(written)
+            else:
+                result.add_done_callback(partial(_resolve_all, written))
 
     def on_close(self):
         '''Remove the views associated with the client when the websocket
         closes.
         '''
+        _resolve_all([future for _, _, future in self._outbox])
+        self._outbox = []
         self._session.close()
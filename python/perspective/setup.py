@@ -51,6 +51,7 @@ requires = [
 
 if sys.version_info.major < 3:
     requires.append("backports.shutil-which")
+    requires.append("futures")
 
 if sys.version_info.minor < 7:
     raise Exception("Requires Python 2.7/3.7 or later")
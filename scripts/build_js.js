@@ -17,6 +17,9 @@ const minimatch = require("minimatch");
 const os = require("os");
 const {getarg} = require("./script_utils.js");
 const IS_CI = getarg("--ci");
+const IS_PTHREADS = !!(getarg("--pthreads") || process.env.PSP_WASM_PTHREADS);
+const IS_MEMORY64 = !!(getarg("--memory64") || process.env.PSP_WASM_MEMORY64);
+const WASM_PROFILE = getarg("--lean") ? "lean" : process.env.PSP_WASM_PROFILE || "full";
 
 require("dotenv").config({path: "./.perspectiverc"});
 
@@ -33,24 +36,57 @@ const WEB_WASM_OPTIONS = {
     build: !!argv.wasm // flag as to whether to build
 };
 
+/**
+ * The pthreads build, which runs the engine's parallel paths on Web Workers
+ * where `SharedArrayBuffer` is available. It is built in its own directory,
+ * as every object in it must be compiled with atomics.
+ */
+const WEB_WASM_MT_OPTIONS = {
+    inputFile: "psp.async.mt.js",
+    inputWasmFile: "psp.async.mt.wasm",
+    inputWorkerFile: "psp.async.mt.worker.js",
+    buildSubdir: "mt",
+    format: false,
+    packageName: "perspective",
+    build: !!argv.wasm
+};
+
+/**
+ * The memory64 build, whose 64-bit pointers let tables grow beyond the 4 GB
+ * heap of the default build, for engines which support memory64. It is
+ * built in its own directory, as every object in it must be compiled for
+ * 64-bit pointers, and bundled as `perspective.memory64.js`.
+ */
+const WEB_WASM_64_OPTIONS = {
+    inputFile: "psp.async.64.js",
+    inputWasmFile: "psp.async.64.wasm",
+    buildSubdir: "64",
+    cmakeFlags: "-DPSP_WASM_MEMORY64=ON",
+    format: false,
+    packageName: "perspective",
+    build: !!argv.wasm
+};
+
+WEB_WASM_MT_OPTIONS.cmakeFlags = "-DPSP_WASM_PTHREADS=ON";
+
 /**
  * Filter for the runtimes we should build
  */
-const AVAILABLE_RUNTIMES = [WEB_WASM_OPTIONS];
+const AVAILABLE_RUNTIMES = [WEB_WASM_OPTIONS].concat(IS_PTHREADS ? [WEB_WASM_MT_OPTIONS] : [], IS_MEMORY64 ? [WEB_WASM_64_OPTIONS] : []);
 
 // Select the runtimes - if no builds are specified then build everything
 const RUNTIMES = AVAILABLE_RUNTIMES.filter(runtime => runtime.build).length ? AVAILABLE_RUNTIMES.filter(runtime => runtime.build) : AVAILABLE_RUNTIMES;
 
 // Directory of Emscripten output
-const getBaseDir = packageName => path.join(__dirname, "..", "cpp", packageName, "obj");
-const getBuildDir = packageName => path.join(getBaseDir(packageName), "build");
+const getBaseDir = (packageName, buildSubdir = "") => path.join(__dirname, "..", "cpp", packageName, "obj", buildSubdir);
+const getBuildDir = (packageName, buildSubdir) => path.join(getBaseDir(packageName, buildSubdir), "build");
 const getOuputDir = packageName => path.join(__dirname, "..", "packages", packageName);
 
-function compileRuntime({inputFile, inputWasmFile, format, packageName}) {
+function compileRuntime({inputFile, inputWasmFile, inputWorkerFile, buildSubdir, format, packageName}) {
     console.log("-- Building %s", inputFile);
 
     const OUTPUT_DIRECTORY = getOuputDir(packageName);
-    const BUILD_DIRECTORY = getBuildDir(packageName);
+    const BUILD_DIRECTORY = getBuildDir(packageName, buildSubdir);
 
     mkdirp.sync(path.join(OUTPUT_DIRECTORY, "dist", "obj"));
     mkdirp.sync(path.join(OUTPUT_DIRECTORY, "dist", "umd"));
@@ -60,6 +96,12 @@ function compileRuntime({inputFile, inputWasmFile, format, packageName}) {
         fs.copyFileSync(path.join(BUILD_DIRECTORY, inputWasmFile), path.join(OUTPUT_DIRECTORY, "dist", "umd", inputWasmFile));
     }
 
+    if (inputWorkerFile) {
+        // Loaded by URL to start each pthread, so it is not bundled
+        console.log("-- Copying pthread worker %s", inputWorkerFile);
+        fs.copyFileSync(path.join(BUILD_DIRECTORY, inputWorkerFile), path.join(OUTPUT_DIRECTORY, "dist", "umd", inputWorkerFile));
+    }
+
     console.debug("-- Creating wrapped js runtime");
     const runtimeText = String(
         fs.readFileSync(path.join(BUILD_DIRECTORY, inputFile), {
@@ -94,15 +136,16 @@ function docker(image = "emsdk") {
     return cmd;
 }
 
-function compileCPP(packageName) {
-    const BASE_DIRECTORY = getBaseDir(packageName);
-    let cmd = `emcmake cmake ../ `;
+function compileCPP(packageName, {buildSubdir, cmakeFlags} = {}) {
+    const BASE_DIRECTORY = getBaseDir(packageName, buildSubdir);
+    let cmd = buildSubdir ? `emcmake cmake ../../ ${cmakeFlags} ` : `emcmake cmake ../ `;
     if (process.env.PSP_DEBUG) {
-        cmd += `-DCMAKE_BUILD_TYPE=debug`;
+        cmd += `-DCMAKE_BUILD_TYPE=debug `;
     }
+    cmd += `-DPSP_WASM_PROFILE=${WASM_PROFILE} `;
     cmd += `&& emmake make -j${process.env.PSP_CPU_COUNT || os.cpus().length}`;
     if (process.env.PSP_DOCKER) {
-        cmd = `${docker()} bash -c "cd cpp/${packageName}/obj && ${cmd}"`;
+        cmd = `${docker()} bash -c "cd cpp/${packageName}/obj/${buildSubdir || ""} && ${cmd}"`;
     } else {
         cmd = `cd ${BASE_DIRECTORY} && ${cmd}`;
     }
@@ -121,9 +164,18 @@ try {
     if (!process.env.PACKAGE || minimatch("perspective", process.env.PACKAGE)) {
         mkdirp("cpp/perspective/obj");
         compileCPP("perspective");
+        for (const runtime of [WEB_WASM_MT_OPTIONS, WEB_WASM_64_OPTIONS]) {
+            if (AVAILABLE_RUNTIMES.includes(runtime)) {
+                mkdirp.sync(`cpp/perspective/obj/${runtime.buildSubdir}`);
+                compileCPP("perspective", runtime);
+            }
+        }
         RUNTIMES.map(compileRuntime);
     }
     lerna();
+    if (IS_MEMORY64 && (!process.env.PACKAGE || minimatch("perspective", process.env.PACKAGE))) {
+        execute(`lerna exec --scope="@finos/perspective" -- yarn build:memory64`);
+    }
 } catch (e) {
     console.log(e.message);
     process.exit(1);